@@ -1,5 +1,6 @@
 #include "GridCurMover.h"
 #include "MemUtils.h"
+#include "TimeInterval.h"
 #include "CROSS.H"
 
 
@@ -16,6 +17,7 @@ GridCurMover::GridCurMover (TMap *owner, char *name) : TCATSMover(owner, name)
 	fTimeDataHdl = 0;
 	fOverLap = false;		// for multiple files case
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 
 	fUserUnits = kUndefined;
 	
@@ -375,7 +377,7 @@ Boolean GridCurMover::CheckInterval(long &timeDataInterval, const Seconds& model
 	
 	Seconds time = model_time;	// AH 07/17/2012
 	
-	long i,numTimes;
+	long numTimes;
 	
 	
 	numTimes = this -> GetNumTimesInFile(); 
@@ -407,14 +409,9 @@ Boolean GridCurMover::CheckInterval(long &timeDataInterval, const Seconds& model
 		else fOverLap = false;
 	}
 	
-	for (i=0;i<numTimes;i++) 
-	{	// find the time interval
-		if (time>=(*fTimeDataHdl)[i].time && time<=(*fTimeDataHdl)[i+1].time)
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(PtCurTimes(fTimeDataHdl), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<(*fTimeDataHdl)[0].time) 
 		timeDataInterval = 0;
@@ -8,6 +8,7 @@
  */
 
 #include "GridWndMover.h"
+#include "TimeInterval.h"
 #include "CROSS.H"
 
 GridWndMover::GridWndMover(TMap *owner,char* name) : TWindMover(owner, name)
@@ -24,6 +25,7 @@ GridWndMover::GridWndMover(TMap *owner,char* name) : TWindMover(owner, name)
 	fIsOptimizedForStep = false;
 	fOverLap = false;		// for multiple files case
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	
 	//fUserUnits = kMetersPerSec;	
 	fUserUnits = kUndefined;	
@@ -456,7 +458,7 @@ OSErr GridWndMover::CheckAndScanFile(char *errmsg, const Seconds& model_time)
 Boolean GridWndMover::CheckInterval(long &timeDataInterval, const Seconds& model_time)
 {
 	Seconds time =  model_time;	// AH 07/17/2012
-	long i,numTimes;
+	long numTimes;
 	
 	numTimes = this -> GetNumTimesInFile(); 
 	if (numTimes==0) {timeDataInterval = 0; return false;}	// really something is wrong, no data exists
@@ -487,14 +489,9 @@ Boolean GridWndMover::CheckInterval(long &timeDataInterval, const Seconds& model
 		else fOverLap = false;
 	}
 	
-	for (i=0;i<numTimes;i++) 
-	{	// find the time interval
-		if (time>=(*fTimeDataHdl)[i].time && time<=(*fTimeDataHdl)[i+1].time)
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(PtCurTimes(fTimeDataHdl), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<(*fTimeDataHdl)[0].time) 
 		timeDataInterval = 0;
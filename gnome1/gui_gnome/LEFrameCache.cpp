@@ -0,0 +1,160 @@
+/*
+ *  LEFrameCache.cpp
+ *  gnome
+ *
+ *  An encoded frame is a list of runs: the count of bytes the same as in
+ *  the base, then the count of bytes that differ and their xors with it,
+ *  the counts 7 bits a byte, the low bits first.
+ *
+ */
+
+#include "LEFrameCache.h"
+
+static void PutCount(vector<char> &encoded, unsigned long count)
+{
+	while (count >= 0x80) {
+		encoded.push_back((char)((count & 0x7F) | 0x80));
+		count >>= 7;
+	}
+	encoded.push_back((char)count);
+}
+
+static unsigned long GetCount(const vector<char> &encoded, long *pos)
+{
+	unsigned long count = 0;
+	short shift = 0;
+	unsigned char c;
+
+	do {
+		c = (unsigned char)encoded[(*pos)++];
+		count |= (unsigned long)(c & 0x7F) << shift;
+		shift += 7;
+	} while (c & 0x80);
+
+	return count;
+}
+
+// the byte of base at i, 0 past its end or with no base
+#define BaseByte(base, i) ((base) && (i) < (long)(base)->size() ? (*(base))[i] : 0)
+
+void LEFrameCache::Encode(const char *data, long length, const vector<char> *base, vector<char> &encoded)
+{
+	long i = 0, start;
+
+	encoded.clear();
+	while (i < length) {
+		start = i;
+		while (i < length && data[i] == BaseByte(base, i)) i++;
+		PutCount(encoded, i - start);
+
+		start = i;
+		while (i < length && data[i] != BaseByte(base, i)) i++;
+		PutCount(encoded, i - start);
+		for (; start < i; start++)
+			encoded.push_back((char)(data[start] ^ BaseByte(base, start)));
+	}
+}
+
+void LEFrameCache::Decode(const vector<char> &encoded, long length, const vector<char> *base, vector<char> &data)
+{
+	long i = 0, pos = 0, end;
+
+	data.resize(length);
+	while (i < length && pos < (long)encoded.size()) {
+		for (end = i + GetCount(encoded, &pos); i < end; i++)
+			data[i] = BaseByte(base, i);
+		for (end = i + GetCount(encoded, &pos); i < end; i++)
+			data[i] = (char)(encoded[pos++] ^ BaseByte(base, i));
+	}
+}
+
+void LEFrameCache::Clear()
+{
+	vector<LEFrame>().swap(fFrames);
+	vector<char>().swap(fLast);
+	fLastNumber = -1;
+	fMemoryUsed = 0;
+}
+
+void LEFrameCache::Remove(long frameNumber)
+{
+	LEFrame *frame;
+
+	if (!Has(frameNumber)) return;
+
+	// the next frame is a difference from this one, it becomes a key frame first.
+	// That can go over the memory limit, it isn't kept anywhere else
+	if (Has(frameNumber + 1) && !fFrames[frameNumber + 1].keyFrame) {
+		vector<char> next, encoded;
+
+		Get(frameNumber + 1, next);
+		frame = &fFrames[frameNumber + 1];
+		Encode(next.empty() ? 0 : &next[0], next.size(), 0, encoded);
+		fMemoryUsed += (long)encoded.size() - (long)frame->encoded.size();
+		vector<char>(encoded).swap(frame->encoded);
+		frame->keyFrame = true;
+	}
+
+	frame = &fFrames[frameNumber];
+	fMemoryUsed -= frame->encoded.size();
+	vector<char>().swap(frame->encoded);
+	frame->kept = false;
+	if (fLastNumber == frameNumber) fLastNumber = -1;
+}
+
+Boolean LEFrameCache::Get(long frameNumber, vector<char> &data)
+{
+	long i, keyNumber;
+	vector<char> base;
+
+	if (!Has(frameNumber)) return false;
+	if (frameNumber == fLastNumber) { data = fLast; return true; }
+
+	// the frames from the key frame on, each the base of the next
+	for (keyNumber = frameNumber; !fFrames[keyNumber].keyFrame; keyNumber--) {}
+	if (fLastNumber >= keyNumber && fLastNumber < frameNumber) {
+		keyNumber = fLastNumber;
+		data = fLast;
+	}
+	else
+		Decode(fFrames[keyNumber].encoded, fFrames[keyNumber].length, 0, data);
+	for (i = keyNumber + 1; i <= frameNumber; i++) {
+		base.swap(data);
+		Decode(fFrames[i].encoded, fFrames[i].length, &base, data);
+	}
+
+	fLast = data;
+	fLastNumber = frameNumber;
+	return true;
+}
+
+Boolean LEFrameCache::Add(long frameNumber, const char *data, long length)
+{
+	vector<char> encoded, base;
+	LEFrame *frame;
+
+	if (frameNumber < 0 || length < 0) return false;
+	if (frameNumber >= (long)fFrames.size()) {
+		LEFrame empty;
+		empty.kept = empty.keyFrame = false;
+		empty.length = 0;
+		fFrames.resize(frameNumber + 1, empty);
+	}
+
+	Remove(frameNumber);
+
+	frame = &fFrames[frameNumber];
+	frame->keyFrame = (frameNumber % kLEFrameKeyInterval == 0 || !Has(frameNumber - 1));
+	if (!frame->keyFrame && !Get(frameNumber - 1, base)) frame->keyFrame = true;
+	Encode(data, length, frame->keyFrame ? 0 : &base, encoded);
+	if (fMemoryUsed + (long)encoded.size() > fMemoryLimit) return false;
+
+	vector<char>(encoded).swap(frame->encoded);	// no more capacity than it needs
+	frame->length = length;
+	frame->kept = true;
+	fMemoryUsed += frame->encoded.size();
+
+	fLast.assign(data, data + length);
+	fLastNumber = frameNumber;
+	return true;
+}
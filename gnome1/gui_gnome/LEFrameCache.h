@@ -0,0 +1,62 @@
+/*
+ *  LEFrameCache.h
+ *  gnome
+ *
+ *  The LE frames of the run bar, kept in memory so stepping back doesn't
+ *  reread a temp file. A frame is the bytes TModel::SaveModelLEs(BFPB*)
+ *  writes. Most of an LE doesn't change from one step to the next, so a
+ *  frame is kept as its difference from the frame before, the xor of the
+ *  two with its runs of zeros counted, and every kLEFrameKeyInterval frames
+ *  as a key frame, its difference from nothing. Frames that don't fit in
+ *  the memory limit are left to the temp files.
+ *
+ */
+
+#ifndef __LEFrameCache__
+#define __LEFrameCache__
+
+#include "Basics.h"
+#include <vector>
+
+using std::vector;
+
+#define kLEFrameKeyInterval 16
+#define kLEFrameCacheDefaultLimit (256L * 1024 * 1024)
+
+class LEFrameCache
+{
+public:
+	LEFrameCache() : fMemoryLimit(kLEFrameCacheDefaultLimit), fMemoryUsed(0), fLastNumber(-1) {}
+
+	void		Clear();
+	void		SetMemoryLimit(long numBytes) { fMemoryLimit = numBytes; }
+	long		GetMemoryUsed() { return fMemoryUsed; }
+
+	// keeps the length bytes of data as frame frameNumber, replacing the frame
+	// there was. False if they don't fit in the memory limit: the frame isn't kept.
+	Boolean		Add(long frameNumber, const char *data, long length);
+	// the bytes of frame frameNumber, false if it isn't kept
+	Boolean		Get(long frameNumber, vector<char> &data);
+	// frame frameNumber isn't kept anymore
+	void		Remove(long frameNumber);
+	Boolean		Has(long frameNumber) { return frameNumber >= 0 && frameNumber < (long)fFrames.size() && fFrames[frameNumber].kept; }
+
+private:
+	typedef struct {
+		Boolean			kept;
+		Boolean			keyFrame;	// else the difference from the frame before
+		long			length;		// of the frame, not of encoded
+		vector<char>	encoded;
+	} LEFrame;
+
+	vector<LEFrame>	fFrames;
+	long			fMemoryLimit;
+	long			fMemoryUsed;
+	long			fLastNumber;	// the frame last added or got, -1 if none
+	vector<char>	fLast;			// and its bytes, the base of the next one
+
+	static void	Encode(const char *data, long length, const vector<char> *base, vector<char> &encoded);
+	static void	Decode(const vector<char> &encoded, long length, const vector<char> *base, vector<char> &data);
+};
+
+#endif
@@ -1,6 +1,7 @@
 
 #include "Cross.h"
 #include "MapUtils.h"
+#include "BoundarySegIndex.h"
 #include "GridMapUtils.h"
 #include "GenDefs.h"
 #include "GridVel.h"
@@ -108,6 +109,11 @@ void Map3D::Dispose()
 		fBoundaryPointsH = 0;
 	}
 	
+	if (fSegIndex) {
+		delete fSegIndex;
+		fSegIndex = 0;
+	}
+	
 	/*if (fDropletSizesH) {
 		DisposeHandle((Handle)fDropletSizesH);
 		fDropletSizesH = 0;
@@ -3004,12 +3010,11 @@ OSErr Map3D_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numCol
 	long i, j, n, ntri, numVerdatPts=0; 
 	long numRows_ext = numRows+1, numCols_ext = numCols+1;
 	long nv = numRows * numCols, nv_ext = numRows_ext*numCols_ext;
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long iIndex,jIndex,index,currentIndex,startIndex; 
+	long iIndex,jIndex,index; 
 	long triIndex1,triIndex2,waterCellNum=0;
 	long ptIndex = 0,cellNum = 0,diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	OSErr err = 0;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(numRows * numCols * sizeof(long));
@@ -3029,7 +3034,6 @@ OSErr Map3D_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numCol
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -3255,7 +3259,6 @@ OSErr Map3D_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numCol
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv_ext * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -3359,38 +3362,10 @@ OSErr Map3D_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numCol
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		//err = -1; goto done;
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		err = -1; goto done;
@@ -3401,40 +3376,6 @@ findnewstartpoint:
 		goto setFields;*/
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	/////////////////////////////////////////////////
@@ -3498,7 +3439,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	
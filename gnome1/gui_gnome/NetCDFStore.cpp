@@ -7,9 +7,131 @@
 #include <list>
 #include <new>
 #include <iostream>
+#include <vector>
+#include "GnomeThreads.h"
 
 using namespace std;
 
+// Write batches a file's steps, then writes each variable's values for all of
+// them at once on a thread of its own, while the model goes on with the run.
+// The netCDF calls hold GnomeFileIOMutex, netCDF isn't thread safe.
+#define kNetCDFBatchSteps 16
+#define kNetCDFBatchValues (1L << 20)	// LE values of all the steps, a variable's
+
+static bool sNetCDF4 = false;
+static int sDeflateLevel = 0;
+static long sChunkSize = 65536;
+
+class NetCDFBatch
+{
+	public:
+		size_t timeStart, dataStart;	// where the first step goes in the file
+		vector<double> time;
+		vector<long> pCount;
+		vector<float> lon, lat, depth, mass;
+		vector<long> age, id;
+		vector<short> status_codes;
+
+		void Clear() { NetCDFBatch empty; swap(empty); }
+		void swap(NetCDFBatch &other);
+};
+
+void NetCDFBatch::swap(NetCDFBatch &other)
+{
+	std::swap(timeStart, other.timeStart);
+	std::swap(dataStart, other.dataStart);
+	time.swap(other.time);
+	pCount.swap(other.pCount);
+	lon.swap(other.lon);
+	lat.swap(other.lat);
+	depth.swap(other.depth);
+	mass.swap(other.mass);
+	age.swap(other.age);
+	id.swap(other.id);
+	status_codes.swap(other.status_codes);
+}
+
+class NetCDFBatchFile
+{
+	public:
+		int ncID;
+		map<string, int> varIDs;
+		size_t timeCoord, dataCoord;	// of the next step written
+		NetCDFBatch pending, writing;
+		GnomeThread thread;				// writing writing
+		int writeErr;					// its ncErr
+
+		NetCDFBatchFile(int ncID, map<string, int> &varIDs) : ncID(ncID), varIDs(varIDs), timeCoord(0), dataCoord(0), writeErr(NC_NOERR) {}
+};
+
+// by ncID, from the first step written to fClose
+static map<int, NetCDFBatchFile*> sBatchFiles;
+
+static int WriteBatch(int ncID, map<string, int> &varIDs, NetCDFBatch &batch)
+{
+	GnomeLock lock(GnomeFileIOMutex());
+	size_t timeStart[] = {batch.timeStart}, timeCount[] = {batch.time.size()};
+	size_t dataStart[] = {batch.dataStart}, dataCount[] = {batch.lon.size()};
+	int ncErr;
+
+	if (timeCount[0] == 0) return NC_NOERR;
+	if (ncErr = nc_put_vara_double(ncID, varIDs["Time"], timeStart, timeCount, &batch.time[0])) return ncErr;
+	if (ncErr = nc_put_vara_long(ncID, varIDs["Particle_Count"], timeStart, timeCount, &batch.pCount[0])) return ncErr;
+
+	if (dataCount[0] == 0) return NC_NOERR;
+	if (ncErr = nc_put_vara_float(ncID, varIDs["Longitude"], dataStart, dataCount, &batch.lon[0])) return ncErr;
+	if (ncErr = nc_put_vara_float(ncID, varIDs["Latitude"], dataStart, dataCount, &batch.lat[0])) return ncErr;
+	if (ncErr = nc_put_vara_float(ncID, varIDs["Depth"], dataStart, dataCount, &batch.depth[0])) return ncErr;
+	if (ncErr = nc_put_vara_float(ncID, varIDs["Mass"], dataStart, dataCount, &batch.mass[0])) return ncErr;
+	if (ncErr = nc_put_vara_long(ncID, varIDs["Age"], dataStart, dataCount, &batch.age[0])) return ncErr;
+	if (ncErr = nc_put_vara_short(ncID, varIDs["Status_Codes"], dataStart, dataCount, &batch.status_codes[0])) return ncErr;
+	return nc_put_vara_long(ncID, varIDs["ID"], dataStart, dataCount, &batch.id[0]);
+}
+
+static void WriteBatchInBackground(void *arg)
+{
+	NetCDFBatchFile *file = (NetCDFBatchFile*)arg;
+
+	file->writeErr = WriteBatch(file->ncID, file->varIDs, file->writing);
+}
+
+static OSErr WaitForBatch(NetCDFBatchFile *file)
+{
+	int ncErr;
+
+	file->thread.Join();
+	ncErr = file->writeErr;
+	file->writeErr = NC_NOERR;
+	file->writing.Clear();
+	return NetCDFStore::CheckNC(ncErr);
+}
+
+// starts writing the pending steps, after the ones being written
+static OSErr StartBatch(NetCDFBatchFile *file)
+{
+	OSErr err = WaitForBatch(file);
+
+	if (err || file->pending.time.empty()) return err;
+
+	file->writing.swap(file->pending);
+	if (!file->thread.Start(WriteBatchInBackground, file))
+	{	// no thread, it's written here
+		WriteBatchInBackground(file);
+		err = WaitForBatch(file);
+	}
+	return err;
+}
+
+static void DisposeBatchFile(int ncID)
+{
+	map<int, NetCDFBatchFile*>::iterator it = sBatchFiles.find(ncID);
+
+	if (it == sBatchFiles.end()) return;
+	it->second->thread.Join();
+	delete it->second;
+	sBatchFiles.erase(it);
+}
+
 NetCDFStore::NetCDFStore() {
 
     this->time = NULL;
@@ -207,12 +329,14 @@ OSErr NetCDFStore::Capture(TModel* model, bool uncertain, map<string, int> *ncVa
 
 OSErr NetCDFStore::Create(char *path, bool overwrite, int* ncID) {
 
-    int ncErr;
+    int ncErr, mode = overwrite ? NC_CLOBBER : NC_NOCLOBBER;
+	GnomeLock lock(GnomeFileIOMutex());
 
-    if(overwrite)
-        ncErr = nc_create(path, NC_CLOBBER, ncID);
-    else
-        ncErr = nc_create(path, NC_NOCLOBBER, ncID);
+	if(sNetCDF4)
+		mode |= NC_NETCDF4;
+    ncErr = nc_create(path, mode, ncID);
+	if(ncErr == NC_NOERR)
+		DisposeBatchFile(*ncID);	// a file that was never closed had this ID
 
     return CheckNC(ncErr);
 }
@@ -222,6 +346,7 @@ OSErr NetCDFStore::Define(TModel* model, bool uncertain, map<string, int> *ncVar
 	Seconds seconds;
 	OSErr err = 0;
 	char currentTimeStr[256], startTimeStr[256], timeStr[256];
+	GnomeLock lock(GnomeFileIOMutex());
 
 	//if(!model->IsUncertain() && uncertain)
 		//return true;
@@ -329,6 +454,21 @@ OSErr NetCDFStore::Define(TModel* model, bool uncertain, map<string, int> *ncVar
     varIDs = tVariables;
     char *tStr;
 
+	if(sNetCDF4) {
+		// the data variables are written a batch of steps at a time, their chunks hold many LEs
+		const char *dataNames[] = {"Longitude", "Latitude", "Depth", "Mass", "Age", "Status_Codes", "ID"};
+		size_t chunkSize = sChunkSize;
+
+		for(int k = 0; k < 7; k++) {
+			ncErr = nc_def_var_chunking(ncID, (*ncVarIDs)[dataNames[k]], NC_CHUNKED, &chunkSize);
+			err = CheckNC(ncErr); {if (err) return err;}
+			if(sDeflateLevel > 0) {
+				ncErr = nc_def_var_deflate(ncID, (*ncVarIDs)[dataNames[k]], 1, 1, sDeflateLevel);
+				err = CheckNC(ncErr); {if (err) return err;}
+			}
+		}
+	}
+
 // ++ Global Attributes: 
 
 	GetDateTime(&seconds);
@@ -530,6 +670,7 @@ OSErr NetCDFStore::Open(char* path, int* ncID) {
 // Opens strictly for read access.
 
     int ncErr;
+	GnomeLock lock(GnomeFileIOMutex());
     ncErr = nc_open(path, NC_WRITE, ncID);
     return CheckNC(ncErr);
 }
@@ -543,140 +684,88 @@ OSErr NetCDFStore::Read() {
 //bool NetCDFStore::Write(TModel* model, bool threeMovement, bool uncertain) {
 OSErr NetCDFStore::Write(TModel* model, bool uncertain) {
 
-    short /**cFlag,*/ *cStatus;
-	int ncID, ncErr = 0;
-    long j, *cID, tID, timeStep, *cAge/*, *cStatus*/;
-    float *cLon, *cLat, *cDepth, *cMass;
-    static map<string, int> lastCoord_M = map<string, int>();
-	static map<string, int> lastCoord_C = map<string, int>();
-	map<string, int> *lastCoord;
+	int ncID;
+	NetCDFBatchFile *file;
+	NetCDFBatch *batch;
 	OSErr err = 0;
 	
-	if(!uncertain)
-		lastCoord = &lastCoord_M;
-	else
-		lastCoord = &lastCoord_C;
     //timeStep = model->currentStep;
 	if(!uncertain)
 		ncID = model->ncID;
 	else
 		ncID = model->ncID_C;
 
+	if(sBatchFiles.find(ncID) == sBatchFiles.end())
+		sBatchFiles[ncID] = new NetCDFBatchFile(ncID, *this->ncVarIDs);
+	file = sBatchFiles[ncID];
+
     // Check coordinates.. - maybe pass in a isFirstStep to avoid the need for model
-    if((*lastCoord).size() == 0 || model->ncSnapshot || (!model->bHindcast && model->modelTime == model->GetStartTime()) || (model->bHindcast && model->modelTime == model->GetEndTime())) {
-        (*lastCoord)["Time"] = 0;
-        (*lastCoord)["Particle_Count"] = 0;
-        (*lastCoord)["Longitude"] = 0;
-        (*lastCoord)["Latitude"] = 0;
-		(*lastCoord)["Depth"] = 0;
-        (*lastCoord)["Mass"] = 0;
-        (*lastCoord)["Age"] = 0;
-        //(*lastCoord)["Flag"] = 0;
-        (*lastCoord)["Status_Codes"] = 0;
-        (*lastCoord)["ID"] = 0;
-    }	
-             // Time: 
-    tID = (*this->ncVarIDs)["Time"];
-    {
-        const size_t tCoord[] = {(*lastCoord)["Time"]};
-        ncErr = nc_put_var1_double(ncID, tID, tCoord, &this->time);
-        (*lastCoord)["Time"]+= 1;
+    if(model->ncSnapshot || (!model->bHindcast && model->modelTime == model->GetStartTime()) || (model->bHindcast && model->modelTime == model->GetEndTime())) {
+		err = Flush(ncID); {if (err) return err;}
+		file->timeCoord = 0;
+		file->dataCoord = 0;
     }
-    err = CheckNC(ncErr); {if (err) return err;} // handle error.
 
-             // Particle Count:
-    tID = (*this->ncVarIDs)["Particle_Count"];
-    {
-        const size_t tCoord[] = {(*lastCoord)["Particle_Count"]};
-        ncErr = nc_put_var1_long(ncID, tID, tCoord, &this->pCount);
-        (*lastCoord)["Particle_Count"]+= 1;
-    }
-    err = CheckNC(ncErr); {if (err) return err;} // handle error.
-    
-            // Longitudes:
-    tID = (*this->ncVarIDs)["Longitude"];
-    for(cLon = this->lon, j = 0;  ncErr == NC_NOERR && j < this->pCount; j++, cLon++) {
-        const size_t tCoord[] = {(*lastCoord)["Longitude"]+j};
-        ncErr = nc_put_var1_float(ncID, tID, tCoord, cLon);
-    }
-    (*lastCoord)["Longitude"] += j;
-    err = CheckNC(ncErr); {if (err) return err;} // handle error.
+	batch = &file->pending;
+	if(batch->time.empty()) {
+		batch->timeStart = file->timeCoord;
+		batch->dataStart = file->dataCoord;
+	}
+	try {
+		batch->time.push_back(this->time);
+		batch->pCount.push_back(this->pCount);
+		batch->lon.insert(batch->lon.end(), this->lon, this->lon + this->pCount);
+		batch->lat.insert(batch->lat.end(), this->lat, this->lat + this->pCount);
+		batch->depth.insert(batch->depth.end(), this->depth, this->depth + this->pCount);
+		batch->mass.insert(batch->mass.end(), this->mass, this->mass + this->pCount);
+		batch->age.insert(batch->age.end(), this->age, this->age + this->pCount);
+		batch->status_codes.insert(batch->status_codes.end(), this->status_codes, this->status_codes + this->pCount);
+		batch->id.insert(batch->id.end(), this->id, this->id + this->pCount);
+	}
+	catch(std::bad_alloc) {
+		return CheckNC(NC_ENOMEM);
+	}
+	file->timeCoord += 1;
+	file->dataCoord += this->pCount;
 
-            // Latitudes:
-    tID = (*this->ncVarIDs)["Latitude"];
-    for(cLat = this->lat, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cLat++) {
-        const size_t tCoord[] = {(*lastCoord)["Latitude"]+j};
-        ncErr = nc_put_var1_float(ncID, tID, tCoord, cLat);
-    }
-    (*lastCoord)["Latitude"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;} // handle error.
-    
-    //if(threeMovement) {
-                // Depths:
-        tID = (*this->ncVarIDs)["Depth"];
-        for(cDepth = this->depth, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cDepth++) {
-            const size_t tCoord[] = {(*lastCoord)["Depth"]+j};
-            ncErr = nc_put_var1_float(ncID, tID, tCoord, cDepth);
-        }
-        (*lastCoord)["Depth"]+=j;
-		err = CheckNC(ncErr); {if (err) return err;}
-    //}
+	if(batch->time.size() >= kNetCDFBatchSteps || batch->lon.size() >= kNetCDFBatchValues)
+		err = StartBatch(file);
 
-            // Mass:
-    tID = (*this->ncVarIDs)["Mass"];
-    for(cMass = this->mass, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cMass++) {
-        const size_t tCoord[] = {(*lastCoord)["Mass"]+j};
-        ncErr = nc_put_var1_float(ncID, tID, tCoord, cMass);
-    }
-    (*lastCoord)["Mass"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;}
+    return err;
+}
 
-            // Age:
-    tID = (*this->ncVarIDs)["Age"];
-    for(cAge = this->age, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cAge++) {
-        const size_t tCoord[] = {(*lastCoord)["Age"]+j};
-        ncErr = nc_put_var1_long(ncID, tID, tCoord, cAge);
-    }
-    (*lastCoord)["Age"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;}
-        
-            // Flags:
-    /*tID = (*this->ncVarIDs)["Flag"];
-    for(cFlag = this->flag, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cFlag++) {
-        const size_t tCoord[] = {(*lastCoord)["Flag"]+j};
-		ncErr = nc_put_var1_short(ncID, tID, tCoord, cFlag);
-    }
-    (*lastCoord)["Flag"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;}
-*/
-             // Status_Codes:
-    tID = (*this->ncVarIDs)["Status_Codes"];
-    for(cStatus = this->status_codes, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cStatus++) {
-        const size_t tCoord[] = {(*lastCoord)["Status_Codes"]+j};
-		//ncErr = nc_put_var1_long(ncID, tID, tCoord, cStatus);
-		ncErr = nc_put_var1_short(ncID, tID, tCoord, cStatus);
-    }
-    (*lastCoord)["Status_Codes"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;}
+void NetCDFStore::SetOutputOptions(bool netCDF4, int deflateLevel, long chunkSize) {
 
-           // ID:
-    tID = (*this->ncVarIDs)["ID"];
-    for(cID = this->id, j = 0; ncErr == NC_NOERR && j < this->pCount; j++, cID++) {
-        const size_t tCoord[] = {(*lastCoord)["ID"]+j};
-        ncErr = nc_put_var1_long(ncID, tID, tCoord, cID);
-    }
-    (*lastCoord)["ID"]+=j;
-    err = CheckNC(ncErr); {if (err) return err;}
+	sNetCDF4 = netCDF4;
+	sDeflateLevel = deflateLevel < 0 ? 0 : (deflateLevel > 9 ? 9 : deflateLevel);
+	if(chunkSize > 0)
+		sChunkSize = chunkSize;
+}
 
-    return err;
+OSErr NetCDFStore::Flush(int ncID) {
+
+	map<int, NetCDFBatchFile*>::iterator it = sBatchFiles.find(ncID);
+	OSErr err, waitErr;
+
+	if(it == sBatchFiles.end())
+		return 0;
+	err = StartBatch(it->second);
+	waitErr = WaitForBatch(it->second);
+	return err ? err : waitErr;
 }
 
 OSErr NetCDFStore::fClose(int ncID) {
 
     int ncErr;
+	OSErr err = Flush(ncID), closeErr;
 
-    ncErr = nc_close(ncID);
-    return CheckNC(ncErr);
+	DisposeBatchFile(ncID);
+	{
+		GnomeLock lock(GnomeFileIOMutex());
+		ncErr = nc_close(ncID);
+	}
+	closeErr = CheckNC(ncErr);
+    return err ? err : closeErr;
 }
 
 
@@ -34,6 +34,11 @@ class NetCDFStore // Houses stepwise run information for NetCDF output (and inpu
         static OSErr fClose(int ncID);
         static OSErr Open(char* inFile, int* ncID);
         static OSErr CheckNC(int ncErr);
+		// NetCDF-4 files (the default is the classic format), their data variables in
+		// chunks of chunkSize values, deflated at deflateLevel (1 to 9, 0 is not at all)
+        static void SetOutputOptions(bool netCDF4, int deflateLevel, long chunkSize);
+		// writes the steps Write has batched for the file, and waits for them
+        static OSErr Flush(int ncID);
 			   OSErr Write(TModel* model, bool uncertain);
                OSErr Read();
 };
@@ -9,6 +9,7 @@
 #include "GridCurMover.h"
 #include "GridWndMover.h"
 #include "Outils.h"
+#include "TimeInterval.h"
 #include "DagTreeIO.h"
 #include "PtCurMover.h"
 
@@ -196,7 +197,7 @@ Boolean NetCDFWindMover::CheckInterval(long &timeDataInterval, const Seconds& mo
 {
 	Seconds time = model_time, startTime, endTime;	
 	
-	long i,numTimes,numFiles = GetNumFiles();
+	long numTimes,numFiles = GetNumFiles();
 	
 	
 	numTimes = this -> GetNumTimesInFile(); 
@@ -228,15 +229,9 @@ Boolean NetCDFWindMover::CheckInterval(long &timeDataInterval, const Seconds& mo
 		else fOverLap = false;
 	}
 	
-	//for (i=0;i<numTimes;i++) 
-	for (i=0;i<numTimes-1;i++) 
-	{	// find the time interval
-		if (time>=((*fTimeHdl)[i] + fTimeShift) && time<=((*fTimeHdl)[i+1] + fTimeShift))
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(ShiftedTimes(fTimeHdl, fTimeShift), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<((*fTimeHdl)[0] + fTimeShift)) 
 	{
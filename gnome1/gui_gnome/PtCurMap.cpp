@@ -1,6 +1,8 @@
 
 #include "Cross.h"
 #include "MapUtils.h"
+#include "BoundarySegIndex.h"
+#include "TriMassAccumulator.h"
 #include "GenDefs.h"
 #include "GridVel.h"
 #include "NetCDFMover.h"
@@ -536,6 +538,7 @@ PtCurMap::PtCurMap(char* name, WorldRect bounds) : TMap(name, bounds)
 	fBoundarySegmentsH = 0;
 	fBoundaryTypeH = 0;
 	fBoundaryPointsH = 0;
+	fSegIndex = 0;
 	fSegSelectedH = 0;
 	fSelectedBeachHdl = 0;	//not sure if both are needed
 	fSelectedBeachFlagHdl = 0;
@@ -569,6 +572,7 @@ PtCurMap::PtCurMap(char* name, WorldRect bounds) : TMap(name, bounds)
 	fDiagnosticStrType = 0;
 	
 	fTriAreaArray = 0;
+	fTriMass[0] = fTriMass[1] = 0;
 	fDepthSliceArray = 0;
 
 	bUseSmoothing = false;
@@ -602,6 +606,11 @@ void PtCurMap::Dispose()
 		fBoundaryPointsH = 0;
 	}
 	
+	if (fSegIndex) {
+		delete fSegIndex;
+		fSegIndex = 0;
+	}
+	
 	if (fSegSelectedH) {
 		DisposeHandle((Handle)fSegSelectedH);
 		fSegSelectedH = 0;
@@ -638,6 +647,8 @@ void PtCurMap::Dispose()
 #endif
 	
 	if (fTriAreaArray) {delete [] fTriAreaArray; fTriAreaArray=0;}
+	if (fTriMass[0]) {delete fTriMass[0]; fTriMass[0] = 0;}
+	if (fTriMass[1]) {delete fTriMass[1]; fTriMass[1] = 0;}
 	if (fDepthSliceArray) {delete [] fDepthSliceArray; fDepthSliceArray=0;}
 	TMap::Dispose();
 }
@@ -3152,15 +3163,12 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 	Rect leRect, beachedRect, floatingRect;
 	float beachedWidthInPoints = 3, floatingWidthInPoints = 2; // a point = 1/72 of an inch
 	float pixelsPerPoint = PixelsPerPoint();
-	short offset, massunits;
+	short offset;
 	Point pt;
 	Boolean offQuickDrawPlane = false, bShowContours, bThereIsSubsurfaceOil = false;
 	RGBColor saveColor, *onLandColor, *inWaterColor;
-	LONGH numLEsInTri = 0;
-	DOUBLEH massInTriInGrams = 0;
-	double density, LEmass, massInGrams, halfLife;
-	TopologyHdl topH = 0;
-	TDagTree *dagTree = 0;
+	const long *numLEsInTri = 0;
+	const double *massInTriInGrams = 0;
 	TTriGridVel3D* triGrid = GetGrid3D(true);	
 	char countStr[64];
 	long count=0;
@@ -3181,18 +3189,6 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 	offset = _max(1,(beachedWidthInPoints*pixelsPerPoint)/2);
 	MySetRect(&beachedRect,-offset,-offset,offset,offset);
 
-	dagTree = triGrid -> GetDagTree();
-	if(!dagTree)	return;
-	topH = dagTree->GetTopologyHdl();
-	if(!topH)	return;
-	numTri = _GetHandleSize((Handle)topH)/sizeof(**topH);
-	numLEsInTri = (LONGH)_NewHandleClear(sizeof(long)*numTri);
-	if (!numLEsInTri)
-		{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); goto done; }
-	massInTriInGrams = (DOUBLEH)_NewHandleClear(sizeof(double)*numTri);
-	if (!massInTriInGrams)
-		{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); goto done; }
-	
 	numLESets = model->LESetsList->GetItemCount();
 	for (i = 0; i < numLESets; i++)
 	{
@@ -3201,32 +3197,21 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 			continue;	// don't draw uncertainty for now...
 		if (!thisLEList->IsActive()) continue;
 		numOfLEs = thisLEList->numOfLEs;
-		// density set from API
-		//density =  GetPollutantDensity(thisLEList->GetOilType());	
-		density = (((TOLEList*)thisLEList)->fSetSummary).density;	
-		halfLife = (*(dynamic_cast<TOLEList*>(thisLEList))).fSetSummary.halfLife;
-		massunits = thisLEList->GetMassUnits();
 
 		// time has already been updated at this point
 		bShowContours = (*(TOLEList*)thisLEList).fDispersantData.bDisperseOil && model->GetModelTime() - model->GetStartTime() - model->GetTimeStep() >= (*(TOLEList*)thisLEList).fDispersantData.timeToDisperse;
-		// code goes here, should total LEs from all spills..., numLEsInTri as a permanent field, maybe should calculate during Step()
 		bShowContours = bShowContours || (*(TOLEList*)thisLEList).fAdiosDataH;
 		bShowContours = bShowContours || (*(TOLEList*)thisLEList).fSetSummary.z > 0;
 		if (bShowContours) 
 		{
 			bThereIsSubsurfaceOil = true;
+			// the LEs are counted in their triangles by CountLEsInTriangles, here they're only drawn
+			if (fDiagnosticStrType==SUBSURFACEPARTICLES)
 			for (j = 0 ; j < numOfLEs ; j++) {
-				LongPoint lp;
-				long triIndex;
 				thisLEList -> GetLE (j, &LE);
 				//if (LE.statusCode == OILSTAT_NOTRELEASED) continue;
 				//if (LE.statusCode == OILSTAT_EVAPORATED) continue;	// shouldn't happen, temporary for dissolved chemicals 
 				if (!(LE.statusCode == OILSTAT_INWATER)) continue;// Windows compiler requires extra parentheses
-				lp.h = LE.p.pLong;
-				lp.v = LE.p.pLat;
-				// will want to calculate individual LE mass for chemicals where particles will dissolve over time
-				LEmass = GetLEMass(LE,halfLife);	// will only vary for chemical with different release end time
-				massInGrams = VolumeMassToGrams(LEmass, density, massunits);	// need to do this above too
 				if (fContourDepth1==BOTTOMINDEX)
 				{
 					double depthAtLE = DepthAtPoint(LE.p);	
@@ -3234,13 +3219,6 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 					//if (LE.z > (depthAtLE-1.) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map
 					if (LE.z > (depthAtLE-fBottomRange) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map
 					{
-						triIndex = dagTree -> WhatTriAmIIn(lp);
-						//if (triIndex>=0) (*numLEsInTri)[triIndex]++;
-						if (triIndex>=0)  
-						{
-							(*numLEsInTri)[triIndex]++;
-							(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-						}
 						if (fDiagnosticStrType==SUBSURFACEPARTICLES)
 						{
 							pt = GetQuickDrawPt(LE.p.pLong,LE.p.pLat,&r,&offQuickDrawPlane);
@@ -3258,13 +3236,6 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 				}
 				else if (LE.z>fContourDepth1 && LE.z<=fContourDepth2) 
 				{
-					triIndex = dagTree -> WhatTriAmIIn(lp);
-					//if (triIndex>=0) (*numLEsInTri)[triIndex]++;
-					if (triIndex>=0) 
-					{
-						(*numLEsInTri)[triIndex]++;
-						(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-					}
 					if (fDiagnosticStrType==SUBSURFACEPARTICLES)
 					{
 						pt = GetQuickDrawPt(LE.p.pLong,LE.p.pLat,&r,&offQuickDrawPlane);
@@ -3337,6 +3308,13 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 	
 	}
 	
+	if (!(fDiagnosticStrType==SUBSURFACEPARTICLES))
+	{
+		if (CountLEsInTriangles(true, model->GetTimeStep(), true, &numLEsInTri, &massInTriInGrams, &bThereIsSubsurfaceOil))
+			goto done;	// no dagtree to find the LEs' triangles
+		numTri = triGrid -> GetNumTriangles();
+	}
+	
 	if (bThereIsSubsurfaceOil && !(fDiagnosticStrType==SUBSURFACEPARTICLES))	// draw LEs in a given layer
 	//if (bShowContours && !(fDiagnosticStrType==SUBSURFACEPARTICLES))	// draw LEs in a given layer
 	{
@@ -3405,12 +3383,12 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 			//if (depthAtPt < fContourDepth2 && depthAtPt > fContourDepth1 && depthAtPt != 0) depthRange = depthAtPt - fContourDepth1;
 			triVol = triArea * depthRange; // code goes here, check this depth range is ok at all vertices
 			//triVol = triArea * (fContourDepth2 - fContourDepth1); // code goes here, check this depth range is ok at all vertices
-			numLEsInTriangle = (*numLEsInTri)[i];
+			numLEsInTriangle = numLEsInTri[i];
 
 			if (!(fContourDepth1==BOTTOMINDEX))		// need to decide what to do for bottom contour
 				if (triGrid->CalculateDepthSliceVolume(&triVol,i,fContourDepth1,fContourDepth2)) goto done;
 
-			oilDensityInWaterColumn = (*massInTriInGrams)[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
+			oilDensityInWaterColumn = massInTriInGrams[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
 
 			//if (prevMax > 0 && prevMax < oilDensityInWaterColumn)	// change this to check global max, at each run reset to -1?
 				//oilDensityInWaterColumn = prevMax;
@@ -3533,8 +3511,6 @@ void PtCurMap::DrawContours(Rect r, WorldRect view)
 	
 done:
 	RGBForeColor(&saveColor);
-	if(numLEsInTri) {DisposeHandle((Handle)numLEsInTri); numLEsInTri=0;}
-	if(massInTriInGrams) {DisposeHandle((Handle)massInTriInGrams); massInTriInGrams=0;}
 	return;
 }
 
@@ -3972,11 +3948,10 @@ int ConcentrationCompare(void const *x1, void const *x2)
 // might want to track each spill separately and combined
 void PtCurMap::TrackOutputData(void)
 {	// need all LELists
-	long i, j, numOfLEs, numLESets, numTri;
-	LERec LE;
+	long i, j, numLESets, numTri;
 	Boolean bShowContours, bTimeZero, bTimeToOutputData = false, bThereIsSubsurfaceOil = false;
-	LONGH numLEsInTri = 0;
-	DOUBLEH massInTriInGrams = 0;
+	const long *numLEsInTri = 0;
+	const double *massInTriInGrams = 0;
 	TopologyHdl topH = 0;
 	TDagTree *dagTree = 0;
 	DOUBLEH /*concentrationH = 0,*/ dosageHdl = 0;
@@ -3984,8 +3959,8 @@ void PtCurMap::TrackOutputData(void)
 	TTriGridVel3D* triGrid = GetGrid3D(true);	
 	Seconds modelTime = model->GetModelTime(),timeStep = model->GetTimeStep();
 	Seconds startTime = model->GetStartTime();
-	short oldIndex, nowIndex, massunits;
-	double depthAtPt, density, LEmass, massInGrams, halfLife;
+	short oldIndex, nowIndex;
+	double depthAtPt;
 	TLEList *thisLEList = 0;
 	
 	if (!triGrid) return; // some error alert, no depth info to check
@@ -3997,12 +3972,6 @@ void PtCurMap::TrackOutputData(void)
 	topH = dagTree->GetTopologyHdl();
 	if(!topH)	return;
 	numTri = _GetHandleSize((Handle)topH)/sizeof(**topH);
-	numLEsInTri = (LONGH)_NewHandleClear(sizeof(long)*numTri);
-	if (!numLEsInTri)
-		{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); goto done; }
-	massInTriInGrams = (DOUBLEH)_NewHandleClear(sizeof(double)*numTri);
-	if (!massInTriInGrams)
-		{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); goto done; }
 	//concentrationH = (DOUBLEH)_NewHandleClear(sizeof(double)*numTri);
 	concentrationH = (ConcTriNumPairH)_NewHandleClear(sizeof(ConcTriNumPair)*numTri);
 	if (!concentrationH)
@@ -4020,12 +3989,6 @@ void PtCurMap::TrackOutputData(void)
 		if (thisLEList->fLeType == UNCERTAINTY_LE)	
 			continue;	// don't draw uncertainty for now...
 		if (!thisLEList->IsActive()) continue;
-		numOfLEs = thisLEList->numOfLEs;
-		// density set from API
-		//density =  GetPollutantDensity(thisLEList->GetOilType());	
-		density = ((TOLEList*)thisLEList)->fSetSummary.density;	
-		halfLife = (*(dynamic_cast<TOLEList*>(thisLEList))).fSetSummary.halfLife;
-		massunits = thisLEList->GetMassUnits();
 
 		if (bTimeToOutputData)	// track budget at the same time
 		{	// make budget table even if spill is not dispersed
@@ -4071,43 +4034,10 @@ void PtCurMap::TrackOutputData(void)
 		DisplayMessage("NEXTMESSAGETEMP");
 		DisplayMessage(msg); 
 	}*/
-		if (!bShowContours) continue;	// no need to track in this case
-		// total LEs from all spills..., numLEsInTri as a permanent field, maybe should calculate during Step()
-		for (j = 0 ; j < numOfLEs ; j++) {
-			LongPoint lp;
-			long triIndex;
-			thisLEList -> GetLE (j, &LE);
-			//if (LE.statusCode == OILSTAT_NOTRELEASED) continue;
-			//if (LE.statusCode == OILSTAT_EVAPORATED) continue;	// shouldn't happen, temporary for dissolved chemicals 
-			if (!(LE.statusCode == OILSTAT_INWATER)) continue;	// Windows compiler requires extra parentheses
-			lp.h = LE.p.pLong;
-			lp.v = LE.p.pLat;
-			LEmass = GetLEMass(LE,halfLife);	// will only vary for chemical with different release end time
-			massInGrams = VolumeMassToGrams(LEmass, density, massunits);	// need to do this above too
-			if (fContourDepth1==BOTTOMINDEX)
-			{
-				double depthAtLE = DepthAtPoint(LE.p);
-				//if (LE.z > (depthAtLE-1.) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map, careful with 2 grids...
-				if (LE.z > (depthAtLE-fBottomRange) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map, careful with 2 grids...
-				{
-					triIndex = dagTree -> WhatTriAmIIn(lp);
-					if (triIndex>=0)  
-					{
-						(*numLEsInTri)[triIndex]++;
-						(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-					}
-				}
-			}
-			else if (LE.z>fContourDepth1 && LE.z<=fContourDepth2) 
-			{
-				triIndex = dagTree -> WhatTriAmIIn(lp);
-				if (triIndex>=0) 
-				{
-					(*numLEsInTri)[triIndex]++;
-					(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-				}
-			}
-		}
+	}
+	if (bThereIsSubsurfaceOil)
+	{	// the LEs of the lists tracked, in the contour layer
+		if (CountLEsInTriangles(true, 0, true, &numLEsInTri, &massInTriInGrams, 0)) goto done;
 	}
 	if (triGrid->bCalculateDosage)
 	{
@@ -4154,13 +4084,13 @@ void PtCurMap::TrackOutputData(void)
 			//if (depthAtPt < fContourDepth2 && depthAtPt > fContourDepth1 && depthAtPt != 0) depthRange = depthAtPt - fContourDepth1;
 			triVol = triArea * depthRange; // code goes here, check this depth range is ok at all vertices
 			//triVol = triArea * (fContourDepth2 - fContourDepth1); // code goes here, check this depth range is ok at all vertices
-			numLEsInTriangle = (*numLEsInTri)[i];
+			numLEsInTriangle = numLEsInTri[i];
 			if (numLEsInTriangle==0)
 				continue;
 
 			if (!(fContourDepth1==BOTTOMINDEX))		// need to decide what to do for bottom contour
 				if (triGrid->CalculateDepthSliceVolume(&triVol,i,fContourDepth1,fContourDepth2)) goto done;
-			oilDensityInWaterColumn = (*massInTriInGrams)[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
+			oilDensityInWaterColumn = massInTriInGrams[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
 
 			//(*concentrationH)[numTrisWithOil] = oilDensityInWaterColumn;
 			(*concentrationH)[numTrisWithOil].conc = oilDensityInWaterColumn;
@@ -4175,7 +4105,7 @@ void PtCurMap::TrackOutputData(void)
 					fTriAreaArray[j] = fTriAreaArray[j] + triArea/1000000;
 					totalLEs += numLEsInTriangle;
 					//totalMass += massInGrams;
-					totalMass += (*massInTriInGrams)[i];
+					totalMass += massInTriInGrams[i];
 					totalVol += triVol;
 					concInSelectedTriangles += oilDensityInWaterColumn;	// sum or track each one?
 					if (oilDensityInWaterColumn > maxConc) 
@@ -4226,8 +4156,6 @@ void PtCurMap::TrackOutputData(void)
 	}
 	
 done:
-	if(numLEsInTri) {DisposeHandle((Handle)numLEsInTri); numLEsInTri=0;}
-	if(massInTriInGrams) {DisposeHandle((Handle)massInTriInGrams); massInTriInGrams=0;}
 	if(concentrationH) {DisposeHandle((Handle)concentrationH); concentrationH=0;}
 	return;
 }
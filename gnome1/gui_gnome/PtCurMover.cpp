@@ -6,6 +6,7 @@
 #include "DagTreeIO.h"
 #include "GridVel.h"
 #include "my_build_list.h"
+#include "TimeSliceLoader.h"
 
 
 #ifdef MAC
@@ -254,6 +255,7 @@ PtCurMover::PtCurMover (TMap *owner, char *name) : TCurrentMover(owner, name)
 	fDepthsH = 0;
 	fDepthDataInfo = 0;
 	fInputFilesHdl = 0;	// for multiple files case
+	fSliceLoader = 0;
 	
 	SetClassName (name); // short file name
 }
@@ -268,6 +270,12 @@ OSErr PtCurMover::InitMover()
 
 void PtCurMover::Dispose ()
 {
+	if (fSliceLoader)
+	{
+		delete fSliceLoader;	// waits for its prefetch, which reads the grid
+		fSliceLoader = nil;
+	}
+	
 	if (fGrid)
 	{
 		fGrid -> Dispose();
@@ -2190,8 +2198,8 @@ done:
 	return err;
 }
 
-//WorldPoint3D PtCurMover::GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
-WorldPoint3D PtCurMover::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+//WorldPoint3D PtCurMover::GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D PtCurMover::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {0,0,0.};
 	WorldPoint refPoint = (*theLE).p;	
@@ -29,7 +29,7 @@ class PtCurMover : virtual public PtCurMover_c,  public TCurrentMover
 		virtual ClassID 	GetClassID () { return TYPE_PTCURMOVER; }
 		virtual Boolean	IAm(ClassID id) { if(id==TYPE_PTCURMOVER) return TRUE; return TCurrentMover::IAm(id); }
 
-		virtual WorldPoint3D	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+		virtual WorldPoint3D	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
 		VelocityRec			GetMove3D(InterpolationVal interpolationVal,float depth);
 		virtual Boolean 	VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
 
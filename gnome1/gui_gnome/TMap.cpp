@@ -623,7 +623,7 @@ void TMap::Draw(Rect r, WorldRect view)
 	
 	// for large bnas with time dependent currents showing, drawing is very slow
 	// if more than one map on top of each other don't want movers all on top map
-	if (model->DrawingDependsOnTime() && model->GetMapCount()==1)
+	if (model->DrawingDependsOnTime() && model->GetMapCount()<=1)
 		return;
 	// draw each of the movers
 	for (i = 0, n = moverList->GetItemCount() ; i < n ; i++) {
@@ -8,6 +8,10 @@
 //#include "shapefil.h"
 
 #include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #ifdef MAC
@@ -98,6 +102,7 @@ TModel::TModel(Seconds start)
 	weatherList = nil;
 	LEFramesList = nil;
 	mapImage = nil;
+	fMapImageUse = 0;
 	frameMapList = nil;
 	movieFrameIndex = 0;
 	modelMode = ADVANCEDMODE;
@@ -126,6 +131,13 @@ TModel::TModel(Seconds start)
 	weatheringOpen = TRUE;
 	
 	fMaxDuration = 3.*24;	// 3 days
+	bUseCounterRandom = false;
+	fRandomSeed = 1;
+#ifdef _OPENMP
+	fNumMoveThreads = omp_get_num_procs();
+#else
+	fNumMoveThreads = 1;
+#endif
 						
 	// JLM found this comment but no does not believe it, 11/15/99
 	// IT MUST ALWAYS START OUT TRUE TO ENSURE 
@@ -332,15 +344,75 @@ void TModel::Dispose()
 		LEFramesList = nil;
 	}
 	
-	if (mapImage)
+	DisposeMapImages ();
+}
+
+void TModel::DisposeMapImages ()
+{
+	long i, n;
+	
+	for (i = 0, n = fMapImages.size(); i < n; i++)
 	{
 		#ifdef MAC
-			KillGWorld (mapImage);
+			KillGWorld (fMapImages[i].image);
 		#else 
-			DestroyDIB(mapImage);
+			DestroyDIB(fMapImages[i].image);
 		#endif
-		mapImage = nil;
 	}
+	fMapImages.clear();
+	mapImage = nil;
+}
+
+Boolean TModel::FindMapImage (WorldRect view, Rect r)
+// sets mapImage to the image of the view drawn in r, if there is one
+{
+	long i, n;
+	
+	for (i = 0, n = fMapImages.size(); i < n; i++)
+	{
+		MapImageRec *rec = &fMapImages[i];
+		if (rec->view.loLong == view.loLong && rec->view.hiLong == view.hiLong && 
+			rec->view.loLat == view.loLat && rec->view.hiLat == view.hiLat && !(rec->r != r))
+		{
+			rec->lastUse = ++fMapImageUse;
+			mapImage = rec->image;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TModel::AddMapImage (WorldRect view, Rect r)
+// keeps mapImage as the image of the view, in place of the one there was or the least recently used
+{
+	long i, n, replace = -1;
+	MapImageRec rec;
+	
+	for (i = 0, n = fMapImages.size(); i < n; i++)
+	{
+		if (fMapImages[i].image == mapImage) return;
+		if (fMapImages[i].view.loLong == view.loLong && fMapImages[i].view.hiLong == view.hiLong && 
+			fMapImages[i].view.loLat == view.loLat && fMapImages[i].view.hiLat == view.hiLat && !(fMapImages[i].r != r))
+			{ replace = i; break; }
+		if (n >= kMaxMapImages && (replace < 0 || fMapImages[i].lastUse < fMapImages[replace].lastUse))
+			replace = i;
+	}
+	
+	rec.image = mapImage;
+	rec.view = view;
+	rec.r = r;
+	rec.lastUse = ++fMapImageUse;
+	if (replace < 0)
+	{
+		fMapImages.push_back(rec);
+		return;
+	}
+	#ifdef MAC
+		KillGWorld (fMapImages[replace].image);
+	#else 
+		DestroyDIB(fMapImages[replace].image);
+	#endif
+	fMapImages[replace] = rec;
 }
 		
 
@@ -385,6 +457,7 @@ void TModel::DisposeLEFrames ()
 			LEFramesList -> DeleteItem (i);
 		}
 	}
+	fLEFrameCache.Clear();
 
 }
 
@@ -5293,6 +5366,129 @@ OSErr TModel::check_spills(vector<WorldPoint3D> *delta, vector <LERec *> *pmappi
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
+// the shio tides of the mover's time values follow the daylight savings setting, Step sets it before each move
+static void SetMoverDaylightSavings(TMover *thisMover)
+{
+	TOSSMTimeValue *time_val_ptr = 0;
+
+	switch(thisMover->GetClassID()) {
+		case TYPE_CATSMOVER:
+			time_val_ptr = ((TCATSMover*)thisMover)->timeDep;
+			break;
+		case TYPE_TIDECURCYCLEMOVER:
+			time_val_ptr = ((TideCurCycleMover*)thisMover)->timeDep;
+			break;
+		case TYPE_CURRENTCYCLEMOVER:
+			time_val_ptr = ((CurrentCycleMover*)thisMover)->timeDep;
+			break;
+		default:
+			break;
+	}
+	if(time_val_ptr && time_val_ptr->GetClassID() == TYPE_SHIOTIMEVALUES)
+		dynamic_cast<TShioTimeValue*>(time_val_ptr)->daylight_savings_off = settings.daylightSavingsTimeFlag;
+}
+
+// true if the active movers of the list can all move LEs of leType in parallel, their time values set up for the step
+static Boolean MoversCanMoveInParallel(CMyList *moverList, LETYPE leType)
+{
+	TMover *thisMover;
+
+	for (long k = 0, d = moverList -> GetItemCount (); k < d; k++)
+	{
+		moverList -> GetListItem ((Ptr) &thisMover, k);
+		if (!thisMover -> IsActive ()) continue;
+		if (!thisMover -> CanMoveInParallel(leType)) return false;
+	}
+	for (long k = 0, d = moverList -> GetItemCount (); k < d; k++)
+	{
+		moverList -> GetListItem ((Ptr) &thisMover, k);
+		if (thisMover -> IsActive ()) SetMoverDaylightSavings(thisMover);
+	}
+	return true;
+}
+
+// adds the moves of the list's movers to movedPoint in Step's order, false when a mover flags the LE dry
+static Boolean AddMoverMoves(CMyList *moverList, Seconds modelTime, Seconds timeStep, short listIndex, long leIndex, LERec *thisLE, LETYPE leType, WorldPoint3D *movedPoint)
+{
+	TMover *thisMover;
+	WorldPoint3D thisMove;
+
+	for (long k = 0, d = moverList -> GetItemCount (); k < d; k++)
+	{
+		moverList -> GetListItem ((Ptr) &thisMover, k);
+		if (!thisMover -> IsActive ()) continue;
+		thisMove = thisMover -> GetMove (modelTime,timeStep,listIndex,leIndex,thisLE,leType);
+		if (thisLE -> leCustomData == -1) return false;
+		movedPoint -> p.pLat  += thisMove.p.pLat;
+		movedPoint -> p.pLong += thisMove.p.pLong;
+		movedPoint -> z += thisMove.z;
+	}
+	return true;
+}
+
+// The movers' moves of the list's LEs in water at the start of the step, on fNumMoveThreads
+// threads, for Step to use instead of calling the movers LE by LE. Only the LEs whose movers,
+// in the universal map and their best map, can all move in parallel are computed, the others
+// (and any LE Step refloats) are left to Step. moves is empty when nothing was computed.
+// The moves are those of Step: the same movers in the same order, on a copy of the LE.
+void TModel::ComputeParallelMoves(TLEList *list, short listIndex, LETYPE leType, vector<ParallelMoveRec> &moves)
+{
+	long j, c = list -> numOfLEs;
+	LERec thisLE;
+	TMap *bestMap;
+	vector<TMap*> parallelMaps, serialMaps;
+	vector<long> toMove;
+	vector<TMap*> toMoveMaps;
+
+	moves.clear();
+	if (fNumMoveThreads <= 1 || c <= 1) return;
+	if (!MoversCanMoveInParallel(uMap -> moverList, leType)) return;
+
+	moves.resize(c);
+	for (j = 0; j < c; j++)
+	{
+		moves[j].computed = false;
+		list -> GetLE (j, &thisLE);
+		thisLE.leCustomData = 0;
+		if (thisLE.statusCode != OILSTAT_INWATER) continue;
+
+		bestMap = GetBestMap (thisLE.p);
+		if (!bestMap) continue;
+		if (find(serialMaps.begin(), serialMaps.end(), bestMap) != serialMaps.end()) continue;
+		if (find(parallelMaps.begin(), parallelMaps.end(), bestMap) == parallelMaps.end())
+		{
+			if (!MoversCanMoveInParallel(bestMap -> moverList, leType))
+			{
+				serialMaps.push_back(bestMap);
+				continue;
+			}
+			parallelMaps.push_back(bestMap);
+		}
+
+		moves[j].le = thisLE;
+		moves[j].movedPoint.p = thisLE.p;
+		moves[j].movedPoint.z = thisLE.z;
+		toMove.push_back(j);
+		toMoveMaps.push_back(bestMap);
+	}
+
+	long numToMove = toMove.size();
+	Seconds timeStep = fDialogVariables.computeTimeStep;
+	CMyList *uMoverList = uMap -> moverList;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumMoveThreads) if(numToMove > 1)
+#endif
+	for (long m = 0; m < numToMove; m++)
+	{
+		ParallelMoveRec *move = &moves[toMove[m]];
+
+		move -> dry = !AddMoverMoves(uMoverList, modelTime, timeStep, listIndex, toMove[m], &move -> le, leType, &move -> movedPoint)
+					|| !AddMoverMoves(toMoveMaps[m] -> moverList, modelTime, timeStep, listIndex, toMove[m], &move -> le, leType, &move -> movedPoint);
+		move -> computed = true;
+	}
+}
+
 OSErr TModel::Step ()
 {
 	long		i, j, k, c, d, n;
@@ -5437,7 +5633,11 @@ OSErr TModel::Step ()
 	}
 	/////////////////////////////////////////////////
 	
-	if (err = this -> TellMoversPrepareForStep()) goto ResetPort;
+	{	// the movers read netCDF files, NetCDFStore may be writing its output on another thread
+		GnomeLock fileLock(GnomeFileIOMutex());
+		err = this -> TellMoversPrepareForStep();
+	}
+	if (err) goto ResetPort;
 	
 	ReleaseLEs(); // release new LE's if their time has come
 	
@@ -5468,8 +5668,10 @@ OSErr TModel::Step ()
 		else listIndex = 0;	// note this is not used for forecast LEs - maybe put in a flag to identify that
 
 		SetChemicalHalfLife(((TOLEList *)thisLEList)->fSetSummary.halfLife);	// each spill can have a half life
-		UpdateWindage(thisLEList);
+		UpdateWindage(thisLEList, fNumMoveThreads);
 		DispersionRec dispInfo = ((TOLEList *)thisLEList) -> GetDispersionInfo();
+		DisperseStepRec disperseStep;	// prepared when the first LE is dispersed
+		Boolean disperseStepPrepared = false;
 		//Seconds disperseTime = model->GetStartTime() + dispInfo.timeToDisperse;
 		Seconds disperseTime = ((TOLEList*)thisLEList) ->fSetSummary.startRelTime + dispInfo.timeToDisperse;
 		// for natural dispersion should start at spill start time, last until
@@ -5482,6 +5684,8 @@ OSErr TModel::Step ()
 		//if (dispInfo.timeToDisperse < model->GetTimeStep() && modelTime == model->GetStartTime()+model->GetTimeStep()) timeToDisperse = true;	// make sure don't skip over dispersing if time step is large
 		if (dispInfo.timeToDisperse < model->GetTimeStep() && modelTime == ((TOLEList*)thisLEList) ->fSetSummary.startRelTime+model->GetTimeStep()) timeToDisperse = true;	// make sure don't skip over dispersing if time step is large
 		//}
+		vector<ParallelMoveRec> parallelMoves;
+		ComputeParallelMoves(thisLEList, listIndex, leType, parallelMoves);
 		for (j = 0, c = thisLEList -> numOfLEs; j < c; j++)
 		{
 			thisLEList -> GetLE (j, &thisLE);
@@ -5520,6 +5724,14 @@ OSErr TModel::Step ()
 	
 				movedPoint.p = thisLE.p; //JLM 10/8/98, moved line here because we need to do this assignment after we re-float it
 				movedPoint.z = thisLE.z; 
+
+				if (!parallelMoves.empty() && parallelMoves[j].computed)
+				{	// moved by ComputeParallelMoves
+					thisLE = parallelMoves[j].le;
+					if (parallelMoves[j].dry) goto WeatherLE;
+					movedPoint = parallelMoves[j].movedPoint;
+					goto MovedByMovers;
+				}
 				//currentMovedPoint.p = thisLE.p; 
 				//currentMovedPoint.z = thisLE.z; 
 				
@@ -5665,6 +5877,7 @@ OSErr TModel::Step ()
 						}
 					//}
 				}
+			MovedByMovers:
 				// Add contributions from all movers together
 				//movedPoint.p.pLat  += currentMovedPoint.p.pLat - thisLE.p.pLat;	// original point counted twice
 				//movedPoint.p.pLong += currentMovedPoint.p.pLong - thisLE.p.pLong; // original point counted twice
@@ -5844,9 +6057,12 @@ OSErr TModel::Step ()
 				{	// by dispersing here it's possible to miss some LEs that have already beached at the first step
 					if (thisLE.statusCode == OILSTAT_INWATER)
 					{
-					thisLEList -> SetLE (j, &thisLE);
-					DisperseOil (thisLEList, j);
-					thisLEList -> GetLE (j, &thisLE); // JLM 9/16/98 , we have to refresh the local variable thisLE
+					if (!disperseStepPrepared)
+					{
+						PrepareDisperseOil(thisLEList, &disperseStep);
+						disperseStepPrepared = true;
+					}
+					DisperseLE(&disperseStep, j, &thisLE);
 					//thisLE.leCustomData = 1;	// for now use this so TRandom3D knows when to add z component
 					}
 				}
@@ -5915,6 +6131,7 @@ OSErr TModel::Step ()
 	delete[] dmapping;
 	delete[] imapping;*/
 	
+	LEList_c::LEsChanged();	// the LE status counts of the budget table are from this step's LEs
 	{	// totals LEs from all spills
 		PtCurMap *map = GetPtCurMap();
 		//if (map && (dispInfo.bDisperseOil || adiosBudgetTable))
@@ -5926,6 +6143,7 @@ OSErr TModel::Step ()
 	}
 
 	this -> TellMoversStepIsDone();
+	LEList_c::LEsChanged();
 		
 	
 	oldTime = modelTime;
@@ -6094,7 +6312,11 @@ OSErr TModel::StepBackwards ()
 	}
 	/////////////////////////////////////////////////
 	
-	if (err = this -> TellMoversPrepareForStep()) goto ResetPort;
+	{	// the movers read netCDF files, NetCDFStore may be writing its output on another thread
+		GnomeLock fileLock(GnomeFileIOMutex());
+		err = this -> TellMoversPrepareForStep();
+	}
+	if (err) goto ResetPort;
 	
 	ReleaseLEs(); // release new LE's if their time has come
 	
@@ -6126,7 +6348,7 @@ OSErr TModel::StepBackwards ()
 		if(!thisLEList->IsActive()) continue;
 
 		SetChemicalHalfLife(((TOLEList *)thisLEList)->fSetSummary.halfLife);	// each spill can have a half life
-		UpdateWindage(thisLEList);
+		UpdateWindage(thisLEList, fNumMoveThreads);
 		//DispersionRec dispInfo = ((TOLEList *)thisLEList) -> GetDispersionInfo();
 		//Seconds disperseTime = model->GetStartTime() + dispInfo.timeToDisperse;
 		//Seconds disperseTime = ((TOLEList*)thisLEList) ->fSetSummary.startRelTime + dispInfo.timeToDisperse;
@@ -6477,6 +6699,7 @@ OSErr TModel::StepBackwards ()
 	}
 
 	this -> TellMoversStepIsDone();
+	LEList_c::LEsChanged();
 		
 	
 	oldTime = modelTime;
@@ -9181,6 +9404,8 @@ void TModel::NewDirtNotification (void)
 void TModel::NewDirtNotification (long flags)
 { // calling this function informs the model that something is dirty
 	
+	LEList_c::LEsChanged();	// it may be the LEs, edited outside a step
+
 	if(sSuppressDirtFlags)
 	{
 		flags = flags & ~(sSuppressDirtFlags); // note ~ is equivalent to BitNot on the mac
@@ -9587,6 +9812,7 @@ OSErr TModel::Reset()
 		LESetsList->GetListItem((Ptr)&thisLEList, i);
 		if (err = thisLEList->Reset(FALSE)) return err;
 	}
+	LEList_c::LEsChanged();
 		
 	DisposeLEFrames ();			// STH
 	
@@ -11461,7 +11687,7 @@ void DrawCombinedImage(void * object,WorldRect wRect,Rect r)
 	// problem is if multiple maps on top of each other all movers will show on top map, big bnas can slow down drawing a lot though
 	// 
 	// draw each of the maps (in reverse order to show priority)	
-	if (model->DrawingDependsOnTime() && model->GetMapCount()==1)	
+	if (model->DrawingDependsOnTime() && model->GetMapCount()<=1)	
 	{
 		for (n = theModel -> mapList->GetItemCount() - 1; n >= 0 ; n--) {
 			theModel -> mapList->GetListItem((Ptr)&map, n);
@@ -11615,28 +11841,27 @@ void TModel::Draw(Rect r, WorldRect view)
 
 	if(r.right <= r.left || r.bottom <= r.top) return; // JLM 2/5/99 , nothing to draw
 	
-	makeNewMapImage =  !sharedPrinting && (mapImage == nil || HasFrameMapListChanged() || r != mapImageRect);
+	if (HasFrameMapListChanged())
+		DisposeMapImages ();	// the images are of the old maps
+	
+	makeNewMapImage =  !sharedPrinting && (mapImage == nil || r != mapImageRect);
 	
 	//if(this -> DrawingDependsOnTime())	
-	if(this -> DrawingDependsOnTime() && (GetMapCount()>1 || GetMapCount()==0))	// universal map needs to be redrawn
+	// with one map (or only the universal map) the movers are drawn on top of the map image, see TMap::Draw
+	if(this -> DrawingDependsOnTime() && GetMapCount()>1)	// the movers have to be drawn between the maps
 		makeNewMapImage = true;
+	else if (makeNewMapImage && FindMapImage(view, r))	// a view drawn before, zoomed back to
+	{
+		mapImageRect = r;
+		makeNewMapImage = false;
+	}
 	
 	if (makeNewMapImage)
 	{
-		// delete previous map image if any
-		if(mapImage)
-		{
-			#ifdef MAC
-				KillGWorld (mapImage);
-			#else 
-				DestroyDIB(mapImage);
-			#endif
-			mapImage = nil;
-		}
-		
 		mapImage = GetColorImageDIB(DrawBaseMap,model,view,r,&err);
 		mapImageRect = r;	// save rect used to make map image
 		UpdateFrameMapList ();	// save the models map list for future comparison
+		if (mapImage) AddMapImage (view, r);	// in place of the view's old image, if any
 	}
 	
 	makeCombinedImage = !sharedPrinting && mapImage; // no need trying for a combined image if we couldn't make a mapImage 
@@ -11759,6 +11984,14 @@ OSErr TModel::SaveModelLEs (Seconds forTime, short fileNumber)
 
 	hdelete(0, 0, LEFileName);
 
+	// the frame is kept in memory if it fits, the file is for when it doesn't
+	if (SaveModelLEsToMemory (LEFramesList ? _min(fileNumber, LEFramesList -> GetItemCount ()) : fileNumber))
+	{
+		err = SetLEFrame (forTime, fileNumber, LEFileName);
+		if (err) printError("Error saving model splots to a file");
+		return err;
+	}
+
 	// get vRefNum for the file we will be creating
 	err = FreeBytesOnVolume(vRefNum, &freeBytes, LEFileName); // MAC uses vRefNum, IBM uses first part of LEFileName
 	if(err) {printNote("Error calculating free space on disk."); return err;}
@@ -11817,22 +12050,58 @@ OSErr TModel::SaveModelLEs (Seconds forTime, short fileNumber)
 		{ TechError("SaveModelLEs()", "FSOpenBuf()", err); return err; }
 
 	err = SaveModelLEs (&LEFile);
-	if (!err)
-	{
-		LEFrameRec	thisFrame;
+	if (!err) err = SetLEFrame (forTime, fileNumber, LEFileName);
+	
+	if (LEFile.f) FSCloseBuf(&LEFile);
+	
+	if (err) printError("Error saving model splots to a file");
+	return err;
+}
 
-		strcpy (thisFrame.frameLEFName, LEFileName);
-		thisFrame.frameTime = forTime;
+Boolean TModel::SaveModelLEsToMemory (long frameIndex)
+// false if the frame doesn't fit in the LE frame cache's memory
+{
+	long i, n, bufSize = 1000000; // the lists' other fields, with room to spare
+	TLEList *thisLEList;
+	Handle h;
+	BFPB memFile;
+	Boolean kept = false;
 
-		if (fileNumber >= LEFramesList -> GetItemCount ())
-			err = LEFramesList -> AppendItem ((Ptr) &thisFrame);
-		else
-			LEFramesList -> SetListItem ((Ptr) &thisFrame, fileNumber);
+	for (i = 0, n = LESetsList->GetItemCount() ; i < n ; i++) 
+	{
+		LESetsList->GetListItem((Ptr)&thisLEList, i);
+		h = (Handle) thisLEList -> LEHandle;
+		if(h) bufSize += 2 * _GetHandleSize(h);
 	}
+
+	if (!MemOpenBuf(&memFile, bufSize, 0, 0))
+	{
+		if (!SaveModelLEs (&memFile))
+		{
+			_HLock((Handle)memFile.buf);
+			kept = fLEFrameCache.Add(frameIndex, DEREFH(memFile.buf), memFile.fileLength);
+			_HUnlock((Handle)memFile.buf);
+		}
+		MemCloseBuf(&memFile);
+	}
+	if (!kept) fLEFrameCache.Remove(frameIndex); // the frame there was, if any, is out of date
 	
-	if (LEFile.f) FSCloseBuf(&LEFile);
+	return kept;
+}
+
+OSErr TModel::SetLEFrame (Seconds forTime, short fileNumber, char *LEFileName)
+{
+	LEFrameRec	thisFrame;
+	OSErr err = 0;
+
+	strcpy (thisFrame.frameLEFName, LEFileName);
+	thisFrame.frameTime = forTime;
+
+	if (fileNumber >= LEFramesList -> GetItemCount ())
+		err = LEFramesList -> AppendItem ((Ptr) &thisFrame);
+	else
+		LEFramesList -> SetListItem ((Ptr) &thisFrame, fileNumber);
 	
-	if (err) printError("Error saving model splots to a file");
 	return err;
 }
 
@@ -11943,6 +12212,8 @@ OSErr TModel::LoadModelLEs (Seconds forTime, Seconds *actualTime)
 	long		bestFrameIndex = -1, i, timeDiff,minTimeDiff = 300 * 24 * 3600;	// 300 days
 	LEFrameRec	thisFrame;
 	BFPB 		LEFile;
+	vector<char> frameData;
+	Boolean		inMemory;
 		
 	if (LEFramesList)
 	{
@@ -11961,7 +12232,11 @@ OSErr TModel::LoadModelLEs (Seconds forTime, Seconds *actualTime)
 	if (bestFrameIndex >= 0)
 	{
 		LEFramesList -> GetListItem ((Ptr) &thisFrame, bestFrameIndex);
-		err = FSOpenBuf(0, 0, thisFrame.frameLEFName, &LEFile, 100000, FALSE);
+		inMemory = fLEFrameCache.Get(bestFrameIndex, frameData);
+		if (inMemory)
+			err = MemOpenBuf(&LEFile, frameData.size(), frameData.empty() ? 0 : &frameData[0], frameData.size());
+		else
+			err = FSOpenBuf(0, 0, thisFrame.frameLEFName, &LEFile, 100000, FALSE);
 		if (!err)
 		{
 			err = LoadModelLEs (&LEFile);
@@ -11972,7 +12247,8 @@ OSErr TModel::LoadModelLEs (Seconds forTime, Seconds *actualTime)
 				*actualTime = thisFrame.frameTime;
 			}
 			
-			FSCloseBuf (&LEFile);
+			if (inMemory) MemCloseBuf (&LEFile);
+			else FSCloseBuf (&LEFile);
 		}
 	}
 
@@ -12,6 +12,7 @@
 
 #include "Model_c.h"
 #include "TClassID.h"
+#include "LEFrameCache.h"
 #include <vector>
 
 using std::vector;
@@ -20,17 +21,49 @@ using std::pair;
 class TOverlay;
 class TWeatherer;
 
+// the movers' move of an LE, worked out before Step's loop over the LEs
+typedef struct {
+	Boolean			computed;	// Step calls the movers itself if not
+	Boolean			dry;		// a mover flagged the LE dry (leCustomData -1)
+	LERec			le;			// the LE as the movers left it
+	WorldPoint3D	movedPoint;
+} ParallelMoveRec;
+
+// a base map image kept for a view, so going back to the view (zooming back out, say)
+// doesn't draw its land, grids and boundaries again
+typedef struct {
+#ifdef MAC
+	CGrafPtr		image;
+#else
+	HDIB			image;
+#endif
+	WorldRect		view;
+	Rect			r;
+	unsigned long	lastUse;
+} MapImageRec;
+
+#define kMaxMapImages 4
+
 class TModel : virtual public Model_c,  public TClassID
 {
 	
 public:
 	
+	// threads Step moves the LEs on, 1 is serial (needs OpenMP)
+	long fNumMoveThreads;
+
+	// the run bar's LE frames, in memory so the temp files are only for what doesn't fit
+	LEFrameCache fLEFrameCache;
+
 	// bitmap version of map at current view and window size without LEs or movement grid
 #ifdef MAC
 	CGrafPtr mapImage;		
 #else 		
 	HDIB	mapImage;		
 #endif
+	// the images of the views drawn lately, mapImage is one of them
+	vector<MapImageRec> fMapImages;
+	unsigned long fMapImageUse;
 	
 	TModel(Seconds start);
 	virtual		   ~TModel () { Dispose (); }
@@ -41,6 +74,9 @@ public:
 	
 	void			DisposeLEFrames ();
 	void			DisposeModelLEs ();
+	void			DisposeMapImages ();
+	Boolean			FindMapImage (WorldRect view, Rect r);
+	void			AddMapImage (WorldRect view, Rect r);
 	void			DisposeAllMoversOfType(ClassID desiredClassID);
 	
 	
@@ -179,6 +215,8 @@ private:
 	Seconds 			PreviousSavedModelLEsTime(Seconds givenTime);
 	OSErr				SaveModelLEs (Seconds forTime, short fileNumber);
 	OSErr				SaveModelLEs (BFPB *bfpb);
+	Boolean				SaveModelLEsToMemory (long frameIndex);
+	OSErr				SetLEFrame (Seconds forTime, short fileNumber, char *LEFileName);
 	OSErr				LoadModelLEs (char *LEFileName);
 	OSErr				LoadModelLEs (BFPB *bfpb);
 	OSErr				LoadModelLEs (Seconds forTime, Seconds *actualTime);
@@ -194,6 +232,10 @@ private:
 	OSErr				move_spills(vector<WorldPoint3D> **, vector<LERec *> **, vector< pair<bool, bool> > **, vector< pair<int, int> > **);
 	OSErr				check_spills(vector<WorldPoint3D> *, vector <LERec *> *, vector< pair<bool, bool> > *, vector< pair<int, int> > *);
 
+	void				SetNumMoveThreads(long numThreads) { fNumMoveThreads = numThreads > 0 ? numThreads : 1; }
+	long				GetNumMoveThreads() { return fNumMoveThreads; }
+	void				ComputeParallelMoves(TLEList *list, short listIndex, LETYPE leType, vector<ParallelMoveRec> &moves);
+
 };
 
 #endif
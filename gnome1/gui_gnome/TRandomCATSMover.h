@@ -31,12 +31,12 @@ class TRandom : public TMover
 		virtual ClassID 	GetClassID () { return TYPE_RANDOMMOVER; }
 		virtual Boolean		IAm(ClassID id) { if(id==TYPE_RANDOMMOVER) return TRUE; return TMover::IAm(id); }
 		
-		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); // AH 07/10/2012
+		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); // AH 07/10/2012
 		virtual OSErr 		PrepareForModelRun(); 
 	
 		virtual void 		ModelStepIsDone();
-		//virtual WorldPoint3D 	GetMove (const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
-		virtual WorldPoint3D 	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+		//virtual WorldPoint3D 	GetMove (const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
+		virtual WorldPoint3D 	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 		
 		// I/O methods
 		virtual OSErr 		Read (BFPB *bfpb);  // read from current position
@@ -94,13 +94,13 @@ class TRandomCATSMover : public TRandomMover
 		virtual Boolean 	OkToAddToUniversalMap();
 		virtual	OSErr 		ReplaceMover();
 		// other uncertainty functions?
-		virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+		virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 		
 		VelocityRec			GetPatValue (WorldPoint p);
 		VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
-		virtual WorldPoint3D	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+		virtual WorldPoint3D	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 		virtual OSErr 		PrepareForModelRun(); 
-		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList);
+		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList);
 	
 		virtual void 		ModelStepIsDone();
 
@@ -166,10 +166,10 @@ class TRandomGridMover : public TRandomMover
 		void 					ClearLoadedData(LoadedData * dataPtr);
 		
 		virtual OSErr 		PrepareForModelRun(); 
-		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList);
+		virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList);
 	
 		virtual void 		ModelStepIsDone();
-		virtual WorldPoint3D 	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+		virtual WorldPoint3D 	GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 
 		// I/O methods
 		virtual OSErr 		Read (BFPB *bfpb);  // read from current position
@@ -3,6 +3,7 @@
 #include "Classes.h"
 #include "ObjectUtilsPD.h"
 #include "GenDefs.h"
+#include "ShorelineIndex.h"
 
 /**************************************************************************************************/
 Boolean RemoveQuotes (char *stringPtr)
@@ -68,6 +69,7 @@ TVectorMap::TVectorMap (char* name, WorldRect bounds): TMap(name, bounds)
 	allowableSpillLayer = nil;
 	mapBoundsLayer = nil;
 	esiMapLayer = nil;
+	fESIIndex = nil;
 	map = nil;
 #ifdef MAC
 	memset(&fLandWaterBitmap,0,sizeof(fLandWaterBitmap)); //JLM
@@ -1168,6 +1170,12 @@ void TVectorMap::Dispose ()
 		esiMapLayer = nil;
 	}
 	
+	if (fESIIndex != nil)
+	{
+		delete fESIIndex;
+		fESIIndex = nil;
+	}
+	
 #ifdef MAC
 	DisposeBlackAndWhiteBitMap (&fLandWaterBitmap);
 	DisposeBlackAndWhiteBitMap (&fAllowableSpillBitmap);
@@ -4,6 +4,7 @@
 #include "DagTreeIO.h"
 #include "GridVel.h"
 #include "my_build_list.h"
+#include "TimeSliceLoader.h"
 #include "TriCurMover.h"
 
 #ifdef MAC
@@ -70,6 +71,7 @@ TriCurMover::TriCurMover (TMap *owner, char *name) : TCurrentMover(owner, name)
 	fDepthsH = 0;
 	fDepthDataInfo = 0;
 	//fInputFilesHdl = 0;	// for multiple files case
+	fSliceLoader = 0;
 	
 	bShowDepthContourLabels = false;
 	bShowDepthContours = false;
@@ -82,6 +84,12 @@ TriCurMover::TriCurMover (TMap *owner, char *name) : TCurrentMover(owner, name)
 
 void TriCurMover::Dispose ()
 {
+	if (fSliceLoader)
+	{
+		delete fSliceLoader;	// waits for its prefetch, which reads the grid
+		fSliceLoader = nil;
+	}
+	
 	if (fGrid)
 	{
 		fGrid -> Dispose();
@@ -10,6 +10,12 @@
 #include "ADCPMover_c.h"
 #include "CROSS.H"
 
+ADCPMover_c::ADCPMover_c () : CurrentMover_c()
+{
+	fBinValuesTime = 0;
+	bBinValuesSet = false;
+}
+
 OSErr ADCPMover_c::ComputeVelocityScale(const Seconds& model_time)
 {	// this function computes and sets this->refScale
 	// returns Error when the refScale is not defined
@@ -96,7 +102,7 @@ OSErr ADCPMover_c::ComputeVelocityScale(const Seconds& model_time)
 	return -1;
 }
 
-OSErr ADCPMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty)
+OSErr ADCPMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty)
 {
 	/// 5/12/99 only add the eddy uncertainty when told to
 	
@@ -177,7 +183,7 @@ OSErr ADCPMover_c::PrepareForModelRun()
 	return CurrentMover_c::PrepareForModelRun();
 }
 
-OSErr ADCPMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr ADCPMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	OSErr err =0;
 	if (err = CurrentMover_c::PrepareForModelStep(model_time, time_step, uncertain, numLESets, LESetsSizesList)) 
@@ -188,6 +194,27 @@ OSErr ADCPMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds&
 	this -> fOptimize.isOptimizedForStep = true;
 	this -> fOptimize.value = sqrt(6*(fEddyDiffusion/10000)/time_step); // in m/s, note: DIVIDED by timestep because this is later multiplied by the timestep
 	//this -> fOptimize.isFirstStep = (model_time == start_time);
+
+	// the stations' bin values are the same for every LE of the step, keep them
+	// as they are looked up
+	fBinValues.clear();
+	if (timeDepList)
+	{
+		long i;
+		ADCPTimeValue *thisTimeDep;
+		fBinValues.resize(timeDepList -> GetItemCount ());
+		for (i = 0; i < timeDepList -> GetItemCount (); i++)
+		{
+			timeDepList -> GetListItem ((Ptr) &thisTimeDep, i);
+			if (thisTimeDep && thisTimeDep->GetNumBins() > 0)
+			{
+				ADCPBinValue unset = {{0, 0}, false};
+				fBinValues[i].assign(thisTimeDep->GetNumBins(), unset);
+			}
+		}
+	}
+	fBinValuesTime = model -> GetModelTime();
+	bBinValuesSet = true;
 	
 	if (err) 
 		printError("An error occurred in ADCPMover::PrepareForModelStep");
@@ -199,10 +226,12 @@ void ADCPMover_c::ModelStepIsDone()
 	this -> fOptimize.isFirstStep = false;
 	memset(&fOptimize,0,sizeof(fOptimize));
 	bIsFirstStep = false;
+	bBinValuesSet = false;
+	fBinValues.clear();
 }
 
 
-WorldPoint3D ADCPMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D ADCPMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	Boolean useEddyUncertainty = false;	
 	double 		dLong, dLat;
@@ -266,6 +295,28 @@ VelocityRec ADCPMover_c::GetScaledPatValue(const Seconds& model_time, WorldPoint
 	return patVelocity;
 }
 
+// the station's value at the bin, from the step's values when they are for
+// that time. Only values read without an error are kept
+OSErr ADCPMover_c::GetBinValue(long station, ADCPTimeValue *timeDep, long depthIndex, Seconds time, VelocityRec *value)
+{
+	OSErr err = 0;
+	Boolean useCache = bBinValuesSet && time == fBinValuesTime && station >= 0 && station < (long)fBinValues.size()
+		&& depthIndex >= 0 && depthIndex < (long)fBinValues[station].size();
+	
+	if (useCache && fBinValues[station][depthIndex].set)
+	{
+		*value = fBinValues[station][depthIndex].value;
+		return 0;
+	}
+	err = timeDep->GetTimeValueAtDepth(depthIndex, time, value);
+	if (!err && useCache)
+	{
+		fBinValues[station][depthIndex].value = *value;
+		fBinValues[station][depthIndex].set = true;
+	}
+	return err;
+}
+
 VelocityRec ADCPMover_c::GetVelocityAtPoint(WorldPoint3D p)
 {	// change this to  take WorldPoint3D, no eddy
 	VelocityRec	patVelocity, timeValue = {0, 0}, topTimeValue = {0,0}, bottomTimeValue = {0,0};
@@ -326,10 +377,10 @@ VelocityRec ADCPMover_c::GetVelocityAtPoint(WorldPoint3D p)
 			//err = thisTimeDep -> GetTimeValue (model -> GetModelTime(), &timeValue); 
 			if (depthIndex1 != UNASSIGNEDINDEX)
 			{	
-				err = thisTimeDep->GetTimeValueAtDepth(depthIndex1, model->GetModelTime(), &topTimeValue);
+				err = GetBinValue(i, thisTimeDep, depthIndex1, model->GetModelTime(), &topTimeValue);
 				if (!err && depthIndex2 != UNASSIGNEDINDEX)	
 				{
-					err = thisTimeDep->GetTimeValueAtDepth(depthIndex2, model->GetModelTime(), &bottomTimeValue);
+					err = GetBinValue(i, thisTimeDep, depthIndex2, model->GetModelTime(), &bottomTimeValue);
 				}
 				if (!err)
 				{
@@ -43,6 +43,13 @@ typedef struct
 	double			fLeftCurUncertainty;	
 } ADCPDialogNonPtrFields;
 
+// a station's value at one bin for the step's time
+typedef struct
+{
+	VelocityRec		value;
+	Boolean			set;
+} ADCPBinValue;
+
 class ADCPMover_c :  virtual public CurrentMover_c {
 
 public:
@@ -67,12 +74,17 @@ public:
 	long			fBinToUse;
 	TCM_OPTIMZE fOptimize; // this does not need to be saved to the save file
 	CMyList		*timeDepList;
+	std::vector<std::vector<ADCPBinValue> >	fBinValues;	// by station and bin, for fBinValuesTime
+	Seconds			fBinValuesTime;
+	Boolean			bBinValuesSet;
+	
+					ADCPMover_c ();
 	
 	OSErr				AddTimeDep(ADCPTimeValue *theTimeDep, short where);
 	OSErr				DropTimeDep(ADCPTimeValue *theTimeDep);
 	ADCPTimeValue *		AddADCP(OSErr *err);
 	
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	void				SetRefPosition (WorldPoint p, long z) { refP = p; refZ = z; }
 	void				GetRefPosition (WorldPoint *p, long *z) { (*p) = refP; (*z) = refZ; }
 	
@@ -84,10 +96,11 @@ public:
 	VelocityRec			GetPatValue (WorldPoint p);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);
 	VelocityRec			GetVelocityAtPoint(WorldPoint3D p);
+	OSErr				GetBinValue(long station, ADCPTimeValue *timeDep, long depthIndex, Seconds time, VelocityRec *value);
 	OSErr       ComputeVelocityScale(const Seconds& model_time);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); // AH 07/10/2012
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); // AH 07/10/2012
 	virtual void 		ModelStepIsDone();
 	virtual Boolean		VelocityStrAtPoint(WorldPoint3D wp, char *velStr);
 
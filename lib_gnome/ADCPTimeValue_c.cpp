@@ -42,6 +42,69 @@ double ADCPTimeValue_c::GetBinDepth(long depthIndex)
 	return binDepth;
 }
 
+ADCPTimeValue_c::ADCPTimeValue_c()
+{
+	fCheckedBinDepthsH = 0;
+	fCheckedNumBins = 0;
+	fCheckedOrientation = 0;
+	bBinDepthsInOrder = false;
+}
+
+// the bin depths get deeper with the index for a downward looking sensor and
+// shallower for an upward looking one. Checked once per set of bins
+Boolean ADCPTimeValue_c::BinDepthsInOrder()
+{
+	long i;
+	
+	if (fCheckedBinDepthsH == fBinDepthsH && fCheckedNumBins == fNumBins && fCheckedOrientation == fSensorOrientation)
+		return bBinDepthsInOrder;
+	
+	bBinDepthsInOrder = fBinDepthsH && fNumBins >= 2 && (fSensorOrientation == 1 || fSensorOrientation == 2) &&
+		_GetHandleSize((Handle)fBinDepthsH) >= (long)(fNumBins * sizeof(double));
+	for (i = 1; bBinDepthsInOrder && i < fNumBins; i++)
+	{
+		if (fSensorOrientation == 2)
+			bBinDepthsInOrder = INDEXH(fBinDepthsH,i-1) < INDEXH(fBinDepthsH,i);
+		else
+			bBinDepthsInOrder = INDEXH(fBinDepthsH,i-1) > INDEXH(fBinDepthsH,i);
+	}
+	
+	fCheckedBinDepthsH = fBinDepthsH;
+	fCheckedNumBins = fNumBins;
+	fCheckedOrientation = fSensorOrientation;
+	return bBinDepthsInOrder;
+}
+
+// the pair of bins with depthAtPoint strictly between them, found by
+// bisection, for a depthAtPoint below the top bin. Returns false when the
+// bins are out of order or there is no such pair, and the scan decides
+Boolean ADCPTimeValue_c::BisectBins(float depthAtPoint, long *depthIndex1, long *depthIndex2)
+{
+	long lo = 0, hi = fNumBins - 1, mid;
+	Boolean downward = (fSensorOrientation == 2);
+	
+	if (!BinDepthsInOrder()) return false;
+	
+	// k counts the bins from the top
+#define BIN_DEPTH(k) INDEXH(fBinDepthsH, downward ? (k) : fNumBins - 1 - (k))
+	while (hi - lo > 1)
+	{
+		mid = (lo + hi) / 2;
+		if (BIN_DEPTH(mid) < depthAtPoint)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	hi = lo + 1;
+	if (!(depthAtPoint > BIN_DEPTH(lo) && depthAtPoint < BIN_DEPTH(hi)))
+		return false;
+#undef BIN_DEPTH
+	
+	*depthIndex1 = downward ? lo : fNumBins - 1 - lo;
+	*depthIndex2 = downward ? hi : fNumBins - 1 - hi;
+	return true;
+}
+
 OSErr ADCPTimeValue_c::GetDepthIndices(float depthAtPoint, float totalDepth, long *depthIndex1, long *depthIndex2)
 {
 	long i;
@@ -62,6 +125,8 @@ OSErr ADCPTimeValue_c::GetDepthIndices(float depthAtPoint, float totalDepth, lon
 			*depthIndex2 = UNASSIGNEDINDEX;
 			return err;
 		}
+		if (BisectBins(depthAtPoint, depthIndex1, depthIndex2))
+			return err;
 		for (i=0;i<fNumBins-1;i++)
 		{
 			if (depthAtPoint > INDEXH(fBinDepthsH,i) && depthAtPoint < INDEXH(fBinDepthsH,i+1))
@@ -86,6 +151,8 @@ OSErr ADCPTimeValue_c::GetDepthIndices(float depthAtPoint, float totalDepth, lon
 			*depthIndex2 = UNASSIGNEDINDEX;
 			return err;
 		}
+		if (BisectBins(depthAtPoint, depthIndex1, depthIndex2))
+			return err;
 		for (i=fNumBins-1;i>0;i--)
 		{
 			if (depthAtPoint > INDEXH(fBinDepthsH,i) && depthAtPoint < INDEXH(fBinDepthsH,i-1))
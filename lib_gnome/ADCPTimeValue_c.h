@@ -33,6 +33,12 @@ public:
 	Boolean					bStationPositionOpen;
 	Boolean					bStationDataOpen;
 	DOUBLEH					fBinDepthsH;
+	DOUBLEH					fCheckedBinDepthsH;	// the bins BinDepthsInOrder looked at
+	long					fCheckedNumBins;
+	short					fCheckedOrientation;
+	Boolean					bBinDepthsInOrder;
+	
+							ADCPTimeValue_c();
 	
 	virtual void 			GetTimeFileName (char *theName) { strcpy (theName, fileName); }
 	virtual void 			SetTimeFileName (char *theName) { strcpy (fileName, theName); }
@@ -53,6 +59,8 @@ public:
 	virtual OSErr			CheckStartTime (Seconds time);
 	virtual void			RescaleTimeValues (double oldScaleFactor, double newScaleFactor);
 	OSErr					GetDepthIndices(float depthAtPoint, float totalDepth, long *depthIndex1, long *depthIndex2);
+	Boolean					BinDepthsInOrder();
+	Boolean					BisectBins(float depthAtPoint, long *depthIndex1, long *depthIndex2);
 	virtual long			GetNumValues ();
 	virtual TimeValuePairH3D	GetTimeValueHandle () { return timeValues; }
 	virtual void			SetTimeValueHandle (TimeValuePairH3D t) ;	
@@ -0,0 +1,229 @@
+/*
+ *  BoundarySegIndex.cpp
+ *  gnome
+ *
+ *  A segment is only in range of a point when the point is in the
+ *  segment's box widened by dLong, dLat (DistFromWPointToSegment returns -1
+ *  otherwise), so the segments of the point's bucket are all the segments
+ *  the full loop would have measured. They are kept in boundary order so
+ *  ties go to the same segment as in the loop.
+ *
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "BoundarySegIndex.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+float DistFromWPointToSegment(long pLong, long pLat, long long1, long lat1, 
+							  long long2, long lat2, long dLong, long dLat);
+
+BoundarySegIndex::BoundarySegIndex()
+{
+	fBoundarySegsH = 0;
+	fBoundaryPtsH = 0;
+	fPtsH = 0;
+	fNumSegs = fNumPts = 0;
+	fDLong = fDLat = 0;
+	fLeft = fBottom = fRight = fTop = 0;
+	fBucketWidth = fBucketHeight = 1;
+	fNumRows = fNumCols = 0;
+}
+
+void BoundarySegIndex::Dispose()
+{
+	fBoundarySegsH = 0;
+	fBoundaryPtsH = 0;
+	fPtsH = 0;
+	fNumSegs = fNumPts = 0;
+	fNumRows = fNumCols = 0;
+	fEndPt.clear();
+	fBoundary.clear();
+	fBucketStart.clear();
+	fBucketSegs.clear();
+}
+
+void BoundarySegIndex::GetBucket(long h, long v, long *col, long *row)
+{
+	long c = (long)((h - fLeft) / fBucketWidth);
+	long r = (long)((v - fBottom) / fBucketHeight);
+
+	*col = c < 0 ? 0 : (c >= fNumCols ? fNumCols - 1 : c);
+	*row = r < 0 ? 0 : (r >= fNumRows ? fNumRows - 1 : r);
+}
+
+LongPoint BoundarySegIndex::GetSegPoint(long segNo)
+{
+	return (*fPtsH)[fBoundaryPtsH ? (*fBoundaryPtsH)[segNo] : segNo];
+}
+
+OSErr BoundarySegIndex::Build(LONGH boundarySegsH, LONGH boundaryPtsH, LongPointHdl ptsH, long dLong, long dLat, long segsPerBucket)
+{
+	long numSegs, numBndPts, numPts, jseg, segNo, firstPoint, lastPoint, r, c;
+	long minCol, maxCol, minRow, maxRow;
+	double numBuckets, aspect;
+	vector<long> fill;
+
+	Dispose();
+
+	if (!boundarySegsH || !ptsH)
+		return -1;
+
+	numSegs = _GetHandleSize((Handle)boundarySegsH)/sizeof(long);
+	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
+	if (numSegs <= 0 || numPts <= 0)
+		return -1;
+
+	numBndPts = (*boundarySegsH)[numSegs - 1] + 1;
+	if (numBndPts <= 0)
+		return -1;
+	if (boundaryPtsH) {
+		if ((long)(_GetHandleSize((Handle)boundaryPtsH)/sizeof(long)) < numBndPts)
+			return -1;
+		for (segNo = 0; segNo < numBndPts; segNo++)
+			if ((*boundaryPtsH)[segNo] < 0 || (*boundaryPtsH)[segNo] >= numPts)
+				return -1;
+	}
+	else if (numBndPts > numPts)
+		return -1;
+
+	fBoundarySegsH = boundarySegsH;
+	fBoundaryPtsH = boundaryPtsH;
+	fPtsH = ptsH;
+	fNumSegs = numSegs;
+	fNumPts = numPts;
+	fDLong = dLong;
+	fDLat = dLat;
+
+	// the segments: segNo runs over all the boundary points, and each joins
+	// the next point of its boundary, the last one closing the boundary
+	fEndPt.resize(numBndPts);
+	fBoundary.resize(numBndPts);
+	for (jseg = 0; jseg < numSegs; jseg++) {
+		firstPoint = jseg == 0? 0: (*boundarySegsH)[jseg-1] + 1;
+		lastPoint = (*boundarySegsH)[jseg]+1;
+		for (segNo = firstPoint; segNo < lastPoint; segNo++) {
+			fEndPt[segNo] = (segNo == lastPoint-1) ? firstPoint : segNo+1;
+			fBoundary[segNo] = jseg;
+		}
+	}
+
+	fLeft = fRight = GetSegPoint(0).h;
+	fBottom = fTop = GetSegPoint(0).v;
+	for (segNo = 1; segNo < numBndPts; segNo++) {
+		LongPoint p = GetSegPoint(segNo);
+		fLeft = _min(fLeft, p.h);
+		fRight = _max(fRight, p.h);
+		fBottom = _min(fBottom, p.v);
+		fTop = _max(fTop, p.v);
+	}
+	fLeft -= dLong;
+	fRight += dLong;
+	fBottom -= dLat;
+	fTop += dLat;
+
+	// about segsPerBucket segments per bucket, with roughly square buckets
+	if (segsPerBucket < 1) segsPerBucket = 1;
+	numBuckets = (double)numBndPts / segsPerBucket;
+	aspect = (fRight > fLeft && fTop > fBottom) ? (double)(fRight - fLeft) / (fTop - fBottom) : 1.;
+	fNumCols = (long)ceil(sqrt(numBuckets * aspect));
+	fNumCols = _max(1, fNumCols);
+	fNumRows = (long)ceil(numBuckets / fNumCols);
+	fNumRows = _max(1, fNumRows);
+	fBucketWidth = _max(1., (double)(fRight - fLeft) / fNumCols + 1e-9);
+	fBucketHeight = _max(1., (double)(fTop - fBottom) / fNumRows + 1e-9);
+
+	// count, then fill, each segment going in every bucket its widened box touches
+	fBucketStart.assign(fNumRows * fNumCols + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			for (c = 0; c < fNumRows * fNumCols; c++)
+				fBucketStart[c + 1] += fBucketStart[c];
+			fBucketSegs.resize(fBucketStart[fNumRows * fNumCols]);
+			fill.assign(fBucketStart.begin(), fBucketStart.end() - 1);
+		}
+		for (segNo = 0; segNo < numBndPts; segNo++) {
+			LongPoint p1 = GetSegPoint(segNo);
+			LongPoint p2 = GetSegPoint(fEndPt[segNo]);
+
+			GetBucket(_min(p1.h, p2.h) - dLong, _min(p1.v, p2.v) - dLat, &minCol, &minRow);
+			GetBucket(_max(p1.h, p2.h) + dLong, _max(p1.v, p2.v) + dLat, &maxCol, &maxRow);
+			for (r = minRow; r <= maxRow; r++) {
+				for (c = minCol; c <= maxCol; c++) {
+					if (pass == 0)
+						fBucketStart[r * fNumCols + c + 1]++;
+					else
+						fBucketSegs[fill[r * fNumCols + c]++] = segNo;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+OSErr BoundarySegIndex::Prepare(LONGH boundarySegsH, LONGH boundaryPtsH, LongPointHdl ptsH, long dLong, long dLat)
+{
+	// rebuilt when the boundary or the points are replaced or resized
+	if (fNumRows > 0 && boundarySegsH == fBoundarySegsH && boundaryPtsH == fBoundaryPtsH && ptsH == fPtsH &&
+		dLong == fDLong && dLat == fDLat &&
+		(long)(_GetHandleSize((Handle)boundarySegsH)/sizeof(long)) == fNumSegs &&
+		(long)(_GetHandleSize((Handle)ptsH)/sizeof(LongPoint)) == fNumPts)
+		return 0;
+
+	return Build(boundarySegsH, boundaryPtsH, ptsH, dLong, dLat);
+}
+
+long BoundarySegIndex::PointOnWhichSeg(long longVal, long latVal, long *startver, long *endver, float *distToSeg)
+{
+	long col, row, b, i, segNo, endPt, closestSeg = -1;
+	float dist, smallestDist = 100.;
+
+	*distToSeg = -1;
+
+	if (fNumRows <= 0 || longVal < fLeft || longVal > fRight || latVal < fBottom || latVal > fTop)
+		return -1;
+
+	GetBucket(longVal, latVal, &col, &row);
+	b = row * fNumCols + col;
+
+	for (i = fBucketStart[b]; i < fBucketStart[b + 1]; i++) {
+		segNo = fBucketSegs[i];
+		endPt = fEndPt[segNo];
+		LongPoint p1 = GetSegPoint(segNo);
+		LongPoint p2 = GetSegPoint(endPt);
+
+		dist = DistFromWPointToSegment(longVal, latVal, p1.h, p1.v, p2.h, p2.v, fDLong, fDLat);
+		if (dist==-1) continue;	// not within range
+
+		if (dist<smallestDist)
+		{
+			smallestDist = dist;
+			*startver = segNo;
+			*endver = endPt;
+			closestSeg = fBoundary[segNo];
+			*distToSeg = smallestDist;
+		}
+	}
+
+	return closestSeg;
+}
+
+long BoundarySegIndex::PointOnWhichBoundary(LONGH boundarySegsH, long point)
+{
+	long numSegs, *first, *last, *seg;
+
+	if (!boundarySegsH)
+		return -1;
+
+	// the boundaries' last points are in order, so the first one at or after point
+	numSegs = _GetHandleSize((Handle)boundarySegsH)/sizeof(long);
+	first = *boundarySegsH;
+	last = first + numSegs;
+	seg = std::lower_bound(first, last, point);
+
+	return seg == last ? -1 : seg - first;
+}
@@ -0,0 +1,61 @@
+/*
+ *  BoundarySegIndex.h
+ *  gnome
+ *
+ *  Uniform grid of buckets over a map's boundary, each bucket lists the
+ *  boundary segments whose bounding box, widened by the search distance,
+ *  touches it. Lets PointOnWhichSeg test the few segments near a point
+ *  instead of every segment of every boundary.
+ *
+ */
+
+#ifndef __BoundarySegIndex__
+#define __BoundarySegIndex__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+class BoundarySegIndex
+{
+	public:
+						BoundarySegIndex();
+						~BoundarySegIndex() {Dispose();}
+		void			Dispose();
+
+		// the handles are not copied, they must outlive the index
+		// boundaryPtsH is nil when the boundary points are the first points of ptsH
+		OSErr			Build(LONGH boundarySegsH, LONGH boundaryPtsH, LongPointHdl ptsH, long dLong, long dLat, long segsPerBucket = 2);
+
+		// builds the index unless it is already built for these handles and distances
+		OSErr			Prepare(LONGH boundarySegsH, LONGH boundaryPtsH, LongPointHdl ptsH, long dLong, long dLat);
+
+		// the closest segment within dLong, dLat of the point, like the maps'
+		// PointOnWhichSeg loop over all of them: the same segment, boundary and distance
+		long			PointOnWhichSeg(long longVal, long latVal, long *startver, long *endver, float *distToSeg);
+
+		// the boundary that boundary point is on, -1 if none
+		static long		PointOnWhichBoundary(LONGH boundarySegsH, long point);
+
+		long			GetNumBuckets() {return fNumRows * fNumCols;}
+
+	private:
+		LONGH				fBoundarySegsH;
+		LONGH				fBoundaryPtsH;
+		LongPointHdl		fPtsH;
+		long				fNumSegs, fNumPts;
+		long				fDLong, fDLat;
+		long				fLeft, fBottom, fRight, fTop;
+		double				fBucketWidth, fBucketHeight;
+		long				fNumRows, fNumCols;
+		std::vector<long>	fEndPt;			// the other end of boundary segment segNo
+		std::vector<long>	fBoundary;		// the boundary of segment segNo
+		std::vector<long>	fBucketStart;	// bucket b's segments are fBucketSegs[fBucketStart[b], fBucketStart[b+1]), in boundary order
+		std::vector<long>	fBucketSegs;
+
+		void			GetBucket(long h, long v, long *col, long *row);
+		LongPoint		GetSegPoint(long segNo);
+};
+
+#endif
@@ -99,7 +99,7 @@
  return -1;
  }
  
- OSErr CATSMover3D_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty)
+ OSErr CATSMover3D_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty)
  {
  /// 5/12/99 only add the eddy uncertainty when told to
  
@@ -179,7 +179,7 @@ OSErr CATSMover3D_c::PrepareForModelRun()
 	return noErr;
 }
 
-OSErr CATSMover3D_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr CATSMover3D_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 
 {
 	OSErr err =0;
@@ -213,7 +213,7 @@ void CATSMover3D_c::ModelStepIsDone()
  }
  
  
- /*WorldPoint3D CATSMover3D_c::GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+ /*WorldPoint3D CATSMover3D_c::GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
  {
  Boolean useEddyUncertainty = false;	
  double 		dLong, dLat;
@@ -47,7 +47,7 @@ public:
 	 TCM_OPTIMZE fOptimize; // this does not need to be saved to the save file
 	 */
 	
-	//virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	//virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	
 	//virtual CurrentUncertainyInfo GetCurrentUncertaintyInfo ();
 	
@@ -63,10 +63,10 @@ public:
 	 VelocityRec 		GetScaledPatValue(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	 VelocityRec			GetSmoothVelocity (WorldPoint p);
 	 OSErr       ComputeVelocityScale(const Seconds& model_time);
-	 virtual WorldPoint3D       GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	 virtual WorldPoint3D       GetMove(const Seconds& start_time, const Seconds& stop_time, const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	 */		
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	virtual	Boolean 		VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
 	
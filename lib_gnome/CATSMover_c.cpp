@@ -12,6 +12,7 @@
 #include "CompFunctions.h"
 #include "MemUtils.h"
 #include "DagTreeIO.h"
+#include "TriGridVel_c.h"
 #include "StringFunctions.h"
 //#include "OUTILS.H"
 
@@ -45,6 +46,16 @@ CATSMover_c::CATSMover_c () : CurrentMover_c() {
 	bApplyLogProfile = false;
 
 	memset(&fOptimize, 0, sizeof(fOptimize));
+	fTriVelocitiesTree = 0;
+	fTriVelocitiesTime = 0;
+	bTriVelocitiesSet = false;
+
+	fRunStartTime = 0;
+	fRunTimeStep = 0;
+	fRunNumSteps = 0;
+	fStepTimeScale = 1;
+	fStepTimeScaleTime = 0;
+	bStepTimeScaleSet = false;
 }
 
 
@@ -63,6 +74,16 @@ CATSMover_c::CATSMover_c(TMap *owner, char *name) : CurrentMover_c(owner, name)
 	bApplyLogProfile = false;
 
 	memset(&fOptimize, 0, sizeof(fOptimize));
+	fTriVelocitiesTree = 0;
+	fTriVelocitiesTime = 0;
+	bTriVelocitiesSet = false;
+
+	fRunStartTime = 0;
+	fRunTimeStep = 0;
+	fRunNumSteps = 0;
+	fStepTimeScale = 1;
+	fStepTimeScaleTime = 0;
+	bStepTimeScaleSet = false;
 
 	SetClassName(name);
 }
@@ -82,6 +103,11 @@ void CATSMover_c::Dispose()
 	DeleteTimeDep ();
 #endif
 
+	fTriVelocities.clear();
+	fTriEddy.clear();
+	bTriVelocitiesSet = false;
+	bStepTimeScaleSet = false;
+
 	CurrentMover_c::Dispose ();
 }
 
@@ -201,7 +227,7 @@ OSErr CATSMover_c::ComputeVelocityScale(const Seconds& model_time)
 
 
 /// 5/12/99 only add the eddy uncertainty when told to
-OSErr CATSMover_c::AddUncertainty(long setIndex, long leIndex,
+OSErr CATSMover_c::AddUncertainty(long setIndex, LECount leIndex,
 								  VelocityRec *patVelocity, double timeStep,
 								  Boolean useEddyUncertainty)
 {
@@ -274,9 +300,25 @@ OSErr CATSMover_c::AddUncertainty(long setIndex, long leIndex,
 }
 
 
+// for the run PrepareForModelRun prepares next, 0 steps for none
+void CATSMover_c::SetModelStepTimes(Seconds startTime, Seconds timeStep, long numSteps)
+{
+	fRunStartTime = startTime;
+	fRunTimeStep = timeStep;
+	fRunNumSteps = numSteps;
+}
+
+
 OSErr CATSMover_c::PrepareForModelRun()
 {
 	this->fOptimize.isFirstStep = true;
+	bStepTimeScaleSet = false;
+
+	// the values are kept by the time file, the values at another time
+	// are looked up as they were
+	if (timeDep && bTimeFileActive && fRunNumSteps > 0)
+		timeDep->PrepareStepValues(fRunStartTime, fRunTimeStep, fRunNumSteps);
+
 	return CurrentMover_c::PrepareForModelRun();
 }
 
@@ -284,8 +326,10 @@ OSErr CATSMover_c::PrepareForModelRun()
 OSErr CATSMover_c::PrepareForModelStep(const Seconds &model_time,
 									   const Seconds &time_step,
 									   bool uncertain,
-									   int numLESets, int *LESetsSizesList)
+									   int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 
 	err = CurrentMover_c::PrepareForModelStep(model_time, time_step,
@@ -306,22 +350,33 @@ OSErr CATSMover_c::PrepareForModelStep(const Seconds &model_time,
 	this->fOptimize.isOptimizedForStep = true;
 	this->fOptimize.value = sqrt(6 * (fEddyDiffusion / 10000) / time_step);
 
+	bStepTimeScaleSet = false;
+	fStepTimeScale = GetTimeScale(model_time);
+	fStepTimeScaleTime = model_time;
+	bStepTimeScaleSet = true;
+
+	SetTriVelocities(model_time);
+
 	return err;
 }
 
 
 void CATSMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	this->fOptimize.isFirstStep = false;
 	memset(&fOptimize, 0, sizeof(fOptimize));
+	bTriVelocitiesSet = false;
 	bIsFirstStep = false;
 }
 
 
-OSErr CATSMover_c::get_move(int n, Seconds model_time, Seconds step_len,
+OSErr CATSMover_c::get_move(LECount n, Seconds model_time, Seconds step_len,
 							WorldPoint3D *ref, WorldPoint3D *delta, short *LE_status,
 							LEType spillType, long spill_ID)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 	if(!delta || !ref) {
 		return 1;
 	}
@@ -333,13 +388,26 @@ OSErr CATSMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 		return 2;
 	}
 
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-
 	WorldPoint3D zero_delta = { {0, 0}, 0.};
+	// eddy uncertainty draws from the shared random number generator so uncertain LEs run serially
+	bool runParallel = fNumThreads > 1 && fOptimize.isOptimizedForStep && spillType == FORECAST_LE;
+
+	if (runParallel && timeDep && bTimeFileActive) {
+		// tide values are computed on demand, fill them in before the threads read them
+		VelocityRec timeValue;
+		timeDep->GetTimeValue(model_time, &timeValue);
+	}
+
+	// size the hints before the loop, each thread only touches its own LE's hint
+	GetTriHint(0, n);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
 
-	for (int i = 0; i < n; i++) {
 		if ( LE_status[i] != OILSTAT_INWATER) {
 			delta[i] = zero_delta;
 			continue;
@@ -362,8 +430,76 @@ OSErr CATSMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 }
 
 
+OSErr CATSMover_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+								  const double *lat, const double *lon, const double *z,
+								  const double *windages, const short *LE_status,
+								  double *delta_lat, double *delta_lon, double *delta_z,
+								  LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+	MoveBatchLEs(n, 0, 0, model_time, step_len, lat, lon, z, windages, LE_status,
+				 delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	return noErr;
+}
+
+
+OSErr CATSMover_c::BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+								  const double *lat, const double *lon, const double *z,
+								  const double *windages, const short *LE_status, LEType spillType)
+{
+	GetTriHint(0, n);
+
+	return noErr;
+}
+
+
+void CATSMover_c::MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+								 const double *lat, const double *lon, const double *z,
+								 const double *windages, const short *LE_status,
+								 double *delta_lat, double *delta_lon, double *delta_z,
+								 LEType spillType, long spill_ID)
+{
+	Boolean useEddyUncertainty = false;
+	WorldPoint3D refPoint3D = { {0, 0}, 0.};
+	VelocityRec scaledPatVelocity;
+
+	for (int k = 0; k < count; k++) {
+		LECount i = index ? index[k] : first + k;
+
+		delta_lat[k] = delta_lon[k] = delta_z[k] = 0.;
+
+		if (LE_status[i] != OILSTAT_INWATER)
+			continue;
+
+		// the grid works on positions scaled by 1e6
+		refPoint3D.p.pLat = lat[i] * 1e6;
+		refPoint3D.p.pLong = lon[i] * 1e6;
+		refPoint3D.z = z[i];
+
+		scaledPatVelocity = this->GetScaledPatValue(model_time, refPoint3D, &useEddyUncertainty, &fTriHints[i]);
+
+		if (spillType == UNCERTAINTY_LE) {
+			AddUncertainty(spill_ID, i, &scaledPatVelocity, step_len, useEddyUncertainty);
+		}
+
+		delta_lon[k] = ((scaledPatVelocity.u / METERSPERDEGREELAT) * step_len) / LongToLatRatio3(refPoint3D.p.pLat);
+		delta_lat[k] = (scaledPatVelocity.v / METERSPERDEGREELAT) * step_len;
+	}
+}
+
+
 WorldPoint3D CATSMover_c::GetMove(const Seconds &model_time, Seconds timeStep,
-								  long setIndex, long leIndex, LERec *theLE, LETYPE leType)
+								  long setIndex, LECount leIndex, LERec *theLE, LETYPE leType)
 {
 	Boolean useEddyUncertainty = false;	
 	double dLong, dLat;
@@ -375,7 +511,7 @@ WorldPoint3D CATSMover_c::GetMove(const Seconds &model_time, Seconds timeStep,
 	refPoint3D.p = (*theLE).p;
 	refPoint3D.z = (*theLE).z;
 
-	scaledPatVelocity = this->GetScaledPatValue(model_time, refPoint3D, &useEddyUncertainty);
+	scaledPatVelocity = this->GetScaledPatValue(model_time, refPoint3D, &useEddyUncertainty, GetTriHint(leIndex, 0));
 
 	if (leType == UNCERTAINTY_LE) {
 		AddUncertainty(setIndex, leIndex, &scaledPatVelocity, timeStep, useEddyUncertainty);
@@ -396,27 +532,73 @@ WorldPoint3D CATSMover_c::GetMove(const Seconds &model_time, Seconds timeStep,
 VelocityRec CATSMover_c::GetScaledPatValue(const Seconds &model_time,
 										   WorldPoint3D p, Boolean *useEddyUncertainty)
 {
-	VelocityRec	patVelocity, timeValue = {1, 1};
-	float lengthSquaredBeforeTimeFactor;
-	OSErr err = 0;
+	return GetScaledPatValue(model_time, p, useEddyUncertainty, 0);
+}
+
+
+VelocityRec CATSMover_c::GetScaledPatValue(const Seconds &model_time,
+										   WorldPoint3D p, Boolean *useEddyUncertainty, long *triHint)
+{
+	VelocityRec	patVelocity;
+
+	// at the surface GetPatValue is the triangle's velocity (a log profile
+	// starts after the first meter)
+	if (bTriVelocitiesSet && fOptimize.isOptimizedForStep && model_time == fTriVelocitiesTime &&
+		(p.z <= 0 || (bApplyLogProfile && p.z <= 1))) {
+		LongPoint lp;
+		long ntri, offGrid = (long)fTriVelocities.size() - 1;
+
+		lp.h = p.p.pLong;
+		lp.v = p.p.pLat;
+		ntri = fTriVelocitiesTree->WhatTriAmIIn(lp, triHint);
+		if (ntri < 0 || ntri >= offGrid)
+			ntri = offGrid;
+
+		if (useEddyUncertainty)
+			*useEddyUncertainty = fTriEddy[ntri];
+
+		return fTriVelocities[ntri];
+	}
 
 	if (!this->fOptimize.isOptimizedForStep && this->scaleType == SCALE_OTHERGRID) {
 		// we need to update refScale
 		this->ComputeVelocityScale(model_time);
 	}
-	
-	// get and apply our time file scale factor
+
+	patVelocity = GetPatValue(p, triHint);
+
+	return ScalePatValue(patVelocity, GetTimeScale(model_time), useEddyUncertainty);
+}
+
+
+// our time file scale factor
+double CATSMover_c::GetTimeScale(const Seconds &model_time)
+{
+	VelocityRec	timeValue = {1, 1};
+	OSErr err = 0;
+
+	if (bStepTimeScaleSet && model_time == fStepTimeScaleTime)
+		return fStepTimeScale;
+
 	if (timeDep && bTimeFileActive) {
 		// VelocityRec errVelocity={1,1};
 		// JLM 11/22/99, if there are no time file values, use zero not 1
 		VelocityRec errVelocity = {0, 1};
 
-		err = timeDep->GetTimeValue(model_time, &timeValue); // AH 07/10/2012
+		if (!timeDep->GetStepValue(model_time, &timeValue, &err))
+			err = timeDep->GetTimeValue(model_time, &timeValue); // AH 07/10/2012
 		if (err)
 			timeValue = errVelocity;
 	}
 
-	patVelocity = GetPatValue(p);
+	return timeValue.u; // magnitude contained in u field only
+}
+
+
+VelocityRec CATSMover_c::ScalePatValue(VelocityRec patVelocity, double timeScale, Boolean *useEddyUncertainty)
+{
+	float lengthSquaredBeforeTimeFactor;
+
 	patVelocity.u *= refScale; 
 	patVelocity.v *= refScale; 
 
@@ -429,14 +611,78 @@ VelocityRec CATSMover_c::GetScaledPatValue(const Seconds &model_time,
 			*useEddyUncertainty = true;
 	}
 
-	patVelocity.u *= timeValue.u; // magnitude contained in u field only
-	patVelocity.v *= timeValue.u; // magnitude contained in u field only
+	patVelocity.u *= timeScale;
+	patVelocity.v *= timeScale;
 
 	return patVelocity;
 }
 
 
+// the DAG tree of a triangle grid, 0 for other grids
+TDagTree *CATSMover_c::GetTriDagTree()
+{
+	TriGridVel_c *triGrid = dynamic_cast<TriGridVel_c *>(fGrid);
+
+	return triGrid ? triGrid->GetDagTree() : 0;
+}
+
+
+// Scales every triangle's velocity for the step the way GetScaledPatValue
+// does, after the step's refScale is set. Grids that aren't triangles keep
+// the per LE path.
+OSErr CATSMover_c::SetTriVelocities(const Seconds &model_time)
+{
+	TDagTree *dagTree = GetTriDagTree();
+	VelocityRec patVelocity = {0., 0.};
+	Boolean useEddy = false;
+	double timeScale;
+	long i, numTri;
+
+	bTriVelocitiesSet = false;
+
+	if (!dagTree || !dagTree->fTopH)
+		return noErr;
+
+	numTri = _GetHandleSize((Handle)dagTree->fTopH) / sizeof(**dagTree->fTopH);
+	if (dagTree->fVelH && _GetHandleSize((Handle)dagTree->fVelH) / (long)sizeof(**dagTree->fVelH) < numTri)
+		return noErr;
+
+	try {
+		fTriVelocities.resize(numTri + 1);
+		fTriEddy.resize(numTri + 1);
+	}
+	catch (...) {
+		return memFullErr;
+	}
+
+	timeScale = GetTimeScale(model_time);
+
+	for (i = 0; i < numTri; i++) {
+		dagTree->GetVelocity(i, &patVelocity);
+		fTriVelocities[i] = ScalePatValue(patVelocity, timeScale, &useEddy);
+		fTriEddy[i] = useEddy;
+	}
+
+	// off the grid the pattern value is zero
+	patVelocity.u = patVelocity.v = 0.0;
+	fTriVelocities[numTri] = ScalePatValue(patVelocity, timeScale, &useEddy);
+	fTriEddy[numTri] = useEddy;
+
+	fTriVelocitiesTree = dagTree;
+	fTriVelocitiesTime = model_time;
+	bTriVelocitiesSet = true;
+
+	return noErr;
+}
+
+
 VelocityRec CATSMover_c::GetPatValue(WorldPoint3D p)
+{
+	return GetPatValue(p, 0);
+}
+
+
+VelocityRec CATSMover_c::GetPatValue(WorldPoint3D p, long *triHint)
 {
 	double depthAtPoint = 0., scaleFactor = 1.;
 	VelocityRec patVal = {0., 0.};
@@ -453,7 +699,7 @@ VelocityRec CATSMover_c::GetPatValue(WorldPoint3D p)
 
 	if (p.z > 1 && bApplyLogProfile) {
 		// start the profile after the first meter
-		depthAtPoint = fGrid->GetDepthAtPoint(p.p);
+		depthAtPoint = fGrid->GetDepthAtPoint(p.p, triHint);
 
 		if (p.z >= depthAtPoint)
 			scaleFactor = 0.;
@@ -461,7 +707,7 @@ VelocityRec CATSMover_c::GetPatValue(WorldPoint3D p)
 			scaleFactor = 1. - log(p.z) / log(depthAtPoint);
 	}
 
-	patVal = fGrid->GetPatValue(p.p);
+	patVal = fGrid->GetPatValue(p.p, triHint);
 	patVal.u *= scaleFactor;
 	patVal.v *= scaleFactor;
 
@@ -510,7 +756,7 @@ void CATSMover_c::DeleteTimeDep ()
 
 
 // import PtCur triangle info so don't have to regenerate
-OSErr CATSMover_c::TextRead(vector<string> &linesInFile)
+OSErr CATSMover_c::TextRead(TextLines &linesInFile)
 {
 	OSErr err = 0;
 	char errmsg[256];
@@ -671,6 +917,14 @@ done:
 }
 
 
+OSErr CATSMover_c::TextRead(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return TextRead(lines);
+}
+
+
 // import PtCur triangle info so don't have to regenerate
 OSErr CATSMover_c::TextRead(char *path)
 {
@@ -678,7 +932,7 @@ OSErr CATSMover_c::TextRead(char *path)
 	if (strPath.size() == 0)
 		return 0;
 
-	vector<string> linesInFile;
+	TextLines linesInFile;
 	if (ReadLinesInFile(strPath, linesInFile)) {
 		return TextRead(linesInFile);
 	}
@@ -691,6 +945,7 @@ OSErr CATSMover_c::TextRead(char *path)
 void CATSMover_c::SetTimeDep(TOSSMTimeValue *newTimeDep)
 {
 	timeDep = newTimeDep;
+	bStepTimeScaleSet = false;
 }
 
 VelocityFH CATSMover_c::GetVelocityHdl(void)
@@ -23,6 +23,7 @@
 #include "OSSMTimeValue_c.h"
 #include "GridVel_c.h"
 #include "DagTree.h"
+#include "TextLines.h"
 //#include "Map_c.h"
 #define TOSSMTimeValue OSSMTimeValue_c
 #define TGridVel GridVel_c
@@ -52,6 +53,24 @@ public:
 	double			fEddyDiffusion;			// cm**2/s minimum eddy velocity for uncertainty
 	double			fEddyV0;			//  in m/s, used for cutoff of minimum eddy for uncertainty
 	TCM_OPTIMZE fOptimize; // this does not need to be saved to the save file	
+
+	// each triangle's velocity with this step's refScale and time file
+	// scale, the velocity off the grid last, so a surface LE's scaled
+	// velocity is a lookup once its triangle is known
+	std::vector<VelocityRec>	fTriVelocities;
+	std::vector<char>		fTriEddy;				// the triangle's velocity before the time scale is at least fEddyV0
+	TDagTree				*fTriVelocitiesTree;	// the grid's tree they were set from
+	Seconds					fTriVelocitiesTime;
+	Boolean					bTriVelocitiesSet;
+
+	// the run's step times: the time file values at all of them are looked
+	// up in PrepareForModelRun, once for the movers sharing the time file
+	Seconds					fRunStartTime;
+	Seconds					fRunTimeStep;
+	long					fRunNumSteps;
+	double					fStepTimeScale;			// GetTimeScale at fStepTimeScaleTime
+	Seconds					fStepTimeScaleTime;
+	Boolean					bStepTimeScaleSet;
 	
 #ifndef pyGNOME
 						CATSMover_c (TMap *owner, char *name);
@@ -60,7 +79,7 @@ public:
 	virtual			   ~CATSMover_c () { Dispose (); }
 	virtual void		Dispose ();
 	virtual OSErr		InitMover ();
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	void				SetRefPosition(WorldPoint3D pos) {this->refPt3D = pos; }
 	void				GetRefPosition (WorldPoint3D *pos) { (*pos) = this->refPt3D; }
 	WorldPoint3D		GetRefPosition () { return this->refPt3D; }	// overloaded for pyGnome
@@ -69,12 +88,19 @@ public:
 	TOSSMTimeValue		*GetTimeDep () { return (timeDep); }
 	void				DeleteTimeDep ();
 	VelocityRec			GetPatValue (WorldPoint3D p);
+	VelocityRec			GetPatValue (WorldPoint3D p, long *triHint);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p,Boolean * useEddyUncertainty);//JLM 5/12/99
+	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p,Boolean * useEddyUncertainty, long *triHint);
+	VelocityRec			ScalePatValue(VelocityRec patVelocity, double timeScale, Boolean *useEddyUncertainty);
+	double				GetTimeScale(const Seconds& model_time);
+	void				SetModelStepTimes(Seconds startTime, Seconds timeStep, long numSteps);
+	TDagTree			*GetTriDagTree();
+	OSErr				SetTriVelocities(const Seconds& model_time);
 	VelocityRec			GetSmoothVelocity (WorldPoint p);
 	virtual OSErr       ComputeVelocityScale(const Seconds& model_time);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); // AH 07/10/2012
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); // AH 07/10/2012
 	virtual void 		ModelStepIsDone();
 	virtual Boolean		VelocityStrAtPoint(WorldPoint3D wp, char *velStr);
 	VelocityFH GetVelocityHdl();
@@ -83,10 +109,27 @@ public:
 	TopologyHdl GetTopologyHdl(void);
 	WORLDPOINTH	GetTriangleCenters();
 
+	virtual	OSErr TextRead(TextLines &linesInFile);
 	virtual	OSErr TextRead(vector<string> &linesInFile);
 	virtual	OSErr TextRead(char* path);
 
-	OSErr get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	OSErr get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
+
+	virtual Boolean		CanFuseMove() { return true; }
+	virtual Boolean		CanMoveInParallel(LETYPE leType) { return fOptimize.isOptimizedForStep && leType == FORECAST_LE; }
+	virtual OSErr		BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status, LEType spillType);
+	virtual void		MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
 
 };
 
@@ -10,6 +10,8 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "CompFunctions.h"
+#include "CounterRandom.h"
+#include "GnomeThreads.h"
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -147,13 +149,82 @@ short ScaleToShort(long n)
 	return n;
 }
 
+static unsigned int randomSeed = 1;
+
+// the thread's stream, Philox blocks of (draw / 4, stream) keyed by the seed
+static GNOME_THREAD_LOCAL unsigned int randomStream = 0;
+static GNOME_THREAD_LOCAL uint32_t streamSeed = 0;
+static GNOME_THREAD_LOCAL uint64_t streamDraws = 0;
+static GNOME_THREAD_LOCAL uint32_t streamBlock[4];
+
+void SetRandomSeed(unsigned int seed)
+{
+	randomSeed = seed;
+	srand(seed);
+}
+
+void SetRandomStream(unsigned int stream)
+{
+	randomStream = stream;
+	streamSeed = randomSeed;
+	streamDraws = 0;
+}
+
+unsigned int GetRandomStream()
+{
+	return randomStream;
+}
+
+void GetRandomState(unsigned int *seed, unsigned int *stream, unsigned int *seedOfStream,
+					long long *draws)
+{
+	*seed = randomSeed;
+	*stream = randomStream;
+	*seedOfStream = streamSeed;
+	*draws = (long long)streamDraws;
+}
+
+void SetRandomState(unsigned int seed, unsigned int stream, unsigned int seedOfStream,
+					long long draws)
+{
+	randomSeed = seed;
+	randomStream = stream;
+	streamSeed = seedOfStream;
+	streamDraws = (uint64_t)draws;
+
+	// the block the next draw comes from, when it is part way through one
+	if (streamDraws & 3) {
+		uint32_t counter[4] = {(uint32_t)(streamDraws >> 2), (uint32_t)(streamDraws >> 34), randomStream, 0};
+		uint32_t key[2] = {streamSeed, 0};
+		Philox4x32(counter, key, streamBlock);
+	}
+}
+
+// 0 to RAND_MAX like rand()
+static int NextRandom()
+{
+	if (randomStream == 0)
+		return rand();
+
+	long i = (long)(streamDraws & 3);
+	if (i == 0) {
+		uint32_t counter[4] = {(uint32_t)(streamDraws >> 2), (uint32_t)(streamDraws >> 34), randomStream, 0};
+		uint32_t key[2] = {streamSeed, 0};
+		Philox4x32(counter, key, streamBlock);
+	}
+	streamDraws++;
+
+	// RAND_MAX + 1 is a power of 2
+	return (int)(streamBlock[i] % ((uint32_t)RAND_MAX + 1));
+}
+
 long GetRandom(long low, long high)
 {
 	float scale, n;
 	
 	scale = (float)(high - low) / (float)RAND_MAX;
 	
-	n = low + rand() * scale;
+	n = low + NextRandom() * scale;
 	
 	return (long)n;
 }
@@ -164,7 +235,7 @@ float GetRandomFloat(float low, float high)
 	
 	scale = (float)(high - low) / (float)RAND_MAX;
 	
-	n = low + rand() * scale;
+	n = low + NextRandom() * scale;
 	
 	return n;
 }
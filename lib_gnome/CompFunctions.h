@@ -11,6 +11,7 @@
 
 #include "Basics.h"
 #include "TypeDefs.h"
+#include "ExportSymbols.h"
 
 #ifdef pyGNOME
 #define PtCurMap PtCurMap_c
@@ -38,6 +39,19 @@ float hypotenuse(float a, float b);
 double myfabs(double x);
 void SetSign(FLOATPTR n, short code);
 short ScaleToShort(long n);
+// GetRandom and GetRandomFloat use the shared rand() unless the thread has
+// picked a stream of its own, which gives the same numbers however the
+// threads interleave. SetRandomStream seeds the stream from the last
+// SetRandomSeed, 0 goes back to rand().
+void DLL_API SetRandomSeed(unsigned int seed);
+void DLL_API SetRandomStream(unsigned int stream);
+unsigned int DLL_API GetRandomStream();
+// the seed and the thread's place in its stream, for checkpoints. The
+// state of rand() itself can't be read, so with stream 0 only the seed is kept
+void DLL_API GetRandomState(unsigned int *seed, unsigned int *stream, unsigned int *streamSeed,
+							long long *streamDraws);
+void DLL_API SetRandomState(unsigned int seed, unsigned int stream, unsigned int streamSeed,
+							long long streamDraws);
 long GetRandom(long low, long high);
 float GetRandomFloat(float low, float high);
 void GetRandomVectorInUnitCircle(float *u,float *v);
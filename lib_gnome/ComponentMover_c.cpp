@@ -44,6 +44,9 @@ ComponentMover_c::ComponentMover_c (TMap *owner, char *name) : CurrentMover_c (o
 	scaleBy = NONE;	// default for dialog is WINDSTRESS, but for location files is WINDSPEED 5/29/00
 	// both are set when they are first encountered
 	memset(&fOptimize,0,sizeof(fOptimize));
+	bPatTriVelocitiesSet = false;
+	fPatGridTree1 = fPatGridTree2 = 0;
+	bPatGridsShared = false;
 	
 	timeMoverCode = kLinkToNone;
 	windMoverName [0] = 0;
@@ -85,6 +88,9 @@ ComponentMover_c::ComponentMover_c () : CurrentMover_c ()
 	scaleBy = NONE;	// default for dialog is WINDSTRESS, but for location files is WINDSPEED 5/29/00
 	// both are set when they are first encountered
 	memset(&fOptimize,0,sizeof(fOptimize));
+	bPatTriVelocitiesSet = false;
+	fPatGridTree1 = fPatGridTree2 = 0;
+	bPatGridsShared = false;
 	
 	timeMoverCode = kLinkToNone;
 	windMoverName [0] = 0;
@@ -117,6 +123,7 @@ void ComponentMover_c::Dispose ()
 		delete pattern2;
 		pattern2 = nil;
 	}
+	fPatGridTree1 = fPatGridTree2 = 0;
 	//For pyGnome, let python/cython manage memory for this object.	
 #ifndef pyGNOME
 	if (timeFile)
@@ -136,14 +143,17 @@ void ComponentMover_c::Dispose ()
 
 void ComponentMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	this -> fOptimize.isFirstStep = false;
 	memset(&fOptimize,0,sizeof(fOptimize));
+	bPatTriVelocitiesSet = false;
 	bIsFirstStep = false;
 }
 
 OSErr ComponentMover_c::PrepareForModelRun()
 {
 	this -> fOptimize.isFirstStep = true;
+	fPatGridTree1 = fPatGridTree2 = 0;	// the patterns may have been read again
 #ifndef pyGNOME
 	if (fAveragedWindsHdl)
 	{	// should recalculate every time in case winds change
@@ -154,9 +164,11 @@ OSErr ComponentMover_c::PrepareForModelRun()
 	return CurrentMover_c::PrepareForModelRun();
 }
 
-OSErr ComponentMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr ComponentMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	char errmsg[256];
 	OSErr err = 0;
 
@@ -172,6 +184,8 @@ OSErr ComponentMover_c::PrepareForModelStep(const Seconds& model_time, const Sec
 	this -> fOptimize.isOptimizedForStep = true;
 	//this -> fOptimize.isFirstStep = (model_time == start_time);
 	
+	SetPatTriVelocities();
+	
 	// code goes here, I think this is redundant
 	/*if (this -> fOptimize.isFirstStep)
 	{	
@@ -251,6 +265,9 @@ OSErr ComponentMover_c::CalculateAveragedWindsVelocity(const Seconds& model_time
 	}
 	//if (forTime > INDEXH(timeValues, n - 1).time) 
 	if (fPastHoursToAverage==0) averageTimeSteps = 1;	// just use the straight wind
+	// the hours of the window are kept in the time file, so each step only
+	// looks up the hour it adds (and the movers sharing the wind look up none)
+	timeFile->CheckAveragingValues();
 	for (j=0;j<averageTimeSteps;j++)
 	{
 		Seconds timeToAddToAverage = startPastTime + j*3600; // eventually this will be time step...
@@ -260,7 +277,7 @@ OSErr ComponentMover_c::CalculateAveragedWindsVelocity(const Seconds& model_time
 		// check first value - 24, last value else will just use first/last value 
 		// also check if it's not a time file...
 		// check here that time is in the handle...
-		timeFile-> GetTimeValue (timeToAddToAverage, &wVel);	
+		timeFile-> GetAveragingValue (timeToAddToAverage, &wVel);	
 		
 		//windSpeedToScale = sqrt(wVel.u*wVel.u + wVel.v*wVel.v);
 		// code goes here, take the component first, then average ?
@@ -714,10 +731,117 @@ OSErr ComponentMover_c::SetOptimizeVariables (char *errmsg, const Seconds& model
 	return noErr;
 }
 
-OSErr ComponentMover_c::get_move(int n, Seconds model_time, Seconds step_len,
+// The patterns' surface values, the ones GetMove asks for, are their
+// triangles' velocities. When the two patterns are on the same grid (the
+// usual pair of files) the step's scaled sum is set for each triangle, so
+// GetMove only has to find the LE's triangle. Otherwise the patterns are
+// looked up directly and summed the way GetMove does. Patterns that aren't
+// on triangle grids keep the per LE path.
+OSErr ComponentMover_c::SetPatTriVelocities()
+{
+	TDagTree *tree1 = pattern1 ? pattern1 -> GetTriDagTree() : 0;
+	TDagTree *tree2 = pattern2 ? pattern2 -> GetTriDagTree() : 0;
+	VelocityRec pat1Val = {0., 0.}, pat2Val = {0., 0.};
+	Boolean shareGrid;
+	long i, numTri = 0;
+
+	bPatTriVelocitiesSet = false;
+	fPatTriVelocities.clear();
+
+	if (!tree1 || (pattern2 && !tree2))
+		return noErr;
+
+	if (tree1 != fPatGridTree1 || tree2 != fPatGridTree2)
+	{
+		shareGrid = tree1->fTopH && tree1->fPtsH && (!tree2 || (tree2->fTopH && tree2->fPtsH));
+		if (shareGrid)
+		{
+			numTri = _GetHandleSize((Handle)tree1->fTopH) / sizeof(**tree1->fTopH);
+			if (tree1->fVelH && _GetHandleSize((Handle)tree1->fVelH) / (long)sizeof(**tree1->fVelH) < numTri)
+				shareGrid = false;
+		}
+		if (shareGrid && tree2)
+		{
+			shareGrid = _GetHandleSize((Handle)tree1->fTopH) == _GetHandleSize((Handle)tree2->fTopH) &&
+						_GetHandleSize((Handle)tree1->fPtsH) == _GetHandleSize((Handle)tree2->fPtsH) &&
+						!(tree2->fVelH && _GetHandleSize((Handle)tree2->fVelH) / (long)sizeof(**tree2->fVelH) < numTri) &&
+						!memcmp(*tree1->fTopH, *tree2->fTopH, _GetHandleSize((Handle)tree1->fTopH)) &&
+						!memcmp(*tree1->fPtsH, *tree2->fPtsH, _GetHandleSize((Handle)tree1->fPtsH));
+		}
+		fPatGridTree1 = tree1;
+		fPatGridTree2 = tree2;
+		bPatGridsShared = shareGrid;
+	}
+	shareGrid = bPatGridsShared;
+
+	if (shareGrid)
+	{
+		numTri = _GetHandleSize((Handle)tree1->fTopH) / sizeof(**tree1->fTopH);
+		try
+		{
+			fPatTriVelocities.resize(numTri + 1);
+		}
+		catch (...)
+		{
+			return memFullErr;
+		}
+
+		for (i = 0; i <= numTri; i++)
+		{
+			// off the grid the pattern values are zero
+			pat1Val.u = pat1Val.v = pat2Val.u = pat2Val.v = 0;
+			if (i < numTri)
+			{
+				tree1 -> GetVelocity(i, &pat1Val);
+				if (tree2) tree2 -> GetVelocity(i, &pat2Val);
+			}
+			fPatTriVelocities[i].u = pat1Val.u * fOptimize.pat1ValScale + pat2Val.u * fOptimize.pat2ValScale;
+			fPatTriVelocities[i].v = pat1Val.v * fOptimize.pat1ValScale + pat2Val.v * fOptimize.pat2ValScale;
+		}
+	}
+
+	bPatTriVelocitiesSet = true;
+
+	return noErr;
+}
+
+VelocityRec ComponentMover_c::GetPatTriVelocity(WorldPoint p, LECount leIndex)
+{
+	VelocityRec	finalVel, pat1Val = {0., 0.}, pat2Val = {0., 0.};
+	LongPoint lp;
+	long ntri;
+
+	lp.h = p.pLong;
+	lp.v = p.pLat;
+
+	ntri = pattern1 -> GetTriDagTree() -> WhatTriAmIIn(lp, pattern1 -> GetTriHint(leIndex, 0));
+
+	if (!fPatTriVelocities.empty())
+	{
+		if (ntri < 0 || ntri >= (long)fPatTriVelocities.size() - 1)
+			ntri = (long)fPatTriVelocities.size() - 1;
+		return fPatTriVelocities[ntri];
+	}
+
+	if (ntri > -1) pattern1 -> GetTriDagTree() -> GetVelocity(ntri, &pat1Val);
+	if (pattern2)
+	{
+		ntri = pattern2 -> GetTriDagTree() -> WhatTriAmIIn(lp, pattern2 -> GetTriHint(leIndex, 0));
+		if (ntri > -1) pattern2 -> GetTriDagTree() -> GetVelocity(ntri, &pat2Val);
+	}
+
+	finalVel.u = pat1Val.u * fOptimize.pat1ValScale + pat2Val.u * fOptimize.pat2ValScale;
+	finalVel.v = pat1Val.v * fOptimize.pat1ValScale + pat2Val.v * fOptimize.pat2ValScale;
+
+	return finalVel;
+}
+
+OSErr ComponentMover_c::get_move(LECount n, Seconds model_time, Seconds step_len,
 							WorldPoint3D *ref, WorldPoint3D *delta, short *LE_status,
 							LEType spillType, long spill_ID)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 	if(!delta || !ref) {
 		return 1;
 	}
@@ -729,13 +853,21 @@ OSErr ComponentMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 		return 2;
 	}
 	
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-	
 	WorldPoint3D zero_delta = { {0, 0}, 0.};
-	
-	for (int i = 0; i < n; i++) {
+	// the pattern scales are set once per step so LEs are independent
+	bool runParallel = fNumThreads > 1 && fOptimize.isOptimizedForStep;
+
+	// size the patterns' hints before the loop, each thread only touches its own LE's hint
+	if (pattern1) pattern1 -> GetTriHint(0, n);
+	if (pattern2) pattern2 -> GetTriHint(0, n);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
+
 		if ( LE_status[i] != OILSTAT_INWATER) {
 			delta[i] = zero_delta;
 			continue;
@@ -757,7 +889,7 @@ OSErr ComponentMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 	return noErr;
 }
 
-WorldPoint3D ComponentMover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D ComponentMover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double 		dLat, dLong;
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -768,20 +900,25 @@ WorldPoint3D ComponentMover_c::GetMove (const Seconds& model_time, Seconds timeS
 	char errmsg[256];
 	
 	refPoint3D.p = refPoint;
-	pat1Val = pattern1 -> GetPatValue (refPoint3D);
-	if (pattern2) pat2Val = pattern2 -> GetPatValue (refPoint3D);
-	else {pat2Val.u = pat2Val.v = 0;}
-	
-	if (!fOptimize.isOptimizedForStep)
+	if (bPatTriVelocitiesSet && fOptimize.isOptimizedForStep)
+		finalVel = GetPatTriVelocity(refPoint, leIndex);
+	else
 	{
-		err = SetOptimizeVariables (errmsg, model_time, timeStep);
-		if (err) return deltaPoint;
+		pat1Val = pattern1 -> GetPatValue (refPoint3D);
+		if (pattern2) pat2Val = pattern2 -> GetPatValue (refPoint3D);
+		else {pat2Val.u = pat2Val.v = 0;}
+		
+		if (!fOptimize.isOptimizedForStep)
+		{
+			err = SetOptimizeVariables (errmsg, model_time, timeStep);
+			if (err) return deltaPoint;
+		}
+		
+		
+		finalVel.u = pat1Val.u * fOptimize.pat1ValScale + pat2Val.u * fOptimize.pat2ValScale;
+		finalVel.v = pat1Val.v * fOptimize.pat1ValScale + pat2Val.v * fOptimize.pat2ValScale;
 	}
 	
-	
-	finalVel.u = pat1Val.u * fOptimize.pat1ValScale + pat2Val.u * fOptimize.pat2ValScale;
-	finalVel.v = pat1Val.v * fOptimize.pat1ValScale + pat2Val.v * fOptimize.pat2ValScale;
-	
 	if(leType == UNCERTAINTY_LE)
 	{
 		AddUncertainty(setIndex,leIndex,&finalVel,timeStep);
@@ -834,7 +971,7 @@ Boolean ComponentMover_c::VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticSt
 	
 }
 
-OSErr ComponentMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep)
+OSErr ComponentMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep)
 {
 	
 	double u,v,lengthS,alpha,beta;
@@ -905,6 +1042,7 @@ OSErr ComponentMover_c::TextRead(char *cats_path1, char *cats_path2)
 	TCATSMover *newCATSMover2 = 0;
 	
 	if (!cats_path1[0]) return -1;
+	fPatGridTree1 = fPatGridTree2 = 0;
 	
 	newCATSMover1 = new TCATSMover;
 	if (!newCATSMover1)
@@ -23,6 +23,7 @@
 class TCATSMover;
 class TOSSMTimeValue;
 class TComponentMover;
+class TDagTree;
 
 
 //class ComponentMover_c : virtual public CurrentMover_c {
@@ -67,6 +68,14 @@ public:
 	
 	//							optimize fields don't need to be saved
 	TC_OPTIMZE			fOptimize;
+	// when the patterns share a grid, each triangle's scaled sum of the
+	// pattern velocities for the step, the velocity off the grid last
+	std::vector<VelocityRec>	fPatTriVelocities;
+	Boolean				bPatTriVelocitiesSet;
+	// the patterns' trees last compared for their grids, and whether they
+	// share one, so the grids are compared once a run and not every step
+	TDagTree			*fPatGridTree1, *fPatGridTree2;
+	Boolean				bPatGridsShared;
 	
 	long				timeMoverCode;
 	char 				windMoverName [64]; 	// file to match at refP
@@ -78,18 +87,20 @@ public:
 	virtual			   ~ComponentMover_c () { Dispose (); }
 	virtual void		Dispose ();
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	OSErr				SetOptimizeVariables (char *errmsg, const Seconds& model_time, const Seconds& time_step);
+	OSErr				SetPatTriVelocities();
+	VelocityRec			GetPatTriVelocity(WorldPoint p, LECount leIndex);
 #ifndef pyGNOME
 	OSErr				CalculateAveragedWindsHdl(char *errmsg);
 	OSErr				GetAveragedWindValue(Seconds time, const Seconds& time_step, VelocityRec *avValue);
 #else
 	OSErr 				CalculateAveragedWindsVelocity(const Seconds& model_time, char *errmsg);
 #endif
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep);
 
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	virtual	Boolean 		VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);	
 
 	//void				SetRefPosition (WorldPoint p) { refP = p;}
@@ -105,7 +116,7 @@ public:
 #ifdef pyGNOME
 	virtual	OSErr TextRead(char* catsPath1, char* catsPath2);
 #endif
-	OSErr get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	OSErr get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
 };
 
 #undef TCATSMover
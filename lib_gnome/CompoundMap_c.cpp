@@ -10,6 +10,7 @@
 #include "CompoundMap_c.h"
 #include "CompFunctions.h"
 #include "MemUtils.h"
+#include "BoundarySegIndex.h"
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -45,15 +46,7 @@ TCurrentMover* CompoundMap_c::GetCompoundMover()
 // will need to deal with this for new curvilinear algorithm when start using subsurface movement
 long CompoundMap_c::PointOnWhichSeg(long point)	// This is really which boundary
 {
-	long numSegs = GetNumBoundarySegs(),jseg;
-	for(jseg = 0; jseg < numSegs; jseg++)
-	{
-		if(point <= (*fBoundarySegmentsH)[jseg])
-		{
-			return jseg;
-		}
-	}
-	return -1;
+	return BoundarySegIndex::PointOnWhichBoundary(fBoundarySegmentsH, point);
 }
 
 Boolean CompoundMap_c::ContiguousPoints(long p1, long p2)
@@ -83,6 +76,11 @@ long CompoundMap_c::PointOnWhichSeg(long longVal, long latVal, long *startver, l
 	dLong = dLat = oneSecond * 50;
 	*distToSeg = -1;
 	
+	// the segments near the point, from the index of the boundary
+	if (!fSegIndex) fSegIndex = new BoundarySegIndex;
+	if (fSegIndex && fSegIndex->Prepare(fBoundarySegmentsH, 0, ptsHdl, dLong, dLat) == noErr)
+		return fSegIndex->PointOnWhichSeg(longVal, latVal, startver, endver, distToSeg);
+	
 	for(jseg = 0; jseg < numSegs; jseg++)	// loop through the boundaries
 	{
 		firstPoint = jseg == 0? 0: (*fBoundarySegmentsH)[jseg-1] + 1;
@@ -749,7 +747,6 @@ void  CompoundMap_c::FindNearestBoundary(WorldPoint wp, long *verNum, long *segN
 	LongPoint lp;
 	long lastVer = GetNumBoundaryPts();
 	//long nbounds = GetNumBoundaries();
-	long nSegs = GetNumBoundarySegs();	
 	float wdist = LatToDistance(ScreenToWorldDistance(4));
 	LongPointHdl ptsHdl = GetPointsHdl(false);	// will use refined grid if there is one
 	if(!ptsHdl) return;
@@ -765,14 +762,11 @@ void  CompoundMap_c::FindNearestBoundary(WorldPoint wp, long *verNum, long *segN
 		if(WPointNearWPoint(wp,wp2 ,wdist))
 		{
 			//for(jseg = 0; jseg < nbounds; jseg++)
-			for(jseg = 0; jseg < nSegs; jseg++)
+			jseg = BoundarySegIndex::PointOnWhichBoundary(fBoundarySegmentsH, i);
+			if (jseg >= 0)
 			{
-				if(i <= (*fBoundarySegmentsH)[jseg])
-				{
-					*verNum  = i;
-					*segNo = jseg;
-					break;
-				}
+				*verNum  = i;
+				*segNo = jseg;
 			}
 		}
 	} 
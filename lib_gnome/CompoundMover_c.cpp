@@ -7,6 +7,8 @@
  *
  */
 
+#include <vector>
+
 #include "CompoundMover_c.h"
 #include "MemUtils.h"
 #include "CompFunctions.h"
@@ -45,7 +47,7 @@ Boolean CompoundMover_c::IAmA3DMover()
 	return false;
 }
 
-OSErr CompoundMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep)
+OSErr CompoundMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep)
 {
 	//probably don't need this since will use individual currents' uncertainties
 	double u,v,lengthS,alpha,beta;
@@ -110,7 +112,7 @@ OSErr CompoundMover_c::PrepareForModelRun()
 	}
 	return CurrentMover_c::PrepareForModelRun();
 }
-OSErr CompoundMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr CompoundMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 
 {
 	char errmsg[256];
@@ -123,9 +125,19 @@ OSErr CompoundMover_c::PrepareForModelStep(const Seconds& model_time, const Seco
 	//if (err) goto done;
 	long i, n;
 	TMover *mover;
+	TCurrentMover *current;
+	fGridBounds.Clear();
 	for (i = 0, n = moverList->GetItemCount() ; i < n ; i++) {
 		moverList->GetListItem((Ptr)&mover, i);
 		err = mover->PrepareForModelStep(model_time, time_step, uncertain, numLESets, LESetsSizesList);	
+		// the grid is read by now. Rectangular grids can give a velocity a
+		// little past their bounds, so only the currents that say they don't
+		// are ever skipped
+		current = dynamic_cast<TCurrentMover *>(mover);
+		if (current && !err && current->MovesOnlyInGridBounds())
+			fGridBounds.Add(current->GetGridBounds());
+		else
+			fGridBounds.AddWorld();
 	}
 	
 	/*if (model_time == start_time)	// first step
@@ -168,7 +180,7 @@ OSErr CompoundMover_c::AddMover(TMover *theMover, short where)
 }
 
 
-WorldPoint3D CompoundMover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D CompoundMover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double 		dLat, dLong;
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -187,6 +199,14 @@ WorldPoint3D CompoundMover_c::GetMove (const Seconds& model_time, Seconds timeSt
 		//listLength += n;
 		for (i = 0, n = moverList->GetItemCount() ; i < n ; i++) 
 		{	// movers should be listed in priority order
+			// a forecast LE off a grid's bounds gets no move from it, so skip
+			// to the next grid that could hold it. Uncertainty LEs try all
+			// of them, they can get a move from the uncertainty alone
+			if (leType == FORECAST_LE && fGridBounds.GetCount() == n)
+			{
+				i = fGridBounds.NextCandidate(refPoint, i);
+				if (i < 0) break;
+			}
 			moverList->GetListItem((Ptr)&mover, i);
 			//check if LE is on the mover's grid
 			if (!mover -> IsActive ()) continue; // to next mover
@@ -220,6 +240,183 @@ WorldPoint3D CompoundMover_c::GetMove (const Seconds& model_time, Seconds timeSt
 	return deltaPoint;
 }
 
+// the first of the movers at or after start that may hold p, as GetMove
+// tries them, -1 if none
+static long NextMember(std::vector<TMover *> &movers, GridBoundsIndex &bounds, Boolean useBounds, WorldPoint p, long start)
+{
+	long numMovers = (long)movers.size();
+
+	for (long m = start; m < numMovers; m++)
+	{
+		if (useBounds)
+		{
+			m = bounds.NextCandidate(p, m);
+			if (m < 0) return -1;
+		}
+		if (movers[m]) return m;
+	}
+
+	return -1;
+}
+
+OSErr CompoundMover_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									  const double *lat, const double *lon, const double *z,
+									  const double *windages, const short *LE_status,
+									  double *delta_lat, double *delta_lon, double *delta_z,
+									  LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+	long numMovers = moverList ? moverList->GetItemCount() : 0, m, next;
+	Boolean useBounds = spillType == FORECAST_LE && fGridBounds.GetCount() == numMovers;
+	Boolean parallel, pending = false;
+	std::vector<TMover *> movers;
+	std::vector< std::vector<LECount> > assigned, unmoved;
+	std::vector< std::vector<double> > moveLat, moveLon, moveZ;
+	std::vector<Boolean> begun;
+	std::vector<long> round;
+	WorldPoint p;
+
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	try
+	{
+		movers.resize(numMovers, 0);
+		assigned.resize(numMovers);
+		unmoved.resize(numMovers);
+		moveLat.resize(numMovers);
+		moveLon.resize(numMovers);
+		moveZ.resize(numMovers);
+		begun.resize(numMovers, false);
+
+		for (m = 0; m < numMovers; m++)
+		{
+			moverList->GetListItem((Ptr)&movers[m], m);
+			if (movers[m] && !movers[m]->IsActive())
+				movers[m] = 0;
+		}
+
+		// GetMove works on positions scaled by 1000000
+		for (LECount i = 0; i < n; i++)
+		{
+			delta_lat[i] = delta_lon[i] = delta_z[i] = 0.;
+			if (LE_status[i] != OILSTAT_INWATER)
+				continue;
+			p.pLat = lat[i] * 1000000;
+			p.pLong = lon[i] * 1000000;
+			if ((m = NextMember(movers, fGridBounds, useBounds, p, 0)) >= 0)
+			{
+				assigned[m].push_back(i);
+				pending = true;
+			}
+		}
+
+		while (pending)
+		{
+			round.clear();
+			parallel = fNumThreads > 1;
+			for (m = 0; m < numMovers; m++)
+			{
+				if (assigned[m].empty())
+					continue;
+				round.push_back(m);
+				if (!movers[m]->CanMoveInParallel(spillType))
+					parallel = false;
+				moveLat[m].resize(assigned[m].size());
+				moveLon[m].resize(assigned[m].size());
+				moveZ[m].resize(assigned[m].size());
+			}
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(fNumThreads) if(parallel && round.size() > 1)
+#endif
+			for (long r = 0; r < (long)round.size(); r++)
+			{
+				long mr = round[r];
+				TMover *mover = movers[mr];
+				const std::vector<LECount> &les = assigned[mr];
+				LECount count = (LECount)les.size();
+
+				if (mover->CanFuseMove())
+				{
+					GnomeLock memberLock(mover->fMoverMutex);
+
+					if (!begun[mr])
+					{
+						begun[mr] = true;
+						mover->BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+					}
+					for (LECount first = 0; first < count; first += kFuseChunk)
+						mover->MoveBatchLEs(count - first < kFuseChunk ? count - first : kFuseChunk, 0, &les[first],
+											model_time, step_len, lat, lon, z, windages, LE_status,
+											&moveLat[mr][first], &moveLon[mr][first], &moveZ[mr][first], spillType, spill_ID);
+				}
+				else
+				{
+					LERec rec;
+					WorldPoint3D delta;
+
+					memset(&rec, 0, sizeof(rec));
+					for (LECount k = 0; k < count; k++)
+					{
+						LECount i = les[k];
+
+						rec.p.pLat = lat[i] * 1000000;
+						rec.p.pLong = lon[i] * 1000000;
+						rec.z = z[i];
+						if (windages)
+							rec.windage = windages[i];
+
+						delta = mover->GetMove(model_time, step_len, spill_ID, i, &rec, spillType);
+
+						moveLat[mr][k] = delta.p.pLat / 1000000;
+						moveLon[mr][k] = delta.p.pLong / 1000000;
+						moveZ[mr][k] = delta.z;
+					}
+				}
+			}
+
+			// the LEs moved are done, the others go on to their next member
+			pending = false;
+			for (long r = 0; r < (long)round.size(); r++)
+			{
+				m = round[r];
+				for (size_t k = 0; k < assigned[m].size(); k++)
+				{
+					LECount i = assigned[m][k];
+
+					if (moveLat[m][k] != 0 || moveLon[m][k] != 0 || moveZ[m][k] != 0.)
+					{
+						delta_lat[i] = moveLat[m][k];
+						delta_lon[i] = moveLon[m][k];
+						delta_z[i] = moveZ[m][k];
+						continue;
+					}
+					p.pLat = lat[i] * 1000000;
+					p.pLong = lon[i] * 1000000;
+					if ((next = NextMember(movers, fGridBounds, useBounds, p, m + 1)) >= 0)
+					{
+						unmoved[next].push_back(i);
+						pending = true;
+					}
+				}
+				assigned[m].clear();
+			}
+			assigned.swap(unmoved);
+		}
+	}
+	catch (...)
+	{
+		return memFullErr;
+	}
+
+	return noErr;
+}
+
 Boolean CompoundMover_c::VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr)
 {
 	char uStr[32], sStr[32];
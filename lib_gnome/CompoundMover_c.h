@@ -14,6 +14,7 @@
 #include "TypeDefs.h"
 #include "CurrentMover_c.h"
 #include "CMYLIST.H"
+#include "GridBoundsIndex.h"
 
 #ifdef pyGNOME
 #define TMap Map_c
@@ -40,6 +41,7 @@ public:
 	//TOSSMTimeValue		*timeFile;
 	
 	Boolean 			bMoversOpen;
+	GridBoundsIndex		fGridBounds;			// of the component currents' grids, set each step
 	/*WorldPoint			refP;
 	 Boolean 			bRefPointOpen;
 	 
@@ -66,12 +68,21 @@ public:
 	
 	CompoundMover_c (TMap *owner, char *name);
 	CompoundMover_c () {}
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep);
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
+	// GetMove's priority order a member at a time: each LE is given to the
+	// first member that may hold it, the ones a member gives no move go on
+	// to their next member in the next round. The members of a round move
+	// their LEs together, in parallel when they all can
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
 	virtual	Boolean 		VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
 	virtual float		GetArrowDepth();
 
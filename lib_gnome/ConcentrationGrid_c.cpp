@@ -0,0 +1,193 @@
+/*
+ *  ConcentrationGrid_c.cpp
+ *  gnome
+ *
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "ConcentrationGrid_c.h"
+#include "Units.h"
+
+ConcentrationGrid_c::ConcentrationGrid_c()
+{
+	fLocator = 0;
+	fWest = fSouth = 0;
+	fDLon = fDLat = 0;
+	fNumCols = fNumRows = fNumCells = 0;
+
+	// the surface meter until told otherwise
+	fEdges.push_back(0.);
+	fEdges.push_back(1.);
+}
+
+void ConcentrationGrid_c::Dispose()
+{
+	fLocator = 0;
+	fNumCols = fNumRows = fNumCells = 0;
+	fMass.clear();
+}
+
+void ConcentrationGrid_c::Resize()
+{
+	fMass.assign(fNumCells * GetNumLayers(), 0.);
+}
+
+OSErr ConcentrationGrid_c::SetRegularGrid(double west, double south, double east, double north, long numCols, long numRows)
+{
+	if (numCols < 1 || numRows < 1 || !(east > west) || !(north > south))
+		return -1;
+
+	Dispose();
+	fWest = west;
+	fSouth = south;
+	fDLon = (east - west) / numCols;
+	fDLat = (north - south) / numRows;
+	fNumCols = numCols;
+	fNumRows = numRows;
+	fNumCells = numCols * numRows;
+	Resize();
+
+	return noErr;
+}
+
+OSErr ConcentrationGrid_c::SetTriangleGrid(GridLocator_c *locator)
+{
+	if (!locator || locator->GetNumTriangles() < 1)
+		return -1;
+
+	Dispose();
+	fLocator = locator;
+	fNumCells = locator->GetNumTriangles();
+	Resize();
+
+	return noErr;
+}
+
+OSErr ConcentrationGrid_c::SetLayers(long numEdges, const double *edges)
+{
+	if (numEdges < 2 || !edges)
+		return -1;
+
+	for (long i = 1; i < numEdges; i++)
+		if (!(edges[i] > edges[i - 1]))
+			return -1;
+
+	fEdges.assign(edges, edges + numEdges);
+	Resize();
+
+	return noErr;
+}
+
+void ConcentrationGrid_c::Clear()
+{
+	std::fill(fMass.begin(), fMass.end(), 0.);
+}
+
+long ConcentrationGrid_c::FindCell(double lon, double lat, long hint)
+{
+	long col, row;
+	double x, y;
+
+	if (fLocator)
+		return fLocator->FindTriangle(lon, lat, hint);
+
+	x = (lon - fWest) / fDLon;
+	y = (lat - fSouth) / fDLat;
+	if (!(x >= 0 && x < fNumCols && y >= 0 && y < fNumRows))
+		return -1;	// off the grid, or not a number
+
+	col = _min((long)x, fNumCols - 1);
+	row = _min((long)y, fNumRows - 1);
+
+	return row * fNumCols + col;
+}
+
+// the layer with depth between its top and bottom, the last one's bottom included
+long ConcentrationGrid_c::FindLayer(double depth)
+{
+	long numLayers = GetNumLayers();
+
+	if (!(depth >= fEdges[0] && depth <= fEdges[numLayers]))
+		return -1;
+
+	long layer = (long)(std::upper_bound(fEdges.begin(), fEdges.end(), depth) - fEdges.begin()) - 1;
+
+	return _min(layer, numLayers - 1);
+}
+
+long ConcentrationGrid_c::AddMass(long n, const double *lon, const double *lat, const double *depth,
+								  const double *mass, long *cell)
+{
+	long i, c, layer, numBinned = 0;
+
+	if (fNumCells == 0)
+		return 0;
+
+	for (i = 0; i < n; i++)
+	{
+		c = FindCell(lon[i], lat[i], cell ? cell[i] : -1);
+		if (cell) cell[i] = c;
+		if (c < 0) continue;
+
+		layer = FindLayer(depth[i]);
+		if (layer < 0) continue;
+
+		fMass[layer * fNumCells + c] += mass[i];
+		numBinned++;
+	}
+
+	return numBinned;
+}
+
+void ConcentrationGrid_c::GetCellAreas(double *area)
+{
+	// the radius of the sphere with the degrees of latitude of the movers
+	const double radius = METERSPERDEGREELAT * 180. / PI;
+	double vLon[3], vLat[3], lonScale, cross;
+	long i, row;
+
+	if (!fLocator)
+	{
+		for (row = 0; row < fNumRows; row++)
+		{
+			double rowArea = radius * radius * fDLon * PI / 180. *
+				(sin((fSouth + (row + 1) * fDLat) * PI / 180.) - sin((fSouth + row * fDLat) * PI / 180.));
+			for (i = 0; i < fNumCols; i++)
+				area[row * fNumCols + i] = fabs(rowArea);
+		}
+		return;
+	}
+
+	// the triangles on the plane the movers move elements in
+	for (i = 0; i < fNumCells; i++)
+	{
+		fLocator->GetTriangleVertices(i, vLon, vLat);
+		lonScale = cos((vLat[0] + vLat[1] + vLat[2]) / 3. * PI / 180.);
+		cross = (vLon[1] - vLon[0]) * lonScale * (vLat[2] - vLat[0])
+			  - (vLon[2] - vLon[0]) * lonScale * (vLat[1] - vLat[0]);
+		area[i] = fabs(cross) / 2. * METERSPERDEGREELAT * METERSPERDEGREELAT;
+	}
+}
+
+void ConcentrationGrid_c::GetCellCenters(double *lon, double *lat)
+{
+	double vLon[3], vLat[3];
+	long i;
+
+	for (i = 0; i < fNumCells; i++)
+	{
+		if (fLocator)
+		{
+			fLocator->GetTriangleVertices(i, vLon, vLat);
+			lon[i] = (vLon[0] + vLon[1] + vLon[2]) / 3.;
+			lat[i] = (vLat[0] + vLat[1] + vLat[2]) / 3.;
+		}
+		else
+		{
+			lon[i] = fWest + (i % fNumCols + .5) * fDLon;
+			lat[i] = fSouth + (i / fNumCols + .5) * fDLat;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+/*
+ *  ConcentrationGrid_c.h
+ *  gnome
+ *
+ *  The mass of the elements binned by cell and depth layer, for the
+ *  concentration output: the cells are those of a regular longitude and
+ *  latitude grid, or the triangles of a model grid located with a
+ *  GridLocator_c, which starts each lookup from the element's last triangle.
+ *
+ */
+
+#ifndef __ConcentrationGrid_c__
+#define __ConcentrationGrid_c__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+#include "GridLocator_c.h"
+
+class DLL_API ConcentrationGrid_c {
+
+public:
+	ConcentrationGrid_c();
+	virtual ~ConcentrationGrid_c() { Dispose(); }
+	void	Dispose();
+
+	// numCols x numRows cells over the bounds in degrees, the rows from the south
+	OSErr	SetRegularGrid(double west, double south, double east, double north, long numCols, long numRows);
+	// the triangles of the locator, which is not kept -- it has to outlive the grid
+	OSErr	SetTriangleGrid(GridLocator_c *locator);
+	// the depths in meters, increasing, of the tops of the layers and the bottom of the last
+	OSErr	SetLayers(long numEdges, const double *edges);
+
+	long	GetNumCells() {return fNumCells;}
+	long	GetNumLayers() {return (long)fEdges.size() - 1;}
+
+	// the binned mass set back to zero
+	void	Clear();
+
+	// adds the mass of the points to their cells and layers, returns how many were binned:
+	// those off the grid, above the first layer or below the last are left out. cell (one per
+	// point, may be 0) is set to the points' cells and, on a triangle grid, is where the
+	// lookups start -- the points' cells on the last call, -1 for none
+	long	AddMass(long n, const double *lon, const double *lat, const double *depth,
+					const double *mass, long *cell);
+
+	// the binned mass in kilograms, layer by layer: that of a cell is at layer * cells + cell
+	const double	*GetMass() {return fMass.empty() ? 0 : &fMass[0];}
+
+	// the areas of the cells in square meters, and their centers in degrees
+	void	GetCellAreas(double *area);
+	void	GetCellCenters(double *lon, double *lat);
+
+private:
+	GridLocator_c		*fLocator;	// 0 for the regular grid
+	double				fWest, fSouth, fDLon, fDLat;
+	long				fNumCols, fNumRows, fNumCells;
+	std::vector<double> fEdges;
+	std::vector<double>	fMass;
+
+	void	Resize();
+	long	FindCell(double lon, double lat, long hint);
+	long	FindLayer(double depth);
+};
+
+#endif
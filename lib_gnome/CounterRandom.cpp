@@ -0,0 +1,122 @@
+/*
+ *  CounterRandom.cpp
+ *  gnome
+ *
+ *  See Salmon et al, "Parallel random numbers: as easy as 1, 2, 3", SC11
+ *
+ */
+
+#include "CounterRandom.h"
+
+#define PHILOX_M0 0xD2511F53UL
+#define PHILOX_M1 0xCD9E8D57UL
+#define PHILOX_W0 0x9E3779B9UL
+#define PHILOX_W1 0xBB67AE85UL
+#define PHILOX_ROUNDS 10
+
+static inline void MulHiLo(uint32_t a, uint32_t b, uint32_t *hi, uint32_t *lo)
+{
+	uint64_t product = (uint64_t)a * (uint64_t)b;
+	*hi = (uint32_t)(product >> 32);
+	*lo = (uint32_t)product;
+}
+
+void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4])
+{
+	uint32_t ctr[4], k0 = key[0], k1 = key[1];
+	uint32_t hi0, lo0, hi1, lo1;
+
+	for (int i = 0; i < 4; i++)
+		ctr[i] = counter[i];
+
+	for (int round = 0; round < PHILOX_ROUNDS; round++)
+	{
+		if (round > 0)
+		{
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+		MulHiLo(PHILOX_M0, ctr[0], &hi0, &lo0);
+		MulHiLo(PHILOX_M1, ctr[2], &hi1, &lo1);
+
+		ctr[0] = hi1 ^ ctr[1] ^ k0;
+		ctr[1] = lo1;
+		ctr[2] = hi0 ^ ctr[3] ^ k1;
+		ctr[3] = lo0;
+	}
+
+	for (int i = 0; i < 4; i++)
+		result[i] = ctr[i];
+}
+
+// each Philox block gives 4 numbers, so draw 0-3 share a block, 4-7 the next, ...
+static uint32_t CounterRandomBits(const CounterRandomKey &key, LECount leIndex, long draw)
+{
+	uint32_t counter[4], philoxKey[2], result[4];
+
+	counter[0] = (uint32_t)leIndex;
+	counter[1] = (uint32_t)key.step;
+	// the LE index past 2^32 goes above the draws, so the LEs before it keep their numbers
+	counter[2] = (uint32_t)(draw / 4) + ((uint32_t)((uint64_t)leIndex >> 32) << 16);
+	counter[3] = (uint32_t)key.stream;
+	philoxKey[0] = key.seed;
+	philoxKey[1] = (uint32_t)key.spillID;
+
+	Philox4x32(counter, philoxKey, result);
+
+	return result[draw % 4];
+}
+
+static inline float BitsToFloat(uint32_t bits, float low, float high)
+{
+	// top 24 bits give a float in [0, 1)
+	float unit = (bits >> 8) * (1.0f / 16777216.0f);
+	return low + unit * (high - low);
+}
+
+float CounterRandomFloat(const CounterRandomKey &key, LECount leIndex, long draw, float low, float high)
+{
+	return BitsToFloat(CounterRandomBits(key, leIndex, draw), low, high);
+}
+
+void CounterRandomVectorInUnitCircle(const CounterRandomKey &key, LECount leIndex, float *u, float *v)
+{
+	long draw = 0;
+	do
+	{
+		*u = CounterRandomFloat(key, leIndex, draw++, -1.0, 1.0);
+		*v = CounterRandomFloat(key, leIndex, draw++, -1.0, 1.0);
+	} while ( (*u)*(*u) + (*v)*(*v) > 1.0);
+}
+
+void FillCounterRandomFloats(const CounterRandomKey &key, LECount firstLEIndex, LECount n, long draw, float low, float high, float *values)
+{
+	for (LECount i = 0; i < n; i++)
+		values[i] = CounterRandomFloat(key, firstLEIndex + i, draw, low, high);
+}
+
+void FillCounterRandomUniforms(const CounterRandomKey &key, LECount n, const uint32_t *leIDs, long draw, double *values)
+{
+	uint32_t counter[4], philoxKey[2], result[4];
+
+	// the doubles come two to a block; the top bit of the draw counter keeps them apart
+	// from the floats' blocks
+	counter[1] = (uint32_t)key.step;
+	counter[2] = (uint32_t)(draw / 2) | 0x80000000UL;
+	counter[3] = (uint32_t)key.stream;
+	philoxKey[0] = key.seed;
+	philoxKey[1] = (uint32_t)key.spillID;
+
+	for (LECount i = 0; i < n; i++)
+	{
+		uint32_t hi, lo;
+
+		counter[0] = leIDs[i];
+		Philox4x32(counter, philoxKey, result);
+
+		hi = result[2 * (draw % 2)] >> 5;		// 27 bits
+		lo = result[2 * (draw % 2) + 1] >> 6;	// 26 bits
+		values[i] = (hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0);
+	}
+}
+
@@ -0,0 +1,41 @@
+/*
+ *  CounterRandom.h
+ *  gnome
+ *
+ *  Stateless counter-based random numbers (Philox4x32-10).
+ *  Each draw is a function of a key and a counter only, so there is no shared
+ *  state - LEs can be processed in any order, or in parallel, and still get
+ *  the same random numbers.
+ *
+ */
+
+#ifndef __CounterRandom__
+#define __CounterRandom__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+typedef struct {
+	uint32_t	seed;
+	long		spillID;
+	long		step;		// model step number
+	long		stream;		// separates independent uses within a step (e.g. forecast and uncertainty LEs)
+} CounterRandomKey;
+
+// one Philox4x32-10 block - four 32 bit random numbers for the counter / key pair
+void DLL_API Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+// uniform in [low, high). draw numbers the random numbers used by one LE in a step
+float DLL_API CounterRandomFloat(const CounterRandomKey &key, LECount leIndex, long draw, float low, float high);
+void DLL_API CounterRandomVectorInUnitCircle(const CounterRandomKey &key, LECount leIndex, float *u, float *v);
+
+// vectorized version of CounterRandomFloat for the LEs firstLEIndex to firstLEIndex + n - 1
+void DLL_API FillCounterRandomFloats(const CounterRandomKey &key, LECount firstLEIndex, LECount n, long draw, float low, float high, float *values);
+
+// uniform doubles in [0, 1), 53 bits each, for the LEs with the given IDs (which needn't be
+// in order) - for the values set on LEs as they're released. draw numbers the doubles used
+// by one LE, and doesn't share random numbers with the draws of CounterRandomFloat
+void DLL_API FillCounterRandomUniforms(const CounterRandomKey &key, LECount n, const uint32_t *leIDs, long draw, double *values);
+
+#endif
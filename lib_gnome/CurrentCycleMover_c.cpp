@@ -30,6 +30,8 @@ CurrentCycleMover_c::CurrentCycleMover_c (TMap *owner, char *name) : GridCurrent
 	timeDep = 0;
 	bTimeFileActive = true;
 	fPatternStartPoint = MaxFlood;	// this should be user input
+	bStepTimeScaleSet = false;
+	fStepTimeScaleTime = 0;
 }
 #endif
 
@@ -38,6 +40,8 @@ CurrentCycleMover_c::CurrentCycleMover_c () : GridCurrentMover_c()
 	timeDep = 0;
 	bTimeFileActive = true;
 	fPatternStartPoint = MaxFlood;	// this should be user input
+	bStepTimeScaleSet = false;
+	fStepTimeScaleTime = 0;
 	//refP.pLat = 0;
 	//refP.pLong = 0;
 	refPt3D.p.pLong = 0;
@@ -67,8 +71,10 @@ OSErr CurrentCycleMover_c::PrepareForModelRun()
 
 
 OSErr CurrentCycleMover_c::PrepareForModelStep(const Seconds &model_time, const Seconds &time_step,
-											  bool uncertain, int numLESets, int *LESetsSizesList)
+											  bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 	char errmsg[256];
 	
@@ -119,6 +125,12 @@ OSErr CurrentCycleMover_c::PrepareForModelStep(const Seconds &model_time, const
 		}
 	}
 	timeGrid -> SetTimeCycleInfo(fraction,offset);
+
+	bStepTimeScaleSet = false;
+	fStepTimeScale = GetTimeScale(model_time);
+	fStepTimeScaleTime = model_time;
+	bStepTimeScaleSet = true;
+
 	return GridCurrentMover_c::PrepareForModelStep(model_time, time_step, uncertain, numLESets, LESetsSizesList);
 	
 	// figure out location in tide cycle ...
@@ -157,12 +169,38 @@ done:
 
 void CurrentCycleMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	fIsOptimizedForStep = false;
+	bStepTimeScaleSet = false;
 	bIsFirstStep = false;
 }
 
+// the time file scale, 1 without one
+double CurrentCycleMover_c::GetTimeScale(const Seconds& model_time)
+{
+	VelocityRec timeValue = {1.,1.};
+	OSErr err = 0;
+
+	if (bStepTimeScaleSet && model_time == fStepTimeScaleTime)
+		return fStepTimeScale;
+
+	if (timeDep && bTimeFileActive) {
+		// VelocityRec errVelocity={1,1};
+		// JLM 11/22/99, if there are no time file values, use zero not 1
+		VelocityRec errVelocity = {0, 1};
 
-OSErr CurrentCycleMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+		err = timeDep->GetTimeValue(model_time, &timeValue); // AH 07/10/2012
+		if (err)
+			timeValue = errVelocity;
+	}
+
+	return timeValue.u;	// magnitude contained in u field only
+}
+
+
+OSErr CurrentCycleMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 
 	//char errmsg[256];
 	if(!ref || !delta) {
@@ -184,7 +222,7 @@ OSErr CurrentCycleMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 	
 	WorldPoint3D zero_delta ={0,0,0.};
 	
-	for (int i = 0; i < n; i++) {
+	for (LECount i = 0; i < n; i++) {
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -210,13 +248,14 @@ OSErr CurrentCycleMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 	return noErr;
 }
 
-WorldPoint3D CurrentCycleMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D CurrentCycleMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {{0,0},0.};
 	WorldPoint3D refPoint;	
 	double dLong, dLat;
 	
-	VelocityRec scaledPatVelocity = {0.,0.}, timeValue = {1.,1.};
+	VelocityRec scaledPatVelocity = {0.,0.};
+	double timeScale = 1.;
 	Boolean useEddyUncertainty = false;	
 	OSErr err = 0;
 	char errmsg[256];
@@ -245,18 +284,10 @@ WorldPoint3D CurrentCycleMover_c::GetMove(const Seconds& model_time, Seconds tim
 	//printNote(errmsg);
 	
 	// get and apply our time file scale factor
-	if (timeDep && bTimeFileActive) {
-		// VelocityRec errVelocity={1,1};
-		// JLM 11/22/99, if there are no time file values, use zero not 1
-		VelocityRec errVelocity = {0, 1};
-
-		err = timeDep->GetTimeValue(model_time, &timeValue); // AH 07/10/2012
-		if (err)
-			timeValue = errVelocity;
-	}
+	timeScale = GetTimeScale(model_time);
 	
-	scaledPatVelocity.u *= myfabs(timeValue.u); // magnitude contained in u field only
-	scaledPatVelocity.v *= myfabs(timeValue.u); 	// multiplying tide by tide, don't want to change phase
+	scaledPatVelocity.u *= myfabs(timeScale); // magnitude contained in u field only
+	scaledPatVelocity.v *= myfabs(timeScale); 	// multiplying tide by tide, don't want to change phase
 	//scaledPatVelocity.u *= timeValue.u; // magnitude contained in u field only
 	//scaledPatVelocity.v *= timeValue.u; // magnitude contained in u field only
 
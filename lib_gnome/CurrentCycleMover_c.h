@@ -46,6 +46,11 @@ public:
 	//WORLDPOINTFH fVertexPtsH;	// may not need this if set pts in dagtree	
 	//long fNumNodes;
 	short fPatternStartPoint;	// maxflood, maxebb, etc
+
+	// the time file scale of the prepared step, the same for every LE
+	double			fStepTimeScale;
+	Seconds			fStepTimeScaleTime;
+	Boolean			bStepTimeScaleSet;
 	//float fTimeAlpha;
 	//char fTopFilePath[kMaxNameLen];
 	//Seconds model_start_time;	// for the diagnostic case - no time file look at the patterns in the file that have no absolute time associated with them
@@ -57,7 +62,7 @@ public:
 	~CurrentCycleMover_c () { Dispose (); }
 	virtual void		Dispose ();
 
-	//virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	//virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	
 	//LongPointHdl 		GetPointsHdl();
 	//long 					GetVelocityIndex(WorldPoint p);
@@ -82,12 +87,22 @@ public:
 	void				SetRefPosition(WorldPoint3D refPt3D) {this->refPt3D = refPt3D;}
 	WorldPoint3D		GetRefPosition() {return refPt3D;}
 
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	// GetMove is overridden, so the batch goes through it one LE at a time
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID)
+						{ return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+														 delta_lat, delta_lon, delta_z, spillType, spill_ID); }
+	virtual Boolean		CanFuseMove() { return false; }
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
+			double		GetTimeScale(const Seconds& model_time);
 			OSErr 		TextRead(char *path, char *topFilePath); 
-			OSErr		get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+			OSErr		get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
 	//OSErr 				ReorderPoints(TMap **newMap, short *bndry_indices, short *bndry_nums, short *bndry_type, long numBoundaryPts); 
 	//virtual Boolean 	CheckInterval(long &timeDataInterval, const Seconds& model_time);	// AH 07/17/2012
 	//virtual OSErr	 	SetInterval(char *errmsg, const Seconds& model_time); // AH 07/17/2012
@@ -10,6 +10,7 @@
 #include "CurrentMover_c.h"
 #include "CompFunctions.h"
 #include "MemUtils.h"
+#include "RunState.h"
 
 #ifdef pyGNOME
 #include "Replacements.h"
@@ -67,13 +68,29 @@ void CurrentMover_c::Dispose ()
 {
 	
 	this->DisposeUncertainty();
+	fTriHints.clear();
 	
 	Mover_c::Dispose ();
 }
 
+// Hint for the triangle search of LE leIndex, grown to n LEs first. Size it
+// before a parallel loop, each thread then only touches its own LE's hint.
+// A hint only saves search time, the result is the same without it, so
+// forecast and uncertainty LEs share them (their positions are close).
+long *CurrentMover_c::GetTriHint(LECount leIndex, LECount n)
+{
+	if (n > 0 && (long)fTriHints.size() < n)
+		fTriHints.resize(n, -1);
+
+	if (leIndex < 0 || leIndex >= (long)fTriHints.size())
+		return 0;
+
+	return &fTriHints[leIndex];
+}
+
 void CurrentMover_c::UpdateUncertaintyValues(Seconds elapsedTime)
 {
-	long i,n;
+	LECount n;
 	
 	fTimeUncertaintyWasSet = elapsedTime;
 	
@@ -81,40 +98,39 @@ void CurrentMover_c::UpdateUncertaintyValues(Seconds elapsedTime)
 	
 	n = _GetHandleSize((Handle)fUncertaintyListH)/sizeof(**fUncertaintyListH);
 	
+	this->SetUncertaintyValues(0,n);
+}
+
+// draws the factors of LEs start to end-1, in the order the model always has
+// (down then cross stream for each LE) so the random sequence is unchanged
+void CurrentMover_c::SetUncertaintyValues(LECount start, LECount end)
+{
+	LECount i;
+	float downLow, downHigh, crossLow, crossHigh;
+	LEUncertainRec *list;
+	
+	if(!fUncertaintyListH) return;
 	
-	for(i=0;i<n;i++)
+	if(fDownCurUncertainty<fUpCurUncertainty)
+		{ downLow = fDownCurUncertainty; downHigh = fUpCurUncertainty; }
+	else
+		{ downLow = fUpCurUncertainty; downHigh = fDownCurUncertainty; }
+	if(fLeftCurUncertainty<fRightCurUncertainty)
+		{ crossLow = fLeftCurUncertainty; crossHigh = fRightCurUncertainty; }
+	else
+		{ crossLow = fRightCurUncertainty; crossHigh = fLeftCurUncertainty; }
+	
+	list = *fUncertaintyListH;
+	for(i=start;i<end;i++)
 	{
-		LEUncertainRec localCopy;
-		memset(&localCopy,0,sizeof(LEUncertainRec));
-		
-		if(fDownCurUncertainty<fUpCurUncertainty)
-		{
-			localCopy.downStream = 
-			GetRandomFloat(fDownCurUncertainty,fUpCurUncertainty);
-		}
-		else
-		{
-			localCopy.downStream = 
-			GetRandomFloat(fUpCurUncertainty,fDownCurUncertainty);
-		}
-		if(fLeftCurUncertainty<fRightCurUncertainty)
-		{
-			localCopy.crossStream = 
-			GetRandomFloat(fLeftCurUncertainty,fRightCurUncertainty);
-		}
-		else
-		{
-			localCopy.crossStream = 
-			GetRandomFloat(fRightCurUncertainty,fLeftCurUncertainty);
-		}
-		INDEXH(fUncertaintyListH,i) = localCopy;
-		
-	}	
+		list[i].downStream = GetRandomFloat(downLow,downHigh);
+		list[i].crossStream = GetRandomFloat(crossLow,crossHigh);
+	}
 }
 
-OSErr CurrentMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// remove off map LEs
+OSErr CurrentMover_c::ReallocateUncertainty(LECount numLEs, short* statusCodes)	// remove off map LEs
 {
-	long i,numrec=0,uncertListSize,numLESetsStored;
+	LECount i,numrec=0,uncertListSize,numLESetsStored;
 	OSErr err=0;
 	
 	if (numLEs == 0 || ! statusCodes) return -1;	// shouldn't happen
@@ -123,7 +139,7 @@ OSErr CurrentMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// r
 
 	// check that (*fLESetSizesH)[0]==numLEs and size of fLESetSizesH == 1
 	uncertListSize = _GetHandleSize((Handle)fUncertaintyListH)/sizeof(LEUncertainRec);
-	numLESetsStored = _GetHandleSize((Handle)fLESetSizesH)/sizeof(long);
+	numLESetsStored = _GetHandleSize((Handle)fLESetSizesH)/sizeof(LECount);
 	
 	if (uncertListSize != numLEs) return -1;
 	if (numLESetsStored != 1) return -1;
@@ -155,16 +171,17 @@ OSErr CurrentMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// r
 	return noErr;
 }
 
-OSErr CurrentMover_c::AllocateUncertainty(int numLESets, int* LESetsSizesList)	// only passing in uncertainty list information
+OSErr CurrentMover_c::AllocateUncertainty(int numLESets, LECount* LESetsSizesList)	// only passing in uncertainty list information
 {
-	long i,j,numrec=0;
+	MemoryTag memoryTag(kMemUncertainty);
+	LECount i,j,numrec=0;
 	OSErr err=0;
 	
 	this->DisposeUncertainty(); // get rid of any old values
 	
 	if (numLESets == 0) return -1;	// shouldn't happen - if we get here there should be an uncertainty set
 	
-	if(!(fLESetSizesH = (LONGH)_NewHandle(sizeof(long)*numLESets)))goto errHandler;
+	if(!(fLESetSizesH = (LECountH)_NewHandle(sizeof(LECount)*numLESets)))goto errHandler;
 	
 	for (i = 0,numrec=0; i < numLESets ; i++) {
 		(*fLESetSizesH)[i]=numrec;
@@ -180,7 +197,7 @@ errHandler:
 	return memFullErr;
 }
 
-OSErr CurrentMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets, int* LESetsSizesList)
+OSErr CurrentMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets, LECount* LESetsSizesList)
 {
 	OSErr err = noErr;
 	long i;
@@ -208,8 +225,8 @@ OSErr CurrentMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESet
 	if(fLESetSizesH)
 	{	// check the LE sets are still the same, JLM 9/18/98
 		//TLEList *list;
-		long numrec, uncertListSize = 0, numLESetsStored;;
-		numLESetsStored = _GetHandleSize((Handle)fLESetSizesH)/sizeof(long);
+		LECount numrec, uncertListSize = 0, numLESetsStored;;
+		numLESetsStored = _GetHandleSize((Handle)fLESetSizesH)/sizeof(LECount);
 		if(numLESets != numLESetsStored) needToReInit = true;
 		else
 		{
@@ -239,7 +256,8 @@ OSErr CurrentMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESet
 		if (needToReAllocate)
 		{	// move to separate function, and probably should combine with 
 			//char errmsg[256] = "";
-			_SetHandleSize((Handle)fUncertaintyListH, numrec*sizeof(LEUncertainRec));
+			// new LEs are only appended, so leave room for the next releases
+			_GrowHandleSize((Handle)fUncertaintyListH, numrec*sizeof(LEUncertainRec));
 			//sprintf(errmsg,"Num LEs to Allocate = %ld, previous Size = %ld\n",numrec,uncertListSize);
 			//printNote(errmsg);
 			//for pyGNOME there should only be one uncertainty spill so fLESetSizes has only 1 value which is zero and doesn't need to be updated.
@@ -248,34 +266,7 @@ OSErr CurrentMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESet
 #endif
 			if (needToReInit) printNote("Uncertainty arrays are being reset\n");	// this shouldn't happen
 			//if(elapsedTime >= fTimeUncertaintyWasSet + fDuration) // we exceeded the persistance, time to update - either update whole list or just add on
-			for(i=uncertListSize;i<numrec;i++)
-			{
-				LEUncertainRec localCopy;
-				memset(&localCopy,0,sizeof(LEUncertainRec));
-				
-				if(fDownCurUncertainty<fUpCurUncertainty)
-				{
-					localCopy.downStream = 
-					GetRandomFloat(fDownCurUncertainty,fUpCurUncertainty);
-				}
-				else
-				{
-					localCopy.downStream = 
-					GetRandomFloat(fUpCurUncertainty,fDownCurUncertainty);
-				}
-				if(fLeftCurUncertainty<fRightCurUncertainty)
-				{
-					localCopy.crossStream = 
-					GetRandomFloat(fLeftCurUncertainty,fRightCurUncertainty);
-				}
-				else
-				{
-					localCopy.crossStream = 
-					GetRandomFloat(fRightCurUncertainty,fLeftCurUncertainty);
-				}
-				INDEXH(fUncertaintyListH,i) = localCopy;
-				
-			}	
+			this->SetUncertaintyValues(uncertListSize,numrec);
 		}
 	}
 	
@@ -300,8 +291,30 @@ OSErr CurrentMover_c::PrepareForModelRun()
 	return noErr;
 }
 
-OSErr CurrentMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+void CurrentMover_c::WriteRunState(RunStateWriter &writer)
+{
+	Mover_c::WriteRunState(writer);
+
+	writer.Put(bIsFirstStep);
+	writer.Put(fModelStartTime);
+	writer.PutHandle((Handle)fLESetSizesH);
+	writer.PutHandle((Handle)fUncertaintyListH);
+}
+
+bool CurrentMover_c::ReadRunState(RunStateReader &reader)
+{
+	// the triangle hints are only a cache of lookups, they are found again
+	return (Mover_c::ReadRunState(reader) &&
+			reader.Get(&bIsFirstStep) &&
+			reader.Get(&fModelStartTime) &&
+			reader.GetHandle((Handle *)&fLESetSizesH) &&
+			reader.GetHandle((Handle *)&fUncertaintyListH));
+}
+
+OSErr CurrentMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 	if (bIsFirstStep)
 		fModelStartTime = model_time;
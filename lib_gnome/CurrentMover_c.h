@@ -15,11 +15,12 @@
 #include "Mover_c.h"
 #include "GEOMETRY.H"
 #include "ExportSymbols.h"
+#include <vector>
 
 class DLL_API CurrentMover_c : virtual public Mover_c {
 	
 public:
-	LONGH			fLESetSizesH;			// cumulative total num le's in each set
+	LECountH			fLESetSizesH;			// cumulative total num le's in each set
 	LEUncertainRecH	fUncertaintyListH;		// list of uncertain factors list elements of type LEUncertainRec
 	Boolean bIsFirstStep;
 	Seconds fModelStartTime;
@@ -32,6 +33,8 @@ public:
 	
 	Boolean			bIAmPartOfACompoundMover;
 	Boolean			bIAmA3DMover;
+
+	std::vector<long>	fTriHints;			// each LE's triangle from the last lookup, by LE index
 	
 #ifndef pyGNOME
 	CurrentMover_c (TMap *owner, char *name);
@@ -40,17 +43,23 @@ public:
 	virtual			   ~CurrentMover_c () { Dispose (); }
 	virtual void		Dispose ();
 	virtual void 		UpdateUncertaintyValues(Seconds elapsedTime);
-	virtual OSErr		UpdateUncertainty(const Seconds& elapsedTime, int numLESets, int* LESetsSizesList);
-	virtual OSErr		AllocateUncertainty (int numLESets, int* LESetsSizesList);
-	virtual OSErr		ReallocateUncertainty(int numLEs, short* statusCodes);	
+	void				SetUncertaintyValues(LECount start, LECount end);
+	virtual OSErr		UpdateUncertainty(const Seconds& elapsedTime, int numLESets, LECount* LESetsSizesList);
+	virtual OSErr		AllocateUncertainty (int numLESets, LECount* LESetsSizesList);
+	virtual OSErr		ReallocateUncertainty(LECount numLEs, short* statusCodes);	
 	virtual void		DisposeUncertainty ();
+	long				*GetTriHint(LECount leIndex, LECount n);
 	
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
+	virtual void		WriteRunState(RunStateWriter &writer);
+	virtual bool		ReadRunState(RunStateReader &reader);
 	
 	//temp fix
 	virtual WorldRect GetGridBounds(){WorldRect theWorld = { -360000000, -90000000, 360000000, 90000000 }; return theWorld;}	
 	//virtual WorldRect GetGridBounds(){return theWorld;}	
+	// true when a forecast LE outside GetGridBounds always gets a zero move
+	virtual Boolean		MovesOnlyInGridBounds(){return false;}
 	virtual float		GetArrowDepth(){return 0.;}
 	virtual Boolean		IAmA3DMover(){return false;}
 	//virtual ClassID 	GetClassID () { return TYPE_CURRENTMOVER; }
@@ -0,0 +1,294 @@
+/*
+ *  CurvCellLocator.cpp
+ *  gnome
+ *
+ *  Built once, then only read, so lookups can run from several threads.
+ *
+ */
+
+#include <math.h>
+
+#include "CurvCellLocator.h"
+#include "DagTreeIO.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+CurvCellLocator::CurvCellLocator()
+{
+	fTopH = 0;
+	fPtsH = 0;
+	fNumRows = fNumCols = 0;
+	fLeft = fBottom = fRight = fTop = 0;
+	fBucketWidth = fBucketHeight = 1;
+	fNumBucketRows = fNumBucketCols = 0;
+}
+
+void CurvCellLocator::Dispose()
+{
+	fTopH = 0;
+	fPtsH = 0;
+	fNumRows = fNumCols = 0;
+	fNumBucketRows = fNumBucketCols = 0;
+	fCellTris.clear();
+	fCellCorners.clear();
+	fCellInside.clear();
+	fTriCell.clear();
+	fBucketStart.clear();
+	fBucketCells.clear();
+}
+
+void CurvCellLocator::GetBucket(long h, long v, long *col, long *row) const
+{
+	long c = (long)((h - fLeft) / fBucketWidth);
+	long r = (long)((v - fBottom) / fBucketHeight);
+
+	*col = c < 0 ? 0 : (c >= fNumBucketCols ? fNumBucketCols - 1 : c);
+	*row = r < 0 ? 0 : (r >= fNumBucketRows ? fNumBucketRows - 1 : r);
+}
+
+OSErr CurvCellLocator::Build(TopologyHdl topH, LongPointHdl ptsH, LONGH verdatToNetCDFH, long numCols_ext)
+{
+	const long kCellsPerBucket = 2;
+	long numTri, numPts, numCells, numWater = 0, t, k, cell, r, c, b;
+	long vertex[3], iIndex[3], jIndex[3], largestI, smallestJ, slot;
+	long minCol, maxCol, minRow, maxRow, h, v;
+	double aspect;
+	vector<long> fill;
+
+	Dispose();
+
+	if (!topH || !ptsH || !verdatToNetCDFH || numCols_ext < 2)
+		return -1;
+
+	numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
+	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
+	if (numTri <= 0 || numPts <= 0 || _GetHandleSize((Handle)verdatToNetCDFH)/(long)sizeof(long) < numPts)
+		return -1;
+
+	// the cell of each triangle, as GetRectIndexFromTriIndex finds it
+	fNumCols = numCols_ext - 1;
+	fTriCell.assign(numTri, -1);
+	for (t = 0; t < numTri; t++)
+	{
+		vertex[0] = (*topH)[t].vertex1;
+		vertex[1] = (*topH)[t].vertex2;
+		vertex[2] = (*topH)[t].vertex3;
+		for (k = 0; k < 3; k++)
+		{
+			if (vertex[k] < 0 || vertex[k] >= numPts || (*verdatToNetCDFH)[vertex[k]] < 0)
+				goto fail;
+			iIndex[k] = (*verdatToNetCDFH)[vertex[k]] / numCols_ext;
+			jIndex[k] = (*verdatToNetCDFH)[vertex[k]] % numCols_ext;
+		}
+		largestI = _max(iIndex[0], _max(iIndex[1], iIndex[2]));
+		smallestJ = _min(jIndex[0], _min(jIndex[1], jIndex[2]));
+		if (largestI < 1 || smallestJ >= fNumCols)
+			goto fail;
+		fTriCell[t] = (largestI - 1) * fNumCols + smallestJ;
+		fNumRows = _max(fNumRows, largestI);
+	}
+
+	numCells = fNumRows * fNumCols;
+	fCellTris.assign(2 * numCells, -1);
+	fCellCorners.assign(4 * numCells, -1);
+	fCellInside.assign(numCells, 0);
+	for (t = 0; t < numTri; t++)
+	{
+		cell = fTriCell[t];
+		r = cell / fNumCols;
+		c = cell % fNumCols;
+
+		slot = fCellTris[2 * cell] < 0 ? 0 : 1;
+		if (fCellTris[2 * cell + slot] >= 0)
+			goto fail;	// more than two triangles in the cell
+		fCellTris[2 * cell + slot] = t;
+
+		vertex[0] = (*topH)[t].vertex1;
+		vertex[1] = (*topH)[t].vertex2;
+		vertex[2] = (*topH)[t].vertex3;
+		for (k = 0; k < 3; k++)
+		{
+			long di = (*verdatToNetCDFH)[vertex[k]] / numCols_ext - r;
+			long dj = (*verdatToNetCDFH)[vertex[k]] % numCols_ext - c;
+
+			if (di < 0 || di > 1 || dj < 0 || dj > 1)
+				goto fail;	// not a corner of the cell
+			slot = di == 0 ? dj : 3 - dj;	// counted around the cell
+			if (fCellCorners[4 * cell + slot] >= 0 && fCellCorners[4 * cell + slot] != vertex[k])
+				goto fail;
+			fCellCorners[4 * cell + slot] = vertex[k];
+		}
+	}
+
+	for (cell = 0; cell < numCells; cell++)
+	{
+		if (fCellTris[2 * cell] < 0)
+			continue;	// land
+		if (fCellTris[2 * cell + 1] < 0)
+			goto fail;
+		for (k = 0; k < 4; k++)
+			if (fCellCorners[4 * cell + k] < 0)
+				goto fail;
+		// the side of the first edge the third corner is on, 0 if the cell is degenerate
+		fCellInside[cell] = Right_or_Left_of_Segment(ptsH, fCellCorners[4 * cell], fCellCorners[4 * cell + 1],
+													 (*ptsH)[fCellCorners[4 * cell + 2]]);
+		numWater++;
+	}
+
+	fLeft = fRight = (*ptsH)[0].h;
+	fBottom = fTop = (*ptsH)[0].v;
+	for (k = 1; k < numPts; k++)
+	{
+		fLeft = _min(fLeft, (*ptsH)[k].h);
+		fRight = _max(fRight, (*ptsH)[k].h);
+		fBottom = _min(fBottom, (*ptsH)[k].v);
+		fTop = _max(fTop, (*ptsH)[k].v);
+	}
+
+	// about kCellsPerBucket cells per bucket, with roughly square buckets
+	aspect = (fRight > fLeft && fTop > fBottom) ? (double)(fRight - fLeft) / (fTop - fBottom) : 1.;
+	fNumBucketCols = _max(1, (long)ceil(sqrt((double)numWater / kCellsPerBucket * aspect)));
+	fNumBucketRows = _max(1, (long)ceil((double)numWater / kCellsPerBucket / fNumBucketCols));
+	fBucketWidth = _max(1., (double)(fRight - fLeft) / fNumBucketCols + 1e-9);
+	fBucketHeight = _max(1., (double)(fTop - fBottom) / fNumBucketRows + 1e-9);
+
+	// count, then fill, each water cell going in every bucket its bounding box touches
+	fBucketStart.assign(fNumBucketRows * fNumBucketCols + 1, 0);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 1)
+		{
+			for (b = 0; b < fNumBucketRows * fNumBucketCols; b++)
+				fBucketStart[b + 1] += fBucketStart[b];
+			fBucketCells.resize(fBucketStart[fNumBucketRows * fNumBucketCols]);
+			fill.assign(fBucketStart.begin(), fBucketStart.end() - 1);
+		}
+		for (cell = 0; cell < numCells; cell++)
+		{
+			if (fCellTris[2 * cell] < 0)
+				continue;
+			minCol = minRow = fNumBucketCols + fNumBucketRows;
+			maxCol = maxRow = -1;
+			for (k = 0; k < 4; k++)
+			{
+				GetBucket((*ptsH)[fCellCorners[4 * cell + k]].h, (*ptsH)[fCellCorners[4 * cell + k]].v, &h, &v);
+				minCol = _min(minCol, h);
+				maxCol = _max(maxCol, h);
+				minRow = _min(minRow, v);
+				maxRow = _max(maxRow, v);
+			}
+			for (r = minRow; r <= maxRow; r++)
+			{
+				for (c = minCol; c <= maxCol; c++)
+				{
+					if (pass == 0)
+						fBucketStart[r * fNumBucketCols + c + 1]++;
+					else
+						fBucketCells[fill[r * fNumBucketCols + c]++] = cell;
+				}
+			}
+		}
+	}
+
+	fTopH = topH;
+	fPtsH = ptsH;
+
+	return noErr;
+
+fail:
+	Dispose();
+	return -1;
+}
+
+long CurvCellLocator::TriOfCell(long cell, LongPoint pt, Boolean strict) const
+{
+	long k, t;
+	int d1, d2, d3;
+
+	for (k = 0; k < 2; k++)
+	{
+		t = fCellTris[2 * cell + k];
+		// triangles are counterclockwise, inside is to the left of every edge
+		d1 = Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex1, (*fTopH)[t].vertex2, pt);
+		d2 = Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex2, (*fTopH)[t].vertex3, pt);
+		d3 = Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex3, (*fTopH)[t].vertex1, pt);
+		if (strict ? (d1 == -1 && d2 == -1 && d3 == -1) : (d1 != 1 && d2 != 1 && d3 != 1))
+			return t;
+	}
+
+	return -1;
+}
+
+// Walk the cells toward pt from startTri's, crossing the first cell edge pt is
+// outside of. Returns the triangle if pt is strictly inside it, or -1 if the
+// walk runs off the grid or onto land, lands on an edge or goes on too long
+// (the buckets decide those)
+long CurvCellLocator::WalkToTri(LongPoint pt, long startTri) const
+{
+	const long kMaxWalkSteps = 64;
+	long cell = GetCellIndex(startTri), step, r, c, t;
+	const long *corner;
+	int outside;
+
+	if (cell < 0)
+		return -1;
+
+	for (step = 0; step < kMaxWalkSteps; step++)
+	{
+		t = TriOfCell(cell, pt, true);
+		if (t >= 0)
+			return t;
+
+		outside = -fCellInside[cell];
+		if (outside == 0)
+			return -1;
+
+		r = cell / fNumCols;
+		c = cell % fNumCols;
+		corner = &fCellCorners[4 * cell];
+		// the edges of the corners (r,c), (r,c+1), (r+1,c+1), (r+1,c) face
+		// row r-1, column c+1, row r+1 and column c-1
+		if (Right_or_Left_of_Segment(fPtsH, corner[0], corner[1], pt) == outside) r--;
+		else if (Right_or_Left_of_Segment(fPtsH, corner[1], corner[2], pt) == outside) c++;
+		else if (Right_or_Left_of_Segment(fPtsH, corner[2], corner[3], pt) == outside) r++;
+		else if (Right_or_Left_of_Segment(fPtsH, corner[3], corner[0], pt) == outside) c--;
+		else return -1;	// on the cell's edges
+
+		if (r < 0 || r >= fNumRows || c < 0 || c >= fNumCols)
+			return -1;
+		cell = r * fNumCols + c;
+		if (fCellTris[2 * cell] < 0)
+			return -1;	// land
+	}
+
+	return -1;
+}
+
+long CurvCellLocator::WhatTriAmIIn(LongPoint pt, long *hint) const
+{
+	long col, row, b, i, t = -1;
+
+	if (!fTopH || !fPtsH)
+		return -1;
+
+	if (hint && *hint >= 0)
+		t = WalkToTri(pt, *hint);
+
+	if (t < 0)
+	{
+		if (pt.h < fLeft || pt.v < fBottom || pt.h > fRight || pt.v > fTop)
+			return -1;
+
+		// the cells are tested in order, so an LE on an edge gets the same
+		// triangle whatever its hint
+		GetBucket(pt.h, pt.v, &col, &row);
+		b = row * fNumBucketCols + col;
+		for (i = fBucketStart[b]; i < fBucketStart[b + 1] && t < 0; i++)
+			t = TriOfCell(fBucketCells[i], pt, false);
+	}
+
+	if (t >= 0 && hint)
+		*hint = t;
+	return t;
+}
@@ -0,0 +1,69 @@
+/*
+ *  CurvCellLocator.h
+ *  gnome
+ *
+ *  Point location on a curvilinear grid by its (i,j) cells instead of the
+ *  DAG of the triangles its water cells are split into. A lookup walks the
+ *  cells from the LE's last one, crossing the first cell edge the point is
+ *  outside of, and otherwise tests the few cells of a uniform bucket grid
+ *  over the cells' LongPoint bounds. The answer is the triangle of the cell
+ *  the point is in, the one the DAG finds.
+ *
+ */
+
+#ifndef __CurvCellLocator__
+#define __CurvCellLocator__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+
+class CurvCellLocator
+{
+	public:
+						CurvCellLocator();
+						~CurvCellLocator() {Dispose();}
+		void			Dispose();
+
+		// the grid's triangles are its water cells split in two, triangle
+		// vertex k is point verdatToNetCDFH[k] of a grid numCols_ext points
+		// wide. Fails if the triangles don't split cells that way. The
+		// handles are not copied, they must outlive the locator
+		OSErr			Build(TopologyHdl topH, LongPointHdl ptsH, LONGH verdatToNetCDFH, long numCols_ext);
+
+		// the triangle pt is in, -1 off the grid or on land. hint is the LE's
+		// triangle from before or -1, it is set to the answer when found
+		long			WhatTriAmIIn(LongPoint pt, long *hint = 0) const;
+
+		// the cell of a triangle, as GetRectIndexFromTriIndex has it
+		long			GetCellIndex(long tri) const {return tri >= 0 && tri < (long)fTriCell.size() ? fTriCell[tri] : -1;}
+
+		long			GetNumCells() const {return fNumRows * fNumCols;}
+
+	private:
+		TopologyHdl			fTopH;
+		LongPointHdl		fPtsH;
+		long				fNumRows, fNumCols;	// cells
+		// cell r*fNumCols+c: its triangles, -1 for land, and its corners
+		// (r,c), (r,c+1), (r+1,c+1), (r+1,c) as grid points
+		std::vector<long>	fCellTris;			// 2 per cell
+		std::vector<long>	fCellCorners;		// 4 per cell
+		std::vector<signed char> fCellInside;	// Right_or_Left_of_Segment of the inside of the cell's edges
+		std::vector<long>	fTriCell;
+
+		// the buckets, bucket b's cells are fBucketCells[fBucketStart[b], fBucketStart[b+1])
+		long				fLeft, fBottom, fRight, fTop;
+		double				fBucketWidth, fBucketHeight;
+		long				fNumBucketRows, fNumBucketCols;
+		std::vector<long>	fBucketStart;
+		std::vector<long>	fBucketCells;
+
+		void			GetBucket(long h, long v, long *col, long *row) const;
+		// the triangle of the cell pt is in, strictly inside or on the edges
+		long			TriOfCell(long cell, LongPoint pt, Boolean strict) const;
+		long			WalkToTri(LongPoint pt, long startTri) const;
+};
+
+#endif
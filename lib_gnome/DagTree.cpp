@@ -2,6 +2,7 @@
 #include "DagTreeIO.h"
 #include "DagTree.h"
 #include "MemUtils.h"
+#include "TriBucketIndex.h"
 
 using namespace std;
 
@@ -20,7 +21,12 @@ void TDagTree::GetVelocity(long ntri,VelocityRec *r)
 
 void TDagTree::GetVelocity(LongPoint lp,VelocityRec *r)
 {
-	long ntri = WhatTriAmIIn(lp);
+	GetVelocity(lp,r,0);
+};
+
+void TDagTree::GetVelocity(LongPoint lp,VelocityRec *r,long *triHint)
+{
+	long ntri = WhatTriAmIIn(lp,triHint);
 	if(ntri > -1 && fVelH)
 	{
 		r->u = (*fVelH)[ntri].u;
@@ -43,10 +49,18 @@ TDagTree::TDagTree(LongPoint **ptsHdl, Topology **topHdl, DAG** tree,VelocityFH
 	fVelH = velocityH;
 
 	fNumBranches = nBranches;
+
+	fBucketIndex = 0;
 }
 
 void TDagTree::Dispose ()
 {
+	if (fBucketIndex)
+	{
+		delete fBucketIndex;
+		fBucketIndex = 0;
+	}
+	fPackedTree.clear();
 	if (fPtsH)
 	{
 		DisposeHandle((Handle)fPtsH);
@@ -93,9 +107,123 @@ long TDagTree::FindThirdPoint(long p1, long p2, long index)
 //////////////////////////////////////////////////////////////////////
 long TDagTree::WhatTriAmIIn(LongPoint pt)
 {
+	if (fBucketIndex)
+	{
+		// the buckets only answer when pt is strictly inside a triangle,
+		// edges, vertices and points outside the grid still go to the DAG
+		long ntri = fBucketIndex->WhatTriAmIIn(pt);
+		if (ntri >= 0)
+			return ntri;
+	}
+	if (!fPackedTree.empty())
+		return WhatTriIsPtIn(fPackedTree,fTopH,fPtsH,pt);
 	return WhatTriIsPtIn(fTreeH,fTopH,fPtsH,pt);
 }
 
+// descend a packed copy of the DAG instead of fTreeH
+OSErr TDagTree::SetUsePackedTree(bool usePacked)
+{
+	DAGTreeStruct dagTree;
+
+	fPackedTree.clear();
+	if (!usePacked)
+		return 0;
+
+	dagTree.numBranches = fTreeH ? _GetHandleSize((Handle)fTreeH)/sizeof(DAG) : 0;
+	dagTree.treeHdl = fTreeH;
+	return MakePackedDagTree(dagTree, fTopH, fPtsH, fPackedTree);
+}
+
+// build (or drop) a bucket index over the topology, looked up before the DAG
+OSErr TDagTree::SetUseBucketIndex(bool useBuckets)
+{
+	OSErr err = 0;
+
+	if (fBucketIndex)
+	{
+		delete fBucketIndex;
+		fBucketIndex = 0;
+	}
+	if (!useBuckets)
+		return 0;
+
+	fBucketIndex = new TriBucketIndex();
+	err = fBucketIndex->Build(fTopH, fPtsH);
+	if (err)
+	{
+		delete fBucketIndex;
+		fBucketIndex = 0;
+	}
+	return err;
+}
+
+// Same as above, starting from the triangle in *triHint (an LE's triangle
+// on the previous step). LEs only move a few triangles per step so walking
+// the neighbors is much shorter than the DAG descent. The hint is updated
+// with the result, pass -1 if there is no previous triangle.
+long TDagTree::WhatTriAmIIn(LongPoint pt, long *triHint)
+{
+	long ntri = -1;
+
+	if (!triHint)
+		return WhatTriAmIIn(pt);
+
+	if (*triHint >= 0)
+		ntri = WalkToTri(pt, *triHint);
+
+	if (ntri < 0)
+		ntri = WhatTriAmIIn(pt);
+
+	*triHint = ntri;
+	return ntri;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Walk through the adjacent triangles toward pt, crossing the first edge
+// pt is to the right of. Returns the triangle if pt is strictly inside it,
+// the same triangle the DAG would find, or -1 if the walk runs off the
+// boundary, lands on an edge or goes on too long (the caller uses the DAG).
+//////////////////////////////////////////////////////////////////////
+long TDagTree::WalkToTri(LongPoint pt, long startTri)
+{
+	const long kMaxWalkSteps = 64;
+	long numTri, ntri = startTri, step;
+	long v1, v2, v3;
+	int d1, d2, d3;
+
+	if (!fTopH || !fPtsH)
+		return -1;
+
+	numTri = _GetHandleSize((Handle)fTopH)/sizeof(Topology);
+	if (startTri < 0 || startTri >= numTri)
+		return -1;
+
+	for (step = 0; step < kMaxWalkSteps; step++)
+	{
+		v1 = (*fTopH)[ntri].vertex1;
+		v2 = (*fTopH)[ntri].vertex2;
+		v3 = (*fTopH)[ntri].vertex3;
+
+		// triangles are counterclockwise, inside is to the left of every edge
+		d3 = Right_or_Left_Point(v1, v2, pt);	// edge opposite vertex3
+		if (d3 == 1) {ntri = (*fTopH)[ntri].adjTri3; goto next;}
+		d1 = Right_or_Left_Point(v2, v3, pt);
+		if (d1 == 1) {ntri = (*fTopH)[ntri].adjTri1; goto next;}
+		d2 = Right_or_Left_Point(v3, v1, pt);
+		if (d2 == 1) {ntri = (*fTopH)[ntri].adjTri2; goto next;}
+
+		if (d1 == -1 && d2 == -1 && d3 == -1)
+			return ntri;
+		return -1;	// on an edge or vertex, let the DAG decide
+
+next:
+		if (ntri < 0)
+			return -1;	// walked out of the grid
+	}
+
+	return -1;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // 																												//
 // Right_or_Left decides if a test point is to the right or left								//
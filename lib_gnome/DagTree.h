@@ -2,6 +2,7 @@
 #ifndef __DAGTREE__
 #define __DAGTREE__
 
+#include <vector>
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "RectUtils.h"
@@ -25,6 +26,21 @@ typedef struct DAG
 	long				branchRight;	// index in node_or_triPtr;
 } DAG,*DAGPtr,**DAGHdl;
 
+// A DAG node laid out for the descent: 32 bit indices, the split segment's
+// end points inlined and the topology lookups done up front. Built from a
+// DAGTreeStruct with the nodes in breadth first order.
+typedef struct PackedDAGNode
+{
+	int32_t				h1, v1, h2, v2;		// first and second point of the split segment
+	int32_t				firstPoint, secondPoint;
+	int32_t				thirdLeft;			// third point of triLeft, negative for the infinite triangle
+	int32_t				triLeft;
+	int32_t				triRight;			// -1 if the segment is on the boundary
+	int32_t				thirdRight;
+	int32_t				branchLeft;			// node indices, -1 ends the descent
+	int32_t				branchRight;
+} PackedDAGNode;
+
 typedef struct DAGTreeStruct	
 {
 	long numBranches;					// number of elements in the DAG tree
@@ -34,6 +50,8 @@ typedef struct DAGTreeStruct
 
 DAGTreeStruct  MakeDagTree(TopologyHdl topoHdl, LongPoint **pointList, char *errStr);
 
+class TriBucketIndex;
+
 class TDagTree
 {
 	public:
@@ -42,6 +60,8 @@ class TDagTree
 		LongPointHdl 		fPtsH;
 		TopologyHdl			fTopH;
 		VelocityFH			fVelH;
+		TriBucketIndex		*fBucketIndex;		// tried before the DAG if set
+		std::vector<PackedDAGNode>	fPackedTree;	// descended instead of fTreeH if not empty
 		//long**				longH;
 
 		int Right_or_Left_Point(long ref_p1, long ref_p2, LongPoint test_p1);
@@ -53,12 +73,19 @@ class TDagTree
 		virtual void 	Dispose();
 
 		long			WhatTriAmIIn(LongPoint pt);
+		long			WhatTriAmIIn(LongPoint pt, long *triHint);
+		long			WalkToTri(LongPoint pt, long startTri);
+		OSErr			SetUseBucketIndex(bool useBuckets);
+		bool			UsesBucketIndex() {return fBucketIndex != 0;}
+		OSErr			SetUsePackedTree(bool usePacked);
+		bool			UsesPackedTree() {return !fPackedTree.empty();}
 		LongPointHdl	GetPointsHdl(){return fPtsH;};
 		TopologyHdl		GetTopologyHdl(){return fTopH;};
 		VelocityFH		GetVelocityHdl(){return fVelH;};
 		DAGHdl			GetDagTreeHdl(){return fTreeH;};
 		void			GetVelocity(long ntri,VelocityRec *r);
 		void			GetVelocity(LongPoint lp,VelocityRec *r);
+		void			GetVelocity(LongPoint lp,VelocityRec *r,long *triHint);
 };
 
 #endif 
@@ -6,6 +6,7 @@
 
 #include "RectUtils.h"
 #include "DagTreeIO.h" 
+#include "TextLines.h"
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -36,7 +37,7 @@ Boolean IsTIndexedDagTreeHeaderLine(const char *s, long *numRecs)
 }
 
 
-OSErr ReadTIndexedDagTreeBody(vector<string> &linesInFile, long *line,
+OSErr ReadTIndexedDagTreeBody(TextLines &linesInFile, long *line,
 							  DAGTreeStruct *dagTree,
 							  char *errmsg, long numRecs)
 {
@@ -82,6 +83,15 @@ done:
 	return err;
 }
 
+OSErr ReadTIndexedDagTreeBody(vector<string> &linesInFile, long *line,
+							  DAGTreeStruct *dagTree,
+							  char *errmsg, long numRecs)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTIndexedDagTreeBody(lines, line, dagTree, errmsg, numRecs);
+}
+
 OSErr ReadTIndexedDagTreeBody(CHARH fileBufH, long *line,
 							  DAGTreeStruct *dagTree,
 							  char *errmsg, long numRecs)
@@ -128,12 +138,12 @@ Boolean IsTVerticesHeaderLine(const char *s, long *numPts)
 
 
 // Note: '*line' must contain the line# at which the vertex data begins
-OSErr ReadTVerticesBody(vector<string> &linesInFile, long *line,
+OSErr ReadTVerticesBody(TextLines &linesInFile, long *line,
 						LongPointHdl *pointsH, FLOATH *depthsH, char *errmsg,
 						long numPoints, bool wantDepths)
 {
 	OSErr err = -1;
-	string currentLine;
+	TextLine currentLine;
 
 	double x, y, z;
 
@@ -225,6 +235,15 @@ done:
 	return err;
 }
 
+OSErr ReadTVerticesBody(vector<string> &linesInFile, long *line,
+						LongPointHdl *pointsH, FLOATH *depthsH, char *errmsg,
+						long numPoints, bool wantDepths)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTVerticesBody(lines, line, pointsH, depthsH, errmsg, numPoints, wantDepths);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 OSErr ReadTVerticesBody(CHARH fileBufH, long *line,
@@ -241,7 +260,7 @@ OSErr ReadTVerticesBody(CHARH fileBufH, long *line,
 
 
 // Note: '*line' must contain the line# at which the vertex data begins
-OSErr ReadTVertices(vector<string> &linesInFile, long *line,
+OSErr ReadTVertices(TextLines &linesInFile, long *line,
 					LongPointHdl *pointsH, FLOATH *depthsH,
 					char* errmsg)
 {
@@ -262,6 +281,15 @@ OSErr ReadTVertices(vector<string> &linesInFile, long *line,
 	return err;
 }
 
+OSErr ReadTVertices(vector<string> &linesInFile, long *line,
+					LongPointHdl *pointsH, FLOATH *depthsH,
+					char* errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTVertices(lines, line, pointsH, depthsH, errmsg);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 OSErr ReadTVertices(CHARH fileBufH, long *line, LongPointHdl *pointsH, FLOATH *depthsH, char *errmsg)
@@ -290,7 +318,7 @@ Boolean IsTTopologyHeaderLine(char *s, long *numPts)
 
 
 // Note: '*line' must contain the line# at which the vertex data begins
-OSErr ReadTTopologyBody(vector<string> &linesInFile, long *line,
+OSErr ReadTTopologyBody(TextLines &linesInFile, long *line,
 						TopologyHdl *topH, VelocityFH *velocityH,
 						char *errmsg, long numRecs, Boolean wantVelData)
 {
@@ -360,6 +388,15 @@ done:
 	return err;
 }
 
+OSErr ReadTTopologyBody(vector<string> &linesInFile, long *line,
+						TopologyHdl *topH, VelocityFH *velocityH,
+						char *errmsg, long numRecs, Boolean wantVelData)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTTopologyBody(lines, line, topH, velocityH, errmsg, numRecs, wantVelData);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 OSErr ReadTTopologyBody(CHARH fileBufH, long *line,
@@ -375,7 +412,7 @@ OSErr ReadTTopologyBody(CHARH fileBufH, long *line,
 }
 
 
-OSErr ReadTTopology(vector<string> &linesInFile, long *line,
+OSErr ReadTTopology(TextLines &linesInFile, long *line,
 					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg)
 { 
 	OSErr err = -1;
@@ -394,6 +431,14 @@ OSErr ReadTTopology(vector<string> &linesInFile, long *line,
 	return ReadTTopologyBody(linesInFile, line, topH, velocityH, errmsg, numRecs, wantVelData);
 }
 
+OSErr ReadTTopology(vector<string> &linesInFile, long *line,
+					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTTopology(lines, line, topH, velocityH, errmsg);
+}
+
 OSErr ReadTTopology(CHARH fileBufH, long *line,
 					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg)
 {
@@ -444,7 +489,13 @@ long FindTriThirdPoint(long **longH,long p1, long p2, long index)
 /////////////////////////////////////////////////////////////////////////////////////////
 int	Right_or_Left_of_Segment(LongPointHdl ptsH,long ref_p1,long ref_p2, LongPoint test_p1)
 {
-	long ref_p1_h, ref_p1_v, ref_p2_h, ref_p2_v;	// lat (h) and long (v) for ref points
+	// Find the lat and lon associated with each point
+	return Right_or_Left_of_Segment((*ptsH)[ref_p1].h, (*ptsH)[ref_p1].v, (*ptsH)[ref_p2].h, (*ptsH)[ref_p2].v, test_p1);
+}
+
+// same, with the reference segment's points given directly
+int	Right_or_Left_of_Segment(long ref_p1_h, long ref_p1_v, long ref_p2_h, long ref_p2_v, LongPoint test_p1)
+{
 	long test_p1_h, test_p1_v;	
 													// lat (h) and long (v) for test point
 	double ref_h, ref_v;								// reference vector components
@@ -458,11 +509,6 @@ int	Right_or_Left_of_Segment(LongPointHdl ptsH,long ref_p1,long ref_p2, LongPoin
 	// Make sure this code matches the code that generated the triangles !!!
 	// (Right now that other code is in CATS)
 	
-	// Find the lat and lon associated with each point
-	ref_p1_h = (*ptsH)[ref_p1].h;
-	ref_p1_v = (*ptsH)[ref_p1].v;
-	ref_p2_h = (*ptsH)[ref_p2].h;
-	ref_p2_v = (*ptsH)[ref_p2].v;
 	test_p1_h = test_p1.h;
 	test_p1_v = test_p1.v;
 	
@@ -504,6 +550,104 @@ int	Right_or_Left_of_Segment(LongPointHdl ptsH,long ref_p1,long ref_p2, LongPoin
 
 ////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////
+// The DAG descent ended on the infinite triangle right of the segment
+// firstPoint-secondPoint. Check whether pt is a vertex of triNum, then the
+// triangles sharing a vertex with it. Returns -8 if none has it.
+//////////////////////////////////////////////////////////////////////
+long FindTriNearVertices(TopologyHdl topH, LongPointHdl ptsH, LongPoint pt, long firstPoint, long secondPoint, long thirdPoint, long triNum)
+{
+	short direction;
+	long triNumIndex = triNum*6;
+	long** longH = (long**)(topH);  
+
+	// occasionally lost right on a vertex - this came up in dispersed oil Gnome
+	if ((pt.h == (*ptsH)[firstPoint].h && pt.v == (*ptsH)[firstPoint].v) ||
+		(pt.h == (*ptsH)[secondPoint].h && pt.v == (*ptsH)[secondPoint].v) ||
+		(pt.h == (*ptsH)[thirdPoint].h && pt.v == (*ptsH)[thirdPoint].v))
+	{
+		//char errmsg[256];
+		//sprintf(errmsg,"on vertex triNum = %ld\n",triNum);
+		//printNote(errmsg);
+		return (triNum);
+	}
+
+	/////////////////////////////////////////////////
+	// check all triangles that include any of the original vertices in case we're close
+	// this caused large runs to grind to a halt when LEs beached
+	long numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
+	long testPt1,testPt2,testPt3,triIndex;
+	for (triIndex=0;triIndex<numTri;triIndex++)
+	{
+		testPt1 = (*longH)[triIndex*6];
+		testPt2 = (*longH)[triIndex*6+1];
+		testPt3 = (*longH)[triIndex*6+2];
+
+		if(firstPoint==testPt1 || firstPoint==testPt2 || firstPoint==testPt3 ||
+			secondPoint==testPt1 || secondPoint==testPt2 || secondPoint==testPt3 ||
+			thirdPoint==testPt1 || thirdPoint==testPt2 || thirdPoint==testPt3
+			&& triIndex != triNumIndex)	// already checked main triangle
+		{
+			direction = Right_or_Left_of_Segment(ptsH,testPt1,testPt2,pt);
+			if (direction == -1) // left
+			{
+				// Am I in the triangle directly to the left of the segment?
+				direction = Right_or_Left_of_Segment(ptsH,testPt2,testPt3,pt);
+				if(direction == -1)
+				{
+					direction = Right_or_Left_of_Segment(ptsH,testPt3,testPt1,pt);
+					if(direction == -1)
+					{
+						//char errmsg[256];
+						//sprintf(errmsg,"first try triNum = %ld\n",triIndex);
+						//printNote(errmsg);
+						return (triIndex); 
+					}
+				}
+			}
+		}
+	}
+	//long numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
+	//long testPt1,testPt2,testPt3,triIndex;
+	/*for (triIndex=0;triIndex<numTri;triIndex++)
+	{
+		testPt1 = (*longH)[triIndex*6];
+		testPt2 = (*longH)[triIndex*6+1];
+		testPt3 = (*longH)[triIndex*6+2];
+
+		//if(firstPoint==testPt1 || firstPoint==testPt2 || firstPoint==testPt3 ||
+			//secondPoint==testPt1 || secondPoint==testPt2 || secondPoint==testPt3 ||
+			//thirdPoint==testPt1 || thirdPoint==testPt2 || thirdPoint==testPt3
+			//&& triIndex != triNumIndex)	// already checked main triangle
+		{
+			direction = Right_or_Left_of_Segment(ptsH,testPt1,testPt2,pt);
+			if (direction == -1) // left
+			{
+				// Am I in the triangle directly to the left of the segment?
+				direction = Right_or_Left_of_Segment(ptsH,testPt2,testPt3,pt);
+				if(direction == -1)
+				{
+					direction = Right_or_Left_of_Segment(ptsH,testPt3,testPt1,pt);
+					if(direction == -1)
+					{
+						char errmsg[256];
+						sprintf(errmsg,"second try triNum = %ld\n",triIndex);
+						printNote(errmsg);
+						return (triIndex); 
+					}
+				}
+			}
+		}
+	}*/
+	/////////////////////////////////////////////////
+	//printNote("Got Here\n");
+	return(-8); 				// This is a special case caused by not being able
+								// to confirm that a point is in the infinite triangle.
+								// To see the change, have the function return -8 for triNum and
+								// give that triangle a unique color for plotting.		
+}
+
+
 /////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////
 // Navigate the DAG tree.  Given a point on the surface of the earth
@@ -602,96 +746,132 @@ long WhatTriIsPtIn(DAGHdl treeH,TopologyHdl topH, LongPointHdl ptsH,LongPoint pt
 checkTriPts:
 		if (i == -8)
 		{
-			// occasionally lost right on a vertex - this came up in dispersed oil Gnome
-			if ((pt.h == (*ptsH)[firstPoint].h && pt.v == (*ptsH)[firstPoint].v) ||
-				(pt.h == (*ptsH)[secondPoint].h && pt.v == (*ptsH)[secondPoint].v) ||
-				(pt.h == (*ptsH)[thirdPoint].h && pt.v == (*ptsH)[thirdPoint].v))
-			{
-				//char errmsg[256];
-				//sprintf(errmsg,"on vertex triNum = %ld\n",triNum);
-				//printNote(errmsg);
-				return (triNum);
-			}
-
-			/////////////////////////////////////////////////
-			// check all triangles that include any of the original vertices in case we're close
-			// this caused large runs to grind to a halt when LEs beached
-			long numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
-			long testPt1,testPt2,testPt3,triIndex;
-			for (triIndex=0;triIndex<numTri;triIndex++)
-			{
-				testPt1 = (*longH)[triIndex*6];
-				testPt2 = (*longH)[triIndex*6+1];
-				testPt3 = (*longH)[triIndex*6+2];
-
-				if(firstPoint==testPt1 || firstPoint==testPt2 || firstPoint==testPt3 ||
-					secondPoint==testPt1 || secondPoint==testPt2 || secondPoint==testPt3 ||
-					thirdPoint==testPt1 || thirdPoint==testPt2 || thirdPoint==testPt3
-					&& triIndex != triNumIndex)	// already checked main triangle
-				{
-					direction = Right_or_Left_of_Segment(ptsH,testPt1,testPt2,pt);
-					if (direction == -1) // left
-					{
-						// Am I in the triangle directly to the left of the segment?
-						direction = Right_or_Left_of_Segment(ptsH,testPt2,testPt3,pt);
-						if(direction == -1)
-						{
-							direction = Right_or_Left_of_Segment(ptsH,testPt3,testPt1,pt);
-							if(direction == -1)
-							{
-								//char errmsg[256];
-								//sprintf(errmsg,"first try triNum = %ld\n",triIndex);
-								//printNote(errmsg);
-								return (triIndex); 
-							}
-						}
-					}
-				}
-			}
-			//long numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
-			//long testPt1,testPt2,testPt3,triIndex;
-			/*for (triIndex=0;triIndex<numTri;triIndex++)
-			{
-				testPt1 = (*longH)[triIndex*6];
-				testPt2 = (*longH)[triIndex*6+1];
-				testPt3 = (*longH)[triIndex*6+2];
-
-				//if(firstPoint==testPt1 || firstPoint==testPt2 || firstPoint==testPt3 ||
-					//secondPoint==testPt1 || secondPoint==testPt2 || secondPoint==testPt3 ||
-					//thirdPoint==testPt1 || thirdPoint==testPt2 || thirdPoint==testPt3
-					//&& triIndex != triNumIndex)	// already checked main triangle
-				{
-					direction = Right_or_Left_of_Segment(ptsH,testPt1,testPt2,pt);
-					if (direction == -1) // left
-					{
-						// Am I in the triangle directly to the left of the segment?
-						direction = Right_or_Left_of_Segment(ptsH,testPt2,testPt3,pt);
-						if(direction == -1)
-						{
-							direction = Right_or_Left_of_Segment(ptsH,testPt3,testPt1,pt);
-							if(direction == -1)
-							{
-								char errmsg[256];
-								sprintf(errmsg,"second try triNum = %ld\n",triIndex);
-								printNote(errmsg);
-								return (triIndex); 
-							}
-						}
-					}
-				}
-			}*/
-			/////////////////////////////////////////////////
-			//printNote("Got Here\n");
-			return(-8); 				// This is a special case caused by not being able
-										// to confirm that a point is in the infinite triangle.
-										// To see the change, have the function return -8 for triNum and
-										// give that triangle a unique color for plotting.		
+			return FindTriNearVertices(topH,ptsH,pt,firstPoint,secondPoint,thirdPoint,triNum);
 		}
 	}
 	return -1; // JLM, we already checked it was not in the triangle 
 }
 
 
+//////////////////////////////////////////////////////////////////////
+// Pack dagTree for WhatTriIsPtIn below. Each node gets the values the
+// descent would read from the topology and points, and the nodes are
+// renumbered breadth first so the top of the tree is contiguous.
+// The packed tree refers to topH and ptsH, it doesn't copy them.
+//////////////////////////////////////////////////////////////////////
+OSErr MakePackedDagTree(DAGTreeStruct dagTree, TopologyHdl topH, LongPointHdl ptsH, std::vector<PackedDAGNode> &packedTree)
+{
+	long numNodes = dagTree.numBranches, numPts, numTri, i, node;
+	long dagIndex, triNum, triNumIndex, firstPoint, secondPoint, triRight;
+	long** longH = (long**)(topH);
+	std::vector<long> newIndex, order;
+
+	packedTree.clear();
+	if (!dagTree.treeHdl || !topH || !ptsH || numNodes <= 0)
+		return -1;
+
+	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
+	numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
+	if (numPts > INT32_MAX || numTri > INT32_MAX || numNodes > INT32_MAX)
+		return -1;
+	for (i = 0; i < numPts; i++)
+	{
+		if ((*ptsH)[i].h < INT32_MIN || (*ptsH)[i].h > INT32_MAX || (*ptsH)[i].v < INT32_MIN || (*ptsH)[i].v > INT32_MAX)
+			return -1;
+	}
+
+	// breadth first from the root, nodes are shared so only visit each once
+	newIndex.assign(numNodes, -1);
+	order.reserve(numNodes);
+	newIndex[0] = 0;
+	order.push_back(0);
+	for (i = 0; i < (long)order.size(); i++)
+	{
+		long branch[2] = {(*dagTree.treeHdl)[order[i]].branchLeft, (*dagTree.treeHdl)[order[i]].branchRight};
+		for (int k = 0; k < 2; k++)
+		{
+			if (branch[k] < 0 || branch[k] >= numNodes || newIndex[branch[k]] >= 0)
+				continue;
+			newIndex[branch[k]] = order.size();
+			order.push_back(branch[k]);
+		}
+	}
+
+	packedTree.resize(order.size());
+	for (i = 0; i < (long)order.size(); i++)
+	{
+		DAG dag = (*dagTree.treeHdl)[order[i]];
+		PackedDAGNode &packed = packedTree[i];
+
+		memset(&packed, 0, sizeof(packed));
+		packed.branchLeft = dag.branchLeft < 0 || dag.branchLeft >= numNodes ? dag.branchLeft : newIndex[dag.branchLeft];
+		packed.branchRight = dag.branchRight < 0 || dag.branchRight >= numNodes ? dag.branchRight : newIndex[dag.branchRight];
+		if (dag.branchLeft == -1 || dag.branchRight == -1)
+			continue;	// the descent stops here without reading the node
+
+		dagIndex = dag.topoIndex;
+		triNum = dagIndex/6;
+		triNumIndex = triNum*6;
+		firstPoint = (*longH)[dagIndex];
+		secondPoint = (*longH)[triNumIndex + ((dagIndex+1)%3)];
+		triRight = (*longH)[triNumIndex + ((dagIndex+2)%3) + 3];
+
+		packed.h1 = (*ptsH)[firstPoint].h;
+		packed.v1 = (*ptsH)[firstPoint].v;
+		packed.h2 = (*ptsH)[secondPoint].h;
+		packed.v2 = (*ptsH)[secondPoint].v;
+		packed.firstPoint = firstPoint;
+		packed.secondPoint = secondPoint;
+		packed.thirdLeft = (*longH)[triNumIndex + ((dagIndex+2)%3)];
+		packed.triLeft = triNum;
+		packed.triRight = triRight;
+		packed.thirdRight = triRight == -1 ? -1 : FindTriThirdPoint(longH,secondPoint,firstPoint,triRight*6);
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// WhatTriIsPtIn on a packed tree, same descent and same answers
+//////////////////////////////////////////////////////////////////////
+long WhatTriIsPtIn(const std::vector<PackedDAGNode> &packedTree, TopologyHdl topH, LongPointHdl ptsH, LongPoint pt)
+{
+	long i = 0, thirdPoint = -1;
+	long numNodes = packedTree.size();
+
+	if (numNodes <= 0)
+		return -1;
+	thirdPoint = packedTree[0].thirdLeft;
+
+	while (i >= 0 && i < numNodes && packedTree[i].branchLeft != -1 && packedTree[i].branchRight != -1)
+	{
+		const PackedDAGNode &node = packedTree[i];
+
+		if (Right_or_Left_of_Segment(node.h1, node.v1, node.h2, node.v2, pt) == -1) // left
+		{
+			thirdPoint = node.thirdLeft;
+			if (thirdPoint >= 0 &&
+				Right_or_Left_of_Segment(ptsH, node.secondPoint, thirdPoint, pt) == -1 &&
+				Right_or_Left_of_Segment(ptsH, thirdPoint, node.firstPoint, pt) == -1)
+				return node.triLeft;
+			i = node.branchLeft;
+		}
+		else // right or on the line
+		{
+			if (node.triRight == -1)
+				return FindTriNearVertices(topH,ptsH,pt,node.firstPoint,node.secondPoint,thirdPoint,node.triLeft);
+			thirdPoint = node.thirdRight;
+			if (thirdPoint >= 0 &&
+				Right_or_Left_of_Segment(ptsH, thirdPoint, node.secondPoint, pt) == -1 &&
+				Right_or_Left_of_Segment(ptsH, node.firstPoint, thirdPoint, pt) == -1)
+				return node.triRight;
+			i = node.branchRight;
+		}
+	}
+	return -1;
+}
+
+
 bool IsPtCurVerticesHeaderLine(const string &strIn, long &numPts, long &numLandPts)
 {
 	string strInLowerCase = strIn;
@@ -757,7 +937,7 @@ Boolean IsBoundaryPointsHeaderLine(const char *s, long *numBoundaryPts)
 
 
 // Note: '*line' must contain the line# at which the vertex data begins
-OSErr ReadWaterBoundaries(vector<string> &linesInFile, long *line,
+OSErr ReadWaterBoundaries(TextLines &linesInFile, long *line,
 						  LONGH *waterBoundaries,
 						  long numWaterBoundaries,
 						  long numBoundaryPts, char *errmsg)
@@ -808,6 +988,16 @@ done:
 	return err;
 }
 
+OSErr ReadWaterBoundaries(vector<string> &linesInFile, long *line,
+						  LONGH *waterBoundaries,
+						  long numWaterBoundaries,
+						  long numBoundaryPts, char *errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadWaterBoundaries(lines, line, waterBoundaries, numWaterBoundaries, numBoundaryPts, errmsg);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 OSErr ReadWaterBoundaries(CHARH fileBufH, long *line,
@@ -826,7 +1016,7 @@ OSErr ReadWaterBoundaries(CHARH fileBufH, long *line,
 
 // Note: '*line' must contain the line# at which the vertex data begins
 // May want to combine this with read vertices if it becomes a mandatory component of PtCur files
-OSErr ReadBoundarySegs(vector<string> &linesInFile, long *line,
+OSErr ReadBoundarySegs(TextLines &linesInFile, long *line,
 					   LONGH *boundarySegs, long numSegs, char *errmsg)
 {
 	OSErr err = 0;
@@ -877,6 +1067,14 @@ done:
 	return err;
 }
 
+OSErr ReadBoundarySegs(vector<string> &linesInFile, long *line,
+					   LONGH *boundarySegs, long numSegs, char *errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadBoundarySegs(lines, line, boundarySegs, numSegs, errmsg);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 OSErr ReadBoundarySegs(CHARH fileBufH, long *line,
@@ -891,7 +1089,7 @@ OSErr ReadBoundarySegs(CHARH fileBufH, long *line,
 
 // Note: '*line' must contain the line# at which the vertex data begins
 // May want to combine this with read vertices if it becomes a mandatory component of PtCur files
-OSErr ReadBoundaryPts(vector<string> &linesInFile, long *line,
+OSErr ReadBoundaryPts(TextLines &linesInFile, long *line,
 					  LONGH *boundaryPts, long numPts, char *errmsg)
 {
 	OSErr err = 0;
@@ -933,6 +1131,14 @@ done:
 	return err;
 }
 
+OSErr ReadBoundaryPts(vector<string> &linesInFile, long *line,
+					  LONGH *boundaryPts, long numPts, char *errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadBoundaryPts(lines, line, boundaryPts, numPts, errmsg);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 // May want to combine this with read vertices if it becomes a mandatory component of PtCur files
@@ -963,7 +1169,7 @@ Boolean IsTransposeArrayHeaderLine(const char *s, long *numPts)
 
 // Note: '*line' must contain the line# at which the vertex data begins
 // May want to combine this with read vertices if it becomes a mandatory component of PtCur files
-OSErr ReadTransposeArray(vector<string> &linesInFile, long *line,
+OSErr ReadTransposeArray(TextLines &linesInFile, long *line,
 						 LONGH *transposeArray, long numPts, char *errmsg)
 {
 	OSErr err = 0;
@@ -1002,6 +1208,14 @@ done:
 	return err;
 }
 
+OSErr ReadTransposeArray(vector<string> &linesInFile, long *line,
+						 LONGH *transposeArray, long numPts, char *errmsg)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTransposeArray(lines, line, transposeArray, numPts, errmsg);
+}
+
 
 // Note: '*line' must contain the line# at which the vertex data begins
 // May want to combine this with read vertices if it becomes a mandatory component of PtCur files
@@ -5,12 +5,16 @@
 #include <vector>
 #include "DagTree.h"
 #include "RectUtils.h"
+#include "TextLines.h"
 
 OSErr ReadTIndexedDagTree(CHARH fileBUFH,long *line,DAGTreeStruct *dagTree,char* errmsg);
 
 bool IsTIndexedDagTreeHeaderLine(const std::string &strIn, long &numRecs);
 Boolean IsTIndexedDagTreeHeaderLine(const char *s, long *numRecs);
 
+OSErr ReadTIndexedDagTreeBody(TextLines &linesInFile, long *line,
+							  DAGTreeStruct *dagTree,
+							  char *errmsg, long numRecs);
 OSErr ReadTIndexedDagTreeBody(std::vector<std::string> &linesInFile, long *line,
 							  DAGTreeStruct *dagTree,
 							  char *errmsg, long numRecs);
@@ -19,16 +23,24 @@ OSErr ReadTIndexedDagTreeBody(CHARH fileBUFH,long *line,DAGTreeStruct *dagTree,c
 bool IsTTopologyHeaderLine(const std::string &strIn, long &numPts);
 Boolean IsTTopologyHeaderLine(char *s, long *numPts);
 
+OSErr ReadTTopology(TextLines &linesInFile, long *line,
+					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg);
 OSErr ReadTTopology(std::vector<std::string> &linesInFile, long *line,
 					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg);
 OSErr ReadTTopology(CHARH fileBUFH, long *line,
 					TopologyHdl *topH, VelocityFH *velocityH, char *errmsg);
 
+OSErr ReadTTopologyBody(TextLines &linesInFile, long *line,
+						TopologyHdl *topH, VelocityFH *velocityH,
+						char *errmsg, long numRecs, Boolean wantVelData);
 OSErr ReadTTopologyBody(std::vector<std::string> &linesInFile, long *line,
 						TopologyHdl *topH, VelocityFH *velocityH,
 						char *errmsg, long numRecs, Boolean wantVelData);
 OSErr ReadTTopologyBody(CHARH fileBufH,long *line,TopologyHdl *topH,VelocityFH *velocityH,char* errmsg,long numRecs,Boolean wantVelData);
 
+OSErr ReadTVertices(TextLines &linesInFile, long *line,
+					LongPointHdl *ptsH, FLOATH *depthsH,
+					char *errmsg);
 OSErr ReadTVertices(std::vector<std::string> &linesInFile, long *line,
 					LongPointHdl *ptsH, FLOATH *depthsH,
 					char *errmsg);
@@ -39,6 +51,9 @@ OSErr ReadTVertices(CHARH fileBUFH, long *line,
 bool IsTVerticesHeaderLine(const std::string &strIn, long &numPts);
 Boolean IsTVerticesHeaderLine(const char *s, long *numPts);
 
+OSErr ReadTVerticesBody(TextLines &linesInFile, long *line,
+						LongPointHdl *pointsH, FLOATH *depthsH, char *errmsg,
+						long numPoints, bool wantDepths);
 OSErr ReadTVerticesBody(std::vector<std::string> &linesInFile, long *line,
 						LongPointHdl *pointsH, FLOATH *depthsH, char *errmsg,
 						long numPoints, bool wantDepths);
@@ -48,7 +63,12 @@ OSErr ReadTVerticesBody(CHARH fileBufH,long *line,
 
 long FindTriThirdPoint(long **longH,long p1, long p2, long index);
 int	Right_or_Left_of_Segment(LongPointHdl ptsH,long ref_p1,long ref_p2, LongPoint test_p1);
+int	Right_or_Left_of_Segment(long ref_p1_h, long ref_p1_v, long ref_p2_h, long ref_p2_v, LongPoint test_p1);
 long WhatTriIsPtIn(DAGHdl treeH,TopologyHdl topH, LongPointHdl ptsH,LongPoint pt);
+long FindTriNearVertices(TopologyHdl topH, LongPointHdl ptsH, LongPoint pt, long firstPoint, long secondPoint, long thirdPoint, long triNum);
+
+OSErr MakePackedDagTree(DAGTreeStruct dagTree, TopologyHdl topH, LongPointHdl ptsH, std::vector<PackedDAGNode> &packedTree);
+long WhatTriIsPtIn(const std::vector<PackedDAGNode> &packedTree, TopologyHdl topH, LongPointHdl ptsH, LongPoint pt);
 
 bool IsPtCurVerticesHeaderLine(const std::string &strIn, long &numPts, long &numLandPts);
 Boolean IsPtCurVerticesHeaderLine(const char *s, long* numPts, long* numLandPts);
@@ -62,16 +82,25 @@ Boolean IsBoundarySegmentHeaderLine(const char *s, long* numBoundarySegs);
 bool IsBoundaryPointsHeaderLine(const std::string &strIn, long &numBoundaryPts);
 Boolean IsBoundaryPointsHeaderLine(const char *s, long *numBoundaryPts);
 
+OSErr ReadBoundarySegs(TextLines &linesInFile, long *line,
+					   LONGH *boundarySegs, long numSegs, char *errmsg);
 OSErr ReadBoundarySegs(std::vector<std::string> &linesInFile, long *line,
 					   LONGH *boundarySegs, long numSegs, char *errmsg);
 OSErr ReadBoundarySegs(CHARH fileBufH,long *line,LONGH *boundarySegs,long numBoundarySegs,char* errmsg);
 
+OSErr ReadWaterBoundaries(TextLines &linesInFile, long *line,
+						  LONGH *waterBoundaries,
+						  long numWaterBoundaries,
+						  long numBoundaryPts, char *errmsg);
 OSErr ReadWaterBoundaries(std::vector<std::string> &linesInFile, long *line,
 						  LONGH *waterBoundaries,
 						  long numWaterBoundaries,
 						  long numBoundaryPts, char *errmsg);
 OSErr ReadWaterBoundaries(CHARH fileBufH,long *line,LONGH *waterBoundaries,long numWaterBoundaries,long numBoundaryPts,char* errmsg);
 
+OSErr ReadBoundaryPts(TextLines &linesInFile, long *line,
+					  LONGH *boundaryPts, long numBoundaryPts,
+					  char *errmsg);
 OSErr ReadBoundaryPts(std::vector<std::string> &linesInFile, long *line,
 					  LONGH *boundaryPts, long numBoundaryPts,
 					  char *errmsg);
@@ -82,6 +111,8 @@ OSErr ReadBoundaryPts(CHARH fileBufH, long *line,
 bool IsTransposeArrayHeaderLine(const std::string &strIn, long &numPts);
 Boolean IsTransposeArrayHeaderLine(const char *s, long *numPts);
 
+OSErr ReadTransposeArray(TextLines &linesInFile, long *line,
+						 LONGH *transposeArray, long numPts, char *errmsg);
 OSErr ReadTransposeArray(std::vector<std::string> &linesInFile, long *line,
 						 LONGH *transposeArray, long numPts, char *errmsg);
 OSErr ReadTransposeArray(CHARH fileBufH, long *line,
@@ -0,0 +1,224 @@
+/*
+ *  ForcingBlockCache.cpp
+ *  gnome
+ *
+ *  File layout: a fixed header, then the values as the buffer type. A file
+ *  is written beside its final name and renamed, so the runs sharing the
+ *  directory never read half a block, and two fetching the same block at
+ *  once both just write it.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#ifdef IBM
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "netcdf.h"
+
+#include "ForcingBlockCache.h"
+#include "ForcingIOCalls.h"
+#include "TopologyCache.h"
+#include "GnomeThreads.h"
+
+using std::string;
+
+#define kForcingBlockMagic		"GNBLOCK\n"
+#define kForcingBlockVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		valueSize;
+	uint64_t	key;
+	int64_t		numValues;
+} ForcingBlockHeader;
+
+static string cacheDir;
+static int64_t numHits = 0, numMisses = 0;
+
+// the prefetch threads read forcing too
+static GnomeMutex &StatsMutex()
+{
+	static GnomeMutex *statsMutex = new GnomeMutex;
+	return *statsMutex;
+}
+
+void SetForcingBlockCacheDir(const char *dir)
+{
+	cacheDir = dir ? dir : "";
+}
+
+const char *GetForcingBlockCacheDir()
+{
+	return cacheDir.c_str();
+}
+
+void GetForcingBlockCacheStats(int64_t *hits, int64_t *misses)
+{
+	GnomeLock statsLock(StatsMutex());
+	*hits = numHits;
+	*misses = numMisses;
+}
+
+Boolean IsRemoteDataPath(const char *path)
+{
+	return path && (!strncmp(path, "http://", 7) || !strncmp(path, "https://", 8));
+}
+
+static void CountRead(const char *path, Boolean hit)
+{
+	CountForcingIO(path, hit ? kIOBlockHits : kIOBlockMisses);
+
+	GnomeLock statsLock(StatsMutex());
+	if (hit)
+		numHits++;
+	else
+		numMisses++;
+}
+
+static string BlockPath(uint64_t key)
+{
+	char name[32];
+	string path = cacheDir;
+
+	sprintf(name, "%016llx.gnomeblock", (unsigned long long)key);
+	if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+		path += '/';
+	return path + name;
+}
+
+// the block is the hyperslab of the variable, by name since the ids are
+// only good for the dataset they came from
+static int BlockKey(int ncid, const char *path, int varid, const size_t *start, const size_t *count,
+					int32_t valueSize, uint64_t *key, int64_t *numValues)
+{
+	char varName[NC_MAX_NAME + 1];
+	int status, ndims;
+	uint64_t hash;
+
+	status = nc_inq_varname(ncid, varid, varName);
+	if (status != NC_NOERR)
+		return status;
+	status = nc_inq_varndims(ncid, varid, &ndims);
+	if (status != NC_NOERR)
+		return status;
+
+	hash = TopologyCacheHash(path, strlen(path) + 1);
+	hash = TopologyCacheHash(varName, strlen(varName) + 1, hash);
+	hash = TopologyCacheHash(&valueSize, sizeof(valueSize), hash);
+	*numValues = 1;
+	for (int i = 0; i < ndims; i++) {
+		uint64_t dims[2] = {start[i], count[i]};
+
+		hash = TopologyCacheHash(dims, sizeof(dims), hash);
+		*numValues *= count[i];
+	}
+	*key = hash;
+
+	return NC_NOERR;
+}
+
+static Boolean ReadBlock(uint64_t key, int32_t valueSize, int64_t numValues, void *values)
+{
+	ForcingBlockHeader header;
+	Boolean ok;
+	FILE *fp = fopen(BlockPath(key).c_str(), "rb");
+
+	if (!fp)
+		return false;
+
+	ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+		!memcmp(header.magic, kForcingBlockMagic, 8) && header.version == kForcingBlockVersion &&
+		header.valueSize == valueSize && header.key == key && header.numValues == numValues &&
+		fread(values, valueSize, numValues, fp) == (size_t)numValues;
+	fclose(fp);
+
+	return ok;
+}
+
+// failures only mean the next run fetches the block again
+static void WriteBlock(uint64_t key, int32_t valueSize, int64_t numValues, const void *values)
+{
+	ForcingBlockHeader header;
+	char pid[32];
+	string path = BlockPath(key), tempPath;
+	Boolean ok;
+	FILE *fp;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kForcingBlockMagic, 8);
+	header.version = kForcingBlockVersion;
+	header.valueSize = valueSize;
+	header.key = key;
+	header.numValues = numValues;
+
+	// other processes may be writing the same block
+	sprintf(pid, ".%ld.tmp", (long)getpid());
+	tempPath = path + pid;
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(values, valueSize, numValues, fp) == (size_t)numValues;
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(path.c_str());	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+	if (!ok)
+		remove(tempPath.c_str());
+}
+
+static int GetVaraValues(int ncid, int varid, const size_t *start, const size_t *count, double *values)
+{
+	return nc_get_vara_double(ncid, varid, start, count, values);
+}
+
+static int GetVaraValues(int ncid, int varid, const size_t *start, const size_t *count, float *values)
+{
+	return nc_get_vara_float(ncid, varid, start, count, values);
+}
+
+template <class T>
+static int GetVaraBlock(int ncid, const char *path, int varid, const size_t *start, const size_t *count, T *values)
+{
+	uint64_t key;
+	int64_t numValues;
+	int status;
+
+	if (cacheDir.empty() || !IsRemoteDataPath(path) ||
+		BlockKey(ncid, path, varid, start, count, sizeof(T), &key, &numValues) != NC_NOERR)
+		return GetVaraValues(ncid, varid, start, count, values);
+
+	if (ReadBlock(key, sizeof(T), numValues, values)) {
+		CountRead(path, true);
+		return NC_NOERR;
+	}
+
+	status = GetVaraValues(ncid, varid, start, count, values);
+	if (status == NC_NOERR) {
+		CountRead(path, false);
+		WriteBlock(key, sizeof(T), numValues, values);
+	}
+
+	return status;
+}
+
+int GetVaraCached(int ncid, const char *path, int varid, const size_t *start, const size_t *count, double *values)
+{
+	return GetVaraBlock(ncid, path, varid, start, count, values);
+}
+
+int GetVaraCached(int ncid, const char *path, int varid, const size_t *start, const size_t *count, float *values)
+{
+	return GetVaraBlock(ncid, path, varid, start, count, values);
+}
@@ -0,0 +1,39 @@
+/*
+ *  ForcingBlockCache.h
+ *  gnome
+ *
+ *  Forcing read from an OPeNDAP server: nc_open takes the URL as a path and
+ *  fetches only the slices, or the sub-windows of the active window mode,
+ *  that are asked for. The blocks fetched are kept on disk, keyed by the
+ *  URL, variable and hyperslab, so every run on the machine reads a block
+ *  from the server once. Off unless a directory is set.
+ *
+ */
+
+#ifndef __ForcingBlockCache__
+#define __ForcingBlockCache__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+// directory the block files go in, empty or NULL turns the cache off.
+// The files are never removed here, the directory can be cleared any time
+void DLL_API SetForcingBlockCacheDir(const char *dir);
+DLL_API const char *GetForcingBlockCacheDir();
+
+// the blocks found in and read into the cache since the process started
+void DLL_API GetForcingBlockCacheStats(int64_t *hits, int64_t *misses);
+
+// a http(s) URL, read remotely by a netCDF library built with DAP
+Boolean DLL_API IsRemoteDataPath(const char *path);
+
+// nc_get_vara for the buffer type, netCDF converts from the type in the
+// file. With the cache on, the blocks of a remote path come from the cache
+// when they were fetched before, and go in it when they weren't
+int GetVaraCached(int ncid, const char *path, int varid, const size_t *start, const size_t *count, double *values);
+int GetVaraCached(int ncid, const char *path, int varid, const size_t *start, const size_t *count, float *values);
+
+#endif
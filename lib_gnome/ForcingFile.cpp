@@ -0,0 +1,505 @@
+/*
+ *  ForcingFile.cpp
+ *  gnome
+ *
+ *  File layout: a fixed header, the times as raw Seconds, the slices, then
+ *  the vertex mapping, points, topology and DAG arrays of the topology
+ *  cache, each section on an 8 byte boundary. A slice is its depth levels
+ *  one after the other, a level its tiles row of tiles by row of tiles and
+ *  a tile its rows, all velocities as raw VelocityFRec. Slices that aren't
+ *  numRows x numCols levels (triangle grids, the water node layout) are
+ *  kept as one row.
+ *
+ *  The files are mapped read only, so the grids of every process using
+ *  one share its pages; where there's no mmap a file is read whole.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "ForcingFile.h"
+#include "TimeValuesCache.h"
+#include "TopologyCache.h"
+#include "GnomeThreads.h"
+#include "MemUtils.h"
+#include "Replacements.h"
+
+using std::string;
+using std::vector;
+
+#define kForcingFileMagic	"GNFORC\r\n"
+#define kForcingFileVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		headerSize;
+	uint64_t	sourceKey;
+	int32_t		sizeofVelocity;	// the sections are platform structs, so these must match to use a file
+	int32_t		sizeofSeconds;
+	int32_t		sizeofLong;
+	int32_t		sizeofLongPoint;
+	int32_t		sizeofTopology;
+	int32_t		sizeofDAG;
+	char		variable[256];
+	double		fileScaleFactor;
+	double		fillValue;
+	int64_t		numRows, numCols, numLevels;
+	int64_t		tileRows, tileCols;
+	int64_t		numTimes;
+	int64_t		timesOffset;
+	int64_t		slicesOffset;
+	int64_t		sliceBytes;		// padded
+	uint64_t	topologyKey;
+	int64_t		topologyOffset;	// 0 if there is no triangulation
+	int64_t		numVerdat, numPts, numTri, numBranches;
+	int64_t		loLat, loLong, hiLat, hiLong;
+} ForcingFileHeader;
+
+typedef struct {
+	string		path;
+	const char	*base;
+	size_t		length;
+	Boolean		mapped;
+	const ForcingFileHeader *header;
+} ForcingFileMap;
+
+static vector<ForcingFileMap> forcingFiles;
+static GnomeMutex forcingFilesMutex;
+
+static uint64_t ForcingSourceKey(const char *path)
+{
+	const char *reader = "GNOME forcing";
+
+	return TimeValuesCacheKey(path, TopologyCacheHash(reader, strlen(reader)));
+}
+
+static int64_t PaddedSize(int64_t numBytes)
+{
+	return (numBytes + 7) & ~(int64_t)7;
+}
+
+// the velocities of tile row tileRow before tile column tileCol, in a level
+static int64_t TileOffset(const ForcingFileHeader *h, int64_t tileRow, int64_t tileCol)
+{
+	int64_t firstRow = tileRow * h->tileRows;
+	int64_t numRows = h->numRows - firstRow < h->tileRows ? h->numRows - firstRow : h->tileRows;
+
+	return firstRow * h->numCols + tileCol * h->tileCols * numRows;
+}
+
+static Boolean CheckHeader(const ForcingFileHeader *h, size_t length)
+{
+	int64_t end;
+
+	if (length < sizeof(ForcingFileHeader))
+		return false;
+	if (memcmp(h->magic, kForcingFileMagic, 8) || h->version != kForcingFileVersion ||
+		h->headerSize != (int32_t)sizeof(ForcingFileHeader))
+		return false;
+	if (h->sizeofVelocity != (int32_t)sizeof(VelocityFRec) || h->sizeofSeconds != (int32_t)sizeof(Seconds) ||
+		h->sizeofLong != (int32_t)sizeof(long) || h->sizeofLongPoint != (int32_t)sizeof(LongPoint) ||
+		h->sizeofTopology != (int32_t)sizeof(Topology) || h->sizeofDAG != (int32_t)sizeof(DAG))
+		return false;
+	if (h->numRows <= 0 || h->numCols <= 0 || h->numLevels <= 0 || h->tileRows <= 0 || h->tileCols <= 0 || h->numTimes <= 0)
+		return false;
+	if (h->variable[sizeof(h->variable) - 1])
+		return false;
+
+	end = h->slicesOffset + h->numTimes * h->sliceBytes;
+	if (h->timesOffset + h->numTimes * (int64_t)sizeof(Seconds) > h->slicesOffset ||
+		h->sliceBytes < h->numRows * h->numCols * h->numLevels * (int64_t)sizeof(VelocityFRec) || end > (int64_t)length)
+		return false;
+	if (h->topologyOffset) {
+		end = h->topologyOffset + PaddedSize(h->numVerdat * sizeof(long)) + PaddedSize(h->numPts * sizeof(LongPoint)) +
+			  PaddedSize(h->numTri * sizeof(Topology)) + PaddedSize(h->numBranches * sizeof(DAG));
+		if (h->numVerdat <= 0 || h->numPts <= 0 || h->numTri <= 0 || h->numBranches <= 0 || end > (int64_t)length)
+			return false;
+	}
+	return true;
+}
+
+static void UnmapForcingFile(ForcingFileMap &file)
+{
+#ifndef _WIN32
+	if (file.mapped) {
+		munmap((void *)file.base, file.length);
+		return;
+	}
+#endif
+	delete [] file.base;
+}
+
+OSErr OpenForcingFile(const char *path)
+{
+	GnomeLock filesLock(forcingFilesMutex);
+	ForcingFileMap file;
+	FILE *fp;
+
+	if (!path || !path[0])
+		return -1;
+
+	for (long i = 0; i < (long)forcingFiles.size(); i++)
+		if (forcingFiles[i].path == path)
+			return noErr;
+
+	file.path = path;
+	file.base = 0;
+	file.length = 0;
+	file.mapped = false;
+
+#ifndef _WIN32
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+
+	if (fd >= 0) {
+		if (fstat(fd, &info) == 0 && info.st_size > 0) {
+			void *map = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (map != MAP_FAILED) {
+				file.base = (const char *)map;
+				file.length = info.st_size;
+				file.mapped = true;
+			}
+		}
+		close(fd);
+	}
+#endif
+
+	if (!file.mapped) {
+		long length;
+		char *buffer;
+
+		fp = fopen(path, "rb");
+		if (!fp)
+			return -1;
+		fseek(fp, 0, SEEK_END);
+		length = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		buffer = length > 0 ? new char[length] : 0;
+		if (!buffer || fread(buffer, 1, length, fp) != (size_t)length) {
+			fclose(fp);
+			delete [] buffer;
+			return -1;
+		}
+		fclose(fp);
+		file.base = buffer;
+		file.length = length;
+	}
+
+	file.header = (const ForcingFileHeader *)file.base;
+	if (!CheckHeader(file.header, file.length)) {
+		UnmapForcingFile(file);
+		return -1;
+	}
+
+	forcingFiles.push_back(file);
+	return noErr;
+}
+
+void CloseForcingFiles()
+{
+	GnomeLock filesLock(forcingFilesMutex);
+
+	for (long i = 0; i < (long)forcingFiles.size(); i++)
+		UnmapForcingFile(forcingFiles[i]);
+	forcingFiles.clear();
+}
+
+long GetNumForcingFiles()
+{
+	GnomeLock filesLock(forcingFilesMutex);
+	return forcingFiles.size();
+}
+
+// the open file for the source, 0 if there is none. variable 0 matches any
+static const ForcingFileMap *FindForcingFile(const char *path, const char *variable)
+{
+	uint64_t key;
+
+	if (forcingFiles.empty() || !(key = ForcingSourceKey(path)))
+		return 0;
+	for (long i = 0; i < (long)forcingFiles.size(); i++) {
+		const ForcingFileHeader *h = forcingFiles[i].header;
+		if (h->sourceKey == key && (!variable || !strcmp(h->variable, variable)))
+			return &forcingFiles[i];
+	}
+	return 0;
+}
+
+OSErr ReadForcingSlice(const char *path, const char *variable, long timeIndex, Seconds time, const long *window,
+					   VelocityFH *velocityH, double *fileScaleFactor, double *fillValue)
+{
+	GnomeLock filesLock(forcingFilesMutex);
+	const ForcingFileMap *file = FindForcingFile(path, variable);
+	const ForcingFileHeader *h;
+	const VelocityFRec *level;
+	VelocityFH velH;
+	int64_t rowStart = 0, rowEnd, colStart = 0, colEnd, levelSize;
+	int64_t k, tileRow, tileCol, row, firstCol, lastCol, tileWidth;
+
+	if (!file)
+		return -1;
+	h = file->header;
+	if (timeIndex < 0 || timeIndex >= h->numTimes || ((const Seconds *)(file->base + h->timesOffset))[timeIndex] != time)
+		return -1;
+
+	rowEnd = h->numRows;
+	colEnd = h->numCols;
+	if (window) {
+		if (window[1] > h->numRows || window[3] > h->numCols || window[0] < 0 || window[2] < 0)
+			return -1;
+		rowStart = window[0]; rowEnd = window[1];
+		colStart = window[2]; colEnd = window[3];
+	}
+
+	levelSize = h->numRows * h->numCols;
+	velH = (VelocityFH)(window ? _NewHandleClear(levelSize * h->numLevels * sizeof(VelocityFRec))
+							   : _NewHandle(levelSize * h->numLevels * sizeof(VelocityFRec)));
+	if (!velH) {
+		TechError("ReadForcingSlice()", "_NewHandle()", 0);
+		return memFullErr;
+	}
+
+	// only the tiles of the window are touched, the pages of the others stay on disk
+	for (k = 0; k < h->numLevels; k++) {
+		level = (const VelocityFRec *)(file->base + h->slicesOffset + timeIndex * h->sliceBytes) + k * levelSize;
+		for (tileRow = rowStart / h->tileRows; tileRow * h->tileRows < rowEnd; tileRow++) {
+			for (tileCol = colStart / h->tileCols; tileCol * h->tileCols < colEnd; tileCol++) {
+				const VelocityFRec *tile = level + TileOffset(h, tileRow, tileCol);
+
+				tileWidth = h->numCols - tileCol * h->tileCols < h->tileCols ? h->numCols - tileCol * h->tileCols : h->tileCols;
+				firstCol = tileCol * h->tileCols > colStart ? tileCol * h->tileCols : colStart;
+				lastCol = tileCol * h->tileCols + tileWidth < colEnd ? tileCol * h->tileCols + tileWidth : colEnd;
+				for (row = tileRow * h->tileRows; row < (tileRow + 1) * h->tileRows && row < h->numRows; row++) {
+					if (row < rowStart || row >= rowEnd)
+						continue;
+					memcpy(&(*velH)[k * levelSize + row * h->numCols + firstCol],
+						   tile + (row - tileRow * h->tileRows) * tileWidth + (firstCol - tileCol * h->tileCols),
+						   (lastCol - firstCol) * sizeof(VelocityFRec));
+				}
+			}
+		}
+	}
+
+	*velocityH = velH;
+	*fileScaleFactor = h->fileScaleFactor;
+	*fillValue = h->fillValue;
+	return noErr;
+}
+
+// a new handle with numBytes at offset, which then moves past the section
+static Handle ReadForcingSection(const ForcingFileMap *file, int64_t *offset, long numBytes)
+{
+	Handle h = _NewHandle(numBytes);
+
+	if (h)
+		memcpy(*h, file->base + *offset, numBytes);
+	*offset += PaddedSize(numBytes);
+	return h;
+}
+
+OSErr ReadForcingTopology(uint64_t key, LONGH *verdatToNetCDFH, LongPointHdl *ptsH,
+						  TopologyHdl *topH, DAGTreeStruct *tree, WorldRect *bounds)
+{
+	MemoryTag memoryTag(kMemTopology);
+	GnomeLock filesLock(forcingFilesMutex);
+	const ForcingFileMap *file = 0;
+	const ForcingFileHeader *h;
+	LONGH verdatH;
+	LongPointHdl pts;
+	TopologyHdl topo;
+	DAGHdl treeH;
+	int64_t offset;
+
+	for (long i = 0; i < (long)forcingFiles.size() && !file; i++)
+		if (forcingFiles[i].header->topologyOffset && forcingFiles[i].header->topologyKey == key)
+			file = &forcingFiles[i];
+	if (!file)
+		return -1;
+
+	h = file->header;
+	offset = h->topologyOffset;
+	verdatH = (LONGH)ReadForcingSection(file, &offset, h->numVerdat * sizeof(long));
+	pts = (LongPointHdl)ReadForcingSection(file, &offset, h->numPts * sizeof(LongPoint));
+	topo = (TopologyHdl)ReadForcingSection(file, &offset, h->numTri * sizeof(Topology));
+	treeH = (DAGHdl)ReadForcingSection(file, &offset, h->numBranches * sizeof(DAG));
+	if (!verdatH || !pts || !topo || !treeH) {
+		TechError("ReadForcingTopology()", "_NewHandle()", 0);
+		if (verdatH) DisposeHandle((Handle)verdatH);
+		if (pts) DisposeHandle((Handle)pts);
+		if (topo) DisposeHandle((Handle)topo);
+		if (treeH) DisposeHandle((Handle)treeH);
+		return memFullErr;
+	}
+
+	*verdatToNetCDFH = verdatH;
+	*ptsH = pts;
+	*topH = topo;
+	tree->treeHdl = treeH;
+	tree->numBranches = h->numBranches;
+	bounds->loLat = h->loLat;
+	bounds->loLong = h->loLong;
+	bounds->hiLat = h->hiLat;
+	bounds->hiLong = h->hiLong;
+	return noErr;
+}
+
+static Boolean WritePadded(FILE *fp, const void *data, int64_t numBytes)
+{
+	static const char zeros[8] = {0};
+	int64_t padBytes = PaddedSize(numBytes) - numBytes;
+
+	if (numBytes > 0 && fwrite(data, 1, numBytes, fp) != (size_t)numBytes)
+		return false;
+	return padBytes == 0 || fwrite(zeros, 1, padBytes, fp) == (size_t)padBytes;
+}
+
+// the tiles of a slice, in the order ReadForcingSlice reads them
+static Boolean WriteForcingSlice(FILE *fp, const ForcingFileHeader &h, const VelocityFRec *vel)
+{
+	int64_t k, tileRow, tileCol, row, tileWidth, levelSize = h.numRows * h.numCols;
+
+	for (k = 0; k < h.numLevels; k++) {
+		for (tileRow = 0; tileRow * h.tileRows < h.numRows; tileRow++) {
+			for (tileCol = 0; tileCol * h.tileCols < h.numCols; tileCol++) {
+				tileWidth = h.numCols - tileCol * h.tileCols < h.tileCols ? h.numCols - tileCol * h.tileCols : h.tileCols;
+				for (row = tileRow * h.tileRows; row < (tileRow + 1) * h.tileRows && row < h.numRows; row++) {
+					if (fwrite(vel + k * levelSize + row * h.numCols + tileCol * h.tileCols, sizeof(VelocityFRec), tileWidth, fp) != (size_t)tileWidth)
+						return false;
+				}
+			}
+		}
+	}
+	return WritePadded(fp, 0, h.sliceBytes - h.numLevels * levelSize * (int64_t)sizeof(VelocityFRec));
+}
+
+OSErr WriteForcingFile(const char *path, const ForcingFileInfo &info, TimeSliceReadProc readProc, void *owner, char *errmsg)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	ForcingFileHeader header;
+	FILE *fp = 0;
+	VelocityFH velH = 0;
+	string tempPath;
+	char suffix[32];
+	long i, numVels;
+	Boolean ok = true;
+	OSErr err = 0;
+
+	errmsg[0] = 0;
+	if (!info.timeH || strlen(info.variable) >= sizeof(header.variable) || info.numRows <= 0 || info.numCols <= 0) {
+		strcpy(errmsg, "The grid has no times or slices to write to a forcing file");
+		return -1;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kForcingFileMagic, 8);
+	header.version = kForcingFileVersion;
+	header.headerSize = sizeof(header);
+	header.sourceKey = ForcingSourceKey(info.sourcePath);
+	header.sizeofVelocity = sizeof(VelocityFRec);
+	header.sizeofSeconds = sizeof(Seconds);
+	header.sizeofLong = sizeof(long);
+	header.sizeofLongPoint = sizeof(LongPoint);
+	header.sizeofTopology = sizeof(Topology);
+	header.sizeofDAG = sizeof(DAG);
+	strcpy(header.variable, info.variable);
+	header.numTimes = _GetHandleSize((Handle)info.timeH) / sizeof(Seconds);
+	header.timesOffset = PaddedSize(sizeof(header));
+	header.slicesOffset = header.timesOffset + PaddedSize(header.numTimes * sizeof(Seconds));
+	if (!header.sourceKey || header.numTimes <= 0) {
+		strcpy(errmsg, "Could not look at the forcing file's source");
+		return -1;
+	}
+
+	// write beside the final name and rename, so a reader never sees half a file
+	sprintf(suffix, ".%ld.tmp", (long)getpid());
+	tempPath = string(path) + suffix;
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp) {
+		strcpy(errmsg, "Could not create the forcing file");
+		return -1;
+	}
+
+	// the header is written again at the end, once the slices have set its sizes
+	ok = WritePadded(fp, &header, sizeof(header)) && WritePadded(fp, *info.timeH, header.numTimes * sizeof(Seconds));
+	for (i = 0; ok && i < header.numTimes; i++) {
+		err = (*readProc)(owner, i, &velH, errmsg);
+		if (err || !velH) {
+			if (!errmsg[0]) strcpy(errmsg, "Could not read a time of the forcing file's source");
+			ok = false;
+			break;
+		}
+		numVels = _GetHandleSize((Handle)velH) / sizeof(VelocityFRec);
+		if (i == 0) {
+			header.numRows = info.numRows;
+			header.numCols = info.numCols;
+			header.numLevels = numVels / (info.numRows * info.numCols);
+			header.tileRows = kForcingTileRows;
+			header.tileCols = kForcingTileCols;
+			if (header.numLevels < 1 || header.numLevels * info.numRows * info.numCols != numVels) {
+				header.numRows = 1;
+				header.numCols = numVels;
+				header.numLevels = 1;
+				header.tileRows = 1;
+				header.tileCols = kForcingTileRows * kForcingTileCols;
+			}
+			header.sliceBytes = PaddedSize(numVels * sizeof(VelocityFRec));
+		}
+		if (numVels != header.numRows * header.numCols * header.numLevels) {
+			strcpy(errmsg, "The times of the forcing file's source are not all the same size");
+			ok = false;
+		}
+		else
+			ok = WriteForcingSlice(fp, header, *velH);
+		DisposeHandle((Handle)velH);
+		velH = 0;
+	}
+
+	if (ok && info.verdatToNetCDFH && info.ptsH && info.topH && info.treeH && info.numBranches > 0) {
+		header.topologyKey = info.topologyKey;
+		header.topologyOffset = header.slicesOffset + header.numTimes * header.sliceBytes;
+		header.numVerdat = _GetHandleSize((Handle)info.verdatToNetCDFH) / sizeof(long);
+		header.numPts = _GetHandleSize((Handle)info.ptsH) / sizeof(LongPoint);
+		header.numTri = _GetHandleSize((Handle)info.topH) / sizeof(Topology);
+		header.numBranches = info.numBranches;
+		header.loLat = info.bounds.loLat;
+		header.loLong = info.bounds.loLong;
+		header.hiLat = info.bounds.hiLat;
+		header.hiLong = info.bounds.hiLong;
+		ok = WritePadded(fp, *info.verdatToNetCDFH, header.numVerdat * sizeof(long)) &&
+			 WritePadded(fp, *info.ptsH, header.numPts * sizeof(LongPoint)) &&
+			 WritePadded(fp, *info.topH, header.numTri * sizeof(Topology)) &&
+			 WritePadded(fp, *info.treeH, header.numBranches * sizeof(DAG));
+	}
+
+	if (ok) {
+		header.fileScaleFactor = *info.fileScaleFactor;
+		header.fillValue = *info.fillValue;
+		ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fp) == 1;
+	}
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(path);	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), path) == 0;
+	}
+	if (!ok) {
+		remove(tempPath.c_str());
+		if (!errmsg[0]) strcpy(errmsg, "Could not write the forcing file");
+		return err ? err : -1;
+	}
+
+	return noErr;
+}
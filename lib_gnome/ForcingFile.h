@@ -0,0 +1,76 @@
+/*
+ *  ForcingFile.h
+ *  gnome
+ *
+ *  GNOME forcing files: the time slices of a gridded current file the way
+ *  its grid decodes them (rows reordered, units converted, rotated), with
+ *  its times and, for a curvilinear grid, the triangulation the topology
+ *  cache keeps, in one file laid out to be mapped in place. A slice is kept
+ *  in tiles of kForcingTileRows x kForcingTileCols velocities, so a grid
+ *  reading an active window pages in only the tiles and times it touches,
+ *  and nothing is decoded by netCDF.
+ *
+ *  A file is written from a grid that has read its source, and used once
+ *  it is opened here: the grids reading the same source, unchanged since
+ *  (same path, size and modification time), and decoding it the same way
+ *  load their slices and topology from it. The grids still read the times
+ *  from the source, the file's times only check that a slice is the time
+ *  asked for.
+ *
+ */
+
+#ifndef __ForcingFile__
+#define __ForcingFile__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+#include "TimeSliceLoader.h"
+#include "ExportSymbols.h"
+
+#define kForcingTileRows 64
+#define kForcingTileCols 64
+
+// maps the file and uses it from now on. An error if it can't be read or
+// isn't a forcing file of this platform's sizes
+OSErr DLL_API OpenForcingFile(const char *path);
+void DLL_API CloseForcingFiles();
+long DLL_API GetNumForcingFiles();
+
+// the slice timeIndex, at time, of the source at path decoded as variable
+// (the grid's GetWholeGridSliceVariable), into a new handle. window is rows
+// and columns [start, end) of the loaded layout, the velocities outside it
+// are zero; 0 reads the whole grid. An error if no open file has it. The
+// file's scale factor and fill value are set as ReadTimeData sets them
+OSErr ReadForcingSlice(const char *path, const char *variable, long timeIndex, Seconds time, const long *window,
+					   VelocityFH *velocityH, double *fileScaleFactor, double *fillValue);
+
+// the triangulation with the topology cache key, as ReadTopologyCache
+OSErr ReadForcingTopology(uint64_t key, LONGH *verdatToNetCDFH, LongPointHdl *ptsH,
+						  TopologyHdl *topH, DAGTreeStruct *tree, WorldRect *bounds);
+
+// what WriteForcingFile writes besides the slices. The handles are only read
+struct ForcingFileInfo {
+	const char	*sourcePath;
+	const char	*variable;		// the grid's GetWholeGridSliceVariable
+	long		numRows, numCols;
+	Seconds		**timeH;
+	// read after the slices, as ReadTimeData sets them
+	const double	*fileScaleFactor;
+	const float		*fillValue;
+	// the triangulation, if verdatToNetCDFH isn't 0
+	uint64_t	topologyKey;
+	LONGH		verdatToNetCDFH;
+	LongPointHdl	ptsH;
+	TopologyHdl	topH;
+	DAGHdl		treeH;
+	long		numBranches;
+	WorldRect	bounds;
+};
+
+// writes the forcing file of the source, the slices read one at a time with readProc
+OSErr WriteForcingFile(const char *path, const ForcingFileInfo &info, TimeSliceReadProc readProc, void *owner, char *errmsg);
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ *  ForcingIOCalls.h
+ *  gnome
+ *
+ *  Included after netcdf.h by the forcing readers, so their netCDF calls
+ *  are counted in the ForcingIOStats of the file the dataset came from:
+ *  the reading calls by name, the gets with the bytes of the values they
+ *  read as they are in the file. The calls that write aren't counted.
+ *
+ */
+
+#ifndef __ForcingIOCalls__
+#define __ForcingIOCalls__
+
+#include "netcdf.h"
+
+#include "ForcingIOStats.h"
+
+inline int CountedOpen(const char *path, int mode, int *ncid)
+{
+	int status = nc_open(path, mode, ncid);
+
+	CountForcingOpen(path, status == NC_NOERR ? *ncid : -1);
+	return status;
+}
+
+inline int CountedClose(int ncid)
+{
+	CountForcingClose(ncid);
+	return nc_close(ncid);
+}
+
+inline int CountedCall(int status, int ncid)
+{
+	CountForcingCall(ncid);
+	return status;
+}
+
+inline int CountedGet(int status, int ncid, int varid, const size_t *count)
+{
+	CountForcingCall(ncid, status == NC_NOERR ? ForcingValueBytes(ncid, varid, count) : 0);
+	return status;
+}
+
+// a macro's name isn't expanded again in its own expansion, so these call netCDF
+#define nc_open(path, mode, ncid)	CountedOpen(path, mode, ncid)
+#define nc_close(ncid)	CountedClose(ncid)
+
+#define nc_get_vara_double(ncid, varid, start, count, values)	CountedGet(nc_get_vara_double(ncid, varid, start, count, values), ncid, varid, count)
+#define nc_get_vara_float(ncid, varid, start, count, values)	CountedGet(nc_get_vara_float(ncid, varid, start, count, values), ncid, varid, count)
+#define nc_get_vara_long(ncid, varid, start, count, values)	CountedGet(nc_get_vara_long(ncid, varid, start, count, values), ncid, varid, count)
+#define nc_get_var1_double(ncid, varid, index, value)	CountedGet(nc_get_var1_double(ncid, varid, index, value), ncid, varid, 0)
+#define nc_get_var1_float(ncid, varid, index, value)	CountedGet(nc_get_var1_float(ncid, varid, index, value), ncid, varid, 0)
+
+#define nc_get_att_double(ncid, ...)	CountedCall(nc_get_att_double(ncid, __VA_ARGS__), ncid)
+#define nc_get_att_float(ncid, ...)		CountedCall(nc_get_att_float(ncid, __VA_ARGS__), ncid)
+#define nc_get_att_text(ncid, ...)		CountedCall(nc_get_att_text(ncid, __VA_ARGS__), ncid)
+#define nc_inq_attlen(ncid, ...)		CountedCall(nc_inq_attlen(ncid, __VA_ARGS__), ncid)
+#define nc_inq_dim(ncid, ...)			CountedCall(nc_inq_dim(ncid, __VA_ARGS__), ncid)
+#define nc_inq_dimid(ncid, ...)			CountedCall(nc_inq_dimid(ncid, __VA_ARGS__), ncid)
+#define nc_inq_dimlen(ncid, ...)		CountedCall(nc_inq_dimlen(ncid, __VA_ARGS__), ncid)
+#define nc_inq_dimname(ncid, ...)		CountedCall(nc_inq_dimname(ncid, __VA_ARGS__), ncid)
+#define nc_inq_format(ncid, ...)		CountedCall(nc_inq_format(ncid, __VA_ARGS__), ncid)
+#define nc_inq_ndims(ncid, ...)			CountedCall(nc_inq_ndims(ncid, __VA_ARGS__), ncid)
+#define nc_inq_nvars(ncid, ...)			CountedCall(nc_inq_nvars(ncid, __VA_ARGS__), ncid)
+#define nc_inq_type(ncid, ...)			CountedCall(nc_inq_type(ncid, __VA_ARGS__), ncid)
+#define nc_inq_unlimdim(ncid, ...)		CountedCall(nc_inq_unlimdim(ncid, __VA_ARGS__), ncid)
+#define nc_inq_var_chunking(ncid, ...)	CountedCall(nc_inq_var_chunking(ncid, __VA_ARGS__), ncid)
+#define nc_inq_vardimid(ncid, ...)		CountedCall(nc_inq_vardimid(ncid, __VA_ARGS__), ncid)
+#define nc_inq_varid(ncid, ...)			CountedCall(nc_inq_varid(ncid, __VA_ARGS__), ncid)
+#define nc_inq_varname(ncid, ...)		CountedCall(nc_inq_varname(ncid, __VA_ARGS__), ncid)
+#define nc_inq_varndims(ncid, ...)		CountedCall(nc_inq_varndims(ncid, __VA_ARGS__), ncid)
+#define nc_inq_vartype(ncid, ...)		CountedCall(nc_inq_vartype(ncid, __VA_ARGS__), ncid)
+#define nc_get_var_chunk_cache(ncid, ...)	CountedCall(nc_get_var_chunk_cache(ncid, __VA_ARGS__), ncid)
+#define nc_set_var_chunk_cache(ncid, ...)	CountedCall(nc_set_var_chunk_cache(ncid, __VA_ARGS__), ncid)
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ *  ForcingIOStats.cpp
+ *  gnome
+ *
+ *  The calls here are netCDF's own, this file doesn't include
+ *  ForcingIOCalls.h.
+ *
+ */
+
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "netcdf.h"
+
+#include "ForcingIOStats.h"
+#include "GnomeThreads.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+static const char *counterNames[kNumForcingIOCounters] = {"bytes_read", "nc_calls", "opens", "closes",
+	"slice_hits", "slice_misses", "block_hits", "block_misses",
+	"prefetches", "prefetches_used", "prefetches_wasted", "prefetch_wait_ns"};
+
+static vector<string> filePaths;
+static vector<ForcingIOStats> fileStats;
+static map<int, string> openPaths;	// the open datasets' paths by ncid
+
+// the prefetch threads read forcing too
+static GnomeMutex &StatsMutex()
+{
+	static GnomeMutex *statsMutex = new GnomeMutex;
+	return *statsMutex;
+}
+
+// with the mutex held
+static ForcingIOStats &FileStats(const string &path)
+{
+	ForcingIOStats stats;
+
+	for (size_t i = 0; i < filePaths.size(); i++)
+		if (filePaths[i] == path)
+			return fileStats[i];
+
+	memset(&stats, 0, sizeof(stats));
+	filePaths.push_back(path);
+	fileStats.push_back(stats);
+	return fileStats.back();
+}
+
+void ResetForcingIOStats()
+{
+	GnomeLock statsLock(StatsMutex());
+
+	// the datasets still open go on being counted
+	filePaths.clear();
+	fileStats.clear();
+}
+
+long GetNumForcingIOFiles()
+{
+	GnomeLock statsLock(StatsMutex());
+	return (long)filePaths.size();
+}
+
+Boolean GetForcingIOStats(long i, char *path, ForcingIOStats *stats)
+{
+	GnomeLock statsLock(StatsMutex());
+
+	if (i < 0 || i >= (long)filePaths.size())
+		return false;
+
+	strncpy(path, filePaths[i].c_str(), kMaxNameLen - 1);
+	path[kMaxNameLen - 1] = 0;
+	*stats = fileStats[i];
+	return true;
+}
+
+const char *GetForcingIOCounterName(short counter)
+{
+	return counter >= 0 && counter < kNumForcingIOCounters ? counterNames[counter] : "";
+}
+
+void CountForcingIO(const char *path, short counter, int64_t n)
+{
+	if (!path || counter < 0 || counter >= kNumForcingIOCounters)
+		return;
+
+	GnomeLock statsLock(StatsMutex());
+	FileStats(path).counts[counter] += n;
+}
+
+void CountForcingOpen(const char *path, int ncid)
+{
+	GnomeLock statsLock(StatsMutex());
+	ForcingIOStats &stats = FileStats(path);
+
+	stats.counts[kIONcCalls]++;
+	if (ncid < 0)
+		return;
+
+	stats.counts[kIOOpens]++;
+	openPaths[ncid] = path;
+}
+
+void CountForcingClose(int ncid)
+{
+	GnomeLock statsLock(StatsMutex());
+	map<int, string>::iterator open = openPaths.find(ncid);
+
+	if (open == openPaths.end())
+		return;
+
+	ForcingIOStats &stats = FileStats(open->second);
+	stats.counts[kIONcCalls]++;
+	stats.counts[kIOCloses]++;
+	openPaths.erase(open);
+}
+
+void CountForcingCall(int ncid, int64_t numBytes)
+{
+	GnomeLock statsLock(StatsMutex());
+	map<int, string>::iterator open = openPaths.find(ncid);
+
+	if (open == openPaths.end())
+		return;	// a dataset created for writing
+
+	ForcingIOStats &stats = FileStats(open->second);
+	stats.counts[kIONcCalls]++;
+	stats.counts[kIOBytesRead] += numBytes;
+}
+
+int64_t ForcingValueBytes(int ncid, int varid, const size_t *count)
+{
+	int numDims;
+	nc_type type;
+	size_t typeSize;
+	int64_t numBytes;
+
+	if (nc_inq_vartype(ncid, varid, &type) != NC_NOERR || nc_inq_type(ncid, type, 0, &typeSize) != NC_NOERR)
+		return 0;
+
+	numBytes = typeSize;
+	if (count && nc_inq_varndims(ncid, varid, &numDims) == NC_NOERR)
+		for (int i = 0; i < numDims; i++)
+			numBytes *= count[i];
+
+	return numBytes;
+}
+
+int64_t ForcingIOClock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
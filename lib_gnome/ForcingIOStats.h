@@ -0,0 +1,52 @@
+/*
+ *  ForcingIOStats.h
+ *  gnome
+ *
+ *  What reading the forcing cost, per file: the netCDF calls made on the
+ *  datasets opened from it and the bytes of the values they read, the
+ *  opens and closes, the time slices found in the TimeSliceCache and read,
+ *  the blocks found in the ForcingBlockCache and fetched, and the times
+ *  prefetched, used and thrown away, and the wait for them. Kept for the
+ *  process, by the readers that include ForcingIOCalls.h, from the start
+ *  or the last ResetForcingIOStats.
+ *
+ */
+
+#ifndef __ForcingIOStats__
+#define __ForcingIOStats__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+enum { kIOBytesRead = 0, kIONcCalls, kIOOpens, kIOCloses, kIOSliceHits, kIOSliceMisses, kIOBlockHits, kIOBlockMisses,
+	kIOPrefetches, kIOPrefetchesUsed, kIOPrefetchesWasted, kIOPrefetchWaitNanoseconds, kNumForcingIOCounters };
+
+typedef struct {
+	int64_t	counts[kNumForcingIOCounters];
+} ForcingIOStats;
+
+void DLL_API ResetForcingIOStats();
+// the files counted, in the order they were first counted
+long DLL_API GetNumForcingIOFiles();
+// the path (up to kMaxNameLen) and stats of file i, false past the last one
+Boolean DLL_API GetForcingIOStats(long i, char *path, ForcingIOStats *stats);
+DLL_API const char *GetForcingIOCounterName(short counter);
+
+// for the readers, from any thread
+void CountForcingIO(const char *path, short counter, int64_t n = 1);
+// a dataset of path opened as ncid, ncid -1 when the open failed,
+// and closed: its calls are counted for path in between
+void CountForcingOpen(const char *path, int ncid);
+void CountForcingClose(int ncid);
+// a call on the dataset ncid, that read numBytes of values
+void CountForcingCall(int ncid, int64_t numBytes = 0);
+// the bytes in the file of the values of the hyperslab count of the
+// variable, of one value when count is 0
+int64_t ForcingValueBytes(int ncid, int varid, const size_t *count);
+// nanoseconds on a steady clock, for the prefetch waits
+int64_t ForcingIOClock();
+
+#endif
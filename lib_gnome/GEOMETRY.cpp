@@ -63,12 +63,134 @@ float LongToLatRatio2(WorldRect *wr)
 }
 #endif
 
+// pi / 180 to the last digit, as numpy's deg2rad: cos(90) is ~6e-17, not
+// a negative number with PI's 3.14159265359
+static const double kRadiansPerDegree = 0.017453292519943295;
+
+double LatCosine(double lat)
+{
+	return cos(lat * kRadiansPerDegree);
+}
+
+// the cosine of 0 to 90 degrees every 0.01 degree, for LongToLatRatio3. The
+// linear interpolation is off by at most step^2 / 8 of the cosine (cos'' is
+// -cos), 4e-9 at any latitude, well under what a float keeps
+#define kLatCosineStep		10000	// micro degrees
+#define kNumLatCosines		(90000000 / kLatCosineStep + 2)
+
+static double sLatCosines[kNumLatCosines];
+
+static bool InitLatCosines()
+{
+	for (long i = 0; i < kNumLatCosines; i++)
+		sLatCosines[i] = LatCosine(i * (kLatCosineStep / 1000000.0));
+	return true;
+}
+
+static const bool sLatCosinesReady = InitLatCosines();
+
+// the cosine of lat in micro degrees, from the table
+static double TableLatCosine(long lat)
+{
+	long a = lat < 0 ? -lat : lat, i = a / kLatCosineStep;
+
+	if (!sLatCosinesReady || a >= 90000000)
+		return LatCosine(lat / 1000000.0);
+
+	return sLatCosines[i] + (sLatCosines[i + 1] - sLatCosines[i]) * ((a - i * kLatCosineStep) / (double)kLatCosineStep);
+}
+
 float LongToLatRatio3(long baseLat)
 #ifdef LLSHIFT
-{ return cos(((float)(baseLat - 90000000) / 1000000.0) * 3.14159 / 180); }
+{ return TableLatCosine(baseLat - 90000000); }
 #else
-{ return cos(((float)baseLat / 1000000.0) * 3.14159 / 180); }
+{ return TableLatCosine(baseLat); }
+#endif
+
+double LongToLatRatio3D(long baseLat)
+#ifdef LLSHIFT
+{ return LatCosine((baseLat - 90000000) / 1000000.0); }
+#else
+{ return LatCosine(baseLat / 1000000.0); }
+#endif
+
+// the x of row i is scaled by the cosine of its reference latitude, up
+// (toMeters) or down
+static void FlatEarthDeltas(long n, int dim, const double *deltas,
+							const double *refPositions, int refDim, long refCount,
+							bool toMeters, double *out)
+{
+	long refStride = refCount == 1 ? 0 : refDim;
+	double yScale = toMeters ? 1. / DEGREESLATPERMETER : DEGREESLATPERMETER;
+
+	// one contiguous pass; the cosines vectorize
+#ifdef _OPENMP
+#pragma omp simd
 #endif
+	for (long i = 0; i < n; i++)
+	{
+		double c = LatCosine(refPositions[i * refStride + 1]);
+		double xScale = toMeters ? yScale * c : yScale / c;
+
+		out[i * dim] = deltas[i * dim] * xScale;
+		out[i * dim + 1] = deltas[i * dim + 1] * yScale;
+		if (dim > 2)
+			out[i * dim + 2] = deltas[i * dim + 2];
+	}
+}
+
+void MetersToLonLat(long n, int dim, const double *deltas,
+					const double *refPositions, int refDim, long refCount,
+					double *out)
+{
+	FlatEarthDeltas(n, dim, deltas, refPositions, refDim, refCount, false, out);
+}
+
+void LonLatToMeters(long n, int dim, const double *deltas,
+					const double *refPositions, int refDim, long refCount,
+					double *out)
+{
+	FlatEarthDeltas(n, dim, deltas, refPositions, refDim, refCount, true, out);
+}
+
+static inline void StorePixel(double v, double &pixel) { pixel = v; }
+static inline void StorePixel(double v, float &pixel) { pixel = (float)v; }
+// floor, not a cast: points off the image to the left or top are at
+// negative pixels
+static inline void StorePixel(double v, int &pixel) { pixel = (int)floor(v); }
+
+template <typename T>
+static void ToPixels(long n, int dim, const double *coords,
+					 const double transform[6], T *pixels)
+{
+	double cx = transform[0], cy = transform[1];
+	double sx = transform[2], sy = transform[3];
+	double ox = transform[4], oy = transform[5];
+
+	for (long i = 0; i < n; i++)
+	{
+		StorePixel((coords[i * dim] - cx) * sx + ox, pixels[2 * i]);
+		StorePixel((coords[i * dim + 1] - cy) * sy + oy, pixels[2 * i + 1]);
+	}
+}
+
+void LonLatToPixels(long n, int dim, const double *coords,
+					const double transform[6], double *pixels)
+{
+	ToPixels(n, dim, coords, transform, pixels);
+}
+
+void LonLatToPixelsFloat(long n, int dim, const double *coords,
+						 const double transform[6], float *pixels)
+{
+	ToPixels(n, dim, coords, transform, pixels);
+}
+
+void LonLatToPixelsInt(long n, int dim, const double *coords,
+					   const double transform[6], int *pixels)
+{
+	ToPixels(n, dim, coords, transform, pixels);
+}
 #ifndef pyGNOME
 Boolean SameSegmentEndPoints(Segment s1, Segment s2)
 {
@@ -0,0 +1,64 @@
+/*
+ *  GnomeError.cpp
+ *  gnome
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "GnomeError.h"
+
+#ifndef pyGNOME
+#include "CROSS.H"
+#else
+#include "Replacements.h"
+#endif
+
+void GnomeError::Set(OSErr code, const char *where, Seconds time, const char *message)
+{
+	if (IsSet() || code == noErr)
+		return;
+
+	fCode = code;
+	fWhere = where;
+	fTime = time;
+	if (message && message[0])
+		fMessage = message;
+}
+
+void GnomeError::Format(char *msg, long maxLen) const
+{
+	if (maxLen <= 0)
+		return;
+	msg[0] = 0;
+	if (!IsSet())
+		return;
+
+	// no snprintf in VS 2008
+	if (fMessage.empty()) {
+		char text[512];
+
+		sprintf(text, "Error %d in %.256s at model time %ld", (int)fCode,
+				fWhere ? fWhere : "GNOME", (long)fTime);
+		strncpy(msg, text, maxLen - 1);
+	}
+	else
+		strncpy(msg, fMessage.c_str(), maxLen - 1);
+	msg[maxLen - 1] = 0;
+}
+
+void GnomeError::Report(const char *defaultMsg) const
+{
+	char msg[256];
+
+	if (!IsSet())
+		return;
+
+	if (fMessage.empty() && defaultMsg)
+		printError(defaultMsg);
+	else {
+		Format(msg, sizeof(msg));
+		printError(msg);
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ *  GnomeError.h
+ *  gnome
+ *
+ *  An error as a code and where it happened, for the per LE paths that
+ *  don't report what goes wrong there. The where is a string literal, kept
+ *  as a pointer, and the only text copied is the message a routine that
+ *  still writes messages (SetInterval, the reads) left, so a GnomeError
+ *  costs nothing until there is an error and its text is made only when
+ *  it is reported.
+ *
+ */
+
+#ifndef __GnomeError__
+#define __GnomeError__
+
+#include <string>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+class DLL_API GnomeError {
+public:
+	GnomeError() : fCode(noErr), fWhere(0), fTime(0) {}
+
+	Boolean		IsSet() const { return fCode != noErr; }
+	OSErr		Code() const { return fCode; }
+
+	// keeps the first error: its code, where (a literal, not copied), the model
+	// time it happened at and the message the routine wrote, if it wrote one
+	void		Set(OSErr code, const char *where, Seconds time, const char *message = 0);
+	void		Clear() { fCode = noErr; fWhere = 0; fTime = 0; fMessage.clear(); }
+
+	// the text of the error, "" if there is none. msg has room for maxLen chars
+	void		Format(char *msg, long maxLen) const;
+	// printError's the text, defaultMsg if the error has no message
+	void		Report(const char *defaultMsg) const;
+
+private:
+	OSErr		fCode;
+	const char	*fWhere;
+	Seconds		fTime;
+	std::string	fMessage;
+};
+
+#endif
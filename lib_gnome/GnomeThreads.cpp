@@ -0,0 +1,195 @@
+/*
+ *  GnomeThreads.cpp
+ *  gnome
+ *
+ */
+
+#include "GnomeThreads.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#include <stdio.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+GnomeMutex::GnomeMutex()
+{
+	Init();
+}
+
+void GnomeMutex::Init()
+{
+#ifdef _WIN32
+	CRITICAL_SECTION *section = new CRITICAL_SECTION;
+	InitializeCriticalSection(section);
+	fMutex = section;
+#else
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	fMutex = mutex;
+#endif
+}
+
+GnomeMutex::~GnomeMutex()
+{
+#ifdef _WIN32
+	DeleteCriticalSection((CRITICAL_SECTION *)fMutex);
+	delete (CRITICAL_SECTION *)fMutex;
+#else
+	pthread_mutex_destroy((pthread_mutex_t *)fMutex);
+	delete (pthread_mutex_t *)fMutex;
+#endif
+}
+
+void GnomeMutex::Lock()
+{
+#ifdef _WIN32
+	EnterCriticalSection((CRITICAL_SECTION *)fMutex);
+#else
+	pthread_mutex_lock((pthread_mutex_t *)fMutex);
+#endif
+}
+
+void GnomeMutex::Unlock()
+{
+#ifdef _WIN32
+	LeaveCriticalSection((CRITICAL_SECTION *)fMutex);
+#else
+	pthread_mutex_unlock((pthread_mutex_t *)fMutex);
+#endif
+}
+
+struct GnomeThreadStart {
+#ifdef _WIN32
+	static DWORD WINAPI Run(LPVOID thread) { GnomeThread::Run((GnomeThread *)thread); return 0; }
+#else
+	static void *Run(void *thread) { GnomeThread::Run((GnomeThread *)thread); return 0; }
+#endif
+};
+
+bool GnomeThread::Start(void (*func)(void *), void *arg)
+{
+	Join();
+	fFunc = func;
+	fArg = arg;
+#ifdef _WIN32
+	fThread = CreateThread(0, 0, GnomeThreadStart::Run, this, 0, 0);
+#else
+	pthread_t *thread = new pthread_t;
+
+	if (pthread_create(thread, 0, GnomeThreadStart::Run, this) == 0)
+		fThread = thread;
+	else
+		delete thread;
+#endif
+	return fThread != 0;
+}
+
+void GnomeThread::Join()
+{
+	if (!fThread)
+		return;
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)fThread, INFINITE);
+	CloseHandle((HANDLE)fThread);
+#else
+	pthread_join(*(pthread_t *)fThread, 0);
+	delete (pthread_t *)fThread;
+#endif
+	fThread = 0;
+}
+
+#ifdef __linux__
+// a sysfs list like 0-3,8-11
+static void ReadNumberList(const char *path, std::vector<int> &numbers)
+{
+	FILE *file = fopen(path, "r");
+	int first, last;
+	char sep;
+
+	numbers.clear();
+	if (!file)
+		return;
+	while (fscanf(file, "%d", &first) == 1) {
+		last = first;
+		if (fscanf(file, "%c", &sep) != 1)
+			sep = '\n';
+		if (sep == '-' && fscanf(file, "%d", &last) == 1 && fscanf(file, "%c", &sep) != 1)
+			sep = '\n';
+		for (int i = first; i <= last; i++)
+			numbers.push_back(i);
+		if (sep != ',')
+			break;
+	}
+	fclose(file);
+}
+#endif
+
+void GetNumaNodes(std::vector<int> &nodes)
+{
+#ifdef __linux__
+	ReadNumberList("/sys/devices/system/node/online", nodes);
+#else
+	nodes.clear();
+#endif
+	if (nodes.empty())
+		nodes.push_back(0);
+}
+
+int GetNumaNodeCount()
+{
+	std::vector<int> nodes;
+
+	GetNumaNodes(nodes);
+	return (int)nodes.size();
+}
+
+int PinWorkerThreads(int numThreads)
+{
+	int pinned = 0;
+#if defined(__linux__) && defined(_OPENMP)
+	std::vector<int> nodes;
+	std::vector< std::vector<int> > cpus;
+	char path[64];
+
+	GetNumaNodes(nodes);
+	if (nodes.size() < 2 || numThreads < 1)
+		return 0;
+
+	cpus.resize(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+		ReadNumberList(path, cpus[i]);
+		if (cpus[i].empty())
+			return 0;	// a node of memory only
+	}
+
+#pragma omp parallel num_threads(numThreads) reduction(+:pinned)
+	{
+		const std::vector<int> &nodeCPUs = cpus[(size_t)omp_get_thread_num() * cpus.size() / omp_get_num_threads()];
+		cpu_set_t set;
+
+		CPU_ZERO(&set);
+		for (size_t i = 0; i < nodeCPUs.size(); i++)
+			if (nodeCPUs[i] < CPU_SETSIZE)
+				CPU_SET(nodeCPUs[i], &set);
+		if (sched_setaffinity(0, sizeof(set), &set) == 0)
+			pinned++;
+	}
+#endif
+	return pinned;
+}
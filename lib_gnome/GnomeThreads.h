@@ -0,0 +1,84 @@
+/*
+ *  GnomeThreads.h
+ *  gnome
+ *
+ *  Locks for the state lib_gnome shares between threads: the handle table,
+ *  the netCDF reads, the caches and each mover. The Cython get_move
+ *  wrappers release the GIL, so Python threads may be moving LEs with
+ *  different movers (or the forecast and uncertain LEs with one mover) at
+ *  once. Doesn't need C++11, the Windows build is still on VS 2008.
+ *
+ */
+
+#ifndef __GnomeThreads__
+#define __GnomeThreads__
+
+#include <vector>
+
+#include "ExportSymbols.h"
+
+#ifdef _MSC_VER
+#define GNOME_THREAD_LOCAL __declspec(thread)
+#else
+#define GNOME_THREAD_LOCAL __thread
+#endif
+
+// recursive, a thread may lock it again. A copy gets a mutex of its own.
+class DLL_API GnomeMutex {
+public:
+	GnomeMutex();
+	GnomeMutex(const GnomeMutex &) { Init(); }
+	~GnomeMutex();
+	GnomeMutex &operator=(const GnomeMutex &) { return *this; }
+
+	void Lock();
+	void Unlock();
+private:
+	void Init();
+	void *fMutex;
+};
+
+// holds the mutex for its scope
+class GnomeLock {
+public:
+	GnomeLock(GnomeMutex &mutex) : fMutex(mutex) { fMutex.Lock(); }
+	~GnomeLock() { fMutex.Unlock(); }
+private:
+	GnomeLock(const GnomeLock &);
+	GnomeLock &operator=(const GnomeLock &);
+	GnomeMutex &fMutex;
+};
+
+// runs func(arg) on a thread of its own, until Join(). The destructor joins it.
+class DLL_API GnomeThread {
+public:
+	GnomeThread() : fThread(0), fFunc(0), fArg(0) {}
+	~GnomeThread() { Join(); }
+
+	// false if the thread couldn't be made, func isn't called then
+	bool Start(void (*func)(void *), void *arg);
+	void Join();
+	bool Running() { return fThread != 0; }
+private:
+	GnomeThread(const GnomeThread &);
+	GnomeThread &operator=(const GnomeThread &);
+	static void Run(GnomeThread *thread) { thread->fFunc(thread->fArg); }
+	friend struct GnomeThreadStart;
+	void *fThread;
+	void (*fFunc)(void *);
+	void *fArg;
+};
+
+// the online NUMA nodes, just node 0 where there's one or they can't be
+// told (not Linux)
+void GetNumaNodes(std::vector<int> &nodes);
+int DLL_API GetNumaNodeCount();
+
+// pins the OpenMP threads of a parallel region numThreads wide to the cpus
+// of the NUMA nodes in blocks, thread t to node t * nodes / numThreads, so
+// the threads stay on their node and a static schedule gives each node the
+// same LE chunks step after step. Returns the threads pinned, 0 on a one
+// node machine or without OpenMP, the threads are left as they are then
+int DLL_API PinWorkerThreads(int numThreads);
+
+#endif
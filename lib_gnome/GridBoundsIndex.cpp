@@ -0,0 +1,71 @@
+/*
+ *  GridBoundsIndex.cpp
+ *  gnome
+ *
+ *  The bounds test is the one WPointInWRect does (edges inclusive), the
+ *  test the maps' InMap start with, so a member is only skipped for points
+ *  its grid can't locate. WPointInWRect itself is not in the pyGNOME build.
+ *
+ */
+
+#include "GridBoundsIndex.h"
+
+static Boolean InBounds(WorldPoint p, const WorldRect &w)
+{
+	return p.pLat >= w.loLat && p.pLat <= w.hiLat &&
+		   p.pLong >= w.loLong && p.pLong <= w.hiLong;
+}
+
+GridBoundsIndex::GridBoundsIndex()
+{
+	Clear();
+}
+
+void GridBoundsIndex::Clear()
+{
+	fBounds.clear();
+	fUnion.loLong = fUnion.loLat = 0;
+	fUnion.hiLong = fUnion.hiLat = -1;	// empty
+}
+
+void GridBoundsIndex::Add(WorldRect bounds)
+{
+	if (fBounds.empty())
+		fUnion = bounds;
+	else {
+		fUnion.loLong = _min(fUnion.loLong, bounds.loLong);
+		fUnion.loLat = _min(fUnion.loLat, bounds.loLat);
+		fUnion.hiLong = _max(fUnion.hiLong, bounds.hiLong);
+		fUnion.hiLat = _max(fUnion.hiLat, bounds.hiLat);
+	}
+	fBounds.push_back(bounds);
+}
+
+void GridBoundsIndex::AddWorld()
+{
+	WorldRect theWorld = { -360000000, -90000000, 360000000, 90000000 };
+
+	Add(theWorld);
+}
+
+Boolean GridBoundsIndex::MayContain(long i, WorldPoint p)
+{
+	if (i < 0 || i >= (long)fBounds.size())
+		return true;
+
+	return InBounds(p, fBounds[i]);
+}
+
+long GridBoundsIndex::NextCandidate(WorldPoint p, long start)
+{
+	long i, n = (long)fBounds.size();
+
+	if (n == 0 || !InBounds(p, fUnion))
+		return -1;
+
+	for (i = _max(start, 0L); i < n; i++)
+		if (InBounds(p, fBounds[i]))
+			return i;
+
+	return -1;
+}
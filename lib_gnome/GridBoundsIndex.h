@@ -0,0 +1,43 @@
+/*
+ *  GridBoundsIndex.h
+ *  gnome
+ *
+ *  The WorldRect bounds of the member grids of a compound mover, in
+ *  priority order, for skipping the grids that can't hold a point before
+ *  asking them to locate it.
+ *
+ */
+
+#ifndef __GridBoundsIndex__
+#define __GridBoundsIndex__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+class GridBoundsIndex
+{
+	public:
+						GridBoundsIndex();
+		void			Clear();
+
+		// members are added in priority order, a member without a grid gets
+		// the whole world so it is never skipped
+		void			Add(WorldRect bounds);
+		void			AddWorld();
+
+		long			GetCount() {return (long)fBounds.size();}
+
+		// false only when member i's grid can't hold p, true for members not added
+		Boolean			MayContain(long i, WorldPoint p);
+
+		// the first member at or after start whose bounds hold p, -1 if none
+		long			NextCandidate(WorldPoint p, long start = 0);
+
+	private:
+		std::vector<WorldRect>	fBounds;
+		WorldRect				fUnion;		// of all the bounds, to drop points off every grid at once
+};
+
+#endif
@@ -11,7 +11,7 @@
 #include "GridCurMover.h"
 #include "CROSS.H"
 
-OSErr GridCurMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr GridCurMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -61,7 +61,7 @@ OSErr GridCurMover_c::PrepareForModelRun()
 	return CurrentMover_c::PrepareForModelRun();
 }
 
-OSErr GridCurMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr GridCurMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	long timeDataInterval;
 	OSErr err=0;
@@ -107,7 +107,7 @@ void GridCurMover_c::ModelStepIsDone()
 
 
 
-WorldPoint3D GridCurMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D GridCurMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {0,0,0.};
 	WorldPoint refPoint = (*theLE).p;	
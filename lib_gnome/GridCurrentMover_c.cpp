@@ -10,6 +10,7 @@
 #include "GridCurrentMover_c.h"
 #include "CompFunctions.h"
 #include "StringFunctions.h"
+#include "InterpolationKernels.h"
 #include <math.h>
 #include <float.h>
 
@@ -58,6 +59,7 @@ GridCurrentMover_c::GridCurrentMover_c (TMap *owner, char *name) : CurrentMover_
 	//
 	
 	fIsOptimizedForStep = false;
+	fBatchHasData = false;
 		
 	SetClassName (name); // short file name
 	
@@ -65,6 +67,8 @@ GridCurrentMover_c::GridCurrentMover_c (TMap *owner, char *name) : CurrentMover_
 	fMaxDepthForExtrapolation = 0.;	// assume 2D is just surface
 	
 	num_method = EULER;
+	fMaxCourant = .5;
+	fMaxSubsteps = 16;
 }
 #endif
 
@@ -102,6 +106,7 @@ GridCurrentMover_c::GridCurrentMover_c () : CurrentMover_c()
 	//
 	
 	fIsOptimizedForStep = false;
+	fBatchHasData = false;
 	
 	//SetClassName (name); // short file name
 	
@@ -109,6 +114,8 @@ GridCurrentMover_c::GridCurrentMover_c () : CurrentMover_c()
 	fMaxDepthForExtrapolation = 0.;	// assume 2D is just surface
 	
 	num_method = EULER;
+	fMaxCourant = .5;
+	fMaxSubsteps = 16;
 }
 
 void GridCurrentMover_c::Dispose ()
@@ -123,7 +130,7 @@ void GridCurrentMover_c::Dispose ()
 	CurrentMover_c::Dispose ();
 }
 
-OSErr GridCurrentMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr GridCurrentMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -172,12 +179,12 @@ OSErr GridCurrentMover_c::PrepareForModelRun()
 
 
 OSErr GridCurrentMover_c::PrepareForModelStep(const Seconds &model_time, const Seconds &time_step,
-											  bool uncertain, int numLESets, int *LESetsSizesList)
+											  bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
-	char errmsg[256];
-	
-	errmsg[0] = 0;
+	GnomeError error;
 	
 	if (bIsFirstStep)
 		fModelStartTime = model_time;
@@ -188,7 +195,7 @@ OSErr GridCurrentMover_c::PrepareForModelStep(const Seconds &model_time, const S
 	if (!timeGrid)
 		return -1;
 
-	err = timeGrid->SetInterval(errmsg, model_time);
+	err = timeGrid->SetInterval(error, model_time);
 	if (err)
 		goto done;
 	
@@ -202,23 +209,39 @@ OSErr GridCurrentMover_c::PrepareForModelStep(const Seconds &model_time, const S
 done:
 	
 	if (err) {
-		if (!errmsg[0])
-			strcpy(errmsg, "An error occurred in GridCurrentMover_c::PrepareForModelStep");
-		printError(errmsg); 
+		error.Set(err, "GridCurrentMover_c::PrepareForModelStep", model_time);
+		error.Report("An error occurred in GridCurrentMover_c::PrepareForModelStep");
 	}	
 
 	return err;
 }
 
 
+OSErr GridCurrentMover_c::LoadInterval(const Seconds &model_time, char *errmsg)
+{
+	LOCK_MOVER;
+
+	errmsg[0] = 0;
+	if (!timeGrid) {
+		strcpy(errmsg, "No time grid");
+		return -1;
+	}
+
+	return timeGrid->SetInterval(errmsg, model_time);
+}
+
+
 void GridCurrentMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	fIsOptimizedForStep = false;
 	bIsFirstStep = false;
 }
 
 
-OSErr GridCurrentMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+OSErr GridCurrentMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 
 	if(!ref || !delta) {
 		//cout << "worldpoints array not provided! returning.\n";
@@ -233,13 +256,40 @@ OSErr GridCurrentMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 		return 2;
 	}
 	
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-	
+	if (timeGrid->UsesActiveWindow()) {
+		char errmsg[256];
+		// the grid is read around the LEs, make sure the loaded part covers them
+		OSErr err = timeGrid->UpdateActiveWindow(errmsg, model_time, n, ref, LE_status);
+		if (err) {
+			WorldPoint3D no_move = {{0,0},0.};
+			for (LECount i = 0; i < n; i++)
+				delta[i] = no_move;
+			return err;
+		}
+	}
+
+	// once the step is prepared RK4 goes stage by stage so the interval is set per stage, not per LE
+	if (num_method == RK4 && fIsOptimizedForStep)
+		return GetMovesRK4(n, model_time, step_len, ref, delta, LE_status);
+
 	WorldPoint3D zero_delta ={0,0,0.};
-	
-	for (int i = 0; i < n; i++) {
+	// the interval is loaded once per step so LEs are independent, ADAPTIVE
+	// sets it for the RK4 stages of each LE that needs them so it is serial
+	bool runParallel = fNumThreads > 1 && fIsOptimizedForStep && num_method == EULER;
+
+	if (fIsOptimizedForStep && num_method == EULER) {
+		OSErr err = timeGrid->PrepareInterpolatedField(model_time);
+		if (err) return err;
+	}
+	GetTriHint(0, n);	// sized before the threads use them
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
+
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -263,6 +313,254 @@ OSErr GridCurrentMover_c::get_move(int n, Seconds model_time, Seconds step_len,
 	return noErr;
 }
 
+// RK4 for all LEs one stage at a time. The stages only sample t, t+dt/2 and t+dt
+// so SetInterval runs 4 times per step (the repeated t+dt/2 is just a check)
+// instead of 4 times per LE, and the inner loop is spatial interpolation only.
+// Same arithmetic as the RK4 branch of GetMove, so the deltas are identical.
+// With the device interpolation the LEs of a stage go to the grid as one batch.
+OSErr GridCurrentMover_c::GetMovesRK4(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status)
+{
+	OSErr err = 0;
+	GnomeError error;
+	double RK_dy_Factors[4] = {0, .5, .5, 1};
+	double RK_Factors[4] = {1./6., 1./3., 1./3., 1./6.};
+	WorldPoint3D zero_delta = {{0,0},0.};
+	vector<WorldPoint3D> stageDelta(n, zero_delta);	// dy of the previous stage, in GNOME units
+	bool batchStages = GetInterpolationDevice();
+	bool runParallel = fNumThreads > 1 && !batchStages;
+	vector<long> stageHints;
+	vector<WorldPoint3D> stagePoints;
+	vector<VelocityRec> stageVel, batchVel;
+
+	for (LECount i = 0; i < n; i++)
+		delta[i] = zero_delta;
+	GetTriHint(0, n);
+
+	for (int k = 0; k < 4; k++) {
+		Seconds stageTime = model_time + (Seconds)(step_len * RK_dy_Factors[k]);
+
+		err = timeGrid->SetInterval(error, stageTime);
+		if (err) {
+			// same as GetMove, LEs don't move if there is no data for the time
+			for (LECount i = 0; i < n; i++)
+				delta[i] = zero_delta;
+			return noErr;
+		}
+		err = timeGrid->PrepareInterpolatedField(stageTime);
+		if (err) return err;
+
+		if (batchStages) {
+			stageHints.clear();
+			stagePoints.clear();
+			for (LECount i = 0; i < n; i++) {
+				WorldPoint3D startPoint = ref[i];
+
+				if (LE_status[i] != OILSTAT_INWATER)
+					continue;
+
+				startPoint.p.pLat *= 1000000;
+				startPoint.p.pLong *= 1000000;
+				stagePoints.push_back(add_two_WP3D(startPoint, scale_WP(stageDelta[i], RK_dy_Factors[k])));
+				stageHints.push_back(fTriHints[i]);
+			}
+			if (stagePoints.empty())
+				break;
+
+			batchVel.resize(stagePoints.size());
+			stageVel.resize(n);
+			timeGrid->GetScaledPatValues(stageTime, stagePoints.size(), &stagePoints[0], &stageHints[0], &batchVel[0]);
+			for (LECount i = 0, j = 0; i < n; i++) {
+				if (LE_status[i] != OILSTAT_INWATER)
+					continue;
+				fTriHints[i] = stageHints[j];
+				stageVel[i] = batchVel[j++];
+			}
+		}
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+		for (LECount i = 0; i < n; i++) {
+			WorldPoint3D startPoint, RKDelta;
+			VelocityRec scaledVel;
+			double dLong, dLat;
+
+			if (LE_status[i] != OILSTAT_INWATER)
+				continue;
+
+			startPoint = ref[i];
+			startPoint.p.pLat *= 1000000;
+			startPoint.p.pLong *= 1000000;
+
+			if (batchStages)
+				scaledVel = stageVel[i];
+			else {
+				RKDelta = scale_WP(stageDelta[i], RK_dy_Factors[k]);
+				scaledVel = timeGrid->GetScaledPatValue(stageTime, add_two_WP3D(startPoint, RKDelta), &fTriHints[i]);
+			}
+			scaledVel.u *= fCurScale;
+			scaledVel.v *= fCurScale;
+
+			dLong = ((scaledVel.u / METERSPERDEGREELAT) * step_len) / LongToLatRatio3 (startPoint.p.pLat);
+			dLat  =  (scaledVel.v / METERSPERDEGREELAT) * step_len;
+			stageDelta[i].p.pLong = dLong * 1000000;
+			stageDelta[i].p.pLat  = dLat  * 1000000;
+
+			delta[i] = add_two_WP3D(delta[i], scale_WP(stageDelta[i], RK_Factors[k]));
+		}
+	}
+
+	for (LECount i = 0; i < n; i++) {
+		delta[i].p.pLat /= 1000000;
+		delta[i].p.pLong /= 1000000;
+	}
+
+	return noErr;
+}
+
+OSErr GridCurrentMover_c::UpdateBatchWindow(LECount n, Seconds model_time, const double *lat, const double *lon,
+											 const double *z, const short *LE_status)
+{
+	char errmsg[256];
+
+	if (!timeGrid->UsesActiveWindow() || !lat || !lon || !z || !LE_status)
+		return noErr;
+
+	vector<WorldPoint3D> ref(n > 0 ? n : 1);
+	for (LECount i = 0; i < n; i++) {
+		ref[i].p.pLat = lat[i];
+		ref[i].p.pLong = lon[i];
+		ref[i].z = z[i];
+	}
+
+	return timeGrid->UpdateActiveWindow(errmsg, model_time, n, &ref[0], (short *)LE_status);
+}
+
+OSErr GridCurrentMover_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+										 const double *lat, const double *lon, const double *z,
+										 const double *windages, const short *LE_status,
+										 double *delta_lat, double *delta_lon, double *delta_z,
+										 LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+	OSErr err = 0;
+
+	// RK4 evaluates the grid at intermediate points, it goes through GetMove
+	if (num_method != EULER) {
+		err = UpdateBatchWindow(n, model_time, lat, lon, z, LE_status);
+		if (err) return err;
+
+		return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+									   delta_lat, delta_lon, delta_z, spillType, spill_ID);
+	}
+
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	err = BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+	if (err) {
+		for (LECount i = 0; i < n; i++)
+			delta_lat[i] = delta_lon[i] = delta_z[i] = 0.;
+		return err;
+	}
+
+	MoveBatchLEs(n, 0, 0, model_time, step_len, lat, lon, z, windages, LE_status,
+				 delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	return noErr;
+}
+
+OSErr GridCurrentMover_c::BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+										 const double *lat, const double *lon, const double *z,
+										 const double *windages, const short *LE_status, LEType spillType)
+{
+	OSErr err = 0;
+	GnomeError error;
+
+	fBatchHasData = false;
+
+	err = UpdateBatchWindow(n, model_time, lat, lon, z, LE_status);
+	if (err) return err;
+
+	if (!fIsOptimizedForStep)
+	{
+		// same as GetMove, LEs don't move if there is no data for the time
+		err = timeGrid->SetInterval(error, model_time);
+		if (err) return noErr;
+	}
+	err = timeGrid->PrepareInterpolatedField(model_time);
+	if (err) return err;
+	GetTriHint(0, n);
+
+	fBatchHasData = true;
+	return noErr;
+}
+
+void GridCurrentMover_c::MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+										const double *lat, const double *lon, const double *z,
+										const double *windages, const short *LE_status,
+										double *delta_lat, double *delta_lon, double *delta_z,
+										LEType spillType, long spill_ID)
+{
+	WorldPoint3D refPoint;
+	VelocityRec scaledPatVelocity;
+	Boolean useEddyUncertainty = false;
+
+	for (int k = 0; k < count; k++)
+		delta_lat[k] = delta_lon[k] = delta_z[k] = 0.;
+
+	if (!fBatchHasData)
+		return;
+
+	// the grid interpolates the LEs in water as one batch
+	fBatchInWater.clear();
+	fBatchHints.clear();
+	fBatchRefPoints.clear();
+	for (int k = 0; k < count; k++) {
+		LECount i = index ? index[k] : first + k;
+
+		if (LE_status[i] != OILSTAT_INWATER)
+			continue;
+
+		// the grid works on positions scaled by 1000000
+		refPoint.p.pLat = lat[i] * 1000000;
+		refPoint.p.pLong = lon[i] * 1000000;
+		refPoint.z = z[i];
+
+		fBatchInWater.push_back(k);
+		fBatchRefPoints.push_back(refPoint);
+		fBatchHints.push_back(fTriHints[i]);
+	}
+	if (fBatchInWater.empty())
+		return;
+
+	fBatchVelocities.resize(fBatchInWater.size());
+	timeGrid->GetScaledPatValues(model_time, fBatchInWater.size(), &fBatchRefPoints[0], &fBatchHints[0], &fBatchVelocities[0]);
+
+	for (size_t j = 0; j < fBatchInWater.size(); j++) {
+		int k = fBatchInWater[j], i = index ? index[k] : first + k;
+
+		fTriHints[i] = fBatchHints[j];
+		refPoint = fBatchRefPoints[j];
+		scaledPatVelocity = fBatchVelocities[j];
+
+		scaledPatVelocity.u *= fCurScale;
+		scaledPatVelocity.v *= fCurScale;
+
+		if (spillType == UNCERTAINTY_LE)
+		{
+			AddUncertainty(spill_ID, i, &scaledPatVelocity, step_len, useEddyUncertainty);
+		}
+
+		delta_lon[k] = ((scaledPatVelocity.u / METERSPERDEGREELAT) * step_len) / LongToLatRatio3(refPoint.p.pLat);
+		delta_lat[k] = (scaledPatVelocity.v / METERSPERDEGREELAT) * step_len;
+	}
+}
+
 //Helper function to scale WorldPoint when used as a delta distance...useful in Runge-Kutta
 WorldPoint3D GridCurrentMover_c::scale_WP(WorldPoint3D point, double scale)
 {
@@ -283,10 +581,10 @@ WorldPoint3D GridCurrentMover_c::add_two_WP3D(const WorldPoint3D &a, const World
 }
 
 
-WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	OSErr err = 0;
-	char errmsg[256];
+	GnomeError error;	// the LE doesn't move if there is no data, the error isn't reported
 	if (num_method == EULER) { //EULER
 		WorldPoint3D	deltaPoint = {{0,0},0.};
 		WorldPoint3D refPoint;
@@ -297,13 +595,13 @@ WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds time
 
 		if(!fIsOptimizedForStep)
 		{
-			err = timeGrid->SetInterval(errmsg, model_time);
+			err = timeGrid->SetInterval(error, model_time);
 			if (err) return deltaPoint;
 		}
 
 		refPoint.p = (*theLE).p;
 		refPoint.z = (*theLE).z;
-		scaledPatVelocity = timeGrid->GetScaledPatValue(model_time, refPoint);
+		scaledPatVelocity = timeGrid->GetScaledPatValue(model_time, refPoint, GetTriHint(leIndex, 0));
 
 		scaledPatVelocity.u *= fCurScale;
 		scaledPatVelocity.v *= fCurScale;
@@ -320,6 +618,8 @@ WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds time
 		deltaPoint.p.pLat  = dLat  * 1000000;
 
 		return deltaPoint;
+	} else if (num_method == ADAPTIVE) {
+		return GetAdaptiveMove(model_time, timeStep, setIndex, leIndex, theLE, leType);
 	} else { //RK4
 		WorldPoint3D deltaD[5] = {{0,0},0}; // [ dummy, dy1, dy2, dy3, dy4 ]
 			double RK_dy_Factors[4] = {0, .5, .5, 1};
@@ -334,7 +634,7 @@ WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds time
 			// check the interval and set if necessary each time
 			/*if(!fIsOptimizedForStep)
 			{
-				err = timeGrid->SetInterval(errmsg, model_time);
+				err = timeGrid->SetInterval(error, model_time);
 
 				if (err) return finalDelta;
 			}*/
@@ -342,7 +642,7 @@ WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds time
 			for (int i = 0; i < 4; i++) {
 				WorldPoint3D RKDelta = scale_WP(deltaD[i], RK_dy_Factors[i]);
 				// could check the end time and only set interval if RK time is past the end time
-				err = timeGrid->SetInterval(errmsg, model_time + (Seconds)(timeStep*RK_dy_Factors[i]));
+				err = timeGrid->SetInterval(error, model_time + (Seconds)(timeStep*RK_dy_Factors[i]));
 				if (err) return finalDelta;
 				scaledVel[i] = timeGrid->GetScaledPatValue(model_time + (Seconds)(timeStep*RK_dy_Factors[i]), add_two_WP3D(startPoint, RKDelta));
 				scaledVel[i].u *= fCurScale;
@@ -361,6 +661,156 @@ WorldPoint3D GridCurrentMover_c::GetMove(const Seconds& model_time, Seconds time
 	}
 }
 
+WorldPoint3D GridCurrentMover_c::VelocityToDelta(VelocityRec vel, double timeStep, WorldPoint3D refPoint)
+{
+	WorldPoint3D deltaPoint = {{0,0},0.};
+	double dLong, dLat;
+
+	dLong = ((vel.u / METERSPERDEGREELAT) * timeStep) / LongToLatRatio3 (refPoint.p.pLat);
+	dLat  =  (vel.v / METERSPERDEGREELAT) * timeStep;
+
+	deltaPoint.p.pLong = dLong * 1000000;
+	deltaPoint.p.pLat  = dLat  * 1000000;
+
+	return deltaPoint;
+}
+
+// how many of its cells the LE moves in the step, 0 where the grid doesn't know the cell size
+double GridCurrentMover_c::GetCourantNumber(VelocityRec vel, double timeStep, WorldPoint3D refPoint, long *triHint)
+{
+	double cellSize = timeGrid->GetCellSize(refPoint, triHint);
+
+	if (cellSize <= 0)
+		return 0;
+
+	return sqrt(vel.u * vel.u + vel.v * vel.v) * timeStep / cellSize;
+}
+
+// one RK4 step from startPoint, the same as the RK4 branch of GetMove
+OSErr GridCurrentMover_c::GetRK4Step(const Seconds& model_time, double timeStep, WorldPoint3D startPoint, long *triHint, WorldPoint3D *delta)
+{
+	OSErr err = 0;
+	GnomeError error;
+	WorldPoint3D deltaD[5] = {{0,0},0}; // [ dummy, dy1, dy2, dy3, dy4 ]
+	double RK_dy_Factors[4] = {0, .5, .5, 1};
+	double RK_Factors[4] = {1./6., 1./3., 1./3., 1./6.};
+	WorldPoint3D finalDelta = {{0,0},0};
+
+	for (int i = 0; i < 4; i++) {
+		Seconds stageTime = model_time + (Seconds)(timeStep*RK_dy_Factors[i]);
+		WorldPoint3D RKDelta = scale_WP(deltaD[i], RK_dy_Factors[i]);
+		VelocityRec scaledVel;
+
+		err = timeGrid->SetInterval(error, stageTime);
+		if (err) return err;
+		scaledVel = timeGrid->GetScaledPatValue(stageTime, add_two_WP3D(startPoint, RKDelta), triHint);
+		scaledVel.u *= fCurScale;
+		scaledVel.v *= fCurScale;
+		deltaD[i+1] = VelocityToDelta(scaledVel, timeStep, startPoint);
+	}
+
+	for (int i = 0; i < 4; i++)
+		finalDelta = add_two_WP3D(finalDelta, scale_WP(deltaD[i+1], RK_Factors[i]));
+
+	*delta = finalDelta;
+	return noErr;
+}
+
+// Euler where the LE moves less than fMaxCourant of its cell in the step, RK4 where
+// it moves further, in as many sub-steps (up to fMaxSubsteps) as keep each of them
+// under fMaxCourant. The uncertainty is the Euler one, added to the RK4 move
+WorldPoint3D GridCurrentMover_c::GetAdaptiveMove(const Seconds& model_time, Seconds timeStep, long setIndex, LECount leIndex, LERec *theLE, LETYPE leType)
+{
+	GnomeError error;
+	WorldPoint3D deltaPoint = {{0,0},0.}, refPoint, point, stepDelta;
+	VelocityRec scaledPatVelocity, uncertainVelocity;
+	Boolean useEddyUncertainty = false;
+	long *triHint = GetTriHint(leIndex, 0);
+	double courant, substep;
+	long numSubsteps;
+
+	refPoint.p = (*theLE).p;
+	refPoint.z = (*theLE).z;
+
+	// an RK4 LE before this one may have left the interval at a later time
+	if (timeGrid->SetInterval(error, model_time))
+		return deltaPoint;
+
+	scaledPatVelocity = timeGrid->GetScaledPatValue(model_time, refPoint, triHint);
+	scaledPatVelocity.u *= fCurScale;
+	scaledPatVelocity.v *= fCurScale;
+
+	uncertainVelocity = scaledPatVelocity;
+	if (leType == UNCERTAINTY_LE)
+		AddUncertainty(setIndex, leIndex, &uncertainVelocity, timeStep, useEddyUncertainty);
+
+	courant = GetCourantNumber(scaledPatVelocity, timeStep, refPoint, triHint);
+	if (courant <= fMaxCourant || fMaxCourant <= 0)
+		return VelocityToDelta(uncertainVelocity, timeStep, refPoint);
+
+	numSubsteps = (long)ceil(courant / fMaxCourant);
+	if (numSubsteps > fMaxSubsteps) numSubsteps = fMaxSubsteps > 0 ? fMaxSubsteps : 1;
+	substep = timeStep / (double)numSubsteps;
+
+	point = refPoint;
+	for (long j = 0; j < numSubsteps; j++) {
+		// no data for the sub-step's time, the LE stops where it got to, as GetMove does
+		if (GetRK4Step(model_time + (Seconds)(j * substep), substep, point, triHint, &stepDelta))
+			break;
+		point = add_two_WP3D(point, stepDelta);
+	}
+
+	deltaPoint.p.pLat = point.p.pLat - refPoint.p.pLat;
+	deltaPoint.p.pLong = point.p.pLong - refPoint.p.pLong;
+
+	uncertainVelocity.u -= scaledPatVelocity.u;
+	uncertainVelocity.v -= scaledPatVelocity.v;
+
+	return add_two_WP3D(deltaPoint, VelocityToDelta(uncertainVelocity, timeStep, refPoint));
+}
+
+OSErr GridCurrentMover_c::GetCourantNumbers(LECount n, Seconds model_time, Seconds step_len,
+											const double *lat, const double *lon, const double *z,
+											const short *LE_status, double *courant)
+{
+	LOCK_MOVER;
+	OSErr err = 0;
+	GnomeError error;
+	WorldPoint3D refPoint;
+	VelocityRec scaledPatVelocity;
+
+	if (!lat || !lon || !z || !LE_status || !courant)
+		return 1;
+
+	for (LECount i = 0; i < n; i++)
+		courant[i] = 0;
+
+	err = UpdateBatchWindow(n, model_time, lat, lon, z, LE_status);
+	if (err) return err;
+
+	// no data for the time, nothing moves
+	if (timeGrid->SetInterval(error, model_time))
+		return noErr;
+	GetTriHint(0, n);
+
+	for (LECount i = 0; i < n; i++) {
+		if (LE_status[i] != OILSTAT_INWATER)
+			continue;
+
+		refPoint.p.pLat = lat[i] * 1000000;
+		refPoint.p.pLong = lon[i] * 1000000;
+		refPoint.z = z[i];
+
+		scaledPatVelocity = timeGrid->GetScaledPatValue(model_time, refPoint, &fTriHints[i]);
+		scaledPatVelocity.u *= fCurScale;
+		scaledPatVelocity.v *= fCurScale;
+
+		courant[i] = GetCourantNumber(scaledPatVelocity, step_len, refPoint, &fTriHints[i]);
+	}
+
+	return noErr;
+}
+
 OSErr GridCurrentMover_c::TextRead(char *path, char *topFilePath) 
 {
 	// this code is for curvilinear grids
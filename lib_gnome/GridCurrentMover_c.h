@@ -33,6 +33,10 @@ public:
 	Boolean fIsOptimizedForStep;
 	TimeGridVel *timeGrid;
 	int num_method;
+	// ADAPTIVE only: the Courant number (the move over the size of the LE's
+	// cell) up to which an LE takes one Euler step, and the most RK4 sub-steps
+	double fMaxCourant;
+	long fMaxSubsteps;
 	Boolean fAllowVerticalExtrapolationOfCurrents;
 	float	fMaxDepthForExtrapolation;
 	
@@ -46,7 +50,7 @@ public:
 	//virtual ClassID 	GetClassID () { return TYPE_GRIDCURRENTMOVER; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_GRIDCURRENTMOVER) return TRUE; return CurrentMover_c::IAm(id); }
 
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	VelocityRec			GetPatValue (WorldPoint p);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	
@@ -58,6 +62,28 @@ public:
 	void	SetExtrapolationInTime(bool extrapolate) {timeGrid->SetExtrapolationInTime(extrapolate);}	
 	bool	GetExtrapolationInTime() {return timeGrid->GetExtrapolationInTime();}	
 
+	void	SetActiveWindowMode(bool useWindow, long halo) {timeGrid->SetActiveWindowMode(useWindow, halo);}
+	bool	GetActiveWindowMode() {return timeGrid->UsesActiveWindow();}
+	bool	SetActiveWindowBounds(const WorldRect &bounds) {return timeGrid->SetActiveWindowBounds(bounds);}
+
+	void	SetPrefetch(bool prefetch) {timeGrid->SetPrefetch(prefetch);}
+	bool	GetPrefetch() {return timeGrid->GetPrefetch();}
+
+	void	SetSinglePrecision(bool singlePrecision) {timeGrid->SetSinglePrecision(singlePrecision);}
+	bool	GetSinglePrecision() {return timeGrid->GetSinglePrecision();}
+
+	void	SetInterpolatedFieldMode(bool useField) {timeGrid->SetInterpolatedFieldMode(useField);}
+	bool	GetInterpolatedFieldMode() {return timeGrid->GetInterpolatedFieldMode();}
+	void	SetCellBinningMode(bool binByCell) {timeGrid->SetCellBinningMode(binByCell);}
+	bool	GetCellBinningMode() {return timeGrid->GetCellBinningMode();}
+	void	SetWaterNodeLayout(bool waterNodes) {timeGrid->SetWaterNodeLayout(waterNodes);}
+	bool	GetWaterNodeLayout() {return timeGrid->GetWaterNodeLayout();}
+	void	SetNearestNodeMode(bool nearestNode) {timeGrid->SetNearestNodeMode(nearestNode);}
+	bool	GetNearestNodeMode() {return timeGrid->GetNearestNodeMode();}
+
+	virtual void	GetTimingStats(TimingStats *stats) {Mover_c::GetTimingStats(stats); if (timeGrid) stats->Add(timeGrid->fTiming);}
+	virtual void	ResetTimingStats() {Mover_c::ResetTimingStats(); if (timeGrid) timeGrid->fTiming.Reset();}
+
 	void	SetTimeShift(long timeShift) {timeGrid->SetTimeShift(timeShift);}	
 	long	GetTimeShift() {return timeGrid->GetTimeShift();}	
 	
@@ -65,12 +91,15 @@ public:
 	OSErr	GetDataEndTime(Seconds *endTime) {return timeGrid->GetDataEndTime(endTime);}	
 	
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	
 			OSErr		TextRead(char *path,char *topFilePath);
 			OSErr 		ExportTopology(char* path){return timeGrid->ExportTopology(path);}
+			OSErr		WriteForcingFile(const char *path, char *errmsg) {return timeGrid->WriteForcingFile(path, errmsg);}
+			// only the time grid's SetInterval for the time, to time and count the reads without moving LEs
+			OSErr		LoadInterval(const Seconds &model_time, char *errmsg);
 
 			OSErr 		GetScaledVelocities(Seconds model_time, VelocityFRec *velocity);
 			TopologyHdl GetTopologyHdl(void);
@@ -82,11 +111,44 @@ public:
 			bool 		IsTriangleGrid(){return timeGrid->IsTriangleGrid();}
 			bool 		IsDataOnCells(){return timeGrid->IsDataOnCells();}
 
-			OSErr		get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+			OSErr		get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+			// the Courant number of each LE in water for a step of step_len from model_time, 0 for the others
+			OSErr		GetCourantNumbers(LECount n, Seconds model_time, Seconds step_len,
+										  const double *lat, const double *lon, const double *z,
+										  const short *LE_status, double *courant);
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
+
+	virtual Boolean		CanFuseMove() { return num_method == EULER; }
+	virtual Boolean		CanMoveInParallel(LETYPE leType) { return fIsOptimizedForStep && num_method == EULER; }
+	virtual OSErr		BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status, LEType spillType);
+	virtual void		MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
 
 
 
 private:
+	Boolean		fBatchHasData;	// set by BeginMoveBatch, false when there is no data for the time
+	// MoveBatchLEs's LEs in water, kept so the chunks don't allocate
+	std::vector<long>			fBatchInWater, fBatchHints;
+	std::vector<WorldPoint3D>	fBatchRefPoints;
+	std::vector<VelocityRec>	fBatchVelocities;
+
+	OSErr		UpdateBatchWindow(LECount n, Seconds model_time, const double *lat, const double *lon,
+								  const double *z, const short *LE_status);
+	OSErr		GetMovesRK4(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status);
+	WorldPoint3D GetAdaptiveMove(const Seconds& model_time, Seconds timeStep, long setIndex, LECount leIndex, LERec *theLE, LETYPE leType);
+	OSErr		GetRK4Step(const Seconds& model_time, double timeStep, WorldPoint3D startPoint, long *triHint, WorldPoint3D *delta);
+	double		GetCourantNumber(VelocityRec vel, double timeStep, WorldPoint3D refPoint, long *triHint);
+	WorldPoint3D VelocityToDelta(VelocityRec vel, double timeStep, WorldPoint3D refPoint);
 	WorldPoint3D scale_WP(WorldPoint3D, double);
 	WorldPoint3D add_two_WP3D(const WorldPoint3D&, const WorldPoint3D&);
 };
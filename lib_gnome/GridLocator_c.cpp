@@ -0,0 +1,351 @@
+/*
+ *  GridLocator_c.cpp
+ *  gnome
+ *
+ */
+
+#include <vector>
+#include <algorithm>
+
+#include "GridLocator_c.h"
+#include "MemUtils.h"
+#include "Replacements.h"
+
+using std::vector;
+
+GridLocator_c::GridLocator_c()
+{
+	fDagTree = 0;
+	fNumNodes = 0;
+	fNumTris = 0;
+}
+
+void GridLocator_c::Dispose()
+{
+	if (fDagTree)
+	{
+		delete fDagTree;	// disposes of the points, topology and tree
+		fDagTree = 0;
+	}
+	fNumNodes = 0;
+	fNumTris = 0;
+}
+
+// an edge of a triangle, by its end nodes in order, for matching the two sides of it
+struct LocatorEdge
+{
+	long	lo, hi;
+	long	tri, side;	// side is the vertex the edge is opposite to
+
+	bool operator<(const LocatorEdge &other) const
+	{
+		return lo < other.lo || (lo == other.lo && hi < other.hi);
+	}
+};
+
+OSErr GridLocator_c::MakeTopology(long numTris, const long *triangles, TopologyHdl topH, char *errmsg)
+{
+	LongPointHdl ptsH = fDagTree ? fDagTree->GetPointsHdl() : 0;
+	vector<LocatorEdge> edges(3 * numTris);
+
+	for (long i = 0; i < numTris; i++)
+	{
+		long v[3] = {triangles[3*i], triangles[3*i+1], triangles[3*i+2]};
+		LongPoint p[3];
+		double cross;
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (v[k] < 0 || v[k] >= fNumNodes)
+			{
+				sprintf(errmsg, "Triangle %ld has node %ld, there are %ld nodes.", i, v[k], fNumNodes);
+				return -1;
+			}
+			p[k] = (*ptsH)[v[k]];
+		}
+
+		// the DAG tree wants them counterclockwise
+		cross = (double)(p[1].h - p[0].h) * (p[2].v - p[0].v) - (double)(p[2].h - p[0].h) * (p[1].v - p[0].v);
+		if (cross < 0)
+			std::swap(v[1], v[2]);
+
+		(*topH)[i].vertex1 = v[0];
+		(*topH)[i].vertex2 = v[1];
+		(*topH)[i].vertex3 = v[2];
+		(*topH)[i].adjTri1 = (*topH)[i].adjTri2 = (*topH)[i].adjTri3 = -1;
+
+		for (int k = 0; k < 3; k++)
+		{
+			LocatorEdge &e = edges[3*i + k];
+			long a = v[(k + 1) % 3], b = v[(k + 2) % 3];
+
+			e.lo = std::min(a, b);
+			e.hi = std::max(a, b);
+			e.tri = i;
+			e.side = k;
+		}
+	}
+
+	// the triangles on either side of an edge are next to each other once sorted
+	std::sort(edges.begin(), edges.end());
+	for (size_t j = 0; j + 1 < edges.size(); j++)
+	{
+		LocatorEdge &e = edges[j], &f = edges[j+1];
+		long *adj[3];
+
+		if (e.lo != f.lo || e.hi != f.hi)
+			continue;
+
+		adj[0] = &(*topH)[e.tri].adjTri1; adj[1] = &(*topH)[e.tri].adjTri2; adj[2] = &(*topH)[e.tri].adjTri3;
+		*adj[e.side] = f.tri;
+		adj[0] = &(*topH)[f.tri].adjTri1; adj[1] = &(*topH)[f.tri].adjTri2; adj[2] = &(*topH)[f.tri].adjTri3;
+		*adj[f.side] = e.tri;
+		j++;
+	}
+
+	return noErr;
+}
+
+OSErr GridLocator_c::Build(long numNodes, const double *lon, const double *lat,
+						   long numTris, const long *triangles, char *errmsg)
+{
+	OSErr err = 0;
+	LongPointHdl ptsH = 0;
+	TopologyHdl topH = 0;
+	DAGTreeStruct tree;
+
+	errmsg[0] = 0;
+	Dispose();
+
+	if (numNodes < 3 || numTris < 1 || !lon || !lat || !triangles)
+	{
+		strcpy(errmsg, "A grid needs at least one triangle.");
+		return -1;
+	}
+
+	ptsH = (LongPointHdl)_NewHandle(numNodes * sizeof(LongPoint));
+	topH = (TopologyHdl)_NewHandle(numTris * sizeof(Topology));
+	if (!ptsH || !topH)
+	{
+		strcpy(errmsg, "Not enough memory for the grid.");
+		err = memFullErr;
+		goto done;
+	}
+
+	// the grids work on positions scaled by 1000000
+	for (long i = 0; i < numNodes; i++)
+	{
+		(*ptsH)[i].h = (long)(lon[i] * 1000000);
+		(*ptsH)[i].v = (long)(lat[i] * 1000000);
+	}
+
+	fNumNodes = numNodes;
+	fNumTris = numTris;
+
+	// the tree is put together once the topology is made
+	fDagTree = new TDagTree(ptsH, 0, 0, 0, 0);
+	if (!fDagTree)
+	{
+		strcpy(errmsg, "Not enough memory for the grid.");
+		err = memFullErr;
+		goto done;
+	}
+	ptsH = 0;	// the tree has it
+
+	err = MakeTopology(numTris, triangles, topH, errmsg);
+	if (err) goto done;
+
+	tree = MakeDagTree(topH, (LongPoint**)fDagTree->GetPointsHdl(), errmsg);
+	if (errmsg[0])
+	{
+		err = -1;
+		goto done;
+	}
+	_SetHandleSize((Handle)tree.treeHdl, tree.numBranches * sizeof(DAG));
+
+	fDagTree->fTopH = topH;
+	fDagTree->fTreeH = tree.treeHdl;
+	fDagTree->fNumBranches = tree.numBranches;
+	topH = 0;
+
+done:
+	if (ptsH) DisposeHandle((Handle)ptsH);
+	if (topH) DisposeHandle((Handle)topH);
+	if (err) Dispose();
+
+	return err;
+}
+
+long GridLocator_c::LocateOne(double lon, double lat, long hint, long *node, double *alpha)
+{
+	TopologyHdl topH = fDagTree ? fDagTree->GetTopologyHdl() : 0;
+	LongPointHdl ptsH = fDagTree ? fDagTree->GetPointsHdl() : 0;
+	LongPoint lp;
+	long ntri;
+	double refLon, refLat, denom;
+	ExPoint vertex1, vertex2, vertex3;
+
+	node[0] = node[1] = node[2] = -1;
+	alpha[0] = alpha[1] = alpha[2] = 0;
+
+	if (!topH || !ptsH)
+		return -1;
+
+	lp.h = (long)(lon * 1000000);
+	lp.v = (long)(lat * 1000000);
+	ntri = hint >= 0 && hint < fNumTris ? fDagTree->WhatTriAmIIn(lp, &hint) : fDagTree->WhatTriAmIIn(lp);
+
+	// the tree says which side of the grid a point is off by how negative it is
+	if (ntri < 0)
+		return -1;
+
+	node[0] = (*topH)[ntri].vertex1;
+	node[1] = (*topH)[ntri].vertex2;
+	node[2] = (*topH)[ntri].vertex3;
+
+	// the same weights as TriGridVel_c::GetInterpolationValues
+	refLon = lp.h / 1000000.;
+	refLat = lp.v / 1000000.;
+	vertex1.h = (*ptsH)[node[0]].h / 1000000.;
+	vertex1.v = (*ptsH)[node[0]].v / 1000000.;
+	vertex2.h = (*ptsH)[node[1]].h / 1000000.;
+	vertex2.v = (*ptsH)[node[1]].v / 1000000.;
+	vertex3.h = (*ptsH)[node[2]].h / 1000000.;
+	vertex3.v = (*ptsH)[node[2]].v / 1000000.;
+
+	denom = (vertex3.v-vertex1.v)*(vertex2.h-vertex1.h)-(vertex3.h-vertex1.h)*(vertex2.v-vertex1.v);
+
+	alpha[0] = ((refLat-vertex3.v)*(vertex3.h-vertex2.h)-(refLon-vertex3.h)*(vertex3.v-vertex2.v)) / denom;
+	alpha[1] = ((refLon-vertex1.h)*(vertex3.v-vertex1.v)-(refLat-vertex1.v)*(vertex3.h-vertex1.h)) / denom;
+	alpha[2] = ((refLat-vertex1.v)*(vertex2.h-vertex1.h)-(refLon-vertex1.h)*(vertex2.v-vertex1.v)) / denom;
+
+	return ntri;
+}
+
+void GridLocator_c::Locate(long n, const double *lon, const double *lat, long *tri, long *node, double *alpha)
+{
+	for (long i = 0; i < n; i++)
+		tri[i] = LocateOne(lon[i], lat[i], tri[i], &node[3*i], &alpha[3*i]);
+}
+
+long GridLocator_c::FindTriangle(double lon, double lat, long hint)
+{
+	LongPoint lp;
+	long ntri;
+
+	if (!fDagTree)
+		return -1;
+
+	lp.h = (long)(lon * 1000000);
+	lp.v = (long)(lat * 1000000);
+	ntri = hint >= 0 && hint < fNumTris ? fDagTree->WhatTriAmIIn(lp, &hint) : fDagTree->WhatTriAmIIn(lp);
+
+	return ntri < 0 ? -1 : ntri;
+}
+
+void GridLocator_c::GetTriangleVertices(long tri, double *lon, double *lat)
+{
+	TopologyHdl topH = fDagTree->GetTopologyHdl();
+	LongPointHdl ptsH = fDagTree->GetPointsHdl();
+	long node[3] = {(*topH)[tri].vertex1, (*topH)[tri].vertex2, (*topH)[tri].vertex3};
+
+	for (int i = 0; i < 3; i++)
+	{
+		lon[i] = (*ptsH)[node[i]].h / 1000000.;
+		lat[i] = (*ptsH)[node[i]].v / 1000000.;
+	}
+}
+
+// the velocity at a point, 0 off the grid as with the movers' grids
+long GridLocator_c::GetVelocity(double lon, double lat, long hint, const double *u, const double *v,
+								double *uVel, double *vVel)
+{
+	long node[3];
+	double alpha[3];
+	long ntri = LocateOne(lon, lat, hint, node, alpha);
+
+	if (ntri < 0)
+	{
+		*uVel = *vVel = 0;
+		return ntri;
+	}
+
+	*uVel = alpha[0] * u[node[0]] + alpha[1] * u[node[1]] + alpha[2] * u[node[2]];
+	*vVel = alpha[0] * v[node[0]] + alpha[1] * v[node[1]] + alpha[2] * v[node[2]];
+
+	return ntri;
+}
+
+OSErr GridLocator_c::GetMoves(long n, const double *lon, const double *lat, long *tri,
+							  NUM_METHOD method, double timeStep,
+							  const double *u0, const double *v0,
+							  const double *uMid, const double *vMid,
+							  const double *u1, const double *v1,
+							  double *dx, double *dy)
+{
+	// meters to degrees of latitude, as FlatEarthProjection
+	const double degPerMeter = 8.9992801e-06;
+
+	if (!fDagTree)
+		return -1;
+
+	if (method != EULER && method != TRAPEZOID && method != RK4)
+		return -1;
+
+	for (long i = 0; i < n; i++)
+	{
+		double lonScale = degPerMeter / cos(lat[i] * PI / 180.);
+		double uVel[4], vVel[4];
+		long hint = tri[i], ntri;
+
+		ntri = GetVelocity(lon[i], lat[i], hint, u0, v0, &uVel[0], &vVel[0]);
+		if (ntri >= 0)
+			hint = ntri;
+		tri[i] = ntri;
+
+		switch (method)
+		{
+			case EULER:
+				dx[i] = uVel[0] * timeStep;
+				dy[i] = vVel[0] * timeStep;
+				break;
+
+			case TRAPEZOID:
+				GetVelocity(lon[i] + uVel[0] * timeStep * lonScale, lat[i] + vVel[0] * timeStep * degPerMeter,
+							hint, u1, v1, &uVel[1], &vVel[1]);
+				dx[i] = timeStep / 2 * (uVel[0] + uVel[1]);
+				dy[i] = timeStep / 2 * (vVel[0] + vVel[1]);
+				break;
+
+			default:	// RK4
+				GetVelocity(lon[i] + uVel[0] * timeStep / 2 * lonScale, lat[i] + vVel[0] * timeStep / 2 * degPerMeter,
+							hint, uMid, vMid, &uVel[1], &vVel[1]);
+				GetVelocity(lon[i] + uVel[1] * timeStep / 2 * lonScale, lat[i] + vVel[1] * timeStep / 2 * degPerMeter,
+							hint, uMid, vMid, &uVel[2], &vVel[2]);
+				GetVelocity(lon[i] + uVel[2] * timeStep * lonScale, lat[i] + vVel[2] * timeStep * degPerMeter,
+							hint, u1, v1, &uVel[3], &vVel[3]);
+				dx[i] = timeStep / 6 * (uVel[0] + 2 * uVel[1] + 2 * uVel[2] + uVel[3]);
+				dy[i] = timeStep / 6 * (vVel[0] + 2 * vVel[1] + 2 * vVel[2] + vVel[3]);
+				break;
+		}
+	}
+
+	return noErr;
+}
+
+void GridLocator_c::Interpolate(long n, const long *tri, const long *node, const double *alpha,
+								 const double *nodeValues, double fill, double *values)
+{
+	for (long i = 0; i < n; i++)
+	{
+		if (tri[i] < 0)
+		{
+			values[i] = fill;
+			continue;
+		}
+
+		values[i] = alpha[3*i] * nodeValues[node[3*i]] +
+					alpha[3*i+1] * nodeValues[node[3*i+1]] +
+					alpha[3*i+2] * nodeValues[node[3*i+2]];
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ *  GridLocator_c.h
+ *  gnome
+ *
+ *  Point location and barycentric weights on a triangle grid given as arrays
+ *  -- the nodes and faces of a pyugrid UGrid -- with the DAG tree the movers'
+ *  grids use. For the gridded properties of the environment, which sample
+ *  several variables (u, v, temperature...) at the same points: the points
+ *  are located once, and the weights applied to each variable.
+ *
+ */
+
+#ifndef __GridLocator_c__
+#define __GridLocator_c__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+#include "DagTree.h"
+
+class DLL_API GridLocator_c {
+
+public:
+	GridLocator_c();
+	virtual ~GridLocator_c() { Dispose(); }
+	void	Dispose();
+
+	// nodes in degrees, the triangles as 3 node indices each, in either order -- they
+	// are made counterclockwise and their neighbors found for the DAG tree
+	OSErr	Build(long numNodes, const double *lon, const double *lat,
+				  long numTris, const long *triangles, char *errmsg);
+
+	long	GetNumNodes() {return fNumNodes;}
+	long	GetNumTriangles() {return fNumTris;}
+
+	// for each point, the triangle it is in (-1 outside the grid) and the weights of the
+	// triangle's nodes alpha[3*i..3*i+2], with the nodes in node[3*i..3*i+2]. A tri of 0
+	// or more passed in is where the lookup starts, e.g. the points' last triangles
+	void	Locate(long n, const double *lon, const double *lat, long *tri, long *node, double *alpha);
+
+	// the triangle of a point as Locate finds it, without the weights
+	long	FindTriangle(double lon, double lat, long hint);
+	// the nodes of a triangle in degrees
+	void	GetTriangleVertices(long tri, double *lon, double *lat);
+
+	// the values at the nodes weighted as Locate found, fill for the points outside the grid
+	static void	Interpolate(long n, const long *tri, const long *node, const double *alpha,
+							const double *nodeValues, double fill, double *values);
+
+	// the moves (dx, dy) in meters of the points over timeStep, with the velocities given at the
+	// nodes at the start, middle and end of the step -- the stages of the py movers' Euler,
+	// TRAPEZOID and RK4 moves, done per point without arrays for the stages. The velocity is 0
+	// off the grid. tri is as in Locate, the triangles of the points at the start of the step
+	OSErr	GetMoves(long n, const double *lon, const double *lat, long *tri,
+					 NUM_METHOD method, double timeStep,
+					 const double *u0, const double *v0,
+					 const double *uMid, const double *vMid,
+					 const double *u1, const double *v1,
+					 double *dx, double *dy);
+
+private:
+	TDagTree	*fDagTree;	// has the points and topology handles
+	long		fNumNodes, fNumTris;
+
+	OSErr	MakeTopology(long numTris, const long *triangles, TopologyHdl topH, char *errmsg);
+	long	LocateOne(double lon, double lat, long hint, long *node, double *alpha);
+	long	GetVelocity(double lon, double lat, long hint, const double *u, const double *v,
+						double *uVel, double *vVel);
+};
+
+#endif
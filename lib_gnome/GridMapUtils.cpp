@@ -8,6 +8,9 @@
  */
 
 #include "GridMapUtils.h"
+#include "MemUtils.h"
+#include "SetupStats.h"
+#include <vector>
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -199,64 +202,95 @@ void ResetMaskValues(LONGH maskH,long landBlockToMerge,long landBlockToJoin,long
 	}
 }
 
+// the first point of the land block of point i, point 0 being the outer boundary. The
+// blocks are joined to their lowest point, so that is the first one in row order
+static long FindLandBlock(std::vector<long> &landBlock, long i)
+{
+	while (landBlock[i] != i) {
+		landBlock[i] = landBlock[landBlock[i]];	// halve the path
+		i = landBlock[i];
+	}
+	return i;
+}
+
+static void JoinLandBlocks(std::vector<long> &landBlock, long i, long j)
+{
+	i = FindLandBlock(landBlock, i);
+	j = FindLandBlock(landBlock, j);
+	if (i < j) landBlock[j] = i;
+	else if (j < i) landBlock[i] = j;
+}
+
+// The land points are numbered by their contiguous blocks (no diagonals, they could be
+// separate small islands): 3 for the blocks on the outer boundary, then 4 and up in the
+// order of the blocks' first points. One sweep joins each land point to its land
+// neighbors above and to the left, a second one numbers the blocks.
 //OSErr NetCDFMoverCurv_c::NumberIslands(LONGH *islandNumberH, VelocityFH velocityH,LONGH landWaterInfo, long numRows, long  numCols, long *numIslands) 
 OSErr NumberIslands(LONGH *islandNumberH, DOUBLEH landmaskH,LONGH landWaterInfo, long numRows, long  numCols, long *numIslands) 
 {
+	SetupStage setupStage(kSetupIslands);
 	OSErr err = 0;
 	long numRows_ext = numRows+1, numCols_ext = numCols+1;
 	long nv = numRows * numCols, nv_ext = numRows_ext*numCols_ext;
-	long i, j, n, landPolyNum = 1, lowestSurroundingNum = 0;
-	long islandNum, maxIslandNum=3;
+	long i, j, n, nextIslandNum=4;
 	LONGH maskH = (LONGH)_NewHandleClear(numRows * numCols * sizeof(long));
 	LONGH maskH2 = (LONGH)_NewHandleClear(nv_ext * sizeof(long));
+	std::vector<long> landBlock;
 	*islandNumberH = 0;
 	
 	if (!maskH || !maskH2) {err = memFullErr; goto done;}
+	try {
+		landBlock.resize(nv + 1);
+	}
+	catch (...) {
+		err = memFullErr;
+		goto done;
+	}
+	for (n=0;n<=nv;n++)
+		landBlock[n] = n;
+	
 	// use surface velocity values at time zero
 	for (i=0;i<numRows;i++)
 	{
 		for (j=0;j<numCols;j++)
 		{
-			if (INDEXH(landWaterInfo,i*numCols+j) == -1)// 1 water, -1 land
+			n = i*numCols+j;
+			if (INDEXH(landWaterInfo,n) == -1)// 1 water, -1 land
 			{
+				INDEXH(maskH,n) = 3;	// land, numbered below
 				if (i==0 || i==numRows-1 || j==0 || j==numCols-1)
-				{
-					INDEXH(maskH,i*numCols+j) = 3;	// set outer boundary to 3
-				}
-				else
-				{
-					if (landPolyNum==1)
-					{	// Land point
-						INDEXH(maskH,i*numCols+j) = landPolyNum+3;
-						landPolyNum+=3;
-					}
-					else
-					{
-						// check for nearest land poly number
-						if ((lowestSurroundingNum = CheckSurroundingPoints(maskH, numRows, numCols, i, j)) >= 3)
-						{
-							INDEXH(maskH,i*numCols+j) = lowestSurroundingNum;
-						}
-						else
-						{
-							INDEXH(maskH,i*numCols+j) = landPolyNum;
-							landPolyNum += 1;
-						}
-					}
-				}
+					JoinLandBlocks(landBlock, n+1, 0);	// outer boundary
+				if (i > 0 && INDEXH(landWaterInfo,n-numCols) == -1)
+					JoinLandBlocks(landBlock, n+1, n-numCols+1);
+				if (j > 0 && INDEXH(landWaterInfo,n-1) == -1)
+					JoinLandBlocks(landBlock, n+1, n);
 			}
 			else
 			{
 				if (i==0 || i==numRows-1 || j==0 || j==numCols-1)
-					INDEXH(maskH,i*numCols+j) = 1;	// Open water boundary
-				//else if (ThereIsAdjacentLand2(maskH,velocityH,numRows,numCols,i,j))
-				else if (ThereIsAdjacentLand2(maskH,landmaskH,numRows,numCols,i,j))
-					INDEXH(maskH,i*numCols+j) = 2;	// Water boundary, not open water
+					INDEXH(maskH,n) = 1;	// Open water boundary
+				else if (INDEXH(landWaterInfo,n-numCols) == -1 || INDEXH(landWaterInfo,n-1) == -1 ||
+						 INDEXH(landmaskH,n-numCols)==0 || INDEXH(landmaskH,n+numCols)==0 ||
+						 INDEXH(landmaskH,n-1)==0 || INDEXH(landmaskH,n+1)==0)
+					INDEXH(maskH,n) = 2;	// Water boundary, not open water
 				else
-					INDEXH(maskH,i*numCols+j) = 0;	// Interior water point
+					INDEXH(maskH,n) = 0;	// Interior water point
 			}
 		}
 	}
+	// a block's first point comes before its other points, so it is numbered first
+	for (n=0;n<nv;n++)
+	{
+		long first;
+		if (INDEXH(maskH,n) < 3) continue;	// water point
+		first = FindLandBlock(landBlock, n+1);
+		if (first == 0)
+			INDEXH(maskH,n) = 3;	// set outer boundary to 3
+		else if (first == n+1)
+			INDEXH(maskH,n) = nextIslandNum++;
+		else
+			INDEXH(maskH,n) = INDEXH(maskH,first-1);
+	}
 	// extend grid by one row/col up/right since velocities correspond to lower left corner of a grid box
 	for (i=0;i<numRows_ext;i++)
 	{
@@ -289,41 +323,8 @@ OSErr NumberIslands(LONGH *islandNumberH, DOUBLEH landmaskH,LONGH landWaterInfo,
 	{
 		if (INDEXH(maskH2,i*numCols_ext+numCols-1)==1) INDEXH(maskH2,i*numCols_ext+numCols-1) = 2;
 	}
-	// now merge any contiguous land blocks (max of landPolyNum)
-	// as soon as find one, all others of that number change, and every higher landpoint changes
-	// repeat until nothing changes
-startLoop:
-	{
-		long lowerPolyNum = 0;
-		for (i=0;i<numRows_ext;i++)
-		{
-			for (j=0;j<numCols_ext;j++)
-			{
-				if (INDEXH(maskH2,i*numCols_ext+j) < 3) continue;	// water point
-				if (ThereIsALowerLandNeighbor(maskH2,&lowerPolyNum,numRows,numCols,i,j))
-				{
-					ResetMaskValues(maskH2,INDEXH(maskH2,i*numCols_ext+j),lowerPolyNum,numRows,numCols);
-					goto startLoop;
-				}
-				if ((i==0 || i==numRows_ext-1 || j==0 || j==numCols_ext-1) && INDEXH(maskH2,i*numCols_ext+j)>3)
-				{	// shouldn't get here
-					ResetMaskValues(maskH2,INDEXH(maskH2,i*numCols_ext+j),3,numRows,numCols);
-					goto startLoop;
-				}
-			}
-		}
-	}
-	for (i=0;i<numRows_ext;i++)
-	{
-		for (j=0;j<numCols_ext;j++)
-		{	// note, the numbers start at 3
-			islandNum = INDEXH(maskH2,i*numCols_ext+j);
-			if (islandNum < 3) continue;	// water point
-			if (islandNum > maxIslandNum) maxIslandNum = islandNum;
-		}
-	}
 	*islandNumberH = maskH2;
-	*numIslands = maxIslandNum;
+	*numIslands = nextIslandNum - 1;	// note, the numbers start at 3
 done:
 	if (err) 
 	{
@@ -333,3 +334,92 @@ done:
 	if (maskH) {DisposeHandle((Handle)maskH); maskH = 0;}
 	return err;
 }
+
+// The segments are the sides of the triangles with no neighbor, with the island they border
+// (1 water, 3 and up land). A boundary starts at the first unused segment and goes on with
+// the first unused segment, in segList order, that starts where the last one ended, until it
+// is back at its start. The ReorderPoints loops looked through all the segments for each
+// point, so the segments are indexed by their first point here, in the same order, and the
+// boundaries come out the same. The handles must have room for all the boundary points and
+// are sized to them, flagH (the points on a boundary) may be 0.
+Boolean TraceBoundarySegments(SegInfoHdl segList, long nSegs, long numIslands, LONGH boundaryPtsH, LONGH waterBoundaryPtsH, LONGH boundaryEndPtsH, LONGH flagH)
+{
+	long i, k, pt, numPts = 0, firstUnused = 0, islandNum = 3;
+	long nBoundaryPts = 0, nEndPts = 0, waterStartPoint;
+	long currentIndex, startIndex, currentIsland;
+	std::vector<long> ptStart, ptSegs, nextSeg;
+	std::vector<char> segUsed(nSegs, 0);
+	Boolean foundPt;
+	
+	for (i = 0; i < nSegs; i++)
+		if ((*segList)[i].pt1 >= numPts) numPts = (*segList)[i].pt1 + 1;
+	
+	// the segments of each point, counted then filled, in segList order
+	ptStart.assign(numPts + 1, 0);
+	for (i = 0; i < nSegs; i++)
+		if ((*segList)[i].pt1 >= 0) ptStart[(*segList)[i].pt1 + 1]++;
+	for (pt = 0; pt < numPts; pt++)
+		ptStart[pt + 1] += ptStart[pt];
+	nextSeg.assign(ptStart.begin(), ptStart.end() - 1);
+	ptSegs.resize(ptStart[numPts]);
+	for (i = 0; i < nSegs; i++)
+		if ((*segList)[i].pt1 >= 0) ptSegs[nextSeg[(*segList)[i].pt1]++] = i;
+	
+	while (islandNum <= numIslands)	// off by 2 - 0,1,2 are water cells, 3 and up are land
+	{
+		// segments are never unused again, so the first unused one only moves on
+		while (firstUnused < nSegs && segUsed[firstUnused]) firstUnused++;
+		if (firstUnused >= nSegs) return false;
+		
+		i = firstUnused;
+		waterStartPoint = nBoundaryPts;
+		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
+		if (flagH) (*flagH)[(*segList)[i].pt1] = 1;
+		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
+		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
+		if (flagH) (*flagH)[(*segList)[i].pt2] = 1;
+		currentIndex = (*segList)[i].pt2;
+		startIndex = (*segList)[i].pt1;
+		currentIsland = (*segList)[i].islandNumber;
+		segUsed[i] = true;
+		
+		for (;;)
+		{
+			// the next segment starts at the second point of the last one
+			foundPt = false;
+			if (currentIndex >= 0 && currentIndex < numPts)
+			{
+				for (k = ptStart[currentIndex]; k < ptStart[currentIndex + 1]; k++)
+				{
+					i = ptSegs[k];
+					if (segUsed[i]) continue;
+					if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
+					if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
+					foundPt = true;
+					break;
+				}
+			}
+			if (!foundPt) goto done;	// shouldn't get here unless there's a problem...
+			
+			currentIndex = (*segList)[i].pt2;
+			segUsed[i] = true;
+			if (currentIndex == startIndex) // completed a segment
+			{
+				islandNum++;
+				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
+				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
+				break;
+			}
+			(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
+			if (flagH) (*flagH)[(*segList)[i].pt2] = 1;
+			(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
+			nBoundaryPts++;
+		}
+	}
+	
+done:
+	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
+	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
+	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
+	return true;
+}
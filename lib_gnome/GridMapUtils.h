@@ -24,5 +24,8 @@ Boolean 			ThereIsALowerLandNeighbor(LONGH maskH, long *lowerPolyNum, long numRo
 void 				ResetMaskValues(LONGH maskH,long landBlockToMerge,long landBlockToJoin,long numRows,long numCols);
 //OSErr 				NumberIslands(LONGH *islandNumberH, VelocityFH velocityH,LONGH landWaterInfo,long numRows,long numCols,long *numIslands);
 OSErr 				NumberIslands(LONGH *islandNumberH, DOUBLEH landmaskH,LONGH landWaterInfo,long numRows,long numCols,long *numIslands);
+// follows the boundary segments of a triangulated grid into the closed boundaries of the map,
+// false if a boundary couldn't be started
+Boolean 			TraceBoundarySegments(SegInfoHdl segList, long nSegs, long numIslands, LONGH boundaryPtsH, LONGH waterBoundaryPtsH, LONGH boundaryEndPtsH, LONGH flagH);
 
 #endif
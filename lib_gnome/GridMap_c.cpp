@@ -15,6 +15,7 @@
 #include "StringFunctions.h"
 #include "CompFunctions.h"
 #include "DagTreeIO.h"
+#include "GridMapUtils.h"
 #include "netcdf.h"
 
 #ifndef pyGNOME
@@ -227,12 +228,11 @@ OSErr GridMap_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numC
 	long i, j, n, ntri, numVerdatPts=0; 
 	long numRows_ext = numRows+1, numCols_ext = numCols+1;
 	long nv = numRows * numCols, nv_ext = numRows_ext*numCols_ext;
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long iIndex,jIndex,index,currentIndex,startIndex; 
+	long iIndex,jIndex,index; 
 	long triIndex1,triIndex2,waterCellNum=0;
 	long ptIndex = 0,cellNum = 0,diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	OSErr err = 0;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(numRows * numCols * sizeof(long));
@@ -252,7 +252,6 @@ OSErr GridMap_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numC
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -478,7 +477,6 @@ OSErr GridMap_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numC
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv_ext * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -582,38 +580,10 @@ OSErr GridMap_c::SetUpCurvilinearGrid(DOUBLEH landMaskH, long numRows, long numC
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		//err = -1; goto done;
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		err = -1; goto done;
@@ -624,40 +594,6 @@ findnewstartpoint:
 		 goto setFields;*/
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	/////////////////////////////////////////////////
@@ -721,7 +657,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	if (verdatPtsH) {DisposeHandle((Handle)verdatPtsH); verdatPtsH = 0;}
@@ -778,11 +713,9 @@ OSErr GridMap_c::SetUpCurvilinearGrid2(DOUBLEH landMaskH, long numRows, long num
 	long triIndex1, triIndex2, waterCellNum=0;
 	long ptIndex = 0, cellNum = 0;
 	
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long currentIndex,startIndex; 
 	long diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(nCells * sizeof(long));
 	LONGH maskH2 = (LONGH)_NewHandleClear(nv * sizeof(long));
@@ -801,7 +734,6 @@ OSErr GridMap_c::SetUpCurvilinearGrid2(DOUBLEH landMaskH, long numRows, long num
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -1016,7 +948,6 @@ OSErr GridMap_c::SetUpCurvilinearGrid2(DOUBLEH landMaskH, long numRows, long num
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -1126,38 +1057,10 @@ OSErr GridMap_c::SetUpCurvilinearGrid2(DOUBLEH landMaskH, long numRows, long num
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		//err = -1; goto done
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		err = -1; goto done;
@@ -1168,40 +1071,6 @@ findnewstartpoint:
 		//goto setFields;
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	/////////////////////////////////////////////////
@@ -1254,7 +1123,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	if (verdatPtsH) {DisposeHandle((Handle)verdatPtsH); verdatPtsH = 0;}
@@ -2311,7 +2179,7 @@ done:
 }
 
 
-OSErr GridMap_c::ReadCATSMap(vector<string> &linesInFile) 
+OSErr GridMap_c::ReadCATSMap(TextLines &linesInFile) 
 {
 	char errmsg[256];
 	long i, numPoints, line = 0;
@@ -2523,13 +2391,21 @@ done:
 }
 
 
+OSErr GridMap_c::ReadCATSMap(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return ReadCATSMap(lines);
+}
+
+
 OSErr GridMap_c::ReadCATSMap(char *path)
 {
 	string strPath = path;
 	if (strPath.size() == 0)
 		return 0;
 	
-	vector<string> linesInFile;
+	TextLines linesInFile;
 	if (ReadLinesInFile(strPath, linesInFile)) {
 		return ReadCATSMap(linesInFile);
 	}
@@ -2539,7 +2415,7 @@ OSErr GridMap_c::ReadCATSMap(char *path)
 }
 
 // import map from a topology file so don't have to regenerate
-OSErr GridMap_c::ReadTopology(vector<string> &linesInFile)
+OSErr GridMap_c::ReadTopology(TextLines &linesInFile)
 {
 	OSErr err = 0;
 	string currentLine;
@@ -2807,6 +2683,14 @@ done:
 }
 
 
+OSErr GridMap_c::ReadTopology(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTopology(lines);
+}
+
+
 // import map from a topology file so don't have to regenerate
 OSErr GridMap_c::ReadTopology(char *path)
 {
@@ -2815,7 +2699,7 @@ OSErr GridMap_c::ReadTopology(char *path)
 	if (strPath.size() == 0)
 		return 0;
 
-	vector<string> linesInFile;
+	TextLines linesInFile;
 	if (ReadLinesInFile(strPath, linesInFile))
 		return ReadTopology(linesInFile);
 	else
@@ -2988,6 +2872,7 @@ done:
 
 OSErr GridMap_c::SaveAsNetCDF(char *path)
 {	
+	GnomeLock fileLock(GnomeFileIOMutex());
 	OSErr err = 0;	
 	int status, ncid, ver_dim, top_dim, dag_dim, edge_dim, top_dimid[2], landwater_dimid[1], edge_dimid[2], boundary_count_dimid[1], dag_dimid[2], lat_dimid[1], lon_dimid[1], depth_dimid[1];
 	int mesh2_node_x_id, mesh2_node_y_id, mesh2_depth_id, mesh2_face_links_id, mesh2_face_nodes_id, mesh2_dagtree_id, mesh2_landwater_id, mesh2_edge_id, mesh2_boundary_count_id;
@@ -3560,6 +3445,7 @@ done:
 
 OSErr GridMap_c::TextRead(char *path)
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	OSErr err = 0;
 	char s[256], fileName[256];
 	char nameStr[256];
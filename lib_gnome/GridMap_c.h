@@ -22,6 +22,7 @@ using namespace std;
 #include "ClassID_c.h"
 #include "my_build_list.h"
 #include "GridMapUtils.h"
+#include "TextLines.h"
 
 
 #ifdef pyGNOME
@@ -82,12 +83,14 @@ public:
 	OSErr			SetUpTriangleGrid2(long numNodes, long numTri, WORLDPOINTFH vertexPtsH, FLOATH depthPtsH, long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts, long *tri_verts, long *tri_neighbors);
 	OSErr			SetUpTriangleGrid(long numNodes, long numTri, WORLDPOINTFH vertexPtsH, FLOATH depthPtsH, long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts);
 
+	OSErr ReadTopology(TextLines &linesInFile);
 	OSErr ReadTopology(std::vector<std::string> &linesInFile);
 	OSErr ReadTopology(char *path);
 
 	OSErr	TextRead(char *path);
 	OSErr	ExportTopology(char* path);
 	OSErr	SaveAsNetCDF(char *path);
+	OSErr	ReadCATSMap(TextLines &linesInFile);
 	OSErr	ReadCATSMap(vector<string> &linesInFile); 
 	OSErr	ReadCATSMap(char *path); 
 	OSErr	GetPointsAndMask(char *path,DOUBLEH *maskH,WORLDPOINTFH *vertexPtsH, FLOATH *depthPtsH, long *numRows, long *numCols);	
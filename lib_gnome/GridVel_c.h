@@ -48,10 +48,20 @@ public:
 	virtual WorldRect GetBounds(){return fGridBounds;}	
 	virtual InterpolationValBilinear GetBilinearInterpolationValues(WorldPoint ref){InterpolationValBilinear ival; memset(&ival,0,sizeof(ival)); return ival;}
 	virtual InterpolationVal GetInterpolationValues(WorldPoint ref){InterpolationVal ival; memset(&ival,0,sizeof(ival)); return ival;}
+	// triHint is an LE's triangle from the previous lookup, it is updated (triangle grids only)
+	virtual VelocityRec GetPatValue(WorldPoint p, long *triHint){return GetPatValue(p);}
+	virtual InterpolationVal GetInterpolationValues(WorldPoint ref, long *triHint){return GetInterpolationValues(ref);}
+	virtual double GetDepthAtPoint(WorldPoint p, long *triHint){return GetDepthAtPoint(p);}
+	virtual OSErr SetUseBucketIndex(bool useBuckets){return 0;}
+	virtual bool UsesBucketIndex(){return false;}
+	virtual OSErr SetUsePackedDagTree(bool usePacked){return 0;}
+	virtual bool UsesPackedDagTree(){return false;}
 	virtual LongPointHdl GetPointsHdl(void){return 0;}
 	virtual TopologyHdl GetTopologyHdl(void){return 0;}
 	virtual WORLDPOINTH	GetCenterPointsHdl(void){return 0;}
 	virtual double GetDepthAtPoint(WorldPoint p){return 0;}
+	// the size in meters of the cell p is in, for Courant numbers - 0 if the grid doesn't know
+	virtual double GetCellSize(WorldPoint p, long *triHint){return 0;}
 	virtual void	Dispose() { return; }
 	
 };
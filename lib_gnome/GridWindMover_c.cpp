@@ -66,12 +66,12 @@ void GridWindMover_c::Dispose()
 	WindMover_c::Dispose ();
 }
 
-OSErr GridWindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr GridWindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
-
-	char errmsg[256];
-	errmsg[0] = 0;
+	GnomeError error;
 
 	if (bIsFirstStep)
 		fModelStartTime = model_time;
@@ -80,7 +80,7 @@ OSErr GridWindMover_c::PrepareForModelStep(const Seconds& model_time, const Seco
 	
 	if (!timeGrid) return -1;
 	
-	err = timeGrid -> SetInterval(errmsg, model_time); 
+	err = timeGrid -> SetInterval(error, model_time); 
 	
 	if (err) goto done;	// again don't want to have error if outside time interval
 	
@@ -97,9 +97,8 @@ done:
 	
 	if(err)
 	{
-		if(!errmsg[0])
-			strcpy(errmsg,"An error occurred in GridWindMover::PrepareForModelStep");
-		printError(errmsg); 
+		error.Set(err, "GridWindMover::PrepareForModelStep", model_time);
+		error.Report("An error occurred in GridWindMover::PrepareForModelStep");
 	}	
 	
 	return err;
@@ -107,12 +106,15 @@ done:
 
 void GridWindMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	bIsFirstStep = false;
 	fIsOptimizedForStep = false;
 }
 
 
-OSErr GridWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+OSErr GridWindMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 
 	if(!ref || !delta || !windages) {
 		//cout << "worldpoints array not provided! returning.\n";
@@ -126,13 +128,17 @@ OSErr GridWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, Wor
 		return 2;
 	}
 	
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-	
 	WorldPoint3D zero_delta ={0,0,0.};
-	
-	for (int i = 0; i < n; i++) {
+	// wind uncertainty draws from the shared random number generator so uncertain LEs run serially
+	bool runParallel = fNumThreads > 1 && fIsOptimizedForStep && spillType == FORECAST_LE;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
+
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -157,23 +163,21 @@ OSErr GridWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, Wor
 	return noErr;
 }
 
-WorldPoint3D GridWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D GridWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double 	dLong, dLat;
 	WorldPoint3D	deltaPoint ={0,0,0.};
 	WorldPoint3D refPoint;	
 	VelocityRec windVelocity;
 	OSErr err = noErr;
-
-	char errmsg[256];
-	errmsg[0] = 0;
+	GnomeError error;	// the LE doesn't move if there is no data, the error isn't reported
 	
 	if ((*theLE).z > 0) return deltaPoint; // wind doesn't act below surface
 	// or use some sort of exponential decay below the surface...
 	
 	if(!fIsOptimizedForStep) 
 	{
-		err = timeGrid -> SetInterval(errmsg, model_time); // AH 07/17/2012
+		err = timeGrid -> SetInterval(error, model_time); // AH 07/17/2012
 		
 		if (err) return deltaPoint;
 	}
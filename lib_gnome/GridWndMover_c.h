@@ -41,12 +41,22 @@ public:
 	
 	Boolean fOverLap;
 	Seconds fOverLapStartTime;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	PtCurFileInfoH	fInputFilesHdl;
 	
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList);
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList);
 	virtual void 		ModelStepIsDone();
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
+	// GetMove is overridden, so the batch goes through it one LE at a time
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID)
+						{ return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+														 delta_lat, delta_lon, delta_z, spillType, spill_ID); }
+	virtual Boolean		CanFuseMove() { return false; }
 	virtual long 		GetVelocityIndex(WorldPoint p);
 
 	
@@ -0,0 +1,130 @@
+/*
+ *  IceFieldProducts.cpp
+ *  gnome
+ *
+ */
+
+#include "IceFieldProducts.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+IceFieldProducts::IceFieldProducts()
+{
+	fCellsBuilt = false;
+	for (short i = 0; i < 2; i++)
+	{
+		fSlices[i].valid = false;
+		fSlices[i].thicknessH = 0;
+		fSlices[i].fractionH = 0;
+	}
+	fFieldsValid = false;
+	fFieldsTime = 0;
+	fFieldsBlended = false;
+}
+
+void IceFieldProducts::Dispose()
+{
+	fCellIndex.clear();
+	fCellsBuilt = false;
+	InvalidateSlice(kIceStartSlice);
+	InvalidateSlice(kIceEndSlice);
+	fThickness.clear();
+	fFraction.clear();
+}
+
+void IceFieldProducts::SetCellIndices(const vector<long> &cellIndex)
+{
+	fCellIndex = cellIndex;
+	fCellsBuilt = true;
+	InvalidateSlice(kIceStartSlice);
+	InvalidateSlice(kIceEndSlice);
+}
+
+void IceFieldProducts::InvalidateSlice(short slice)
+{
+	fSlices[slice].valid = false;
+	fSlices[slice].thicknessH = 0;
+	fSlices[slice].fractionH = 0;
+	fFieldsValid = false;
+}
+
+void IceFieldProducts::ShiftInterval()
+{
+	Slice &start = fSlices[kIceStartSlice], &end = fSlices[kIceEndSlice];
+
+	start.thickness.swap(end.thickness);
+	start.fraction.swap(end.fraction);
+	start.valid = end.valid;
+	start.thicknessH = end.thicknessH;
+	start.fractionH = end.fractionH;
+	InvalidateSlice(kIceEndSlice);
+}
+
+void IceFieldProducts::LoadSlice(short slice, DOUBLEH thicknessH, DOUBLEH fractionH, double fillValue)
+{
+	Slice &s = fSlices[slice];
+	long numCells = (long)fCellIndex.size(), i, index;
+	long numThickness = thicknessH ? _GetHandleSize((Handle)thicknessH)/sizeof(**thicknessH) : 0;
+	long numFraction = fractionH ? _GetHandleSize((Handle)fractionH)/sizeof(**fractionH) : 0;
+	double value;
+
+	if (s.valid && s.thicknessH == thicknessH && s.fractionH == fractionH)
+		return;
+
+	s.thickness.assign(numCells, 0.);
+	s.fraction.assign(numCells, 0.);
+	for (i = 0; i < numCells; i++)
+	{
+		index = fCellIndex[i];
+		if (index < 0)
+			continue;
+
+		if (index < numThickness && (value = INDEXH(thicknessH, index)) != fillValue)
+			s.thickness[i] = value;
+		if (index < numFraction && (value = INDEXH(fractionH, index)) != fillValue)
+			s.fraction[i] = value;
+	}
+
+	s.valid = true;
+	s.thicknessH = thicknessH;
+	s.fractionH = fractionH;
+	fFieldsValid = false;
+}
+
+void IceFieldProducts::GetFields(Seconds time, Boolean blend, double timeAlpha, double fillValue,
+								 double *thickness, double *fraction)
+{
+	const Slice &start = fSlices[kIceStartSlice], &end = fSlices[kIceEndSlice];
+	long numCells = (long)fCellIndex.size(), i;
+
+	if (!fFieldsValid || fFieldsTime != time || fFieldsBlended != blend)
+	{
+		fThickness.resize(numCells);
+		fFraction.resize(numCells);
+		for (i = 0; i < numCells; i++)
+		{
+			if (blend)
+			{
+				fThickness[i] = timeAlpha*start.thickness[i] + (1-timeAlpha)*end.thickness[i];
+				fFraction[i] = timeAlpha*start.fraction[i] + (1-timeAlpha)*end.fraction[i];
+			}
+			else
+			{
+				fThickness[i] = start.thickness[i];
+				fFraction[i] = start.fraction[i];
+			}
+			if (fThickness[i] == fillValue) fThickness[i] = 0.;
+			if (fFraction[i] == fillValue) fFraction[i] = 0.;
+		}
+		fFieldsValid = true;
+		fFieldsTime = time;
+		fFieldsBlended = blend;
+	}
+
+	for (i = 0; i < numCells; i++)
+	{
+		thickness[i] = fThickness[i];
+		fraction[i] = fFraction[i];
+	}
+}
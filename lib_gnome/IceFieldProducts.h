@@ -0,0 +1,70 @@
+/*
+ *  IceFieldProducts.h
+ *  gnome
+ *
+ *  The ice thickness and fraction on the cells of an ice grid, gathered
+ *  from the fields of each loaded time slice once, when the slice is first
+ *  asked for, instead of looking up each cell's value at every output
+ *  step. GetIceFields then only blends the two slices' arrays, and keeps
+ *  the blend for the outputs that ask for the same time.
+ *
+ */
+
+#ifndef __IceFieldProducts__
+#define __IceFieldProducts__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+enum { kIceStartSlice = 0, kIceEndSlice };
+
+class IceFieldProducts
+{
+	public:
+						IceFieldProducts();
+						~IceFieldProducts() {Dispose();}
+		void			Dispose();
+
+		// the index in the fields of each cell's value, -1 for none, found
+		// once for the grid
+		Boolean			HasCellIndices(long numCells) const {return fCellsBuilt && (long)fCellIndex.size() == numCells;}
+		void			SetCellIndices(const std::vector<long> &cellIndex);
+
+		// as the grid's loaded data: a slice thrown away, or the end one
+		// becoming the start
+		void			InvalidateSlice(short slice);
+		void			ShiftInterval();
+
+		// gathers the cells' values of the slice's fields unless they are
+		// from these handles already. Fill values are 0, as are the values
+		// of the cells with no index or with no field loaded
+		void			LoadSlice(short slice, DOUBLEH thicknessH, DOUBLEH fractionH, double fillValue);
+
+		// the fields of the cells at time: the start slice's, or blended
+		// with the end one's by timeAlpha. Kept until a slice changes
+		void			GetFields(Seconds time, Boolean blend, double timeAlpha, double fillValue,
+								  double *thickness, double *fraction);
+
+	private:
+		typedef struct {
+			std::vector<double>	thickness;
+			std::vector<double>	fraction;
+			Boolean				valid;
+			DOUBLEH				thicknessH;	// the fields gathered, only compared
+			DOUBLEH				fractionH;
+		} Slice;
+
+		std::vector<long>	fCellIndex;
+		Boolean				fCellsBuilt;
+		Slice				fSlices[2];
+
+		Boolean				fFieldsValid;
+		Seconds				fFieldsTime;
+		Boolean				fFieldsBlended;
+		std::vector<double>	fThickness;
+		std::vector<double>	fFraction;
+};
+
+#endif
@@ -121,7 +121,7 @@ void IceMover_c::Dispose ()
 	GridCurrentMover_c::Dispose ();
 }
 
-/*OSErr IceMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+/*OSErr IceMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -170,8 +170,10 @@ OSErr IceMover_c::PrepareForModelRun()
 
 
 OSErr IceMover_c::PrepareForModelStep(const Seconds &model_time, const Seconds &time_step,
-											  bool uncertain, int numLESets, int *LESetsSizesList)
+											  bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 	char errmsg[256];
 	
@@ -190,6 +192,16 @@ OSErr IceMover_c::PrepareForModelStep(const Seconds &model_time, const Seconds &
 	if (err)
 		goto done;
 	
+	if (TimeGridVelIce_c *iceGrid = dynamic_cast<TimeGridVelIce_c *>(timeGrid))
+	{
+		err = iceGrid->LoadIceFields(errmsg, kIceVelocities | kIceFields);
+		if (err)
+			goto done;
+		err = iceGrid->PrepareMovementField(model_time);
+		if (err)
+			goto done;
+	}
+	
 	if (uncertain)
 	{
 		Seconds elapsed_time = model_time - fModelStartTime;	// code goes here, how to set start time
@@ -211,12 +223,15 @@ done:
 
 void IceMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	fIsOptimizedForStep = false;
 	bIsFirstStep = false;
 }
 
 
-OSErr IceMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+OSErr IceMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 
 	if(!ref || !delta) {
 		//cout << "worldpoints array not provided! returning.\n";
@@ -237,7 +252,7 @@ OSErr IceMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoi
 	
 	WorldPoint3D zero_delta ={0,0,0.};
 	
-	for (int i = 0; i < n; i++) {
+	for (LECount i = 0; i < n; i++) {
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -261,7 +276,7 @@ OSErr IceMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoi
 	return noErr;
 }
 
-WorldPoint3D IceMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D IceMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {{0,0},0.};
 	WorldPoint3D refPoint;	
@@ -277,6 +292,8 @@ WorldPoint3D IceMover_c::GetMove(const Seconds& model_time, Seconds timeStep,lon
 		err = timeGrid->SetInterval(errmsg, model_time); 
 		
 		if (err) return deltaPoint;
+		if (TimeGridVelIce_c *iceGrid = dynamic_cast<TimeGridVelIce_c *>(timeGrid))
+			if (iceGrid->LoadIceFields(errmsg, kIceVelocities | kIceFields)) return deltaPoint;
 	}
 
 	refPoint.p = (*theLE).p;	
@@ -291,7 +308,7 @@ WorldPoint3D IceMover_c::GetMove(const Seconds& model_time, Seconds timeStep,lon
 		AddUncertainty(setIndex,leIndex,&scaledPatVelocity,timeStep,useEddyUncertainty);
 	}
 	
-	dLong = ((scaledPatVelocity.u / METERSPERDEGREELAT) * timeStep) / LongToLatRatio3 (refPoint.p.pLat);
+	dLong = ((scaledPatVelocity.u / METERSPERDEGREELAT) * timeStep) / LongToLatRatio3D (refPoint.p.pLat);
 	dLat  =  (scaledPatVelocity.v / METERSPERDEGREELAT) * timeStep;
 
 	deltaPoint.p.pLong = dLong * 1000000;
@@ -464,6 +481,18 @@ OSErr IceMover_c::GetIceVelocities(Seconds model_time, VelocityFRec *ice_velocit
 	return dynamic_cast<TimeGridVelIce_c *>(timeGrid)->GetIceVelocities(model_time, ice_velocities);
 }
 
+void IceMover_c::SetMovementFieldMode(bool useField)
+{
+	if (TimeGridVelIce_c *iceGrid = dynamic_cast<TimeGridVelIce_c *>(timeGrid))
+		iceGrid->SetMovementFieldMode(useField);
+}
+
+bool IceMover_c::GetMovementFieldMode()
+{
+	TimeGridVelIce_c *iceGrid = dynamic_cast<TimeGridVelIce_c *>(timeGrid);
+	return iceGrid && iceGrid->GetMovementFieldMode();
+}
+
 OSErr IceMover_c::GetMovementVelocities(Seconds model_time, VelocityFRec *velocities)
 {	// this function gets velocities based on ice coverage 
 	// high coverage use ice_velocity, low coverage use current_velocity, in between interpolate
@@ -48,7 +48,7 @@ public:
 	//virtual ClassID 	GetClassID () { return TYPE_ICEMOVER; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_ICEMOVER) return TRUE; return GridCurrentMover_c::IAm(id); }
 
-	//virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	//virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	//VelocityRec			GetPatValue (WorldPoint p);
 	//VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	
@@ -64,8 +64,17 @@ public:
 	//long	GetTimeShift() {return timeGrid->GetTimeShift();}	
 	
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	// GetMove is overridden, so the batch goes through it one LE at a time
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID)
+						{ return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+														 delta_lat, delta_lon, delta_z, spillType, spill_ID); }
+	virtual Boolean		CanFuseMove() { return false; }
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 			// may need these functions eventually if add a separate ice grid
 			//TopologyHdl GetTopologyHdl(void);
@@ -75,10 +84,13 @@ public:
 			OSErr 		GetIceFields(Seconds model_time, double *ice_fraction, double *ice_thickness);
 			OSErr 		GetIceVelocities(Seconds model_time, VelocityFRec *ice_velocity);
 			OSErr 		GetMovementVelocities(Seconds model_time, VelocityFRec *ice_velocity);
+			// blend the ice and water velocities once per step (see TimeGridVelIce_c)
+			void		SetMovementFieldMode(bool useField);
+			bool		GetMovementFieldMode();
 			OSErr		TextRead(char *path,char *topFilePath);
 			OSErr 		ExportTopology(char* path){return timeGrid->ExportTopology(path);}
 
-			OSErr		get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+			OSErr		get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
 
 };
 
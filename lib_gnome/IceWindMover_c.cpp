@@ -67,7 +67,7 @@ void IceWindMover_c::Dispose ()
 	GridWindMover_c::Dispose ();
 }
 
-/*OSErr IceWindMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+/*OSErr IceWindMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -116,8 +116,10 @@ OSErr IceWindMover_c::PrepareForModelRun()
 
 
 OSErr IceWindMover_c::PrepareForModelStep(const Seconds &model_time, const Seconds &time_step,
-											  bool uncertain, int numLESets, int *LESetsSizesList)
+											  bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 	char errmsg[256];
 	
@@ -136,6 +138,13 @@ OSErr IceWindMover_c::PrepareForModelStep(const Seconds &model_time, const Secon
 	if (err)
 		goto done;
 	
+	if (TimeGridWindIce_c *iceGrid = dynamic_cast<TimeGridWindIce_c *>(timeGrid))
+	{
+		err = iceGrid->LoadIceFields(errmsg, kIceFields);
+		if (err)
+			goto done;
+	}
+	
 	if (uncertain)
 	{
 		Seconds elapsed_time = model_time - fModelStartTime;	// code goes here, how to set start time
@@ -157,12 +166,15 @@ done:
 
 void IceWindMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	fIsOptimizedForStep = false;
 	bIsFirstStep = false;
 }
 
 
-OSErr IceWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+OSErr IceWindMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 
 	if(!ref || !delta || !windages) {
 		//cout << "worldpoints array not provided! returning.\n";
@@ -183,7 +195,7 @@ OSErr IceWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, Worl
 	
 	WorldPoint3D zero_delta ={0,0,0.};
 	
-	for (int i = 0; i < n; i++) {
+	for (LECount i = 0; i < n; i++) {
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -208,7 +220,7 @@ OSErr IceWindMover_c::get_move(int n, Seconds model_time, Seconds step_len, Worl
 	return noErr;
 }
 
-WorldPoint3D IceWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D IceWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {{0,0},0.};
 	WorldPoint3D refPoint;	
@@ -227,6 +239,8 @@ WorldPoint3D IceWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep
 		err = timeGrid->SetInterval(errmsg, model_time); 
 		
 		if (err) return deltaPoint;
+		if (TimeGridWindIce_c *iceGrid = dynamic_cast<TimeGridWindIce_c *>(timeGrid))
+			if (iceGrid->LoadIceFields(errmsg, kIceFields)) return deltaPoint;
 	}
 
 	refPoint.p = (*theLE).p;	
@@ -244,7 +258,7 @@ WorldPoint3D IceWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep
 	windVelocity.u *=  (*theLE).windage;
 	windVelocity.v *=  (*theLE).windage;
 	
-	dLong = ((windVelocity.u / METERSPERDEGREELAT) * timeStep) / LongToLatRatio3 (refPoint.p.pLat);
+	dLong = ((windVelocity.u / METERSPERDEGREELAT) * timeStep) / LongToLatRatio3D (refPoint.p.pLat);
 	dLat  =  (windVelocity.v / METERSPERDEGREELAT) * timeStep;
 
 	deltaPoint.p.pLong = dLong * 1000000;
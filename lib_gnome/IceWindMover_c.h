@@ -48,7 +48,7 @@ public:
 	//virtual ClassID 	GetClassID () { return TYPE_ICEWINDMOVER; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_ICEWINDMOVER) return TRUE; return GridWindMover_c::IAm(id); }
 
-	//virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	//virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	//VelocityRec			GetPatValue (WorldPoint p);
 	//VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	
@@ -64,8 +64,8 @@ public:
 	//long	GetTimeShift() {return timeGrid->GetTimeShift();}	
 	
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 			// may need these functions eventually if add a separate ice grid
 			//TopologyHdl GetTopologyHdl(void);
@@ -78,7 +78,7 @@ public:
 			OSErr		TextRead(char *path,char *topFilePath);
 			OSErr 		ExportTopology(char* path){return timeGrid->ExportTopology(path);}
 
-			OSErr		get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID);
+			OSErr		get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID);
 
 };
 
@@ -0,0 +1,191 @@
+/*
+ *  InterpolationDevice.cu
+ *  gnome
+ *
+ *  One device thread per LE. The products and sums are the round to nearest
+ *  intrinsics, so nvcc can't contract them to fused multiply adds whatever
+ *  its flags, and the velocities are bitwise those of the cpu kernels.
+ *
+ *  The fields on the device are kept in a small table, the least recently
+ *  used one is dropped for a new one. The table and the scratch buffers of
+ *  the batches are shared by all the movers and threads.
+ *
+ */
+
+#include <cuda_runtime.h>
+
+#include "InterpolationDevice.h"
+#include "GnomeThreads.h"
+
+// the start and end fields of 8 grids
+#define kMaxDeviceFields 16
+#define kDeviceBlockSize 256
+
+typedef struct {
+	const void		*key;
+	long			count;
+	double			*data;
+	unsigned long	lastUse;
+} DeviceFieldEntry;
+
+static GnomeMutex sDeviceMutex;
+static DeviceFieldEntry sFields[kMaxDeviceFields];
+static unsigned long sUseCounter = 0;
+
+// the batch buffers, grown as needed and kept
+static long *sPtIndex = 0;
+static double *sAlpha = 0, *sVel = 0;
+static long sScratchSize = 0;	// LEs the buffers have room for, with 4 corners
+
+__global__ void InterpolateKernel(int numCorners, long n, const long *ptIndex, const double *alpha,
+								  const double *start, const double *end, double timeAlpha, double *vel)
+{
+	long i = blockIdx.x * (long)blockDim.x + threadIdx.x;
+	double velU = 0., velV = 0.;
+
+	if (i >= n)
+		return;
+
+	if (ptIndex[i] >= 0) {
+		for (int k = 0; k < numCorners; k++) {
+			long index = ptIndex[k * n + i];
+			double a = alpha[k * n + i], u, w;
+
+			if (end) {
+				u = __dmul_rn(a, __dadd_rn(__dmul_rn(timeAlpha, start[2 * index]), __dmul_rn(1 - timeAlpha, end[2 * index])));
+				w = __dmul_rn(a, __dadd_rn(__dmul_rn(timeAlpha, start[2 * index + 1]), __dmul_rn(1 - timeAlpha, end[2 * index + 1])));
+			}
+			else {
+				u = __dmul_rn(a, start[2 * index]);
+				w = __dmul_rn(a, start[2 * index + 1]);
+			}
+			if (k == 0) {
+				velU = u;
+				velV = w;
+			}
+			else {
+				velU = __dadd_rn(velU, u);
+				velV = __dadd_rn(velV, w);
+			}
+		}
+	}
+	vel[2 * i] = velU;
+	vel[2 * i + 1] = velV;
+}
+
+bool DeviceInterpolationAvailable()
+{
+	static int available = -1;
+
+	GnomeLock lock(sDeviceMutex);
+	if (available < 0) {
+		int count = 0;
+
+		available = (cudaGetDeviceCount(&count) == cudaSuccess && count > 0) ? 1 : 0;
+	}
+	return available == 1;
+}
+
+static void FreeEntry(DeviceFieldEntry *entry)
+{
+	if (entry->data)
+		cudaFree(entry->data);
+	entry->key = 0;
+	entry->count = 0;
+	entry->data = 0;
+	entry->lastUse = 0;
+}
+
+// the field on the device, uploaded if it isn't there. Called with the mutex held
+static const double *DeviceFieldData(const DeviceField &field)
+{
+	DeviceFieldEntry *entry = &sFields[0];
+
+	for (int j = 0; j < kMaxDeviceFields; j++) {
+		if (sFields[j].key == field.key && sFields[j].count == field.count && sFields[j].data) {
+			sFields[j].lastUse = ++sUseCounter;
+			return sFields[j].data;
+		}
+		if (sFields[j].lastUse < entry->lastUse)
+			entry = &sFields[j];
+	}
+
+	FreeEntry(entry);
+	if (cudaMalloc((void **)&entry->data, 2 * field.count * sizeof(double)) != cudaSuccess) {
+		entry->data = 0;
+		return 0;
+	}
+	if (cudaMemcpy(entry->data, field.uv, 2 * field.count * sizeof(double), cudaMemcpyHostToDevice) != cudaSuccess) {
+		FreeEntry(entry);
+		return 0;
+	}
+	entry->key = field.key;
+	entry->count = field.count;
+	entry->lastUse = ++sUseCounter;
+	return entry->data;
+}
+
+static bool ReserveScratch(long n)
+{
+	if (n <= sScratchSize)
+		return true;
+
+	cudaFree(sPtIndex);
+	cudaFree(sAlpha);
+	cudaFree(sVel);
+	sPtIndex = 0;
+	sAlpha = sVel = 0;
+	sScratchSize = 0;
+
+	if (cudaMalloc((void **)&sPtIndex, 4 * n * sizeof(long)) != cudaSuccess ||
+		cudaMalloc((void **)&sAlpha, 4 * n * sizeof(double)) != cudaSuccess ||
+		cudaMalloc((void **)&sVel, 2 * n * sizeof(double)) != cudaSuccess)
+		return false;
+
+	sScratchSize = n;
+	return true;
+}
+
+bool DeviceInterpolate(long numCorners, long n, const long *ptIndex, const double *alpha,
+					   DeviceField start, DeviceField end, double timeAlpha, double *velUV)
+{
+	const double *startData, *endData = 0;
+	long numBlocks = (n + kDeviceBlockSize - 1) / kDeviceBlockSize;
+
+	if (n <= 0 || !start.key || numCorners > 4 || !DeviceInterpolationAvailable())
+		return false;
+
+	GnomeLock lock(sDeviceMutex);
+
+	startData = DeviceFieldData(start);
+	if (end.key)
+		endData = DeviceFieldData(end);
+	if (!startData || (end.key && !endData))
+		return false;
+
+	if (!ReserveScratch(n))
+		return false;
+
+	if (cudaMemcpy(sPtIndex, ptIndex, numCorners * n * sizeof(long), cudaMemcpyHostToDevice) != cudaSuccess ||
+		cudaMemcpy(sAlpha, alpha, numCorners * n * sizeof(double), cudaMemcpyHostToDevice) != cudaSuccess)
+		return false;
+
+	InterpolateKernel<<<numBlocks, kDeviceBlockSize>>>((int)numCorners, n, sPtIndex, sAlpha,
+													   startData, endData, timeAlpha, sVel);
+	if (cudaGetLastError() != cudaSuccess)
+		return false;
+
+	return cudaMemcpy(velUV, sVel, 2 * n * sizeof(double), cudaMemcpyDeviceToHost) == cudaSuccess;
+}
+
+void ForgetDeviceField(const void *key)
+{
+	if (!key)
+		return;
+
+	GnomeLock lock(sDeviceMutex);
+	for (int j = 0; j < kMaxDeviceFields; j++) {
+		if (sFields[j].key == key)
+			FreeEntry(&sFields[j]);
+	}
+}
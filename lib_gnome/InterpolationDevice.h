@@ -0,0 +1,38 @@
+/*
+ *  InterpolationDevice.h
+ *  gnome
+ *
+ *  The CUDA kernel of the batched interpolation (InterpolationKernels.h),
+ *  built with GNOME_CUDA. A velocity field is copied to the device the first
+ *  time a batch uses it and kept there, by its handle, until
+ *  ForgetDeviceField(): a time slice goes over once for the interval it is
+ *  loaded for, not once per batch. Each batch sends only its LEs' corners
+ *  and weights - the LEs are located on the cpu, by the grid's DAG tree.
+ *
+ *  The kernel does the sums of InterpolateScalar in the same order, and is
+ *  compiled without fused multiply adds, so it gives the same velocities.
+ *
+ */
+
+#ifndef __InterpolationDevice__
+#define __InterpolationDevice__
+
+// the count velocities of the field of key, u and v interleaved
+typedef struct {
+	const void		*key;
+	const double	*uv;
+	long			count;
+} DeviceField;
+
+// true if there is a device to run the kernel on
+bool DeviceInterpolationAvailable();
+
+// the velocities of the n LEs, as InterpolateScalar. An end field with no key
+// means the start field alone. False if the device failed, with vel unset.
+bool DeviceInterpolate(long numCorners, long n, const long *ptIndex, const double *alpha,
+					   DeviceField start, DeviceField end, double timeAlpha, double *velUV);
+
+// the field of key is disposed of, or about to change
+void ForgetDeviceField(const void *key);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ *  InterpolationKernels.cpp
+ *  gnome
+ *
+ *  The AVX2 kernel does 4 LEs at a time with gathers, chosen at run time so
+ *  the library still runs on older cpus. It does not use FMA, a fused
+ *  multiply add rounds once instead of twice and would change the results.
+ *  Other platforms (including NEON, where the compiler vectorizes the plain
+ *  loop) use the scalar loop. With GNOME_CUDA the batches can go to the
+ *  CUDA kernel instead, see InterpolationDevice.h.
+ *
+ */
+
+#include "InterpolationKernels.h"
+#include "MemUtils.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__) && defined(__LP64__)
+#define INTERPOLATION_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(GNOME_CUDA) && defined(pyGNOME)	// the device kernel is double precision
+#define INTERPOLATION_DEVICE
+#include "InterpolationDevice.h"
+#endif
+
+static Boolean useSIMD = true;
+static Boolean useDevice = false;
+
+void SetInterpolationSIMD(Boolean simd)
+{
+	useSIMD = simd;
+}
+
+Boolean SetInterpolationDevice(Boolean device)
+{
+	useDevice = false;
+#ifdef INTERPOLATION_DEVICE
+	useDevice = device && DeviceInterpolationAvailable();
+#endif
+	return useDevice;
+}
+
+Boolean GetInterpolationDevice()
+{
+	return useDevice;
+}
+
+void ForgetInterpolationField(VelocityFH field)
+{
+#ifdef INTERPOLATION_DEVICE
+	ForgetDeviceField(field);
+#endif
+}
+
+#ifdef INTERPOLATION_AVX2
+static Boolean HasAVX2()
+{
+	static int hasAVX2 = -1;
+
+	if (hasAVX2 < 0) {
+		__builtin_cpu_init();
+		hasAVX2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return hasAVX2 == 1;
+}
+#endif
+
+const char *GetInterpolationKernel()
+{
+	if (useDevice)
+		return "cuda";
+#ifdef INTERPOLATION_AVX2
+	if (useSIMD && HasAVX2())
+		return "avx2";
+#endif
+	return "scalar";
+}
+
+static void InterpolateScalar(long numCorners, long first, long n, const long *ptIndex, const double *alpha,
+							  VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel)
+{
+	for (long i = first; i < n; i++) {
+		VelocityRec v = {0., 0.};
+
+		if (ptIndex[i] >= 0) {
+			for (long k = 0; k < numCorners; k++) {
+				long index = ptIndex[k * n + i];
+				double a = alpha[k * n + i], u, w;
+
+				if (endH) {
+					u = a * (timeAlpha * INDEXH(startH, index).u + (1 - timeAlpha) * INDEXH(endH, index).u);
+					w = a * (timeAlpha * INDEXH(startH, index).v + (1 - timeAlpha) * INDEXH(endH, index).v);
+				}
+				else {
+					u = a * (INDEXH(startH, index).u);
+					w = a * (INDEXH(startH, index).v);
+				}
+				if (k == 0) {
+					v.u = u;
+					v.v = w;
+				}
+				else {
+					v.u += u;
+					v.v += w;
+				}
+			}
+		}
+		vel[i] = v;
+	}
+}
+
+#ifdef INTERPOLATION_AVX2
+// one component of 4 velocities, offsets are in components (2 per velocity)
+__attribute__((target("avx2")))
+static inline __m256d GatherComponent(const VelocityFRec *field, long component, __m256i offsets)
+{
+#ifdef pyGNOME
+	return _mm256_i64gather_pd(&field->u + component, offsets, sizeof(double));
+#else
+	return _mm256_cvtps_pd(_mm256_i64gather_ps(&field->u + component, offsets, sizeof(float)));
+#endif
+}
+
+// returns how many LEs it did, the rest are left for the scalar loop
+__attribute__((target("avx2")))
+static long InterpolateAVX2(long numCorners, long n, const long *ptIndex, const double *alpha,
+							VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel)
+{
+	const VelocityFRec *start = *startH, *end = endH ? *endH : 0;
+	__m256d startWeight = _mm256_set1_pd(timeAlpha), endWeight = _mm256_set1_pd(1 - timeAlpha);
+	double u[4], v[4];
+	long i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		__m256i valid = _mm256_cmpgt_epi64(_mm256_loadu_si256((const __m256i *)(ptIndex + i)), _mm256_set1_epi64x(-1));
+		__m256d sumU = _mm256_setzero_pd(), sumV = _mm256_setzero_pd();
+
+		for (long k = 0; k < numCorners; k++) {
+			// LEs with no cell read velocity 0 and are zeroed below
+			__m256i index = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(ptIndex + k * n + i)), valid);
+			__m256i offsets = _mm256_slli_epi64(index, 1);
+			__m256d a = _mm256_loadu_pd(alpha + k * n + i);
+			__m256d cornerU = GatherComponent(start, 0, offsets);
+			__m256d cornerV = GatherComponent(start, 1, offsets);
+
+			if (end) {
+				cornerU = _mm256_add_pd(_mm256_mul_pd(startWeight, cornerU), _mm256_mul_pd(endWeight, GatherComponent(end, 0, offsets)));
+				cornerV = _mm256_add_pd(_mm256_mul_pd(startWeight, cornerV), _mm256_mul_pd(endWeight, GatherComponent(end, 1, offsets)));
+			}
+			cornerU = _mm256_mul_pd(a, cornerU);
+			cornerV = _mm256_mul_pd(a, cornerV);
+			if (k == 0) {
+				sumU = cornerU;
+				sumV = cornerV;
+			}
+			else {
+				sumU = _mm256_add_pd(sumU, cornerU);
+				sumV = _mm256_add_pd(sumV, cornerV);
+			}
+		}
+
+		_mm256_storeu_pd(u, _mm256_and_pd(sumU, _mm256_castsi256_pd(valid)));
+		_mm256_storeu_pd(v, _mm256_and_pd(sumV, _mm256_castsi256_pd(valid)));
+		for (long j = 0; j < 4; j++) {
+			vel[i + j].u = u[j];
+			vel[i + j].v = v[j];
+		}
+	}
+
+	return i;
+}
+#endif
+
+static void Interpolate(long numCorners, long n, const long *ptIndex, const double *alpha,
+						VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel)
+{
+	long first = 0;
+
+	if (n <= 0 || !startH)
+		return;
+
+#ifdef INTERPOLATION_DEVICE
+	if (useDevice) {
+		DeviceField start = {startH, &(*startH)->u, _GetHandleSize((Handle)startH) / (long)sizeof(VelocityFRec)};
+		DeviceField end = {endH, endH ? &(*endH)->u : 0, endH ? _GetHandleSize((Handle)endH) / (long)sizeof(VelocityFRec) : 0};
+
+		if (DeviceInterpolate(numCorners, n, ptIndex, alpha, start, end, timeAlpha, &vel->u))
+			return;
+	}
+#endif
+#ifdef INTERPOLATION_AVX2
+	if (useSIMD && HasAVX2())
+		first = InterpolateAVX2(numCorners, n, ptIndex, alpha, startH, endH, timeAlpha, vel);
+#endif
+	InterpolateScalar(numCorners, first, n, ptIndex, alpha, startH, endH, timeAlpha, vel);
+}
+
+void InterpolateBarycentric(long n, const long *ptIndex, const double *alpha,
+							VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel)
+{
+	Interpolate(3, n, ptIndex, alpha, startH, endH, timeAlpha, vel);
+}
+
+void InterpolateBilinear(long n, const long *ptIndex, const double *alpha,
+						 VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel)
+{
+	Interpolate(4, n, ptIndex, alpha, startH, endH, timeAlpha, vel);
+}
@@ -0,0 +1,43 @@
+/*
+ *  InterpolationKernels.h
+ *  gnome
+ *
+ *  Space and time interpolation of a velocity field for a batch of LEs whose
+ *  cells are already located. Corner k of LE i is ptIndex[k*n + i] with
+ *  weight alpha[k*n + i], an LE with ptIndex[i] < 0 gets zero velocity.
+ *  With endH == 0 the start field is used alone (constant current), otherwise
+ *  each corner is timeAlpha*start + (1-timeAlpha)*end.
+ *
+ *  The sums are done in the same order as the per LE code in TimeGridVel_c,
+ *  so every path gives bitwise the same velocities.
+ *
+ */
+
+#ifndef __InterpolationKernels__
+#define __InterpolationKernels__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+// triangles, 3 corners with barycentric weights
+void InterpolateBarycentric(long n, const long *ptIndex, const double *alpha,
+							VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel);
+
+// grid cells, 4 corners with bilinear weights
+void InterpolateBilinear(long n, const long *ptIndex, const double *alpha,
+						 VelocityFH startH, VelocityFH endH, double timeAlpha, VelocityRec *vel);
+
+// the vector kernels are used when the cpu has them, false forces the scalar loop
+void DLL_API SetInterpolationSIMD(Boolean useSIMD);
+DLL_API const char *GetInterpolationKernel();
+
+// true sends the batches to the CUDA kernel (InterpolationDevice.h). Returns false,
+// and the cpu kernels are kept, if lib_gnome wasn't built with GNOME_CUDA or there is
+// no device. A batch the device fails goes to the cpu kernels.
+Boolean DLL_API SetInterpolationDevice(Boolean useDevice);
+Boolean DLL_API GetInterpolationDevice();
+// a field is disposed of, or about to change: the device drops its copy of it
+void ForgetInterpolationField(VelocityFH field);
+
+#endif
@@ -17,6 +17,8 @@
 #include "Replacements.h"
 #endif
 
+unsigned long LEList_c::sLEChangeCount = 1;
+
 LEList_c::LEList_c()
 {
 	LEHandle = 0;
@@ -26,6 +28,10 @@ LEList_c::LEList_c()
 	//memset(&fOwnersUniqueID,0,sizeof(fOwnersUniqueID));
 		
 	bOpen = FALSE;
+
+	memset(&fStatusCounts,0,sizeof(fStatusCounts));
+	fStatusCountsStamp = 0;
+	fStatusCountsHandle = 0;
 }
 
 
@@ -44,53 +50,71 @@ WorldRect LEList_c::GetLEBounds()
 	return bounds;
 }
 
-//JLE 1/6/99
-
-void LEList_c::GetLEStatistics(long* numReleased,long* numEvaporated,long* numBeached, long* numOffMap, long* numFloating)
+// The budget table, the mass balance totals and the list all ask for the same counts
+// several times a step, they're kept until LEsChanged()
+const LEStatusCounts &LEList_c::GetLEStatusCounts()
 {
-	long i,numNotReleased = 0;
-	*numEvaporated = *numBeached = *numOffMap = *numFloating = 0;
+	long i;
+	LERec *le;
+
+	if (fStatusCountsStamp == sLEChangeCount && fStatusCountsHandle == LEHandle && 
+		fStatusCounts.numNotReleased + fStatusCounts.numFloating + fStatusCounts.numBeached + 
+		fStatusCounts.numOffMap + fStatusCounts.numEvaporated + fStatusCounts.numOther == this->numOfLEs)
+		return fStatusCounts;
+
+	memset(&fStatusCounts,0,sizeof(fStatusCounts));
 	if (LEHandle) {
 		for (i = 0 ; i < this->numOfLEs ; i++) {
-			switch( INDEXH(LEHandle, i).statusCode)
+			le = &INDEXH(LEHandle, i);
+			switch(le->statusCode)
 			{
-				case OILSTAT_NOTRELEASED: numNotReleased++; break;
-				case OILSTAT_OFFMAPS: (*numOffMap)++; break;
-				case OILSTAT_ONLAND: (*numBeached)++; break;
-				case OILSTAT_EVAPORATED: (*numEvaporated)++; break;
-				case OILSTAT_INWATER:(*numFloating)++; break;
+				case OILSTAT_NOTRELEASED: fStatusCounts.numNotReleased++; break;
+				case OILSTAT_OFFMAPS: fStatusCounts.numOffMap++; break;
+				case OILSTAT_ONLAND: fStatusCounts.numBeached++; break;
+				case OILSTAT_EVAPORATED: fStatusCounts.numEvaporated++; break;
+				case OILSTAT_INWATER: fStatusCounts.numFloating++; break;
+				default: fStatusCounts.numOther++; break;
 			}
+			// code goes here, Alan occasionally seeing budget table floating < 0, maybe not released has z>0 or dispersed Le is getting beached?
+			if ((le->dispersionStatus == HAVE_DISPERSED || le->dispersionStatus == HAVE_DISPERSED_NAT || le->z > 0) && 
+				!(le->statusCode==OILSTAT_EVAPORATED) && !(le->statusCode==OILSTAT_OFFMAPS) && !(le->statusCode==OILSTAT_NOTRELEASED) && !(le->statusCode==OILSTAT_ONLAND))
+				fStatusCounts.numDispersed++;
+			if (le->dispersionStatus == HAVE_REMOVED && le->statusCode==OILSTAT_OFFMAPS)
+				fStatusCounts.numRemoved++;
 		}
 	}
-	*numReleased = this->numOfLEs - numNotReleased;
+	else
+		fStatusCounts.numOther = this->numOfLEs;	// nothing to count
+	fStatusCountsStamp = sLEChangeCount;
+	fStatusCountsHandle = LEHandle;
+	return fStatusCounts;
+}
+
+//JLE 1/6/99
+
+void LEList_c::GetLEStatistics(long* numReleased,long* numEvaporated,long* numBeached, long* numOffMap, long* numFloating)
+{
+	const LEStatusCounts &counts = GetLEStatusCounts();
+
+	*numEvaporated = counts.numEvaporated;
+	*numBeached = counts.numBeached;
+	*numOffMap = counts.numOffMap;
+	*numFloating = counts.numFloating;
+	*numReleased = this->numOfLEs - counts.numNotReleased;
 }
 
 void LEList_c::RecalculateLEStatistics(long* numDispersed,long* numFloating,long* numRemoved,long* numOffMaps)
 {
 	// code goes here, might want to calculate percent dissolved here
-	long i;
-	if (LEHandle) {
-		for (i = 0 ; i < this->numOfLEs ; i++) {	// code goes here, Alan occasionally seeing budget table floating < 0, maybe not released has z>0 or dispersed Le is getting beached?
-			if( ((INDEXH(LEHandle, i).dispersionStatus == HAVE_DISPERSED || INDEXH(LEHandle, i).dispersionStatus == HAVE_DISPERSED_NAT) || INDEXH(LEHandle,i).z > 0) && !(INDEXH(LEHandle, i).statusCode==OILSTAT_EVAPORATED) && !(INDEXH(LEHandle, i).statusCode==OILSTAT_OFFMAPS) && !(INDEXH(LEHandle, i).statusCode==OILSTAT_NOTRELEASED) && !(INDEXH(LEHandle, i).statusCode==OILSTAT_ONLAND))
-				//if( ((INDEXH(LEHandle, i).dispersionStatus == HAVE_DISPERSED || INDEXH(LEHandle, i).dispersionStatus == HAVE_DISPERSED_NAT) || INDEXH(LEHandle,i).z > 0) && INDEXH(LEHandle, i).statusCode==OILSTAT_INWATER )
-			{
-				(*numDispersed)++; 
-				(*numFloating)--; 
-				if ((*numFloating) < 0) 
-				{
-					//printNote("Num floating < 0 in RecalculateLEStatistics");
-				}
-			}
-			if( (INDEXH(LEHandle, i).dispersionStatus == HAVE_REMOVED) && (INDEXH(LEHandle, i).statusCode==OILSTAT_OFFMAPS) )
-			{
-				(*numRemoved)++; 
-				(*numOffMaps)--; 
-				if ((*numOffMaps) < 0) 
-				{
-					printNote("Num off maps < 0 in RecalculateLEStatistics");
-				}
-			}
-		}
+	const LEStatusCounts &counts = GetLEStatusCounts();
+
+	*numDispersed += counts.numDispersed;
+	*numFloating -= counts.numDispersed;
+	*numRemoved += counts.numRemoved;
+	*numOffMaps -= counts.numRemoved;
+	if ((*numOffMaps) < 0) 
+	{
+		printNote("Num off maps < 0 in RecalculateLEStatistics");
 	}
 }
 /*
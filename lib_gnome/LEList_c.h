@@ -15,6 +15,18 @@
 #include "TypeDefs.h"
 #include "ClassID_c.h"
 
+// the LEs of a list in each status, counted in one pass
+typedef struct {
+	long	numNotReleased;
+	long	numFloating;
+	long	numBeached;
+	long	numOffMap;
+	long	numEvaporated;
+	long	numOther;
+	long	numDispersed;	// in the water column, of the floating and other
+	long	numRemoved;		// of the off map
+} LEStatusCounts;
+
 class LEList_c : virtual public ClassID_c {
 
 public:
@@ -24,6 +36,13 @@ public:
 	LETYPE 			fLeType;
 	//UNIQUEID		fOwnersUniqueID; // set if owned by another LE set, i.e this is a mirrored set
 
+protected:
+	LEStatusCounts	fStatusCounts;
+	unsigned long	fStatusCountsStamp;	// sLEChangeCount when they were counted, 0 if never
+	LERecH			fStatusCountsHandle;
+	static unsigned long sLEChangeCount;
+
+public:
 					LEList_c ();
 	virtual OSErr	Reset (Boolean newKeys) { return noErr; }
 	virtual LETYPE 	GetLEType () { return fLeType; }
@@ -42,6 +61,9 @@ public:
 	WorldRect		GetLEBounds ();
 	void 			GetLEStatistics(long* numReleased,long* numEvaporated,long* numBeached, long* numOffMap, long* numFloating);
 	void 			RecalculateLEStatistics(long* numEvaporated,long* numFloating, long* numRemoved, long* numOffMaps); // 	to account for dispersion
+	const LEStatusCounts &GetLEStatusCounts();
+	// the LEs of some list may have changed: the counts of all the lists are counted again when next asked for
+	static void		LEsChanged() { sLEChangeCount++; }
 	virtual void 	GetLEAmountStatistics(short desiredMassVolUnits, double *amtTotal,double *amtReleased,double *amtEvaporated,
 										  double *amtDispersed,double *amtBeached,double *amtOffmap, double *amtFloating, double *amtRemoved){};
 	virtual long	GetLECount () { return numOfLEs; }  
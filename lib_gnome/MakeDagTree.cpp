@@ -3,6 +3,7 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "MemUtils.h"
+#include "SetupStats.h"
 #include "DagTreeIO.h"
 #include "my_build_list.h"
 
@@ -223,6 +224,8 @@ void ConvertSegNoToTopIndex(Side_List **sl, DAGTreeStruct dagTree)
 
 DAGTreeStruct  MakeDagTree(TopologyHdl topoHdl, LongPoint **pointList, char *errStr)
 {
+	MemoryTag memoryTag(kMemDagTree);
+	SetupStage setupStage(kSetupDagTree);
 	Side_List **sidesList = 0;
 	DAGTreeStruct  dagTree;
 	long numSidesInList;		
@@ -0,0 +1,474 @@
+// constrained Delaunay alternative to maketriangles for large grids
+// points are inserted in Hilbert curve order, each located by walking from
+// the last insertion, then the boundary segments are forced in by flipping
+// and the triangles outside the boundaries dropped, so it runs in about
+// n log n where maketriangles scans every vertex for every front segment
+#include <math.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "MemUtils.h"
+#include "DagTreeIO.h"
+#include "my_build_list.h"
+
+#ifndef pyGNOME
+#include "CROSS.H"
+#else
+#include "Replacements.h"
+#endif
+
+using std::vector;
+using std::deque;
+
+typedef long long CDTCoord;	// orientation is exact on the LongPoints, 64 bits covers the products
+
+class CDTMesh
+{
+	public:
+		vector<CDTCoord>	h, v;		// exact coordinates, the 3 enclosing vertices are last
+		vector<double>		x, y;		// scaled for the circle tests
+		vector<long>		tv;			// 3 vertices per triangle, counterclockwise
+		vector<long>		tn;			// neighbor tn[3t+k] is across the edge opposite tv[3t+k]
+		vector<long>		vertexTri;	// a triangle using each vertex
+		vector<long>		ringNext;	// next point along its boundary, -1 for interior vertices
+		long				numReal, lastTri;
+
+		long	Orient(long a, long b, long c);
+		Boolean	InCircle(long a, long b, long c, long d);
+		Boolean	IsConstrained(long a, long b);
+		long	Index(long t, long vert) {for (int k = 0; k < 3; k++) if (tv[3*t+k] == vert) return k; return -1;}
+		void	ReplaceNeighbor(long t, long oldTri, long newTri);
+		long	NewTri();
+		void	SetTri(long t, long a, long b, long c, long na, long nb, long nc);
+		long	FindEdge(long a, long b, long *k);
+		long	Locate(long p, long *onEdge);
+		void	Flip(long t, long k);
+		void	Legalize(long t, long k);
+		OSErr	Insert(long p);
+		OSErr	InsertSegment(long a, long b);
+};
+
+long CDTMesh::Orient(long a, long b, long c)
+{
+	CDTCoord det = (h[b] - h[a]) * (v[c] - v[a]) - (v[b] - v[a]) * (h[c] - h[a]);
+	return det > 0 ? 1 : (det < 0 ? -1 : 0);
+}
+
+// d strictly inside the circle through counterclockwise a, b, c
+// nearly cocircular quads are left alone so a regular grid can't flip back and forth
+Boolean CDTMesh::InCircle(long a, long b, long c, long d)
+{
+	double adx = x[a] - x[d], ady = y[a] - y[d];
+	double bdx = x[b] - x[d], bdy = y[b] - y[d];
+	double cdx = x[c] - x[d], cdy = y[c] - y[d];
+	double alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy, clift = cdx * cdx + cdy * cdy;
+	double bc = bdx * cdy - cdx * bdy, ca = cdx * ady - adx * cdy, ab = adx * bdy - bdx * ady;
+	double det = alift * bc + blift * ca + clift * ab;
+	double permanent = alift * fabs(bc) + blift * fabs(ca) + clift * fabs(ab);
+
+	return det > 1e-10 * permanent;
+}
+
+Boolean CDTMesh::IsConstrained(long a, long b)
+{
+	return (a < numReal && ringNext[a] == b) || (b < numReal && ringNext[b] == a);
+}
+
+void CDTMesh::ReplaceNeighbor(long t, long oldTri, long newTri)
+{
+	if (t < 0) return;
+	for (int k = 0; k < 3; k++)
+		if (tn[3*t+k] == oldTri) {tn[3*t+k] = newTri; return;}
+}
+
+long CDTMesh::NewTri()
+{
+	tv.resize(tv.size() + 3);
+	tn.resize(tn.size() + 3);
+	return (long)tv.size() / 3 - 1;
+}
+
+void CDTMesh::SetTri(long t, long a, long b, long c, long na, long nb, long nc)
+{
+	tv[3*t] = a; tv[3*t+1] = b; tv[3*t+2] = c;
+	tn[3*t] = na; tn[3*t+1] = nb; tn[3*t+2] = nc;
+	vertexTri[a] = vertexTri[b] = vertexTri[c] = t;
+}
+
+// triangle with a, then b, counterclockwise, -1 if there is no such edge
+// *k gets the index of the third vertex, so the edge is opposite tv[3t+*k]
+long CDTMesh::FindEdge(long a, long b, long *k)
+{
+	long t = vertexTri[a], start = t, i;
+
+	do {
+		i = Index(t, a);
+		if (tv[3*t+(i+1)%3] == b) {*k = (i+2)%3; return t;}
+		t = tn[3*t+(i+1)%3];	// across the edge from tv[3t+i+2] to a, counterclockwise around a
+	} while (t >= 0 && t != start);
+
+	return -1;
+}
+
+// triangle holding p, *onEdge gets the index of the vertex opposite the edge p is on, or -1
+long CDTMesh::Locate(long p, long *onEdge)
+{
+	long t = lastTri, steps = 0, numTri = (long)tv.size() / 3;
+
+	for (;;) {
+		int k, offset = (int)(steps % 3), zeros = 0;
+		long next = -1, zeroEdge = -1;
+
+		for (int i = 0; i < 3; i++) {
+			k = (i + offset) % 3;
+			long o = Orient(tv[3*t+(k+1)%3], tv[3*t+(k+2)%3], p);
+			if (o < 0) {next = tn[3*t+k]; break;}
+			if (o == 0) {zeros++; zeroEdge = k;}
+		}
+		if (next < 0) {
+			if (zeros > 1) return -1;	// on a vertex, a duplicate point
+			*onEdge = zeros ? zeroEdge : -1;
+			return t;
+		}
+		t = next;
+		if (++steps > numTri) return -1;
+	}
+}
+
+// replace the edge opposite tv[3t+k] with the other diagonal of the quad
+void CDTMesh::Flip(long t, long k)
+{
+	long o = tn[3*t+k], j;
+	long p = tv[3*t+k], e1 = tv[3*t+(k+1)%3], e2 = tv[3*t+(k+2)%3];
+	long A = tn[3*t+(k+1)%3], B = tn[3*t+(k+2)%3];
+	long d, C, D;
+
+	for (j = 0; j < 3; j++)
+		if (tn[3*o+j] == t) break;
+	d = tv[3*o+j];
+	C = tn[3*o+(j+1)%3];
+	D = tn[3*o+(j+2)%3];
+
+	SetTri(t, p, e1, d, C, o, B);
+	SetTri(o, d, e2, p, A, t, D);
+	ReplaceNeighbor(C, o, t);
+	ReplaceNeighbor(A, t, o);
+}
+
+// restore the Delaunay condition after p = tv[3t+k] was inserted
+void CDTMesh::Legalize(long t, long k)
+{
+	vector<long> stack;
+
+	stack.push_back(t);
+	stack.push_back(tv[3*t+k]);
+	while (!stack.empty()) {
+		long p = stack.back(); stack.pop_back();
+		long tri = stack.back(); stack.pop_back();
+		long i = Index(tri, p), o = tn[3*tri+i], j;
+
+		if (o < 0) continue;
+		for (j = 0; j < 3; j++)
+			if (tn[3*o+j] == tri) break;
+		if (!InCircle(tv[3*tri], tv[3*tri+1], tv[3*tri+2], tv[3*o+j]))
+			continue;
+		Flip(tri, i);
+		// tri is now (p, e1, d) and o is (d, e2, p)
+		stack.push_back(tri); stack.push_back(p);
+		stack.push_back(o); stack.push_back(p);
+	}
+}
+
+OSErr CDTMesh::Insert(long p)
+{
+	long onEdge, t = Locate(p, &onEdge);
+
+	if (t < 0) return -1;
+
+	if (onEdge < 0) {
+		long a = tv[3*t], b = tv[3*t+1], c = tv[3*t+2];
+		long na = tn[3*t], nb = tn[3*t+1], nc = tn[3*t+2];
+		long t1 = NewTri(), t2 = NewTri();
+
+		SetTri(t, a, b, p, t1, t2, nc);
+		SetTri(t1, b, c, p, t2, t, na);
+		SetTri(t2, c, a, p, t, t1, nb);
+		ReplaceNeighbor(na, t, t1);
+		ReplaceNeighbor(nb, t, t2);
+		Legalize(t, 2);
+		Legalize(t1, 2);
+		Legalize(t2, 2);
+	}
+	else {
+		long k = onEdge, o = tn[3*t+k], j;
+		long a = tv[3*t+k], b = tv[3*t+(k+1)%3], c = tv[3*t+(k+2)%3];
+		long nca = tn[3*t+(k+1)%3], nab = tn[3*t+(k+2)%3];
+		long d, nbd, ndc, t1, o1;
+
+		if (o < 0) return -1;	// can't happen inside the enclosing triangle
+		for (j = 0; j < 3; j++)
+			if (tn[3*o+j] == t) break;
+		d = tv[3*o+j];
+		nbd = tn[3*o+(j+1)%3];
+		ndc = tn[3*o+(j+2)%3];
+		t1 = NewTri();
+		o1 = NewTri();
+
+		SetTri(t, a, b, p, o, t1, nab);
+		SetTri(t1, a, p, c, o1, nca, t);
+		SetTri(o, d, p, b, t, nbd, o1);
+		SetTri(o1, d, c, p, t1, o, ndc);
+		ReplaceNeighbor(nca, t, t1);
+		ReplaceNeighbor(ndc, o, o1);
+		Legalize(t, 2);
+		Legalize(t1, 1);
+		Legalize(o, 1);
+		Legalize(o1, 2);
+	}
+	lastTri = vertexTri[p];
+
+	return 0;
+}
+
+// force the edge a-b in by flipping the edges that cross it (Sloan)
+// fails if another vertex lies on the segment
+OSErr CDTMesh::InsertSegment(long a, long b)
+{
+	deque<long> crossing;	// pairs of vertices
+	vector<long> added;
+	long t, k, start, i, left, right, count = 0;
+
+	if (FindEdge(a, b, &k) >= 0 || FindEdge(b, a, &k) >= 0)
+		return 0;
+
+	// the triangle around a the segment leaves through
+	t = start = vertexTri[a];
+	for (;;) {
+		i = Index(t, a);
+		right = tv[3*t+(i+1)%3];
+		left = tv[3*t+(i+2)%3];
+		if (Orient(a, right, b) > 0 && Orient(a, left, b) < 0) break;
+		if (Orient(a, right, b) == 0 && (h[right]-h[a])*(h[b]-h[a]) + (v[right]-v[a])*(v[b]-v[a]) > 0) return -1;
+		t = tn[3*t+(i+1)%3];
+		if (t < 0 || t == start) return -1;
+	}
+
+	// walk to b collecting the crossed edges
+	for (;;) {
+		long o, d, j, s;
+
+		crossing.push_back(left);
+		crossing.push_back(right);
+		for (j = 0; j < 3; j++)
+			if (tv[3*t+j] != left && tv[3*t+j] != right) break;
+		o = tn[3*t+j];
+		if (o < 0) return -1;
+		for (j = 0; j < 3; j++)
+			if (tv[3*o+j] != left && tv[3*o+j] != right) break;
+		d = tv[3*o+j];
+		if (d == b) break;
+		s = Orient(a, b, d);
+		if (s == 0) return -1;
+		if (s > 0) left = d; else right = d;
+		t = o;
+	}
+
+	// flip until none cross (Sloan), first in first out or a flip is undone right away
+	while (!crossing.empty()) {
+		long u, w, p, d, j, o;
+
+		if (++count > 1000000) return -1;	// the list is bounded so a bad case can't spin forever
+		u = crossing.front(); crossing.pop_front();
+		w = crossing.front(); crossing.pop_front();
+		t = FindEdge(u, w, &k);
+		if (t < 0) return -1;
+		o = tn[3*t+k];
+		if (o < 0) return -1;
+		for (j = 0; j < 3; j++)
+			if (tn[3*o+j] == t) break;
+		p = tv[3*t+k];
+		d = tv[3*o+j];
+		// t is (p, u, w), the quad p, u, d, w must be strictly convex
+		if (Orient(p, u, d) <= 0 || Orient(d, w, p) <= 0) {
+			crossing.push_back(u);
+			crossing.push_back(w);
+			continue;
+		}
+		Flip(t, k);
+		if (p != a && p != b && d != a && d != b &&
+			Orient(a, b, p) * Orient(a, b, d) < 0 && Orient(p, d, a) * Orient(p, d, b) < 0) {
+			crossing.push_back(p);
+			crossing.push_back(d);
+		}
+		else {
+			added.push_back(p);
+			added.push_back(d);
+		}
+	}
+
+	// make the new edges Delaunay again, rechecking the sides of each flipped quad
+	// and leaving the boundary segments alone
+	for (count = 0; !added.empty() && count < 1000000; count++) {
+		long u, w, j, o, p, d;
+
+		w = added.back(); added.pop_back();
+		u = added.back(); added.pop_back();
+		if (IsConstrained(u, w)) continue;
+		t = FindEdge(u, w, &k);
+		if (t < 0) continue;
+		o = tn[3*t+k];
+		if (o < 0) continue;
+		for (j = 0; j < 3; j++)
+			if (tn[3*o+j] == t) break;
+		p = tv[3*t+k];
+		d = tv[3*o+j];
+		if (!InCircle(p, u, w, d)) continue;
+		if (Orient(p, u, d) <= 0 || Orient(d, w, p) <= 0) continue;
+		Flip(t, k);
+		added.push_back(p); added.push_back(u);
+		added.push_back(u); added.push_back(d);
+		added.push_back(d); added.push_back(w);
+		added.push_back(w); added.push_back(p);
+	}
+
+	return FindEdge(a, b, &k) >= 0 || FindEdge(b, a, &k) >= 0 ? 0 : -1;
+}
+
+// position along a Hilbert curve over a 2^16 grid
+static unsigned long long HilbertIndex(unsigned long hx, unsigned long hy)
+{
+	unsigned long long d = 0;
+
+	for (unsigned long s = 1UL << 15; s > 0; s >>= 1) {
+		unsigned long rx = (hx & s) > 0, ry = (hy & s) > 0;
+		d += (unsigned long long)s * s * ((3 * rx) ^ ry);
+		if (ry == 0) {
+			if (rx == 1) {hx = s - 1 - hx; hy = s - 1 - hy;}
+			unsigned long tmp = hx; hx = hy; hy = tmp;
+		}
+	}
+	return d;
+}
+
+// same inputs and Topology output as maketriangles, returns true on failure
+// (duplicate points, a vertex on a boundary segment, badly oriented boundaries)
+// so the caller can fall back, errors are not reported here
+Boolean maketrianglesDelaunay(TopologyHdl *topoHdl, LongPointHdl ptsH, long nv, LONGH boundarySegs, long nbounds)
+{
+	CDTMesh mesh;
+	vector<std::pair<unsigned long long, long> > order;
+	vector<long> newIndex, queue;
+	CDTCoord hmin, hmax, vmin, vmax, M;
+	double xscale;
+	long i, k, t, numTri, numInside, segStart, seg;
+	TopologyHdl topo = 0;
+
+	if (nv < 3 || nbounds < 1 || !ptsH || !boundarySegs) return true;
+	if (INDEXH(boundarySegs, nbounds-1) >= nv) return true;
+
+	hmin = hmax = INDEXH(ptsH, 0).h;
+	vmin = vmax = INDEXH(ptsH, 0).v;
+	for (i = 1; i < nv; i++) {
+		hmin = _min(hmin, (CDTCoord)INDEXH(ptsH, i).h); hmax = _max(hmax, (CDTCoord)INDEXH(ptsH, i).h);
+		vmin = _min(vmin, (CDTCoord)INDEXH(ptsH, i).v); vmax = _max(vmax, (CDTCoord)INDEXH(ptsH, i).v);
+	}
+	M = _max(hmax - hmin, vmax - vmin) + 1;
+	// coordinates span at most 5M, which keeps the orientation products in 64 bits
+	if (M > 400000000) return true;
+
+	// distance ratios as on the ground, like InitCoordinates
+	xscale = cos((vmax + vmin) / 2e6 * PI / 180.);
+
+	mesh.numReal = nv;
+	mesh.h.resize(nv + 3); mesh.v.resize(nv + 3);
+	mesh.x.resize(nv + 3); mesh.y.resize(nv + 3);
+	for (i = 0; i < nv; i++) {
+		mesh.h[i] = INDEXH(ptsH, i).h - hmin;
+		mesh.v[i] = INDEXH(ptsH, i).v - vmin;
+	}
+	mesh.h[nv] = -M;		mesh.v[nv] = -M;
+	mesh.h[nv+1] = 4*M;		mesh.v[nv+1] = -M;
+	mesh.h[nv+2] = -M;		mesh.v[nv+2] = 4*M;
+	for (i = 0; i < nv + 3; i++) {
+		mesh.x[i] = mesh.h[i] * xscale;
+		mesh.y[i] = (double)mesh.v[i];
+	}
+
+	// boundary i runs from the point after boundarySegs[i-1] to boundarySegs[i] and closes
+	mesh.ringNext.assign(nv, -1);
+	for (seg = 0, segStart = 0; seg < nbounds; seg++) {
+		long segEnd = INDEXH(boundarySegs, seg);
+		if (segEnd - segStart < 2) return true;
+		for (i = segStart; i <= segEnd; i++) {
+			mesh.ringNext[i] = i < segEnd ? i + 1 : segStart;
+		}
+		segStart = segEnd + 1;
+	}
+
+	mesh.vertexTri.assign(nv + 3, -1);
+	mesh.tv.reserve(3 * (2 * nv + 8));
+	mesh.tn.reserve(3 * (2 * nv + 8));
+	mesh.SetTri(mesh.NewTri(), nv, nv+1, nv+2, -1, -1, -1);
+	mesh.lastTri = 0;
+
+	order.resize(nv);
+	for (i = 0; i < nv; i++) {
+		double side = (double)M;
+		order[i].first = HilbertIndex((unsigned long)(mesh.h[i] / side * 65535.), (unsigned long)(mesh.v[i] / side * 65535.));
+		order[i].second = i;
+	}
+	std::sort(order.begin(), order.end());
+
+	for (i = 0; i < nv; i++) {
+		if (i > 1000 && i % 1000 == 0) MySpinCursor();
+		if (mesh.Insert(order[i].second)) return true;
+	}
+
+	for (i = 0; i < nv; i++) {
+		if (mesh.ringNext[i] >= 0 && mesh.InsertSegment(i, mesh.ringNext[i]))
+			return true;
+	}
+
+	// flood from the left of each boundary segment without crossing one
+	numTri = (long)mesh.tv.size() / 3;
+	newIndex.assign(numTri, -1);
+	numInside = 0;
+	for (i = 0; i < nv; i++) {
+		if (mesh.ringNext[i] < 0) continue;
+		t = mesh.FindEdge(i, mesh.ringNext[i], &k);
+		if (t < 0) return true;
+		if (newIndex[t] < 0) {newIndex[t] = numInside++; queue.push_back(t);}
+	}
+	while (!queue.empty()) {
+		t = queue.back(); queue.pop_back();
+		for (k = 0; k < 3; k++) {
+			if (mesh.tv[3*t+k] >= nv) return true;	// reached the enclosing triangle, a boundary is backwards
+			long o = mesh.tn[3*t+k];
+			if (o < 0 || newIndex[o] >= 0) continue;
+			if (mesh.IsConstrained(mesh.tv[3*t+(k+1)%3], mesh.tv[3*t+(k+2)%3])) continue;
+			newIndex[o] = numInside++;
+			queue.push_back(o);
+		}
+	}
+
+	if (!(topo = (TopologyHdl)_NewHandleClear(numInside * sizeof(Topology)))) {
+		printError("Not enough memory to generate triangles.");
+		return true;
+	}
+	for (t = 0; t < numTri; t++) {
+		long n = newIndex[t];
+		if (n < 0) continue;
+		(*topo)[n].vertex1 = mesh.tv[3*t];
+		(*topo)[n].vertex2 = mesh.tv[3*t+1];
+		(*topo)[n].vertex3 = mesh.tv[3*t+2];
+		(*topo)[n].adjTri1 = mesh.tn[3*t] >= 0 ? newIndex[mesh.tn[3*t]] : -1;
+		(*topo)[n].adjTri2 = mesh.tn[3*t+1] >= 0 ? newIndex[mesh.tn[3*t+1]] : -1;
+		(*topo)[n].adjTri3 = mesh.tn[3*t+2] >= 0 ? newIndex[mesh.tn[3*t+2]] : -1;
+	}
+	*topoHdl = topo;
+
+	return false;
+}
@@ -21,6 +21,9 @@ double *gTrival=0;
 
 #define SF 30000
 
+// grids this size or larger go through maketrianglesDelaunay first
+#define kMinDelaunayVertices 2000
+
 Boolean CROSS(long x1,long y1,long x2,long y2,long x3,long y3,long x4,long y4)
 {
 	long p1Left,p2Left,p3Left,p4Left;
@@ -349,6 +352,10 @@ Boolean maketriangles(TopologyHdl *topoHdl, LongPointHdl ptsH, long nv, LONGH bo
 	//Rect r=MapDrawingRect();
 	TopologyHdl tempTopoHdl = 0;
 
+	// the sweep below is quadratic in nv, fall back to it only if the boundaries trip up the other one
+	if (nv >= kMinDelaunayVertices && !maketrianglesDelaunay(topoHdl, ptsH, nv, boundarySegs, nbounds))
+		return false;
+
 	//long nbounds = GetNumBoundaries();	// defined in Topology.c
 	/*if(!(p =(long *) _NewPtrClear(sizeof(long)*nv)))goto errRecovery;
 	if(!(l = (MySegment *)_NewPtr(8*nv *sizeof(MySegment))))goto errRecovery;
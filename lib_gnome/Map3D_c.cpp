@@ -11,6 +11,7 @@
 #include "Map3D.h"
 #include "CurrentMover_c.h"
 #include "MemUtils.h"
+#include "BoundarySegIndex.h"
 #include "StringFunctions.h"
 #include "CompFunctions.h"
 
@@ -57,6 +58,7 @@ Map3D_c::Map3D_c(char* name, WorldRect bounds) : Map_c(name, bounds)
 	fBoundarySegmentsH = 0;
 	fBoundaryTypeH = 0;
 	fBoundaryPointsH = 0;
+	fSegIndex = 0;
 
 	//bDrawLandBitMap = false;	// combined option for now
 	//bDrawWaterBitMap = false;
@@ -104,6 +106,11 @@ long Map3D_c::PointOnWhichSeg(long longVal, long latVal, long *startver, long *e
 	dLong = dLat = oneSecond * 50;
 	*distToSeg = -1;
 	
+	// the segments near the point, from the index of the boundary
+	if (!fSegIndex) fSegIndex = new BoundarySegIndex;
+	if (fSegIndex && fSegIndex->Prepare(fBoundarySegmentsH, fBoundaryPointsH, ptsHdl, dLong, dLat) == noErr)
+		return fSegIndex->PointOnWhichSeg(longVal, latVal, startver, endver, distToSeg);
+	
 	// to support new curvilinear algorithm
 	if (fBoundaryPointsH)
 	{
@@ -30,6 +30,8 @@
 #include "GridVel.h"
 #endif
 
+class BoundarySegIndex;
+
 class Map3D_c : virtual public Map_c
 {
 	
@@ -39,6 +41,7 @@ public:
 	LONGH			fBoundarySegmentsH;
 	LONGH			fBoundaryTypeH;		// 1 land, 2 water
 	LONGH			fBoundaryPointsH;	// for curvilinear grids
+	BoundarySegIndex	*fSegIndex;		// the boundary segments near a point, built by PointOnWhichSeg
 
 	//Boolean			bDrawLandBitMap;
 	//Boolean			bDrawWaterBitMap;
@@ -9,6 +9,18 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "MemUtils.h"
+#include "GnomeThreads.h"
+
+#include <string>
+#include <algorithm>
+#ifndef IBM
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 
 #ifndef hubris
@@ -32,10 +44,488 @@ OSErr DeleteHandleItem(CHARH h, long i, long size)
 /////////// UNIVERSAL MEMORY UTILS
 
 long _handleCount = 0;
-static long masterPointerCount = 0;
-static OSErr memoryError = 0;
-static Ptr *masterPointers = 0;
-static Handle freeMasterPointers[10];
+static GNOME_THREAD_LOCAL OSErr memoryError = 0;	// of the last call on this thread
+
+// master pointers come in chunks that never move, so a Handle stays valid,
+// the free ones are kept on a stack
+#define kNumMasterPointers 6000 // was 1000 , JLM 6/8/10
+static std::vector<Ptr *> masterPointerChunks;
+static std::vector<Handle> freeMasterPointers;
+
+// the master pointer table is shared with the background prefetch threads
+// and the movers running without the GIL
+static GnomeMutex &HandleMutex()
+{
+	static GnomeMutex *handleMutex = new GnomeMutex;	// never deleted, handles are still freed at exit
+	return *handleMutex;
+}
+#define LOCK_HANDLES GnomeLock handleLock(HandleMutex())
+
+// every block starts with this, the data follows it
+// size must be last, _GetPtrSize reads the long just before the data
+typedef struct {
+	HandleAllocator	*allocator;	// the one to free it with
+	Handle			owner;		// the master pointer, 0 for a plain pointer
+	long			tag;		// what it is counted under
+	long			capacity;	// usable bytes after the header
+	long			size;
+} BlockHeader;
+
+static BlockHeader *GetBlockHeader(Ptr p)
+{
+	return (BlockHeader *)(p - sizeof(BlockHeader));
+}
+
+/////////// MEMORY ACCOUNTING
+
+static const char *memoryTagNames[kNumMemoryTags] = {"other", "time_slices", "topology", "dag_tree", "uncertainty", "tide_tables"};
+static MemoryUsage memoryUsage[kNumMemoryTags + 1];	// the last is the totals
+
+static GNOME_THREAD_LOCAL short currentTag = kMemOther;
+
+short SetMemoryTag(short tag)
+{
+	short previous = currentTag;
+
+	currentTag = tag >= 0 && tag < kNumMemoryTags ? tag : kMemOther;
+	return previous;
+}
+
+static void CountBlock(long tag, int64_t bytes, int64_t numBlocks)
+{
+	MemoryUsage *usage[2] = {&memoryUsage[tag], &memoryUsage[kNumMemoryTags]};
+
+	for (long i = 0; i < 2; i++) {
+		usage[i]->bytes += bytes;
+		usage[i]->numBlocks += numBlocks;
+		if (usage[i]->bytes > usage[i]->peakBytes)
+			usage[i]->peakBytes = usage[i]->bytes;
+	}
+}
+
+void GetMemoryUsage(short tag, MemoryUsage *usage)
+{
+	LOCK_HANDLES;
+	if (tag < 0 || tag > kNumMemoryTags)
+		tag = kNumMemoryTags;
+	*usage = memoryUsage[tag];
+}
+
+const char *GetMemoryTagName(short tag)
+{
+	return tag >= 0 && tag < kNumMemoryTags ? memoryTagNames[tag] : "total";
+}
+
+void ResetMemoryPeaks()
+{
+	LOCK_HANDLES;
+	for (long i = 0; i <= kNumMemoryTags; i++)
+		memoryUsage[i].peakBytes = memoryUsage[i].bytes;
+}
+
+/////////// BLOCK ALLOCATORS
+
+// new/delete, what every block used before the pools
+class DefaultAllocator : public HandleAllocator {
+public:
+	virtual void *Allocate(long numBytes, long *capacity)
+	{
+		try {
+			*capacity = numBytes;
+			return new char[numBytes];
+		}
+		catch(...) {
+			return 0;
+		}
+	}
+	virtual void Free(void *block, long capacity)
+	{
+		delete[] (char *)block;
+	}
+};
+
+// size classes of 32 bytes to 64K carved from slabs, a freed block goes on
+// its class's free list for the next one that size, larger blocks use new/delete
+#define kMinClassShift		5
+#define kNumSizeClasses		12
+#define kMaxPooledBlock		(1L << (kMinClassShift + kNumSizeClasses - 1))
+#define kSlabSize			(256L * 1024)
+
+class HandlePool : public HandleAllocator {
+public:
+	HandlePool() : numBlocks(0), releaseWhenEmpty(false)
+	{
+		for (long i = 0; i < kNumSizeClasses; i++)
+			freeBlocks[i] = 0;
+	}
+	virtual ~HandlePool()
+	{
+		for (long i = 0; i < (long)slabs.size(); i++)
+			delete[] slabs[i];
+	}
+
+	virtual void *Allocate(long numBytes, long *capacity)
+	{
+		long sizeClass = 0;
+		void *block;
+
+		if (numBytes > kMaxPooledBlock)
+			return largeBlocks.Allocate(numBytes, capacity);
+
+		while ((1L << (kMinClassShift + sizeClass)) < numBytes)
+			sizeClass++;
+		if (!freeBlocks[sizeClass] && !AddSlab(sizeClass))
+			return 0;
+
+		block = freeBlocks[sizeClass];
+		freeBlocks[sizeClass] = *(void **)block;
+		*capacity = 1L << (kMinClassShift + sizeClass);
+		numBlocks++;
+		return block;
+	}
+
+	virtual void Free(void *block, long capacity)
+	{
+		long sizeClass = 0;
+
+		if (capacity > kMaxPooledBlock) {
+			largeBlocks.Free(block, capacity);
+			return;
+		}
+
+		while ((1L << (kMinClassShift + sizeClass)) < capacity)
+			sizeClass++;
+		*(void **)block = freeBlocks[sizeClass];
+		freeBlocks[sizeClass] = block;
+		numBlocks--;
+		if (releaseWhenEmpty && numBlocks == 0)
+			delete this;
+	}
+
+	// for an arena, the slabs go once the last block is freed
+	void ReleaseWhenEmpty()
+	{
+		releaseWhenEmpty = true;
+		if (numBlocks == 0)
+			delete this;
+	}
+
+protected:
+	Boolean AddSlab(long sizeClass)
+	{
+		long blockSize = 1L << (kMinClassShift + sizeClass);
+		long slabSize = blockSize > kSlabSize / 4 ? blockSize * 4 : kSlabSize;
+		char *slab;
+
+		try {
+			slab = new char[slabSize];
+			slabs.push_back(slab);
+		}
+		catch(...) {
+			return false;
+		}
+
+		// the lowest block ends up first on the list
+		for (long offset = slabSize - blockSize; offset >= 0; offset -= blockSize) {
+			*(void **)(slab + offset) = freeBlocks[sizeClass];
+			freeBlocks[sizeClass] = slab + offset;
+		}
+		return true;
+	}
+
+	DefaultAllocator	largeBlocks;
+	std::vector<char *>	slabs;
+	void				*freeBlocks[kNumSizeClasses];	// each block holds the next one
+	long				numBlocks;
+	Boolean				releaseWhenEmpty;
+};
+
+#ifdef __linux__
+#define kMPolInterleave		3	// MPOL_INTERLEAVE of <numaif.h>
+#define kHugePageSize		(1L << 21)
+
+// whole pages of their own from mmap: bound to be interleaved over the
+// nodes of nodeMask (0 for none) before anything touches them, and huge
+// pages for hugePages. A huge page block is aligned to them, they are
+// 2MB on every cpu lib_gnome runs on
+class PageAllocator : public HandleAllocator {
+public:
+	PageAllocator(unsigned long nodeMask, short hugePages) : nodeMask(nodeMask), hugePages(hugePages) {}
+
+	virtual void *Allocate(long numBytes, long *capacity)
+	{
+		long pageSize = hugePages != kHugePagesOff ? kHugePageSize : sysconf(_SC_PAGESIZE);
+		long length = (numBytes + pageSize - 1) / pageSize * pageSize;
+		void *block = MAP_FAILED;
+
+		if (hugePages == kHugePagesExplicit)
+			block = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (block == MAP_FAILED && hugePages != kHugePagesOff) {
+			// room to align, the ends are unmapped
+			char *base = (char *)mmap(0, length + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+			if (base == MAP_FAILED)
+				return 0;
+			char *aligned = (char *)(((size_t)base + kHugePageSize - 1) & ~(size_t)(kHugePageSize - 1));
+			if (aligned > base)
+				munmap(base, aligned - base);
+			munmap(aligned + length, base + kHugePageSize - aligned);
+			madvise(aligned, length, MADV_HUGEPAGE);	// ignored without transparent huge pages
+			block = aligned;
+		}
+		else if (block == MAP_FAILED) {
+			block = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (block == MAP_FAILED)
+				return 0;
+		}
+
+		// if it fails the pages are placed as usual
+		if (nodeMask)
+			syscall(SYS_mbind, block, length, kMPolInterleave, &nodeMask, sizeof(nodeMask) * 8, 0);
+		*capacity = length;
+		return block;
+	}
+	virtual void Free(void *block, long capacity)
+	{
+		munmap(block, capacity);
+	}
+
+private:
+	unsigned long nodeMask;
+	short hugePages;
+};
+
+// by interleaved and huge page mode, made when first used, they live as
+// long as the process
+static PageAllocator *pageAllocators[2][kHugePagesExplicit + 1];
+static unsigned long sliceNodeMask = 0;
+
+static HandleAllocator *GetPageAllocator(Boolean interleave, short hugePages)
+{
+	if (!pageAllocators[interleave][hugePages])
+		pageAllocators[interleave][hugePages] = new PageAllocator(interleave ? sliceNodeMask : 0, hugePages);
+	return pageAllocators[interleave][hugePages];
+}
+
+static Boolean IsPageAllocator(HandleAllocator *allocator)
+{
+	for (long i = 0; i < 2; i++)
+		for (long j = 0; j <= kHugePagesExplicit; j++)
+			if (pageAllocators[i][j] && allocator == pageAllocators[i][j])
+				return true;
+	return false;
+}
+#else
+static Boolean IsPageAllocator(HandleAllocator *allocator)
+{
+	return false;
+}
+#endif
+
+static DefaultAllocator defaultAllocator;
+static Boolean interleaveSlices = false;
+static short hugePageMode = kHugePagesOff;
+static long hugePageTags = 0;
+static HandlePool *sharedPool = 0;
+static HandlePool *arena = 0;
+static HandleAllocator *currentAllocator = &defaultAllocator;
+static HandleAllocator *allocatorBeforeArena = 0;
+
+void SetHandleAllocator(HandleAllocator *allocator)
+{
+	LOCK_HANDLES;
+	currentAllocator = allocator ? allocator : &defaultAllocator;
+}
+
+HandleAllocator *GetHandleAllocator()
+{
+	return currentAllocator;
+}
+
+void SetHandlePooling(Boolean usePools)
+{
+	LOCK_HANDLES;
+	if (usePools && !sharedPool)
+		sharedPool = new HandlePool;	// lives as long as the process, blocks may still be in use
+	SetHandleAllocator(usePools ? sharedPool : 0);
+}
+
+Boolean GetHandlePooling()
+{
+	return sharedPool && currentAllocator == sharedPool;
+}
+
+void BeginHandleArena()
+{
+	LOCK_HANDLES;
+	if (arena)
+		return;
+	allocatorBeforeArena = currentAllocator;
+	arena = new HandlePool;
+	currentAllocator = arena;
+}
+
+void EndHandleArena()
+{
+	LOCK_HANDLES;
+	if (!arena)
+		return;
+	if (currentAllocator == arena)
+		currentAllocator = allocatorBeforeArena;
+	arena->ReleaseWhenEmpty();
+	arena = 0;
+}
+
+// the disposed time slice blocks kept by SetTimeSliceRecycling(), still
+// counted under time_slices. Only those of the allocators that live as long
+// as the process, an arena may be gone by the time one is used again
+#define kMaxSpareSlices		4
+static Boolean recycleSlices = false;
+static std::vector<BlockHeader *> spareSlices;
+
+static Boolean CanRecycle(BlockHeader *header)
+{
+	return recycleSlices && header->tag == kMemTimeSlices && header->capacity > kMaxPooledBlock &&
+		(header->allocator == &defaultAllocator || header->allocator == sharedPool ||
+		 IsPageAllocator(header->allocator));
+}
+
+// a spare slice with room for size bytes that doesn't waste more than an eighth of it
+static BlockHeader *TakeSpareSlice(long size)
+{
+	for (long i = 0; i < (long)spareSlices.size(); i++) {
+		BlockHeader *header = spareSlices[i];
+
+		if (header->capacity >= size && header->capacity - size <= header->capacity / 8) {
+			spareSlices.erase(spareSlices.begin() + i);
+			return header;
+		}
+	}
+	return 0;
+}
+
+void SetTimeSliceRecycling(Boolean recycle)
+{
+	LOCK_HANDLES;
+	recycleSlices = recycle;
+	if (recycle)
+		return;
+	for (long i = 0; i < (long)spareSlices.size(); i++) {
+		long capacity = spareSlices[i]->capacity + sizeof(BlockHeader);
+
+		CountBlock(spareSlices[i]->tag, -capacity, -1);
+		spareSlices[i]->allocator->Free(spareSlices[i], capacity);
+	}
+	spareSlices.clear();
+}
+
+Boolean GetTimeSliceRecycling()
+{
+	return recycleSlices;
+}
+
+Boolean SetTimeSliceInterleaving(Boolean interleave)
+{
+	LOCK_HANDLES;
+#ifdef __linux__
+	if (interleave && !sliceNodeMask) {
+		std::vector<int> nodes;
+
+		GetNumaNodes(nodes);
+		if (nodes.size() > 1)
+			for (long i = 0; i < (long)nodes.size(); i++)
+				if (nodes[i] < (int)sizeof(sliceNodeMask) * 8 - 1)
+					sliceNodeMask |= 1UL << nodes[i];
+	}
+	interleaveSlices = interleave && sliceNodeMask;
+#else
+	interleaveSlices = false;
+#endif
+	return interleaveSlices;
+}
+
+Boolean GetTimeSliceInterleaving()
+{
+	return interleaveSlices;
+}
+
+Boolean SetHugePages(short mode, long tagMask)
+{
+	LOCK_HANDLES;
+#ifdef __linux__
+	if (mode < kHugePagesOff || mode > kHugePagesExplicit || !tagMask)
+		mode = kHugePagesOff;
+#else
+	mode = kHugePagesOff;
+#endif
+	hugePageMode = mode;
+	hugePageTags = mode != kHugePagesOff ? tagMask : 0;
+	return hugePageMode != kHugePagesOff;
+}
+
+short GetHugePages(long *tagMask)
+{
+	if (tagMask)
+		*tagMask = hugePageTags;
+	return hugePageMode;
+}
+
+#ifndef IBM
+// the names of the segments this process made and hasn't removed yet
+static std::vector<std::string> segmentNames;
+static pid_t segmentNamesPid = 0;
+
+static void RemoveSegmentNames()
+{
+	// a forked process has its parent's list, the names are the parent's
+	if (getpid() != segmentNamesPid)
+		return;
+	for (long i = 0; i < (long)segmentNames.size(); i++)
+		shm_unlink(segmentNames[i].c_str());
+	segmentNames.clear();
+}
+
+// a named shared memory segment of ShareHandleBlocks(), its blocks packed
+// one after another. It makes none, and it's unmapped when the last one
+// is freed -- its name removed then too by the process that made it
+class SharedSegment : public HandleAllocator {
+public:
+	SharedSegment(const char *name, void *base, size_t length, long numBlocks) :
+		name(name), base(base), length(length), numBlocks(numBlocks), creatorPid(getpid()) {}
+
+	virtual void *Allocate(long numBytes, long *capacity)
+	{
+		return 0;
+	}
+	virtual void Free(void *block, long capacity)
+	{
+		if (--numBlocks > 0)
+			return;
+		munmap(base, length);
+		if (creatorPid == getpid()) {
+			shm_unlink(name.c_str());
+			segmentNames.erase(std::remove(segmentNames.begin(), segmentNames.end(), name), segmentNames.end());
+		}
+		delete this;
+	}
+	virtual Boolean Shared() { return true; }
+
+private:
+	std::string name;
+	void *base;
+	size_t length;
+	long numBlocks;
+	pid_t creatorPid;
+};
+
+// the room of a block in a segment, header and data, keeping the data
+// aligned the way new[] does
+static long SharedBlockLength(long size)
+{
+	return (sizeof(BlockHeader) + size + 15) & ~15L;
+}
+#endif
+
 
 
 
@@ -54,45 +544,169 @@ Handle _MySetHandleSize(Handle h, long newSize)
 
 OSErr _InitAllHandles()
 {
-	long kNumToAllocate = 6000; // was 1000 , JLM 6/8/10
+	LOCK_HANDLES;
+	Ptr *masterPointers;
 
-	if ((masterPointers = (Ptr *)_NewPtr(kNumToAllocate * sizeof(Ptr))) == NULL)
+	try {
+		masterPointers = new Ptr[kNumMasterPointers]();
+		masterPointerChunks.push_back(masterPointers);
+		freeMasterPointers.reserve(freeMasterPointers.size() + kNumMasterPointers);
+	}
+	catch(...) {
 		return -1;
+	}
 
-	for (long i = 0; i < kNumToAllocate; i++)
-		masterPointers[i] = 0;
-
-	for (long i = 0; i < 10 ;i++)
-		freeMasterPointers[i] = &masterPointers[i];
-
-	masterPointerCount = kNumToAllocate;
+	// the lowest address gets used first
+	for (long i = kNumMasterPointers - 1; i >= 0; i--)
+		freeMasterPointers.push_back(&masterPointers[i]);
 
 	return 0;
 }
 
 void _DeleteAllHandles()
 {
-	//delete[] masterPointers;
-	_DisposePtr((Ptr)masterPointers);
+	LOCK_HANDLES;
+	for (long i = 0; i < (long)masterPointerChunks.size(); i++)
+		delete[] masterPointerChunks[i];
+	masterPointerChunks.clear();
+	freeMasterPointers.clear();
+}
+
+static Ptr NewBlock(long size, Handle owner, long tag)
+{
+	HandleAllocator *allocator = currentAllocator;
+	BlockHeader *header;
+	long capacity;
+
+	if (tag == kMemTimeSlices && !spareSlices.empty() && (header = TakeSpareSlice(size))) {
+		header->owner = owner;
+		header->size = size;
+		return (Ptr)(header + 1);	// it was never uncounted
+	}
+
+#ifdef __linux__
+	Boolean interleave = tag == kMemTimeSlices && interleaveSlices && size > kMaxPooledBlock;
+	short hugePages = (hugePageTags & (1L << tag)) && size >= kMinHugePageBlock ? hugePageMode : kHugePagesOff;
+
+	if (interleave || hugePages != kHugePagesOff)
+		allocator = GetPageAllocator(interleave, hugePages);
+#endif
+
+	if (!(header = (BlockHeader *)allocator->Allocate(size + sizeof(BlockHeader), &capacity)))
+		return 0;
+
+	header->allocator = allocator;
+	header->owner = owner;
+	header->tag = tag;
+	header->capacity = capacity - sizeof(BlockHeader);
+	header->size = size;
+	CountBlock(tag, capacity, 1);
+
+	return (Ptr)(header + 1);
+}
+
+static void FreeBlock(Ptr p)
+{
+	BlockHeader *header = GetBlockHeader(p);
+	long capacity = header->capacity + sizeof(BlockHeader);
+
+	if (CanRecycle(header) && (long)spareSlices.size() < kMaxSpareSlices) {
+		spareSlices.push_back(header);
+		return;
+	}
+
+	CountBlock(header->tag, -capacity, -1);
+	header->allocator->Free(header, capacity);
+}
+
+int64_t ShareHandleBlocks(const char *segmentName, long tagMask, Boolean readOnly)
+{
+#ifdef IBM
+	return -1;
+#else
+	LOCK_HANDLES;
+	std::vector<Handle> handles;
+	size_t length = 0;
+
+	for (long i = 0; i < (long)masterPointerChunks.size(); i++) {
+		for (long j = 0; j < kNumMasterPointers; j++) {
+			Handle h = &masterPointerChunks[i][j];
+			BlockHeader *header;
+
+			if ((size_t)*h <= sizeof(BlockHeader))
+				continue;	// a free master pointer
+			header = GetBlockHeader(*h);
+			if (header->owner != h || !(tagMask & (1L << header->tag)) || header->allocator->Shared())
+				continue;
+			handles.push_back(h);
+			length += SharedBlockLength(header->size);
+		}
+	}
+
+	if (handles.empty())
+		return 0;
+
+	int fd = shm_open(segmentName, O_CREAT | O_EXCL | O_RDWR, 0600);
+	void *base = MAP_FAILED;
+
+	if (fd < 0)
+		return -1;
+	if (ftruncate(fd, length) == 0)
+		base = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);	// the mapping keeps the segment
+	if (base == MAP_FAILED) {
+		shm_unlink(segmentName);
+		return -1;
+	}
+
+	if (segmentNamesPid != getpid()) {
+		if (!segmentNamesPid)
+			atexit(RemoveSegmentNames);
+		segmentNames.clear();
+		segmentNamesPid = getpid();
+	}
+	segmentNames.push_back(segmentName);
+
+	SharedSegment *segment = new SharedSegment(segmentName, base, length, handles.size());
+	char *next = (char *)base;
+
+	// the handles keep their master pointers, only the blocks move
+	for (long i = 0; i < (long)handles.size(); i++) {
+		Ptr p = *handles[i];
+		BlockHeader *header = GetBlockHeader(p), *shared = (BlockHeader *)next;
+		long blockLength = SharedBlockLength(header->size);
+
+		shared->allocator = segment;
+		shared->owner = handles[i];
+		shared->tag = header->tag;
+		shared->capacity = blockLength - sizeof(BlockHeader);
+		shared->size = header->size;
+		memcpy(shared + 1, p, header->size);
+		CountBlock(header->tag, blockLength, 1);
+
+		FreeBlock(p);
+		*handles[i] = (Ptr)(shared + 1);
+		next += blockLength;
+	}
+
+	if (readOnly)
+		mprotect(base, length, PROT_READ);
+
+	return length;
+#endif
 }
 
 Ptr _NewPtr(long size)
 {
+	LOCK_HANDLES;
 	memoryError = 0;
 	Ptr p;
 
-	try {
-		p = new char[size + sizeof(long)]();
-	}
-	catch(...) {
+	if (!(p = NewBlock(size, 0, currentTag))) {
 		memoryError = -1; 
 		return 0; 
 	}
 
-	((long *)p)[0] = size;
-
-	p += sizeof(long);
-
 	memset(p, 0, size);
 
 	_handleCount++;
@@ -115,7 +729,7 @@ long _GetPtrSize(Ptr p)
 // these memory pointers are managed as
 // a (sort of)struct of the type
 //    struct Data {
-//	    long size;
+//	    BlockHeader header;
 //	    char data[];
 //    };
 // and this function manages the resizing of
@@ -123,49 +737,56 @@ long _GetPtrSize(Ptr p)
 // size.
 //
 // Basically any pointer p passed in is assumed to
-// be immediately preceded in memory by a long
-// value representing the size of allocated memory.
+// be immediately preceded in memory by a BlockHeader
+// whose last field is the size of allocated memory.
+//
+// The block is kept if the new size fits and uses at least half of it,
+// otherwise the data moves to a new block. Any new bytes are zeroed.
 Ptr _SetPtrSize(Ptr p, long newSize)
 {
+	LOCK_HANDLES;
 	Ptr p2 = 0;
 	memoryError = 0;
 
-	if (p > (Ptr)sizeof(long)) {
+	if (p > (Ptr)sizeof(BlockHeader)) {
 		// we have a valid buffer coming in
-		try {
-			long *currentSize = (long *)(p - sizeof(long));
-
-			p2 = new char[newSize + sizeof(long)]();
-
-			((long *)p2)[0] = newSize;
-
-			if (newSize < currentSize[0])
-				memmove(p2 + sizeof(long), p, newSize);
-			else
-				memmove(p2 + sizeof(long), p, *currentSize);
+		BlockHeader *header = GetBlockHeader(p);
+		long currentSize = header->size;
 
-			// this seems a bit brittle, but...ok.
-			p -= sizeof(long);
-			delete[] p;
+		if (newSize <= header->capacity && newSize >= header->capacity / 2 && !header->allocator->Shared()) {
+			if (newSize > currentSize)
+				memset(p + currentSize, 0, newSize - currentSize);
+			header->size = newSize;
+			return p;
 		}
-		catch(...) {
+
+		if (!(p2 = NewBlock(newSize, header->owner, header->tag))) {
 			memoryError = -1;
 			return p;
 		}
+
+		if (newSize < currentSize)
+			memmove(p2, p, newSize);
+		else {
+			memmove(p2, p, currentSize);
+			memset(p2 + currentSize, 0, newSize - currentSize);
+		}
+
+		FreeBlock(p);
 	}
 	else {
 		memoryError = -1;
 		return p;
 	}
 
-	return (p2 + sizeof(long));
+	return p2;
 }
 
 void _DisposePtr(Ptr p)
 {
-	if ((size_t)p > sizeof(long)) {
-		p -= sizeof(long);
-		delete[] p;
+	LOCK_HANDLES;
+	if ((size_t)p > sizeof(BlockHeader)) {
+		FreeBlock(p);
 		_handleCount--;
 	}
 	else {
@@ -180,62 +801,22 @@ void _DisposPtr(Ptr p)
 
 Handle _NewHandle(long size)
 {
+	LOCK_HANDLES;
 	Ptr p;
 	Handle h = 0;
 	
-	// look for a free space
-	for (long i = 0; i < 10; i++)
-		if (freeMasterPointers[i] != 0) {
-			// freeMasterPointers holds the easy places to look
-			h = freeMasterPointers[i];
-			break;
-		} // we found an easy one
-
-
-	if (!h) {
-		// did not find a free place for our handle
-		// we need to reset the freeMasterPointers
-		for (long i = 0, j = 0 ; i < masterPointerCount ; i++)
-			if (masterPointers[i] == 0) {
-				// we found a free unused place
-				if (!h)
-					h = &masterPointers[i];
-
-				if (j < 10)
-					freeMasterPointers[j++] = &masterPointers[i];
-				else
-					break;// we have found all ten
-			}
-
-		if (!h) {
-			// JLM 6/8/10, the InitWindowsHandles below will loose track of hte previously allocated "Handles".
-			// as a work around to help avoid this, I've increase the number allocated in InitWindowsHandles 
-			_InitAllHandles();
-			h = &masterPointers[0];
-			// code goes here, JLM 3/30/99, why was this code was commented out ?
-			// Note: This code is still in TAT
-			/*
-			 masterPointers = (Ptr *)Win_SetPtrSize(masterPointers, (masterPointerCount + 1000) * sizeof(Ptr));
-			 if (memoryError) return 0;
-			 for (i = 0 ; i < 10 ; i++)
-			 freeMasterPointers[i] = &masterPointers[masterPointerCount + i];
-			 h = &masterPointers[masterPointerCount];
-			 masterPointerCount += 1000;
-			 */
-		}
+	if (freeMasterPointers.empty() && _InitAllHandles()) {
+		memoryError = -1;
+		return 0;
 	}
+	h = freeMasterPointers.back();
 
-	// we have found all ten
 	if (!(p = _NewPtr(size)))
 		return 0; // unable to allocate
 
+	GetBlockHeader(p)->owner = h;
 	(*h) = p; // record the pointer in the MAC-like "Handle"
-
-	for (long i = 0; i < 10; i++)
-		if (freeMasterPointers[i] == h) {
-			freeMasterPointers[i] = 0; // mark this place as no longer free
-			break;
-		}
+	freeMasterPointers.pop_back(); // no longer free
 
 	return h;
 }
@@ -259,13 +840,14 @@ Handle _TempNewHandle(long size, LONGPTR err)
 
 Handle _RecoverHandle(Ptr p)
 {
-	long i;
+	LOCK_HANDLES;
+	Handle h;
 	
 	memoryError = 0;
 	
-	for (i = 0 ; i < masterPointerCount ; i++)
-		if (masterPointers[i] == p)
-			return &masterPointers[i];
+	// the block knows its master pointer
+	if ((size_t)p > sizeof(BlockHeader) && (h = GetBlockHeader(p)->owner) && *h == p)
+		return h;
 	
 	memoryError = -1;
 	
@@ -304,6 +886,22 @@ void _SetHandleSize(Handle h, long newSize)
 	(*h) = _SetPtrSize(*h, newSize);
 }
 
+void _GrowHandleSize(Handle h, long newSize)
+{
+	LOCK_HANDLES;
+	Ptr p = *h;
+
+	if (p > (Ptr)sizeof(BlockHeader)) {
+		BlockHeader *header = GetBlockHeader(p);
+
+		// the second resize is at least half the room so it stays put
+		if (newSize > header->capacity && newSize < 2 * header->size)
+			p = _SetPtrSize(p, 2 * header->size);
+	}
+
+	(*h) = _SetPtrSize(p, newSize);
+}
+
 long _GetHandleSize(Handle h)
 {
 	return _GetPtrSize(*h);
@@ -311,15 +909,16 @@ long _GetHandleSize(Handle h)
 
 void _DisposeHandleReally(Handle h)
 {
-	short i;
+	LOCK_HANDLES;
+	Ptr p = *h;
 	
-	_DisposePtr(*h);
+	_DisposePtr(p);
 	
 	*h = 0;
 	
-	for (i = 0 ; i < 10 ; i++)
-		if (freeMasterPointers[i] == 0)
-		{ freeMasterPointers[i] = h; break; }
+	// a handle disposed twice must not go on the free list twice
+	if ((size_t)p > sizeof(BlockHeader))
+		freeMasterPointers.push_back(h);
 }
 
 void _DisposeHandle2(HANDLEPTR hp)
@@ -20,13 +20,92 @@
 #endif
 #endif
 
+// what blocks are for, so the memory held can be reported by subsystem
+enum { kMemOther = 0, kMemTimeSlices, kMemTopology, kMemDagTree, kMemUncertainty, kMemTideTables, kNumMemoryTags };
+
 // If either pyGNOME or IBM is defined:
 
 #ifndef hubris
 
+// Where the handle and pointer blocks come from. Each block is freed by the
+// allocator that made it, so the current one can be changed at any time.
+class HandleAllocator {
+public:
+	virtual			~HandleAllocator() {}
+	// capacity is set to the usable bytes, at least numBytes
+	virtual void	*Allocate(long numBytes, long *capacity) = 0;
+	virtual void	Free(void *block, long capacity) = 0;
+	// blocks of a shared memory segment are never resized in place
+	virtual Boolean	Shared() { return false; }
+};
+
+// 0 goes back to new/delete
+void SetHandleAllocator(HandleAllocator *allocator);
+HandleAllocator *GetHandleAllocator();
+
+// new blocks come from shared size class pools instead of new/delete
+void DLL_API SetHandlePooling(Boolean usePools);
+Boolean DLL_API GetHandlePooling();
+
+// new blocks come from an arena until it ends (say for one model run),
+// its memory goes in one go once the last of its blocks is disposed
+void DLL_API BeginHandleArena();
+void DLL_API EndHandleArena();
+
+// the big time slice blocks that are disposed are kept for the next slice
+// that fits them instead of going back to the allocator, so the slice that
+// leaves an interval becomes the slice that comes in. False frees them
+void DLL_API SetTimeSliceRecycling(Boolean recycle);
+Boolean DLL_API GetTimeSliceRecycling();
+
+// the big time slice blocks get pages interleaved over the NUMA nodes,
+// placed before the reading thread first touches them, so the get_move
+// threads of every node read them at the same speed instead of the far
+// node's threads reading the reader's node. Returns whether new slices are
+// interleaved: false on a one node machine or without Linux's mbind, they
+// are plain blocks then. The blocks made before stay where they are
+Boolean DLL_API SetTimeSliceInterleaving(Boolean interleave);
+Boolean DLL_API GetTimeSliceInterleaving();
+
+// the blocks of at least kMinHugePageBlock bytes counted under the tags in
+// tagMask (bit 1 << tag for each tag) get huge pages, so the point location
+// and interpolation over the points, triangles, DAG and velocities of a big
+// grid miss the TLB less: kHugePagesTransparent asks the kernel for
+// transparent huge pages, kHugePagesExplicit maps them from the reserved
+// pool, or asks for transparent ones when the pool is out. Returns whether
+// new blocks get them: false for kHugePagesOff or without Linux. The
+// blocks made before stay as they are
+enum { kHugePagesOff = 0, kHugePagesTransparent, kHugePagesExplicit };
+#define kMinHugePageBlock	(1L << 21)
+Boolean DLL_API SetHugePages(short mode, long tagMask);
+short DLL_API GetHugePages(long *tagMask);
+
+// moves the blocks of the handles counted under the tags in tagMask (bit
+// 1 << tag for each tag) to the named POSIX shared memory segment
+// segmentName, so the processes forked after this map one copy of them,
+// which is never copied on write. With readOnly the segment is mapped read
+// only, so the blocks must not be written (resizing one moves it out).
+// Returns the bytes moved, 0 if there were none, -1 if it failed or there
+// is no POSIX shared memory (Windows)
+int64_t DLL_API ShareHandleBlocks(const char *segmentName, long tagMask, Boolean readOnly);
+
 OSErr _InitAllHandles();
 void _DeleteAllHandles();
 
+typedef struct {
+	int64_t	bytes;		// held by the blocks, headers included
+	int64_t	peakBytes;
+	int64_t	numBlocks;
+} MemoryUsage;
+
+// new blocks are counted under tag until it is set again (per thread), returns the old tag
+short SetMemoryTag(short tag);
+// tag kNumMemoryTags gives the totals
+void DLL_API GetMemoryUsage(short tag, MemoryUsage *usage);
+DLL_API const char *GetMemoryTagName(short tag);
+// peaks start again from what is held now
+void DLL_API ResetMemoryPeaks();
+
 Ptr _NewPtr(long size);
 Ptr _NewPtrClear(long size);
 long _GetPtrSize(Ptr p);
@@ -42,6 +121,9 @@ void _HLock(Handle h);
 void _HUnlock(Handle h);
 DLL_API long _GetHandleSize(Handle h);
 void _SetHandleSize(Handle h, long newSize);
+// like _SetHandleSize, but a block that has to move gets room to double,
+// so a handle grown a little at a time is not copied each time
+void _GrowHandleSize(Handle h, long newSize);
 
 //Handle RecoverHandle(Ptr p);
 
@@ -80,6 +162,7 @@ void _DisposeHandleReally(Handle p);
 #define _HUnlock HUnlock
 #define _GetHandleSize GetHandleSize
 #define _SetHandleSize SetHandleSize
+#define _GrowHandleSize SetHandleSize
 #define _MyBlockMove BlockMove
 #define _BlockMove BlockMove
 #define _MaxBlock MaxBlock
@@ -90,8 +173,18 @@ void _DisposeHandleReally(Handle p);
 #define _MySetHandleSize MySetHandleSize
 #define _RecoverHandle RecoverHandle
 #define _ZeroHandleError ZeroHandleError
+inline short SetMemoryTag(short tag) { return kMemOther; }
 #endif
 
+// counts the blocks made in a scope under tag
+class MemoryTag {
+public:
+	MemoryTag(short tag) { previous = SetMemoryTag(tag); }
+	~MemoryTag() { SetMemoryTag(previous); }
+private:
+	short previous;
+};
+
 long GetNumDoubleHdlItems(DOUBLEH h);
 long GetNumHandleItems(Handle h, long itemSize);
 
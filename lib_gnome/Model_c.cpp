@@ -68,6 +68,9 @@ Model_c::Model_c(Seconds start)
 	weatheringOpen = TRUE;
 	
 	fMaxDuration = 3.*24;	// 3 days
+	bUseCounterRandom = false;
+	fRandomSeed = 1;
+	fRefloatTimeStep = 0;
 	
 	// JLM found this comment but no does not believe it, 11/15/99
 	// IT MUST ALWAYS START OUT TRUE TO ENSURE 
@@ -136,10 +139,34 @@ TMap *Model_c::GetBestMap(WorldPoint p)
 }
 
 
-void Model_c::UpdateWindage(TLEList* theLEList)
+// the draws the windage, dispersion and refloating of an LE make in a step
+enum { kWindageDraw = 0, kNaturalDispersionDraw, kChemicalDispersionDraw, kDispersedDepthDraw, kDropletSizeDraw, kRefloatDraw };
+
+// uniform in [low, high), the counter based random number for LE leIndex, or MyRandom's
+static float LERandomFloat(Boolean useCounterRandom, const CounterRandomKey &key, long leIndex, long draw, float low, float high)
 {
-	long i, numLEs;
-	LERec theLE;
+	if (useCounterRandom)
+		return CounterRandomFloat(key, leIndex, draw, low, high);
+	return GetRandomFloat(low, high);
+}
+
+void Model_c::GetLERandomKey(TLEList* theLEList, CounterRandomKey *key)
+{
+	long listIndex = 0;
+	
+	if (LESetsList) LESetsList->IsItemInList((Ptr)&theLEList, &listIndex);
+	key->seed = (uint32_t)fRandomSeed;
+	key->spillID = listIndex;
+	key->step = GetTimeStep() > 0 ? (modelTime - GetStartTime()) / GetTimeStep() : 0;
+	key->stream = theLEList->GetLEType();
+}
+
+// numThreads is only used with the counter based random numbers, MyRandom's are drawn in LE order
+void Model_c::UpdateWindage(TLEList* theLEList, long numThreads)
+{
+	long numLEs;
+	LERec *les;
+	CounterRandomKey key;
 	double originalWindageRange, currentWindageRange, meanWindage, persistence;
 	double windage, windageA, windageB, currentWindageA, currentWindageB;
 	WindageRec windageRec = (*(dynamic_cast<TOLEList*>(theLEList))).fWindageData;
@@ -175,15 +202,23 @@ void Model_c::UpdateWindage(TLEList* theLEList)
 		currentWindageA = meanWindage - currentWindageRange / 2.;
 		currentWindageB = meanWindage + currentWindageRange / 2.;
 	}
-	for (i = 0; i<numLEs; i++) 
+	else	// infinite persistence
 	{
-		theLEList -> GetLE (i, &theLE);
-		if (persistence == -1)	// infinite persistence
-			theLE.windage = GetRandomFloat(windageA, windageB);
-		else	// standard persistence
-			theLE.windage = GetRandomFloat(currentWindageA, currentWindageB);
-		theLEList -> SetLE (i, &theLE);
+		currentWindageA = windageA;
+		currentWindageB = windageB;
 	}
+	if (numLEs <= 0 || !theLEList->LEHandle) return;
+	
+	GetLERandomKey(theLEList, &key);
+	les = *theLEList->LEHandle;	// only the windage of each LE is set, nothing moves the handle
+	Boolean runParallel = bUseCounterRandom && numThreads > 1 && numLEs > 1;
+	Boolean useCounterRandom = bUseCounterRandom;
+	
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(runParallel)
+#endif
+	for (long i = 0; i < numLEs; i++) 
+		les[i].windage = LERandomFloat(useCounterRandom, key, i, kWindageDraw, currentWindageA, currentWindageB);
 }
 
 OSErr GetAdiosIndices(AdiosInfoRecH adiosBudgetTable, Seconds time, long *startIndex, long *endIndex)
@@ -207,53 +242,48 @@ OSErr GetAdiosIndices(AdiosInfoRecH adiosBudgetTable, Seconds time, long *startI
 	return noErr;	// time before first adios budget table value - should do something here?
 }
 
-void Model_c::DisperseOil(TLEList* theLEList, long index)
+// The spill's dispersion in this step, the same for all its LEs: the adios budget table's
+// amounts at this time and the chemical dispersion step
+void Model_c::PrepareDisperseOil(TLEList* theLEList, DisperseStepRec *step)
 {
-	long i, numLEs, startIndex=0, endIndex=0, startIndexEvap, endIndexEvap, startIndexNat, endIndexNat, startIndexRem, endIndexRem;
-	long disperseStep, totalSteps, numBudgetTableItems, numDropletSizes = 0;
-	float x,y,rand,rand2;
-	LERec theLE,savedLE;
-	DispersionRec dispInfo = (dynamic_cast<TOLEList*>(theLEList)) -> GetDispersionInfo();
-	AdiosInfoRecH adiosBudgetTable = (dynamic_cast<TOLEList *>(theLEList)) -> GetAdiosInfo();
-	Boolean chemicalDispersion = dispInfo.bDisperseOil, naturalDispersion = false;
-	DropletInfoRecH dropSizeHdl = 0;
+	TOLEList *theOLEList = dynamic_cast<TOLEList*>(theLEList);
+	AdiosInfoRecH adiosBudgetTable = theOLEList -> GetAdiosInfo();
+	
+	memset(step,0,sizeof(*step));
+	step->dispInfo = theOLEList -> GetDispersionInfo();
+	step->spillStartTime = theOLEList ->fSetSummary.startRelTime;
+	step->numLEs = theLEList->GetLECount();
+	GetLERandomKey(theLEList, &step->randomKey);
 	
 	//if we read in Adios Table will have to do evaporation too, status = oilstat_evaporated
 	//and make sure Gnome doesn't - maybe set oil type to conservative??
 	//or check if AdiosDataH exists
-	if (adiosBudgetTable) naturalDispersion = true;
-	// special case if both are set, need to account for large reduction in number of LEs after
-	// chemical dispersion
-	theLEList -> GetLE (index, &theLE);
-	savedLE = theLE;
-	if (naturalDispersion)
+	if (adiosBudgetTable) step->naturalDispersion = true;
+	if (step->naturalDispersion)
 	{
 		OSErr err = 0;
-		long adiosStartIndex, adiosEndIndex;
-		float totalAmountToDisperse,totalAmountToEvaporate,totalAmountToRemove;
+		long adiosStartIndex, adiosEndIndex, numBudgetTableItems;
 		float startAmtDisp, endAmtDisp, startAmtEvap, endAmtEvap, startAmtRem, endAmtRem, frac=0;
-		Seconds currentTime, previousTime=0, adiosIntervalStartTime, adiosIntervalEndTime, duration;
-		numBudgetTableItems = (dynamic_cast<TOLEList*>(theLEList)) -> GetNumAdiosBudgetTableItems();
+		Seconds currentTime, adiosIntervalStartTime, adiosIntervalEndTime, duration;
+		numBudgetTableItems = theOLEList -> GetNumAdiosBudgetTableItems();
 		if (numBudgetTableItems<1) 
 		{
 			printError("Problem accessing Adios Budget Table data"); 
+			step->badBudgetTable = true;
 			return;
 		}
-		totalAmountToDisperse = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountDispersed;
-		totalAmountToEvaporate = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountEvaporated;
-		totalAmountToRemove = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountRemoved;
-		currentTime = GetModelTime() - (dynamic_cast<TOLEList*>(theLEList)) ->fSetSummary.startRelTime;
-		//currentTime = GetModelTime() - GetStartTime();
-		if (currentTime>0) previousTime = currentTime - GetTimeStep();
+		step->totalAmountToDisperse = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountDispersed;
+		step->totalAmountToEvaporate = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountEvaporated;
+		step->totalAmountToRemove = INDEXH(adiosBudgetTable,numBudgetTableItems-1).amountRemoved;
+		currentTime = GetModelTime() - theOLEList ->fSetSummary.startRelTime;
 		err = GetAdiosIndices(adiosBudgetTable,currentTime,&adiosStartIndex,&adiosEndIndex);
 		//if (err == -2)	//after table ends, may have chemical dispersion, let it go
-		//return;// this should be after table ends, assume chemical would be before...
 		if (err == -1)	// shouldn't happen
 		{
 			printError("Problem accessing Adios Budget Table data"); 
+			step->badBudgetTable = true;
 			return;
 		}
-		// maybe static the previous endIndex and use as next startIndex..., reset each time a new run is done
 		startAmtDisp = INDEXH(adiosBudgetTable,adiosStartIndex).amountDispersed;
 		endAmtDisp = INDEXH(adiosBudgetTable,adiosEndIndex).amountDispersed;
 		startAmtEvap = INDEXH(adiosBudgetTable,adiosStartIndex).amountEvaporated;
@@ -267,154 +297,153 @@ void Model_c::DisperseOil(TLEList* theLEList, long index)
 			frac = (float)(currentTime - adiosIntervalStartTime)/(float)(adiosIntervalEndTime-adiosIntervalStartTime); // how far into the interval
 		// also want % of total to determine how many steps
 		duration = INDEXH(adiosBudgetTable,numBudgetTableItems-1).timeAfterSpill;
-		disperseStep = (currentTime + GetTimeStep())/GetTimeStep(); //releaseTime
-		//disperseStep = (currentTime + GetTimeStep())/GetTimeStep(); //releaseTime
-		// for endIndex figure out how many LEs total should be dispersed at this time
-		totalSteps = duration/GetTimeStep() + 1;
-		//theLEList -> GetLE (index, &theLE);
-		//savedLE = theLE;
-		numLEs = theLEList->GetLECount();
-		
-		// also need to pay attention if time dependent release, then total available LEs changes
-		//if ((TOLEList*)theLEList) ->fSetSummary.bWantEndRelTime && (TOLEList*)theLEList) ->numOfLEs > 1)
-		//timeStep = (fSetSummary.endRelTime  - fSetSummary.startRelTime) / (double) (fSetSummary.numOfLEs - 1);
-		//representativeLE.releaseTime = fSetSummary.startRelTime + i * timeStep;
+		step->naturalDisperseStep = (currentTime + GetTimeStep())/GetTimeStep(); //releaseTime
+		step->totalSteps = duration/GetTimeStep() + 1;
 		
 		// may want to make this more random, rather than marking in order, could tie into dispersant step
-		//startIndexNat = numLEs * (startAmtDisp + frac * (endAmtDisp - startAmtDisp)) / totalAmountToDisperse;
-		//startIndexEvap = numLEs * (startAmtEvap + frac * (endAmtEvap - startAmtEvap)) / totalAmountToEvaporate;
-		endIndexNat = numLEs * (startAmtDisp + frac * (endAmtDisp - startAmtDisp)) / totalAmountToDisperse;
-		endIndexEvap = numLEs * (startAmtEvap + frac * (endAmtEvap - startAmtEvap)) / totalAmountToEvaporate;
-		endIndexRem = numLEs * (startAmtRem + frac * (endAmtRem - startAmtRem)) / totalAmountToRemove;
-		//if (disperseStep==1 || (((TOLEList*)theLEList) ->fSetSummary.startRelTime != ((TOLEList*)theLEList) ->fSetSummary.endRelTime && GetModelTime() - theLE.releaseTime) <= GetTimeStep())	// time dependent release
-		//if (disperseStep==1 ||  (GetModelTime() - theLE.releaseTime) < GetTimeStep())	// time dependent release
-		if (disperseStep==1 ||  ((GetModelTime() - theLE.releaseTime) < GetTimeStep() && theLE.releaseTime > (dynamic_cast<TOLEList*>(theLEList)) ->fSetSummary.startRelTime))	// time dependent release
+		step->endIndexNat = step->numLEs * (startAmtDisp + frac * (endAmtDisp - startAmtDisp)) / step->totalAmountToDisperse;
+		step->endIndexEvap = step->numLEs * (startAmtEvap + frac * (endAmtEvap - startAmtEvap)) / step->totalAmountToEvaporate;
+		step->endIndexRem = step->numLEs * (startAmtRem + frac * (endAmtRem - startAmtRem)) / step->totalAmountToRemove;
+	}
+	if (step->dispInfo.bDisperseOil)
+	{
+		step->beforeChemicalDispersion = this->GetModelTime() - theOLEList ->fSetSummary.startRelTime < step->dispInfo.timeToDisperse;
+		step->chemicalDisperseStep = (GetModelTime() - theOLEList ->fSetSummary.startRelTime - step->dispInfo.timeToDisperse + GetTimeStep())/GetTimeStep();
+		step->totalSteps = step->dispInfo.duration/GetTimeStep() + 1;
+	}
+}
+
+// the map's breaking wave height and droplet sizes, looked up when the first LE is dispersed
+static void GetDisperseMapValues(DisperseStepRec *step)
+{
+	if (step->haveMapValues) return;
+	step->haveMapValues = true;
+	step->map = GetPtCurMap();
+	if (!step->map) return;
+	//double breakingWaveHeight = map->fBreakingWaveHeight;
+	step->breakingWaveHeight = step->map->GetBreakingWaveHeight();
+	step->dropSizeHdl = step->map->GetDropletSizesH();
+	if (step->dropSizeHdl) step->numDropletSizes = _GetHandleSize((Handle)step->dropSizeHdl)/sizeof(**step->dropSizeHdl);
+}
+
+void Model_c::DisperseOil(TLEList* theLEList, long index)
+{
+	DisperseStepRec step;
+	LERec theLE;
+	
+	PrepareDisperseOil(theLEList, &step);
+	theLEList -> GetLE (index, &theLE);
+	DisperseLE(&step, index, &theLE);
+	theLEList -> SetLE (index, &theLE);
+}
+
+// disperses LE index of step's spill, thisLE is left as it was if it isn't to be changed
+void Model_c::DisperseLE(DisperseStepRec *step, long index, LERec *thisLE)
+{
+	long i, disperseStep, endIndex=0;
+	float x,rand,rand2;
+	LERec theLE = *thisLE, savedLE = *thisLE;
+	DispersionRec *dispInfo = &step->dispInfo;
+	Boolean chemicalDispersion = dispInfo->bDisperseOil, naturalDispersion = step->naturalDispersion;
+	
+	if (step->badBudgetTable) return;
+	// special case if both are set, need to account for large reduction in number of LEs after
+	// chemical dispersion
+	if (naturalDispersion)
+	{
+		//if (disperseStep==1 || (GetModelTime() - theLE.releaseTime) < GetTimeStep())	// time dependent release
+		if (step->naturalDisperseStep==1 ||  ((GetModelTime() - theLE.releaseTime) < GetTimeStep() && theLE.releaseTime > step->spillStartTime))	// time dependent release
 		{
 			// mark the LEs that will be dispersed
 			// what if combine lasso with adios??
-			//if (dispInfo.lassoSelectedLEsToDisperse && dispInfo.timeToDisperse == 0 && theLE.dispersionStatus)
 			// need to calculate based on time lasso was applied, it would have superceded any evaporate or disperse setting
-			// probably want to use originally set values, except if lassoed before first time step. THen what?
-			// then don't mark any already marked LEs and proceed 
-			//if (!dispInfo.lassoSelectedLEsToDisperse || (dispInfo.lassoSelectedLEsToDisperse && dispInfo.timeToDisperse == 0 && theLE.dispersionStatus != DISPERSE))
-			//{
-			//y = GetRandomFloat(0, 1.0);
-			x = GetRandomFloat(0, 1.0);
-			//if(x > 1-totalAmountToDisperse) // percent within the area or of total amount of oil?
-			if(x <= totalAmountToDisperse) // percent within the area or of total amount of oil?
+			x = LERandomFloat(bUseCounterRandom, step->randomKey, index, kNaturalDispersionDraw, 0, 1.0);
+			if(x <= step->totalAmountToDisperse) // percent within the area or of total amount of oil?
 			{
 				theLE.dispersionStatus = DISPERSE_NAT;
 			}
 			// total amount to evaporate should be scaled by 1/(1-totalAmtDispersed)
 			// to make up for the dispersed LEs bringing down the total available
-			//else if(y <= totalAmountToEvaporate / (1-totalAmountToDisperse))
-			//else if(x < 1-totalAmountToDisperse && x > 1-(totalAmountToDisperse + totalAmountToEvaporate) )
-			else if(x > totalAmountToDisperse && x <= totalAmountToDisperse + totalAmountToEvaporate )
+			else if(x > step->totalAmountToDisperse && x <= step->totalAmountToDisperse + step->totalAmountToEvaporate )
 			{
 				theLE.dispersionStatus = EVAPORATE;
 			}
-			//else if(x < 1-(totalAmountToDisperse + totalAmountToEvaporate) && x > 1 - (totalAmountToDisperse + totalAmountToEvaporate + totalAmountToRemove) )
-			else if(x > totalAmountToDisperse + totalAmountToEvaporate && x <= totalAmountToDisperse + totalAmountToEvaporate + totalAmountToRemove )
+			else if(x > step->totalAmountToDisperse + step->totalAmountToEvaporate && x <= step->totalAmountToDisperse + step->totalAmountToEvaporate + step->totalAmountToRemove )
 			{
 				theLE.dispersionStatus = REMOVE;
 			}
-			//else
-			//theLE.dispersionStatus = DONT_DISPERSE;
-			//}
-			if (chemicalDispersion && dispInfo.lassoSelectedLEsToDisperse && savedLE.dispersionStatus == DISPERSE)
+			if (chemicalDispersion && dispInfo->lassoSelectedLEsToDisperse && savedLE.dispersionStatus == DISPERSE)
 				theLE.dispersionStatus = savedLE.dispersionStatus;
 			
 		} 
 		if (!chemicalDispersion) goto weatherLE;
 	}
 	if (!chemicalDispersion) return;
-	if (this->GetModelTime() - (dynamic_cast<TOLEList*>(theLEList)) ->fSetSummary.startRelTime < dispInfo.timeToDisperse) goto weatherLE;
-	//if (this->GetModelTime() - this->GetStartTime() < dispInfo.timeToDisperse) goto weatherLE;
-	//if (this->GetModelTime() - this->GetStartTime() < dispInfo.timeToDisperse && !naturalDispersion) return;
+	if (step->beforeChemicalDispersion) goto weatherLE;
 	// code goes here, check wind speed >= 7 knots, can assume only one wind mover? only at first step?
 	
-	//theLEList -> GetLE (index, &theLE);
 	//if (dispInfo.lassoSelectedLEsToDisperse && thisLE.beachTime >= GetModelTime() && thisLE.beachTime <= GetModelTime() + GetTimeStep()) timeToDisperse = true;
-	if (dispInfo.lassoSelectedLEsToDisperse && theLE.beachTime >= GetStartTime() )
+	if (dispInfo->lassoSelectedLEsToDisperse && theLE.beachTime >= GetStartTime() )
 	{
 		if (theLE.beachTime >= GetModelTime() && theLE.beachTime <= GetModelTime() + GetTimeStep())
 			disperseStep = (GetModelTime() - theLE.beachTime + GetTimeStep())/GetTimeStep();
 		else return;
 	}
-	//disperseStep = (GetModelTime() - GetStartTime() - dispInfo.timeToDisperse + GetTimeStep())/GetTimeStep();
 	else
-		disperseStep = (GetModelTime() - (dynamic_cast<TOLEList*>(theLEList)) ->fSetSummary.startRelTime - dispInfo.timeToDisperse + GetTimeStep())/GetTimeStep();
-	totalSteps = dispInfo.duration/GetTimeStep() + 1;
-	numLEs = theLEList->GetLECount();
-	startIndex = numLEs * (disperseStep - 1) / totalSteps;
-	endIndex = numLEs * disperseStep / totalSteps;
-	if (WPointInWRect(theLE.p.pLong,theLE.p.pLat,&dispInfo.areaToDisperse))
+		disperseStep = step->chemicalDisperseStep;
+	endIndex = step->numLEs * disperseStep / step->totalSteps;
+	if (WPointInWRect(theLE.p.pLong,theLE.p.pLat,&dispInfo->areaToDisperse))
 	{
 		//if (disperseStep==1 && !dispInfo.lassoSelectedLEsToDisperse) // if lasso selected, already set
-		if ((disperseStep==1 || (GetModelTime() - theLE.releaseTime) < GetTimeStep()) && !dispInfo.lassoSelectedLEsToDisperse) // if lasso selected, already set
+		if ((disperseStep==1 || (GetModelTime() - theLE.releaseTime) < GetTimeStep()) && !dispInfo->lassoSelectedLEsToDisperse) // if lasso selected, already set
 		{
 			// mark the LEs that will be dispersed
-			x = GetRandomFloat(0, 1.0);
-			if(x <= dispInfo.amountToDisperse) // percent within the area or of total amount of oil?
+			x = LERandomFloat(bUseCounterRandom, step->randomKey, index, kChemicalDispersionDraw, 0, 1.0);
+			if(x <= dispInfo->amountToDisperse) // percent within the area or of total amount of oil?
 			{
 				theLE.dispersionStatus = DISPERSE;
 			}
-			//else
-			//theLE.dispersionStatus = DONT_DISPERSE;
 		}
-		if (disperseStep==1 && dispInfo.lassoSelectedLEsToDisperse && !naturalDispersion)
+		if (disperseStep==1 && dispInfo->lassoSelectedLEsToDisperse && !naturalDispersion)
 		{
 			if (theLE.dispersionStatus != DISPERSE) theLE.dispersionStatus=DONT_DISPERSE;
 		}
 	}
 	
 weatherLE:
-	if (theLE.dispersionStatus == EVAPORATE && (/*index>=startIndex &&*/ index<endIndexEvap))
-		//if (theLE.dispersionStatus == EVAPORATE && (index%totalSteps == disperseStep))
+	if (theLE.dispersionStatus == EVAPORATE && (/*index>=startIndex &&*/ index<step->endIndexEvap))
 	{	
 		theLE.statusCode = OILSTAT_EVAPORATED;
 		theLE.dispersionStatus = HAVE_EVAPORATED;
 	}
-	if (theLE.dispersionStatus == REMOVE && (/*index>=startIndex &&*/ index<endIndexRem))
-		//if (theLE.dispersionStatus == EVAPORATE && (index%totalSteps == disperseStep))
+	if (theLE.dispersionStatus == REMOVE && (/*index>=startIndex &&*/ index<step->endIndexRem))
 	{	
 		theLE.statusCode = OILSTAT_OFFMAPS;
 		theLE.dispersionStatus = HAVE_REMOVED;
 	}
 	if (theLE.dispersionStatus == DISPERSE && (/*index>=startIndex &&*/ index<endIndex)
-		|| (theLE.dispersionStatus == DISPERSE_NAT && index<endIndexNat))
+		|| (theLE.dispersionStatus == DISPERSE_NAT && index<step->endIndexNat))
 	{
 		// disperse percent of LEs each time, each time depth range is the same
-		PtCurMap *map = GetPtCurMap();
+		GetDisperseMapValues(step);
+		PtCurMap *map = step->map;
 		if (!map) {printError("Programmer error - TModel::DisperseOil()");return;}
-		//double breakingWaveHeight = map->fBreakingWaveHeight;
-		double breakingWaveHeight = map->GetBreakingWaveHeight();
-		if (breakingWaveHeight == 0) printNote("Oil cannot be dispersed because there is no wind");
+		double breakingWaveHeight = step->breakingWaveHeight;
+		if (breakingWaveHeight == 0 && !step->notedNoWind) 
+		{
+			printNote("Oil cannot be dispersed because there is no wind");
+			step->notedNoWind = true;
+		}
 		double depthAtPoint = map->DepthAtPoint(theLE.p);	// or check rand instead
 		if (depthAtPoint >= breakingWaveHeight * 1.5 || depthAtPoint <= 0)		
-			rand = GetRandomFloat(1e-6, breakingWaveHeight*1.5);
+			rand = LERandomFloat(bUseCounterRandom, step->randomKey, index, kDispersedDepthDraw, 1e-6, breakingWaveHeight*1.5);
 		else
-			rand = GetRandomFloat(1e-6, depthAtPoint);
+			rand = LERandomFloat(bUseCounterRandom, step->randomKey, index, kDispersedDepthDraw, 1e-6, depthAtPoint);
 		theLE.z = rand; 	// check if in vertical map
-		rand2 = GetRandomFloat(0,1);
-		/*if (rand2>=0 && rand2<.056)
-		 theLE.dropletSize = 10;
-		 else if (rand2>=.056 && rand2<.147)
-		 theLE.dropletSize = 20;
-		 else if (rand2>=.147 && rand2<.267)
-		 theLE.dropletSize = 30;
-		 else if (rand2>=.267 && rand2<.414)
-		 theLE.dropletSize = 40;
-		 else if (rand2>=.414 && rand2<.586)
-		 theLE.dropletSize = 50;
-		 else if (rand2>=.586 && rand2<.782)
-		 theLE.dropletSize = 60;
-		 else if (rand2>=.782 && rand2<=1.0)
-		 theLE.dropletSize = 70;*/
-		
-		dropSizeHdl = map->GetDropletSizesH();
-		if (dropSizeHdl) numDropletSizes = _GetHandleSize((Handle)dropSizeHdl)/sizeof(**dropSizeHdl);
+		rand2 = LERandomFloat(bUseCounterRandom, step->randomKey, index, kDropletSizeDraw, 0, 1);
 		
+		DropletInfoRecH dropSizeHdl = step->dropSizeHdl;
+		long numDropletSizes = step->numDropletSizes;
 		for (i=0;i<numDropletSizes;i++)
 		{	
 			if (rand2 < (*dropSizeHdl)[i].probability) {theLE.dropletSize = (*dropSizeHdl)[i].dropletSize; break;}
@@ -425,10 +454,9 @@ weatherLE:
 			theLE.dispersionStatus = HAVE_DISPERSED_NAT;
 		else
 			theLE.dispersionStatus = HAVE_DISPERSED;
-		//theLE.dispersionStatus = HAVE_DISPERSED;
 	}
 	
-	theLEList -> SetLE (index, &theLE);
+	*thisLE = theLE;
 	return;
 }
 
@@ -526,6 +554,24 @@ Boolean Model_c::IsAllowableSpillPoint(WorldPoint p)
 	return bestMap -> IsAllowableSpillPoint (p);
 }
 
+void Model_c::AreWaterPoints(long n, const WorldPoint *p, Boolean *isWater, long numThreads)
+{
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(numThreads > 1 && n > 1)
+#endif
+	for (long i = 0; i < n; i++)
+		isWater[i] = IsWaterPoint(p[i]);
+}
+
+void Model_c::AreAllowableSpillPoints(long n, const WorldPoint *p, Boolean *allowable, long numThreads)
+{
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(numThreads > 1 && n > 1)
+#endif
+	for (long i = 0; i < n; i++)
+		allowable[i] = IsAllowableSpillPoint(p[i]);
+}
+
 Boolean Model_c::HaveAllowableSpillLayer(WorldPoint p)
 {
 	TMap *bestMap = GetBestMap (p);
@@ -844,7 +890,7 @@ OSErr Model_c::TellMoversPrepareForStep()
 	TMover *thisMover;
 	TLEList *list;
 	OSErr err=0;
-	int *LESetsSizesList = 0;
+	LECount *LESetsSizesList = 0;
 
 	
 	// loop through all maps except universal map
@@ -989,10 +1035,33 @@ Boolean Model_c::ThereIsALaterSpill(Seconds timeOfInterest, TLEList *someLEListT
 }
 
 
+// the probability an LE on a shore of halfLifeInHrs refloats in a time step, worked out
+// once for each half-life until the time step changes
+double Model_c::RefloatProbability(double halfLifeInHrs)
+{
+	map<double, double>::iterator it;
+	double probability;
+	
+	if (fRefloatTimeStep != GetTimeStep()) {
+		fRefloatProbabilities.clear();
+		fRefloatTimeStep = GetTimeStep();
+	}
+	
+	it = fRefloatProbabilities.find(halfLifeInHrs);
+	if (it != fRefloatProbabilities.end())
+		return it->second;
+	
+	probability = 1.0 - pow(0.5, (GetTimeStep() / 3600.0) / halfLifeInHrs);
+	fRefloatProbabilities[halfLifeInHrs] = probability;
+	return probability;
+}
+
+// the LEs of a step are refloated before they move, so the ones beached in it wait for the next one
 void Model_c::PossiblyReFloatLE(TMap *theMap, TLEList *theLEList, long i, LETYPE leType)
 {
 	LERec theLE;
 	Boolean refloat = true;
+	CounterRandomKey key;
 	
 	theLEList -> GetLE (i, &theLE);
 	
@@ -1008,7 +1077,7 @@ void Model_c::PossiblyReFloatLE(TMap *theMap, TLEList *theLEList, long i, LETYPE
 				// code goes here to allow user to set this etc.
 				// should probably be map dependent etc....
 				
-				double halfLifeInHrs,thisStepInHours;
+				double halfLifeInHrs;
 				float probOfRefloatingThisTimeStep,x;
 				
 				halfLifeInHrs = theMap -> RefloatHalfLifeInHrs (theLE.p);
@@ -1016,9 +1085,9 @@ void Model_c::PossiblyReFloatLE(TMap *theMap, TLEList *theLEList, long i, LETYPE
 					refloat = true;
 				else
 				{
-					thisStepInHours = model->GetTimeStep()/3600.0;
-					probOfRefloatingThisTimeStep = 1.0 - pow(0.5,thisStepInHours/halfLifeInHrs);
-					x = GetRandomFloat(0, 1.0);
+					probOfRefloatingThisTimeStep = RefloatProbability(halfLifeInHrs);
+					if (bUseCounterRandom) GetLERandomKey(theLEList, &key);
+					x = LERandomFloat(bUseCounterRandom, key, i, kRefloatDraw, 0, 1.0);
 					if(x <= probOfRefloatingThisTimeStep) 
 						refloat = true;
 					else 
@@ -15,6 +15,7 @@
 #include "GuiTypeDefs.h"
 #include "CMYLIST.H"
 #include "ClassID_c.h"
+#include "CounterRandom.h"
 #include <string>
 #include <map>
 
@@ -43,6 +44,29 @@ class TRandom3D;
 class TCurrentMover;
 class LocaleWizard;
 class TLEList;
+class PtCurMap;
+
+// what DisperseLE needs of a spill in a step, worked out once by PrepareDisperseOil
+typedef struct {
+	Seconds			spillStartTime;
+	Boolean			badBudgetTable;	// the adios budget table couldn't be read, no LE is changed
+	DispersionRec	dispInfo;
+	Boolean			naturalDispersion;
+	long			numLEs;
+	// natural dispersion, from the adios budget table
+	float			totalAmountToDisperse, totalAmountToEvaporate, totalAmountToRemove;
+	long			naturalDisperseStep, endIndexNat, endIndexEvap, endIndexRem;
+	// chemical dispersion
+	Boolean			beforeChemicalDispersion;
+	long			chemicalDisperseStep, totalSteps;	// the step isn't used for lassoed LEs
+	Boolean			haveMapValues;	// the map's, looked up when an LE is first dispersed
+	PtCurMap		*map;
+	double			breakingWaveHeight;
+	Boolean			notedNoWind;
+	DropletInfoRecH	dropSizeHdl;
+	long			numDropletSizes;
+	CounterRandomKey randomKey;
+} DisperseStepRec;
 
 class Model_c : virtual public ClassID_c {
 
@@ -103,6 +127,16 @@ public:
 	CMyList *LEFramesList;
 	CMyList *frameMapList;		// copy of map list used to detect changes in actual map-list
 	
+	// the windage and dispersion draws are stateless random numbers keyed on spill, LE and step,
+	// the same in any LE order and on any number of threads. Off, they are MyRandom's as they were
+	Boolean		bUseCounterRandom;
+	long		fRandomSeed;
+	
+	// the probabilities of refloating in a step of fRefloatTimeStep, by half-life -
+	// the shoreline classes of a map have a few half-lives between them
+	map<double, double>	fRefloatProbabilities;
+	Seconds		fRefloatTimeStep;
+	
 	Model_c	(Seconds start);
 	Model_c	() {}
 	void				SetStartTime (Seconds newStartTime) { fDialogVariables.startTime = newStartTime; }
@@ -144,6 +178,10 @@ public:
 	 TMap				*GetBestMap (WorldPoint p);
 	 Boolean			IsWaterPoint(WorldPoint p);
 	 Boolean			IsAllowableSpillPoint(WorldPoint p);
+	// IsWaterPoint and IsAllowableSpillPoint of n points, say the start positions of a big
+	// release. On numThreads threads the maps are only read, they must be set up already
+	 void				AreWaterPoints(long n, const WorldPoint *p, Boolean *isWater, long numThreads = 1);
+	 void				AreAllowableSpillPoints(long n, const WorldPoint *p, Boolean *allowable, long numThreads = 1);
 	 Boolean			HaveAllowableSpillLayer(WorldPoint p);
 	 Boolean			CurrentBeachesLE(WorldPoint3D startPoint, WorldPoint3D *movedPoint, TMap *bestMap);
 	 WorldPoint3D		TurnLEAlongShoreLine(WorldPoint3D waterPoint, WorldPoint3D beachedPoint, TMap *bestMap);
@@ -158,8 +196,12 @@ public:
 	
 	void				ReDisperseOil(LERec* thisLE, double breakingWaveHeight);
 	void				PossiblyReFloatLE (TMap *theMap, TLEList *theLEList, long i, LETYPE leType);
+	double				RefloatProbability (double halfLifeInHrs);
 	void 				DisperseOil(TLEList* theLEList, long index);
-	void 				UpdateWindage(TLEList* theLEList);
+	void				PrepareDisperseOil(TLEList* theLEList, DisperseStepRec *step);
+	void				DisperseLE(DisperseStepRec *step, long index, LERec *theLE);
+	void 				UpdateWindage(TLEList* theLEList, long numThreads = 1);
+	void				GetLERandomKey(TLEList* theLEList, CounterRandomKey *key);
 	OSErr 				TellMoversPrepareForRun();
 	OSErr 				TellMoversPrepareForStep();
 	void 				TellMoversStepIsDone();
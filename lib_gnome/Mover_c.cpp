@@ -8,6 +8,7 @@
  */
 
 #include "Mover_c.h"
+#include "RunState.h"
 
 //#ifdef pyGNOME
 //#define TMap Map_c
@@ -25,6 +26,7 @@ Mover_c::Mover_c(TMap *owner, char *name)
 	fUncertainStartTime = 0;
 	fDuration = 0; // JLM 9/18/98
 	fTimeUncertaintyWasSet = 0;// JLM 9/18/98
+	fNumThreads = 1;
 	//fColor = colors[PURPLE];	// default to draw arrows in purple
 }
 #endif
@@ -36,6 +38,7 @@ Mover_c::Mover_c()
 	fUncertainStartTime = 0;
 	fDuration = 0; // JLM 9/18/98
 	fTimeUncertaintyWasSet = 0;// JLM 9/18/98
+	fNumThreads = 1;
 }
 
 
@@ -49,8 +52,40 @@ OSErr Mover_c::UpdateUncertainty(void)
 	return 0;	
 }
 
+OSErr Mover_c::GetRunState(std::vector<char> &state)
+{
+	LOCK_MOVER;
+	RunStateWriter writer(state);
+
+	state.clear();
+	WriteRunState(writer);
+
+	return noErr;
+}
+
+OSErr Mover_c::SetRunState(const char *state, long size)
+{
+	LOCK_MOVER;
+	RunStateReader reader(state, size);
+
+	if (!state || !ReadRunState(reader) || !reader.AtEnd())
+		return 1;
+
+	return noErr;
+}
+
+void Mover_c::WriteRunState(RunStateWriter &writer)
+{
+	writer.Put(fTimeUncertaintyWasSet);
+}
+
+bool Mover_c::ReadRunState(RunStateReader &reader)
+{
+	return reader.Get(&fTimeUncertaintyWasSet);
+}
+
 
-WorldPoint3D Mover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType) 
+WorldPoint3D Mover_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType) 
 {
 	//WorldPoint3D theLE3D [] = {(*theLE).p.pLat,(*theLE).p.pLong,(*theLE).z}; 
 	WorldPoint3D theLE3D; 
@@ -60,4 +95,307 @@ WorldPoint3D Mover_c::GetMove (const Seconds& model_time, Seconds timeStep,long
 	return theLE3D;
 }
 
+OSErr Mover_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+							   const double *lat, const double *lon, const double *z,
+							   const double *windages, const short *LE_status,
+							   double *delta_lat, double *delta_lon, double *delta_z,
+							   LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	LERec rec;
+	WorldPoint3D delta;
+
+	memset(&rec, 0, sizeof(rec));
+
+	for (LECount i = 0; i < n; i++) {
+		if (LE_status[i] != OILSTAT_INWATER) {
+			delta_lat[i] = delta_lon[i] = delta_z[i] = 0.;
+			continue;
+		}
+
+		// GetMove works on positions scaled by 1000000
+		rec.p.pLat = lat[i] * 1000000;
+		rec.p.pLong = lon[i] * 1000000;
+		rec.z = z[i];
+		if (windages)
+			rec.windage = windages[i];
+
+		delta = GetMove(model_time, step_len, spill_ID, i, &rec, spillType);
+
+		delta_lat[i] = delta.p.pLat / 1000000;
+		delta_lon[i] = delta.p.pLong / 1000000;
+		delta_z[i] = delta.z;
+	}
+
+	return noErr;
+}
+
+OSErr Mover_c::get_move_batch_active(LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+									 const double *lat, const double *lon, const double *z,
+									 const double *windages, const short *LE_status,
+									 double *delta_lat, double *delta_lon, double *delta_z,
+									 LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	OSErr err;
+	double chunk_lat[kFuseChunk], chunk_lon[kFuseChunk], chunk_z[kFuseChunk];
+
+	if (!active || !CanFuseMove())
+		return get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+							  delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	TIME_SECTION(&fTiming, kTimerGetMove, numActive);
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	for (LECount i = 0; i < n; i++)
+		delta_lat[i] = delta_lon[i] = delta_z[i] = 0.;
+
+	err = BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+	if (err) return err;
+
+	for (LECount first = 0; first < numActive; first += kFuseChunk) {
+		int count = numActive - first < kFuseChunk ? numActive - first : kFuseChunk;
+
+		MoveBatchLEs(count, 0, active + first, model_time, step_len, lat, lon, z, windages, LE_status,
+					 chunk_lat, chunk_lon, chunk_z, spillType, spill_ID);
+		for (int k = 0; k < count; k++) {
+			LECount i = active[first + k];
+
+			delta_lat[i] = chunk_lat[k];
+			delta_lon[i] = chunk_lon[k];
+			delta_z[i] = chunk_z[k];
+		}
+	}
+
+	return noErr;
+}
+
+OSErr MoveFused(int numMovers, Mover_c **movers, double *const *windages,
+				LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+				const double *lat, const double *lon, const double *z, const short *LE_status,
+				double *next_lat, double *next_lon, double *next_z,
+				LEType spillType, long spill_ID)
+{
+	OSErr err = noErr;
+	Boolean fuse = (spillType == FORECAST_LE);
+	LECount numLEs = active ? numActive : n;	// the LEs moved, active[k] or k
+
+	if (!movers || !lat || !lon || !z || !LE_status || !next_lat || !next_lon || !next_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	if (n <= 0 || numLEs <= 0 || numMovers <= 0)
+		return noErr;
+
+	for (int m = 0; m < numMovers; m++) {
+		if (!movers[m]->CanFuseMove())
+			fuse = false;
+	}
+
+	if (!fuse) {
+		std::vector<double> delta(3 * n);
+
+		for (int m = 0; m < numMovers; m++) {
+			err = movers[m]->get_move_batch_active(n, numActive, active, model_time, step_len, lat, lon, z,
+												   windages ? windages[m] : 0, LE_status,
+												   &delta[0], &delta[n], &delta[2 * n], spillType, spill_ID);
+			if (err == 1 || err == 2)
+				return err;
+
+			// the LEs that aren't in the list don't move
+			for (LECount k = 0; k < numLEs; k++) {
+				LECount i = active ? active[k] : k;
+
+				next_lat[i] += delta[i];
+				next_lon[i] += delta[n + i];
+				next_z[i] += delta[2 * n + i];
+			}
+		}
+
+		return noErr;
+	}
+
+	double delta_lat[kFuseChunk], delta_lon[kFuseChunk], delta_z[kFuseChunk];
+	std::vector<char> skip(numMovers, 0);
+
+	for (int m = 0; m < numMovers; m++)
+		movers[m]->fMoverMutex.Lock();
+
+	for (int m = 0; m < numMovers && !err; m++) {
+		TIME_SECTION(&movers[m]->fTiming, kTimerGetMove, 0);
+		err = movers[m]->BeginMoveBatch(n, model_time, step_len, lat, lon, z,
+										windages ? windages[m] : 0, LE_status, spillType);
+		// like get_move_batch, a mover that can't move this step adds nothing
+		if (err != 1 && err != 2) {
+			skip[m] = (err != noErr);
+			err = noErr;
+		}
+	}
+
+	for (LECount first = 0; first < numLEs && !err; first += kFuseChunk) {
+		int count = numLEs - first < kFuseChunk ? numLEs - first : kFuseChunk;
+		const LECount *index = active ? active + first : 0;
+
+		for (int m = 0; m < numMovers; m++) {
+			if (skip[m])
+				continue;
+
+			{
+				TIME_SECTION(&movers[m]->fTiming, kTimerGetMove, count);
+				movers[m]->MoveBatchLEs(count, first, index, model_time, step_len, lat, lon, z,
+										windages ? windages[m] : 0, LE_status,
+										delta_lat, delta_lon, delta_z, spillType, spill_ID);
+			}
+
+			for (int k = 0; k < count; k++) {
+				LECount i = index ? index[k] : first + k;
+
+				next_lat[i] += delta_lat[k];
+				next_lon[i] += delta_lon[k];
+				next_z[i] += delta_z[k];
+			}
+		}
+	}
+
+	for (int m = numMovers - 1; m >= 0; m--)
+		movers[m]->fMoverMutex.Unlock();
+
+	return err;
+}
+
+OSErr MoveEnsemble(int numMovers, Mover_c **movers, double *const *windages,
+				   int numMembers, const LECount *memberStart, const double *memberScale,
+				   LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+				   const double *lat, const double *lon, const double *z, const short *LE_status,
+				   double *next_lat, double *next_lon, double *next_z,
+				   LEType spillType, long spill_ID)
+{
+	OSErr err = noErr;
+	Boolean fuse = (spillType == FORECAST_LE);
+	LECount numLEs = active ? numActive : n;	// the LEs moved, active[k] or k
+
+	if (!movers || !memberStart || !memberScale || !lat || !lon || !z || !LE_status ||
+		!next_lat || !next_lon || !next_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	if (numMembers <= 0 || memberStart[0] != 0 || memberStart[numMembers] != n)
+		return 1;
+	for (int k = 0; k < numMembers; k++) {
+		if (memberStart[k + 1] < memberStart[k])
+			return 1;
+	}
+
+	if (n <= 0 || numLEs <= 0 || numMovers <= 0)
+		return noErr;
+
+	for (int m = 0; m < numMovers; m++) {
+		if (!movers[m]->CanFuseMove())
+			fuse = false;
+	}
+
+	if (!fuse) {
+		std::vector<double> delta(3 * n);
+
+		for (int m = 0; m < numMovers; m++) {
+			// one call moves the LEs of all the members
+			err = movers[m]->get_move_batch_active(n, numActive, active, model_time, step_len, lat, lon, z,
+												   windages ? windages[m] : 0, LE_status,
+												   &delta[0], &delta[n], &delta[2 * n], spillType, spill_ID);
+			if (err == 1 || err == 2)
+				return err;
+
+			// the LEs (and the active list) are in member order
+			int member = 0;
+			for (LECount k = 0; k < numLEs; k++) {
+				LECount i = active ? active[k] : k;
+
+				while (i >= memberStart[member + 1])
+					member++;
+
+				double scale = memberScale[member * numMovers + m];
+
+				next_lat[i] += scale * delta[i];
+				next_lon[i] += scale * delta[n + i];
+				next_z[i] += scale * delta[2 * n + i];
+			}
+		}
+
+		return noErr;
+	}
+
+	double delta_lat[kFuseChunk], delta_lon[kFuseChunk], delta_z[kFuseChunk];
+	int chunk_member[kFuseChunk];
+	std::vector<char> skip(numMovers, 0);
+	int member = 0;
+
+	for (int m = 0; m < numMovers; m++)
+		movers[m]->fMoverMutex.Lock();
+
+	for (int m = 0; m < numMovers && !err; m++) {
+		TIME_SECTION(&movers[m]->fTiming, kTimerGetMove, 0);
+		err = movers[m]->BeginMoveBatch(n, model_time, step_len, lat, lon, z,
+										windages ? windages[m] : 0, LE_status, spillType);
+		// like get_move_batch, a mover that can't move this step adds nothing
+		if (err != 1 && err != 2) {
+			skip[m] = (err != noErr);
+			err = noErr;
+		}
+	}
+
+	for (LECount first = 0; first < numLEs && !err; first += kFuseChunk) {
+		int count = numLEs - first < kFuseChunk ? numLEs - first : kFuseChunk;
+		const LECount *index = active ? active + first : 0;
+
+		for (int k = 0; k < count; k++) {
+			LECount i = index ? index[k] : first + k;
+
+			while (i >= memberStart[member + 1])
+				member++;
+			chunk_member[k] = member;
+		}
+
+		for (int m = 0; m < numMovers; m++) {
+			if (skip[m])
+				continue;
+
+			{
+				TIME_SECTION(&movers[m]->fTiming, kTimerGetMove, count);
+				movers[m]->MoveBatchLEs(count, first, index, model_time, step_len, lat, lon, z,
+										windages ? windages[m] : 0, LE_status,
+										delta_lat, delta_lon, delta_z, spillType, spill_ID);
+			}
+
+			for (int k = 0; k < count; k++) {
+				LECount i = index ? index[k] : first + k;
+				double scale = memberScale[chunk_member[k] * numMovers + m];
+
+				next_lat[i] += scale * delta_lat[k];
+				next_lon[i] += scale * delta_lon[k];
+				next_z[i] += scale * delta_z[k];
+			}
+		}
+	}
+
+	for (int m = numMovers - 1; m >= 0; m--)
+		movers[m]->fMoverMutex.Unlock();
+
+	return err;
+}
+
 //#undef TMap
\ No newline at end of file
@@ -14,6 +14,9 @@
 #include "TypeDefs.h"
 #include "ClassID_c.h"
 #include "RectUtils.h"
+#include "TimingStats.h"
+#include "GnomeThreads.h"
+#include <vector>
 //#include "Map_c.h"
 #include "ExportSymbols.h"
 
@@ -25,6 +28,14 @@
 class TMap;
 #endif
 
+// get_move runs without the GIL, so threads may move LEs with one mover at
+// once (the forecast and uncertain spills). The first line of get_move,
+// get_move_batch, PrepareForModelStep and ModelStepIsDone.
+#define LOCK_MOVER GnomeLock moverLock(fMoverMutex)
+
+class RunStateWriter;
+class RunStateReader;
+
 class DLL_API Mover_c : virtual public ClassID_c {
 
 public:
@@ -33,6 +44,9 @@ public:
 #endif
 	Seconds				fUncertainStartTime;
 	double				fDuration; 				// duration time for uncertainty;
+	int					fNumThreads;			// threads for the get_move loop, 1 is serial (needs OpenMP)
+	TimingStats			fTiming;				// only counted with GNOME_TIMING
+	GnomeMutex			fMoverMutex;			// held while a thread moves or prepares a step with it, see LOCK_MOVER
 	//RGBColor			fColor;
 	
 protected:
@@ -46,14 +60,50 @@ public:
 	virtual				~Mover_c();
 	virtual void		Dispose () {}
 
-	virtual OSErr		AddUncertainty (long setIndex, long leIndex, VelocityRec *v) { return 0; }
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType); 
+	virtual OSErr		AddUncertainty (long setIndex, LECount leIndex, VelocityRec *v) { return 0; }
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType); 
+
+	// batched structure-of-arrays version of get_move - positions and deltas are in degrees (and meters for z)
+	// windages may be nil for movers that don't use them
+	// the default implementation goes through GetMove one LE at a time, movers on the hot path override it
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
+
+	// get_move_batch of only the LEs in the active list (the indexes of the LEs in water, in order), the
+	// deltas of the other LEs are 0. Movers that can't fuse move all n LEs
+	OSErr				get_move_batch_active(LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+											  const double *lat, const double *lon, const double *z,
+											  const double *windages, const short *LE_status,
+											  double *delta_lat, double *delta_lon, double *delta_z,
+											  LEType spillType, long spill_ID);
+
+	// the fused pass (MoveFused) moves the LEs a chunk at a time through several movers:
+	// BeginMoveBatch sets the mover up for all n LEs once, then MoveBatchLEs moves count LEs, LE
+	// index[k] (first + k without an index), and writes the deltas of its kth LE to delta_*[k].
+	// Together they are the mover's get_move_batch, the caller holds the mover's lock. Only movers that
+	// say CanFuseMove are fused
+	virtual Boolean		CanFuseMove() { return false; }
+	// true if GetMove may be called for different LEs of leType from several threads at once
+	// this step, as the desktop model's TModel::Step does. The same conditions as the mover's
+	// own parallel get_move loop, after PrepareForModelStep
+	virtual Boolean		CanMoveInParallel(LETYPE leType) { return false; }
+	virtual OSErr		BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status, LEType spillType) { return noErr; }
+	virtual void		MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+									 const double *lat, const double *lon, const double *z,
+									 const double *windages, const short *LE_status,
+									 double *delta_lat, double *delta_lon, double *delta_z,
+									 LEType spillType, long spill_ID) {}
 	
 	virtual Boolean		VelocityStrAtPoint(WorldPoint3D wp, char *velStr) {return false;}
 	virtual float		GetArrowDepth(){return 0.;}
 	virtual LongPointHdl	GetPointsHdl(){return nil;}
 	virtual OSErr 		PrepareForModelRun() { return noErr; } 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList) { return noErr; } // AH 07/10/2012
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList) { return noErr; } // AH 07/10/2012
 
 	virtual OSErr		UpdateUncertainty(void);
 #ifndef pyGNOME
@@ -63,13 +113,52 @@ public:
 	void				SetMoverMap (TMap *owner) { moverMap = owner; }
 #endif
 	virtual void 		ModelStepIsDone(){ return; }
-	virtual OSErr 		ReallocateUncertainty(int numLEs, short* LE_Status){ return 0; }
+	void				SetNumThreads(int numThreads) { fNumThreads = numThreads > 0 ? numThreads : 1; }
+	int					GetNumThreads() { return fNumThreads; }
+	// the mover's timers, with its time grid's added in
+	virtual void		GetTimingStats(TimingStats *stats) { stats->Reset(); stats->Add(fTiming); }
+	virtual void		ResetTimingStats() { fTiming.Reset(); }
+	virtual OSErr 		ReallocateUncertainty(LECount numLEs, short* LE_Status){ return 0; }
 	virtual Boolean		IAmA3DMover() {return false;}
+
+	// the runtime state of the mover, for checkpoints (see RunState.h). SetRunState takes the bytes
+	// GetRunState gave, for a mover set up the same way, and returns 1 when they aren't the state of
+	// this kind of mover. The movers with state of their own add it in WriteRunState / ReadRunState,
+	// after their base class's
+	OSErr				GetRunState(std::vector<char> &state);
+	OSErr				SetRunState(const char *state, long size);
+	virtual void		WriteRunState(RunStateWriter &writer);
+	virtual bool		ReadRunState(RunStateReader &reader);
 	//virtual ClassID 	GetClassID () { return TYPE_MOVER; }
 	//virtual Boolean		IAm(ClassID id) { if(id==TYPE_MOVER) return TRUE; return ClassID_c::IAm(id); }
 	
 };
 
+// LEs per chunk of the fused pass, the deltas of a chunk stay in L1
+#define kFuseChunk 256
+
+// moves n LEs with the movers in order, adding the deltas of each mover (with windages[m], which may be
+// nil) to next_*, the same sum as a get_move_batch per mover. With an active list only those LEs are
+// moved. Forecast LEs go through all the movers kFuseChunk at a time when every mover can fuse. The
+// uncertainty of several movers draws random numbers per LE, so uncertain LEs, and movers that can't
+// fuse, are moved by each mover in turn
+DLL_API OSErr MoveFused(int numMovers, Mover_c **movers, double *const *windages,
+						LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+						const double *lat, const double *lon, const double *z, const short *LE_status,
+						double *next_lat, double *next_lon, double *next_z,
+						LEType spillType, long spill_ID);
+
+// MoveFused for an ensemble: the LEs of numMembers members, member k's LEs memberStart[k] up to
+// memberStart[k + 1] (memberStart[numMembers] is n), are moved by all the movers in one pass, so the
+// forcing of each mover is read once for all the members rather than once per member. The deltas of
+// mover m for the LEs of member k are scaled by memberScale[k * numMovers + m] -- the wind or current
+// scale of the member for that mover, 1 for the movers it doesn't perturb
+DLL_API OSErr MoveEnsemble(int numMovers, Mover_c **movers, double *const *windages,
+						   int numMembers, const LECount *memberStart, const double *memberScale,
+						   LECount n, LECount numActive, const LECount *active, Seconds model_time, Seconds step_len,
+						   const double *lat, const double *lon, const double *z, const short *LE_status,
+						   double *next_lat, double *next_lon, double *next_z,
+						   LEType spillType, long spill_ID);
 
 //#undef TMap
 #endif
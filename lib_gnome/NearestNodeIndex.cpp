@@ -0,0 +1,132 @@
+/*
+ *  NearestNodeIndex.cpp
+ *  gnome
+ *
+ *  Built once, then only read, so lookups can run from several threads.
+ *
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "NearestNodeIndex.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+NearestNodeIndex::NearestNodeIndex()
+{
+	fLongScale = 1.;
+}
+
+void NearestNodeIndex::Dispose()
+{
+	fNodes.clear();
+	fNodeOfPoint.clear();
+	fLongScale = 1.;
+}
+
+OSErr NearestNodeIndex::Build(LongPointHdl ptsH, LONGH verdatToNetCDFH)
+{
+	long numPts, i, loLat, hiLat;
+	Node node;
+
+	Dispose();
+
+	if (!ptsH || !verdatToNetCDFH)
+		return -1;
+
+	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
+	if (_GetHandleSize((Handle)verdatToNetCDFH)/(long)sizeof(long) < numPts)
+		return -1;
+
+	loLat = hiLat = numPts > 0 ? (*ptsH)[0].v : 0;
+	for (i = 1; i < numPts; i++) {
+		loLat = _min(loLat, (*ptsH)[i].v);
+		hiLat = _max(hiLat, (*ptsH)[i].v);
+	}
+	fLongScale = cos(((loLat + (double)hiLat) / 2) / 1000000. * PI / 180.);
+
+	for (i = 0; i < numPts; i++) {
+		if ((*verdatToNetCDFH)[i] < 0)
+			continue;	// land
+		node.x = (*ptsH)[i].h * fLongScale;
+		node.y = (*ptsH)[i].v;
+		node.pt = i;
+		fNodes.push_back(node);
+	}
+	if (fNodes.empty())
+		return -1;
+
+	BuildSubtree(0, fNodes.size(), 0);
+
+	fNodeOfPoint.assign(numPts, -1);
+	for (i = 0; i < (long)fNodes.size(); i++)
+		fNodeOfPoint[fNodes[i].pt] = i;
+
+	return noErr;
+}
+
+void NearestNodeIndex::BuildSubtree(long first, long last, int axis)
+{
+	long mid = (first + last) / 2;
+
+	if (last - first <= 1)
+		return;
+
+	std::nth_element(fNodes.begin() + first, fNodes.begin() + mid, fNodes.begin() + last, axis ? NodeYLess : NodeXLess);
+	BuildSubtree(first, mid, 1 - axis);
+	BuildSubtree(mid + 1, last, 1 - axis);
+}
+
+void NearestNodeIndex::Search(long first, long last, int axis, double x, double y, long *best, double *bestDist) const
+{
+	long mid;
+	double dx, dy, dist, split;
+
+	if (first >= last)
+		return;
+
+	mid = (first + last) / 2;
+	const Node &node = fNodes[mid];
+	dx = node.x - x;
+	dy = node.y - y;
+	dist = dx * dx + dy * dy;
+	// ties go to the lower grid point, so the answer doesn't depend on the hint
+	if (dist < *bestDist || (dist == *bestDist && node.pt < fNodes[*best].pt)) {
+		*bestDist = dist;
+		*best = mid;
+	}
+
+	split = axis ? dy : dx;	// pt's side of the split is searched first
+	if (split > 0) {
+		Search(first, mid, 1 - axis, x, y, best, bestDist);
+		if (split * split <= *bestDist)
+			Search(mid + 1, last, 1 - axis, x, y, best, bestDist);
+	}
+	else {
+		Search(mid + 1, last, 1 - axis, x, y, best, bestDist);
+		if (split * split <= *bestDist)
+			Search(first, mid, 1 - axis, x, y, best, bestDist);
+	}
+}
+
+long NearestNodeIndex::Nearest(LongPoint pt, long hint) const
+{
+	double x = pt.h * fLongScale, y = pt.v, dx, dy, bestDist;
+	long best;
+
+	if (fNodes.empty())
+		return -1;
+
+	best = (hint >= 0 && hint < (long)fNodeOfPoint.size()) ? fNodeOfPoint[hint] : -1;
+	if (best < 0)
+		best = fNodes.size() / 2;	// the root
+	dx = fNodes[best].x - x;
+	dy = fNodes[best].y - y;
+	bestDist = dx * dx + dy * dy;
+
+	Search(0, fNodes.size(), 0, x, y, &best, &bestDist);
+
+	return fNodes[best].pt;
+}
@@ -0,0 +1,55 @@
+/*
+ *  NearestNodeIndex.h
+ *  gnome
+ *
+ *  k-d tree over the water nodes of a curvilinear grid, for the velocity of
+ *  the nearest water node at an LE off the grid. Distances are on the
+ *  LongPoint positions with the longitudes shrunk by the cosine of the
+ *  grid's middle latitude, close enough to meters over one grid.
+ *
+ */
+
+#ifndef __NearestNodeIndex__
+#define __NearestNodeIndex__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+class NearestNodeIndex
+{
+	public:
+						NearestNodeIndex();
+						~NearestNodeIndex() {Dispose();}
+		void			Dispose();
+
+		// point i is a water node if verdatToNetCDFH[i] >= 0, no handle is kept
+		OSErr			Build(LongPointHdl ptsH, LONGH verdatToNetCDFH);
+
+		// the water node nearest pt, -1 if there are none. hint is a node
+		// found before (the LE's last) or -1, the search skips what is
+		// farther than it
+		long			Nearest(LongPoint pt, long hint = -1) const;
+
+		long			GetNumNodes() const {return (long)fNodes.size();}
+
+	private:
+		typedef struct {
+			double	x, y;	// scaled position
+			long	pt;		// index of the grid point
+		} Node;
+
+		// a balanced tree in place: the median of fNodes[first, last) splits
+		// it, on x at even depths and on y at odd ones
+		std::vector<Node>	fNodes;
+		std::vector<long>	fNodeOfPoint;	// the position in fNodes of a grid point, -1 for land
+		double				fLongScale;
+
+		static bool		NodeXLess(const Node &a, const Node &b) {return a.x < b.x;}
+		static bool		NodeYLess(const Node &a, const Node &b) {return a.y < b.y;}
+		void			BuildSubtree(long first, long last, int axis);
+		void			Search(long first, long last, int axis, double x, double y, long *best, double *bestDist) const;
+};
+
+#endif
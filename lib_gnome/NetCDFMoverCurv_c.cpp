@@ -19,6 +19,7 @@
 #include "StringFunctions.h"
 #include "DagTree.h"
 #include "DagTreeIO.h"
+#include "GridMapUtils.h"
 
 NetCDFMoverCurv_c::NetCDFMoverCurv_c (TMap *owner, char *name) : NetCDFMover_c(owner, name)
 {
@@ -484,7 +485,7 @@ scale:
 	return true;
 }
 
-WorldPoint3D NetCDFMoverCurv_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D NetCDFMoverCurv_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {{0,0},0.};
 	WorldPoint refPoint = (*theLE).p;	
@@ -1331,12 +1332,11 @@ OSErr NetCDFMoverCurv_c::ReorderPoints(DOUBLEH landmaskH, TMap **newMap, char* e
 	long i, j, n, ntri, numVerdatPts=0;
 	long fNumRows_ext = fNumRows+1, fNumCols_ext = fNumCols+1;
 	long nv = fNumRows * fNumCols, nv_ext = fNumRows_ext*fNumCols_ext;
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long iIndex,jIndex,index,currentIndex,startIndex; 
+	long iIndex,jIndex,index; 
 	long triIndex1,triIndex2,waterCellNum=0;
 	long ptIndex = 0,cellNum = 0,diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	OSErr err = 0;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(fNumRows * fNumCols * sizeof(long));
@@ -1355,7 +1355,6 @@ OSErr NetCDFMoverCurv_c::ReorderPoints(DOUBLEH landmaskH, TMap **newMap, char* e
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -1722,7 +1721,6 @@ OSErr NetCDFMoverCurv_c::ReorderPoints(DOUBLEH landmaskH, TMap **newMap, char* e
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv_ext * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv_ext * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -1827,37 +1825,10 @@ OSErr NetCDFMoverCurv_c::ReorderPoints(DOUBLEH landmaskH, TMap **newMap, char* e
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		// clean up handles and set grid without a map
@@ -1867,40 +1838,6 @@ findnewstartpoint:
 		goto setFields;
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	fVerdatToNetCDFH = verdatPtsH;
@@ -2025,7 +1962,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	
@@ -2418,11 +2354,9 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMaskOld(TMap **newMap, DOUBLEH landma
 	long triIndex1, triIndex2, waterCellNum=0;
 	long ptIndex = 0, cellNum = 0;
 	
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long currentIndex,startIndex; 
 	long diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(nCells * sizeof(long));
 	LONGH maskH2 = (LONGH)_NewHandleClear(nv * sizeof(long));
@@ -2440,7 +2374,6 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMaskOld(TMap **newMap, DOUBLEH landma
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -2657,7 +2590,6 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMaskOld(TMap **newMap, DOUBLEH landma
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -2767,37 +2699,10 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMaskOld(TMap **newMap, DOUBLEH landma
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		// clean up handles and set grid without a map
@@ -2807,40 +2712,6 @@ findnewstartpoint:
 		goto setFields;
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	fVerdatToNetCDFH = verdatPtsH;
@@ -2899,7 +2770,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	
@@ -2963,11 +2833,9 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMask(DOUBLEH landmaskH, TMap **newMap
 	long triIndex1, triIndex2, waterCellNum=0;
 	long ptIndex = 0, cellNum = 0;
 
-	long currentIsland=0, islandNum, nBoundaryPts=0, nEndPts=0, waterStartPoint;
 	long nSegs, segNum = 0, numIslands, rectIndex; 
-	long currentIndex,startIndex; 
 	long diag = 1;
-	Boolean foundPt = false, isOdd;
+	Boolean isOdd;
 	
 	LONGH landWaterInfo = (LONGH)_NewHandleClear(nCells * sizeof(long));
 	LONGH maskH2 = (LONGH)_NewHandleClear(nv * sizeof(long));
@@ -2985,7 +2853,6 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMask(DOUBLEH landmaskH, TMap **newMap
 	LONGH boundaryPtsH = 0;
 	LONGH boundaryEndPtsH = 0;
 	LONGH waterBoundaryPtsH = 0;
-	Boolean** segUsed = 0;
 	SegInfoHdl segList = 0;
 	LONGH flagH = 0;
 	
@@ -3308,7 +3175,6 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMask(DOUBLEH landmaskH, TMap **newMap
 	boundaryEndPtsH = (LONGH)_NewHandleClear(nv * sizeof(**boundaryEndPtsH));
 	waterBoundaryPtsH = (LONGH)_NewHandleClear(nv * sizeof(**waterBoundaryPtsH));
 	flagH = (LONGH)_NewHandleClear(nv * sizeof(**flagH));
-	segUsed = (Boolean**)_NewHandleClear(nSegs * sizeof(Boolean));
 	segList = (SegInfoHdl)_NewHandleClear(nSegs * sizeof(**segList));
 	// first go through rectangles and group by island
 	// do this before making dagtree, 
@@ -3418,37 +3284,10 @@ OSErr NetCDFMoverCurv_c::ReorderPointsCOOPSMask(DOUBLEH landmaskH, TMap **newMap
 	}
 	nSegs = segNum;
 	_SetHandleSize((Handle)segList,nSegs*sizeof(**segList));
-	_SetHandleSize((Handle)segUsed,nSegs*sizeof(**segUsed));
 	// go through list of segments, and make list of boundary segments
 	// as segment is taken mark so only use each once
 	// get a starting point, add the first and second to the list
-	islandNum = 3;
-findnewstartpoint:
-	if (islandNum > numIslands) 
-	{
-		_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-		_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-		_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-		goto setFields;	// off by 2 - 0,1,2 are water cells, 3 and up are land
-	}
-	foundPt = false;
-	for (i=0;i<nSegs;i++)
-	{
-		if ((*segUsed)[i]) continue;
-		waterStartPoint = nBoundaryPts;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt1;
-		(*flagH)[(*segList)[i].pt1] = 1;
-		(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-		(*boundaryPtsH)[nBoundaryPts++] = (*segList)[i].pt2;
-		(*flagH)[(*segList)[i].pt2] = 1;
-		currentIndex = (*segList)[i].pt2;
-		startIndex = (*segList)[i].pt1;
-		currentIsland = (*segList)[i].islandNumber;	
-		foundPt = true;
-		(*segUsed)[i] = true;
-		break;
-	}
-	if (!foundPt)
+	if (!TraceBoundarySegments(segList, nSegs, numIslands, boundaryPtsH, waterBoundaryPtsH, boundaryEndPtsH, flagH))
 	{
 		printNote("Lost trying to set boundaries");
 		// clean up handles and set grid without a map
@@ -3458,40 +3297,6 @@ findnewstartpoint:
 		goto setFields;
 	}
 	
-findnextpoint:
-	for (i=0;i<nSegs;i++)
-	{
-		// look for second point of the previous selected segment, add the second to point list
-		if ((*segUsed)[i]) continue;
-		if ((*segList)[i].islandNumber > 3 && (*segList)[i].islandNumber != currentIsland) continue;
-		if ((*segList)[i].islandNumber > 3 && currentIsland <= 3) continue;
-		index = (*segList)[i].pt1;
-		if (index == currentIndex)	// found next point
-		{
-			currentIndex = (*segList)[i].pt2;
-			(*segUsed)[i] = true;
-			if (currentIndex == startIndex) // completed a segment
-			{
-				islandNum++;
-				(*boundaryEndPtsH)[nEndPts++] = nBoundaryPts-1;
-				(*waterBoundaryPtsH)[waterStartPoint] = (*segList)[i].isWater+1;	// need to deal with this
-				goto findnewstartpoint;
-			}
-			else
-			{
-				(*boundaryPtsH)[nBoundaryPts] = (*segList)[i].pt2;
-				(*flagH)[(*segList)[i].pt2] = 1;
-				(*waterBoundaryPtsH)[nBoundaryPts] = (*segList)[i].isWater+1;
-				nBoundaryPts++;
-				goto findnextpoint;
-			}
-		}
-	}
-	// shouldn't get here unless there's a problem...
-	_SetHandleSize((Handle)boundaryPtsH,nBoundaryPts*sizeof(**boundaryPtsH));
-	_SetHandleSize((Handle)waterBoundaryPtsH,nBoundaryPts*sizeof(**waterBoundaryPtsH));
-	_SetHandleSize((Handle)boundaryEndPtsH,nEndPts*sizeof(**boundaryEndPtsH));
-	
 setFields:	
 	
 	fVerdatToNetCDFH = verdatPtsH;
@@ -3551,7 +3356,6 @@ done:
 	if (landWaterInfo) {DisposeHandle((Handle)landWaterInfo); landWaterInfo=0;}
 	if (ptIndexHdl) {DisposeHandle((Handle)ptIndexHdl); ptIndexHdl = 0;}
 	if (gridCellInfo) {DisposeHandle((Handle)gridCellInfo); gridCellInfo = 0;}
-	if (segUsed) {DisposeHandle((Handle)segUsed); segUsed = 0;}
 	if (segList) {DisposeHandle((Handle)segList); segList = 0;}
 	if (flagH) {DisposeHandle((Handle)flagH); flagH = 0;}
 	
@@ -40,7 +40,7 @@ public:
 	LongPointHdl		GetPointsHdl();
 	virtual Boolean 	VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
 	VelocityRec 		GetInterpolatedValue(InterpolationValBilinear interpolationVal,float depth,float totalDepth);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
 	//VelocityRec 		GetMove3D(InterpolationValBilinear interpolationVal,float depth,float totalDepth);
 	/*long 				CheckSurroundingPoints(LONGH maskH, long numRows, long  numCols, long row, long col) ;
 	Boolean 			InteriorLandPoint(LONGH maskH, long numRows, long  numCols, long row, long col); 
@@ -17,6 +17,7 @@
 #include "netcdf.h"
 #include "CompFunctions.h"
 #include "StringFunctions.h"
+#include "TimeInterval.h"
 #include <math.h>
 #include <float.h>
 
@@ -69,6 +70,7 @@ NetCDFMover_c::NetCDFMover_c (TMap *owner, char *name) : CurrentMover_c(owner, n
 	fIsOptimizedForStep = false;
 	fOverLap = false;		// for multiple files case
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	
 	fFillValue = -1e+34;
 	fIsNavy = false;	
@@ -99,7 +101,7 @@ NetCDFMover_c::NetCDFMover_c (TMap *owner, char *name) : CurrentMover_c(owner, n
 #endif
 
 
-OSErr NetCDFMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr NetCDFMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -178,7 +180,7 @@ OSErr NetCDFMover_c::PrepareForModelRun()
 }
 
 
-OSErr NetCDFMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr NetCDFMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	long timeDataInterval;
 	OSErr err=0;
@@ -218,7 +220,7 @@ Boolean NetCDFMover_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 {
 	Seconds time =  model_time, startTime, endTime;	
 	
-	long i,numTimes,numFiles = GetNumFiles();
+	long numTimes,numFiles = GetNumFiles();
 	
 	numTimes = this -> GetNumTimesInFile(); 
 	if (numTimes==0) {timeDataInterval = 0; return false;}	// really something is wrong, no data exists
@@ -249,15 +251,9 @@ Boolean NetCDFMover_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 		else fOverLap = false;
 	}
 	
-	//for (i=0;i<numTimes;i++) 
-	for (i=0;i<numTimes-1;i++) 
-	{	// find the time interval
-		if (time>=((*fTimeHdl)[i] + fTimeShift) && time<=((*fTimeHdl)[i+1] + fTimeShift))
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(ShiftedTimes(fTimeHdl, fTimeShift), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<((*fTimeHdl)[0] + fTimeShift)) 
 	{
@@ -978,7 +974,7 @@ long NetCDFMover_c::GetNumDepths(void)
 	return numDepths;
 }
 
-OSErr NetCDFMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+OSErr NetCDFMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
 
 	if(!ref || !delta) {
 		//cout << "worldpoints array not provided! returning.\n";
@@ -999,7 +995,7 @@ OSErr NetCDFMover_c::get_move(int n, Seconds model_time, Seconds step_len, World
 	
 	WorldPoint3D zero_delta ={0,0,0.};
 	
-	for (int i = 0; i < n; i++) {
+	for (LECount i = 0; i < n; i++) {
 		
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -1023,7 +1019,7 @@ OSErr NetCDFMover_c::get_move(int n, Seconds model_time, Seconds step_len, World
 	return noErr;
 }
 
-WorldPoint3D NetCDFMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D NetCDFMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	WorldPoint3D	deltaPoint = {{0,0},0.};
 	WorldPoint refPoint = (*theLE).p;	
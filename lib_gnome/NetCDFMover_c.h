@@ -84,6 +84,7 @@ public:
 	Boolean fIsOptimizedForStep;
 	Boolean fOverLap;
 	Seconds fOverLapStartTime;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	PtCurFileInfoH	fInputFilesHdl;
 	long fTimeShift;		// to convert GMT to local time
 	Boolean fAllowExtrapolationOfCurrentsInTime;
@@ -100,7 +101,7 @@ public:
 	//virtual ClassID 	GetClassID () { return TYPE_NETCDFMOVER; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_NETCDFMOVER) return TRUE; return TCurrentMover::IAm(id); }
 
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	virtual long 		GetVelocityIndex(WorldPoint p);
 	virtual LongPoint 	GetVelocityIndices(WorldPoint wp);
 	VelocityRec			GetPatValue (WorldPoint p);
@@ -125,8 +126,8 @@ public:
 #endif
 	virtual OSErr 		PrepareForModelRun(); 
 	float		GetTotalDepth(WorldPoint refPoint, long triNum);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	
 	long 					GetNumTimesInFile();
@@ -145,7 +146,7 @@ public:
 	virtual OSErr 	GetDepthProfileAtPoint(WorldPoint refPoint, long timeIndex, DepthValuesSetH *profilesH) {*profilesH=nil; return 0;}
 	
 
-			OSErr		get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+			OSErr		get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
 
 };
 
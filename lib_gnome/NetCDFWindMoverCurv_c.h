@@ -28,7 +28,7 @@ public:
 
 	LongPointHdl		GetPointsHdl();
 	virtual Boolean 	VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
 	VelocityRec 		GetInterpolatedMove(InterpolationValBilinear interpolationVal);
 	OSErr 				ReorderPoints(TMap **newMap, char* errmsg); 
 	OSErr 				ReorderPointsCOOPSNoMask(TMap **newMap, char* errmsg); 
@@ -42,6 +42,7 @@ NetCDFWindMover_c::NetCDFWindMover_c(TMap *owner,char* name) : WindMover_c(owner
 	
 	fOverLap = false;
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	fInputFilesHdl = 0; 
 }
 
@@ -245,7 +246,7 @@ OSErr NetCDFWindMover_c::PrepareForModelRun()
 	return WindMover_c::PrepareForModelRun();
 }
 
-OSErr NetCDFWindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr NetCDFWindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	OSErr err = 0;
 
@@ -288,7 +289,7 @@ void NetCDFWindMover_c::ModelStepIsDone()
 }
 
 
-WorldPoint3D NetCDFWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D NetCDFWindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double 	dLong, dLat;
 	WorldPoint3D	deltaPoint ={0,0,0.};
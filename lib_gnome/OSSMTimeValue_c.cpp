@@ -7,12 +7,15 @@
  *
  */
 #include <iostream>
+#include <typeinfo>
 
 #include "OSSMTimeValue_c.h"
 #include "CompFunctions.h"
 #include "StringFunctions.h"
 #include "OUTILS.H"
 #include "TimeValuesIO.h"
+#include "TopologyCache.h"
+#include "TimeValuesCache.h"
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -22,6 +25,26 @@
 
 using namespace std;
 
+#define kNumTimeFileTypeLines 8	// the lines the Is...File functions look at
+
+// the cache key of the values read from path with these settings, 0 when
+// the cache is off
+static uint64_t GetTimeValuesCacheKey(const char *path, const char *reader, short format,
+									  double conversionFactor, long numHeaderLines)
+{
+	uint64_t hash;
+
+	if (!TimeValuesCacheIsOn())
+		return 0;
+
+	hash = TopologyCacheHash(reader, strlen(reader));
+	hash = TopologyCacheHash(&format, sizeof(format), hash);
+	hash = TopologyCacheHash(&conversionFactor, sizeof(conversionFactor), hash);
+	hash = TopologyCacheHash(&numHeaderLines, sizeof(numHeaderLines), hash);
+
+	return TimeValuesCacheKey(path, hash);
+}
+
 OSSMTimeValue_c::OSSMTimeValue_c() : TimeValue_c()
 { 
 	fileName[0]=0;
@@ -37,6 +60,18 @@ OSSMTimeValue_c::OSSMTimeValue_c() : TimeValue_c()
 	bOSSMStyle = true;
 	fTransport = 0;
 	fVelAtRefPt = 0;
+	fTimeIndex = 0;
+	fHermiteValues = 0;
+	fHermiteNumValues = 0;
+	bHermiteCoefsOK = false;
+	fAveragingKey = 0;
+	fRunningAverageKey = 0;
+	bRunningAverageUsedModelTime = false;
+	fStepValuesStart = 0;
+	fStepValuesTimeStep = 0;
+	fStepValuesKey = 0;
+	fStepTimesKey = 0;
+	fRunningAverageModelTime = 0;
 //#ifdef pyGNOME
 	fInterpolationType = LINEAR;
 //#else
@@ -60,6 +95,18 @@ OSSMTimeValue_c::OSSMTimeValue_c(TMover *theOwner) : TimeValue_c(theOwner)
 	bOSSMStyle = true;
 	fTransport = 0;
 	fVelAtRefPt = 0;
+	fTimeIndex = 0;
+	fHermiteValues = 0;
+	fHermiteNumValues = 0;
+	bHermiteCoefsOK = false;
+	fAveragingKey = 0;
+	fRunningAverageKey = 0;
+	bRunningAverageUsedModelTime = false;
+	fStepValuesStart = 0;
+	fStepValuesTimeStep = 0;
+	fStepValuesKey = 0;
+	fStepTimesKey = 0;
+	fRunningAverageModelTime = 0;
 	//fInterpolationType = HERMITE;	// pyGNOME doesn't use this constructor
 	fInterpolationType = LINEAR;	// pyGNOME doesn't use this constructor
 }
@@ -115,12 +162,47 @@ OSErr OSSMTimeValue_c::GetTimeChange(long a, long b, Seconds *dt)
 }
 
 
+// first value at or after forTime, which must be within the times
+long OSSMTimeValue_c::GetTimeIndex(Seconds forTime, long n)
+{
+	long startIndex, midIndex, endIndex, i = fTimeIndex;
+
+	// model time mostly moves forward, so the last bracket or the next one has it
+	if (i > 0 && i < n && INDEXH(timeValues, i - 1).time < forTime) {
+		if (forTime <= INDEXH(timeValues, i).time)
+			return i;
+		if (i + 1 < n && forTime <= INDEXH(timeValues, i + 1).time) {
+			fTimeIndex = i + 1;
+			return i + 1;
+		}
+	}
+
+	// JLM 7/21/00, use a binary method for when we have a lot of values
+	startIndex = 0;
+	endIndex = n - 1;
+	while(endIndex - startIndex > 3) {
+		midIndex = (startIndex + endIndex) / 2;
+		if (forTime <= INDEXH(timeValues, midIndex).time)
+			endIndex = midIndex;
+		else
+			startIndex = midIndex;
+	}
+
+	for (i = startIndex; i < n - 1; i++) {
+		if (forTime <= INDEXH(timeValues, i).time)
+			break;
+	}
+
+	// only written when it moves, so threads asking for the same time don't write it
+	if (i != fTimeIndex)
+		fTimeIndex = i;
+	return i;
+}
+
 OSErr OSSMTimeValue_c::GetInterpolatedComponent(Seconds forTime, double *value, short index)
 {
 	OSErr err = 0;
 
-	long startIndex, midIndex, endIndex;
-
 	long a, b, n = GetNumValues();
 	double dv, slope, slope1, slope2, intercept;
 	Seconds dt;
@@ -201,35 +283,14 @@ OSErr OSSMTimeValue_c::GetInterpolatedComponent(Seconds forTime, double *value,
 	}
 	
 	// find before and after elements
-	
-	/////////////////////////////////////////////////
-	// JLM 7/21/00, we need to speed this up for when we have a lot of values
-	// code goes here, (should we use a static to remember a guess of where to start) before we do the binary search ?
-	// use a binary method 
-	startIndex = 0;
-	endIndex = n - 1;
-	while(endIndex - startIndex > 3) {
-		midIndex = (startIndex + endIndex) / 2;
-		if (forTime <= INDEXH(timeValues, midIndex).time)
-			endIndex = midIndex;
-		else
-			startIndex = midIndex;
-	}
-
-	for (long i = startIndex; i < n; i++) {
-		if (forTime <= INDEXH(timeValues, i).time) {
-			dt = INDEXH(timeValues, i).time - forTime;
-			if (dt <= TIMEVALUE_TOLERANCE) {
-				// found match
-				(*value) = UorV(INDEXH(timeValues, i).value, index);
-				return 0;
-			}
-			
-			a = i - 1;
-			b = i;
-			break;
-		}
+	b = GetTimeIndex(forTime, n);
+	dt = INDEXH(timeValues, b).time - forTime;
+	if (dt <= TIMEVALUE_TOLERANCE) {
+		// found match
+		(*value) = UorV(INDEXH(timeValues, b).value, index);
+		return 0;
 	}
+	a = b - 1;
 
 	dv = UorV(INDEXH(timeValues, b).value, index)
 	   - UorV(INDEXH(timeValues, a).value, index);
@@ -258,6 +319,16 @@ OSErr OSSMTimeValue_c::GetInterpolatedComponent(Seconds forTime, double *value,
 	
 	// interpolated value is between positions a and b
 	
+	if (CheckHermiteCoefs(n)) {
+		const double *c = &fHermiteCoefs[8 * a + 4 * index];
+		double t1 = INDEXH(timeValues, a).time, t2 = INDEXH(timeValues, b).time;
+		double x = (forTime - t1) / (t2 - t1);
+
+		// as Hermite() has it
+		(*value) = c[0] * x * x * x + c[1] * x * x + c[2] * x + c[3];
+		return 0;
+	}
+
 	// compute slopes before using Hermite()
 	
 	if (b == 1) {
@@ -317,12 +388,69 @@ OSErr OSSMTimeValue_c::GetInterpolatedComponent(Seconds forTime, double *value,
 	return 0;
 }
 
+// Makes the cubics for the values if they changed, with the slopes the
+// interpolation works out: the mean of the slopes of the interval and its
+// neighbours, the interval's own at the ends. False if the values have
+// duplicate times.
+Boolean OSSMTimeValue_c::CheckHermiteCoefs(long n)
+{
+	vector<double> slopes;
+	double v1, v2, s1, s2, dt;
+	long i;
+	short index;
+
+	if (fHermiteValues == timeValues && fHermiteNumValues == n)
+		return bHermiteCoefsOK;
+
+	fHermiteValues = timeValues;
+	fHermiteNumValues = n;
+	bHermiteCoefsOK = false;
+	fHermiteCoefs.clear();
+	if (n < 3)
+		return false;
+
+	slopes.resize(2 * (n - 1));
+	for (i = 0; i < n - 1; i++) {
+		Seconds dSecs = INDEXH(timeValues, i + 1).time - INDEXH(timeValues, i).time;
+
+		if (INDEXH(timeValues, i + 1).time <= INDEXH(timeValues, i).time)
+			return false;
+		for (index = 0; index < 2; index++)
+			slopes[2 * i + index] = (UorV(INDEXH(timeValues, i + 1).value, index)
+									 - UorV(INDEXH(timeValues, i).value, index)) / dSecs;
+	}
+
+	fHermiteCoefs.resize(8 * (n - 1));
+	for (i = 0; i < n - 1; i++) {
+		dt = (double)INDEXH(timeValues, i + 1).time - (double)INDEXH(timeValues, i).time;
+		for (index = 0; index < 2; index++) {
+			double *c = &fHermiteCoefs[8 * i + 4 * index];
+
+			v1 = UorV(INDEXH(timeValues, i).value, index);
+			v2 = UorV(INDEXH(timeValues, i + 1).value, index);
+			s1 = i == 0 ? slopes[index] : 0.5 * (slopes[2 * (i - 1) + index] + slopes[2 * i + index]);
+			s2 = i == n - 2 ? slopes[2 * i + index] : 0.5 * (slopes[2 * (i + 1) + index] + slopes[2 * i + index]);
+
+			s1 = s1 * dt;
+			s2 = s2 * dt;
+			c[0] = 2.0 * v1 - 2.0 * v2 + s1 + s2;
+			c[1] = - 3.0 * v1 + 3.0 * v2 - 2.0 * s1 - s2;
+			c[2] = s1;
+			c[3] = v1;
+		}
+	}
+
+	bHermiteCoefsOK = true;
+	return true;
+}
+
 void OSSMTimeValue_c::SetTimeValueHandle(TimeValuePairH t)
 {
 	if (timeValues && t != timeValues)
 		DisposeHandle((Handle)timeValues);
 
 	timeValues = t;
+	fHermiteValues = 0;
 }
 
 
@@ -332,6 +460,13 @@ void OSSMTimeValue_c::Dispose()
 		DisposeHandle((Handle)timeValues);
 		timeValues = 0;
 	}
+	fHermiteValues = 0;
+	fHermiteCoefs.clear();
+	fAveragingValues.clear();
+	fRunningAverage.clear();
+	fStepValues.clear();
+	fStepErrors.clear();
+	fStepTimesKey = 0;
 	
 	TimeValue_c::Dispose();
 }
@@ -395,6 +530,7 @@ OSErr OSSMTimeValue_c::CheckStartTime(Seconds forTime)
 
 OSErr OSSMTimeValue_c::GetTimeValue(const Seconds& forTime, VelocityRec *value)
 {
+	GnomeLock valueLock(fValueMutex);
 	OSErr err = 0;
 
 	if (!timeValues || _GetHandleSize((Handle)timeValues) == 0) {
@@ -414,6 +550,15 @@ OSErr OSSMTimeValue_c::GetTimeValue(const Seconds& forTime, VelocityRec *value)
 }
 
 
+OSErr OSSMTimeValue_c::GetTimeValues(const Seconds *times, long n, VelocityRec *values)
+{
+	// the mutex is recursive: each GetTimeValue takes it again, the batch holds it throughout
+	GnomeLock valueLock(fValueMutex);
+
+	return TimeValue_c::GetTimeValues(times, n, values);
+}
+
+
 void OSSMTimeValue_c::RescaleTimeValues (double oldScaleFactor, double newScaleFactor)
 {
 	long numValues = GetNumValues();
@@ -430,6 +575,7 @@ void OSSMTimeValue_c::RescaleTimeValues (double oldScaleFactor, double newScaleF
 
 		INDEXH(timeValues, i) = tv;
 	}
+	fHermiteValues = 0;
 
 	return;
 }
@@ -476,6 +622,7 @@ OSErr OSSMTimeValue_c::ReadNCDCWind(char *path)
 	long numDataLines;
 	long numHeaderLines = 1;
 	long numValues, numLines, numScanned;
+	uint64_t cacheKey;
 
 	double value1, value2, magnitude, degrees;
 
@@ -502,6 +649,11 @@ OSErr OSSMTimeValue_c::ReadNCDCWind(char *path)
 	numDataLines = numLines - numHeaderLines;
 
     this->SetUserUnits(kMilesPerHour);	//check this
+
+	cacheKey = GetTimeValuesCacheKey(path, "NCDC", format, conversionFactor, numHeaderLines);
+	fHermiteValues = 0;
+	if (cacheKey && !ReadTimeValuesCache(cacheKey, &timeValues))
+		goto done;
 	
 	timeValues = (TimeValuePairH)_NewHandle(numDataLines * sizeof(TimeValuePair));
 	if (!timeValues) {
@@ -644,6 +796,9 @@ OSErr OSSMTimeValue_c::ReadNCDCWind(char *path)
 		err = true;
 	}
 
+	if (!err && cacheKey)
+		WriteTimeValuesCache(cacheKey, timeValues);	// not fatal if this fails
+
 done:
 
 	if (f) {
@@ -659,11 +814,12 @@ done:
 	return err;
 }
 
-OSErr OSSMTimeValue_c::ReadNDBCWind(vector<string> &linesInFile, long numHeaderLines)
+OSErr OSSMTimeValue_c::ReadNDBCWind(TextLines &linesInFile, long numHeaderLines)
 {
 	OSErr err = noErr;
 
 	DateTimeRec time;
+	string currentLine;
 
 	long numValues = 0;
 	long numLines = linesInFile.size();
@@ -672,6 +828,7 @@ OSErr OSSMTimeValue_c::ReadNDBCWind(vector<string> &linesInFile, long numHeaderL
 	time.second = 0;
 	this->SetUserUnits(kMetersPerSec);	//check this
 
+	fHermiteValues = 0;
 	timeValues = (TimeValuePairH)_NewHandle(numDataLines * sizeof(TimeValuePair));
 	if (!timeValues) {
 		err = -1;
@@ -690,49 +847,47 @@ OSErr OSSMTimeValue_c::ReadNDBCWind(vector<string> &linesInFile, long numHeaderL
 
 		double conversionFactor = 1.0;	// wind speeds are in mps
 		double u, v;
-		string value1S, value2S;
+		TextLine value1S, value2S;
 		TimeValuePair pair;
-		string 	currentLine = trim(linesInFile[i]);
+		const char *p, *end;
 
+		currentLine = linesInFile[i];
+		trim(currentLine);
 
 		if (currentLine.size() == 0)
 			continue; // it's a blank line, allow this and skip the line
 
-		istringstream lineStream(currentLine); // day, month, year, hour, min, value1, value2
+		// year, month, day, hour, [min,] value1, value2 read in place, as
+		// an istringstream of the line reads them
+		p = currentLine.c_str();
+		end = p + currentLine.size();
 
 		// first we read the date/time values
-		if (numHeaderLines == 1) {
-			lineStream >> time.year >> time.month >> time.day
-			>> time.hour;
-			time.minute = time.second = 0;
-		}
-		else {
-			lineStream >> time.year >> time.month >> time.day
-			>> time.hour >> time.minute;
-			time.second = 0;
-		}
-
-		if (lineStream.fail()) {
+		if (!ScanValue(p, end, time.year) || !ScanValue(p, end, time.month) ||
+			!ScanValue(p, end, time.day) || !ScanValue(p, end, time.hour) ||
+			(numHeaderLines != 1 && !ScanValue(p, end, time.minute))) {
 			err = -1;
 			string errMsg = "Invalid date in data row: '";
-			errMsg += linesInFile[i] + "'";
+			errMsg += currentLine + "'";
 			TechError("OSSMTimeValue_c::ReadNDBCWind()",(char*)errMsg.c_str(), 0);
 			goto done;
 		}
+		if (numHeaderLines == 1)
+			time.minute = 0;
+		time.second = 0;
 
 		// check date is valid
 		if (!DateIsValid(time)){
 			err = -1;
 			string errMsg = "Invalid date in data row: '";
-			errMsg += linesInFile[i] + "'";
+			errMsg += currentLine + "'";
 			TechError( "OSSMTimeValue_c::ReadNDBCWind()",(char*)errMsg.c_str(), 0);
 			goto done;
 		}
 
 		CorrectTwoDigitYear(time);
 
-		lineStream >> value1S >> value2S;
-		if (lineStream.fail()) {
+		if (!ScanWord(p, end, value1S) || !ScanWord(p, end, value2S)) {
 			// scan will allow comment at end of line, for now just ignore
 			err = -1;
 			TechError("OSSMTimeValue_c::ReadTimeValues()", "scan data values", 0);
@@ -787,9 +942,17 @@ done:
 }
 
 
+OSErr OSSMTimeValue_c::ReadNDBCWind(vector<string> &linesInFile, long numHeaderLines)
+{
+	TextLines lines(linesInFile);
+
+	return ReadNDBCWind(lines, numHeaderLines);
+}
+
+
 OSErr OSSMTimeValue_c::ReadNDBCWind(char *path, long numHeaderLines)
 {
-	vector<string> linesInFile;
+	TextLines linesInFile;
 
 	if (ReadLinesInFile(path, linesInFile)) {
 		return ReadNDBCWind(linesInFile, numHeaderLines);
@@ -826,6 +989,7 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 	time.second = 0;
 
 	timeValues = 0;
+	fHermiteValues = 0;
 	this->fileName[0] = 0;
 	this->filePath[0] = 0;
 
@@ -847,17 +1011,33 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 	//strcpy(this->fileName, path); // for now use full path
 //#endif
 
-	vector<string> linesInFile;
-	if (ReadLinesInFile(path, linesInFile)) {
-		linesInFile = rtrim_empty_lines(linesInFile);
-	}
-	else
+	TextLines linesInFile;
+	vector<string> headerLines;
+	string currentLine;
+	uint64_t cacheKey = 0;
+
+	if (!ReadLinesInFile(path, linesInFile))
 		return -1; // we failed to read in the file.
 
+	// without the empty lines at the end, like rtrim_empty_lines
 	numLines = linesInFile.size();
-
-	if (IsNDBCWindFile(linesInFile, &numHeaderLines)) {
+	while (numLines > 1 && linesInFile[numLines - 1].size() == 0)
+		numLines--;
+
+	// the kind of file is told from its first lines. These include the empty
+	// lines at the end, which the checks of a short file may read
+	for (long i = 0; i < linesInFile.size() && i < kNumTimeFileTypeLines; i++)
+		headerLines.push_back(linesInFile[i]);
+
+	if (IsNDBCWindFile(headerLines, &numHeaderLines)) {
+		cacheKey = GetTimeValuesCacheKey(path, "NDBC", M19DEGREESMAGNITUDE, 1.0, numHeaderLines);
+		if (cacheKey && !ReadTimeValuesCache(cacheKey, &timeValues)) {
+			this->SetUserUnits(kMetersPerSec);	// what ReadNDBCWind sets
+			return noErr;
+		}
 		err = ReadNDBCWind(linesInFile, numHeaderLines); //scan is different
+		if (!err && cacheKey)
+			WriteTimeValuesCache(cacheKey, timeValues);	// not fatal if this fails
 		return err;
 		// or
 		// selectedUnits = kMetersPerSec;
@@ -866,7 +1046,7 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 		// units/format always the same
 	}
 	
-	if (IsNCDCWindFile(linesInFile)) {
+	if (IsNCDCWindFile(headerLines)) {
 		err = ReadNCDCWind(path); 
 		return err;
 		// or
@@ -878,7 +1058,7 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 	
 	if( numLines >= 5)
 	{
-		if (IsLongWindFile(linesInFile, &selectedUnits, &dataInGMT)) {
+		if (IsLongWindFile(headerLines, &selectedUnits, &dataInGMT)) {
 			askForUnits = false;
 			numHeaderLines = 5;
 			isLongWindFile = true;
@@ -886,11 +1066,11 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 	}
 	if(numLines >= 3 && !isLongWindFile)
 	{
-		if (IsOSSMTimeFile(linesInFile, &selectedUnits)) {
+		if (IsOSSMTimeFile(headerLines, &selectedUnits)) {
 			numHeaderLines = 3;
 			ReadOSSMTimeHeader(path);
 		}
-		else if ((isHydrologyFile = IsHydrologyFile(linesInFile)) == true) {
+		else if ((isHydrologyFile = IsHydrologyFile(headerLines)) == true) {
 			// ask for scale factor, but not units
 			SetFileType(HYDROLOGYFILE);
 			numHeaderLines = 3;
@@ -961,6 +1141,10 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 		}
 	}
 	
+	cacheKey = GetTimeValuesCacheKey(path, "OSSM", format, conversionFactor, numHeaderLines);
+	if (cacheKey && !ReadTimeValuesCache(cacheKey, &timeValues))
+		goto done;
+
 	numDataLines = numLines - numHeaderLines;
 	timeValues = (TimeValuePairH)_NewHandle(numDataLines * sizeof(TimeValuePair));
 	if (!timeValues) {
@@ -978,19 +1162,24 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 			continue; // skip any header lines
 
 		double u, v;
-		string value1S, value2S;
-		string 	currentLine = trim(linesInFile[i]);
+		TextLine value1S, value2S;
+		const char *p, *end;
+
+		currentLine = linesInFile[i];
+		trim(currentLine);
 
 		if (currentLine.size() == 0)
 			continue; // it's a blank line, allow this and skip the line
 
 		std::replace(currentLine.begin(), currentLine.end(), ',', ' ');
-		
-		istringstream lineStream(currentLine);
-		lineStream >> time.day >> time.month >> time.year
-					   >> time.hour >> time.minute;
 
-		if (lineStream.fail()) {
+		// read in place, as an istringstream of the line reads it
+		p = currentLine.c_str();
+		end = p + currentLine.size();
+
+		if (!ScanValue(p, end, time.day) || !ScanValue(p, end, time.month) ||
+			!ScanValue(p, end, time.year) || !ScanValue(p, end, time.hour) ||
+			!ScanValue(p, end, time.minute)) {
 			// scan will allow comment at end of line, for now just ignore 
 			err = -1;
 			TechError("TOSSMTimeValue::ReadTimeValues()", "scan date/time", 0);
@@ -1009,8 +1198,7 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 
 		CorrectTwoDigitYear(time);
 
-		lineStream >> value1S >> value2S;
-		if (lineStream.fail()) {
+		if (!ScanWord(p, end, value1S) || !ScanWord(p, end, value2S)) {
 			// scan will allow comment at end of line, for now just ignore
 			err = -1;
 			TechError("TOSSMTimeValue::ReadTimeValues()", "scan data values", 0);
@@ -1052,6 +1240,9 @@ OSErr OSSMTimeValue_c::ReadTimeValues(char *path, short format, short unitsIfKno
 		err = true;
 	}
 
+	if (!err && cacheKey)
+		WriteTimeValuesCache(cacheKey, timeValues);	// not fatal if this fails
+
 done:
 
 	if (err && timeValues) {
@@ -1390,6 +1581,46 @@ OSErr OSSMTimeValue_c::ConvertRowValuesToUV(string &value1, string &value2,
 }
 
 
+// the same conversion reading the words in place
+OSErr OSSMTimeValue_c::ConvertRowValuesToUV(const TextLine &value1, const TextLine &value2,
+											short format, double conversionFactor,
+											double &uOut, double &vOut)
+{
+	double magnitude, degrees;
+
+	switch (format) {
+		case M19REALREAL:
+			// no UV conversion necessary, just load the values and return
+			uOut = StreamValue(value1) * conversionFactor;
+			vOut = StreamValue(value2) * conversionFactor;
+			return noErr;
+			break;
+		case M19MAGNITUDEDEGREES:
+			magnitude = StreamValue(value1) * conversionFactor;
+			degrees = StreamValue(value2);
+			break;
+		case M19DEGREESMAGNITUDE:
+			degrees = StreamValue(value1);
+			magnitude = StreamValue(value2) * conversionFactor;
+			break;
+		case M19MAGNITUDEDIRECTION:
+			magnitude = StreamValue(value1) * conversionFactor;
+			degrees = ConvertToDegrees((char *)string(value2).c_str());
+			break;
+		case M19DIRECTIONMAGNITUDE:
+			magnitude = StreamValue(value2) * conversionFactor;
+			degrees = ConvertToDegrees((char *)string(value1).c_str());
+			break;
+		default:
+			return -1;
+	}
+
+	ConvertToUV(magnitude, degrees, &uOut, &vOut);
+
+	return noErr;
+}
+
+
 bool OSSMTimeValue_c::DateValuesAreZero(DateTimeRec &dateTime)
 {
 	return 	(dateTime.day == 0 && dateTime.month == 0 && dateTime.year == 0 &&
@@ -1417,6 +1648,144 @@ void OSSMTimeValue_c::CorrectTwoDigitYear(DateTimeRec &dateTime)
 }
 
 
+// Only the values of this class are known to depend on nothing but the time
+// values, a subclass (Shio) computes its own
+static Boolean AveragingValuesCanBeKept(OSSMTimeValue_c *timeValue)
+{
+	return typeid(*timeValue) == typeid(OSSMTimeValue_c);
+}
+
+
+// clears the kept values if the time values changed since they were looked up
+void OSSMTimeValue_c::CheckAveragingValues()
+{
+	GnomeLock valueLock(fValueMutex);
+	uint64_t key = kTopologyHashSeed;
+
+	if (timeValues)
+		key = TopologyCacheHash(*timeValues, _GetHandleSize((Handle)timeValues), key);
+	key = TopologyCacheHash(&fInterpolationType, sizeof(fInterpolationType), key);
+
+	if (key != fAveragingKey) {
+		fAveragingValues.clear();
+		fRunningAverage.clear();
+		fAveragingKey = key;
+	}
+}
+
+
+// GetTimeValue, kept by time for the running averages once it succeeds.
+// On an error the value is left the way GetTimeValue leaves it.
+// Call CheckAveragingValues() first.
+OSErr OSSMTimeValue_c::GetAveragingValue(const Seconds& forTime, VelocityRec *value)
+{
+	GnomeLock valueLock(fValueMutex);
+	map<Seconds, VelocityRec>::iterator it;
+	OSErr err;
+
+	if (!AveragingValuesCanBeKept(this))
+		return GetTimeValue(forTime, value);
+
+	it = fAveragingValues.find(forTime);
+	if (it != fAveragingValues.end()) {
+		*value = it->second;
+		return 0;
+	}
+
+	err = GetTimeValue(forTime, value);
+	if (!err) {
+		if (fAveragingValues.size() > 100000)	// a bound for very long runs
+			fAveragingValues.clear();
+		fAveragingValues[forTime] = *value;
+	}
+
+	return err;
+}
+
+
+uint64_t OSSMTimeValue_c::GetValuesKey()
+{
+	GnomeLock valueLock(fValueMutex);
+	uint64_t key = kTopologyHashSeed;
+
+	if (timeValues)
+		key = TopologyCacheHash(*timeValues, _GetHandleSize((Handle)timeValues), key);
+	return TopologyCacheHash(&fInterpolationType, sizeof(fInterpolationType), key);
+}
+
+
+// GetTimeValue at startTime and each timeStep after it, numSteps values, in
+// one pass. A mover sharing this object asking for the same times finds
+// them done
+OSErr OSSMTimeValue_c::PrepareStepValues(Seconds startTime, Seconds timeStep, long numSteps)
+{
+	GnomeLock valueLock(fValueMutex);
+	uint64_t valuesKey, timesKey;
+	vector<VelocityRec> values;
+	vector<OSErr> errors;
+	VelocityRec value;
+	long i;
+
+	if (numSteps <= 0 || timeStep <= 0)
+		return noErr;
+
+	valuesKey = GetValuesKey();
+	timesKey = TopologyCacheHash(&startTime, sizeof(startTime), valuesKey);
+	timesKey = TopologyCacheHash(&timeStep, sizeof(timeStep), timesKey);
+	timesKey = TopologyCacheHash(&numSteps, sizeof(numSteps), timesKey);
+	if (timesKey == fStepTimesKey && (long)fStepValues.size() == numSteps)
+		return noErr;
+
+	try {
+		values.resize(numSteps);
+		errors.resize(numSteps);
+	}
+	catch (...) {
+		return memFullErr;
+	}
+
+	for (i = 0; i < numSteps; i++) {
+		value.u = value.v = 0;
+		errors[i] = GetTimeValue(startTime + i * timeStep, &value);
+		values[i] = value;
+	}
+
+	fStepValues.swap(values);
+	fStepErrors.swap(errors);
+	fStepValuesStart = startTime;
+	fStepValuesTimeStep = timeStep;
+	// a Shio object's values were computed as they went, its key doesn't
+	// change with them
+	fStepValuesKey = GetValuesKey();
+	fStepTimesKey = timesKey;
+
+	return noErr;
+}
+
+
+Boolean OSSMTimeValue_c::GetStepValue(const Seconds& forTime, VelocityRec *value, OSErr *err)
+{
+	GnomeLock valueLock(fValueMutex);
+	Seconds sinceStart;
+	long i;
+
+	if (fStepValues.empty() || forTime < fStepValuesStart)
+		return false;
+
+	sinceStart = forTime - fStepValuesStart;
+	if (sinceStart % fStepValuesTimeStep != 0)
+		return false;
+
+	i = sinceStart / fStepValuesTimeStep;
+	if (i >= (long)fStepValues.size() || GetValuesKey() != fStepValuesKey)
+		return false;
+
+	*value = fStepValues[i];
+	*err = fStepErrors[i];
+	return true;
+}
+
+
 TimeValuePairH OSSMTimeValue_c::CalculateRunningAverage(long pastHoursToAverage, Seconds model_time)
 {	// will need to handle / return errors somehow
 	OSErr err = 0;
@@ -1425,7 +1794,8 @@ TimeValuePairH OSSMTimeValue_c::CalculateRunningAverage(long pastHoursToAverage,
 	Seconds startTime, endTime;
 	VelocityRec velocity = {0.,0.}, average = {0.,0.};
 	double speed = 0, speed1 = 0, speed2 = 0;
-	Boolean calculateAll = true;
+	Boolean calculateAll = true, usedModelTime = false;
+	uint64_t key;
 	//char errmsg[256];
 	
 	long i, j, numTimeValues = 0, numRunningAverageValues = 0;
@@ -1494,6 +1864,21 @@ TimeValuePairH OSSMTimeValue_c::CalculateRunningAverage(long pastHoursToAverage,
 		TechError("OSSMTimeValue_c::CalculateRunningAverage()", "_NewHandle()", 0);
 		goto done;
 	}
+
+	// the series only changes with the time values and the window (and the
+	// model time, if it was needed for times before or after the data), the
+	// environment asks again every step
+	CheckAveragingValues();
+	key = TopologyCacheHash(&pastHoursToAverage, sizeof(pastHoursToAverage), fAveragingKey);
+	key = TopologyCacheHash(&startTime, sizeof(startTime), key);
+	key = TopologyCacheHash(&endTime, sizeof(endTime), key);
+	key = TopologyCacheHash(&runningAverageTimeStep, sizeof(runningAverageTimeStep), key);
+	if (AveragingValuesCanBeKept(this) && key == fRunningAverageKey &&
+		(long)fRunningAverage.size() == numRunningAverageValues &&
+		(!bRunningAverageUsedModelTime || model_time == fRunningAverageModelTime)) {
+		memcpy(*runningAverageTimeValues, &fRunningAverage[0], numRunningAverageValues * sizeof(TimeValuePair));
+		goto done;
+	}
 	
 	/*for (i=0; i<numRunningAverageValues; i++)
 	{
@@ -1529,11 +1914,13 @@ TimeValuePairH OSSMTimeValue_c::CalculateRunningAverage(long pastHoursToAverage,
 		for (j=0; j<pastHoursToAverage+1; j++)
 		{
 			timeToAverage = currentTime - j * 3600; 	// will get first value for any time before time zero
-			err = GetTimeValue(timeToAverage, &velocity);
+			err = GetAveragingValue(timeToAverage, &velocity);
 			if (err == -1/* && fAllowExtrapolationInTime*/)
 			{
 				Seconds start_time, end_time;
 
+				usedModelTime = true;
+
 				err = GetDataStartTime(&start_time);	
 				err = GetDataEndTime(&end_time);	
 
@@ -1562,6 +1949,13 @@ TimeValuePairH OSSMTimeValue_c::CalculateRunningAverage(long pastHoursToAverage,
 		//printNote(errmsg);
 	
 	}
+
+	if (AveragingValuesCanBeKept(this)) {
+		fRunningAverage.assign(*runningAverageTimeValues, *runningAverageTimeValues + numRunningAverageValues);
+		fRunningAverageKey = key;
+		bRunningAverageUsedModelTime = usedModelTime;
+		fRunningAverageModelTime = model_time;
+	}
 	
 done:
 	return runningAverageTimeValues;
@@ -12,12 +12,17 @@
 #define __OSSMTimeValue_c__
 
 #include <vector>
+#include <map>
 #include <sstream>
 #include <string>
 
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "TimeValue_c.h"
+#include "TextLines.h"
+#include <stdint.h>
+
+#include "GnomeThreads.h"
 #include "ExportSymbols.h"
 
 using namespace std;
@@ -38,6 +43,36 @@ public:
 	double					fTransport;
 	double					fVelAtRefPt;
 	short					fInterpolationType;
+	long					fTimeIndex;	// where the last lookup in timeValues ended
+	// the Hermite cubic of each interval of timeValues, the u then the v
+	// coefficients of x^3 to x^0, made the first time the non-linear
+	// interpolation needs them after the values change
+	vector<double>			fHermiteCoefs;
+	TimeValuePairH			fHermiteValues;	// the values they were made from, 0 to make them again
+	long					fHermiteNumValues;
+	Boolean					bHermiteCoefsOK;	// false for duplicate times, the per query slopes report those
+	GnomeMutex				fValueMutex;	// GetTimeValue moves fTimeIndex (Shio recomputes timeValues), the movers sharing it may be on different threads
+
+	// the values the running averages have asked for, by time, kept while
+	// the time values hash to fAveragingKey. The movers sharing a wind share
+	// this object, so each hour is looked up once for all of them and all
+	// the steps
+	map<Seconds, VelocityRec>	fAveragingValues;
+	uint64_t				fAveragingKey;
+	// the last running average series and what it was made from
+	vector<TimeValuePair>	fRunningAverage;
+	uint64_t				fRunningAverageKey;
+	Boolean					bRunningAverageUsedModelTime;	// an average needed the model time to fill a gap
+	Seconds					fRunningAverageModelTime;
+	// the values at a run's step times, looked up once when the run is
+	// prepared for all the movers sharing this object, and used while the
+	// values still hash to fStepValuesKey. An error is kept as the value
+	vector<VelocityRec>		fStepValues;
+	vector<OSErr>			fStepErrors;
+	Seconds					fStepValuesStart;
+	Seconds					fStepValuesTimeStep;
+	uint64_t				fStepValuesKey;
+	uint64_t				fStepTimesKey;	// with the step times
 	
 	virtual void 			GetTimeFileName (char *theName) { strcpy (theName, fileName); }
 	virtual short			GetFileType	() { if (fFileType == PROGRESSIVETIDEFILE) return SHIOHEIGHTSFILE; else return fFileType; }
@@ -55,6 +90,8 @@ public:
 	
 	virtual void			Dispose ();
 	virtual OSErr			GetTimeValue(const Seconds& current_time, VelocityRec *value);
+	// locks once for the batch, so another thread's times don't move fTimeIndex between them
+	virtual OSErr			GetTimeValues(const Seconds *times, long n, VelocityRec *values);
 	virtual OSErr			CheckStartTime (Seconds time);
 	virtual void			RescaleTimeValues (double oldScaleFactor, double newScaleFactor);
 	virtual long			GetNumValues ();
@@ -70,6 +107,7 @@ public:
 	virtual double			GetMaxValue();
 	virtual OSErr			InitTimeFunc ();
 
+	virtual OSErr ReadNDBCWind(TextLines &linesInFile, long numHeaderLines);
 	virtual OSErr ReadNDBCWind(vector<string> &linesInFile, long numHeaderLines);
 	virtual OSErr ReadNDBCWind(char *path, long numHeaderLines);
 
@@ -81,14 +119,26 @@ public:
 
 	virtual OSErr 			GetLocationInTideCycle(const Seconds& model_time, short *ebbFloodType, float *fraction) {*ebbFloodType=0; *fraction=0; return 0;}
 	TimeValuePairH 			CalculateRunningAverage(long pastHoursToAverage, Seconds model_time);
+	void					CheckAveragingValues();
+	OSErr					GetAveragingValue(const Seconds& forTime, VelocityRec *value);
+	// everything GetTimeValue's values depend on
+	virtual uint64_t		GetValuesKey();
+	OSErr					PrepareStepValues(Seconds startTime, Seconds timeStep, long numSteps);
+	// false if forTime isn't one of the step times prepared or the values changed
+	Boolean					GetStepValue(const Seconds& forTime, VelocityRec *value, OSErr *err);
 	
 protected:
 	OSErr					GetInterpolatedComponent (Seconds forTime, double *value, short index);
 	OSErr					GetTimeChange (long a, long b, Seconds *dt);
+	long					GetTimeIndex (Seconds forTime, long n);
+	Boolean					CheckHermiteCoefs (long n);
 
 	OSErr ConvertRowValuesToUV(string &value1, string &value2,
 							   short format, double conversionFactor,
 							   double &uOut, double &vOut);
+	OSErr ConvertRowValuesToUV(const TextLine &value1, const TextLine &value2,
+							   short format, double conversionFactor,
+							   double &uOut, double &vOut);
 	bool DateValuesAreZero(DateTimeRec &dateTime);
 	bool DateIsValid(DateTimeRec &dateTime);
 	void CorrectTwoDigitYear(DateTimeRec &dateTime);
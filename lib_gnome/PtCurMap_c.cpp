@@ -10,6 +10,8 @@
 #include "PtCurMap_c.h"
 #include "CurrentMover_c.h"
 #include "MemUtils.h"
+#include "BoundarySegIndex.h"
+#include "TriMassAccumulator.h"
 #include "StringFunctions.h"
 #include "CompFunctions.h"
 
@@ -54,6 +56,7 @@ PtCurMap_c::PtCurMap_c(char* name, WorldRect bounds) : Map_c(name, bounds)
 	fBoundarySegmentsH = 0;
 	fBoundaryTypeH = 0;
 	fBoundaryPointsH = 0;
+	fSegIndex = 0;
 	fSegSelectedH = 0;
 	fSelectedBeachHdl = 0;	//not sure if both are needed
 	fSelectedBeachFlagHdl = 0;
@@ -81,6 +84,7 @@ PtCurMap_c::PtCurMap_c(char* name, WorldRect bounds) : Map_c(name, bounds)
 	fDiagnosticStrType = 0;
 	
 	fTriAreaArray = 0;
+	fTriMass[0] = fTriMass[1] = 0;
 	fDepthSliceArray = 0;
 	
 	bUseSmoothing = false;
@@ -145,15 +149,7 @@ OSErr PtCurMap_c::InitContourLevels()
 // will need to deal with this for new curvilinear algorithm when start using subsurface movement
 long PtCurMap_c::PointOnWhichSeg(long point)	// This is really which boundary
 {
-	long numSegs = GetNumBoundarySegs(),jseg;
-	for(jseg = 0; jseg < numSegs; jseg++)
-	{
-		if(point <= (*fBoundarySegmentsH)[jseg])
-		{
-			return jseg;
-		}
-	}
-	return -1;
+	return BoundarySegIndex::PointOnWhichBoundary(fBoundarySegmentsH, point);
 }
 
 Boolean PtCurMap_c::ContiguousPoints(long p1, long p2)
@@ -215,6 +211,11 @@ long PtCurMap_c::PointOnWhichSeg(long longVal, long latVal, long *startver, long
 	dLong = dLat = oneSecond * 50;
 	*distToSeg = -1;
 	
+	// the segments near the point, from the index of the boundary
+	if (!fSegIndex) fSegIndex = new BoundarySegIndex;
+	if (fSegIndex && fSegIndex->Prepare(fBoundarySegmentsH, fBoundaryPointsH, ptsHdl, dLong, dLat) == noErr)
+		return fSegIndex->PointOnWhichSeg(longVal, latVal, startver, endver, distToSeg);
+	
 	// to support new curvilinear algorithm
 	if (fBoundaryPointsH)
 	{
@@ -1093,43 +1094,40 @@ long PtCurMap_c::WhichSelectedSegAmIIn(long index)
 	}
 	return -1;	// this is an error
 }
-OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)	
-{	// 
-	long i,j,n,numOfLEs=0,numLESets,numDepths=0,numTri;
-	TTriGridVel3D* triGrid = GetGrid3D(false);
+// the LEs in the contour layer in each triangle of the grid and their mass. The
+// counts are kept from one call to the next, each LE's search starts from the
+// triangle it was in and only the LEs that moved to another triangle or changed
+// mass change them. The arrays are the map's, good until the next call.
+OSErr PtCurMap_c::CountLEsInTriangles(Boolean wantRefinedGrid, Seconds dispersantTimeOffset, Boolean activeListsOnly,
+									  const long **numLEsInTri, const double **massInTriInGrams, Boolean *thereIsSubsurfaceOil)
+{
+	long i, j, numOfLEs, numLESets, numTri;
+	TTriGridVel3D* triGrid = GetGrid3D(wantRefinedGrid);
 	TDagTree *dagTree = 0;
-	LONGH numLEsInTri = 0;
-	DOUBLEH massInTriInGrams = 0;
 	TopologyHdl topH = 0;
-	LERec LE;
-	OSErr err = 0;
-	double triArea, triVol, oilDensityInWaterColumn, massInGrams, totalVol=0, depthAtPt = 0;
-	long numLEsInTriangle,numLevels,totalLEs=0,maxTriNum=-1;
-	double concInSelectedTriangles=0,maxConc=0;
-	Boolean **triSelected = triGrid -> GetTriSelection(false);	// don't init
-	short massunits;
-	double density, LEmass, halfLife;
+	TriMassAccumulator *triMass = 0;
 	TLEList *thisLEList = 0;
-	//short massunits = thisLEList->GetMassUnits();
-	//double density =  thisLEList->fSetSummary.density;	// density set from API
-	//double LEmass =  thisLEList->fSetSummary.totalMass / (double)(thisLEList->fSetSummary.numOfLEs);	
-	
+	TOLEList *thisOLEList = 0;
+	Boolean inContours, bottomLayer = (fContourDepth1==BOTTOMINDEX);
+	short massunits;
+	double density, halfLife;
+
+	*numLEsInTri = 0;
+	*massInTriInGrams = 0;
+	if (thereIsSubsurfaceOil) *thereIsSubsurfaceOil = false;
+
+	if (!triGrid) return -1;
 	dagTree = triGrid -> GetDagTree();
 	if(!dagTree) return -1;
 	topH = dagTree->GetTopologyHdl();
 	if(!topH)	return -1;
 	numTri = _GetHandleSize((Handle)topH)/sizeof(**topH);
-	numLEsInTri = (LONGH)_NewHandleClear(sizeof(long)*numTri);
-	if (!numLEsInTri)
-	{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); err = -1; goto done; }
-	massInTriInGrams = (DOUBLEH)_NewHandleClear(sizeof(double)*numTri);
-	if (!massInTriInGrams)
-	{ TechError("PtCurMap::DrawContour()", "_NewHandleClear()", 0); err = -1; goto done; }
-	//numOfLEs = thisLEList->numOfLEs;
-	//massInGrams = VolumeMassToGrams(LEmass, density, massunits);
-	if (!fContourLevelsH)
-		if (!InitContourLevels()) {err = -1; goto done;}
-	numLevels = GetNumDoubleHdlItems(fContourLevelsH);
+
+	if (!fTriMass[wantRefinedGrid ? 1 : 0]) fTriMass[wantRefinedGrid ? 1 : 0] = new TriMassAccumulator;
+	triMass = fTriMass[wantRefinedGrid ? 1 : 0];
+	if (!triMass) { TechError("PtCurMap::CountLEsInTriangles()", "new TriMassAccumulator", 0); return -1; }
+
+	triMass -> BeginCount(dagTree, numTri, fContourDepth1, fContourDepth2, bottomLayer ? fBottomRange : 0);
 	
 	numLESets = model->LESetsList->GetItemCount();
 	for (i = 0; i < numLESets; i++)
@@ -1137,57 +1135,81 @@ OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)
 		model -> LESetsList -> GetListItem ((Ptr) &thisLEList, i);
 		if (thisLEList->fLeType == UNCERTAINTY_LE)	
 			continue;	
-		if (!((*(dynamic_cast<TOLEList*>(thisLEList))).fDispersantData.bDisperseOil && ((model->GetModelTime() - model->GetStartTime()) >= (*(dynamic_cast<TOLEList*>(thisLEList))).fDispersantData.timeToDisperse ) )
-			&& !(*(dynamic_cast<TOLEList*>(thisLEList))).fAdiosDataH && !((*(dynamic_cast<TOLEList*>(thisLEList))).fSetSummary.z > 0)) 
-			continue;
+		if (activeListsOnly && !thisLEList->IsActive()) continue;
+		thisOLEList = dynamic_cast<TOLEList*>(thisLEList);
+		inContours = thisOLEList->fDispersantData.bDisperseOil && model->GetModelTime() - model->GetStartTime() - dispersantTimeOffset >= thisOLEList->fDispersantData.timeToDisperse;
+		inContours = inContours || thisOLEList->fAdiosDataH;
+		inContours = inContours || thisOLEList->fSetSummary.z > 0;
+		if (!inContours) continue;
+		if (thereIsSubsurfaceOil) *thereIsSubsurfaceOil = true;
+
 		numOfLEs = thisLEList->numOfLEs;
 		// density set from API
-		//density =  GetPollutantDensity(thisLEList->GetOilType());	
-		density = ((dynamic_cast<TOLEList*>(thisLEList)))->fSetSummary.density;	
-		halfLife = (*(dynamic_cast<TOLEList*>(thisLEList))).fSetSummary.halfLife;
+		density = thisOLEList->fSetSummary.density;	
+		halfLife = thisOLEList->fSetSummary.halfLife;
 		massunits = thisLEList->GetMassUnits();
-		
+
+		TriMassLE *les = triMass -> BeginList(thisLEList, numOfLEs);
+		// the bottom layer asks the movers for the depth at each LE, one at a time
+		Boolean runParallel = !bottomLayer && numOfLEs >= 1000;
+
+#ifdef _OPENMP
+#pragma omp parallel for if(runParallel)
+#endif
 		for (j = 0 ; j < numOfLEs ; j++) 
 		{
+			LERec LE;
 			LongPoint lp;
-			long triIndex;
+			Boolean inLayer;
 			thisLEList -> GetLE (j, &LE);
-			//if (LE.statusCode == OILSTAT_NOTRELEASED) continue;
-			if (!(LE.statusCode == OILSTAT_INWATER)) continue;// Windows compiler requires extra parentheses
-			lp.h = LE.p.pLong;
-			lp.v = LE.p.pLat;
-			LEmass = GetLEMass(LE,halfLife);	// will only vary for chemical with different release end time
-			massInGrams = VolumeMassToGrams(LEmass, density, massunits);	// need to do this above too
-			if (fContourDepth1==BOTTOMINDEX)
+			if (!(LE.statusCode == OILSTAT_INWATER))	// Windows compiler requires extra parentheses
+				inLayer = false;
+			else if (bottomLayer)
 			{
 				double depthAtLE = DepthAtPoint(LE.p);
-				if (depthAtLE <= 0) continue;
-				//if (LE.z > (depthAtLE-1.) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map, careful with 2 grids...
-				if (LE.z > (depthAtLE-fBottomRange) && LE.z > 0 && LE.z <= depthAtLE) // assume it's in map, careful with 2 grids...
-				{
-					triIndex = dagTree -> WhatTriAmIIn(lp);
-					//if (triIndex>=0) (*numLEsInTri)[triIndex]++;
-					//if (triIndex>=0 && LE.pollutantType == CHEMICAL) (*massInTri)[triIndex]+=GetLEMass(LE);	// use weathering information
-					if (triIndex>=0) 
-					{
-						(*numLEsInTri)[triIndex]++;
-						(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-					}
-				}
+				inLayer = (LE.z > (depthAtLE-fBottomRange) && LE.z > 0 && LE.z <= depthAtLE);	// assume it's in map, careful with 2 grids...
 			}
-			else if (LE.z>fContourDepth1 && LE.z<=fContourDepth2) 
+			else
+				inLayer = (LE.z>fContourDepth1 && LE.z<=fContourDepth2);
+			if (!inLayer)
 			{
-				triIndex = dagTree -> WhatTriAmIIn(lp);
-				//if (triIndex>=0) (*numLEsInTri)[triIndex]++;
-				//if (triIndex>=0 && LE.pollutantType == CHEMICAL) (*massInTri)[triIndex]+=GetLEMass(LE);	// use weathering information
-				if (triIndex>=0) 
-				{
-					(*numLEsInTri)[triIndex]++;
-					(*massInTriInGrams)[triIndex]+=massInGrams;	// use weathering information
-				}
+				les[j].tri = -1;
+				continue;
 			}
+			lp.h = LE.p.pLong;
+			lp.v = LE.p.pLat;
+			dagTree -> WhatTriAmIIn(lp, &les[j].tri);	// from the triangle it was in, sets it to where it is
+			// will only vary for chemical with different release end time
+			les[j].massInGrams = les[j].tri >= 0 ? VolumeMassToGrams(GetLEMass(LE,halfLife), density, massunits) : 0;
 		}
+		triMass -> EndList();
 	}
+	triMass -> EndCount();
+
+	*numLEsInTri = triMass -> GetNumLEsInTri();
+	*massInTriInGrams = triMass -> GetMassInTriInGrams();
+	return (*numLEsInTri && *massInTriInGrams) ? noErr : -1;
+}
+
+OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)	
+{	// 
+	long i,j,numTri;
+	TTriGridVel3D* triGrid = GetGrid3D(false);
+	const long *numLEsInTri = 0;
+	const double *massInTriInGrams = 0;
+	OSErr err = 0;
+	double triArea, triVol, oilDensityInWaterColumn, depthAtPt = 0;
+	long numLEsInTriangle,numLevels,maxTriNum=-1;
+	double maxConc=0;
+	Boolean **triSelected = triGrid -> GetTriSelection(false);	// don't init
+	
+	if (!fContourLevelsH)
+		if (!InitContourLevels()) {err = -1; goto done;}
+	numLevels = GetNumDoubleHdlItems(fContourLevelsH);
+	
+	err = CountLEsInTriangles(false, 0, false, &numLEsInTri, &massInTriInGrams, 0);
+	if (err) goto done;
+	numTri = triGrid -> GetNumTriangles();
 	
 	for (i=0;i<numTri;i++)
 	{	
@@ -1216,7 +1238,7 @@ OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)
 		if (depthAtPt < fContourDepth2 && depthAtPt > fContourDepth1 && depthAtPt > 0) depthRange = depthAtPt - fContourDepth1;
 		triVol = triArea * depthRange; 
 		//triVol = triArea * (fContourDepth2 - fContourDepth1); // code goes here, check this depth range is ok at all vertices
-		numLEsInTriangle = (*numLEsInTri)[i];
+		numLEsInTriangle = numLEsInTri[i];
 		if (!(fContourDepth1==BOTTOMINDEX))		// need to decide what to do for bottom contour
 			if (triGrid->CalculateDepthSliceVolume(&triVol,i,fContourDepth1,fContourDepth2)) goto done;
 		/*if (thisLEList->GetOilType() == CHEMICAL) 
@@ -1229,7 +1251,7 @@ OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)
 		 */
 		if (numLEsInTriangle==0)
 			continue;
-		oilDensityInWaterColumn = (*massInTriInGrams)[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
+		oilDensityInWaterColumn = massInTriInGrams[i] / triVol;	// units? milligrams/liter ?? for now gm/m^3
 		
 		for (j=0;j<numLevels;j++)
 		{
@@ -1252,8 +1274,6 @@ OSErr PtCurMap_c::GetDepthAtMaxTri(long *maxTriIndex,double *depthAtPnt)
 	*depthAtPnt = depthAtPt;
 	*maxTriIndex = maxTriNum;
 done:
-	if(numLEsInTri) {DisposeHandle((Handle)numLEsInTri); numLEsInTri=0;}
-	if(massInTriInGrams) {DisposeHandle((Handle)massInTriInGrams); massInTriInGrams=0;}
 	return err;
 }
 
@@ -1705,7 +1725,6 @@ void  PtCurMap_c::FindNearestBoundary(WorldPoint wp, long *verNum, long *segNo)
 	LongPoint lp;
 	long lastVer = GetNumBoundaryPts();
 	//long nbounds = GetNumBoundaries();
-	long nSegs = GetNumBoundarySegs();	
 	float wdist = LatToDistance(ScreenToWorldDistance(4));
 	LongPointHdl ptsHdl = GetPointsHdl(false);	// will use refined grid if there is one
 	if(!ptsHdl) return;
@@ -1721,14 +1740,11 @@ void  PtCurMap_c::FindNearestBoundary(WorldPoint wp, long *verNum, long *segNo)
 		if(WPointNearWPoint(wp,wp2 ,wdist))
 		{
 			//for(jseg = 0; jseg < nbounds; jseg++)
-			for(jseg = 0; jseg < nSegs; jseg++)
+			jseg = BoundarySegIndex::PointOnWhichBoundary(fBoundarySegmentsH, i);
+			if (jseg >= 0)
 			{
-				if(i <= (*fBoundarySegmentsH)[jseg])
-				{
-					*verNum  = i;
-					*segNo = jseg;
-					break;
-				}
+				*verNum  = i;
+				*segNo = jseg;
 			}
 		}
 	} 
@@ -28,6 +28,9 @@
 #define TTriGridVel3D TriGridVel3D_c
 #endif
 
+class BoundarySegIndex;
+class TriMassAccumulator;
+
 class PtCurMap_c : virtual public Map_c
 {
 	
@@ -35,6 +38,7 @@ public:
 	LONGH			fBoundarySegmentsH;
 	LONGH			fBoundaryTypeH;		// 1 land, 2 water
 	LONGH			fBoundaryPointsH;	// for curvilinear grids
+	BoundarySegIndex	*fSegIndex;		// the boundary segments near a point, built by PointOnWhichSeg
 	LONGH			fSegSelectedH;
 	LONGH			fSelectedBeachHdl;	//not sure if both are needed
 	LONGH			fSelectedBeachFlagHdl;	//not sure if both are needed
@@ -64,6 +68,7 @@ public:
 	Boolean			bDrawBitMapBounds;
 	
 	double			*fTriAreaArray;
+	TriMassAccumulator	*fTriMass[2];	// the LEs in the triangles of the grid and the refined grid, kept by CountLEsInTriangles
 	//long			*fDepthSliceArray;	// number of LEs in each layer (1m) of depth slice
 	float			*fDepthSliceArray;	//changed to ppm in each layer (1m) of depth slice 7/21/03
 	
@@ -128,6 +133,8 @@ public:
 	double 			GetMixedLayerDepth(void) {return fMixedLayerDepth;}
 	//OSErr 			GetDepthAtMaxTri(TOLEList *thisLEList,long *maxTriIndex,double *depthAtPnt);	
 	OSErr 			GetDepthAtMaxTri(long *maxTriIndex, double *depthAtPnt);	
+	OSErr			CountLEsInTriangles(Boolean wantRefinedGrid, Seconds dispersantTimeOffset, Boolean activeListsOnly,
+										const long **numLEsInTri, const double **massInTriInGrams, Boolean *thereIsSubsurfaceOil);
 	//OSErr 			CreateDepthSlice(TLEList *thisLEList, long triNum)	;
 	OSErr 			CreateDepthSlice(long triNum, float **depthSlice);
 	//OSErr 			CreateDepthSlice(long triNum, float *depthSlice);
@@ -9,6 +9,10 @@
 
 #include "PtCurMover_c.h"
 #include "MemUtils.h"
+#include "TimeSliceCache.h"
+#include "TimeSliceLoader.h"
+#include "TimeInterval.h"
+#include <typeinfo>
 
 #ifndef pyGNOME
 #include "CROSS.H"
@@ -46,6 +50,7 @@ PtCurMover_c::PtCurMover_c (TMap *owner, char *name) : CurrentMover_c(owner, nam
 	fIsOptimizedForStep = false;
 	fOverLap = false;		// for multiple files case
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	
 	memset(&fStartData,0,sizeof(fStartData));
 	fStartData.timeIndex = UNASSIGNEDINDEX; 
@@ -57,11 +62,12 @@ PtCurMover_c::PtCurMover_c (TMap *owner, char *name) : CurrentMover_c(owner, nam
 	fDepthsH = 0;
 	fDepthDataInfo = 0;
 	fInputFilesHdl = 0;	// for multiple files case
+	fSliceLoader = 0;
 	
 	SetClassName (name); // short file name
 }
 
-OSErr PtCurMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr PtCurMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -119,7 +125,7 @@ OSErr PtCurMover_c::PrepareForModelRun()
 	return CurrentMover_c::PrepareForModelRun();
 }
 
-OSErr PtCurMover_c::PrepareForModelStep(const Seconds& model_time,const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr PtCurMover_c::PrepareForModelStep(const Seconds& model_time,const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	long timeDataInterval;
 	//Boolean intervalLoaded;
@@ -185,7 +191,8 @@ void PtCurMover_c::ModelStepIsDone()
 
 void PtCurMover_c::DisposeLoadedData(LoadedData *dataPtr)
 {
-	if(dataPtr -> dataHdl) DisposeHandle((Handle) dataPtr -> dataHdl);
+	// slices shared through the cache are released, not disposed
+	if(dataPtr -> dataHdl && !ReleaseTimeSlice(dataPtr -> dataHdl)) DisposeHandle((Handle) dataPtr -> dataHdl);
 	ClearLoadedData(dataPtr);
 }
 
@@ -204,6 +211,7 @@ OSErr PtCurMover_c::CheckAndScanFile(char *errmsg, const Seconds& model_time)
 	OSErr err = 0;
 	
 	errmsg[0]=0;
+	if (fSliceLoader) fSliceLoader -> FinishPrefetch();	// it reads the file and times that change here
 	if (fEndData.timeIndex!=UNASSIGNEDINDEX)
 		testTime = (*fTimeDataHdl)[fEndData.timeIndex].time;	// currently loaded end time
 	
@@ -295,7 +303,7 @@ Boolean PtCurMover_c::CheckInterval(long &timeDataInterval, const Seconds& model
 {
 	Seconds time = model_time; // AH 07/17/2012
 	
-	long i,numTimes;
+	long numTimes;
 	
 	
 	numTimes = this -> GetNumTimesInFile(); 
@@ -326,14 +334,9 @@ Boolean PtCurMover_c::CheckInterval(long &timeDataInterval, const Seconds& model
 		else fOverLap = false;
 	}
 	
-	for (i=0;i<numTimes;i++) 
-	{	// find the time interval
-		if (time>=(*fTimeDataHdl)[i].time && time<=(*fTimeDataHdl)[i+1].time)
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(PtCurTimes(fTimeDataHdl), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<(*fTimeDataHdl)[0].time) 
 		timeDataInterval = 0;
@@ -357,7 +360,10 @@ OSErr PtCurMover_c::SetInterval(char *errmsg, const Seconds& model_time)
 	strcpy(errmsg,"");
 	
 	if(intervalLoaded) 
+	{
+		StartPrefetch();
 		return 0;
+	}
 	
 	// check for constant current 
 	if(numTimesInFile==1 && !(GetNumFiles()>1))	//or if(timeDataInterval==-1) 
@@ -403,16 +409,14 @@ OSErr PtCurMover_c::SetInterval(char *errmsg, const Seconds& model_time)
 		
 		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
 		{ // start data is not loaded
-			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfStart,&fStartData,errmsg);
 			if(err) goto done;
-			fStartData.timeIndex = indexOfStart;
 		}	
 		
 		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
 		{
-			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfEnd,&fEndData,errmsg);
 			if(err) goto done;
-			fEndData.timeIndex = indexOfEnd;
 		}
 	}
 	
@@ -423,11 +427,59 @@ done:
 		DisposeLoadedData(&fStartData);
 		DisposeLoadedData(&fEndData);
 	}
+	else
+		StartPrefetch();
 	return err;
 	
 }
 
 
+static OSErr ReadPtCurTimeData(void *mover, long index, VelocityFH *velocityH, char *errmsg)
+{
+	return ((PtCurMover_c *)mover) -> ReadTimeData(index, velocityH, errmsg);
+}
+
+// movers of the same class, points and depths read a file the same way
+void PtCurMover_c::GetTimeSliceVariable(char *variable)
+{
+	long numDepthValues = fDepthDataInfo ? _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo) : 0;
+	long totalNumberOfVels = numDepthValues ? (*fDepthDataInfo)[numDepthValues-1].indexToDepthData+(*fDepthDataInfo)[numDepthValues-1].numDepths : 0;
+	
+	sprintf(variable, "%s %ld %ld %ld", typeid(*this).name(), numDepthValues, fVar.numLandPts, totalNumberOfVels);
+}
+
+// read a time into data, or share it with another mover that already has it
+OSErr PtCurMover_c::LoadTimeData(long index, LoadedData *data, char *errmsg)
+{
+	char variable[256];
+	
+	if (!fSliceLoader) fSliceLoader = new TimeSliceLoader(ReadPtCurTimeData, this);
+	if (!fSliceLoader)
+	{
+		OSErr err = this -> ReadTimeData(index,&data->dataHdl,errmsg);
+		if (!err) data->timeIndex = index;
+		return err;
+	}
+	
+	GetTimeSliceVariable(variable);
+	return fSliceLoader -> Load(fVar.pathName, variable, index, data, errmsg);
+}
+
+// read the time after the loaded interval in the background, so the
+// SetInterval that crosses into it doesn't wait on the file
+void PtCurMover_c::StartPrefetch()
+{
+	char variable[256];
+	long nextIndex = fEndData.timeIndex + 1;
+	
+	// constant current, or the next time is in another file
+	if (!fSliceLoader || fEndData.timeIndex == UNASSIGNEDINDEX || nextIndex >= GetNumTimesInFile())
+		return;
+	
+	GetTimeSliceVariable(variable);
+	fSliceLoader -> StartPrefetch(fVar.pathName, variable, nextIndex);
+}
+
 long PtCurMover_c::GetNumTimesInFile()
 {
 	long numTimes = 0;
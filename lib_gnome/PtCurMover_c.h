@@ -25,6 +25,7 @@
 #define TMap Map_c
 #endif
 
+class TimeSliceLoader;
 
 class PtCurMover_c : virtual public CurrentMover_c {
 
@@ -40,17 +41,20 @@ public:
 	Boolean fIsOptimizedForStep;
 	Boolean fOverLap;
 	Seconds fOverLapStartTime;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	PtCurFileInfoH	fInputFilesHdl;
+	TimeSliceLoader	*fSliceLoader;	// SetInterval's reads, cached and the next time prefetched
 	
 	PtCurMover_c (TMap *owner, char *name);
 	PtCurMover_c () {}
 	//virtual ClassID 	GetClassID () { return TYPE_PTCURMOVER; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_PTCURMOVER) return TRUE; return TCurrentMover::IAm(id); }
 	
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	VelocityRec			GetPatValue (WorldPoint p);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	virtual WorldRect	GetGridBounds(){return fGrid->GetBounds();}	
+	virtual Boolean		MovesOnlyInGridBounds(){return true;}	// off the triangles is no velocity
 
 	
 	long 					GetNumTimesInFile();
@@ -62,7 +66,7 @@ public:
 	void 					GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2);
 	virtual float		GetArrowDepth() {return fVar.arrowDepth;}
 	
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList);
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList);
 	virtual OSErr 		PrepareForModelRun(); 
 	virtual void 		ModelStepIsDone();
 	
@@ -73,6 +77,9 @@ public:
 	virtual OSErr	 	SetInterval(char *errmsg, const Seconds& model_time);	// AH 07/17/2012
 	virtual OSErr 		CheckAndScanFile(char *errmsg, const Seconds& model_time);	// AH 07/17/2012
 	OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
+	OSErr 				LoadTimeData(long index,LoadedData *data, char* errmsg); 
+	void 				StartPrefetch();
+	void 				GetTimeSliceVariable(char *variable);
 	OSErr 				ScanFileForTimes(char *path,PtCurTimeDataHdl *timeDataHdl,Boolean setStartTime);	// AH 07/17/2012
 
 };
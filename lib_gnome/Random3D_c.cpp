@@ -28,6 +28,7 @@ Random3D_c::Random3D_c (TMap *owner, char *name) : Mover_c(owner, name), Random_
 	fVerticalBottomDiffusionCoefficient = .11; //  cm**2/sec, Bushy suggested a larger default	
 	fHorizontalDiffusionCoefficient = 126; //  cm**2/sec	
 	bUseDepthDependentDiffusion = false;
+	bStepSizesValid = false;
 	SetClassName (name);
 	//fUncertaintyFactor = 2;		// default uncertainty mult-factor
 }
@@ -37,23 +38,63 @@ OSErr Random3D_c::PrepareForModelRun()
 	return noErr;
 }
 
-OSErr Random3D_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr Random3D_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	this -> fOptimize.isOptimizedForStep = true;
 	this -> fOptimize.value = sqrt(6*(fDiffusionCoefficient/10000)*time_step)/METERSPERDEGREELAT; // in deg lat
 	this -> fOptimize.uncertaintyValue = sqrt(fUncertaintyFactor*6*(fDiffusionCoefficient/10000)*time_step)/METERSPERDEGREELAT; // in deg lat
 	//this -> fOptimize.isFirstStep = (model_time == start_time);
+	SetStepSizes(model_time, time_step);
 	return noErr;
 }
 
+// the parts of the vertical and horizontal diffusion that are the same for each
+// LE of a step, the wind's friction velocity among them
+void Random3D_c::SetStepSizes(const Seconds& model_time, Seconds timeStep)
+{
+	double rho_a = 1.29, rho_w = 1030., dragCoeff, tau, vel;
+	VelocityRec windVel;
+	OSErr err = 0;
+
+	if (bStepSizesValid && fStepSizesTime == model_time && fStepSizesTimeStep == timeStep)
+		return;
+
+	fHorizontalStep = sqrt(2.*(fHorizontalDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT;
+	fVerticalStep = sqrt(2.*(fVerticalDiffusionCoefficient/10000.)*timeStep);
+	fLeakedStep = sqrt(2.*.000011*timeStep);
+	fVerticalBottomStep = sqrt(2.*(fVerticalBottomDiffusionCoefficient/10000.)*timeStep);
+
+	fUStar = 0;
+	if (bUseDepthDependentDiffusion)
+	{
+		TWindMover *wind = model -> GetWindMover(false);
+		if (wind) err = wind -> GetTimeValue(model_time,&windVel);	// minus AH 07/10/2012
+		if (err || !wind) 
+		{
+			//printNote("Depth dependent diffusion requires a wind");
+			vel = 5;	// instead should have a minimum diffusion coefficient 5cm2/s
+		}
+		else 
+			vel = sqrt(windVel.u*windVel.u + windVel.v*windVel.v);	// m/s
+		dragCoeff = (.8+.065*vel)*.001;
+		tau = rho_a*dragCoeff*vel*vel;
+		fUStar = sqrt(tau/rho_w);
+	}
+
+	fStepSizesTime = model_time;
+	fStepSizesTimeStep = timeStep;
+	bStepSizesValid = true;
+}
+
 void Random3D_c::ModelStepIsDone()
 {
+	bStepSizesValid = false;	// the coefficients or the wind may change before the next step
 	this -> fOptimize.isFirstStep = false;
 	memset(&fOptimize,0,sizeof(fOptimize));
 }
 
 
-WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double		dLong, dLat, z;
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -101,9 +142,8 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 		double g = 9.8, buoyancy = 0.;
 		double horizontalDiffusionCoefficient, verticalDiffusionCoefficient;
 		double mixedLayerDepth=10., totalLEDepth, breakingWaveHeight=1., depthAtPoint=INFINITE_DEPTH;
-		double karmen = .4, rho_a = 1.29, rho_w = 1030., dragCoeff, tau, uStar;
+		double karmen = .4, uStar;
 		float water_density=1020.,water_viscosity = 1.e-6,eps = 1.e-6;
-		TWindMover *wind = model -> GetWindMover(false);
 		Boolean alreadyLeaked = false;
 		Boolean subsurfaceSpillStartPosition = !((*theLE).dispersionStatus==HAVE_DISPERSED || (*theLE).dispersionStatus==HAVE_DISPERSED_NAT);
 		Boolean chemicalSpill = ((*theLE).pollutantType==CHEMICAL);
@@ -121,21 +161,10 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 		//depthAtPoint=5000.;	// allow no bathymetry
 		if (map) breakingWaveHeight = map->GetBreakingWaveHeight();	// meters
 		if (map) mixedLayerDepth = map->fMixedLayerDepth;	// meters
+		SetStepSizes(model_time, timeStep);
 		if (bUseDepthDependentDiffusion)
 		{	
-			VelocityRec windVel;
-			double vel;
-			if (wind) err = wind -> GetTimeValue(model_time,&windVel);	// minus AH 07/10/2012
-			if (err || !wind) 
-			{
-				//printNote("Depth dependent diffusion requires a wind");
-				vel = 5;	// instead should have a minimum diffusion coefficient 5cm2/s
-			}
-			else 
-				vel = sqrt(windVel.u*windVel.u + windVel.v*windVel.v);	// m/s
-			dragCoeff = (.8+.065*vel)*.001;
-			tau = rho_a*dragCoeff*vel*vel;
-			uStar = sqrt(tau/rho_w);
+			uStar = fUStar;	// from the wind, the same for each LE
 			//verticalDiffusionCoefficient = sqrt(2.*(.4*.00138*500/10000.)*timeStep);	// code goes here, use wind speed, other data
 			if ((*theLE).z <= 1.5 * breakingWaveHeight)
 				//verticalDiffusionCoefficient = sqrt(2.*(karmen*uStar*1.5/10000.)*timeStep);	
@@ -148,7 +177,7 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 			{
 				//verticalDiffusionCoefficient = sqrt(2.*.000011/10000.*timeStep);
 				// code goes here, allow user to set this - is this different from fVerticalBottomDiffusionCoefficient which is used for leaking?
-				verticalDiffusionCoefficient = sqrt(2.*.000011*timeStep);
+				verticalDiffusionCoefficient = fLeakedStep;
 				alreadyLeaked = true;
 			}
 		}
@@ -157,11 +186,11 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 			if ((*theLE).z > mixedLayerDepth /*&& !chemicalSpill*/)
 			{
 				//verticalDiffusionCoefficient = sqrt(2.*.000011/10000.*timeStep);	
-				verticalDiffusionCoefficient = sqrt(2.*.000011*timeStep);	// particles that leaked through
+				verticalDiffusionCoefficient = fLeakedStep;	// particles that leaked through
 				alreadyLeaked = true;
 			}
 			else
-				verticalDiffusionCoefficient = sqrt(2.*(fVerticalDiffusionCoefficient/10000.)*timeStep);
+				verticalDiffusionCoefficient = fVerticalStep;
 		}
 		GetRandomVectorInUnitCircle(&rand1,&rand2);
 		r = sqrt(rand1*rand1+rand2*rand2);
@@ -207,7 +236,7 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 		 }*/
 		
 		//horizontalDiffusionCoefficient = sqrt(2.*(fDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT;
-		horizontalDiffusionCoefficient = sqrt(2.*(fHorizontalDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT;
+		horizontalDiffusionCoefficient = fHorizontalStep;
 		dLong = (rand1 * w * horizontalDiffusionCoefficient )/ LongToLatRatio3 (refPoint.pLat);
 		dLat  = rand2 * w * horizontalDiffusionCoefficient;		
 		
@@ -311,7 +340,7 @@ WorldPoint3D Random3D_c::GetMove (const Seconds& model_time, Seconds timeStep,lo
 			if (totalLEDepth>mixedLayerDepth) // allow leaking
 			{
 				double x, reflectRatio = 0., verticalBottomDiffusionCoefficient;
-				verticalBottomDiffusionCoefficient = sqrt(2.*(fVerticalBottomDiffusionCoefficient/10000.)*timeStep);
+				verticalBottomDiffusionCoefficient = fVerticalBottomStep;
 				if (verticalBottomDiffusionCoefficient>0) reflectRatio = sqrt(verticalDiffusionCoefficient/verticalBottomDiffusionCoefficient); // should be > 1
 				x = GetRandomFloat(0, 1.0);
 				if(x <= reflectRatio/(reflectRatio+1) || fVerticalBottomDiffusionCoefficient == 0 || totalLEDepth > depthAtPoint) // percent to reflect
@@ -9,6 +9,7 @@
 
 #include "RandomVertical_c.h"
 #include "CompFunctions.h"
+#include "RunState.h"
 #include "GEOMETRY.H"
 #include "Units.h"
 
@@ -37,16 +38,40 @@ void RandomVertical_c::Init()
 	fMixedLayerDepth = 10.; // meters
 	//fHorizontalDiffusionCoefficient = 126; //  cm**2/sec	
 	bUseDepthDependentDiffusion = false;
+	bUseCounterRandom = false;
+	fRandomSeed = 1;
+	fStepCount = 0;
 	//memset(&fOptimize,0,sizeof(fOptimize));
 }
 
+// draw numbers the random numbers one LE uses in a step
+float RandomVertical_c::GetRandomDraw(long setIndex, LECount leIndex, LETYPE leType, long draw, float low, float high)
+{
+	if (bUseCounterRandom)
+	{
+		CounterRandomKey key;
+
+		key.seed = (uint32_t)fRandomSeed;
+		key.spillID = setIndex;
+		key.step = fStepCount;
+		key.stream = leType;
+
+		return CounterRandomFloat(key, leIndex, draw, low, high);
+	}
+
+	return GetRandomFloat(low, high);
+}
+
 OSErr RandomVertical_c::PrepareForModelRun()
 {
 	//this -> fOptimize.isFirstStep = true;	// may need this, but no uncertainty at this point
+	fStepCount = 0;
 	return noErr;
 }
-OSErr RandomVertical_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr RandomVertical_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	//this -> fOptimize.isOptimizedForStep = true;
 	//this -> fOptimize.value = sqrt(6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
 	//this -> fOptimize.uncertaintyValue = sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
@@ -55,12 +80,28 @@ OSErr RandomVertical_c::PrepareForModelStep(const Seconds& model_time, const Sec
 
 void RandomVertical_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	//if (this -> fOptimize.isFirstStep == true) this -> fOptimize.isFirstStep = false;
 	//memset(&fOptimize,0,sizeof(fOptimize));
+	fStepCount++;
 }
 
+void RandomVertical_c::WriteRunState(RunStateWriter &writer)
+{
+	Mover_c::WriteRunState(writer);
+
+	writer.Put(fStepCount);
+}
 
-OSErr RandomVertical_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+bool RandomVertical_c::ReadRunState(RunStateReader &reader)
+{
+	return Mover_c::ReadRunState(reader) && reader.Get(&fStepCount);
+}
+
+
+OSErr RandomVertical_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 	
 	// JS Ques: Is this required? Could cy/python invoke this method without well defined numpy arrays?
 	if(!delta || !ref) {
@@ -75,13 +116,17 @@ OSErr RandomVertical_c::get_move(int n, Seconds model_time, Seconds step_len, Wo
 		return 2;
 	}
 	
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-	
 	WorldPoint3D zero_delta ={0,0,0.};
+	// only the counter based random numbers are safe to draw from several threads
+	bool runParallel = fNumThreads > 1 && bUseCounterRandom;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
 
-	for (int i = 0; i < n; i++) {
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
 		{
@@ -111,7 +156,7 @@ double GetDepthAtPoint(WorldPoint p)
 	return depthAtPt;
 }
 
-WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double	dLong, dLat, z = 0;
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -139,7 +184,7 @@ WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeS
 		{
 			if (fVerticalDiffusionCoefficient==0) return deltaPoint;	
 			verticalDiffusionCoefficient = sqrt(6.*(fVerticalDiffusionCoefficient/10000.)*timeStep);
-			rand = GetRandomFloat(-1.0, 1.0);
+			rand = GetRandomDraw(setIndex, leIndex, leType, 0, -1.0, 1.0);
 			deltaPoint.z = rand*verticalDiffusionCoefficient;
 			//z = deltaPoint.z;	// will add this on to the next move
 			
@@ -155,7 +200,7 @@ WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeS
 			{
 				deltaPoint.z = mixedLayerDepth - (totalLEDepth - mixedLayerDepth) - (*theLE).z; // reflect about mixed layer depth
 				// check if went above surface and put randomly into mixed layer
-				if ((*theLE).z+deltaPoint.z <= 0) deltaPoint.z = GetRandomFloat(eps,mixedLayerDepth) - (*theLE).z;	
+				if ((*theLE).z+deltaPoint.z <= 0) deltaPoint.z = GetRandomDraw(setIndex, leIndex, leType, 1, eps, mixedLayerDepth) - (*theLE).z;	
 					// or just let it go and deal with it later? then it will go into full water column...
 			}
 		}
@@ -164,7 +209,7 @@ WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeS
 		// now apply below mixed layer depth diffusion to all particles above and below
 		if (fVerticalBottomDiffusionCoefficient==0/* && z==0*/) /*return deltaPoint*/goto dochecks;	// don't return until do checks
 		verticalDiffusionCoefficient = sqrt(6.*(fVerticalBottomDiffusionCoefficient/10000.)*timeStep);
-		rand = GetRandomFloat(-1.0, 1.0);
+		rand = GetRandomDraw(setIndex, leIndex, leType, 2, -1.0, 1.0);
 		deltaPoint.z = rand*verticalDiffusionCoefficient;
 		
 		z = z + deltaPoint.z;	// add move to previous move if any
@@ -181,7 +226,7 @@ dochecks:
 			deltaPoint.z = - totalLEDepth - (*theLE).z;	// reflect below surface
 			totalLEDepth = (*theLE).z + deltaPoint.z;
 			if (totalLEDepth > depthAtPoint) 
-				deltaPoint.z = GetRandomFloat(eps,depthAtPoint-eps) - (*theLE).z;
+				deltaPoint.z = GetRandomDraw(setIndex, leIndex, leType, 3, eps, depthAtPoint-eps) - (*theLE).z;
 			return deltaPoint;
 		}
 		if (totalLEDepth==depthAtPoint) 
@@ -196,7 +241,7 @@ dochecks:
 			totalLEDepth = (*theLE).z + deltaPoint.z;
 			if (totalLEDepth <= 0) 
 				// put randomly into water column
-				deltaPoint.z = GetRandomFloat(eps,depthAtPoint-eps) - (*theLE).z;
+				deltaPoint.z = GetRandomDraw(setIndex, leIndex, leType, 3, eps, depthAtPoint-eps) - (*theLE).z;
 			return deltaPoint;
 		}
 		else
@@ -210,7 +255,7 @@ dochecks:
 /*
 // Box Muller algorithm - needs a factor adjustment since the random value range is limited by the sqrt(-2log(r)/r) calculation (can't have r>1)
 // We might want to revisit this sometime if we want an algorithm for generating normally distributed random numbers
-WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D RandomVertical_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double	dLong, dLat, z = 0;
 	WorldPoint3D	deltaPoint = {0,0,0.};
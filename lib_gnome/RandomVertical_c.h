@@ -13,6 +13,7 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "Mover_c.h"
+#include "CounterRandom.h"
 #include "ExportSymbols.h"
 
 class DLL_API RandomVertical_c : virtual public Mover_c {
@@ -23,6 +24,9 @@ public:
 	double fVerticalBottomDiffusionCoefficient; //cm**2/s
 	double fMixedLayerDepth;	// meters
 	Boolean bUseDepthDependentDiffusion;
+	Boolean bUseCounterRandom;		// stateless random numbers keyed on spill, LE and step - reproducible in any LE order
+	long fRandomSeed;				// key for the counter based random numbers
+	long fStepCount;				// model steps since PrepareForModelRun
 	//TR_OPTIMZE fOptimize; // this does not need to be saved to the save file
 	
 #ifndef pyGNOME
@@ -30,15 +34,18 @@ public:
 #endif
 	RandomVertical_c();
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual void		WriteRunState(RunStateWriter &writer);
+	virtual bool		ReadRunState(RunStateReader &reader);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	
 	
-	OSErr				get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	OSErr				get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
 
 protected:
 	void				Init();
+	float				GetRandomDraw(long setIndex, LECount leIndex, LETYPE leType, long draw, float low, float high);
 };
 
 #endif
@@ -9,6 +9,7 @@
 
 #include "Random_c.h"
 #include "CompFunctions.h"
+#include "RunState.h"
 #include "GEOMETRY.H"
 #include "Units.h"
 
@@ -18,6 +19,11 @@
 
 using std::cout;
 
+// the bins of 10/depth in the depth dependent step sizes, from 0 (deep water)
+// to .5 (20 m, shallower has no diffusion)
+static const long kDepthTableSize = 1024;
+static const double kDepthTableEnd = .5;
+
 Random_c::Random_c () : Mover_c()
 {
 	Init();
@@ -36,30 +42,133 @@ void Random_c::Init()
 	memset(&fOptimize,0,sizeof(fOptimize));
 	fUncertaintyFactor = 2;		// default uncertainty mult-factor
 	bUseDepthDependent = false;
+	bUseCounterRandom = false;
+	fRandomSeed = 1;
+	fStepCount = 0;
+	fDepthTableStep = 0;
+	fDepthTableFactor = 0;
 }
 
 OSErr Random_c::PrepareForModelRun()
 {
 	this -> fOptimize.isFirstStep = true;
+	fStepCount = 0;
 	return noErr;
 }
-OSErr Random_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr Random_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	this -> fOptimize.isOptimizedForStep = true;
 	this -> fOptimize.value = sqrt(6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
 	this -> fOptimize.uncertaintyValue = sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
+	if (bUseDepthDependent)
+		SetDepthTable(time_step);
 	//this -> fOptimize.isFirstStep = (model_time == start_time);
 	return noErr;
 }
 
+// the step sizes of logD = 1+exp(1-1/.1H) at the edges of the bins of 1/.1H,
+// so the LEs only interpolate between two of them
+void Random_c::SetDepthTable(Seconds timeStep)
+{
+	double x, localDiffusionCoefficient;
+
+	if (!fDepthTable.empty() && fDepthTableStep == timeStep && fDepthTableFactor == fUncertaintyFactor)
+		return;
+
+	fDepthTable.resize(2 * (kDepthTableSize + 1));
+	for (long k = 0; k <= kDepthTableSize; k++)
+	{
+		x = kDepthTableEnd * k / kDepthTableSize;
+		localDiffusionCoefficient = pow(10., 1 + exp(1 - x));
+		fDepthTable[2 * k] = sqrt(6.*(localDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
+		fDepthTable[2 * k + 1] = sqrt(fUncertaintyFactor*6.*(localDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
+	}
+
+	fDepthTableStep = timeStep;
+	fDepthTableFactor = fUncertaintyFactor;
+}
+
+double Random_c::GetDepthStep(float depth, LETYPE leType)
+{
+	double x, w;
+	long k, j = (leType == UNCERTAINTY_LE);
+
+	// no diffusion in shallow water, or where the point isn't in the dagtree
+	if (!(depth > 20))
+		return 0.;
+
+	x = (1 / (.1 * depth)) * (kDepthTableSize / kDepthTableEnd);
+	k = (long)x;
+	if (k >= kDepthTableSize)
+		k = kDepthTableSize - 1;
+	w = x - k;
+
+	return (1 - w) * fDepthTable[2 * k + j] + w * fDepthTable[2 * (k + 1) + j];
+}
+
 void Random_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	if (this -> fOptimize.isFirstStep == true) this -> fOptimize.isFirstStep = false;
 	memset(&fOptimize,0,sizeof(fOptimize));
+	fStepCount++;
+}
+
+void Random_c::WriteRunState(RunStateWriter &writer)
+{
+	Mover_c::WriteRunState(writer);
+
+	writer.Put(fOptimize.isFirstStep);
+	writer.Put(fStepCount);
 }
 
+bool Random_c::ReadRunState(RunStateReader &reader)
+{
+	return (Mover_c::ReadRunState(reader) &&
+			reader.Get(&fOptimize.isFirstStep) &&
+			reader.Get(&fStepCount));
+}
 
-OSErr Random_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+void Random_c::GetRandomPair(long setIndex, LECount leIndex, LETYPE leType, float *rand1, float *rand2)
+{
+	if (bUseCounterRandom)
+	{
+		CounterRandomKey key;
+
+		key.seed = (uint32_t)fRandomSeed;
+		key.spillID = setIndex;
+		key.step = fStepCount;
+		key.stream = leType;
+
+		if (this -> fOptimize.isFirstStep)
+		{
+			CounterRandomVectorInUnitCircle(key, leIndex, rand1, rand2);
+		}
+		else
+		{
+			*rand1 = CounterRandomFloat(key, leIndex, 0, -1.0, 1.0);
+			*rand2 = CounterRandomFloat(key, leIndex, 1, -1.0, 1.0);
+		}
+		return;
+	}
+
+	if (this -> fOptimize.isFirstStep)
+	{
+		GetRandomVectorInUnitCircle(rand1,rand2);
+	}
+	else
+	{
+		*rand1 = GetRandomFloat(-1.0, 1.0);
+		*rand2 = GetRandomFloat(-1.0, 1.0);
+	}
+}
+
+
+OSErr Random_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 	
 	// JS Ques: Is this required? Could cy/python invoke this method without well defined numpy arrays?
 	if(!delta || !ref) {
@@ -74,13 +183,17 @@ OSErr Random_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint
 		return 2;
 	}
 	
-	LERec* prec;
-	LERec rec;
-	prec = &rec;
-	
 	WorldPoint3D zero_delta ={0,0,0.};
+	// only the counter based random numbers are safe to draw from several threads
+	bool runParallel = fNumThreads > 1 && bUseCounterRandom && fOptimize.isOptimizedForStep && !bUseDepthDependent;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++) {
+		LERec rec;	// scratch record, private to each thread
+		LERec* prec = &rec;
 
-	for (int i = 0; i < n; i++) {
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
 		{
@@ -103,7 +216,77 @@ OSErr Random_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint
 	return noErr;
 }
 
-WorldPoint3D Random_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+OSErr Random_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+							   const double *lat, const double *lon, const double *z,
+							   const double *windages, const short *LE_status,
+							   double *delta_lat, double *delta_lon, double *delta_z,
+							   LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+
+	// depth dependent diffusion sets the coefficient per LE
+	if (bUseDepthDependent)
+		return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+									   delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+	MoveBatchLEs(n, 0, 0, model_time, step_len, lat, lon, z, windages, LE_status,
+				 delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	return noErr;
+}
+
+OSErr Random_c::BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+							   const double *lat, const double *lon, const double *z,
+							   const double *windages, const short *LE_status, LEType spillType)
+{
+	if (!this->fOptimize.isOptimizedForStep)
+	{
+		this -> fOptimize.value =  sqrt(6.*(fDiffusionCoefficient/10000.)*step_len)/METERSPERDEGREELAT; // in deg lat
+		this -> fOptimize.uncertaintyValue =  sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*step_len)/METERSPERDEGREELAT; // in deg lat
+	}
+
+	return noErr;
+}
+
+void Random_c::MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+							  const double *lat, const double *lon, const double *z,
+							  const double *windages, const short *LE_status,
+							  double *delta_lat, double *delta_lon, double *delta_z,
+							  LEType spillType, long spill_ID)
+{
+	double diffusionCoefficient;
+	float rand1, rand2;
+
+	if (spillType == UNCERTAINTY_LE)
+		diffusionCoefficient = this -> fOptimize.uncertaintyValue;
+	else
+		diffusionCoefficient = this -> fOptimize.value;
+
+	for (int k = 0; k < count; k++) {
+		LECount i = index ? index[k] : first + k;
+
+		if (LE_status[i] != OILSTAT_INWATER) {
+			delta_lat[k] = delta_lon[k] = delta_z[k] = 0.;
+			continue;
+		}
+
+		GetRandomPair(spill_ID, i, spillType, &rand1, &rand2);
+
+		delta_lon[k] = (rand1 * diffusionCoefficient) / LongToLatRatio3(lat[i] * 1000000);
+		delta_lat[k] = rand2 * diffusionCoefficient;
+		delta_z[k] = 0.;
+	}
+}
+
+WorldPoint3D Random_c::GetMove (const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double		dLong, dLat;
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -116,23 +299,13 @@ WorldPoint3D Random_c::GetMove (const Seconds& model_time, Seconds timeStep,long
 	if (bUseDepthDependent)
 	{
 		float depth=0.;
-		double localDiffusionCoefficient, factor;
 #ifndef pyGNOME
 		VectorMap_c* vMap = GetNthVectorMap(0);	// get first vector map
 		if (vMap) depth = vMap->DepthAtPoint(refPoint);
 #endif
-		// logD = 1+exp(1-1/.1H) 
-		if (depth==0)	// couldn't find the point in dagtree, maybe a different default?
-			factor = 1;
-		else
-			factor = 1 + exp(1 - 1/(.1*depth));
-		if (depth>20)
-			//localDiffusionCoefficient = pow(10,factor);
-			localDiffusionCoefficient = pow(10.,factor);
-		else
-			localDiffusionCoefficient = 0;
-		this -> fOptimize.value =  sqrt(6.*(localDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
-		this -> fOptimize.uncertaintyValue =  sqrt(fUncertaintyFactor*6.*(localDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
+		// logD = 1+exp(1-1/.1H), from the step's table
+		SetDepthTable(timeStep);
+		diffusionCoefficient = GetDepthStep(depth, leType);
 		/*if (depth<20)
 		 {
 		 localDiffusionCoefficient = 0;
@@ -149,27 +322,22 @@ WorldPoint3D Random_c::GetMove (const Seconds& model_time, Seconds timeStep,long
 		// need to get the bathymetry then set diffusion based on > 20 O(1000), < 20 O(100)
 		// figure out where LE is, interpolate to get depth (units?)
 	}
-	if(!this->fOptimize.isOptimizedForStep && !bUseDepthDependent)  
-	{
-		this -> fOptimize.value =  sqrt(6.*(fDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
-		this -> fOptimize.uncertaintyValue =  sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
-	}
-	
-	if (leType == UNCERTAINTY_LE)
-		diffusionCoefficient = this -> fOptimize.uncertaintyValue;
-	else
-		diffusionCoefficient = this -> fOptimize.value;
-	
-	if(this -> fOptimize.isFirstStep)
-	{
-		GetRandomVectorInUnitCircle(&rand1,&rand2);
-	}
 	else
 	{
-		rand1 = GetRandomFloat(-1.0, 1.0);
-		rand2 = GetRandomFloat(-1.0, 1.0);
+		if(!this->fOptimize.isOptimizedForStep)  
+		{
+			this -> fOptimize.value =  sqrt(6.*(fDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
+			this -> fOptimize.uncertaintyValue =  sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*timeStep)/METERSPERDEGREELAT; // in deg lat
+		}
+	
+		if (leType == UNCERTAINTY_LE)
+			diffusionCoefficient = this -> fOptimize.uncertaintyValue;
+		else
+			diffusionCoefficient = this -> fOptimize.value;
 	}
 	
+	GetRandomPair(setIndex, leIndex, leType, &rand1, &rand2);
+	
 	dLong = (rand1 * diffusionCoefficient )/ LongToLatRatio3 (refPoint.pLat);
 	dLat  = rand2 * diffusionCoefficient;
 	
@@ -13,7 +13,9 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "Mover_c.h"
+#include "CounterRandom.h"
 #include "ExportSymbols.h"
+#include <vector>
 
 class DLL_API Random_c : virtual public Mover_c {
 	
@@ -22,21 +24,52 @@ public:
 	TR_OPTIMZE fOptimize; // this does not need to be saved to the save file
 	double fUncertaintyFactor;		// multiplicative factor applied when uncertainty is on
 	Boolean bUseDepthDependent;
+	Boolean bUseCounterRandom;		// stateless random numbers keyed on spill, LE and step - reproducible in any LE order
+	long fRandomSeed;				// key for the counter based random numbers
+	long fStepCount;				// model steps since PrepareForModelRun
+
+	// the depth dependent step sizes, forecast and uncertainty for each bin
+	// of 10/depth, for the time step and uncertainty factor they were made for
+	std::vector<double> fDepthTable;
+	Seconds fDepthTableStep;
+	double fDepthTableFactor;
 	
 #ifndef pyGNOME
 	Random_c (TMap *owner, char *name);
 #endif
 	Random_c();
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); // AH 07/10/2012
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); // AH 07/10/2012
 	virtual void 		ModelStepIsDone();
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual void		WriteRunState(RunStateWriter &writer);
+	virtual bool		ReadRunState(RunStateReader &reader);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	
 	
-	OSErr				get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	OSErr				get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spill_ID);
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
+
+	virtual Boolean		CanFuseMove() { return !bUseDepthDependent; }
+	virtual Boolean		CanMoveInParallel(LETYPE leType) { return bUseCounterRandom && fOptimize.isOptimizedForStep && !bUseDepthDependent; }
+	virtual OSErr		BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status, LEType spillType);
+	virtual void		MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
 
 protected:
 	void				Init();
+	void				GetRandomPair(long setIndex, LECount leIndex, LETYPE leType, float *rand1, float *rand2);
+	void				SetDepthTable(Seconds timeStep);
+	// the depth dependent step size in deg lat at depth (meters)
+	double				GetDepthStep(float depth, LETYPE leType);
 };
 
 #endif
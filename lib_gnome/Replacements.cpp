@@ -10,6 +10,7 @@
 #ifdef pyGNOME
 
 #include "Replacements.h"
+#include "TextLines.h"
 #include <fstream>
 #include <ios>
 #include <sys/stat.h>
@@ -505,7 +506,7 @@ Boolean IsShioFile(char* path)
 		return false;
 }
 
-bool IsTriGridFile (vector<string> &linesInFile)
+bool IsTriGridFile (TextLines &linesInFile)
 {
 	long lineIdx = 0;
 	string currentLine;
@@ -513,7 +514,8 @@ bool IsTriGridFile (vector<string> &linesInFile)
 	string value1S;
 
 	// First line, must start with 'DAG'
-	currentLine = trim(linesInFile[lineIdx++]);
+	currentLine = linesInFile[lineIdx++];
+	trim(currentLine);
 
 	istringstream lineStream(currentLine);
 
@@ -527,6 +529,13 @@ bool IsTriGridFile (vector<string> &linesInFile)
 	return true;
 }
 
+bool IsTriGridFile (vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return IsTriGridFile(lines);
+}
+
 Boolean IsTriGridFile (char *path)
 {
 	vector<string> linesInFile;
@@ -95,6 +95,7 @@ Boolean IsGridWindFile (char *path, short *selectedUnits);
 bool IsShioFile (std::vector<std::string> &linesInFile);
 Boolean IsShioFile (char *path);
 
+bool IsTriGridFile (TextLines &linesInFile);
 bool IsTriGridFile (std::vector<std::string> &linesInFile);
 Boolean IsTriGridFile (char *path);
 
@@ -45,8 +45,10 @@ OSErr RiseVelocity_c::PrepareForModelRun()
 }
 
 
-OSErr RiseVelocity_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr RiseVelocity_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	//this -> fOptimize.isOptimizedForStep = true;
 	//this -> fOptimize.value = sqrt(6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
 	//this -> fOptimize.uncertaintyValue = sqrt(fUncertaintyFactor*6.*(fDiffusionCoefficient/10000.)*time_step)/METERSPERDEGREELAT; // in deg lat
@@ -56,13 +58,14 @@ OSErr RiseVelocity_c::PrepareForModelStep(const Seconds& model_time, const Secon
 
 void RiseVelocity_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	//if (this -> fOptimize.isFirstStep == true) this -> fOptimize.isFirstStep = false;
 	//memset(&fOptimize,0,sizeof(fOptimize));
 }
 
-OSErr get_rise_velocity(int n, double *rise_velocity, double *le_density, double *le_droplet_size, double water_viscosity, double water_density)
+OSErr get_rise_velocity(LECount n, double *rise_velocity, double *le_density, double *le_droplet_size, double water_viscosity, double water_density)
 {
-	for (int i=0; i < n; i++)
+	for (LECount i = 0; i < n; i++)
 	{
 		rise_velocity[i] = GetRiseVelocity(le_density[i], le_droplet_size[i], water_viscosity, water_density);
 	}
@@ -151,11 +154,13 @@ double GetDropletSize(double riseVelocity, double water_viscosity, double water_
 	return y1;
 }
 
-OSErr RiseVelocity_c::get_move(int n, unsigned long model_time, unsigned long step_len,
+OSErr RiseVelocity_c::get_move(LECount n, unsigned long model_time, unsigned long step_len,
 							   WorldPoint3D *ref, WorldPoint3D *delta,
 							   double *rise_velocity,
 							   short *LE_status, LEType spillType, long spill_ID)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 	// JS Ques: Is this required? Could cy/python invoke this method without well defined numpy arrays?
 	if (!delta || !ref || !rise_velocity) {
 		//cerr << "(delta, ref, rise_velocity) = ("
@@ -169,28 +174,13 @@ OSErr RiseVelocity_c::get_move(int n, unsigned long model_time, unsigned long st
 		return 2;
 	}
 
-	LERec rec;
-	WorldPoint3D zero_delta = { {0, 0}, 0.};
+	// the move is GetMove's, without the copy to an LERec and the call per LE
+	double timeStep = step_len;
 
-	for (int i = 0; i < n; i++) {
-		if (LE_status[i] != OILSTAT_INWATER) {
-			delta[i] = zero_delta;
-			continue;
-		}
-
-		rec.p = ref[i].p;
-		rec.z = ref[i].z;
-
-		rec.riseVelocity = rise_velocity[i];
-
-		// let's do the multiply by 1000000 here - this is what gnome expects
-		//rec.p.pLat *= 1e6;	// not using the lat, lon at this point
-		//rec.p.pLong*= 1000000;
-
-		delta[i] = this->GetMove(model_time, step_len, spill_ID, i, &rec, spillType);
-
-		//delta[i].p.pLat /= 1e6;
-		//delta[i].p.pLong /= 1e6;
+	for (LECount i = 0; i < n; i++) {
+		delta[i].p.pLat = 0;
+		delta[i].p.pLong = 0;
+		delta[i].z = (LE_status[i] == OILSTAT_INWATER) ? -1. * rise_velocity[i] * timeStep : 0.;
 	}
 
 	return noErr;
@@ -198,7 +188,7 @@ OSErr RiseVelocity_c::get_move(int n, unsigned long model_time, unsigned long st
 
 
 WorldPoint3D RiseVelocity_c::GetMove(const Seconds &model_time, Seconds timeStep,
-									 long setIndex, long leIndex, LERec *theLE, LETYPE leType)
+									 long setIndex, LECount leIndex, LERec *theLE, LETYPE leType)
 {
 	WorldPoint3D deltaPoint = { {0, 0}, 0.};
 	// for now not implementing uncertainty
@@ -17,7 +17,7 @@
 
 // functions for computing rise velocity from droplet size
 // get_rise_velocity is exposed to Cython/Python for PyGnome
-OSErr DLL_API get_rise_velocity(int n, double *rise_velocity, double *le_density, double *le_droplet_size, double water_viscosity, double water_density);
+OSErr DLL_API get_rise_velocity(LECount n, double *rise_velocity, double *le_density, double *le_droplet_size, double water_viscosity, double water_density);
 double GetRiseVelocity(double le_density, double le_droplet_size, double water_viscosity, double water_density);
 
 class DLL_API RiseVelocity_c : virtual public Mover_c {
@@ -32,14 +32,14 @@ public:
 	RiseVelocity_c();
 
 	virtual OSErr PrepareForModelRun();
-	virtual OSErr PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList);
+	virtual OSErr PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList);
 
 	virtual void ModelStepIsDone();
 
 	virtual WorldPoint3D GetMove(const Seconds& model_time, Seconds timeStep,
-								 long setIndex, long leIndex, LERec *theLE, LETYPE leType);
+								 long setIndex, LECount leIndex, LERec *theLE, LETYPE leType);
 
-	OSErr get_move(int n, unsigned long model_time, unsigned long step_len,
+	OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len,
 				   WorldPoint3D *ref, WorldPoint3D *delta,
 				  // double *rise_velocity, double *density, double *droplet_size,
 				   double *rise_velocity,
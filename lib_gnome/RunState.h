@@ -0,0 +1,108 @@
+/*
+ *  RunState.h
+ *  gnome
+ *
+ *  Reading and writing the runtime state of a mover -- what a run changes
+ *  after PrepareForModelRun: uncertainty lists, step counters, first step
+ *  flags -- as bytes, for model checkpoints (Mover_c::GetRunState and
+ *  SetRunState). The bytes are the values as they are in memory, so they
+ *  are only read back by the same build on the same machine, by a mover
+ *  set up the same way.
+ *
+ *  A mover's state is its base class's state followed by its own, so each
+ *  GetRunState calls the base class's first, and SetRunState reads the
+ *  state back in the same order.
+ *
+ */
+
+#ifndef __RunState__
+#define __RunState__
+
+#include <string.h>
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "MemUtils.h"
+
+class RunStateWriter {
+
+public:
+	std::vector<char>	&fState;
+
+	RunStateWriter(std::vector<char> &state) : fState(state) {}
+
+	void PutBytes(const void *p, long n)
+	{
+		const char *c = (const char *)p;
+
+		fState.insert(fState.end(), c, c + n);
+	}
+
+	template <class T> void Put(const T &value) { PutBytes(&value, sizeof(T)); }
+
+	// the size of the handle and its contents, -1 for no handle
+	void PutHandle(Handle h)
+	{
+		long n = h ? _GetHandleSize(h) : -1;
+
+		Put(n);
+		if (n > 0)
+			PutBytes(*h, n);
+	}
+};
+
+class RunStateReader {
+
+public:
+	const char	*fState;
+	long		fSize;
+	long		fPos;
+
+	RunStateReader(const char *state, long size) : fState(state), fSize(size), fPos(0) {}
+
+	// the read would go past the end of the state -- a state from another mover
+	bool GetBytes(void *p, long n)
+	{
+		if (n < 0 || fPos + n > fSize)
+			return false;
+
+		memcpy(p, fState + fPos, n);
+		fPos += n;
+
+		return true;
+	}
+
+	template <class T> bool Get(T *value) { return GetBytes(value, sizeof(T)); }
+
+	// a handle written by PutHandle, replacing *h (which is disposed of)
+	bool GetHandle(Handle *h)
+	{
+		long n;
+
+		if (!Get(&n))
+			return false;
+
+		if (n < 0) {
+			if (*h) DisposeHandle(*h);
+			*h = 0;
+			return true;
+		}
+
+		if (fPos + n > fSize)
+			return false;
+
+		if (!*h)
+			*h = _NewHandle(n);
+		else
+			_SetHandleSize(*h, n);
+		if (!*h || _MemError())
+			return false;
+
+		return GetBytes(**h, n);
+	}
+
+	bool AtEnd() { return fPos == fSize; }
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ *  SetupStats.cpp
+ *  gnome
+ *
+ */
+
+#include <string.h>
+#include <chrono>
+
+#include "SetupStats.h"
+#include "GnomeThreads.h"
+
+static const char *stageNames[kNumSetupStages] = {"topology", "islands", "dag_tree", "year_data", "time_scan"};
+static const char *cacheNames[kNumSetupCaches] = {"topology", "time_index", "time_values", "tide_table"};
+
+static SetupStageStats stageStats[kNumSetupStages];
+static int64_t cacheHitCounts[kNumSetupCaches];
+
+// the grids of the movers loaded at the same time are read on several threads
+static GnomeMutex &StatsMutex()
+{
+	static GnomeMutex *statsMutex = new GnomeMutex;
+	return *statsMutex;
+}
+
+static int64_t SetupClock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void GetSetupStats(SetupStageStats stages[kNumSetupStages], int64_t cacheHits[kNumSetupCaches])
+{
+	GnomeLock statsLock(StatsMutex());
+
+	memcpy(stages, stageStats, sizeof(stageStats));
+	memcpy(cacheHits, cacheHitCounts, sizeof(cacheHitCounts));
+}
+
+void ResetSetupStats()
+{
+	GnomeLock statsLock(StatsMutex());
+
+	memset(stageStats, 0, sizeof(stageStats));
+	memset(cacheHitCounts, 0, sizeof(cacheHitCounts));
+}
+
+const char *GetSetupStageName(short stage)
+{
+	return stage >= 0 && stage < kNumSetupStages ? stageNames[stage] : "";
+}
+
+const char *GetSetupCacheName(short cache)
+{
+	return cache >= 0 && cache < kNumSetupCaches ? cacheNames[cache] : "";
+}
+
+void CountSetupCacheHit(short cache)
+{
+	GnomeLock statsLock(StatsMutex());
+
+	cacheHitCounts[cache]++;
+}
+
+SetupStage::SetupStage(short stage)
+{
+	fStage = stage;
+	fStart = SetupClock();
+}
+
+SetupStage::~SetupStage()
+{
+	int64_t elapsed = SetupClock() - fStart;
+	GnomeLock statsLock(StatsMutex());
+
+	stageStats[fStage].count++;
+	stageStats[fStage].nanoseconds += elapsed;
+}
@@ -0,0 +1,54 @@
+/*
+ *  SetupStats.h
+ *  gnome
+ *
+ *  What making the grids, maps and tides of a model cost the process: the
+ *  time in the stages that dominate it -- building a curvilinear grid's
+ *  topology, numbering the islands of a land mask, making DAG trees,
+ *  reading tide year data and scanning forcing files for their times --
+ *  and the number of times each of the caches served one. Always kept, the
+ *  stages run a few times per object; gnome.utilities.setup_profile reads
+ *  them before and after each object's setup.
+ *
+ *  The stages may nest: a topology build includes the islands and the DAG
+ *  tree it makes.
+ *
+ */
+
+#ifndef __SetupStats__
+#define __SetupStats__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "ExportSymbols.h"
+
+enum { kSetupTopology = 0, kSetupIslands, kSetupDagTree, kSetupYearData, kSetupTimeScan, kNumSetupStages };
+
+enum { kSetupCacheTopology = 0, kSetupCacheTimeIndex, kSetupCacheTimeValues, kSetupCacheTideTable, kNumSetupCaches };
+
+typedef struct {
+	int64_t	count;
+	int64_t	nanoseconds;
+} SetupStageStats;
+
+// since the process started or the last ResetSetupStats
+DLL_API void GetSetupStats(SetupStageStats stages[kNumSetupStages], int64_t cacheHits[kNumSetupCaches]);
+DLL_API void ResetSetupStats();
+DLL_API const char *GetSetupStageName(short stage);
+DLL_API const char *GetSetupCacheName(short cache);
+
+// a stage the cache served instead, from any thread
+void CountSetupCacheHit(short cache);
+
+// times its scope into the stage, from any thread
+class SetupStage {
+public:
+	SetupStage(short stage);
+	~SetupStage();
+private:
+	short	fStage;
+	int64_t	fStart;
+};
+
+#endif
@@ -412,6 +412,14 @@ double RStatHeight(double	theTime,	// time in hrs from begin of year
 					 short	ncoeff,		// number of coefficients to use
 					 double	datum);		// datum in feet
 
+void RStatHeights(const double *times,	// times in hrs from begin of year
+				  long		numTimes,	// number of times
+				  double	*AMPA,		// amplitude corrected for year
+				  double	*epoch,		// epoch corrected for year
+				  short		ncoeff,		// number of coefficients to use
+				  double	datum,		// datum in feet
+				  double	*heights);	// the heights at the times
+
 
 
 
@@ -626,6 +634,15 @@ double RStatCurrent(double	theTime,	// time in hrs from begin of year
 					 short	ncoeff,		// number of coefficients to use
 					 short	CFlag);		// hydraulic station flag
 
+void RStatCurrents(const double *times,	// times in hrs from begin of year
+				   long		numTimes,	// number of times
+				   double	*AMPA,		// amplitude corrected for year
+				   double	*epoch,		// epoch corrected for year
+				   double	refCur,		// reference current in knots
+				   short	ncoeff,		// number of coefficients to use
+				   short	CFlag,		// hydraulic station flag
+				   double	*currents);	// the currents at the times
+
 double RStatCurrentRot(double		theTime,		// time in hrs from begin of year
                      double			*AMPA,			// amplitude corrected for year
 					 double			*epoch,			// epoch corrected for year
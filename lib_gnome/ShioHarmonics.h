@@ -0,0 +1,32 @@
+/*
+ *  ShioHarmonics.h
+ *  gnome
+ *
+ *  Sums of the harmonic constituents for many times at once, for the
+ *  reference station curves in ShioHeight.cpp and ShioCurrent2.cpp.
+ *
+ */
+
+#ifndef __ShioHarmonics__
+#define __ShioHarmonics__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+#define kNumShioFrequencies 114
+
+// constituent speeds in degrees per hour, in the order of the constituent files
+extern const double kShioFrequencies[kNumShioFrequencies];
+
+// sums[k] is the sum over the constituents of AMPA[i]*cos(freq[i]*times[k] + epoch[i]),
+// epoch in degrees, without the datum. Bitwise the same as summing one time at a time.
+void HarmonicSeries(const double *times, long numTimes, const double *AMPA, const double *epoch,
+					short ncoeff, double *sums);
+
+// for evenly spaced times, step the cosines by angle addition instead of calling cos,
+// agrees with the direct sums to about 1e-11 of the amplitudes but is not bitwise the same
+void DLL_API SetHarmonicRecurrence(Boolean useRecurrence);
+Boolean DLL_API GetHarmonicRecurrence();
+
+#endif
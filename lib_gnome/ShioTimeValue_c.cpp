@@ -12,6 +12,9 @@
 #include "ShioTimeValue_c.h"
 #include "StringFunctions.h"
 #include "MemUtils.h"
+#include "TopologyCache.h"
+#include "TideTableCache.h"
+#include "SetupStats.h"
 #include <iostream>
 
 #ifndef pyGNOME
@@ -401,14 +404,16 @@ void ShioTimeValue_c::GetYearDataPath(char *pathName)
 /////////////////////////////////////////////////
 OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *value)
 {
+	GnomeLock valueLock(fValueMutex);
 	OSErr err = 0;
 	Boolean needToCompute = true;
 	// Seconds modelStartTime = model->GetStartTime();	// minus AH 07/10/2012
 	// Seconds modelEndTime = model->GetEndTime();		// minus AH 07/10/2012
 
 	DateTimeRec beginDate, endDate;
-	Seconds beginSeconds;
+	Seconds beginSeconds, endSeconds;
 	Boolean daylightSavings;
+	uint64_t tideKey;
 	YEARDATAHDL		YHdl = 0; 
 	double *XODE=0, *VPU=0;
     //YEARDATA		*yearData = (YEARDATA *) NULL;
@@ -458,6 +463,21 @@ OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *va
 	endDate.second = 0;
 	 
 	daylightSavings = this->DaylightSavingTimeInEffect(&beginDate);// code goes here, set the daylight flag
+	DateToSeconds(&endDate, &endSeconds);
+	
+	// the same station and window may have been computed before
+	tideKey = this->GetTideTableKey(beginSeconds, endSeconds, daylightSavings);
+	if (this->LoadTideTable(tideKey))
+	{
+#ifndef pyGNOME
+		model->NewDirtNotification(DIRTY_LIST);// what we display in the list is invalid
+#endif
+		if (this->fStationType == 'H')
+			return GetHeightDerivValue(current_time, value);
+		else if (this->fStationType == 'P')
+			return ScaleProgressiveWaveValue(value);
+		return OSSMTimeValue_c::GetTimeValue(current_time,value);
+	}
 #ifndef pyGNOME	
 #ifdef IBM	// code goes here - decide where to put the yeardata folder
 	YHdl = GetYearData(beginDate.year);
@@ -750,6 +770,7 @@ OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *va
 		if (VPU)  {delete [] VPU; VPU = 0;}
 		if (conArray) {delete [] conArray; conArray = 0;}
 		if(err) return err;
+		this->SaveTideTable(tideKey);
 	}
 	
 	else if (this->fStationType == 'H')
@@ -908,56 +929,8 @@ OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *va
 		// Find derivative
 		if(!err)
 		{
-			long i;
-			Boolean valueFound = false;
-			Seconds midTime;
-			double forHeight, maxMinDeriv, largestDeriv = 0.;
-			HighLowData startHighLowData,endHighLowData;
-			double scaleFactor = 1.;
-			char msg[256];
-			for( i=0 ; i<this->GetNumHighLowValues()-1; i++) 
-			{
-				startHighLowData = INDEXH(fHighLowDataHdl, i);
-				endHighLowData = INDEXH(fHighLowDataHdl, i+1);
-		//		if (forTime == startHighLowData.time || forTime == this->GetNumHighLowValues()-1)	// minus AH 07/10/2012
-				if (current_time == startHighLowData.time || current_time == this->GetNumHighLowValues()-1)	// AH 07/10/2012
-				{
-					(*value).u = 0.;	// derivative is zero at the highs and lows
-					(*value).v = 0.;
-					valueFound = true;
-				}
-		//		if (forTime > startHighLowData.time && forTime < endHighLowData.time && !valueFound)	// minus AH 07/10/2012
-				if (current_time > startHighLowData.time && current_time < endHighLowData.time && !valueFound)	// AH 07/10/2012
-				{
-				//	(*value).u = GetDeriv(startHighLowData.time, startHighLowData.height, 
-				//						  endHighLowData.time, endHighLowData.height, forTime);		// minus AH 07/10/2012
-					(*value).u = GetDeriv(startHighLowData.time, startHighLowData.height,endHighLowData.time, endHighLowData.height, current_time);	// AH 07/10/2012
-										  
-					(*value).v = 0.;
-					valueFound = true;
-				}
-				// find the maxMins for this region...
-				midTime = (endHighLowData.time - startHighLowData.time)/2 + startHighLowData.time;
-				maxMinDeriv = GetDeriv(startHighLowData.time, startHighLowData.height,
-									   endHighLowData.time, endHighLowData.height, midTime);
-				// track largest and save all for left hand list, but only do this first time...
-				if (fabs(maxMinDeriv) > largestDeriv) largestDeriv = fabs(maxMinDeriv);
-			}		
-			/////////////////////////////////////////////////
-			// ask for a scale factor if not known from wizard
-			sprintf(msg,"The largest calculated derivative was %.4lf", largestDeriv);
-			strcat(msg, ".  Enter scale factor for heights coefficients file : ");
-			if (fScaleFactor==0)
-			{
-#ifndef pyGNOME
-				err = GetScaleFactorFromUser(msg,&scaleFactor);
-#else
-				err = 1;
-#endif
-				if (err) goto done_heights;
-				fScaleFactor = scaleFactor;
-			}
-			(*value).u = (*value).u * fScaleFactor;
+			this->SaveTideTable(tideKey);
+			err = GetHeightDerivValue(current_time, value);
 		}
 		
 		
@@ -1117,28 +1090,8 @@ OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *va
 		// Find derivative
 		if(!err)
 		{
-			/////////////////////////////////////////////////
-			// ask for a scale factor if not known from wizard
-			/*fScaleFactor = 1;	// will want a scale factor, but not related to derivative
-			 (*value).u = (*value).u * fScaleFactor;*/
-			/////////////////////////////////////////////////
-			// ask for a scale factor if not known from wizard
-			//sprintf(msg,lfFix("The largest calculated derivative was %.4lf"),largestDeriv);
-			//strcat(msg, ".  Enter scale factor for heights coefficients file : ");
-			char msg[256];
-			double scaleFactor;
-			strcpy(msg, "Enter scale factor for progressive wave coefficients file : ");
-			if (fScaleFactor==0)
-			{
-#ifndef pyGNOME
-				err = GetScaleFactorFromUser(msg,&scaleFactor);
-#else
-				err = 1;
-#endif
-				if (err) goto done_heights2;
-				fScaleFactor = scaleFactor;
-			}
-			(*value).u = (*value).u * fScaleFactor;
+			this->SaveTideTable(tideKey);
+			err = ScaleProgressiveWaveValue(value);
 		}
 		
 		
@@ -1166,40 +1119,245 @@ OSErr ShioTimeValue_c::GetTimeValue(const Seconds& current_time, VelocityRec *va
 	return OSSMTimeValue_c::GetTimeValue(current_time,value);	// minus AH 07/10/2012
 }
 
-double ShioTimeValue_c::GetDeriv (Seconds t1, double val1, Seconds t2, double val2, Seconds theTime)
+// the last high or low at or before forTime that starts an interval, -1 if
+// there is none. The highs and lows are in time order
+long ShioTimeValue_c::GetHighLowIndex(Seconds forTime)
 {
-	double dt = float (t2 - t1) / 3600.;
-	if( dt<0.000000001){
-		return val2;
+	long startIndex = 0, endIndex = this->GetNumHighLowValues() - 2, midIndex;
+
+	if (endIndex < 0 || forTime < INDEXH(fHighLowDataHdl, 0).time)
+		return -1;
+
+	while (startIndex < endIndex) {
+		midIndex = (startIndex + endIndex + 1) / 2;
+		if (INDEXH(fHighLowDataHdl, midIndex).time <= forTime)
+			startIndex = midIndex;
+		else
+			endIndex = midIndex - 1;
 	}
-	double x = (theTime - t1) / (3600. * dt);
-	double deriv = 6. * x * (val1 - val2) * (x - 1.) / dt;
-	return (3048./3600.) * deriv;	// convert from ft/hr to m/s, added 10^4 fudge factor so scale is O(1)
+
+	return startIndex;
 }
 
-OSErr ShioTimeValue_c::GetConvertedHeightValue(Seconds forTime, VelocityRec *value)
+// the height derivative from the highs and lows, times the scale factor
+OSErr ShioTimeValue_c::GetHeightDerivValue(const Seconds& current_time, VelocityRec *value)
 {
-	long i;
 	OSErr err = 0;
+	long i, n = this->GetNumHighLowValues();
+	Seconds midTime;
+	double forHeight, maxMinDeriv, largestDeriv = 0.;
 	HighLowData startHighLowData,endHighLowData;
-	for( i=0 ; i<this->GetNumHighLowValues()-1; i++) 
+	double scaleFactor = 1.;
+	char msg[256];
+
+	// the interval the time is in, instead of testing them all
+	i = GetHighLowIndex(current_time);
+	if (n > 1 && current_time == n - 1)	// as the loop over the intervals had it
+	{
+		(*value).u = 0.;
+		(*value).v = 0.;
+	}
+	else if (i >= 0)
 	{
 		startHighLowData = INDEXH(fHighLowDataHdl, i);
 		endHighLowData = INDEXH(fHighLowDataHdl, i+1);
-		if (forTime == startHighLowData.time || forTime == this->GetNumHighLowValues()-1)
+		if (current_time == startHighLowData.time)
 		{
 			(*value).u = 0.;	// derivative is zero at the highs and lows
 			(*value).v = 0.;
-			return noErr;
 		}
-		if (forTime>startHighLowData.time && forTime<endHighLowData.time)
+		else if (current_time < endHighLowData.time)
 		{
-			(*value).u = GetDeriv(startHighLowData.time, startHighLowData.height, 
-								  endHighLowData.time, endHighLowData.height, forTime) * fScaleFactor;
+			(*value).u = GetDeriv(startHighLowData.time, startHighLowData.height,endHighLowData.time, endHighLowData.height, current_time);	// AH 07/10/2012
 			(*value).v = 0.;
-			return noErr;
 		}
 	}
+	/////////////////////////////////////////////////
+	// ask for a scale factor if not known from wizard
+	if (fScaleFactor==0)
+	{
+		for( i=0 ; i<n-1; i++) 
+		{
+			startHighLowData = INDEXH(fHighLowDataHdl, i);
+			endHighLowData = INDEXH(fHighLowDataHdl, i+1);
+			// find the maxMins for this region...
+			midTime = (endHighLowData.time - startHighLowData.time)/2 + startHighLowData.time;
+			maxMinDeriv = GetDeriv(startHighLowData.time, startHighLowData.height,
+								   endHighLowData.time, endHighLowData.height, midTime);
+			if (fabs(maxMinDeriv) > largestDeriv) largestDeriv = fabs(maxMinDeriv);
+		}
+		sprintf(msg,"The largest calculated derivative was %.4lf", largestDeriv);
+		strcat(msg, ".  Enter scale factor for heights coefficients file : ");
+#ifndef pyGNOME
+		err = GetScaleFactorFromUser(msg,&scaleFactor);
+#else
+		err = 1;
+#endif
+		if (err) return err;
+		fScaleFactor = scaleFactor;
+	}
+	(*value).u = (*value).u * fScaleFactor;
+	return err;
+}
+
+// the progressive wave value times the scale factor
+OSErr ShioTimeValue_c::ScaleProgressiveWaveValue(VelocityRec *value)
+{
+	OSErr err = 0;
+	/////////////////////////////////////////////////
+	// ask for a scale factor if not known from wizard
+	/*fScaleFactor = 1;	// will want a scale factor, but not related to derivative
+	 (*value).u = (*value).u * fScaleFactor;*/
+	/////////////////////////////////////////////////
+	// ask for a scale factor if not known from wizard
+	//sprintf(msg,lfFix("The largest calculated derivative was %.4lf"),largestDeriv);
+	//strcat(msg, ".  Enter scale factor for heights coefficients file : ");
+	char msg[256];
+	double scaleFactor;
+	strcpy(msg, "Enter scale factor for progressive wave coefficients file : ");
+	if (fScaleFactor==0)
+	{
+#ifndef pyGNOME
+		err = GetScaleFactorFromUser(msg,&scaleFactor);
+#else
+		err = 1;
+#endif
+		if (err) return err;
+		fScaleFactor = scaleFactor;
+	}
+	(*value).u = (*value).u * fScaleFactor;
+	return err;
+}
+
+static uint64_t HashData(const DATA &data, uint64_t hash)
+{	// field by field, the struct has padding
+	hash = TopologyCacheHash(&data.val, sizeof(data.val), hash);
+	return TopologyCacheHash(&data.dataAvailFlag, sizeof(data.dataAvailFlag), hash);
+}
+
+// everything GetTideCurrent and GetTideHeight use for a window
+uint64_t ShioTimeValue_c::GetTideTableKey(Seconds beginSeconds, Seconds endSeconds, Boolean daylightSavings)
+{
+	const CONTROLVAR &controls = this->fConstituent.DatumControls;
+	const DATA *offsets;
+	long i, numOffsets;
+	uint64_t hash = kTopologyHashSeed;
+
+	hash = TopologyCacheHash(&this->fStationType, sizeof(this->fStationType), hash);
+	hash = TopologyCacheHash(this->fStationName, strlen(this->fStationName), hash);
+	hash = TopologyCacheHash(this->fYearDataPath, strlen(this->fYearDataPath) + 1, hash);
+	hash = TopologyCacheHash(&controls.datum, sizeof(controls.datum), hash);
+	hash = TopologyCacheHash(&controls.FDir, sizeof(controls.FDir), hash);
+	hash = TopologyCacheHash(&controls.EDir, sizeof(controls.EDir), hash);
+	hash = TopologyCacheHash(&controls.L2Flag, sizeof(controls.L2Flag), hash);
+	hash = TopologyCacheHash(&controls.HFlag, sizeof(controls.HFlag), hash);
+	hash = TopologyCacheHash(&controls.RotFlag, sizeof(controls.RotFlag), hash);
+	if (this->fConstituent.H)
+		hash = TopologyCacheHash(*this->fConstituent.H, _GetHandleSize((Handle)this->fConstituent.H), hash);
+	if (this->fConstituent.kPrime)
+		hash = TopologyCacheHash(*this->fConstituent.kPrime, _GetHandleSize((Handle)this->fConstituent.kPrime), hash);
+
+	offsets = (const DATA *)&this->fHeightOffset;
+	numOffsets = sizeof(this->fHeightOffset) / sizeof(DATA);
+	for (i = 0; i < numOffsets; i++)
+		hash = HashData(offsets[i], hash);
+	offsets = (const DATA *)&this->fCurrentOffset;
+	numOffsets = sizeof(this->fCurrentOffset) / sizeof(DATA);
+	for (i = 0; i < numOffsets; i++)
+		hash = HashData(offsets[i], hash);
+
+	hash = TopologyCacheHash(&beginSeconds, sizeof(beginSeconds), hash);
+	hash = TopologyCacheHash(&endSeconds, sizeof(endSeconds), hash);
+	return TopologyCacheHash(&daylightSavings, sizeof(daylightSavings), hash);
+}
+
+// the station's, not the time values': those are recomputed for each window
+uint64_t ShioTimeValue_c::GetValuesKey()
+{
+	GnomeLock valueLock(fValueMutex);
+	uint64_t key = this->GetTideTableKey(0, 0, false);
+
+	key = TopologyCacheHash(&this->daylight_savings_off, sizeof(this->daylight_savings_off), key);
+	return TopologyCacheHash(&this->fScaleFactor, sizeof(this->fScaleFactor), key);
+}
+
+// installs the cached tables for the window, returns false if there are none
+Boolean ShioTimeValue_c::LoadTideTable(uint64_t key)
+{
+	TimeValuePairH tvals = 0;
+	EbbFloodDataH ebbFloods = 0;
+	HighLowDataH highLows = 0;
+
+	if (this->fStationType != 'C' && this->fStationType != 'H' && this->fStationType != 'P')
+		return false;
+	if (!TideTableCacheIsOn() || FindTideTable(key, &tvals, &ebbFloods, &highLows))
+		return false;
+
+	if (!tvals) {
+		if (ebbFloods) _DisposeHandle((Handle)ebbFloods);
+		if (highLows) _DisposeHandle((Handle)highLows);
+		return false;
+	}
+
+	this->SetTimeValueHandle(tvals);
+	if (this->fStationType == 'C') {
+		if (fEbbFloodDataHdl) _DisposeHandle((Handle)fEbbFloodDataHdl);
+		fEbbFloodDataHdl = ebbFloods;
+		if (highLows) _DisposeHandle((Handle)highLows);
+	}
+	else {
+		if (fHighLowDataHdl) _DisposeHandle((Handle)fHighLowDataHdl);
+		fHighLowDataHdl = highLows;
+		if (ebbFloods) _DisposeHandle((Handle)ebbFloods);
+	}
+	CountSetupCacheHit(kSetupCacheTideTable);
+	return true;
+}
+
+void ShioTimeValue_c::SaveTideTable(uint64_t key)
+{
+	if (!TideTableCacheIsOn() || !this->timeValues)
+		return;
+
+	if (this->fStationType == 'C')
+		AddTideTable(key, this->timeValues, fEbbFloodDataHdl, 0);
+	else
+		AddTideTable(key, this->timeValues, 0, fHighLowDataHdl);
+}
+
+double ShioTimeValue_c::GetDeriv (Seconds t1, double val1, Seconds t2, double val2, Seconds theTime)
+{
+	double dt = float (t2 - t1) / 3600.;
+	if( dt<0.000000001){
+		return val2;
+	}
+	double x = (theTime - t1) / (3600. * dt);
+	double deriv = 6. * x * (val1 - val2) * (x - 1.) / dt;
+	return (3048./3600.) * deriv;	// convert from ft/hr to m/s, added 10^4 fudge factor so scale is O(1)
+}
+
+OSErr ShioTimeValue_c::GetConvertedHeightValue(Seconds forTime, VelocityRec *value)
+{
+	long i = GetHighLowIndex(forTime), n = this->GetNumHighLowValues();
+	HighLowData startHighLowData,endHighLowData;
+
+	if (i < 0 && !(n > 1 && forTime == n - 1))
+		return -1; // point not found
+	if (i < 0 || forTime == INDEXH(fHighLowDataHdl, i).time || forTime == n - 1)
+	{
+		(*value).u = 0.;	// derivative is zero at the highs and lows
+		(*value).v = 0.;
+		return noErr;
+	}
+	startHighLowData = INDEXH(fHighLowDataHdl, i);
+	endHighLowData = INDEXH(fHighLowDataHdl, i+1);
+	if (forTime < endHighLowData.time)
+	{
+		(*value).u = GetDeriv(startHighLowData.time, startHighLowData.height, 
+							  endHighLowData.time, endHighLowData.height, forTime) * fScaleFactor;
+		(*value).v = 0.;
+		return noErr;
+	}
 	return -1; // point not found
 }
 
@@ -1615,6 +1773,7 @@ YEARDATA2* ReadYearData(short year, const char *path, char *errStr)
 	
 	// if errStr not empty then don't bother, something has already gone wrong
 	
+	SetupStage	setupStage(kSetupYearData);
 	YEARDATA2	*result = 0;
 	FILE		*stream = 0;
 	double		*xode = 0;
@@ -10,6 +10,8 @@
 #ifndef __ShioTimeValue_c__
 #define __ShioTimeValue_c__
 
+#include <stdint.h>
+
 #include "Shio.h"
 #include "OSSMTimeValue_c.h"
 #include "ExportSymbols.h"
@@ -66,6 +68,13 @@ protected:
 	long 		I_SHIOHIGHLOWS(void);
 	long 		I_SHIOEBBFLOODS(void);
 	
+	OSErr		GetHeightDerivValue(const Seconds& current_time, VelocityRec *value);
+	long		GetHighLowIndex(Seconds forTime);
+	OSErr		ScaleProgressiveWaveValue(VelocityRec *value);
+	uint64_t	GetTideTableKey(Seconds beginSeconds, Seconds endSeconds, Boolean daylightSavings);
+	Boolean		LoadTideTable(uint64_t key);
+	void		SaveTideTable(uint64_t key);
+	
 public:						
 	char					fStationType;
 	bool					daylight_savings_off;	// AH 07/09/2012
@@ -86,6 +95,7 @@ public:
 	virtual long			GetNumEbbFloodValues ();	
 	virtual long			GetNumHighLowValues ();
 	virtual OSErr			GetTimeValue(const Seconds& current_time, VelocityRec *value);
+	virtual uint64_t		GetValuesKey();
 	//virtual WorldPoint		GetStationLocation (void);
 	
 	virtual	double			GetDeriv (Seconds t1, double val1, Seconds t2, double val2, Seconds theTime);
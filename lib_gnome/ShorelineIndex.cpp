@@ -0,0 +1,199 @@
+/*
+ *  ShorelineIndex.cpp
+ *  gnome
+ *
+ *  A segment is only in range of a point when the point is in the
+ *  segment's box widened by dLong, dLat (DistFromWPointToSegmentDouble
+ *  returns -1 otherwise), so the segments of the point's bucket are all the
+ *  segments the full loop would have measured. They are kept in the loop's
+ *  order, and only a strictly closer segment replaces the closest one, so
+ *  ties go to the same object as in the loop.
+ *
+ */
+
+#include <math.h>
+
+#include "ShorelineIndex.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+double DistFromWPointToSegmentDouble(long pLong, long pLat, long long1, long lat1, 
+									 long long2, long lat2, long dLong, long dLat);
+
+ShorelineIndex::ShorelineIndex()
+{
+	fObjectList = 0;
+	fNumObjects = fNumPts = 0;
+	fDLong = fDLat = 0;
+	fLeft = fBottom = fRight = fTop = 0;
+	fBucketWidth = fBucketHeight = 1;
+	fNumRows = fNumCols = 0;
+}
+
+void ShorelineIndex::Dispose()
+{
+	fObjectList = 0;
+	fNumObjects = fNumPts = 0;
+	fNumRows = fNumCols = 0;
+	fESICode.clear();
+	fSegs.clear();
+	fBucketStart.clear();
+	fBucketSegs.clear();
+}
+
+void ShorelineIndex::GetBucket(long h, long v, long *col, long *row)
+{
+	long c = (long)((h - fLeft) / fBucketWidth);
+	long r = (long)((v - fBottom) / fBucketHeight);
+
+	*col = c < 0 ? 0 : (c >= fNumCols ? fNumCols - 1 : c);
+	*row = r < 0 ? 0 : (r >= fNumRows ? fNumRows - 1 : r);
+}
+
+long ShorelineIndex::CountPoints(CMyList *objectList)
+{
+	long objectNum, numObjects = objectList -> GetItemCount (), numPts = 0;
+	ObjectRecHdl thisObjectHdl = nil;
+
+	for (objectNum = 0; objectNum < numObjects; objectNum++)
+	{
+		objectList -> GetListItem ((Ptr) &thisObjectHdl, objectNum);
+		if ((**thisObjectHdl).objectDataHdl != nil)
+			numPts += (**((PolyObjectHdl)thisObjectHdl)).pointCount;
+	}
+	return numPts;
+}
+
+OSErr ShorelineIndex::Build(CMyList *objectList, long dLong, long dLat, long segsPerBucket)
+{
+	long objectNum, numObjects, pointNum, pointCount, segNo, r, c;
+	long minCol, maxCol, minRow, maxRow;
+	double numBuckets, aspect;
+	ObjectRecHdl thisObjectHdl = nil;
+	LongPoint **rgnPtsHdl;
+	vector<long> fill;
+
+	Dispose();
+
+	if (!objectList)
+		return -1;
+
+	numObjects = objectList -> GetItemCount ();
+	fESICode.resize(numObjects);
+	for (objectNum = 0; objectNum < numObjects; objectNum++)
+	{
+		objectList -> GetListItem ((Ptr) &thisObjectHdl, objectNum);
+		fESICode[objectNum] = (**thisObjectHdl).objectESICode;
+		pointCount = (**((PolyObjectHdl)thisObjectHdl)).pointCount;
+		rgnPtsHdl = (LongPoint **) ((**thisObjectHdl).objectDataHdl);
+		if (rgnPtsHdl == nil) continue;
+		fNumPts += pointCount;
+
+		// the open polyline of the points, as CheckShoreline measures it
+		for (pointNum = 0; pointNum < pointCount - 1; pointNum++)
+		{
+			ShorelineSeg seg;
+			seg.object = objectNum;
+			seg.p1 = (*rgnPtsHdl)[pointNum];
+			seg.p2 = (*rgnPtsHdl)[pointNum + 1];
+			fSegs.push_back(seg);
+		}
+	}
+
+	fObjectList = objectList;
+	fNumObjects = numObjects;
+	fDLong = dLong;
+	fDLat = dLat;
+	if (fSegs.empty())
+		return 0;	// nothing is ever in range
+
+	fLeft = fRight = fSegs[0].p1.h;
+	fBottom = fTop = fSegs[0].p1.v;
+	for (segNo = 0; segNo < (long)fSegs.size(); segNo++) {
+		fLeft = _min(fLeft, _min(fSegs[segNo].p1.h, fSegs[segNo].p2.h));
+		fRight = _max(fRight, _max(fSegs[segNo].p1.h, fSegs[segNo].p2.h));
+		fBottom = _min(fBottom, _min(fSegs[segNo].p1.v, fSegs[segNo].p2.v));
+		fTop = _max(fTop, _max(fSegs[segNo].p1.v, fSegs[segNo].p2.v));
+	}
+	fLeft -= dLong;
+	fRight += dLong;
+	fBottom -= dLat;
+	fTop += dLat;
+
+	// about segsPerBucket segments per bucket, with roughly square buckets
+	if (segsPerBucket < 1) segsPerBucket = 1;
+	numBuckets = (double)fSegs.size() / segsPerBucket;
+	aspect = (fRight > fLeft && fTop > fBottom) ? (double)(fRight - fLeft) / (fTop - fBottom) : 1.;
+	fNumCols = (long)ceil(sqrt(numBuckets * aspect));
+	fNumCols = _max(1, fNumCols);
+	fNumRows = (long)ceil(numBuckets / fNumCols);
+	fNumRows = _max(1, fNumRows);
+	fBucketWidth = _max(1., (double)(fRight - fLeft) / fNumCols + 1e-9);
+	fBucketHeight = _max(1., (double)(fTop - fBottom) / fNumRows + 1e-9);
+
+	// count, then fill, each segment going in every bucket its widened box touches
+	fBucketStart.assign(fNumRows * fNumCols + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			for (c = 0; c < fNumRows * fNumCols; c++)
+				fBucketStart[c + 1] += fBucketStart[c];
+			fBucketSegs.resize(fBucketStart[fNumRows * fNumCols]);
+			fill.assign(fBucketStart.begin(), fBucketStart.end() - 1);
+		}
+		for (segNo = 0; segNo < (long)fSegs.size(); segNo++) {
+			LongPoint p1 = fSegs[segNo].p1;
+			LongPoint p2 = fSegs[segNo].p2;
+
+			GetBucket(_min(p1.h, p2.h) - dLong, _min(p1.v, p2.v) - dLat, &minCol, &minRow);
+			GetBucket(_max(p1.h, p2.h) + dLong, _max(p1.v, p2.v) + dLat, &maxCol, &maxRow);
+			for (r = minRow; r <= maxRow; r++) {
+				for (c = minCol; c <= maxCol; c++) {
+					if (pass == 0)
+						fBucketStart[r * fNumCols + c + 1]++;
+					else
+						fBucketSegs[fill[r * fNumCols + c]++] = segNo;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+OSErr ShorelineIndex::Prepare(CMyList *objectList, long dLong, long dLat)
+{
+	// rebuilt when the layer's objects are replaced, added, removed or reshaped
+	if (fObjectList && objectList == fObjectList && dLong == fDLong && dLat == fDLat &&
+		objectList -> GetItemCount () == fNumObjects && CountPoints(objectList) == fNumPts)
+		return 0;
+
+	return Build(objectList, dLong, dLat);
+}
+
+long ShorelineIndex::GetESICode(long longVal, long latVal)
+{
+	long col, row, b, i;
+	const ShorelineSeg *seg;
+	double dist, smallestDist = 100.;
+	long objectNum = -1;
+
+	if (fNumRows <= 0 || longVal < fLeft || longVal > fRight || latVal < fBottom || latVal > fTop)
+		return 0;
+
+	GetBucket(longVal, latVal, &col, &row);
+	b = row * fNumCols + col;
+
+	for (i = fBucketStart[b]; i < fBucketStart[b + 1]; i++) {
+		seg = &fSegs[fBucketSegs[i]];
+		dist = DistFromWPointToSegmentDouble(longVal, latVal, seg->p1.h, seg->p1.v, seg->p2.h, seg->p2.v, fDLong, fDLat);
+		if (dist==-1) continue;	// not within range
+
+		if (dist < smallestDist) {
+			smallestDist = dist;
+			objectNum = seg->object;
+		}
+	}
+
+	return objectNum >= 0 ? fESICode[objectNum] : 0;
+}
@@ -0,0 +1,62 @@
+/*
+ *  ShorelineIndex.h
+ *  gnome
+ *
+ *  Uniform grid of buckets over a map layer's polygons (the ESI shoreline),
+ *  each bucket lists the polygon segments whose bounding box, widened by
+ *  the search distance, touches it. Lets RefloatHalfLifeInHrs find the
+ *  shoreline a beached LE is on from the few segments near it instead of
+ *  every segment of every polygon of the layer.
+ *
+ */
+
+#ifndef __ShorelineIndex__
+#define __ShorelineIndex__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ObjectUtils.h"
+
+class ShorelineIndex
+{
+	public:
+						ShorelineIndex();
+						~ShorelineIndex() {Dispose();}
+		void			Dispose();
+
+		// the objects aren't copied, the list must outlive the index
+		OSErr			Build(CMyList *objectList, long dLong, long dLat, long segsPerBucket = 2);
+
+		// builds the index unless it is already built for this list, its objects and distances
+		OSErr			Prepare(CMyList *objectList, long dLong, long dLat);
+
+		// the ESI code of the object with the closest segment within dLong, dLat of
+		// the point, 0 if none, like CheckShoreline's loop over all of them
+		long			GetESICode(long longVal, long latVal);
+
+		long			GetNumBuckets() {return fNumRows * fNumCols;}
+
+	private:
+		typedef struct {
+			long		object;
+			LongPoint	p1, p2;
+		} ShorelineSeg;
+
+		CMyList						*fObjectList;
+		long						fNumObjects, fNumPts;
+		long						fDLong, fDLat;
+		long						fLeft, fBottom, fRight, fTop;
+		double						fBucketWidth, fBucketHeight;
+		long						fNumRows, fNumCols;
+		std::vector<long>			fESICode;		// of object objectNum
+		std::vector<ShorelineSeg>	fSegs;			// in the order of the objects and their points
+		std::vector<long>			fBucketStart;	// bucket b's segments are fBucketSegs[fBucketStart[b], fBucketStart[b+1]), in fSegs order
+		std::vector<long>			fBucketSegs;
+
+		void			GetBucket(long h, long v, long *col, long *row);
+		long			CountPoints(CMyList *objectList);
+};
+
+#endif
@@ -11,6 +11,8 @@
 #include "TypeDefs.h"
 #include "MemUtils.h"
 #include "StringFunctions.h"
+#include "TextLines.h"
+#include "GnomeThreads.h"
 #include <iostream>
 #include <time.h>
 
@@ -1129,8 +1131,10 @@ CHARPTR NthLineInTextHelper(CHARPTR text, long n, CHARPTR line, Boolean optimize
 	bool lineFeed = false;
 	char *s, *q;
 	long count = 1, i = 0;
-	static long linesRead;
-	static CHARPTR t, p;
+	// where the last optimized call left off, per thread: movers read their
+	// files on the prefetch threads too
+	static GNOME_THREAD_LOCAL long linesRead;
+	static GNOME_THREAD_LOCAL CHARPTR t, p;
 	long numCharCopied = 0;
 	long lineLengthInFile = 0;
 
@@ -1940,6 +1944,7 @@ void SecondsToDate (Seconds seconds, DateTimeRec *date)
 				newTime->tm_hour--;
 			else {
 				seconds -= 3600;
+				converted_seconds = (time_t)seconds;	// the hour before, on the day before
 				newTime = localtime(&converted_seconds);
 
 				if (newTime->tm_isdst == 1) {
@@ -1997,6 +2002,57 @@ void DateToSeconds (DateTimeRec *date, Seconds *seconds)
 	
 	(*seconds) = secs;
 }
+
+
+// DateToSeconds of each date. mktime is called once for each run of dates
+// on the same day, the times of the day only add their seconds
+void DatesToSeconds(const DateTimeRec *dates, long n, Seconds *seconds)
+{
+	DateTimeRec day;
+	Seconds daySeconds = 0;
+	bool haveDay = false;
+
+	for (long i = 0; i < n; i++) {
+		if (!haveDay || dates[i].year != day.year || dates[i].month != day.month || dates[i].day != day.day) {
+			day = dates[i];
+			day.hour = day.minute = day.second = 0;
+			DateToSeconds(&day, &daySeconds);
+			haveDay = true;
+		}
+		seconds[i] = daySeconds + dates[i].hour * 3600 + dates[i].minute * 60 + dates[i].second;
+	}
+}
+
+
+// SecondsToDate of each time. The UTC offsets, and the daylight savings
+// changes, are on quarter hours, so localtime is called once for each run of
+// times in the same quarter hour and the others count on from its start.
+// Where the start has seconds (local mean times of long ago) each is converted
+void SecondsToDates(const Seconds *seconds, long n, DateTimeRec *dates)
+{
+	const Seconds kQuarterHour = 900;
+	DateTimeRec start;
+	Seconds startSeconds = 0, offset;
+	bool haveStart = false, countOn = false;
+
+	for (long i = 0; i < n; i++) {
+		if (!haveStart || seconds[i] < startSeconds || seconds[i] - startSeconds >= kQuarterHour) {
+			startSeconds = seconds[i] - ((seconds[i] % kQuarterHour) + kQuarterHour) % kQuarterHour;
+			SecondsToDate(startSeconds, &start);
+			haveStart = true;
+			countOn = start.year != 0 && start.second == 0 && start.minute % 15 == 0;
+		}
+
+		if (countOn) {
+			offset = seconds[i] - startSeconds;
+			dates[i] = start;
+			dates[i].minute += (short)(offset / 60);
+			dates[i].second = (short)(offset % 60);
+		}
+		else
+			SecondsToDate(seconds[i], &dates[i]);
+	}
+}
 #endif
 
 // Path functions - eventually replace with a library
@@ -2278,6 +2334,69 @@ bool ReadLinesInFile(const string &name, vector<string> &stringList, size_t line
 	return ReadLinesInFile(name.c_str(), stringList, linesToRead);
 }
 
+// Opens the file in the lines, which are split like the ones above but are
+// read in place rather than copied to strings.
+// Returns: true if we were successful, otherwise returns false
+bool ReadLinesInFile(const char *name, TextLines &lines)
+{
+	if (!lines.Open(name)) {
+#ifdef pyGNOME
+		printError("We are unable to open or read from the file. \nBreaking from ReadLinesInFile().\n");
+#else
+#ifdef MAC
+		printNote("We are unable to open or read from the file. Check file name length is < 32 characters.");
+#else
+		printError("We are unable to open or read from the file. \nBreaking from ReadLinesInFile().\n");
+#endif
+#endif
+		return false;
+	}
+	return true;
+}
+
+bool ReadLinesInFile(const string &name, TextLines &lines)
+{
+	return ReadLinesInFile(name.c_str(), lines);
+}
+
+// Reads the lines of the file up to and including the first line key is
+// in, or all of them when it isn't, split as ReadLinesInFile splits them.
+// The file is mapped, so the rest of it is never read - the header of a
+// large data file is read without the data.
+// Returns: true if we were successful, otherwise returns false
+bool ReadLinesInFileUpTo(const string &name, const char *key, vector<string> &stringList)
+{
+	MappedText text;
+	size_t keyLength = strlen(key), length;
+	const char *start, *end, *found;
+
+	if (!text.Open(name.c_str())) {
+		printError("We are unable to open or read from the file. \nBreaking from ReadLinesInFileUpTo().\n");
+		return false;
+	}
+
+	start = text.text();
+	end = start + text.size();
+	length = text.size();
+	for (found = start; (found = (const char *)memchr(found, key[0], end - found)) != 0; found++) {
+		if ((size_t)(end - found) >= keyLength && memcmp(found, key, keyLength) == 0) {
+			while (found < end && *found != '\n' && *found != '\r')
+				found++;
+			length = found - start;
+			break;
+		}
+	}
+
+	TextLines lines(start, length);
+
+	stringList.clear();
+	stringList.reserve(lines.size());
+	for (long i = 0; i < lines.size(); i++)
+		stringList.push_back(lines[i]);
+
+	return true;
+}
+
 // Reads the lines contained in a text buffer in as safely a manner
 // as we can.
 // Returns: true if we were successful, otherwise returns false
@@ -24,6 +24,8 @@ using namespace std;
 #include "DagTree.h"
 #include "ExportSymbols.h"
 
+class TextLines;
+
 char* lfFix(char* str);
 OSErr StringToDouble(char* str,double* val);
 void StringWithoutTrailingZeros(char* str,double val,short maxNumDecimalPlaces); //JLM
@@ -151,6 +153,9 @@ Seconds RoundDateSeconds(Seconds timeInSeconds);
 void DLL_API DateToSeconds(DateTimeRec *date, Seconds *seconds);
 void GetDateTime(Seconds *seconds);
 void DLL_API SecondsToDate(Seconds seconds, DateTimeRec *date);
+// the same for arrays of n, in one call
+void DLL_API DatesToSeconds(const DateTimeRec *dates, long n, Seconds *seconds);
+void DLL_API SecondsToDates(const Seconds *seconds, long n, DateTimeRec *dates);
 #endif
 
 Boolean IsWindowsPath(char* path);
@@ -165,7 +170,10 @@ Boolean ConvertIfClassicPath(char* path, char* unixPath);
 std::ios::pos_type FileSize(std::fstream &file);
 std::istream& safeGetLine(std::istream& is, std::string& t);
 bool ReadLinesInFile(const string &name, vector<std::string> &stringList, size_t linesToRead = 0);
+bool ReadLinesInFile(const string &name, TextLines &lines);
+bool ReadLinesInFile(const char *name, TextLines &lines);
 bool ReadLinesInFile(const char *name, std::vector<string> &stringList, size_t linesToRead = 0);
+bool ReadLinesInFileUpTo(const string &name, const char *key, std::vector<string> &stringList);
 bool ReadLinesInBuffer(CHARH fileBufH, vector<string> &stringList, size_t linesToRead = 0);
 void ConvertDriveLetterToUnixStyle(string &pathPart);
 void SplitPathIntoDirAndFile(string &path, string &dir, string &file);
@@ -0,0 +1,585 @@
+/*
+ *  TextLines.cpp
+ *  gnome
+ *
+ *  The lines of a text file, read in place.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cfloat>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "TextLines.h"
+
+using namespace std;
+
+TextLines::TextLines()
+{
+	fStrings = 0;
+	fText = 0;
+	fLength = 0;
+	fNumLines = 0;
+	fMap = 0;
+	fMapLength = 0;
+}
+
+TextLines::TextLines(const vector<string> &lines)
+{
+	fStrings = &lines;
+	fText = 0;
+	fLength = 0;
+	fNumLines = lines.size();
+	fMap = 0;
+	fMapLength = 0;
+}
+
+TextLines::TextLines(const char *text, size_t length)
+{
+	fStrings = 0;
+	fText = text;
+	fLength = length;
+	fNumLines = 0;
+	fMap = 0;
+	fMapLength = 0;
+
+	IndexLines();
+}
+
+TextLines::~TextLines()
+{
+	Close();
+}
+
+bool TextLines::Open(const char *path)
+{
+	Close();
+
+#ifndef _WIN32
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		void *map = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, info.st_size, MADV_SEQUENTIAL);
+
+			fMap = map;
+			fMapLength = info.st_size;
+			fText = (const char *)map;
+			fLength = fMapLength;
+		}
+	}
+	close(fd);
+#endif
+
+	if (!fMap) {
+		// read it in one piece - pipes, empty files and systems without mmap
+		FILE *f = fopen(path, "rb");
+		char chunk[65536];
+		size_t n;
+
+		if (!f)
+			return false;
+
+		while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+			fBuffer.insert(fBuffer.end(), chunk, chunk + n);
+
+		bool failed = ferror(f) != 0;
+		fclose(f);
+		if (failed) {
+			fBuffer.clear();
+			return false;
+		}
+
+		fText = fBuffer.empty() ? "" : &fBuffer[0];
+		fLength = fBuffer.size();
+	}
+
+	IndexLines();
+	return true;
+}
+
+void TextLines::SetText(const char *text, size_t length)
+{
+	Close();
+
+	fText = text;
+	fLength = length;
+
+	IndexLines();
+}
+
+void TextLines::Close()
+{
+#ifndef _WIN32
+	if (fMap)
+		munmap(fMap, fMapLength);
+#endif
+	fMap = 0;
+	fMapLength = 0;
+	vector<char>().swap(fBuffer);
+	vector<size_t>().swap(fLineStarts);
+
+	fStrings = 0;
+	fText = 0;
+	fLength = 0;
+	fNumLines = 0;
+}
+
+// Lines end at \n, \r\n or \r. Like ReadLinesInFile there is always an
+// empty line after the last, and a last line without a break is kept
+void TextLines::IndexLines()
+{
+	size_t i = 0;
+
+	fLineStarts.clear();
+	fLineStarts.reserve(fLength / 32 + 2);
+	fLineStarts.push_back(0);
+
+	while (i < fLength) {
+		char c = fText[i++];
+
+		if (c == '\n')
+			fLineStarts.push_back(i);
+		else if (c == '\r') {
+			if (i < fLength && fText[i] == '\n')
+				i++;
+			fLineStarts.push_back(i);
+		}
+	}
+
+	if (fLineStarts.back() < fLength)
+		fLineStarts.push_back(fLength);
+
+	fNumLines = fLineStarts.size();
+}
+
+long TextLines::size() const
+{
+	return fNumLines;
+}
+
+TextLine TextLines::operator[](long i) const
+{
+	if (i < 0 || i >= fNumLines)
+		return TextLine();
+
+	if (fStrings) {
+		const string &s = (*fStrings)[i];
+		return TextLine(s.c_str(), s.c_str() + s.size());
+	}
+
+	const char *begin = fText + fLineStarts[i];
+	const char *stop = fText + fLength;
+	const char *end = begin;
+
+	while (end < stop && *end != '\n' && *end != '\r')
+		end++;
+
+	return TextLine(begin, end);
+}
+
+
+MappedText::MappedText()
+{
+	fText = "";
+	fLength = 0;
+	fMap = 0;
+	fMapLength = 0;
+}
+
+MappedText::~MappedText()
+{
+	Close();
+}
+
+bool MappedText::Open(const char *path, size_t offset, size_t length)
+{
+	Close();
+
+#ifndef _WIN32
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && offset < (size_t)info.st_size) {
+		// the mapping starts at the page the range is in
+		size_t page = sysconf(_SC_PAGESIZE);
+		size_t start = offset - offset % page;
+
+		if (length == 0 || length > info.st_size - offset)
+			length = info.st_size - offset;
+
+		void *map = mmap(0, offset - start + length, PROT_READ, MAP_PRIVATE, fd, start);
+		if (map != MAP_FAILED) {
+			madvise(map, offset - start + length, MADV_SEQUENTIAL);
+
+			fMap = map;
+			fMapLength = offset - start + length;
+			fText = (const char *)map + (offset - start);
+			fLength = length;
+		}
+	}
+	close(fd);
+#endif
+
+	if (!fMap) {
+		FILE *f = fopen(path, "rb");
+		char chunk[65536];
+		size_t n;
+
+		if (!f)
+			return false;
+
+		if (fseek(f, offset, SEEK_SET) != 0) {
+			fclose(f);
+			return false;
+		}
+
+		while (length == 0 || fBuffer.size() < length) {
+			n = sizeof(chunk);
+			if (length != 0 && length - fBuffer.size() < n)
+				n = length - fBuffer.size();
+
+			if ((n = fread(chunk, 1, n, f)) == 0)
+				break;
+			fBuffer.insert(fBuffer.end(), chunk, chunk + n);
+		}
+
+		bool failed = ferror(f) != 0;
+		fclose(f);
+		if (failed) {
+			fBuffer.clear();
+			return false;
+		}
+
+		fText = fBuffer.empty() ? "" : &fBuffer[0];
+		fLength = fBuffer.size();
+	}
+
+	return true;
+}
+
+void MappedText::Close()
+{
+#ifndef _WIN32
+	if (fMap)
+		munmap(fMap, fMapLength);
+#endif
+	fMap = 0;
+	fMapLength = 0;
+	vector<char>().swap(fBuffer);
+
+	fText = "";
+	fLength = 0;
+}
+
+
+// The scanners read what operator>> reads in the "C" locale: white space,
+// then the longest number it would take, failing where it fails
+
+static inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static bool ScanNumber(const char *&p, const char *end, long &value)
+{
+	bool negative = false;
+	unsigned long v = 0, limit;
+
+	while (p < end && IsSpace(*p))
+		p++;
+
+	if (p < end && (*p == '+' || *p == '-')) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	if (p == end || !IsDigit(*p))
+		return false;
+
+	limit = negative ? (unsigned long)LONG_MAX + 1 : (unsigned long)LONG_MAX;
+	for (; p < end && IsDigit(*p); p++) {
+		unsigned long digit = *p - '0';
+
+		if (v > (limit - digit) / 10)
+			return false;
+		v = v * 10 + digit;
+	}
+
+	if (negative)
+		value = (v == (unsigned long)LONG_MAX + 1) ? LONG_MIN : -(long)v;
+	else
+		value = (long)v;
+
+	return true;
+}
+
+static inline double ConvertNumber(const char *s, char **stop, double)
+{
+	return strtod(s, stop);
+}
+
+static inline float ConvertNumber(const char *s, char **stop, float)
+{
+	return strtof(s, stop);
+}
+
+// the length of the number operator>> would take at p: a sign, digits, a
+// decimal point and digits, and an exponent once there are mantissa digits
+static size_t NumberToken(const char *p, const char *end)
+{
+	const char *q = p;
+	bool mantissa = false;
+
+	if (q < end && (*q == '+' || *q == '-'))
+		q++;
+	for (; q < end && IsDigit(*q); q++)
+		mantissa = true;
+	if (q < end && *q == '.') {
+		for (q++; q < end && IsDigit(*q); q++)
+			mantissa = true;
+	}
+	if (mantissa && q < end && (*q == 'e' || *q == 'E')) {
+		q++;
+		if (q < end && (*q == '+' || *q == '-'))
+			q++;
+		while (q < end && IsDigit(*q))
+			q++;
+	}
+
+	return q - p;
+}
+
+// the token is converted with strtod (or strtof), which is what operator>>
+// converts it with. Returns 1 for a number, -1 for one out of range (value
+// is then +-HUGE_VAL) and 0 where the token isn't all number
+template <class T>
+static int ConvertToken(const char *first, size_t length, T &value)
+{
+	char small[64], *stop;
+	string large;
+	const char *token;
+	T v;
+
+	if (length < sizeof(small)) {
+		memcpy(small, first, length);
+		small[length] = 0;
+		token = small;
+	}
+	else {
+		large.assign(first, length);
+		token = large.c_str();
+	}
+
+	errno = 0;
+	v = ConvertNumber(token, &stop, T());
+	if (stop != token + length)
+		return 0;
+
+	value = v;
+	if (errno == ERANGE && (v == (T)HUGE_VAL || v == -(T)HUGE_VAL))
+		return -1;
+	return 1;
+}
+
+template <class T>
+static bool ScanNumber(const char *&p, const char *end, T &value)
+{
+	size_t length;
+	T v;
+
+	while (p < end && IsSpace(*p))
+		p++;
+
+	length = NumberToken(p, end);
+	if (length == 0 || ConvertToken(p, length, v) != 1)
+		return false;
+
+	value = v;
+	p += length;
+	return true;
+}
+
+
+bool ScanValue(const char *&p, const char *end, short &value)
+{
+	const char *q = p;
+	long v;
+
+	if (!ScanNumber(q, end, v) || v < SHRT_MIN || v > SHRT_MAX)
+		return false;
+
+	value = (short)v;
+	p = q;
+	return true;
+}
+
+bool ScanValue(const char *&p, const char *end, long &value)
+{
+	const char *q = p;
+
+	if (!ScanNumber(q, end, value))
+		return false;
+
+	p = q;
+	return true;
+}
+
+bool ScanValue(const char *&p, const char *end, double &value)
+{
+	const char *q = p;
+
+	if (!ScanNumber(q, end, value))
+		return false;
+
+	p = q;
+	return true;
+}
+
+bool ScanWord(const char *&p, const char *end, TextLine &word)
+{
+	while (p < end && IsSpace(*p))
+		p++;
+	if (p == end)
+		return false;
+
+	word.begin = p;
+	while (p < end && !IsSpace(*p))
+		p++;
+	word.end = p;
+	return true;
+}
+
+// C++11 operator>> sets 0 when it reads no number and the largest value
+// when the number is out of range
+double StreamValue(const TextLine &text)
+{
+	const char *p = text.begin;
+	size_t length;
+	double v = 0;
+
+	while (p < text.end && IsSpace(*p))
+		p++;
+
+	length = NumberToken(p, text.end);
+	if (length == 0)
+		return 0;
+
+	switch (ConvertToken(p, length, v)) {
+		case 1:
+			return v;
+		case -1:
+			return v > 0 ? DBL_MAX : -DBL_MAX;
+		default:
+			return 0;
+	}
+}
+
+bool ParseLine(const TextLine &lineIn, long &out1)
+{
+	const char *p = lineIn.begin;
+	long v1;
+
+	if (!ScanNumber(p, lineIn.end, v1))
+		return false;
+
+	out1 = v1;
+	return true;
+}
+
+bool ParseLine(const TextLine &lineIn, double &out1, double &out2)
+{
+	const char *p = lineIn.begin;
+	double v1, v2;
+
+	if (!ScanNumber(p, lineIn.end, v1) || !ScanNumber(p, lineIn.end, v2))
+		return false;
+
+	out1 = v1;
+	out2 = v2;
+	return true;
+}
+
+bool ParseLine(const TextLine &lineIn, double &out1, double &out2, double &out3)
+{
+	const char *p = lineIn.begin;
+	double v1, v2, v3;
+
+	if (!ScanNumber(p, lineIn.end, v1) || !ScanNumber(p, lineIn.end, v2) ||
+		!ScanNumber(p, lineIn.end, v3))
+		return false;
+
+	out1 = v1;
+	out2 = v2;
+	out3 = v3;
+	return true;
+}
+
+bool ParseLine(const TextLine &lineIn, DAG &out1)
+{
+	const char *p = lineIn.begin;
+	DAG v1;
+
+	if (!ScanNumber(p, lineIn.end, v1.topoIndex) || !ScanNumber(p, lineIn.end, v1.branchLeft) ||
+		!ScanNumber(p, lineIn.end, v1.branchRight))
+		return false;
+
+	out1 = v1;
+	return true;
+}
+
+static bool ScanTopology(const char *&p, const char *end, Topology &v1)
+{
+	return ScanNumber(p, end, v1.vertex1) && ScanNumber(p, end, v1.vertex2) &&
+		ScanNumber(p, end, v1.vertex3) && ScanNumber(p, end, v1.adjTri1) &&
+		ScanNumber(p, end, v1.adjTri2) && ScanNumber(p, end, v1.adjTri3);
+}
+
+bool ParseLine(const TextLine &lineIn, Topology &out1)
+{
+	const char *p = lineIn.begin;
+	Topology v1;
+
+	if (!ScanTopology(p, lineIn.end, v1))
+		return false;
+
+	out1 = v1;
+	return true;
+}
+
+bool ParseLine(const TextLine &lineIn, Topology &out1, VelocityFRec &out2)
+{
+	const char *p = lineIn.begin;
+	Topology v1;
+	VelocityFRec v2;
+
+	if (!ScanTopology(p, lineIn.end, v1) || !ScanNumber(p, lineIn.end, v2.u) ||
+		!ScanNumber(p, lineIn.end, v2.v))
+		return false;
+
+	out1 = v1;
+	out2 = v2;
+	return true;
+}
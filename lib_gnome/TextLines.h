@@ -0,0 +1,122 @@
+/*
+ *  TextLines.h
+ *  gnome
+ *
+ *  The lines of a text file, read in place.
+ *  The file is mapped (or read into one buffer where it can't be) and only
+ *  the line starts are kept, instead of a std::string per line, so reading
+ *  a large topology or CATS file doesn't hold the text twice. The lines
+ *  are split the way ReadLinesInFile splits them.
+ *
+ */
+
+#ifndef __TextLines__
+#define __TextLines__
+
+#include <vector>
+#include <string>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+#include "ExportSymbols.h"
+
+// a line of a TextLines, without the line break. It points into the
+// TextLines' text, so it is only good while that is
+class DLL_API TextLine {
+
+public:
+	const char *begin;
+	const char *end;
+
+	TextLine() : begin(""), end(begin) {}
+	TextLine(const char *b, const char *e) : begin(b), end(e) {}
+
+	size_t size() const { return end - begin; }
+	operator std::string() const { return std::string(begin, end); }
+};
+
+class DLL_API TextLines {
+
+public:
+	TextLines();
+	TextLines(const std::vector<std::string> &lines);	// the lines of a ReadLinesInFile
+	TextLines(const char *text, size_t length);			// a text buffer, which must outlive this
+	~TextLines();
+
+	bool Open(const char *path);
+	void SetText(const char *text, size_t length);	// as the constructor of a text buffer
+	void Close();
+
+	long size() const;
+	TextLine operator[](long i) const;	// an empty line past the end
+
+protected:
+	const std::vector<std::string> *fStrings;
+	const char *fText;
+	size_t fLength;
+	std::vector<size_t> fLineStarts;
+	long fNumLines;
+
+	void *fMap;
+	size_t fMapLength;
+	std::vector<char> fBuffer;	// the file, when it can't be mapped
+
+	void IndexLines();
+
+private:
+	TextLines(const TextLines &);
+	TextLines &operator=(const TextLines &);
+};
+
+// a range of a text file, read in place: mapped, or read into a buffer
+// where it can't be. The range is only touched as it is read, so a table
+// of a few MB is parsed out of a file of GBs without reading the rest
+class DLL_API MappedText {
+
+public:
+	MappedText();
+	~MappedText();
+
+	// length bytes from offset, to the end of the file when length is 0.
+	// A range past the end is cut at the end
+	bool Open(const char *path, size_t offset = 0, size_t length = 0);
+	void Close();
+
+	const char *text() const { return fText; }
+	size_t size() const { return fLength; }
+
+protected:
+	const char *fText;
+	size_t fLength;
+
+	void *fMap;
+	size_t fMapLength;
+	std::vector<char> fBuffer;
+
+private:
+	MappedText(const MappedText &);
+	MappedText &operator=(const MappedText &);
+};
+
+// operator>> in the "C" locale at p, which is moved past what was read.
+// On failure p is left where it was
+bool ScanValue(const char *&p, const char *end, short &value);
+bool ScanValue(const char *&p, const char *end, long &value);
+bool ScanValue(const char *&p, const char *end, double &value);
+// the next white space delimited word, as operator>> of a string reads it
+bool ScanWord(const char *&p, const char *end, TextLine &word);
+// what operator>> of a double reads from a stream of the text alone
+double StreamValue(const TextLine &text);
+
+// ParseLine for the records of the topology and CATS files, reading the
+// numbers in place. They take what ParseLine(std::string ...) takes and
+// give the same values
+bool ParseLine(const TextLine &lineIn, long &out1);
+bool ParseLine(const TextLine &lineIn, double &out1, double &out2);
+bool ParseLine(const TextLine &lineIn, double &out1, double &out2, double &out3);
+bool ParseLine(const TextLine &lineIn, DAG &out1);
+bool ParseLine(const TextLine &lineIn, Topology &out1);
+bool ParseLine(const TextLine &lineIn, Topology &out1, VelocityFRec &out2);
+
+#endif
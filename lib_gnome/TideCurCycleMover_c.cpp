@@ -12,6 +12,7 @@
 #include "my_build_list.h"
 #include "CompFunctions.h"
 #include "StringFunctions.h"
+#include "TimeInterval.h"
 #include "netcdf.h"
 
 #ifndef pyGNOME
@@ -26,6 +27,7 @@
 TideCurCycleMover_c::TideCurCycleMover_c (TMap *owner, char *name) : CATSMover_c(owner, name)
 {
 	fTimeHdl = 0;
+	fTimeIntervalCursor = 0;
 	
 	fUserUnits = kUndefined;
 	
@@ -53,6 +55,8 @@ TideCurCycleMover_c::TideCurCycleMover_c (TMap *owner, char *name) : CATSMover_c
 	//fPatternStartPoint = 2;	// some default
 	fPatternStartPoint = MaxFlood;	// this should be user input
 	fTimeAlpha = -1;
+	bStepTimeScaleSet = false;
+	fStepTimeScaleTime = 0;
 	
 	fFillValue = -1e+34;
 	fDryValue = -1e+34;
@@ -64,6 +68,7 @@ TideCurCycleMover_c::TideCurCycleMover_c (TMap *owner, char *name) : CATSMover_c
 TideCurCycleMover_c::TideCurCycleMover_c () : CATSMover_c()
 {
 	fTimeHdl = 0;
+	fTimeIntervalCursor = 0;
 	
 	fUserUnits = kUndefined;
 	
@@ -91,6 +96,8 @@ TideCurCycleMover_c::TideCurCycleMover_c () : CATSMover_c()
 	//fPatternStartPoint = 2;	// some default
 	fPatternStartPoint = MaxFlood;	// this should be user input
 	fTimeAlpha = -1;
+	bStepTimeScaleSet = false;
+	fStepTimeScaleTime = 0;
 	
 	fFillValue = -1e+34;
 	fDryValue = -1e+34;
@@ -111,6 +118,7 @@ void TideCurCycleMover_c::Dispose ()
 	if(fTimeHdl) {DisposeHandle((Handle)fTimeHdl); fTimeHdl=0;}
 	if(fStartData.dataHdl)DisposeLoadedData(&fStartData); 
 	if(fEndData.dataHdl)DisposeLoadedData(&fEndData);
+	DisposeCycleFrames();
 	
 	if(fVerdatToNetCDFH) {DisposeHandle((Handle)fVerdatToNetCDFH); fVerdatToNetCDFH=0;}
 	if(fVertexPtsH) {DisposeHandle((Handle)fVertexPtsH); fVertexPtsH=0;}
@@ -263,7 +271,7 @@ OSErr TideCurCycleMover_c::ComputeVelocityScale(const Seconds& model_time)
 	return -1;*/
 }
 
-OSErr TideCurCycleMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr TideCurCycleMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -313,7 +321,7 @@ OSErr TideCurCycleMover_c::PrepareForModelRun()
 	fOptimize.isFirstStep = true;
 	return CurrentMover_c::PrepareForModelRun();
 }
-OSErr TideCurCycleMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr TideCurCycleMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	long timeDataInterval;
 	OSErr err=0;
@@ -336,6 +344,11 @@ OSErr TideCurCycleMover_c::PrepareForModelStep(const Seconds& model_time, const
 	
 	if(err) goto done;
 	
+	bStepTimeScaleSet = false;
+	fStepTimeScale = GetTimeScale(model_time);
+	fStepTimeScaleTime = model_time;
+	bStepTimeScaleSet = true;
+	
 	if (uncertain)
 	{
 		Seconds elapsed_time = model_time - fModelStartTime;	// code goes here, how to set start time
@@ -360,6 +373,7 @@ void TideCurCycleMover_c::ModelStepIsDone()
 {
 	fOptimize.isFirstStep = false;
 	fOptimize.isOptimizedForStep = false;
+	bStepTimeScaleSet = false;
 	bIsFirstStep = false;
 }
 
@@ -520,7 +534,7 @@ double TideCurCycleMover_c::GetEndVVelocity(long index)
 }
 
 
-WorldPoint3D TideCurCycleMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D TideCurCycleMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	// see PtCurMover::GetMove - will depend on what is in netcdf files and how it's stored
 	WorldPoint3D	deltaPoint = {0,0,0.};
@@ -532,7 +546,8 @@ WorldPoint3D TideCurCycleMover_c::GetMove(const Seconds& model_time, Seconds tim
 	Seconds startTime,endTime;
 	Seconds time = model_time;
 	InterpolationVal interpolationVal;
-	VelocityRec scaledPatVelocity, timeValue = {1, 1};
+	VelocityRec scaledPatVelocity;
+	double timeScale = 1.;
 	Boolean useEddyUncertainty = false, isDry = false;	
 	OSErr err = 0;
 	char errmsg[256];
@@ -639,20 +654,13 @@ WorldPoint3D TideCurCycleMover_c::GetMove(const Seconds& model_time, Seconds tim
 scale:
 	
 	// get and apply our time file scale factor
-	if (timeDep && bTimeFileActive)
-	{
-		// VelocityRec errVelocity={1,1};
-		// JLM 11/22/99, if there are no time file values, use zero not 1
-		VelocityRec errVelocity={0,1};
-		//err = timeDep -> GetTimeValue (model -> GetModelTime(), &timeValue);	// AH 07/10/2012
-		err = timeDep -> GetTimeValue (model_time, &timeValue);	// AH 07/10/2012
-		//err = timeDep -> GetTimeValue (start_time, stop_time, model_time, &timeValue);	// AH 07/10/2012
-		
-		if(err) timeValue = errVelocity;
-	}
+	if (bStepTimeScaleSet && model_time == fStepTimeScaleTime)
+		timeScale = fStepTimeScale;
+	else
+		timeScale = GetTimeScale(model_time);
 	
-	scaledPatVelocity.u *= myfabs(timeValue.u); // magnitude contained in u field only
-	scaledPatVelocity.v *= myfabs(timeValue.u); 	// multiplying tide by tide, don't want to change phase
+	scaledPatVelocity.u *= myfabs(timeScale); // magnitude contained in u field only
+	scaledPatVelocity.v *= myfabs(timeScale); 	// multiplying tide by tide, don't want to change phase
 	//scaledPatVelocity.u = timeValue.u; // magnitude contained in u field only
 	//scaledPatVelocity.v = timeValue.v; 	// multiplying tide by tide, don't want to change phase
 	
@@ -1182,7 +1190,7 @@ Boolean TideCurCycleMover_c::CheckInterval(long &timeDataInterval, const Seconds
 {
 	Seconds time =  model_time; // AH 07/17/2012
 	
-	long i,numTimes;
+	long numTimes;
 	
 	
 	numTimes = this -> GetNumTimesInFile(); 
@@ -1230,14 +1238,9 @@ Boolean TideCurCycleMover_c::CheckInterval(long &timeDataInterval, const Seconds
 				}
 			}
 			
-			for (i=0;i<numTimes;i++) 
-			{	// find the time interval
-				if (time>=(*fTimeHdl)[i] && time<=(*fTimeHdl)[i+1])
-				{
-					timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-					return false;
-				}
-			}	
+			// find the time interval, the first is between 0 and 1, and so on
+			if (FindTimeInterval(ShiftedTimes(fTimeHdl, 0), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+				return false;
 			// don't allow time before first or after last
 			if (time<(*fTimeHdl)[0]) 
 				timeDataInterval = 0;
@@ -1282,10 +1285,53 @@ Boolean TideCurCycleMover_c::CheckInterval(long &timeDataInterval, const Seconds
 
 void TideCurCycleMover_c::DisposeLoadedData(LoadedData *dataPtr)
 {
-	if(dataPtr -> dataHdl) DisposeHandle((Handle) dataPtr -> dataHdl);
+	if(dataPtr -> dataHdl && !IsCycleFrame(dataPtr -> dataHdl)) DisposeHandle((Handle) dataPtr -> dataHdl);
 	ClearLoadedData(dataPtr);
 }
 
+Boolean TideCurCycleMover_c::IsCycleFrame(VelocityFH h)
+{
+	for (size_t i = 0; i < fCycleFrames.size(); i++)
+		if (fCycleFrames[i] == h)
+			return true;
+	return false;
+}
+
+void TideCurCycleMover_c::DisposeCycleFrames()
+{
+	for (size_t i = 0; i < fCycleFrames.size(); i++)
+	{
+		if (!fCycleFrames[i])
+			continue;
+		if (fStartData.dataHdl == fCycleFrames[i]) ClearLoadedData(&fStartData);
+		if (fEndData.dataHdl == fCycleFrames[i]) ClearLoadedData(&fEndData);
+		DisposeHandle((Handle)fCycleFrames[i]);
+	}
+	fCycleFrames.clear();
+}
+
+// the run goes around the same patterns, so each is read only the first time
+OSErr TideCurCycleMover_c::LoadTimeData(long index, LoadedData *data, char *errmsg)
+{
+	OSErr err = 0;
+	long numTimes = GetNumTimesInFile();
+
+	if (fCycleFrames.size() != (size_t)numTimes)
+	{
+		DisposeCycleFrames();
+		fCycleFrames.resize(numTimes, 0);
+	}
+	if (!fCycleFrames[index])
+	{
+		err = this -> ReadTimeData(index,&fCycleFrames[index],errmsg);
+		if(err) return err;
+	}
+	data -> dataHdl = fCycleFrames[index];
+	data -> timeIndex = index;
+
+	return noErr;
+}
+
 void TideCurCycleMover_c::ClearLoadedData(LoadedData *dataPtr)
 {
 	dataPtr -> dataHdl = 0;
@@ -1360,16 +1406,14 @@ OSErr TideCurCycleMover_c::SetInterval(char *errmsg, const Seconds& model_time)
 		
 		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
 		{ // start data is not loaded
-			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfStart,&fStartData,errmsg);
 			if(err) goto done;
-			fStartData.timeIndex = indexOfStart;
 		}	
 		
 		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
 		{
-			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfEnd,&fEndData,errmsg);
 			if(err) goto done;
-			fEndData.timeIndex = indexOfEnd;
 		}
 	}
 	
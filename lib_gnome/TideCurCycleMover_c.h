@@ -28,6 +28,7 @@ public:
 	//long fNumCols;
 	//PtCurTimeDataHdl fTimeDataHdl;
 	Seconds **fTimeHdl;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	LoadedData fStartData; 
 	LoadedData fEndData;
 	float fFillValue;
@@ -40,6 +41,10 @@ public:
 	long fNumNodes;
 	short fPatternStartPoint;	// maxflood, maxebb, etc
 	float fTimeAlpha;
+	std::vector<VelocityFH> fCycleFrames;	// the patterns, read once and kept, the loaded data points at two of them
+	double fStepTimeScale;		// the time file scale of the prepared step, the same for every LE
+	Seconds fStepTimeScaleTime;
+	Boolean bStepTimeScaleSet;
 	char fTopFilePath[kMaxNameLen];
 	//Seconds model_start_time;	// for the diagnostic case - no time file look at the patterns in the file that have no absolute time associated with them
 	
@@ -50,7 +55,7 @@ public:
 	~TideCurCycleMover_c () { Dispose (); }
 	virtual void		Dispose ();
 
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	
 	LongPointHdl 		GetPointsHdl();
 	//long 					GetVelocityIndex(WorldPoint p);
@@ -71,9 +76,18 @@ public:
 	VelocityRec 		GetStartVelocity(long index, Boolean *isDryPt);
 	VelocityRec 		GetEndVelocity(long index, Boolean *isDryPt);
 	
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
+	// GetMove is overridden, so the batch goes through it one LE at a time
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID)
+						{ return Mover_c::get_move_batch(n, model_time, step_len, lat, lon, z, windages, LE_status,
+														 delta_lat, delta_lon, delta_z, spillType, spill_ID); }
+	virtual Boolean		CanFuseMove() { return false; }
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	OSErr 				ReorderPoints(TMap **newMap, short *bndry_indices, short *bndry_nums, short *bndry_type, long numBoundaryPts); 
 	virtual Boolean 	CheckInterval(long &timeDataInterval, const Seconds& model_time);	// AH 07/17/2012
@@ -82,6 +96,9 @@ public:
 	void 				DisposeLoadedData(LoadedData * dataPtr);	
 	void 				ClearLoadedData(LoadedData * dataPtr);	
 	OSErr				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
+	OSErr				LoadTimeData(long index, LoadedData *data, char *errmsg);
+	Boolean				IsCycleFrame(VelocityFH h);
+	void				DisposeCycleFrames();
 
 };
 
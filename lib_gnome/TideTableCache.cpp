@@ -0,0 +1,322 @@
+/*
+ *  TideTableCache.cpp
+ *  gnome
+ *
+ *  The public functions hold the cache lock, movers sharing a station may
+ *  step on different threads (get_move without the GIL).
+ *
+ *  File layout: a fixed header, then the time values, ebb/flood and high/low
+ *  arrays as raw platform structs, each padded to 8 bytes.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "TideTableCache.h"
+#include "MemUtils.h"
+#include "GnomeThreads.h"
+#include "Replacements.h"
+
+using std::string;
+using std::vector;
+
+#define kTideCacheMagic		"GNTIDE\r\n"
+#define kTideCacheVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		headerSize;
+	uint64_t	key;
+	int32_t		sizeofTimeValue;	// the arrays are platform structs, so these must match to use a file
+	int32_t		sizeofEbbFlood;
+	int32_t		sizeofHighLow;
+	int32_t		unused;
+	int64_t		numTimeValues;		// -1 for no handle
+	int64_t		numEbbFloods;
+	int64_t		numHighLows;
+} TideCacheHeader;
+
+typedef struct {
+	uint64_t		key;
+	TimeValuePairH	timeValues;
+	EbbFloodDataH	ebbFloods;
+	HighLowDataH	highLows;
+	unsigned long	lastUse;
+} TideTableEntry;
+
+static vector<TideTableEntry> tideCache;
+static long maxTables = 0;
+static unsigned long useCount = 0;
+static string cacheDir;
+static GnomeMutex cacheMutex;
+
+static Handle CopyTable(Handle h)
+{
+	Handle copy = h;
+
+	if (!h || _HandToHand(&copy))
+		return 0;
+	return copy;
+}
+
+static void DisposeTable(Handle h)
+{
+	if (h) _DisposeHandle(h);
+}
+
+static void DisposeEntry(TideTableEntry &entry)
+{
+	DisposeTable((Handle)entry.timeValues);
+	DisposeTable((Handle)entry.ebbFloods);
+	DisposeTable((Handle)entry.highLows);
+}
+
+// least recently used first, until under the limit
+static void TrimTideTableCache()
+{
+	while ((long)tideCache.size() > maxTables) {
+		long oldest = 0;
+
+		for (long i = 1; i < (long)tideCache.size(); i++) {
+			if (tideCache[i].lastUse < tideCache[oldest].lastUse)
+				oldest = i;
+		}
+		DisposeEntry(tideCache[oldest]);
+		tideCache.erase(tideCache.begin() + oldest);
+	}
+}
+
+void SetTideTableCacheSize(long numTables)
+{
+	GnomeLock cacheLock(cacheMutex);
+	maxTables = numTables < 0 ? 0 : numTables;
+	TrimTideTableCache();
+}
+
+long GetTideTableCacheSize()
+{
+	return maxTables;
+}
+
+long GetTideTableCacheCount()
+{
+	GnomeLock cacheLock(cacheMutex);
+	return tideCache.size();
+}
+
+void SetTideTableCacheDir(const char *dir)
+{
+	GnomeLock cacheLock(cacheMutex);
+	cacheDir = dir ? dir : "";
+}
+
+const char *GetTideTableCacheDir()
+{
+	return cacheDir.c_str();
+}
+
+Boolean TideTableCacheIsOn()
+{
+	return maxTables > 0 || !cacheDir.empty();
+}
+
+static string TideCachePath(uint64_t key)
+{
+	char name[32];
+	string path = cacheDir;
+
+	sprintf(name, "%016llx.gnometide", (unsigned long long)key);
+	if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+		path += '/';
+	return path + name;
+}
+
+static long PaddedSize(long numBytes)
+{
+	return (numBytes + 7) & ~7L;
+}
+
+// count -1 is no handle
+static Boolean ReadTable(FILE *fp, int64_t count, long itemSize, Handle *h)
+{
+	static const char zeros[8] = {0};
+	char pad[8];
+	long numBytes, padBytes;
+
+	*h = 0;
+	if (count < 0)
+		return true;
+
+	numBytes = count * itemSize;
+	padBytes = PaddedSize(numBytes) - numBytes;
+	*h = _NewHandle(numBytes);
+	if (!*h) {
+		TechError("ReadTideTable()", "_NewHandle()", 0);
+		return false;
+	}
+	if (numBytes > 0 && fread(**h, 1, numBytes, fp) != (size_t)numBytes)
+		return false;
+	return padBytes == 0 || (fread(pad, 1, padBytes, fp) == (size_t)padBytes && !memcmp(pad, zeros, padBytes));
+}
+
+static Boolean WriteTable(FILE *fp, Handle h)
+{
+	static const char zeros[8] = {0};
+	long numBytes = h ? _GetHandleSize(h) : 0;
+	long padBytes = PaddedSize(numBytes) - numBytes;
+
+	if (numBytes > 0 && fwrite(*h, 1, numBytes, fp) != (size_t)numBytes)
+		return false;
+	return padBytes == 0 || fwrite(zeros, 1, padBytes, fp) == (size_t)padBytes;
+}
+
+static OSErr ReadTideTable(uint64_t key, TimeValuePairH *timeValues, EbbFloodDataH *ebbFloods, HighLowDataH *highLows)
+{
+	FILE *fp = 0;
+	TideCacheHeader header;
+	Handle tv = 0, ef = 0, hl = 0;
+	OSErr err = -1;
+
+	if (cacheDir.empty())
+		return -1;
+
+	fp = fopen(TideCachePath(key).c_str(), "rb");
+	if (!fp)
+		return -1;
+
+	if (fread(&header, sizeof(header), 1, fp) != 1)
+		goto done;
+	if (memcmp(header.magic, kTideCacheMagic, 8) || header.version != kTideCacheVersion ||
+		header.headerSize != (int32_t)sizeof(header) || header.key != key)
+		goto done;
+	if (header.sizeofTimeValue != (int32_t)sizeof(TimeValuePair) || header.sizeofEbbFlood != (int32_t)sizeof(EbbFloodData) ||
+		header.sizeofHighLow != (int32_t)sizeof(HighLowData))
+		goto done;
+
+	if (!ReadTable(fp, header.numTimeValues, sizeof(TimeValuePair), &tv) ||
+		!ReadTable(fp, header.numEbbFloods, sizeof(EbbFloodData), &ef) ||
+		!ReadTable(fp, header.numHighLows, sizeof(HighLowData), &hl))
+		goto done;
+
+	*timeValues = (TimeValuePairH)tv;
+	*ebbFloods = (EbbFloodDataH)ef;
+	*highLows = (HighLowDataH)hl;
+	tv = ef = hl = 0;
+	err = 0;
+
+done:
+	fclose(fp);
+	DisposeTable(tv);
+	DisposeTable(ef);
+	DisposeTable(hl);
+
+	return err;
+}
+
+static void WriteTideTable(uint64_t key, TimeValuePairH timeValues, EbbFloodDataH ebbFloods, HighLowDataH highLows)
+{
+	FILE *fp = 0;
+	TideCacheHeader header;
+	string path, tempPath;
+	Boolean ok;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kTideCacheMagic, 8);
+	header.version = kTideCacheVersion;
+	header.headerSize = sizeof(header);
+	header.key = key;
+	header.sizeofTimeValue = sizeof(TimeValuePair);
+	header.sizeofEbbFlood = sizeof(EbbFloodData);
+	header.sizeofHighLow = sizeof(HighLowData);
+	header.numTimeValues = timeValues ? _GetHandleSize((Handle)timeValues) / sizeof(TimeValuePair) : -1;
+	header.numEbbFloods = ebbFloods ? _GetHandleSize((Handle)ebbFloods) / sizeof(EbbFloodData) : -1;
+	header.numHighLows = highLows ? _GetHandleSize((Handle)highLows) / sizeof(HighLowData) : -1;
+
+	// write beside the final name and rename, so a reader never sees half a file
+	path = TideCachePath(key);
+	tempPath = path + ".tmp";
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		WriteTable(fp, (Handle)timeValues) &&
+		WriteTable(fp, (Handle)ebbFloods) &&
+		WriteTable(fp, (Handle)highLows);
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(path.c_str());	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+	if (!ok)
+		remove(tempPath.c_str());
+}
+
+static void AddToMemory(uint64_t key, TimeValuePairH timeValues, EbbFloodDataH ebbFloods, HighLowDataH highLows)
+{
+	TideTableEntry entry;
+	MemoryTag tag(kMemTideTables);
+
+	if (maxTables <= 0)
+		return;
+
+	entry.key = key;
+	entry.timeValues = (TimeValuePairH)CopyTable((Handle)timeValues);
+	entry.ebbFloods = (EbbFloodDataH)CopyTable((Handle)ebbFloods);
+	entry.highLows = (HighLowDataH)CopyTable((Handle)highLows);
+	entry.lastUse = ++useCount;
+	if ((timeValues && !entry.timeValues) || (ebbFloods && !entry.ebbFloods) || (highLows && !entry.highLows)) {
+		DisposeEntry(entry);
+		return;
+	}
+
+	tideCache.push_back(entry);
+	TrimTideTableCache();
+}
+
+OSErr FindTideTable(uint64_t key, TimeValuePairH *timeValues, EbbFloodDataH *ebbFloods, HighLowDataH *highLows)
+{
+	GnomeLock cacheLock(cacheMutex);
+	for (long i = 0; i < (long)tideCache.size(); i++) {
+		TideTableEntry &entry = tideCache[i];
+
+		if (entry.key != key)
+			continue;
+
+		*timeValues = (TimeValuePairH)CopyTable((Handle)entry.timeValues);
+		*ebbFloods = (EbbFloodDataH)CopyTable((Handle)entry.ebbFloods);
+		*highLows = (HighLowDataH)CopyTable((Handle)entry.highLows);
+		if ((entry.timeValues && !*timeValues) || (entry.ebbFloods && !*ebbFloods) || (entry.highLows && !*highLows)) {
+			DisposeTable((Handle)*timeValues);
+			DisposeTable((Handle)*ebbFloods);
+			DisposeTable((Handle)*highLows);
+			return memFullErr;
+		}
+		entry.lastUse = ++useCount;
+		return 0;
+	}
+
+	if (ReadTideTable(key, timeValues, ebbFloods, highLows))
+		return -1;
+
+	AddToMemory(key, *timeValues, *ebbFloods, *highLows);
+	return 0;
+}
+
+void AddTideTable(uint64_t key, TimeValuePairH timeValues, EbbFloodDataH ebbFloods, HighLowDataH highLows)
+{
+	GnomeLock cacheLock(cacheMutex);
+	for (long i = 0; i < (long)tideCache.size(); i++) {
+		if (tideCache[i].key == key)
+			return;
+	}
+
+	AddToMemory(key, timeValues, ebbFloods, highLows);
+	if (!cacheDir.empty())
+		WriteTideTable(key, timeValues, ebbFloods, highLows);
+}
@@ -0,0 +1,41 @@
+/*
+ *  TideTableCache.h
+ *  gnome
+ *
+ *  Process wide cache of the tide curves and extrema ShioTimeValue_c computes
+ *  for a station over a window of days, so long hindcasts stepping back over
+ *  the same days and several scenarios on one station compute each window
+ *  once. Keyed by a hash of the station's constituents, offsets and the
+ *  window. Held in memory up to a number of tables, and optionally in a
+ *  directory shared between runs. Both are off unless set.
+ *
+ */
+
+#ifndef __TideTableCache__
+#define __TideTableCache__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ShioTimeValue_c.h"
+#include "ExportSymbols.h"
+
+// maximum tables held in memory, 0 turns the memory cache off
+void DLL_API SetTideTableCacheSize(long maxTables);
+long DLL_API GetTideTableCacheSize();
+long DLL_API GetTideTableCacheCount();
+
+// directory the tables are saved in, empty or NULL turns the disk cache off
+void DLL_API SetTideTableCacheDir(const char *dir);
+DLL_API const char *GetTideTableCacheDir();
+
+Boolean TideTableCacheIsOn();
+
+// on success the caller owns copies of the tables, any of which may be 0
+OSErr FindTideTable(uint64_t key, TimeValuePairH *timeValues, EbbFloodDataH *ebbFloods, HighLowDataH *highLows);
+
+// the handles are copied, 0 handles are kept as 0
+void AddTideTable(uint64_t key, TimeValuePairH timeValues, EbbFloodDataH ebbFloods, HighLowDataH highLows);
+
+#endif
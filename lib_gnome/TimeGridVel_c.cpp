@@ -12,12 +12,28 @@
 #include <istream>
 #include <iostream>
 #include <sstream>
+#include <typeinfo>
+#include <algorithm>
 
 #include "TimeGridVel_c.h"
 #include "netcdf.h"
+#include "ForcingIOCalls.h"
 #include "CompFunctions.h"
 #include "StringFunctions.h"
+#include "TextLines.h"
 #include "DagTreeIO.h"
+#include "TimeSliceCache.h"
+#include "TopologyCache.h"
+#include "ForcingFile.h"
+#include "ForcingBlockCache.h"
+#include "TimeIndexCache.h"
+#include "SetupStats.h"
+#include "TimeInterval.h"
+#include "InterpolationKernels.h"
+#include "NearestNodeIndex.h"
+#include "TriDepthTables.h"
+#include "IceFieldProducts.h"
+#include "CurvCellLocator.h"
 #include "OUTILS.H"	// for the units
 
 #ifndef pyGNOME
@@ -117,19 +133,23 @@ Boolean IsNetCDFFile (char *path, short *gridType)
 	size_t t_len, t_len2;
 	char *modelTypeStr = 0, *gridTypeStr = 0, *sourceStr = 0;
 
-	err = MyGetFileSize(0, 0, path, &fileLength);
-	if (err)
-		return false;
-	
-	lenToRead = _min(512, fileLength);
-	
-	err = ReadSectionOfFile(0, 0, path, 0, lenToRead, firstPartOfFile, 0);
-	firstPartOfFile[lenToRead - 1] = 0; // make sure it is a cString
-	if (!err) {
-		// must start with "CDF
-		NthLineInTextNonOptimized(firstPartOfFile, line = 0, strLine, 512);
-		if (!strncmp (firstPartOfFile, "CDF", 3))
-			bIsValid = true;
+	if (IsRemoteDataPath(path))
+		bIsValid = true;	// an OPeNDAP URL, nc_open tells
+	else {
+		err = MyGetFileSize(0, 0, path, &fileLength);
+		if (err)
+			return false;
+		
+		lenToRead = _min(512, fileLength);
+		
+		err = ReadSectionOfFile(0, 0, path, 0, lenToRead, firstPartOfFile, 0);
+		firstPartOfFile[lenToRead - 1] = 0; // make sure it is a cString
+		if (!err) {
+			// must start with "CDF
+			NthLineInTextNonOptimized(firstPartOfFile, line = 0, strLine, 512);
+			if (!strncmp (firstPartOfFile, "CDF", 3))
+				bIsValid = true;
+		}
 	}
 
 	if (!bIsValid)
@@ -251,6 +271,7 @@ TimeGridVel_c::TimeGridVel_c ()
 
 	fOverLap = false;		// for multiple files case
 	fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	
 	fFillValue = -1e+34;
 	
@@ -275,10 +296,36 @@ TimeGridVel_c::TimeGridVel_c ()
 	fMaxDepthForExtrapolation = 0.;	// assume 2D is just surface
 	
 	fNumCols = fNumRows = 0;
+
+	fPrefetchNextTime = true;
+	memset(&fPrefetchData,0,sizeof(fPrefetchData));
+	fPrefetchData.timeIndex = UNASSIGNEDINDEX;
+	fPrefetchData.dataHdl = 0;
+	fPrefetchErr = 0;
+	fPrefetchPath[0] = 0;
+#ifdef GNOME_PREFETCH
+	fPrefetchThread = 0;
+#endif
+
+	fNcid = -1;
+	fNcidPath[0] = 0;
+
+	fReadSinglePrecision = false;
+
+	fUseInterpolatedField = false;
+	fInterpolatedValid = false;
+	fInterpolatedAlpha = 0;
+	fInterpolatedH = 0;
 }
 
 void TimeGridVel_c::Dispose ()
 {
+	FinishPrefetch();
+	DisposePrefetchData();
+
+	CloseTimeDataFile();
+	DisposeInterpolatedField();
+
 	if (fGrid)
 	{
 		fGrid -> Dispose();
@@ -290,6 +337,7 @@ void TimeGridVel_c::Dispose ()
 	
 	if(fStartData.dataHdl)DisposeLoadedData(&fStartData); 
 	if(fEndData.dataHdl)DisposeLoadedData(&fEndData);
+	DisposeCycleFrames();
 	
 	if(fInputFilesHdl) {DisposeHandle((Handle)fInputFilesHdl); fInputFilesHdl=0;}
 	
@@ -321,7 +369,7 @@ Boolean TimeGridVel_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 {
 	Seconds time = model_time, startTime, endTime;
 	
-	long i, numTimes, numFiles = GetNumFiles();
+	long numTimes, numFiles = GetNumFiles();
 	
 	numTimes = this->GetNumTimesInFile();
 	//cerr << "CheckInterval(): numTimes = " << numTimes << endl;
@@ -364,14 +412,9 @@ Boolean TimeGridVel_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 				}
 			}
 			
-			for (i=0;i<numTimes;i++) 
-			{	// find the time interval
-				if (time>=(*fTimeHdl)[i] && time<=(*fTimeHdl)[i+1])
-				{
-					timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-					return false;
-				}
-			}	
+			// find the time interval, the first is between 0 and 1, and so on
+			if (FindTimeInterval(ShiftedTimes(fTimeHdl, 0), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+				return false;
 			// don't allow time before first or after last
 			if (time<(*fTimeHdl)[0]) 
 				timeDataInterval = 0;
@@ -417,15 +460,9 @@ Boolean TimeGridVel_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 			fOverLap = false;
 	}
 
-	for (i = 0; i < numTimes - 1; i++) {
-		// find the time interval
-		if (time >= ((*fTimeHdl)[i] + fTimeShift) &&
-			time <= ((*fTimeHdl)[i + 1] + fTimeShift))
-		{
-			timeDataInterval = i + 1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(ShiftedTimes(fTimeHdl, fTimeShift), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 
 	// don't allow time before first or after last
 	if (time < ((*fTimeHdl)[0] + fTimeShift)) {
@@ -478,7 +515,9 @@ void TimeGridVel_c::DisposeTimeHdl()
 
 void TimeGridVel_c::DisposeLoadedData(LoadedData *dataPtr)
 {
-	if(dataPtr -> dataHdl) DisposeHandle((Handle) dataPtr -> dataHdl);
+	// slices shared through the cache are released and the cycle frames are kept, not disposed
+	ForgetInterpolationField(dataPtr -> dataHdl);
+	if(dataPtr -> dataHdl && !IsCycleFrame(dataPtr -> dataHdl) && !ReleaseTimeSlice(dataPtr -> dataHdl)) DisposeHandle((Handle) dataPtr -> dataHdl);
 	ClearLoadedData(dataPtr);
 }
 
@@ -490,8 +529,41 @@ void TimeGridVel_c::DisposeLoadedData(LoadedFieldData *dataPtr)
 
 void TimeGridVel_c::DisposeAllLoadedData()
 {
+	FinishPrefetch();
+	DisposePrefetchData();
+	CloseTimeDataFile();
+	fInterpolatedValid = false;
 	if(fStartData.dataHdl)DisposeLoadedData(&fStartData); 
 	if(fEndData.dataHdl)DisposeLoadedData(&fEndData);
+	DisposeCycleFrames();
+}
+
+Boolean TimeGridVel_c::IsCycleFrame(VelocityFH h)
+{
+	for (size_t i = 0; i < fCycleFrames.size(); i++)
+		if (fCycleFrames[i] == h)
+			return true;
+	return false;
+}
+
+void TimeGridVel_c::DisposeCycleFrames()
+{
+	for (size_t i = 0; i < fCycleFrames.size(); i++)
+	{
+		if (!fCycleFrames[i])
+			continue;
+		if (fStartData.dataHdl == fCycleFrames[i]) ClearLoadedData(&fStartData);
+		if (fEndData.dataHdl == fCycleFrames[i]) ClearLoadedData(&fEndData);
+		ForgetInterpolationField(fCycleFrames[i]);
+		DisposeHandle((Handle)fCycleFrames[i]);
+	}
+	fCycleFrames.clear();
+}
+
+void TimeGridVel_c::DisposeInterpolatedField()
+{
+	if(fInterpolatedH) {DisposeHandle((Handle)fInterpolatedH); fInterpolatedH=0;}
+	fInterpolatedValid = false;
 }
 
 void TimeGridVel_c::ClearLoadedData(LoadedData *dataPtr)
@@ -506,6 +578,95 @@ void TimeGridVel_c::ClearLoadedData(LoadedFieldData *dataPtr)
 	dataPtr -> timeIndex = UNASSIGNEDINDEX;
 }
 
+void TimeGridVel_c::GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+{
+	TIME_SECTION(&fTiming, kTimerInterpolate, n);	// location included
+
+	for (LECount i = 0; i < n; i++)
+		vel[i] = GetScaledPatValue(model_time, refPoints[i], triHints ? &triHints[i] : 0);
+}
+
+Boolean TimeGridVel_c::IsConstantField(const Seconds& model_time)
+{
+	return (GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || (fEndData.timeIndex == UNASSIGNEDINDEX && model_time > ((*fTimeHdl)[fStartData.timeIndex] + fTimeShift) && fAllowExtrapolationInTime) || (fEndData.timeIndex == UNASSIGNEDINDEX && model_time < ((*fTimeHdl)[fStartData.timeIndex] + fTimeShift) && fAllowExtrapolationInTime);
+}
+
+TimeGridFieldView TimeGridVel_c::GetFieldView(Boolean constantField, double timeAlpha)
+{
+	TimeGridFieldView view = {0, 0, 0, 1, fNumRows*fNumCols, fVar.fileScaleFactor};
+
+	if (!fStartData.dataHdl)
+		return view;
+
+	if (constantField)
+		view.start = *fStartData.dataHdl;
+	else if (UseInterpolatedField(timeAlpha))
+	{
+		view.start = *fStartData.dataHdl;
+		view.blended = *fInterpolatedH;
+	}
+	else if (fEndData.dataHdl)
+	{
+		view.start = *fStartData.dataHdl;
+		view.end = *fEndData.dataHdl;
+		view.timeAlpha = timeAlpha;
+	}
+	return view;
+}
+
+double TimeGridVel_c::GetCellSize(WorldPoint3D p, long *triHint)
+{
+	return fGrid ? fGrid->GetCellSize(p.p, triHint) : 0;
+}
+
+OSErr TimeGridVel_c::get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints)
+{
+	OSErr err = 0;
+	char errmsg[256];
+	
+	if(!ref || !vels)
+		return 1;
+	
+	if (n <= 0)
+		return noErr;
+	
+	if ((err = this -> SetInterval(errmsg, model_time)))
+		return err;
+	
+	// the grid works on positions scaled by 1000000
+	vector<WorldPoint3D> refPoints(ref, ref + n);
+	for (LECount i = 0; i < n; i++)
+	{
+		refPoints[i].p.pLat *= 1000000;
+		refPoints[i].p.pLong *= 1000000;
+	}
+	
+	GetScaledPatValues(model_time, n, &refPoints[0], hints, vels);
+	
+	return noErr;
+}
+
+
+// the first and last times of a NetCDF file from the time index, which
+// ScanFileForTimes adds the file to the first time it is opened
+static Boolean GetIndexedFileTimes(char *path, Seconds *startTime, Seconds *endTime)
+{
+	Seconds **timeH = 0;
+	long numTimes;
+
+	if (!TimeIndexCacheIsOn() || ScanFileForTimes(path, &timeH) != noErr)
+		return false;
+
+	numTimes = _GetHandleSize((Handle)timeH) / sizeof(**timeH);
+	if (numTimes > 0) {
+		if (startTime) *startTime = INDEXH(timeH, 0);
+		if (endTime) *endTime = INDEXH(timeH, numTimes - 1);
+	}
+	DisposeHandle((Handle)timeH);
+
+	return numTimes > 0;
+}
+
 
 // for now leave this part out of the python and let the file path list be passed in
 OSErr TimeGridVel_c::ReadInputFileNames(char *fileNamesPath)
@@ -526,7 +687,7 @@ OSErr TimeGridVel_c::ReadInputFileNames(char *fileNamesPath)
 	double timeVal;
 	char recname[NC_MAX_NAME], *timeUnits = 0;
 	static size_t timeIndex;
-	Seconds startTime2;
+	Seconds startTime2, indexedStart, indexedEnd;
 	double timeConversion = 1.;
 
 	if ((err = ReadFileContents(TERMINATED, 0, 0, fileNamesPath, 0, 0, &fileBufH)) != noErr)
@@ -568,6 +729,12 @@ OSErr TimeGridVel_c::ReadInputFileNames(char *fileNamesPath)
 #endif
 
 			strcpy(path,(*inputFilesHdl)[i].pathName);
+			if (GetIndexedFileTimes(path, &indexedStart, &indexedEnd)) {
+				(*inputFilesHdl)[i].startTime = indexedStart;
+				(*inputFilesHdl)[i].endTime = indexedEnd;
+				continue;
+			}
+
 			status = nc_open(path, NC_NOWRITE, &ncid);
 			if (status != NC_NOERR) {
 				err = -2;
@@ -727,6 +894,7 @@ long TimeGridVelRect_c::GetNumDepthLevelsInFile()
 /////////////////////////////////////////////////////////////////
 OSErr TimeGridVelRect_c::TextRead(const char *path, const char *topFilePath)
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	// this code is for regular grids
 	// For regridded data files don't have the real latitude/longitude values
 	// Also may want to get fill_Value and scale_factor here, rather than every time velocities are read
@@ -1050,6 +1218,7 @@ done:
 		if(fTimeHdl) {DisposeHandle((Handle)fTimeHdl); fTimeHdl=0;}
 		if (fDepthLevelsHdl) {DisposeHandle((Handle)fDepthLevelsHdl); fDepthLevelsHdl=0;}
 	}
+	SetDepthLevelOrder();
 	
 	if (lat_vals) delete [] lat_vals;
 	if (lon_vals) delete [] lon_vals;
@@ -1060,7 +1229,8 @@ done:
 }
 
 
-OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* errmsg) 
+template <class T>
+OSErr TimeGridVelRect_c::ReadVelocityData(long index,VelocityFH *velocityH, char* errmsg) 
 {
 	OSErr err = 0;
 	long i,j,k;
@@ -1071,7 +1241,8 @@ OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	static size_t curr_index[] = {0,0,0,0};
 	static size_t curr_count[4];
 	size_t velunit_len;
-	double *curr_uvals=0,*curr_vvals=0, fill_value, velConversion=1.;
+	T *curr_uvals=0,*curr_vvals=0;
+	double fill_value, velConversion=1.;
 	long totalNumberOfVels = fNumRows * fNumCols;
 	VelocityFH velH = 0;
 	long latlength = fNumRows;
@@ -1079,13 +1250,16 @@ OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	long depthlength = fNumDepthLevels;	// code goes here, do we want all depths? maybe if movermap is a ptcur map??
 	double scale_factor = 1.;
 	Boolean bDepthIncluded = false;
+	long latDim, fileRow, valIndex;
+	// part of the grid to read, in file row order (velH row i is file row latlength-i-1)
+	long rowStart = 0, numRowsRead = latlength, colStart = 0, numColsRead = lonlength;
 	
 	errmsg[0]=0;
 	
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	status = nc_inq_ndims(ncid, &numdims);
@@ -1093,10 +1267,10 @@ OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	
 	if (numdims>=4)
 	{	// code goes here, do we really want to use all the depths? 
-		status = nc_inq_dimid(ncid, "depth", &depthid);	//3D
+		status = InqDimID(ncid, "depth", &depthid);	//3D
 		if (status != NC_NOERR) 
 		{
-			status = nc_inq_dimid(ncid, "sigma", &depthid);	//3D - need to check sigma values in TextRead...
+			status = InqDimID(ncid, "sigma", &depthid);	//3D - need to check sigma values in TextRead...
 			if (status != NC_NOERR) bDepthIncluded = false;
 			else bDepthIncluded = true;
 		}
@@ -1119,30 +1293,38 @@ OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 		curr_count[2] = lonlength;
 	}
 	
-	curr_uvals = new double[latlength*lonlength*depthlength]; 
+	if (fUseActiveWindow && fWindowRowEnd > fWindowRowStart && fWindowColEnd > fWindowColStart)
+	{
+		rowStart = latlength - fWindowRowEnd;
+		numRowsRead = fWindowRowEnd - fWindowRowStart;
+		colStart = fWindowColStart;
+		numColsRead = fWindowColEnd - fWindowColStart;
+	}
+	
+	curr_uvals = new T[numRowsRead*numColsRead*depthlength]; 
 	if(!curr_uvals) {TechError("TimeGridVel::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
-	curr_vvals = new double[latlength*lonlength*depthlength]; 
+	curr_vvals = new T[numRowsRead*numColsRead*depthlength]; 
 	if(!curr_vvals) {TechError("TimeGridVel::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
 	
-	status = nc_inq_varid(ncid, "water_u", &curr_ucmp_id);
+	status = InqVarID(ncid, "water_u", &curr_ucmp_id);
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "curr_ucmp", &curr_ucmp_id); 
+		status = InqVarID(ncid, "curr_ucmp", &curr_ucmp_id); 
 		if (status != NC_NOERR) 
 		{
-			status = nc_inq_varid(ncid, "u", &curr_ucmp_id); // allow u,v since so many people get confused
-			if (status != NC_NOERR) {status = nc_inq_varid(ncid, "U", &curr_ucmp_id); if (status != NC_NOERR)	// ferret uses CAPS
+			status = InqVarID(ncid, "u", &curr_ucmp_id); // allow u,v since so many people get confused
+			if (status != NC_NOERR) {status = InqVarID(ncid, "U", &curr_ucmp_id); if (status != NC_NOERR)	// ferret uses CAPS
 			{err = -1; goto LAS;}}	// broader check for variable names coming out of LAS
 		}	
 	}
-	status = nc_inq_varid(ncid, "water_v", &curr_vcmp_id);	// what if only input one at a time (u,v separate movers)?
+	status = InqVarID(ncid, "water_v", &curr_vcmp_id);	// what if only input one at a time (u,v separate movers)?
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "curr_vcmp", &curr_vcmp_id); 
+		status = InqVarID(ncid, "curr_vcmp", &curr_vcmp_id); 
 		if (status != NC_NOERR) 
 		{
-			status = nc_inq_varid(ncid, "v", &curr_vcmp_id); // allow u,v since so many people get confused
-			if (status != NC_NOERR) {status = nc_inq_varid(ncid, "V", &curr_vcmp_id); if (status != NC_NOERR)	// ferret uses CAPS
+			status = InqVarID(ncid, "v", &curr_vcmp_id); // allow u,v since so many people get confused
+			if (status != NC_NOERR) {status = InqVarID(ncid, "V", &curr_vcmp_id); if (status != NC_NOERR)	// ferret uses CAPS
 			{err = -1; goto done;}}
 		}	
 	}
@@ -1185,10 +1367,18 @@ LAS:
 	
 	status = nc_inq_varndims(ncid, curr_ucmp_id, &uv_ndims);
 	if (status==NC_NOERR){if (uv_ndims < numdims && uv_ndims==3) {curr_count[1] = latlength; curr_count[2] = lonlength;}}	// could have more dimensions than are used in u,v
-	if (uv_ndims==4) {curr_count[1] = depthlength;curr_count[2] = latlength;curr_count[3] = lonlength;}
-	status = nc_get_vara_double(ncid, curr_ucmp_id, curr_index, curr_count, curr_uvals);
+	latDim = bDepthIncluded ? 2 : 1;
+	if (status==NC_NOERR && uv_ndims < numdims && uv_ndims==3) latDim = 1;
+	if (uv_ndims==4) {curr_count[1] = depthlength;curr_count[2] = latlength;curr_count[3] = lonlength; latDim = 2;}
+	// the statics keep the last window, so set every start
+	curr_index[1] = curr_index[2] = curr_index[3] = 0;
+	curr_index[latDim] = rowStart;
+	curr_count[latDim] = numRowsRead;
+	curr_index[latDim+1] = colStart;
+	curr_count[latDim+1] = numColsRead;
+	status = GetVaraCached(ncid, path, curr_ucmp_id, curr_index, curr_count, curr_uvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
-	status = nc_get_vara_double(ncid, curr_vcmp_id, curr_index, curr_count, curr_vvals);
+	status = GetVaraCached(ncid, path, curr_vcmp_id, curr_index, curr_count, curr_vvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	
@@ -1219,8 +1409,6 @@ LAS:
 	status = nc_get_att_double(ncid, curr_ucmp_id, "scale_factor", &scale_factor);
 	if (status != NC_NOERR) {/*err = -1; goto done;*/}	// don't require scale factor
 	
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	velH = (VelocityFH)_NewHandleClear(totalNumberOfVels * sizeof(VelocityFRec) * depthlength);
 	if (!velH) {err = memFullErr; goto done;}
@@ -1228,20 +1416,24 @@ LAS:
 	{
 		for (i=0;i<latlength;i++)
 		{
-			for (j=0;j<lonlength;j++)
+			fileRow = latlength-i-1;
+			if (fileRow < rowStart || fileRow >= rowStart+numRowsRead)
+				continue;	// outside the window, left at zero
+			for (j=colStart;j<colStart+numColsRead;j++)
 			{
-				if (curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]==fill_value)	// should store in current array and check before drawing or moving
-					curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]=0.;
-				if (curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]==fill_value)
-					curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]=0.;
+				valIndex = (fileRow-rowStart)*numColsRead+(j-colStart)+k*numRowsRead*numColsRead;
+				if (curr_uvals[valIndex]==(T)fill_value)	// should store in current array and check before drawing or moving
+					curr_uvals[valIndex]=0.;
+				if (curr_vvals[valIndex]==(T)fill_value)
+					curr_vvals[valIndex]=0.;
 
-				if (isnan(curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]))	// should store in current array and check before drawing or moving
-					curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]=0.;
-				if (isnan(curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]))
-					curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]=0.;
+				if (isnan(curr_uvals[valIndex]))	// should store in current array and check before drawing or moving
+					curr_uvals[valIndex]=0.;
+				if (isnan(curr_vvals[valIndex]))
+					curr_vvals[valIndex]=0.;
 
-				INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).u = (float)curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;
-				INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).v = (float)curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;
+				INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).u = (float)curr_uvals[valIndex] * velConversion;
+				INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).v = (float)curr_vvals[valIndex] * velConversion;
 			}
 		}
 	}
@@ -1263,153 +1455,654 @@ done:
 	return err;
 }
 
+OSErr TimeGridVelRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* errmsg)
+{
+	if (fReadSinglePrecision)
+		return ReadVelocityData<float>(index, velocityH, errmsg);
+	return ReadVelocityData<double>(index, velocityH, errmsg);
+}
 
-OSErr TimeGridVel_c::SetInterval(char *errmsg, const Seconds& model_time)
+Boolean TimeGridVelRect_c::GetSliceWindow(long *window)
 {
-	OSErr err = 0;
+	if (!(fUseActiveWindow && fWindowRowEnd > fWindowRowStart && fWindowColEnd > fWindowColStart))
+		return false;
 
-	long timeDataInterval = 0;
-	Boolean intervalLoaded = this->CheckInterval(timeDataInterval, model_time);
-	long indexOfStart = timeDataInterval - 1;
-	long indexOfEnd = timeDataInterval;
-	long numTimesInFile = this->GetNumTimesInFile();
+	window[0] = fWindowRowStart;
+	window[1] = fWindowRowEnd;
+	window[2] = fWindowColStart;
+	window[3] = fWindowColEnd;
+	return true;
+}
 
-	errmsg[0] = 0;
+void TimeGridVelRect_c::SetActiveWindowMode(bool useWindow, long halo)
+{
+	fUseActiveWindow = useWindow;
+	fActiveWindowHalo = halo < 0 ? 0 : halo;
+	fWindowRowStart = fWindowRowEnd = 0;
+	fWindowColStart = fWindowColEnd = 0;
+	DisposeAllLoadedData();	// any windowed slices are reloaded in full on the next SetInterval
+}
+
+// the window of the cells of bounds plus the halo, where a domain decomposed
+// run's rank has its LEs: the times read from then on are windowed from the
+// first, rather than after the LEs of the first step are seen, and the
+// window still grows to cover LEs that leave it
+Boolean TimeGridVelRect_c::SetActiveWindowBounds(const WorldRect &bounds)
+{
+	LongRect gridLRect, geoRect;
+	ScaleRec scale;
+	WorldRect gridBounds;
+	double col1, col2, row1, row2;
+	long rowStart, rowEnd, colStart, colEnd;
 
-	if (intervalLoaded)
+	if (!fUseActiveWindow || fNumRows <= 0 || fNumCols <= 0)
+		return false;
+
+	// as GetVelocityIndex finds the cell of a point
+	gridBounds = GetGridBounds();
+	SetLRect(&gridLRect, 0, fNumRows, fNumCols, 0);
+	SetLRect(&geoRect, gridBounds.loLong, gridBounds.loLat, gridBounds.hiLong, gridBounds.hiLat);
+	GetLScaleAndOffsets(&geoRect, &gridLRect, &scale);
+
+	col1 = bounds.loLong * scale.XScale + scale.XOffset - .5;
+	col2 = bounds.hiLong * scale.XScale + scale.XOffset - .5;
+	row1 = bounds.loLat * scale.YScale + scale.YOffset - .5;
+	row2 = bounds.hiLat * scale.YScale + scale.YOffset - .5;
+
+	rowStart = _max(0, (long)floor(_min(row1, row2)) - fActiveWindowHalo);
+	rowEnd = _min(fNumRows, (long)ceil(_max(row1, row2)) + fActiveWindowHalo + 1);
+	colStart = _max(0, (long)floor(_min(col1, col2)) - fActiveWindowHalo);
+	colEnd = _min(fNumCols, (long)ceil(_max(col1, col2)) + fActiveWindowHalo + 1);
+	if (rowEnd <= rowStart || colEnd <= colStart)
+		return false;
+
+	FinishPrefetch();
+	fWindowRowStart = rowStart;
+	fWindowRowEnd = rowEnd;
+	fWindowColStart = colStart;
+	fWindowColEnd = colEnd;
+	DisposeAllLoadedData();	// read again for the window on the next SetInterval
+	return true;
+}
+
+// grow the window to cover the in water LEs plus the halo. The window only
+// grows, and when it does the loaded times are read again for the new window.
+OSErr TimeGridVelRect_c::UpdateActiveWindow(char *errmsg, const Seconds& model_time, LECount n, WorldPoint3D *ref, short *LE_status)
+{
+	long rowMin = fNumRows, rowMax = -1, colMin = fNumCols, colMax = -1;
+	long index, row, col;
+	Boolean loadedAll = !(fWindowRowEnd > fWindowRowStart && fWindowColEnd > fWindowColStart);
+
+	if (!fUseActiveWindow)
 		return 0;
 
-	// check for constant current 
-	if (numTimesInFile == 1 && !(GetNumFiles() > 1))
-		//or if(timeDataInterval==-1)
-	{
-		indexOfStart = 0;
-		indexOfEnd = UNASSIGNEDINDEX;	// should already be -1
-	}
+	for (LECount i = 0; i < n; i++) {
+		WorldPoint p;
 
-	if (timeDataInterval == 0 && fAllowExtrapolationInTime) {
-		indexOfStart = 0;
-		indexOfEnd = -1;
-	}
+		if (LE_status[i] != OILSTAT_INWATER)
+			continue;
 
-	//cerr << "timeDataInterval: " << timeDataInterval << endl;
-	if (timeDataInterval == 0 || timeDataInterval == numTimesInFile)
-	{
+		p.pLat = ref[i].p.pLat * 1000000;
+		p.pLong = ref[i].p.pLong * 1000000;
+		index = GetVelocityIndex(p);
+		if (index < 0)
+			continue;
 
-		//cerr << "GetNumFiles(): " << GetNumFiles() << endl;
-		// before the first step in the file
-		if (GetNumFiles() > 1) {
-			if ((err = CheckAndScanFile(errmsg, model_time)) || fOverLap)
-				goto done;
-			
-			intervalLoaded = this->CheckInterval(timeDataInterval, model_time);
-			
-			indexOfStart = timeDataInterval - 1;
-			indexOfEnd = timeDataInterval;
-			numTimesInFile = this->GetNumTimesInFile();
-			if (fAllowExtrapolationInTime &&
-				(timeDataInterval == numTimesInFile || timeDataInterval == 0))
-			{
-				if (intervalLoaded)
-					return 0;
-				indexOfEnd = -1;
-				if (timeDataInterval == 0)
-					indexOfStart = 0;	// if we allow extrapolation we need to load the first time
-			}
-		}
-		else {
-			if(fTimeAlpha>=0 && timeDataInterval == numTimesInFile)
-				indexOfEnd = 0;	// start over
-			else if (fAllowExtrapolationInTime && timeDataInterval == numTimesInFile) {
-				fStartData.timeIndex = numTimesInFile-1;//check if time > last model time in all files
-				fEndData.timeIndex = UNASSIGNEDINDEX;//check if time > last model time in all files
-			}
-			else if (fAllowExtrapolationInTime && timeDataInterval == 0) {
-				fStartData.timeIndex = 0;//check if time > last model time in all files
-				fEndData.timeIndex = UNASSIGNEDINDEX;//check if time > last model time in all files
-			}
-			else {
-				err = -1;
-				strcpy(errmsg,"Time outside of interval being modeled");
-				goto done;
-			}
-		}
-		// code goes here, if time > last time in files allow user to continue
-		// leave last two times loaded? move last time to start and nothing for end?
-		// redefine as constant or just check if time > last time and some flag set
-		// careful with timeAlpha, really just want to use the last time but needs to be loaded
-		// want to check so that don't reload at every step, should recognize last time is ok
-	}
-	//else // load the two intervals
-	{
-		DisposeLoadedData(&fStartData);
-		
-		if(indexOfStart == fEndData.timeIndex) // passing into next interval
-		{
-			fStartData = fEndData;
-			ClearLoadedData(&fEndData);
-		}
-		else
-		{
-			DisposeLoadedData(&fEndData);
-		}
-		
-		//////////////////
-		
-		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
-		{ // start data is not loaded
-			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
-			if(err) goto done;
-			fStartData.timeIndex = indexOfStart;
-		}	
-		
-		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
-		{
-			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
-			if(err) goto done;
-			fEndData.timeIndex = indexOfEnd;
-		}
+		row = index / fNumCols;
+		col = index % fNumCols;
+		if (row < rowMin) rowMin = row;
+		if (row > rowMax) rowMax = row;
+		if (col < colMin) colMin = col;
+		if (col > colMax) colMax = col;
 	}
-	
-done:	
-	if(err)
-	{
-		if(!errmsg[0])strcpy(errmsg,"Error in TimeGridVel::SetInterval()");
-		DisposeLoadedData(&fStartData);
-		DisposeLoadedData(&fEndData);
+
+	if (rowMax < 0)
+		return 0;	// no LEs on the grid
+
+	if (!loadedAll &&
+		rowMin >= fWindowRowStart && rowMax < fWindowRowEnd &&
+		colMin >= fWindowColStart && colMax < fWindowColEnd)
+		return 0;	// already covered
+
+	FinishPrefetch();	// it reads the window
+
+	if (!loadedAll) {
+		if (fWindowRowStart < rowMin) rowMin = fWindowRowStart;
+		if (fWindowRowEnd - 1 > rowMax) rowMax = fWindowRowEnd - 1;
+		if (fWindowColStart < colMin) colMin = fWindowColStart;
+		if (fWindowColEnd - 1 > colMax) colMax = fWindowColEnd - 1;
 	}
-	return err;
-	
+
+	fWindowRowStart = _max(0, rowMin - fActiveWindowHalo);
+	fWindowRowEnd = _min(fNumRows, rowMax + fActiveWindowHalo + 1);
+	fWindowColStart = _max(0, colMin - fActiveWindowHalo);
+	fWindowColEnd = _min(fNumCols, colMax + fActiveWindowHalo + 1);
+
+	if (loadedAll)
+		return 0;	// the loaded times cover the whole grid, later reads use the window
+
+	DisposeAllLoadedData();
+	return SetInterval(errmsg, model_time);
 }
 
 
-OSErr TimeGridVel_c::CheckAndScanFile(char *errmsg, const Seconds& model_time)
+GnomeMutex& GnomeFileIOMutex()
 {
-	OSErr err = 0;
-	Seconds time = model_time, startTime, endTime, lastEndTime, testTime, firstStartTime; 
-	
-	long i, numFiles = GetNumFiles();
+	static GnomeMutex fileIOMutex;
+	return fileIOMutex;
+}
+
+#ifdef GNOME_PREFETCH
+static void PrefetchTimeData(TimeGridVel_c *timeGrid, long index)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	char errmsg[256];
+	GnomeLock fileLock(GnomeFileIOMutex());
 
 	errmsg[0] = 0;
+	timeGrid->fPrefetchErr = timeGrid->ReadTimeSlice(index, &timeGrid->fPrefetchData.dataHdl, errmsg);
+}
+#endif
 
-	if (fEndData.timeIndex!=UNASSIGNEDINDEX)
-		testTime = (*fTimeHdl)[fEndData.timeIndex];	// currently loaded end time
-	
-	firstStartTime = (*fInputFilesHdl)[0].startTime + fTimeShift;
-	for (i = 0; i < numFiles; i++)
-	{
-		startTime = (*fInputFilesHdl)[i].startTime + fTimeShift;
-		endTime = (*fInputFilesHdl)[i].endTime + fTimeShift;
-		if (startTime<=time&&time<=endTime && !(startTime==endTime))
-		{
-			//if(fTimeHdl) {DisposeHandle((Handle)fTimeHdl); fTimeHdl=0;}
-			DisposeTimeHdl();
-			err = ScanFileForTimes((*fInputFilesHdl)[i].pathName,&fTimeHdl);	
-			
-			// code goes here, check that start/end times match
-			strcpy(fVar.pathName,(*fInputFilesHdl)[i].pathName);
-			fOverLap = false;
-			return err;
+// returns the open dataset for path, opening it (and closing the previous
+// one) only when the path changes. Returns a netCDF status like nc_open.
+int TimeGridVel_c::OpenTimeDataFile(const char *path, int *ncid)
+{
+	int status;
+
+	if (fNcid >= 0 && !strcmp(fNcidPath, path)) {
+		*ncid = fNcid;
+		return NC_NOERR;
+	}
+
+	CloseTimeDataFile();
+
+	status = nc_open(path, NC_NOWRITE, ncid);
+	if (status != NC_NOERR)
+		return status;
+
+	fNcid = *ncid;
+	strcpy(fNcidPath, path);
+
+	return NC_NOERR;
+}
+
+void TimeGridVel_c::CloseTimeDataFile()
+{
+	if (fNcid >= 0)
+		nc_close(fNcid);
+
+	fNcid = -1;
+	fNcidPath[0] = 0;
+	fNcVarIDs.clear();
+	fNcDimIDs.clear();
+}
+
+// the most a variable's chunk cache is grown to, for SizeChunkCache
+#define kMaxChunkCacheBytes (128 * 1024 * 1024)
+
+static bool IsPrime(size_t n)
+{
+	if (n < 2) return false;
+	for (size_t d = 2; d * d <= n; d++)
+		if (n % d == 0) return false;
+	return true;
+}
+
+// a compressed variable chunked over several times is decompressed a chunk
+// at a time, so with the default chunk cache (a few MB) every time read
+// decompresses its chunks again. The cache of a variable read by time is
+// grown to hold the chunks of one time, so the dataset kept open decodes
+// each chunk once for all the times in it
+static void SizeChunkCache(int ncid, int varid)
+{
+	int format, storage, numDims, dimIDs[NC_MAX_VAR_DIMS];
+	size_t chunks[NC_MAX_VAR_DIMS], dimLen, typeSize, size, numSlots;
+	double numBytes, numChunks = 1;
+	float preemption;
+	nc_type type;
+
+	if (nc_inq_format(ncid, &format) != NC_NOERR || (format != NC_FORMAT_NETCDF4 && format != NC_FORMAT_NETCDF4_CLASSIC))
+		return;
+	if (nc_inq_varndims(ncid, varid, &numDims) != NC_NOERR || numDims < 3 ||
+		nc_inq_var_chunking(ncid, varid, &storage, chunks) != NC_NOERR || storage != NC_CHUNKED || chunks[0] <= 1)
+		return;	// a chunk holds a single time, each is read once anyway
+	if (nc_inq_vardimid(ncid, varid, dimIDs) != NC_NOERR || nc_inq_vartype(ncid, varid, &type) != NC_NOERR ||
+		nc_inq_type(ncid, type, 0, &typeSize) != NC_NOERR)
+		return;
+
+	numBytes = typeSize * (double)chunks[0];
+	for (int i = 1; i < numDims; i++) {
+		if (nc_inq_dimlen(ncid, dimIDs[i], &dimLen) != NC_NOERR || !chunks[i])
+			return;
+		numBytes *= chunks[i];
+		numChunks *= (dimLen + chunks[i] - 1) / chunks[i];
+	}
+	numBytes *= numChunks;
+	if (numBytes > kMaxChunkCacheBytes)
+		return;	// too big to keep, left as it is
+
+	if (nc_get_var_chunk_cache(ncid, varid, &size, &numSlots, &preemption) != NC_NOERR || size >= numBytes)
+		return;
+	// HDF5 wants many more hash slots than chunks, and a prime number of them
+	if (numSlots < numChunks * 10) numSlots = (size_t)numChunks * 10;
+	for (numSlots |= 1; !IsPrime(numSlots); numSlots += 2) {}
+	nc_set_var_chunk_cache(ncid, varid, (size_t)numBytes, numSlots, preemption);
+}
+
+// ids are looked up once per open dataset, a missing name is remembered as
+// a negative id so the fallback names aren't retried either. A variable's
+// chunk cache is sized when it is first looked up
+static int InqCachedID(vector<pair<string, int> > &ids, int ncid, const char *name, int *id, bool isVar)
+{
+	int status;
+
+	for (size_t i = 0; i < ids.size(); i++) {
+		if (ids[i].first == name) {
+			if (ids[i].second < 0)
+				return isVar ? NC_ENOTVAR : NC_EBADDIM;
+			*id = ids[i].second;
+			return NC_NOERR;
+		}
+	}
+
+	status = isVar ? nc_inq_varid(ncid, name, id) : nc_inq_dimid(ncid, name, id);
+	ids.push_back(make_pair(string(name), status == NC_NOERR ? *id : -1));
+	if (isVar && status == NC_NOERR)
+		SizeChunkCache(ncid, *id);
+
+	return status;
+}
+
+int TimeGridVel_c::InqVarID(int ncid, const char *name, int *varid)
+{
+	if (ncid != fNcid)
+		return nc_inq_varid(ncid, name, varid);
+
+	return InqCachedID(fNcVarIDs, ncid, name, varid, true);
+}
+
+int TimeGridVel_c::InqDimID(int ncid, const char *name, int *dimid)
+{
+	if (ncid != fNcid)
+		return nc_inq_dimid(ncid, name, dimid);
+
+	return InqCachedID(fNcDimIDs, ncid, name, dimid, false);
+}
+
+// grids of the same class and size decode a file the same way
+void TimeGridVel_c::GetWholeGridSliceVariable(char *variable)
+{
+	sprintf(variable, "%s %ld %ld", typeid(*this).name(), fNumRows, fNumCols);
+	if (fReadSinglePrecision)
+		strcat(variable, " float");
+}
+
+// windowed slices only match grids reading the same window
+void TimeGridVel_c::GetTimeSliceVariable(char *variable)
+{
+	long window[4];
+
+	GetWholeGridSliceVariable(variable);
+	if (GetSliceWindow(window))
+		sprintf(variable + strlen(variable), " [%ld %ld %ld %ld]", window[0], window[1], window[2], window[3]);
+}
+
+OSErr TimeGridVel_c::ReadTimeSlice(long index, VelocityFH *velocityH, char *errmsg)
+{
+	char variable[256];
+	long window[4];
+	double fileScaleFactor, fillValue;
+
+	if (GetNumForcingFiles() > 0 && fTimeHdl && index >= 0 && index < GetNumTimesInFile())
+	{
+		GetWholeGridSliceVariable(variable);
+		if (ReadForcingSlice(fVar.pathName, variable, index, (*fTimeHdl)[index], GetSliceWindow(window) ? window : 0,
+							 velocityH, &fileScaleFactor, &fillValue) == noErr)
+		{
+			fFillValue = fillValue;
+			if (fileScaleFactor != 1.) fVar.fileScaleFactor = fileScaleFactor;
+			return noErr;
+		}
+	}
+
+	return this -> ReadTimeData(index, velocityH, errmsg);
+}
+
+static OSErr ReadForcingSource(void *owner, long index, VelocityFH *velocityH, char *errmsg)
+{
+	return ((TimeGridVel_c *)owner) -> ReadTimeData(index, velocityH, errmsg);
+}
+
+OSErr TimeGridVel_c::WriteForcingFile(const char *path, char *errmsg)
+{
+	ForcingFileInfo info;
+	char variable[256];
+	long window[4];
+
+	errmsg[0] = 0;
+	if (GetSliceWindow(window)) {
+		strcpy(errmsg, "A forcing file is written from the whole grid, not an active window");
+		return -1;
+	}
+
+	FinishPrefetch();	// before the lock, the prefetch holds it
+	GnomeLock fileLock(GnomeFileIOMutex());
+
+	GetWholeGridSliceVariable(variable);
+	memset(&info, 0, sizeof(info));
+	info.sourcePath = fVar.pathName;
+	info.variable = variable;
+	info.numRows = fNumRows;
+	info.numCols = fNumCols;
+	info.timeH = fTimeHdl;
+	info.fileScaleFactor = &fVar.fileScaleFactor;
+	info.fillValue = &fFillValue;
+	GetForcingTopology(&info);
+
+	return ::WriteForcingFile(path, info, ReadForcingSource, this, errmsg);
+}
+
+// read a time into data, or share it with another grid that already has it
+OSErr TimeGridVel_c::LoadTimeData(long index, LoadedData *data, char *errmsg)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	OSErr err = 0;
+	char variable[256];
+
+	// a cycle mover goes around the same patterns, so they are read only the first time
+	if (KeepsCycleFrames() && index >= 0 && index < GetNumTimesInFile())
+	{
+		if (fCycleFrames.size() != (size_t)GetNumTimesInFile())
+		{
+			DisposeCycleFrames();
+			fCycleFrames.resize(GetNumTimesInFile(), 0);
+		}
+		if (!fCycleFrames[index])
+		{
+			err = this -> ReadTimeSlice(index, &fCycleFrames[index], errmsg);
+			if (err)
+				return err;
+			ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fCycleFrames[index]));
+		}
+		data->dataHdl = fCycleFrames[index];
+		data->timeIndex = index;
+		return noErr;
+	}
+
+	GetTimeSliceVariable(variable);
+
+	data->dataHdl = AcquireTimeSlice(fVar.pathName, variable, index);
+	CountForcingIO(fVar.pathName, data->dataHdl ? kIOSliceHits : kIOSliceMisses);
+	if (!data->dataHdl) {
+		err = this -> ReadTimeSlice(index, &data->dataHdl, errmsg);
+		if (err)
+			return err;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)data->dataHdl));
+		AddTimeSlice(fVar.pathName, variable, index, data->dataHdl);
+	}
+	data->timeIndex = index;
+
+	return noErr;
+}
+
+// read the time after the loaded interval on a background thread so the
+// SetInterval that crosses into it doesn't wait on the file
+void TimeGridVel_c::StartPrefetch()
+{
+#ifdef GNOME_PREFETCH
+	long nextIndex = fEndData.timeIndex + 1;
+	char variable[256];
+
+	if (!fPrefetchNextTime || fPrefetchThread)
+		return;
+
+	if (KeepsCycleFrames())
+		return;	// LoadTimeData keeps the patterns once they are read
+
+	// constant or extrapolated, or the next time is in another file
+	if (fEndData.timeIndex == UNASSIGNEDINDEX || nextIndex >= GetNumTimesInFile())
+		return;
+
+	if (fPrefetchData.dataHdl && fPrefetchData.timeIndex == nextIndex && !strcmp(fPrefetchPath, fVar.pathName))
+		return;	// already have it
+
+	GetTimeSliceVariable(variable);
+	if (HasTimeSlice(fVar.pathName, variable, nextIndex))
+		return;	// another grid has read it
+
+	DisposePrefetchData();
+	fPrefetchData.timeIndex = nextIndex;
+	fPrefetchErr = 0;
+	strcpy(fPrefetchPath, fVar.pathName);
+
+	try {
+		fPrefetchThread = new std::thread(PrefetchTimeData, this, nextIndex);
+		CountForcingIO(fPrefetchPath, kIOPrefetches);
+	}
+	catch (...) {
+		fPrefetchThread = 0;	// no thread, SetInterval will read it when needed
+		ClearLoadedData(&fPrefetchData);
+	}
+#endif
+}
+
+// a prefetched time thrown away before a SetInterval used it
+void TimeGridVel_c::DisposePrefetchData()
+{
+	if (!fPrefetchData.dataHdl)
+		return;
+
+	CountForcingIO(fPrefetchPath, kIOPrefetchesWasted);
+	DisposeLoadedData(&fPrefetchData);
+}
+
+void TimeGridVel_c::FinishPrefetch()
+{
+#ifdef GNOME_PREFETCH
+	int64_t waitStart;
+
+	if (!fPrefetchThread)
+		return;
+
+	waitStart = ForcingIOClock();
+	fPrefetchThread->join();
+	CountForcingIO(fPrefetchPath, kIOPrefetchWaitNanoseconds, ForcingIOClock() - waitStart);
+	delete fPrefetchThread;
+	fPrefetchThread = 0;
+
+	// SetInterval reads it again and reports the error
+	if (fPrefetchErr)
+		DisposeLoadedData(&fPrefetchData);
+#endif
+}
+
+OSErr TimeGridVel_c::SetInterval(GnomeError &error, const Seconds& model_time)
+{
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
+	long timeDataInterval = 0;
+
+	if (this->CheckInterval(timeDataInterval, model_time)) {
+		KeepLoadedInterval();
+		return noErr;
+	}
+
+	char errmsg[256];
+	OSErr err = SetInterval(errmsg, model_time);
+
+	if (err)
+		error.Set(err, "TimeGridVel::SetInterval", model_time, errmsg);
+	return err;
+}
+
+OSErr TimeGridVel_c::SetInterval(char *errmsg, const Seconds& model_time)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
+	OSErr err = 0;
+
+	long timeDataInterval = 0;
+	Boolean intervalLoaded = this->CheckInterval(timeDataInterval, model_time);
+	long indexOfStart = timeDataInterval - 1;
+	long indexOfEnd = timeDataInterval;
+	long numTimesInFile = this->GetNumTimesInFile();
+
+	errmsg[0] = 0;
+
+	if (intervalLoaded) {
+		StartPrefetch();
+		return 0;
+	}
+
+	FinishPrefetch();
+	fInterpolatedValid = false;
+	GnomeLock fileLock(GnomeFileIOMutex());
+
+	// check for constant current 
+	if (numTimesInFile == 1 && !(GetNumFiles() > 1))
+		//or if(timeDataInterval==-1)
+	{
+		indexOfStart = 0;
+		indexOfEnd = UNASSIGNEDINDEX;	// should already be -1
+	}
+
+	if (timeDataInterval == 0 && fAllowExtrapolationInTime) {
+		indexOfStart = 0;
+		indexOfEnd = -1;
+	}
+
+	//cerr << "timeDataInterval: " << timeDataInterval << endl;
+	if (timeDataInterval == 0 || timeDataInterval == numTimesInFile)
+	{
+
+		//cerr << "GetNumFiles(): " << GetNumFiles() << endl;
+		// before the first step in the file
+		if (GetNumFiles() > 1) {
+			if ((err = CheckAndScanFile(errmsg, model_time)) || fOverLap)
+				goto done;
+			
+			intervalLoaded = this->CheckInterval(timeDataInterval, model_time);
+			
+			indexOfStart = timeDataInterval - 1;
+			indexOfEnd = timeDataInterval;
+			numTimesInFile = this->GetNumTimesInFile();
+			if (fAllowExtrapolationInTime &&
+				(timeDataInterval == numTimesInFile || timeDataInterval == 0))
+			{
+				if (intervalLoaded)
+					return 0;
+				indexOfEnd = -1;
+				if (timeDataInterval == 0)
+					indexOfStart = 0;	// if we allow extrapolation we need to load the first time
+			}
+		}
+		else {
+			if(fTimeAlpha>=0 && timeDataInterval == numTimesInFile)
+				indexOfEnd = 0;	// start over
+			else if (fAllowExtrapolationInTime && timeDataInterval == numTimesInFile) {
+				fStartData.timeIndex = numTimesInFile-1;//check if time > last model time in all files
+				fEndData.timeIndex = UNASSIGNEDINDEX;//check if time > last model time in all files
+			}
+			else if (fAllowExtrapolationInTime && timeDataInterval == 0) {
+				fStartData.timeIndex = 0;//check if time > last model time in all files
+				fEndData.timeIndex = UNASSIGNEDINDEX;//check if time > last model time in all files
+			}
+			else {
+				err = -1;
+				strcpy(errmsg,"Time outside of interval being modeled");
+				goto done;
+			}
+		}
+		// code goes here, if time > last time in files allow user to continue
+		// leave last two times loaded? move last time to start and nothing for end?
+		// redefine as constant or just check if time > last time and some flag set
+		// careful with timeAlpha, really just want to use the last time but needs to be loaded
+		// want to check so that don't reload at every step, should recognize last time is ok
+	}
+	//else // load the two intervals
+	{
+		DisposeLoadedData(&fStartData);
+		
+		if(indexOfStart == fEndData.timeIndex) // passing into next interval
+		{
+			fStartData = fEndData;
+			ClearLoadedData(&fEndData);
+		}
+		else
+		{
+			DisposeLoadedData(&fEndData);
+		}
+		
+		//////////////////
+		
+		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
+		{ // start data is not loaded
+			err = this -> LoadTimeData(indexOfStart,&fStartData,errmsg);
+			if(err) goto done;
+		}	
+		
+		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
+		{
+			if(fPrefetchData.dataHdl && fPrefetchData.timeIndex == indexOfEnd && !strcmp(fPrefetchPath, fVar.pathName))
+			{
+				char variable[256];
+				GetTimeSliceVariable(variable);
+				AddTimeSlice(fVar.pathName, variable, indexOfEnd, fPrefetchData.dataHdl);
+				ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fPrefetchData.dataHdl));
+				CountForcingIO(fPrefetchPath, kIOPrefetchesUsed);
+				fEndData = fPrefetchData;
+				ClearLoadedData(&fPrefetchData);
+			}
+			else
+			{
+				err = this -> LoadTimeData(indexOfEnd,&fEndData,errmsg);
+				if(err) goto done;
+			}
+		}
+	}
+	
+done:	
+	if(err)
+	{
+		if(!errmsg[0])strcpy(errmsg,"Error in TimeGridVel::SetInterval()");
+		DisposeLoadedData(&fStartData);
+		DisposeLoadedData(&fEndData);
+	}
+	else
+		StartPrefetch();
+	return err;
+	
+}
+
+
+OSErr TimeGridVel_c::CheckAndScanFile(char *errmsg, const Seconds& model_time)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	OSErr err = 0;
+	Seconds time = model_time, startTime, endTime, lastEndTime, testTime, firstStartTime; 
+	
+	long i, numFiles = GetNumFiles();
+
+	errmsg[0] = 0;
+
+	if (fEndData.timeIndex!=UNASSIGNEDINDEX)
+		testTime = (*fTimeHdl)[fEndData.timeIndex];	// currently loaded end time
+	
+	firstStartTime = (*fInputFilesHdl)[0].startTime + fTimeShift;
+	for (i = 0; i < numFiles; i++)
+	{
+		startTime = (*fInputFilesHdl)[i].startTime + fTimeShift;
+		endTime = (*fInputFilesHdl)[i].endTime + fTimeShift;
+		if (startTime<=time&&time<=endTime && !(startTime==endTime))
+		{
+			//if(fTimeHdl) {DisposeHandle((Handle)fTimeHdl); fTimeHdl=0;}
+			DisposeTimeHdl();
+			err = ScanFileForTimes((*fInputFilesHdl)[i].pathName,&fTimeHdl);	
+			
+			// code goes here, check that start/end times match
+			strcpy(fVar.pathName,(*fInputFilesHdl)[i].pathName);
+			fOverLap = false;
+			return err;
 		}
 		if (startTime==endTime && startTime==time)	// one time in file, need to overlap
 		{
@@ -1559,13 +2252,91 @@ long TimeGridVelRect_c::GetNumDepths(void)
 	return numDepths;
 }
 
+double TimeGridVelRect_c::GetTimeAlpha(const Seconds& model_time)
+{
+	Seconds startTime, endTime;
+
+	if (GetNumFiles()>1 && fOverLap)
+		startTime = fOverLapStartTime + fTimeShift;
+	else
+		startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
+	endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
+
+	return (endTime - model_time)/(double)(endTime - startTime);
+}
+
+void TimeGridVelRect_c::SetInterpolatedFieldMode(bool useField)
+{
+	fUseInterpolatedField = useField;
+	if (!useField)
+		DisposeInterpolatedField();
+}
+
+// blend the loaded start and end times at model_time, using the same
+// expression as the per LE code so the velocities come out identical
+OSErr TimeGridVelRect_c::PrepareInterpolatedField(const Seconds& model_time)
+{
+	double timeAlpha;
+	long i, numValues;
+
+	if (!fUseInterpolatedField || !fStartData.dataHdl || !fEndData.dataHdl || fEndData.timeIndex == UNASSIGNEDINDEX)
+	{
+		fInterpolatedValid = false;
+		return 0;
+	}
+
+	timeAlpha = GetTimeAlpha(model_time);
+	if (UseInterpolatedField(timeAlpha))
+		return 0;
+
+	numValues = _GetHandleSize((Handle)fStartData.dataHdl)/sizeof(**fStartData.dataHdl);
+	if (numValues != _GetHandleSize((Handle)fEndData.dataHdl)/sizeof(**fEndData.dataHdl))
+	{
+		fInterpolatedValid = false;
+		return 0;
+	}
+
+	if (!fInterpolatedH || _GetHandleSize((Handle)fInterpolatedH) != numValues*(long)sizeof(VelocityRec))
+	{
+		DisposeInterpolatedField();
+		fInterpolatedH = (VelocityH)_NewHandleClear(numValues*sizeof(VelocityRec));
+		if (!fInterpolatedH) {TechError("TimeGridVelRect_c::PrepareInterpolatedField()", "_NewHandleClear()", 0); return memFullErr;}
+	}
+
+	for (i = 0; i < numValues; i++)
+	{
+		INDEXH(fInterpolatedH,i).u = timeAlpha*INDEXH(fStartData.dataHdl,i).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,i).u;
+		INDEXH(fInterpolatedH,i).v = timeAlpha*INDEXH(fStartData.dataHdl,i).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,i).v;
+	}
+
+	fInterpolatedAlpha = timeAlpha;
+	fInterpolatedValid = true;
+
+	return 0;
+}
+
+// the grid bounds are the outer edges of the cells, so the cells are the bounds
+// split in fNumCols by fNumRows. The shorter side is the size
+double TimeGridVelRect_c::GetCellSize(WorldPoint3D p, long *triHint)
+{
+	double dx, dy;
+
+	if (fNumCols <= 0 || fNumRows <= 0)
+		return 0;
+
+	dx = (fGridBounds.hiLong - fGridBounds.loLong) / 1000000. / fNumCols * METERSPERDEGREELAT * LongToLatRatio3(p.p.pLat);
+	dy = (fGridBounds.hiLat - fGridBounds.loLat) / 1000000. / fNumRows * METERSPERDEGREELAT;
+
+	return dx < dy ? dx : dy;
+}
+
 VelocityRec TimeGridVelRect_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint)
 {	// pull out the getpatval part
 	double timeAlpha, depthAlpha;
 	float topDepth, bottomDepth;
 	long index;
 	long depthIndex1,depthIndex2;	// default to -1?
-	Seconds startTime,endTime;
+	Boolean useField = false;
 	char errmsg[256];
 
 	VelocityRec	scaledPatVelocity = {0.,0.};
@@ -1603,7 +2374,7 @@ VelocityRec TimeGridVelRect_c::GetScaledPatValue(const Seconds& model_time, Worl
 	if((GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || (fEndData.timeIndex == UNASSIGNEDINDEX && model_time > ((*fTimeHdl)[fStartData.timeIndex] + fTimeShift) && fAllowExtrapolationInTime) || (fEndData.timeIndex == UNASSIGNEDINDEX && model_time < ((*fTimeHdl)[fStartData.timeIndex] + fTimeShift) && fAllowExtrapolationInTime))
 	{
 		// Calculate the interpolated velocity at the point
-		if (index >= 0)
+		if (index >= 0 && depthIndex1 >= 0)	// none below the levels
 		{
 			if(depthIndex2==UNASSIGNEDINDEX) // surface velocity or special cases
 			{
@@ -1625,27 +2396,23 @@ VelocityRec TimeGridVelRect_c::GetScaledPatValue(const Seconds& model_time, Worl
 	else // time varying current 
 	{
 		// Calculate the time weight factor
-		if (GetNumFiles()>1 && fOverLap)
-			startTime = fOverLapStartTime + fTimeShift;
-		else
-			startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
-		endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
-		timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
+		timeAlpha = GetTimeAlpha(model_time);
+		useField = UseInterpolatedField(timeAlpha);
 		
 		// Calculate the interpolated velocity at the point
-		if (index >= 0) 
+		if (index >= 0 && depthIndex1 >= 0) 
 		{
 			if(depthIndex2==UNASSIGNEDINDEX) // surface velocity or special cases
 			{
-				scaledPatVelocity.u = timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u;
-				scaledPatVelocity.v = timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v;
+				scaledPatVelocity.u = (useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u);
+				scaledPatVelocity.v = (useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v);
 			}
 			else	// below surface velocity
 			{
-				scaledPatVelocity.u = depthAlpha*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u);
-				scaledPatVelocity.u += (1-depthAlpha)*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u);
-				scaledPatVelocity.v = depthAlpha*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v);
-				scaledPatVelocity.v += (1-depthAlpha)*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v);
+				scaledPatVelocity.u = depthAlpha*((useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u));
+				scaledPatVelocity.u += (1-depthAlpha)*((useField ? INDEXH(fInterpolatedH,index+depthIndex2*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u));
+				scaledPatVelocity.v = depthAlpha*((useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v));
+				scaledPatVelocity.v += (1-depthAlpha)*((useField ? INDEXH(fInterpolatedH,index+depthIndex2*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v));
 			}
 		}
 		else	// set vel to zero
@@ -1666,6 +2433,73 @@ scale:
 	return scaledPatVelocity;
 }
 
+// the batch of GetScaledPatValue, reading the field through its view
+void TimeGridVelRect_c::GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+{
+	Boolean constantField;
+	TimeGridFieldView view;
+
+	if (!fStartData.dataHdl || n <= 0)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	constantField = IsConstantField(model_time);
+	view = GetFieldView(constantField, constantField ? 1 : GetTimeAlpha(model_time));
+	if (!view.start)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	TIME_SECTION(&fTiming, kTimerInterpolate, n);	// location included
+	if (view.TimeVarying())
+		GetRectValues<true>(n, refPoints, view, vel);
+	else
+		GetRectValues<false>(n, refPoints, view, vel);
+}
+
+template <bool timeVarying>
+void TimeGridVelRect_c::GetRectValues(long n, const WorldPoint3D *refPoints, const TimeGridFieldView &view, VelocityRec *vel)
+{
+	long i, index, depthIndex1, depthIndex2;
+	float topDepth, bottomDepth;
+	double depthAlpha = 1;
+
+	for (i = 0; i < n; i++)
+	{
+		vel[i].u = 0.;
+		vel[i].v = 0.;
+
+		index = TimeGridVel_c::GetVelocityIndex(refPoints[i].p);  // regular grid
+
+		if (refPoints[i].z>0 && fVar.gridType==TWO_D)
+		{
+			if (!fAllowVerticalExtrapolationOfCurrents)
+				continue;
+#ifndef pyGNOME
+			if (fMaxDepthForExtrapolation < refPoints[i].z)
+				continue;
+#endif
+		}
+
+		GetDepthIndices(0,refPoints[i].z,&depthIndex1,&depthIndex2);
+		if (depthIndex2!=UNASSIGNEDINDEX)
+		{
+			topDepth = INDEXH(fDepthLevelsHdl,depthIndex1);
+			bottomDepth = INDEXH(fDepthLevelsHdl,depthIndex2);
+			depthAlpha = (bottomDepth - refPoints[i].z)/(double)(bottomDepth - topDepth);
+		}
+
+		if (index >= 0 && depthIndex1 >= 0)
+			vel[i] = view.Velocity<timeVarying>(index, depthIndex1, depthIndex2, depthAlpha);
+
+		vel[i].u *= view.scale;
+		vel[i].v *= view.scale;
+	}
+}
+
 Seconds TimeGridVel_c::GetTimeValue(long index)
 {
 	if (index<0) printError("Access violation in TimeGridVel_c::GetTimeValue()");
@@ -1831,6 +2665,9 @@ OSErr TimeGridVel_c::GetFileStartTime(Seconds *startTime)
 	
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
+
+	if (GetIndexedFileTimes(path, startTime, 0))
+		return noErr;
 	
 	status = nc_open(path, NC_NOWRITE, &ncid);
 	if (status != NC_NOERR) {
@@ -1954,6 +2791,9 @@ OSErr TimeGridVel_c::GetFileEndTime(Seconds *endTime)
 	
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
+
+	if (GetIndexedFileTimes(path, 0, endTime))
+		return noErr;
 	
 	status = nc_open(path, NC_NOWRITE, &ncid);
 	if (status != NC_NOERR) {
@@ -2080,33 +2920,127 @@ OSErr TimeGridVel_c::GetDataStartTime(Seconds *startTime)
 			err = -1;
 		
 	}
-
-	return err;
+
+	return err;
+}
+
+OSErr TimeGridVel_c::GetDataEndTime(Seconds *endTime)
+{
+	OSErr err = 0;
+	*endTime = 0;
+	long numTimesInFile = GetNumTimesInFile();
+
+	if (GetNumFiles()>1)
+	{
+		*endTime = (*fInputFilesHdl)[GetNumFiles()-1].endTime + fTimeShift;				
+		return err;
+	}
+	else
+	{
+		if (numTimesInFile>0)
+		{
+			err = GetFileEndTime(endTime);
+			return err;
+		}
+		else
+			err = -1;
+	}
+
+	return err;
+}
+
+// the depth of a ROMS s-coordinate level, the way the level scans work it out
+static inline float RomsLevelDepth(float totalDepth, float hc, float sc_r, float Cs_r)
+{
+	return fabs(totalDepth*(hc*sc_r+totalDepth*Cs_r))/(totalDepth+hc);
+}
+
+// the depth of level k, with k = 0 the top level
+struct DepthLevels {
+	const float *depths;
+	DepthLevels(const float *d) : depths(d) {}
+	float operator()(long k) const {return depths[k];}
+};
+
+struct SigmaDepthLevels {
+	const float *sigma;
+	float totalDepth;
+	SigmaDepthLevels(const float *s, float t) : sigma(s), totalDepth(t) {}
+	float operator()(long k) const {return sigma[k] * totalDepth;}
+};
+
+// the ROMS levels are stored bottom up, turned over here so k = 0 is the top
+struct RomsDepthLevels {
+	const float *sc_r, *Cs_r;
+	float totalDepth, hc;
+	long last;
+	RomsDepthLevels(const float *s, const float *c, float t, float h, long n) : sc_r(s), Cs_r(c), totalDepth(t), hc(h), last(n-1) {}
+	float operator()(long k) const {return RomsLevelDepth(totalDepth,hc,sc_r[last-k],Cs_r[last-k]);}
+};
+
+// for n > 1 levels that never get shallower, gives the level the scans in
+// GetDepthIndices stop at: the levels k1, k2 = k1+1 around depth, or k1 = 0
+// alone when depth is on the top level. false when the scan would find neither
+template <class Levels>
+static Boolean BisectDepthLevels(const Levels &levels, long n, float depth, long *k1, long *k2)
+{
+	long lo = 0, hi = n, mid;
+	
+	while (lo < hi)
+	{	// first level at or below depth
+		mid = (lo + hi) / 2;
+		if (levels(mid) < depth) lo = mid + 1;
+		else hi = mid;
+	}
+	if (lo > 0 && lo < n)
+	{
+		*k1 = lo - 1;
+		*k2 = lo;
+		return true;
+	}
+	if (lo == 0 && levels(0) == depth)
+	{
+		*k1 = 0;
+		*k2 = UNASSIGNEDINDEX;
+		return true;
+	}
+	return false;
 }
 
-OSErr TimeGridVel_c::GetDataEndTime(Seconds *endTime)
+// BisectDepthLevels for the levels of a node of a triangle grid, giving
+// what the scans in their GetDepthIndices keep: their last match, so a
+// level on the depth (other than the bottom) beats the pair above it
+static Boolean BisectNodeLevels(const float *depths, long n, float depth, long *k1, long *k2)
 {
-	OSErr err = 0;
-	*endTime = 0;
-	long numTimesInFile = GetNumTimesInFile();
+	DepthLevels levels(depths);
 
-	if (GetNumFiles()>1)
+	if (!BisectDepthLevels(levels,n,depth,k1,k2))
+		return false;
+
+	if (*k2 != UNASSIGNEDINDEX && *k2 < n-1 && levels(*k2) == depth)
 	{
-		*endTime = (*fInputFilesHdl)[GetNumFiles()-1].endTime + fTimeShift;				
-		return err;
+		for (*k1 = *k2; *k1 < n-2 && levels(*k1+1) == depth; (*k1)++);
+		*k2 = UNASSIGNEDINDEX;
 	}
-	else
+	return true;
+}
+
+void TimeGridVelRect_c::SetDepthLevelOrder()
+{
+	long i, n = GetNumDepthLevelsInFile(), n2 = 0;
+	
+	fDepthLevelsAscending = n > 1;
+	for (i = 0; fDepthLevelsAscending && i < n-1; i++)
+		if (!(INDEXH(fDepthLevelsHdl,i) <= INDEXH(fDepthLevelsHdl,i+1))) fDepthLevelsAscending = false;
+	
+	// then the level depths never get shallower from the bottom up for any total depth
+	if (fDepthLevelsHdl2) n2 = _GetHandleSize((Handle)fDepthLevelsHdl2)/sizeof(**fDepthLevelsHdl2);
+	fRomsLevelsAscending = fDepthLevelsAscending && n2 >= n && hc >= 0;
+	for (i = 0; fRomsLevelsAscending && i < n; i++)
 	{
-		if (numTimesInFile>0)
-		{
-			err = GetFileEndTime(endTime);
-			return err;
-		}
-		else
-			err = -1;
+		if (!(INDEXH(fDepthLevelsHdl,i) <= 0 && INDEXH(fDepthLevelsHdl2,i) <= 0)) fRomsLevelsAscending = false;
+		else if (i < n-1 && !(INDEXH(fDepthLevelsHdl2,i) <= INDEXH(fDepthLevelsHdl2,i+1))) fRomsLevelsAscending = false;
 	}
-
-	return err;
 }
 
 double TimeGridVelRect_c::GetDepthAtIndex(long depthIndex, double totalDepth)
@@ -2177,8 +3111,20 @@ void TimeGridVelRect_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *
 
 	if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 	{
-		long j;
-		for(j=0;j<numDepthLevels-1;j++)
+		long j, k1, k2;
+		Boolean inOrder = fDepthLevelsAscending && numDepthLevels > 1;
+		DepthLevels levels(*fDepthLevelsHdl);
+		if (inOrder && BisectDepthLevels(levels,numDepthLevels,depthAtPoint,&k1,&k2))
+		{	// the scan keeps its last match, so a level on the depth (other than the bottom) beats the pair above it
+			if (k2 != UNASSIGNEDINDEX && k2 < numDepthLevels-1 && levels(k2) == depthAtPoint)
+			{
+				for (k1 = k2; k1 < numDepthLevels-2 && levels(k1+1) == depthAtPoint; k1++);
+				k2 = UNASSIGNEDINDEX;
+			}
+			*depthIndex1 = indexToDepthData+k1;
+			*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+		}
+		for(j=0;!inOrder && j<numDepthLevels-1;j++)
 		{
 			if(INDEXH(fDepthLevelsHdl,indexToDepthData+j)<depthAtPoint &&
 			   depthAtPoint<=INDEXH(fDepthLevelsHdl,indexToDepthData+j+1))
@@ -2221,6 +3167,8 @@ TimeGridVelRect_c::TimeGridVelRect_c () : TimeGridVel_c()
 	fDepthLevelsHdl = 0;	// depth level, sigma, or sc_r
 	fDepthLevelsHdl2 = 0;	// Cs_r
 	hc = 1.;	// what default?
+	fDepthLevelsAscending = false;
+	fRomsLevelsAscending = false;
 	
 	memset(&fStartData,0,sizeof(fStartData));
 	fStartData.timeIndex = UNASSIGNEDINDEX; 
@@ -2234,6 +3182,11 @@ TimeGridVelRect_c::TimeGridVelRect_c () : TimeGridVel_c()
 	
 	fNumDepthLevels = 1;	// default surface current only
 	
+	fUseActiveWindow = false;
+	fActiveWindowHalo = 10;
+	fWindowRowStart = fWindowRowEnd = 0;
+	fWindowColStart = fWindowColEnd = 0;
+	
 	//fAllowVerticalExtrapolationOfCurrents = false;
 	//fMaxDepthForExtrapolation = 0.;	// assume 2D is just surface
 	
@@ -2244,6 +3197,8 @@ TimeGridVelRect_c::TimeGridVelRect_c () : TimeGridVel_c()
 void TimeGridVelRect_c::Dispose ()
 {
 	if(fDepthLevelsHdl) {DisposeHandle((Handle)fDepthLevelsHdl); fDepthLevelsHdl=0;}
+	fDepthLevelsAscending = false;
+	fRomsLevelsAscending = false;
 	
 	if(fDepthsH) {DisposeHandle((Handle)fDepthsH); fDepthsH=0;}
 	if(fDepthDataInfo) {DisposeHandle((Handle)fDepthDataInfo); fDepthDataInfo=0;}
@@ -2258,8 +3213,20 @@ TimeGridVelCurv_c::TimeGridVelCurv_c () : TimeGridVelRect_c()
 	fVertexPtsH = 0;
 	fGridCellInfoH = 0;
 	fCenterPtsH = 0;
+	fCellCacheTopH = 0;
 	//bIsCOOPSWaterMask = false;
 	bVelocitiesOnNodes = false;	// eventually switch to assuming all data is on nodes
+	fBinLEsByCell = false;
+	fWaterNodeLayout = false;
+	fTopologyCacheKey = 0;
+	fUseNearestNode = false;
+	fNearestNodeIndex = 0;
+	fCellLocator = 0;
+	fCellLocatorGrid = 0;
+	fCellLocatorTriGrid = 0;
+	fCellLocatorTopH = 0;
+	fCellLocatorMapH = 0;
+	fCellLocatorCols = 0;
 }	
 
 void TimeGridVelCurv_c::Dispose ()
@@ -2268,10 +3235,157 @@ void TimeGridVelCurv_c::Dispose ()
 	if(fVertexPtsH) {DisposeHandle((Handle)fVertexPtsH); fVertexPtsH=0;}
 	if(fGridCellInfoH) {DisposeHandle((Handle)fGridCellInfoH); fGridCellInfoH=0;}
 	if(fCenterPtsH) {DisposeHandle((Handle)fCenterPtsH); fCenterPtsH=0;}
+	fCellCacheTopH = 0;
+	if(fNearestNodeIndex) {delete fNearestNodeIndex; fNearestNodeIndex=0;}
+	if(fCellLocator) {delete fCellLocator; fCellLocator=0;}
+	fCellLocatorGrid = 0;
+	fCellLocatorTriGrid = 0;
+	fCellLocatorTopH = 0;
+	fCellLocatorMapH = 0;
 	
 	TimeGridVelRect_c::Dispose ();
 }
 
+void TimeGridVelCurv_c::SetWaterNodeLayout(bool waterNodes)
+{
+	if (fWaterNodeLayout == (Boolean)waterNodes) return;
+	fWaterNodeLayout = waterNodes;
+	DisposeAllLoadedData();	// read again in the other layout on the next SetInterval
+}
+
+// the layout is kept for 2D velocities on the nodes, the rest read the whole grid
+Boolean TimeGridVelCurv_c::UsesWaterNodeLayout()
+{
+	long amtOfDepthData = 0;
+
+	if (fDepthDataInfo) amtOfDepthData = _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo);
+	return fWaterNodeLayout && bVelocitiesOnNodes && fVerdatToNetCDFH && amtOfDepthData == 0 && fVar.maxNumDepths <= 1;
+}
+
+void TimeGridVelCurv_c::SetNearestNodeMode(bool nearestNode)
+{
+	fUseNearestNode = nearestNode;
+	BuildNearestNodeIndex();
+}
+
+// the index is kept for 2D velocities on the nodes, LEs off other grids stay at zero
+void TimeGridVelCurv_c::BuildNearestNodeIndex()
+{
+	long amtOfDepthData = 0;
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+
+	if (fNearestNodeIndex) {delete fNearestNodeIndex; fNearestNodeIndex = 0;}
+
+	if (fDepthDataInfo) amtOfDepthData = _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo);
+	if (!fUseNearestNode || !bVelocitiesOnNodes || !triGrid || !fVerdatToNetCDFH || amtOfDepthData > 0)
+		return;
+
+	fNearestNodeIndex = new NearestNodeIndex();
+	if (fNearestNodeIndex->Build(triGrid->GetPointsHdl(), fVerdatToNetCDFH))
+		{delete fNearestNodeIndex; fNearestNodeIndex = 0;}
+}
+
+// the interpolation taking all of its velocity from the water node nearest p.
+// triHint keeps the node as -(node + 2) for the LE's next step
+Boolean TimeGridVelCurv_c::GetNearestNodeValues(WorldPoint p, long *triHint, InterpolationValBilinear *interpolationVal)
+{
+	LongPoint lp;
+	long node, hint = -1;
+
+	if (!fNearestNodeIndex) return false;
+
+	lp.h = p.pLong;
+	lp.v = p.pLat;
+	if (triHint && *triHint <= -2) hint = -*triHint - 2;
+	node = fNearestNodeIndex->Nearest(lp, hint);
+	if (node < 0) return false;
+	if (triHint) *triHint = -(node + 2);
+
+	interpolationVal->ptIndex1 = interpolationVal->ptIndex2 = node;
+	interpolationVal->ptIndex3 = interpolationVal->ptIndex4 = node;
+	interpolationVal->alpha1 = 1;
+	interpolationVal->alpha2 = interpolationVal->alpha3 = interpolationVal->alpha4 = 0;
+	return true;
+}
+
+// keyed on the grid, its topology and point map as GetScaledPatValue uses them
+CurvCellLocator* TimeGridVelCurv_c::GetCellLocator()
+{
+	long numCols_ext = bVelocitiesOnNodes ? fNumCols : fNumCols+1;
+
+	if (fGrid == fCellLocatorGrid && fVerdatToNetCDFH == fCellLocatorMapH && numCols_ext == fCellLocatorCols &&
+		(!fCellLocatorTriGrid || fCellLocatorTriGrid->GetTopologyHdl() == fCellLocatorTopH))
+		return fCellLocator;
+
+	if (fCellLocator) {delete fCellLocator; fCellLocator = 0;}
+	fCellLocatorGrid = fGrid;
+	fCellLocatorTriGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	fCellLocatorTopH = fCellLocatorTriGrid ? fCellLocatorTriGrid->GetTopologyHdl() : 0;
+	fCellLocatorMapH = fVerdatToNetCDFH;
+	fCellLocatorCols = numCols_ext;
+
+	if (!fCellLocatorTopH || !fVerdatToNetCDFH)
+		return 0;
+
+	fCellLocator = new CurvCellLocator();
+	if (fCellLocator->Build(fCellLocatorTopH, fCellLocatorTriGrid->GetPointsHdl(), fVerdatToNetCDFH, numCols_ext))
+		{delete fCellLocator; fCellLocator = 0;}	// not a grid of cells, the DAG does it
+
+	return fCellLocator;
+}
+
+InterpolationValBilinear TimeGridVelCurv_c::GetBilinearValues(WorldPoint p, long *triHint)
+{
+	CurvCellLocator *locator = GetCellLocator();
+	LongPoint lp;
+
+	if (!locator)
+		return fGrid -> GetBilinearInterpolationValues(p);
+
+	lp.h = p.pLong;
+	lp.v = p.pLat;
+	return fCellLocatorTriGrid -> GetBilinearInterpolationValues(p, locator->WhatTriAmIIn(lp, triHint));
+}
+
+long TimeGridVelCurv_c::GetCellIndex(WorldPoint p, long *triHint)
+{
+	CurvCellLocator *locator = GetCellLocator();
+	LongPoint lp;
+	long ntri;
+
+	if (!locator)
+		return (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(p,fVerdatToNetCDFH,fNumCols+1);
+
+	lp.h = p.pLong;
+	lp.v = p.pLat;
+	ntri = locator->WhatTriAmIIn(lp, triHint);
+	return ntri < 0 ? ntri : locator->GetCellIndex(ntri);
+}
+
+OSErr TimeGridVelCurv_c::PrepareInterpolatedField(const Seconds& model_time)
+{
+	GetCellLocator();
+	return TimeGridVelRect_c::PrepareInterpolatedField(model_time);
+}
+
+long TimeGridVelCurv_c::GetNodeDataIndex(long ptIndex, Boolean waterNodes)
+{
+	long index;
+
+	if (ptIndex < 0) return -1;
+	index = (*fVerdatToNetCDFH)[ptIndex];
+	if (waterNodes && index >= 0) index = ptIndex;
+	return index;
+}
+
+// slices in the water node layout only match grids reading it
+void TimeGridVelCurv_c::GetWholeGridSliceVariable(char *variable)
+{
+	TimeGridVelRect_c::GetWholeGridSliceVariable(variable);
+	if (UsesWaterNodeLayout())
+		strcat(variable, " water nodes");
+}
+
 LongPointHdl TimeGridVelCurv_c::GetPointsHdl()
 {
 	return (dynamic_cast<TTriGridVel*>(fGrid)) -> GetPointsHdl();
@@ -2314,12 +3428,18 @@ LongPoint TimeGridVelCurv_c::GetVelocityIndices(WorldPoint wp)
 }
 
 VelocityRec TimeGridVelCurv_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint)
+{
+	return GetScaledPatValue(model_time, refPoint, 0);
+}
+
+VelocityRec TimeGridVelCurv_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint, long *triHint)
 {	
 	double timeAlpha, depthAlpha, depth = refPoint.z;
 	float topDepth, bottomDepth;
 	long index = -1, depthIndex1, depthIndex2; 
 	float totalDepth; 
 	Seconds startTime,endTime;
+	Boolean useField = false;
 	VelocityRec scaledPatVelocity = {0.,0.};
 	InterpolationValBilinear interpolationVal;
 	OSErr err = 0;
@@ -2329,15 +3449,17 @@ VelocityRec TimeGridVelCurv_c::GetScaledPatValue(const Seconds& model_time, Worl
 		if (bVelocitiesOnNodes)
 		{
 			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
-			interpolationVal = fGrid -> GetBilinearInterpolationValues(refPoint.p);
+			interpolationVal = GetBilinearValues(refPoint.p, triHint);
+			if (interpolationVal.ptIndex1<0 || (*fVerdatToNetCDFH)[interpolationVal.ptIndex1]<0)
+				GetNearestNodeValues(refPoint.p, triHint, &interpolationVal);	// off the grid or on land
 			if (interpolationVal.ptIndex1<0) return scaledPatVelocity;
 			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
 			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
 			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
+			index = GetNodeDataIndex(interpolationVal.ptIndex1, UsesWaterNodeLayout());
 		}
 		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			index = GetCellIndex(refPoint.p, triHint);// curvilinear grid
 	}
 	if (index < 0) return scaledPatVelocity;
 	
@@ -2401,6 +3523,7 @@ VelocityRec TimeGridVelCurv_c::GetScaledPatValue(const Seconds& model_time, Worl
 		//startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
 		endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
 		timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
+		useField = UseInterpolatedField(timeAlpha);
 		
 		// Calculate the interpolated velocity at the point
 		if (index >= 0 && depthIndex1 >= 0) 
@@ -2409,15 +3532,15 @@ VelocityRec TimeGridVelCurv_c::GetScaledPatValue(const Seconds& model_time, Worl
 			//scaledPatVelocity.v = timeAlpha*INDEXH(fStartData.dataHdl,index).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index).v;
 			if(depthIndex2==UNASSIGNEDINDEX) // surface velocity or special cases
 			{
-				scaledPatVelocity.u = timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u;
-				scaledPatVelocity.v = timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v;
+				scaledPatVelocity.u = (useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u);
+				scaledPatVelocity.v = (useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v);
 			}
 			else	// below surface velocity
 			{
-				scaledPatVelocity.u = depthAlpha*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u);
-				scaledPatVelocity.u += (1-depthAlpha)*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u);
-				scaledPatVelocity.v = depthAlpha*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v);
-				scaledPatVelocity.v += (1-depthAlpha)*(timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v);
+				scaledPatVelocity.u = depthAlpha*((useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).u));
+				scaledPatVelocity.u += (1-depthAlpha)*((useField ? INDEXH(fInterpolatedH,index+depthIndex2*fNumRows*fNumCols).u : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).u));
+				scaledPatVelocity.v = depthAlpha*((useField ? INDEXH(fInterpolatedH,index+depthIndex1*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex1*fNumRows*fNumCols).v));
+				scaledPatVelocity.v += (1-depthAlpha)*((useField ? INDEXH(fInterpolatedH,index+depthIndex2*fNumRows*fNumCols).v : timeAlpha*INDEXH(fStartData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,index+depthIndex2*fNumRows*fNumCols).v));
 			}
 		}
 		else	// set vel to zero
@@ -2437,6 +3560,278 @@ scale:
 	return scaledPatVelocity;
 }
 
+void TimeGridVelCurv_c::GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+{
+	long i, amtOfDepthData = 0;
+	double timeAlpha = 1;
+	VelocityFH endH = 0;
+	InterpolationValBilinear interpolationVal;
+
+	Boolean constantCurrent;
+
+	if (fDepthDataInfo) amtOfDepthData = _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo);
+
+	if (!fGrid || !fStartData.dataHdl || n <= 0)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	constantCurrent = IsConstantField(model_time);
+
+	if (!bVelocitiesOnNodes)
+	{
+		GetCellValuesBatch(model_time, constantCurrent, n, refPoints, triHints, vel);
+		return;
+	}
+
+	// the kernel does the 2D case with velocities on the nodes, depth levels
+	// and the blended field go per LE
+	if (!fVerdatToNetCDFH || amtOfDepthData > 0)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	if (!constantCurrent)
+	{
+		timeAlpha = GetTimeAlpha(model_time);
+		if (UseInterpolatedField(timeAlpha) || !fEndData.dataHdl)
+		{
+			TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+			return;
+		}
+		endH = fEndData.dataHdl;
+	}
+
+	vector<long> ptIndex(4 * n, -1);
+	vector<double> alpha(4 * n, 0.);
+	{
+		TIME_SECTION(&fTiming, kTimerLocate, n);
+		Boolean waterNodes = UsesWaterNodeLayout();
+		for (i = 0; i < n; i++)
+		{
+			interpolationVal = GetBilinearValues(refPoints[i].p, triHints ? &triHints[i] : 0);
+			if (interpolationVal.ptIndex1 < 0 || (*fVerdatToNetCDFH)[interpolationVal.ptIndex1] < 0)
+				if (!GetNearestNodeValues(refPoints[i].p, triHints ? &triHints[i] : 0, &interpolationVal))
+					continue;
+			ptIndex[i] = GetNodeDataIndex(interpolationVal.ptIndex1, waterNodes);
+			ptIndex[n + i] = GetNodeDataIndex(interpolationVal.ptIndex2, waterNodes);
+			ptIndex[2 * n + i] = GetNodeDataIndex(interpolationVal.ptIndex3, waterNodes);
+			ptIndex[3 * n + i] = GetNodeDataIndex(interpolationVal.ptIndex4, waterNodes);
+			alpha[i] = interpolationVal.alpha1;
+			alpha[n + i] = interpolationVal.alpha2;
+			alpha[2 * n + i] = interpolationVal.alpha3;
+			alpha[3 * n + i] = interpolationVal.alpha4;
+		}
+	}
+
+	TIME_SECTION(&fTiming, kTimerInterpolate, n);
+	InterpolateBilinear(n, &ptIndex[0], &alpha[0], fStartData.dataHdl, endH, timeAlpha, &vel[0]);
+
+	// LEs off the grid keep the unscaled zero, as in GetScaledPatValue
+	for (i = 0; i < n; i++)
+	{
+		if (ptIndex[i] < 0) continue;
+		vel[i].u *= fVar.fileScaleFactor;
+		vel[i].v *= fVar.fileScaleFactor;
+	}
+}
+
+
+// the velocity of GetScaledPatValue for velocities at the cell centers, the
+// same sums in the same order. index is the LE's cell
+template <bool depthLevels, bool sigma, bool timeVarying>
+inline VelocityRec TimeGridVelCurv_c::GetCellValue(long index, const WorldPoint3D &refPoint, TTriGridVel *triGrid,
+												   const TimeGridFieldView &view)
+{
+	VelocityRec vel = {0., 0.};
+	long depthIndex1 = 0, depthIndex2 = UNASSIGNEDINDEX;
+	float totalDepth, topDepth, bottomDepth;
+	double depth, depthAlpha = 1;
+
+	if (depthLevels)
+	{
+		depth = refPoint.z;
+		if (sigma)
+			totalDepth = GetTotalDepth(refPoint.p,index,triGrid);
+		else
+			totalDepth = fDepthsH ? INDEXH(fDepthsH,index) : 0;
+		GetDepthIndices(index,depth,totalDepth,&depthIndex1,&depthIndex2);
+		if (depthIndex1==UNASSIGNEDINDEX && depthIndex2==UNASSIGNEDINDEX)
+			return vel;	// no value at this depth, the unscaled zero
+
+		if (depthIndex2!=UNASSIGNEDINDEX)
+		{
+			topDepth = GetDepthAtIndex(depthIndex1,totalDepth);
+			bottomDepth = GetDepthAtIndex(depthIndex2,totalDepth);
+			if (totalDepth == 0) depthAlpha = 1;
+			else
+				depthAlpha = (bottomDepth - depth)/(double)(bottomDepth - topDepth);
+		}
+	}
+
+	if (depthIndex1 >= 0)
+	{
+		if (depthLevels)
+			vel = view.Velocity<timeVarying>(index, depthIndex1, depthIndex2, depthAlpha);
+		else
+			vel = view.Velocity<timeVarying>(index, 0);
+	}
+
+	vel.u *= view.scale;
+	vel.v *= view.scale;
+	return vel;
+}
+
+template <bool depthLevels, bool sigma, bool timeVarying>
+void TimeGridVelCurv_c::GetCellValues(long n, const WorldPoint3D *refPoints, long *triHints, TTriGridVel *triGrid,
+									  const TimeGridFieldView &view, VelocityRec *vel)
+{
+	long i, index;
+
+	for (i = 0; i < n; i++)
+	{
+		vel[i].u = 0.;
+		vel[i].v = 0.;
+
+		index = GetCellIndex(refPoints[i].p, triHints ? &triHints[i] : 0);
+		if (index < 0) continue;
+
+		vel[i] = GetCellValue<depthLevels, sigma, timeVarying>(index, refPoints[i], triGrid, view);
+	}
+}
+
+typedef struct {
+	long	cell;
+	double	z;
+	long	le;
+} CellBinEntry;
+
+static bool CellBinLess(const CellBinEntry &a, const CellBinEntry &b)
+{
+	if (a.cell != b.cell) return a.cell < b.cell;
+	if (a.z != b.z) return a.z < b.z;
+	return a.le < b.le;
+}
+
+// GetCellValues with the LEs binned by cell: the velocity at the cell center
+// only depends on the cell and the depth, so it is worked out once for the
+// LEs of a cell at the same depth and copied to the others
+template <bool depthLevels, bool sigma, bool timeVarying>
+void TimeGridVelCurv_c::GetBinnedCellValues(long n, const WorldPoint3D *refPoints, long *triHints, TTriGridVel *triGrid,
+											const TimeGridFieldView &view, VelocityRec *vel)
+{
+	vector<CellBinEntry> bins;
+	CellBinEntry entry;
+	long i, j, index;
+
+	bins.reserve(n);
+	for (i = 0; i < n; i++)
+	{
+		vel[i].u = 0.;
+		vel[i].v = 0.;
+
+		index = GetCellIndex(refPoints[i].p, triHints ? &triHints[i] : 0);
+		if (index < 0) continue;
+
+		entry.cell = index;
+		entry.z = depthLevels ? refPoints[i].z : 0;
+		entry.le = i;
+		bins.push_back(entry);
+	}
+
+	sort(bins.begin(), bins.end(), CellBinLess);
+
+	for (j = 0; j < (long)bins.size(); j++)
+	{
+		i = bins[j].le;
+		if (j > 0 && bins[j].cell == bins[j - 1].cell && bins[j].z == bins[j - 1].z)
+			vel[i] = vel[bins[j - 1].le];
+		else
+			vel[i] = GetCellValue<depthLevels, sigma, timeVarying>(bins[j].cell, refPoints[i], triGrid, view);
+	}
+}
+
+// picks the GetCellValues for the grid and the time, once for the batch
+void TimeGridVelCurv_c::GetCellValuesBatch(const Seconds& model_time, Boolean constantCurrent, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+{
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	Boolean depthLevels = fDepthLevelsHdl && GetNumDepthLevelsInFile() > 0;
+	Boolean sigma = depthLevels && fVar.gridType == SIGMA_ROMS;
+	Seconds startTime, endTime;
+	double timeAlpha = 1;
+	TimeGridFieldView view;
+
+	if (!constantCurrent)
+	{	// the time weight as GetScaledPatValue has it, not GetTimeAlpha()
+		if (GetNumFiles()>1 && fOverLap)
+			startTime = fOverLapStartTime + fTimeShift;
+		else
+			startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
+		endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
+		timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
+	}
+
+	view = GetFieldView(constantCurrent, timeAlpha);
+	if (!triGrid || !view.start)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	TIME_SECTION(&fTiming, kTimerInterpolate, n);	// location included
+	if (fBinLEsByCell)
+	{
+		if (view.TimeVarying())
+		{
+			if (!depthLevels)
+				GetBinnedCellValues<false, false, true>(n, refPoints, triHints, triGrid, view, vel);
+			else if (!sigma)
+				GetBinnedCellValues<true, false, true>(n, refPoints, triHints, triGrid, view, vel);
+			else
+				GetBinnedCellValues<true, true, true>(n, refPoints, triHints, triGrid, view, vel);
+		}
+		else if (!depthLevels)
+			GetBinnedCellValues<false, false, false>(n, refPoints, triHints, triGrid, view, vel);
+		else if (!sigma)
+			GetBinnedCellValues<true, false, false>(n, refPoints, triHints, triGrid, view, vel);
+		else
+			GetBinnedCellValues<true, true, false>(n, refPoints, triHints, triGrid, view, vel);
+	}
+	else if (view.TimeVarying())
+	{
+		if (!depthLevels)
+			GetCellValues<false, false, true>(n, refPoints, triHints, triGrid, view, vel);
+		else if (!sigma)
+			GetCellValues<true, false, true>(n, refPoints, triHints, triGrid, view, vel);
+		else
+			GetCellValues<true, true, true>(n, refPoints, triHints, triGrid, view, vel);
+	}
+	else if (!depthLevels)
+		GetCellValues<false, false, false>(n, refPoints, triHints, triGrid, view, vel);
+	else if (!sigma)
+		GetCellValues<true, false, false>(n, refPoints, triHints, triGrid, view, vel);
+	else
+		GetCellValues<true, true, false>(n, refPoints, triHints, triGrid, view, vel);
+}
+
+double TimeGridVelCurv_c::GetTimeAlpha(const Seconds& model_time)
+{
+	Seconds startTime, endTime, relTime;
+
+	if (fTimeAlpha==-1)
+	{
+		//Seconds relTime = time - model->GetStartTime();
+		relTime = model_time - fModelStartTime;
+		startTime = (*fTimeHdl)[fStartData.timeIndex];
+		endTime = (*fTimeHdl)[fEndData.timeIndex];
+		//timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
+		return (endTime - relTime)/(double)(endTime - startTime);
+	}
+
+	return fTimeAlpha;
+}
 
 VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, InterpolationValBilinear interpolationVal,float depth,float totalDepth)
 {
@@ -2453,7 +3848,7 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 	double topDepth, bottomDepth, depthAlpha, timeAlpha;
 	VelocityRec pt1interp = {0.,0.}, pt2interp = {0.,0.}, pt3interp = {0.,0.}, pt4interp = {0.,0.};
 	VelocityRec scaledPatVelocity = {0.,0.};
-	Seconds startTime, endTime, relTime;
+	Boolean useField = false;
 	
 	if (interpolationVal.ptIndex1 >= 0)  // if negative corresponds to negative ntri
 	{
@@ -2464,10 +3859,11 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 		ptIndex4 =  interpolationVal.ptIndex4;
 		if (fVerdatToNetCDFH)
 		{
-			ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
-			ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
-			ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			ptIndex4 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex4];
+			Boolean waterNodes = UsesWaterNodeLayout();
+			ptIndex1 =  GetNodeDataIndex(interpolationVal.ptIndex1, waterNodes);	
+			ptIndex2 =  GetNodeDataIndex(interpolationVal.ptIndex2, waterNodes);
+			ptIndex3 =  GetNodeDataIndex(interpolationVal.ptIndex3, waterNodes);
+			ptIndex4 =  GetNodeDataIndex(interpolationVal.ptIndex4, waterNodes);
 		}
 	}
 	else
@@ -2574,25 +3970,8 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 	else // time varying current 
 	{
 		// Calculate the time weight factor
-		if (GetNumFiles()>1 && fOverLap)
-			startTime = fOverLapStartTime + fTimeShift;
-		else
-			startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
-		endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
-		timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
-		
-		// Calculate the time weight factor
-		if (fTimeAlpha==-1)
-		{
-			//Seconds relTime = time - model->GetStartTime();
-			relTime = model_time - fModelStartTime;
-			startTime = (*fTimeHdl)[fStartData.timeIndex];
-			endTime = (*fTimeHdl)[fEndData.timeIndex];
-			//timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
-			timeAlpha = (endTime - relTime)/(double)(endTime - startTime);
-		}
-		else
-			timeAlpha = fTimeAlpha;
+		timeAlpha = GetTimeAlpha(model_time);
+		useField = UseInterpolatedField(timeAlpha);
 
 		if (pt1depthIndex1!=-1)
 		{
@@ -2601,15 +3980,15 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 				topDepth = INDEXH(fDepthsH,pt1depthIndex1);	
 				bottomDepth = INDEXH(fDepthsH,pt1depthIndex2);
 				depthAlpha = (bottomDepth - depth)/(double)(bottomDepth - topDepth);
-				pt1interp.u = depthAlpha*(interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).u))
-				+ (1-depthAlpha)*(interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex2).u));
-				pt1interp.v = depthAlpha*(interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).v))
-				+ (1-depthAlpha)*(interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex2).v));
+				pt1interp.u = depthAlpha*(interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).u)))
+				+ (1-depthAlpha)*(interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex2).u : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex2).u)));
+				pt1interp.v = depthAlpha*(interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).v)))
+				+ (1-depthAlpha)*(interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex2).v : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex2).v)));
 			}
 			else
 			{
-				pt1interp.u = interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).u); 
-				pt1interp.v = interpolationVal.alpha1*(timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).v); 
+				pt1interp.u = interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).u)); 
+				pt1interp.v = interpolationVal.alpha1*((useField ? INDEXH(fInterpolatedH,pt1depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt1depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt1depthIndex1).v)); 
 			}
 		}
 		
@@ -2620,15 +3999,15 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 				topDepth = INDEXH(fDepthsH,pt2depthIndex1);	
 				bottomDepth = INDEXH(fDepthsH,pt2depthIndex2);
 				depthAlpha = (bottomDepth - depth)/(double)(bottomDepth - topDepth);
-				pt2interp.u = depthAlpha*(interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).u))
-				+ (1-depthAlpha)*(interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex2).u));
-				pt2interp.v = depthAlpha*(interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).v))
-				+ (1-depthAlpha)*(interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex2).v));
+				pt2interp.u = depthAlpha*(interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).u)))
+				+ (1-depthAlpha)*(interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex2).u : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex2).u)));
+				pt2interp.v = depthAlpha*(interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).v)))
+				+ (1-depthAlpha)*(interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex2).v : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex2).v)));
 			}
 			else
 			{
-				pt2interp.u = interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).u); 
-				pt2interp.v = interpolationVal.alpha2*(timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).v); 
+				pt2interp.u = interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).u)); 
+				pt2interp.v = interpolationVal.alpha2*((useField ? INDEXH(fInterpolatedH,pt2depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt2depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt2depthIndex1).v)); 
 			}
 		}
 		
@@ -2639,15 +4018,15 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 				topDepth = INDEXH(fDepthsH,pt3depthIndex1);	
 				bottomDepth = INDEXH(fDepthsH,pt3depthIndex2);
 				depthAlpha = (bottomDepth - depth)/(double)(bottomDepth - topDepth);
-				pt3interp.u = depthAlpha*(interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).u))
-				+ (1-depthAlpha)*(interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex2).u));
-				pt3interp.v = depthAlpha*(interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).v))
-				+ (1-depthAlpha)*(interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex2).v));
+				pt3interp.u = depthAlpha*(interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).u)))
+				+ (1-depthAlpha)*(interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex2).u : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex2).u)));
+				pt3interp.v = depthAlpha*(interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).v)))
+				+ (1-depthAlpha)*(interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex2).v : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex2).v)));
 			}
 			else
 			{
-				pt3interp.u = interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).u); 
-				pt3interp.v = interpolationVal.alpha3*(timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).v); 
+				pt3interp.u = interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).u)); 
+				pt3interp.v = interpolationVal.alpha3*((useField ? INDEXH(fInterpolatedH,pt3depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt3depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt3depthIndex1).v)); 
 			}
 		}
 		if (pt4depthIndex1!=-1) 
@@ -2657,15 +4036,15 @@ VelocityRec TimeGridVelCurv_c::GetInterpolatedValue(const Seconds& model_time, I
 				topDepth = INDEXH(fDepthsH,pt4depthIndex1);	
 				bottomDepth = INDEXH(fDepthsH,pt4depthIndex2);
 				depthAlpha = (bottomDepth - depth)/(double)(bottomDepth - topDepth);
-				pt4interp.u = depthAlpha*(interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).u))
-				+ (1-depthAlpha)*(interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex2).u));
-				pt4interp.v = depthAlpha*(interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).v))
-				+ (1-depthAlpha)*(interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex2).v));
+				pt4interp.u = depthAlpha*(interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).u)))
+				+ (1-depthAlpha)*(interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex2).u : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex2).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex2).u)));
+				pt4interp.v = depthAlpha*(interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).v)))
+				+ (1-depthAlpha)*(interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex2).v : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex2).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex2).v)));
 			}
 			else
 			{
-				pt4interp.u = interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).u); 
-				pt4interp.v = interpolationVal.alpha4*(timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).v); 
+				pt4interp.u = interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex1).u : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).u)); 
+				pt4interp.v = interpolationVal.alpha4*((useField ? INDEXH(fInterpolatedH,pt4depthIndex1).v : timeAlpha*INDEXH(fStartData.dataHdl,pt4depthIndex1).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,pt4depthIndex1).v)); 
 			}
 		}
 	}
@@ -2716,6 +4095,12 @@ float TimeGridVelCurv_c::GetInterpolatedTotalDepth(WorldPoint refPoint)
 }
 
 float TimeGridVelCurv_c::GetTotalDepth(WorldPoint refPoint,long ptIndex)
+{
+	return GetTotalDepth(refPoint, ptIndex, fVar.gridType == SIGMA_ROMS ? dynamic_cast<TTriGridVel*>(fGrid) : 0);
+}
+
+// triGrid is fGrid, for the sigma grids
+float TimeGridVelCurv_c::GetTotalDepth(WorldPoint refPoint,long ptIndex,TTriGridVel *triGrid)
 {
 	long index1, index2, index3, index4, numDepths;
 	OSErr err = 0;
@@ -2727,9 +4112,9 @@ float TimeGridVelCurv_c::GetTotalDepth(WorldPoint refPoint,long ptIndex)
 	{
 		//if (triNum < 0) useTriNum = false;
 		if (bVelocitiesOnNodes)
-			err = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectCornersFromTriIndexOrPoint(&index1, &index2, &index3, &index4, refPoint, triNum, useTriNum, fVerdatToNetCDFH, fNumCols);
+			err = triGrid->GetRectCornersFromTriIndexOrPoint(&index1, &index2, &index3, &index4, refPoint, triNum, useTriNum, fVerdatToNetCDFH, fNumCols);
 		else 
-			err = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectCornersFromTriIndexOrPoint(&index1, &index2, &index3, &index4, refPoint, triNum, useTriNum, fVerdatToNetCDFH, fNumCols+1);
+			err = triGrid->GetRectCornersFromTriIndexOrPoint(&index1, &index2, &index3, &index4, refPoint, triNum, useTriNum, fVerdatToNetCDFH, fNumCols+1);
 		
 		//if (err) return 0;
 		if (err) return -1;
@@ -2851,9 +4236,16 @@ void TimeGridVelCurv_c::GetDepthIndices(long ptIndex, float depthAtPoint, float
 			}
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{	// is sigma always 0-1 ?
-				long j;
+				long j, k1, k2;
 				float depthAtLevel, depthAtNextLevel;
-				for(j=0;j<numDepthLevels-1;j++)
+				Boolean inOrder = fDepthLevelsAscending && numDepthLevels > 1;
+				if (inOrder && BisectDepthLevels(DepthLevels(*fDepthLevelsHdl),numDepthLevels,depthAtPoint,&k1,&k2))
+				{
+					*depthIndex1 = indexToDepthData+k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+					return;
+				}
+				for(j=0;!inOrder && j<numDepthLevels-1;j++)
 				{
 					depthAtLevel = INDEXH(fDepthLevelsHdl,indexToDepthData+j);
 					depthAtNextLevel = INDEXH(fDepthLevelsHdl,indexToDepthData+j+1);
@@ -2908,9 +4300,16 @@ void TimeGridVelCurv_c::GetDepthIndices(long ptIndex, float depthAtPoint, float
 			}
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{	// is sigma always 0-1 ?
-				long j;
+				long j, k1, k2;
 				float sigma, sigmaNext, depthAtLevel, depthAtNextLevel;
-				for(j=0;j<numDepthLevels-1;j++)
+				Boolean inOrder = fDepthLevelsAscending && numDepthLevels > 1;
+				if (inOrder && BisectDepthLevels(SigmaDepthLevels(*fDepthLevelsHdl,totalDepth),numDepthLevels,depthAtPoint,&k1,&k2))
+				{
+					*depthIndex1 = indexToDepthData+k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+					return;
+				}
+				for(j=0;!inOrder && j<numDepthLevels-1;j++)
 				{
 					sigma = INDEXH(fDepthLevelsHdl,indexToDepthData+j);
 					sigmaNext = INDEXH(fDepthLevelsHdl,indexToDepthData+j+1);
@@ -2969,10 +4368,17 @@ void TimeGridVelCurv_c::GetDepthIndices(long ptIndex, float depthAtPoint, float
 			}
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{	// is sigma always 0-1 ?
-				long j;
+				long j, k1, k2;
 				float sc_r, sc_r2, Cs_r, Cs_r2, depthAtLevel, depthAtNextLevel;
+				Boolean inOrder = fRomsLevelsAscending && numDepthLevels > 1;
+				if (inOrder && BisectDepthLevels(RomsDepthLevels(*fDepthLevelsHdl,*fDepthLevelsHdl2,totalDepth,hc,numDepthLevels),numDepthLevels,depthAtPoint,&k1,&k2))
+				{	// level k counts from the top, j = numDepthLevels-1-k from the bottom
+					*depthIndex1 = indexToDepthData+numDepthLevels-1-k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+numDepthLevels-1-k2;
+					return;
+				}
 				//for(j=0;j<numDepthLevels-1;j++)
-				for(j=numDepthLevels-1;j>0;j--)
+				for(j=numDepthLevels-1;!inOrder && j>0;j--)
 				{
 					// sc and Cs are negative so need abs value
 					/*float sc_r = INDEXH(fDepthLevelsHdl,indexToDepthData+j);
@@ -2985,8 +4391,8 @@ void TimeGridVelCurv_c::GetDepthIndices(long ptIndex, float depthAtPoint, float
 					Cs_r2 = INDEXH(fDepthLevelsHdl2,indexToDepthData+j-1);
 					//depthAtLevel = abs(hc * (sc_r-Cs_r) + Cs_r * totalDepth);
 					//depthAtNextLevel = abs(hc * (sc_r2-Cs_r2) + Cs_r2 * totalDepth);
-					depthAtLevel = fabs(totalDepth*(hc*sc_r+totalDepth*Cs_r))/(totalDepth+hc);
-					depthAtNextLevel = fabs(totalDepth*(hc*sc_r2+totalDepth*Cs_r2))/(totalDepth+hc);
+					depthAtLevel = RomsLevelDepth(totalDepth,hc,sc_r,Cs_r);
+					depthAtNextLevel = RomsLevelDepth(totalDepth,hc,sc_r2,Cs_r2);
 					if(depthAtLevel<depthAtPoint &&
 					   depthAtPoint<=depthAtNextLevel)
 					{
@@ -3046,6 +4452,7 @@ void TimeGridVelCurv_c::GetDepthIndices(long ptIndex, float depthAtPoint, float
 
 OSErr TimeGridVelCurv_c::TextRead(const char *path, const char *topFilePath)
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	// this code is for curvilinear grids
 	OSErr err = 0;
 	char errmsg[256] = "";
@@ -3077,6 +4484,7 @@ OSErr TimeGridVelCurv_c::TextRead(const char *path, const char *topFilePath)
 	DOUBLEH landmaskH = 0;
 	FLOATH totalDepthsH = 0, sigmaLevelsH = 0;
 	WORLDPOINTFH vertexPtsH = 0;
+	uint64_t cacheKey = 0;
 	
 	if (!path || !path[0]) return 0;
 	strcpy(fVar.pathName,path);
@@ -3412,11 +4820,21 @@ OLD:
 		goto depths;
 	}
 	
+	// a grid triangulated on an earlier run can be read back instead
+	cacheKey = fTopologyCacheKey = GetTopologyCacheKey(landmaskH, isLandMask, isCoopsMask);
+	if ((TopologyCacheIsOn() || GetNumForcingFiles() > 0) && LoadCachedTopology(cacheKey) == noErr) goto depths;
+	
+	{
+		SetupStage setupStage(kSetupTopology);
+
 		if (isLandMask && bVelocitiesOnNodes) err = ReorderPointsCOOPSMask(landmaskH,errmsg);
 		else if (isCoopsMask) err = ReorderPointsCOOPSMaskOld(landmaskH,errmsg);
 		else if (bVelocitiesOnNodes) err = ReorderPointsCOOPSNoMask(errmsg);
 		else if (isLandMask) err = ReorderPoints(landmaskH,errmsg);	
 		else err = ReorderPointsNoMask(errmsg);
+	}
+	
+	if (!err && TopologyCacheIsOn()) SaveCachedTopology(cacheKey);	// not fatal if this fails
 	
 depths:
 	if (err) goto done;
@@ -3548,6 +4966,8 @@ done:
 		if (fDepthLevelsHdl) {DisposeHandle((Handle)fDepthLevelsHdl); fDepthLevelsHdl=0;}
 		if (fDepthLevelsHdl2) {DisposeHandle((Handle)fDepthLevelsHdl2); fDepthLevelsHdl2=0;}
 	}
+	SetDepthLevelOrder();
+	BuildNearestNodeIndex();	// the grid is new
 	
 	if (timeUnits) delete [] timeUnits;
 	if (lat_vals) delete [] lat_vals;
@@ -3558,7 +4978,37 @@ done:
 	return err;
 }
 
-OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* errmsg) 
+// the velocity of value src of the file's u and v, with angle a of angle_vals
+// if they are rotated, zero for fill values and NaNs
+template <class T>
+static inline void StoreNodeVelocity(T *curr_uvals, T *curr_vvals, long src, long a, double *angle_vals,
+									 double velConversion, double fill_value, VelocityFRec *vel)
+{
+	T u = curr_uvals[src], v = curr_vvals[src];
+	double u_grid, v_grid, angle;
+
+	if (u==(T)fill_value || v==(T)fill_value)
+		u = v = 0;
+	// NOTE: if leave velocity as NaN need to be sure to check for it wherever velocity is used (GetMove,Draw,...)
+	if (isnan(u) || isnan(v))
+		u = v = 0;
+	if (angle_vals)
+	{
+		u_grid = (double)u * velConversion;
+		v_grid = (double)v * velConversion;
+		angle = angle_vals[a];
+		vel->u = u_grid*cos(angle)-v_grid*sin(angle);	//in radians
+		vel->v = u_grid*sin(angle)+v_grid*cos(angle);
+	}
+	else
+	{
+		vel->u = u * velConversion;	// need units
+		vel->v = v * velConversion;
+	}
+}
+
+template <class T>
+OSErr TimeGridVelCurv_c::ReadVelocityData(long index,VelocityFH *velocityH, char* errmsg) 
 {
 	OSErr err = 0;
 	char path[256], outPath[256];
@@ -3574,9 +5024,10 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	static size_t curr_index[] = {0, 0, 0, 0}, angle_index[] = {0, 0};
 	static size_t curr_count[4], angle_count[2];
 
-	double scale_factor = 1., angle = 0., u_grid, v_grid;
+	double scale_factor = 1.;
 	char *velUnits = 0;
-	double *curr_uvals = 0, *curr_vvals = 0, *curr_wvals = 0, fill_value = -1e+34, test_value = 8e+10;
+	T *curr_uvals = 0, *curr_vvals = 0, *curr_wvals = 0;
+	double fill_value = -1e+34, test_value = 8e+10;
 	double *landmask = 0, velConversion = 1.;
 	double *angle_vals = 0, debug_mask;
 
@@ -3589,7 +5040,7 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 
 	status = nc_inq_ndims(ncid, &numdims);
@@ -3613,9 +5064,9 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 	angle_count[1] = lonlength;
 	
 	{
-		status = nc_inq_varid(ncid, "mask", &mask_id);
+		status = InqVarID(ncid, "mask", &mask_id);
 		if (status != NC_NOERR)	{/*err=-1; goto done;*/ isLandMask = false;}
-		status = nc_inq_varid(ncid, "ang", &angle_id);
+		status = InqVarID(ncid, "ang", &angle_id);
 		if (status != NC_NOERR) {/*err = -1; goto done;*/bRotated = false;}
 		else
 		{
@@ -3624,21 +5075,21 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 			status = nc_get_vara_double(ncid, angle_id, angle_index, angle_count, angle_vals);
 			if (status != NC_NOERR) {/*err = -1; goto done;*/bRotated = false;}
 		}
-		curr_uvals = new double[latlength*lonlength*numDepths]; 
+		curr_uvals = new T[latlength*lonlength*numDepths]; 
 		if(!curr_uvals) 
 		{
 			TechError("TimeGridVelCurv_c::ReadTimeData()", "new[]", 0); 
 			err = memFullErr; 
 			goto done;
 		}
-		curr_vvals = new double[latlength*lonlength*numDepths]; 
+		curr_vvals = new T[latlength*lonlength*numDepths]; 
 		if(!curr_vvals) 
 		{
 			TechError("TimeGridVelCurv_c::ReadTimeData()", "new[]", 0); 
 			err = memFullErr; 
 			goto done;
 		}
-		curr_wvals = new double[latlength*lonlength*numDepths]; 
+		curr_wvals = new T[latlength*lonlength*numDepths]; 
 		if(!curr_wvals) 
 		{
 			TechError("TimeGridVelCurv_c::ReadTimeData()", "new[]", 0); 
@@ -3646,35 +5097,35 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 			goto done;
 		}
 
-		status = nc_inq_varid(ncid, "U", &curr_ucmp_id);
+		status = InqVarID(ncid, "U", &curr_ucmp_id);
 		if (status != NC_NOERR)
 		{
-			status = nc_inq_varid(ncid, "u", &curr_ucmp_id);
+			status = InqVarID(ncid, "u", &curr_ucmp_id);
 			if (status != NC_NOERR)
 			{
-				status = nc_inq_varid(ncid, "water_u", &curr_ucmp_id);
+				status = InqVarID(ncid, "water_u", &curr_ucmp_id);
 				if (status != NC_NOERR)
 				{err = -1; goto done;}
 			}
 		}
-		status = nc_inq_varid(ncid, "V", &curr_vcmp_id);
+		status = InqVarID(ncid, "V", &curr_vcmp_id);
 		if (status != NC_NOERR) 
 		{
-			status = nc_inq_varid(ncid, "v", &curr_vcmp_id);
+			status = InqVarID(ncid, "v", &curr_vcmp_id);
 			if (status != NC_NOERR) 
 			{
-				status = nc_inq_varid(ncid, "water_v", &curr_vcmp_id);
+				status = InqVarID(ncid, "water_v", &curr_vcmp_id);
 				if (status != NC_NOERR)
 				{err = -1; goto done;}
 			}
 		}
-		status = nc_inq_varid(ncid, "W", &curr_wcmp_id);
+		status = InqVarID(ncid, "W", &curr_wcmp_id);
 		if (status != NC_NOERR)
 		{
-			status = nc_inq_varid(ncid, "w", &curr_wcmp_id);
+			status = InqVarID(ncid, "w", &curr_wcmp_id);
 			if (status != NC_NOERR)
 			{
-				status = nc_inq_varid(ncid, "water_w", &curr_wcmp_id);
+				status = InqVarID(ncid, "water_w", &curr_wcmp_id);
 				if (status != NC_NOERR)
 					//{err = -1; goto done;}
 					bIsWVel = false;
@@ -3684,15 +5135,13 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 		}
 		status = nc_inq_varndims(ncid, curr_ucmp_id, &uv_ndims);
 		if (status==NC_NOERR){if (uv_ndims < numdims && uv_ndims==3) {curr_count[1] = latlength; curr_count[2] = lonlength;}}	// could have more dimensions than are used in u,v
-		//status = nc_get_vara_float(ncid, curr_ucmp_id, curr_index, curr_count, curr_uvals);
-		status = nc_get_vara_double(ncid, curr_ucmp_id, curr_index, curr_count, curr_uvals);
+		status = GetVaraCached(ncid, path, curr_ucmp_id, curr_index, curr_count, curr_uvals);
 		if (status != NC_NOERR) {err = -1; goto done;}
-		//status = nc_get_vara_float(ncid, curr_vcmp_id, curr_index, curr_count, curr_vvals);
-		status = nc_get_vara_double(ncid, curr_vcmp_id, curr_index, curr_count, curr_vvals);
+		status = GetVaraCached(ncid, path, curr_vcmp_id, curr_index, curr_count, curr_vvals);
 		if (status != NC_NOERR) {err = -1; goto done;}
 		if (bIsWVel)
 		{	
-			status = nc_get_vara_double(ncid, curr_wcmp_id, curr_index, curr_count, curr_wvals);
+			status = GetVaraCached(ncid, path, curr_wcmp_id, curr_index, curr_count, curr_wvals);
 			if (status != NC_NOERR) {err = -1; goto done;}
 		}
 		status = nc_inq_attlen(ncid, curr_ucmp_id, "units", &velunit_len);
@@ -3718,44 +5167,42 @@ OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* er
 		//if (status != NC_NOERR) {err = -1; goto done;}	// don't require
 		status = nc_get_att_double(ncid, curr_ucmp_id, "scale_factor", &scale_factor);
 	}	
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	// NOTE: if allow fill_value as NaN need to be sure to check for it wherever fill_value is used
 	if (isnan(fill_value))
 		fill_value = -9999.;
 	
+	if (UsesWaterNodeLayout())
+		totalNumberOfVels = _GetHandleSize((Handle)fVerdatToNetCDFH)/sizeof(**fVerdatToNetCDFH);
 	velH = (VelocityFH)_NewHandleClear(totalNumberOfVels * sizeof(VelocityFRec));
 	if (!velH) 
 	{
 		err = memFullErr; 
 		goto done;
 	}
-	//for (i=0;i<totalNumberOfVels;i++)
-	for (k=0;k<numDepths;k++)
+	if (UsesWaterNodeLayout())
 	{
-		for (i=0;i<latlength;i++)
+		// point k of the grid is velocity (*fVerdatToNetCDFH)[k] of the whole grid, whose row i is row latlength-i-1 of the file
+		for (k=0;k<totalNumberOfVels;k++)
+		{
+			long node = (*fVerdatToNetCDFH)[k];
+			if (node < 0) continue;
+			i = node / lonlength;
+			j = node % lonlength;
+			StoreNodeVelocity(curr_uvals, curr_vvals, (latlength-i-1)*lonlength+j, (latlength-i-1)*lonlength+j,
+							  bRotated ? angle_vals : 0, velConversion, fill_value, &INDEXH(velH,k));
+		}
+	}
+	else
+	{
+		for (k=0;k<numDepths;k++)
 		{
-			for (j=0;j<lonlength;j++)
+			for (i=0;i<latlength;i++)
 			{
-				if (curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]==fill_value || curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]==fill_value)
-					curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] = curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] = 0;
-				// NOTE: if leave velocity as NaN need to be sure to check for it wherever velocity is used (GetMove,Draw,...)
-				if (isnan(curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]) || isnan(curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols]))
-					curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] = curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] = 0;
-				/////////////////////////////////////////////////
-				if (bRotated)
+				for (j=0;j<lonlength;j++)
 				{
-					u_grid = (double)curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;
-					v_grid = (double)curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;
-					if (bRotated) angle = angle_vals[(latlength-i-1)*lonlength+j];
-					INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).u = u_grid*cos(angle)-v_grid*sin(angle);	//in radians
-					INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).v = u_grid*sin(angle)+v_grid*cos(angle);
-				}
-				else
-				{
-					INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).u = curr_uvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;	// need units
-					INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols).v = curr_vvals[(latlength-i-1)*lonlength+j+k*fNumRows*fNumCols] * velConversion;
+					StoreNodeVelocity(curr_uvals, curr_vvals, (latlength-i-1)*lonlength+j+k*fNumRows*fNumCols, (latlength-i-1)*lonlength+j,
+									  bRotated ? angle_vals : 0, velConversion, fill_value, &INDEXH(velH,i*lonlength+j+k*fNumRows*fNumCols));
 				}
 			}
 		}
@@ -3796,8 +5243,16 @@ done:
 	return err;
 }
 
+OSErr TimeGridVelCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* errmsg)
+{
+	if (fReadSinglePrecision)
+		return ReadVelocityData<float>(index, velocityH, errmsg);
+	return ReadVelocityData<double>(index, velocityH, errmsg);
+}
+
 OSErr TimeGridVelCurv_c::ReorderPoints(DOUBLEH landmaskH, char* errmsg) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	long i, j, n, ntri, numVerdatPts=0;
 	long fNumRows_ext = fNumRows+1, fNumCols_ext = fNumCols+1;
 	long nv = fNumRows * fNumCols, nv_ext = fNumRows_ext*fNumCols_ext;
@@ -4333,6 +5788,7 @@ done:
 
 OSErr TimeGridVelCurv_c::ReorderPointsNoMask(char* errmsg) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	long i, j, n, ntri, numVerdatPts=0;
 	long fNumRows_ext = fNumRows+1, fNumCols_ext = fNumCols+1;
 	long nv = fNumRows * fNumCols, nv_ext = fNumRows_ext*fNumCols_ext;
@@ -4645,6 +6101,7 @@ done:
 
 OSErr TimeGridVelCurv_c::ReorderPointsCOOPSMaskOld(DOUBLEH landmaskH, char* errmsg) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i,j,k;
 	char *velUnits=0; 
@@ -5180,6 +6637,7 @@ done:
 
 OSErr TimeGridVelCurv_c::ReorderPointsCOOPSMask(DOUBLEH landmaskH, char* errmsg) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i,j,k;
 	char *velUnits=0; 
@@ -5715,6 +7173,7 @@ done:
 
 OSErr TimeGridVelCurv_c::ReorderPointsCOOPSNoMask(char* errmsg) 
 {	// this should be combined with ReorderPointsCOOPSMask - they are the same since we don't use the mask
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i,j,k;
 	char *velUnits=0; 
@@ -6123,9 +7582,98 @@ long TimeGridVelCurv_c::GetNumDepthLevels()
 
 
 
+// the reorder only depends on the vertices, the mask and which variant is used
+uint64_t TimeGridVelCurv_c::GetTopologyCacheKey(DOUBLEH landmaskH, Boolean isLandMask, Boolean isCoopsMask)
+{
+	char flags[3] = {(char)isLandMask, (char)isCoopsMask, (char)bVelocitiesOnNodes};
+	long dims[2] = {fNumRows, fNumCols};
+	uint64_t key;
+
+	key = TopologyCacheHash(flags, sizeof(flags));
+	key = TopologyCacheHash(dims, sizeof(dims), key);
+	if (fVertexPtsH) key = TopologyCacheHash(*fVertexPtsH, _GetHandleSize((Handle)fVertexPtsH), key);
+	if (landmaskH) key = TopologyCacheHash(*landmaskH, _GetHandleSize((Handle)landmaskH), key);
+
+	return key;
+}
+
+// same grid setup as ReadTopology, the boundaries are not kept there either
+OSErr TimeGridVelCurv_c::LoadCachedTopology(uint64_t key)
+{
+	OSErr err = 0;
+	LONGH verdatH = 0;
+	LongPointHdl pts = 0;
+	TopologyHdl topo = 0;
+	DAGTreeStruct tree;
+	WorldRect bounds = voidWorldRect;
+	TTriGridVel *triGrid = 0;
+	TDagTree *dagTree = 0;
+
+	tree.treeHdl = 0;
+	tree.numBranches = 0;
+
+	err = ReadForcingTopology(key, &verdatH, &pts, &topo, &tree, &bounds);
+	if (err) err = ReadTopologyCache(key, &verdatH, &pts, &topo, &tree, &bounds);
+	if (err) return err;
+
+	triGrid = new TTriGridVel;
+	if (triGrid) dagTree = new TDagTree(pts, topo, tree.treeHdl, 0, tree.numBranches);
+	if (!triGrid || !dagTree)
+	{
+		TechError("TimeGridVelCurv_c::LoadCachedTopology()", "new TTriGridVel", 0);
+		if (triGrid) delete triGrid;
+		DisposeHandle((Handle)verdatH);
+		DisposeHandle((Handle)pts);
+		DisposeHandle((Handle)topo);
+		DisposeHandle((Handle)tree.treeHdl);
+		return memFullErr;
+	}
+
+	if (fVerdatToNetCDFH) DisposeHandle((Handle)fVerdatToNetCDFH);
+	fVerdatToNetCDFH = verdatH;
+
+	fGrid = (TTriGridVel*)triGrid;
+	triGrid->SetBounds(bounds);
+	this->SetGridBounds(bounds);
+	triGrid->SetDagTree(dagTree);	// fGrid is now responsible for the handles
+
+	CountSetupCacheHit(kSetupCacheTopology);
+	return noErr;
+}
+
+void TimeGridVelCurv_c::GetForcingTopology(ForcingFileInfo *info)
+{
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	TDagTree *dagTree = triGrid ? triGrid->GetDagTree() : 0;
+
+	if (!dagTree || !fVerdatToNetCDFH || !fTopologyCacheKey)
+		return;
+
+	info->topologyKey = fTopologyCacheKey;
+	info->verdatToNetCDFH = fVerdatToNetCDFH;
+	info->ptsH = dagTree->GetPointsHdl();
+	info->topH = dagTree->GetTopologyHdl();
+	info->treeH = dagTree->GetDagTreeHdl();
+	info->numBranches = dagTree->fNumBranches;
+	info->bounds = triGrid->GetBounds();
+}
+
+OSErr TimeGridVelCurv_c::SaveCachedTopology(uint64_t key)
+{
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	TDagTree *dagTree = triGrid ? triGrid->GetDagTree() : 0;
+
+	if (!dagTree || !fVerdatToNetCDFH)
+		return -1;
+
+	return WriteTopologyCache(key, fVerdatToNetCDFH, dagTree->GetPointsHdl(), dagTree->GetTopologyHdl(),
+							 dagTree->GetDagTreeHdl(), dagTree->fNumBranches, triGrid->GetBounds());
+}
+
 // import NetCDF curvilinear info so don't have to regenerate
-OSErr TimeGridVelCurv_c::ReadTopology(vector<string> &linesInFile)
+OSErr TimeGridVelCurv_c::ReadTopology(TextLines &linesInFile)
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	char errmsg[256];
 
@@ -6367,9 +7915,18 @@ done:
 }
 
 
+OSErr TimeGridVelCurv_c::ReadTopology(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTopology(lines);
+}
+
+
 OSErr TimeGridVelCurv_c::ReadTopology(const char *path)
 {
-	vector<string> linesInFile;
+	MemoryTag memoryTag(kMemTopology);
+	TextLines linesInFile;
 
 	ReadLinesInFile(path, linesInFile);
 	return ReadTopology(linesInFile);
@@ -6599,6 +8156,7 @@ OSErr TimeGridVelCurv_c::GetScaledVelocities(Seconds time, VelocityFRec *scaled_
 	//TTriGridVel* triGrid = (TTriGridVel*)fGrid;
 	TTriGridVel* triGrid = (dynamic_cast<TTriGridVel*>(fGrid));
 	VelocityFRec velocity;
+	Boolean waterNodes;
 	
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
@@ -6607,6 +8165,7 @@ OSErr TimeGridVelCurv_c::GetScaledVelocities(Seconds time, VelocityFRec *scaled_
 	
 	if(!loaded) return -1;
 	
+	waterNodes = UsesWaterNodeLayout();
 	//topH = triGrid -> GetTopologyHdl();
 	topH = fGrid -> GetTopologyHdl();
 	if(topH)
@@ -6652,7 +8211,7 @@ OSErr TimeGridVelCurv_c::GetScaledVelocities(Seconds time, VelocityFRec *scaled_
 			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
 			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
 			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
+			index = GetNodeDataIndex(interpolationVal.ptIndex1, waterNodes);
 		}
 		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
 			//index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
@@ -6690,6 +8249,16 @@ OSErr TimeGridVelCurv_c::GetScaledVelocities(Seconds time, VelocityFRec *scaled_
 }
 
 
+// the cell centers and cell data made for another grid are thrown out
+void TimeGridVelCurv_c::CheckCellCaches(TopologyHdl topH)
+{
+	if (topH == fCellCacheTopH) return;
+
+	if(fGridCellInfoH) {DisposeHandle((Handle)fGridCellInfoH); fGridCellInfoH=0;}
+	if(fCenterPtsH) {DisposeHandle((Handle)fCenterPtsH); fCenterPtsH=0;}
+	fCellCacheTopH = topH;
+}
+
 WORLDPOINTH TimeGridVelCurv_c::GetCellCenters()
 {
 	OSErr err = 0;
@@ -6702,10 +8271,13 @@ WORLDPOINTH TimeGridVelCurv_c::GetCellCenters()
 	int32_t i, index1, index2; 
 	Topology tri1, tri2;
 	
-	if (fCenterPtsH) return fCenterPtsH;
-	
+	if (!fGrid) return 0;
 	topH = GetTopologyHdl();
 	ptsH = GetPointsHdl();
+	CheckCellCaches(topH);
+	if (fCenterPtsH) return fCenterPtsH;
+	if (!topH || !ptsH) return 0;
+	
 	numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
 	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
 	numCells = numTri / 2;
@@ -6755,16 +8327,18 @@ GridCellInfoHdl TimeGridVelCurv_c::GetCellData()
 	char errmsg[256];
 	errmsg[0] = 0;
 
+	if (!fGrid) return 0;
+	topH = fGrid -> GetTopologyHdl();
+	CheckCellCaches(topH);
 	if (fGridCellInfoH) return fGridCellInfoH;
 	
-	topH = fGrid -> GetTopologyHdl();
 	if(topH)
 		numTri = _GetHandleSize((Handle)topH)/sizeof(**topH);
 	else 
 		numTri = 0;
 		
 	numCells = numTri / 2;
-	GridCellInfoHdl fGridCellInfoH = (GridCellInfoHdl)_NewHandleClear(numCells * sizeof(**fGridCellInfoH));
+	fGridCellInfoH = (GridCellInfoHdl)_NewHandleClear(numCells * sizeof(**fGridCellInfoH));	// kept, not made again for each call
 	if (!fGridCellInfoH) 
 	{
 		err = memFullErr; 
@@ -6818,16 +8392,23 @@ TimeGridVelIce_c::TimeGridVelIce_c () : TimeGridVelCurv_c(), TimeGridVel_c()
 	fEndDataFraction.timeIndex = UNASSIGNEDINDEX;
 	fEndDataFraction.dataHdl = 0;
 	
+	fUseMovementField = false;
+	fMovementValid = false;
+	fMovementTime = 0;
+	fMovementH = 0;
+	fIceProducts = 0;
 }
 
 void TimeGridVelIce_c::Dispose ()
 {
-	if(fStartDataIce.dataHdl)DisposeLoadedData(&fStartDataIce); 
-	if(fEndDataIce.dataHdl)DisposeLoadedData(&fEndDataIce); 
-	if(fStartDataThickness.dataHdl)DisposeLoadedData(&fStartDataThickness);
-	if(fEndDataThickness.dataHdl)DisposeLoadedData(&fEndDataThickness);
-	if(fStartDataFraction.dataHdl)DisposeLoadedData(&fStartDataFraction);
-	if(fEndDataFraction.dataHdl)DisposeLoadedData(&fEndDataFraction);
+	DisposeLoadedData(&fStartDataIce); 
+	DisposeLoadedData(&fEndDataIce); 
+	DisposeLoadedData(&fStartDataThickness);
+	DisposeLoadedData(&fEndDataThickness);
+	DisposeLoadedData(&fStartDataFraction);
+	DisposeLoadedData(&fEndDataFraction);
+	DisposeMovementField();
+	if (fIceProducts) {delete fIceProducts; fIceProducts = 0;}
 	
 	TimeGridVelCurv_c::Dispose ();
 }
@@ -6840,18 +8421,22 @@ void TimeGridVelIce_c::Dispose ()
 
 void TimeGridVelIce_c::DisposeLoadedStartData()
 {
+	fMovementValid = false;
 	if(fStartData.dataHdl)DisposeLoadedData(&fStartData); 
-	if(fStartDataIce.dataHdl)DisposeLoadedData(&fStartDataIce);
-	if(fStartDataThickness.dataHdl)DisposeLoadedData(&fStartDataThickness);
-	if(fStartDataFraction.dataHdl)DisposeLoadedData(&fStartDataFraction);
+	DisposeLoadedData(&fStartDataIce);
+	DisposeLoadedData(&fStartDataThickness);
+	DisposeLoadedData(&fStartDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceStartSlice);
 }
 
 void TimeGridVelIce_c::DisposeLoadedEndData()
 {
+	fMovementValid = false;
 	if(fEndData.dataHdl)DisposeLoadedData(&fEndData); 
-	if(fEndDataIce.dataHdl)DisposeLoadedData(&fEndDataIce);
-	if(fEndDataThickness.dataHdl)DisposeLoadedData(&fEndDataThickness);
-	if(fEndDataFraction.dataHdl)DisposeLoadedData(&fEndDataFraction);
+	DisposeLoadedData(&fEndDataIce);
+	DisposeLoadedData(&fEndDataThickness);
+	DisposeLoadedData(&fEndDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceEndSlice);
 }
 
 void TimeGridVelIce_c::ShiftInterval()
@@ -6860,6 +8445,7 @@ void TimeGridVelIce_c::ShiftInterval()
 	fStartDataIce = fEndDataIce;
 	fStartDataThickness = fEndDataThickness;
 	fStartDataFraction = fEndDataFraction;
+	if (fIceProducts) fIceProducts -> ShiftInterval();
 	ClearLoadedEndData();
 	
 }
@@ -6873,14 +8459,16 @@ void TimeGridVelIce_c::ShiftInterval()
 void TimeGridVelIce_c::ClearLoadedEndData()
 {
 	if(fEndData.dataHdl)ClearLoadedData(&fEndData); 
-	if(fEndDataIce.dataHdl)ClearLoadedData(&fEndDataIce);
-	if(fEndDataThickness.dataHdl)ClearLoadedData(&fEndDataThickness);
-	if(fEndDataFraction.dataHdl)ClearLoadedData(&fEndDataFraction);
-	
+	ClearLoadedData(&fEndDataIce);
+	ClearLoadedData(&fEndDataThickness);
+	ClearLoadedData(&fEndDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceEndSlice);
 }
 
 OSErr TimeGridVelIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 {
+	MemoryTag memoryTag(kMemTimeSlices);
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
 	OSErr err = 0;
 
 	long timeDataInterval = 0;
@@ -6894,6 +8482,11 @@ OSErr TimeGridVelIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 	if (intervalLoaded)
 		return 0;
 
+	fInterpolatedValid = false;
+	fMovementValid = false;
+
+	GnomeLock fileLock(GnomeFileIOMutex());
+
 	// check for constant current 
 	if (numTimesInFile == 1 && !(GetNumFiles() > 1))
 		//or if(timeDataInterval==-1)
@@ -6988,10 +8581,10 @@ OSErr TimeGridVelIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 		
 		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
 		{ // start data is not loaded
+			// the ice data is read by LoadIceFields when something asks for it
 			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
-			err = this -> ReadTimeDataIce(indexOfStart,&fStartDataIce.dataHdl,errmsg);
-			err = this -> ReadTimeDataFields(indexOfStart,&fStartDataThickness.dataHdl,&fStartDataFraction.dataHdl,errmsg);
 			if(err) goto done;
+			ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartData.dataHdl));
 			fStartData.timeIndex = indexOfStart;
 			fStartDataIce.timeIndex = indexOfStart;
 			fStartDataThickness.timeIndex = indexOfStart;
@@ -7001,9 +8594,8 @@ OSErr TimeGridVelIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
 		{
 			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
-			err = this -> ReadTimeDataIce(indexOfEnd,&fEndDataIce.dataHdl,errmsg);
-			err = this -> ReadTimeDataFields(indexOfEnd,&fEndDataThickness.dataHdl,&fEndDataFraction.dataHdl,errmsg);
 			if(err) goto done;
+			ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndData.dataHdl));
 			fEndData.timeIndex = indexOfEnd;
 			fEndDataIce.timeIndex = indexOfEnd;
 			fEndDataThickness.timeIndex = indexOfEnd;
@@ -7028,6 +8620,7 @@ done:
 
 OSErr TimeGridVelIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_time)
 {
+	MemoryTag memoryTag(kMemTimeSlices);
 	OSErr err = 0;
 	Seconds time = model_time, startTime, endTime, lastEndTime, testTime, firstStartTime; 
 	
@@ -7035,6 +8628,11 @@ OSErr TimeGridVelIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_time
 
 	errmsg[0] = 0;
 
+	// what is loaded may be shifted or kept across the change of file, so the
+	// ice data left for later has to come from this file
+	if ((err = LoadIceFields(errmsg, kIceVelocities | kIceFields)))
+		return err;
+
 	if (fEndData.timeIndex!=UNASSIGNEDINDEX)
 		testTime = (*fTimeHdl)[fEndData.timeIndex];	// currently loaded end time
 	
@@ -7177,6 +8775,52 @@ OSErr TimeGridVelIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_time
 	return -1;	
 }
 
+OSErr TimeGridVelIce_c::LoadIceFields(char *errmsg, short fields)
+{	// reads the ice data of the loaded times that SetInterval left unread
+	MemoryTag memoryTag(kMemTimeSlices);
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
+	OSErr err = 0;
+	
+	errmsg[0] = 0;
+	
+	GnomeLock fileLock(GnomeFileIOMutex());
+	
+	if ((fields & kIceVelocities) && fStartDataIce.timeIndex >= 0 && !fStartDataIce.dataHdl)
+	{
+		fMovementValid = false;
+		if ((err = this -> ReadTimeDataIce(fStartDataIce.timeIndex,&fStartDataIce.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartDataIce.dataHdl));
+	}
+	if ((fields & kIceVelocities) && fEndDataIce.timeIndex >= 0 && !fEndDataIce.dataHdl)
+	{
+		fMovementValid = false;
+		if ((err = this -> ReadTimeDataIce(fEndDataIce.timeIndex,&fEndDataIce.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndDataIce.dataHdl));
+	}
+	// thickness and fraction are read together, each is zeroed where the other is missing
+	if ((fields & kIceFields) && fStartDataThickness.timeIndex >= 0 && !fStartDataThickness.dataHdl)
+	{
+		fMovementValid = false;
+		if ((err = this -> ReadTimeDataFields(fStartDataThickness.timeIndex,&fStartDataThickness.dataHdl,&fStartDataFraction.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartDataThickness.dataHdl) + LoadedBytes((Handle)fStartDataFraction.dataHdl));
+	}
+	if ((fields & kIceFields) && fEndDataThickness.timeIndex >= 0 && !fEndDataThickness.dataHdl)
+	{
+		fMovementValid = false;
+		if ((err = this -> ReadTimeDataFields(fEndDataThickness.timeIndex,&fEndDataThickness.dataHdl,&fEndDataFraction.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndDataThickness.dataHdl) + LoadedBytes((Handle)fEndDataFraction.dataHdl));
+	}
+	
+done:
+	if(err)
+	{
+		if(!errmsg[0])strcpy(errmsg,"Error in TimeGridVelIce::LoadIceFields()");
+		DisposeLoadedStartData();
+		DisposeLoadedEndData();
+	}
+	return err;
+}
+
 double TimeGridVelIce_c::GetStartFieldValue(long index, long field)
 {	// 
 	double value = 0;
@@ -7265,6 +8909,15 @@ VelocityRec TimeGridVelIce_c::GetScaledPatValue(const Seconds& model_time, World
 	double frac_coverage = 0, max_coverage = .8, min_coverage = .2, fracAlpha;
 	VelocityRec scaledPatVelocity = {0.,0.}, iceVelocity = {0.,0.}, currentVelocity = {0.,0.};
 
+	if (fMovementValid && fMovementTime == model_time && fGrid)
+	{	// the field has the three lookups below at the LE's cell, blended
+		long index = GetCellIndex(refPoint.p, 0);// curvilinear grid
+		if (index < 0)
+			return scaledPatVelocity;
+		if (index < (long)(_GetHandleSize((Handle)fMovementH)/sizeof(**fMovementH)))
+			return INDEXH(fMovementH,index);
+	}
+
 	frac_coverage = GetDataField(model_time, refPoint, 2);
 	iceVelocity = GetScaledPatValueIce(model_time, refPoint);
 	currentVelocity = TimeGridVelCurv_c::GetScaledPatValue(model_time, refPoint);
@@ -7302,7 +8955,7 @@ VelocityRec TimeGridVelIce_c::GetScaledPatValueIce(const Seconds& model_time, Wo
 		if (bVelocitiesOnNodes)
 		{
 			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
-			interpolationVal = fGrid -> GetBilinearInterpolationValues(refPoint.p);
+			interpolationVal = GetBilinearValues(refPoint.p, 0);
 			if (interpolationVal.ptIndex1<0) return scaledPatVelocity;
 			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
 			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
@@ -7310,7 +8963,7 @@ VelocityRec TimeGridVelIce_c::GetScaledPatValueIce(const Seconds& model_time, Wo
 			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
 		}
 		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			index = GetCellIndex(refPoint.p, 0);// curvilinear grid
 	}
 	if (index < 0) return scaledPatVelocity;
 	
@@ -7399,7 +9052,7 @@ double TimeGridVelIce_c::GetDataField(const Seconds& model_time, WorldPoint3D re
 			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
 		}
 		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			index = GetCellIndex(refPoint.p, 0);// curvilinear grid
 	}
 	if (index < 0) return iceDataValue;
 	
@@ -7581,7 +9234,7 @@ OSErr TimeGridVelIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 
 	status = nc_inq_ndims(ncid, &numdims);
@@ -7604,15 +9257,7 @@ OSErr TimeGridVelIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	angle_count[0] = latlength;
 	angle_count[1] = lonlength;
 	
-	status = nc_inq_varid(ncid, "ang", &angle_id);
-	if (status != NC_NOERR) {/*err = -1; goto done;*/bRotated = false;}
-	else
-	{
-		angle_vals = new double[latlength*lonlength]; 
-		if(!angle_vals) {TechError("TimeGridVelIce_c::ReadTimeData()", "new[ ]", 0); err = memFullErr; goto done;}
-		status = nc_get_vara_double(ncid, angle_id, angle_index, angle_count, angle_vals);
-		if (status != NC_NOERR) {/*err = -1; goto done;*/bRotated = false;}
-	}
+	// the ice velocities aren't rotated (see below), so the angles aren't read for every time
 	curr_uvals = new double[latlength*lonlength]; 
 	if(!curr_uvals) 
 	{
@@ -7628,19 +9273,19 @@ OSErr TimeGridVelIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 		goto done;
 	}
 
-	status = nc_inq_varid(ncid, "ice_u", &curr_ucmp_id);
+	status = InqVarID(ncid, "ice_u", &curr_ucmp_id);
 	if (status != NC_NOERR)
 	{
-		status = nc_inq_varid(ncid, "ICE_U", &curr_ucmp_id);
+		status = InqVarID(ncid, "ICE_U", &curr_ucmp_id);
 		if (status != NC_NOERR)
 		{
 			err = -1; goto done;
 		}
 	}
-	status = nc_inq_varid(ncid, "ice_v", &curr_vcmp_id);
+	status = InqVarID(ncid, "ice_v", &curr_vcmp_id);
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "ICE_V", &curr_vcmp_id);
+		status = InqVarID(ncid, "ICE_V", &curr_vcmp_id);
 		if (status != NC_NOERR) 
 		{
 			err = -1; goto done;
@@ -7678,8 +9323,6 @@ OSErr TimeGridVelIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	//if (status != NC_NOERR) {err = -1; goto done;}	// don't require
 	status = nc_get_att_double(ncid, curr_ucmp_id, "scale_factor", &scale_factor);
 
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	// NOTE: if allow fill_value as NaN need to be sure to check for it wherever fill_value is used
 	if (isnan(fill_value))
@@ -7775,7 +9418,7 @@ OSErr TimeGridVelIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOUB
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 
 	status = nc_inq_ndims(ncid, &numdims);
@@ -7811,19 +9454,19 @@ OSErr TimeGridVelIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOUB
 		goto done;
 	}
 
-	status = nc_inq_varid(ncid, "ice_thickness", &data_thickness_id);
+	status = InqVarID(ncid, "ice_thickness", &data_thickness_id);
 	if (status != NC_NOERR)
 	{
-		status = nc_inq_varid(ncid, "ICE_U", &data_thickness_id);
+		status = InqVarID(ncid, "ICE_U", &data_thickness_id);
 		if (status != NC_NOERR)
 		{
 			err = -1; goto done;
 		}
 	}
-	status = nc_inq_varid(ncid, "ice_fraction", &data_fraction_id);
+	status = InqVarID(ncid, "ice_fraction", &data_fraction_id);
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "ICE_V", &data_fraction_id);
+		status = InqVarID(ncid, "ICE_V", &data_fraction_id);
 		if (status != NC_NOERR) 
 		{
 			err = -1; goto done;
@@ -7864,8 +9507,6 @@ OSErr TimeGridVelIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOUB
 	status = nc_get_att_double(ncid, data_thickness_id, "scale_factor", &scale_factor1);
 	status = nc_get_att_double(ncid, data_fraction_id, "scale_factor", &scale_factor2);
 
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	// NOTE: if allow fill_value as NaN need to be sure to check for it wherever fill_value is used
 	if (isnan(fill_value))
@@ -7933,7 +9574,8 @@ done:
 
 OSErr TimeGridVelIce_c::GetIceFields(Seconds time, double *thickness, double *fraction)
 {	// use for curvilinear
-	double timeAlpha;
+	double timeAlpha = 1;
+	Boolean constantField;
 	Seconds startTime,endTime;
 	OSErr err = 0;
 	
@@ -7951,6 +9593,8 @@ OSErr TimeGridVelIce_c::GetIceFields(Seconds time, double *thickness, double *fr
 
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceFields);
+	if(err) return err;
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
 	if(!loaded) return -1;
@@ -7989,46 +9633,31 @@ OSErr TimeGridVelIce_c::GetIceFields(Seconds time, double *thickness, double *fr
 	}
 	
 	numCells = numTri / 2;
-	//for (i = 0 ; i< numTri; i++)
-	for (i = 0 ; i< numCells; i++)
-	{
-		triIndex = i*2;
-		if (bVelocitiesOnNodes)
-		{
-			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
-			//interpolationVal = triGrid -> GetInterpolationValues(refPoint.p);
-			//interpolationVal = triGrid -> GetInterpolationValuesFromIndex(i);
-			interpolationVal = triGrid -> GetInterpolationValuesFromIndex(triIndex);
-			if (interpolationVal.ptIndex1<0) {thickness[i] = 0;	fraction[i] = 0;}// should this be an error?
-			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
-			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
-			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
-		}
-		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			//index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-			//index = triGrid->GetRectIndexFromTriIndex2(i,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-			index = triGrid->GetRectIndexFromTriIndex2(triIndex,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-
-		if (index < 0) {thickness[i] = 0;	fraction[i] = 0;}// should this be an error?
-		
-		// Should check vs fFillValue
-		// Check for constant current 
-		if(((GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1) && index!=-1)
-		{
-				thickness[i] = GetStartFieldValue(index,1);
-				fraction[i] = GetStartFieldValue(index,2);
-		}
-		else if (index!=-1)// time varying current
+	if (!fIceProducts) fIceProducts = new IceFieldProducts;
+	if (!fIceProducts -> HasCellIndices(numCells))
+	{	// the cells' indices in the fields don't change with time
+		vector<long> cellIndex(numCells, -1);
+		for (i = 0 ; i< numCells; i++)
 		{
-			thickness[i] = timeAlpha*GetStartFieldValue(index,1) + (1-timeAlpha)*GetEndFieldValue(index,1);
-			fraction[i] = timeAlpha*GetStartFieldValue(index,2) + (1-timeAlpha)*GetEndFieldValue(index,2);
+			triIndex = i*2;
+			if (bVelocitiesOnNodes)
+			{
+				interpolationVal = triGrid -> GetInterpolationValuesFromIndex(triIndex);
+				index = interpolationVal.ptIndex1 >= 0 ? (*fVerdatToNetCDFH)[interpolationVal.ptIndex1] : -1;
+			}
+			else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
+				index = triGrid->GetRectIndexFromTriIndex2(triIndex,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			cellIndex[i] = index < 0 ? -1 : index;
 		}
-		if (thickness[i] == fFillValue) thickness[i] = 0.;
-		if (fraction[i] == fFillValue) fraction[i] = 0.;
-		//thickness[i] *= fVar.fileScaleFactor;	// doing this on read
-		//fraction[i] *= fVar.fileScaleFactor; // doing this on read
+		fIceProducts -> SetCellIndices(cellIndex);
 	}
+
+	// the cells' values of each slice are gathered once, only the blend is per time
+	constantField = (GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1;
+	fIceProducts -> LoadSlice(kIceStartSlice, fStartDataThickness.dataHdl, fStartDataFraction.dataHdl, fFillValue);
+	if (!constantField)
+		fIceProducts -> LoadSlice(kIceEndSlice, fEndDataThickness.dataHdl, fEndDataFraction.dataHdl, fFillValue);
+	fIceProducts -> GetFields(time, !constantField, timeAlpha, fFillValue, thickness, fraction);
 	return err;
 }
 
@@ -8054,6 +9683,8 @@ OSErr TimeGridVelIce_c::GetIceVelocities(Seconds time, VelocityFRec *ice_velocit
 	
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceVelocities);
+	if(err) return err;
 	
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
@@ -8091,52 +9722,180 @@ OSErr TimeGridVelIce_c::GetIceVelocities(Seconds time, VelocityFRec *ice_velocit
 			timeAlpha = (endTime - time)/(double)(endTime - startTime);
 		}
 	}
-	
-	for (i = 0 ; i< numTri; i++)
+	
+	for (i = 0 ; i< numTri; i++)
+	{
+		if (bVelocitiesOnNodes)
+		{
+			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
+			//interpolationVal = triGrid -> GetInterpolationValues(refPoint.p);
+			interpolationVal = triGrid -> GetInterpolationValuesFromIndex(i);
+			if (interpolationVal.ptIndex1<0) {ice_velocity[i].u = 0;	ice_velocity[i].v = 0;}// should this be an error?
+			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
+			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
+			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
+			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
+		}
+		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
+			//index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			index = triGrid->GetRectIndexFromTriIndex2(i,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+
+		if (index < 0) {ice_velocity[i].u = 0;	ice_velocity[i].v = 0;}// should this be an error?
+		
+		// Should check vs fFillValue
+		// Check for constant current 
+		if(((GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1) && index!=-1)
+		{
+				velocity.u = GetStartIceUVelocity(index);
+				velocity.v = GetStartIceVVelocity(index);
+		}
+		else if (index!=-1)// time varying current
+		{
+			velocity.u = timeAlpha*GetStartIceUVelocity(index) + (1-timeAlpha)*GetEndIceUVelocity(index);
+			velocity.v = timeAlpha*GetStartIceVVelocity(index) + (1-timeAlpha)*GetEndIceVVelocity(index);
+		}
+		if (velocity.u == fFillValue) velocity.u = 0.;
+		if (velocity.v == fFillValue) velocity.v = 0.;
+		/*if ((velocity.u != 0 || velocity.v != 0) && (velocity.u != fFillValue && velocity.v != fFillValue)) // should already have handled fill value issue
+		{
+			// code goes here, fill up arrays with data
+			float inchesX = (velocity.u * refScale * fVar.fileScaleFactor) / arrowScale;
+			float inchesY = (velocity.v * refScale * fVar.fileScaleFactor) / arrowScale;
+		}*/
+		//u[i] = velocity.u * fVar.fileScaleFactor;
+		//v[i] = velocity.v * fVar.fileScaleFactor;
+		ice_velocity[i].u = velocity.u * fVar.fileScaleFactor;
+		ice_velocity[i].v = velocity.v * fVar.fileScaleFactor;
+	}
+	return err;
+}
+
+OSErr TimeGridVelIce_c::get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints)
+{
+	OSErr err = 0;
+	char errmsg[256];
+	
+	if (n > 0 && ref && vels)
+	{
+		if ((err = this -> SetInterval(errmsg, model_time)))
+			return err;
+		if ((err = LoadIceFields(errmsg, kIceVelocities | kIceFields)))
+			return err;
+		if ((err = PrepareMovementField(model_time)))
+			return err;
+	}
+	
+	return TimeGridVel_c::get_values(n, model_time, ref, vels, hints);
+}
+
+void TimeGridVelIce_c::SetMovementFieldMode(bool useField)
+{
+	fUseMovementField = useField;
+	if (!useField)
+		DisposeMovementField();
+}
+
+void TimeGridVelIce_c::DisposeMovementField()
+{
+	if(fMovementH) {DisposeHandle((Handle)fMovementH); fMovementH=0;}
+	fMovementValid = false;
+}
+
+// blend the loaded ice and water velocities by the ice coverage at model_time,
+// a velocity per cell, using the same expressions as the per LE code so the
+// velocities come out identical. The blend isn't linear in the fraction, so
+// it is done for each step's time rather than blended once per interval
+OSErr TimeGridVelIce_c::PrepareMovementField(const Seconds& model_time)
+{
+	double timeAlpha = 1, frac_coverage, max_coverage = .8, min_coverage = .2, fracAlpha;
+	Seconds startTime, endTime;
+	Boolean constantField;
+	long i, numValues;
+	VelocityRec iceVelocity, currentVelocity;
+
+	// the per LE lookups of the other grids interpolate between nodes or depths
+	if (!fUseMovementField || bVelocitiesOnNodes || (fDepthLevelsHdl && GetNumDepthLevelsInFile() > 0) ||
+		!fGrid || !fStartData.dataHdl || !fStartDataIce.dataHdl || !fStartDataFraction.dataHdl)
+	{
+		fMovementValid = false;
+		return 0;
+	}
+
+	if (fMovementValid && fMovementTime == model_time)
+		return 0;
+
+	constantField = IsConstantField(model_time);
+	if (!constantField && (!fEndData.dataHdl || !fEndDataIce.dataHdl || !fEndDataFraction.dataHdl))
+	{
+		fMovementValid = false;
+		return 0;
+	}
+
+	// the per LE code reads all of them at the same index
+	numValues = _GetHandleSize((Handle)fStartData.dataHdl)/sizeof(**fStartData.dataHdl);
+	numValues = _min(numValues, (long)(_GetHandleSize((Handle)fStartDataIce.dataHdl)/sizeof(**fStartDataIce.dataHdl)));
+	numValues = _min(numValues, (long)(_GetHandleSize((Handle)fStartDataFraction.dataHdl)/sizeof(**fStartDataFraction.dataHdl)));
+	if (!constantField)
+	{
+		numValues = _min(numValues, (long)(_GetHandleSize((Handle)fEndData.dataHdl)/sizeof(**fEndData.dataHdl)));
+		numValues = _min(numValues, (long)(_GetHandleSize((Handle)fEndDataIce.dataHdl)/sizeof(**fEndDataIce.dataHdl)));
+		numValues = _min(numValues, (long)(_GetHandleSize((Handle)fEndDataFraction.dataHdl)/sizeof(**fEndDataFraction.dataHdl)));
+
+		// Calculate the time weight factor
+		if (GetNumFiles()>1 && fOverLap)
+			startTime = fOverLapStartTime + fTimeShift;
+		else
+			startTime = (*fTimeHdl)[fStartData.timeIndex] + fTimeShift;
+		endTime = (*fTimeHdl)[fEndData.timeIndex] + fTimeShift;
+		timeAlpha = (endTime - model_time)/(double)(endTime - startTime);
+	}
+
+	if (!fMovementH || _GetHandleSize((Handle)fMovementH) != numValues*(long)sizeof(VelocityRec))
+	{
+		DisposeMovementField();
+		fMovementH = (VelocityH)_NewHandleClear(numValues*sizeof(VelocityRec));
+		if (!fMovementH) {TechError("TimeGridVelIce_c::PrepareMovementField()", "_NewHandleClear()", 0); return memFullErr;}
+	}
+
+	for (i = 0; i < numValues; i++)
 	{
-		if (bVelocitiesOnNodes)
+		if (constantField)
 		{
-			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
-			//interpolationVal = triGrid -> GetInterpolationValues(refPoint.p);
-			interpolationVal = triGrid -> GetInterpolationValuesFromIndex(i);
-			if (interpolationVal.ptIndex1<0) {ice_velocity[i].u = 0;	ice_velocity[i].v = 0;}// should this be an error?
-			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
-			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
-			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
+			currentVelocity.u = INDEXH(fStartData.dataHdl,i).u;
+			currentVelocity.v = INDEXH(fStartData.dataHdl,i).v;
+			iceVelocity.u = INDEXH(fStartDataIce.dataHdl,i).u;
+			iceVelocity.v = INDEXH(fStartDataIce.dataHdl,i).v;
+			frac_coverage = INDEXH(fStartDataFraction.dataHdl,i);
 		}
-		else // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			//index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-			index = triGrid->GetRectIndexFromTriIndex2(i,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-
-		if (index < 0) {ice_velocity[i].u = 0;	ice_velocity[i].v = 0;}// should this be an error?
-		
-		// Should check vs fFillValue
-		// Check for constant current 
-		if(((GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1) && index!=-1)
+		else
 		{
-				velocity.u = GetStartIceUVelocity(index);
-				velocity.v = GetStartIceVVelocity(index);
-		}
-		else if (index!=-1)// time varying current
+			currentVelocity.u = timeAlpha*INDEXH(fStartData.dataHdl,i).u + (1-timeAlpha)*INDEXH(fEndData.dataHdl,i).u;
+			currentVelocity.v = timeAlpha*INDEXH(fStartData.dataHdl,i).v + (1-timeAlpha)*INDEXH(fEndData.dataHdl,i).v;
+			iceVelocity.u = timeAlpha*INDEXH(fStartDataIce.dataHdl,i).u + (1-timeAlpha)*INDEXH(fEndDataIce.dataHdl,i).u;
+			iceVelocity.v = timeAlpha*INDEXH(fStartDataIce.dataHdl,i).v + (1-timeAlpha)*INDEXH(fEndDataIce.dataHdl,i).v;
+			frac_coverage = timeAlpha*INDEXH(fStartDataFraction.dataHdl,i) + (1-timeAlpha)*INDEXH(fEndDataFraction.dataHdl,i);
+		}
+		currentVelocity.u *= fVar.fileScaleFactor;
+		currentVelocity.v *= fVar.fileScaleFactor;
+		iceVelocity.u *= fVar.fileScaleFactor;
+		iceVelocity.v *= fVar.fileScaleFactor;
+
+		if (frac_coverage >= max_coverage)
+			INDEXH(fMovementH,i) = iceVelocity;
+		else if (frac_coverage <= min_coverage)
+			INDEXH(fMovementH,i) = currentVelocity;
+		else
 		{
-			velocity.u = timeAlpha*GetStartIceUVelocity(index) + (1-timeAlpha)*GetEndIceUVelocity(index);
-			velocity.v = timeAlpha*GetStartIceVVelocity(index) + (1-timeAlpha)*GetEndIceVVelocity(index);
+			fracAlpha = (.8 - frac_coverage)/(double)(max_coverage - min_coverage);
+			INDEXH(fMovementH,i).u = fracAlpha*currentVelocity.u + (1 - fracAlpha)*iceVelocity.u;
+			INDEXH(fMovementH,i).v = fracAlpha*currentVelocity.v + (1 - fracAlpha)*iceVelocity.v;
 		}
-		if (velocity.u == fFillValue) velocity.u = 0.;
-		if (velocity.v == fFillValue) velocity.v = 0.;
-		/*if ((velocity.u != 0 || velocity.v != 0) && (velocity.u != fFillValue && velocity.v != fFillValue)) // should already have handled fill value issue
-		{
-			// code goes here, fill up arrays with data
-			float inchesX = (velocity.u * refScale * fVar.fileScaleFactor) / arrowScale;
-			float inchesY = (velocity.v * refScale * fVar.fileScaleFactor) / arrowScale;
-		}*/
-		//u[i] = velocity.u * fVar.fileScaleFactor;
-		//v[i] = velocity.v * fVar.fileScaleFactor;
-		ice_velocity[i].u = velocity.u * fVar.fileScaleFactor;
-		ice_velocity[i].v = velocity.v * fVar.fileScaleFactor;
 	}
-	return err;
+
+	fMovementTime = model_time;
+	fMovementValid = true;
+
+	return 0;
 }
 
 OSErr TimeGridVelIce_c::GetMovementVelocities(Seconds time, VelocityFRec *movement_velocity)
@@ -8162,6 +9921,8 @@ OSErr TimeGridVelIce_c::GetMovementVelocities(Seconds time, VelocityFRec *moveme
 
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceVelocities | kIceFields);
+	if(err) return err;
 	
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
@@ -8283,6 +10044,7 @@ TimeGridVelTri_c::TimeGridVelTri_c () : TimeGridVelCurv_c(), TimeGridVel_c()
 	fNumNodes = 0;
 	fNumEles = 0;
 	bVelocitiesOnTriangles = false;
+	fDepthTables = 0;
 }
 
 LongPointHdl TimeGridVelTri_c::GetPointsHdl()
@@ -8292,6 +10054,7 @@ LongPointHdl TimeGridVelTri_c::GetPointsHdl()
 
 void TimeGridVelTri_c::Dispose ()
 {
+	if(fDepthTables) {delete fDepthTables; fDepthTables=0;}
 	TimeGridVelCurv_c::Dispose ();
 }
 
@@ -8307,6 +10070,24 @@ float TimeGridVelTri_c::GetTotalDepth(WorldPoint refPoint, long triNum)
 	}
 	return totalDepth; // this should be an error
 }
+
+// the tables of the depth data now, 0 without any
+TriDepthTables *TimeGridVelTri_c::GetDepthTables()
+{
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	TDagTree *dagTree = triGrid ? triGrid->GetDagTree() : 0;
+	TopologyHdl topH = dagTree ? dagTree->GetTopologyHdl() : 0;
+
+	if (!fDepthDataInfo) return 0;
+
+	if (!fDepthTables) fDepthTables = new TriDepthTables();
+	if (!fDepthTables->IsFor(fDepthDataInfo,fDepthsH,topH,fVerdatToNetCDFH) &&
+		fDepthTables->Build(fDepthDataInfo,fDepthsH,topH,fVerdatToNetCDFH))
+		return 0;
+
+	return fDepthTables;
+}
+
 // probably eventually switch to base class
 
 void TimeGridVelTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2)
@@ -8345,8 +10126,14 @@ void TimeGridVelTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *d
 		case MULTILAYER: //
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{	// if depths are measured from the bottom this is confusing
-				long j;
-				for(j=0;j<numDepths-1;j++)
+				long j, k1, k2;
+				Boolean inOrder = fDepthTables && fDepthTables->IsForNodes(fDepthDataInfo,fDepthsH) && fDepthTables->LevelsAscending(ptIndex);
+				if (inOrder && BisectNodeLevels(*fDepthsH + indexToDepthData,numDepths,depthAtPoint,&k1,&k2))
+				{
+					*depthIndex1 = indexToDepthData+k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+				}
+				for(j=0;!inOrder && j<numDepths-1;j++)
 				{
 					if(INDEXH(fDepthsH,indexToDepthData+j)<depthAtPoint &&
 					   depthAtPoint<=INDEXH(fDepthsH,indexToDepthData+j+1))
@@ -8385,8 +10172,14 @@ void TimeGridVelTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *d
 		case SIGMA: // should rework the sigma to match Gnome_beta's simpler method
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{
-				long j;
-				for(j=0;j<numDepths-1;j++)
+				long j, k1, k2;
+				Boolean inOrder = fDepthTables && fDepthTables->IsForNodes(fDepthDataInfo,fDepthsH) && fDepthTables->LevelsAscending(ptIndex);
+				if (inOrder && BisectNodeLevels(*fDepthsH + indexToDepthData,numDepths,depthAtPoint,&k1,&k2))
+				{
+					*depthIndex1 = indexToDepthData+k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+				}
+				for(j=0;!inOrder && j<numDepths-1;j++)
 				{
 					if(INDEXH(fDepthsH,indexToDepthData+j)<depthAtPoint &&
 					   depthAtPoint<=INDEXH(fDepthsH,indexToDepthData+j+1))
@@ -8430,18 +10223,28 @@ void TimeGridVelTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *d
 }
 
 VelocityRec TimeGridVelTri_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint)
+{
+	return GetScaledPatValue(model_time, refPoint, 0);
+}
+
+VelocityRec TimeGridVelTri_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint, long *triHint)
 {
 	double timeAlpha, depth = refPoint.z;
 	long ptIndex1,ptIndex2,ptIndex3,triIndex; 
-	long index = -1; 
+	long index = -1, triNum = -1; 
 	Seconds startTime,endTime, relTime;
 	InterpolationVal interpolationVal;
 	VelocityRec scaledPatVelocity = {0.,0.};
 	OSErr err = 0;
 	
 	// Get the interpolation coefficients, alpha1,ptIndex1,alpha2,ptIndex2,alpha3,ptIndex3
+	// (the triangle found is kept for the depth tables)
 	if (!bVelocitiesOnTriangles)
-		interpolationVal = fGrid -> GetInterpolationValues(refPoint.p);
+	{
+		if (triHint) triNum = *triHint;
+		interpolationVal = fGrid -> GetInterpolationValues(refPoint.p, &triNum);
+		if (triHint) *triHint = triNum;
+	}
 	else
 	{
 		LongPoint lp;
@@ -8450,7 +10253,7 @@ VelocityRec TimeGridVelTri_c::GetScaledPatValue(const Seconds& model_time, World
 		if(!dagTree) return scaledPatVelocity;
 		lp.h = refPoint.p.pLong;
 		lp.v = refPoint.p.pLat;
-		triIndex = dagTree -> WhatTriAmIIn(lp);
+		triIndex = dagTree -> WhatTriAmIIn(lp, triHint);
 		interpolationVal.ptIndex1 = -1;
 	}
 	
@@ -8477,7 +10280,7 @@ VelocityRec TimeGridVelTri_c::GetScaledPatValue(const Seconds& model_time, World
 	// what kind of weird things can triangles do below the surface ??
 	if (depth>0 && interpolationVal.ptIndex1 >= 0) 
 	{
-		scaledPatVelocity = GetScaledPatValue3D(model_time, interpolationVal,depth);
+		scaledPatVelocity = GetScaledPatValue3D(model_time, interpolationVal,depth,triNum);
 		goto scale;
 	}						
 	if (depth > 0) return scaledPatVelocity;	// set subsurface spill with no subsurface velocity
@@ -8573,7 +10376,100 @@ scale:
 	return scaledPatVelocity;
 }
 
+void TimeGridVelTri_c::GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+{
+	long i, j, numSurface = 0;
+	double timeAlpha = 1;
+	VelocityFH endH = 0;
+	InterpolationVal interpolationVal;
+
+	// the kernel does surface LEs with velocities on the nodes
+	if (!fGrid || bVelocitiesOnTriangles || !fStartData.dataHdl || n <= 0)
+	{
+		TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+		return;
+	}
+
+	if (!IsConstantField(model_time))
+	{
+		if (!fEndData.dataHdl)
+		{
+			TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);
+			return;
+		}
+		timeAlpha = GetTimeAlpha(model_time);
+		endH = fEndData.dataHdl;
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		if (refPoints[i].z <= 0)
+			numSurface++;
+	}
+
+	// LEs below the surface interpolate in depth, one at a time
+	if (numSurface < n)
+	{
+		TIME_SECTION(&fTiming, kTimerInterpolate, n - numSurface);	// location included
+		for (i = 0; i < n; i++)
+		{
+			if (refPoints[i].z > 0)
+				vel[i] = GetScaledPatValue(model_time, refPoints[i], triHints ? &triHints[i] : 0);
+		}
+	}
+	if (numSurface == 0) return;
+
+	vector<long> surface(numSurface);
+	vector<long> ptIndex(3 * numSurface, -1);
+	vector<double> alpha(3 * numSurface, 0.);
+	vector<VelocityRec> surfaceVel(numSurface);
+	{
+		TIME_SECTION(&fTiming, kTimerLocate, numSurface);
+		for (i = 0, j = 0; i < n; i++)
+		{
+			if (refPoints[i].z > 0) continue;
+			surface[j] = i;
+			interpolationVal = fGrid -> GetInterpolationValues(refPoints[i].p, triHints ? &triHints[i] : 0);
+			if (interpolationVal.ptIndex1 >= 0)
+			{
+				ptIndex[j] = interpolationVal.ptIndex1;
+				ptIndex[numSurface + j] = interpolationVal.ptIndex2;
+				ptIndex[2 * numSurface + j] = interpolationVal.ptIndex3;
+				if (fVerdatToNetCDFH)
+				{
+					ptIndex[j] = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
+					ptIndex[numSurface + j] = (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
+					ptIndex[2 * numSurface + j] = (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
+				}
+				alpha[j] = interpolationVal.alpha1;
+				alpha[numSurface + j] = interpolationVal.alpha2;
+				alpha[2 * numSurface + j] = interpolationVal.alpha3;
+			}
+			j++;
+		}
+	}
+
+	TIME_SECTION(&fTiming, kTimerInterpolate, numSurface);
+	InterpolateBarycentric(numSurface, &ptIndex[0], &alpha[0], fStartData.dataHdl, endH, timeAlpha, &surfaceVel[0]);
+
+	// LEs off the grid keep the unscaled zero, as in GetScaledPatValue
+	for (j = 0; j < numSurface; j++)
+	{
+		if (ptIndex[j] >= 0)
+		{
+			surfaceVel[j].u *= fVar.fileScaleFactor;
+			surfaceVel[j].v *= fVar.fileScaleFactor;
+		}
+		vel[surface[j]] = surfaceVel[j];
+	}
+}
+
 VelocityRec TimeGridVelTri_c::GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth)
+{
+	return GetScaledPatValue3D(model_time, interpolationVal, depth, -1);
+}
+
+VelocityRec TimeGridVelTri_c::GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth,long triNum)
 {
 	// figure out which depth values the LE falls between
 	// will have to interpolate in lat/long for both levels first
@@ -8609,6 +10505,11 @@ VelocityRec TimeGridVelTri_c::GetScaledPatValue3D(const Seconds& model_time, Int
 	if (fDepthDataInfo) amtOfDepthData = _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo);
  	if (amtOfDepthData>0)
  	{
+		// below the bottom at all three points there is no velocity (but 2D data has none)
+		TriDepthTables *tables = GetDepthTables();
+		if (tables && fVar.gridType != TWO_D && tables->BelowBottom(triNum,depth))
+			return scaledPatVelocity;
+
 		GetDepthIndices(ptIndex1,depth,&pt1depthIndex1,&pt1depthIndex2);	
 		GetDepthIndices(ptIndex2,depth,&pt2depthIndex1,&pt2depthIndex2);	
 		GetDepthIndices(ptIndex3,depth,&pt3depthIndex1,&pt3depthIndex2);	
@@ -8772,6 +10673,7 @@ VelocityRec TimeGridVelTri_c::GetScaledPatValue3D(const Seconds& model_time, Int
 
 OSErr TimeGridVelTri_c::TextRead(const char *path, const char *topFilePath)
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	// needs to be updated once triangle grid format is set
 
 	OSErr err = 0;
@@ -9416,6 +11318,7 @@ done:
 			sigmaLevelsH = 0;
 		}
 	}
+	SetDepthLevelOrder();
 	
 	if (timeUnits)
 		delete [] timeUnits;
@@ -9462,13 +11365,13 @@ OSErr TimeGridVelTri_c::ReadTimeData(long index,VelocityFH *velocityH, char* err
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	/*if (status != NC_NOERR)
 	{
 #if TARGET_API_MAC_CARBON
 		err = ConvertTraditionalPathToUnixPath((const char *) path, outPath, kMaxNameLen) ;
-		status = nc_open(outPath, NC_NOWRITE, &ncid);
+		status = OpenTimeDataFile(outPath, &ncid);
 #endif
 		if (status != NC_NOERR) {err = -1; goto done;}
 	}*/
@@ -9490,9 +11393,9 @@ OSErr TimeGridVelTri_c::ReadTimeData(long index,VelocityFH *velocityH, char* err
 	{
 		curr_count[1] = numNodes;	
 	}
-	status = nc_inq_varid(ncid, "u", &curr_ucmp_id);
+	status = InqVarID(ncid, "u", &curr_ucmp_id);
 	if (status != NC_NOERR) {err = -1; goto done;}
-	status = nc_inq_varid(ncid, "v", &curr_vcmp_id);
+	status = InqVarID(ncid, "v", &curr_vcmp_id);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	status = nc_inq_varndims(ncid, curr_ucmp_id, &uv_ndims);
 	if (status==NC_NOERR){if (numdims < 6 && uv_ndims==3) {curr_count[1] = numDepths; curr_count[2] = numNodes;}}	// could have more dimensions than are used in u,v
@@ -9523,9 +11426,9 @@ OSErr TimeGridVelTri_c::ReadTimeData(long index,VelocityFH *velocityH, char* err
 	curr_vvals = new float[totalNumberOfVels]; 
 	if(!curr_vvals) {TechError("TimeGridVelTri_c::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
 	
-	status = nc_get_vara_float(ncid, curr_ucmp_id, curr_index, curr_count, curr_uvals);
+	status = GetVaraCached(ncid, path, curr_ucmp_id, curr_index, curr_count, curr_uvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
-	status = nc_get_vara_float(ncid, curr_vcmp_id, curr_index, curr_count, curr_vvals);
+	status = GetVaraCached(ncid, path, curr_vcmp_id, curr_index, curr_count, curr_vvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	status = nc_get_att_float(ncid, curr_ucmp_id, "missing_value", &fill_value);// missing_value vs _FillValue
 	if (status != NC_NOERR) {/*err = -1; goto done;*/fill_value=-9999.;}
@@ -9533,8 +11436,6 @@ OSErr TimeGridVelTri_c::ReadTimeData(long index,VelocityFH *velocityH, char* err
 	//if (status != NC_NOERR) {err = -1; goto done;}
 	status = nc_get_att_float(ncid, curr_ucmp_id, "dry_value", &dry_value);// missing_value vs _FillValue
 	if (status != NC_NOERR) {/*err = -1; goto done;*/}  
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	velH = (VelocityFH)_NewHandleClear(totalNumberOfVels * sizeof(VelocityFRec));
 	if (!velH) {err = memFullErr; goto done;}
@@ -9610,6 +11511,7 @@ done:
 
 OSErr TimeGridVelTri_c::ReorderPoints2(long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts, long *tri_verts, long *tri_neighbors, long ntri, Boolean isCCW) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i, n, nv = fNumNodes;
 	long currentBoundary;
@@ -9899,6 +11801,7 @@ done:
 
 OSErr TimeGridVelTri_c::ReorderPoints(long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i, n, nv = fNumNodes;
 	long currentBoundary;
@@ -10200,8 +12103,9 @@ long TimeGridVelTri_c::GetNumDepthLevels()
 
 // import NetCDF triangle info so don't have to regenerate
 // this is same as curvilinear mover so may want to combine later
-OSErr TimeGridVelTri_c::ReadTopology(vector<string> &linesInFile)
+OSErr TimeGridVelTri_c::ReadTopology(TextLines &linesInFile)
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 
 	string currentLine;
@@ -10437,11 +12341,20 @@ done:
 }
 
 
+OSErr TimeGridVelTri_c::ReadTopology(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTopology(lines);
+}
+
+
 // import NetCDF triangle info so don't have to regenerate
 // this is same as curvilinear mover so may want to combine later
 OSErr TimeGridVelTri_c::ReadTopology(const char *path)
 {
-	vector<string> linesInFile;
+	MemoryTag memoryTag(kMemTopology);
+	TextLines linesInFile;
 
 	ReadLinesInFile(path, linesInFile);
 	return ReadTopology(linesInFile);
@@ -11149,6 +13062,12 @@ OSErr ScanFileForTimes(char *path,Seconds ***timeH)
 	outPath[0] = 0;
 	errmsg[0] = 0;
 
+	// the times of a file indexed on an earlier open
+	if (!ReadTimeIndexCache(path, timeH))
+		return noErr;
+
+	SetupStage setupStage(kSetupTimeScan);
+
 	status = nc_open(path, NC_NOWRITE, &ncid);
 	// code goes here, will need to resolve file paths to unix paths in readinputfilenames
 	if (status != NC_NOERR) /*{err = -1; goto done;}*/
@@ -11228,6 +13147,8 @@ OSErr ScanFileForTimes(char *path,Seconds ***timeH)
 	status = nc_close(ncid);
 	if (status != NC_NOERR) {err = -2; goto done;}
 
+	WriteTimeIndexCache(path, timeHdl);	// not fatal if this fails
+
 
 done:
 	if (err)
@@ -11334,169 +13255,107 @@ done:
 }*/
 
 
-OSErr ScanFileForTimes(char *path,
-					   PtCurTimeDataHdl *timeDataH, Seconds ***timeH)
+// the [TIME] blocks of an ASCII file in one pass over it. The file is mapped,
+// so a time block is a reach of the text, from its [TIME line to the next
+static OSErr ScanTimeBlocks(char *path, PtCurTimeDataHdl *timeDataH)
 {
-	vector<string> linesInFile;
+	OSErr err = 0;
+	MappedText text;
+	vector<PtCurTimeData> blocks;
+	const char *start, *p, *end;
+	PtCurTimeDataHdl timeDataHdl = 0;
 
-	ReadLinesInFile(path, linesInFile);
-	//return ScanFileForTimes(linesInFile, timeDataH, timeH);
-	return ScanFileForTimes(path, linesInFile, timeDataH, timeH);
+	if (!text.Open(path))
+	{ err = -1; TechError("ScanFileForTimes()", "MappedText::Open()", 0); goto done; }
+
+	start = text.text();
+	end = text.size() > 5 ? start + text.size() - 5 : start;
+	for (p = start; (p = (const char *)memchr(p, '[', end - p)) != 0; p++)
+	{
+		PtCurTimeData timeData;
+		DateTimeRec time;
+		char timeLine[128];
+		size_t n = start + text.size() - (p + 6);
+
+		if (memcmp(p + 1, "TIME", 4) != 0)
+			continue;
+
+		// sscanf wants a C string, and the mapped text isn't one
+		if (n > sizeof(timeLine) - 1)
+			n = sizeof(timeLine) - 1;
+		memcpy(timeLine, p + 6, n);
+		timeLine[n] = 0;
+
+		if (sscanf(timeLine, "%hd %hd %hd %hd %hd",
+				   &time.day, &time.month, &time.year,
+				   &time.hour, &time.minute) != 5)
+		{ err = -1; TechError("GridCurMover::TextRead()", "sscanf() == 5", 0); goto done; }
+
+		memset(&timeData, 0, sizeof(timeData));
+		timeData.fileOffsetToStartOfData = p - start;
+
+		// check for constant current
+		if (DateValuesAreMinusOne(time))
+			timeData.time = CONSTANTCURRENT;
+		else {
+			CorrectTwoDigitYear(time);
+			time.second = 0;
+			DateToSeconds(&time, &timeData.time);
+		}
+
+		if (!blocks.empty())
+			blocks.back().lengthOfData = timeData.fileOffsetToStartOfData - blocks.back().fileOffsetToStartOfData;
+		blocks.push_back(timeData);
+	}
+	if (!blocks.empty())  // last block goes to end of file
+		blocks.back().lengthOfData = text.size() - blocks.back().fileOffsetToStartOfData;
+
+	timeDataHdl = (PtCurTimeDataHdl)_NewHandle(blocks.size() * sizeof(PtCurTimeData));
+	if (!timeDataHdl) { TechError("ScanFileForTimes()", "_NewHandle()", 0); err = memFullErr; goto done; }
+	if (!blocks.empty())
+		memcpy(*timeDataHdl, &blocks[0], blocks.size() * sizeof(PtCurTimeData));
+
+	*timeDataH = timeDataHdl;
+
+done:
+	return err;
 }
 
-// for large ascii files need to be able to seek to the file position rather
-// than read in the whole file every time or the run gets really slow
-// if there is a way to seek for a line number then the newer code can be used
-// changes also in ReadTimeData for TimeGridCurRect and TimeGridCurTri
-// 
-OSErr ScanFileForTimes(char * path, vector<string> &linesInFile,
+
+// The blocks come from the time index when it has the file, so a model on a
+// large PtCur or grid current file only scans it the first time. The data
+// of a time is read from its block alone, by ReadTimeData of TimeGridCurRect
+// and TimeGridCurTri
+OSErr ScanFileForTimes(char *path,
 					   PtCurTimeDataHdl *timeDataH, Seconds ***timeH)
-//OSErr ScanFileForTimes(char *path, PtCurTimeDataHdl *timeDataH, Seconds ***timeH)
 {
-	// scan through the file looking for times "[TIME "  (close file if necessary...)
-	
 	OSErr err = 0;
-	CHARH h = 0;
-	char *sectionOfFile = 0;
-	
-	long fileLength,lengthRemainingToScan,offset;
-	long lengthToRead,lengthOfPartToScan,numTimeBlocks=0;
-	long i, numScanned;
-	DateTimeRec time;
-	Seconds timeSeconds;	
-	
-	// allocate an empty handle
-	PtCurTimeDataHdl timeDataHdl;
-	timeDataHdl = (PtCurTimeDataHdl)_NewHandle(0);
-	if(!timeDataHdl) {TechError("ScanFileForTimes()", "_NewHandle()", 0); err = memFullErr; goto done;}
+	PtCurTimeDataHdl timeDataHdl = 0;
+	Seconds **timeHdl = 0;
+	long i, numTimeBlocks;
 
-	// allocate an empty handle
-	Seconds **timeHdl;
-	timeHdl = (Seconds**)_NewHandle(0);
-	if(!timeHdl) {TechError("ScanFileForTimes()", "_NewHandle()", 0); err = memFullErr; goto done;}
-	
-	// think in terms of 100K blocks, allocate 101K, read 101K, scan 100K
-	
-#define kGridCurFileBufferSize  100000 // code goes here, increase to 100K or more
-#define kGridCurFileBufferExtraCharSize  256
-	
-	err = MyGetFileSize(0,0,path,&fileLength);
-	if(err) goto done;
-	
-	offset = 0;
-	lengthRemainingToScan = fileLength - 5;
-	// loop until whole file is read 
-	
-	h = (CHARH)_NewHandle(2* kGridCurFileBufferSize+1);
-	if(!h){TechError("ScanFileForTimes()", "_NewHandle()", 0); err = memFullErr; goto done;}
-	
-	_HLock((Handle)h);
-	sectionOfFile = *h;
-	
-	while (lengthRemainingToScan>0)
-	{
-		if(lengthRemainingToScan > 2* kGridCurFileBufferSize)
-		{
-			lengthToRead = kGridCurFileBufferSize + kGridCurFileBufferExtraCharSize; 
-			lengthOfPartToScan = kGridCurFileBufferSize; 		
-		}
-		else
-		{
-			// deal with it in one piece
-			// just read the rest of the file
-			lengthToRead = fileLength - offset;
-			lengthOfPartToScan = lengthToRead - 5; 
-		}
-		
-		err = ReadSectionOfFile(0,0,path,offset,lengthToRead,sectionOfFile,0);
-		if(err || !h) goto done;
-		sectionOfFile[lengthToRead] = 0; // make it a C string
-		
-		lengthRemainingToScan -= lengthOfPartToScan;
-		
-		
-		// scan 100K chars of the buffer for '['
-		for(i = 0; i < lengthOfPartToScan; i++)
-		{
-			if(	sectionOfFile[i] == '[' 
-			   && sectionOfFile[i+1] == 'T'
-			   && sectionOfFile[i+2] == 'I'
-			   && sectionOfFile[i+3] == 'M'
-			   && sectionOfFile[i+4] == 'E')
-			{
-				// read and record the time and filePosition
-				PtCurTimeData timeData;
-				memset(&timeData,0,sizeof(timeData));
-				timeData.fileOffsetToStartOfData = i + offset;
-				
-				if (numTimeBlocks > 0) 
-				{
-					(*timeDataHdl)[numTimeBlocks-1].lengthOfData = i+offset - (*timeDataHdl)[numTimeBlocks-1].fileOffsetToStartOfData;					
-				}
-				// some sort of a scan
-				numScanned=sscanf(sectionOfFile+i+6, "%hd %hd %hd %hd %hd",
-								  &time.day, &time.month, &time.year,
-								  &time.hour, &time.minute) ;
-				if (numScanned != 5)
-				{ err = -1; TechError("GridCurMover::TextRead()", "sscanf() == 5", 0); goto done; }
-				// check for constant current
-				if (time.day == -1 && time.month == -1 && time.year == -1 && time.hour == -1 && time.minute == -1)
-					//if (time.day == time.month == time.year == time.hour == time.minute == -1)
-				{
-					timeSeconds = CONSTANTCURRENT;
-					//setStartTime = false;
-				}
-				else // time varying current
-				{
-					if (time.year < 1900)					// two digit date, so fix it
-					{
-						if (time.year >= 40 && time.year <= 99)	
-							time.year += 1900;
-						else
-							time.year += 2000;					// correct for year 2000 (00 to 40)
-					}
-					
-					time.second = 0;
-					DateToSeconds (&time, &timeSeconds);
-				}
-				
-				timeData.time = timeSeconds;
-				
-				// if we don't know the number of times ahead of time
-				_SetHandleSize((Handle) timeDataHdl, (numTimeBlocks+1)*sizeof(timeData));
-				if (_MemError()) { TechError("ScanFileForTimes()", "_SetHandleSize()", 0); goto done; }
-				_SetHandleSize((Handle) timeHdl, (numTimeBlocks+1)*sizeof(Seconds));
-				if (_MemError()) { TechError("ScanFileForTimes()", "_SetHandleSize()", 0); goto done; }
-				/*if (numTimeBlocks==0 && setStartTime) 
-				{	// set the default times to match the file
-					model->SetModelTime(timeSeconds);
-					model->SetStartTime(timeSeconds);
-					model->NewDirtNotification(DIRTY_RUNBAR); // must reset the runbar
-				}*/
-				//(*timeDataHdl)[numTimeBlocks++] = timeData;				
-				(*timeDataHdl)[numTimeBlocks] = timeData;				
-				(*timeHdl)[numTimeBlocks] = timeData.time;		
-				numTimeBlocks++;
-			}
-		}
-		offset += lengthOfPartToScan;
-	}
-	if (numTimeBlocks > 0)  // last block goes to end of file
+	if (ReadTimeDataIndexCache(path, &timeDataHdl) != noErr)
 	{
-		(*timeDataHdl)[numTimeBlocks-1].lengthOfData = fileLength - (*timeDataHdl)[numTimeBlocks-1].fileOffsetToStartOfData;				
+		SetupStage setupStage(kSetupTimeScan);
+
+		timeDataHdl = 0;
+		err = ScanTimeBlocks(path, &timeDataHdl);
+		if (err) goto done;
+
+		WriteTimeDataIndexCache(path, timeDataHdl);	// not fatal if this fails
 	}
+
+	numTimeBlocks = _GetHandleSize((Handle)timeDataHdl) / sizeof(**timeDataHdl);
+	timeHdl = (Seconds**)_NewHandle(numTimeBlocks * sizeof(Seconds));
+	if(!timeHdl) {TechError("ScanFileForTimes()", "_NewHandle()", 0); err = memFullErr; goto done;}
+
+	for (i = 0; i < numTimeBlocks; i++)
+		(*timeHdl)[i] = (*timeDataHdl)[i].time;
+
 	*timeDataH = timeDataHdl;
 	*timeH = timeHdl;
-	
-	
-	
+
 done:
-	
-	if(h) {
-		_HUnlock((Handle)h); 
-		DisposeHandle((Handle)h); 
-		h = 0;
-	}
 	if (err)
 	{
 		if(timeDataHdl) {DisposeHandle((Handle)timeDataHdl); timeDataHdl=0;}
@@ -11505,8 +13364,16 @@ done:
 	return err;
 }
 
+// the lines were read for the scan once, it doesn't need them now
+OSErr ScanFileForTimes(char * path, vector<string> &linesInFile,
+					   PtCurTimeDataHdl *timeDataH, Seconds ***timeH)
+{
+	return ScanFileForTimes(path, timeDataH, timeH);
+}
+
 OSErr TimeGridCurRect_c::CheckAndScanFile(char *errmsg, const Seconds &model_time)
 {
+	MemoryTag memoryTag(kMemTimeSlices);
 	Seconds time = model_time, startTime, endTime, lastEndTime, testTime; // AH 07/17/2012
 	
 	long i,numFiles = GetNumFiles();
@@ -11818,8 +13685,9 @@ OSErr TimeGridCurRect_c::TextRead(const char *path, const char *topFilePath)
 	SplitPathIntoDirAndFile(strPath, dir, file);
 
 
+	// the velocities are read a time block at a time, by ReadTimeData
 	vector<string> linesInFile;
-	if (ReadLinesInFile(strPath, linesInFile)) {
+	if (ReadLinesInFileUpTo(strPath, "[TIME", linesInFile)) {
 		return TextRead(linesInFile, dir);
 	}
 	else {
@@ -11835,16 +13703,13 @@ OSErr TimeGridCurRect_c::ReadTimeData(long index,
 	OSErr err = 0;
 
 	string path = fVar.pathName;
-	vector<string> linesInFile;
-	istringstream lineStream;
+	MappedText block;
+	TextLines linesInFile;
 	long line = 0;
-	string key;
 
 	long offset,lengthToRead;
 	long totalNumberOfVels = fNumRows * fNumCols;
-	char *sectionOfFile = 0;
 
-	CHARH h = 0;
 	VelocityFH velH = 0;
 	DateTimeRec time;
 	Seconds timeSeconds;
@@ -11857,32 +13722,18 @@ OSErr TimeGridCurRect_c::ReadTimeData(long index,
 	lengthToRead = (*fTimeDataHdl)[index].lengthOfData;
 	offset = (*fTimeDataHdl)[index].fileOffsetToStartOfData;
 	
-	h = (CHARH)_NewHandle(lengthToRead+1);
-	if(!h){TechError("TimeGridCurRect_c::ReadTimeData()", "_NewHandle()", 0); err = memFullErr; goto done;}
-	
-	_HLock((Handle)h);
-	sectionOfFile = *h;			
-	
-	// don't read in entire file every time...
-	err = ReadSectionOfFile(0,0,fVar.pathName,offset,lengthToRead,sectionOfFile,0);
-	if(err || !h) 
+	// don't read in entire file every time, just map the time's block
+	if (lengthToRead <= 0 || !block.Open(fVar.pathName, offset, lengthToRead))
 	{
 		char firstPartOfLine[128];
+		err = -1;
 		sprintf(errmsg,"Unable to open data file:%s",NEWLINESTRING);
 		strncpy(firstPartOfLine,fVar.pathName,120);
 		strcpy(firstPartOfLine+120,"...");
 		strcat(errmsg,firstPartOfLine);
 		goto done;
 	}
-	sectionOfFile[lengthToRead] = 0; // make it a C string
-
-	if (!ReadLinesInBuffer(&sectionOfFile, linesInFile)) {
-		return -1;
-	}
-	//if (!ReadLinesInFile(path, linesInFile)) {
-		//return -1;
-	//}
-	//line = (*fTimeDataHdl)[index].fileOffsetToStartOfData;
+	linesInFile.SetText(block.text(), block.size());
 
 	// some other way to calculate
 	velH = (VelocityFH)_NewHandleClear(sizeof(**velH) * totalNumberOfVels);
@@ -11920,26 +13771,25 @@ OSErr TimeGridCurRect_c::ReadTimeData(long index,
 	{
 		VelocityRec vel;
  		long rowNum, colNum, index;
+		TextLine text = linesInFile[line], key;
+		const char *p = text.begin;
 
-		if (linesInFile[line].size() == 0) {
+		if (text.size() == 0) {
 			// it's a blank line, allow this and skip the line
 			line++;
 			continue;
 		}
 
-		lineStream.str(linesInFile[line++]);
-		lineStream.clear();
-		lineStream >> rowNum >> colNum >> vel.u >> vel.v;
-		if (lineStream.fail())
+		line++;
+		if (!ScanValue(p, text.end, rowNum) || !ScanValue(p, text.end, colNum) ||
+			!ScanValue(p, text.end, vel.u) || !ScanValue(p, text.end, vel.v))
 		{
 			// did we run into the next [TIME] stanza?
-			lineStream.clear();
-			lineStream >> key;
-			if (lineStream.fail() || key != "[TIME]" ) {
+			if (!ScanWord(p, text.end, key) || string(key) != "[TIME]" ) {
 				// anything other than a time stanza is not allowed
 				char firstPartOfLine[128];
 				sprintf(errmsg, "TimeGridCurRect_c::ReadTimeData(): Unable to read velocity data from line %ld:%s", line, NEWLINESTRING);
-				strncpy(firstPartOfLine, lineStream.str().c_str(), 120);
+				strncpy(firstPartOfLine, string(text).c_str(), 120);
 				strcpy(firstPartOfLine + 120, "...");
 				strcat(errmsg, firstPartOfLine);
 				err = -1;
@@ -11955,7 +13805,7 @@ OSErr TimeGridCurRect_c::ReadTimeData(long index,
 		{
 			char firstPartOfLine[128];
 			sprintf(errmsg, "TimeGridCurRect_c::ReadTimeData(): velocity data out of bounds in line %ld:%s", line, NEWLINESTRING);
-			strncpy(firstPartOfLine, lineStream.str().c_str(), 120);
+			strncpy(firstPartOfLine, string(text).c_str(), 120);
 			strcpy(firstPartOfLine + 120, "...");
 			strcat(errmsg, firstPartOfLine);
 			err = -1;
@@ -11971,12 +13821,6 @@ OSErr TimeGridCurRect_c::ReadTimeData(long index,
 	
 done:
 
-	if (h) {
-		_HUnlock((Handle)h); 
-		DisposeHandle((Handle)h); 
-		h = 0;
-	}
-
 	if (err) {
 		if (!errmsg[0])
 			strcpy(errmsg, "An error occurred in TimeGridCurRect_c::ReadTimeData");
@@ -11999,6 +13843,7 @@ TimeGridCurTri_c::TimeGridCurTri_c () : TimeGridCurRect_c()
 	//
 	fDepthsH = 0;
 	fDepthDataInfo = 0;
+	fDepthTables = 0;
 	//fInputFilesHdl = 0;	// for multiple files case
 	
 	//SetClassName (name); // short file name
@@ -12018,11 +13863,30 @@ void TimeGridCurTri_c::Dispose ()
 {
 	if(fDepthsH) {DisposeHandle((Handle)fDepthsH); fDepthsH=0;}
 	if(fDepthDataInfo) {DisposeHandle((Handle)fDepthDataInfo); fDepthDataInfo=0;}
+	if(fDepthTables) {delete fDepthTables; fDepthTables=0;}
 	
 	TimeGridCurRect_c::Dispose ();
 }
 
 
+// the tables of the depth data now, 0 without any
+TriDepthTables *TimeGridCurTri_c::GetDepthTables()
+{
+	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*>(fGrid);
+	TDagTree *dagTree = triGrid ? triGrid->GetDagTree() : 0;
+	TopologyHdl topH = dagTree ? dagTree->GetTopologyHdl() : 0;
+
+	if (!fDepthDataInfo) return 0;
+
+	if (!fDepthTables) fDepthTables = new TriDepthTables();
+	if (!fDepthTables->IsFor(fDepthDataInfo,fDepthsH,topH,0) &&
+		fDepthTables->Build(fDepthDataInfo,fDepthsH,topH,0))
+		return 0;
+
+	return fDepthTables;
+}
+
+
 void TimeGridCurTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2)
 {
 	long indexToDepthData = (*fDepthDataInfo)[ptIndex].indexToDepthData;
@@ -12053,8 +13917,14 @@ void TimeGridCurTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *d
 		case SIGMA: // 
 			if (depthAtPoint <= totalDepth) // check data exists at chosen/LE depth for this point
 			{
-				long j;
-				for(j=0;j<numDepths-1;j++)
+				long j, k1, k2;
+				Boolean inOrder = fDepthTables && fDepthTables->IsForNodes(fDepthDataInfo,fDepthsH) && fDepthTables->LevelsAscending(ptIndex);
+				if (inOrder && BisectNodeLevels(*fDepthsH + indexToDepthData,numDepths,depthAtPoint,&k1,&k2))
+				{
+					*depthIndex1 = indexToDepthData+k1;
+					*depthIndex2 = k2 == UNASSIGNEDINDEX ? UNASSIGNEDINDEX : indexToDepthData+k2;
+				}
+				for(j=0;!inOrder && j<numDepths-1;j++)
 				{
 					if(INDEXH(fDepthsH,indexToDepthData+j)<depthAtPoint &&
 					   depthAtPoint<=INDEXH(fDepthsH,indexToDepthData+j+1))
@@ -12101,7 +13971,7 @@ void TimeGridCurTri_c::GetDepthIndices(long ptIndex, float depthAtPoint, long *d
 VelocityRec TimeGridCurTri_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint)
 {
 	double timeAlpha, depth = refPoint.z;
-	long ptIndex1,ptIndex2,ptIndex3; 
+	long ptIndex1,ptIndex2,ptIndex3,triNum = -1; 
 	Seconds startTime,endTime;
 	InterpolationVal interpolationVal;
 	VelocityRec scaledPatVelocity;
@@ -12111,7 +13981,7 @@ VelocityRec TimeGridCurTri_c::GetScaledPatValue(const Seconds& model_time, World
 	memset(&interpolationVal,0,sizeof(interpolationVal));
 	
 	// Get the interpolation coefficients, alpha1,ptIndex1,alpha2,ptIndex2,alpha3,ptIndex3
-	interpolationVal = fGrid -> GetInterpolationValues(refPoint.p);
+	interpolationVal = fGrid -> GetInterpolationValues(refPoint.p, &triNum);
 	
 	if (interpolationVal.ptIndex1 >= 0)  // if negative corresponds to negative ntri
 	{
@@ -12124,7 +13994,7 @@ VelocityRec TimeGridCurTri_c::GetScaledPatValue(const Seconds& model_time, World
 	// what kind of weird things can triangles do below the surface ??
 	if (depth>0 && interpolationVal.ptIndex1 >= 0) 
 	{
-		scaledPatVelocity = GetScaledPatValue3D(model_time,interpolationVal,depth);
+		scaledPatVelocity = GetScaledPatValue3D(model_time,interpolationVal,depth,triNum);
 		goto scale;
 	}						
 	
@@ -12184,6 +14054,11 @@ scale:
 }
 
 VelocityRec TimeGridCurTri_c::GetScaledPatValue3D(const Seconds& model_time,InterpolationVal interpolationVal,float depth)
+{
+	return GetScaledPatValue3D(model_time, interpolationVal, depth, -1);
+}
+
+VelocityRec TimeGridCurTri_c::GetScaledPatValue3D(const Seconds& model_time,InterpolationVal interpolationVal,float depth,long triNum)
 {
 	// figure out which depth values the LE falls between
 	// will have to interpolate in lat/long for both levels first
@@ -12198,7 +14073,12 @@ VelocityRec TimeGridCurTri_c::GetScaledPatValue3D(const Seconds& model_time,Inte
 	VelocityRec pt1interp = {0.,0.}, pt2interp = {0.,0.}, pt3interp = {0.,0.};
 	VelocityRec scaledPatVelocity = {0.,0.};
 	Seconds startTime, endTime;
+	TriDepthTables *tables = GetDepthTables();
 	
+	// below the bottom at all three points there is no velocity (but 2D data has none)
+	if (tables && fVar.gridType != TWO_D && tables->BelowBottom(triNum,depth))
+		return scaledPatVelocity;
+
 	GetDepthIndices(interpolationVal.ptIndex1,depth,&pt1depthIndex1,&pt1depthIndex2);	
 	GetDepthIndices(interpolationVal.ptIndex2,depth,&pt2depthIndex1,&pt2depthIndex2);	
 	GetDepthIndices(interpolationVal.ptIndex3,depth,&pt3depthIndex1,&pt3depthIndex2);	
@@ -12636,20 +14516,15 @@ OSErr TimeGridCurTri_c::ReadTimeData(long index,
 	OSErr err = 0;
 
 	string path = fVar.pathName;
-	vector<string> linesInFile;
-	string currentLine;
-
+	MappedText block;
+	TextLines linesInFile;
 
 	long line = 0;
-	long len;
 	long offset,lengthToRead;
 	long totalNumberOfVels = 0;
 	long numDepths = 1;
 	long numPoints;
-	char *sectionOfFile = 0;
-	char *strToMatch = 0;
 
-	CHARH h = 0;
 	VelocityFH velH = 0;
 	LongPointHdl ptsHdl = 0;
 	TTriGridVel *triGrid = dynamic_cast<TTriGridVel*> (fGrid); // don't think need 3D here
@@ -12666,31 +14541,18 @@ OSErr TimeGridCurTri_c::ReadTimeData(long index,
 	lengthToRead = (*fTimeDataHdl)[index].lengthOfData;
 	offset = (*fTimeDataHdl)[index].fileOffsetToStartOfData;
 
-	h = (CHARH)_NewHandle(lengthToRead+1);
-	if(!h){TechError("PtCurMover::ReadTimeData()", "_NewHandle()", 0); err = memFullErr; goto done;}
-	
-	_HLock((Handle)h);
-	sectionOfFile = *h;			
-	
-	err = ReadSectionOfFile(0,0,fVar.pathName,offset,lengthToRead,sectionOfFile,0);
-	if(err || !h) 
+	// only the time's block of the file is mapped
+	if (lengthToRead <= 0 || !block.Open(fVar.pathName, offset, lengthToRead))
 	{
 		char firstPartOfLine[128];
+		err = -1;
 		sprintf(errmsg,"Unable to open data file:%s",NEWLINESTRING);
 		strncpy(firstPartOfLine,fVar.pathName,120);
 		strcpy(firstPartOfLine+120,"...");
 		strcat(errmsg,firstPartOfLine);
 		goto done;
 	}
-	sectionOfFile[lengthToRead] = 0; // make it a C string
-
-	if (!ReadLinesInBuffer(&sectionOfFile, linesInFile)) {
-		return -1;
-	}
-	//if (!ReadLinesInFile(path, linesInFile)) {
-		//return -1;
-	//}
-	//line = (*fTimeDataHdl)[index].fileOffsetToStartOfData;
+	linesInFile.SetText(block.text(), block.size());
 	
 	ptsHdl = triGrid->GetPointsHdl();
 	if (ptsHdl)
@@ -12748,30 +14610,18 @@ OSErr TimeGridCurTri_c::ReadTimeData(long index,
 	}
 	
 	for (long i = fNumLandPts; i < numPoints; i++) {
-		// interior points
-		long scanLength, stringIndex = 0;
+		// interior points, a u and v for each depth, read in place
 		numDepths = (*fDepthDataInfo)[i].numDepths;
-		char *startScan;
 
+		TextLine text = linesInFile[line];
+		const char *p = text.begin;
 		VelocityRec vel;
-		
-		char *s1 = new char[numDepths * 64];
-		if (!s1) {
-			TechError("PtCurMover::ReadTimeData()", "new[]", 0);
-			err = memFullErr;
-			goto done;
-		}
-		
-		currentLine = linesInFile[line];
-		
-		istringstream lineStream(currentLine);
 
 		for (long j = 0; j < numDepths; j++) {
-			if (!ParseLine(lineStream, vel)) {
+			if (!ScanValue(p, text.end, vel.u) || !ScanValue(p, text.end, vel.v)) {
 				sprintf(errmsg, "TimeGridCurTri_c::ReadTimeData(): Unable to read velocity data from line %ld:%s",
 						line, NEWLINESTRING);
-				delete[] s1;
-				s1 = 0;
+				err = -1;
 				goto done;
 			}
 
@@ -12780,20 +14630,12 @@ OSErr TimeGridCurTri_c::ReadTimeData(long index,
 		}
 
 		line++;
-		delete[] s1;
-		s1 = 0;
 	}
 
 	*velocityH = velH;
 
 done:
 
-	if (h) {
-		_HUnlock((Handle)h); 
-		DisposeHandle((Handle)h); 
-		h = 0;
-	}
-
 	if (err) {
 		if (!errmsg[0])
 			strcpy(errmsg,"An error occurred in PtCurMover::ReadTimeData");
@@ -13127,8 +14969,9 @@ OSErr TimeGridCurTri_c::TextRead(const char *path, const char *topFilePath)
 	SplitPathIntoDirAndFile(strPath, dir, file);
 
 
+	// the velocities are read a time block at a time, by ReadTimeData
 	vector<string> linesInFile;
-	if (ReadLinesInFile(strPath, linesInFile)) {
+	if (ReadLinesInFileUpTo(strPath, "[TIME", linesInFile)) {
 		return TextRead(linesInFile,
 						dir);
 	}
@@ -13178,7 +15021,7 @@ OSErr TimeGridCurTri_c::ReadHeaderLines(const char *path, UncertaintyParameters
 	
 	
 	vector<string> linesInFile;
-	if (ReadLinesInFile(strPath, linesInFile)) {
+	if (ReadLinesInFileUpTo(strPath, "[TIME", linesInFile)) {
 		return ReadHeaderLines(linesInFile, dir, uncertainParams);
 	}
 	else {
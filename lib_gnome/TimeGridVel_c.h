@@ -14,6 +14,10 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "ExportSymbols.h"
+#include "TimingStats.h"
+#include "GnomeError.h"
+#include <string>
+#include <vector>
 #include "DagTree.h"
 #include "DagTreeIO.h"
 #include "my_build_list.h"
@@ -28,6 +32,13 @@
 
 using namespace std;
 
+class TTriGridVel;
+class NearestNodeIndex;
+class TriDepthTables;
+class IceFieldProducts;
+class CurvCellLocator;
+struct ForcingFileInfo;
+
 // code goes here, decide which fields go with the mover
 typedef struct {
 	char		pathName[kMaxNameLen];
@@ -40,10 +51,73 @@ typedef struct {
 	//
 } TimeGridVariables;
 
+#ifdef GNOME_PREFETCH
+#include <thread>
+#endif
+#include "GnomeThreads.h"
+// netCDF and the ReadTimeData scratch arrays are not thread safe, file reads
+// hold this while a background prefetch or another mover may be reading
+GnomeMutex& GnomeFileIOMutex();
+
 Boolean IsNetCDFFile (char *path, short *gridType);
 Boolean IsNetCDFPathsFile (char *path, Boolean *isNetCDFPathsFile, char *fileNamesPath, short *gridType);
 //Boolean IsGridWindFile(char *path,short *selectedUnits);
 
+// the velocities of a grid at one time as flat arrays, for the batches of
+// GetScaledPatValues: made once by GetFieldView(), then read inline in the
+// loop over the LEs instead of through the virtual TimeGridVel_c calls
+struct TimeGridFieldView
+{
+	const VelocityFRec	*start;		// 0 if there is no field at the time
+	const VelocityFRec	*end;		// 0 for a constant field
+	const VelocityRec	*blended;	// start and end blended at timeAlpha, or 0
+	double				timeAlpha;
+	long				levelSize;	// velocities in a depth level
+	double				scale;		// the file's scale factor
+
+	// interpolates from start to end, else reads blended or start
+	bool TimeVarying() const {return end && !blended;}
+
+	// the unscaled velocity at index of the depth level
+	template <bool timeVarying>
+	VelocityRec Velocity(long index, long level) const
+	{
+		VelocityRec vel;
+
+		index += level*levelSize;
+		if (timeVarying)
+		{
+			vel.u = timeAlpha*start[index].u + (1-timeAlpha)*end[index].u;
+			vel.v = timeAlpha*start[index].v + (1-timeAlpha)*end[index].v;
+		}
+		else if (blended)
+			vel = blended[index];
+		else
+		{
+			vel.u = start[index].u;
+			vel.v = start[index].v;
+		}
+		return vel;
+	}
+
+	// between two levels, depthAlpha the weight of level1, or level1 alone
+	// if level2 is UNASSIGNEDINDEX
+	template <bool timeVarying>
+	VelocityRec Velocity(long index, long level1, long level2, double depthAlpha) const
+	{
+		VelocityRec vel = Velocity<timeVarying>(index, level1), vel2;
+
+		if (level2 == UNASSIGNEDINDEX)
+			return vel;
+		vel2 = Velocity<timeVarying>(index, level2);
+		vel.u = depthAlpha*vel.u;
+		vel.u += (1-depthAlpha)*vel2.u;
+		vel.v = depthAlpha*vel.v;
+		vel.v += (1-depthAlpha)*vel2.v;
+		return vel;
+	}
+};
+
 class DLL_API TimeGridVel_c
 {
 public:
@@ -65,9 +139,13 @@ public:
 	float fTimeAlpha;
 	Seconds fModelStartTime;
 	Boolean bIsCycleMover;
+	// the patterns of a cycle mover's file, read once and kept for the run,
+	// fStartData and fEndData point at two of them
+	vector<VelocityFH> fCycleFrames;
 	
 	Boolean fOverLap;
 	Seconds fOverLapStartTime;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	PtCurFileInfoH	fInputFilesHdl;
 	long fTimeShift;		// to convert GMT to local time
 	Boolean fAllowExtrapolationInTime;
@@ -77,6 +155,34 @@ public:
 	
 	WorldRect fGridBounds;
 
+	// next time in the file, read in the background (only with GNOME_PREFETCH)
+	Boolean fPrefetchNextTime;
+	LoadedData fPrefetchData;
+	OSErr fPrefetchErr;
+	char fPrefetchPath[kMaxNameLen];
+#ifdef GNOME_PREFETCH
+	std::thread *fPrefetchThread;
+#endif
+
+	// dataset kept open between ReadTimeData calls, with its variable and dimension ids
+	int fNcid;
+	char fNcidPath[kMaxNameLen];
+	vector<pair<string, int> > fNcVarIDs;
+	vector<pair<string, int> > fNcDimIDs;
+
+	// read velocities from the file as float instead of double, saving the
+	// double read buffers (the loaded data is float either way)
+	Boolean fReadSinglePrecision;
+
+	// start and end data blended once per step, so the per LE lookups only
+	// interpolate in space. Kept in double so the velocities are unchanged
+	Boolean fUseInterpolatedField;
+	Boolean fInterpolatedValid;
+	double fInterpolatedAlpha;	// time weight the field was blended with
+	VelocityH fInterpolatedH;
+
+	// SetInterval, the reads and the batch interpolation, for the mover's stats
+	TimingStats fTiming;
 
 	TimeGridVel_c (/*TMover *owner, char *name*/);	// do we need an owner? or a name
 
@@ -89,6 +195,12 @@ public:
 	virtual long 		GetVelocityIndex(WorldPoint p);
 	virtual LongPoint 	GetVelocityIndices(WorldPoint wp);
 	virtual VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p) {VelocityRec vRec = {0,.0,}; return vRec;}
+	// triHint is the LE's triangle from the last lookup, only triangle grids use it
+	virtual VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p, long *triHint) {return GetScaledPatValue(model_time, p);}
+	// the same as GetScaledPatValue on each point in turn, triHints (one per point) may be 0
+	virtual void				GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel);
+	// the size in meters of the grid cell p is in, for Courant numbers - 0 where it isn't known
+	virtual double				GetCellSize(WorldPoint3D p, long *triHint);
 	
 	//virtual WorldRect GetGridBounds(){return fGrid->GetBounds();}	
 	//virtual void SetGridBounds(WorldRect gridBounds){return fGrid->SetBounds(gridBounds);}	
@@ -102,6 +214,17 @@ public:
 	long GetTimeShift(){return fTimeShift;}
 	
 	void SetTimeCycleInfo(float fraction, long offset) {fFraction = fraction; fOffset = offset;}
+	void SetPrefetch(bool prefetch) {fPrefetchNextTime = prefetch;}
+	bool GetPrefetch() {return fPrefetchNextTime;}
+	void SetSinglePrecision(bool singlePrecision) {fReadSinglePrecision = singlePrecision;}
+	bool GetSinglePrecision() {return fReadSinglePrecision;}
+	bool GetInterpolatedFieldMode() {return fUseInterpolatedField;}
+	Boolean UseInterpolatedField(double timeAlpha) {return fInterpolatedValid && timeAlpha == fInterpolatedAlpha;}
+	// one time in the data, or extrapolating past the data
+	Boolean IsConstantField(const Seconds& model_time);
+	// the loaded field for a batch, timeAlpha as the grid weighs the start
+	// and end times (unused for a constant field)
+	TimeGridFieldView GetFieldView(Boolean constantField, double timeAlpha);
 	
 	virtual Seconds 		GetStartTimeValue(long index);
 	virtual Seconds 		GetTimeValue(long index);
@@ -124,8 +247,56 @@ public:
 	long 					GetNumFiles();
 	virtual OSErr 		CheckAndScanFile(char *errmsg, const Seconds& model_time);	
 	virtual OSErr	 	SetInterval(char *errmsg, const Seconds& model_time);	
+	// SetInterval for the per LE paths: a loaded interval is only checked, with no
+	// message, and an error is kept in error with the time it happened at
+	OSErr				SetInterval(GnomeError &error, const Seconds& model_time);
 	
 	virtual Boolean 	CheckInterval(long &timeDataInterval, const Seconds& model_time);	
+	// what SetInterval does when the interval is already loaded
+	virtual void		KeepLoadedInterval() {StartPrefetch();}
+	void				StartPrefetch();
+	void				FinishPrefetch();
+	void				DisposePrefetchData();
+	int					OpenTimeDataFile(const char *path, int *ncid);
+	void				CloseTimeDataFile();
+	int					InqVarID(int ncid, const char *name, int *varid);
+	int					InqDimID(int ncid, const char *name, int *dimid);
+	// the whole grid key, with the window read when there is one
+	void				GetTimeSliceVariable(char *variable);
+	virtual void		GetWholeGridSliceVariable(char *variable);
+	// the rows and columns [start, end) of the loaded layout ReadTimeData reads, false for the whole grid
+	virtual Boolean		GetSliceWindow(long *window) {return false;}
+	// a time from an open forcing file of the source, else ReadTimeData
+	OSErr				ReadTimeSlice(long index, VelocityFH *velocityH, char *errmsg);
+	OSErr				LoadTimeData(long index, LoadedData *data, char *errmsg);
+	// the loaded file's times as a forcing file (see ForcingFile.h), read a time at a time
+	OSErr				WriteForcingFile(const char *path, char *errmsg);
+	virtual void		GetForcingTopology(ForcingFileInfo *info) {}
+	Boolean				KeepsCycleFrames() {return bIsCycleMover && GetNumFiles() <= 1;}
+	Boolean				IsCycleFrame(VelocityFH h);
+	void				DisposeCycleFrames();
+
+	// read only the part of the grid around the LEs (regular grids only)
+	virtual void		SetActiveWindowMode(bool useWindow, long halo) {}
+	virtual Boolean		UsesActiveWindow() {return false;}
+	// start the window at the cells of bounds, false if there's no window or bounds is off the grid
+	virtual Boolean		SetActiveWindowBounds(const WorldRect &bounds) {return false;}
+	virtual OSErr		UpdateActiveWindow(char *errmsg, const Seconds& model_time, LECount n, WorldPoint3D *ref, short *LE_status) {return 0;}
+
+	// blend the loaded times once for model_time (regular and curvilinear grids only)
+	virtual void		SetInterpolatedFieldMode(bool useField) {}
+	// bin the LEs of a batch by grid cell, for fields that have a value per cell
+	virtual void		SetCellBinningMode(bool binByCell) {}
+	virtual bool		GetCellBinningMode() {return false;}
+	// keep only the water nodes of each time, in the grid's point order (curvilinear grids only)
+	virtual void		SetWaterNodeLayout(bool waterNodes) {}
+	virtual bool		GetWaterNodeLayout() {return false;}
+	// LEs off the grid or on land get the velocity of the nearest water node
+	// instead of zero (2D curvilinear grids with velocities on the nodes only)
+	virtual void		SetNearestNodeMode(bool nearestNode) {}
+	virtual bool		GetNearestNodeMode() {return false;}
+	virtual OSErr		PrepareInterpolatedField(const Seconds& model_time) {return 0;}
+	void				DisposeInterpolatedField();
 	virtual OSErr		TextRead(const char *path, const char *topFilePath) {return 0;}
 	virtual OSErr 		ReadTimeData(long index,VelocityFH *velocityH, char* errmsg) {return 0;}
 	OSErr 				ReadInputFileNames(char *fileNamesPath);
@@ -141,7 +312,8 @@ public:
 
 	virtual	bool 		IsTriangleGrid(){return false;}
 	virtual	bool 		IsDataOnCells(){return true;}
-	virtual OSErr 		get_values(int n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels) {return 0;}
+	// GetScaledPatValues at positions in degrees, loading the interval first, hints (one per point) may be 0
+	virtual OSErr 		get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints = 0);
 };
 
 
@@ -153,6 +325,9 @@ OSErr ScanFileForTimes(char *path, std::vector<std::string> &linesInFile,
 OSErr ScanFileForTimes(char *path,
 					   PtCurTimeDataHdl *timeDataH, Seconds ***timeH);
 
+// bytes of a loaded handle (0 for none), for the read stats
+inline long LoadedBytes(Handle h) { return h ? _GetHandleSize(h) : 0; }
+
 bool DateValuesAreMinusOne(DateTimeRec &dateTime);
 bool DateIsValid(DateTimeRec &dateTime);
 void CorrectTwoDigitYear(DateTimeRec &dateTime);
@@ -166,11 +341,21 @@ public:
 	float **fDepthLevelsHdl;	// can be depth levels, sigma, or sc_r (for roms formula)
 	float **fDepthLevelsHdl2;	// Cs_r (for roms formula)
 	float hc;	// parameter for roms formula
+	// set by SetDepthLevelOrder once the levels are read, GetDepthIndices
+	// bisects the levels instead of scanning them when they are in order
+	Boolean fDepthLevelsAscending;	// levels (or sigma) never decrease
+	Boolean fRomsLevelsAscending;	// sc_r and Cs_r never decrease and are <= 0, hc >= 0
 
 	FLOATH fDepthsH;	// check what this is, maybe rename
 	DepthDataInfoH fDepthDataInfo;
 	//double fFileScaleFactor;
 
+	// grid rows and columns read by ReadTimeData, [start, end), empty reads the whole grid
+	Boolean fUseActiveWindow;
+	long fActiveWindowHalo;
+	long fWindowRowStart, fWindowRowEnd;
+	long fWindowColStart, fWindowColEnd;
+
 	//Boolean fAllowVerticalExtrapolationOfCurrents;
 	//float	fMaxDepthForExtrapolation;
 	
@@ -183,6 +368,9 @@ public:
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_TIMEGRIDVELRECT) return TRUE; return TimeGridVel_c::IAm(id); }
 	
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p);
+	virtual void		GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel);
+	virtual double		GetCellSize(WorldPoint3D p, long *triHint);
+	virtual double		GetTimeAlpha(const Seconds& model_time);
 	void 				GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2);
 	float 				GetMaxDepth();
 	
@@ -191,14 +379,29 @@ public:
 
 	virtual double	GetDepthAtIndex(long depthIndex, double totalDepth);
 	float		GetTotalDepth(WorldPoint refPoint, long triNum);
+	void		SetDepthLevelOrder();
 
 	void SetVerticalExtrapolation(bool extrapolate){fAllowVerticalExtrapolationOfCurrents = extrapolate;}
 	bool GetVerticalExtrapolation(){return fAllowVerticalExtrapolationOfCurrents;}
 	
 	virtual OSErr 		ReadTimeData(long index,VelocityFH *velocityH, char* errmsg);
+	template <class T>
+	OSErr 				ReadVelocityData(long index,VelocityFH *velocityH, char* errmsg);
 	virtual long 		GetNumDepthLevelsInFile();	// eventually get rid of this
+
+	virtual Boolean		GetSliceWindow(long *window);
+	virtual void		SetActiveWindowMode(bool useWindow, long halo);
+	virtual Boolean		UsesActiveWindow() {return fUseActiveWindow;}
+	virtual Boolean		SetActiveWindowBounds(const WorldRect &bounds);
+	virtual OSErr		UpdateActiveWindow(char *errmsg, const Seconds& model_time, LECount n, WorldPoint3D *ref, short *LE_status);
+	virtual void		SetInterpolatedFieldMode(bool useField);
+	virtual OSErr		PrepareInterpolatedField(const Seconds& model_time);
 	
 	virtual OSErr		TextRead(const char *path, const char *topFilePath);
+
+protected:
+	template <bool timeVarying>
+	void				GetRectValues(long n, const WorldPoint3D *refPoints, const TimeGridFieldView &view, VelocityRec *vel);
 };
 
 
@@ -211,7 +414,32 @@ public:
 	WORLDPOINTFH fVertexPtsH;		// for curvilinear, all vertex points from file
 	WORLDPOINTH fCenterPtsH;		// for curvilinear, all vertex points from file
 	GridCellInfoHdl fGridCellInfoH;
+	// the topology the cell centers and cell data were made from, they are
+	// kept for the outputters until the grid changes
+	TopologyHdl fCellCacheTopH;
 	Boolean bVelocitiesOnNodes;		// default is velocities on cells
+	// the batches with velocities on cells work out the velocity once per cell
+	// and depth, for many LEs in a few cells. Same velocities
+	Boolean fBinLEsByCell;
+	// with velocities on the nodes and no depth levels, a time holds the
+	// velocities of the grid's points only, point i at fVerdatToNetCDFH[i]
+	// in the file, and not the land nodes. Same velocities
+	Boolean fWaterNodeLayout;
+	// the triangulation's key in the topology cache, 0 if it was read from a topology file
+	uint64_t fTopologyCacheKey;
+	// for the LEs off the grid, built from the water nodes when the mode is on.
+	// An LE's hint holds -(node + 2) for the node it had last
+	Boolean fUseNearestNode;
+	NearestNodeIndex *fNearestNodeIndex;
+	// locates the LEs by the grid's (i,j) cells instead of the DAG, for the
+	// grid, point map and row width it was built for. 0 if the triangles
+	// aren't the cells split in two, the DAG is used then
+	CurvCellLocator *fCellLocator;
+	TGridVel *fCellLocatorGrid;
+	TTriGridVel *fCellLocatorTriGrid;
+	TopologyHdl fCellLocatorTopH;
+	LONGH fCellLocatorMapH;
+	long fCellLocatorCols;
 
 	TimeGridVelCurv_c ();
 	virtual ~TimeGridVelCurv_c () { Dispose (); }
@@ -222,7 +450,13 @@ public:
 	LongPointHdl		GetPointsHdl();
 	TopologyHdl 		GetTopologyHdl();
 	OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
+	template <class T>
+	OSErr 				ReadVelocityData(long index,VelocityFH *velocityH, char* errmsg);
 	VelocityRec			GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint);
+	virtual VelocityRec	GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint, long *triHint);
+	virtual void		GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel);
+	// the curvilinear grid is triangulated, the cells are its triangles
+	virtual double		GetCellSize(WorldPoint3D p, long *triHint) {return TimeGridVel_c::GetCellSize(p, triHint);}
 
 	OSErr 				ReorderPoints(DOUBLEH landmaskH, char* errmsg); 
 	OSErr 				ReorderPointsNoMask(char* errmsg); 
@@ -230,6 +464,10 @@ public:
 	OSErr 				ReorderPointsCOOPSMaskOld(DOUBLEH landmaskH, char* errmsg); 
 	OSErr 				ReorderPointsCOOPSNoMask(char* errmsg); 
 	Boolean				IsCOOPSFile();
+
+	uint64_t			GetTopologyCacheKey(DOUBLEH landmaskH, Boolean isLandMask, Boolean isCoopsMask);
+	OSErr				LoadCachedTopology(uint64_t key);
+	OSErr				SaveCachedTopology(uint64_t key);
 	
 	virtual long 		GetVelocityIndex(WorldPoint wp);
 	virtual LongPoint 	GetVelocityIndices(WorldPoint wp);
@@ -237,20 +475,64 @@ public:
 	virtual long 		GetNumDepthLevels();
 	void 				GetDepthIndices(long ptIndex, float depthAtPoint, float totalDepth, long *depthIndex1, long *depthIndex2);
 	float		GetTotalDepth(WorldPoint refPoint,long ptIndex);
+	float		GetTotalDepth(WorldPoint refPoint,long ptIndex,TTriGridVel *triGrid);
 	float 		GetInterpolatedTotalDepth(WorldPoint refPoint);
 
 	virtual OSErr 	GetScaledVelocities(Seconds time, VelocityFRec *velocity);
 	VelocityRec 	GetInterpolatedValue(const Seconds& model_time, InterpolationValBilinear interpolationVal,float depth,float totalDepth);
+	virtual double	GetTimeAlpha(const Seconds& model_time);
 	virtual	bool 		IsDataOnCells(){return !bVelocitiesOnNodes;}
+	virtual void		SetActiveWindowMode(bool useWindow, long halo) {}	// reads the whole grid
+	virtual void		SetCellBinningMode(bool binByCell) {fBinLEsByCell = binByCell;}
+	virtual bool		GetCellBinningMode() {return fBinLEsByCell;}
+	virtual void		SetWaterNodeLayout(bool waterNodes);
+	virtual bool		GetWaterNodeLayout() {return fWaterNodeLayout;}
+	virtual void		SetNearestNodeMode(bool nearestNode);
+	virtual bool		GetNearestNodeMode() {return fUseNearestNode;}
+	void				BuildNearestNodeIndex();
+	// the nearest water node as interpolation values (all its weight on one
+	// node), false if the mode is off or doesn't apply to the grid
+	Boolean				GetNearestNodeValues(WorldPoint p, long *triHint, InterpolationValBilinear *interpolationVal);
+	// the cell locator of the grid, built the first time after the grid changes
+	CurvCellLocator*	GetCellLocator();
+	// the point location of GetScaledPatValue, by the cells when the grid has
+	// a locator. triHint is the LE's triangle from the last lookup, or 0
+	InterpolationValBilinear	GetBilinearValues(WorldPoint p, long *triHint);
+	long				GetCellIndex(WorldPoint p, long *triHint);
+	// builds the locator before the threads of the step look the LEs up
+	virtual OSErr		PrepareInterpolatedField(const Seconds& model_time);
+	// the loaded times are in the water node layout
+	Boolean				UsesWaterNodeLayout();
+	// the index in a loaded time of the grid's point ptIndex, -1 if it has no velocity
+	long				GetNodeDataIndex(long ptIndex, Boolean waterNodes);
+	virtual void		GetWholeGridSliceVariable(char *variable);
+	virtual void		GetForcingTopology(ForcingFileInfo *info);
 	virtual GridCellInfoHdl 	GetCellData();
 	virtual WORLDPOINTH 	GetCellCenters();
+	void				CheckCellCaches(TopologyHdl topH);
 
+	virtual	OSErr ReadTopology(TextLines &linesInFile);
 	virtual	OSErr ReadTopology(std::vector<std::string> &linesInFile);
 	virtual	OSErr ReadTopology(const char *path);
 
 	virtual	OSErr ExportTopology(char *path);
 
 	virtual OSErr TextRead(const char *path, const char *topFilePath);
+
+protected:
+	void				GetCellValuesBatch(const Seconds& model_time, Boolean constantCurrent, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel);
+	// the batch of GetScaledPatValues for velocities at the cell centers, one
+	// instantiation for each kind of grid so the loop over the LEs has no
+	// branches on it. timeVarying is view.TimeVarying()
+	template <bool depthLevels, bool sigma, bool timeVarying>
+	void				GetCellValues(long n, const WorldPoint3D *refPoints, long *triHints, TTriGridVel *triGrid,
+									  const TimeGridFieldView &view, VelocityRec *vel);
+	template <bool depthLevels, bool sigma, bool timeVarying>
+	void				GetBinnedCellValues(long n, const WorldPoint3D *refPoints, long *triHints, TTriGridVel *triGrid,
+											const TimeGridFieldView &view, VelocityRec *vel);
+	template <bool depthLevels, bool sigma, bool timeVarying>
+	VelocityRec			GetCellValue(long index, const WorldPoint3D &refPoint, TTriGridVel *triGrid,
+									 const TimeGridFieldView &view);
 };
 
 
@@ -261,6 +543,7 @@ public:
 	long fNumNodes;
 	long fNumEles;	//for now, number of triangles
 	Boolean bVelocitiesOnTriangles;
+	TriDepthTables *fDepthTables;	// of fDepthDataInfo, made by GetDepthTables
 	
 	
 	TimeGridVelTri_c ();
@@ -272,13 +555,22 @@ public:
 	void					GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2);
 	OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint);
+	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint, long *triHint);
+	virtual void		GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel);
 	VelocityRec 		GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth);
+	// triNum is the triangle of the interpolation, -1 when it isn't known
+	VelocityRec 		GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth,long triNum);
+	TriDepthTables*		GetDepthTables();
+	virtual void		SetInterpolatedFieldMode(bool useField) {}	// blends per LE
+	virtual void		SetWaterNodeLayout(bool waterNodes) {}	// reads its own times
+	virtual void		SetNearestNodeMode(bool nearestNode) {}
 	OSErr					ReorderPoints(long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts); 
 	OSErr					ReorderPoints2(long *bndry_indices, long *bndry_nums, long *bndry_type, long numBoundaryPts, long *tri_verts, long *tri_neighbors, long ntri, Boolean isCCW);
 	
 	virtual long			GetNumDepthLevels();
 	float					GetTotalDepth(WorldPoint refPoint, long triNum);
 
+	virtual OSErr ReadTopology(TextLines &linesInFile);
 	virtual OSErr ReadTopology(std::vector<std::string> &linesInFile);
 	virtual OSErr ReadTopology(const char *path);
 
@@ -291,6 +583,9 @@ public:
 	virtual OSErr 		GetScaledVelocities(Seconds time, VelocityFRec *scaled_velocity);
 };
 
+// the ice data LoadIceFields reads, thickness and fraction come together
+enum { kIceVelocities = 1, kIceFields = 2 };
+
 class TimeGridVelIce_c : virtual public TimeGridVelCurv_c
 {
 public:
@@ -304,6 +599,18 @@ public:
 	LoadedFieldData fStartDataFraction;
 	LoadedFieldData fEndDataFraction;
 	
+	// the ice and water velocities blended by the ice coverage once per step,
+	// so each LE looks up one velocity instead of the fraction, the ice and
+	// the water velocities on its own (velocities on the cells of single
+	// layer grids only)
+	Boolean fUseMovementField;
+	Boolean fMovementValid;
+	Seconds fMovementTime;	// model time the field was blended for
+	VelocityH fMovementH;
+
+	// the ice fields on the cells of each loaded slice, for GetIceFields
+	IceFieldProducts *fIceProducts;
+	
 	TimeGridVelIce_c ();
 	virtual ~TimeGridVelIce_c () { Dispose (); }
 	virtual void		Dispose ();
@@ -316,6 +623,8 @@ public:
 	void 				ClearLoadedEndData();
 	void 				ShiftInterval();
 	virtual OSErr 		SetInterval(char *errmsg, const Seconds& model_time);
+	using TimeGridVel_c::SetInterval;
+	virtual void		KeepLoadedInterval() {}
 	//OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
 	OSErr 				CheckAndScanFile(char *errmsg, const Seconds& model_time);
 	double 				GetStartFieldValue(long index, long field);
@@ -326,13 +635,28 @@ public:
 	double 				GetEndIceVVelocity(long index);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint);
 	VelocityRec 		GetScaledPatValueIce(const Seconds& model_time, WorldPoint3D refPoint);
+	virtual VelocityRec	GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint, long *triHint)
+							{return GetScaledPatValue(model_time, refPoint);}
+	// ice changes the velocities, so not the curvilinear batch
+	virtual void		GetScaledPatValues(const Seconds& model_time, long n, const WorldPoint3D *refPoints, long *triHints, VelocityRec *vel)
+							{TimeGridVel_c::GetScaledPatValues(model_time, n, refPoints, triHints, vel);}
 	double 				GetDataField(const Seconds& model_time, WorldPoint3D refPoint, long field);
 	OSErr 				ReadTimeDataIce(long index,VelocityFH *velocityH, char* errmsg); 
 	OSErr 				ReadTimeDataFields(long index,DOUBLEH *thicknessH, DOUBLEH *fractionH, char* errmsg); 
+	OSErr 				LoadIceFields(char *errmsg, short fields);	// after SetInterval, reads the fields not read yet
+	virtual OSErr 		get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints = 0);
 	OSErr 				GetIceFields(Seconds time, double *thickness, double *fraction);
 	OSErr 				GetIceVelocities(Seconds time, VelocityFRec *ice_velocity);
 	OSErr 				GetMovementVelocities(Seconds time, VelocityFRec *movement_velocity);
+	void				SetMovementFieldMode(bool useField);
+	bool				GetMovementFieldMode() {return fUseMovementField;}
+	// blend the movement field for model_time, after SetInterval and LoadIceFields
+	OSErr				PrepareMovementField(const Seconds& model_time);
+	void				DisposeMovementField();
 	VelocityRec 		GetInterpolatedValue(const Seconds& model_time, InterpolationValBilinear interpolationVal,float depth,float totalDepth);
+	virtual void		SetInterpolatedFieldMode(bool useField) {}	// blends per LE
+	virtual void		SetWaterNodeLayout(bool waterNodes) {}	// the ice velocities are on the whole grid
+	virtual void		SetNearestNodeMode(bool nearestNode) {}
 	//OSErr 				GetIceVelocities(Seconds time, double *u, double *v);
 	//VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint);
 	//VelocityRec 		GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth);
@@ -391,6 +715,7 @@ public:
 	
 	FLOATH fDepthsH;
 	DepthDataInfoH fDepthDataInfo;
+	TriDepthTables *fDepthTables;	// of fDepthDataInfo, made by GetDepthTables
 	
 	TimeGridCurTri_c();
 	virtual	~TimeGridCurTri_c() { Dispose (); }
@@ -401,6 +726,8 @@ public:
 	
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint3D p);
 	VelocityRec 		GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth);
+	VelocityRec 		GetScaledPatValue3D(const Seconds& model_time, InterpolationVal interpolationVal,float depth,long triNum);
+	TriDepthTables*		GetDepthTables();
 	
 	//OSErr         ReadHeaderLine(std::string &strIn);
 	OSErr	ReadHeaderLine(string &strIn, UncertaintyParameters *uncertainParams);
@@ -468,13 +795,13 @@ public:
 	OSErr 				ReorderPointsCOOPSNoMask(char* errmsg); 
 	OSErr				GetLatLonFromIndex(long iIndex, long jIndex, WorldPoint *wp);
 
+	virtual OSErr ReadTopology(TextLines &linesInFile);
 	virtual OSErr ReadTopology(std::vector<std::string> &linesInFile);
 	virtual OSErr ReadTopology(const char *path);
 
 	virtual OSErr ExportTopology(char* path);
 
 	virtual OSErr TextRead(const char *path, const char *topFilePath);
-	virtual OSErr get_values(int n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels);
 };
 
 
@@ -491,6 +818,9 @@ public:
 	LoadedFieldData fStartDataFraction;
 	LoadedFieldData fEndDataFraction;
 	
+	// the ice fields on the cells of each loaded slice, for GetIceFields
+	IceFieldProducts *fIceProducts;
+	
 	TimeGridWindIce_c ();
 	virtual ~TimeGridWindIce_c () { Dispose (); }
 	virtual void		Dispose ();
@@ -503,6 +833,8 @@ public:
 	void 				ClearLoadedEndData();
 	void 				ShiftInterval();
 	virtual OSErr 		SetInterval(char *errmsg, const Seconds& model_time);
+	using TimeGridVel_c::SetInterval;
+	virtual void		KeepLoadedInterval() {}
 	//OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
 	OSErr 				CheckAndScanFile(char *errmsg, const Seconds& model_time);
 	double 				GetStartFieldValue(long index, long field);
@@ -516,6 +848,8 @@ public:
 	double 				GetDataField(const Seconds& model_time, WorldPoint3D refPoint, long field);
 	OSErr 				ReadTimeDataIce(long index,VelocityFH *velocityH, char* errmsg); 
 	OSErr 				ReadTimeDataFields(long index,DOUBLEH *thicknessH, DOUBLEH *fractionH, char* errmsg); 
+	OSErr 				LoadIceFields(char *errmsg, short fields);	// after SetInterval, reads the fields not read yet
+	virtual OSErr 		get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints = 0);
 	OSErr 				GetIceFields(Seconds time, double *thickness, double *fraction);
 	OSErr 				GetIceVelocities(Seconds time, VelocityFRec *ice_velocity);
 	OSErr 				GetMovementVelocities(Seconds time, VelocityFRec *movement_velocity);
@@ -16,6 +16,9 @@
 #endif
 
 #include "netcdf.h"
+#include "ForcingIOCalls.h"
+#include "ForcingBlockCache.h"
+#include "IceFieldProducts.h"
 
 /*Boolean IsGridWindFile(char *path,short *selectedUnitsP)
 {
@@ -134,6 +137,7 @@ scale:
 
 OSErr TimeGridWindRect_c::TextRead(const char *path, const char *topFilePath)
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	// this code is for regular grids
 	OSErr err = 0;
 	long i,j, numScanned;
@@ -429,12 +433,12 @@ OSErr TimeGridWindRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR)
 	{
 #if TARGET_API_MAC_CARBON
 		err = ConvertTraditionalPathToUnixPath((const char *) path, outPath, kMaxNameLen) ;
-		status = nc_open(outPath, NC_NOWRITE, &ncid);
+		status = OpenTimeDataFile(outPath, &ncid);
 #endif
 		if (status != NC_NOERR) {err = -1; goto done;}
 	}
@@ -446,10 +450,10 @@ OSErr TimeGridWindRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 	
 	if (numdims>=4)
 	{	// won't be using the heights, just need to know how to read the file
-		status = nc_inq_dimid(ncid, "sigma", &sigma_id);	//3D
+		status = InqDimID(ncid, "sigma", &sigma_id);	//3D
 		if (status != NC_NOERR) 
 		{
-			/*status = nc_inq_dimid(ncid, "height", &sigma_id);	//3D - need to check sigma values in TextRead...
+			/*status = InqDimID(ncid, "height", &sigma_id);	//3D - need to check sigma values in TextRead...
 			 if (status != NC_NOERR) bHeightIncluded = false;
 			 else bHeightIncluded = true;*/
 			bHeightIncluded = false;
@@ -475,16 +479,16 @@ OSErr TimeGridWindRect_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 	if(!wind_vvals) {TechError("TimeGridWindRect::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
 	
 	// code goes here, change key word to wind_u,v
-	status = nc_inq_varid(ncid, "air_u", &wind_ucmp_id);	
+	status = InqVarID(ncid, "air_u", &wind_ucmp_id);	
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "UX", &wind_ucmp_id);	// for Lucas's Pac SSH LAS server data
+		status = InqVarID(ncid, "UX", &wind_ucmp_id);	// for Lucas's Pac SSH LAS server data
 		if (status != NC_NOERR) {err = -1; /*goto done;*/ goto LAS;}	// broader check for variable names coming out of LAS
 	}
-	status = nc_inq_varid(ncid, "air_v", &wind_vcmp_id);	// what if only input one at a time (u,v separate movers)?
+	status = InqVarID(ncid, "air_v", &wind_vcmp_id);	// what if only input one at a time (u,v separate movers)?
 	if (status != NC_NOERR)
 	{
-		status = nc_inq_varid(ncid, "VY", &wind_vcmp_id);	// for Lucas's Pac SSH LAS server data
+		status = InqVarID(ncid, "VY", &wind_vcmp_id);	// for Lucas's Pac SSH LAS server data
 		if (status != NC_NOERR) {err = -1; goto done;}
 	}
 	
@@ -520,9 +524,9 @@ LAS:
 	if (uv_ndims==4) {wind_count[1] = 1;wind_count[2] = latlength;wind_count[3] = lonlength;}
 	
 	
-	status = nc_get_vara_double(ncid, wind_ucmp_id, wind_index, wind_count, wind_uvals);
+	status = GetVaraCached(ncid, path, wind_ucmp_id, wind_index, wind_count, wind_uvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
-	status = nc_get_vara_double(ncid, wind_vcmp_id, wind_index, wind_count, wind_vvals);
+	status = GetVaraCached(ncid, path, wind_vcmp_id, wind_index, wind_count, wind_vvals);
 	if (status != NC_NOERR) {err = -1; goto done;}
 	status = nc_get_att_double(ncid, wind_ucmp_id, "_FillValue", &fill_value);	// should get this in text_read and store, but will have to go short to float and back
 	if (status != NC_NOERR) 
@@ -534,8 +538,6 @@ LAS:
 	status = nc_get_att_double(ncid, wind_ucmp_id, "scale_factor", &scale_factor);
 	//if (status != NC_NOERR) {err = -1; goto done;}	// don't require scale factor
 	
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	velH = (VelocityFH)_NewHandleClear(totalNumberOfVels * sizeof(VelocityFRec));
 	if (!velH) {err = memFullErr; goto done;}
@@ -708,36 +710,6 @@ VelocityRec TimeGridWindCurv_c::GetInterpolatedMove(const Seconds& model_time, I
 	return scaledPatVelocity;
 }
 
-OSErr TimeGridWindCurv_c::get_values(int n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels) {
-
-	if(!ref || !vels) {
-		//cout << "worldpoints array not provided! returning.\n";
-		return 1;
-	}	
-	
-	WorldPoint3D rec;
-	
-	VelocityRec zero_vel ={0.,0.};
-	
-	for (int i = 0; i < n; i++) {
-		
-		// will get all values and let movers figure out which ones to use
-		rec.p = ref[i].p;
-		rec.z = ref[i].z;
-		
-		// let's do the multiply by 1000000 here - this is what gnome expects
-		rec.p.pLat *= 1000000;	
-		rec.p.pLong*= 1000000;
-
-		vels[i] = GetScaledPatValue(model_time, rec);
-		
-		//delta[i].p.pLat /= 1000000;
-		//delta[i].p.pLong /= 1000000;
-	}
-	
-	return noErr;
-}
-
 VelocityRec TimeGridWindCurv_c::GetScaledPatValue(const Seconds& model_time, WorldPoint3D refPoint)
 {
 	double timeAlpha;
@@ -821,6 +793,7 @@ scale:
 // this code is for curvilinear grids
 OSErr TimeGridWindCurv_c::TextRead(const char *path, const char *topFilePath) // don't want a map
 {
+	GnomeLock fileLock(GnomeFileIOMutex());
 	OSErr err = 0;
 	char s[256], topPath[256];
 	char recname[NC_MAX_NAME];
@@ -1214,13 +1187,13 @@ OSErr TimeGridWindCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	//if (status != NC_NOERR) {err = -1; goto done;}
 	if (status != NC_NOERR)
 	{
 #if TARGET_API_MAC_CARBON
 		err = ConvertTraditionalPathToUnixPath((const char *) path, outPath, kMaxNameLen) ;
-		status = nc_open(outPath, NC_NOWRITE, &ncid);
+		status = OpenTimeDataFile(outPath, &ncid);
 #endif
 		if (status != NC_NOERR) {err = -1; goto done;}
 	}
@@ -1248,16 +1221,16 @@ OSErr TimeGridWindCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 		if(!wind_uvals) {TechError("TimeGridWindCurv_c::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
 		wind_vvals = new float[latlength*lonlength]; 
 		if(!wind_vvals) {TechError("TimeGridWindCurv_c::ReadTimeData()", "new[]", 0); err = memFullErr; goto done;}
-		status = nc_inq_varid(ncid, "air_u", &wind_ucmp_id);
+		status = InqVarID(ncid, "air_u", &wind_ucmp_id);
 		if (status != NC_NOERR)
 		{
-			status = nc_inq_varid(ncid, "u", &wind_ucmp_id);
+			status = InqVarID(ncid, "u", &wind_ucmp_id);
 			if (status != NC_NOERR)
 			{
-				status = nc_inq_varid(ncid, "U", &wind_ucmp_id);
+				status = InqVarID(ncid, "U", &wind_ucmp_id);
 				if (status != NC_NOERR)
 				{
-					status = nc_inq_varid(ncid, "WindSpd_SFC", &wind_ucmp_id);
+					status = InqVarID(ncid, "WindSpd_SFC", &wind_ucmp_id);
 					if (status != NC_NOERR)
 					{err = -1; goto done;}
 					bIsNWSSpeedDirData = true;
@@ -1268,19 +1241,19 @@ OSErr TimeGridWindCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 		}
 		if (bIsNWSSpeedDirData)
 		{
-			status = nc_inq_varid(ncid, "WindDir_SFC", &wind_vcmp_id);
+			status = InqVarID(ncid, "WindDir_SFC", &wind_vcmp_id);
 			if (status != NC_NOERR)
 			{err = -2; goto done;}
 		}
 		else
 		{
-			status = nc_inq_varid(ncid, "air_v", &wind_vcmp_id);
+			status = InqVarID(ncid, "air_v", &wind_vcmp_id);
 			if (status != NC_NOERR) 
 			{
-				status = nc_inq_varid(ncid, "v", &wind_vcmp_id);
+				status = InqVarID(ncid, "v", &wind_vcmp_id);
 				if (status != NC_NOERR) 
 				{
-					status = nc_inq_varid(ncid, "V", &wind_vcmp_id);
+					status = InqVarID(ncid, "V", &wind_vcmp_id);
 					if (status != NC_NOERR)
 					{err = -1; goto done;}
 				}
@@ -1291,9 +1264,9 @@ OSErr TimeGridWindCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 		status = nc_inq_varndims(ncid, wind_ucmp_id, &uv_ndims);
 		if (status==NC_NOERR){if (uv_ndims < numdims && uv_ndims==3) {wind_count[1] = latlength; wind_count[2] = lonlength;}}	// could have more dimensions than are used in u,v
 		
-		status = nc_get_vara_float(ncid, wind_ucmp_id, wind_index, wind_count, wind_uvals);
+		status = GetVaraCached(ncid, path, wind_ucmp_id, wind_index, wind_count, wind_uvals);
 		if (status != NC_NOERR) {err = -1; goto done;}
-		status = nc_get_vara_float(ncid, wind_vcmp_id, wind_index, wind_count, wind_vvals);
+		status = GetVaraCached(ncid, path, wind_vcmp_id, wind_index, wind_count, wind_vvals);
 		if (status != NC_NOERR) {err = -1; goto done;}
 		status = nc_get_att_float(ncid, wind_ucmp_id, "_FillValue", &fill_value);
 		if (status != NC_NOERR) 
@@ -1326,8 +1299,6 @@ OSErr TimeGridWindCurv_c::ReadTimeData(long index,VelocityFH *velocityH, char* e
 	}
 	
 	
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	velH = (VelocityFH)_NewHandleClear(totalNumberOfVels * sizeof(VelocityFRec));
 	if (!velH) {err = memFullErr; goto done;}
@@ -1592,6 +1563,7 @@ done:
 // simplify for wind data - no map needed, no mask 
 OSErr TimeGridWindCurv_c::ReorderPoints(char* errmsg) 
 {
+	MemoryTag memoryTag(kMemTopology);
 	long i, j, n, ntri, numVerdatPts=0;
 	long fNumRows_ext = fNumRows+1, fNumCols_ext = fNumCols+1;
 	long nv = fNumRows * fNumCols, nv_ext = fNumRows_ext*fNumCols_ext;
@@ -1904,6 +1876,7 @@ done:
 
 OSErr TimeGridWindCurv_c::ReorderPointsCOOPSNoMask(char* errmsg) 
 {	// this should be combined with ReorderPointsCOOPSMask - they are the same since we don't use the mask
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	long i,j,k;
 	char *velUnits=0; 
@@ -2196,8 +2169,9 @@ done:
 }
 
 // import NetCDF curvilinear info so don't have to regenerate
-OSErr TimeGridWindCurv_c::ReadTopology(vector<string> &linesInFile)
+OSErr TimeGridWindCurv_c::ReadTopology(TextLines &linesInFile)
 {
+	MemoryTag memoryTag(kMemTopology);
 	OSErr err = 0;
 	string currentLine;
 
@@ -2470,10 +2444,19 @@ done:
 }
 
 
+OSErr TimeGridWindCurv_c::ReadTopology(vector<string> &linesInFile)
+{
+	TextLines lines(linesInFile);
+
+	return ReadTopology(lines);
+}
+
+
 // import NetCDF curvilinear info so don't have to regenerate
 OSErr TimeGridWindCurv_c::ReadTopology(const char *path)
 {
-	vector<string> linesInFile;
+	MemoryTag memoryTag(kMemTopology);
+	TextLines linesInFile;
 
 	ReadLinesInFile(path, linesInFile);
 	return ReadTopology(linesInFile);
@@ -2549,16 +2532,18 @@ TimeGridWindIce_c::TimeGridWindIce_c () : TimeGridWindCurv_c(), TimeGridVel_c()
 	fEndDataFraction.timeIndex = UNASSIGNEDINDEX;
 	fEndDataFraction.dataHdl = 0;
 	
+	fIceProducts = 0;
 }
 
 void TimeGridWindIce_c::Dispose ()
 {
-	if(fStartDataIce.dataHdl)DisposeLoadedData(&fStartDataIce); 
-	if(fEndDataIce.dataHdl)DisposeLoadedData(&fEndDataIce); 
-	if(fStartDataThickness.dataHdl)DisposeLoadedData(&fStartDataThickness);
-	if(fEndDataThickness.dataHdl)DisposeLoadedData(&fEndDataThickness);
-	if(fStartDataFraction.dataHdl)DisposeLoadedData(&fStartDataFraction);
-	if(fEndDataFraction.dataHdl)DisposeLoadedData(&fEndDataFraction);
+	DisposeLoadedData(&fStartDataIce); 
+	DisposeLoadedData(&fEndDataIce); 
+	DisposeLoadedData(&fStartDataThickness);
+	DisposeLoadedData(&fEndDataThickness);
+	DisposeLoadedData(&fStartDataFraction);
+	DisposeLoadedData(&fEndDataFraction);
+	if (fIceProducts) {delete fIceProducts; fIceProducts = 0;}
 	
 	TimeGridWindCurv_c::Dispose ();
 }
@@ -2572,17 +2557,19 @@ void TimeGridWindIce_c::Dispose ()
 void TimeGridWindIce_c::DisposeLoadedStartData()
 {
 	if(fStartData.dataHdl)DisposeLoadedData(&fStartData); 
-	if(fStartDataIce.dataHdl)DisposeLoadedData(&fStartDataIce);
-	if(fStartDataThickness.dataHdl)DisposeLoadedData(&fStartDataThickness);
-	if(fStartDataFraction.dataHdl)DisposeLoadedData(&fStartDataFraction);
+	DisposeLoadedData(&fStartDataIce);
+	DisposeLoadedData(&fStartDataThickness);
+	DisposeLoadedData(&fStartDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceStartSlice);
 }
 
 void TimeGridWindIce_c::DisposeLoadedEndData()
 {
 	if(fEndData.dataHdl)DisposeLoadedData(&fEndData); 
-	if(fEndDataIce.dataHdl)DisposeLoadedData(&fEndDataIce);
-	if(fEndDataThickness.dataHdl)DisposeLoadedData(&fEndDataThickness);
-	if(fEndDataFraction.dataHdl)DisposeLoadedData(&fEndDataFraction);
+	DisposeLoadedData(&fEndDataIce);
+	DisposeLoadedData(&fEndDataThickness);
+	DisposeLoadedData(&fEndDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceEndSlice);
 }
 
 void TimeGridWindIce_c::ShiftInterval()
@@ -2591,6 +2578,7 @@ void TimeGridWindIce_c::ShiftInterval()
 	fStartDataIce = fEndDataIce;
 	fStartDataThickness = fEndDataThickness;
 	fStartDataFraction = fEndDataFraction;
+	if (fIceProducts) fIceProducts -> ShiftInterval();
 	ClearLoadedEndData();
 	
 }
@@ -2604,14 +2592,16 @@ void TimeGridWindIce_c::ShiftInterval()
 void TimeGridWindIce_c::ClearLoadedEndData()
 {
 	if(fEndData.dataHdl)ClearLoadedData(&fEndData); 
-	if(fEndDataIce.dataHdl)ClearLoadedData(&fEndDataIce);
-	if(fEndDataThickness.dataHdl)ClearLoadedData(&fEndDataThickness);
-	if(fEndDataFraction.dataHdl)ClearLoadedData(&fEndDataFraction);
-	
+	ClearLoadedData(&fEndDataIce);
+	ClearLoadedData(&fEndDataThickness);
+	ClearLoadedData(&fEndDataFraction);
+	if (fIceProducts) fIceProducts -> InvalidateSlice(kIceEndSlice);
 }
 
 OSErr TimeGridWindIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 {
+	MemoryTag memoryTag(kMemTimeSlices);
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
 	OSErr err = 0;
 
 	long timeDataInterval = 0;
@@ -2625,6 +2615,8 @@ OSErr TimeGridWindIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 	if (intervalLoaded)
 		return 0;
 
+	GnomeLock fileLock(GnomeFileIOMutex());
+
 	// check for constant current 
 	if (numTimesInFile == 1 && !(GetNumFiles() > 1))
 		//or if(timeDataInterval==-1)
@@ -2719,10 +2711,10 @@ OSErr TimeGridWindIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 		
 		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
 		{ // start data is not loaded
+			// the ice data is read by LoadIceFields when something asks for it
 			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
-			err = this -> ReadTimeDataIce(indexOfStart,&fStartDataIce.dataHdl,errmsg);
-			err = this -> ReadTimeDataFields(indexOfStart,&fStartDataThickness.dataHdl,&fStartDataFraction.dataHdl,errmsg);
 			if(err) goto done;
+			ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartData.dataHdl));
 			fStartData.timeIndex = indexOfStart;
 			fStartDataIce.timeIndex = indexOfStart;
 			fStartDataThickness.timeIndex = indexOfStart;
@@ -2732,9 +2724,8 @@ OSErr TimeGridWindIce_c::SetInterval(char *errmsg, const Seconds& model_time)
 		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
 		{
 			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
-			err = this -> ReadTimeDataIce(indexOfEnd,&fEndDataIce.dataHdl,errmsg);
-			err = this -> ReadTimeDataFields(indexOfEnd,&fEndDataThickness.dataHdl,&fEndDataFraction.dataHdl,errmsg);
 			if(err) goto done;
+			ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndData.dataHdl));
 			fEndData.timeIndex = indexOfEnd;
 			fEndDataIce.timeIndex = indexOfEnd;
 			fEndDataThickness.timeIndex = indexOfEnd;
@@ -2759,6 +2750,7 @@ done:
 
 OSErr TimeGridWindIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_time)
 {
+	MemoryTag memoryTag(kMemTimeSlices);
 	OSErr err = 0;
 	Seconds time = model_time, startTime, endTime, lastEndTime, testTime, firstStartTime; 
 	
@@ -2766,6 +2758,11 @@ OSErr TimeGridWindIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_tim
 
 	errmsg[0] = 0;
 
+	// what is loaded may be shifted or kept across the change of file, so the
+	// ice data left for later has to come from this file
+	if ((err = LoadIceFields(errmsg, kIceVelocities | kIceFields)))
+		return err;
+
 	if (fEndData.timeIndex!=UNASSIGNEDINDEX)
 		testTime = (*fTimeHdl)[fEndData.timeIndex];	// currently loaded end time
 	
@@ -2908,6 +2905,48 @@ OSErr TimeGridWindIce_c::CheckAndScanFile(char *errmsg, const Seconds& model_tim
 	return -1;	
 }
 
+OSErr TimeGridWindIce_c::LoadIceFields(char *errmsg, short fields)
+{	// reads the ice data of the loaded times that SetInterval left unread
+	MemoryTag memoryTag(kMemTimeSlices);
+	TIME_SECTION(&fTiming, kTimerReadData, 0);
+	OSErr err = 0;
+	
+	errmsg[0] = 0;
+	
+	GnomeLock fileLock(GnomeFileIOMutex());
+	
+	if ((fields & kIceVelocities) && fStartDataIce.timeIndex >= 0 && !fStartDataIce.dataHdl)
+	{
+		if ((err = this -> ReadTimeDataIce(fStartDataIce.timeIndex,&fStartDataIce.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartDataIce.dataHdl));
+	}
+	if ((fields & kIceVelocities) && fEndDataIce.timeIndex >= 0 && !fEndDataIce.dataHdl)
+	{
+		if ((err = this -> ReadTimeDataIce(fEndDataIce.timeIndex,&fEndDataIce.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndDataIce.dataHdl));
+	}
+	// thickness and fraction are read together, each is zeroed where the other is missing
+	if ((fields & kIceFields) && fStartDataThickness.timeIndex >= 0 && !fStartDataThickness.dataHdl)
+	{
+		if ((err = this -> ReadTimeDataFields(fStartDataThickness.timeIndex,&fStartDataThickness.dataHdl,&fStartDataFraction.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fStartDataThickness.dataHdl) + LoadedBytes((Handle)fStartDataFraction.dataHdl));
+	}
+	if ((fields & kIceFields) && fEndDataThickness.timeIndex >= 0 && !fEndDataThickness.dataHdl)
+	{
+		if ((err = this -> ReadTimeDataFields(fEndDataThickness.timeIndex,&fEndDataThickness.dataHdl,&fEndDataFraction.dataHdl,errmsg))) goto done;
+		ADD_BYTES_READ(&fTiming, kTimerReadData, LoadedBytes((Handle)fEndDataThickness.dataHdl) + LoadedBytes((Handle)fEndDataFraction.dataHdl));
+	}
+	
+done:
+	if(err)
+	{
+		if(!errmsg[0])strcpy(errmsg,"Error in TimeGridWindIce::LoadIceFields()");
+		DisposeLoadedStartData();
+		DisposeLoadedEndData();
+	}
+	return err;
+}
+
 double TimeGridWindIce_c::GetStartFieldValue(long index, long field)
 {	// 
 	double value = 0;
@@ -3222,7 +3261,7 @@ OSErr TimeGridWindIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 
 	status = nc_inq_ndims(ncid, &numdims);
@@ -3245,7 +3284,7 @@ OSErr TimeGridWindIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	angle_count[0] = latlength;
 	angle_count[1] = lonlength;
 	
-	status = nc_inq_varid(ncid, "ang", &angle_id);
+	status = InqVarID(ncid, "ang", &angle_id);
 	if (status != NC_NOERR) {/*err = -1; goto done;*/bRotated = false;}
 	else
 	{
@@ -3269,19 +3308,19 @@ OSErr TimeGridWindIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 		goto done;
 	}
 
-	status = nc_inq_varid(ncid, "ice_u", &ice_ucmp_id);
+	status = InqVarID(ncid, "ice_u", &ice_ucmp_id);
 	if (status != NC_NOERR)
 	{
-		status = nc_inq_varid(ncid, "ICE_U", &ice_ucmp_id);
+		status = InqVarID(ncid, "ICE_U", &ice_ucmp_id);
 		if (status != NC_NOERR)
 		{
 			err = -1; goto done;
 		}
 	}
-	status = nc_inq_varid(ncid, "ice_v", &ice_vcmp_id);
+	status = InqVarID(ncid, "ice_v", &ice_vcmp_id);
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "ICE_V", &ice_vcmp_id);
+		status = InqVarID(ncid, "ICE_V", &ice_vcmp_id);
 		if (status != NC_NOERR) 
 		{
 			err = -1; goto done;
@@ -3319,8 +3358,6 @@ OSErr TimeGridWindIce_c::ReadTimeDataIce(long index,VelocityFH *velocityH, char*
 	//if (status != NC_NOERR) {err = -1; goto done;}	// don't require
 	status = nc_get_att_double(ncid, ice_ucmp_id, "scale_factor", &scale_factor);
 
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	// NOTE: if allow fill_value as NaN need to be sure to check for it wherever fill_value is used
 	if (isnan(fill_value))
@@ -3416,7 +3453,7 @@ OSErr TimeGridWindIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOU
 	strcpy(path,fVar.pathName);
 	if (!path || !path[0]) return -1;
 	
-	status = nc_open(path, NC_NOWRITE, &ncid);
+	status = OpenTimeDataFile(path, &ncid);
 	if (status != NC_NOERR) {err = -1; goto done;}
 
 	status = nc_inq_ndims(ncid, &numdims);
@@ -3452,19 +3489,19 @@ OSErr TimeGridWindIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOU
 		goto done;
 	}
 
-	status = nc_inq_varid(ncid, "ice_thickness", &data_thickness_id);
+	status = InqVarID(ncid, "ice_thickness", &data_thickness_id);
 	if (status != NC_NOERR)
 	{
-		status = nc_inq_varid(ncid, "ICE_U", &data_thickness_id);
+		status = InqVarID(ncid, "ICE_U", &data_thickness_id);
 		if (status != NC_NOERR)
 		{
 			err = -1; goto done;
 		}
 	}
-	status = nc_inq_varid(ncid, "ice_fraction", &data_fraction_id);
+	status = InqVarID(ncid, "ice_fraction", &data_fraction_id);
 	if (status != NC_NOERR) 
 	{
-		status = nc_inq_varid(ncid, "ICE_V", &data_fraction_id);
+		status = InqVarID(ncid, "ICE_V", &data_fraction_id);
 		if (status != NC_NOERR) 
 		{
 			err = -1; goto done;
@@ -3505,8 +3542,6 @@ OSErr TimeGridWindIce_c::ReadTimeDataFields(long index, DOUBLEH *thicknessH, DOU
 	status = nc_get_att_double(ncid, data_thickness_id, "scale_factor", &scale_factor1);
 	status = nc_get_att_double(ncid, data_fraction_id, "scale_factor", &scale_factor2);
 
-	status = nc_close(ncid);
-	if (status != NC_NOERR) {err = -1; goto done;}
 	
 	// NOTE: if allow fill_value as NaN need to be sure to check for it wherever fill_value is used
 	if (isnan(fill_value))
@@ -3574,7 +3609,8 @@ done:
 
 OSErr TimeGridWindIce_c::GetIceFields(Seconds time, double *thickness, double *fraction)
 {	// use for curvilinear
-	double timeAlpha;
+	double timeAlpha = 1;
+	Boolean constantField;
 	Seconds startTime,endTime;
 	OSErr err = 0;
 	
@@ -3592,6 +3628,8 @@ OSErr TimeGridWindIce_c::GetIceFields(Seconds time, double *thickness, double *f
 
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceFields);
+	if(err) return err;
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
 	if(!loaded) return -1;
@@ -3630,46 +3668,26 @@ OSErr TimeGridWindIce_c::GetIceFields(Seconds time, double *thickness, double *f
 	}
 	
 	numCells = numTri / 2;
-	//for (i = 0 ; i< numTri; i++)
-	for (i = 0 ; i< numCells; i++)
-	{
-		triIndex = i*2;
-		/*if (bVelocitiesOnNodes)
+	if (!fIceProducts) fIceProducts = new IceFieldProducts;
+	if (!fIceProducts -> HasCellIndices(numCells))
+	{	// the cells' indices in the fields don't change with time
+		vector<long> cellIndex(numCells, -1);
+		for (i = 0 ; i< numCells; i++)
 		{
-			//index = ((TTriGridVel*)fGrid)->GetRectIndexFromTriIndex(refPoint,fVerdatToNetCDFH,fNumCols);// curvilinear grid
-			//interpolationVal = triGrid -> GetInterpolationValues(refPoint.p);
-			//interpolationVal = triGrid -> GetInterpolationValuesFromIndex(i);
-			interpolationVal = triGrid -> GetInterpolationValuesFromIndex(triIndex);
-			if (interpolationVal.ptIndex1<0) {thickness[i] = 0;	fraction[i] = 0;}// should this be an error?
-			//ptIndex1 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];	
-			//ptIndex2 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex2];
-			//ptIndex3 =  (*fVerdatToNetCDFH)[interpolationVal.ptIndex3];
-			index = (*fVerdatToNetCDFH)[interpolationVal.ptIndex1];
-		}
-		else*/ // for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
-			//index = (dynamic_cast<TTriGridVel*>(fGrid))->GetRectIndexFromTriIndex(refPoint.p,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-			//index = triGrid->GetRectIndexFromTriIndex2(i,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
+			triIndex = i*2;
+			// for now just use the u,v at left and bottom midpoints of grid box as velocity over entire gridbox
 			index = triGrid->GetRectIndexFromTriIndex2(triIndex,fVerdatToNetCDFH,fNumCols+1);// curvilinear grid
-
-		if (index < 0) {thickness[i] = 0;	fraction[i] = 0;}// should this be an error?
-		
-		// Should check vs fFillValue
-		// Check for constant current 
-		if(((GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1) && index!=-1)
-		{
-				thickness[i] = GetStartFieldValue(index,1);
-				fraction[i] = GetStartFieldValue(index,2);
-		}
-		else if (index!=-1)// time varying current
-		{
-			thickness[i] = timeAlpha*GetStartFieldValue(index,1) + (1-timeAlpha)*GetEndFieldValue(index,1);
-			fraction[i] = timeAlpha*GetStartFieldValue(index,2) + (1-timeAlpha)*GetEndFieldValue(index,2);
+			cellIndex[i] = index < 0 ? -1 : index;
 		}
-		if (thickness[i] == fFillValue) thickness[i] = 0.;
-		if (fraction[i] == fFillValue) fraction[i] = 0.;
-		//thickness[i] *= fVar.fileScaleFactor;	// doing this on read
-		//fraction[i] *= fVar.fileScaleFactor; // doing this on read
+		fIceProducts -> SetCellIndices(cellIndex);
 	}
+
+	// the cells' values of each slice are gathered once, only the blend is per time
+	constantField = (GetNumTimesInFile()==1 && !(GetNumFiles()>1)) || timeAlpha == 1;
+	fIceProducts -> LoadSlice(kIceStartSlice, fStartDataThickness.dataHdl, fStartDataFraction.dataHdl, fFillValue);
+	if (!constantField)
+		fIceProducts -> LoadSlice(kIceEndSlice, fEndDataThickness.dataHdl, fEndDataFraction.dataHdl, fFillValue);
+	fIceProducts -> GetFields(time, !constantField, timeAlpha, fFillValue, thickness, fraction);
 	return err;
 }
 
@@ -3695,6 +3713,8 @@ OSErr TimeGridWindIce_c::GetIceVelocities(Seconds time, VelocityFRec *ice_veloci
 	
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceVelocities);
+	if(err) return err;
 	
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
@@ -3780,6 +3800,22 @@ OSErr TimeGridWindIce_c::GetIceVelocities(Seconds time, VelocityFRec *ice_veloci
 	return err;
 }
 
+OSErr TimeGridWindIce_c::get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints)
+{
+	OSErr err = 0;
+	char errmsg[256];
+	
+	if (n > 0 && ref && vels)
+	{
+		if ((err = this -> SetInterval(errmsg, model_time)))
+			return err;
+		if ((err = LoadIceFields(errmsg, kIceFields)))
+			return err;
+	}
+	
+	return TimeGridVel_c::get_values(n, model_time, ref, vels, hints);
+}
+
 OSErr TimeGridWindIce_c::GetMovementVelocities(Seconds time, VelocityFRec *movement_velocity)
 {	// use for curvilinear
 	OSErr err = 0;
@@ -3803,6 +3839,8 @@ OSErr TimeGridWindIce_c::GetMovementVelocities(Seconds time, VelocityFRec *movem
 
 	err = this -> SetInterval(errmsg, time);
 	if(err) return err;
+	err = LoadIceFields(errmsg, kIceVelocities | kIceFields);
+	if(err) return err;
 	
 	loaded = this -> CheckInterval(timeDataInterval, time);	 
 	
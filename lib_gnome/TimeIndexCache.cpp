@@ -0,0 +1,194 @@
+/*
+ *  TimeIndexCache.cpp
+ *  gnome
+ *
+ *  File layout: a fixed header, then the records as raw Seconds, or raw
+ *  PtCurTimeData for the ASCII blocks. An entry is found by the same path,
+ *  size, modification time and time zone key as the time values cache, so
+ *  a file that changed is just scanned again.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "TimeIndexCache.h"
+#include "TimeValuesCache.h"
+#include "TopologyCache.h"
+#include "MemUtils.h"
+#include "SetupStats.h"
+#include "Replacements.h"
+
+using std::string;
+
+#define kTimeIndexCacheMagic	"GNTIDX\r\n"
+#define kTimeIndexCacheVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		headerSize;
+	uint64_t	key;
+	int32_t		recordSize;		// the records are platform values, so this must match to use a file
+	int32_t		unused;
+	int64_t		numRecords;
+} TimeIndexCacheHeader;
+
+static string cacheDir;
+
+void SetTimeIndexCacheDir(const char *dir)
+{
+	cacheDir = dir ? dir : "";
+}
+
+const char *GetTimeIndexCacheDir()
+{
+	return cacheDir.c_str();
+}
+
+Boolean TimeIndexCacheIsOn()
+{
+	return !cacheDir.empty();
+}
+
+// each kind of index has its own entry for a file
+static uint64_t TimeIndexCacheKey(const char *path, const char *reader)
+{
+	return TimeValuesCacheKey(path, TopologyCacheHash(reader, strlen(reader)));
+}
+
+static string TimeIndexCachePath(uint64_t key)
+{
+	char name[32];
+	string path = cacheDir;
+
+	sprintf(name, "%016llx.gnometimes", (unsigned long long)key);
+	if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+		path += '/';
+	return path + name;
+}
+
+static OSErr ReadIndexCache(const char *path, const char *reader, int32_t recordSize, Handle *h)
+{
+	OSErr err = -1;
+	FILE *fp = 0;
+	TimeIndexCacheHeader header;
+	Handle records = 0;
+	uint64_t key;
+	long numBytes;
+
+	if (!TimeIndexCacheIsOn() || !(key = TimeIndexCacheKey(path, reader)))
+		return -1;
+
+	fp = fopen(TimeIndexCachePath(key).c_str(), "rb");
+	if (!fp)
+		return -1;
+
+	if (fread(&header, sizeof(header), 1, fp) != 1)
+		goto done;
+	if (memcmp(header.magic, kTimeIndexCacheMagic, 8) || header.version != kTimeIndexCacheVersion ||
+		header.headerSize != (int32_t)sizeof(header) || header.key != key)
+		goto done;
+	if (header.recordSize != recordSize || header.numRecords <= 0)
+		goto done;
+
+	numBytes = header.numRecords * recordSize;
+	records = _NewHandle(numBytes);
+	if (!records) {
+		TechError("ReadTimeIndexCache()", "_NewHandle()", 0);
+		err = memFullErr;
+		goto done;
+	}
+	if (fread(*records, 1, numBytes, fp) != (size_t)numBytes)
+		goto done;
+
+	*h = records;
+	records = 0;
+	err = 0;
+	CountSetupCacheHit(kSetupCacheTimeIndex);
+
+done:
+	fclose(fp);
+	if (records) DisposeHandle(records);
+
+	return err;
+}
+
+static OSErr WriteIndexCache(const char *path, const char *reader, int32_t recordSize, Handle h)
+{
+	FILE *fp = 0;
+	TimeIndexCacheHeader header;
+	string cachePath, tempPath;
+	char suffix[32];
+	uint64_t key;
+	long numBytes;
+	Boolean ok;
+
+	if (!TimeIndexCacheIsOn() || !h || !(key = TimeIndexCacheKey(path, reader)))
+		return -1;
+
+	numBytes = _GetHandleSize(h);
+	numBytes -= numBytes % recordSize;
+	if (numBytes <= 0)
+		return -1;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kTimeIndexCacheMagic, 8);
+	header.version = kTimeIndexCacheVersion;
+	header.headerSize = sizeof(header);
+	header.key = key;
+	header.recordSize = recordSize;
+	header.numRecords = numBytes / recordSize;
+
+	// write beside the final name and rename, so a reader never sees half a
+	// file. The processes of a run may write the same entry at once, so each
+	// writes its own temporary file
+	cachePath = TimeIndexCachePath(key);
+	sprintf(suffix, ".%ld.tmp", (long)getpid());
+	tempPath = cachePath + suffix;
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return -1;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(*h, 1, numBytes, fp) == (size_t)numBytes;
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(cachePath.c_str());	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), cachePath.c_str()) == 0;
+	}
+	if (!ok) {
+		remove(tempPath.c_str());
+		return -1;
+	}
+
+	return 0;
+}
+
+OSErr ReadTimeIndexCache(const char *path, Seconds ***timeH)
+{
+	return ReadIndexCache(path, "NetCDF times", sizeof(Seconds), (Handle *)timeH);
+}
+
+OSErr WriteTimeIndexCache(const char *path, Seconds **timeH)
+{
+	return WriteIndexCache(path, "NetCDF times", sizeof(Seconds), (Handle)timeH);
+}
+
+OSErr ReadTimeDataIndexCache(const char *path, PtCurTimeDataHdl *timeDataH)
+{
+	return ReadIndexCache(path, "ASCII time blocks", sizeof(PtCurTimeData), (Handle *)timeDataH);
+}
+
+OSErr WriteTimeDataIndexCache(const char *path, PtCurTimeDataHdl timeDataH)
+{
+	return WriteIndexCache(path, "ASCII time blocks", sizeof(PtCurTimeData), (Handle)timeDataH);
+}
@@ -0,0 +1,42 @@
+/*
+ *  TimeIndexCache.h
+ *  gnome
+ *
+ *  On disk index of the times in the NetCDF files of a multiple file
+ *  forcing list, so opening a model on a long archive of files doesn't open
+ *  every file again to learn its time axis, and of the [TIME] blocks of the
+ *  ASCII grid current files, so a large one isn't scanned through again.
+ *  A file's entry is checked against its size and modification time and is
+ *  shared by all the runs and processes using the directory. Off unless a
+ *  directory is set.
+ *
+ */
+
+#ifndef __TimeIndexCache__
+#define __TimeIndexCache__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+// directory the index files go in, empty or NULL turns the index off
+void DLL_API SetTimeIndexCacheDir(const char *dir);
+DLL_API const char *GetTimeIndexCacheDir();
+Boolean TimeIndexCacheIsOn();
+
+// the times ScanFileForTimes read from the file at path. On success the
+// caller owns the new handle, a miss (no entry, the file changed, other
+// platform sizes, truncated entry) returns an error and allocates nothing
+OSErr ReadTimeIndexCache(const char *path, Seconds ***timeH);
+
+// the handle is only read, failures are not fatal to the caller
+OSErr WriteTimeIndexCache(const char *path, Seconds **timeH);
+
+// the same for the offsets, lengths and times of the [TIME] blocks of an
+// ASCII file, as the ScanFileForTimes of the time data handles found them
+OSErr ReadTimeDataIndexCache(const char *path, PtCurTimeDataHdl *timeDataH);
+OSErr WriteTimeDataIndexCache(const char *path, PtCurTimeDataHdl timeDataH);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ *  TimeInterval.h
+ *  gnome
+ *
+ *  The search of the movers' CheckInterval for the interval of their times
+ *  the model time is in. The model time mostly steps forward, so the
+ *  interval found last is kept as a cursor and it and the one after it are
+ *  checked first; else the times are searched by halves.
+ *
+ */
+
+#ifndef __TimeInterval__
+#define __TimeInterval__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+// time i of a handle of times, with the mover's time shift
+class ShiftedTimes
+{
+	public:
+		ShiftedTimes(Seconds **times, long shift) : fTimes(times), fShift(shift) {}
+		Seconds operator()(long i) const { return (*fTimes)[i] + fShift; }
+
+	private:
+		Seconds	**fTimes;
+		long	fShift;
+};
+
+// time i of a handle of PtCurTimeData
+class PtCurTimes
+{
+	public:
+		PtCurTimes(PtCurTimeDataHdl times) : fTimes(times) {}
+		Seconds operator()(long i) const { return (*fTimes)[i].time; }
+
+	private:
+		PtCurTimeDataHdl	fTimes;
+};
+
+// True if time is in one of the intervals of the numTimes times, which don't
+// decrease, and interval is set to it as CheckInterval's timeDataInterval:
+// i + 1 for the interval between times i and i + 1, the first of them if time
+// is one of the times. False, and interval isn't changed, if time is before
+// the first time or after the last. cursor is the interval found last, any
+// value at first, and is set to the one found.
+template <class Times>
+Boolean FindTimeInterval(const Times &times, long numTimes, Seconds time, long *cursor, long &interval)
+{
+	long i, low, high, mid;
+
+	if (numTimes < 2)
+		return false;
+
+	for (i = *cursor; i <= *cursor + 1; i++) {
+		if (i >= 1 && i < numTimes && time <= times(i) &&
+			(i == 1 ? time >= times(0) : time > times(i - 1))) {
+			*cursor = interval = i;
+			return true;
+		}
+	}
+
+	if (time < times(0) || time > times(numTimes - 1))
+		return false;
+
+	// the first time at or after time, from time 1 on
+	low = 1;
+	high = numTimes - 1;
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (times(mid) < time)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	*cursor = interval = low;
+	return true;
+}
+
+#endif
@@ -0,0 +1,305 @@
+/*
+ *  TimeSliceCache.cpp
+ *  gnome
+ *
+ *  SetInterval may run on several threads (get_move without the GIL, the
+ *  prefetch), so the public functions hold the cache lock.
+ *
+ *  A quantized tile puts the nonzero values of a component between offset -
+ *  32767*scale and offset + 32767*scale; kQuantZero is an exact zero, for the
+ *  land and fill values. The quantization is a function of the velocities
+ *  alone, so two grids reading a slice get the same integers.
+ *
+ */
+
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "TimeSliceCache.h"
+#include "InterpolationKernels.h"
+#include "MemUtils.h"
+#include "GnomeThreads.h"
+
+using std::string;
+using std::vector;
+
+#define kQuantZero -32768
+
+typedef struct {
+	double		uOffset, uScale;
+	double		vOffset, vScale;
+} QuantTile;
+
+typedef struct {
+	string		path;
+	string		variable;
+	long		timeIndex;
+	VelocityFH	dataHdl;	// 0 for a quantized slice no one is using
+	long		numBytes;
+	long		refCount;
+	unsigned long lastUse;
+	Boolean		quantized;
+	long		numVels;
+	vector<short>	packed;	// u, v of each velocity
+	vector<QuantTile>	tiles;
+} TimeSliceEntry;
+
+static vector<TimeSliceEntry> sliceCache;
+static long maxCacheBytes = 0;
+static long cacheBytes = 0;
+static unsigned long useCount = 0;
+static Boolean quantizeSlices = false;
+static double quantizationError = 0;
+static GnomeMutex cacheMutex;
+
+static long FindTimeSlice(const char *path, const char *variable, long timeIndex)
+{
+	for (long i = 0; i < (long)sliceCache.size(); i++) {
+		TimeSliceEntry &entry = sliceCache[i];
+		if (entry.timeIndex == timeIndex && entry.quantized == quantizeSlices &&
+			entry.path == path && entry.variable == variable)
+			return i;
+	}
+	return -1;
+}
+
+// the offset and scale of component (0 for u, 1 for v) of velocities first to last - 1
+static void GetTileRange(const VelocityFRec *vel, long first, long last, long component, double *offset, double *scale)
+{
+	double low = 0, high = 0, x;
+	Boolean any = false;
+
+	for (long i = first; i < last; i++) {
+		x = component ? vel[i].v : vel[i].u;
+		if (x == 0)
+			continue;
+		if (!any || x < low) low = x;
+		if (!any || x > high) high = x;
+		any = true;
+	}
+	*offset = (low + high) / 2;
+	*scale = (high - low) / 65534;
+}
+
+static short Quantize(double x, double offset, double scale)
+{
+	double q;
+
+	if (x == 0)
+		return kQuantZero;
+	if (scale == 0)
+		return 0;
+	q = floor((x - offset) / scale + .5);
+	if (q < -32767) q = -32767;
+	if (q > 32767) q = 32767;
+	return (short)q;
+}
+
+static double Dequantize(short q, double offset, double scale)
+{
+	return q == kQuantZero ? 0 : offset + q * scale;
+}
+
+// packs h into the entry and sets h to the velocities of the integers,
+// returns the largest change of a u or v
+static double QuantizeTimeSlice(TimeSliceEntry &entry, VelocityFH h)
+{
+	VelocityFRec *vel = *h, quantized;
+	double error = 0;
+	long i, tile;
+
+	entry.numVels = _GetHandleSize((Handle)h) / sizeof(VelocityFRec);
+	entry.packed.resize(2 * entry.numVels);
+	entry.tiles.resize((entry.numVels + kQuantTileSize - 1) / kQuantTileSize);
+
+	for (tile = 0; tile < (long)entry.tiles.size(); tile++) {
+		QuantTile &t = entry.tiles[tile];
+		long first = tile * kQuantTileSize, last = first + kQuantTileSize;
+
+		if (last > entry.numVels) last = entry.numVels;
+		GetTileRange(vel, first, last, 0, &t.uOffset, &t.uScale);
+		GetTileRange(vel, first, last, 1, &t.vOffset, &t.vScale);
+		for (i = first; i < last; i++) {
+			entry.packed[2 * i] = Quantize(vel[i].u, t.uOffset, t.uScale);
+			entry.packed[2 * i + 1] = Quantize(vel[i].v, t.vOffset, t.vScale);
+			quantized.u = Dequantize(entry.packed[2 * i], t.uOffset, t.uScale);
+			quantized.v = Dequantize(entry.packed[2 * i + 1], t.vOffset, t.vScale);
+			if (fabs(quantized.u - vel[i].u) > error) error = fabs(quantized.u - vel[i].u);
+			if (fabs(quantized.v - vel[i].v) > error) error = fabs(quantized.v - vel[i].v);
+			vel[i] = quantized;
+		}
+	}
+	return error;
+}
+
+// the velocities of a packed entry, 0 if there isn't the memory
+static VelocityFH DequantizeTimeSlice(const TimeSliceEntry &entry)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	VelocityFH h = (VelocityFH)_NewHandle(entry.numVels * sizeof(VelocityFRec));
+	VelocityFRec *vel;
+
+	if (!h)
+		return 0;
+	vel = *h;
+	for (long i = 0; i < entry.numVels; i++) {
+		const QuantTile &t = entry.tiles[i / kQuantTileSize];
+		vel[i].u = Dequantize(entry.packed[2 * i], t.uOffset, t.uScale);
+		vel[i].v = Dequantize(entry.packed[2 * i + 1], t.vOffset, t.vScale);
+	}
+	return h;
+}
+
+static long PackedBytes(const TimeSliceEntry &entry)
+{
+	return entry.packed.size() * sizeof(short) + entry.tiles.size() * sizeof(QuantTile);
+}
+
+// a quantized slice no one is using keeps only its integers
+static void PackTimeSlice(TimeSliceEntry &entry)
+{
+	if (!entry.quantized || entry.refCount > 0 || !entry.dataHdl)
+		return;
+	ForgetInterpolationField(entry.dataHdl);
+	DisposeHandle((Handle)entry.dataHdl);
+	entry.dataHdl = 0;
+	cacheBytes -= entry.numBytes - PackedBytes(entry);
+	entry.numBytes = PackedBytes(entry);
+}
+
+// drop unused slices, least recently used first, until under the limit
+static void TrimTimeSliceCache()
+{
+	while (cacheBytes > maxCacheBytes) {
+		long oldest = -1;
+
+		for (long i = 0; i < (long)sliceCache.size(); i++) {
+			if (sliceCache[i].refCount > 0)
+				continue;
+			if (oldest < 0 || sliceCache[i].lastUse < sliceCache[oldest].lastUse)
+				oldest = i;
+		}
+		if (oldest < 0)
+			return;	// everything left is in use
+
+		if (sliceCache[oldest].dataHdl)
+			DisposeHandle((Handle)sliceCache[oldest].dataHdl);
+		cacheBytes -= sliceCache[oldest].numBytes;
+		sliceCache.erase(sliceCache.begin() + oldest);
+	}
+}
+
+void SetTimeSliceCacheSize(long maxBytes)
+{
+	GnomeLock cacheLock(cacheMutex);
+	maxCacheBytes = maxBytes < 0 ? 0 : maxBytes;
+	TrimTimeSliceCache();
+}
+
+long GetTimeSliceCacheSize()
+{
+	return maxCacheBytes;
+}
+
+long GetTimeSliceCacheBytes()
+{
+	GnomeLock cacheLock(cacheMutex);
+	return cacheBytes;
+}
+
+void SetTimeSliceQuantization(Boolean quantize)
+{
+	GnomeLock cacheLock(cacheMutex);
+	quantizeSlices = quantize;
+}
+
+Boolean GetTimeSliceQuantization()
+{
+	return quantizeSlices;
+}
+
+double GetTimeSliceQuantizationError()
+{
+	GnomeLock cacheLock(cacheMutex);
+	return quantizationError;
+}
+
+VelocityFH AcquireTimeSlice(const char *path, const char *variable, long timeIndex)
+{
+	GnomeLock cacheLock(cacheMutex);
+	long i = FindTimeSlice(path, variable, timeIndex);
+	VelocityFH h;
+
+	if (i < 0)
+		return 0;
+
+	if (!sliceCache[i].dataHdl) {
+		sliceCache[i].dataHdl = DequantizeTimeSlice(sliceCache[i]);
+		if (!sliceCache[i].dataHdl)
+			return 0;
+		sliceCache[i].numBytes += _GetHandleSize((Handle)sliceCache[i].dataHdl);
+		cacheBytes += _GetHandleSize((Handle)sliceCache[i].dataHdl);
+	}
+	sliceCache[i].refCount++;
+	sliceCache[i].lastUse = ++useCount;
+	h = sliceCache[i].dataHdl;
+	TrimTimeSliceCache();	// for the velocities just made, the entries can move
+	return h;
+}
+
+Boolean HasTimeSlice(const char *path, const char *variable, long timeIndex)
+{
+	GnomeLock cacheLock(cacheMutex);
+	return FindTimeSlice(path, variable, timeIndex) >= 0;
+}
+
+Boolean AddTimeSlice(const char *path, const char *variable, long timeIndex, VelocityFH h)
+{
+	GnomeLock cacheLock(cacheMutex);
+	TimeSliceEntry entry;
+
+	double error;
+
+	if (maxCacheBytes <= 0 || !h || !path || !path[0])
+		return false;
+
+	entry.quantized = quantizeSlices;
+	entry.numVels = 0;
+	if (entry.quantized) {
+		error = QuantizeTimeSlice(entry, h);
+		if (error > quantizationError) quantizationError = error;
+	}
+
+	if (FindTimeSlice(path, variable, timeIndex) >= 0)
+		return false;
+
+	entry.path = path;
+	entry.variable = variable;
+	entry.timeIndex = timeIndex;
+	entry.dataHdl = h;
+	entry.numBytes = _GetHandleSize((Handle)h) + PackedBytes(entry);
+	entry.refCount = 1;
+	entry.lastUse = ++useCount;
+
+	sliceCache.push_back(entry);
+	cacheBytes += entry.numBytes;
+	TrimTimeSliceCache();
+
+	return true;
+}
+
+Boolean ReleaseTimeSlice(VelocityFH h)
+{
+	GnomeLock cacheLock(cacheMutex);
+	for (long i = 0; i < (long)sliceCache.size(); i++) {
+		if (sliceCache[i].dataHdl == h) {
+			if (sliceCache[i].refCount > 0)
+				sliceCache[i].refCount--;
+			PackTimeSlice(sliceCache[i]);
+			TrimTimeSliceCache();
+			return true;
+		}
+	}
+	return false;
+}
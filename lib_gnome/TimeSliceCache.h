@@ -0,0 +1,52 @@
+/*
+ *  TimeSliceCache.h
+ *  gnome
+ *
+ *  Process wide LRU cache of decoded time slices, so grids that read the same
+ *  file (current and ice, forecast and uncertainty models) share one copy.
+ *  Keyed by file path, variable and time index. Off unless a size is set.
+ *
+ *  With quantization on, a slice is kept as 16 bit integers, each tile of
+ *  kQuantTileSize velocities with its own scale and offset for u and for v,
+ *  and only while it is in use also as velocities. The velocities handed out
+ *  are always those of the integers, also to the grid that read the slice,
+ *  so a run doesn't depend on which grid read it first.
+ *
+ */
+
+#ifndef __TimeSliceCache__
+#define __TimeSliceCache__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+// maximum bytes held, 0 turns the cache off
+// slices still in use are never evicted, so this can be exceeded while they are
+void DLL_API SetTimeSliceCacheSize(long maxBytes);
+long DLL_API GetTimeSliceCacheSize();
+long DLL_API GetTimeSliceCacheBytes();
+
+#define kQuantTileSize 1024	// velocities that share a scale and offset
+
+// lossy 16 bit storage of the slices added from now on, with the cache on.
+// The slices of the other mode are not shared, they go as the cache fills up
+void DLL_API SetTimeSliceQuantization(Boolean quantize);
+Boolean DLL_API GetTimeSliceQuantization();
+// the largest difference in a u or v between a slice read and its 16 bit
+// velocities, over the slices quantized so far
+double DLL_API GetTimeSliceQuantizationError();
+
+// returns a shared slice and adds a reference, or 0 if it is not cached
+VelocityFH AcquireTimeSlice(const char *path, const char *variable, long timeIndex);
+Boolean HasTimeSlice(const char *path, const char *variable, long timeIndex);
+
+// hands a freshly read slice to the cache with one reference
+// returns false (caller keeps ownership) if the cache is off or has the key.
+// With quantization on h is set to its 16 bit velocities either way
+Boolean AddTimeSlice(const char *path, const char *variable, long timeIndex, VelocityFH h);
+
+// drops a reference, returns false if the handle is not owned by the cache
+Boolean ReleaseTimeSlice(VelocityFH h);
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ *  TimeSliceLoader.cpp
+ *  gnome
+ *
+ *  The prefetch reads with the owner's ReadTimeData on the loader's thread;
+ *  the owner calls FinishPrefetch() before it changes the file, its times or
+ *  its grid. A failed prefetch is dropped, Load reads it again and reports
+ *  the error.
+ *
+ */
+
+#include "TimeSliceLoader.h"
+#include "TimeSliceCache.h"
+#include "ForcingIOStats.h"
+#include "TimeGridVel_c.h"
+#include "MemUtils.h"
+
+TimeSliceLoader::TimeSliceLoader(TimeSliceReadProc readProc, void *owner)
+{
+	fReadProc = readProc;
+	fOwner = owner;
+
+	fPrefetchNextTime = true;
+	fPrefetchData.timeIndex = UNASSIGNEDINDEX;
+	fPrefetchData.dataHdl = 0;
+	fPrefetchErr = 0;
+	fPrefetchPath[0] = 0;
+	fPrefetchVariable[0] = 0;
+}
+
+void TimeSliceLoader::Dispose()
+{
+	FinishPrefetch();
+	if (fPrefetchData.dataHdl) CountForcingIO(fPrefetchPath, kIOPrefetchesWasted);
+	Release(&fPrefetchData);
+	fPrefetchPath[0] = 0;
+	fPrefetchVariable[0] = 0;
+}
+
+void TimeSliceLoader::Release(LoadedData *data)
+{
+	if (data->dataHdl && !ReleaseTimeSlice(data->dataHdl)) DisposeHandle((Handle)data->dataHdl);
+	data->dataHdl = 0;
+	data->timeIndex = UNASSIGNEDINDEX;
+}
+
+OSErr TimeSliceLoader::Load(const char *path, const char *variable, long index, LoadedData *data, char *errmsg)
+{
+	MemoryTag memoryTag(kMemTimeSlices);
+	OSErr err = 0;
+
+	FinishPrefetch();
+
+	if (fPrefetchData.dataHdl && fPrefetchData.timeIndex == index &&
+		!strcmp(fPrefetchPath, path) && !strcmp(fPrefetchVariable, variable))
+	{
+		AddTimeSlice(path, variable, index, fPrefetchData.dataHdl);
+		CountForcingIO(path, kIOPrefetchesUsed);
+		*data = fPrefetchData;
+		fPrefetchData.dataHdl = 0;
+		fPrefetchData.timeIndex = UNASSIGNEDINDEX;
+		return noErr;
+	}
+
+	data->dataHdl = AcquireTimeSlice(path, variable, index);
+	CountForcingIO(path, data->dataHdl ? kIOSliceHits : kIOSliceMisses);
+	if (!data->dataHdl) {
+		GnomeLock fileLock(GnomeFileIOMutex());
+
+		err = (*fReadProc)(fOwner, index, &data->dataHdl, errmsg);
+		if (err)
+			return err;
+		AddTimeSlice(path, variable, index, data->dataHdl);
+	}
+	data->timeIndex = index;
+
+	return noErr;
+}
+
+void TimeSliceLoader::Prefetch(void *arg)
+{
+	TimeSliceLoader *loader = (TimeSliceLoader *)arg;
+	MemoryTag memoryTag(kMemTimeSlices);
+	char errmsg[256];
+	GnomeLock fileLock(GnomeFileIOMutex());
+
+	errmsg[0] = 0;
+	loader->fPrefetchErr = (*loader->fReadProc)(loader->fOwner, loader->fPrefetchData.timeIndex, &loader->fPrefetchData.dataHdl, errmsg);
+}
+
+void TimeSliceLoader::StartPrefetch(const char *path, const char *variable, long index)
+{
+	if (!fPrefetchNextTime || fPrefetchThread.Running() || index < 0)
+		return;
+
+	if (fPrefetchData.dataHdl && fPrefetchData.timeIndex == index &&
+		!strcmp(fPrefetchPath, path) && !strcmp(fPrefetchVariable, variable))
+		return;	// already have it
+
+	if (HasTimeSlice(path, variable, index))
+		return;	// another mover has read it
+
+	if (fPrefetchData.dataHdl) CountForcingIO(fPrefetchPath, kIOPrefetchesWasted);
+	Release(&fPrefetchData);
+	fPrefetchData.timeIndex = index;
+	fPrefetchErr = 0;
+	strcpy(fPrefetchPath, path);
+	strcpy(fPrefetchVariable, variable);
+
+	if (!fPrefetchThread.Start(Prefetch, this))
+		fPrefetchData.timeIndex = UNASSIGNEDINDEX;	// no thread, Load will read it when needed
+	else
+		CountForcingIO(fPrefetchPath, kIOPrefetches);
+}
+
+void TimeSliceLoader::FinishPrefetch()
+{
+	int64_t waitStart;
+
+	if (!fPrefetchThread.Running())
+		return;
+
+	waitStart = ForcingIOClock();
+	fPrefetchThread.Join();
+	CountForcingIO(fPrefetchPath, kIOPrefetchWaitNanoseconds, ForcingIOClock() - waitStart);
+
+	if (fPrefetchErr)
+		Release(&fPrefetchData);
+}
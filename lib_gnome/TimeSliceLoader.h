@@ -0,0 +1,59 @@
+/*
+ *  TimeSliceLoader.h
+ *  gnome
+ *
+ *  Loads the time slices of a mover that reads its own ReadTimeData (the
+ *  ptCur and triCur movers) the way TimeGridVel_c::SetInterval does: through
+ *  the TimeSliceCache, so the forecast and uncertainty movers of a file share
+ *  them, and with the next time of the file read on a background thread once
+ *  an interval is in place. The handles come from the handle pools as any
+ *  other. Reads hold GnomeFileIOMutex().
+ *
+ */
+
+#ifndef __TimeSliceLoader__
+#define __TimeSliceLoader__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "GnomeThreads.h"
+
+// reads time index of the owner's file into velocityH, like ReadTimeData
+typedef OSErr (*TimeSliceReadProc)(void *owner, long index, VelocityFH *velocityH, char *errmsg);
+
+class TimeSliceLoader
+{
+	public:
+						TimeSliceLoader(TimeSliceReadProc readProc, void *owner);
+						~TimeSliceLoader() {Dispose();}
+		// waits for the prefetch and disposes of what it read
+		void			Dispose();
+
+		void			SetPrefetch(Boolean prefetch) {fPrefetchNextTime = prefetch;}
+
+		// reads index into data, or shares it with a mover that already has it.
+		// The slices are keyed by path and variable, what fixes how the file is read
+		OSErr			Load(const char *path, const char *variable, long index, LoadedData *data, char *errmsg);
+		// disposes of data's handle, or releases it if it is shared through the cache
+		void			Release(LoadedData *data);
+
+		// reads index in the background, for a Load that is to come. Nothing if it is cached
+		void			StartPrefetch(const char *path, const char *variable, long index);
+		// waits for the prefetch, before the owner's file or times change
+		void			FinishPrefetch();
+
+	private:
+		TimeSliceReadProc	fReadProc;
+		void				*fOwner;
+
+		Boolean			fPrefetchNextTime;
+		LoadedData		fPrefetchData;
+		OSErr			fPrefetchErr;
+		char			fPrefetchPath[kMaxNameLen];
+		char			fPrefetchVariable[256];
+		GnomeThread		fPrefetchThread;
+
+		static void		Prefetch(void *loader);
+};
+
+#endif
@@ -17,6 +17,18 @@ OSErr TimeValue_c::GetTimeValue(const Seconds& forTime, VelocityRec *value)
 	return 0;
 }
 
+OSErr TimeValue_c::GetTimeValues(const Seconds *times, long n, VelocityRec *values)
+{
+	OSErr err = 0;
+
+	for (long i = 0; i < n; i++) {
+		if ((err = GetTimeValue(times[i], &values[i])) != 0)
+			return err;
+	}
+
+	return 0;
+}
+
 OSErr TimeValue_c::CheckStartTime(Seconds forTime)
 {	
 	return 0;
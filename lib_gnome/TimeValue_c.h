@@ -31,6 +31,8 @@ public:
 	//virtual ClassID GetClassID () { return TYPE_TIMEVALUES; }
 	//virtual Boolean	IAm(ClassID id) { if(id==TYPE_TIMEVALUES) return TRUE; return ClassID_c::IAm(id); }
 	virtual OSErr   GetTimeValue(const Seconds& current_time, VelocityRec *value);
+	// GetTimeValue for each of n times, stops at the first error
+	virtual OSErr   GetTimeValues(const Seconds *times, long n, VelocityRec *values);
 	virtual OSErr	CheckStartTime (Seconds time);
 	virtual void	Dispose () {}
 	virtual OSErr	InitTimeFunc ();
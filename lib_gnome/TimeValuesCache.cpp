@@ -0,0 +1,185 @@
+/*
+ *  TimeValuesCache.cpp
+ *  gnome
+ *
+ *  File layout: a fixed header, then the time values as raw platform
+ *  structs. A file whose size or modification time changed gets a new key,
+ *  so its old cache file is just never read again.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "TimeValuesCache.h"
+#include "TopologyCache.h"
+#include "MemUtils.h"
+#include "SetupStats.h"
+#include "Replacements.h"
+
+using std::string;
+
+#define kTimeValuesCacheMagic	"GNTVAL\r\n"
+#define kTimeValuesCacheVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		headerSize;
+	uint64_t	key;
+	int32_t		sizeofTimeValue;	// the values are platform structs, so this must match to use a file
+	int32_t		unused;
+	int64_t		numValues;
+} TimeValuesCacheHeader;
+
+static string cacheDir;
+
+void SetTimeValuesCacheDir(const char *dir)
+{
+	cacheDir = dir ? dir : "";
+}
+
+const char *GetTimeValuesCacheDir()
+{
+	return cacheDir.c_str();
+}
+
+Boolean TimeValuesCacheIsOn()
+{
+	return !cacheDir.empty();
+}
+
+uint64_t TimeValuesCacheKey(const char *path, uint64_t settingsHash)
+{
+	struct stat info;
+	int64_t size, modified;
+	uint64_t key;
+	DateTimeRec date;
+	Seconds secs;
+
+	if (!path || stat(path, &info) != 0)
+		return 0;
+
+	size = info.st_size;
+	modified = info.st_mtime;
+
+	// the values are in the local time DateToSeconds converts with
+	memset(&date, 0, sizeof(date));
+	date.year = 2000;
+	date.month = 1;
+	date.day = 1;
+	DateToSeconds(&date, &secs);
+
+	key = TopologyCacheHash(path, strlen(path), settingsHash);
+	key = TopologyCacheHash(&size, sizeof(size), key);
+	key = TopologyCacheHash(&modified, sizeof(modified), key);
+	key = TopologyCacheHash(&secs, sizeof(secs), key);
+
+	return key ? key : 1;
+}
+
+static string TimeValuesCachePath(uint64_t key)
+{
+	char name[32];
+	string path = cacheDir;
+
+	sprintf(name, "%016llx.gnometv", (unsigned long long)key);
+	if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+		path += '/';
+	return path + name;
+}
+
+OSErr ReadTimeValuesCache(uint64_t key, TimeValuePairH *timeValues)
+{
+	OSErr err = -1;
+	FILE *fp = 0;
+	TimeValuesCacheHeader header;
+	TimeValuePairH values = 0;
+	long numBytes;
+
+	if (!TimeValuesCacheIsOn() || !key)
+		return -1;
+
+	fp = fopen(TimeValuesCachePath(key).c_str(), "rb");
+	if (!fp)
+		return -1;
+
+	if (fread(&header, sizeof(header), 1, fp) != 1)
+		goto done;
+	if (memcmp(header.magic, kTimeValuesCacheMagic, 8) || header.version != kTimeValuesCacheVersion ||
+		header.headerSize != (int32_t)sizeof(header) || header.key != key)
+		goto done;
+	if (header.sizeofTimeValue != (int32_t)sizeof(TimeValuePair) || header.numValues <= 0)
+		goto done;
+
+	numBytes = header.numValues * sizeof(TimeValuePair);
+	values = (TimeValuePairH)_NewHandle(numBytes);
+	if (!values) {
+		TechError("ReadTimeValuesCache()", "_NewHandle()", 0);
+		err = memFullErr;
+		goto done;
+	}
+	if (fread(*values, 1, numBytes, fp) != (size_t)numBytes)
+		goto done;
+
+	*timeValues = values;
+	values = 0;
+	err = 0;
+	CountSetupCacheHit(kSetupCacheTimeValues);
+
+done:
+	fclose(fp);
+	if (values) DisposeHandle((Handle)values);
+
+	return err;
+}
+
+OSErr WriteTimeValuesCache(uint64_t key, TimeValuePairH timeValues)
+{
+	FILE *fp = 0;
+	TimeValuesCacheHeader header;
+	string path, tempPath;
+	long numBytes;
+	Boolean ok;
+
+	if (!TimeValuesCacheIsOn() || !key || !timeValues)
+		return -1;
+
+	numBytes = _GetHandleSize((Handle)timeValues);
+	numBytes -= numBytes % sizeof(TimeValuePair);
+	if (numBytes <= 0)
+		return -1;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kTimeValuesCacheMagic, 8);
+	header.version = kTimeValuesCacheVersion;
+	header.headerSize = sizeof(header);
+	header.key = key;
+	header.sizeofTimeValue = sizeof(TimeValuePair);
+	header.numValues = numBytes / sizeof(TimeValuePair);
+
+	// write beside the final name and rename, so a reader never sees half a file
+	path = TimeValuesCachePath(key);
+	tempPath = path + ".tmp";
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return -1;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(*timeValues, 1, numBytes, fp) == (size_t)numBytes;
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(path.c_str());	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+	if (!ok) {
+		remove(tempPath.c_str());
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+/*
+ *  TimeValuesCache.h
+ *  gnome
+ *
+ *  On disk cache of the time values read from wind, current and hydrology
+ *  time series files, so repeat runs on long station records skip parsing
+ *  the text. Files are keyed by the data file's path, size and modification
+ *  time and the settings it was read with. Off unless a directory is set.
+ *
+ */
+
+#ifndef __TimeValuesCache__
+#define __TimeValuesCache__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+// directory the cache files go in, empty or NULL turns the cache off
+void DLL_API SetTimeValuesCacheDir(const char *dir);
+DLL_API const char *GetTimeValuesCacheDir();
+Boolean TimeValuesCacheIsOn();
+
+// the key for reading path with the reader's settings (any hashed bytes),
+// 0 if the file can't be looked at
+uint64_t TimeValuesCacheKey(const char *path, uint64_t settingsHash);
+
+// on success the caller owns the new handle, a miss (no file, other key,
+// other platform sizes, truncated file) returns an error and allocates nothing
+OSErr ReadTimeValuesCache(uint64_t key, TimeValuePairH *timeValues);
+
+// the handle is only read, failures are not fatal to the caller
+OSErr WriteTimeValuesCache(uint64_t key, TimeValuePairH timeValues);
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ *  TimingStats.cpp
+ *  gnome
+ *
+ */
+
+#include <string.h>
+
+#include "TimingStats.h"
+
+#ifdef GNOME_TIMING
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *timerNames[kNumTimers] = {"prepare_for_model_step", "get_move", "read_data", "locate", "interpolate"};
+
+void TimingStats::Reset()
+{
+	memset(timers, 0, sizeof(timers));
+	memset(depth, 0, sizeof(depth));
+}
+
+void TimingStats::Add(const TimingStats &other)
+{
+	for (long i = 0; i < kNumTimers; i++) {
+		timers[i].count += other.timers[i].count;
+		timers[i].numLEs += other.timers[i].numLEs;
+		timers[i].nanoseconds += other.timers[i].nanoseconds;
+		timers[i].bytesRead += other.timers[i].bytesRead;
+		for (long j = 0; j < kNumSectionCounters; j++)
+			timers[i].counts[j] += other.timers[i].counts[j];
+	}
+}
+
+const char *GetTimerName(short timer)
+{
+	return timer >= 0 && timer < kNumTimers ? timerNames[timer] : "";
+}
+
+static int64_t TimerNow()
+{
+#ifdef GNOME_TIMING
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+	return 0;
+#endif
+}
+
+#ifdef GNOME_TIMING
+static std::atomic<bool> sTracing(false);
+static std::atomic<int32_t> sNumTraceThreads(0);
+static std::mutex sTraceMutex;
+static std::vector<SectionTraceEvent> sTraceEvents;
+static long sTraceDropped = 0;
+
+static int32_t TraceThread()
+{
+	static thread_local int32_t thread = -1;
+
+	if (thread < 0)
+		thread = sNumTraceThreads++;
+	return thread;
+}
+
+static void TraceSection(short timer, long numLEs, int64_t start, int64_t end)
+{
+	SectionTraceEvent event;
+
+	event.start = start;
+	event.duration = end - start;
+	event.numLEs = numLEs;
+	event.thread = TraceThread();
+	event.timer = timer;
+
+	std::lock_guard<std::mutex> lock(sTraceMutex);
+	if (sTraceEvents.size() < kMaxTraceEvents)
+		sTraceEvents.push_back(event);
+	else
+		sTraceDropped++;
+}
+#endif
+
+bool SetSectionTracing(bool on)
+{
+#ifdef GNOME_TIMING
+	sTracing = on;
+	return on;
+#else
+	return false;
+#endif
+}
+
+bool GetSectionTracing()
+{
+#ifdef GNOME_TIMING
+	return sTracing;
+#else
+	return false;
+#endif
+}
+
+int64_t GetSectionTraceClock()
+{
+	return TimerNow();
+}
+
+long TakeSectionTrace(SectionTraceEvent *events, long maxEvents)
+{
+#ifdef GNOME_TIMING
+	std::lock_guard<std::mutex> lock(sTraceMutex);
+	long n = sTraceEvents.size() < (size_t)maxEvents ? sTraceEvents.size() : maxEvents;
+
+	if (n <= 0)
+		return 0;
+	memcpy(events, &sTraceEvents[0], n * sizeof(SectionTraceEvent));
+	sTraceEvents.erase(sTraceEvents.begin(), sTraceEvents.begin() + n);
+	return n;
+#else
+	return 0;
+#endif
+}
+
+long GetSectionTraceDropped()
+{
+#ifdef GNOME_TIMING
+	std::lock_guard<std::mutex> lock(sTraceMutex);
+	return sTraceDropped;
+#else
+	return 0;
+#endif
+}
+
+/////////// HARDWARE COUNTERS
+
+// opens a counter of the process and the threads it starts for each of the
+// configs, -1 for the ones that can't be, returns whether any could be
+static bool OpenCounters(unsigned type, const unsigned long long *configs, long num, int *fds)
+{
+	bool opened = false;
+
+	for (long i = 0; i < num; i++) {
+		fds[i] = -1;
+#ifdef __linux__
+		struct perf_event_attr attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.type = type;
+		attr.size = sizeof(attr);
+		attr.config = configs[i];
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fds[i] >= 0)
+			opened = true;
+#endif
+	}
+	return opened;
+}
+
+static void CloseCounters(int *fds, long num)
+{
+	for (long i = 0; i < num; i++) {
+#ifdef __linux__
+		if (fds[i] >= 0)
+			close(fds[i]);
+#endif
+		fds[i] = -1;
+	}
+}
+
+static void ReadCounters(const int *fds, long num, int64_t *counts)
+{
+	for (long i = 0; i < num; i++) {
+		counts[i] = -1;
+#ifdef __linux__
+		uint64_t count;
+
+		if (fds[i] >= 0 && read(fds[i], &count, sizeof(count)) == sizeof(count))
+			counts[i] = (int64_t)count;
+#endif
+	}
+}
+
+static const char *sectionCounterNames[kNumSectionCounters] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+static int sectionCounters[kNumSectionCounters] = {-1, -1, -1, -1};
+static bool sectionCountersOpen = false;
+
+bool OpenSectionCounters()
+{
+	CloseSectionCounters();
+#ifdef __linux__
+	const unsigned long long configs[kNumSectionCounters] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+	sectionCountersOpen = OpenCounters(PERF_TYPE_HARDWARE, configs, kNumSectionCounters, sectionCounters);
+#endif
+	return sectionCountersOpen;
+}
+
+void CloseSectionCounters()
+{
+	sectionCountersOpen = false;
+	CloseCounters(sectionCounters, kNumSectionCounters);
+}
+
+bool GetSectionCountersOpen()
+{
+	return sectionCountersOpen;
+}
+
+void ReadSectionCounters(int64_t counts[kNumSectionCounters])
+{
+	ReadCounters(sectionCounters, kNumSectionCounters, counts);
+}
+
+const char *GetSectionCounterName(short counter)
+{
+	return counter >= 0 && counter < kNumSectionCounters ? sectionCounterNames[counter] : "";
+}
+
+/////////// SECTION TIMER
+
+SectionTimer::SectionTimer(TimingStats *stats, short timer, long numLEs)
+{
+	fStats = stats;
+	fTimer = timer;
+	fNumLEs = numLEs;
+	fStart = 0;
+	if (!fStats)
+		return;
+
+	if (fStats->depth[fTimer]++ > 0)
+		return;	// counted by the outer section
+	fStats->timers[fTimer].count++;
+	fStats->timers[fTimer].numLEs += numLEs;
+	if (sectionCountersOpen)
+		ReadSectionCounters(fStartCounts);
+	fStart = TimerNow();
+}
+
+SectionTimer::~SectionTimer()
+{
+	if (!fStats)
+		return;
+
+	if (--fStats->depth[fTimer] == 0) {
+		int64_t end = TimerNow();
+
+		fStats->timers[fTimer].nanoseconds += end - fStart;
+		if (sectionCountersOpen) {
+			int64_t counts[kNumSectionCounters];
+
+			ReadSectionCounters(counts);
+			for (long i = 0; i < kNumSectionCounters; i++)
+				if (counts[i] >= 0 && fStartCounts[i] >= 0)
+					fStats->timers[fTimer].counts[i] += counts[i] - fStartCounts[i];
+		}
+#ifdef GNOME_TIMING
+		if (sTracing)
+			TraceSection(fTimer, fNumLEs, fStart, end);
+#endif
+	}
+}
+
+/////////// TLB COUNTERS
+
+static const char *tlbCounterNames[kNumTLBCounters] = {"dtlb_load_misses", "dtlb_store_misses", "itlb_load_misses"};
+static int tlbCounters[kNumTLBCounters] = {-1, -1, -1};
+
+bool OpenTLBCounters()
+{
+	bool opened = false;
+
+	CloseTLBCounters();
+#ifdef __linux__
+	const unsigned long long configs[kNumTLBCounters] = {
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_WRITE << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_ITLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+
+	opened = OpenCounters(PERF_TYPE_HW_CACHE, configs, kNumTLBCounters, tlbCounters);
+#endif
+	return opened;
+}
+
+void CloseTLBCounters()
+{
+	CloseCounters(tlbCounters, kNumTLBCounters);
+}
+
+void ReadTLBCounters(int64_t counts[kNumTLBCounters])
+{
+	ReadCounters(tlbCounters, kNumTLBCounters, counts);
+}
+
+const char *GetTLBCounterName(short counter)
+{
+	return counter >= 0 && counter < kNumTLBCounters ? tlbCounterNames[counter] : "";
+}
@@ -0,0 +1,123 @@
+/*
+ *  TimingStats.h
+ *  gnome
+ *
+ *  Wall clock time spent in the hot sections of a mover, kept per mover (and
+ *  per time grid for the file reads and interpolation). The timers are only
+ *  compiled in with GNOME_TIMING, otherwise the sections cost nothing and
+ *  the stats stay at zero. Only the thread holding the mover's lock
+ *  (LOCK_MOVER) adds to them.
+ *
+ *  The sections nest: get_move includes any SetInterval it makes, and a
+ *  section entered again inside itself (a subclass calling its base class)
+ *  is counted once.
+ *
+ */
+
+#ifndef __TimingStats__
+#define __TimingStats__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "ExportSymbols.h"
+
+enum { kTimerPrepareStep = 0, kTimerGetMove, kTimerReadData, kTimerLocate, kTimerInterpolate, kNumTimers };
+
+// the hardware counters of the sections, with OpenSectionCounters
+enum { kCounterCycles = 0, kCounterInstructions, kCounterLLCMisses, kCounterBranchMisses, kNumSectionCounters };
+
+typedef struct {
+	int64_t	count;			// times the section ran
+	int64_t	numLEs;			// LEs it did, summed over the runs
+	int64_t	nanoseconds;
+	int64_t	bytesRead;
+	int64_t	counts[kNumSectionCounters];
+} TimerStats;
+
+class DLL_API TimingStats {
+public:
+	TimerStats	timers[kNumTimers];
+	short		depth[kNumTimers];	// open sections of each timer
+
+	TimingStats() { Reset(); }
+	void		Reset();
+	void		Add(const TimingStats &other);
+	TimerStats	GetTimer(short timer) { return timers[timer]; }
+};
+
+DLL_API const char *GetTimerName(short timer);
+
+// With section tracing on, each timed section also leaves an event, for
+// Chrome trace files: its start and duration in nanoseconds on the clock of
+// GetSectionTraceClock(), on a thread numbered in the order the threads
+// first traced. The events wait in a buffer of at most kMaxTraceEvents
+// until they are taken; the ones after that are dropped.
+enum { kMaxTraceEvents = 1000000 };
+
+typedef struct {
+	int64_t	start;
+	int64_t	duration;
+	int64_t	numLEs;
+	int32_t	thread;
+	short	timer;
+} SectionTraceEvent;
+
+// returns false, and stays off, without GNOME_TIMING
+DLL_API bool SetSectionTracing(bool on);
+DLL_API bool GetSectionTracing();
+DLL_API int64_t GetSectionTraceClock();
+// moves up to maxEvents of the buffered events to events, oldest first, and
+// returns how many it moved
+DLL_API long TakeSectionTrace(SectionTraceEvent *events, long maxEvents);
+DLL_API long GetSectionTraceDropped();
+
+// times its scope into stats (which may be 0)
+class SectionTimer {
+public:
+	SectionTimer(TimingStats *stats, short timer, long numLEs = 0);
+	~SectionTimer();
+private:
+	TimingStats	*fStats;
+	short		fTimer;
+	long		fNumLEs;
+	int64_t		fStart;
+	int64_t		fStartCounts[kNumSectionCounters];
+};
+
+// The hardware counters of the process's TLB misses, from Linux's perf
+// events, to tell what huge pages (SetHugePages) save. They count this
+// thread and the threads started after they are opened, so open them
+// before the first parallel loop. Unlike the section timers they don't
+// need GNOME_TIMING. Returns false if none of them can be opened (not
+// Linux, no such counters, or perf_event_paranoid doesn't allow them)
+enum { kCounterDTLBLoadMisses = 0, kCounterDTLBStoreMisses, kCounterITLBLoadMisses, kNumTLBCounters };
+
+DLL_API bool OpenTLBCounters();
+DLL_API void CloseTLBCounters();
+// the counts since they were opened, -1 for the ones that couldn't be
+DLL_API void ReadTLBCounters(int64_t counts[kNumTLBCounters]);
+DLL_API const char *GetTLBCounterName(short counter);
+
+// The cycles, instructions, last level cache misses and branch misses of
+// the process, counted like the TLB misses. While they are open the timed
+// sections also add them up in their TimerStats' counts (only with
+// GNOME_TIMING): they are read at the start and end of a section, so they
+// include the worker threads of its parallel loops, and anything else the
+// process does meanwhile -- count a run without concurrent spill
+// containers. A counter that couldn't be opened stays at 0
+DLL_API bool OpenSectionCounters();
+DLL_API void CloseSectionCounters();
+DLL_API bool GetSectionCountersOpen();
+DLL_API void ReadSectionCounters(int64_t counts[kNumSectionCounters]);
+DLL_API const char *GetSectionCounterName(short counter);
+
+#ifdef GNOME_TIMING
+#define TIME_SECTION(stats, timer, numLEs) SectionTimer sectionTimer##timer(stats, timer, numLEs)
+#define ADD_BYTES_READ(stats, timer, numBytes) ((stats)->timers[timer].bytesRead += (numBytes))
+#else
+#define TIME_SECTION(stats, timer, numLEs)
+#define ADD_BYTES_READ(stats, timer, numBytes)
+#endif
+
+#endif
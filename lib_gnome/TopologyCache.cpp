@@ -0,0 +1,233 @@
+/*
+ *  TopologyCache.cpp
+ *  gnome
+ *
+ *  File layout: a fixed header, then the vertex mapping, points, topology and
+ *  DAG arrays as raw platform structs, each starting on an 8 byte boundary so
+ *  the file can be mapped in place. They are read into handles here because
+ *  the grid classes own and dispose their handles.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "TopologyCache.h"
+#include "MemUtils.h"
+#include "Replacements.h"
+
+using std::string;
+
+#define kTopologyCacheMagic		"GNTOPO\r\n"
+#define kTopologyCacheVersion	1
+
+typedef struct {
+	char		magic[8];
+	int32_t		version;
+	int32_t		headerSize;
+	uint64_t	key;
+	int32_t		sizeofLong;		// the arrays are platform structs, so these must match to use a file
+	int32_t		sizeofLongPoint;
+	int32_t		sizeofTopology;
+	int32_t		sizeofDAG;
+	int64_t		numVerdat;
+	int64_t		numPts;
+	int64_t		numTri;
+	int64_t		numBranches;
+	int64_t		loLat, loLong, hiLat, hiLong;
+} TopologyCacheHeader;
+
+static string cacheDir;
+
+void SetTopologyCacheDir(const char *dir)
+{
+	cacheDir = dir ? dir : "";
+}
+
+const char *GetTopologyCacheDir()
+{
+	return cacheDir.c_str();
+}
+
+Boolean TopologyCacheIsOn()
+{
+	return !cacheDir.empty();
+}
+
+uint64_t TopologyCacheHash(const void *data, long numBytes, uint64_t hash)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+
+	for (long i = 0; i < numBytes; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static string TopologyCachePath(uint64_t key)
+{
+	char name[32];
+	string path = cacheDir;
+
+	sprintf(name, "%016llx.gnometopo", (unsigned long long)key);
+	if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+		path += '/';
+	return path + name;
+}
+
+static long PaddedSize(long numBytes)
+{
+	return (numBytes + 7) & ~7L;
+}
+
+static Boolean ReadSection(FILE *fp, Handle h, long numBytes)
+{
+	static const char zeros[8] = {0};
+	char pad[8];
+	long padBytes = PaddedSize(numBytes) - numBytes;
+
+	if (numBytes > 0 && fread(*h, 1, numBytes, fp) != (size_t)numBytes)
+		return false;
+	return padBytes == 0 || (fread(pad, 1, padBytes, fp) == (size_t)padBytes && !memcmp(pad, zeros, padBytes));
+}
+
+static Boolean WriteSection(FILE *fp, Handle h, long numBytes)
+{
+	static const char zeros[8] = {0};
+	long padBytes = PaddedSize(numBytes) - numBytes;
+
+	if (numBytes > 0 && fwrite(*h, 1, numBytes, fp) != (size_t)numBytes)
+		return false;
+	return padBytes == 0 || fwrite(zeros, 1, padBytes, fp) == (size_t)padBytes;
+}
+
+OSErr ReadTopologyCache(uint64_t key, LONGH *verdatToNetCDFH, LongPointHdl *ptsH,
+						TopologyHdl *topH, DAGTreeStruct *tree, WorldRect *bounds)
+{
+	MemoryTag memoryTag(kMemTopology);
+	OSErr err = -1;
+	FILE *fp = 0;
+	TopologyCacheHeader header;
+	LONGH verdatH = 0;
+	LongPointHdl pts = 0;
+	TopologyHdl topo = 0;
+	DAGHdl treeH = 0;
+
+	if (!TopologyCacheIsOn())
+		return -1;
+
+	fp = fopen(TopologyCachePath(key).c_str(), "rb");
+	if (!fp)
+		return -1;
+
+	if (fread(&header, sizeof(header), 1, fp) != 1)
+		goto done;
+	if (memcmp(header.magic, kTopologyCacheMagic, 8) || header.version != kTopologyCacheVersion ||
+		header.headerSize != (int32_t)sizeof(header) || header.key != key)
+		goto done;
+	if (header.sizeofLong != (int32_t)sizeof(long) || header.sizeofLongPoint != (int32_t)sizeof(LongPoint) ||
+		header.sizeofTopology != (int32_t)sizeof(Topology) || header.sizeofDAG != (int32_t)sizeof(DAG))
+		goto done;
+	if (header.numVerdat <= 0 || header.numPts <= 0 || header.numTri <= 0 || header.numBranches <= 0)
+		goto done;
+
+	verdatH = (LONGH)_NewHandle(header.numVerdat * sizeof(long));
+	pts = (LongPointHdl)_NewHandle(header.numPts * sizeof(LongPoint));
+	topo = (TopologyHdl)_NewHandle(header.numTri * sizeof(Topology));
+	treeH = (DAGHdl)_NewHandle(header.numBranches * sizeof(DAG));
+	if (!verdatH || !pts || !topo || !treeH) {
+		TechError("ReadTopologyCache()", "_NewHandle()", 0);
+		err = memFullErr;
+		goto done;
+	}
+
+	if (!ReadSection(fp, (Handle)verdatH, header.numVerdat * sizeof(long)) ||
+		!ReadSection(fp, (Handle)pts, header.numPts * sizeof(LongPoint)) ||
+		!ReadSection(fp, (Handle)topo, header.numTri * sizeof(Topology)) ||
+		!ReadSection(fp, (Handle)treeH, header.numBranches * sizeof(DAG)))
+		goto done;
+
+	*verdatToNetCDFH = verdatH;
+	*ptsH = pts;
+	*topH = topo;
+	tree->treeHdl = treeH;
+	tree->numBranches = header.numBranches;
+	bounds->loLat = header.loLat;
+	bounds->loLong = header.loLong;
+	bounds->hiLat = header.hiLat;
+	bounds->hiLong = header.hiLong;
+	verdatH = 0;
+	pts = 0;
+	topo = 0;
+	treeH = 0;
+	err = 0;
+
+done:
+	fclose(fp);
+	if (verdatH) DisposeHandle((Handle)verdatH);
+	if (pts) DisposeHandle((Handle)pts);
+	if (topo) DisposeHandle((Handle)topo);
+	if (treeH) DisposeHandle((Handle)treeH);
+
+	return err;
+}
+
+OSErr WriteTopologyCache(uint64_t key, LONGH verdatToNetCDFH, LongPointHdl ptsH,
+						 TopologyHdl topH, DAGHdl treeH, long numBranches, WorldRect bounds)
+{
+	FILE *fp = 0;
+	TopologyCacheHeader header;
+	string path, tempPath;
+	Boolean ok;
+
+	if (!TopologyCacheIsOn() || !verdatToNetCDFH || !ptsH || !topH || !treeH || numBranches <= 0)
+		return -1;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kTopologyCacheMagic, 8);
+	header.version = kTopologyCacheVersion;
+	header.headerSize = sizeof(header);
+	header.key = key;
+	header.sizeofLong = sizeof(long);
+	header.sizeofLongPoint = sizeof(LongPoint);
+	header.sizeofTopology = sizeof(Topology);
+	header.sizeofDAG = sizeof(DAG);
+	header.numVerdat = _GetHandleSize((Handle)verdatToNetCDFH) / sizeof(long);
+	header.numPts = _GetHandleSize((Handle)ptsH) / sizeof(LongPoint);
+	header.numTri = _GetHandleSize((Handle)topH) / sizeof(Topology);
+	header.numBranches = numBranches;
+	header.loLat = bounds.loLat;
+	header.loLong = bounds.loLong;
+	header.hiLat = bounds.hiLat;
+	header.hiLong = bounds.hiLong;
+
+	if (_GetHandleSize((Handle)treeH) < (long)(numBranches * sizeof(DAG)))
+		return -1;
+
+	// write beside the final name and rename, so a reader never sees half a file
+	path = TopologyCachePath(key);
+	tempPath = path + ".tmp";
+	fp = fopen(tempPath.c_str(), "wb");
+	if (!fp)
+		return -1;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		WriteSection(fp, (Handle)verdatToNetCDFH, header.numVerdat * sizeof(long)) &&
+		WriteSection(fp, (Handle)ptsH, header.numPts * sizeof(LongPoint)) &&
+		WriteSection(fp, (Handle)topH, header.numTri * sizeof(Topology)) &&
+		WriteSection(fp, (Handle)treeH, numBranches * sizeof(DAG));
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(path.c_str());	// rename won't replace an existing file on Windows
+		ok = rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+	if (!ok) {
+		remove(tempPath.c_str());
+		return -1;
+	}
+
+	return 0;
+}
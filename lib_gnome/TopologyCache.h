@@ -0,0 +1,40 @@
+/*
+ *  TopologyCache.h
+ *  gnome
+ *
+ *  On disk cache of the triangulation built from a curvilinear grid: the
+ *  vertex mapping, points, topology and DAG tree. Files are keyed by a hash
+ *  of the grid that was triangulated, so repeat runs on the same grid skip
+ *  the reorder and MakeDagTree. Off unless a directory is set.
+ *
+ */
+
+#ifndef __TopologyCache__
+#define __TopologyCache__
+
+#include <stdint.h>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+#include "ExportSymbols.h"
+
+// directory the cache files go in, empty or NULL turns the cache off
+void DLL_API SetTopologyCacheDir(const char *dir);
+DLL_API const char *GetTopologyCacheDir();
+Boolean TopologyCacheIsOn();
+
+// FNV-1a, chain calls to hash several blocks
+#define kTopologyHashSeed 14695981039346656037ULL
+uint64_t TopologyCacheHash(const void *data, long numBytes, uint64_t hash = kTopologyHashSeed);
+
+// on success the caller owns the new handles, a miss (no file, other key,
+// other platform sizes, truncated file) returns an error and allocates nothing
+OSErr ReadTopologyCache(uint64_t key, LONGH *verdatToNetCDFH, LongPointHdl *ptsH,
+						TopologyHdl *topH, DAGTreeStruct *tree, WorldRect *bounds);
+
+// the handles are only read, failures are not fatal to the caller
+OSErr WriteTopologyCache(uint64_t key, LONGH verdatToNetCDFH, LongPointHdl ptsH,
+						 TopologyHdl topH, DAGHdl treeH, long numBranches, WorldRect bounds);
+
+#endif
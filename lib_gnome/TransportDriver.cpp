@@ -0,0 +1,261 @@
+/*
+ *  TransportDriver.cpp
+ *  gnome
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "TransportDriver.h"
+#include "WindMover_c.h"
+
+static inline bool LandPixel(const TransportMap &map, int x, int y)
+{
+	if (map.rowBytes == 0)
+		return map.land[(long)x * map.height + y] == 1;
+
+	return (map.land[(long)x * map.rowBytes + (y >> 3)] >> (7 - (y & 7))) & 1;
+}
+
+static inline bool OffRaster(const TransportMap &map, int x, int y)
+{
+	return x < 0 || x >= map.width || y < 0 || y >= map.height;
+}
+
+bool FindFirstLandPixel(const TransportMap &map, int x0, int y0, int x1, int y1,
+						int *prevX, int *prevY, int *hitX, int *hitY)
+{
+	int dx, dy, sx, sy, err, e2;
+	bool wasOnRaster = false;
+
+	// totally off the raster
+	if ((x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0) ||
+		(x0 >= map.width && x1 >= map.width) || (y0 >= map.height && y1 >= map.height))
+		return false;
+
+	dx = abs(x1 - x0);
+	dy = abs(y1 - y0);
+	sx = x0 < x1 ? 1 : -1;
+	sy = y0 < y1 ? 1 : -1;
+	err = dx - dy;
+
+	if (!OffRaster(map, x0, y0)) {
+		if (LandPixel(map, x0, y0)) {
+			*prevX = *hitX = x0;
+			*prevY = *hitY = y0;
+			return true;
+		}
+		wasOnRaster = true;
+	}
+
+	while (x0 != x1 || y0 != y1) {
+		*prevX = x0;
+		*prevY = y0;
+
+		e2 = 2 * err;
+		if (e2 > -dy) {
+			err -= dy;
+			x0 += sx;
+		}
+		if (e2 < dx) {
+			err += dx;
+			y0 += sy;
+		}
+
+		if (OffRaster(map, x0, y0)) {
+			// off the raster for good once it has crossed it
+			if (wasOnRaster)
+				return false;
+			continue;
+		}
+		wasOnRaster = true;
+
+		if (LandPixel(map, x0, y0)) {
+			*hitX = x0;
+			*hitY = y0;
+			return true;
+		}
+
+		// a diagonal step between two land pixels is a hit too
+		if (e2 > -dy && e2 < dx &&
+			LandPixel(map, x0, y0 - sy) && LandPixel(map, x0 - sx, y0)) {
+			*hitX = x0;
+			*hitY = y0 - sy;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// the crossing test of c_point_in_poly1
+static bool InBounds(const TransportMap &map, double lon, double lat)
+{
+	const double *v = map.boundPts;
+	bool in = false;
+
+	for (long i = 0, j = map.numBoundPts - 1; i < map.numBoundPts; j = i++) {
+		if (((v[2 * i + 1] > lat) != (v[2 * j + 1] > lat)) &&
+			(lon < (v[2 * j] - v[2 * i]) * (lat - v[2 * i + 1]) / (v[2 * j + 1] - v[2 * i + 1]) + v[2 * i]))
+			in = !in;
+	}
+
+	return in;
+}
+
+static inline void ToPixel(const TransportMap &map, double lon, double lat, int *x, int *y)
+{
+	*x = (int)floor((lon - map.transform[0]) * map.transform[2] + map.transform[4]);
+	*y = (int)floor((lat - map.transform[1]) * map.transform[3] + map.transform[5]);
+}
+
+// the center of the pixel, as the projection's to_lonlat
+static inline void ToLonLat(const TransportMap &map, int x, int y, double *lon, double *lat)
+{
+	*lon = (x + .5 - map.transform[4]) / map.transform[2] + map.transform[0];
+	*lat = (y + .5 - map.transform[5]) / map.transform[3] + map.transform[1];
+}
+
+static void RefloatLEs(const TransportMap &map, TransportLEs &les)
+{
+	double u = 0.;
+
+	for (LECount i = 0; i < les.n; i++) {
+		if (les.status[i] != OILSTAT_ONLAND)
+			continue;
+
+		if (map.refloatProbability < 1.)
+			FillCounterRandomUniforms(map.refloatKey, 1, &les.ids[i], kRefloatDraw, &u);
+
+		if (map.refloatProbability >= 1. || u <= map.refloatProbability) {
+			les.lon[i] = les.lastWaterLon[i];
+			les.lat[i] = les.lastWaterLat[i];
+			les.z[i] = les.lastWaterZ[i];
+			les.status[i] = OILSTAT_INWATER;
+		}
+	}
+}
+
+// the map's beach_elements: the LEs no higher than the surface, stopped at the first land
+// they cross, and off the maps once out of its bounds
+static LECount CheckLEs(const TransportMap &map, TransportLEs &les,
+						double *nextLon, double *nextLat, double *nextZ)
+{
+	int x0, y0, x1, y1, prevX, prevY, hitX, hitY;
+	LECount numBeached = 0;
+
+	for (LECount i = 0; i < les.n; i++) {
+		short status = les.status[i];
+
+		if (nextZ[i] < 0.)
+			nextZ[i] = 0.;
+
+		// gone, they wait for the caller to remove them
+		if (status == OILSTAT_OFFMAPS || status == OILSTAT_TO_BE_REMOVED)
+			continue;
+
+		if (map.land && status != OILSTAT_ONLAND) {
+			ToPixel(map, les.lon[i], les.lat[i], &x0, &y0);
+			ToPixel(map, nextLon[i], nextLat[i], &x1, &y1);
+
+			if (FindFirstLandPixel(map, x0, y0, x1, y1, &prevX, &prevY, &hitX, &hitY)) {
+				ToLonLat(map, hitX, hitY, &nextLon[i], &nextLat[i]);
+				ToLonLat(map, prevX, prevY, &les.lastWaterLon[i], &les.lastWaterLat[i]);
+				les.status[i] = OILSTAT_ONLAND;
+				numBeached++;
+			}
+		}
+
+		if (map.numBoundPts > 0 && !InBounds(map, nextLon[i], nextLat[i]))
+			les.status[i] = OILSTAT_OFFMAPS;
+	}
+
+	return numBeached;
+}
+
+OSErr RunTransportSteps(int numMovers, Mover_c **movers, const char *usesWindages,
+						const TransportMap &map, TransportLEs &les,
+						int numSteps, Seconds modelTime, Seconds stepLen,
+						double *trackLon, double *trackLat, double *trackZ, short *trackStatus,
+						int *stepsDone, LECount *numBeached)
+{
+	OSErr err = noErr;
+	LECount n = les.n;
+	std::vector<double> next(3 * (n > 0 ? n : 1));
+	std::vector<double *> windages(numMovers > 0 ? numMovers : 1, (double *)0);
+	std::vector<LECount> active;
+
+	*stepsDone = 0;
+	*numBeached = 0;
+
+	for (int m = 0; m < numMovers; m++) {
+		if (usesWindages && usesWindages[m])
+			windages[m] = les.windages;
+	}
+
+	for (int s = 0; s < numSteps; s++) {
+		Seconds time = modelTime + s * stepLen;
+
+		// the order of Model.step: the windages and the movers are set up for the step, then
+		// the LEs on land may refloat before they move
+		if (les.windages && n > 0) {
+			CounterRandomKey key = les.windageKey;
+
+			key.step = time;
+			UpdateWindages(key, n, les.ids, les.windageRange, les.windagePersist, stepLen,
+						   les.windages, 1);
+		}
+
+		for (int m = 0; m < numMovers; m++) {
+			err = movers[m]->PrepareForModelStep(time, stepLen, false, 0, 0);
+			if (err)
+				return err;
+		}
+
+		if (map.land && map.refloatProbability >= 0.)
+			RefloatLEs(map, les);
+
+		active.clear();
+		for (LECount i = 0; i < n; i++) {
+			next[i] = les.lat[i];
+			next[n + i] = les.lon[i];
+			next[2 * n + i] = les.z[i];
+			if (les.status[i] == OILSTAT_INWATER)
+				active.push_back(i);
+		}
+
+		if (!active.empty() && numMovers > 0) {
+			err = MoveFused(numMovers, movers, &windages[0], n, (LECount)active.size(), &active[0],
+							time, stepLen, les.lat, les.lon, les.z, les.status,
+							&next[0], &next[n], &next[2 * n], FORECAST_LE, 0);
+			if (err)
+				return err;
+		}
+
+		*numBeached += CheckLEs(map, les, &next[n], &next[0], &next[2 * n]);
+
+		for (LECount i = 0; i < n; i++) {
+			les.lat[i] = next[i];
+			les.lon[i] = next[n + i];
+			les.z[i] = next[2 * n + i];
+		}
+
+		for (int m = 0; m < numMovers; m++)
+			movers[m]->ModelStepIsDone();
+
+		if (trackLon && trackLat && trackZ && trackStatus) {
+			for (LECount i = 0; i < n; i++) {
+				trackLon[(long)s * n + i] = les.lon[i];
+				trackLat[(long)s * n + i] = les.lat[i];
+				trackZ[(long)s * n + i] = les.z[i];
+				trackStatus[(long)s * n + i] = les.status[i];
+			}
+		}
+
+		*stepsDone = s + 1;
+	}
+
+	return noErr;
+}
@@ -0,0 +1,76 @@
+/*
+ *  TransportDriver.h
+ *  gnome
+ *
+ *  Runs many time steps of a transport-only model in C++: for the forecast
+ *  LEs of a model with no weathering whose movers are all C++ movers, one
+ *  call does what pyGNOME's Model.step does each step -- the refloat, the
+ *  windages, the movers' PrepareForModelStep, the fused move, the land and
+ *  map checks and the movers' ModelStepIsDone -- so Python only comes back
+ *  for the steps with output or releases.
+ *
+ */
+
+#ifndef __TransportDriver__
+#define __TransportDriver__
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+#include "CounterRandom.h"
+#include "Mover_c.h"
+
+// the land and the bounds of the map the LEs move on
+typedef struct {
+	// the finest raster of a raster map, land pixels 1: pixel (x, y) is land[x * height + y],
+	// or bit 7 - y % 8 of land[x * rowBytes + y / 8] for a packed one. 0 for a map with no land
+	const unsigned char	*land;
+	long				width, height;
+	long				rowBytes;			// 0 for a raster of a byte a pixel
+	double				transform[6];		// (center, scale, offset) of lon, lat to pixels
+	// the polygon of the map bounds, the LEs that leave it are off the maps. 0 points for none
+	long				numBoundPts;
+	const double		*boundPts;			// (lon, lat) pairs
+	// the LEs on land refloat with this probability each step -- with the counter based draw
+	// of the LE's ID and refloatKey, as the map's refloat -- never with a negative one
+	double				refloatProbability;
+	CounterRandomKey	refloatKey;
+} TransportMap;
+
+// the forecast LEs, moved in place
+typedef struct {
+	LECount				n;
+	double				*lon, *lat, *z;
+	short				*status;
+	double				*lastWaterLon, *lastWaterLat, *lastWaterZ;
+	const uint32_t		*ids;
+	// drawn again each step, keyed on the model time, when the model has wind movers.
+	// 0 if it has none
+	double				*windages;
+	const double		*windageRange;
+	const long			*windagePersist;
+	CounterRandomKey	windageKey;
+} TransportLEs;
+
+// the draw of an LE's refloat, as cy_land_check.refloat_batch's
+#define kRefloatDraw 1
+
+// moves the LEs numSteps steps of stepLen from modelTime with the movers, in order, the
+// windages of mover m being les.windages if usesWindages[m] (usesWindages may be 0). The LEs
+// that leave the map are off the maps, and neither moved nor checked again: the caller
+// removes them. When the track arrays aren't 0, the positions and statuses at the end of
+// step s are at [s * n]. stepsDone is the number of steps done, numBeached the LEs that
+// beached in them. Returns the error of the PrepareForModelStep that failed, if one did --
+// its step was not done
+DLL_API OSErr RunTransportSteps(int numMovers, Mover_c **movers, const char *usesWindages,
+								const TransportMap &map, TransportLEs &les,
+								int numSteps, Seconds modelTime, Seconds stepLen,
+								double *trackLon, double *trackLat, double *trackZ, short *trackStatus,
+								int *stepsDone, LECount *numBeached);
+
+// the first land pixel on the line from (x0, y0) to (x1, y1) on the map's raster, and the
+// pixel before it: the walk of cy_land_check.find_first_pixel
+DLL_API bool FindFirstLandPixel(const TransportMap &map, int x0, int y0, int x1, int y1,
+								int *prevX, int *prevY, int *hitX, int *hitY);
+
+#endif
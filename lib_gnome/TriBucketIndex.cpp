@@ -0,0 +1,137 @@
+/*
+ *  TriBucketIndex.cpp
+ *  gnome
+ *
+ *  Built once, then only read, so lookups can run from several threads.
+ *
+ */
+
+#include <math.h>
+
+#include "TriBucketIndex.h"
+#include "DagTreeIO.h"
+#include "MemUtils.h"
+
+using std::vector;
+
+TriBucketIndex::TriBucketIndex()
+{
+	fTopH = 0;
+	fPtsH = 0;
+	fLeft = fBottom = 0;
+	fBucketWidth = fBucketHeight = 1;
+	fNumRows = fNumCols = 0;
+}
+
+void TriBucketIndex::Dispose()
+{
+	fTopH = 0;
+	fPtsH = 0;
+	fNumRows = fNumCols = 0;
+	fBucketStart.clear();
+	fBucketTris.clear();
+}
+
+void TriBucketIndex::GetBucket(long h, long v, long *col, long *row)
+{
+	long c = (long)((h - fLeft) / fBucketWidth);
+	long r = (long)((v - fBottom) / fBucketHeight);
+
+	*col = c < 0 ? 0 : (c >= fNumCols ? fNumCols - 1 : c);
+	*row = r < 0 ? 0 : (r >= fNumRows ? fNumRows - 1 : r);
+}
+
+OSErr TriBucketIndex::Build(TopologyHdl topH, LongPointHdl ptsH, long trisPerBucket)
+{
+	long numTri, numPts, i, t, r, c;
+	long right, top, minCol, maxCol, minRow, maxRow;
+	double numBuckets, aspect;
+	vector<long> fill;
+
+	Dispose();
+
+	if (!topH || !ptsH)
+		return -1;
+
+	numTri = _GetHandleSize((Handle)topH)/sizeof(Topology);
+	numPts = _GetHandleSize((Handle)ptsH)/sizeof(LongPoint);
+	if (numTri <= 0 || numPts <= 0)
+		return -1;
+
+	fLeft = right = (*ptsH)[0].h;
+	fBottom = top = (*ptsH)[0].v;
+	for (i = 1; i < numPts; i++) {
+		fLeft = _min(fLeft, (*ptsH)[i].h);
+		right = _max(right, (*ptsH)[i].h);
+		fBottom = _min(fBottom, (*ptsH)[i].v);
+		top = _max(top, (*ptsH)[i].v);
+	}
+
+	// about trisPerBucket triangles per bucket, with roughly square buckets
+	if (trisPerBucket < 1) trisPerBucket = 1;
+	numBuckets = (double)numTri / trisPerBucket;
+	aspect = (right > fLeft && top > fBottom) ? (double)(right - fLeft) / (top - fBottom) : 1.;
+	fNumCols = (long)ceil(sqrt(numBuckets * aspect));
+	fNumCols = _max(1, fNumCols);
+	fNumRows = (long)ceil(numBuckets / fNumCols);
+	fNumRows = _max(1, fNumRows);
+	fBucketWidth = _max(1., (double)(right - fLeft) / fNumCols + 1e-9);
+	fBucketHeight = _max(1., (double)(top - fBottom) / fNumRows + 1e-9);
+
+	// count, then fill, each triangle going in every bucket its bounding box touches
+	fBucketStart.assign(fNumRows * fNumCols + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			for (i = 0; i < fNumRows * fNumCols; i++)
+				fBucketStart[i + 1] += fBucketStart[i];
+			fBucketTris.resize(fBucketStart[fNumRows * fNumCols]);
+			fill.assign(fBucketStart.begin(), fBucketStart.end() - 1);
+		}
+		for (t = 0; t < numTri; t++) {
+			LongPoint p1 = (*ptsH)[(*topH)[t].vertex1];
+			LongPoint p2 = (*ptsH)[(*topH)[t].vertex2];
+			LongPoint p3 = (*ptsH)[(*topH)[t].vertex3];
+
+			GetBucket(_min(p1.h, _min(p2.h, p3.h)), _min(p1.v, _min(p2.v, p3.v)), &minCol, &minRow);
+			GetBucket(_max(p1.h, _max(p2.h, p3.h)), _max(p1.v, _max(p2.v, p3.v)), &maxCol, &maxRow);
+			for (r = minRow; r <= maxRow; r++) {
+				for (c = minCol; c <= maxCol; c++) {
+					if (pass == 0)
+						fBucketStart[r * fNumCols + c + 1]++;
+					else
+						fBucketTris[fill[r * fNumCols + c]++] = t;
+				}
+			}
+		}
+	}
+
+	fTopH = topH;
+	fPtsH = ptsH;
+
+	return 0;
+}
+
+long TriBucketIndex::WhatTriAmIIn(LongPoint pt)
+{
+	long col, row, b, i, t;
+
+	if (!fTopH || !fPtsH || fNumRows <= 0)
+		return -1;
+
+	if (pt.h < fLeft || pt.v < fBottom || pt.h > fLeft + fBucketWidth * fNumCols || pt.v > fBottom + fBucketHeight * fNumRows)
+		return -1;
+
+	GetBucket(pt.h, pt.v, &col, &row);
+	b = row * fNumCols + col;
+
+	for (i = fBucketStart[b]; i < fBucketStart[b + 1]; i++) {
+		t = fBucketTris[i];
+		// triangles are counterclockwise, inside is to the left of every edge
+		if (Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex1, (*fTopH)[t].vertex2, pt) == -1 &&
+			Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex2, (*fTopH)[t].vertex3, pt) == -1 &&
+			Right_or_Left_of_Segment(fPtsH, (*fTopH)[t].vertex3, (*fTopH)[t].vertex1, pt) == -1)
+			return t;
+	}
+
+	return -1;
+}
@@ -0,0 +1,48 @@
+/*
+ *  TriBucketIndex.h
+ *  gnome
+ *
+ *  Uniform grid of buckets over the triangle grid's LongPoint bounds, each
+ *  bucket lists the triangles whose bounding box touches it. An alternative
+ *  to descending the DAG for large unstructured grids.
+ *
+ */
+
+#ifndef __TriBucketIndex__
+#define __TriBucketIndex__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+
+class TriBucketIndex
+{
+	public:
+						TriBucketIndex();
+						~TriBucketIndex() {Dispose();}
+		void			Dispose();
+
+		// the handles are not copied, they must outlive the index
+		OSErr			Build(TopologyHdl topH, LongPointHdl ptsH, long trisPerBucket = 2);
+
+		// triangle pt is strictly inside, or -1 if none of the candidates has it
+		// (outside the grid, on an edge or vertex), the caller then uses the DAG
+		long			WhatTriAmIIn(LongPoint pt);
+
+		long			GetNumBuckets() {return fNumRows * fNumCols;}
+
+	private:
+		TopologyHdl			fTopH;
+		LongPointHdl		fPtsH;
+		long				fLeft, fBottom;
+		double				fBucketWidth, fBucketHeight;
+		long				fNumRows, fNumCols;
+		std::vector<long>	fBucketStart;	// bucket b's triangles are fBucketTris[fBucketStart[b], fBucketStart[b+1])
+		std::vector<long>	fBucketTris;
+
+		void			GetBucket(long h, long v, long *col, long *row);
+};
+
+#endif
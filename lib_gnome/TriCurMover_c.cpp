@@ -9,6 +9,10 @@
 
 #include "TriCurMover_c.h"
 #include "MemUtils.h"
+#include "TimeSliceCache.h"
+#include "TimeSliceLoader.h"
+#include "TimeInterval.h"
+#include <typeinfo>
 #include "CompFunctions.h"
 #include "StringFunctions.h"
 
@@ -48,6 +52,7 @@ TriCurMover_c::TriCurMover_c (TMap *owner, char *name) : CurrentMover_c(owner, n
 	fIsOptimizedForStep = false;
 	//fOverLap = false;		// for multiple files case
 	//fOverLapStartTime = 0;
+	fTimeIntervalCursor = 0;
 	
 	memset(&fInputValues,0,sizeof(fInputValues));
 	
@@ -61,6 +66,7 @@ TriCurMover_c::TriCurMover_c (TMap *owner, char *name) : CurrentMover_c(owner, n
 	fDepthsH = 0;
 	fDepthDataInfo = 0;
 	//fInputFilesHdl = 0;	// for multiple files case
+	fSliceLoader = 0;
 	
 	bShowDepthContourLabels = false;
 	bShowDepthContours = false;
@@ -70,7 +76,7 @@ TriCurMover_c::TriCurMover_c (TMap *owner, char *name) : CurrentMover_c(owner, n
 	SetClassName (name); // short file name
 	
 }
-OSErr TriCurMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
+OSErr TriCurMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *velocity,double timeStep,Boolean useEddyUncertainty)
 {
 	LEUncertainRec unrec;
 	double u,v,lengthS,alpha,beta,v0;
@@ -127,7 +133,7 @@ OSErr TriCurMover_c::PrepareForModelRun()
 	return CurrentMover_c::PrepareForModelRun();
 }
 
-OSErr TriCurMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr TriCurMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
 	long timeDataInterval;
 	OSErr err=0;
@@ -219,7 +225,7 @@ long TriCurMover_c::WhatTriAmIIn(WorldPoint wp)
 	return dagTree -> WhatTriAmIIn(lp);
 }
 
-WorldPoint3D TriCurMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+WorldPoint3D TriCurMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	// figure out which depth values the LE falls between
 	// since velocities are at centers no need to interpolate, use value over whole triangle
@@ -932,7 +938,10 @@ OSErr TriCurMover_c::SetInterval(char *errmsg, const Seconds& model_time)
 	strcpy(errmsg,"");
 	
 	if(intervalLoaded) 
+	{
+		StartPrefetch();
 		return 0;
+	}
 	
 	// check for constant current 
 	//if(numTimesInFile==1 && !(GetNumFiles()>1))	//or if(timeDataInterval==-1) 
@@ -977,16 +986,14 @@ OSErr TriCurMover_c::SetInterval(char *errmsg, const Seconds& model_time)
 		
 		if(fStartData.dataHdl == 0 && indexOfStart >= 0) 
 		{ // start data is not loaded
-			err = this -> ReadTimeData(indexOfStart,&fStartData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfStart,&fStartData,errmsg);
 			if(err) goto done;
-			fStartData.timeIndex = indexOfStart;
 		}	
 		
 		if(indexOfEnd < numTimesInFile && indexOfEnd != UNASSIGNEDINDEX)  // not past the last interval and not constant current
 		{
-			err = this -> ReadTimeData(indexOfEnd,&fEndData.dataHdl,errmsg);
+			err = this -> LoadTimeData(indexOfEnd,&fEndData,errmsg);
 			if(err) goto done;
-			fEndData.timeIndex = indexOfEnd;
 		}
 	}
 	
@@ -997,15 +1004,63 @@ done:
 		DisposeLoadedData(&fStartData);
 		DisposeLoadedData(&fEndData);
 	}
+	else
+		StartPrefetch();
 	return err;
 	
 }
 
+static OSErr ReadTriCurTimeData(void *mover, long index, VelocityFH *velocityH, char *errmsg)
+{
+	return ((TriCurMover_c *)mover) -> ReadTimeData(index, velocityH, errmsg);
+}
+
+// movers of the same class, triangles and depths read a file the same way
+void TriCurMover_c::GetTimeSliceVariable(char *variable)
+{
+	long numTris = fDepthDataInfo ? _GetHandleSize((Handle)fDepthDataInfo)/sizeof(**fDepthDataInfo) : 0;
+	long totalNumberOfVels = numTris ? (*fDepthDataInfo)[numTris-1].indexToDepthData+(*fDepthDataInfo)[numTris-1].numDepths : 0;
+	
+	sprintf(variable, "%s %ld %ld", typeid(*this).name(), numTris, totalNumberOfVels);
+}
+
+// read a time into data, or share it with another mover that already has it
+OSErr TriCurMover_c::LoadTimeData(long index, LoadedData *data, char *errmsg)
+{
+	char variable[256];
+	
+	if (!fSliceLoader) fSliceLoader = new TimeSliceLoader(ReadTriCurTimeData, this);
+	if (!fSliceLoader)
+	{
+		OSErr err = this -> ReadTimeData(index,&data->dataHdl,errmsg);
+		if (!err) data->timeIndex = index;
+		return err;
+	}
+	
+	GetTimeSliceVariable(variable);
+	return fSliceLoader -> Load(fVar.pathName, variable, index, data, errmsg);
+}
+
+// read the time after the loaded interval in the background, so the
+// SetInterval that crosses into it doesn't wait on the file
+void TriCurMover_c::StartPrefetch()
+{
+	char variable[256];
+	long nextIndex = fEndData.timeIndex + 1;
+	
+	// constant current, or past the last time
+	if (!fSliceLoader || fEndData.timeIndex == UNASSIGNEDINDEX || nextIndex >= GetNumTimesInFile())
+		return;
+	
+	GetTimeSliceVariable(variable);
+	fSliceLoader -> StartPrefetch(fVar.pathName, variable, nextIndex);
+}
+
 Boolean TriCurMover_c::CheckInterval(long &timeDataInterval, const Seconds& model_time)
 {
 	Seconds time = model_time; // AH 07/17/2012
 	
-	long i,numTimes;
+	long numTimes;
 	
 	
 	numTimes = this -> GetNumTimesInFile(); 
@@ -1036,14 +1091,9 @@ Boolean TriCurMover_c::CheckInterval(long &timeDataInterval, const Seconds& mode
 	 else fOverLap = false;
 	 }*/
 	
-	for (i=0;i<numTimes;i++) 
-	{	// find the time interval
-		if (time>=(*fTimeDataHdl)[i].time && time<=(*fTimeDataHdl)[i+1].time)
-		{
-			timeDataInterval = i+1; // first interval is between 0 and 1, and so on
-			return false;
-		}
-	}	
+	// find the time interval, the first is between 0 and 1, and so on
+	if (FindTimeInterval(PtCurTimes(fTimeDataHdl), numTimes, time, &fTimeIntervalCursor, timeDataInterval))
+		return false;
 	// don't allow time before first or after last
 	if (time<(*fTimeDataHdl)[0].time) 
 		timeDataInterval = 0;
@@ -1064,7 +1114,8 @@ long TriCurMover_c::GetNumTimesInFile()
 
 void TriCurMover_c::DisposeLoadedData(LoadedData *dataPtr)
 {
-	if(dataPtr -> dataHdl) DisposeHandle((Handle) dataPtr -> dataHdl);
+	// slices shared through the cache are released, not disposed
+	if(dataPtr -> dataHdl && !ReleaseTimeSlice(dataPtr -> dataHdl)) DisposeHandle((Handle) dataPtr -> dataHdl);
 	ClearLoadedData(dataPtr);
 }
 
@@ -25,6 +25,8 @@
 #define TMap Map_c
 #endif
 
+class TimeSliceLoader;
+
 Boolean IsTriCurFile (char *path);
 Boolean IsTriCurVerticesHeaderLine(const char *s, long* numPts);
 
@@ -57,8 +59,10 @@ public:
 	FLOATH fDepthsH;	
 	DepthDataInfoH fDepthDataInfo;	// triangle info?
 	Boolean fIsOptimizedForStep;
+	TimeSliceLoader	*fSliceLoader;	// SetInterval's reads, cached and the next time prefetched
 	//Boolean fOverLap;
 	//Seconds fOverLapStartTime;
+	long fTimeIntervalCursor;	// the interval CheckInterval found last
 	//PtCurFileInfoH	fInputFilesHdl;
 	Rect fLegendRect;
 	Boolean bShowDepthContours;
@@ -71,7 +75,7 @@ public:
 	//virtual Boolean		IAm(ClassID id) { if(id==TYPE_TRICURMOVER) return TRUE; return TCurrentMover::IAm(id); }
 	virtual Boolean		IAmA3DMover(){return true;}
 
-	virtual OSErr		AddUncertainty(long setIndex, long leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVelocity,double timeStep,Boolean useEddyUncertainty);
 	VelocityRec			GetPatValue (WorldPoint p);
 	VelocityRec 		GetScaledPatValue(const Seconds& model_time, WorldPoint p,Boolean * useEddyUncertainty);//JLM 5/12/99
 	virtual Boolean 	VelocityStrAtPoint(WorldPoint3D wp, char *diagnosticStr);
@@ -84,9 +88,9 @@ public:
 	long			 		WhatTriAmIIn(WorldPoint p);
 	OSErr 				GetTriangleCentroid(long trinum, LongPoint *p);
 	void 					GetDepthIndices(long ptIndex, float depthAtPoint, long *depthIndex1, long *depthIndex2);
-	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *thisLE,LETYPE leType);
+	virtual WorldPoint3D       GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *thisLE,LETYPE leType);
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void 		ModelStepIsDone();
 	OSErr				CalculateVerticalGrid(LongPointHdl ptsH, FLOATH totalDepthH, TopologyHdl topH, long numTri,FLOATH sigmaLevels, long numSigmaLevels);
 	long				CreateDepthSlice(long triNum, float **depthSlice);
@@ -95,6 +99,9 @@ public:
 	virtual Boolean 	CheckInterval(long &timeDataInterval, const Seconds& model_time);	// AH 07/17/2012
 	virtual OSErr	 	SetInterval(char *errmsg, const Seconds& model_time);	// AH 07/17/2012
 	OSErr 				ReadTimeData(long index,VelocityFH *velocityH, char* errmsg); 
+	OSErr 				LoadTimeData(long index,LoadedData *data, char* errmsg); 
+	void 				StartPrefetch();
+	void 				GetTimeSliceVariable(char *variable);
 	long 				GetNumTimesInFile();
 	
 };
@@ -0,0 +1,87 @@
+/*
+ *  TriDepthTables.cpp
+ *  gnome
+ *
+ */
+
+#include <math.h>
+
+#include "TriDepthTables.h"
+#include "MemUtils.h"
+
+TriDepthTables::TriDepthTables()
+{
+	fBuilt = false;
+	fDepthDataInfo = 0;
+	fDepthsH = 0;
+	fTopH = 0;
+	fNodeMap = 0;
+}
+
+void TriDepthTables::Dispose()
+{
+	fLevelsAscending.clear();
+	fMaxBottom.clear();
+
+	fBuilt = false;
+	fDepthDataInfo = 0;
+	fDepthsH = 0;
+	fTopH = 0;
+	fNodeMap = 0;
+}
+
+OSErr TriDepthTables::Build(DepthDataInfoH depthDataInfo, FLOATH depthsH, TopologyHdl topH, LONGH nodeMap)
+{
+	long numNodes, numDepths = 0, numTris, numMapped = 0, i, j;
+
+	Dispose();
+
+	if (!depthDataInfo)
+		return -1;
+
+	numNodes = _GetHandleSize((Handle)depthDataInfo)/sizeof(**depthDataInfo);
+	if (depthsH) numDepths = _GetHandleSize((Handle)depthsH)/sizeof(**depthsH);
+	if (nodeMap) numMapped = _GetHandleSize((Handle)nodeMap)/sizeof(**nodeMap);
+
+	fLevelsAscending.assign(numNodes, 0);
+	for (i = 0; i < numNodes; i++)
+	{
+		long first = (*depthDataInfo)[i].indexToDepthData, n = (*depthDataInfo)[i].numDepths;
+		Boolean ascending = n > 1 && first >= 0 && first + n <= numDepths;
+
+		for (j = 0; ascending && j < n-1; j++)
+			if (!((*depthsH)[first+j] <= (*depthsH)[first+j+1])) ascending = false;
+		fLevelsAscending[i] = ascending;
+	}
+
+	numTris = topH ? _GetHandleSize((Handle)topH)/sizeof(**topH) : 0;
+	fMaxBottom.resize(numTris);
+	for (i = 0; i < numTris; i++)
+	{
+		long vertex[3] = {(*topH)[i].vertex1, (*topH)[i].vertex2, (*topH)[i].vertex3};
+		float maxBottom = -HUGE_VAL;
+
+		for (j = 0; j < 3; j++)
+		{
+			long node = vertex[j];
+
+			if (nodeMap) node = node >= 0 && node < numMapped ? (*nodeMap)[node] : -1;
+			if (node < 0 || node >= numNodes)
+			{	// never below the bottom
+				maxBottom = HUGE_VAL;
+				break;
+			}
+			if ((*depthDataInfo)[node].totalDepth > maxBottom)
+				maxBottom = (*depthDataInfo)[node].totalDepth;
+		}
+		fMaxBottom[i] = maxBottom;
+	}
+
+	fBuilt = true;
+	fDepthDataInfo = depthDataInfo;
+	fDepthsH = depthsH;
+	fTopH = topH;
+	fNodeMap = nodeMap;
+
+	return noErr;
+}
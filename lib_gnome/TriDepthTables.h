@@ -0,0 +1,56 @@
+/*
+ *  TriDepthTables.h
+ *  gnome
+ *
+ *  What the 3D lookups on a triangle grid need of its depth data, worked
+ *  out once instead of per LE: whether each node's levels deepen, so its
+ *  level pair can be bisected, and the deepest bottom of each triangle's
+ *  nodes, so an LE below it gets no velocity without the per node search.
+ *
+ */
+
+#ifndef __TriDepthTables__
+#define __TriDepthTables__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "DagTree.h"
+
+class TriDepthTables
+{
+	public:
+						TriDepthTables();
+						~TriDepthTables() {Dispose();}
+		void			Dispose();
+
+		// the depth data of node i of a triangle of topH is that of
+		// nodeMap[i], or of i without a map. No handle is kept, topH may
+		// be 0 for the node table alone
+		OSErr			Build(DepthDataInfoH depthDataInfo, FLOATH depthsH, TopologyHdl topH, LONGH nodeMap);
+		// built from these handles, the node table needs only the first two
+		Boolean			IsForNodes(DepthDataInfoH depthDataInfo, FLOATH depthsH) const
+							{return fBuilt && depthDataInfo == fDepthDataInfo && depthsH == fDepthsH;}
+		Boolean			IsFor(DepthDataInfoH depthDataInfo, FLOATH depthsH, TopologyHdl topH, LONGH nodeMap) const
+							{return IsForNodes(depthDataInfo, depthsH) && topH == fTopH && nodeMap == fNodeMap;}
+
+		// more than one level for the node and they never get shallower
+		Boolean			LevelsAscending(long node) const
+							{return node >= 0 && node < (long)fLevelsAscending.size() && fLevelsAscending[node];}
+		// depth is below the bottom at every node of the triangle
+		Boolean			BelowBottom(long triNum, float depth) const
+							{return triNum >= 0 && triNum < (long)fMaxBottom.size() && depth > fMaxBottom[triNum];}
+
+	private:
+		std::vector<char>	fLevelsAscending;	// by node
+		std::vector<float>	fMaxBottom;			// by triangle, HUGE_VAL where a node has no data
+
+		Boolean				fBuilt;
+		DepthDataInfoH		fDepthDataInfo;
+		FLOATH				fDepthsH;
+		TopologyHdl			fTopH;
+		LONGH				fNodeMap;
+};
+
+#endif
@@ -147,7 +147,23 @@ InterpolationValBilinear TriGridVel_c::GetBilinearInterpolationValues(WorldPoint
 {
 	InterpolationValBilinear interpolationVal;
 	LongPoint lp;
-	long ntri, adj_tri;
+	long ntri;
+	
+	memset(&interpolationVal,0,sizeof(interpolationVal));
+	
+	if(!fDagTree) return interpolationVal;
+	lp.h = refPoint.pLong;
+	lp.v = refPoint.pLat;
+	ntri = fDagTree->WhatTriAmIIn(lp);
+	return GetBilinearInterpolationValues(refPoint, ntri);
+}
+
+// the interpolation in the rectangle of triangle ntri (and its neighbor), wherever it was found
+InterpolationValBilinear TriGridVel_c::GetBilinearInterpolationValues(WorldPoint refPoint, long ntri)
+{
+	InterpolationValBilinear interpolationVal;
+	LongPoint lp;
+	long adj_tri;
 	long ptIndex1,ptIndex2,ptIndex3,ptIndex4;
 	ExPoint vertex1,vertex2,vertex3,vertex4;
 	double largest_lat, smallest_lat, largest_lon, smallest_lon;
@@ -163,7 +179,6 @@ InterpolationValBilinear TriGridVel_c::GetBilinearInterpolationValues(WorldPoint
 	// get four corners (or just diagonals - x1,y1, x2,y2)
 	lp.h = refPoint.pLong;
 	lp.v = refPoint.pLat;
-	ntri = fDagTree->WhatTriAmIIn(lp);
 	if (ntri < 0) 
 	{
 		interpolationVal.ptIndex1 = ntri; // flag it
@@ -284,6 +299,11 @@ InterpolationValBilinear TriGridVel_c::GetBilinearInterpolationValues(WorldPoint
 }
 
 InterpolationVal TriGridVel_c::GetInterpolationValues(WorldPoint refPoint)
+{
+	return GetInterpolationValues(refPoint, 0);
+}
+
+InterpolationVal TriGridVel_c::GetInterpolationValues(WorldPoint refPoint, long *triHint)
 {
 	InterpolationVal interpolationVal;
 	LongPoint lp;
@@ -301,7 +321,7 @@ InterpolationVal TriGridVel_c::GetInterpolationValues(WorldPoint refPoint)
 	
 	lp.h = refPoint.pLong;
 	lp.v = refPoint.pLat;
-	ntri = fDagTree->WhatTriAmIIn(lp);
+	ntri = fDagTree->WhatTriAmIIn(lp,triHint);
 	if (ntri < 0) 
 	{
 		interpolationVal.ptIndex1 = ntri; // flag it
@@ -347,6 +367,48 @@ InterpolationVal TriGridVel_c::GetInterpolationValues(WorldPoint refPoint)
 	return interpolationVal;
 }
 
+// the smallest altitude of p's triangle -- the shortest way across it, so a
+// move of that length can leave the triangle whichever way it goes
+double TriGridVel_c::GetCellSize(WorldPoint p, long *triHint)
+{
+	LongPoint lp;
+	long ntri;
+	double x[3], y[3], area2, edge, longestEdge = 0;
+
+	TopologyHdl topH;
+	LongPointHdl ptsH;
+
+	if(!fDagTree) return 0;
+
+	lp.h = p.pLong;
+	lp.v = p.pLat;
+	ntri = triHint ? fDagTree->WhatTriAmIIn(lp,triHint) : fDagTree->WhatTriAmIIn(lp);
+	if (ntri < 0) return 0;
+
+	topH = fDagTree->GetTopologyHdl();
+	ptsH = fDagTree->GetPointsHdl();
+	if(!topH || !ptsH) return 0;
+
+	long vertices[3] = {(*topH)[ntri].vertex1, (*topH)[ntri].vertex2, (*topH)[ntri].vertex3};
+
+	// in meters, on the plane the movers move LEs in
+	for (int i = 0; i < 3; i++)
+	{
+		x[i] = ((*ptsH)[vertices[i]].h - p.pLong) / 1000000. * METERSPERDEGREELAT * LongToLatRatio3(p.pLat);
+		y[i] = ((*ptsH)[vertices[i]].v - p.pLat) / 1000000. * METERSPERDEGREELAT;
+	}
+
+	area2 = fabs((x[1]-x[0])*(y[2]-y[0]) - (x[2]-x[0])*(y[1]-y[0]));
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		edge = sqrt((x[j]-x[i])*(x[j]-x[i]) + (y[j]-y[i])*(y[j]-y[i]));
+		if (edge > longestEdge) longestEdge = edge;
+	}
+
+	return longestEdge > 0 ? area2 / longestEdge : 0;
+}
+
 InterpolationVal TriGridVel_c::GetInterpolationValuesFromIndex(long triNum)
 {
 	InterpolationVal interpolationVal;
@@ -661,6 +723,11 @@ VelocityRec TriGridVel_c::GetSmoothVelocity(WorldPoint p)
 }
 
 VelocityRec TriGridVel_c::GetPatValue(WorldPoint p)
+{
+	return GetPatValue(p, 0);
+}
+
+VelocityRec TriGridVel_c::GetPatValue(WorldPoint p, long *triHint)
 {
 	VelocityRec r;
 	LongPoint lp;
@@ -668,19 +735,24 @@ VelocityRec TriGridVel_c::GetPatValue(WorldPoint p)
 	lp.h = p.pLong;
 	lp.v = p.pLat;
 
-	fDagTree->GetVelocity(lp,&r);
+	fDagTree->GetVelocity(lp,&r,triHint);
 
 	return r;
 }
 
 double TriGridVel_c::GetDepthAtPoint(WorldPoint p)
+{
+	return GetDepthAtPoint(p, 0);
+}
+
+double TriGridVel_c::GetDepthAtPoint(WorldPoint p, long *triHint)
 {
 	double depthAtPoint = 0;
 	long ptIndex1,ptIndex2,ptIndex3; 
 	float depth1,depth2,depth3;
 	InterpolationVal interpolationVal;
 
-	interpolationVal = this->GetInterpolationValues(p);
+	interpolationVal = this->GetInterpolationValues(p, triHint);
 
 	if (interpolationVal.ptIndex1 < 0) return depthAtPoint;
 
@@ -29,6 +29,12 @@ public:
 	//virtual ClassID 	GetClassID 	() { return TYPE_TRIGRIDVEL; }
 	void SetDagTree(TDagTree *dagTree){fDagTree=dagTree;}
 	TDagTree*  GetDagTree(){return fDagTree;}
+	// look triangles up through a uniform bucket grid before the DAG
+	virtual OSErr SetUseBucketIndex(bool useBuckets){return fDagTree ? fDagTree->SetUseBucketIndex(useBuckets) : -1;}
+	virtual bool UsesBucketIndex(){return fDagTree && fDagTree->UsesBucketIndex();}
+	// descend a packed, breadth first copy of the DAG
+	virtual OSErr SetUsePackedDagTree(bool usePacked){return fDagTree ? fDagTree->SetUsePackedTree(usePacked) : -1;}
+	virtual bool UsesPackedDagTree(){return fDagTree && fDagTree->UsesPackedTree();}
 	WORLDPOINTH GetWorldPointsHdl(void);
 	//WORLDPOINTH GetWorldPointsHdl(return WPtH);
 	WORLDPOINTH GetCenterPointsHdl(void);
@@ -46,10 +52,15 @@ public:
 	FLOATH  GetBathymetry(){return fBathymetryH;}
 	FLOATH  GetDepths(){return fBathymetryH;}
 	VelocityRec GetPatValue(WorldPoint p);
+	virtual VelocityRec GetPatValue(WorldPoint p, long *triHint);
 	VelocityRec GetSmoothVelocity(WorldPoint p);
 	virtual double GetDepthAtPoint(WorldPoint p);
+	virtual double GetDepthAtPoint(WorldPoint p, long *triHint);
 	virtual InterpolationVal GetInterpolationValues(WorldPoint refPoint);
+	virtual InterpolationVal GetInterpolationValues(WorldPoint refPoint, long *triHint);
+	virtual double GetCellSize(WorldPoint p, long *triHint);
 	virtual InterpolationValBilinear GetBilinearInterpolationValues(WorldPoint refPoint);
+	InterpolationValBilinear GetBilinearInterpolationValues(WorldPoint refPoint, long ntri);
 	InterpolationVal GetInterpolationValuesFromIndex(long triNum);
 	virtual	long GetRectIndexFromTriIndex(WorldPoint refPoint, LONGH ptrVerdatToNetCDFH, long numCols_ext);
 	virtual	long GetRectIndexFromTriIndex2(long triIndex, LONGH ptrVerdatToNetCDFH, long numCols_ext);
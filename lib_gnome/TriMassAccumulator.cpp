@@ -0,0 +1,128 @@
+/*
+ *  TriMassAccumulator.cpp
+ *  gnome
+ *
+ */
+
+#include "TriMassAccumulator.h"
+
+// the mass totals are summed again from the LEs every this many counts,
+// so the additions and subtractions don't drift
+#define kTriMassSumInterval 64
+
+TriMassAccumulator::TriMassAccumulator()
+{
+	fDagTree = 0;
+	fDepth1 = fDepth2 = fBottomRange = 0;
+	fListIndex = 0;
+	fNumCounts = 0;
+}
+
+void TriMassAccumulator::Dispose()
+{
+	fDagTree = 0;
+	std::vector<long>().swap(fNumLEsInTri);
+	std::vector<double>().swap(fMassInTri);
+	std::vector<TriMassList>().swap(fLists);
+	fListIndex = 0;
+	fNumCounts = 0;
+}
+
+void TriMassAccumulator::Add(const TriMassLE &le)
+{
+	if (le.tri < 0) return;
+	fNumLEsInTri[le.tri]++;
+	fMassInTri[le.tri] += le.massInGrams;
+}
+
+void TriMassAccumulator::Remove(const TriMassLE &le)
+{
+	if (le.tri < 0) return;
+	if (--fNumLEsInTri[le.tri] == 0)
+		fMassInTri[le.tri] = 0;	// exactly empty, whatever the rounding of the subtractions
+	else
+		fMassInTri[le.tri] -= le.massInGrams;
+}
+
+void TriMassAccumulator::SumFromScratch()
+{
+	long i, j, n;
+
+	fNumLEsInTri.assign(fNumLEsInTri.size(), 0);
+	fMassInTri.assign(fMassInTri.size(), 0.);
+	for (i = 0; i < (long)fLists.size(); i++)
+		for (j = 0, n = fLists[i].les.size(); j < n; j++)
+			Add(fLists[i].les[j]);
+	fNumCounts = 0;
+}
+
+void TriMassAccumulator::BeginCount(TDagTree *dagTree, long numTri, float depth1, float depth2, float bottomRange)
+{
+	if (dagTree != fDagTree || numTri != (long)fNumLEsInTri.size() || 
+		depth1 != fDepth1 || depth2 != fDepth2 || bottomRange != fBottomRange)
+	{	// the LEs counted are all different
+		Dispose();
+		fDagTree = dagTree;
+		fDepth1 = depth1;
+		fDepth2 = depth2;
+		fBottomRange = bottomRange;
+		fNumLEsInTri.assign(numTri, 0);
+		fMassInTri.assign(numTri, 0.);
+	}
+	fListIndex = 0;
+}
+
+TriMassLE *TriMassAccumulator::BeginList(const void *listKey, long numLEs)
+{
+	long j, n;
+	TriMassList *list;
+
+	if (fListIndex >= (long)fLists.size())
+	{
+		TriMassList empty;
+		empty.key = 0;
+		fLists.push_back(empty);
+	}
+	list = &fLists[fListIndex];
+
+	if (list->key != listKey || (long)list->les.size() != numLEs)
+	{	// another list, none of its LEs is counted yet
+		for (j = 0, n = list->les.size(); j < n; j++)
+			Remove(list->les[j]);
+		TriMassLE none = {-1, 0.};
+		list->key = listKey;
+		list->les.assign(numLEs, none);
+	}
+	list->next = list->les;
+	return list->next.empty() ? 0 : &list->next[0];
+}
+
+void TriMassAccumulator::EndList()
+{
+	long j, n;
+	TriMassList *list = &fLists[fListIndex];
+
+	for (j = 0, n = list->les.size(); j < n; j++)
+	{
+		if (list->next[j].tri == list->les[j].tri && list->next[j].massInGrams == list->les[j].massInGrams)
+			continue;
+		Remove(list->les[j]);
+		Add(list->next[j]);
+	}
+	list->les.swap(list->next);
+	fListIndex++;
+}
+
+void TriMassAccumulator::EndCount()
+{
+	long i, j, n;
+
+	// the lists that aren't counted anymore
+	for (i = fListIndex; i < (long)fLists.size(); i++)
+		for (j = 0, n = fLists[i].les.size(); j < n; j++)
+			Remove(fLists[i].les[j]);
+	fLists.resize(fListIndex);
+
+	if (++fNumCounts >= kTriMassSumInterval)
+		SumFromScratch();
+}
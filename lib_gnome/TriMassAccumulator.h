@@ -0,0 +1,66 @@
+/*
+ *  TriMassAccumulator.h
+ *  gnome
+ *
+ *  The LEs in each triangle of a grid and their mass, for the contours of
+ *  the subsurface oil. Kept from one count to the next: each LE's triangle
+ *  and mass are remembered, so the next count starts each search from the
+ *  LE's last triangle (a WhatTriAmIIn hint) and only the LEs whose triangle
+ *  or mass changed move the totals.
+ *
+ */
+
+#ifndef __TriMassAccumulator__
+#define __TriMassAccumulator__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+
+class TDagTree;
+
+typedef struct {
+	long	tri;			// -1 if the LE isn't counted
+	double	massInGrams;
+} TriMassLE;
+
+class TriMassAccumulator
+{
+	public:
+						TriMassAccumulator();
+		void			Dispose();
+
+		// starts a count in the numTri triangles of dagTree, the same LEs (lists, counts
+		// and depth range) as the last one or with their totals reset if they aren't
+		void			BeginCount(TDagTree *dagTree, long numTri, float depth1, float depth2, float bottomRange);
+		// the numLEs of the next list: each with the triangle it was in on the last count,
+		// -1 if none, for the caller to set to where it is now
+		TriMassLE		*BeginList(const void *listKey, long numLEs);
+		void			EndList();
+		void			EndCount();
+
+		const long		*GetNumLEsInTri() {return fNumLEsInTri.empty() ? 0 : &fNumLEsInTri[0];}
+		const double	*GetMassInTriInGrams() {return fMassInTri.empty() ? 0 : &fMassInTri[0];}
+
+	private:
+		typedef struct {
+			const void				*key;
+			std::vector<TriMassLE>	les;	// as counted in the totals
+			std::vector<TriMassLE>	next;	// the count being made
+		} TriMassList;
+
+		TDagTree					*fDagTree;
+		float						fDepth1, fDepth2, fBottomRange;
+		std::vector<long>			fNumLEsInTri;
+		std::vector<double>			fMassInTri;
+		std::vector<TriMassList>	fLists;
+		long						fListIndex;		// of the list being counted
+		long						fNumCounts;		// since the totals were summed from scratch
+
+		void			Add(const TriMassLE &le);
+		void			Remove(const TriMassLE &le);
+		void			SumFromScratch();
+};
+
+#endif
@@ -11,6 +11,7 @@
 #define __TypeDefs__
 
 #include <time.h>
+#include <stdint.h>
 
 #ifndef pyGNOME
 #include "Earl.h"
@@ -61,6 +62,11 @@ typedef short LandType;
 
 typedef unsigned long LETYPE;
 
+// a count or index of LEs: a spill may have more than 2^31 of them, and
+// long is 32 bits on Windows
+typedef int64_t LECount;
+typedef LECount **LECountH;
+
 ///// TYPES ///////////////////////////////////////////////////////////////////////
 
 extern Rect CATSgridRect;
@@ -130,7 +136,9 @@ enum { OIL_UNKNOWN = 0, OIL_GAS, OIL_JETFUELS, OIL_DIESEL, OIL_4, OIL_CRUDE, OIL
 	OIL_CONSERVATIVE, OIL_USER1=5000, OIL_USER2 = 5001,
 	OIL_COMBINATION = 1000, CHEMICAL = 8 };
 
-enum NUM_METHOD {EULER = 0, RK4 = 1};
+// ADAPTIVE is Euler where an LE stays within its grid cell, RK4 in sub-steps where it doesn't.
+// TRAPEZOID (RK2) is the py movers' default, for the grid locator's moves
+enum NUM_METHOD {EULER = 0, RK4 = 1, ADAPTIVE = 2, TRAPEZOID = 3};
 
 enum { LT_LAND = 1, LT_WATER = 2, LT_UNDEFINED = -1 };
 
@@ -267,24 +275,28 @@ typedef struct {
 
 ///////////////////////////////////////////////////////////////////////////
 
+// the fields every step and every output frame reads come first, so they
+// share the start of the record, and the shorts go together so they pack.
+// LEs are read and written field by field, the order isn't in any file
 typedef struct
 {
-	long		leUnits;
-	long		leKey; 			// index to identify LE
-	long		leCustomData; 	// space for custom LE data, default = 0
 	WorldPoint	p; 				// x and y location
 	double		z; 				// z position
+	OilStatus	statusCode; 	// not-released, floating, beached, etc.
+	short 		dispersionStatus;
+	OilType		pollutantType; 	// L.E. pollutant type
+	long		leKey; 			// index to identify LE
+	long		leCustomData; 	// space for custom LE data, default = 0
+	double		windage;
+	double		mass; 			// amount of pollutant (what units ?)
+	double		riseVelocity;	// cm/s
 	Seconds		releaseTime; 	// time of release, seconds since 1904
+	
+	long		leUnits;
 	double		ageInHrsWhenReleased;// age of oil in hours at time of release
 	Seconds		clockRef; 		// time offset in seconds (for statistically varying use of time files)
-	OilType		pollutantType; 	// L.E. pollutant type
-	double		mass; 			// amount of pollutant (what units ?)
 	double		density; 		// density in grams/cc
-	double		windage;
 	long 		dropletSize;		// microns
-	short 		dispersionStatus;
-	double		riseVelocity;	// cm/s
-	OilStatus	statusCode; 	// not-released, floating, beached, etc.
 	WorldPoint	lastWaterPt; 	// last on-water point before L.E. was beached
 	Seconds		beachTime; 		// time when L.E. was beached
 } LERec, *LERecP, **LERecH;
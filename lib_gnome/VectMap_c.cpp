@@ -9,6 +9,7 @@
 
 #include "VectMap_c.h"
 #include "MemUtils.h"
+#include "ShorelineIndex.h"
 #ifndef pyGNOME
 #include "TModel.h"
 #include "TMover.h"
@@ -27,6 +28,7 @@ VectorMap_c::VectorMap_c (char* name, WorldRect bounds): Map_c(name, bounds)
 	allowableSpillLayer = nil;
 	mapBoundsLayer = nil;
 	esiMapLayer = nil;
+	fESIIndex = nil;
 	map = nil;
 	bDrawLandBitMap = false;
 	bDrawAllowableSpillBitMap = false;
@@ -85,6 +87,9 @@ double DistFromWPointToSegmentDouble(long pLong, long pLat, long long1, long lat
 	return dist;
 }
 
+// how far from a shoreline segment a point is on it, 1/5 of a second
+#define kShorelineDist ((1000000/3600) / 5)
+
 long CheckShoreline (long longVal, long latVal,CMapLayer *mapLayer)
 {
 	long	ObjectIndex, ObjectCount;
@@ -99,7 +104,7 @@ long CheckShoreline (long longVal, long latVal,CMapLayer *mapLayer)
 	long oneSecond = (1000000/3600); // map border is several pixels wide
 	//dLong = dLat = oneSecond * 50;
 	//dLong = dLat = oneSecond * 5;
-	dLong = dLat = oneSecond / 5;
+	dLong = dLat = kShorelineDist;
 	//dLong = dLat = oneSecond;	// need to figure how to set this
 	//dLong = dLat = 0;
 	long theESICode = 0; // default value
@@ -192,7 +197,11 @@ float VectorMap_c::RefloatHalfLifeInHrs(WorldPoint wp)
 	long esiCode = 1;
 	if (HaveESIMapLayer())	// change to ESILayer
 	{
-		esiCode = CheckShoreline(wp.pLong,wp.pLat,esiMapLayer);
+		if (!fESIIndex) fESIIndex = new ShorelineIndex;
+		if (fESIIndex && fESIIndex->Prepare(esiMapLayer->GetLayerObjectList(), kShorelineDist, kShorelineDist) == noErr)
+			esiCode = fESIIndex->GetESICode(wp.pLong,wp.pLat);
+		else
+			esiCode = CheckShoreline(wp.pLong,wp.pLat,esiMapLayer);
 		refloatHalfLifeInHrs = GetRefloatTimeInHoursFromESICode(esiCode);
 	}
 	return refloatHalfLifeInHrs;
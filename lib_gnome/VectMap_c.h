@@ -28,6 +28,7 @@
 #endif
 
 class CMapLayer;
+class ShorelineIndex;
 
 class VectorMap_c : virtual public Map_c  {
 
@@ -36,6 +37,7 @@ public:
 	CMapLayer			*allowableSpillLayer;
 	CMapLayer			*mapBoundsLayer;
 	CMapLayer			*esiMapLayer;
+	ShorelineIndex		*fESIIndex;		// the esiMapLayer segments near a point, built by RefloatHalfLifeInHrs
 	CMap				*map;
 
 	Boolean				bDrawLandBitMap;
@@ -14,10 +14,24 @@
 #include "Units.h"
 #include "Replacements.h"
 
+#include <vector>
+
 using namespace std;
 
 
-OSErr emulsify(int n, unsigned long step_len,
+static int weatheringThreads = 1;
+
+void SetWeatheringThreads(int numThreads)
+{
+	weatheringThreads = numThreads < 1 ? 1 : numThreads;
+}
+
+int GetWeatheringThreads()
+{
+	return weatheringThreads;
+}
+
+OSErr emulsify(LECount n, unsigned long step_len,
 			   double *frac_water,
 			   double *interfacial_area,
 			   double *frac_evap,
@@ -31,38 +45,34 @@ OSErr emulsify(int n, unsigned long step_len,
 			   double drop_max)
 {
 	OSErr err = 0;
-	double Y, S;
-	//Seconds start;
-	double start, le_age;	// convert to double for calculations
-	//char errmsg[256];
-	
-	for (int i=0; i < n; i++)
+	bool failed = false;
+	bool runParallel = weatheringThreads > 1;
+
+	// the same per LE for the whole step, grouped as in the expressions they came from
+	bool userStart = emul_time > 0.;	// user has set value
+	bool startByAge = emul_time >= 0.;
+	bool startByEvap = emul_C > 0.;
+	double S_rate = k_emul * step_len;
+	double S_decay = -k_emul / S_max;
+	double S_Ymax = (6.0 / drop_max) * (Y_max / (1.0 - Y_max));	// S where Y reaches Y_max
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(weatheringThreads) if(runParallel) reduction(||:failed)
+#endif
+	for (LECount i = 0; i < n; i++)
 	{
-		S = interfacial_area[i];
-		le_age = age[i];
-		//sprintf(errmsg,"for i = %ld, S = %lf, age = %lf, emul_time =%lf, frac_evap[i] = %lf\n",i,S,le_age,emul_time,frac_evap[i]);
-		//printNote(errmsg);
-		//sprintf(errmsg,"k_emul = %lf, emul_C = %lf, Y_max = %lf, S_max = %lf, drop_max = %lf\n",k_emul,emul_C,Y_max,S_max,drop_max);
-		//printNote(errmsg);
-		//if ((age[i] >= emul_time && emul_time >= 0.) || frac_evap[i] >= emul_C && emul_C > 0.)
-		if ((le_age >= emul_time && emul_time >= 0.) || frac_evap[i] >= emul_C && emul_C > 0.)
+		double Y, S = interfacial_area[i];
+		double start, le_age = age[i];	// convert to double for calculations
+
+		if (failed) continue;	// stop at the first bad LE (the first in each thread's share when parallel)
+
+		if ((startByAge && le_age >= emul_time) || (startByEvap && frac_evap[i] >= emul_C))
 		{
-			if (emul_time > 0.)	// user has set value
-				start = emul_time;
-			else
-			{
-				if (bulltime[i] < 0.)
-				{
-					//start = age[i];
-					//bulltime[i] = age[i];
-					start = le_age;
-					bulltime[i] = le_age;
-				}
-				else
-					start = bulltime[i];
-			}
-			//S = S + k_emul * step_len * exp( (-k_emul / S_max) * (age[i] - start));
-			S = S + k_emul * step_len * exp( (-k_emul / S_max) * (le_age - start));
+			if (!userStart && bulltime[i] < 0.)
+				bulltime[i] = le_age;
+			start = userStart ? emul_time : bulltime[i];
+
+			S = S + S_rate * exp(S_decay * (le_age - start));
 			if (S > S_max)
 				S = S_max;
 		}
@@ -71,30 +81,20 @@ OSErr emulsify(int n, unsigned long step_len,
 			S = 0.;
 		}
 		
-		if (S < ((6.0 / drop_max) * (Y_max / (1.0 - Y_max))))
-		{
-			Y = S * drop_max / (6.0 + (S * drop_max));
-		//sprintf(errmsg,"Y = %lf, S = %lf\n",Y,S);
-		//printNote(errmsg);
-		}
-		else
-		{
-			Y = Y_max;
-		//sprintf(errmsg,"Y = %lf, S = %lf\n",Y,S);
-		//printNote(errmsg);
-		}
-		
-		if (Y < 0) { err = -1; return err;}
+		Y = S < S_Ymax ? S * drop_max / (6.0 + (S * drop_max)) : Y_max;
+
+		if (Y < 0) { failed = true; continue;}
 		
 		frac_water[i] = Y;
 		interfacial_area[i] = S;
 	}
 	
+	if (failed) err = -1;
 	return err;
 }
 
 
-OSErr adios2_disperse(int n, unsigned long step_len,
+OSErr adios2_disperse(LECount n, unsigned long step_len,
                       double *frac_water,
                       double *le_mass,
                       double *le_viscosity,
@@ -121,7 +121,16 @@ OSErr adios2_disperse(int n, unsigned long step_len,
 
 	double C_disp = pow(De, 0.57) * fbw; // dispersion term at current time
 
-	for (int i=0; i < n; i++)
+	// the same per LE for the whole step, grouped as in the expressions they came from
+	double sed_rate = 1.6 * ka * sqrt(Hrms * De * fbw / (rho_w * visc_w));
+	double rise_visc = 18.0 * visc_w;
+	double wave_depth = 1.5 * Hrms;
+	bool runParallel = weatheringThreads > 1;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(weatheringThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++)
 	{
 		double rho = le_density[i];	// pure oil density
 		double mass = le_mass[i];
@@ -164,7 +173,7 @@ OSErr adios2_disperse(int n, unsigned long step_len,
 			// droplet average rise velocity
 			double speed = (droplet * droplet * g *
 			                (1.0 - rho / rho_w) /
-			                (18.0 * visc_w));
+			                rise_visc);
 
 			// vol of refloat oil/wave p
 			double V_refloat = 0.588 * (pow(thickness, 1.7) - 5.0e-8);
@@ -175,12 +184,10 @@ OSErr adios2_disperse(int n, unsigned long step_len,
 			double q_refloat = C_Roy * C_disp * V_refloat * A;
 
 			double C_oil = (q_refloat * step_len /
-			                (speed * step_len + 1.5 * Hrms));
+			                (speed * step_len + wave_depth));
 
 			//vol rate
-			Q_sed = (1.6 * ka *
-			         sqrt(Hrms * De * fbw / (rho_w * visc_w)) *
-			         C_oil * C_sed / rho);
+			Q_sed = (sed_rate * C_oil * C_sed / rho);
 		}
 
 		//total vol oil loss due to dispersion
@@ -207,3 +214,227 @@ OSErr adios2_disperse(int n, unsigned long step_len,
 
 	return err;
 }
+
+
+OSErr evaporate(LECount n, int num_components, int num_vp, int num_steps,
+				const double *step_len,
+				const double *K,
+				double *mass_components,
+				double *mass,
+				double *evap_decay,
+				const double *area,
+				const double *frac_water,
+				const double *vapor_pressure,
+				const double *mol_weight,
+				double water_temp,
+				double gas_constant,
+				double *evaporated)
+{
+	OSErr err = 0;
+	bool failed = false;
+	bool runParallel = weatheringThreads > 1;
+	double total = 0.;
+	double RT = gas_constant * water_temp;
+
+	if (num_vp > num_components || num_vp < 0)
+		return -2;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(weatheringThreads) if(runParallel) reduction(||:failed) reduction(+:total)
+#endif
+	for (LECount i = 0; i < n; i++)
+	{
+		double *m = mass_components + (long)i * num_components;
+		double *decay = evap_decay + (long)i * num_components;
+		double f_diff = frac_water ? 1.0 - frac_water[i] : 1.0;
+		double le_mass = 0., start_mass = 0.;
+
+		if (failed) continue;
+
+		for (int j = 0; j < num_components; j++)
+			start_mass += m[j];
+
+		for (int j = num_vp; j < num_components; j++)
+			decay[j] = 0.;
+
+		for (int s = 0; s < num_steps; s++)
+		{
+			double sum_mi_mw = 0., c, dt = step_len[s];
+
+			for (int j = 0; j < num_vp; j++)
+				sum_mi_mw += m[j] / mol_weight[j];
+
+			c = -area[i] * f_diff * K[s] / (RT * sum_mi_mw);
+			if (c > 0.) { failed = true; break; }
+
+			// the components decay independently of one another
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+			for (int j = 0; j < num_vp; j++)
+			{
+				decay[j] = c * vapor_pressure[j];
+				m[j] *= exp(decay[j] * dt);
+			}
+		}
+
+		for (int j = 0; j < num_components; j++)
+			le_mass += m[j];
+
+		total += start_mass - le_mass;
+		mass[i] = le_mass;
+	}
+
+	if (failed) err = -1;
+	*evaporated = total;
+	return err;
+}
+
+
+OSErr fay_spread(LECount n, int num_blobs, const int32_t *blob,
+				 const int32_t *age, long step_len,
+				 const double *blob_init_volume,
+				 double *fay_area,
+				 double *area,
+				 double water_visc,
+				 double rel_buoy,
+				 double thickness_limit,
+				 double k1, double k2,
+				 double gravity)
+{
+	// the area, size, volume and age of each blob -- the volume and age are the same for its LEs
+	vector<double> blobArea(num_blobs, 0.), blobVolume(num_blobs, -1.), leArea(num_blobs, -1.);
+	vector<long> blobCount(num_blobs, 0);
+	vector<long> blobAge(num_blobs, 0);
+
+	double t0Factor = pow(k2 / k1, 4.0);
+	double areaFactor = PI * k2 * k2;
+	double visc_sqrt = sqrt(water_visc);
+
+	for (LECount i = 0; i < n; i++)
+	{
+		int b = blob[i];
+
+		if (b < 0 || b >= num_blobs) return -2;
+		if (age[i] + step_len == 0) return -1;
+
+		blobArea[b] += fay_area[i];
+		blobCount[b]++;
+		if (blobVolume[b] < 0)
+		{
+			blobVolume[b] = blob_init_volume[i];
+			blobAge[b] = age[i] + step_len;
+		}
+	}
+
+	for (int b = 0; b < num_blobs; b++)
+	{
+		double volume = blobVolume[b], t0, max_area, blob_area;
+
+		if (blobCount[b] == 0) continue;
+
+		// only past the transient phase, t0 on the order of minutes
+		t0 = t0Factor * pow(volume / (water_visc * gravity * rel_buoy), 1. / 3);
+		if (blobAge[b] <= t0) continue;
+
+		// only till max area is reached
+		max_area = volume / thickness_limit;
+		if (blobArea[b] >= max_area) continue;
+
+		blob_area = areaFactor *
+					pow(volume * volume * gravity * rel_buoy / visc_sqrt, 1. / 3) *
+					sqrt((double)blobAge[b]);
+
+		leArea[b] = (blob_area < max_area ? blob_area : max_area) / blobCount[b];
+	}
+
+	for (LECount i = 0; i < n; i++)
+	{
+		double a = leArea[blob[i]];
+
+		if (a >= 0) fay_area[i] = a;
+		area[i] = fay_area[i];
+	}
+
+	return 0;
+}
+
+
+OSErr langmuir_coverage(LECount n, int num_groups, const int32_t *group,
+						const double *blob_init_volume,
+						const double *fay_area,
+						const double *density,
+						double *frac_coverage,
+						double *area,
+						double v_max,
+						double rho_water,
+						double gravity)
+{
+	// the thickness of a spill's oil is the volume of its first blob over the area of all of it
+	vector<double> groupArea(num_groups, 0.), groupVolume(num_groups, -1.);
+	double v_factor = v_max * v_max * 4 * PI * PI / gravity;
+
+	for (LECount i = 0; i < n; i++)
+	{
+		int g = group[i];
+
+		if (g < 0 || g >= num_groups) return -2;
+
+		groupArea[g] += fay_area[i];
+		if (groupVolume[g] < 0)
+			groupVolume[g] = blob_init_volume[i];
+	}
+
+	for (LECount i = 0; i < n; i++)
+	{
+		int g = group[i];
+		double thickness = groupVolume[g] / groupArea[g];
+		double rel_buoy = (rho_water - density[i]) / rho_water;
+		double frac_cov = 1. / pow(v_factor / (thickness * rel_buoy), 1. / 3);
+
+		// 0.1 <= frac_cov <= 1.0
+		if (frac_cov < 0.1) frac_cov = 0.1;
+		if (frac_cov > 1.0) frac_cov = 1.0;
+
+		frac_coverage[i] = frac_cov;
+		area[i] = fay_area[i] * frac_cov;
+	}
+
+	return 0;
+}
+
+
+OSErr remove_mass(LECount n, int num_components, int num_groups, const int32_t *group,
+				  const double *factor,
+				  double *mass_components,
+				  double *mass)
+{
+	bool failed = false;
+	bool runParallel = weatheringThreads > 1;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(weatheringThreads) if(runParallel) reduction(||:failed)
+#endif
+	for (LECount i = 0; i < n; i++)
+	{
+		int g = group[i];
+		double *components = mass_components + (long)i * num_components;
+		double sum = 0.;
+
+		if (g < 0) continue;
+		if (g >= num_groups) {
+			failed = true;
+			continue;
+		}
+
+		for (int c = 0; c < num_components; c++)
+		{
+			components[c] *= factor[g];
+			sum += components[c];
+		}
+		mass[i] = sum;
+	}
+
+	return failed ? -2 : 0;
+}
+
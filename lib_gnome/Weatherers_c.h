@@ -16,7 +16,12 @@
 
 // emulsify and disperse are exposed to Cython/Python for PyGnome
 
-OSErr DLL_API emulsify(int n, unsigned long step_len,
+// threads for the emulsify and disperse loops, 1 (the default) is serial
+// only has an effect when lib_gnome is built with OpenMP
+void DLL_API SetWeatheringThreads(int numThreads);
+int DLL_API GetWeatheringThreads();
+
+OSErr DLL_API emulsify(LECount n, unsigned long step_len,
                        double *frac_water,
                        double *le_interfacial_area,
                        double *frac_evap,
@@ -29,7 +34,7 @@ OSErr DLL_API emulsify(int n, unsigned long step_len,
                        double Y_max,
                        double drop_max);
 
-OSErr DLL_API adios2_disperse(int n, unsigned long step_len,
+OSErr DLL_API adios2_disperse(LECount n, unsigned long step_len,
                               double *frac_water,
                               double *le_mass,
                               double *le_viscosity,
@@ -47,4 +52,59 @@ OSErr DLL_API adios2_disperse(int n, unsigned long step_len,
                               double V_entrain,
                               double ka);
 
+// evaporation of the pseudo-components of n LEs over num_steps sub-steps of step_len[s] seconds,
+// the wind's mass transport coefficient K[s] at each. mass_components is n x num_components, in
+// place, the first num_vp of them evaporating; mass and evap_decay (n x num_components, the
+// decay constants of the last sub-step) are output, as is the total evaporated.
+// frac_water may be NULL for no water. Returns -1 if a decay constant is positive
+OSErr DLL_API evaporate(LECount n, int num_components, int num_vp, int num_steps,
+                        const double *step_len,
+                        const double *K,
+                        double *mass_components,
+                        double *mass,
+                        double *evap_decay,  // output
+                        const double *area,
+                        const double *frac_water,
+                        const double *vapor_pressure,
+                        const double *mol_weight,
+                        double water_temp,
+                        double gas_constant,
+                        double *evaporated);  // output
+
+// Fay spreading of all the blobs of LEs (the LEs released together from a spill) in one pass.
+// blob[i] is the blob of LE i, 0 to num_blobs - 1; the LEs are of age[i] + step_len at the end
+// of the step. fay_area is updated in place for the blobs past their initial spreading and not
+// at their max area, and area set to it. Returns -1 for an LE of age 0 (they are given their
+// initial area instead), -2 for a bad blob
+OSErr DLL_API fay_spread(LECount n, int num_blobs, const int32_t *blob,
+                         const int32_t *age, long step_len,
+                         const double *blob_init_volume,
+                         double *fay_area,
+                         double *area,  // output
+                         double water_visc,
+                         double rel_buoy,
+                         double thickness_limit,
+                         double k1, double k2,
+                         double gravity);
+
+// the fractional coverage of Langmuir circulation for the LEs of num_groups spills (group[i] is
+// the spill of LE i) with the wind's v_max, and area = fay_area * frac_coverage
+OSErr DLL_API langmuir_coverage(LECount n, int num_groups, const int32_t *group,
+                                const double *blob_init_volume,
+                                const double *fay_area,
+                                const double *density,
+                                double *frac_coverage,  // output
+                                double *area,  // output
+                                double v_max,
+                                double rho_water,
+                                double gravity);
+
+// the mass removed by the cleanup operations of a step in one pass: the components of each LE in
+// group[i] (0 to num_groups - 1, -1 for none) are scaled by factor[group[i]], and its mass set to
+// their sum. mass_components is n x num_components. Returns -2 for a bad group
+OSErr DLL_API remove_mass(LECount n, int num_components, int num_groups, const int32_t *group,
+                          const double *factor,
+                          double *mass_components,
+                          double *mass);
+
 #endif
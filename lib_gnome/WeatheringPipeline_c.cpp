@@ -0,0 +1,219 @@
+/*
+ *  WeatheringPipeline_c.cpp
+ *  gnome
+ *
+ *  Each stage does what its weatherer does to the arrays in a sub-step,
+ *  in the same order: evaporation.py's evaporation and frac_lost,
+ *  natural_dispersion.py's dispersion and the mass it takes out of the
+ *  components, emulsification.py's emulsify.
+ *
+ */
+
+#include "WeatheringPipeline_c.h"
+#include "Weatherers_c.h"
+
+using namespace std;
+
+
+void WeatheringPipeline_c::AddEvaporation(int numSteps, const double *K, int numVP, const double *vaporPressure,
+										  const double *molWeight, double waterTemp, double gasConstant)
+{
+	Stage stage;
+
+	stage.kind = kStageEvaporation;
+	stage.perStep[0].assign(K, K + numSteps);
+	stage.perComponent[0].assign(vaporPressure, vaporPressure + numVP);
+	stage.perComponent[1].assign(molWeight, molWeight + numVP);
+	stage.numVP = numVP;
+	stage.params[0] = waterTemp;
+	stage.params[1] = gasConstant;
+	fStages.push_back(stage);
+}
+
+
+void WeatheringPipeline_c::AddDispersion(int numSteps, const double *fracBreakingWaves, const double *dispWaveEnergy,
+										 const double *waveHeight, double visc_w, double rho_w, double C_sed,
+										 double V_entrain, double ka)
+{
+	Stage stage;
+
+	stage.kind = kStageDispersion;
+	stage.perStep[0].assign(fracBreakingWaves, fracBreakingWaves + numSteps);
+	stage.perStep[1].assign(dispWaveEnergy, dispWaveEnergy + numSteps);
+	stage.perStep[2].assign(waveHeight, waveHeight + numSteps);
+	stage.numVP = 0;
+	stage.params[0] = visc_w;
+	stage.params[1] = rho_w;
+	stage.params[2] = C_sed;
+	stage.params[3] = V_entrain;
+	stage.params[4] = ka;
+	fStages.push_back(stage);
+}
+
+
+void WeatheringPipeline_c::AddEmulsification(int numSteps, const double *k_emul, double emulTime, double emulC,
+											 double S_max, double Y_max, double dropMax)
+{
+	Stage stage;
+
+	stage.kind = kStageEmulsification;
+	stage.perStep[0].assign(k_emul, k_emul + numSteps);
+	stage.numVP = 0;
+	stage.params[0] = emulTime;
+	stage.params[1] = emulC;
+	stage.params[2] = S_max;
+	stage.params[3] = Y_max;
+	stage.params[4] = dropMax;
+	fStages.push_back(stage);
+}
+
+
+OSErr WeatheringPipeline_c::Run(LECount n, int numComponents, int numSteps, const double *stepLen,
+								const WeatheringArrays &arrays, WeatheringStageResult *results)
+{
+	OSErr err = 0;
+
+	for (size_t i = 0; i < fStages.size(); i++)
+	{
+		const Stage &stage = fStages[i];
+
+		results[i].kind = stage.kind;
+		results[i].totals[0] = results[i].totals[1] = 0.;
+		if (n <= 0) continue;
+
+		if ((long)stage.perStep[0].size() != numSteps)
+			return -2;	// added for another number of sub-steps
+
+		switch (stage.kind)
+		{
+			case kStageEvaporation:
+				err = Evaporate(stage, n, numComponents, numSteps, stepLen, arrays, results[i].totals);
+				break;
+			case kStageDispersion:
+				err = Disperse(stage, n, numComponents, numSteps, stepLen, arrays, results[i].totals);
+				break;
+			case kStageEmulsification:
+				err = Emulsify(stage, n, numSteps, stepLen, arrays);
+				break;
+		}
+		if (err) return err;
+	}
+
+	return 0;
+}
+
+
+OSErr WeatheringPipeline_c::Evaporate(const Stage &stage, LECount n, int numComponents, int numSteps,
+									  const double *stepLen, const WeatheringArrays &arrays, double *totals)
+{
+	OSErr err;
+
+	if (!arrays.massComponents || !arrays.mass || !arrays.evapDecay || !arrays.area)
+		return -3;
+
+	err = evaporate(n, numComponents, stage.numVP, numSteps, stepLen, &stage.perStep[0][0],
+					arrays.massComponents, arrays.mass, arrays.evapDecay, arrays.area, arrays.fracWater,
+					stage.numVP ? &stage.perComponent[0][0] : 0, stage.numVP ? &stage.perComponent[1][0] : 0,
+					stage.params[0], stage.params[1], &totals[0]);
+	if (err) return err;
+
+	if (arrays.fracLost && arrays.initMass)
+		for (LECount i = 0; i < n; i++)
+			arrays.fracLost[i] = 1 - arrays.mass[i] / arrays.initMass[i];
+
+	return 0;
+}
+
+
+// the mass fraction removed from the LEs, of their total
+static double RemovedFraction(double removed, const double *mass, LECount n)
+{
+	double total = 0., frac;
+
+	for (LECount i = 0; i < n; i++)
+		total += mass[i];
+
+	if (total <= 0.)
+		return 0.;
+
+	frac = removed / total;
+	return frac > 1. ? 1. : frac;
+}
+
+
+static void ScaleMass(double factor, double *massComponents, double *mass, LECount n, int numComponents)
+{
+	for (LECount i = 0; i < n; i++)
+	{
+		double *m = massComponents + (long)i * numComponents;
+		double le_mass = 0.;
+
+		for (int j = 0; j < numComponents; j++)
+		{
+			m[j] *= factor;
+			le_mass += m[j];
+		}
+		mass[i] = le_mass;
+	}
+}
+
+
+OSErr WeatheringPipeline_c::Disperse(const Stage &stage, LECount n, int numComponents, int numSteps,
+									 const double *stepLen, const WeatheringArrays &arrays, double *totals)
+{
+	OSErr err;
+
+	if (!arrays.massComponents || !arrays.mass || !arrays.fracWater || !arrays.viscosity ||
+		!arrays.density || !arrays.fayArea || !arrays.dropletAvgSize)
+		return -3;
+
+	if (fDispersed.size() < (size_t)n) fDispersed.resize(n);
+	if (fSedimented.size() < (size_t)n) fSedimented.resize(n);
+
+	for (int s = 0; s < numSteps; s++)
+	{
+		double disp = 0., sed = 0.;
+
+		err = adios2_disperse(n, (unsigned long)stepLen[s], arrays.fracWater, arrays.mass, arrays.viscosity,
+							  arrays.density, arrays.fayArea, &fDispersed[0], &fSedimented[0],
+							  arrays.dropletAvgSize, stage.perStep[0][s], stage.perStep[1][s],
+							  stage.perStep[2][s], stage.params[0], stage.params[1], stage.params[2],
+							  stage.params[3], stage.params[4]);
+		if (err) return err;
+
+		for (LECount i = 0; i < n; i++)
+		{
+			disp += fDispersed[i];
+			sed += fSedimented[i];
+		}
+
+		// the dispersed mass comes out of the components, then the sedimented
+		ScaleMass(1. - RemovedFraction(disp, arrays.mass, n), arrays.massComponents, arrays.mass, n, numComponents);
+		ScaleMass(1. - RemovedFraction(sed, arrays.mass, n), arrays.massComponents, arrays.mass, n, numComponents);
+
+		totals[0] += disp;
+		totals[1] += sed;
+	}
+
+	return 0;
+}
+
+
+OSErr WeatheringPipeline_c::Emulsify(const Stage &stage, LECount n, int numSteps,
+									 const double *stepLen, const WeatheringArrays &arrays)
+{
+	OSErr err;
+
+	if (!arrays.fracWater || !arrays.interfacialArea || !arrays.fracLost || !arrays.age || !arrays.bulltime)
+		return -3;
+
+	for (int s = 0; s < numSteps; s++)
+	{
+		err = emulsify(n, (unsigned long)stepLen[s], arrays.fracWater, arrays.interfacialArea, arrays.fracLost,
+					   arrays.age, arrays.bulltime, stage.perStep[0][s], stage.params[0], stage.params[1],
+					   stage.params[2], stage.params[3], stage.params[4]);
+		if (err) return err;
+	}
+
+	return 0;
+}
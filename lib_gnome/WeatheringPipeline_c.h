@@ -0,0 +1,95 @@
+/*
+ *  WeatheringPipeline_c.h
+ *  gnome
+ *
+ *  The weatherers next to each other in a model that work on the LEs in
+ *  lib_gnome -- evaporation, natural dispersion and emulsification -- run
+ *  as stages of one call on a substance's arrays, each over all the
+ *  sub-steps of the model step before the next, as the model runs them
+ *  one after another. The stages are added from Python with what they need
+ *  of the environment at each sub-step, then Run does them all.
+ *
+ */
+
+#ifndef __WeatheringPipeline_c__
+#define __WeatheringPipeline_c__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+enum { kStageEvaporation = 0, kStageDispersion, kStageEmulsification };
+
+// the data arrays of a substance's LEs the stages work on, in place. Only
+// the ones of the stages added are needed
+typedef struct {
+	double	*massComponents;	// n x numComponents
+	double	*mass;
+	double	*initMass;
+	double	*evapDecay;			// n x numComponents
+	double	*area;
+	double	*fracWater;
+	double	*fracLost;
+	double	*viscosity;
+	double	*density;
+	double	*fayArea;
+	double	*dropletAvgSize;
+	double	*interfacialArea;
+	int32_t	*age;
+	double	*bulltime;
+} WeatheringArrays;
+
+typedef struct {
+	short	kind;
+	double	totals[2];	// evaporated; dispersed and sedimented
+} WeatheringStageResult;
+
+class DLL_API WeatheringPipeline_c {
+
+public:
+	WeatheringPipeline_c() {}
+	virtual ~WeatheringPipeline_c() {}
+
+	void	Clear() {fStages.clear();}
+	long	GetNumStages() {return (long)fStages.size();}
+
+	// the values of each of the numSteps sub-steps of the Run: K, the mass
+	// transport coefficient of the wind; the fraction of breaking waves,
+	// their dissipated energy and height; k_emul, the water uptake rate
+	void	AddEvaporation(int numSteps, const double *K, int numVP, const double *vaporPressure,
+						   const double *molWeight, double waterTemp, double gasConstant);
+	void	AddDispersion(int numSteps, const double *fracBreakingWaves, const double *dispWaveEnergy,
+						  const double *waveHeight, double visc_w, double rho_w, double C_sed,
+						  double V_entrain, double ka);
+	void	AddEmulsification(int numSteps, const double *k_emul, double emulTime, double emulC,
+							  double S_max, double Y_max, double dropMax);
+
+	// the stages in the order they were added, each over the sub-steps of
+	// stepLen seconds, results gets one per stage
+	OSErr	Run(LECount n, int numComponents, int numSteps, const double *stepLen,
+				const WeatheringArrays &arrays, WeatheringStageResult *results);
+
+private:
+	typedef struct {
+		short				kind;
+		std::vector<double>	perStep[3];
+		std::vector<double>	perComponent[2];
+		int					numVP;
+		double				params[6];
+	} Stage;
+
+	OSErr	Evaporate(const Stage &stage, LECount n, int numComponents, int numSteps,
+					  const double *stepLen, const WeatheringArrays &arrays, double *totals);
+	OSErr	Disperse(const Stage &stage, LECount n, int numComponents, int numSteps,
+					 const double *stepLen, const WeatheringArrays &arrays, double *totals);
+	OSErr	Emulsify(const Stage &stage, LECount n, int numSteps,
+					 const double *stepLen, const WeatheringArrays &arrays);
+
+	std::vector<Stage> fStages;
+	std::vector<double> fDispersed;
+	std::vector<double> fSedimented;
+};
+
+#endif
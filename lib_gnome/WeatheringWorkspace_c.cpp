@@ -0,0 +1,188 @@
+/*
+ *  WeatheringWorkspace_c.cpp
+ *  gnome
+ *
+ */
+
+#include "WeatheringWorkspace_c.h"
+#include "Weatherers_c.h"
+
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+
+// numpy's nan_to_num(), as dissolution.py applied it
+static inline double NanToNum(double x)
+{
+	if (x != x) return 0.;
+	if (x > DBL_MAX) return DBL_MAX;
+	if (x < -DBL_MAX) return -DBL_MAX;
+	return x;
+}
+
+static inline double Clip(double x, double lo, double hi)
+{
+	return x < lo ? lo : (x > hi ? hi : x);
+}
+
+
+OSErr WeatheringWorkspace_c::Disperse(LECount n, unsigned long step_len,
+									  double *frac_water,
+									  double *le_mass,
+									  double *le_viscosity,
+									  double *le_density,
+									  double *fay_area,
+									  double *droplet_avg_size,
+									  double frac_breaking_waves,
+									  double disp_wave_energy,
+									  double wave_height,
+									  double visc_w,
+									  double rho_w,
+									  double C_sed,
+									  double V_entrain,
+									  double ka,
+									  double *dispersed,
+									  double *sedimented)
+{
+	OSErr err = 0;
+	double disp = 0., sed = 0.;
+
+	*dispersed = *sedimented = 0.;
+	if (n <= 0) return 0;
+
+	Reserve(fDispersed, n);
+	Reserve(fSedimented, n);
+
+	err = adios2_disperse(n, step_len, frac_water, le_mass, le_viscosity, le_density, fay_area,
+						  &fDispersed[0], &fSedimented[0], droplet_avg_size,
+						  frac_breaking_waves, disp_wave_energy, wave_height,
+						  visc_w, rho_w, C_sed, V_entrain, ka);
+	if (err) return err;
+
+	for (LECount i = 0; i < n; i++)
+	{
+		disp += fDispersed[i];
+		sed += fSedimented[i];
+	}
+
+	*dispersed = disp;
+	*sedimented = sed;
+
+	return 0;
+}
+
+
+OSErr WeatheringWorkspace_c::Dissolve(LECount n, int num_components, unsigned long step_len,
+									  double *mass_components,
+									  double *le_mass,
+									  double *area,
+									  double *droplet_avg_size,
+									  double *partition_coeff,
+									  double *k_ow,
+									  double *mol_weight,
+									  double *density,
+									  double rho_water,
+									  double wave_height,
+									  double wave_period,
+									  double frac_breaking_waves,
+									  double wind_speed,
+									  double *dissolved)
+{
+	double total = 0.;
+	double dt = (double)step_len;
+	int numThreads = GetWeatheringThreads();
+	bool runParallel = numThreads > 1;
+
+	// the calm between wave breaks (Ding & Farmer), the same for all LEs
+	double T_calm = (1.0 / frac_breaking_waves - 0.5) * wave_period;
+	// the mass transfer rate from the slick per unit area (Cohen), kg/(m^2 s)
+	double slick_rate = 0.01 * (wind_speed / 3600.0);
+
+	*dissolved = 0.;
+	if (n <= 0) return 0;
+
+	Reserve(fDissolved, n);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(runParallel)
+#endif
+	for (LECount i = 0; i < n; i++)
+	{
+		double *m = mass_components + (long)i * num_components;
+		double sum_m = 0., sum_m_mw = 0., sum_mk_mw = 0., sum_m_rho = 0.;
+		double arom_mass = 0., arom_vol = 0., inert_vol = 0.;
+		double K_ow, avg_rho, k_w, X, beta, dX_dt, f_wc, T_wc, T_slick;
+		double wc_rate, c_rate, le_dissolved = 0., le_remain = 0.;
+
+		for (int j = 0; j < num_components; j++)
+		{
+			double vol = m[j] / density[j];
+
+			sum_m += m[j];
+			sum_m_mw += m[j] / mol_weight[j];
+			sum_mk_mw += m[j] * k_ow[j] / mol_weight[j];
+			sum_m_rho += m[j] * density[j];
+
+			if (k_ow[j] > 0)
+			{
+				arom_mass += m[j];
+				arom_vol += vol;
+			}
+			else
+				inert_vol += vol;
+		}
+
+		// molar averaged partition coefficient
+		K_ow = sum_mk_mw / sum_m_mw;
+		partition_coeff[i] = K_ow;
+
+		avg_rho = NanToNum(sum_m_rho / sum_m);
+
+		// droplet water phase transfer velocity (Stokes)
+		k_w = 544.814 * (rho_water - avg_rho) * droplet_avg_size[i] * droplet_avg_size[i];
+
+		// the aromatics against the inert volume
+		X = arom_vol / inert_vol;
+		beta = 4.84 * k_w / K_ow * pow(inert_vol, 2.0 / 3.0);
+		dX_dt = beta * X / pow(X + 1.0, 1.0 / 3.0);
+
+		// time in the water column, refloating from 0.75 of the wave height
+		f_wc = Clip((0.75 * wave_height / k_w) / T_calm, 0.0, 1.0);
+		T_wc = f_wc * dt;
+		T_slick = Clip(T_calm, 0.0, dt - T_wc);
+
+		// the fraction of a component dissolved from the water column is its share of the
+		// aromatics, and from the slick its concentration in the oil (avg_rho * m / sum_m)
+		wc_rate = dX_dt * T_wc / arom_mass;
+		c_rate = slick_rate * avg_rho / sum_m * area[i];
+
+		for (int j = 0; j < num_components; j++)
+		{
+			double diss = 0.;
+
+			// only the aromatics dissolve
+			if (k_ow[j] > 0)
+				diss = NanToNum(m[j] * wc_rate) + NanToNum(c_rate * m[j] / k_ow[j]) * T_slick;
+
+			// don't dissolve more than there is
+			if (m[j] - diss < 0.)
+				diss = m[j];
+
+			m[j] -= diss;
+			le_dissolved += diss;
+			le_remain += m[j];
+		}
+
+		le_mass[i] = le_remain;
+		fDissolved[i] = le_dissolved;
+	}
+
+	for (LECount i = 0; i < n; i++)
+		total += fDissolved[i];
+
+	*dissolved = total;
+
+	return 0;
+}
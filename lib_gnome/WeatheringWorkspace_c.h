@@ -0,0 +1,81 @@
+/*
+ *  WeatheringWorkspace_c.h
+ *  gnome
+ *
+ *  The arrays the dispersion and dissolution weatherers need for each step,
+ *  kept from one step to the next so they're allocated only when there are
+ *  more LEs than before. It does the dissolution mass transfer of a step, as
+ *  dissolution.py worked it out.
+ *
+ */
+
+#ifndef __WeatheringWorkspace_c__
+#define __WeatheringWorkspace_c__
+
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "ExportSymbols.h"
+
+class DLL_API WeatheringWorkspace_c {
+
+public:
+	WeatheringWorkspace_c() {}
+	virtual ~WeatheringWorkspace_c() {}
+
+	// adios2_disperse() into the workspace, then the totals dispersed and sedimented
+	OSErr	Disperse(LECount n, unsigned long step_len,
+					 double *frac_water,
+					 double *le_mass,
+					 double *le_viscosity,
+					 double *le_density,
+					 double *fay_area,
+					 double *droplet_avg_size,  // output
+					 double frac_breaking_waves,
+					 double disp_wave_energy,
+					 double wave_height,
+					 double visc_w,
+					 double rho_w,
+					 double C_sed,
+					 double V_entrain,
+					 double ka,
+					 double *dispersed,  // output
+					 double *sedimented);  // output
+
+	// the mass of the aromatic components dissolved in a step -- from the droplets in the
+	// water column between the wave breaks and from the slick in the calm -- taken out of
+	// mass_components (n x num_components) in place, and le_mass set to what's left.
+	// k_ow is the partition coefficient of each component, 0 for those not aromatic; the
+	// molar averaged coefficient of each LE is put in partition_coeff.
+	// The waves are those of the step: the peak period and the fraction breaking
+	OSErr	Dissolve(LECount n, int num_components, unsigned long step_len,
+					 double *mass_components,
+					 double *le_mass,  // output
+					 double *area,
+					 double *droplet_avg_size,
+					 double *partition_coeff,  // output
+					 double *k_ow,
+					 double *mol_weight,
+					 double *density,
+					 double rho_water,
+					 double wave_height,
+					 double wave_period,
+					 double frac_breaking_waves,
+					 double wind_speed,
+					 double *dissolved);  // output
+
+	// the dispersed/sedimented/dissolved mass of each LE in the last step
+	const double *GetDispersed() {return fDispersed.empty() ? 0 : &fDispersed[0];}
+	const double *GetSedimented() {return fSedimented.empty() ? 0 : &fSedimented[0];}
+	const double *GetDissolved() {return fDissolved.empty() ? 0 : &fDissolved[0];}
+
+private:
+	void	Reserve(std::vector<double> &v, size_t n) {if (v.size() < n) v.resize(n);}
+
+	std::vector<double> fDispersed;
+	std::vector<double> fSedimented;
+	std::vector<double> fDissolved;
+};
+
+#endif
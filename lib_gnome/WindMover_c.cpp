@@ -11,6 +11,7 @@
 #include "MemUtils.h"
 #include "GEOMETRY.H"
 #include "CompFunctions.h"
+#include "RunState.h"
 //#include "OUTILS.H"
 
 #ifdef pyGNOME
@@ -57,6 +58,9 @@ void WindMover_c::Init()
 	fSigmaTheta =  0; 
 	//conversion = 1.0;// JLM , I think this field should be removed
 	fUncertaintyDiffusion = 0;
+	bUseCounterRandom = false;
+	fRandomSeed = 1;
+	fSharedFactorCount = 0;
 	bTimeFileOpen = FALSE;
 	bUncertaintyPointOpen=false;
 	bSubsurfaceActive = false;
@@ -97,6 +101,34 @@ void rndv(float *rndv1,float *rndv2)
 	*rndv2 = srt * sin(cosArg);
 }
 
+void UpdateWindages(const CounterRandomKey &key, LECount n, const uint32_t *leIDs,
+					const double *windageRange, const long *persistence, double timeStep,
+					double *windages, int numThreads)
+{
+	if (n <= 0 || timeStep <= 0) return;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(numThreads) if(numThreads > 1 && n > 1)
+#endif
+	for (LECount i = 0; i < n; i++)
+	{
+		double low = windageRange[2 * i], high = windageRange[2 * i + 1], u;
+
+		if (persistence[i] <= 0) continue;
+
+		if (persistence[i] != timeStep)
+		{
+			double range = (high - low) * sqrt(persistence[i] / timeStep), mean = (high + low) / 2.;
+
+			low = mean - range / 2.;
+			high = mean + range / 2.;
+		}
+
+		FillCounterRandomUniforms(key, 1, &leIDs[i], 0, &u);
+		windages[i] = low + u * (high - low);
+	}
+}
+
 // Routine to check if random variables selected for
 // the variable wind speed and direction are within acceptable
 // limits. 0 means ok for angle and speed in anglekey and speedkey
@@ -134,8 +166,7 @@ void WindMover_c::DisposeUncertainty()
 
 void WindMover_c::UpdateUncertaintyValues(Seconds elapsedTime)
 {
-	long i,j,n;
-	float cosTerm,sinTerm;
+	LECount n;
 	
 	fTimeUncertaintyWasSet = elapsedTime;
 	
@@ -143,24 +174,71 @@ void WindMover_c::UpdateUncertaintyValues(Seconds elapsedTime)
 	
 	n = _GetHandleSize((Handle)fWindUncertaintyList)/sizeof(LEWindUncertainRec);
 	
-	for(i=0;i<n;i++)
+	this->SetUncertaintyValues(0,n);
+}
+
+// rndv with the counter based random numbers of LE leIndex, attempt numbering the pairs drawn
+static void CounterRndv(const CounterRandomKey &key, LECount leIndex, long attempt, float *rndv1, float *rndv2)
+{
+	float cosArg = 2 * PI * CounterRandomFloat(key, leIndex, 2 * attempt, 0.0, 1.0);
+	float srt = sqrt(-2 * log(CounterRandomFloat(key, leIndex, 2 * attempt + 1, .001, .999)));
+	
+	*rndv1 = srt * cos(cosArg);
+	*rndv2 = srt * sin(cosArg);
+}
+
+// draws the factors of LEs start to end-1 with the current sigmas. With fSharedFactorCount
+// only the first member's LEs are drawn, the others copy the factor of the same LE in it
+void WindMover_c::SetUncertaintyValues(LECount start, LECount end)
+{
+	LECount i, drawEnd = end;
+	LEWindUncertainRec *list;
+	CounterRandomKey key;
+	
+	if(!fWindUncertaintyList) return;
+	
+	if (fSharedFactorCount > 0 && drawEnd > fSharedFactorCount)
+		drawEnd = start > fSharedFactorCount ? start : fSharedFactorCount;
+	
+	key.seed = (uint32_t)fRandomSeed;
+	key.spillID = 0;	// the LE indices run through all the uncertainty sets
+	key.step = (long)fTimeUncertaintyWasSet;
+	key.stream = UNCERTAINTY_LE;
+	
+	list = *fWindUncertaintyList;
+	// only the counter based random numbers are safe to draw from several threads
+	bool runParallel = fNumThreads > 1 && bUseCounterRandom && drawEnd - start > 1;
+	bool useCounterRandom = bUseCounterRandom;
+	
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNumThreads) if(runParallel)
+#endif
+	for(i=start;i<drawEnd;i++)
 	{
-		rndv(&cosTerm,&sinTerm);
+		float cosTerm,sinTerm;
+		long j;
+		
+		if (useCounterRandom) CounterRndv(key,i,0,&cosTerm,&sinTerm);
+		else rndv(&cosTerm,&sinTerm);
 		for(j=0;j<10;j++)
 		{
 			if(TermsLessThanMax(cosTerm,sinTerm,
 								fMaxSpeed,fMaxAngle,fSigma2,fSigmaTheta))break;
-			rndv(&cosTerm,&sinTerm);
+			if (useCounterRandom) CounterRndv(key,i,j+1,&cosTerm,&sinTerm);
+			else rndv(&cosTerm,&sinTerm);
 		}
 		
-		(*fWindUncertaintyList)[i].randCos=cosTerm;
-		(*fWindUncertaintyList)[i].randSin = sinTerm;
+		list[i].randCos = cosTerm;
+		list[i].randSin = sinTerm;
 	}
+	
+	for(i=drawEnd;i<end;i++)
+		list[i] = list[i % fSharedFactorCount];
 }
 
-OSErr WindMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// remove off map LEs
+OSErr WindMover_c::ReallocateUncertainty(LECount numLEs, short* statusCodes)	// remove off map LEs
 {
-	long i,numrec=0,uncertListSize,numLESetsStored;
+	LECount i,numrec=0,uncertListSize,numLESetsStored;
 	OSErr err=0;
 	
 	if (numLEs == 0 || ! statusCodes) return -1;	// shouldn't happen
@@ -169,7 +247,7 @@ OSErr WindMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// remo
 	
 	// check that (*fLESetSizesH)[0]==numLEs and size of fLESetSizesH == 1
 	uncertListSize = _GetHandleSize((Handle)fWindUncertaintyList)/sizeof(LEWindUncertainRec);
-	numLESetsStored = _GetHandleSize((Handle)fLESetSizes)/sizeof(long);
+	numLESetsStored = _GetHandleSize((Handle)fLESetSizes)/sizeof(LECount);
 	
 	if (uncertListSize != numLEs) return -1;
 	if (numLESetsStored != 1) return -1;
@@ -202,16 +280,17 @@ OSErr WindMover_c::ReallocateUncertainty(int numLEs, short* statusCodes)	// remo
 }
 
 
-OSErr WindMover_c::AllocateUncertainty(int numLESets, int* LESetsSizesList)	// only passing in uncertainty list information
+OSErr WindMover_c::AllocateUncertainty(int numLESets, LECount* LESetsSizesList)	// only passing in uncertainty list information
 {
-	long i,j,numrec=0;
+	MemoryTag memoryTag(kMemUncertainty);
+	LECount i,j,numrec=0;
 	OSErr err=0;
 	
 	this->DisposeUncertainty(); // get rid of any old values
 		
 	if (numLESets == 0) return -1;	// shouldn't happen - if we get here there should be an uncertainty set
 	
-	if(!(fLESetSizes = (LONGH)_NewHandle(sizeof(long)*numLESets)))goto errHandler;
+	if(!(fLESetSizes = (LECountH)_NewHandle(sizeof(LECount)*numLESets)))goto errHandler;
 	
 	for (i = 0,numrec=0; i < numLESets ; i++) {
 		(*fLESetSizes)[i]=numrec;	// this is really storing an index to the fWindUncertaintyList
@@ -228,10 +307,10 @@ errHandler:
 }
 
 
-OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets, int* LESetsSizesList)
+OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets, LECount* LESetsSizesList)
 {
 	OSErr err = noErr;
-	long i,j;
+	long i;
 	Boolean needToReInit = false, needToReAllocate = false;
 	//Boolean bAddUncertainty = (elapsedTime >= fUncertainStartTime) && model->IsUncertain();
 	Boolean bAddUncertainty = (elapsedTime >= fUncertainStartTime);
@@ -255,8 +334,8 @@ OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets,
 	if(fLESetSizes)
 	{	// check the LE sets are still the same, JLM 9/18/98
 		// code goes here, if LEs were added instead of needToReInit use needToReAllocate - save uncertainty if duration has not been exceeded
-		long numrec, uncertListSize = 0, numLESetsStored;
-		numLESetsStored = _GetHandleSize((Handle)fLESetSizes)/sizeof(long);
+		LECount numrec, uncertListSize = 0, numLESetsStored;
+		numLESetsStored = _GetHandleSize((Handle)fLESetSizes)/sizeof(LECount);
 		if(numLESets != numLESetsStored) needToReInit = true;
 		else
 		{
@@ -286,8 +365,8 @@ OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets,
 		if (needToReAllocate)
 		{	// move to separate function, and probably should combine with 
 			char errmsg[256] = "";
-			float cosTerm,sinTerm;
-			_SetHandleSize((Handle)fWindUncertaintyList, numrec*sizeof(LEWindUncertainRec));
+			// new LEs are only appended, so leave room for the next releases
+			_GrowHandleSize((Handle)fWindUncertaintyList, numrec*sizeof(LEWindUncertainRec));
 			//sprintf(errmsg,"Num LEs to Allocate = %ld, previous Size = %ld\n",numrec,uncertListSize);
 			//printNote(errmsg);
 			//for pyGNOME there should only be one uncertainty spill so fLESetSizes has only 1 value which is zero and doesn't need to be updated.
@@ -297,19 +376,7 @@ OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets,
 			if (needToReInit) printNote("Uncertainty arrays are being reset\n");	// this shouldn't happen
 			//if(elapsedTime >= fTimeUncertaintyWasSet + fDuration) // we exceeded the persistance, time to update - either update whole list or just add on
 			// but would also need to update fSigmas - maybe move this section lower
-			for(i=uncertListSize;i<numrec;i++)
-			{
-				rndv(&cosTerm,&sinTerm);
-				for(j=0;j<10;j++)
-				{
-					if(TermsLessThanMax(cosTerm,sinTerm,
-										fMaxSpeed,fMaxAngle,fSigma2,fSigmaTheta))break;
-					rndv(&cosTerm,&sinTerm);
-				}
-				
-				(*fWindUncertaintyList)[i].randCos=cosTerm;
-				(*fWindUncertaintyList)[i].randSin = sinTerm;
-			}
+			this->SetUncertaintyValues(uncertListSize,numrec);
 		}
 	}
 	
@@ -333,7 +400,7 @@ OSErr WindMover_c::UpdateUncertainty(const Seconds& elapsedTime, int numLESets,
 	return err;
 }
 
-OSErr WindMover_c::AddUncertainty(long setIndex, long leIndex,VelocityRec *patVel)
+OSErr WindMover_c::AddUncertainty(long setIndex, LECount leIndex,VelocityRec *patVel)
 {
 	VelocityRec tempV = *patVel;
 	double sqs,m,dtheta,x,w,s,t,costheta,sintheta;
@@ -424,8 +491,10 @@ OSErr WindMover_c::PrepareForModelRun()
 	return noErr;
 }
 
-OSErr WindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, int* LESetsSizesList)
+OSErr WindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds& time_step, bool uncertain, int numLESets, LECount* LESetsSizesList)
 {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerPrepareStep, 0);
 	OSErr err = 0;
 
 	if (bIsFirstStep)
@@ -460,9 +529,29 @@ OSErr WindMover_c::PrepareForModelStep(const Seconds& model_time, const Seconds&
 
 void WindMover_c::ModelStepIsDone()
 {
+	LOCK_MOVER;
 	bIsFirstStep = false;
 }
 
+void WindMover_c::WriteRunState(RunStateWriter &writer)
+{
+	Mover_c::WriteRunState(writer);
+
+	writer.Put(bIsFirstStep);
+	writer.Put(fModelStartTime);
+	writer.PutHandle((Handle)fLESetSizes);
+	writer.PutHandle((Handle)fWindUncertaintyList);
+}
+
+bool WindMover_c::ReadRunState(RunStateReader &reader)
+{
+	return (Mover_c::ReadRunState(reader) &&
+			reader.Get(&bIsFirstStep) &&
+			reader.Get(&fModelStartTime) &&
+			reader.GetHandle((Handle *)&fLESetSizes) &&
+			reader.GetHandle((Handle *)&fWindUncertaintyList));
+}
+
 OSErr WindMover_c::CheckStartTime (Seconds time)
 {
 	OSErr err = 0;
@@ -499,7 +588,9 @@ OSErr WindMover_c::GetTimeValue(const Seconds& current_time, VelocityRec *value)
 // JS 10/8/12: Updated so the input arguments are not char * 
 // NOTE: Some of the input arrays (ref, windages) should be const since you don't want the method to change them;
 // however, haven't gotten const to work well with cython yet so just be careful when changing the input data
-OSErr WindMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+OSErr WindMover_c::get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) {
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
 		
 	// JS Ques: Is this required? Could cy/python invoke this method without well defined numpy arrays?
 	if(!delta || !ref || !windages) {
@@ -520,7 +611,7 @@ OSErr WindMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPo
 
 	WorldPoint3D zero_delta ={0,0,0.};
 
-	for (int i = 0; i < n; i++) {
+	for (LECount i = 0; i < n; i++) {
 
 		// only operate on LE if the status is in water
 		if( LE_status[i] != OILSTAT_INWATER)
@@ -544,7 +635,73 @@ OSErr WindMover_c::get_move(int n, Seconds model_time, Seconds step_len, WorldPo
 	return noErr;
 }
 
-WorldPoint3D WindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType)
+OSErr WindMover_c::get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+								  const double *lat, const double *lon, const double *z,
+								  const double *windages, const short *LE_status,
+								  double *delta_lat, double *delta_lon, double *delta_z,
+								  LEType spillType, long spill_ID)
+{
+	LOCK_MOVER;
+	TIME_SECTION(&fTiming, kTimerGetMove, n);
+	OSErr err;
+
+	if (!lat || !lon || !z || !LE_status || !delta_lat || !delta_lon || !delta_z)
+		return 1;
+
+	if (spillType < FORECAST_LE || spillType > UNCERTAINTY_LE)
+		return 2;
+
+	err = BeginMoveBatch(n, model_time, step_len, lat, lon, z, windages, LE_status, spillType);
+	if (err) return err;
+
+	MoveBatchLEs(n, 0, 0, model_time, step_len, lat, lon, z, windages, LE_status,
+				 delta_lat, delta_lon, delta_z, spillType, spill_ID);
+
+	return noErr;
+}
+
+OSErr WindMover_c::BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+								  const double *lat, const double *lon, const double *z,
+								  const double *windages, const short *LE_status, LEType spillType)
+{
+	// the wind moves the LEs by their windage
+	if (!windages)
+		return 1;
+
+	return noErr;
+}
+
+void WindMover_c::MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+								 const double *lat, const double *lon, const double *z,
+								 const double *windages, const short *LE_status,
+								 double *delta_lat, double *delta_lon, double *delta_z,
+								 LEType spillType, long spill_ID)
+{
+	VelocityRec timeValue;
+
+	for (int k = 0; k < count; k++) {
+		LECount i = index ? index[k] : first + k;
+
+		delta_lat[k] = delta_lon[k] = delta_z[k] = 0.;
+
+		// wind doesn't act below surface
+		if (LE_status[i] != OILSTAT_INWATER || z[i] > 0)
+			continue;
+
+		timeValue = this->current_time_value;	// set in PrepareForModelStep
+
+		if (spillType == UNCERTAINTY_LE)
+			AddUncertainty(spill_ID, i, &timeValue);
+
+		timeValue.u *= windages[i];
+		timeValue.v *= windages[i];
+
+		delta_lon[k] = ((timeValue.u / METERSPERDEGREELAT) * step_len) / LongToLatRatio3(lat[i] * 1000000);
+		delta_lat[k] = (timeValue.v / METERSPERDEGREELAT) * step_len;
+	}
+}
+
+WorldPoint3D WindMover_c::GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType)
 {
 	double 	dLong, dLat;
 	VelocityRec	patVelocity, timeValue = { 0, 0 };
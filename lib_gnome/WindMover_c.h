@@ -13,6 +13,7 @@
 #include "Basics.h"
 #include "TypeDefs.h"
 #include "Mover_c.h"
+#include "CounterRandom.h"
 #include "ExportSymbols.h"
 
 #ifdef pyGNOME
@@ -26,7 +27,7 @@ class TMap;
 class DLL_API WindMover_c : virtual public Mover_c {
 	
 protected:
-	LONGH				fLESetSizes;		// cumulative total num le's in each set
+	LECountH				fLESetSizes;		// cumulative total num le's in each set
 	LEWindUncertainRecH	fWindUncertaintyList;
 	void				Init();	// initializes local variables to defaults - called by constructor
 	
@@ -40,6 +41,9 @@ public:
 	Boolean bIsFirstStep;
 	Seconds fModelStartTime;
 	double fUncertaintyDiffusion;
+	Boolean bUseCounterRandom;		// stateless uncertainty factors keyed on LE and the time they're drawn - reproducible in any LE order
+	long fRandomSeed;				// key for the counter based random numbers
+	LECount fSharedFactorCount;		// LEs of one ensemble member, the members after it reuse its factors. 0 for a draw per LE
 	
 	Boolean fIsConstantWind;
 	VelocityRec fConstantValue;
@@ -67,17 +71,20 @@ public:
 	//virtual ClassID 	GetClassID () { return TYPE_WINDMOVER; }
 	//virtual Boolean		IAm(ClassID id) { if(id==TYPE_WINDMOVER) return TRUE; return Mover_c::IAm(id); }
 	
-	virtual OSErr		AllocateUncertainty (int numLESets, int* LESetsSizesList);
-	virtual OSErr		ReallocateUncertainty(int numLEs, short* statusCodes);	
+	virtual OSErr		AllocateUncertainty (int numLESets, LECount* LESetsSizesList);
+	virtual OSErr		ReallocateUncertainty(LECount numLEs, short* statusCodes);	
 	virtual void		DisposeUncertainty ();
-	virtual OSErr		AddUncertainty(long setIndex,long leIndex,VelocityRec *v);
+	virtual OSErr		AddUncertainty(long setIndex, LECount leIndex,VelocityRec *v);
 	virtual void 		UpdateUncertaintyValues(Seconds elapsedTime);
-	virtual OSErr		UpdateUncertainty(const Seconds& elapsedTime, int numLESets, int* LESetsSizesList);
+	void				SetUncertaintyValues(LECount start, LECount end);
+	virtual OSErr		UpdateUncertainty(const Seconds& elapsedTime, int numLESets, LECount* LESetsSizesList);
 
 	virtual OSErr 		PrepareForModelRun(); 
-	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, int* LESetsSizesList); 
+	virtual OSErr 		PrepareForModelStep(const Seconds&, const Seconds&, bool, int numLESets, LECount* LESetsSizesList); 
 	virtual void		ModelStepIsDone();
-	virtual WorldPoint3D GetMove(const Seconds& model_time, Seconds timeStep,long setIndex,long leIndex,LERec *theLE,LETYPE leType);
+	virtual void		WriteRunState(RunStateWriter &writer);
+	virtual bool		ReadRunState(RunStateReader &reader);
+	virtual WorldPoint3D GetMove(const Seconds& model_time, Seconds timeStep,long setIndex, LECount leIndex,LERec *theLE,LETYPE leType);
 	void				SetTimeDep (TOSSMTimeValue *newTimeDep); 
 	TOSSMTimeValue		*GetTimeDep () { return (timeDep); }
 	void				DeleteTimeDep ();
@@ -85,13 +92,37 @@ public:
 	void				SetIsConstantWind (Boolean isConstantWind) { fIsConstantWind = isConstantWind; }
 	OSErr				GetTimeValue(const Seconds& current_time, VelocityRec *value);
 	OSErr				CheckStartTime(Seconds time);
-	OSErr				get_move(int n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windage, short* LE_status, LEType spillType, long spillID);
+	OSErr				get_move(LECount n, Seconds model_time, Seconds step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windage, short* LE_status, LEType spillType, long spillID);
+	virtual OSErr		get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
+
+	virtual Boolean		CanFuseMove() { return true; }
+	virtual OSErr		BeginMoveBatch(LECount n, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status, LEType spillType);
+	virtual void		MoveBatchLEs(int count, LECount first, const LECount *index, Seconds model_time, Seconds step_len,
+									   const double *lat, const double *lon, const double *z,
+									   const double *windages, const short *LE_status,
+									   double *delta_lat, double *delta_lon, double *delta_z,
+									   LEType spillType, long spill_ID);
 
 	void 				SetExtrapolationInTime(bool extrapolate){fAllowExtrapolationInTime = extrapolate;}
 	bool 				GetExtrapolationInTime(){return fAllowExtrapolationInTime;}
 	
 };
 
+// Draws again the windages of the n LEs whose windage persistence (in seconds) is positive, in
+// place - uniform in the LE's windage range (2 values an LE), the range scaled by
+// sqrt(persistence / timeStep) about its middle so the spread doesn't depend on the time step.
+// Negative persistence keeps the windage for the whole run. The numbers are the counter based
+// ones of key and the LEs' IDs, so any number of threads gives the same windages
+DLL_API void UpdateWindages(const CounterRandomKey &key, LECount n, const uint32_t *leIDs,
+							const double *windageRange, const long *persistence, double timeStep,
+							double *windages, int numThreads);
+
 #undef TOSSMTimeValue
 //#undef TMap
 #endif
@@ -0,0 +1,746 @@
+/*
+ *  GnomeBench.cpp
+ *  gnome
+ *
+ *  Micro benchmarks for the lib_gnome hot paths: the get_move loops of the
+ *  random, wind, CATS and gridded current movers, the three of them fused
+ *  (MoveFused, on all the LEs and on the list of those in water), the DAG
+ *  tree triangle lookup and the gridded ReadTimeData. Each runs for every
+ *  LE count and thread count asked for and prints a row of ms per step and
+ *  throughput, so runs before and after a change can be diffed.
+ *
+ *  Built by "python setup.py build_bench" in py_gnome, with the same macros
+ *  as the extensions (GNOME_OPENMP for the thread counts to mean anything),
+ *  and run from py_gnome as build/bench/gnome_bench.
+ *
+ *  gnome_bench [-les 1000,10000,100000] [-threads 1,2,4] [-steps 24]
+ *              [-scale 100,300] [-wind file.WND] [-cats file.cur]
+ *              [-grid file.nc [-top topology.dat]]
+ *
+ *  -scale is the points on a side of the synthetic grids: a triangle
+ *  lattice for the CATS mover and DAG tree, and a regular netCDF file
+ *  for the gridded current mover and ReadTimeData.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Basics.h"
+#include "TypeDefs.h"
+#include "MemUtils.h"
+#include "DagTree.h"
+#include "TriGridVel_c.h"
+#include "Random_c.h"
+#include "WindMover_c.h"
+#include "CATSMover_c.h"
+#include "GridCurrentMover_c.h"
+#include "TimeGridVel_c.h"
+#include "OSSMTimeValue_c.h"
+#include "netcdf.h"
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+#define kBenchTimeStep	900
+#define kNumFileTimes	25		// hourly times in the synthetic netCDF files
+
+typedef struct {
+	vector<long>	numLEs;
+	vector<int>		numThreads;
+	vector<long>	scales;
+	long			numSteps;
+	string			windPath;
+	string			catsPath;
+	string			gridPath;
+	string			topPath;
+} BenchOptions;
+
+// the LEs of a run, positions in degrees
+typedef struct {
+	vector<WorldPoint3D>	ref;
+	vector<WorldPoint3D>	delta;
+	vector<short>			status;
+	vector<double>			windages;
+} BenchLEs;
+
+static double Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PrintHeader()
+{
+	printf("%-12s %-22s %9s %7s %11s %10s\n", "benchmark", "grid", "LEs", "threads", "ms/step", "MLE/s");
+}
+
+static void PrintRow(const char *bench, const char *grid, long numLEs, int numThreads, double seconds, long numSteps)
+{
+	double msPerStep = seconds * 1000. / numSteps;
+	double leRate = seconds > 0 ? numLEs * (double)numSteps / seconds / 1e6 : 0;
+
+	printf("%-12s %-22s %9ld %7d %11.3f %10.3f\n", bench, grid, numLEs, numThreads, msPerStep, leRate);
+	fflush(stdout);
+}
+
+static void ParseList(const char *arg, vector<long> *values)
+{
+	char *end;
+
+	values->clear();
+	while (*arg) {
+		long value = strtol(arg, &end, 10);
+
+		if (end == arg)
+			break;
+		if (value > 0)
+			values->push_back(value);
+		arg = *end == ',' ? end + 1 : end;
+	}
+}
+
+static const char *BaseName(const string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+
+	return slash == string::npos ? path.c_str() : path.c_str() + slash + 1;
+}
+
+// uniform LEs over the middle of the box, the same for every run of a size
+static void MakeLEs(long numLEs, WorldRect bounds, BenchLEs *les)
+{
+	double loLong = bounds.loLong / 1e6, hiLong = bounds.hiLong / 1e6;
+	double loLat = bounds.loLat / 1e6, hiLat = bounds.hiLat / 1e6;
+	double margin = .05;
+
+	srand(1);
+	les->ref.resize(numLEs);
+	les->delta.resize(numLEs);
+	les->status.assign(numLEs, OILSTAT_INWATER);
+	les->windages.assign(numLEs, .03);
+	for (long i = 0; i < numLEs; i++) {
+		double x = margin + (1 - 2 * margin) * rand() / (double)RAND_MAX;
+		double y = margin + (1 - 2 * margin) * rand() / (double)RAND_MAX;
+
+		les->ref[i].p.pLong = loLong + x * (hiLong - loLong);
+		les->ref[i].p.pLat = loLat + y * (hiLat - loLat);
+		les->ref[i].z = 0;
+	}
+}
+
+static WorldRect DefaultBounds()
+{
+	WorldRect bounds;
+
+	bounds.loLong = -71000000;
+	bounds.hiLong = -70000000;
+	bounds.loLat = 41000000;
+	bounds.hiLat = 42000000;
+	return bounds;
+}
+
+static double LatticeSpeed(double x, double y)
+{
+	return .5 * sin(2 * PI * x) * cos(2 * PI * y);
+}
+
+// triangle lattice over bounds with size points on a side, two triangles a cell,
+// counterclockwise, with a circulating velocity on each triangle
+static TriGridVel_c *MakeTriGrid(long size, WorldRect bounds, char *errmsg)
+{
+	long numPts = size * size, numTri = 2 * (size - 1) * (size - 1);
+	LongPointHdl pts = (LongPointHdl)_NewHandle(numPts * sizeof(LongPoint));
+	TopologyHdl topo = (TopologyHdl)_NewHandle(numTri * sizeof(Topology));
+	VelocityFH velH = (VelocityFH)_NewHandle(numTri * sizeof(VelocityFRec));
+	map<pair<long, long>, long> edges;
+	DAGTreeStruct tree;
+	TDagTree *dagTree = 0;
+	TriGridVel_c *triGrid = 0;
+	long t = 0;
+
+	errmsg[0] = 0;
+	if (!pts || !topo || !velH) {
+		strcpy(errmsg, "Not enough memory for the triangle grid");
+		goto done;
+	}
+
+	for (long j = 0; j < size; j++) {
+		for (long i = 0; i < size; i++) {
+			INDEXH(pts, j * size + i).h = bounds.loLong + (long)((bounds.hiLong - bounds.loLong) * (double)i / (size - 1));
+			INDEXH(pts, j * size + i).v = bounds.loLat + (long)((bounds.hiLat - bounds.loLat) * (double)j / (size - 1));
+		}
+	}
+
+	for (long j = 0; j < size - 1; j++) {
+		for (long i = 0; i < size - 1; i++) {
+			long p00 = j * size + i, p10 = p00 + 1, p01 = p00 + size, p11 = p01 + 1;
+			long corners[2][3] = {{p00, p10, p11}, {p00, p11, p01}};
+
+			for (long k = 0; k < 2; k++, t++) {
+				double x = (i + .5) / (size - 1), y = (j + .5) / (size - 1);
+
+				INDEXH(topo, t).vertex1 = corners[k][0];
+				INDEXH(topo, t).vertex2 = corners[k][1];
+				INDEXH(topo, t).vertex3 = corners[k][2];
+				INDEXH(velH, t).u = LatticeSpeed(y, x);
+				INDEXH(velH, t).v = -LatticeSpeed(x, y);
+			}
+		}
+	}
+
+	// adjTriN is the triangle across the edge opposite vertexN
+	for (t = 0; t < numTri; t++) {
+		long v[3] = {INDEXH(topo, t).vertex1, INDEXH(topo, t).vertex2, INDEXH(topo, t).vertex3};
+
+		for (long k = 0; k < 3; k++) {
+			long a = v[(k + 1) % 3], b = v[(k + 2) % 3];
+
+			edges[pair<long, long>(a, b)] = t;
+		}
+	}
+	for (t = 0; t < numTri; t++) {
+		long v[3] = {INDEXH(topo, t).vertex1, INDEXH(topo, t).vertex2, INDEXH(topo, t).vertex3};
+		long adj[3];
+
+		for (long k = 0; k < 3; k++) {
+			map<pair<long, long>, long>::iterator it = edges.find(pair<long, long>(v[(k + 2) % 3], v[(k + 1) % 3]));
+
+			adj[k] = it == edges.end() ? -1 : it->second;
+		}
+		INDEXH(topo, t).adjTri1 = adj[0];
+		INDEXH(topo, t).adjTri2 = adj[1];
+		INDEXH(topo, t).adjTri3 = adj[2];
+	}
+
+	tree = MakeDagTree(topo, (LongPoint**)pts, errmsg);
+	if (errmsg[0] || !tree.treeHdl)
+		goto done;
+
+	dagTree = new TDagTree(pts, topo, tree.treeHdl, velH, tree.numBranches);
+	triGrid = new TriGridVel_c;
+	triGrid->SetBounds(bounds);
+	triGrid->SetDagTree(dagTree);
+	pts = 0;	// the grid owns these now
+	topo = 0;
+	velH = 0;
+
+done:
+	if (pts) _DisposeHandle((Handle)pts);
+	if (topo) _DisposeHandle((Handle)topo);
+	if (velH) _DisposeHandle((Handle)velH);
+	return triGrid;
+}
+
+#define CHECK_NC(status) if ((status) != NC_NOERR) goto done
+
+// regular lat/lon netCDF file with kNumFileTimes hourly currents that drift through the cells
+static OSErr WriteRegularGridFile(const char *path, long size, WorldRect bounds)
+{
+	int ncid = -1, timeDim, latDim, lonDim, timeVar, latVar, lonVar, uVar, vVar, dims[3];
+	double fillValue = -99999;
+	vector<double> values(size);
+	vector<float> u(size * size), v(size * size);
+	OSErr err = -1;
+
+	CHECK_NC(nc_create(path, NC_CLOBBER, &ncid));
+	CHECK_NC(nc_def_dim(ncid, "time", NC_UNLIMITED, &timeDim));
+	CHECK_NC(nc_def_dim(ncid, "lat", size, &latDim));
+	CHECK_NC(nc_def_dim(ncid, "lon", size, &lonDim));
+	CHECK_NC(nc_def_var(ncid, "time", NC_DOUBLE, 1, &timeDim, &timeVar));
+	CHECK_NC(nc_put_att_text(ncid, timeVar, "units", strlen("hours since 2000-01-01 00:00:00"), "hours since 2000-01-01 00:00:00"));
+	CHECK_NC(nc_def_var(ncid, "lat", NC_DOUBLE, 1, &latDim, &latVar));
+	CHECK_NC(nc_def_var(ncid, "lon", NC_DOUBLE, 1, &lonDim, &lonVar));
+	dims[0] = timeDim;
+	dims[1] = latDim;
+	dims[2] = lonDim;
+	CHECK_NC(nc_def_var(ncid, "water_u", NC_FLOAT, 3, dims, &uVar));
+	CHECK_NC(nc_def_var(ncid, "water_v", NC_FLOAT, 3, dims, &vVar));
+	CHECK_NC(nc_put_att_text(ncid, uVar, "units", 3, "m/s"));
+	CHECK_NC(nc_put_att_text(ncid, vVar, "units", 3, "m/s"));
+	CHECK_NC(nc_put_att_double(ncid, uVar, "_FillValue", NC_DOUBLE, 1, &fillValue));
+	CHECK_NC(nc_put_att_double(ncid, vVar, "_FillValue", NC_DOUBLE, 1, &fillValue));
+	CHECK_NC(nc_enddef(ncid));
+
+	for (long i = 0; i < size; i++)
+		values[i] = (bounds.loLat + (bounds.hiLat - bounds.loLat) * (double)i / (size - 1)) / 1e6;
+	CHECK_NC(nc_put_var_double(ncid, latVar, &values[0]));
+	for (long i = 0; i < size; i++)
+		values[i] = (bounds.loLong + (bounds.hiLong - bounds.loLong) * (double)i / (size - 1)) / 1e6;
+	CHECK_NC(nc_put_var_double(ncid, lonVar, &values[0]));
+
+	for (long k = 0; k < kNumFileTimes; k++) {
+		size_t start[3] = {(size_t)k, 0, 0}, count[3] = {1, (size_t)size, (size_t)size}, index = k;
+		double hours = k, phase = k / (double)kNumFileTimes;
+
+		CHECK_NC(nc_put_var1_double(ncid, timeVar, &index, &hours));
+		for (long j = 0; j < size; j++) {
+			for (long i = 0; i < size; i++) {
+				double x = i / (double)(size - 1) + phase, y = j / (double)(size - 1);
+
+				u[j * size + i] = LatticeSpeed(y, x);
+				v[j * size + i] = -LatticeSpeed(x, y);
+			}
+		}
+		CHECK_NC(nc_put_vara_float(ncid, uVar, start, count, &u[0]));
+		CHECK_NC(nc_put_vara_float(ncid, vVar, start, count, &v[0]));
+	}
+	err = 0;
+
+done:
+	if (ncid >= 0 && nc_close(ncid) != NC_NOERR)
+		err = -1;
+	return err;
+}
+
+static void BenchRandom(const BenchOptions &opts)
+{
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		int sizes[1] = {(int)numLEs};
+
+		MakeLEs(numLEs, DefaultBounds(), &les);
+		for (size_t t = 0; t < opts.numThreads.size(); t++) {
+			Random_c mover;
+			double start, seconds = 0;
+
+			mover.fDiffusionCoefficient = 100000;
+			mover.bUseCounterRandom = true;	// the threaded loop needs it, set it for every run so they compare
+			mover.SetNumThreads(opts.numThreads[t]);
+			for (long step = 0; step < opts.numSteps; step++) {
+				Seconds modelTime = step * kBenchTimeStep;
+
+				start = Now();
+				mover.PrepareForModelStep(modelTime, kBenchTimeStep, false, 1, sizes);
+				mover.get_move(numLEs, modelTime, kBenchTimeStep, &les.ref[0], &les.delta[0], &les.status[0], FORECAST_LE, 0);
+				mover.ModelStepIsDone();
+				seconds += Now() - start;
+			}
+			PrintRow("random", "-", numLEs, opts.numThreads[t], seconds, opts.numSteps);
+		}
+	}
+}
+
+static void BenchWind(const BenchOptions &opts)
+{
+	char path[256];
+	Seconds startTime = 0;
+	OSSMTimeValue_c *timeDep = 0;
+
+	if (!opts.windPath.empty()) {
+		strncpy(path, opts.windPath.c_str(), 255);
+		path[255] = 0;
+		timeDep = new OSSMTimeValue_c();
+		if (timeDep->ReadTimeValues(path, M19MAGNITUDEDIRECTION, -1) || timeDep->GetDataStartTime(&startTime)) {
+			fprintf(stderr, "could not read the wind file %s, using a constant wind\n", path);
+			delete timeDep;
+			timeDep = 0;
+		}
+	}
+
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		int sizes[1] = {(int)numLEs};
+
+		MakeLEs(numLEs, DefaultBounds(), &les);
+		for (size_t t = 0; t < opts.numThreads.size(); t++) {
+			WindMover_c mover;
+			double start, seconds = 0;
+
+			if (timeDep) {
+				mover.SetTimeDep(timeDep);
+				mover.SetIsConstantWind(false);
+			}
+			else {
+				mover.SetIsConstantWind(true);
+				mover.fConstantValue.u = 5;
+				mover.fConstantValue.v = 5;
+			}
+			mover.SetNumThreads(opts.numThreads[t]);
+			for (long step = 0; step < opts.numSteps; step++) {
+				Seconds modelTime = startTime + step * kBenchTimeStep;
+
+				start = Now();
+				mover.PrepareForModelStep(modelTime, kBenchTimeStep, false, 1, sizes);
+				mover.get_move(numLEs, modelTime, kBenchTimeStep, &les.ref[0], &les.delta[0], &les.windages[0], &les.status[0], FORECAST_LE, 0);
+				mover.ModelStepIsDone();
+				seconds += Now() - start;
+			}
+			mover.SetTimeDep(0);	// shared between the runs
+			PrintRow("wind", timeDep ? BaseName(opts.windPath) : "constant", numLEs, opts.numThreads[t], seconds, opts.numSteps);
+		}
+	}
+
+	if (timeDep)
+		delete timeDep;
+}
+
+static void BenchCATS(const BenchOptions &opts, CATSMover_c *mover, const char *gridName)
+{
+	WorldRect bounds = mover->GetGridBounds();
+	WorldPoint3D refPt;
+
+	refPt.p.pLong = (bounds.loLong + bounds.hiLong) / 2e6;
+	refPt.p.pLat = (bounds.loLat + bounds.hiLat) / 2e6;
+	refPt.z = 0;
+	mover->SetRefPosition(refPt);
+
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		int sizes[1] = {(int)numLEs};
+
+		MakeLEs(numLEs, bounds, &les);
+		for (size_t t = 0; t < opts.numThreads.size(); t++) {
+			double start, seconds = 0;
+
+			mover->SetNumThreads(opts.numThreads[t]);
+			for (long step = 0; step < opts.numSteps; step++) {
+				Seconds modelTime = step * kBenchTimeStep;
+
+				start = Now();
+				mover->PrepareForModelStep(modelTime, kBenchTimeStep, false, 1, sizes);
+				mover->get_move(numLEs, modelTime, kBenchTimeStep, &les.ref[0], &les.delta[0], &les.status[0], FORECAST_LE, 0);
+				mover->ModelStepIsDone();
+				seconds += Now() - start;
+			}
+			PrintRow("cats", gridName, numLEs, opts.numThreads[t], seconds, opts.numSteps);
+		}
+	}
+}
+
+// the random, wind and CATS movers moving the same LEs, with a get_move_batch per mover, with MoveFused
+// and with MoveFused on the active list, which have to come to the same positions. Only every
+// inWaterEvery'th LE is in water, the others are beached
+static void BenchFused(const BenchOptions &opts, CATSMover_c *cats, const char *gridName, long inWaterEvery)
+{
+	WorldRect bounds = cats->GetGridBounds();
+	char name[64];
+	static const char *runNames[3] = {"separate", "fused", "fused+act"};
+
+	if (inWaterEvery > 1)
+		sprintf(name, "%s 1/%ld", gridName, inWaterEvery);
+	else
+		sprintf(name, "%s", gridName);
+
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		int sizes[1] = {(int)numLEs};
+		vector<double> lat(numLEs), lon(numLEs), z(numLEs), delta(3 * numLEs);
+		vector<double> next[3];
+		vector<int> active;
+
+		MakeLEs(numLEs, bounds, &les);
+		for (long i = 0; i < numLEs; i++) {
+			lat[i] = les.ref[i].p.pLat;
+			lon[i] = les.ref[i].p.pLong;
+			z[i] = les.ref[i].z;
+			if (i % inWaterEvery == 0)
+				active.push_back(i);
+			else
+				les.status[i] = OILSTAT_ONLAND;
+		}
+
+		for (int run = 0; run < 3; run++) {
+			Random_c random;
+			WindMover_c wind;
+			Mover_c *movers[3] = {&random, &wind, cats};
+			double *windages[3] = {0, &les.windages[0], 0};
+			double start, seconds = 0;
+
+			random.fDiffusionCoefficient = 100000;
+			random.bUseCounterRandom = true;	// the same random numbers in every run
+			wind.SetIsConstantWind(true);
+			wind.fConstantValue.u = 5;
+			wind.fConstantValue.v = 5;
+			for (long step = 0; step < opts.numSteps; step++) {
+				Seconds modelTime = step * kBenchTimeStep;
+
+				next[run].assign(lat.begin(), lat.end());
+				next[run].insert(next[run].end(), lon.begin(), lon.end());
+				next[run].insert(next[run].end(), z.begin(), z.end());
+
+				start = Now();
+				for (int m = 0; m < 3; m++)
+					movers[m]->PrepareForModelStep(modelTime, kBenchTimeStep, false, 1, sizes);
+				if (run == 0) {
+					for (int m = 0; m < 3; m++) {
+						movers[m]->get_move_batch(numLEs, modelTime, kBenchTimeStep, &lat[0], &lon[0], &z[0], windages[m],
+												  &les.status[0], &delta[0], &delta[numLEs], &delta[2 * numLEs], FORECAST_LE, 0);
+						for (long i = 0; i < 3 * numLEs; i++)
+							next[0][i] += delta[i];
+					}
+				}
+				else
+					MoveFused(3, movers, windages, numLEs, active.size(), run == 2 ? &active[0] : 0,
+							  modelTime, kBenchTimeStep, &lat[0], &lon[0], &z[0], &les.status[0],
+							  &next[run][0], &next[run][numLEs], &next[run][2 * numLEs], FORECAST_LE, 0);
+				for (int m = 0; m < 3; m++)
+					movers[m]->ModelStepIsDone();
+				seconds += Now() - start;
+			}
+			PrintRow(runNames[run], name, numLEs, 1, seconds, opts.numSteps);
+		}
+
+		if (next[0] != next[1] || next[0] != next[2])
+			fprintf(stderr, "%s %ld LEs: the fused moves differ from the separate ones\n", name, numLEs);
+	}
+}
+
+// lookups of LEs that drift a little between passes, cold and with each LE's last triangle as the hint
+static void BenchDagTree(const BenchOptions &opts, TriGridVel_c *triGrid, const char *gridName)
+{
+	TDagTree *dagTree = triGrid->GetDagTree();
+	WorldRect bounds = triGrid->GetBounds();
+	const char *modes[4] = {"dag", "dag+hint", "packed+hint", "buckets+hint"};
+
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		vector<LongPoint> pts(numLEs);
+		double drift = (bounds.hiLong - bounds.loLong) * 1e-4;
+
+		MakeLEs(numLEs, bounds, &les);
+		for (long mode = 0; mode < 4; mode++) {
+			vector<long> hints(numLEs, -1);
+			double start, seconds = 0;
+			long found = 0;
+
+			dagTree->SetUsePackedTree(mode == 2);
+			dagTree->SetUseBucketIndex(mode == 3);
+			for (long step = 0; step < opts.numSteps; step++) {
+				for (long i = 0; i < numLEs; i++) {
+					pts[i].h = (long)(les.ref[i].p.pLong * 1e6 + drift * sin(step + i));
+					pts[i].v = (long)(les.ref[i].p.pLat * 1e6 + drift * cos(step + i));
+				}
+				start = Now();
+				for (long i = 0; i < numLEs; i++) {
+					long tri = mode == 0 ? dagTree->WhatTriAmIIn(pts[i]) : dagTree->WhatTriAmIIn(pts[i], &hints[i]);
+
+					if (tri >= 0) found++;
+				}
+				seconds += Now() - start;
+			}
+			if (found < numLEs * opts.numSteps)
+				fprintf(stderr, "%s: %ld of %ld lookups fell outside the grid\n", modes[mode], numLEs * opts.numSteps - found, numLEs * opts.numSteps);
+			PrintRow(modes[mode], gridName, numLEs, 1, seconds, opts.numSteps);
+		}
+		dagTree->SetUsePackedTree(false);
+		dagTree->SetUseBucketIndex(false);
+	}
+}
+
+static void BenchGridCurrent(const BenchOptions &opts, GridCurrentMover_c *mover, const char *gridName)
+{
+	WorldRect bounds = mover->GetGridBounds();
+	Seconds startTime = 0;
+
+	mover->GetDataStartTime(&startTime);
+	for (size_t n = 0; n < opts.numLEs.size(); n++) {
+		BenchLEs les;
+		long numLEs = opts.numLEs[n];
+		int sizes[1] = {(int)numLEs};
+
+		MakeLEs(numLEs, bounds, &les);
+		for (size_t t = 0; t < opts.numThreads.size(); t++) {
+			double start, seconds = 0;
+			OSErr err = 0;
+
+			mover->timeGrid->DisposeAllLoadedData();	// every run reads its own times
+			mover->SetNumThreads(opts.numThreads[t]);
+			for (long step = 0; step < opts.numSteps && !err; step++) {
+				Seconds modelTime = startTime + step * kBenchTimeStep;
+
+				start = Now();
+				err = mover->PrepareForModelStep(modelTime, kBenchTimeStep, false, 1, sizes);
+				if (!err)
+					err = mover->get_move(numLEs, modelTime, kBenchTimeStep, &les.ref[0], &les.delta[0], &les.status[0], FORECAST_LE, 0);
+				mover->ModelStepIsDone();
+				seconds += Now() - start;
+			}
+			if (err)
+				fprintf(stderr, "%s: stopped on error %d\n", gridName, err);
+			PrintRow("gridcurrent", gridName, numLEs, opts.numThreads[t], seconds, opts.numSteps);
+		}
+	}
+}
+
+static void BenchReadTimeData(TimeGridVel *timeGrid, const char *gridName)
+{
+	long numTimes = timeGrid->GetNumTimesInFile();
+	long numReads = numTimes < 10 ? 10 : numTimes;
+	double start, seconds = 0, numBytes = 0;
+	char errmsg[256];
+
+	for (long i = 0; i < numReads; i++) {
+		VelocityFH velocityH = 0;
+		OSErr err;
+
+		start = Now();
+		err = timeGrid->ReadTimeData(i % numTimes, &velocityH, errmsg);
+		seconds += Now() - start;
+		if (err) {
+			fprintf(stderr, "%s: ReadTimeData failed: %s\n", gridName, errmsg);
+			return;
+		}
+		if (velocityH) {
+			numBytes += _GetHandleSize((Handle)velocityH);
+			_DisposeHandle((Handle)velocityH);
+		}
+	}
+	printf("%-12s %-22s %9ld %7d %11.3f %10.3f MB/s\n", "read_data", gridName, numReads, 1, seconds * 1000. / numReads, seconds > 0 ? numBytes / seconds / 1e6 : 0);
+	fflush(stdout);
+}
+
+static void RunGridFile(const BenchOptions &opts, const string &path, const string &topPath, const char *gridName)
+{
+	GridCurrentMover_c *mover = new GridCurrentMover_c();
+	char filePath[256], topFilePath[256];
+	OSErr err;
+
+	strncpy(filePath, path.c_str(), 255);
+	filePath[255] = 0;
+	strncpy(topFilePath, topPath.c_str(), 255);
+	topFilePath[255] = 0;
+
+	err = mover->TextRead(filePath, topFilePath);
+	if (err || !mover->timeGrid) {
+		fprintf(stderr, "could not read the grid file %s\n", filePath);
+		delete mover;
+		return;
+	}
+
+	BenchReadTimeData(mover->timeGrid, gridName);
+	BenchGridCurrent(opts, mover, gridName);
+	delete mover;
+}
+
+static void RunCATSFile(const BenchOptions &opts)
+{
+	CATSMover_c *mover = new CATSMover_c();
+	char path[256];
+
+	strncpy(path, opts.catsPath.c_str(), 255);
+	path[255] = 0;
+	if (mover->TextRead(path) || !mover->fGrid) {
+		fprintf(stderr, "could not read the CATS file %s\n", path);
+		delete mover;
+		return;
+	}
+
+	BenchCATS(opts, mover, BaseName(opts.catsPath));
+	if (dynamic_cast<TriGridVel_c*>(mover->fGrid))
+		BenchDagTree(opts, dynamic_cast<TriGridVel_c*>(mover->fGrid), BaseName(opts.catsPath));
+	delete mover;
+}
+
+static void RunSynthetic(const BenchOptions &opts)
+{
+	for (size_t s = 0; s < opts.scales.size(); s++) {
+		long size = opts.scales[s];
+		char gridName[64], errmsg[256], path[256];
+		CATSMover_c *cats = new CATSMover_c();
+		TriGridVel_c *triGrid;
+
+		if (size < 2)
+			continue;
+
+		sprintf(gridName, "tri %ldx%ld", size, size);
+		triGrid = MakeTriGrid(size, DefaultBounds(), errmsg);
+		if (!triGrid) {
+			fprintf(stderr, "%s: %s\n", gridName, errmsg[0] ? errmsg : "could not make the grid");
+			delete cats;
+			continue;
+		}
+		cats->fGrid = triGrid;
+		BenchCATS(opts, cats, gridName);
+		BenchFused(opts, cats, gridName, 1);
+		BenchFused(opts, cats, gridName, 4);
+		BenchDagTree(opts, triGrid, gridName);
+		delete cats;
+
+		sprintf(gridName, "rect %ldx%ld", size, size);
+		sprintf(path, "gnome_bench_%ld.nc", size);
+		if (WriteRegularGridFile(path, size, DefaultBounds())) {
+			fprintf(stderr, "%s: could not write %s\n", gridName, path);
+			continue;
+		}
+		RunGridFile(opts, path, "", gridName);
+		remove(path);
+	}
+}
+
+static void Usage()
+{
+	fprintf(stderr, "gnome_bench [-les 1000,10000,100000] [-threads 1,2,4] [-steps 24] [-scale 100,300]\n"
+			"            [-wind file.WND] [-cats file.cur] [-grid file.nc [-top topology.dat]]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	BenchOptions opts;
+	vector<long> values;
+
+	ParseList("1000,10000,100000", &opts.numLEs);
+	ParseList("1,2,4", &values);
+	opts.numThreads.assign(values.begin(), values.end());
+	ParseList("100,300", &opts.scales);
+	opts.numSteps = 24;
+	opts.windPath = "tests/unit_tests/sample_data/WindDataFromGnome.WND";	// run from py_gnome
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+
+		if (i + 1 >= argc) {
+			Usage();
+			return 1;
+		}
+		if (arg == "-les")
+			ParseList(argv[++i], &opts.numLEs);
+		else if (arg == "-threads") {
+			ParseList(argv[++i], &values);
+			opts.numThreads.assign(values.begin(), values.end());
+		}
+		else if (arg == "-steps") {
+			opts.numSteps = atol(argv[++i]);
+			if (opts.numSteps < 1)
+				opts.numSteps = 1;
+		}
+		else if (arg == "-scale")
+			ParseList(argv[++i], &opts.scales);
+		else if (arg == "-wind")
+			opts.windPath = argv[++i];
+		else if (arg == "-cats")
+			opts.catsPath = argv[++i];
+		else if (arg == "-grid")
+			opts.gridPath = argv[++i];
+		else if (arg == "-top")
+			opts.topPath = argv[++i];
+		else {
+			Usage();
+			return 1;
+		}
+	}
+
+	PrintHeader();
+	BenchRandom(opts);
+	BenchWind(opts);
+	if (!opts.catsPath.empty())
+		RunCATSFile(opts);
+	if (!opts.gridPath.empty())
+		RunGridFile(opts, opts.gridPath, opts.topPath, BaseName(opts.gridPath));
+	RunSynthetic(opts);
+
+	return 0;
+}
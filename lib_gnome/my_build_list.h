@@ -32,6 +32,7 @@ typedef struct Side_List
 
 Boolean maketriangles(TopologyHdl *topoHdl, LongPointHdl ptsH, long nv, LONGH boundarySegs, long nbounds); 
 Boolean maketriangles2(TopologyHdl *topoHdl, LongPointHdl ptsH, long nv, LONGH boundarySegs, long nbounds, LONGH ptrVerdatToNetCDFH, long numCols_ext); 
+Boolean maketrianglesDelaunay(TopologyHdl *topoHdl, LongPointHdl ptsH, long nv, LONGH boundarySegs, long nbounds); 
 //////////////////////////////////////////////////////////////////////////
 //																								//
 // CJ Beegle-Krause																		//
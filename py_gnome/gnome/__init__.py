@@ -72,21 +72,21 @@ def _valid_units(unit_name):
                                 uc.ConvertDataUnits[unit_name].values()]))
     return tuple(_valid_units)
 
-# we have a sort of chicken-egg situation here.  The above functions need
-# to be defined before we can import these modules.
-from . import (map, environment,
-               model, multi_model_broadcast,
-               spill_container, spill,
-               movers, outputters)
-
-__all__ = [GnomeId,
-           map,
-           spill,
-           spill_container,
-           movers,
-           environment,
-           model,
-           outputters,
-           initialize_log,
-           AddLogger,
-           multi_model_broadcast]
+# the modules are imported the first time they are used: importing gnome
+# doesn't import all of them, with the cython extensions, netCDF4 and py_gd.
+# So gnome.model, gnome.movers and so forth work without importing them.
+from gnome.utilities.lazy_import import lazy_package
+
+__all__ = ['GnomeId',
+           'map',
+           'spill',
+           'spill_container',
+           'movers',
+           'environment',
+           'model',
+           'outputters',
+           'initialize_log',
+           'AddLogger',
+           'multi_model_broadcast']
+
+lazy_package(__name__)
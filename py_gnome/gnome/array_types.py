@@ -123,6 +123,38 @@ class ArrayType(AddLogger):
         shape = value.shape if self.shape is None else self.shape
         return self.initialize(num, shape, value)
 
+    def split_elements(self, values, nums):
+        '''
+        split_element of many LEs at once, into equal parts
+
+        :param values: the values of the LEs that are split
+        :param nums: the number of LEs each is split into, at least 2
+        :returns: the value of each LE kept, and of the new ones: nums - 1
+            of them for each LE, in order
+        '''
+        return values, np.repeat(values, nums - 1, axis=0)
+
+    def merge_elements(self, values, weights, starts):
+        '''
+        define how the LEs of a super-particle are merged into one for
+        specified ArrayType, the inverse of split_element: the weighted
+        mean of floating point values, the value of the first LE of others
+
+        :param values: the values of the LEs, the ones merged together next
+            to each other
+        :param weights: their weights, the LEs' masses, all positive
+        :param starts: the index of the first LE of each super-particle
+        :returns: the value of each super-particle
+        '''
+        if not np.issubdtype(values.dtype, np.floating):
+            return values[starts]
+
+        weights = weights.reshape((-1,) + (1,) * (values.ndim - 1))
+        total = np.add.reduceat(weights, starts, axis=0)
+
+        return (np.add.reduceat(values * weights, starts, axis=0) /
+                total).astype(values.dtype)
+
     def __eq__(self, other):
         if not isinstance(other, self.__class__):
             return False
@@ -176,6 +208,12 @@ class IdArrayType(ArrayType):
 
         return arr
 
+    def merge_elements(self, values, weights, starts):
+        '''
+        a super-particle keeps the id of its first LE
+        '''
+        return values[starts]
+
 
 class ArrayTypeDivideOnSplit(ArrayType):
     def split_element(self, num, value, l_frac=None):
@@ -218,6 +256,20 @@ class ArrayTypeDivideOnSplit(ArrayType):
             else:
                 return split * l_frac
 
+    def split_elements(self, values, nums):
+        '''
+        the values are divided evenly between the parts of each LE
+        '''
+        values = values / nums.reshape((-1,) + (1,) * (values.ndim - 1))
+
+        return values, np.repeat(values, nums - 1, axis=0)
+
+    def merge_elements(self, values, weights, starts):
+        '''
+        a super-particle has the sum of the values of its LEs
+        '''
+        return np.add.reduceat(values, starts, axis=0)
+
 
 # SpillContainer manipulates initial_value property to initialize 'spill_num'
 # and 'element_id' properly. Referencing global ArrayType objects for this
@@ -258,6 +310,9 @@ _default_values = {'positions': ((3,), world_point_type, 'positions',
                    # by langmuir. Objects should only use 'area' array, but
                    # keep 'fay_area' and 'frac_coverage' for diagnostics
                    'fay_area': ((), np.float64, 'fay_area', 0),
+                   # the blob of LEs released together each LE is in, numbered
+                   # as they're released; -1 is not yet numbered
+                   'blob_num': ((), np.int32, 'blob_num', -1),
                    'area': ((), np.float64, 'area', 0),
                    'frac_coverage': ((), np.float64, 'frac_coverage', 1.0),
 
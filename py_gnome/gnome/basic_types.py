@@ -72,7 +72,9 @@ fate = enum(non_weather=1,
             )
 
 numerical_methods = enum(euler=0,
-                         rk4=1)
+                         rk4=1,
+                         adaptive=2,
+                         trapezoid=3)
 
 # ----------------------------------------------------------------
 # Mirror C++ structures, following are used by cython code
@@ -37,10 +37,12 @@ cdef extern from "CATSMover_c.h":
         void            SetRefPosition(WorldPoint3D p)
         WorldPoint3D    GetRefPosition()
         OSErr    InitMover()
+        void     SetModelStepTimes(Seconds startTime, Seconds timeStep,
+                                   long numSteps)
 
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len,
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len,
                        WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status,
-                       LEType spillType, long spillID)
+                       LEType spillType, long spillID) nogil
         void  SetTimeDep(OSSMTimeValue_c *ossm)
         LongPointHdl  GetPointsHdl()
         WORLDPOINTH  GetWorldPointsHdl()
@@ -72,7 +74,7 @@ cdef extern from "ComponentMover_c.h":
         void            SetRefPosition(WorldPoint3D p)
         WorldPoint3D    GetRefPosition()
 
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID) nogil
         void  SetTimeFile(OSSMTimeValue_c *ossm)    
 
 
@@ -92,17 +94,37 @@ cdef extern from "GridCurrentMover_c.h":
         Boolean fIsOptimizedForStep
         Boolean fAllowVerticalExtrapolationOfCurrents
         int num_method
+        double fMaxCourant
+        long fMaxSubsteps
 
         GridCurrentMover_c ()
         WorldPoint3D    GetMove(Seconds&,Seconds&,Seconds&,Seconds&, long, long, LERec *, LETYPE)
-        OSErr           get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)
+        OSErr           get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID) nogil
+        OSErr           GetCourantNumbers(LECount n, Seconds model_time, Seconds step_len, double *lat, double *lon, double *z, short *LE_status, double *courant) nogil
         void            SetTimeGrid(TimeGridVel_c *newTimeGrid)
         OSErr           TextRead(char *path,char *topFilePath)
         OSErr           ExportTopology(char *topFilePath)
+        OSErr           WriteForcingFile(const char *path, char *errmsg)
+        OSErr           LoadInterval(const Seconds &model_time, char *errmsg)
         void            SetExtrapolationInTime(bool extrapolate)
         bool            GetExtrapolationInTime()
         void            SetTimeShift(long timeShift)
         long            GetTimeShift()
+        void            SetActiveWindowMode(bool useWindow, long halo)
+        bool            GetActiveWindowMode()
+        bool            SetActiveWindowBounds(const WorldRect &bounds)
+        void            SetPrefetch(bool prefetch)
+        bool            GetPrefetch()
+        void            SetSinglePrecision(bool singlePrecision)
+        bool            GetSinglePrecision()
+        void            SetInterpolatedFieldMode(bool useField)
+        bool            GetInterpolatedFieldMode()
+        void            SetCellBinningMode(bool binByCell)
+        bool            GetCellBinningMode()
+        void            SetWaterNodeLayout(bool waterNodes)
+        bool            GetWaterNodeLayout()
+        void            SetNearestNodeMode(bool nearestNode)
+        bool            GetNearestNodeMode()
         OSErr           GetDataStartTime(Seconds *startTime)
         OSErr           GetDataEndTime(Seconds *endTime)
         OSErr  			GetScaledVelocities(Seconds time, VelocityFRec *velocity)
@@ -129,6 +151,8 @@ cdef extern from "IceMover_c.h":
         OSErr  GetIceFields(Seconds time, double *fraction, double *thickness)
         OSErr  GetIceVelocities(Seconds time, VelocityFRec *ice_velocity)
         OSErr  GetMovementVelocities(Seconds time, VelocityFRec *ice_velocity)
+        void   SetMovementFieldMode(bool useField)
+        bool   GetMovementFieldMode()
 
 cdef extern from "CurrentCycleMover_c.h":
 
@@ -140,7 +164,7 @@ cdef extern from "CurrentCycleMover_c.h":
 
         CurrentCycleMover_c ()
         WorldPoint3D    GetMove(Seconds&,Seconds&,Seconds&,Seconds&, long, long, LERec *, LETYPE)
-        #OSErr             get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)
+        #OSErr             get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)
         #void             SetTimeGrid(TimeGridVel_c *newTimeGrid)
         #OSErr           TextRead(char *path,char *topFilePath)
         #OSErr           ExportTopology(char *topFilePath)
@@ -40,7 +40,9 @@ oil_status = enum(not_released=OILSTAT_NOTRELEASED,
                   to_be_removed=OILSTAT_TO_BE_REMOVED)
 
 numerical_methods = enum(euler=EULER,
-                         rk4=RK4)
+                         rk4=RK4,
+                         adaptive=ADAPTIVE,
+                         trapezoid=TRAPEZOID)
 
 """
 disperse status as an enum type
@@ -14,6 +14,7 @@ from gnome import basic_types
 from gnome.cy_gnome.cy_ossm_time cimport CyOSSMTime
 from gnome.cy_gnome.cy_shio_time cimport CyShioTime
 from gnome.cy_gnome.cy_helpers import filename_as_bytes
+from gnome.cy_gnome.cy_helpers cimport handle_array
 
 """
 Dynamic casts are not currently supported in Cython - define it here instead.
@@ -113,6 +114,48 @@ cdef class CyCatsMover(CyCurrentMover):
         def __get__(self):
             return self.cats.refScale
 
+    property bucket_index:
+        """
+        find the LEs' triangles through a uniform grid of buckets, falling
+        back to the DAG tree. Set after text_read.
+        """
+        def __get__(self):
+            if self.cats.fGrid == NULL:
+                return False
+            return self.cats.fGrid.UsesBucketIndex()
+
+        def __set__(self, value):
+            cdef OSErr err
+
+            if self.cats.fGrid == NULL:
+                raise ValueError('CATSMover.bucket_index needs the grid, '
+                                 'call text_read(..) first')
+            err = self.cats.fGrid.SetUseBucketIndex(value)
+            if err:
+                raise ValueError('CATSMover.bucket_index could not build '
+                                 'the index. OSErr: {0}'.format(err))
+
+    property packed_dag_tree:
+        """
+        descend a packed, breadth first copy of the DAG tree when finding
+        the LEs' triangles. Set after text_read.
+        """
+        def __get__(self):
+            if self.cats.fGrid == NULL:
+                return False
+            return self.cats.fGrid.UsesPackedDagTree()
+
+        def __set__(self, value):
+            cdef OSErr err
+
+            if self.cats.fGrid == NULL:
+                raise ValueError('CATSMover.packed_dag_tree needs the grid, '
+                                 'call text_read(..) first')
+            err = self.cats.fGrid.SetUsePackedDagTree(value)
+            if err:
+                raise ValueError('CATSMover.packed_dag_tree could not pack '
+                                 'the tree. OSErr: {0}'.format(err))
+
     property ref_point:
         def __get__(self):
             """
@@ -239,9 +282,17 @@ cdef class CyCatsMover(CyCurrentMover):
 
         return True
 
+    def set_model_step_times(self, Seconds start_time, Seconds time_step,
+                             long num_steps):
+        """
+        The step times of the next run: prepare_for_model_run() looks up
+        the time file's values at all of them, 0 steps for none
+        """
+        self.cats.SetModelStepTimes(start_time, time_step, num_steps)
+
     def get_move(self,
-                 model_time,
-                 step_len,
+                 Seconds model_time,
+                 Seconds step_len,
                  cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
                  cnp.ndarray[WorldPoint3D, ndim=1] delta,
                  cnp.ndarray[short] LE_status,
@@ -274,11 +325,12 @@ cdef class CyCatsMover(CyCurrentMover):
         """
         cdef OSErr err
 
-        N = len(ref_points)
+        cdef LECount N = len(ref_points)
 
-        err = self.cats.get_move(N, model_time, step_len,
-                                 &ref_points[0], &delta[0], &LE_status[0],
-                                 spill_type, 0)
+        with nogil:
+            err = self.cats.get_move(N, model_time, step_len,
+                                     &ref_points[0], &delta[0], &LE_status[0],
+                                     spill_type, 0)
         if err == 1:
             raise ValueError('Make sure numpy arrays for ref_points, delta, '
                              'and windages are defined')
@@ -324,42 +376,20 @@ cdef class CyCatsMover(CyCurrentMover):
     def _get_center_points(self):
         """
             Invokes the GetTriangleCenters method of TriGridVel_c object
-            to get the velocities for the grid
+            to get the center points of the triangles. The grid keeps them:
+            the array is a read-only view of them
         """
-        cdef short tmp_size = sizeof(WorldPoint)
-        cdef WORLDPOINTH pts_hdl
-        cdef cnp.ndarray[WorldPoint, ndim = 1] pts
-
-        # allocate memory and copy it over
-        pts_hdl = self.cats.GetTriangleCenters()
-        sz = _GetHandleSize(<Handle>pts_hdl)
-
-        # will this always work?
-        pts = np.empty((sz / tmp_size,), dtype=basic_types.w_point_2d)
-
-        memcpy(&pts[0], pts_hdl[0], sz)
-
-        return pts
+        return handle_array(<Handle>self.cats.GetTriangleCenters(),
+                            basic_types.w_point_2d, self)
 
     def _get_world_points(self):
         """
-            Invokes the GetTriangleCenters method of TriGridVel_c object
-            to get the velocities for the grid
+            Invokes the GetWorldPointsHdl method of TriGridVel_c object
+            to get the points of the grid in degrees, a read-only view as
+            _get_center_points()
         """
-        cdef short tmp_size = sizeof(WorldPoint)
-        cdef WORLDPOINTH pts_hdl
-        cdef cnp.ndarray[WorldPoint, ndim = 1] pts
-
-        # allocate memory and copy it over
-        pts_hdl = self.cats.GetWorldPointsHdl()
-        sz = _GetHandleSize(<Handle>pts_hdl)
-
-        # will this always work?
-        pts = np.empty((sz / tmp_size,), dtype=basic_types.w_point_2d)
-
-        memcpy(&pts[0], pts_hdl[0], sz)
-
-        return pts
+        return handle_array(<Handle>self.cats.GetWorldPointsHdl(),
+                            basic_types.w_point_2d, self)
 
     def _get_points(self):
         """
@@ -0,0 +1,162 @@
+"""
+The mass of the elements binned by cell and depth layer in lib_gnome, for
+the concentration output: on a regular longitude and latitude grid, or on
+the triangles of a model grid located with a CyGridLocator.
+"""
+import cython
+cimport numpy as cnp
+import numpy as np
+
+from type_defs cimport OSErr
+from grids cimport ConcentrationGrid_c
+from cy_grid_locator cimport CyGridLocator
+
+
+cdef class CyConcentrationGrid:
+    '''
+    The binned mass, kept until clear(). The cells of a triangle grid are
+    its triangles; those of a regular grid are numbered along the rows,
+    from the south west.
+    '''
+    cdef ConcentrationGrid_c *grid
+    # kept for the triangle grid, which only points to its locator
+    cdef CyGridLocator grid_locator
+    cdef readonly object shape
+
+    def __cinit__(self):
+        self.grid = new ConcentrationGrid_c()
+
+    def __dealloc__(self):
+        del self.grid
+
+    def __init__(self, bounds=None, shape=None, CyGridLocator locator=None,
+                 depth_edges=(0., 1.)):
+        '''
+        :param bounds: ((west, south), (east, north)) of a regular grid in
+            degrees
+        :param shape: (rows, columns) of the regular grid
+        :param locator: the CyGridLocator of a triangle grid, instead of
+            bounds and shape
+        :param depth_edges: the depths in meters, increasing, of the tops
+            of the layers and the bottom of the last -- the surface meter
+            by default
+        '''
+        cdef OSErr err
+        cdef cnp.ndarray[double, ndim=1] edges
+
+        if locator is not None:
+            err = self.grid.SetTriangleGrid(locator.locator)
+            self.grid_locator = locator
+            self.shape = (locator.num_triangles,)
+        else:
+            if bounds is None or shape is None:
+                raise ValueError('a concentration grid needs bounds and '
+                                 'shape, or a grid locator')
+            (west, south), (east, north) = bounds
+            rows, cols = shape
+            err = self.grid.SetRegularGrid(west, south, east, north,
+                                           cols, rows)
+            self.shape = (rows, cols)
+        if err != 0:
+            raise ValueError('not a grid: bounds {0}, shape {1}'
+                             .format(bounds, shape))
+
+        edges = np.ascontiguousarray(depth_edges, dtype=np.float64)
+        if (len(edges) < 2 or
+                self.grid.SetLayers(len(edges), &edges[0]) != 0):
+            raise ValueError('depth_edges must be at least two increasing '
+                             'depths, not {0}'.format(depth_edges))
+
+    property num_cells:
+        def __get__(self):
+            return self.grid.GetNumCells()
+
+    property num_layers:
+        def __get__(self):
+            return self.grid.GetNumLayers()
+
+    def clear(self):
+        'sets the binned mass back to zero'
+        self.grid.Clear()
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def add_mass(self, positions, mass, cells=None):
+        '''
+        Adds the mass of the elements at positions to their cells and
+        layers. Those off the grid or outside the layers are left out.
+
+        :param positions: (N, 3) array of (lon, lat, depth)
+        :param mass: the mass of each element in kilograms
+        :param cells: the cells the elements were in the last time, where
+            the lookups on a triangle grid start (-1 for none)
+
+        :returns: (the number of elements binned, their cells)
+        '''
+        cdef cnp.ndarray[double, ndim=1] lon, lat, depth, c_mass
+        cdef cnp.ndarray[long, ndim=1] c_cells
+        cdef long n, binned = 0
+
+        positions = np.asarray(positions, dtype=np.float64).reshape(-1, 3)
+        n = len(positions)
+
+        lon = np.ascontiguousarray(positions[:, 0])
+        lat = np.ascontiguousarray(positions[:, 1])
+        depth = np.ascontiguousarray(positions[:, 2])
+        c_mass = np.ascontiguousarray(mass, dtype=np.float64).ravel()
+        if len(c_mass) != n:
+            raise ValueError('there are {0} masses for {1} elements'
+                             .format(len(c_mass), n))
+
+        if cells is None:
+            c_cells = np.full((n,), -1, dtype=np.int_)
+        else:
+            c_cells = np.array(cells, dtype=np.int_).ravel()
+            if len(c_cells) != n:
+                raise ValueError('there are {0} cells for {1} elements'
+                                 .format(len(c_cells), n))
+
+        if n > 0:
+            with nogil:
+                binned = self.grid.AddMass(n, &lon[0], &lat[0], &depth[0],
+                                           &c_mass[0], &c_cells[0])
+
+        return binned, c_cells
+
+    property mass:
+        '''
+        the binned mass in kilograms, by layer and cell: (layers, rows,
+        columns) for a regular grid, (layers, triangles) for a triangle grid
+        '''
+        def __get__(self):
+            cdef cnp.ndarray[double, ndim=1] result
+            cdef long size = self.grid.GetNumCells() * self.grid.GetNumLayers()
+            cdef const double *c_mass = self.grid.GetMass()
+            cdef long i
+
+            result = np.empty((size,), dtype=np.float64)
+            for i in range(size):
+                result[i] = c_mass[i]
+
+            return result.reshape((self.grid.GetNumLayers(),) + self.shape)
+
+    property cell_areas:
+        'the areas of the cells in square meters, in the shape of a layer'
+        def __get__(self):
+            cdef cnp.ndarray[double, ndim=1] area
+
+            area = np.empty((self.grid.GetNumCells(),), dtype=np.float64)
+            self.grid.GetCellAreas(&area[0])
+
+            return area.reshape(self.shape)
+
+    property cell_centers:
+        'the (lon, lat) of the centers of the cells, in the shape of a layer'
+        def __get__(self):
+            cdef cnp.ndarray[double, ndim=1] lon, lat
+
+            lon = np.empty((self.grid.GetNumCells(),), dtype=np.float64)
+            lat = np.empty((self.grid.GetNumCells(),), dtype=np.float64)
+            self.grid.GetCellCenters(&lon[0], &lat[0])
+
+            return lon.reshape(self.shape), lat.reshape(self.shape)
@@ -1,4 +1,4 @@
-from type_defs cimport OSErr, VelocityRec, WorldPoint3D
+from type_defs cimport OSErr, VelocityRec, WorldPoint3D, LECount
 from libcpp cimport bool
 
 import cython
@@ -71,32 +71,56 @@ cdef class CyTimeGridVel(object):
 
 
     def get_values(self,
-                 int model_time,
-                 cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
-                 cnp.ndarray[VelocityRec] vels):
+                   int model_time,
+                   cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
+                   cnp.ndarray[VelocityRec] vels,
+                   cnp.ndarray[long, ndim=1] hints=None):
         """
-        .. function:: get_move(self,
+        .. function:: get_values(self,
                  model_time,
                  cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
-                 cnp.ndarray[VelocityRec] vels)
+                 cnp.ndarray[VelocityRec] vels,
+                 cnp.ndarray[long, ndim=1] hints=None)
 
-        Invokes the underlying C++ TimeGridVel_c.get_values(...)
+        Invokes the underlying C++ TimeGridVel_c.get_values(...), which
+        loads the data for model_time and interpolates all the points in one
+        call, without the GIL
 
         :param model_time: current model time
         :param ref_points: current locations of LE particles
         :type ref_points: numpy array of WorldPoint3D
         :param vels: the velocity at the position of each particle
         :type vels: numpy array of VelocityRec
+        :param hints: optional, the triangle of each point from the last
+            call, updated in place - start them at -1 and pass the same
+            array each time to speed up the search on triangle grids
+        :type hints: numpy array of numpy.int_
         :returns: none
         """
         cdef OSErr err
+        cdef LECount N = len(ref_points)
+        cdef long *hints_ptr = NULL
+
+        if len(vels) != N:
+            raise ValueError('ref_points and vels must be the same length')
 
-        N = len(ref_points)
+        if N == 0:
+            return
 
-        err = self.timegrid.get_values(N, model_time,
-                                 &ref_points[0], &vels[0])
+        if hints is not None:
+            if len(hints) != N:
+                raise ValueError('ref_points and hints must be the same '
+                                 'length')
+            hints_ptr = &hints[0]
+
+        with nogil:
+            err = self.timegrid.get_values(N, model_time,
+                                           &ref_points[0], &vels[0],
+                                           hints_ptr)
 
         if err == 1:
             raise ValueError('Make sure numpy arrays for ref_points and vels, '
                              'are defined')
-
+        elif err != 0:
+            raise Exception('get_values failed to load the data for time '
+                            '{0}'.format(model_time))
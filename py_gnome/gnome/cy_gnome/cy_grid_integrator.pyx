@@ -0,0 +1,117 @@
+"""
+The moves of the py movers (PyGridCurrentMover, UGridCurrentMover) on a
+triangle grid, integrated in lib_gnome: each element's Euler, Trapezoid or
+RK4 stages are done in C, from the velocities at the grid's nodes, with no
+arrays made for the stages.
+"""
+import cython
+cimport numpy as cnp
+import numpy as np
+
+from type_defs cimport OSErr, NUM_METHOD, EULER, RK4, TRAPEZOID
+from cy_grid_locator cimport CyGridLocator
+
+# the py movers' names for their numerical methods
+_methods = {'Euler': EULER,
+            'Trapezoid': TRAPEZOID,
+            'RK4': RK4}
+
+
+cdef class CyGridIntegrator:
+    '''
+    Moves the elements on the grid of a CyGridLocator. The triangles the
+    elements were in are kept from one step to the next as where the
+    lookups start, and the arrays of the moves are reused.
+    '''
+    cdef CyGridLocator grid_locator
+    cdef cnp.ndarray tri
+    cdef cnp.ndarray dx
+    cdef cnp.ndarray dy
+
+    def __init__(self, CyGridLocator grid_locator):
+        self.grid_locator = grid_locator
+        self.tri = np.zeros((0,), dtype=np.int_)
+        self.dx = np.zeros((0,), dtype=np.float64)
+        self.dy = np.zeros((0,), dtype=np.float64)
+
+    property locator:
+        def __get__(self):
+            return self.grid_locator
+
+    def _sized(self, long n):
+        if len(self.tri) != n:
+            # the elements changed -- the old triangles aren't theirs
+            self.tri = np.full((n,), -1, dtype=np.int_)
+
+        if len(self.dx) < n:
+            self.dx = np.empty((n,), dtype=np.float64)
+            self.dy = np.empty((n,), dtype=np.float64)
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def get_moves(self, positions, double time_step, method,
+                  u0, v0, u_mid=None, v_mid=None, u1=None, v1=None):
+        '''
+        The moves in meters of the elements at positions over time_step.
+
+        :param positions: (N, 2) or (N, 3) array of (lon, lat[, z])
+        :param method: 'Euler', 'Trapezoid' or 'RK4'
+        :param u0, v0: the velocities at the grid's nodes at the start of
+            the step; u_mid, v_mid at the middle (RK4) and u1, v1 at the
+            end (Trapezoid, RK4). Those not given are the ones at the start
+
+        :returns: (N, 2) array of (dx, dy) in meters
+        '''
+        cdef cnp.ndarray[double, ndim=1] lon, lat
+        cdef cnp.ndarray[double, ndim=1] c_u0, c_v0, c_um, c_vm, c_u1, c_v1
+        cdef cnp.ndarray[long, ndim=1] tri
+        cdef cnp.ndarray[double, ndim=1] dx, dy
+        cdef NUM_METHOD c_method
+        cdef long n, num_nodes = self.grid_locator.locator.GetNumNodes()
+        cdef OSErr err
+
+        if method not in _methods:
+            raise ValueError('{0} is not one of {1}'
+                             .format(method, sorted(_methods)))
+        c_method = _methods[method]
+
+        positions = np.asarray(positions, dtype=np.float64)
+        if positions.ndim == 1:
+            positions = positions.reshape(1, -1)
+        n = len(positions)
+
+        lon = np.ascontiguousarray(positions[:, 0])
+        lat = np.ascontiguousarray(positions[:, 1])
+
+        u_mid = u0 if u_mid is None else u_mid
+        v_mid = v0 if v_mid is None else v_mid
+        u1 = u0 if u1 is None else u1
+        v1 = v0 if v1 is None else v1
+
+        c_u0, c_v0, c_um, c_vm, c_u1, c_v1 = [
+            np.ascontiguousarray(f, dtype=np.float64).ravel()
+            for f in (u0, v0, u_mid, v_mid, u1, v1)]
+
+        for f in (c_u0, c_v0, c_um, c_vm, c_u1, c_v1):
+            if len(f) != num_nodes:
+                raise ValueError('there are {0} velocities for {1} nodes'
+                                 .format(len(f), num_nodes))
+
+        self._sized(n)
+        tri = self.tri
+        dx = self.dx
+        dy = self.dy
+
+        if n > 0:
+            with nogil:
+                err = self.grid_locator.locator.GetMoves(n, &lon[0], &lat[0],
+                                                         &tri[0],
+                                                         c_method, time_step,
+                                                         &c_u0[0], &c_v0[0],
+                                                         &c_um[0], &c_vm[0],
+                                                         &c_u1[0], &c_v1[0],
+                                                         &dx[0], &dy[0])
+            if err != 0:
+                raise ValueError('the grid locator has no grid')
+
+        return np.column_stack((dx[:n], dy[:n]))
@@ -0,0 +1,9 @@
+"""
+CyGridLocator is cimported by the integrator of the py movers, which moves
+the elements on its grid.
+"""
+from grids cimport GridLocator_c
+
+
+cdef class CyGridLocator:
+    cdef GridLocator_c *locator
@@ -0,0 +1,135 @@
+"""
+Point location on a triangle grid -- the nodes and faces of a pyugrid UGrid --
+with lib_gnome's DAG tree, for the gridded properties of the environment.
+
+The points are located once and their weights kept, so each variable on the
+grid and each time slice of it is interpolated with a weighted sum of three
+node values.
+"""
+import cython
+cimport numpy as cnp
+import numpy as np
+
+from type_defs cimport OSErr
+from grids cimport GridLocator_c, Interpolate
+
+
+cdef class CyGridLocator:
+
+    def __cinit__(self):
+        self.locator = new GridLocator_c()
+
+    def __dealloc__(self):
+        del self.locator
+
+    def __init__(self, nodes, faces):
+        '''
+        :param nodes: (N, 2) array of the nodes' (lon, lat) in degrees
+        :param faces: (M, 3) array of the node indices of each triangle,
+            in either order
+        '''
+        cdef OSErr err
+        cdef char errmsg[256]
+        cdef cnp.ndarray[double, ndim=1] lon, lat
+        cdef cnp.ndarray[long, ndim=1] triangles
+
+        nodes = np.asarray(nodes, dtype=np.float64)
+        faces = np.asarray(faces)
+
+        if nodes.ndim != 2 or nodes.shape[1] < 2:
+            raise ValueError('nodes must be an (N, 2) array')
+        if faces.ndim != 2 or faces.shape[1] != 3:
+            raise ValueError('faces must be an (M, 3) array of triangles')
+
+        lon = np.ascontiguousarray(nodes[:, 0])
+        lat = np.ascontiguousarray(nodes[:, 1])
+        triangles = np.ascontiguousarray(faces, dtype=np.int_).ravel()
+
+        err = self.locator.Build(len(lon), &lon[0], &lat[0],
+                                 len(faces), &triangles[0], errmsg)
+        if err != 0:
+            raise ValueError('could not build the grid locator: {0}'
+                             .format(errmsg))
+
+    property num_nodes:
+        def __get__(self):
+            return self.locator.GetNumNodes()
+
+    property num_triangles:
+        def __get__(self):
+            return self.locator.GetNumTriangles()
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def locate(self, points, hints=None):
+        '''
+        The triangle each of points is in, -1 for those off the grid, with
+        the triangle's nodes and their weights.
+
+        :param points: (N, 2) or (N, 3) array of (lon, lat[, depth])
+        :param hints: an optional array of triangles the points were in
+            last: the lookup starts from them
+
+        :returns: (tri, node, alpha) -- node and alpha are (N, 3)
+        '''
+        cdef cnp.ndarray[double, ndim=1] lon, lat
+        cdef cnp.ndarray[long, ndim=1] tri
+        cdef cnp.ndarray[long, ndim=2] node
+        cdef cnp.ndarray[double, ndim=2] alpha
+        cdef long n
+
+        points = np.asarray(points, dtype=np.float64)
+        if points.ndim == 1:
+            points = points.reshape(1, -1)
+        n = len(points)
+
+        lon = np.ascontiguousarray(points[:, 0])
+        lat = np.ascontiguousarray(points[:, 1])
+
+        if hints is None:
+            tri = np.full((n,), -1, dtype=np.int_)
+        else:
+            tri = np.array(hints, dtype=np.int_).ravel()
+            if len(tri) != n:
+                raise ValueError('there are {0} hints for {1} points'
+                                 .format(len(tri), n))
+
+        node = np.empty((n, 3), dtype=np.int_)
+        alpha = np.empty((n, 3), dtype=np.float64)
+
+        if n > 0:
+            with nogil:
+                self.locator.Locate(n, &lon[0], &lat[0],
+                                    &tri[0], &node[0, 0], &alpha[0, 0])
+
+        return tri, node, alpha
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def interpolate(self, tri, node, alpha, values, fill=np.nan):
+        '''
+        values given at the nodes, at the points located by locate()
+
+        :param values: an array of a value for each node
+        :param fill: the value for the points off the grid
+        '''
+        cdef cnp.ndarray[long, ndim=1] c_tri = np.ascontiguousarray(tri, dtype=np.int_)
+        cdef cnp.ndarray[long, ndim=2] c_node = np.ascontiguousarray(node, dtype=np.int_)
+        cdef cnp.ndarray[double, ndim=2] c_alpha = np.ascontiguousarray(alpha, dtype=np.float64)
+        cdef cnp.ndarray[double, ndim=1] c_values = np.ascontiguousarray(values, dtype=np.float64).ravel()
+        cdef cnp.ndarray[double, ndim=1] result
+        cdef long n = len(c_tri)
+        cdef double c_fill = fill
+
+        if len(c_values) != self.locator.GetNumNodes():
+            raise ValueError('there are {0} values for {1} nodes'
+                             .format(len(c_values),
+                                     self.locator.GetNumNodes()))
+
+        result = np.empty((n,), dtype=np.float64)
+        if n > 0:
+            with nogil:
+                Interpolate(n, &c_tri[0], &c_node[0, 0], &c_alpha[0, 0],
+                            &c_values[0], c_fill, &result[0])
+
+        return result
@@ -11,7 +11,7 @@ from current_movers cimport GridCurrentMover_c, CurrentMover_c
 
 from gnome import basic_types
 from gnome.cy_gnome.cy_mover cimport CyCurrentMoverBase
-from gnome.cy_gnome.cy_helpers cimport to_bytes
+from gnome.cy_gnome.cy_helpers cimport to_bytes, handle_array
 
 
 cdef extern from *:
@@ -78,6 +78,45 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
             raise OSError('GridCurrentMover_c.ExportTopology '
                           'returned an error.')
 
+    def write_forcing_file(self, forcing_file):
+        """
+        .. function::write_forcing_file
+
+        Writes the times of the current file as a forcing file, tiled and
+        decoded the way this mover reads them, for
+        cy_helpers.open_forcing_file(). Each time is read from the file in
+        turn, so write it before a run, and from the whole grid rather than
+        an active window.
+        """
+        cdef OSErr err
+        cdef char errmsg[256]
+
+        forcing_file = os.path.normpath(forcing_file)
+        forcing_file = to_bytes(unicode(forcing_file))
+
+        err = self.grid_current.WriteForcingFile(forcing_file, errmsg)
+        if err != 0:
+            raise OSError('GridCurrentMover_c.WriteForcingFile '
+                          'returned an error: {0}'.format(errmsg))
+
+    def load_interval(self, Seconds model_time):
+        """
+        .. function::load_interval
+
+        Reads the times of the file around model_time, as
+        prepare_for_model_step does, and no more: no uncertainty and no LEs
+        moved, to time and count the forcing reads on their own (see
+        cy_helpers.get_forcing_io_stats()). The next time is prefetched as
+        in a run.
+        """
+        cdef OSErr err
+        cdef char errmsg[256]
+
+        err = self.grid_current.LoadInterval(model_time, errmsg)
+        if err != 0:
+            raise OSError('GridCurrentMover_c.LoadInterval '
+                          'returned an error: {0}'.format(errmsg))
+
     def __init__(self, current_scale=1,
                  uncertain_duration=24*3600,
                  uncertain_time_delay=0,
@@ -181,6 +220,165 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
         def __set__(self, value):
             self.grid_current.num_method = value
 
+    property max_courant:
+        """
+        for num_method adaptive: LEs that move less than this much of their
+        grid cell in a step take one Euler step, the others RK4 sub-steps
+        that each move them at most this much
+        """
+        def __get__(self):
+            return self.grid_current.fMaxCourant
+
+        def __set__(self, value):
+            self.grid_current.fMaxCourant = value
+
+    property max_substeps:
+        """
+        for num_method adaptive: the most RK4 sub-steps an LE takes in a step
+        """
+        def __get__(self):
+            return self.grid_current.fMaxSubsteps
+
+        def __set__(self, value):
+            self.grid_current.fMaxSubsteps = value
+
+    def get_courant_numbers(self,
+                            Seconds model_time,
+                            Seconds step_len,
+                            cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lat,
+                            cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lon,
+                            cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] z,
+                            cnp.ndarray[short, ndim=1, mode='c'] LE_status):
+        """
+        The Courant number of each LE for a step of step_len from
+        model_time: how far the current moves it, in sizes of the grid cell
+        it is in. 0 for the LEs not in water, and where the grid doesn't
+        know its cell sizes.
+        """
+        cdef OSErr err
+        cdef LECount N = len(lat)
+        cdef cnp.ndarray[cnp.npy_double, ndim=1] courant = np.zeros((N,),
+                                                                   dtype=np.float64)
+
+        if N == 0:
+            return courant
+
+        if len(lon) != N or len(z) != N or len(LE_status) != N:
+            raise ValueError('the arrays must all be the same length')
+
+        with nogil:
+            err = self.grid_current.GetCourantNumbers(N, model_time, step_len,
+                                                      &lat[0], &lon[0], &z[0],
+                                                      &LE_status[0],
+                                                      &courant[0])
+
+        if err:
+            raise ValueError('Error in GridCurrentMover_c.GetCourantNumbers: '
+                             '{0}'.format(err))
+
+        return courant
+
+    def set_active_window(self, use_window, halo=10):
+        """
+        For regular grids, read only the cells around the LEs (plus halo
+        cells) from the file. The window grows as LEs move out of it.
+        Velocities outside the window are zero, so leave this off if the
+        whole field is needed (e.g. for output).
+        """
+        self.grid_current.SetActiveWindowMode(use_window, halo)
+
+    def set_active_window_bounds(self, bounds):
+        """
+        Start the active window at the cells of bounds, ((lon, lat), (lon,
+        lat)) corners in degrees, plus the halo, instead of around the LEs of
+        the first step. It still grows as LEs move out of it.
+
+        :returns: False if the active window is off or bounds is off the grid
+        """
+        cdef WorldRect rect
+
+        ((lo_long, lo_lat), (hi_long, hi_lat)) = bounds
+        rect.loLong = <long>round(min(lo_long, hi_long) * 1000000)
+        rect.hiLong = <long>round(max(lo_long, hi_long) * 1000000)
+        rect.loLat = <long>round(min(lo_lat, hi_lat) * 1000000)
+        rect.hiLat = <long>round(max(lo_lat, hi_lat) * 1000000)
+
+        return self.grid_current.SetActiveWindowBounds(rect)
+
+    property active_window:
+        def __get__(self):
+            return self.grid_current.GetActiveWindowMode()
+
+    property prefetch:
+        """
+        read the next time of the file on a background thread while the
+        loaded ones are used, when lib_gnome is built with GNOME_PREFETCH
+        """
+        def __get__(self):
+            return self.grid_current.GetPrefetch()
+
+        def __set__(self, value):
+            self.grid_current.SetPrefetch(value)
+
+    property single_precision:
+        """
+        read velocities from the file as float32 rather than through
+        double buffers. The loaded data is float32 either way.
+        """
+        def __get__(self):
+            return self.grid_current.GetSinglePrecision()
+
+        def __set__(self, value):
+            self.grid_current.SetSinglePrecision(value)
+
+    property interpolated_field:
+        """
+        blend the two loaded times once per step, so each LE only
+        interpolates in space. Gives the same velocities.
+        """
+        def __get__(self):
+            return self.grid_current.GetInterpolatedFieldMode()
+
+        def __set__(self, value):
+            self.grid_current.SetInterpolatedFieldMode(value)
+
+    property cell_binning:
+        """
+        for velocities on the cells of a curvilinear grid, bin the LEs by
+        cell and work out the velocity once for the LEs of a cell at the
+        same depth. Gives the same velocities, faster for dense plumes.
+        """
+        def __get__(self):
+            return self.grid_current.GetCellBinningMode()
+
+        def __set__(self, value):
+            self.grid_current.SetCellBinningMode(value)
+
+    property water_node_layout:
+        """
+        for 2D velocities on the nodes of a curvilinear grid, keep only the
+        velocities of the water nodes of each time, in the order of the grid's
+        points. Gives the same velocities with less memory for grids with
+        much land.
+        """
+        def __get__(self):
+            return self.grid_current.GetWaterNodeLayout()
+
+        def __set__(self, value):
+            self.grid_current.SetWaterNodeLayout(value)
+
+    property nearest_node:
+        """
+        for 2D velocities on the nodes of a curvilinear grid, give an LE off
+        the grid or on a land node the velocity of the nearest water node
+        instead of zero. Off by default.
+        """
+        def __get__(self):
+            return self.grid_current.GetNearestNodeMode()
+
+        def __set__(self, value):
+            self.grid_current.SetNearestNodeMode(value)
+
     def extrapolate_in_time(self, extrapolate):
         self.grid_current.SetExtrapolationInTime(extrapolate)
 
@@ -203,8 +401,8 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
         return end_time
 
     def get_move(self,
-                 model_time,
-                 step_len,
+                 Seconds model_time,
+                 Seconds step_len,
                  cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
                  cnp.ndarray[WorldPoint3D, ndim=1] delta,
                  cnp.ndarray[short] LE_status,
@@ -233,13 +431,14 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
         :returns: none
         """
         cdef OSErr err
-        N = len(ref_points)
+        cdef LECount N = len(ref_points)
 
-        err = self.grid_current.get_move(N, model_time, step_len,
-                                         &ref_points[0],
-                                         &delta[0],
-                                         &LE_status[0],
-                                         spill_type, 0)
+        with nogil:
+            err = self.grid_current.get_move(N, model_time, step_len,
+                                             &ref_points[0],
+                                             &delta[0],
+                                             &LE_status[0],
+                                             spill_type, 0)
 
         if err == 1:
             raise ValueError('Make sure numpy arrays for ref_points '
@@ -277,22 +476,11 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
     def _get_center_points(self):
         """
             Invokes the GetTriangleCenters method of TriGridVel_c object
-            to get the velocities for the grid
+            to get the center points of the triangles or cells of the grid.
+            The grid keeps them: the array is a read-only view of them
         """
-        cdef short tmp_size = sizeof(WorldPoint)
-        cdef WORLDPOINTH pts_hdl
-        cdef cnp.ndarray[WorldPoint, ndim = 1] pts
-
-        # allocate memory and copy it over
-        pts_hdl = self.grid_current.GetTriangleCenters()
-        sz = _GetHandleSize(<Handle>pts_hdl)
-
-        # will this always work?
-        pts = np.empty((sz / tmp_size,), dtype=basic_types.w_point_2d)
-
-        memcpy(&pts[0], pts_hdl[0], sz)
-
-        return pts
+        return handle_array(<Handle>self.grid_current.GetTriangleCenters(),
+                            basic_types.w_point_2d, self)
 
     def _get_triangle_data(self):
         """
@@ -318,23 +506,11 @@ cdef class CyGridCurrentMover(CyCurrentMoverBase):
     def _get_cell_data(self):
         """
             Invokes the GetCellDataHdl method of TimeGridVel_c object
-            to get the velocities for the grid
+            to get the corners of the cells of a curvilinear grid, a
+            read-only view as _get_center_points()
         """
-        cdef short tmp_size = sizeof(GridCellInfo)
-        cdef GridCellInfoHdl cell_data_hdl
-        cdef cnp.ndarray[GridCellInfo, ndim = 1] cell_data
-
-        # allocate memory and copy it over
-        # should check that cell data exists
-        cell_data_hdl = self.grid_current.GetCellDataHdl()
-        sz = _GetHandleSize(<Handle>cell_data_hdl)
-
-        # will this always work?
-        cell_data = np.empty((sz / tmp_size,), dtype=basic_types.cell_data)
-
-        memcpy(&cell_data[0], cell_data_hdl[0], sz)
-
-        return cell_data
+        return handle_array(<Handle>self.grid_current.GetCellDataHdl(),
+                            basic_types.cell_data, self)
 
     def _is_triangle_grid(self):
         """
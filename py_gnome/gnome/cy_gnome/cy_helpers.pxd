@@ -4,4 +4,7 @@ Functions with implementation given in cy_helpers.pyx
 These can be cimported in other cython modules
 """
 
-cdef bytes to_bytes(unicode ucode)
\ No newline at end of file
+from type_defs cimport Handle
+
+cdef bytes to_bytes(unicode ucode)
+cdef object handle_array(Handle h, dtype, owner)
@@ -6,7 +6,7 @@ cimport numpy as cnp
 import numpy as np
 
 from gnome import basic_types
-from type_defs cimport Seconds, DateTimeRec
+from type_defs cimport Seconds, DateTimeRec, LECount, Handle
 cimport utils
 
 cdef class CyDateTime:
@@ -35,11 +35,161 @@ cdef class CyDateTime:
         return daterec[:][0]
 
 
+def _date_recs(times):
+    'the date_rec of each of an array of naive numpy.datetime64'
+    times = times.astype('datetime64[s]')
+    months = times.astype('datetime64[M]')
+    days = times.astype('datetime64[D]')
+    secs = (times - days).astype(np.int64)
+
+    recs = np.zeros((len(times), ), dtype=basic_types.date_rec)
+    recs['year'] = times.astype('datetime64[Y]').astype(np.int64) + 1970
+    recs['month'] = months.astype(np.int64) % 12 + 1
+    recs['day'] = (days - months).astype(np.int64) + 1
+    recs['hour'] = secs // 3600
+    recs['minute'] = secs // 60 % 60
+    recs['second'] = secs % 60
+
+    return recs
+
+
+def dates_to_seconds(dates):
+    '''
+    DateToSeconds of each of an array of dates, in one call: lib_gnome only
+    calls mktime once for each day of them.
+
+    :param dates: naive numpy.datetime64, or basic_types.date_rec records
+    :returns: an array of basic_types.seconds, as time_utils.date_to_sec
+    '''
+    cdef cnp.ndarray[DateTimeRec, ndim = 1, mode = 'c'] recs
+    cdef cnp.ndarray[Seconds, ndim = 1, mode = 'c'] seconds
+
+    dates = np.asarray(dates).reshape(-1)
+    if dates.dtype.kind == 'M':
+        recs = _date_recs(dates)
+    else:
+        recs = np.ascontiguousarray(dates, dtype=basic_types.date_rec)
+
+    seconds = np.empty((recs.size, ), dtype=basic_types.seconds)
+    if recs.size > 0:
+        utils.DatesToSeconds(&recs[0], recs.size, &seconds[0])
+
+    return seconds
+
+
+def seconds_to_dates(seconds):
+    '''
+    SecondsToDate of each of an array of times in seconds, in one call
+
+    :returns: an array of basic_types.date_rec
+    '''
+    cdef cnp.ndarray[Seconds, ndim = 1, mode = 'c'] secs
+    cdef cnp.ndarray[DateTimeRec, ndim = 1, mode = 'c'] recs
+
+    secs = np.ascontiguousarray(seconds, dtype=basic_types.seconds).reshape(-1)
+    recs = np.empty((secs.size, ), dtype=basic_types.date_rec)
+    if secs.size > 0:
+        utils.SecondsToDates(&secs[0], secs.size, &recs[0])
+
+    return recs
+
+
+def seconds_to_datetime64(seconds):
+    '''
+    seconds_to_dates as naive numpy.datetime64[s], as time_utils.sec_to_date
+    '''
+    recs = seconds_to_dates(seconds)
+
+    months = ((recs['year'].astype(np.int64) - 1970) * 12 +
+              recs['month'] - 1).astype('datetime64[M]')
+    offsets = ((recs['day'].astype(np.int64) - 1) * 86400 +
+               recs['hour'].astype(np.int64) * 3600 +
+               recs['minute'].astype(np.int64) * 60 +
+               recs['second'])
+
+    return months.astype('datetime64[s]') + offsets.astype('timedelta64[s]')
+
+
 def srand(seed):
     """
     Resets C random seed
     """
-    stdlib.srand(seed)
+    utils.SetRandomSeed(seed)
+
+
+def set_random_stream(stream):
+    """
+    Gives the calling thread a random number stream of its own for the
+    lib_gnome movers, seeded from the last srand(). A thread moving LEs
+    with the GIL released gets the same numbers whatever the other threads
+    draw, as long as each thread uses a different stream. 0 (the default)
+    goes back to the shared C rand().
+    """
+    utils.SetRandomStream(stream)
+
+
+def get_random_stream():
+    return utils.GetRandomStream()
+
+
+def get_random_state():
+    """
+    The lib_gnome random number seed and the calling thread's place in its
+    random stream, as a tuple for set_random_state(). The state of the
+    shared C rand() can't be read, so it isn't in it.
+    """
+    cdef unsigned int seed, stream, stream_seed
+    cdef long long draws
+
+    utils.GetRandomState(&seed, &stream, &stream_seed, &draws)
+
+    return (seed, stream, stream_seed, draws)
+
+
+def set_random_state(state):
+    """
+    Puts back the state get_random_state() returned -- the stream goes on
+    with the very numbers it would have drawn. This does not seed rand().
+    """
+    seed, stream, stream_seed, draws = state
+
+    utils.SetRandomState(seed, stream, stream_seed, draws)
+
+
+def counter_uniforms(le_ids, long draw, long spill_id=0, long step=0,
+                     long stream=0, seed=None):
+    """
+    Uniform random numbers in [0, 1), one for each of the LEs le_ids, from
+    lib_gnome's counter based generator: each is a function of the seed,
+    spill_id, step, stream, the LE's ID and draw only, so it doesn't matter
+    how many LEs there are, in what order or which thread draws them. Use a
+    new draw for each number an LE needs.
+
+    :param seed: the key's seed, by default the last srand()
+    """
+    cdef cnp.ndarray[cnp.uint32_t, ndim=1] ids = \
+        np.ascontiguousarray(le_ids, dtype=np.uint32).ravel()
+    cdef cnp.ndarray[double, ndim=1] values = \
+        np.empty((len(ids),), dtype=np.float64)
+    cdef utils.CounterRandomKey key
+    cdef unsigned int c_seed, c_stream, stream_seed
+    cdef long long draws
+    cdef LECount n = len(ids)
+
+    if seed is None:
+        utils.GetRandomState(&c_seed, &c_stream, &stream_seed, &draws)
+    else:
+        c_seed = seed
+
+    key.seed = c_seed
+    key.spillID = spill_id
+    key.step = step
+    key.stream = stream
+
+    if n > 0:
+        utils.FillCounterRandomUniforms(key, n, &ids[0], draw, &values[0])
+
+    return values
 
 
 def rand():
@@ -51,6 +201,653 @@ def rand():
     return stdlib.rand()
 
 
+def set_handle_pooling(use_pools):
+    """
+    True makes the lib_gnome handles and pointers come from shared size
+    class pools, which reuse freed blocks of the same size instead of going
+    back to new/delete each time. False (the default) uses new/delete.
+    """
+    utils.SetHandlePooling(use_pools)
+
+
+def get_handle_pooling():
+    """
+    returns True if new lib_gnome handles come from the shared pools
+    """
+    return bool(utils.GetHandlePooling())
+
+
+def begin_handle_arena():
+    """
+    New lib_gnome handles come from an arena until end_handle_arena(), say
+    for one model run. Handles made in it stay valid after it ends, its
+    memory is released in one go once the last of them is disposed.
+    """
+    utils.BeginHandleArena()
+
+
+def end_handle_arena():
+    utils.EndHandleArena()
+
+
+def set_time_slice_recycling(recycle):
+    """
+    True keeps the big time slice blocks of the gridded movers when they are
+    disposed, a few of them, and gives them to the next slices that fit:
+    on a big grid each interval change reuses the slice that left instead
+    of freeing one and allocating another. They stay counted under
+    'time_slices'. False (the default) frees them.
+    """
+    utils.SetTimeSliceRecycling(recycle)
+
+
+def get_time_slice_recycling():
+    return bool(utils.GetTimeSliceRecycling())
+
+
+def set_time_slice_interleaving(interleave):
+    """
+    True puts the pages of the big time slice blocks of the gridded movers
+    made from now on interleaved over the NUMA nodes, before the thread
+    reading them in touches them, so the get_move threads on every node
+    read them at the same speed. False (the default) leaves them where the
+    reading thread's node puts them.
+
+    :returns: True if the slices are interleaved -- False on a machine of
+        one node, or not Linux, where they are allocated as usual
+    """
+    return bool(utils.SetTimeSliceInterleaving(interleave))
+
+
+def get_time_slice_interleaving():
+    return bool(utils.GetTimeSliceInterleaving())
+
+
+def get_numa_node_count():
+    """
+    the number of NUMA nodes of the machine, 1 if it can't be told
+    """
+    return utils.GetNumaNodeCount()
+
+
+def pin_worker_threads(num_threads):
+    """
+    pins the OpenMP threads of the movers' num_threads wide loops to the
+    NUMA nodes in blocks -- the first threads to the cpus of the first node
+    and so on -- so they stay on their node, and the static schedules give
+    each node the same chunks of LEs every step. Call it with the movers'
+    num_threads before the run.
+
+    :returns: the number of threads pinned, 0 on a machine of one node or
+        lib_gnome built without OpenMP, the threads aren't pinned then
+    """
+    return utils.PinWorkerThreads(num_threads)
+
+
+def get_memory_usage():
+    """
+    returns the memory held in lib_gnome handles and pointers, as a dict of
+    subsystem name ('time_slices', 'topology', 'dag_tree', 'uncertainty',
+    'tide_tables', 'other' and 'total' for all of them) to a dict of the
+    bytes held now, the peak bytes and the number of blocks.
+    Block headers and unused capacity are included.
+    """
+    cdef utils.MemoryUsage usage
+    cdef short tag
+
+    memory = {}
+    for tag in range(utils.kNumMemoryTags + 1):
+        utils.GetMemoryUsage(tag, &usage)
+        memory[utils.GetMemoryTagName(tag)] = {'bytes': usage.bytes,
+                                               'peak_bytes': usage.peakBytes,
+                                               'num_blocks': usage.numBlocks}
+
+    return memory
+
+
+def reset_memory_peaks():
+    """
+    starts the peaks in get_memory_usage() again from the bytes held now
+    """
+    utils.ResetMemoryPeaks()
+
+
+def _tag_names():
+    cdef short tag
+
+    return [utils.GetMemoryTagName(tag)
+            for tag in range(utils.kNumMemoryTags)]
+
+
+def _tag_mask(tags):
+    'the MemUtils tag mask of the memory subsystems named in tags'
+    cdef long mask = 0
+
+    names = _tag_names()
+    for subsystem in tags:
+        if subsystem not in names:
+            raise ValueError('{0} is not a memory subsystem, one of {1}'
+                             .format(subsystem, names))
+        mask |= 1 << names.index(subsystem)
+
+    return mask
+
+
+_huge_page_modes = {'off': utils.kHugePagesOff,
+                    'transparent': utils.kHugePagesTransparent,
+                    'explicit': utils.kHugePagesExplicit}
+
+
+def set_huge_pages(mode, tags=('time_slices', 'topology', 'dag_tree')):
+    """
+    Backs the lib_gnome blocks of 2MB or more of the subsystems in tags (the
+    names of get_memory_usage()) made from now on with huge pages, so the
+    point location and interpolation over a big grid's points, triangles,
+    DAG and velocities miss the TLB less:
+
+     - 'transparent' asks the kernel for transparent huge pages (with
+       /sys/kernel/mm/transparent_hugepage/enabled 'madvise' or 'always')
+     - 'explicit' maps them from the pool reserved in vm.nr_hugepages, and
+       asks for transparent ones when it is out
+     - 'off' (the default) gives new blocks ordinary pages
+
+    :returns: True if new blocks get huge pages, False for 'off' or if it
+        isn't Linux
+    """
+    if mode not in _huge_page_modes:
+        raise ValueError('{0} is not a huge page mode, one of {1}'
+                         .format(mode, sorted(_huge_page_modes)))
+
+    return bool(utils.SetHugePages(_huge_page_modes[mode], _tag_mask(tags)))
+
+
+def get_huge_pages():
+    """
+    returns the huge page mode, and the subsystems that get them
+    """
+    cdef long mask = 0
+    cdef short mode = utils.GetHugePages(&mask)
+
+    names = [name for name, value in _huge_page_modes.iteritems()
+             if value == mode]
+
+    return names[0], [name for i, name in enumerate(_tag_names())
+                      if mask & (1 << i)]
+
+
+def open_tlb_counters():
+    """
+    Starts the hardware counters of the TLB misses of this process, for
+    read_tlb_counters(). They count this thread and the threads started
+    after, so open them before the first run.
+
+    :returns: False if the counters can't be opened -- not Linux, a cpu or
+        a virtual machine without them, or /proc/sys/kernel/
+        perf_event_paranoid too high
+    """
+    return bool(utils.OpenTLBCounters())
+
+
+def close_tlb_counters():
+    utils.CloseTLBCounters()
+
+
+def read_tlb_counters():
+    """
+    returns the TLB misses since open_tlb_counters(), as a dict of counter
+    name ('dtlb_load_misses', 'dtlb_store_misses', 'itlb_load_misses') to
+    the count, None for the ones that couldn't be opened
+    """
+    cdef int64_t counts[utils.kNumTLBCounters]
+    cdef short i
+
+    utils.ReadTLBCounters(counts)
+
+    tlb = {}
+    for i in range(utils.kNumTLBCounters):
+        tlb[utils.GetTLBCounterName(i)] = counts[i] if counts[i] >= 0 else None
+
+    return tlb
+
+
+def open_section_counters():
+    """
+    Starts the hardware counters of the cycles, instructions, last level
+    cache misses and branch misses of this process, opened like the TLB
+    counters. While they are open the timed lib_gnome sections add them up
+    (CyMover.get_timing_stats(), with GNOME_TIMING), and so do the stages
+    of Model.step() (Model.stage_counters).
+
+    :returns: False if the counters can't be opened
+    """
+    return bool(utils.OpenSectionCounters())
+
+
+def close_section_counters():
+    utils.CloseSectionCounters()
+
+
+def section_counters_open():
+    return bool(utils.GetSectionCountersOpen())
+
+
+def read_section_counters():
+    """
+    returns the counts since open_section_counters(), as a dict of counter
+    name ('cycles', 'instructions', 'llc_misses', 'branch_misses') to the
+    count, None for the ones that couldn't be opened
+    """
+    cdef int64_t counts[utils.kNumSectionCounters]
+    cdef short i
+
+    utils.ReadSectionCounters(counts)
+
+    section = {}
+    for i in range(utils.kNumSectionCounters):
+        section[utils.GetSectionCounterName(i)] = (counts[i] if counts[i] >= 0
+                                                   else None)
+
+    return section
+
+
+def share_handle_blocks(name, tags=('topology', 'dag_tree'), read_only=True):
+    """
+    Moves the lib_gnome blocks of the subsystems in tags (the names of
+    get_memory_usage()) to the POSIX shared memory segment name, say
+    '/gnome_1234_0', for the grids set up so far. The processes forked after
+    this share the one copy of them, copy on write or not, rather than each
+    getting its own copy as soon as it writes near them.
+
+    With read_only the segment is mapped read only in all of them, so a
+    block written to faults: only share what isn't written after setup.
+
+    :returns: the bytes moved to the segment, 0 if there was nothing to
+        move
+    :raises: OSError if the segment couldn't be made (it exists, or there
+        is no POSIX shared memory)
+    """
+    cdef int64_t moved
+
+    moved = utils.ShareHandleBlocks(name, _tag_mask(tags), read_only)
+    if moved < 0:
+        raise OSError('could not make the shared memory segment {0}'
+                      .format(name))
+
+    return moved
+
+
+def set_time_slice_cache_size(max_bytes):
+    """
+    Sets the memory cap in bytes of the time slice cache shared by the
+    gridded movers in this process. 0 (the default) turns it off.
+    """
+    utils.SetTimeSliceCacheSize(max_bytes)
+
+
+def get_time_slice_cache_size():
+    """
+    returns (memory cap, bytes in use) of the shared time slice cache
+    """
+    return (utils.GetTimeSliceCacheSize(), utils.GetTimeSliceCacheBytes())
+
+
+def set_time_slice_quantization(quantize):
+    """
+    True keeps the slices added to the time slice cache as 16 bit integers,
+    with a scale and offset for each tile of 1024 velocities, and as
+    velocities only while a mover uses them: more slices fit in the cache.
+    It is lossy, the movers get the velocities of the integers, see
+    get_time_slice_quantization_error(). Only with the cache on.
+    """
+    utils.SetTimeSliceQuantization(quantize)
+
+
+def get_time_slice_quantization():
+    return bool(utils.GetTimeSliceQuantization())
+
+
+def get_time_slice_quantization_error():
+    """
+    the largest change of a u or v by the quantization, in m/s, over the
+    slices quantized so far
+    """
+    return utils.GetTimeSliceQuantizationError()
+
+
+def set_topology_cache_dir(cache_dir):
+    """
+    Sets the directory where the topology built for curvilinear grids is
+    saved, and looked for by later runs on the same grid. None or an empty
+    string (the default) turns it off.
+    """
+    cdef bytes dir_bytes
+
+    if cache_dir is None:
+        cache_dir = ''
+    dir_bytes = to_bytes(unicode(cache_dir))
+    utils.SetTopologyCacheDir(dir_bytes)
+
+
+def get_topology_cache_dir():
+    """
+    returns the topology cache directory, empty when it is off
+    """
+    return utils.GetTopologyCacheDir()
+
+
+def set_forcing_block_cache_dir(cache_dir):
+    """
+    Sets the directory where the blocks of forcing read from OPeNDAP URLs
+    are kept, and looked for by later reads on this machine -- of this or
+    any other process. None or an empty string (the default) turns it off,
+    and every slice is fetched from the server.
+    """
+    cdef bytes dir_bytes
+
+    if cache_dir is None:
+        cache_dir = ''
+    dir_bytes = to_bytes(unicode(cache_dir))
+    utils.SetForcingBlockCacheDir(dir_bytes)
+
+
+def get_forcing_block_cache_dir():
+    """
+    returns the forcing block cache directory, empty when it is off
+    """
+    return utils.GetForcingBlockCacheDir()
+
+
+def get_forcing_block_cache_stats():
+    """
+    returns (hits, misses): the blocks of remote forcing this process found
+    in the cache, and fetched from the server and put in it
+    """
+    cdef int64_t hits, misses
+
+    utils.GetForcingBlockCacheStats(&hits, &misses)
+    return (hits, misses)
+
+
+def get_forcing_io_stats():
+    """
+    returns what the forcing files were read with, since the process
+    started or reset_forcing_io_stats(): a dict of path to a dict of
+    'bytes_read' (of the values the netCDF gets read, as they are in the
+    file), 'nc_calls', 'opens', 'closes', 'slice_hits' and 'slice_misses'
+    (the times found in the time slice cache and read), 'block_hits' and
+    'block_misses' (of the forcing block cache), 'prefetches',
+    'prefetches_used', 'prefetches_wasted' and 'prefetch_wait_ns'.
+
+    The gridded current and wind readers count them, the calls that write
+    files aren't.
+    """
+    cdef utils.ForcingIOStats stats
+    cdef char path[256]
+    cdef long i
+    cdef short c
+
+    files = {}
+    for i in range(utils.GetNumForcingIOFiles()):
+        if not utils.GetForcingIOStats(i, path, &stats):
+            break
+
+        counts = {}
+        for c in range(utils.kNumForcingIOCounters):
+            counts[utils.GetForcingIOCounterName(c)] = stats.counts[c]
+        files[path] = counts
+
+    return files
+
+
+def reset_forcing_io_stats():
+    """
+    starts the counts of get_forcing_io_stats() over
+    """
+    utils.ResetForcingIOStats()
+
+
+def get_setup_stats():
+    """
+    returns what lib_gnome's setup stages cost since the process started
+    or reset_setup_stats(): a dict of 'stages', each stage ('topology',
+    'islands', 'dag_tree', 'year_data' and 'time_scan') to a dict of 'count'
+    and 'seconds', and 'cache_hits', each cache ('topology', 'time_index',
+    'time_values' and 'tide_table') to the number of times it served one.
+
+    The stages nest: a topology's time includes its islands and DAG tree.
+    """
+    cdef utils.SetupStageStats stages[utils.kNumSetupStages]
+    cdef int64_t hits[utils.kNumSetupCaches]
+    cdef short i
+
+    utils.GetSetupStats(stages, hits)
+
+    stage_stats = {}
+    for i in range(utils.kNumSetupStages):
+        stage_stats[utils.GetSetupStageName(i)] = {
+            'count': stages[i].count,
+            'seconds': stages[i].nanoseconds * 1e-9}
+
+    cache_hits = {}
+    for i in range(utils.kNumSetupCaches):
+        cache_hits[utils.GetSetupCacheName(i)] = hits[i]
+
+    return {'stages': stage_stats, 'cache_hits': cache_hits}
+
+
+def reset_setup_stats():
+    """
+    starts the counts of get_setup_stats() over
+    """
+    utils.ResetSetupStats()
+
+
+def open_forcing_file(path):
+    """
+    Maps a forcing file written by GridCurrentMover.write_forcing_file().
+    From then on the grids reading its source file, unchanged since, read
+    their time slices (and the curvilinear grids their topology) from it
+    instead of the NetCDF file. Raises an OSError if it isn't a forcing
+    file written on a platform like this one.
+    """
+    cdef OSErr err
+    cdef bytes path_bytes
+
+    path_bytes = to_bytes(unicode(os.path.normpath(path)))
+    err = utils.OpenForcingFile(path_bytes)
+    if err != 0:
+        raise OSError('{0} is not a forcing file that can be used here'
+                      .format(path))
+
+
+def close_forcing_files():
+    """
+    Unmaps the open forcing files, the grids read their source files again
+    """
+    utils.CloseForcingFiles()
+
+
+def get_num_forcing_files():
+    """
+    returns the number of open forcing files
+    """
+    return utils.GetNumForcingFiles()
+
+
+def set_tide_table_cache_size(max_tables):
+    """
+    Sets how many computed tide tables (a station over a few days) are kept
+    in memory, so runs that step back over the same days or several runs on
+    one station compute them once. 0 (the default) turns it off.
+    """
+    utils.SetTideTableCacheSize(max_tables)
+
+
+def get_tide_table_cache_size():
+    """
+    returns (maximum tables, tables held) of the tide table cache
+    """
+    return (utils.GetTideTableCacheSize(), utils.GetTideTableCacheCount())
+
+
+def set_tide_table_cache_dir(cache_dir):
+    """
+    Sets the directory where computed tide tables are saved, and looked for
+    by later runs. None or an empty string (the default) turns it off.
+    """
+    cdef bytes dir_bytes
+
+    if cache_dir is None:
+        cache_dir = ''
+    dir_bytes = to_bytes(unicode(cache_dir))
+    utils.SetTideTableCacheDir(dir_bytes)
+
+
+def get_tide_table_cache_dir():
+    """
+    returns the tide table cache directory, empty when it is off
+    """
+    return utils.GetTideTableCacheDir()
+
+
+def set_time_values_cache_dir(cache_dir):
+    """
+    Sets the directory where the values read from wind, current and
+    hydrology time series files are saved, so later reads of an unchanged
+    file skip parsing it. None or an empty string (the default) turns it off.
+    """
+    cdef bytes dir_bytes
+
+    if cache_dir is None:
+        cache_dir = ''
+    dir_bytes = to_bytes(unicode(cache_dir))
+    utils.SetTimeValuesCacheDir(dir_bytes)
+
+
+def get_time_values_cache_dir():
+    """
+    returns the time values cache directory, empty when it is off
+    """
+    return utils.GetTimeValuesCacheDir()
+
+
+def set_time_index_cache_dir(cache_dir):
+    """
+    Sets the directory where the times of each NetCDF file in a list of
+    forcing files are saved, so opening a model on the list again (in any
+    process) doesn't open every file to learn its times, and where the
+    [TIME] blocks of the ASCII grid current files are, so a large one isn't
+    scanned again. None or an empty string (the default) turns it off.
+    """
+    cdef bytes dir_bytes
+
+    if cache_dir is None:
+        cache_dir = ''
+    dir_bytes = to_bytes(unicode(cache_dir))
+    utils.SetTimeIndexCacheDir(dir_bytes)
+
+
+def get_time_index_cache_dir():
+    """
+    returns the time index directory, empty when it is off
+    """
+    return utils.GetTimeIndexCacheDir()
+
+
+def set_harmonic_recurrence(use_recurrence):
+    """
+    The Shio tide curves sum the harmonic constituents for every time step.
+    True steps the cosines by angle addition instead, several times faster
+    but only the same to about 1e-11 of the amplitudes. False (the default)
+    gives the same values as one time at a time.
+    """
+    utils.SetHarmonicRecurrence(use_recurrence)
+
+
+def get_harmonic_recurrence():
+    """
+    returns True if the tide curves are summed with the recurrence
+    """
+    return bool(utils.GetHarmonicRecurrence())
+
+
+def set_interpolation_simd(use_simd):
+    """
+    The batched interpolation in get_move_batch uses vector instructions
+    when the cpu has them. False forces the scalar loop, the velocities are
+    the same either way.
+    """
+    utils.SetInterpolationSIMD(use_simd)
+
+
+def set_interpolation_device(use_device):
+    """
+    True sends the batched interpolation of get_move_batch, and of the RK4
+    stages of the grid current movers, to the CUDA kernel: the time slices
+    are copied to the device once, and the velocities are the same as on
+    the cpu. The LEs are still located on the cpu.
+
+    :returns: True if the device is in use -- False if lib_gnome wasn't
+        built with GNOME_CUDA=1 or there is no device, and the cpu kernels
+        are kept
+    """
+    return bool(utils.SetInterpolationDevice(use_device))
+
+
+def get_interpolation_kernel():
+    """
+    returns the name of the interpolation kernel in use, 'cuda', 'avx2' or
+    'scalar'
+    """
+    return utils.GetInterpolationKernel()
+
+
+def set_section_tracing(on):
+    """
+    Turns on or off the trace events of the timed lib_gnome sections
+    (prepare_for_model_step, get_move, read_data, locate, interpolate).
+    Returns whether tracing is on: never without GNOME_TIMING.
+    """
+    return utils.SetSectionTracing(on)
+
+
+def get_section_tracing():
+    return utils.GetSectionTracing()
+
+
+def section_trace_clock():
+    """
+    now, in nanoseconds on the clock of the trace events
+    """
+    return utils.GetSectionTraceClock()
+
+
+def take_section_trace():
+    """
+    takes the trace events buffered in lib_gnome, oldest first: a list of
+    (section name, start ns, duration ns, thread number, number of LEs)
+    """
+    cdef utils.SectionTraceEvent events[1024]
+    cdef long i, n
+
+    trace = []
+    while True:
+        n = utils.TakeSectionTrace(events, 1024)
+        for i in range(n):
+            trace.append((utils.GetTimerName(events[i].timer),
+                          events[i].start, events[i].duration,
+                          events[i].thread, events[i].numLEs))
+        if n < 1024:
+            return trace
+
+
+def get_section_trace_dropped():
+    """
+    the events dropped because the buffer was full
+    """
+    return utils.GetSectionTraceDropped()
+
+
 cdef bytes to_bytes(unicode ucode):
     """
     Encode a string to its unicode type to default file system encoding for
@@ -84,3 +881,46 @@ def filename_as_bytes(filename):
     file_ = to_bytes(unicode(filename))
 
     return file_
+
+
+cdef class _HandleView:
+    """
+    The memory of a lib_gnome handle as an __array_interface__, for
+    handle_array(). Keeps the handle's owner alive
+    """
+    cdef object owner
+    cdef dict interface
+
+    property __array_interface__:
+        def __get__(self):
+            return self.interface
+
+
+cdef object handle_array(Handle h, dtype, owner):
+    """
+    A read-only numpy array of the handle's memory, no copy. The grids own
+    the handles they cache (the cell centers, the cell data...): owner is
+    the cython object of the grid's mover, kept alive by the array. The
+    array is only good until the grid is read again, like the handle
+    """
+    cdef _HandleView view
+    cdef long sz = 0
+
+    dtype = np.dtype(dtype)
+    if h != NULL:
+        sz = utils._GetHandleSize(h)
+
+    if sz <= 0:
+        arr = np.empty((0,), dtype=dtype)
+        arr.flags.writeable = False
+        return arr
+
+    view = _HandleView()
+    view.owner = owner
+    view.interface = {'version': 3,
+                      'shape': (sz // dtype.itemsize,),
+                      'typestr': dtype.str,
+                      'descr': dtype.descr,
+                      'data': (<size_t>h[0], True)}
+
+    return np.asarray(view)
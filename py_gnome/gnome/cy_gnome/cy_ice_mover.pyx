@@ -63,6 +63,19 @@ cdef class CyIceMover(CyGridCurrentMover):
             """
             raise OSError("IceMover_c.TextRead returned an error.")
 
+    property movement_field:
+        """
+        blend the ice and water velocities by the ice coverage once per
+        step, so each LE looks up one velocity instead of three. Gives the
+        same velocities; only velocities on the cells of single layer grids
+        use it.
+        """
+        def __get__(self):
+            return self.grid_ice.GetMovementFieldMode()
+
+        def __set__(self, value):
+            self.grid_ice.SetMovementFieldMode(value)
+
 #     def _get_points(self):
 #         """
 #             Invokes the GetPointsHdl method of TriGridVel_c object
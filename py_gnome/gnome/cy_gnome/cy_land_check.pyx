@@ -6,16 +6,31 @@ have crossed land on the raster map
 """
 
 import cython
+from cython.parallel cimport prange
 
 import numpy as np
 from gnome.utilities.geometry.cy_point_in_polygon import points_in_poly
+from gnome.utilities.packed_bitmap import PackedBitmap
 cimport numpy as cnp
 from cpython.mem cimport PyMem_Malloc, PyMem_Free
-from libc.stdint cimport int16_t, int32_t, uint8_t, uint32_t
+from libc.stdint cimport int8_t, int16_t, int32_t, int64_t, uint8_t, uint32_t
 from libc.stdlib cimport abs, div, div_t
 from libcpp cimport bool
 
 cimport type_defs
+cimport utils
+
+# tile_occupancy() values
+DEF TILE_WATER = 0
+DEF TILE_MIXED = 1
+DEF TILE_LAND = 2
+
+# LEs a thread of status_totals() and refloat_batch() sums by itself
+DEF STATUS_CHUNK = 4096
+
+# the counter based draw of refloat_batch(), the windages of
+# cy_wind_mover.update_windages() are draw 0 of the same key
+DEF REFLOAT_DRAW = 1
 
 def overlap_grid(int32_t m, int32_t n, pt1, pt2):
     """
@@ -41,7 +56,7 @@ cdef int32_t c_overlap_grid(int32_t m,
                             int32_t y1,
                             int32_t x2,
                             int32_t y2,
-                            ):
+                            ) nogil:
     """
     check if the line segment from pt1 to pt could overlap the grid of
     size (m,n).
@@ -62,7 +77,97 @@ cdef int32_t c_overlap_grid(int32_t m,
         return 1
 
 
+@cython.cdivision(True)
+cdef int64_t c_ceil_div(int64_t a, int64_t b) nogil:
+    # a / b rounded up, a >= 0 and b > 0
+    return (a + b - 1) / b
+
+
+@cython.cdivision(True)
+cdef void c_skip_water_tile(int32_t m,
+                            int32_t n,
+                            int32_t q,
+                            int32_t xs,
+                            int32_t ys,
+                            int32_t dx,
+                            int32_t dy,
+                            int32_t sx,
+                            int32_t sy,
+                            int32_t *x0,
+                            int32_t *y0,
+                            int32_t *err,
+                            ) nogil:
+    """
+    Advances the walk from (xs, ys) past the pixels after (x0, y0) that are
+    still in its tile, which is all water.
+
+    That's safe: those pixels, and the pixels of their diagonal checks,
+    which are between a pixel and the one before it, are all in the tile.
+    The walk stops on the last of them, and goes on from there as usual.
+
+    Along the major axis the walk moves one pixel a step. After k steps the
+    minor axis has moved ceil((2 k minor - major) / (2 major)) pixels (and
+    not less than 0), and err is dx - dy - |x - xs| dy + |y - ys| dx.
+    """
+    cdef int32_t xlo = (x0[0] / q) * q
+    cdef int32_t ylo = (y0[0] / q) * q
+    cdef int32_t xhi = min(xlo + q, m) - 1
+    cdef int32_t yhi = min(ylo + q, n) - 1
+    cdef int64_t k, k_end, bound, major, minor, moved
+
+    if dx >= dy:
+        major, minor = dx, dy
+        k = abs(x0[0] - xs)
+        k_end = k + (xhi - x0[0] if sx > 0 else x0[0] - xlo)
+        bound = yhi - ys if sy > 0 else ys - ylo
+    else:
+        major, minor = dy, dx
+        k = abs(y0[0] - ys)
+        k_end = k + (yhi - y0[0] if sy > 0 else y0[0] - ylo)
+        bound = xhi - xs if sx > 0 else xs - xlo
+
+    # the last step still in the tile along the minor axis
+    if minor > 0:
+        k_end = min(k_end, (2 * bound * major + major) / (2 * minor))
+    k_end = min(k_end, major)
+
+    if k_end <= k:
+        return
+
+    moved = 0
+    if 2 * k_end * minor > major:
+        moved = c_ceil_div(2 * k_end * minor - major, 2 * major)
+
+    if dx >= dy:
+        x0[0] = xs + sx * k_end
+        y0[0] = ys + sy * moved
+        err[0] = dx - dy - k_end * dy + moved * dx
+    else:
+        x0[0] = xs + sx * moved
+        y0[0] = ys + sy * k_end
+        err[0] = dx - dy - moved * dy + k_end * dx
+
+
+cdef inline bool c_land(uint8_t* grid,
+                        int32_t n,
+                        int32_t row_bytes,
+                        int32_t x,
+                        int32_t y,
+                        ) nogil:
+    """
+    is pixel (x, y) of the grid land?
+
+    row_bytes is 0 for a uint8 grid of n columns, or the bytes in each row
+    of a PackedBitmap's bits: 8 pixels a byte, the first in the high bit
+    """
+    if row_bytes == 0:
+        return grid[x * n + y] == 1
+
+    return (grid[x * row_bytes + (y >> 3)] >> (7 - (y & 7))) & 1
+
+
 @cython.boundscheck(False)
+@cython.cdivision(True)
 cdef bool c_find_first_pixel( uint8_t* grid,
                              int32_t m,
                              int32_t n,
@@ -74,7 +179,10 @@ cdef bool c_find_first_pixel( uint8_t* grid,
                              int32_t *prev_y,
                              int32_t *hit_x,
                              int32_t *hit_y,
-                             ):
+                             uint8_t* tiles,
+                             int32_t tile_ratio,
+                             int32_t row_bytes,
+                             ) nogil:
     """
     Marches along the grid to see if the LE movement crosses land
     
@@ -83,11 +191,25 @@ cdef bool c_find_first_pixel( uint8_t* grid,
     returns True is a land pixel is hit.
 
     the passed-in values hit_x and hit_y are set to the pixel hit
+
+    tiles, if not NULL, is the tile_occupancy() of the grid for tiles of
+    tile_ratio pixels: the pixels in all water tiles are passed over without
+    reading them, and the ones in all land tiles are land. Only the pixels
+    in mixed tiles are read. The result is the same.
+
+    row_bytes is 0 for a uint8 grid, or the row length of a packed one (see
+    c_land)
     """
     cdef int32_t dx, dy, sx, sy, err, e2,
     cdef int32_t pt1_x, pt1_y, pt2_x, pt2_y
+    cdef int32_t xs = x0, ys = y0
+    cdef uint8_t tile = TILE_MIXED
+    cdef int32_t tn = 0
     cdef bool was_on_grid = False
 
+    if tiles != NULL:
+        tn = (n + tile_ratio - 1) / tile_ratio
+
     # check if totally off the grid
     if not c_overlap_grid(m, n, x0, y0, x1, y1):
         return False
@@ -111,7 +233,7 @@ cdef bool c_find_first_pixel( uint8_t* grid,
     if not (x0 < 0 or x0 >= m or y0 < 0 or y0 >= n):#  is the point off the grid? if so, it's not land!
         ##fixme: we should never be starting on land!
         ## should this raise an Error instead ?
-        if grid[x0 * n + y0] == 1: #we've hit "land"
+        if c_land(grid, n, row_bytes, x0, y0): #we've hit "land"
             prev_x[0] = x0
             prev_y[0] = y0
             hit_x[0] = x0
@@ -145,7 +267,10 @@ cdef bool c_find_first_pixel( uint8_t* grid,
                 continue
         else:
             was_on_grid = True
-            if grid[x0 * n + y0] == 1:
+            if tiles != NULL:
+                tile = tiles[(x0 / tile_ratio) * tn + y0 / tile_ratio]
+            if (tile == TILE_LAND or
+                    (tile == TILE_MIXED and c_land(grid, n, row_bytes, x0, y0))):
                 hit_x[0] = x0
                 hit_y[0] = y0
                 # return (*prev_x, *prev_y), (*hit_x, *hit_y)
@@ -157,16 +282,18 @@ cdef bool c_find_first_pixel( uint8_t* grid,
                     pt1_y = y0-sy
                     pt2_x = x0-sx
                     pt2_y = y0
-                    try: # replace with real check???
-                        if ( (grid[pt1_x * n + pt1_y] == 1) and #is the y-adjacent point on land?
-                             (grid[pt2_x * n + pt2_y] == 1)     #is the x-adjacent point on land?
-                            ):
-                            hit_x[0] = pt1_x # we have to pick one -- this is arbitrary
-                            hit_y[0] = pt1_y # we have to pick one -- this is arbitrary
-                            #return (*prev_x, *prev_y), (*hit_x, *hit_y)
-                            return True
-                    except IndexError:
-                        pass
+                    # replace with real check??? (the grid is a raw pointer,
+                    # so there's no IndexError to catch here)
+                    if ( c_land(grid, n, row_bytes, pt1_x, pt1_y) and #is the y-adjacent point on land?
+                         c_land(grid, n, row_bytes, pt2_x, pt2_y)     #is the x-adjacent point on land?
+                        ):
+                        hit_x[0] = pt1_x # we have to pick one -- this is arbitrary
+                        hit_y[0] = pt1_y # we have to pick one -- this is arbitrary
+                        #return (*prev_x, *prev_y), (*hit_x, *hit_y)
+                        return True
+                if tile == TILE_WATER:
+                    c_skip_water_tile(m, n, tile_ratio, xs, ys, dx, dy,
+                                      sx, sy, &x0, &y0, &err)
 
     # if we get here, no hit
     return False
@@ -224,6 +351,9 @@ def find_first_pixel(grid, pt1, pt2):
                                 &prev_y,
                                 &hit_x,
                                 &hit_y,
+                                NULL,
+                                0,
+                                0,
                                 )
 
     if result:
@@ -273,6 +403,9 @@ def check_land(cnp.ndarray[uint8_t, ndim=2, mode='c'] grid not None,
                                          &prev_y,
                                          &hit_x,
                                          &hit_y,
+                                         NULL,
+                                         0,
+                                         0,
                                          )
             if did_hit:
                 last_water_positions[i, 0] = prev_x
@@ -286,6 +419,426 @@ def check_land(cnp.ndarray[uint8_t, ndim=2, mode='c'] grid not None,
                 positions[i, 1] = end_positions[i, 1]
         return None
 
+cdef bool c_walk_layers(uint8_t** dataptrs,
+                        int32_t* widths,
+                        int32_t* heights,
+                        int32_t* row_bytes,
+                        int32_t* grid_ratios,
+                        int32_t num_ratios,
+                        int32_t x0,
+                        int32_t y0,
+                        int32_t x1,
+                        int32_t y1,
+                        int32_t *prev_x,
+                        int32_t *prev_y,
+                        int32_t *hit_x,
+                        int32_t *hit_y,
+                        uint8_t** tiles,
+                        int32_t* tile_ratios,
+                        ) nogil:
+    """
+    walks one LE's move from the coarsest layer down
+
+    begin the walk. If a hit is registered on the current grid, drop down
+    one level and continue the walk. If a hit is registered on the lowest
+    level, then LE has landed -- returns True with prev_x, prev_y, hit_x
+    and hit_y set like c_find_first_pixel does
+
+    tiles, if not NULL, holds the tile occupancy of each layer, for tiles of
+    tile_ratios pixels (NULL for a layer without). row_bytes is 0 for the
+    uint8 layers and the row length of the packed ones
+    """
+    cdef int32_t layer = 0
+
+    while True:
+        if c_find_first_pixel(dataptrs[layer],
+                              widths[layer],
+                              heights[layer],
+                              div(x0, grid_ratios[layer]).quot,
+                              div(y0, grid_ratios[layer]).quot,
+                              div(x1, grid_ratios[layer]).quot,
+                              div(y1, grid_ratios[layer]).quot,
+                              prev_x,
+                              prev_y,
+                              hit_x,
+                              hit_y,
+                              tiles[layer] if tiles != NULL else NULL,
+                              tile_ratios[layer] if tiles != NULL else 0,
+                              row_bytes[layer],
+                              ):
+            if layer == num_ratios - 1:
+                # hit on the lowest layer (confirmed land hit)
+                return True
+            # possible hit, go down a layer and try again
+            layer += 1
+        else:
+            return False
+
+
+cdef bool c_box_is_water(int32_t* land_counts,
+                         int32_t m,
+                         int32_t n,
+                         int32_t x0,
+                         int32_t y0,
+                         int32_t x1,
+                         int32_t y1,
+                         ) nogil:
+    """
+    True if there's no land in the pixels of the box with corners (x0, y0)
+    and (x1, y1), clipped to the (m, n) grid.
+
+    land_counts is the (m + 1, n + 1) summed area table of the grid: element
+    [i, j] is the number of land pixels in grid[:i, :j]
+
+    Bresenham's walk, diagonal checks included, never leaves the box of its
+    end points, so a move with no land in its box can't hit any.
+    """
+    cdef int32_t xmin = max(min(x0, x1), 0)
+    cdef int32_t xmax = min(max(x0, x1), m - 1)
+    cdef int32_t ymin = max(min(y0, y1), 0)
+    cdef int32_t ymax = min(max(y0, y1), n - 1)
+    cdef int32_t w = n + 1
+
+    if xmin > xmax or ymin > ymax:
+        # all off the grid
+        return True
+
+    return (land_counts[(xmax + 1) * w + ymax + 1] -
+            land_counts[xmin * w + ymax + 1] -
+            land_counts[(xmax + 1) * w + ymin] +
+            land_counts[xmin * w + ymin]) == 0
+
+
+def land_count_table(cnp.ndarray[uint8_t, ndim=2, mode='c'] grid not None):
+    """
+    The summed area table of a raster for check_land_layers_batch: an
+    (m + 1, n + 1) int32 array, [i, j] is the number of land pixels in
+    grid[:i, :j]
+    """
+    counts = np.zeros((grid.shape[0] + 1, grid.shape[1] + 1), dtype=np.int32)
+    counts[1:, 1:] = (grid == 1).cumsum(axis=0, dtype=np.int32).cumsum(axis=1)
+
+    return counts
+
+
+cdef uint8_t* _packed_bits(packed) except NULL:
+    """
+    the address of a PackedBitmap's bits, which need not be writable
+    """
+    cdef cnp.ndarray bits = packed.bits
+
+    if (bits.dtype != np.uint8 or not bits.flags['C_CONTIGUOUS'] or
+            bits.shape[0] != packed.shape[0] or
+            bits.shape[1] != (packed.shape[1] + 7) // 8):
+        raise ValueError('not the bits of a PackedBitmap')
+
+    return <uint8_t*> cnp.PyArray_DATA(bits)
+
+
+@cython.boundscheck(False)
+@cython.cdivision(True)
+def _packed_tile_occupancy(packed, int32_t ratio):
+    """
+    tile_occupancy() of a PackedBitmap, from its bytes: each row of a tile
+    is tested 8 pixels at a time, masking the partial bytes at its ends
+    """
+    cdef uint8_t* bits = _packed_bits(packed)
+    cdef int32_t m = packed.shape[0], n = packed.shape[1]
+    cdef int32_t row_bytes = (n + 7) // 8
+    cdef int32_t tm = (m + ratio - 1) // ratio, tn = (n + ratio - 1) // ratio
+    cdef int32_t x, tx, ty, y0, y1, b, b0, b1
+    cdef uint8_t mask, byte
+    cdef bool any_land, all_land
+
+    tiles = np.empty((tm, tn), dtype=np.uint8)
+    cdef uint8_t[:, ::1] out = tiles
+
+    with nogil:
+        for tx in range(tm):
+            for ty in range(tn):
+                y0 = ty * ratio
+                y1 = min(y0 + ratio, n)  # one past the last column
+                b0 = y0 >> 3
+                b1 = (y1 - 1) >> 3
+                any_land = False
+                all_land = True
+
+                for x in range(tx * ratio, min(tx * ratio + ratio, m)):
+                    for b in range(b0, b1 + 1):
+                        # the pixels of byte b in [y0, y1)
+                        mask = 0xFF
+                        if b == b0:
+                            mask = mask & (0xFF >> (y0 & 7))
+                        if b == b1 and (y1 & 7) != 0:
+                            mask = mask & <uint8_t> (0xFF << (8 - (y1 & 7)))
+
+                        byte = bits[x * row_bytes + b] & mask
+                        any_land = any_land or byte != 0
+                        all_land = all_land and byte == mask
+
+                    if any_land and not all_land:
+                        break
+
+                if not any_land:
+                    out[tx, ty] = TILE_WATER
+                elif all_land:
+                    out[tx, ty] = TILE_LAND
+                else:
+                    out[tx, ty] = TILE_MIXED
+
+    return tiles
+
+
+def tile_occupancy(grid, int32_t ratio):
+    """
+    Sorts the (ratio, ratio) pixel tiles of a raster for c_find_first_pixel:
+    a uint8 array of the ceil(m / ratio), ceil(n / ratio) tiles, TILE_WATER
+    (0) if none of its pixels are land, TILE_LAND (2) if they all are and
+    TILE_MIXED (1) otherwise. The tiles on the right and top edges have only
+    the pixels in the grid.
+
+    grid is a uint8 array or a PackedBitmap
+    """
+    if isinstance(grid, PackedBitmap):
+        return _packed_tile_occupancy(grid, ratio)
+
+    return _tile_occupancy_array(grid, ratio)
+
+
+def _tile_occupancy_array(cnp.ndarray[uint8_t, ndim=2, mode='c'] grid not None,
+                          int32_t ratio):
+    cdef int32_t m = grid.shape[0], n = grid.shape[1]
+    cdef int32_t tm = (m + ratio - 1) // ratio, tn = (n + ratio - 1) // ratio
+
+    land = np.zeros((tm * ratio, tn * ratio), dtype=np.int32)
+    land[:m, :n] = grid == 1
+    pixels = np.zeros((tm * ratio, tn * ratio), dtype=np.int32)
+    pixels[:m, :n] = 1
+
+    land = land.reshape(tm, ratio, tn, ratio).sum(axis=(1, 3))
+    pixels = pixels.reshape(tm, ratio, tn, ratio).sum(axis=(1, 3))
+
+    tiles = np.empty((tm, tn), dtype=np.uint8)
+    tiles.fill(TILE_MIXED)
+    tiles[land == 0] = TILE_WATER
+    tiles[land == pixels] = TILE_LAND
+
+    return tiles
+
+
+# distance_field() saturates here
+DEF MAX_DISTANCE = 127
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def distance_field(grid):
+    """
+    The signed chessboard distance from each pixel of a raster to the
+    nearest pixel of the other kind, in pixels: positive in the water
+    (the distance to land), negative on land (the distance to water), as an
+    int8 array of the raster's shape. Distances over MAX_DISTANCE (127) are
+    127.
+
+    A move of fewer than d pixels along each axis from a water pixel at
+    distance d stays in the water, so the land check can skip its walk --
+    see check_land_layers_batch.
+
+    Two passes of the 3x3 chamfer, which is exact for the chessboard
+    distance. A pixel's neighbors of the other kind are at distance 0.
+
+    grid is a uint8 array or a PackedBitmap
+    """
+    cdef uint8_t* data
+    cdef cnp.ndarray[uint8_t, ndim=2, mode="c"] grid_arr
+    cdef int32_t m, n, row_bytes, x, y, k, nx, ny
+    cdef int32_t best, v
+    cdef bool land
+    cdef int32_t[4] dxs = [-1, -1, -1, 0]
+    cdef int32_t[4] dys = [-1, 0, 1, -1]
+
+    if isinstance(grid, PackedBitmap):
+        data = _packed_bits(grid)
+        m, n = grid.shape
+        row_bytes = grid.bits.shape[1]
+    else:
+        grid_arr = grid
+        data = &grid_arr[0, 0]
+        m, n = grid_arr.shape[0], grid_arr.shape[1]
+        row_bytes = 0
+
+    field = np.empty((m, n), dtype=np.uint8)
+    cdef uint8_t[:, ::1] mag = field
+
+    with nogil:
+        # forward: the neighbors before the pixel
+        for x in range(m):
+            for y in range(n):
+                land = c_land(data, n, row_bytes, x, y)
+                best = MAX_DISTANCE
+                for k in range(4):
+                    nx = x + dxs[k]
+                    ny = y + dys[k]
+                    if nx < 0 or ny < 0 or ny >= n:
+                        continue
+                    v = (mag[nx, ny] if c_land(data, n, row_bytes, nx, ny) == land
+                         else 0)
+                    best = min(best, v + 1)
+                mag[x, y] = best
+
+        # backward: the neighbors after it
+        for x in range(m - 1, -1, -1):
+            for y in range(n - 1, -1, -1):
+                land = c_land(data, n, row_bytes, x, y)
+                best = mag[x, y]
+                for k in range(4):
+                    nx = x - dxs[k]
+                    ny = y - dys[k]
+                    if nx >= m or ny < 0 or ny >= n:
+                        continue
+                    v = (mag[nx, ny] if c_land(data, n, row_bytes, nx, ny) == land
+                         else 0)
+                    best = min(best, v + 1)
+                mag[x, y] = best
+
+    signed = field.astype(np.int8)
+    land_pixels = (np.asarray(grid) == 1)
+    signed[land_pixels] = -signed[land_pixels]
+
+    return signed
+
+
+@cython.boundscheck(False)
+def pixels_on_land(grid,
+                   cnp.ndarray[int32_t, ndim=2, mode='c'] pixels not None):
+    """
+    which of the pixels are land pixels of the grid, a uint8 raster or a
+    PackedBitmap: the pixels off the grid are not. The points are looked
+    up on threads.
+
+    :param pixels: (x, y) pixel coordinates
+    :type pixels: Nx2 int32 array
+
+    returns a bool array, one for each pixel
+    """
+    cdef cnp.ndarray[uint8_t, ndim=2, mode='c'] grid_arr
+    cdef uint8_t* data
+    cdef int32_t m, n, row_bytes = 0
+    cdef Py_ssize_t i, num = pixels.shape[0]
+    cdef int32_t x, y
+
+    if num > 0 and pixels.shape[1] < 2:
+        raise ValueError('pixels need x and y')
+
+    if isinstance(grid, PackedBitmap):
+        data = _packed_bits(grid)
+        m, n = grid.shape
+        row_bytes = grid.bits.shape[1]
+    else:
+        grid_arr = grid
+        data = &grid_arr[0, 0]
+        m = grid_arr.shape[0]
+        n = grid_arr.shape[1]
+
+    cdef cnp.ndarray[uint8_t, ndim=1, mode='c'] land = \
+        np.zeros((num, ), dtype=np.uint8)
+
+    with nogil:
+        for i in prange(num, schedule='static'):
+            x = pixels[i, 0]
+            y = pixels[i, 1]
+            if x >= 0 and y >= 0 and x < m and y < n:
+                land[i] = c_land(data, n, row_bytes, x, y)
+
+    return land.view(np.bool_)
+
+
+cdef class _Layers:
+    """
+    the raw pointers to the layers of a raster map, kept as long as the
+    arrays are referenced. A layer is a uint8 array or a PackedBitmap
+    """
+    cdef list arrays
+    cdef uint8_t** dataptrs
+    cdef int32_t* widths
+    cdef int32_t* heights
+    cdef int32_t* row_bytes
+    cdef uint8_t** tiles
+    cdef int32_t* tile_ratios
+    cdef int32_t num
+
+    def __cinit__(self, grid_layers, int32_t num):
+        cdef cnp.ndarray[uint8_t, ndim=2, mode="c"] grid_arr
+        cdef int32_t i
+
+        self.num = num
+        self.arrays = []
+        self.dataptrs = <uint8_t**> PyMem_Malloc(num * sizeof(uint8_t *))
+        self.widths = <int32_t*> PyMem_Malloc(num * sizeof(int32_t))
+        self.heights = <int32_t*> PyMem_Malloc(num * sizeof(int32_t))
+        self.row_bytes = <int32_t*> PyMem_Malloc(num * sizeof(int32_t))
+        self.tiles = NULL
+        self.tile_ratios = NULL
+        if (not self.dataptrs or not self.widths or not self.heights or
+                not self.row_bytes):
+            raise MemoryError()
+
+        for i in range(num):
+            layer = grid_layers[i]
+            if isinstance(layer, PackedBitmap):
+                # the bits may be a read only map (PackedBitmap.share)
+                self.dataptrs[i] = _packed_bits(layer)
+                self.arrays.append(layer.bits)
+                self.widths[i], self.heights[i] = layer.shape
+                self.row_bytes[i] = layer.bits.shape[1]
+            else:
+                grid_arr = layer
+                self.arrays.append(grid_arr)
+                self.widths[i] = grid_arr.shape[0]
+                self.heights[i] = grid_arr.shape[1]
+                self.dataptrs[i] = &grid_arr[0, 0]
+                self.row_bytes[i] = 0
+
+    def set_tiles(self, tiles,
+                  cnp.ndarray[int32_t, ndim=1, mode='c'] grid_ratios):
+        """
+        tiles[i] is the tile_occupancy() of layer i + 1 for the tiles of
+        the pixels of layer i. The coarsest layer has no tiles.
+        """
+        cdef cnp.ndarray[uint8_t, ndim=2, mode="c"] tile_arr
+        cdef int32_t i, ratio
+
+        if len(tiles) != self.num - 1:
+            raise ValueError('need the tiles of all but the coarsest layer')
+
+        self.tiles = <uint8_t**> PyMem_Malloc(self.num * sizeof(uint8_t *))
+        self.tile_ratios = <int32_t*> PyMem_Malloc(self.num * sizeof(int32_t))
+        if not self.tiles or not self.tile_ratios:
+            raise MemoryError()
+
+        self.tiles[0] = NULL
+        self.tile_ratios[0] = 0
+        for i in range(1, self.num):
+            tile_arr = tiles[i - 1]
+            ratio = grid_ratios[i - 1] // grid_ratios[i]
+            if (tile_arr.shape[0] != (self.widths[i] + ratio - 1) // ratio or
+                    tile_arr.shape[1] != (self.heights[i] + ratio - 1) // ratio):
+                raise ValueError('tiles {0} are not the tiles of layer {1}'
+                                 .format(i - 1, i))
+
+            self.arrays.append(tile_arr)
+            self.tiles[i] = &tile_arr[0, 0]
+            self.tile_ratios[i] = ratio
+
+    def __dealloc__(self):
+        PyMem_Free(self.dataptrs)
+        PyMem_Free(self.widths)
+        PyMem_Free(self.heights)
+        PyMem_Free(self.row_bytes)
+        PyMem_Free(self.tiles)
+        PyMem_Free(self.tile_ratios)
+
+
 ## called by a method in gnome.map.RasterMap class
 @cython.boundscheck(False)
 @cython.wraparound(False)
@@ -305,82 +858,348 @@ def check_land_layers(grid_layers,
         This version will look through multiple layers of raster map
 
         """
-        cdef int32_t  prev_x, prev_y, hit_x, hit_y, cur_ratio, layer, coarse_pos_x, num_ratios
+        cdef int32_t  prev_x, prev_y, hit_x, hit_y
         cdef uint32_t i, num_le
-        cdef int32_t m, n
         cdef bool did_hit
-        cdef int32_t* coarse_pos = <int32_t*> PyMem_Malloc (2*sizeof(int32_t))
-        cdef int32_t* coarse_end = <int32_t*> PyMem_Malloc (2*sizeof(int32_t))
-
-        num_ratios = grid_ratios.shape[0]
-        cdef uint8_t** dataptrs = <uint8_t**> PyMem_Malloc(num_ratios*sizeof(uint8_t *))
-        cdef int32_t* widths = <int32_t*> PyMem_Malloc(num_ratios*sizeof(int32_t))
-        cdef int32_t* heights = <int32_t*> PyMem_Malloc(num_ratios*sizeof(int32_t))
-
-        cdef cnp.ndarray[uint8_t, ndim=2, mode="c"] grid_arr
-        for i in range(num_ratios):
-            grid_arr = grid_layers[i]
-            widths[i] = grid_layers[i].shape[0]
-            heights[i] = grid_layers[i].shape[1]
-            dataptrs[i] = &grid_arr[0,0]
+        cdef _Layers layers = _Layers(grid_layers, grid_ratios.shape[0])
 
         num_le = positions.shape[0]
 
         for i in range(num_le):
-            #if the LE is on land, or if it starts and ends in the same water-only square on the coarsest grid, skip this LE
+            #if the LE is on land, skip this LE
             if status_codes[i] == type_defs.OILSTAT_ONLAND:
                 continue
 
-            layer = 0
-            #begin the walk. If a hit is registered on the current grid, drop down one level and continue the walk.
-            #If a hit is registered on the lowest level, then LE has landed.
-            while True:
-                coarse_pos[0] = div(positions[i,0], grid_ratios[layer]).quot
-                coarse_pos[1] = div(positions[i,1], grid_ratios[layer]).quot
-                coarse_end[0] = div(end_positions[i,0], grid_ratios[layer]).quot
-                coarse_end[1] = div(end_positions[i,1], grid_ratios[layer]).quot
-                cur_ratio = grid_ratios[layer]
-                did_hit = c_find_first_pixel(dataptrs[layer],
-                                         widths[layer],
-                                         heights[layer],
-                                         coarse_pos[0],
-                                         coarse_pos[1],
-                                         coarse_end[0],
-                                         coarse_end[1],
-                                         &prev_x,
-                                         &prev_y,
-                                         &hit_x,
-                                         &hit_y,
-                                         )
+            did_hit = c_walk_layers(layers.dataptrs,
+                                    layers.widths,
+                                    layers.heights,
+                                    layers.row_bytes,
+                                    &grid_ratios[0],
+                                    layers.num,
+                                    positions[i, 0],
+                                    positions[i, 1],
+                                    end_positions[i, 0],
+                                    end_positions[i, 1],
+                                    &prev_x,
+                                    &prev_y,
+                                    &hit_x,
+                                    &hit_y,
+                                    NULL,
+                                    NULL,
+                                    )
+            if did_hit:
+                last_water_positions[i, 0] = prev_x
+                last_water_positions[i, 1] = prev_y
+                end_positions[i,0] = hit_x
+                end_positions[i,1] = hit_y
+                status_codes[i] = type_defs.OILSTAT_ONLAND
+            else:
+                # didn't hit land -- can move the LE
+                positions[i, 0] = end_positions[i, 0]
+                positions[i, 1] = end_positions[i, 1]
+
+
+## called by a method in gnome.map.RasterMap class
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def check_land_layers_batch(grid_layers,
+                cnp.ndarray[int32_t, ndim=1, mode='c'] grid_ratios,
+                cnp.ndarray[int32_t, ndim=2, mode='c'] positions,
+                cnp.ndarray[int32_t, ndim=2, mode='c'] end_positions,
+                cnp.ndarray[int16_t, ndim=1, mode='c'] status_codes,
+                cnp.ndarray[int32_t, ndim=2, mode='c'] last_water_positions,
+                cnp.ndarray[int32_t, ndim=2, mode='c'] land_counts=None,
+                tiles=None,
+                cnp.ndarray[int8_t, ndim=2, mode='c'] distance=None,
+                int chunk=256):
+        """
+        check_land_layers for many LEs: the same result, with the GIL
+        released and the LEs split over threads in chunks of chunk LEs
+        (when cy_land_check is built with OpenMP, GNOME_OPENMP=1)
+
+        any of grid_layers can be a PackedBitmap, read one bit per pixel
+
+        land_counts is the summed area table of the coarsest layer (see
+        land_count_table()). If it's passed, the LEs whose move has no land
+        in the box of its coarse pixels are moved without walking them -- in
+        open water that's most of them.
+
+        tiles, if passed, is the tile_occupancy() of each layer but the
+        coarsest for the tiles of the pixels of the layer above it, so the
+        walks only read the pixels near the shore: the finer layers can be
+        made finer without the walks getting that much slower.
+
+        distance, if passed, is the distance_field() of the finest layer:
+        the LEs that start in the water closer to it than to any land along
+        x and y can't reach land, and are moved without a walk.
+
+        returns the number of LEs that beached
+        """
+        cdef int32_t  prev_x, prev_y, hit_x, hit_y, r, x0, y0, base_m, base_n
+        cdef int i, num_le
+        cdef int num_beached = 0
+        cdef bool did_hit
+        cdef _Layers layers = _Layers(grid_layers, grid_ratios.shape[0])
+        cdef int32_t* ratios = &grid_ratios[0]
+        cdef int32_t* counts = NULL
+        cdef int8_t* dist = NULL
+
+        base_m = layers.widths[layers.num - 1]
+        base_n = layers.heights[layers.num - 1]
+        if distance is not None:
+            if (distance.shape[0] != base_m or distance.shape[1] != base_n or
+                    grid_ratios[layers.num - 1] != 1):
+                raise ValueError('distance is not the distance field of the '
+                                 'finest layer')
+            dist = &distance[0, 0]
+
+        if land_counts is not None:
+            if (land_counts.shape[0] != layers.widths[0] + 1 or
+                    land_counts.shape[1] != layers.heights[0] + 1):
+                raise ValueError('land_counts is not the size of the '
+                                 'coarsest layer plus one')
+            counts = &land_counts[0, 0]
+
+        if tiles is not None:
+            layers.set_tiles(tiles, grid_ratios)
+
+        if chunk < 1:
+            chunk = 1
+
+        num_le = positions.shape[0]
+
+        with nogil:
+            for i in prange(num_le, schedule='dynamic', chunksize=chunk):
+                if status_codes[i] == type_defs.OILSTAT_ONLAND:
+                    continue
+
+                # assigned here so each thread has its own
+                prev_x = positions[i, 0]
+                prev_y = positions[i, 1]
+                hit_x = end_positions[i, 0]
+                hit_y = end_positions[i, 1]
+
+                x0 = positions[i, 0]
+                y0 = positions[i, 1]
+                if (dist != NULL and
+                        x0 >= 0 and x0 < base_m and y0 >= 0 and y0 < base_n and
+                        max(abs(end_positions[i, 0] - x0),
+                            abs(end_positions[i, 1] - y0)) <
+                        dist[x0 * base_n + y0]):
+                    positions[i, 0] = end_positions[i, 0]
+                    positions[i, 1] = end_positions[i, 1]
+                    continue
+
+                r = ratios[0]
+                if counts != NULL and c_box_is_water(counts,
+                                                     layers.widths[0],
+                                                     layers.heights[0],
+                                                     div(positions[i, 0], r).quot,
+                                                     div(positions[i, 1], r).quot,
+                                                     div(end_positions[i, 0], r).quot,
+                                                     div(end_positions[i, 1], r).quot):
+                    did_hit = False
+                else:
+                    did_hit = c_walk_layers(layers.dataptrs,
+                                            layers.widths,
+                                            layers.heights,
+                                            layers.row_bytes,
+                                            ratios,
+                                            layers.num,
+                                            positions[i, 0],
+                                            positions[i, 1],
+                                            end_positions[i, 0],
+                                            end_positions[i, 1],
+                                            &prev_x,
+                                            &prev_y,
+                                            &hit_x,
+                                            &hit_y,
+                                            layers.tiles,
+                                            layers.tile_ratios,
+                                            )
                 if did_hit:
-                    if layer == num_ratios - 1:
-                        # hit on the lowest layer (confirmed land hit)
-                        last_water_positions[i, 0] = prev_x
-                        last_water_positions[i, 1] = prev_y
-                        end_positions[i,0] = hit_x
-                        end_positions[i,1] = hit_y
-                        status_codes[i] = type_defs.OILSTAT_ONLAND
-                        break
-                    else:
-                        # possible hit, go down a layer and try again
-                        layer += 1
-                        coarse_pos[0] = div(positions[i,0], grid_ratios[layer]).quot
-                        coarse_pos[1] = div(positions[i,1], grid_ratios[layer]).quot
-                        coarse_end[0] = div(end_positions[i,0], grid_ratios[layer]).quot
-                        coarse_end[1] = div(end_positions[i,1], grid_ratios[layer]).quot
+                    last_water_positions[i, 0] = prev_x
+                    last_water_positions[i, 1] = prev_y
+                    end_positions[i, 0] = hit_x
+                    end_positions[i, 1] = hit_y
+                    status_codes[i] = type_defs.OILSTAT_ONLAND
+                    num_beached += 1
                 else:
                     # didn't hit land -- can move the LE
                     positions[i, 0] = end_positions[i, 0]
                     positions[i, 1] = end_positions[i, 1]
-                    break
 
-        PyMem_Free(coarse_pos)
-        PyMem_Free(coarse_end)
-        PyMem_Free(dataptrs)
-        PyMem_Free(widths)
-        PyMem_Free(heights)
-        
-        
+        return num_beached
+
+
+def status_totals(cnp.ndarray[int16_t, ndim=1, mode='c'] status_codes not None,
+                  cnp.ndarray[cnp.float64_t, ndim=1, mode='c'] mass=None):
+    """
+    the number of LEs on land and off the maps, and their mass (0 with no
+    mass), without masks of the status codes
+
+    the LEs are summed on threads in chunks of STATUS_CHUNK, and the chunks
+    added up in order, so the masses don't depend on the number of threads
+
+    returns (num_on_land, mass_on_land, num_off_maps, mass_off_maps)
+    """
+    cdef Py_ssize_t num_le = status_codes.shape[0]
+    cdef Py_ssize_t num_chunks = (num_le + STATUS_CHUNK - 1) // STATUS_CHUNK
+    cdef Py_ssize_t c, i, end
+    cdef int16_t* status = NULL
+    cdef double* m = NULL
+    cdef int64_t num_on_land = 0, num_off_maps = 0
+    cdef double mass_on_land = 0., mass_off_maps = 0.
+
+    if num_le == 0:
+        return (0, 0., 0, 0.)
+
+    if mass is not None:
+        if mass.shape[0] != num_le:
+            raise ValueError('mass is not the length of status_codes')
+        m = &mass[0]
+    status = &status_codes[0]
+
+    cdef cnp.ndarray[int64_t, ndim=2, mode='c'] counts = \
+        np.zeros((num_chunks, 2), dtype=np.int64)
+    cdef cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] masses = \
+        np.zeros((num_chunks, 2), dtype=np.float64)
+
+    with nogil:
+        for c in prange(num_chunks, schedule='static'):
+            end = min((c + 1) * STATUS_CHUNK, num_le)
+            for i in range(c * STATUS_CHUNK, end):
+                if status[i] == type_defs.OILSTAT_ONLAND:
+                    counts[c, 0] += 1
+                    if m != NULL:
+                        masses[c, 0] += m[i]
+                elif status[i] == type_defs.OILSTAT_OFFMAPS:
+                    counts[c, 1] += 1
+                    if m != NULL:
+                        masses[c, 1] += m[i]
+
+    for c in range(num_chunks):
+        num_on_land += counts[c, 0]
+        num_off_maps += counts[c, 1]
+        mass_on_land += masses[c, 0]
+        mass_off_maps += masses[c, 1]
+
+    return (num_on_land, mass_on_land, num_off_maps, mass_off_maps)
+
+
+def refloat_batch(cnp.ndarray[int16_t, ndim=1, mode='c'] status_codes not None,
+                  cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] positions not None,
+                  cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] last_water_positions not None,
+                  cnp.ndarray[cnp.float64_t, ndim=1, mode='c'] rnd=None,
+                  double probability=1.,
+                  cnp.ndarray[uint32_t, ndim=1, mode='c'] le_ids=None,
+                  long step=0, long stream=0, seed=None):
+    """
+    refloats the LEs on land: puts them back in the water at their last
+    water position. With rnd, only the ones whose draw is
+    <= probability: rnd has a draw for each of the LEs on land, the k-th
+    of them in status_codes order gets rnd[k], as the old numpy code drew
+    them. With le_ids instead, each LE on land draws its own number from
+    lib_gnome's counter based generator, keyed on the seed, step and
+    stream, its 'id' and REFLOAT_DRAW: it doesn't depend on the other LEs
+    or the threads. Without either, all of them refloat
+
+    the threads first count the LEs on land of their chunks of
+    STATUS_CHUNK LEs, so each chunk knows where its draws start, then
+    refloat their chunks: the same LEs refloat with any number of threads
+
+    :param seed: the key's seed, by default the last srand()
+
+    returns the number of LEs refloated
+    """
+    cdef Py_ssize_t num_le = status_codes.shape[0]
+    cdef Py_ssize_t num_chunks = (num_le + STATUS_CHUNK - 1) // STATUS_CHUNK
+    cdef Py_ssize_t c, i, k, end, total
+    cdef int16_t* status = NULL
+    cdef double* draws = NULL
+    cdef uint32_t* ids = NULL
+    cdef double u
+    cdef utils.CounterRandomKey key
+    cdef unsigned int c_seed, c_stream, stream_seed
+    cdef long long num_draws
+    cdef int64_t num_refloated = 0
+
+    if num_le == 0:
+        return 0
+    if (positions.shape[0] != num_le or
+            last_water_positions.shape[0] != num_le or
+            positions.shape[1] != last_water_positions.shape[1]):
+        raise ValueError('positions and last_water_positions are not the '
+                         'shape of the status_codes')
+    if le_ids is not None:
+        if rnd is not None:
+            raise ValueError('give rnd or le_ids, not both')
+        if le_ids.shape[0] != num_le:
+            raise ValueError('le_ids is not the shape of the status_codes')
+    status = &status_codes[0]
+
+    cdef cnp.ndarray[int64_t, ndim=1, mode='c'] first = \
+        np.zeros((num_chunks + 1, ), dtype=np.int64)
+    cdef cnp.ndarray[int64_t, ndim=1, mode='c'] refloated = \
+        np.zeros((num_chunks, ), dtype=np.int64)
+
+    with nogil:
+        for c in prange(num_chunks, schedule='static'):
+            end = min((c + 1) * STATUS_CHUNK, num_le)
+            for i in range(c * STATUS_CHUNK, end):
+                if status[i] == type_defs.OILSTAT_ONLAND:
+                    first[c + 1] += 1
+
+    for c in range(num_chunks):
+        first[c + 1] += first[c]
+    total = first[num_chunks]
+    if total == 0:
+        return 0
+
+    if rnd is not None:
+        if rnd.shape[0] != total:
+            raise ValueError('rnd does not have a draw for each LE on land')
+        draws = &rnd[0]
+    elif le_ids is not None and probability < 1.:
+        if seed is None:
+            utils.GetRandomState(&c_seed, &c_stream, &stream_seed,
+                                 &num_draws)
+        else:
+            c_seed = seed
+        key.seed = c_seed
+        key.spillID = 0
+        key.step = step
+        key.stream = stream
+        ids = &le_ids[0]
+
+    with nogil:
+        for c in prange(num_chunks, schedule='static'):
+            k = first[c]
+            end = min((c + 1) * STATUS_CHUNK, num_le)
+            for i in range(c * STATUS_CHUNK, end):
+                if status[i] != type_defs.OILSTAT_ONLAND:
+                    continue
+                u = 0.
+                if draws != NULL:
+                    u = draws[k]
+                elif ids != NULL:
+                    utils.FillCounterRandomUniforms(key, 1, &ids[i],
+                                                    REFLOAT_DRAW, &u)
+                if (draws == NULL and ids == NULL) or u <= probability:
+                    positions[i, 0] = last_water_positions[i, 0]
+                    positions[i, 1] = last_water_positions[i, 1]
+                    if positions.shape[1] > 2:
+                        positions[i, 2] = last_water_positions[i, 2]
+                    status[i] = type_defs.OILSTAT_INWATER
+                    refloated[c] += 1
+                k = k + 1
+
+    for c in range(num_chunks):
+        num_refloated += refloated[c]
+
+    return num_refloated
+
+
 def move_particles(cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] positions not None,
                  cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] end_positions not None,
                  cnp.ndarray[int16_t, ndim=1, mode='c'] status_codes not None,
@@ -389,6 +1208,8 @@ def move_particles(cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] positions not No
     
     """
     This land checking algorithm is for use with the parameterized map, a long, straight shoreline.
+
+    returns the number of LEs that beached
     """
     cdef cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] shoreline
     shoreline = land_points[0:2]
@@ -397,6 +1218,7 @@ def move_particles(cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] positions not No
     [a1,a2] = shoreline[1] - shoreline[0]
     
     beaching = points_in_poly(land_points, end_positions)
+    num_beached = 0
     
     for i in range(positions.shape[0]):
         #skip if already landed
@@ -421,7 +1243,9 @@ def move_particles(cnp.ndarray[cnp.float64_t, ndim=2, mode='c'] positions not No
             last_water_positions[i,0] = p1[0] + ( x - p1[0])*0.1
             last_water_positions[i,1] = p1[1] + ( y - p1[1])*0.1
             status_codes[i] = type_defs.OILSTAT_ONLAND
+            num_beached += 1
         else:
             positions[i, 0] = end_positions[i, 0]
             positions[i, 1] = end_positions[i, 1]
-        
+
+    return num_beached
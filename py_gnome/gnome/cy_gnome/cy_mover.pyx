@@ -1,9 +1,17 @@
 
-from libc.stdint cimport int32_t
+from libc.stdint cimport int64_t
+from libcpp.vector cimport vector
 
+import numpy as np
 cimport numpy as cnp
 
-from type_defs cimport OSErr, Seconds
+from type_defs cimport OSErr, Seconds, LEType, LECount
+from movers cimport (Mover_c, MoveFused, MoveEnsemble,
+                     TransportMap, TransportLEs, RunTransportSteps,
+                     TimingStats, TimerStats, GetTimerName, kNumTimers,
+                     GetSectionCounterName, GetSectionCountersOpen,
+                     kNumSectionCounters)
+from utils cimport GetRandomState
 
 from gnome import basic_types
 
@@ -25,6 +33,14 @@ cdef class CyMover(object):
     This is so the application doesn't crash if the user instantiates a
     CyMover object in Python. Though this object doesn't do anything and it
     does not have a get_move method.
+
+    get_move and get_move_batch release the GIL while the C++ loop runs, so
+    Python threads can move LEs at the same time, with different movers or
+    the forecast and uncertain LEs with one mover. The C++ mover is locked
+    while it moves or prepares a step, so two threads using one mover take
+    turns. Don't change a mover's settings while a thread is moving with
+    it, and see cy_helpers.set_random_stream() for repeatable random
+    numbers.
     """
     def __cinit__(self):
         '''
@@ -44,6 +60,98 @@ cdef class CyMover(object):
         return ('{0} object - see attributes for more info'
                 .format(self.__class__.__name__))
 
+    property num_threads:
+        """
+        number of threads used by the C++ get_move loop. Default is 1
+        (serial). Only the movers with a parallel loop use it and it only
+        has an effect if lib_gnome was built with OpenMP.
+        """
+        def __get__(self):
+            if self.mover:
+                return self.mover.GetNumThreads()
+            return 1
+
+        def __set__(self, int value):
+            if self.mover:
+                self.mover.SetNumThreads(value)
+
+    def get_timing_stats(self):
+        """
+        returns the time the C++ mover (and its time grid) spent in its hot
+        sections since it was made or reset_timing_stats() was called, as a
+        dict of section name ('prepare_for_model_step', 'get_move',
+        'read_data', 'locate', 'interpolate') to a dict of the number of
+        runs, the LEs done, nanoseconds, nanoseconds per LE and bytes read,
+        and with cy_helpers.open_section_counters() 'counters', the dict of
+        the hardware counts of the section: 'cycles', 'instructions',
+        'llc_misses' and 'branch_misses'.
+
+        The sections are only timed if lib_gnome was built with GNOME_TIMING,
+        otherwise they are all zero.
+        """
+        cdef TimingStats stats
+        cdef TimerStats timer
+        cdef short i, c
+
+        timing = {}
+        if self.mover:
+            self.mover.GetTimingStats(&stats)
+
+        for i in range(kNumTimers):
+            timer = stats.GetTimer(i)
+            timing[GetTimerName(i)] = {'count': timer.count,
+                                       'num_les': timer.numLEs,
+                                       'ns': timer.nanoseconds,
+                                       'ns_per_le': (float(timer.nanoseconds) /
+                                                     timer.numLEs
+                                                     if timer.numLEs > 0
+                                                     else 0.),
+                                       'bytes_read': timer.bytesRead}
+            if GetSectionCountersOpen():
+                counters = {}
+                for c in range(kNumSectionCounters):
+                    counters[GetSectionCounterName(c)] = timer.counts[c]
+                timing[GetTimerName(i)]['counters'] = counters
+
+        return timing
+
+    def reset_timing_stats(self):
+        if self.mover:
+            self.mover.ResetTimingStats()
+
+    def get_run_state(self):
+        """
+        returns the runtime state of the C++ mover -- what the run has
+        changed since prepare_for_model_run(): its uncertainty lists, step
+        counters and so on -- as a byte string, for checkpoints. It is only
+        meant for set_run_state() of a mover set up the same way, with the
+        same build of lib_gnome.
+        """
+        cdef vector[char] state
+
+        if not self.mover:
+            return b''
+
+        self.mover.GetRunState(state)
+        if state.size() == 0:
+            return b''
+
+        return (&state[0])[:state.size()]
+
+    def set_run_state(self, bytes state):
+        """
+        puts back the runtime state get_run_state() returned
+        """
+        cdef OSErr err
+
+        if not self.mover:
+            return
+
+        err = self.mover.SetRunState(state, len(state))
+        if err:
+            raise ValueError('the run state is not the state of a '
+                             '{0}'.format(self.__class__.__name__))
+
     def prepare_for_model_run(self):
         """
         default implementation. It calls the C++ objects's
@@ -56,7 +164,7 @@ cdef class CyMover(object):
                                Seconds model_time,
                                Seconds step_len,
                                numSets=0,
-                               cnp.ndarray[int32_t] setSizes=None):
+                               cnp.ndarray[int64_t] setSizes=None):
         """
         .. function:: prepare_for_model_step(self, model_time, step_len,
                                              uncertain)
@@ -68,7 +176,7 @@ cdef class CyMover(object):
         :param step_len: length of the time step over which the get move
                          will be computed
         :param numSets: either 0 or 1 if uncertainty is on.
-        :param setSizes: Numpy array containing dtype=int for the size of
+        :param setSizes: Numpy array containing dtype=int64 for the size of
                          uncertainty array if numSets is 1
         """
         cdef OSErr err
@@ -115,6 +223,506 @@ cdef class CyMover(object):
         if self.mover:
             self.mover.ModelStepIsDone()
 
+    def get_move_batch(self,
+                       Seconds model_time,
+                       Seconds step_len,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lat,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lon,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] z,
+                       cnp.ndarray[short, ndim=1, mode='c'] LE_status,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] delta_lat,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] delta_lon,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] delta_z,
+                       LEType spill_type,
+                       cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] windages=None,
+                       cnp.ndarray[int64_t, ndim=1, mode='c'] active=None):
+        """
+        .. function:: get_move_batch(self, model_time, step_len,
+                                     lat, lon, z, LE_status,
+                                     delta_lat, delta_lon, delta_z,
+                                     spill_type, windages=None, active=None)
+
+        Invokes the underlying C++ Mover_c.get_move_batch(...) - the
+        structure-of-arrays version of get_move. All arrays are contiguous
+        1-D arrays of the same length. Positions and deltas are in degrees
+        (meters for z); the deltas are modified in place.
+
+        :param windages: only required by the wind movers
+        :param active: optional int64 array of the indexes of the LEs in
+                       water, in order. The movers that can fuse only move
+                       those (Mover_c::get_move_batch_active); the deltas of
+                       the other LEs are 0.
+        """
+        cdef OSErr err
+        cdef double *windages_ptr = NULL
+        cdef LECount *active_ptr = NULL
+        cdef LECount num_active = 0
+        cdef bint use_active = active is not None
+        cdef LECount N = len(lat)
+
+        if self.mover == NULL or N == 0:
+            return
+
+        if (len(lon) != N or len(z) != N or len(LE_status) != N or
+                len(delta_lat) != N or len(delta_lon) != N or
+                len(delta_z) != N or
+                (windages is not None and len(windages) != N)):
+            raise ValueError('all arrays passed to get_move_batch must be '
+                             'the same length')
+
+        if windages is not None:
+            windages_ptr = &windages[0]
+
+        if use_active:
+            num_active = len(active)
+            if num_active == 0:
+                # no LEs in water
+                delta_lat[:] = 0
+                delta_lon[:] = 0
+                delta_z[:] = 0
+                return
+
+            active_ptr = <LECount *>&active[0]
+
+        with nogil:
+            if not use_active:
+                err = self.mover.get_move_batch(N, model_time, step_len,
+                                                &lat[0], &lon[0], &z[0],
+                                                windages_ptr,
+                                                &LE_status[0],
+                                                &delta_lat[0], &delta_lon[0],
+                                                &delta_z[0],
+                                                spill_type, 0)
+            else:
+                err = self.mover.get_move_batch_active(N, num_active,
+                                                       active_ptr,
+                                                       model_time, step_len,
+                                                       &lat[0], &lon[0],
+                                                       &z[0],
+                                                       windages_ptr,
+                                                       &LE_status[0],
+                                                       &delta_lat[0],
+                                                       &delta_lon[0],
+                                                       &delta_z[0],
+                                                       spill_type, 0)
+        if err == 1:
+            raise ValueError('Make sure numpy arrays for positions, deltas '
+                             'and (for wind movers) windages are defined')
+
+        if err == 2:
+            raise ValueError("The value for spill type can only be 'forecast' "
+                             "or 'uncertainty' - you've chosen: "
+                             "{0}".format(spill_type))
+
+
+def get_move_fused(movers,
+                   Seconds model_time,
+                   Seconds step_len,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lat,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lon,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] z,
+                   cnp.ndarray[short, ndim=1, mode='c'] LE_status,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_lat,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_lon,
+                   cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_z,
+                   LEType spill_type,
+                   windages,
+                   cnp.ndarray[int64_t, ndim=1, mode='c'] active=None):
+    """
+    .. function:: get_move_fused(movers, model_time, step_len,
+                                 lat, lon, z, LE_status,
+                                 next_lat, next_lon, next_z,
+                                 spill_type, windages, active=None)
+
+    Invokes the C++ MoveFused(...): adds the moves of the CyMover objects
+    in movers, in order, to next_lat, next_lon and next_z - the same sum as
+    a get_move_batch per mover - passing the LEs through all the movers a
+    chunk at a time when the movers can do that.
+
+    :param windages: list of the windages array of each mover, None for
+                     the movers that don't use them
+    :param active: optional int64 array of the indexes of the LEs in water,
+                   in order - only those are moved
+    """
+    cdef OSErr err
+    cdef CyMover mover
+    cdef cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] mover_windages
+    cdef vector[Mover_c *] c_movers
+    cdef vector[double *] c_windages
+    cdef LECount *active_ptr = NULL
+    cdef LECount num_active = 0
+    cdef LECount N = len(lat)
+
+    if (len(lon) != N or len(z) != N or len(LE_status) != N or
+            len(next_lat) != N or len(next_lon) != N or len(next_z) != N):
+        raise ValueError('all arrays passed to get_move_fused must be the '
+                         'same length')
+
+    if len(windages) != len(movers):
+        raise ValueError('get_move_fused needs the windages of each mover')
+
+    for mover, w in zip(movers, windages):
+        if mover.mover == NULL:
+            continue
+
+        c_movers.push_back(mover.mover)
+        if w is None:
+            c_windages.push_back(NULL)
+        else:
+            mover_windages = w
+            if len(mover_windages) != N:
+                raise ValueError('all arrays passed to get_move_fused must '
+                                 'be the same length')
+            c_windages.push_back(&mover_windages[0])
+
+    if active is not None:
+        num_active = len(active)
+        if num_active == 0:
+            return
+        active_ptr = <LECount *>&active[0]
+
+    if N == 0 or c_movers.size() == 0:
+        return
+
+    with nogil:
+        err = MoveFused(c_movers.size(), &c_movers[0], &c_windages[0],
+                        N, num_active, active_ptr, model_time, step_len,
+                        &lat[0], &lon[0], &z[0], &LE_status[0],
+                        &next_lat[0], &next_lon[0], &next_z[0],
+                        spill_type, 0)
+    if err == 1:
+        raise ValueError('Make sure numpy arrays for positions, deltas '
+                         'and (for wind movers) windages are defined')
+
+    if err == 2:
+        raise ValueError("The value for spill type can only be 'forecast' "
+                         "or 'uncertainty' - you've chosen: "
+                         "{0}".format(spill_type))
+
+
+def get_move_ensemble(movers,
+                      Seconds model_time,
+                      Seconds step_len,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lat,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lon,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] z,
+                      cnp.ndarray[short, ndim=1, mode='c'] LE_status,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_lat,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_lon,
+                      cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] next_z,
+                      LEType spill_type,
+                      windages,
+                      cnp.ndarray[int64_t, ndim=1, mode='c'] member_start,
+                      scales,
+                      cnp.ndarray[int64_t, ndim=1, mode='c'] active=None):
+    """
+    .. function:: get_move_ensemble(movers, model_time, step_len,
+                                    lat, lon, z, LE_status,
+                                    next_lat, next_lon, next_z,
+                                    spill_type, windages,
+                                    member_start, scales, active=None)
+
+    Invokes the C++ MoveEnsemble(...): get_move_fused for the LEs of the
+    members of an ensemble, which are in the arrays one member after the
+    other, with the moves of each mover scaled for each member. The forcing
+    of the movers is read once for all the members.
+
+    :param member_start: int64 array of the index of the first LE of each
+                         member, and then the number of LEs
+    :param scales: (number of members, number of movers) array of the scale
+                   of each member's move by each mover - e.g. the member's
+                   wind speed factor for a wind mover, or its current scale
+                   for a current mover
+    """
+    cdef OSErr err
+    cdef CyMover mover
+    cdef cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] mover_windages
+    cdef cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] member_scales
+    cdef vector[Mover_c *] c_movers
+    cdef vector[double *] c_windages
+    cdef vector[double] c_scales
+    cdef LECount *active_ptr = NULL
+    cdef LECount num_active = 0
+    cdef LECount N = len(lat)
+    cdef int num_members = len(member_start) - 1
+    cdef int k
+    cdef int j
+
+    if (len(lon) != N or len(z) != N or len(LE_status) != N or
+            len(next_lat) != N or len(next_lon) != N or len(next_z) != N):
+        raise ValueError('all arrays passed to get_move_ensemble must be the '
+                         'same length')
+
+    if len(windages) != len(movers):
+        raise ValueError('get_move_ensemble needs the windages of each mover')
+
+    member_scales = np.ascontiguousarray(scales, dtype=np.float64)
+    if (num_members < 1 or
+            member_scales.shape[0] != num_members or
+            member_scales.shape[1] != len(movers)):
+        raise ValueError('get_move_ensemble needs the scale of each member '
+                         'for each mover')
+
+    if member_start[0] != 0 or member_start[num_members] != N:
+        raise ValueError('the members must start at 0 and end at the last '
+                         'LE')
+
+    # the movers with no C++ mover are skipped, and their scales with them
+    kept = []
+    for j, (mover, w) in enumerate(zip(movers, windages)):
+        if mover.mover == NULL:
+            continue
+
+        kept.append(j)
+        c_movers.push_back(mover.mover)
+        if w is None:
+            c_windages.push_back(NULL)
+        else:
+            mover_windages = w
+            if len(mover_windages) != N:
+                raise ValueError('all arrays passed to get_move_ensemble '
+                                 'must be the same length')
+            c_windages.push_back(&mover_windages[0])
+
+    for k in range(num_members):
+        for j in kept:
+            c_scales.push_back(member_scales[k, j])
+
+    if active is not None:
+        num_active = len(active)
+        if num_active == 0:
+            return
+        active_ptr = <LECount *>&active[0]
+
+    if N == 0 or c_movers.size() == 0:
+        return
+
+    with nogil:
+        err = MoveEnsemble(c_movers.size(), &c_movers[0], &c_windages[0],
+                           num_members, <LECount *>&member_start[0],
+                           &c_scales[0],
+                           N, num_active, active_ptr, model_time, step_len,
+                           &lat[0], &lon[0], &z[0], &LE_status[0],
+                           &next_lat[0], &next_lon[0], &next_z[0],
+                           spill_type, 0)
+    if err == 1:
+        raise ValueError('Make sure numpy arrays for positions, deltas, '
+                         'windages and members are defined, and the '
+                         'members are in order')
+
+    if err == 2:
+        raise ValueError("The value for spill type can only be 'forecast' "
+                         "or 'uncertainty' - you've chosen: "
+                         "{0}".format(spill_type))
+
+
+def run_transport_steps(movers,
+                        int num_steps,
+                        Seconds model_time,
+                        Seconds step_len,
+                        positions,
+                        cnp.ndarray[short, ndim=1, mode='c'] status_codes,
+                        last_water_positions,
+                        le_ids,
+                        uses_windages=None,
+                        cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] windages=None,
+                        cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] windage_range=None,
+                        cnp.ndarray[long, ndim=1, mode='c'] windage_persist=None,
+                        land=None,
+                        transform=None,
+                        map_bounds=None,
+                        double refloat_probability=-1.,
+                        long refloat_step=0,
+                        track=False,
+                        seed=None):
+    """
+    .. function:: run_transport_steps(movers, num_steps, model_time,
+                                      step_len, positions, status_codes,
+                                      last_water_positions, le_ids, ...)
+
+    Invokes the C++ RunTransportSteps(...): num_steps steps of the forecast
+    LEs with the CyMover objects in movers, the map's land and bounds, all
+    in C++. positions, status_codes and last_water_positions are updated in
+    place, and the windages when the movers include wind movers.
+
+    :param uses_windages: a bool for each mover, whether it moves the LEs
+                          with the windages
+    :param land: the finest raster of the map (uint8, land 1) or its
+                 PackedBitmap, None for a map with no land
+    :param transform: the projection's pixel_transform() of the raster
+    :param map_bounds: (N, 2) polygon of the map bounds, None for none
+    :param refloat_probability: of an LE on land each step, negative for
+                                never
+    :param refloat_step: the step of the key of the refloat draws
+    :param track: if True, the positions and statuses at the end of each
+                  step are returned too
+    :param seed: the seed of the keys of the draws, by default the last
+                 srand()
+
+    :returns: a dict of the 'steps' done, the number of LEs that
+              'beached', the 'error' of the mover that could not prepare
+              a step (0 for none) and, with track, the 'lon', 'lat', 'z'
+              and 'status_codes' of the steps, (steps, N) arrays
+    """
+    cdef OSErr err
+    cdef CyMover mover
+    cdef vector[Mover_c *] c_movers
+    cdef vector[char] c_uses
+    cdef TransportMap c_map
+    cdef TransportLEs les
+    cdef cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lon, lat, z
+    cdef cnp.ndarray[cnp.npy_double, ndim=1, mode='c'] lw_lon, lw_lat, lw_z
+    cdef cnp.ndarray[cnp.uint32_t, ndim=1, mode='c'] ids
+    cdef cnp.ndarray[cnp.uint8_t, ndim=2, mode='c'] raster
+    cdef cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] bounds
+    cdef cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] t_lon, t_lat, t_z
+    cdef cnp.ndarray[short, ndim=2, mode='c'] t_status
+    cdef double *track_ptrs[3]
+    cdef short *track_status = NULL
+    cdef unsigned int c_seed, c_stream, stream_seed
+    cdef long long num_draws
+    cdef int steps_done = 0
+    cdef LECount num_beached = 0
+    cdef LECount N = len(status_codes)
+    cdef int i
+
+    positions = np.asarray(positions)
+    last_water_positions = np.asarray(last_water_positions)
+    if (positions.shape != (N, 3) or last_water_positions.shape != (N, 3) or
+            len(le_ids) != N):
+        raise ValueError('positions, last_water_positions and le_ids must '
+                         'be the length of status_codes')
+
+    if uses_windages is None:
+        uses_windages = [False] * len(movers)
+    if len(uses_windages) != len(movers):
+        raise ValueError('run_transport_steps needs uses_windages for each '
+                         'mover')
+
+    for mover, uses in zip(movers, uses_windages):
+        if mover.mover == NULL:
+            continue
+
+        c_movers.push_back(mover.mover)
+        c_uses.push_back(1 if uses else 0)
+    c_uses.push_back(0)  # so there is a first one
+
+    if seed is None:
+        GetRandomState(&c_seed, &c_stream, &stream_seed, &num_draws)
+    else:
+        c_seed = seed
+
+    lon = np.ascontiguousarray(positions[:, 0], dtype=np.float64)
+    lat = np.ascontiguousarray(positions[:, 1], dtype=np.float64)
+    z = np.ascontiguousarray(positions[:, 2], dtype=np.float64)
+    lw_lon = np.ascontiguousarray(last_water_positions[:, 0],
+                                  dtype=np.float64)
+    lw_lat = np.ascontiguousarray(last_water_positions[:, 1],
+                                  dtype=np.float64)
+    lw_z = np.ascontiguousarray(last_water_positions[:, 2], dtype=np.float64)
+    ids = np.ascontiguousarray(le_ids, dtype=np.uint32)
+
+    les.n = N
+    les.lon = &lon[0] if N > 0 else NULL
+    les.lat = &lat[0] if N > 0 else NULL
+    les.z = &z[0] if N > 0 else NULL
+    les.status = &status_codes[0] if N > 0 else NULL
+    les.lastWaterLon = &lw_lon[0] if N > 0 else NULL
+    les.lastWaterLat = &lw_lat[0] if N > 0 else NULL
+    les.lastWaterZ = &lw_z[0] if N > 0 else NULL
+    les.ids = &ids[0] if N > 0 else NULL
+    les.windages = NULL
+    les.windageRange = NULL
+    les.windagePersist = NULL
+    les.windageKey.seed = c_seed
+    les.windageKey.spillID = 0
+    les.windageKey.step = 0
+    les.windageKey.stream = 0
+
+    if windages is not None and N > 0:
+        if (len(windages) != N or windage_range is None or
+                windage_persist is None or windage_range.shape[0] != N or
+                windage_range.shape[1] != 2 or len(windage_persist) != N):
+            raise ValueError('windages, windage_range and windage_persist '
+                             'must be the length of status_codes')
+        les.windages = &windages[0]
+        les.windageRange = &windage_range[0, 0]
+        les.windagePersist = &windage_persist[0]
+
+    c_map.land = NULL
+    c_map.width = c_map.height = c_map.rowBytes = 0
+    c_map.numBoundPts = 0
+    c_map.boundPts = NULL
+    c_map.refloatProbability = refloat_probability
+    c_map.refloatKey.seed = c_seed
+    c_map.refloatKey.spillID = 0
+    c_map.refloatKey.step = refloat_step
+    c_map.refloatKey.stream = 0
+
+    if land is not None:
+        if hasattr(land, 'bits'):
+            # a PackedBitmap, read a bit a pixel
+            raster = np.ascontiguousarray(land.bits, dtype=np.uint8)
+            c_map.width, c_map.height = land.shape
+            c_map.rowBytes = raster.shape[1]
+        else:
+            raster = np.ascontiguousarray(land, dtype=np.uint8)
+            c_map.width = raster.shape[0]
+            c_map.height = raster.shape[1]
+
+        if transform is None or len(transform) != 6:
+            raise ValueError('the land needs the pixel_transform() of its '
+                             'projection')
+        c_map.land = &raster[0, 0]
+        for i in range(6):
+            c_map.transform[i] = transform[i]
+
+    if map_bounds is not None:
+        bounds = np.ascontiguousarray(map_bounds, dtype=np.float64)
+        if bounds.shape[0] > 0:
+            c_map.numBoundPts = bounds.shape[0]
+            c_map.boundPts = &bounds[0, 0]
+
+    track_ptrs[0] = track_ptrs[1] = track_ptrs[2] = NULL
+    if track and N > 0 and num_steps > 0:
+        t_lon = np.zeros((num_steps, N), dtype=np.float64)
+        t_lat = np.zeros((num_steps, N), dtype=np.float64)
+        t_z = np.zeros((num_steps, N), dtype=np.float64)
+        t_status = np.zeros((num_steps, N), dtype=np.int16)
+        track_ptrs[0] = &t_lon[0, 0]
+        track_ptrs[1] = &t_lat[0, 0]
+        track_ptrs[2] = &t_z[0, 0]
+        track_status = &t_status[0, 0]
+
+    with nogil:
+        err = RunTransportSteps(c_movers.size(),
+                                &c_movers[0] if c_movers.size() > 0 else NULL,
+                                &c_uses[0], c_map, les,
+                                num_steps, model_time, step_len,
+                                track_ptrs[0], track_ptrs[1], track_ptrs[2],
+                                track_status, &steps_done, &num_beached)
+
+    if err == 1:
+        raise ValueError('Make sure numpy arrays for positions and (for '
+                         'wind movers) windages are defined')
+
+    positions[:, 0] = lon
+    positions[:, 1] = lat
+    positions[:, 2] = z
+    last_water_positions[:, 0] = lw_lon
+    last_water_positions[:, 1] = lw_lat
+
+    result = {'steps': steps_done,
+              'beached': num_beached,
+              'error': err}
+    if track_status != NULL:
+        result['lon'] = t_lon[:steps_done]
+        result['lat'] = t_lat[:steps_done]
+        result['z'] = t_z[:steps_done]
+        result['status_codes'] = t_status[:steps_done]
+
+    return result
+
 
 cdef class CyWindMoverBase(CyMover):
 
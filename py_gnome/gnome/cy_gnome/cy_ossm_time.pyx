@@ -205,27 +205,29 @@ cdef class CyOSSMTime(object):
           GetTimeValue - for a specified modelTime or array of model times,
               it returns the values.
         """
-        cdef cnp.ndarray[Seconds, ndim = 1] modelTimeArray
-        modelTimeArray = np.asarray(modelTime,
-                                    basic_types.seconds).reshape((-1,))
+        cdef cnp.ndarray[Seconds, ndim = 1, mode = 'c'] modelTimeArray
+        modelTimeArray = np.ascontiguousarray(modelTime,
+                                              basic_types.seconds).reshape((-1,))
 
         # velocity record passed to OSSMTimeValue_c methods and
         # returned back to python
         cdef cnp.ndarray[VelocityRec, ndim = 1] vel_rec
-        cdef VelocityRec * velrec
 
-        cdef unsigned int i
         cdef OSErr err
 
         vel_rec = np.empty((modelTimeArray.size,),
                            dtype=basic_types.velocity_rec)
+        if modelTimeArray.size == 0:
+            return vel_rec
 
-        for i in range(0, modelTimeArray.size):
-            err = self.time_dep.GetTimeValue(modelTimeArray[i], &vel_rec[i])
-            if err != 0:
-                raise ValueError('Error invoking TimeValue_c.GetTimeValue '
-                                 'method in CyOSSMTime: '
-                                 'C++ OSERR = {0}'.format(err))
+        # one call for all the times, consecutive times reuse the last bracket
+        err = self.time_dep.GetTimeValues(&modelTimeArray[0],
+                                          modelTimeArray.size,
+                                          &vel_rec[0])
+        if err != 0:
+            raise ValueError('Error invoking TimeValue_c.GetTimeValue '
+                             'method in CyOSSMTime: '
+                             'C++ OSERR = {0}'.format(err))
 
         return vel_rec
 
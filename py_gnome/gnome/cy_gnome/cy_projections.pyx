@@ -0,0 +1,147 @@
+"""
+The projections of gnome.utilities.projections done in lib_gnome: the flat
+earth deltas of every element and the pixels of every point in one pass
+each, written straight into the output array -- which may be the input
+itself -- with no temporaries.
+"""
+import cython
+cimport numpy as cnp
+import numpy as np
+
+from utils cimport (MetersToLonLat, LonLatToMeters, LonLatToPixels,
+                    LonLatToPixelsFloat, LonLatToPixelsInt)
+
+
+def _rows(values, name):
+    'values as a float64 (N, 2) or (N, 3) array'
+    values = np.asarray(values, dtype=np.float64)
+    if values.ndim == 1:
+        values = values.reshape(1, -1)
+
+    if values.ndim != 2 or values.shape[1] not in (2, 3):
+        raise ValueError('{0} must be (x, y[, z]) or an Nx2 or Nx3 array'
+                         .format(name))
+
+    return values
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def _flat_earth(deltas, ref_positions, out, bint to_meters):
+    cdef cnp.ndarray[double, ndim=2, mode='c'] c_out, c_refs
+    cdef long n, ref_count
+    cdef int dim, ref_dim
+
+    deltas = _rows(deltas, 'deltas')
+    c_refs = np.ascontiguousarray(_rows(ref_positions, 'ref_positions'))
+
+    if out is None:
+        # the copy is the output: the deltas are converted in place
+        out = np.array(deltas, dtype=np.float64, order='C')
+    elif (not isinstance(out, np.ndarray) or out.dtype != np.float64 or
+          out.shape != deltas.shape or not out.flags.c_contiguous):
+        raise ValueError('out must be a C contiguous float64 array of '
+                         'shape {0}'.format(deltas.shape))
+    elif out is not deltas:
+        if np.may_share_memory(out, deltas):
+            raise ValueError('out may be the deltas, not overlap them')
+        out[...] = deltas
+
+    c_out = out
+    n = c_out.shape[0]
+    dim = c_out.shape[1]
+    ref_count = c_refs.shape[0]
+    ref_dim = c_refs.shape[1]
+
+    if ref_count != 1 and ref_count != n:
+        raise ValueError('there are {0} reference positions for {1} deltas'
+                         .format(ref_count, n))
+
+    if n > 0:
+        with nogil:
+            if to_meters:
+                LonLatToMeters(n, dim, &c_out[0, 0], &c_refs[0, 0], ref_dim,
+                               ref_count, &c_out[0, 0])
+            else:
+                MetersToLonLat(n, dim, &c_out[0, 0], &c_refs[0, 0], ref_dim,
+                               ref_count, &c_out[0, 0])
+
+    return out
+
+
+def meters_to_lonlat(meters, ref_positions, out=None):
+    """
+    FlatEarthProjection.meters_to_lonlat(): the (dlon, dlat[, dz]) of the
+    (dx, dy[, dz]) meters at the latitudes of ref_positions
+
+    :param ref_positions: one position, or one for each row of meters
+    :param out: C contiguous float64 array of the shape of meters for the
+        result, or meters itself to convert in place. By default a new array
+    """
+    return _flat_earth(meters, ref_positions, out, False)
+
+
+def lonlat_to_meters(lon_lat, ref_positions, out=None):
+    """
+    FlatEarthProjection.lonlat_to_meters(): the reverse of
+    meters_to_lonlat()
+    """
+    return _flat_earth(lon_lat, ref_positions, out, True)
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def to_pixels(coords, transform, asint=False, dtype=np.float64):
+    """
+    ((lon, lat) - center) * scale + offset of each of coords, the
+    GeoProjection.to_pixel() of a pixel_transform()
+
+    :param coords: (lon, lat[, depth]) or an Nx2 or Nx3 array of them
+    :param transform: (center_x, center_y, scale_x, scale_y, offset_x,
+        offset_y)
+    :param asint: if True, int32 pixels: floor()'ed, so negative coords are
+        off the image
+    :param dtype: np.float64, or np.float32 for renderers that draw in
+        single precision. Ignored if asint
+
+    :returns: Nx2 array of pixel (x, y)
+    """
+    cdef cnp.ndarray[double, ndim=2, mode='c'] c_coords
+    cdef cnp.ndarray[double, ndim=1] c_transform
+    cdef cnp.ndarray[double, ndim=2, mode='c'] pix_d
+    cdef cnp.ndarray[float, ndim=2, mode='c'] pix_f
+    cdef cnp.ndarray[int, ndim=2, mode='c'] pix_i
+    cdef long n
+    cdef int dim
+
+    c_coords = np.ascontiguousarray(_rows(coords, 'coords'))
+    c_transform = np.ascontiguousarray(transform, dtype=np.float64)
+    if len(c_transform) != 6:
+        raise ValueError('transform must be (center_x, center_y, scale_x, '
+                         'scale_y, offset_x, offset_y)')
+
+    n = c_coords.shape[0]
+    dim = c_coords.shape[1]
+
+    if asint:
+        pix_i = np.empty((n, 2), dtype=np.intc)
+        if n > 0:
+            with nogil:
+                LonLatToPixelsInt(n, dim, &c_coords[0, 0], &c_transform[0],
+                                  &pix_i[0, 0])
+        return pix_i.astype(np.int32, copy=False)
+
+    if np.dtype(dtype) == np.float32:
+        pix_f = np.empty((n, 2), dtype=np.float32)
+        if n > 0:
+            with nogil:
+                LonLatToPixelsFloat(n, dim, &c_coords[0, 0], &c_transform[0],
+                                    &pix_f[0, 0])
+        return pix_f
+
+    pix_d = np.empty((n, 2), dtype=np.float64)
+    if n > 0:
+        with nogil:
+            LonLatToPixels(n, dim, &c_coords[0, 0], &c_transform[0],
+                           &pix_d[0, 0])
+    return pix_d
@@ -89,6 +89,26 @@ cdef class CyRandomVerticalMover(cy_mover.CyMover):
                                  'for mixed_layer_depth')
             self.rand.fMixedLayerDepth = value
 
+    property use_counter_rng:
+        """
+        use the stateless counter based random numbers (keyed on seed,
+        spill, LE index and step) instead of the C rand(). Results are then
+        reproducible independent of the order LEs are processed in, so
+        get_move can use num_threads > 1.
+        """
+        def __get__(self):
+            return bool(self.rand.bUseCounterRandom)
+
+        def __set__(self, value):
+            self.rand.bUseCounterRandom = value
+
+    property rng_seed:
+        def __get__(self):
+            return self.rand.fRandomSeed
+
+        def __set__(self, value):
+            self.rand.fRandomSeed = value
+
     def __repr__(self):
         """
         unambiguous repr of object, reuse for str() method
@@ -102,8 +122,8 @@ cdef class CyRandomVerticalMover(cy_mover.CyMover):
                         self.mixed_layer_depth))
 
     def get_move(self,
-                 model_time,
-                 step_len,
+                 Seconds model_time,
+                 Seconds step_len,
                  cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
                  cnp.ndarray[WorldPoint3D, ndim=1] delta,
                  cnp.ndarray[short] LE_status,
@@ -131,11 +151,12 @@ cdef class CyRandomVerticalMover(cy_mover.CyMover):
         :returns: none
         """
         cdef OSErr err
-        N = len(ref_points)  # set a data type?
+        cdef LECount N = len(ref_points)
 
-        err = self.rand.get_move(N, model_time, step_len,
-                                 &ref_points[0], &delta[0], &LE_status[0],
-                                 spill_type, 0)
+        with nogil:
+            err = self.rand.get_move(N, model_time, step_len,
+                                     &ref_points[0], &delta[0], &LE_status[0],
+                                     spill_type, 0)
         if err == 1:
             raise ValueError('Make sure numpy arrays for ref_points, delta '
                              'are defined')
@@ -1,3 +1,4 @@
+import cython
 cimport numpy as cnp
 import numpy as np
 
@@ -5,7 +6,28 @@ import numpy as np
 from type_defs cimport *
 from utils cimport emulsify
 from utils cimport adios2_disperse
+from utils cimport evaporate
+from utils cimport fay_spread, langmuir_coverage, remove_mass
+from utils cimport WeatheringWorkspace_c
+from utils cimport (WeatheringPipeline_c, WeatheringArrays,
+                    WeatheringStageResult, kStageEvaporation,
+                    kStageDispersion)
+from utils cimport SetWeatheringThreads, GetWeatheringThreads
 from libc.stdint cimport *
+from libc cimport stdlib
+
+
+def set_num_threads(int num_threads):
+    """
+    number of threads emulsify_oil and disperse_oil use, 1 (the default) is
+    serial. The results are the same either way. Only has an effect if
+    lib_gnome was built with OpenMP.
+    """
+    SetWeatheringThreads(num_threads)
+
+
+def get_num_threads():
+    return GetWeatheringThreads()
 
 
 def emulsify_oil(step_len, cnp.ndarray[cnp.npy_double] frac_water,
@@ -88,3 +110,575 @@ def disperse_oil(step_len, cnp.ndarray[cnp.npy_double] frac_water,
     if disp_err != 0:
         raise ValueError("C++ call to disperse returned error code: "
                          "{0}".format(disp_err))
+
+
+def evaporate_oil(step_lens, mass_transport_coeffs,
+                  cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] mass_components,
+                  cnp.ndarray[cnp.npy_double, mode='c'] le_mass,
+                  cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] evap_decay,
+                  cnp.ndarray[cnp.npy_double, mode='c'] area,
+                  frac_water,
+                  vapor_pressure,
+                  mol_weight,
+                  double water_temp,
+                  double gas_constant):
+    """
+    evaporates the components of the LEs over the sub-steps of step_lens
+    seconds, with the wind's mass transport coefficient at each, in place:
+    mass_components, le_mass and evap_decay (the decay constants of the
+    last sub-step) are updated. The first len(vapor_pressure) components
+    evaporate.
+
+    frac_water may be None for no water.
+
+    :returns: the mass evaporated
+    """
+    cdef OSErr evap_err
+    cdef double evaporated = 0.
+    cdef double *c_frac_water = NULL
+    cdef double *c_vp_ptr = NULL
+    cdef double *c_mw_ptr = NULL
+    cdef LECount N
+    cdef int num_components, num_vp, num_steps
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_step_lens = \
+        np.ascontiguousarray(step_lens, dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_K = \
+        np.ascontiguousarray(mass_transport_coeffs, dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_vp = \
+        np.ascontiguousarray(vapor_pressure, dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_mw = \
+        np.ascontiguousarray(np.broadcast_to(mol_weight, c_vp.shape),
+                             dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_fw
+
+    N = len(le_mass)
+    if N == 0 or len(c_step_lens) == 0:
+        return 0.
+
+    if (mass_components.shape[0] != N or len(area) != N or
+            evap_decay.shape[0] != N or
+            evap_decay.shape[1] != mass_components.shape[1]):
+        raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+    if len(c_K) != len(c_step_lens):
+        raise ValueError("a mass transport coefficient is needed for each "
+                         "sub-step")
+
+    if frac_water is not None:
+        c_fw = np.ascontiguousarray(frac_water, dtype=np.float64)
+        c_frac_water = &c_fw[0]
+
+    if len(c_vp) > 0:
+        c_vp_ptr = &c_vp[0]
+        c_mw_ptr = &c_mw[0]
+
+    num_components = mass_components.shape[1]
+    num_vp = len(c_vp)
+    num_steps = len(c_step_lens)
+
+    # it only touches the arrays, so the substances of a spill container,
+    # or the spill containers, can evaporate on threads at the same time
+    with nogil:
+        evap_err = evaporate(N, num_components, num_vp, num_steps,
+                             &c_step_lens[0],
+                             &c_K[0],
+                             &mass_components[0, 0],
+                             &le_mass[0],
+                             &evap_decay[0, 0],
+                             &area[0],
+                             c_frac_water,
+                             c_vp_ptr,
+                             c_mw_ptr,
+                             water_temp,
+                             gas_constant,
+                             &evaporated)
+
+    if evap_err == -1:
+        raise ValueError("Error in Evaporation routine. One of the"
+                         " exponential decay constant is positive")
+    if evap_err != 0:
+        raise ValueError("C++ call to evaporate returned error code: "
+                         "{0}".format(evap_err))
+
+    return evaporated
+
+
+def spread_oil(blob_num, age, long step_len,
+               bulk_init_volume,
+               cnp.ndarray[cnp.npy_double, mode='c'] fay_area,
+               cnp.ndarray[cnp.npy_double, mode='c'] area,
+               double water_visc,
+               double rel_buoy,
+               double thickness_limit,
+               spreading_const,
+               double gravity):
+    """
+    Fay spreading of all the blobs of LEs in one pass: fay_area is updated in
+    place for the LEs of age + step_len, and area set to it. blob_num is the
+    blob of each LE, numbered from 0.
+    """
+    cdef OSErr spread_err
+    cdef int num_blobs
+    cdef cnp.ndarray[int32_t, mode='c'] c_blob = \
+        np.ascontiguousarray(blob_num, dtype=np.int32)
+    cdef cnp.ndarray[int32_t, mode='c'] c_age = \
+        np.ascontiguousarray(age, dtype=np.int32)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_volume = \
+        np.ascontiguousarray(bulk_init_volume, dtype=np.float64)
+
+    N = len(fay_area)
+    if N == 0:
+        return
+
+    if len(c_blob) != N or len(c_age) != N or len(c_volume) != N or \
+            len(area) != N:
+        raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+    num_blobs = c_blob.max() + 1
+
+    spread_err = fay_spread(N, num_blobs, &c_blob[0], &c_age[0], step_len,
+                            &c_volume[0],
+                            &fay_area[0],
+                            &area[0],
+                            water_visc,
+                            rel_buoy,
+                            thickness_limit,
+                            spreading_const[0], spreading_const[1],
+                            gravity)
+
+    if spread_err == -1:
+        raise ValueError("use init_area for age == 0")
+    if spread_err != 0:
+        raise ValueError("C++ call to fay_spread returned error code: "
+                         "{0}".format(spread_err))
+
+
+def langmuir_oil(spill_num, bulk_init_volume,
+                 fay_area, density,
+                 cnp.ndarray[cnp.npy_double, mode='c'] frac_coverage,
+                 cnp.ndarray[cnp.npy_double, mode='c'] area,
+                 double v_max,
+                 double rho_water,
+                 double gravity):
+    """
+    sets the fractional coverage of Langmuir circulation of the LEs of each
+    spill, and area = fay_area * frac_coverage, in place
+    """
+    cdef OSErr langmuir_err
+    cdef cnp.ndarray[int32_t, mode='c'] c_group = \
+        np.ascontiguousarray(spill_num, dtype=np.int32)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_volume = \
+        np.ascontiguousarray(bulk_init_volume, dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_fay_area = \
+        np.ascontiguousarray(fay_area, dtype=np.float64)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_density = \
+        np.ascontiguousarray(density, dtype=np.float64)
+
+    N = len(area)
+    if N == 0:
+        return
+
+    if len(c_group) != N or len(c_volume) != N or len(c_fay_area) != N or \
+            len(c_density) != N or len(frac_coverage) != N:
+        raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+    langmuir_err = langmuir_coverage(N, c_group.max() + 1, &c_group[0],
+                                     &c_volume[0],
+                                     &c_fay_area[0],
+                                     &c_density[0],
+                                     &frac_coverage[0],
+                                     &area[0],
+                                     v_max,
+                                     rho_water,
+                                     gravity)
+
+    if langmuir_err != 0:
+        raise ValueError("C++ call to langmuir_coverage returned error code: "
+                         "{0}".format(langmuir_err))
+
+
+def remove_oil(group, factors,
+               cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] mass_components,
+               cnp.ndarray[cnp.npy_double, mode='c'] le_mass):
+    """
+    the mass removed by the cleanup operations of a step, in one pass over
+    the LEs: the mass_components of the LEs of each group are scaled by its
+    factor, and le_mass set to their sum, in place. group is the group of
+    each LE, numbered from 0, -1 for the LEs not removed from.
+    """
+    cdef OSErr remove_err
+    cdef cnp.ndarray[int32_t, mode='c'] c_group = \
+        np.ascontiguousarray(group, dtype=np.int32)
+    cdef cnp.ndarray[cnp.npy_double, mode='c'] c_factors = \
+        np.ascontiguousarray(factors, dtype=np.float64)
+
+    N = len(le_mass)
+    if N == 0 or len(c_factors) == 0:
+        return
+
+    if len(c_group) != N or mass_components.shape[0] != N:
+        raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+    remove_err = remove_mass(N, mass_components.shape[1], len(c_factors),
+                             &c_group[0],
+                             &c_factors[0],
+                             &mass_components[0, 0],
+                             &le_mass[0])
+
+    if remove_err == -2:
+        raise ValueError("a group of the LEs has no factor")
+    if remove_err != 0:
+        raise ValueError("C++ call to remove_mass returned error code: "
+                         "{0}".format(remove_err))
+
+
+cdef class WeatheringWorkspace:
+    """
+    lib_gnome's WeatheringWorkspace_c: the arrays dispersion and dissolution
+    work with each step are kept in C++ and reused from step to step. The
+    arrays of the LEs are worked on in place -- only those not already
+    contiguous arrays of doubles are copied.
+    """
+    cdef WeatheringWorkspace_c *workspace
+
+    def __cinit__(self):
+        self.workspace = new WeatheringWorkspace_c()
+
+    def __dealloc__(self):
+        del self.workspace
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def disperse(self, unsigned long step_len,
+                 frac_water, le_mass, le_viscosity, le_density, fay_area,
+                 cnp.ndarray[cnp.npy_double, mode='c'] droplet_avg_size,
+                 double frac_breaking_waves,
+                 double disp_wave_energy,
+                 double wave_height,
+                 double visc_w,
+                 double rho_w,
+                 double C_sed,
+                 double V_entrain,
+                 double ka):
+        """
+        disperses the LEs over step_len and sets their droplet_avg_size in
+        place
+
+        :returns: (dispersed, sedimented) the total mass of each
+        """
+        cdef OSErr disp_err
+        cdef double dispersed = 0., sedimented = 0.
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_fw = \
+            np.ascontiguousarray(frac_water, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_mass = \
+            np.ascontiguousarray(le_mass, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_visc = \
+            np.ascontiguousarray(le_viscosity, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_density = \
+            np.ascontiguousarray(le_density, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_area = \
+            np.ascontiguousarray(fay_area, dtype=np.float64)
+        cdef LECount N = len(c_mass)
+
+        if N == 0:
+            return (0., 0.)
+
+        if (len(c_fw) != N or len(c_visc) != N or len(c_density) != N or
+                len(c_area) != N or len(droplet_avg_size) != N):
+            raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+        with nogil:
+            disp_err = self.workspace.Disperse(N, step_len,
+                                               &c_fw[0], &c_mass[0],
+                                               &c_visc[0], &c_density[0],
+                                               &c_area[0],
+                                               &droplet_avg_size[0],
+                                               frac_breaking_waves,
+                                               disp_wave_energy,
+                                               wave_height,
+                                               visc_w,
+                                               rho_w,
+                                               C_sed,
+                                               V_entrain,
+                                               ka,
+                                               &dispersed,
+                                               &sedimented)
+
+        if disp_err != 0:
+            raise ValueError("C++ call to disperse returned error code: "
+                             "{0}".format(disp_err))
+
+        return (dispersed, sedimented)
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def dissolve(self, unsigned long step_len,
+                 cnp.ndarray[cnp.npy_double, ndim=2, mode='c'] mass_components,
+                 cnp.ndarray[cnp.npy_double, mode='c'] le_mass,
+                 area, droplet_avg_size,
+                 cnp.ndarray[cnp.npy_double, mode='c'] partition_coeff,
+                 k_ow, mol_weight, density,
+                 double rho_water,
+                 double wave_height,
+                 double wave_period,
+                 double frac_breaking_waves,
+                 double wind_speed):
+        """
+        dissolves the aromatic components of the LEs over step_len, in place
+        in mass_components; le_mass is set to what's left and
+        partition_coeff to the molar averaged partition coefficient of each
+        LE. k_ow is the partition coefficient of each component, 0 for those
+        that are not aromatic.
+
+        :returns: the mass dissolved
+        """
+        cdef OSErr diss_err
+        cdef double dissolved = 0.
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_area = \
+            np.ascontiguousarray(area, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_drop = \
+            np.ascontiguousarray(droplet_avg_size, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_k_ow = \
+            np.ascontiguousarray(k_ow, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_mw = \
+            np.ascontiguousarray(mol_weight, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_rho = \
+            np.ascontiguousarray(density, dtype=np.float64)
+        cdef LECount N = mass_components.shape[0]
+        cdef int num_components = mass_components.shape[1]
+
+        if N == 0:
+            return 0.
+
+        if (len(le_mass) != N or len(c_area) != N or len(c_drop) != N or
+                len(partition_coeff) != N):
+            raise ValueError("the arrays are not all of the {0} LEs".format(N))
+
+        if (len(c_k_ow) != num_components or len(c_mw) != num_components or
+                len(c_rho) != num_components):
+            raise ValueError("the components are not all of the {0} of "
+                             "mass_components".format(num_components))
+
+        with nogil:
+            diss_err = self.workspace.Dissolve(N, num_components, step_len,
+                                               &mass_components[0, 0],
+                                               &le_mass[0],
+                                               &c_area[0],
+                                               &c_drop[0],
+                                               &partition_coeff[0],
+                                               &c_k_ow[0],
+                                               &c_mw[0],
+                                               &c_rho[0],
+                                               rho_water,
+                                               wave_height,
+                                               wave_period,
+                                               frac_breaking_waves,
+                                               wind_speed,
+                                               &dissolved)
+
+        if diss_err != 0:
+            raise ValueError("C++ call to dissolve returned error code: "
+                             "{0}".format(diss_err))
+
+        return dissolved
+
+
+
+cdef double *_pipeline_array(data, name, kept) except? NULL:
+    '''
+    the data array, as contiguous doubles kept alive in kept, NULL if the
+    data doesn't have it
+    '''
+    cdef cnp.ndarray array
+
+    if name not in data:
+        return NULL
+
+    array = np.ascontiguousarray(data[name], dtype=np.float64)
+    kept.append((name, array))
+    if array.size == 0:
+        return NULL
+
+    return <double *>array.data
+
+
+cdef class WeatheringPipeline:
+    """
+    lib_gnome's WeatheringPipeline_c: the stages of the weatherers added
+    with the add_*() methods, each with its values at each sub-step, run
+    one after the other on a substance's data arrays by run() -- each over
+    all the sub-steps before the next, as the model runs the weatherers.
+    The arrays are worked on in place, those not already contiguous arrays
+    of doubles (of int32 for 'age') are copied and written back.
+    """
+    cdef WeatheringPipeline_c *pipeline
+    cdef readonly int num_steps
+
+    def __cinit__(self):
+        self.pipeline = new WeatheringPipeline_c()
+        self.num_steps = -1
+
+    def __dealloc__(self):
+        del self.pipeline
+
+    def __len__(self):
+        return self.pipeline.GetNumStages()
+
+    def clear(self):
+        self.pipeline.Clear()
+        self.num_steps = -1
+
+    def _per_step(self, values):
+        values = np.ascontiguousarray(values, dtype=np.float64)
+        if self.num_steps < 0:
+            self.num_steps = len(values)
+        elif len(values) != self.num_steps:
+            raise ValueError('the stages are of {0} sub-steps, not {1}'
+                             .format(self.num_steps, len(values)))
+
+        return values
+
+    def add_evaporation(self, mass_transport_coeffs, vapor_pressure,
+                        mol_weight, double water_temp, double gas_constant):
+        """
+        evaporate_oil() of the sub-steps, with the wind's mass transport
+        coefficient at each, then the LEs' frac_lost set from their mass
+        """
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_K = \
+            self._per_step(mass_transport_coeffs)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_vp = \
+            np.ascontiguousarray(vapor_pressure, dtype=np.float64)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_mw = \
+            np.ascontiguousarray(np.broadcast_to(mol_weight, c_vp.shape),
+                                 dtype=np.float64)
+        cdef double dummy = 0.
+
+        self.pipeline.AddEvaporation(len(c_K),
+                                     &c_K[0] if len(c_K) else &dummy,
+                                     len(c_vp),
+                                     &c_vp[0] if len(c_vp) else &dummy,
+                                     &c_mw[0] if len(c_mw) else &dummy,
+                                     water_temp, gas_constant)
+
+    def add_dispersion(self, frac_breaking_waves, disp_wave_energy,
+                       wave_height, double visc_w, double rho_w,
+                       double C_sed, double V_entrain, double ka):
+        """
+        disperse() of each sub-step with the waves of each, the dispersed
+        then the sedimented mass taken out of the components
+        """
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_frac = \
+            self._per_step(frac_breaking_waves)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_energy = \
+            self._per_step(disp_wave_energy)
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_height = \
+            self._per_step(wave_height)
+        cdef double dummy = 0.
+
+        self.pipeline.AddDispersion(len(c_frac),
+                                    &c_frac[0] if len(c_frac) else &dummy,
+                                    &c_energy[0] if len(c_frac) else &dummy,
+                                    &c_height[0] if len(c_frac) else &dummy,
+                                    visc_w, rho_w, C_sed, V_entrain, ka)
+
+    def add_emulsification(self, k_emul, double emul_time, double emul_C,
+                           double S_max, double Y_max, double drop_max):
+        """
+        emulsify_oil() of each sub-step with its water uptake rate
+        """
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_k = \
+            self._per_step(k_emul)
+        cdef double dummy = 0.
+
+        self.pipeline.AddEmulsification(len(c_k),
+                                        &c_k[0] if len(c_k) else &dummy,
+                                        emul_time, emul_C, S_max, Y_max,
+                                        drop_max)
+
+    def run(self, step_lens, data):
+        """
+        runs the stages over the sub-steps of step_lens seconds on the
+        arrays of data, a substance's dict of the data arrays
+
+        :returns: a list of the totals of each stage: (evaporated, ),
+            (dispersed, sedimented), ()
+        """
+        cdef OSErr err
+        cdef WeatheringArrays arrays
+        cdef cnp.ndarray[cnp.npy_double, mode='c'] c_step_lens = \
+            np.ascontiguousarray(step_lens, dtype=np.float64)
+        cdef cnp.ndarray[int32_t, mode='c'] c_age
+        cdef WeatheringStageResult *results
+        cdef LECount N = len(data['mass'])
+        cdef int num_components = 0, num_steps = len(c_step_lens)
+        cdef long i, num_stages = self.pipeline.GetNumStages()
+
+        if num_stages == 0 or N == 0:
+            return [() for i in range(num_stages)]
+
+        if num_steps != self.num_steps:
+            raise ValueError('the stages are of {0} sub-steps, not {1}'
+                             .format(self.num_steps, num_steps))
+
+        if 'mass_components' in data:
+            num_components = data['mass_components'].shape[1]
+
+        kept = []
+        arrays.massComponents = _pipeline_array(data, 'mass_components',
+                                                kept)
+        arrays.mass = _pipeline_array(data, 'mass', kept)
+        arrays.initMass = _pipeline_array(data, 'init_mass', kept)
+        arrays.evapDecay = _pipeline_array(data, 'evap_decay_constant', kept)
+        arrays.area = _pipeline_array(data, 'area', kept)
+        arrays.fracWater = _pipeline_array(data, 'frac_water', kept)
+        arrays.fracLost = _pipeline_array(data, 'frac_lost', kept)
+        arrays.viscosity = _pipeline_array(data, 'viscosity', kept)
+        arrays.density = _pipeline_array(data, 'density', kept)
+        arrays.fayArea = _pipeline_array(data, 'fay_area', kept)
+        arrays.dropletAvgSize = _pipeline_array(data, 'droplet_avg_size',
+                                                kept)
+        arrays.interfacialArea = _pipeline_array(data, 'interfacial_area',
+                                                 kept)
+        arrays.bulltime = _pipeline_array(data, 'bulltime', kept)
+        arrays.age = NULL
+        if 'age' in data:
+            c_age = np.ascontiguousarray(data['age'], dtype=np.int32)
+            kept.append(('age', c_age))
+            arrays.age = &c_age[0]
+
+        for name, array in kept:
+            if len(array) != N:
+                raise ValueError("the arrays are not all of the {0} LEs"
+                                 .format(N))
+
+        results = <WeatheringStageResult *>stdlib.malloc(
+            num_stages * sizeof(WeatheringStageResult))
+        if results == NULL:
+            raise MemoryError()
+
+        try:
+            with nogil:
+                err = self.pipeline.Run(N, num_components, num_steps,
+                                        &c_step_lens[0], arrays, results)
+
+            if err != 0:
+                raise ValueError("C++ call to the weathering pipeline "
+                                 "returned error code: {0}".format(err))
+
+            for name, array in kept:
+                if array is not data[name]:
+                    data[name][:] = array
+
+            totals = []
+            for i in range(num_stages):
+                if results[i].kind == kStageEvaporation:
+                    totals.append((results[i].totals[0], ))
+                elif results[i].kind == kStageDispersion:
+                    totals.append((results[i].totals[0],
+                                   results[i].totals[1]))
+                else:
+                    totals.append(())
+        finally:
+            stdlib.free(results)
+
+        return totals
@@ -4,10 +4,11 @@ import numpy as np
 from gnome import basic_types
 
 # following exist in gnome.cy_gnome
-from movers cimport WindMover_c, Mover_c
+from movers cimport WindMover_c, Mover_c, UpdateWindages
 from type_defs cimport WorldPoint3D, LEWindUncertainRec, LEStatus, LEType, \
-                       OSErr, Seconds, VelocityRec
+                       OSErr, Seconds, VelocityRec, LECount
 cimport cy_mover, cy_ossm_time
+cimport utils
 from cy_mover cimport CyWindMoverBase
 
 """
@@ -120,7 +121,42 @@ cdef class CyWindMover(CyWindMoverBase):
         def __set__(self, value):
             self.wind.SetExtrapolationInTime(value)
 
-    def get_move(self, model_time, step_len,
+    property use_counter_rng:
+        """
+        draw the uncertainty factors with the stateless counter based random
+        numbers (keyed on seed, LE index and the time they're drawn) instead
+        of the C rand(). They are then the same for any num_threads, and are
+        drawn on num_threads threads.
+        """
+        def __get__(self):
+            return bool(self.wind.bUseCounterRandom)
+
+        def __set__(self, value):
+            self.wind.bUseCounterRandom = value
+
+    property rng_seed:
+        def __get__(self):
+            return self.wind.fRandomSeed
+
+        def __set__(self, value):
+            self.wind.fRandomSeed = value
+
+    property shared_factor_count:
+        """
+        number of uncertainty LEs in one member of an ensemble whose members
+        release the same spills. The factors are drawn for the first member's
+        LEs only, and the LE at the same place in each of the other members
+        gets the same factors. 0 (the default) draws factors for every LE.
+        """
+        def __get__(self):
+            return self.wind.fSharedFactorCount
+
+        def __set__(self, value):
+            if value < 0:
+                raise ValueError('shared_factor_count must be 0 or more')
+            self.wind.fSharedFactorCount = value
+
+    def get_move(self, Seconds model_time, Seconds step_len,
                  cnp.ndarray[WorldPoint3D, ndim=1] ref_points,
                  cnp.ndarray[WorldPoint3D, ndim=1] delta,
                  cnp.ndarray[cnp.npy_double] windages,
@@ -152,16 +188,17 @@ cdef class CyWindMover(CyWindMoverBase):
         :returns: none
         """
         cdef OSErr err
-        N = len(ref_points)  # set a data type?
+        cdef LECount N = len(ref_points)
 
         # modifies delta in place
-        err = self.wind.get_move(N, model_time, step_len,
-                                  &ref_points[0],
-                                  &delta[0],
-                                  &windages[0],
-                                  &LE_status[0],
-                                  spill_type,
-                                  0)
+        with nogil:
+            err = self.wind.get_move(N, model_time, step_len,
+                                      &ref_points[0],
+                                      &delta[0],
+                                      &windages[0],
+                                      &LE_status[0],
+                                      spill_type,
+                                      0)
         if err == 1:
             raise ValueError('Make sure numpy arrays for ref_points, delta '
                              'and windages are defined')
@@ -218,3 +255,50 @@ cdef class CyWindMover(CyWindMoverBase):
                 raise ValueError
 
         return vel_rec
+
+
+def update_windages(le_ids,
+                    cnp.ndarray[double, ndim=2, mode='c'] windage_range,
+                    cnp.ndarray[long, ndim=1, mode='c'] windage_persist,
+                    cnp.ndarray[double, ndim=1, mode='c'] windages,
+                    double time_step, long step, long stream=0,
+                    seed=None, int num_threads=1):
+    """
+    Draws again, in place, the windages of the elements whose windage
+    persistence is positive, as rand.random_with_persistance does, with
+    lib_gnome's counter based random numbers: the windage of an element is
+    a function of the seed, step, stream and its ID only, so all the wind
+    movers of a time step give it the same windage and it doesn't matter how
+    many threads draw them.
+
+    :param step: the key's step, the model time in seconds
+    :param stream: the key's stream, 1 for the uncertain spill container
+    :param seed: the key's seed, by default the last srand()
+    """
+    cdef cnp.ndarray[cnp.uint32_t, ndim=1] ids = \
+        np.ascontiguousarray(le_ids, dtype=np.uint32).ravel()
+    cdef utils.CounterRandomKey key
+    cdef unsigned int c_seed, c_stream, stream_seed
+    cdef long long draws
+    cdef LECount n = len(windages)
+
+    if (len(ids) != n or len(windage_persist) != n or
+            windage_range.shape[0] != n or windage_range.shape[1] != 2):
+        raise ValueError('le_ids, windage_range, windage_persist and '
+                         'windages must be the same length')
+
+    if seed is None:
+        utils.GetRandomState(&c_seed, &c_stream, &stream_seed, &draws)
+    else:
+        c_seed = seed
+
+    key.seed = c_seed
+    key.spillID = 0
+    key.step = step
+    key.stream = stream
+
+    if n > 0:
+        with nogil:
+            UpdateWindages(key, n, &ids[0], &windage_range[0, 0],
+                           &windage_persist[0], time_step, &windages[0],
+                           num_threads)
@@ -11,11 +11,13 @@ from type_defs cimport (OSErr,
                         VelocityRec,
                         WorldPoint3D,
                         Seconds,
+                        LECount,
                         WorldRect,
                         LongPointHdl,
                         TopologyHdl,
                         DAGHdl,
-                        LONGH)
+                        LONGH,
+                        NUM_METHOD)
 
 
 '''
@@ -23,7 +25,10 @@ Keep following two definitions for now so current cython movers code works
 '''
 cdef extern from "GridVel_c.h":
     cdef cppclass GridVel_c:
-        pass
+        OSErr SetUseBucketIndex(bool useBuckets)
+        bool UsesBucketIndex()
+        OSErr SetUsePackedDagTree(bool usePacked)
+        bool UsesPackedDagTree()
 
 cdef extern from "DagTree.h":
     cdef cppclass TDagTree:
@@ -55,7 +60,7 @@ cdef extern from "TimeGridVel_c.h":
         OSErr       ReadInputFileNames(char *fileNamesPath)
         OSErr       SetInterval(char *errmsg, const Seconds& model_time)
         VelocityRec GetScaledPatValue(Seconds& time, WorldPoint3D p)
-        OSErr 		get_values(int n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels)
+        OSErr 		get_values(LECount n, Seconds model_time, WorldPoint3D* ref, VelocityRec* vels, long *hints) nogil
 
     cdef cppclass TimeGridWindRect_c(TimeGridVel_c):
         pass
@@ -79,3 +84,45 @@ cdef extern from "GridMap_c.h":
         OSErr       ExportTopology(char *path)
         OSErr       SaveAsNetCDF(char *path)
         OSErr       TextRead(char *path)
+
+
+cdef extern from "GridLocator_c.h":
+    cdef cppclass GridLocator_c:
+        GridLocator_c()
+        OSErr   Build(long numNodes, double *lon, double *lat,
+                      long numTris, long *triangles, char *errmsg)
+        long    GetNumNodes()
+        long    GetNumTriangles()
+        void    Locate(long n, double *lon, double *lat,
+                       long *tri, long *node, double *alpha) nogil
+
+        OSErr   GetMoves(long n, double *lon, double *lat, long *tri,
+                         NUM_METHOD method, double timeStep,
+                         double *u0, double *v0,
+                         double *uMid, double *vMid,
+                         double *u1, double *v1,
+                         double *dx, double *dy) nogil
+
+    void Interpolate "GridLocator_c::Interpolate" (long n, long *tri,
+                                                   long *node, double *alpha,
+                                                   double *nodeValues,
+                                                   double fill,
+                                                   double *values) nogil
+
+
+cdef extern from "ConcentrationGrid_c.h":
+    cdef cppclass ConcentrationGrid_c:
+        ConcentrationGrid_c()
+        OSErr   SetRegularGrid(double west, double south,
+                               double east, double north,
+                               long numCols, long numRows)
+        OSErr   SetTriangleGrid(GridLocator_c *locator)
+        OSErr   SetLayers(long numEdges, double *edges)
+        long    GetNumCells()
+        long    GetNumLayers()
+        void    Clear()
+        long    AddMass(long n, double *lon, double *lat, double *depth,
+                        double *mass, long *cell) nogil
+        const double   *GetMass()
+        void    GetCellAreas(double *area)
+        void    GetCellCenters(double *lon, double *lat)
@@ -2,11 +2,12 @@
 Declare the C++ mover classes from lib_gnome
 """
 from libcpp cimport bool
+from libcpp.vector cimport vector
 
-from libc.stdint cimport int32_t
+from libc.stdint cimport int32_t, int64_t, uint32_t
 
 from type_defs cimport *
-from utils cimport OSSMTimeValue_c
+from utils cimport OSSMTimeValue_c, CounterRandomKey
 
 from grids cimport GridVel_c, TimeGridVel_c
 """
@@ -16,22 +17,114 @@ these are declared here. This may get smaller as we work through the
 cython files since there maybe no need to expose all the C++ functionality.
 """
 
+'timers:'
+cdef extern from "TimingStats.h":
+    enum:
+        kNumTimers
+        kNumSectionCounters
+
+    ctypedef struct TimerStats:
+        int64_t count
+        int64_t numLEs
+        int64_t nanoseconds
+        int64_t bytesRead
+        int64_t counts[kNumSectionCounters]
+
+    cdef cppclass TimingStats:
+        TimerStats GetTimer(short timer)
+
+    const char *GetTimerName(short timer)
+    const char *GetSectionCounterName(short counter)
+    bool GetSectionCountersOpen()
+
 'movers:'
 cdef extern from "Mover_c.h":
     cdef cppclass Mover_c:
         OSErr PrepareForModelRun()
         OSErr PrepareForModelStep(Seconds &time, Seconds &time_step,
                                   bool uncertain, int numLESets,
-                                  int32_t *LESetsSizesList)    # currently this happens in C++ get_move command
+                                  LECount *LESetsSizesList)    # currently this happens in C++ get_move command
         void ModelStepIsDone()
-        OSErr ReallocateUncertainty(int numLEs, short* LE_status)
+        OSErr ReallocateUncertainty(LECount numLEs, short* LE_status)
+        void SetNumThreads(int numThreads)
+        int GetNumThreads()
+        void GetTimingStats(TimingStats *stats)
+        void ResetTimingStats()
+        OSErr GetRunState(vector[char] &state)
+        OSErr SetRunState(char *state, long size)
+        OSErr get_move_batch(LECount n, Seconds model_time, Seconds step_len,
+                             double *lat, double *lon, double *z,
+                             double *windages, short *LE_status,
+                             double *delta_lat, double *delta_lon,
+                             double *delta_z,
+                             LEType spillType, long spill_ID) nogil
+        OSErr get_move_batch_active(LECount n, LECount numActive,
+                                    LECount *active,
+                                    Seconds model_time, Seconds step_len,
+                                    double *lat, double *lon, double *z,
+                                    double *windages, short *LE_status,
+                                    double *delta_lat, double *delta_lon,
+                                    double *delta_z,
+                                    LEType spillType, long spill_ID) nogil
+
+    OSErr MoveFused(int numMovers, Mover_c **movers, double **windages,
+                    LECount n, LECount numActive, LECount *active,
+                    Seconds model_time, Seconds step_len,
+                    double *lat, double *lon, double *z, short *LE_status,
+                    double *next_lat, double *next_lon, double *next_z,
+                    LEType spillType, long spill_ID) nogil
+
+    OSErr MoveEnsemble(int numMovers, Mover_c **movers, double **windages,
+                       int numMembers, LECount *memberStart, double *memberScale,
+                       LECount n, LECount numActive, LECount *active,
+                       Seconds model_time, Seconds step_len,
+                       double *lat, double *lon, double *z, short *LE_status,
+                       double *next_lat, double *next_lon, double *next_z,
+                       LEType spillType, long spill_ID) nogil
+
+cdef extern from "TransportDriver.h":
+    ctypedef struct TransportMap:
+        unsigned char *land
+        long width
+        long height
+        long rowBytes
+        double transform[6]
+        long numBoundPts
+        double *boundPts
+        double refloatProbability
+        CounterRandomKey refloatKey
+
+    ctypedef struct TransportLEs:
+        LECount n
+        double *lon
+        double *lat
+        double *z
+        short *status
+        double *lastWaterLon
+        double *lastWaterLat
+        double *lastWaterZ
+        uint32_t *ids
+        double *windages
+        double *windageRange
+        long *windagePersist
+        CounterRandomKey windageKey
+
+    OSErr RunTransportSteps(int numMovers, Mover_c **movers,
+                            char *usesWindages,
+                            TransportMap &map, TransportLEs &les,
+                            int numSteps, Seconds modelTime, Seconds stepLen,
+                            double *trackLon, double *trackLat,
+                            double *trackZ, short *trackStatus,
+                            int *stepsDone, LECount *numBeached) nogil
 
 cdef extern from "Random_c.h":
     cdef cppclass Random_c(Mover_c):
         Random_c() except +
         double fDiffusionCoefficient
         double fUncertaintyFactor
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)        
+        Boolean bUseCounterRandom
+        long fRandomSeed
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID) nogil
 
 cdef extern from "RandomVertical_c.h":
     cdef cppclass RandomVertical_c(Mover_c):
@@ -39,20 +132,22 @@ cdef extern from "RandomVertical_c.h":
         double fVerticalDiffusionCoefficient
         double fVerticalBottomDiffusionCoefficient
         double fMixedLayerDepth
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID)        
+        Boolean bUseCounterRandom
+        long fRandomSeed
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, short* LE_status, LEType spillType, long spillID) nogil
 
 cdef extern from "RiseVelocity_c.h":
-    OSErr get_rise_velocity(int n, double *rise_vel, double *le_density, double *le_drop_size, double water_vis, double water_density)
+    OSErr get_rise_velocity(LECount n, double *rise_vel, double *le_density, double *le_drop_size, double water_vis, double water_density)
 
     # the mover class, above is just a function for computing rise velocity
     cdef cppclass RiseVelocity_c(Mover_c):
         RiseVelocity_c() except +
         #double water_density
         #double water_viscosity
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len,
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len,
                        WorldPoint3D* ref, WorldPoint3D* delta,
                        double* rise_velocity,
-                       short* LE_status, LEType spillType, long spillID)        
+                       short* LE_status, LEType spillType, long spillID) nogil
 
 cdef extern from "WindMover_c.h":
     cdef cppclass WindMover_c(Mover_c):
@@ -63,13 +158,21 @@ cdef extern from "WindMover_c.h":
         double fUncertainStartTime
         double fSpeedScale
         double fAngleScale
+        Boolean bUseCounterRandom
+        long fRandomSeed
+        LECount fSharedFactorCount
 
-        OSErr get_move(int n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID)
+        OSErr get_move(LECount n, unsigned long model_time, unsigned long step_len, WorldPoint3D* ref, WorldPoint3D* delta, double* windages, short* LE_status, LEType spillType, long spill_ID) nogil
         void SetTimeDep(OSSMTimeValue_c *ossm)
         OSErr GetTimeValue(Seconds &time, VelocityRec *vel)
         void  SetExtrapolationInTime(bool extrapolate)
         bool  GetExtrapolationInTime()
 
+    void UpdateWindages(CounterRandomKey &key, LECount n, uint32_t *leIDs,
+                        double *windageRange, long *persistence,
+                        double timeStep, double *windages,
+                        int numThreads) nogil
+
 cdef extern from "GridWindMover_c.h":
     cdef cppclass GridWindMover_c(WindMover_c):
         # Why can't I do this?
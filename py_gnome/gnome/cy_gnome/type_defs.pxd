@@ -20,6 +20,8 @@ cdef extern from "TypeDefs.h":
     ctypedef short OSErr
     ctypedef unsigned long LETYPE
     ctypedef long Seconds
+    # int64_t: the count or index of an LE
+    ctypedef long long LECount
 
 cdef extern from "GEOMETRY.H":
     ctypedef struct WorldPoint:
@@ -48,22 +50,22 @@ cdef extern from "TypeDefs.h":
         double uncertaintyValue
 
     ctypedef struct LERec:
-        long leUnits
-        long leKey
-        long leCustomData
         WorldPoint p
         double z
+        short statusCode
+        short dispersionStatus
+        short pollutantType
+        long leKey
+        long leCustomData
+        double windage
+        double mass
+        double riseVelocity
         unsigned long releaseTime
+        long leUnits
         double ageInHrsWhenReleased
         unsigned long clockRef
-        short pollutantType
-        double mass
         double density
-        double windage
         long dropletSize
-        short dispersionStatus
-        double riseVelocity
-        short statusCode
         WorldPoint lastWaterPt
         unsigned long beachTime
         
@@ -120,6 +122,8 @@ cdef extern from "TypeDefs.h":
     ctypedef enum NUM_METHOD:
         EULER = 0
         RK4 = 1
+        ADAPTIVE = 2
+        TRAPEZOID = 3
     
     # In C++, this information is defined for each LE
     # However, it is the same for all LEs in a spill.
@@ -13,6 +13,221 @@ cdef extern from "MemUtils.h":
     Handle _NewHandle(long)
     void _DisposeHandleReally(Handle)
     long _GetHandleSize(Handle)
+    void SetHandlePooling(Boolean)
+    Boolean GetHandlePooling()
+    void BeginHandleArena()
+    void EndHandleArena()
+    void SetTimeSliceRecycling(Boolean)
+    Boolean GetTimeSliceRecycling()
+    Boolean SetTimeSliceInterleaving(Boolean)
+    Boolean GetTimeSliceInterleaving()
+    enum:
+        kHugePagesOff
+        kHugePagesTransparent
+        kHugePagesExplicit
+    Boolean SetHugePages(short, long)
+    short GetHugePages(long *)
+
+    ctypedef struct MemoryUsage:
+        int64_t bytes
+        int64_t peakBytes
+        int64_t numBlocks
+
+    enum:
+        kNumMemoryTags
+    void GetMemoryUsage(short, MemoryUsage *)
+    const char *GetMemoryTagName(short)
+    void ResetMemoryPeaks()
+    int64_t ShareHandleBlocks(const char *, long, Boolean)
+
+"""
+The NUMA nodes and the pinning of the OpenMP threads to them,
+lib_gnome/GnomeThreads.h
+"""
+cdef extern from "GnomeThreads.h":
+    int GetNumaNodeCount()
+    int PinWorkerThreads(int)
+
+"""
+Chrome trace events of the timed lib_gnome sections, lib_gnome/TimingStats.h
+"""
+cdef extern from "TimingStats.h":
+    ctypedef struct SectionTraceEvent:
+        int64_t start
+        int64_t duration
+        int64_t numLEs
+        int32_t thread
+        short timer
+
+    const char *GetTimerName(short timer)
+    bool SetSectionTracing(bool on)
+    bool GetSectionTracing()
+    int64_t GetSectionTraceClock()
+    long TakeSectionTrace(SectionTraceEvent *events, long maxEvents)
+    long GetSectionTraceDropped()
+
+    enum:
+        kNumTLBCounters
+    bool OpenTLBCounters()
+    void CloseTLBCounters()
+    void ReadTLBCounters(int64_t *counts)
+    const char *GetTLBCounterName(short counter)
+
+    enum:
+        kNumSectionCounters
+    bool OpenSectionCounters()
+    void CloseSectionCounters()
+    bool GetSectionCountersOpen()
+    void ReadSectionCounters(int64_t *counts)
+    const char *GetSectionCounterName(short counter)
+
+"""
+The lib_gnome random numbers, lib_gnome/CompFunctions.h
+"""
+cdef extern from "CompFunctions.h":
+    void SetRandomSeed(unsigned int)
+    void SetRandomStream(unsigned int)
+    unsigned int GetRandomStream()
+    void GetRandomState(unsigned int *seed, unsigned int *stream,
+                        unsigned int *streamSeed, long long *streamDraws)
+    void SetRandomState(unsigned int seed, unsigned int stream,
+                        unsigned int streamSeed, long long streamDraws)
+
+"""
+The counter based random numbers, lib_gnome/CounterRandom.h
+"""
+cdef extern from "CounterRandom.h":
+    ctypedef struct CounterRandomKey:
+        uint32_t seed
+        long spillID
+        long step
+        long stream
+
+    void FillCounterRandomUniforms(CounterRandomKey &key, LECount n,
+                                   uint32_t *leIDs, long draw,
+                                   double *values) nogil
+
+"""
+Shared cache of gridded data time slices, lib_gnome/TimeSliceCache.h
+"""
+cdef extern from "TimeSliceCache.h":
+    void SetTimeSliceCacheSize(long)
+    long GetTimeSliceCacheSize()
+    long GetTimeSliceCacheBytes()
+    void SetTimeSliceQuantization(Boolean)
+    Boolean GetTimeSliceQuantization()
+    double GetTimeSliceQuantizationError()
+
+"""
+On disk cache of curvilinear grid topology, lib_gnome/TopologyCache.h
+"""
+cdef extern from "TopologyCache.h":
+    void SetTopologyCacheDir(const char *)
+    const char *GetTopologyCacheDir()
+
+"""
+On disk cache of the forcing read from OPeNDAP, lib_gnome/ForcingBlockCache.h
+"""
+cdef extern from "ForcingBlockCache.h":
+    void SetForcingBlockCacheDir(const char *)
+    const char *GetForcingBlockCacheDir()
+    void GetForcingBlockCacheStats(int64_t *, int64_t *)
+
+"""
+The reads of each forcing file, lib_gnome/ForcingIOStats.h
+"""
+cdef extern from "ForcingIOStats.h":
+    enum:
+        kNumForcingIOCounters
+    ctypedef struct ForcingIOStats:
+        int64_t counts[kNumForcingIOCounters]
+
+    void ResetForcingIOStats()
+    long GetNumForcingIOFiles()
+    Boolean GetForcingIOStats(long i, char *path, ForcingIOStats *stats)
+    const char *GetForcingIOCounterName(short counter)
+
+"""
+The cost of each setup stage and the caches that saved it, lib_gnome/SetupStats.h
+"""
+cdef extern from "SetupStats.h":
+    enum:
+        kNumSetupStages
+        kNumSetupCaches
+    ctypedef struct SetupStageStats:
+        int64_t count
+        int64_t nanoseconds
+
+    void GetSetupStats(SetupStageStats *stages, int64_t *cacheHits)
+    void ResetSetupStats()
+    const char *GetSetupStageName(short stage)
+    const char *GetSetupCacheName(short cache)
+
+"""
+Preprocessed tiled forcing files, lib_gnome/ForcingFile.h
+"""
+cdef extern from "ForcingFile.h":
+    OSErr OpenForcingFile(const char *)
+    void CloseForcingFiles()
+    long GetNumForcingFiles()
+
+"""
+Cache of computed tide tables, lib_gnome/TideTableCache.h
+"""
+cdef extern from "TideTableCache.h":
+    void SetTideTableCacheSize(long)
+    long GetTideTableCacheSize()
+    long GetTideTableCacheCount()
+    void SetTideTableCacheDir(const char *)
+    const char *GetTideTableCacheDir()
+
+"""
+On disk cache of time series files read as text, lib_gnome/TimeValuesCache.h
+"""
+cdef extern from "TimeValuesCache.h":
+    void SetTimeValuesCacheDir(const char *)
+    const char *GetTimeValuesCacheDir()
+
+"""
+On disk index of the times in multiple file NetCDF forcing,
+lib_gnome/TimeIndexCache.h
+"""
+cdef extern from "TimeIndexCache.h":
+    void SetTimeIndexCacheDir(const char *)
+    const char *GetTimeIndexCacheDir()
+
+"""
+Harmonic constituent sums for the Shio tides, lib_gnome/ShioHarmonics.h
+"""
+cdef extern from "ShioHarmonics.h":
+    void SetHarmonicRecurrence(Boolean)
+    Boolean GetHarmonicRecurrence()
+
+"""
+Batched velocity interpolation, lib_gnome/InterpolationKernels.h
+"""
+cdef extern from "InterpolationKernels.h":
+    void SetInterpolationSIMD(Boolean)
+    const char *GetInterpolationKernel()
+    Boolean SetInterpolationDevice(Boolean)
+
+"""
+Flat earth and pixel projections of arrays, lib_gnome/GEOMETRY.H
+"""
+cdef extern from "GEOMETRY.H":
+    double LatCosine(double lat)
+    void MetersToLonLat(long n, int dim, const double *deltas,
+                        const double *refPositions, int refDim, long refCount,
+                        double *out)
+    void LonLatToMeters(long n, int dim, const double *deltas,
+                        const double *refPositions, int refDim, long refCount,
+                        double *out)
+    void LonLatToPixels(long n, int dim, const double *coords,
+                        const double *transform, double *pixels)
+    void LonLatToPixelsFloat(long n, int dim, const double *coords,
+                             const double *transform, float *pixels)
+    void LonLatToPixelsInt(long n, int dim, const double *coords,
+                           const double *transform, int *pixels)
 
 """
 Expose DateTime conversion functions from the lib_gnome/StringFunctions.h
@@ -20,6 +235,8 @@ Expose DateTime conversion functions from the lib_gnome/StringFunctions.h
 cdef extern from "StringFunctions.h":
     void DateToSeconds(DateTimeRec *, Seconds *)
     void SecondsToDate(Seconds, DateTimeRec *)
+    void DatesToSeconds(DateTimeRec *, long, Seconds *)
+    void SecondsToDates(Seconds *, long, DateTimeRec *)
 
 """
 Declare methods for interpolation of timeseries from 
@@ -39,6 +256,7 @@ cdef extern from "OSSMTimeValue_c.h":
 
         # Methods
         OSErr   GetTimeValue(Seconds &, VelocityRec *)
+        OSErr   GetTimeValues(Seconds *, long, VelocityRec *)
         OSErr   ReadTimeValues(char *, short, short)
         void    SetTimeValueHandle(TimeValuePairH)    # sets all time values
         TimeValuePairH GetTimeValueHandle()
@@ -88,7 +306,10 @@ cdef extern from "ShioTimeValue_c.h":
         OSErr       GetProgressiveWaveValue(Seconds &, VelocityRec *)
 
 cdef extern from "Weatherers_c.h":
-    OSErr emulsify(int n, unsigned long step_len,
+    void SetWeatheringThreads(int numThreads)
+    int GetWeatheringThreads()
+
+    OSErr emulsify(LECount n, unsigned long step_len,
                    double *frac_water,
                    double *interfacial_area,
                    double *frac_evap,
@@ -101,7 +322,7 @@ cdef extern from "Weatherers_c.h":
                    double Y_max,
                    double drop_max)
 
-    OSErr adios2_disperse(int n, unsigned long step_len,
+    OSErr adios2_disperse(LECount n, unsigned long step_len,
                           double *frac_water,
                           double *le_mass,
                           double *le_viscosity,
@@ -118,3 +339,128 @@ cdef extern from "Weatherers_c.h":
                           double C_sed,
                           double V_entrain,
                           double ka)
+
+    OSErr evaporate(LECount n, int num_components, int num_vp, int num_steps,
+                    double *step_len,
+                    double *K,
+                    double *mass_components,
+                    double *mass,
+                    double *evap_decay,
+                    double *area,
+                    double *frac_water,
+                    double *vapor_pressure,
+                    double *mol_weight,
+                    double water_temp,
+                    double gas_constant,
+                    double *evaporated) nogil
+
+    OSErr fay_spread(LECount n, int num_blobs, int32_t *blob,
+                     int32_t *age, long step_len,
+                     double *blob_init_volume,
+                     double *fay_area,
+                     double *area,
+                     double water_visc,
+                     double rel_buoy,
+                     double thickness_limit,
+                     double k1, double k2,
+                     double gravity)
+
+    OSErr langmuir_coverage(LECount n, int num_groups, int32_t *group,
+                            double *blob_init_volume,
+                            double *fay_area,
+                            double *density,
+                            double *frac_coverage,
+                            double *area,
+                            double v_max,
+                            double rho_water,
+                            double gravity)
+
+    OSErr remove_mass(LECount n, int num_components, int num_groups,
+                      int32_t *group,
+                      double *factor,
+                      double *mass_components,
+                      double *mass)
+
+
+cdef extern from "WeatheringWorkspace_c.h":
+    cdef cppclass WeatheringWorkspace_c:
+        WeatheringWorkspace_c()
+        OSErr Disperse(LECount n, unsigned long step_len,
+                       double *frac_water,
+                       double *le_mass,
+                       double *le_viscosity,
+                       double *le_density,
+                       double *fay_area,
+                       double *droplet_avg_size,
+                       double frac_breaking_waves,
+                       double disp_wave_energy,
+                       double wave_height,
+                       double visc_w,
+                       double rho_w,
+                       double C_sed,
+                       double V_entrain,
+                       double ka,
+                       double *dispersed,
+                       double *sedimented) nogil
+        OSErr Dissolve(LECount n, int num_components, unsigned long step_len,
+                       double *mass_components,
+                       double *le_mass,
+                       double *area,
+                       double *droplet_avg_size,
+                       double *partition_coeff,
+                       double *k_ow,
+                       double *mol_weight,
+                       double *density,
+                       double rho_water,
+                       double wave_height,
+                       double wave_period,
+                       double frac_breaking_waves,
+                       double wind_speed,
+                       double *dissolved) nogil
+
+
+cdef extern from "WeatheringPipeline_c.h":
+    enum:
+        kStageEvaporation
+        kStageDispersion
+        kStageEmulsification
+
+    ctypedef struct WeatheringArrays:
+        double *massComponents
+        double *mass
+        double *initMass
+        double *evapDecay
+        double *area
+        double *fracWater
+        double *fracLost
+        double *viscosity
+        double *density
+        double *fayArea
+        double *dropletAvgSize
+        double *interfacialArea
+        int32_t *age
+        double *bulltime
+
+    ctypedef struct WeatheringStageResult:
+        short kind
+        double totals[2]
+
+    cdef cppclass WeatheringPipeline_c:
+        WeatheringPipeline_c()
+        void Clear()
+        long GetNumStages()
+        void AddEvaporation(int numSteps, const double *K, int numVP,
+                            const double *vaporPressure,
+                            const double *molWeight,
+                            double waterTemp, double gasConstant)
+        void AddDispersion(int numSteps, const double *fracBreakingWaves,
+                           const double *dispWaveEnergy,
+                           const double *waveHeight,
+                           double visc_w, double rho_w, double C_sed,
+                           double V_entrain, double ka)
+        void AddEmulsification(int numSteps, const double *k_emul,
+                               double emulTime, double emulC,
+                               double S_max, double Y_max, double dropMax)
+        OSErr Run(LECount n, int numComponents, int numSteps,
+                  const double *stepLen, const WeatheringArrays &arrays,
+                  WeatheringStageResult *results) nogil
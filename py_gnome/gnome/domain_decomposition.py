@@ -0,0 +1,281 @@
+#!/usr/bin/env python
+"""
+domain_decomposition.py
+
+A run of more elements over a bigger grid than one model holds, split by
+space: the domain is cut into strips of longitude, one per rank, and each
+rank is a Model of all the spills that only releases the ones that start in
+its strip, with its gridded current movers reading only the cells of the
+strip, plus a halo, from their files -- the active window of
+TimeGridVelRect_c, set to the strip before the first read. The movers move
+the elements of the ranks through the element view, get_move_batch.
+
+The ranks step in lockstep. After each step the elements that have moved out
+of a rank's strip go to the rank of the strip they are in now: their data
+arrays are taken out of its spill container and appended to the other
+rank's, with their ids, so they go on as they would have in one model.
+
+The ranks are all in one process, run_local(), or one to an MPI process,
+run_mpi(), which hands the elements over with mpi4py:
+
+    decomposition = Decomposition.strips(((-75., 38.), (-70., 42.)), 4)
+
+    for step in run_local(make_model, decomposition):
+        ...
+
+    # mpiexec -n 4 python run.py, with in run.py
+    for step in run_mpi(make_model, decomposition):
+        ...
+
+make_model(rank) makes the same model for every rank, its outputters aside.
+The rank that releases a spill gives its elements their ids, so an element
+is its spill_num and id in whatever rank it is in. The weatherers and the
+mass balance of a rank only see its elements, and the uncertain spill
+containers aren't decomposed: the models must not be uncertain.
+"""
+import numpy as np
+
+
+class Decomposition(object):
+    """
+    The strips of longitude of the ranks: rank r has the longitudes from
+    edges[r] to edges[r + 1]. The first and last strips go on past the edges
+    of the domain, so every element has a rank; the latitudes are the
+    domain's, for the windows of the movers.
+    """
+    def __init__(self, edges, lat_range):
+        self.edges = np.asarray(edges, dtype=np.float64)
+        self.lat_range = (min(lat_range), max(lat_range))
+
+        if len(self.edges) < 2 or np.any(np.diff(self.edges) <= 0):
+            raise ValueError('the edges of the strips must increase: {0}'
+                             .format(edges))
+
+    def __repr__(self):
+        return ('Decomposition({0}, {1})'
+                .format(list(self.edges), self.lat_range))
+
+    @classmethod
+    def strips(cls, bounds, num_ranks, positions=None):
+        """
+        the domain bounds, ((lon, lat), (lon, lat)) corners, cut in
+        num_ranks strips of longitude: of the same number of positions, an
+        (N, 2 or 3) array of where the elements are expected, or of the same
+        width
+        """
+        ((lo_long, lo_lat), (hi_long, hi_lat)) = bounds
+        lo_long, hi_long = min(lo_long, hi_long), max(lo_long, hi_long)
+
+        if positions is not None and len(positions) >= num_ranks:
+            lon = np.clip(np.asarray(positions)[:, 0], lo_long, hi_long)
+            edges = np.r_[lo_long,
+                          np.percentile(lon, np.linspace(0, 100,
+                                                         num_ranks + 1)
+                                        [1:-1]),
+                          hi_long]
+
+            # the positions are too bunched up for strips of their own
+            if np.any(np.diff(edges) <= 0):
+                edges = np.linspace(lo_long, hi_long, num_ranks + 1)
+        else:
+            edges = np.linspace(lo_long, hi_long, num_ranks + 1)
+
+        return cls(edges, (lo_lat, hi_lat))
+
+    @property
+    def num_ranks(self):
+        return len(self.edges) - 1
+
+    def ranks_of(self, positions):
+        """
+        the rank of the strip each of the (N, 2 or 3) positions is in
+        """
+        positions = np.asarray(positions)
+        if len(positions) == 0:
+            return np.zeros((0, ), dtype=np.intp)
+
+        return np.searchsorted(self.edges[1:-1], positions[:, 0],
+                               side='right').astype(np.intp)
+
+    def region(self, rank):
+        """
+        the ((lon, lat), (lon, lat)) corners of the strip of rank
+        """
+        return ((self.edges[rank], self.lat_range[0]),
+                (self.edges[rank + 1], self.lat_range[1]))
+
+
+def spill_rank(spill, decomposition):
+    """
+    the rank that releases the spill: the one of the strip of its start
+    position, rank 0 for releases without one
+    """
+    start = getattr(spill.release, 'start_position', None)
+    if start is None:
+        return 0
+
+    start = np.asarray(start, dtype=np.float64).reshape(-1)
+    if len(start) < 2:
+        return 0
+
+    return int(decomposition.ranks_of(start[:2].reshape(1, 2))[0])
+
+
+class Rank(object):
+    """
+    The model of a rank: it releases the spills that start in its strip,
+    and its gridded current movers read the strip plus halo cells around it
+    """
+    def __init__(self, model, decomposition, rank, halo=10,
+                 use_element_view=True):
+        if model.uncertain:
+            raise ValueError('the uncertain spill containers of a domain '
+                             'decomposed run are not decomposed')
+
+        self.model = model
+        self.decomposition = decomposition
+        self.rank = rank
+
+        model.use_element_view = use_element_view
+
+        sc = self.spill_container
+        sc.release_spills = set(i for i, spill in enumerate(sc.spills)
+                                if spill_rank(spill, decomposition) == rank)
+
+        self.windowed_movers = []
+        for m in model.movers:
+            cy_mover = getattr(m, 'mover', None)
+            if hasattr(cy_mover, 'set_active_window_bounds'):
+                cy_mover.set_active_window(True, halo)
+                if cy_mover.set_active_window_bounds(decomposition
+                                                     .region(rank)):
+                    self.windowed_movers.append(m)
+
+    @property
+    def spill_container(self):
+        return self.model.spills.items()[0]
+
+    def __len__(self):
+        return len(self.spill_container)
+
+    def step(self):
+        return self.model.step()
+
+    def emigrants(self):
+        """
+        takes the elements that are now in the strips of other ranks out
+
+        :returns: {rank: {name: array}} of their data arrays
+        """
+        sc = self.spill_container
+        if len(sc) == 0:
+            return {}
+
+        ranks = self.decomposition.ranks_of(sc['positions'])
+        leaving = np.flatnonzero(ranks != self.rank)
+        if len(leaving) == 0:
+            return {}
+
+        arrays = sc.extract_elements(leaving)
+        ranks = ranks[leaving]
+        emigrants = {}
+        for rank in np.unique(ranks):
+            index = np.flatnonzero(ranks == rank)
+            emigrants[int(rank)] = dict((name, array[index])
+                                        for name, array
+                                        in arrays.iteritems())
+
+        return emigrants
+
+    def immigrate(self, arrays):
+        """
+        appends elements other ranks' emigrants() took out
+        """
+        self.spill_container.add_elements(arrays)
+
+
+def run_local(make_model, decomposition, halo=10, **kwargs):
+    """
+    the ranks' models of a decomposition in this process, stepped in
+    lockstep, the elements going to the rank of their strip after each step
+
+    :param make_model: make_model(rank) makes the model of a rank
+    :returns: an iterator of the list of the ranks' step() results of each
+        step. The ranks are its ranks attribute.
+    """
+    return _LocalRun([Rank(make_model(rank), decomposition, rank, halo,
+                           **kwargs)
+                      for rank in range(decomposition.num_ranks)])
+
+
+class _LocalRun(object):
+    def __init__(self, ranks):
+        self.ranks = ranks
+
+    def __iter__(self):
+        for r in self.ranks:
+            r.model.rewind()
+
+        return self
+
+    def next(self):
+        steps = [r.step() for r in self.ranks]
+
+        incoming = [[] for _r in self.ranks]
+        for r in self.ranks:
+            for rank, arrays in r.emigrants().iteritems():
+                incoming[rank].append(arrays)
+
+        for r, arrays_list in zip(self.ranks, incoming):
+            for arrays in arrays_list:
+                r.immigrate(arrays)
+
+        return steps
+
+
+def run_mpi(make_model, decomposition, comm=None, halo=10, **kwargs):
+    """
+    the model of this MPI process's rank of a decomposition, stepped in
+    lockstep with the others, the elements sent to the rank of their strip
+    after each step. The communicator, MPI.COMM_WORLD by default, must have
+    a process for each rank.
+
+    :param make_model: make_model(rank) makes the model of a rank
+    :returns: a generator of this rank's step() results
+    """
+    if comm is None:
+        from mpi4py import MPI
+        comm = MPI.COMM_WORLD
+
+    if comm.Get_size() != decomposition.num_ranks:
+        raise ValueError('{0} ranks in the decomposition and {1} MPI '
+                         'processes'.format(decomposition.num_ranks,
+                                            comm.Get_size()))
+
+    rank = Rank(make_model(comm.Get_rank()), decomposition, comm.Get_rank(),
+                halo, **kwargs)
+    rank.model.rewind()
+
+    while True:
+        try:
+            step = rank.step()
+            done = False
+        except StopIteration:
+            step, done = None, True
+
+        # they all end at the same step, they share the model's times
+        if comm.allreduce(done, op=_mpi_lor()):
+            return
+
+        emigrants = rank.emigrants()
+        outgoing = [emigrants.get(r) for r in range(comm.Get_size())]
+        for arrays in comm.alltoall(outgoing):
+            if arrays is not None:
+                rank.immigrate(arrays)
+
+        yield step
+
+
+def _mpi_lor():
+    from mpi4py import MPI
+    return MPI.LOR
@@ -1,43 +1,53 @@
 '''
 environment module
+
+The environment objects are imported from their modules the first time
+they are used, so importing one doesn't import all of them, with netCDF4,
+pyugrid and pysgrid and the cython time series.
 '''
-from environment import Environment, Water, WaterSchema
-from property import EnvProp, VectorProp, Time
-from ts_property import TimeSeriesProp, TSVectorProp
-from grid_property import GriddedProp, GridVectorProp
-from environment_objects import (WindTS,
-                                 GridCurrent,
-                                 GridWind,
-                                 IceConcentration,
-                                 WaterTemperature,
-                                 IceAwareCurrent,
-                                 IceAwareWind)
-from waves import Waves, WavesSchema
-from tide import Tide, TideSchema
-from wind import Wind, WindSchema, constant_wind, wind_from_values
-from running_average import RunningAverage, RunningAverageSchema
-from grid import Grid, GridSchema
+from gnome.utilities.lazy_import import lazy_package
 
+_environment = {'environment': ('Environment', 'Water', 'WaterSchema',
+                                'StepCache'),
+                'property': ('EnvProp', 'VectorProp', 'Time'),
+                'ts_property': ('TimeSeriesProp', 'TSVectorProp'),
+                'grid_property': ('GriddedProp', 'GridVectorProp'),
+                'environment_objects': ('WindTS',
+                                        'GridCurrent',
+                                        'GridWind',
+                                        'IceConcentration',
+                                        'WaterTemperature',
+                                        'IceAwareCurrent',
+                                        'IceAwareWind'),
+                'waves': ('Waves', 'WavesSchema'),
+                'tide': ('Tide', 'TideSchema'),
+                'wind': ('Wind', 'WindSchema', 'constant_wind',
+                         'wind_from_values'),
+                'running_average': ('RunningAverage', 'RunningAverageSchema'),
+                'grid': ('Grid', 'GridSchema')}
 
-__all__ = [Environment,
-           Water,
-           WaterSchema,
-           Waves,
-           WavesSchema,
-           Tide,
-           TideSchema,
-           Wind,
-           WindSchema,
-           RunningAverage,
-           RunningAverageSchema,
-           Grid,
-           GridSchema,
-           constant_wind,
-           WindTS,
-           GridCurrent,
-           GridWind,
-           IceConcentration,
-           WaterTemperature,
-           IceAwareCurrent,
-           IceAwareWind
+__all__ = ['Environment',
+           'Water',
+           'WaterSchema',
+           'StepCache',
+           'Waves',
+           'WavesSchema',
+           'Tide',
+           'TideSchema',
+           'Wind',
+           'WindSchema',
+           'RunningAverage',
+           'RunningAverageSchema',
+           'Grid',
+           'GridSchema',
+           'constant_wind',
+           'WindTS',
+           'GridCurrent',
+           'GridWind',
+           'IceConcentration',
+           'WaterTemperature',
+           'IceAwareCurrent',
+           'IceAwareWind'
            ]
+
+lazy_package(__name__, _environment)
@@ -57,6 +57,69 @@ class Environment(object):
         """
         pass
 
+    def prepare_forcing(self, model_time):
+        """
+        Override this method to read the data of the step at model_time
+        ahead of its prepare_for_model_step(). With Model.pipeline_steps it
+        is called on a background thread while the step before weathers -
+        see gnome.utilities.step_pipeline
+        """
+        pass
+
+
+class StepCache(object):
+    '''
+    The values an environment object computes for the step being run, by
+    time and location, so the weatherers asking for the same ones in the
+    step -- and its weathering substeps -- share one computation. The object
+    resets it in its prepare_for_model_step(), which the model calls for the
+    objects in its environment collection. The values of an object the model
+    doesn't prepare are computed each time they are asked for.
+    '''
+    def __init__(self):
+        self.model_time = None
+        self._values = {}
+
+    def reset(self, model_time=None):
+        '''
+        forget the values: the ones of the step at model_time are kept from
+        now on, none if it is None
+        '''
+        self.model_time = model_time
+        self._values = {}
+
+    def get(self, key, time, compute):
+        '''
+        the value of key at time: compute() the first time it is asked for
+        in the step
+        '''
+        if self.model_time is None:
+            return compute()
+
+        values = self._values
+        if (key, time) not in values:
+            values[key, time] = compute()
+
+        return values[key, time]
+
+    def get_many(self, keys, time, compute):
+        '''
+        the values of each of the keys at time, as a list: compute(missing)
+        gets the values of the ones not asked for yet in the step, in one
+        call with the list of them
+        '''
+        if self.model_time is None:
+            return list(compute(list(keys)))
+
+        values = self._values
+        missing = [k for k in keys if (k, time) not in values]
+        if missing:
+            values.update(zip([(k, time) for k in missing],
+                              compute(missing)))
+
+        return [values[k, time] for k in keys]
+
+
 # define valid units at module scope because the Schema and Object both use it
 _valid_temp_units = _valid_units('Temperature')
 _valid_dist_units = _valid_units('Length')
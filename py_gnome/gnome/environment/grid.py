@@ -115,6 +115,12 @@ class Grid(Environment, Serializable):
         model_time = date_to_sec(model_time)
         self.grid.set_interval(model_time)
 
+    def prepare_forcing(self, model_time):
+        """
+        Loads the data of the step at model_time before it starts
+        """
+        self.grid.set_interval(date_to_sec(model_time))
+
     def get_value(self, time, location):
         '''
         Return the value at specified time and location. 
@@ -124,12 +130,15 @@ class Grid(Environment, Serializable):
 
         return data
 
-    def get_values(self, model_time, positions, velocities):
+    def get_values(self, model_time, positions, velocities, hints=None):
         '''
         Return the values for the given positions
 
+        hints is an optional numpy.int_ array, one per position, kept by the
+        caller from one call to the next so triangle grids start the search
+        where each position was last time
         '''
-        data = self.grid.get_values(model_time, positions, velocities)
+        data = self.grid.get_values(model_time, positions, velocities, hints)
 
         return data
 
@@ -0,0 +1,139 @@
+'''
+grid_locator.py
+
+Interpolation of the variables on a triangle grid (a pyugrid.UGrid) with
+lib_gnome's DAG tree, in place of the grid library's own point location.
+
+The gridded properties are sampled at the same points several times a
+step -- u and v of a current, each at two time slices, at each stage of an
+RK4 step -- and the grid library locates the points again for each of
+them. Here a grid gets one locator, and the triangles and weights the points
+were found to have are kept for the last few arrays of points it was asked
+for, so every variable and time slice sampled at them is a weighted sum of
+three node values.
+
+Variables not on the nodes of a triangle grid, and points off the grid, go
+to grid.interpolate_var_to_points() as before.
+'''
+import weakref
+
+import numpy as np
+
+import pyugrid
+
+from gnome.cy_gnome.cy_grid_locator import CyGridLocator
+from gnome.cy_gnome.cy_grid_integrator import CyGridIntegrator
+
+
+class GridLocatorCache(object):
+    '''
+    The locator of one grid, with the weights of the points it located last
+    '''
+    # the arrays of points a step samples at: the stages of an RK4 step
+    max_points = 4
+
+    def __init__(self, grid):
+        self.locator = CyGridLocator(grid.nodes, grid.faces)
+        self._weights = []
+
+    def weights(self, points):
+        '''
+        (tri, node, alpha) of points, located once for each array of them
+        '''
+        for i, (pts, weights) in enumerate(self._weights):
+            if pts.shape == points.shape and np.array_equal(pts, points):
+                if i > 0:
+                    self._weights.insert(0, self._weights.pop(i))
+                return weights
+
+        # the points move a little each step: start from where the last
+        # points of the same number were
+        hints = None
+        for pts, (tri, _node, _alpha) in self._weights:
+            if len(pts) == len(points):
+                hints = tri
+                break
+
+        weights = self.locator.locate(points, hints)
+
+        self._weights.insert(0, (points.copy(), weights))
+        del self._weights[self.max_points:]
+
+        return weights
+
+    def clear(self):
+        self._weights = []
+
+
+# keyed on the grid, so the locators go with the grids
+_locators = weakref.WeakKeyDictionary()
+
+
+def _locator(grid):
+    if not isinstance(grid, pyugrid.UGrid) or grid.faces is None:
+        return None
+
+    if grid.faces.shape[-1] != 3:
+        return None
+
+    try:
+        return _locators[grid]
+    except KeyError:
+        pass
+    except TypeError:
+        # a grid that can't be referred to weakly
+        return None
+
+    _locators[grid] = GridLocatorCache(grid)
+    return _locators[grid]
+
+
+# the integrators of the movers, which keep their elements' triangles
+_integrators = weakref.WeakKeyDictionary()
+
+
+def grid_integrator(grid, owner):
+    '''
+    The CyGridIntegrator of owner (a mover) on grid, which moves its
+    elements in lib_gnome. None if grid is not a triangle grid.
+    '''
+    cache = _locator(grid)
+    if cache is None:
+        return None
+
+    integrator = _integrators.get(owner)
+    if integrator is None or integrator.locator is not cache.locator:
+        integrator = CyGridIntegrator(cache.locator)
+        _integrators[owner] = integrator
+
+    return integrator
+
+
+def interpolate_var_to_points(grid, points, variable, slices=None, **kwargs):
+    '''
+    grid.interpolate_var_to_points(points, variable, slices, **kwargs) --
+    with the triangles of the points the grid's locator found, when the
+    variable is on the nodes of a triangle grid
+    '''
+    locator = _locator(grid)
+    if locator is not None:
+        values = variable[tuple(slices)] if slices is not None else variable
+        values = np.asarray(values)
+
+        if values.ndim == 1 and len(values) == len(grid.nodes):
+            points = np.asarray(points, dtype=np.float64)
+            if points.ndim == 1:
+                points = points.reshape(1, -1)
+
+            tri, node, alpha = locator.weights(points)
+            result = locator.locator.interpolate(tri, node, alpha, values)
+
+            off_grid = tri < 0
+            if off_grid.any():
+                result[off_grid] = grid.interpolate_var_to_points(
+                    points[off_grid], variable, slices=slices, **kwargs)
+
+            return result
+
+    return grid.interpolate_var_to_points(points, variable, slices=slices,
+                                          **kwargs)
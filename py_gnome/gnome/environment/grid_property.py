@@ -1,12 +1,14 @@
 import warnings
 import copy
 
-import netCDF4 as nc4
+from gnome.utilities.lazy_import import lazy_module
+nc4 = lazy_module('netCDF4')
 import numpy as np
 
 from datetime import datetime, timedelta
 from colander import SchemaNode, Float, Boolean, Sequence, MappingSchema, drop, String, OneOf, SequenceSchema, TupleSchema, DateTime
 from gnome.environment.property import *
+from gnome.environment.grid_locator import interpolate_var_to_points
 
 import pyugrid
 import pysgrid
@@ -267,7 +269,7 @@ class GriddedProp(EnvProp):
         m = True
         if self.time is None:
             # special case! prop has no time variance
-            v0 = self.grid.interpolate_var_to_points(points, self.data, slices=None, slice_grid=sg, _memo=m)
+            v0 = interpolate_var_to_points(self.grid, points, self.data, slices=None, slice_grid=sg, _memo=m)
             return v0
 
         t_alphas = s0 = s1 = value = None
@@ -275,7 +277,7 @@ class GriddedProp(EnvProp):
             self.time.valid_time(time)
         t_index = self.time.index_of(time, extrapolate)
         if len(self.time) == 1:
-            value = self.grid.interpolate_var_to_points(points, self.data, slices=[0], _memo=m)
+            value = interpolate_var_to_points(self.grid, points, self.data, slices=[0], _memo=m)
         else:
             if time > self.time.max_time:
                 value = self.data[-1]
@@ -283,7 +285,7 @@ class GriddedProp(EnvProp):
                 value = self.data[0]
             if extrapolate and t_index == len(self.time.time):
                 s0 = [t_index]
-                value = self.grid.interpolate_var_to_points(points, self.data, slices=s0, _memo=m)
+                value = interpolate_var_to_points(self.grid, points, self.data, slices=s0, _memo=m)
             else:
                 t_alphas = self.time.interp_alpha(time, extrapolate)
                 s1 = [t_index]
@@ -291,14 +293,55 @@ class GriddedProp(EnvProp):
                 if len(self.data.shape) == 4:
                     s0.append(depth)
                     s1.append(depth)
-                v0 = self.grid.interpolate_var_to_points(points, self.data, slices=s0, slice_grid=sg, _memo=m)
-                v1 = self.grid.interpolate_var_to_points(points, self.data, slices=s1, slice_grid=sg, _memo=m)
+                v0 = interpolate_var_to_points(self.grid, points, self.data, slices=s0, slice_grid=sg, _memo=m)
+                v1 = interpolate_var_to_points(self.grid, points, self.data, slices=s1, slice_grid=sg, _memo=m)
                 value = v0 + (v1 - v0) * t_alphas
 
         if units is not None and units != self.units:
             value = unit_conversion.convert(self.units, units, value)
         return value
 
+    def node_values(self, time, units=None, depth=-1, extrapolate=False):
+        '''
+        The values of the property at the nodes of its grid at time T, for
+        the integrators that interpolate to the points themselves.
+
+        :return: an array of a value for each node, or None if the property
+                 is not on the nodes of a triangle grid
+        '''
+        if not isinstance(self.grid, pyugrid.UGrid):
+            return None
+
+        def at_depth(values):
+            values = np.asarray(values)
+            return values[depth] if values.ndim == 2 else values
+
+        if self.time is None:
+            value = at_depth(self.data[:])
+        elif len(self.time) == 1:
+            value = at_depth(self.data[0])
+        else:
+            if not extrapolate:
+                self.time.valid_time(time)
+            t_index = self.time.index_of(time, extrapolate)
+
+            if t_index >= len(self.time.time):
+                value = at_depth(self.data[-1])
+            elif t_index == 0:
+                value = at_depth(self.data[0])
+            else:
+                t_alphas = self.time.interp_alpha(time, extrapolate)
+                v0 = at_depth(self.data[t_index - 1])
+                v1 = at_depth(self.data[t_index])
+                value = v0 + (v1 - v0) * t_alphas
+
+        if value.ndim != 1 or len(value) != len(self.grid.nodes):
+            return None
+
+        if units is not None and units != self.units:
+            value = unit_conversion.convert(self.units, units, value)
+        return value
+
     @classmethod
     def _gen_varname(cls,
                      filename=None,
@@ -518,6 +561,17 @@ class GridVectorProp(VectorProp):
     def is_data_on_nodes(self):
         return self.grid.infer_location(self.variables[0].data) == 'node'
 
+    def node_values(self, time, units=None, depth=-1, extrapolate=False):
+        '''
+        The values of each variable at the nodes of the grid at time T (see
+        GriddedProp.node_values), or None if they are not on the nodes of a
+        triangle grid
+        '''
+        values = [var.node_values(time, units, depth, extrapolate)
+                  for var in self.variables]
+
+        return None if any(v is None for v in values) else values
+
     @property
     def time(self):
         return self._time
@@ -1,7 +1,8 @@
 import warnings
 import copy
 
-import netCDF4 as nc4
+from gnome.utilities.lazy_import import lazy_module
+nc4 = lazy_module('netCDF4')
 import numpy as np
 
 from datetime import datetime, timedelta
@@ -255,12 +256,44 @@ class VectorProp(object):
         return np.column_stack([var.at(*args, **kwargs) for var in self._variables])
 
 
+_epoch = datetime(1970, 1, 1)
+
+
+def _to_seconds(times):
+    '''
+    seconds since 1970 of a datetime, or an int64 array of them for a
+    sequence of datetimes
+    '''
+    if isinstance(times, datetime):
+        delta = times - _epoch
+        return delta.days * 86400 + delta.seconds
+
+    try:
+        return np.array(times, dtype='datetime64[s]').astype(np.int64)
+    except (TypeError, ValueError):
+        # the datetimes of other calendars, from netCDF4.num2date
+        return np.array([_to_seconds(t) if isinstance(t, datetime)
+                         else int((t - _epoch).total_seconds())
+                         for t in times], dtype=np.int64)
+
+
+def _is_times(time):
+    '''
+    whether time is a batch of times, not one
+    '''
+    return isinstance(time, (list, tuple, np.ndarray))
+
+
 class Time(object):
 
     def __init__(self, time_seq, tz_offset=None, offset=None):
         '''
         Representation of a time axis. Provides interpolation alphas and indexing.
 
+        The times are kept as int64 seconds too, which the indexing works on,
+        with the interval the last time queried was in: a model stepping
+        through the times finds them there or in the next one.
+
         :param time_seq: Ascending list of times to use
         :param tz_offset: offset to compensate for time zone shifts
         :type time_seq: netCDF4.Variable or [] of datetime.datetime
@@ -280,6 +313,17 @@ class Time(object):
         if self._has_duplicates(self.time):
             raise ValueError("Time sequence has duplicate entries")
 
+    @property
+    def time(self):
+        return self._time
+
+    @time.setter
+    def time(self, time_seq):
+        self._time = time_seq
+        self._seconds = _to_seconds(time_seq)
+        self._bracket = 0
+        self._last_time = self._last_seconds = None
+
     @classmethod
     def time_from_nc_var(cls, var):
         return cls(nc4.num2date(var[:], units=var.units))
@@ -303,6 +347,14 @@ class Time(object):
     def _has_duplicates(self, ts):
         return len(np.unique(ts)) != len(ts) and len(ts) != 1
 
+    def _time_seconds(self, time):
+        # the model asks for the same time of each property at a step
+        if time is not self._last_time:
+            self._last_time = time
+            self._last_seconds = _to_seconds(time)
+
+        return self._last_seconds
+
     @property
     def min_time(self):
         '''
@@ -335,44 +387,96 @@ class Time(object):
         return not time < self.min_time or time > self.max_time
 
     def valid_time(self, time):
-        if time < self.min_time or time > self.max_time:
+        if _is_times(time):
+            seconds = _to_seconds(time)
+            if len(seconds) == 0:
+                return
+            out = ((seconds < self._seconds[0]) |
+                   (seconds > self._seconds[-1]))
+            if out.any():
+                self.valid_time(np.asarray(time)[out][0])
+            return
+
+        seconds = self._time_seconds(time)
+        if seconds < self._seconds[0] or seconds > self._seconds[-1]:
             raise ValueError('time specified ({0}) is not within the bounds of the time ({1} to {2})'.format(
                 time.strftime('%c'), self.min_time.strftime('%c'), self.max_time.strftime('%c')))
 
+    def _index_of_seconds(self, seconds):
+        '''
+        the index of the first time at or after seconds -- from the interval
+        the last one was in when it or the next one has it
+        '''
+        times = self._seconds
+        n = len(times)
+
+        for index in (self._bracket, self._bracket + 1):
+            if (index <= n and
+                    (index == 0 or times[index - 1] < seconds) and
+                    (index == n or seconds <= times[index])):
+                self._bracket = index
+                return index
+
+        self._bracket = int(np.searchsorted(times, seconds))
+        return self._bracket
+
     def index_of(self, time, extrapolate):
         '''
         Returns the index of the provided time with respect to the time intervals in the file.
 
-        :param time: Time to be queried
+        :param time: Time to be queried, or a sequence of them
         :param extrapolate:
-        :type time: datetime.datetime
+        :type time: datetime.datetime, or [] of datetime.datetime
         :type extrapolate: boolean
-        :return: index of first time before specified time
+        :return: index of first time before specified time, an array of
+                 them for a sequence of times
         :rtype: integer
         '''
         if not (extrapolate or len(self.time) == 1):
             self.valid_time(time)
-        index = np.searchsorted(self.time, time)
-        return index
+
+        if _is_times(time):
+            return np.searchsorted(self._seconds, _to_seconds(time))
+
+        return self._index_of_seconds(self._time_seconds(time))
 
     def interp_alpha(self, time, extrapolate=False):
         '''
         Returns interpolation alpha for the specified time
 
-        :param time: Time to be queried
+        :param time: Time to be queried, or a sequence of them
         :param extrapolate:
-        :type time: datetime.datetime
+        :type time: datetime.datetime, or [] of datetime.datetime
         :type extrapolate: boolean
-        :return: interpolation alpha
+        :return: interpolation alpha, an array of them for a sequence of
+                 times
         :rtype: double (0 <= r <= 1)
         '''
         if not len(self.time) == 1 or not extrapolate:
             self.valid_time(time)
-        i0 = self.index_of(time, extrapolate)
-        if i0 > len(self.time) - 1:
+
+        times = self._seconds
+
+        if _is_times(time):
+            seconds = _to_seconds(time)
+            i0 = np.searchsorted(times, seconds)
+
+            alpha = np.zeros(seconds.shape, dtype=np.float64)
+            alpha[i0 > len(times) - 1] = 1
+
+            inside = (i0 > 0) & (i0 < len(times))
+            t0 = times[i0[inside] - 1]
+            t1 = times[i0[inside]]
+            alpha[inside] = (seconds[inside] - t0) / (t1 - t0).astype(np.float64)
+
+            return alpha
+
+        seconds = self._time_seconds(time)
+        i0 = self._index_of_seconds(seconds)
+        if i0 > len(times) - 1:
             return 1
         if i0 == 0:
             return 0
-        t0 = self.time[i0 - 1]
-        t1 = self.time[i0]
-        return (time - t0).total_seconds() / (t1 - t0).total_seconds()
+        t0 = times[i0 - 1]
+        t1 = times[i0]
+        return float(seconds - t0) / (t1 - t0)
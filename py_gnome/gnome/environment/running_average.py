@@ -230,12 +230,9 @@ class RunningAverage(Environment, Serializable):
         model_time = date_to_sec(model_time)
         if self.ossm.check_time_in_range(model_time):
             return
-        else:
-            if self.wind.ossm.check_time_in_range(model_time):
-                # there is wind data for this time so create
-                # a new running average
-                self.create_running_average_timeseries(self._past_hours_to_average, model_time)
 
+        # the wind's time series keeps the hours it has looked up and the
+        # last series, so a series made again for the same window is a copy
         self.create_running_average_timeseries(self._past_hours_to_average,
                                                model_time)
 
@@ -6,6 +6,8 @@ import string
 import os
 import copy
 
+import numpy as np
+
 from colander import SchemaNode, String, Float, drop
 
 import gnome
@@ -20,6 +22,8 @@ from gnome.persist import base_schema
 #       CHB-- I don't think that's a problem -- that's what namespaces are for!
 
 from gnome.utilities.convert import tsformat
+from gnome.utilities import time_utils
+from gnome.utilities.setup_profile import setup_stage
 
 from gnome.utilities.serializable import Serializable, Field
 
@@ -90,7 +94,10 @@ class Tide(Environment, Serializable):
         # define locally so it is available even for OSSM files,
         # though not used by OSSM files
         self._yeardata = None
-        self.cy_obj = self._obj_to_create(filename)
+        with setup_stage(self, 'read') as caches:
+            self.cy_obj = self._obj_to_create(filename)
+            if isinstance(self.cy_obj, CyTimeseries):
+                caches['time_values'] = False
         # self.yeardata = os.path.abspath( yeardata ) # set yeardata
         self.yeardata = yeardata  # set yeardata
         self.name = kwargs.pop('name', os.path.split(self.filename)[1])
@@ -162,6 +169,22 @@ class Tide(Environment, Serializable):
                              'that can be read by OSSM or Shio to get '
                              'tide information')
 
+    def get_values(self, times):
+        '''
+        The scaled tide at each of the times, in one call to the C++ object
+        for all of them.
+
+        :param times: the times you want the data for
+        :type times: datetime objects, numpy.datetime64 or seconds since the
+            epoch (int64, see time_utils.date_to_sec) -- a scalar or
+            a sequence
+
+        :returns: an (N, 2) numpy array of (u, v) for each of the N times
+        '''
+        vel_rec = self.cy_obj.get_time_value(time_utils.times_to_sec(times))
+
+        return np.column_stack((vel_rec['u'], vel_rec['v']))
+
     def to_serialize(self, json_='webapi'):
         toserial = super(Tide, self).to_serialize(json_)
 
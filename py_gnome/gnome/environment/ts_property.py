@@ -1,7 +1,8 @@
 import warnings
 import copy
 
-import netCDF4 as nc4
+from gnome.utilities.lazy_import import lazy_module
+nc4 = lazy_module('netCDF4')
 import numpy as np
 
 from gnome.environment.property import EnvProp, VectorProp, Time
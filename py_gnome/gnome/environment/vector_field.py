@@ -1,6 +1,7 @@
 import warnings
 
-import netCDF4 as nc4
+from gnome.utilities.lazy_import import lazy_module
+nc4 = lazy_module('netCDF4')
 import numpy as np
 
 from gnome.utilities.geometry.cy_point_in_polygon import points_in_polys
@@ -10,6 +11,7 @@ from colander import SchemaNode, Float, MappingSchema, drop, String, OneOf
 from gnome.persist.base_schema import ObjType
 from gnome.utilities import serializable
 from gnome.movers import ProcessSchema
+from gnome.environment.grid_locator import interpolate_var_to_points
 
 import pyugrid
 import pysgrid
@@ -184,15 +186,12 @@ class VectorField(object):
     def triangles(self):
         return self.grid.nodes[self.grid.faces]
 
-    def interpolated_velocities(self, time, points):
+    def node_velocities(self, time):
         """
-        Returns the velocities at each of the points at the specified time, using interpolation
-        on the nodes of the triangle that the point is in.
-        :param time: The time in the simulation
-        :param points: a numpy array of points that you want to find interpolated velocities for
-        :return: interpolated velocities at the specified points
+        The velocities on the nodes at time, interpolated between the time
+        slices of the data.
+        :return: (u, v) arrays of a velocity for each node
         """
-
         t_alphas = self.time.interp_alpha(time)
         t_index = self.time.indexof(time)
 
@@ -203,8 +202,21 @@ class VectorField(object):
         v1 = self.v[t_index+1]
         vt = v0 + (v1 - v0) * t_alphas
 
-        u_vels = self.grid.interpolate_var_to_points(points, ut)
-        v_vels = self.grid.interpolate_var_to_points(points, vt)
+        return ut, vt
+
+    def interpolated_velocities(self, time, points):
+        """
+        Returns the velocities at each of the points at the specified time, using interpolation
+        on the nodes of the triangle that the point is in.
+        :param time: The time in the simulation
+        :param points: a numpy array of points that you want to find interpolated velocities for
+        :return: interpolated velocities at the specified points
+        """
+
+        ut, vt = self.node_velocities(time)
+
+        u_vels = interpolate_var_to_points(self.grid, points, ut)
+        v_vels = interpolate_var_to_points(self.grid, points, vt)
 
         vels = np.ma.column_stack((u_vels, v_vels))
         return vels
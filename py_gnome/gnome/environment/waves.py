@@ -14,6 +14,8 @@ from __future__ import division
 
 import copy
 
+import numpy as np
+
 from gnome import constants
 from gnome.utilities import serializable
 from gnome.utilities.serializable import Field
@@ -22,7 +24,7 @@ from gnome.utilities.weathering import Adios2, LehrSimecek, PiersonMoskowitz
 from gnome.persist import base_schema
 from gnome.exceptions import ReferencedObjectNotSet
 
-from .environment import Environment
+from .environment import Environment, StepCache
 from .environment import WaterSchema
 
 from wind import WindSchema
@@ -40,8 +42,11 @@ class Waves(Environment, serializable.Serializable):
     """
     class to compute the wave height for a time series
 
-    At the moment, it only does a single point, non spatially
-    variable, but may be extended in the future
+    With a Wind it only does a single point, non spatially variable; with
+    a gridded wind get_values_at() varies with the wind's cells.
+
+    The values of the step being run are computed once and kept for all the
+    weatherers that ask for them: see StepCache.
     """
     _ref_as = 'waves'
     _state = copy.deepcopy(Environment._state)
@@ -70,6 +75,7 @@ class Waves(Environment, serializable.Serializable):
 
         self.wind = wind
         self.water = water
+        self._step_cache = StepCache()
 
         # turn off make_default_refs if references are defined and
         # make_default_refs is False
@@ -109,6 +115,10 @@ class Waves(Environment, serializable.Serializable):
           whitecap_fraction: unit-less fraction
           dissipation_energy: not sure!! # fixme!
         """
+        return self._step_cache.get('value', time,
+                                    lambda: self._compute_value(time))
+
+    def _compute_value(self, time):
         # make sure are we are up to date with water object
         wave_height = self.water.wave_height
 
@@ -125,6 +135,100 @@ class Waves(Environment, serializable.Serializable):
 
         return H, T, Wf, De
 
+    def get_values(self, times):
+        """
+        get_value() for each of the times, the wind for all of them from one
+        Wind.get_values() call
+
+        :param times: the times you want the wave data for
+        :type times: datetime objects, numpy.datetime64 or seconds since the
+            epoch (see Wind.get_values)
+
+        :returns: wave_height, peak_period, whitecap_fraction,
+                  dissipation_energy -- each an array of one value per time
+        """
+        if self.water.wave_height is None:
+            U = self.wind.get_values(times)[:, 0]  # only need velocity
+        else:
+            U = np.zeros((len(np.asarray(times).reshape(-1)),))
+
+        return self._values_from_wind(U)
+
+    def get_values_at(self, points, time):
+        """
+        get_value() at each of the points, for a gridded wind (one with a
+        grid and an at() method, like GridWind). The wave field varies with
+        the wind's cells: the values of a cell are computed once for the
+        step being run, from the wind at the mean position of the points in
+        it the first time it is asked for. With a Wind they are the same
+        everywhere.
+
+        :param points: Nx2 or Nx3 array of the (lon, lat[, z]) positions
+        :param time: the time you want the wave data for
+        :type time: datetime.datetime object
+
+        :returns: wave_height, peak_period, whitecap_fraction,
+                  dissipation_energy -- each an array of one value per point
+        """
+        points = np.asarray(points, dtype=np.float64)
+        points = points.reshape(-1, points.shape[-1])[:, :2]
+
+        if not hasattr(self.wind, 'grid'):
+            return tuple(np.full((len(points),), v, dtype=np.float64)
+                         for v in self.get_value(time))
+
+        cells, idx = np.unique(self._wind_cells(points), return_inverse=True)
+        counts = np.bincount(idx)
+        centers = np.column_stack([np.bincount(idx, weights=points[:, i]) /
+                                   counts for i in range(2)])
+        cell_idx = dict((c, i) for i, c in enumerate(cells))
+
+        def compute(missing):
+            where = [cell_idx[c] for _k, c in missing]
+            if self.water.wave_height is None:
+                uv = np.asarray(self.wind.at(centers[where], time,
+                                             units='m/s'))
+                U = np.sqrt(uv[:, 0] ** 2 + uv[:, 1] ** 2)
+            else:
+                U = np.zeros((len(where),))
+
+            return zip(*self._values_from_wind(U))
+
+        values = self._step_cache.get_many([('cell', c) for c in cells],
+                                           time, compute)
+        values = np.array(values, dtype=np.float64).reshape(-1, 4)[idx]
+
+        return tuple(values.T)
+
+    def _wind_cells(self, points):
+        'the index of the cell of the gridded wind of each of the points'
+        cells = np.asarray(self.wind.grid.locate_faces(points))
+        if cells.ndim == 2:
+            # (i, j) of a structured grid
+            cells = cells[:, 0].astype(np.int64) * (1 << 32) + cells[:, 1]
+
+        return cells.astype(np.int64).reshape(-1)
+
+    def _values_from_wind(self, U):
+        '''
+        the wave_height, peak_period, whitecap_fraction, dissipation_energy
+        arrays of the wind speeds U, or of the specified wave height
+        '''
+        wave_height = self.water.wave_height
+
+        if wave_height is None:
+            H = self.compute_H(U)
+        else:  # user specified a wave height
+            H = np.full(U.shape, wave_height, dtype=np.float64)
+            U = self.pseudo_wind(H)
+        Wf = self.whitecap_fraction(U)
+        T = self.mean_wave_period(U)
+
+        De = self.dissipative_wave_energy(H)
+
+        return (np.asarray(H), np.broadcast_to(T, H.shape), np.asarray(Wf),
+                np.asarray(De))
+
     def get_emulsification_wind(self, time):
         """
         Return the right wind for the wave climate
@@ -142,6 +246,11 @@ class Waves(Environment, serializable.Serializable):
         fixme: I'm not sure this is right -- if we stick with the wave energy
                given by the user for dispersion, why not for emulsification?
         """
+        return self._step_cache.get(
+            'emulsification_wind', time,
+            lambda: self._compute_emulsification_wind(time))
+
+    def _compute_emulsification_wind(self, time):
         wave_height = self.water.wave_height
         U = self.wind.get_value(time)[0]  # only need velocity
         if wave_height is None:
@@ -215,3 +324,12 @@ class Waves(Environment, serializable.Serializable):
         if self.water is None:
             msg = "water object not defined for " + self.__class__.__name__
             raise ReferencedObjectNotSet(msg)
+
+        self._step_cache.reset()
+
+    def prepare_for_model_step(self, model_time):
+        '''
+        the values of the step are kept from now on, the ones of the step
+        before are forgotten
+        '''
+        self._step_cache.reset(model_time)
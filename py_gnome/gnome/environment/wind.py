@@ -7,7 +7,6 @@ import datetime
 import os
 import copy
 import StringIO
-import zipfile
 
 import numpy as np
 
@@ -17,7 +16,8 @@ import unit_conversion as uc
 
 from gnome import basic_types
 
-from gnome.utilities import serializable
+from gnome.utilities import serializable, time_utils, transforms
+from gnome.utilities.convert import tsformat
 
 from gnome.utilities.distributions import RayleighDistribution as rayleigh
 
@@ -25,9 +25,11 @@ from gnome.persist.extend_colander import (DefaultTupleSchema,
                                            LocalDateTime,
                                            DatetimeValue2dArraySchema)
 from gnome.persist import validators, base_schema
+from gnome.persist.save_load import is_savezip
 
 from .environment import Environment
 from gnome.utilities.timeseries import Timeseries
+from gnome.utilities.setup_profile import setup_stage
 from gnome.cy_gnome.cy_ossm_time import ossm_wind_units
 from .. import _valid_units
 
@@ -134,6 +136,9 @@ class Wind(serializable.Serializable, Timeseries, Environment):
                       ])
     _state['name'].test_for_eq = False
 
+    # the timeseries is serialized in the units
+    _dependent_fields = {'units': ('timeseries',)}
+
     # list of valid velocity units for timeseries
     valid_vel_units = _valid_units('Velocity')
 
@@ -158,7 +163,8 @@ class Wind(serializable.Serializable, Timeseries, Environment):
 
         if filename is not None:
             self.source_type = kwargs.pop('source_type', 'file')
-            super(Wind, self).__init__(filename=filename, format=format)
+            with setup_stage(self, 'read', {'time_values': False}):
+                super(Wind, self).__init__(filename=filename, format=format)
             self.name = kwargs.pop('name', os.path.split(self.filename)[1])
             # set _user_units attribute to match user_units read from file.
             self._user_units = self.ossm.user_units
@@ -272,7 +278,7 @@ class Wind(serializable.Serializable, Timeseries, Environment):
         name = (name, 'Wind.json')[name is None]
         ts_name = os.path.splitext(name)[0] + '_data.WND'
 
-        if zipfile.is_zipfile(saveloc):
+        if is_savezip(saveloc):
             self._write_timeseries_to_zip(saveloc, ts_name)
             self._filename = ts_name
         else:
@@ -408,6 +414,7 @@ class Wind(serializable.Serializable, Timeseries, Environment):
                                                      'meter per second')
 
             super(Wind, self).set_timeseries(wind_data, format)
+            self._mark_changed('timeseries')
         else:
             raise ValueError('Bad timeseries as input')
 
@@ -422,10 +429,35 @@ class Wind(serializable.Serializable, Timeseries, Environment):
         :param time: the time(s) you want the data for
         :type time: datetime object or sequence of datetime objects.
 
-        .. note:: It invokes get_wind_data(..) function
+        .. note:: It invokes get_values(..) function
+        '''
+        return tuple(self.get_values(time)[0])
+
+    def get_values(self, times, units='m/s', format='r-theta'):
         '''
-        data = self.get_wind_data(time, 'm/s', 'r-theta')
-        return tuple(data[0]['value'])
+        The wind at each of the times, in one call to the C++ object for all
+        of them -- for running averages, wave computations and time series
+        plots.
+
+        :param times: the times you want the data for
+        :type times: datetime objects, numpy.datetime64 or seconds since the
+            epoch (int64, see time_utils.date_to_sec) -- a scalar or
+            a sequence
+        :param units: outputs data in these units
+        :param format: output format: either 'r-theta' or 'uv'
+
+        :returns: an (N, 2) numpy array of (speed, direction) or (u, v) for
+                  each of the N times
+        '''
+        vel_rec = self.ossm.get_time_value(time_utils.times_to_sec(times))
+        values = np.column_stack((vel_rec['u'], vel_rec['v']))
+
+        ts_format = tsformat(format)
+        if ts_format == basic_types.ts_format.magnitude_direction:
+            values = transforms.uv_to_r_theta_wind(values)
+
+        return self._convert_units(values, ts_format,
+                                   'meter per second', units)
 
     def set_speed_uncertainty(self, up_or_down=None):
         '''
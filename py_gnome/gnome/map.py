@@ -18,9 +18,13 @@ Features:
 import copy
 import os
 import math
+import hashlib
+import tempfile
+import cPickle
 from osgeo import ogr
 
-import py_gd
+from gnome.utilities.lazy_import import lazy_module
+py_gd = lazy_module('py_gd')
 from osgeo import ogr
 #import pyugrid
 
@@ -34,22 +38,33 @@ import unit_conversion as uc
 
 from gnome import _valid_units
 from gnome.basic_types import oil_status, world_point_type
+from gnome.utilities.setup_profile import SetupStage
 
 from gnome.utilities.projections import (FlatEarthProjection,
                                          RectangularGridProjection,
                                          RegularGridProjection)
 from gnome.utilities.map_canvas import MapCanvas
+from gnome.utilities import time_utils
 from gnome.utilities.serializable import Serializable, Field
 from gnome.utilities.file_tools import haz_files
+from gnome.utilities.packed_bitmap import PackedBitmap
 from gnome.utilities.file_tools.osgeo_helpers import (ogr_layers)
 from gnome.utilities.file_tools.osgeo_helpers import (ogr_features)
 from gnome.utilities.file_tools.osgeo_helpers import (ogr_open_file)
 
 from gnome.utilities.geometry.polygons import PolygonSet
 from gnome.utilities.geometry.cy_point_in_polygon import (points_in_poly,
-                                                          point_in_poly)
+                                                          point_in_poly,
+                                                          PolygonIndex)
 
-from gnome.cy_gnome.cy_land_check import check_land_layers, move_particles
+from gnome.cy_gnome.cy_land_check import (check_land_layers_batch,
+                                          distance_field,
+                                          land_count_table,
+                                          tile_occupancy,
+                                          move_particles,
+                                          status_totals,
+                                          refloat_batch,
+                                          pixels_on_land)
 
 
 import gnome.map
@@ -144,6 +159,57 @@ class GnomeMap(Serializable):
         else:
             self.land_polys = land_polys
 
+    def polygon_index(self, name):
+        """
+        The PolygonIndex of one of the PolygonSets of the map --
+        'spillable_area' or 'land_polys'
+
+        It is built the first time it is asked for, and again when the
+        polygons have been replaced or added to.
+        """
+        polys = getattr(self, name)
+        key = (id(polys), getattr(polys, 'total_num_points', None))
+
+        indexes = self.__dict__.setdefault('_polygon_indexes', {})
+        if name not in indexes or indexes[name][0] != key:
+            indexes[name] = (key, PolygonIndex(polys))
+
+        return indexes[name][1]
+
+    def in_land_polys(self, coords):
+        """
+        :param coords: locations for test.
+        :type coords: 3-tuple of floats: (long, lat, depth) or an Nx3 array
+
+        :returns: bool array: True where the location is in one of the land
+                  polygons, and not in a lake drawn over it -- the vector
+                  version of what the raster of a MapFromBNA holds. A single
+                  location gives a python bool.
+
+        The points are found with polygon_index('land_polys'), so the cost
+        grows with the edges near each point rather than with all of them.
+        """
+        located = self.polygon_index('land_polys').locate(coords)
+        lakes = np.array([self._is_lake(m)
+                          for m in getattr(self.land_polys, '_MetaDataList',
+                                           [])] + [False], dtype=np.bool)
+
+        # -1 (in no polygon) picks the trailing False
+        in_land = np.logical_and(located >= 0, np.logical_not(lakes[located]))
+
+        if np.ndim(located) == 0:
+            return bool(in_land)
+        else:
+            return in_land
+
+    @staticmethod
+    def _is_lake(metadata):
+        # fixme -- like MapFromBNA, this should be something like "lake"
+        try:
+            return metadata[2] == '2'
+        except (IndexError, KeyError, TypeError):
+            return False
+
     def get_polygons(self):
         polys = {}
         polys['spillable_area'] = self.spillable_area
@@ -260,11 +326,50 @@ class GnomeMap(Serializable):
         .. note:: it could be either off the map, or in a location that
                   spills aren't allowed
         """
-        for poly in self.spillable_area:
-            if points_in_poly(poly.points, coord):
-                return True
+        return self.polygon_index('spillable_area').contains(coord)
 
-        return False
+    @staticmethod
+    def _batch_coords(coords):
+        """
+        the coords of the batch methods as an Nx3 array of float64
+        """
+        coords = np.atleast_2d(np.asarray(coords, dtype=np.float64))
+        if coords.shape[1] == 2:
+            coords = np.c_[coords, np.zeros((len(coords),))]
+
+        return np.ascontiguousarray(coords[:, :3])
+
+    def on_land_batch(self, coords):
+        """
+        on_land() of each of the coords, an Nx3 or Nx2 array
+
+        :returns: bool array
+        """
+        return np.zeros((len(self._batch_coords(coords)),), dtype=bool)
+
+    def in_water_batch(self, coords):
+        """
+        in_water() of each of the coords: on the map and not on land
+
+        :returns: bool array
+        """
+        coords = self._batch_coords(coords)
+
+        return (np.atleast_1d(self.on_map(coords)) &
+                ~self.on_land_batch(coords))
+
+    def allowable_spill_batch(self, coords):
+        """
+        allowable_spill_position() of each of the coords -- the start
+        positions of a big release, say -- with the points found in the
+        spillable area's PolygonIndex on threads
+
+        :returns: bool array
+        """
+        coords = self._batch_coords(coords)
+
+        return np.atleast_1d(self.polygon_index('spillable_area')
+                             .contains(coords))
 
     def _set_off_map_status(self, spill):
         """
@@ -337,6 +442,84 @@ class GnomeMap(Serializable):
         np.maximum(next_positions[:, 2], 0.0, out=next_positions[:, 2])
         return None
 
+    def _update_mass_balance(self, sc, num_beached=0):
+        """
+        Puts the mass on land and off the maps in the mass balance, and the
+        numbers of LEs of the step in sc.beaching_counts
+
+        :param num_beached: the LEs that beached in this step
+        """
+        (num_on_land, mass_on_land,
+         num_off_maps, mass_off_maps) = status_totals(sc['status_codes'],
+                                                      sc['mass'])
+
+        # todo: need a prepare_for_model_run() so map adds these keys to
+        #     mass_balance as opposed to SpillContainer
+        sc.mass_balance['beached'] = mass_on_land
+        sc.mass_balance['off_maps'] += mass_off_maps
+
+        sc.beaching_counts['beached'] = num_beached
+        sc.beaching_counts['on_land'] = num_on_land
+        sc.beaching_counts['off_maps'] = num_off_maps
+
+    # (half-life, time step, probability) of the last _refloat_probability()
+    _refloat_probability_cache = (None, None, 1.0)
+
+    def _refloat_probability(self, time_step):
+        """
+        the probability that an LE on land refloats in time_step, 1 with a
+        half-life of 0. Worked out again only when the half-life or the
+        time step change.
+        """
+        halflife, step, probability = self._refloat_probability_cache
+
+        if halflife != self._refloat_halflife or step != time_step:
+            probability = 1.0
+            if self._refloat_halflife > 0.0:
+                probability = 1.0 - 0.5 ** (float(time_step) /
+                                            self._refloat_halflife)
+
+            self._refloat_probability_cache = (self._refloat_halflife,
+                                               time_step, probability)
+
+        return probability
+
+    def _refloat_on_land(self, spill_container, time_step):
+        """
+        refloat_elements for the maps with land: each LE on land refloats
+        with the probability of the refloat half-life over the time step,
+        all of them with a half-life of 0 and none with a negative one. They
+        go back to their last water position.
+
+        The draws are the counter based ones of the LEs' 'id', the step and
+        the spill container, made in refloat_batch. The LEs are refloated
+        before the movers move them, so the ones beached in this step only
+        get their chance in the next one.
+        """
+        num_on_land = status_totals(spill_container['status_codes'])[0]
+        spill_container.beaching_counts['refloated'] = 0
+
+        if num_on_land == 0 or self._refloat_halflife < 0.0:
+            return
+
+        spill_container.beaching_counts['refloated'] = \
+            refloat_batch(spill_container['status_codes'],
+                          spill_container['positions'],
+                          spill_container['last_water_positions'],
+                          None, self._refloat_probability(time_step),
+                          spill_container['id'],
+                          self._refloat_step(spill_container),
+                          int(spill_container.uncertain))
+
+    def _refloat_step(self, spill_container):
+        """
+        the step of the key of the refloat draws
+        """
+        if spill_container.current_time_stamp is None:
+            return 0
+
+        return time_utils.date_to_sec(spill_container.current_time_stamp)
+
 
 class ParamMap(GnomeMap):
     _state = copy.deepcopy(GnomeMap._state)
@@ -515,6 +698,21 @@ class ParamMap(GnomeMap):
                    'that this map was built with')
             return False
 
+    def on_land_batch(self, coords):
+        coords = self._batch_coords(coords)
+
+        return (np.atleast_1d(self.on_map(coords)) &
+                np.atleast_1d(points_in_poly(self.land_points, coords)))
+
+    def allowable_spill_batch(self, coords):
+        """
+        only the center is allowable, as in allowable_spill_position()
+        """
+        coords = self._batch_coords(coords)
+        center = np.asarray(self.center, dtype=np.float64)
+
+        return np.all(coords[:, :len(center)] == center, axis=1)
+
     def _set_off_map_status(self, spill):
         """
         Determines which LEs moved off the map
@@ -557,18 +755,12 @@ class ParamMap(GnomeMap):
 
         # beached = 1xN numpy array of bool, elem is true if on water
         # and next pos is on land
-        move_particles(start_pos, next_pos, status_codes,
-                       last_water_positions, self.land_points)
+        num_beached = move_particles(start_pos, next_pos, status_codes,
+                                     last_water_positions, self.land_points)
 
         self._set_off_map_status(sc)
 
-        # todo: need a prepare_for_model_run() so map adds these keys to
-        #     mass_balance as opposed to SpillContainer
-        # update 'off_maps'/'beached' in mass_balance
-        sc.mass_balance['beached'] = \
-            sc['mass'][sc['status_codes'] == oil_status.on_land].sum()
-        sc.mass_balance['off_maps'] += \
-            sc['mass'][sc['status_codes'] == oil_status.off_maps].sum()
+        self._update_mass_balance(sc, num_beached)
 
     def refloat_elements(self, spill_container, time_step):
         """
@@ -578,34 +770,7 @@ class ParamMap(GnomeMap):
         :param spill_container: the current spill container
         :type spill_container:  :class:`gnome.spill_container.SpillContainer`
         """
-        r_idx = np.where(spill_container['status_codes'] ==
-                         oil_status.on_land)[0]
-
-        if r_idx.size == 0:  # no particles on land
-            return
-
-        if self._refloat_halflife > 0.0:
-            # if 0.0, then r_idx is all of them -- they will all refloat.
-            # refloat particles based on probability
-            refloat_probability = 1.0 - 0.5 ** (float(time_step) /
-                                                self._refloat_halflife)
-            rnd = np.random.uniform(0, 1, len(r_idx))
-
-            # subset of indices that will refloat
-            # maybe we should rename refloat_probability since
-            # rnd <= refloat_probability to
-            # refloat, maybe call it stay_on_land_probability
-            r_idx = r_idx[np.where(rnd <= refloat_probability)[0]]
-        elif self._refloat_halflife < 0.0:
-            # fake for nothing gets refloated.
-            r_idx = np.array((), np.bool)
-
-        if r_idx.size > 0:
-            # check is not required, but why do this operation if no particles
-            # need to be refloated
-            spill_container['positions'][r_idx] = \
-                spill_container['last_water_positions'][r_idx]
-            spill_container['status_codes'][r_idx] = oil_status.in_water
+        self._refloat_on_land(spill_container, time_step)
 
     def update_from_dict(self, data):
         if ('center' in data.keys() or
@@ -688,6 +853,22 @@ class RasterMap(GnomeMap):
         :param spillable_area: The polygon bounding the spillable_area
         :type spillable_area: (N,2) numpy array of floats
 
+        :param packed_bitmap: keep the land-water raster one bit per pixel
+                              (see pack_bitmap)
+        :type packed_bitmap: bool, default False
+
+        :param distance_field: compute the distance from each pixel to the
+                               shore once, so the land check can skip the
+                               elements that can't reach it this step. It
+                               takes a byte per pixel.
+        :type distance_field: bool, default False
+
+        :param pyramid: the (layers[:-1], land_counts, tiles) that
+                        build_coarser_bitmaps() made of this bitmap before,
+                        so they aren't built again -- see MapFromBNA's
+                        cache_dir
+        :type pyramid: tuple, default None
+
         :param id: unique ID of the object. Using UUID as a string.
                    This is only used when loading object from save file.
 
@@ -695,6 +876,9 @@ class RasterMap(GnomeMap):
         """
         refloat_halflife = kwargs.pop('refloat_halflife', 1)
         self._refloat_halflife = refloat_halflife * self.seconds_in_hour
+        packed_bitmap = kwargs.pop('packed_bitmap', False)
+        use_distance_field = kwargs.pop('distance_field', False)
+        pyramid = kwargs.pop('pyramid', None)
 
         self.basebitmap = np.ascontiguousarray(bitmap_array)
 
@@ -705,7 +889,20 @@ class RasterMap(GnomeMap):
         else:
             self.ratios = np.array((16, 1,), dtype=np.int32)
 
-        self.build_coarser_bitmaps()
+        if pyramid is None:
+            self.build_coarser_bitmaps()
+        else:
+            layers, self.land_counts, self.tiles = pyramid
+            self.layers = list(layers) + [self.basebitmap]
+
+        if packed_bitmap:
+            self.pack_bitmap()
+
+        # the signed distance to the shore of each pixel, see
+        # cy_land_check.distance_field
+        self.distance = (distance_field(self.basebitmap)
+                         if use_distance_field else None)
+
         self.projection = projection
 
         GnomeMap.__init__(self, **kwargs)
@@ -738,6 +935,13 @@ class RasterMap(GnomeMap):
         base_h = self.basebitmap.shape[1]
 
         for ratio in self.ratios[:-1]:
+            if isinstance(self.basebitmap, PackedBitmap):
+                # a coarse pixel is land if any of its pixels are
+                genned_layer = (tile_occupancy(self.basebitmap, ratio) !=
+                                0).astype(np.uint8)
+                self.layers.append(genned_layer)
+                continue
+
             genned_layer = np.zeros((int(math.ceil(float(base_w) / ratio)),
                                      int(math.ceil(float(base_h) / ratio))),
                                     dtype=np.uint8, order='C')
@@ -750,8 +954,40 @@ class RasterMap(GnomeMap):
 
             self.layers.append(genned_layer)
 
+        # a list, not an array: the base layer may be a PackedBitmap
         self.layers.append(self.basebitmap)
-        self.layers = np.array(self.layers)
+
+        # lets the land check skip the moves with no land near them
+        self.land_counts = land_count_table(self.layers[0])
+
+        # the all water, all land and mixed tiles of each layer under the
+        # coarsest one, a tile per pixel of the layer above: the land check
+        # only reads the pixels of the mixed tiles
+        self.tiles = [tile_occupancy(self.layers[i + 1],
+                                     self.ratios[i] // self.ratios[i + 1])
+                      for i in range(len(self.ratios) - 1)]
+
+    def pack_bitmap(self):
+        '''
+        Replaces the uint8 base raster with a PackedBitmap of its land
+        pixels, an eighth of the size. The land check reads the bits in
+        place and gives the same results; the coarser layers stay uint8.
+        '''
+        if not isinstance(self.basebitmap, PackedBitmap):
+            self.basebitmap = PackedBitmap.pack(self.basebitmap,
+                                                self.land_flag)
+            self.layers[-1] = self.basebitmap
+
+    def share_bitmap(self, filename=None):
+        '''
+        Packs the base raster and moves its bits to shared memory, so the
+        worker processes of a multiprocessing run, like the
+        ModelBroadcaster's, share one copy of it: forked workers without a
+        filename, and workers that get the model by pickle with one -- see
+        PackedBitmap.share()
+        '''
+        self.pack_bitmap()
+        self.basebitmap.share(filename)
 
     @property
     def refloat_halflife(self):
@@ -767,10 +1003,10 @@ class RasterMap(GnomeMap):
 
         :param filename: the name of the file to save to.
         '''
-        bitmap = self.basebitmap.copy()
+        bitmap = np.array(self.basebitmap)
 
         # change anything not zero to 255 - to get black and white
-        np.putmask(bitmap, self.basebitmap > 0, 2)
+        np.putmask(bitmap, bitmap > 0, 2)
 
         im = py_gd.from_array(bitmap)
         print im.get_color_index('white')
@@ -901,9 +1137,10 @@ class RasterMap(GnomeMap):
         # call the actual hit code:
         # the status_code and last_water_point arrays are altered in-place
         # only check the ones that aren't already beached?
-        self._check_land_layers(self.layers, self.ratios,
-                                start_pos_pixel, next_pos_pixel,
-                                status_codes, last_water_pos_pixel)
+        num_beached = self._check_land_layers(self.layers, self.ratios,
+                                              start_pos_pixel, next_pos_pixel,
+                                              status_codes,
+                                              last_water_pos_pixel)
 
         # transform the points back to lat-long.
         beached = status_codes == oil_status.on_land
@@ -914,13 +1151,7 @@ class RasterMap(GnomeMap):
 
         self._set_off_map_status(sc)
 
-        # todo: need a prepare_for_model_run() so map adds these keys to
-        #     mass_balance as opposed to SpillContainer
-        # update 'off_maps'/'beached' in mass_balance
-        sc.mass_balance['beached'] = \
-            sc['mass'][sc['status_codes'] == oil_status.on_land].sum()
-        sc.mass_balance['off_maps'] += \
-            sc['mass'][sc['status_codes'] == oil_status.off_maps].sum()
+        self._update_mass_balance(sc, num_beached)
 
     def refloat_elements(self, spill_container, time_step):
         """
@@ -930,37 +1161,7 @@ class RasterMap(GnomeMap):
         :param spill_container: the current spill container
         :type spill_container:  :class:`gnome.spill_container.SpillContainer`
         """
-        # index into array of particles on_land
-
-        r_idx = np.where(spill_container['status_codes'] ==
-                         oil_status.on_land)[0]
-
-        if r_idx.size == 0:  # no particles on land
-            return
-
-        if self._refloat_halflife > 0.0:
-            # if 0.0, then r_idx is all of them -- they will all refloat.
-            # refloat particles based on probability
-
-            refloat_probability = 1.0 - 0.5 ** (float(time_step) /
-                                                self._refloat_halflife)
-            rnd = np.random.uniform(0, 1, len(r_idx))
-
-            # subset of indices that will refloat
-            # maybe we should rename refloat_probability since
-            # rnd <= refloat_probability to
-            # refloat, maybe call it stay_on_land_probability
-            r_idx = r_idx[np.where(rnd <= refloat_probability)[0]]
-        elif self._refloat_halflife < 0.0:
-            # fake for nothing gets refloated.
-            r_idx = np.array((), np.bool)
-
-        if r_idx.size > 0:
-            # check is not required, but why do this operation if no particles
-            # need to be refloated
-            spill_container['positions'][r_idx] = \
-                spill_container['last_water_positions'][r_idx]
-            spill_container['status_codes'][r_idx] = oil_status.in_water
+        self._refloat_on_land(spill_container, time_step)
 
     def _check_land_layers(self, raster_map_layers, ratios,
                            positions, end_positions,
@@ -968,14 +1169,16 @@ class RasterMap(GnomeMap):
         """
         Do the actual land-checking.
         This method simply calls a Cython version:
-            gnome.cy_gnome.cy_land_check.check_land()
+            gnome.cy_gnome.cy_land_check.check_land_layers_batch()
 
         The arguments 'status_codes', 'positions' and 'last_water_positions'
-        are altered in place.
+        are altered in place. Returns the number of LEs that beached.
         """
-        check_land_layers(raster_map_layers, ratios,
-                          positions, end_positions,
-                          status_codes, last_water_positions)
+        return check_land_layers_batch(raster_map_layers, ratios,
+                                positions, end_positions,
+                                status_codes, last_water_positions,
+                                self.land_counts, self.tiles,
+                                self.distance)
 
     def allowable_spill_position(self, coord):
         """
@@ -998,6 +1201,30 @@ class RasterMap(GnomeMap):
         else:
             return False
 
+    def on_land_batch(self, coords):
+        """
+        on_land() of each of the coords, the pixels read on threads
+        """
+        coords = self._batch_coords(coords)
+
+        pixels = self.projection.to_pixel(coords, asint=True)
+
+        return pixels_on_land(self.basebitmap,
+                              np.ascontiguousarray(pixels, dtype=np.int32))
+
+    def allowable_spill_batch(self, coords):
+        """
+        allowable_spill_position() of each of the coords
+        """
+        coords = self._batch_coords(coords)
+        allowable = self.in_water_batch(coords)
+
+        if self.spillable_area is not None and np.any(allowable):
+            allowable[allowable] = (super(RasterMap, self)
+                                    .allowable_spill_batch(coords[allowable]))
+
+        return allowable
+
     def to_pixel_array(self, coords):
         """
         Projects an array of (lon, lat) tuples onto the basebitmap,
@@ -1023,6 +1250,12 @@ class MapFromBNA(RasterMap):
                            test_for_eq=False))
     _schema = MapFromBNASchema
 
+    # the directory of the cache of the land polygons and raster drawn of
+    # each BNA file, None for no cache. The cache files are named by the
+    # contents of the BNA file, so a changed file is read again.
+    cache_dir = None
+    _cache_version = 1
+
     def __init__(self, filename, raster_size=4096 * 4096, **kwargs):
         """
         Creates a GnomeMap (specifically a RasterMap) from a data file.
@@ -1047,18 +1280,88 @@ class MapFromBNA(RasterMap):
 
         :param spillable_area: The polygon bounding the spillable_area
 
+        :param cache_dir: the directory to cache the polygons and raster in,
+                          so the next map of the same file and raster_size
+                          skips reading and drawing them. Defaults to the
+                          class attribute cache_dir.
+
         :param id: unique ID of the object. Using UUID as a string.
                    This is only used when loading object from save file.
         :type id: string
         """
         self.filename = filename
 
+        self.name = kwargs.pop('name', os.path.split(filename)[1])
+
+        setup_stage = SetupStage('read_bna')
+        cache_dir = kwargs.pop('cache_dir', self.cache_dir)
+        cache_file = (self._cache_file(filename, raster_size, cache_dir)
+                      if cache_dir is not None else None)
+        cached = self._load_cache(cache_file)
+
+        if cached is None:
+            (land_polys,
+             file_spillable_area,
+             file_map_bounds) = self._read_polygons(filename)
+            bitmap_array = projection = pyramid = None
+        else:
+            (land_polys, file_spillable_area, file_map_bounds,
+             bitmap_array, projection, pyramid) = cached
+
+        BB = land_polys.bounding_box
+
+        # create spillable area and  bounds if they weren't in the BNA
+
+        spillable_area = kwargs.pop('spillable_area', file_spillable_area)
+        map_bounds = kwargs.pop('map_bounds', file_map_bounds)
+
+        if map_bounds is None:
+            map_bounds = BB.AsPoly()
+
+        if len(spillable_area) == 0:
+            # a new set: the file's one may go to the cache
+            spillable_area = PolygonSet()
+            spillable_area.append(map_bounds)
+
+        # user defined spillable_area, map_bounds overrides data obtained
+        # from polygons
+
+        # todo: should there be a check between spillable_area read from BNA
+        # versus what the user entered. if this is within spillable_area for
+        # BNA, then include it? else ignore
+
+        if bitmap_array is None:
+            bitmap_array, projection = self._draw_land(land_polys,
+                                                       raster_size)
+
+        RasterMap.__init__(self, bitmap_array, projection,
+                           map_bounds=map_bounds,
+                           spillable_area=spillable_area,
+                           land_polys=land_polys,
+                           pyramid=pyramid,
+                           **kwargs)
+
+        if cache_file is not None and cached is None:
+            self._save_cache(cache_file,
+                             (land_polys, file_spillable_area,
+                              file_map_bounds, bitmap_array, projection,
+                              (self.layers[:-1], self.land_counts,
+                               self.tiles)))
+
+        setup_stage.done(self, {'bna_map': cached is not None})
+
+        return None
+
+    @staticmethod
+    def _read_polygons(filename):
+        """
+        the land polygons, spillable area and map bounds (None if not
+        there) of a BNA file
+        """
         # fixme: do some file type checking here.
         polygons = haz_files.ReadBNA(filename, 'PolygonSet')
         map_bounds = None
 
-        self.name = kwargs.pop('name', os.path.split(filename)[1])
-
         # find the spillable area and map bounds:
         # and create a new polygonset without them
         #  fixme -- adding a "pop" method to PolygonSet might be better
@@ -1076,29 +1379,18 @@ class MapFromBNA(RasterMap):
             else:
                 land_polys.append(p)
 
+        return land_polys, spillable_area, map_bounds
+
+    @staticmethod
+    def _draw_land(land_polys, raster_size):
+        """
+        the land-water raster of the land polygons, and its projection
+        """
         # now draw the raster map with a map_canvas:
         # determine the size:
 
         BB = land_polys.bounding_box
 
-        # create spillable area and  bounds if they weren't in the BNA
-
-        spillable_area = kwargs.pop('spillable_area', spillable_area)
-        map_bounds = kwargs.pop('map_bounds', map_bounds)
-
-        if map_bounds is None:
-            map_bounds = BB.AsPoly()
-
-        if len(spillable_area) == 0:
-            spillable_area.append(map_bounds)
-
-        # user defined spillable_area, map_bounds overrides data obtained
-        # from polygons
-
-        # todo: should there be a check between spillable_area read from BNA
-        # versus what the user entered. if this is within spillable_area for
-        # BNA, then include it? else ignore
-
         # stretch the bounding box, to get approximate aspect ratio in
         # projected coords.
         aspect_ratio = (np.cos(BB.Center[1] * np.pi / 180) *
@@ -1139,14 +1431,62 @@ class MapFromBNA(RasterMap):
         # canvas.save_background("raster_map_test.png")
 
         # get the basebitmap as a numpy array:
-        bitmap_array = canvas.back_asarray()
+        return canvas.back_asarray(), canvas.projection
 
-        RasterMap.__init__(self, bitmap_array, canvas.projection,
-                           map_bounds=map_bounds,
-                           spillable_area=spillable_area,
-                           land_polys=land_polys,
-                           **kwargs)
-        return None
+    @classmethod
+    def _cache_file(cls, filename, raster_size, cache_dir):
+        """
+        the cache file of a BNA file drawn to raster_size pixels: named by
+        the contents of the file, so a changed file isn't found
+        """
+        digest = hashlib.sha1()
+        with open(filename, 'rb') as fd:
+            for block in iter(lambda: fd.read(1 << 20), b''):
+                digest.update(block)
+        digest.update('{0}:{1}'.format(int(raster_size), cls._cache_version))
+
+        return os.path.join(cache_dir,
+                            'bna_{0}.pkl'.format(digest.hexdigest()))
+
+    @staticmethod
+    def _load_cache(cache_file):
+        """
+        what _save_cache() saved in cache_file, None if it isn't there or
+        can't be read -- then the map is made from the BNA file again
+        """
+        if cache_file is None or not os.path.isfile(cache_file):
+            return None
+
+        try:
+            with open(cache_file, 'rb') as fd:
+                cached = cPickle.load(fd)
+        except Exception:
+            return None
+
+        if not isinstance(cached, tuple) or len(cached) != 6:
+            return None
+
+        return cached
+
+    @staticmethod
+    def _save_cache(cache_file, cached):
+        """
+        saves cached to cache_file, by way of a temporary file in the same
+        directory, so the other processes find the whole file or none
+        """
+        cache_dir = os.path.dirname(cache_file)
+        if not os.path.isdir(cache_dir):
+            os.makedirs(cache_dir)
+
+        fd, tmp_name = tempfile.mkstemp(dir=cache_dir, suffix='.tmp')
+        try:
+            with os.fdopen(fd, 'wb') as tmp:
+                cPickle.dump(cached, tmp, protocol=2)
+            os.rename(tmp_name, cache_file)
+        except Exception:
+            if os.path.exists(tmp_name):
+                os.remove(tmp_name)
+            raise
 
     def to_geojson(self):
         map_file = ogr_open_file(self.filename)
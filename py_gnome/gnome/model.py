@@ -1,10 +1,13 @@
 #!/usr/bin/env python
 import os
 import shutil
+import logging
+import time
 from datetime import datetime, timedelta
 import copy
 import inspect
 import zipfile
+import json
 
 from colander import (SchemaNode,
                       String, Float, Int, Bool,
@@ -13,26 +16,43 @@ from colander import (SchemaNode,
 from gnome.environment import Environment
 
 import gnome.utilities.cache
-from gnome.utilities.time_utils import round_time
+from gnome.utilities.time_utils import round_time, date_to_sec
 from gnome.utilities.orderedcollection import OrderedCollection
 from gnome.utilities.serializable import Serializable, Field
 
 from gnome.basic_types import oil_status, fate
 from gnome.spill_container import SpillContainerPair
 from gnome.environment import Wind
-from gnome.movers import Mover
+from gnome.movers import Mover, CyMover, get_move_fused
+from gnome.movers.wind_movers import WindMoversBase
+from gnome.cy_gnome.cy_mover import run_transport_steps
 from gnome.weatherers import (weatherer_sort,
                               Weatherer,
                               WeatheringData,
                               FayGravityViscous)
+from gnome.weatherers.cleanup import CleanUpBase, weather_cleanups
+from gnome.weatherers.core import weather_pipeline
 from gnome.outputters import Outputter, NetCDFOutput, WeatheringOutput
+from gnome.outputters.output_writer import (OutputWriter, StepSnapshot,
+                                           write_step)
+from gnome.utilities.step_pipeline import (ForcingPrefetch,
+                                           run_concurrently,
+                                           in_worker_thread)
+from gnome.utilities.tracing import NO_SPAN
+from gnome.utilities import setup_profile
 from gnome.persist import (extend_colander,
                            validators,
                            References,
                            class_from_objtype)
+from gnome.persist import checkpoint
+from gnome.persist.save_load import (open_savezip,
+                                     is_savezip,
+                                     write_array,
+                                     read_array)
 from gnome.persist.base_schema import (ObjType,
                                        CollectionItemsList)
 from gnome.exceptions import ReferencedObjectNotSet
+from gnome.cy_gnome import cy_helpers
 
 
 class ModelSchema(ObjType):
@@ -165,13 +185,16 @@ class Model(Serializable):
         return model
 
     @classmethod
-    def load_savefile(cls, filename):
+    def load_savefile(cls, filename, lazy=False):
         """
         load a model instance from a save file
 
         :param filename: the filename of the save file -- usually a zip file,
                          but can also be a directry with the full contents of
                          a zip file
+        :param lazy=False: if True, the gridded current and wind movers read
+                           their forcing files the first time they are used,
+                           rather than as they are loaded
 
         :returns: a model instance all set up from the savefile.
 
@@ -179,7 +202,7 @@ class Model(Serializable):
         ``gnome.persist.save_load.load()``
 
         """
-        model = gnome.persist.save_load.load(filename)
+        model = gnome.persist.save_load.load(filename, lazy=lazy)
 
         # check that this actually loaded a model object
         #  load() will load any gnome object from json...
@@ -272,6 +295,57 @@ class Model(Serializable):
         # list of output objects
         self.outputters = OrderedCollection(dtype=Outputter)
 
+        # lib_gnome section timings of each mover this run, by mover id, and
+        # the counts of the spill containers' scratch pools by 'scratch'
+        self.timing_stats = {}
+
+        # wall clock seconds spent in each stage of step() this run
+        self.stage_times = {}
+
+        # with cy_helpers.open_section_counters(), the hardware counts of
+        # each stage this run, by stage and counter name. The stages of the
+        # spill containers run at the same time are counted in the next
+        # stage done on the model's thread
+        self.stage_counters = {}
+        self._stage_counts = None
+
+        # a gnome.utilities.tracing.ChromeTracer gets spans of the stages,
+        # and of the movers, weatherers and outputters in them
+        self.tracer = None
+
+        # With more than 0, the outputters that can be are run on a
+        # background OutputWriter, with at most this many of their calls
+        # queued. Their output isn't in what step() returns then: it is in
+        # background_output ({step_num: {outputter class name: output}})
+        # when the run is done, and in what full_run() returns.
+        self.output_queue_depth = 0
+        self.background_output = {}
+        self._output_writer = None
+
+        # With pipeline_steps, the forcing of the next step is read on a
+        # background thread while the elements of this one weather - see
+        # gnome.utilities.step_pipeline
+        self.pipeline_steps = False
+        self._forcing_prefetch = ForcingPrefetch()
+
+        # With concurrent_spill_containers, the forecast and uncertain
+        # spill containers are moved and weathered at the same time on two
+        # threads when their movers and weatherers allow it - see
+        # _spill_container_jobs()
+        self.concurrent_spill_containers = False
+
+        # With concurrent_substances, the weatherers that allow it weather
+        # the substances of a spill container at the same time on threads of
+        # their own - see _weather_substances()
+        self.concurrent_substances = False
+
+        # the spill containers' data arrays kept out of core, mapped to
+        # temporary files in cold_array_dir, for runs with more elements
+        # than fit in memory - see SpillContainer.cold_arrays and
+        # spill_container.COLD_ARRAYS. Empty is all of them in memory
+        self.cold_arrays = ()
+        self.cold_array_dir = None
+
         # default to now, rounded to the nearest hour
         self._start_time = start_time
         self._duration = duration
@@ -308,6 +382,47 @@ class Model(Serializable):
         # make_default_refs is True
         self.make_default_refs = True
 
+        # movers that support it move the elements in each spill container's
+        # element_view, loaded once per step, instead of in their own copy
+        # of the positions - see SpillContainer.element_view
+        self.use_element_view = False
+
+        # with use_element_view, the movers next to each other in the list
+        # that can, move the elements in one pass - see get_move_fused()
+        self.fuse_movers = False
+
+        # the cleanup operations next to each other in the weatherers remove
+        # their mass in one pass over the elements - see weather_cleanups()
+        self.batch_cleanup = False
+
+        # the chainable weatherers next to each other in the weatherers run
+        # on each substance in one call to lib_gnome - see weather_pipeline()
+        self.chain_weatherers = False
+
+        # every sort_interval steps, reorder the elements of the forecast
+        # spill containers along a space filling curve so the movers walk
+        # their grids in order - see SpillContainer.sort_by_position(). 0 is
+        # off. The time it takes is stage_times['sort']
+        self.sort_interval = 0
+
+        # an ElementManager merges the far field elements of the forecast
+        # spill container into super-particles every few steps, and splits
+        # them near the shore. None is off. The time it takes is
+        # stage_times['manage']
+        self.element_manager = None
+
+        # every checkpoint_interval steps, save a checkpoint of the run to
+        # checkpoint_file - see save_checkpoint(). 0 is off
+        self.checkpoint_file = None
+        self.checkpoint_interval = 0
+
+        # with transport_fast_path, a run that only moves its forecast
+        # elements with movers that run in C++ has its steps run many at a
+        # time by lib_gnome's RunTransportSteps: step() only comes back to
+        # Python for the steps that are output or release elements - see
+        # run_transport(). The steps in between aren't in the cache.
+        self.transport_fast_path = False
+
     def reset(self, **kwargs):
         '''
         Resets model to defaults -- Caution -- clears all movers, spills, etc.
@@ -319,6 +434,10 @@ class Model(Serializable):
         '''
         Rewinds the model to the beginning (start_time)
         '''
+        self._close_output_writer()
+        self.background_output = {}
+        self._forcing_prefetch.wait(raise_error=False)
+
         self._current_time_step = -1
         self.model_time = self._start_time
 
@@ -338,6 +457,14 @@ class Model(Serializable):
         for outputter in self.outputters:
             outputter.rewind()
 
+        self.timing_stats = {}
+        self.stage_times = {}
+        self.stage_counters = {}
+        for m in self.movers:
+            cy_mover = getattr(m, 'mover', None)
+            if hasattr(cy_mover, 'reset_timing_stats'):
+                cy_mover.reset_timing_stats()
+
         self.logger.info(self._pid + "rewound model - " + self.name)
 
 #    def write_from_cache(self, filetype='netcdf', time_step='all'):
@@ -487,13 +614,23 @@ class Model(Serializable):
         if self.map.id == obj_id:
             return True
 
-        for collection in (self.environment,
-                           self.spills,
-                           self.movers,
-                           self.weatherers,
-                           self.outputters):
+        collections = (self.environment,
+                       self.spills,
+                       self.movers,
+                       self.weatherers,
+                       self.outputters)
+
+        # the ordered collections know the ids of their objects, only the
+        # objects that contain others are looked in
+        for collection in collections:
+            if (isinstance(collection, OrderedCollection) and
+                    collection.contains_id(str(obj_id))):
+                return True
+
+        for collection in collections:
             for o in collection:
-                if obj_id == o.id:
+                if (not isinstance(collection, OrderedCollection) and
+                        obj_id == o.id):
                     return True
 
                 if (hasattr(o, 'contains_object') and
@@ -508,13 +645,16 @@ class Model(Serializable):
         By default, it will return the first object of this type.
         To get all obects of this type, set ret_all to True
         '''
+        if isinstance(collection, OrderedCollection):
+            return collection.find_by_class(obj, ret_all)
+
         all_objs = []
         for item in collection:
             if isinstance(item, obj):
                 if not ret_all:
-                    return obj
+                    return item
                 else:
-                    all_objs.append(obj)
+                    all_objs.append(item)
 
         if len(all_objs) == 0:
             return None
@@ -536,6 +676,9 @@ class Model(Serializable):
         :param OrderedCollection collection: the ordered collection in which
             to search
         '''
+        if isinstance(collection, OrderedCollection):
+            return collection.find_by_attr(attr, value, allitems)
+
         items = []
         for item in collection:
             try:
@@ -645,7 +788,11 @@ class Model(Serializable):
         transport = False
         for mover in self.movers:
             if mover.on:
-                mover.prepare_for_model_run()
+                mover.set_model_step_times(self.start_time, self.time_step,
+                                           self.num_time_steps)
+                with setup_profile.setup_stage(mover,
+                                               'prepare_for_model_run'):
+                    mover.prepare_for_model_run()
                 transport = True
                 array_types.update(mover.array_types)
 
@@ -677,16 +824,27 @@ class Model(Serializable):
             self._reset_num_time_steps()
 
         for sc in self.spills.items():
+            sc.cold_arrays = set(self.cold_arrays)
+            sc.cold_array_dir = self.cold_array_dir
             sc.prepare_for_model_run(array_types)
 
         # outputters need array_types, so this needs to come after those
         # have been updated.
+        self._close_output_writer()
         for outputter in self.outputters:
             outputter.prepare_for_model_run(model_start_time=self.start_time,
                                             cache=self._cache,
                                             uncertain=self.uncertain,
                                             spills=self.spills,
                                             model_time_step=self.time_step)
+
+        self.background_output = {}
+        if (self.output_queue_depth > 0 and
+                any(o.background_safe for o in self.outputters)):
+            self._output_writer = OutputWriter(self.output_queue_depth)
+
+        if self.tracer is not None:
+            self.tracer.start()
         self.logger.debug("{0._pid} setup_model_run complete for: "
                           "{0.name}".format(self))
 
@@ -694,10 +852,15 @@ class Model(Serializable):
         '''
         sets up everything for the current time_step:
         '''
+        # the forcing read for this step while the last one weathered
+        self._forcing_prefetch.wait()
+
         # initialize movers differently if model uncertainty is on
         for m in self.movers:
-            for sc in self.spills.items():
-                m.prepare_for_model_step(sc, self.time_step, self.model_time)
+            with self._trace(m, 'prepare_for_model_step'):
+                for sc in self.spills.items():
+                    m.prepare_for_model_step(sc, self.time_step,
+                                             self.model_time)
 
         for w in self.weatherers:
             for sc in self.spills.items():
@@ -708,7 +871,32 @@ class Model(Serializable):
             environment.prepare_for_model_step(self.model_time)
 
         for outputter in self.outputters:
-            outputter.prepare_for_model_step(self.time_step, self.model_time)
+            if self._in_background(outputter):
+                self._output_writer.submit(outputter.prepare_for_model_step,
+                                           self.time_step, self.model_time)
+            else:
+                outputter.prepare_for_model_step(self.time_step,
+                                                 self.model_time)
+
+    def prepare_next_forcing(self):
+        '''
+        With pipeline_steps, starts reading the forcing of the next step,
+        if there is one, on a background thread: the movers and environment
+        objects' prepare_forcing(). Called once move_elements() is done with
+        the forcing of this step.
+        '''
+        if (not self.pipeline_steps or
+                self.current_time_step + 2 >= self._num_time_steps):
+            return
+
+        next_time = self.model_time + timedelta(seconds=self.time_step)
+
+        jobs = [(m.prepare_forcing, (self.time_step, next_time))
+                for m in self.movers if m.on]
+        jobs.extend((environment.prepare_forcing, (next_time,))
+                    for environment in self.environment)
+
+        self._forcing_prefetch.start(jobs)
 
     def move_elements(self):
         '''
@@ -718,30 +906,94 @@ class Model(Serializable):
          - calls the beaching code to beach the elements that need beaching.
          - sets the new position
         '''
-        for sc in self.spills.items():
-            if sc.num_released > 0:  # can this check be removed?
+        # the movers keep the arrays of the last get_move(): only the ones
+        # that move the element views can move two containers at once, and
+        # the ones with random moves only with the counter based draws
+        concurrent = (self.use_element_view and
+                      all(getattr(m, 'uses_element_view', False) and
+                          getattr(m.mover, 'use_counter_rng', True)
+                          for m in self.movers))
 
-                # possibly refloat elements
-                self.map.refloat_elements(sc, self.time_step)
+        self._for_each_spill_container(self._move_spill_container,
+                                       concurrent)
 
+    def _move_spill_container(self, sc):
+        'move_elements() of one spill container'
+        if sc.num_released > 0:  # can this check be removed?
+            start = time.time()
+
+            # possibly refloat elements
+            self.map.refloat_elements(sc, self.time_step)
+            start = self._stage_done('beach', start)
+
+            if self.use_element_view:
+                self._move_element_view(sc)
+            else:
                 # reset next_positions
                 (sc['next_positions'])[:] = sc['positions']
 
                 # loop through the movers
                 for m in self.movers:
-                    delta = m.get_move(sc, self.time_step, self.model_time)
+                    with self._trace(m, 'get_move'):
+                        delta = m.get_move(sc, self.time_step,
+                                           self.model_time)
                     sc['next_positions'] += delta
+            start = self._stage_done('move', start)
 
-                self.map.beach_elements(sc)
+            self.map.beach_elements(sc)
+            self._stage_done('beach', start)
 
-                # let model mark these particles to be removed
-                tbr_mask = sc['status_codes'] == oil_status.off_maps
-                sc['status_codes'][tbr_mask] = oil_status.to_be_removed
+            # let model mark these particles to be removed
+            tbr_mask = sc['status_codes'] == oil_status.off_maps
+            sc['status_codes'][tbr_mask] = oil_status.to_be_removed
 
-                self._update_fate_status(sc)
+            self._update_fate_status(sc)
 
-                # the final move to the new positions
-                (sc['positions'])[:] = sc['next_positions']
+            # the final move to the new positions
+            (sc['positions'])[:] = sc['next_positions']
+
+    def _for_each_spill_container(self, func, concurrent):
+        '''
+        func(sc) for each spill container: at the same time, with
+        concurrent_spill_containers and concurrent, or one after the other
+        '''
+        spill_containers = self.spills.items()
+
+        if (self.concurrent_spill_containers and concurrent and
+                len(spill_containers) > 1):
+            run_concurrently([(func, (sc,)) for sc in spill_containers])
+        else:
+            for sc in spill_containers:
+                func(sc)
+
+    def _move_element_view(self, sc):
+        '''
+        the mover loop of move_elements() on sc.element_view: next_positions
+        is the positions plus the moves of all the movers, like the loop on
+        sc['next_positions']
+        '''
+        view = sc.element_view
+        view.load(sc)
+
+        fused = []
+        for m in self.movers:
+            if (self.fuse_movers and isinstance(m, CyMover) and
+                    m.uses_element_view):
+                fused.append(m)
+                continue
+
+            # the moves are added in the order of the movers
+            get_move_fused(fused, sc, view, self.time_step, self.model_time)
+            fused = []
+
+            with self._trace(m, 'get_move'):
+                if not m.get_move_view(sc, view, self.time_step,
+                                       self.model_time):
+                    view.add_delta(m.get_move(sc, self.time_step,
+                                              self.model_time))
+
+        get_move_fused(fused, sc, view, self.time_step, self.model_time)
+        view.store(sc)
 
     def _update_fate_status(self, sc):
         '''
@@ -775,15 +1027,88 @@ class Model(Serializable):
             # if no weatherers then mass_components array may not be defined
             return
 
-        for sc in self.spills.items():
+        substeps = self._split_into_substeps()
+
+        def weather(sc):
             # elements may have beached to update fate_status
 
             sc.reset_fate_dataview()
 
+            cleanups = []
+            chain = []
             for w in self.weatherers:
-                for model_time, time_step in self._split_into_substeps():
-                    # change 'mass_components' in weatherer
-                    w.weather_elements(sc, time_step, model_time)
+                if self.batch_cleanup and isinstance(w, CleanUpBase):
+                    self._weather_chain(chain, sc, substeps)
+                    chain = []
+                    cleanups.append(w)
+                    continue
+
+                self._weather_cleanups(cleanups, sc, substeps)
+                cleanups = []
+
+                if self.chain_weatherers and w.chainable:
+                    chain.append(w)
+                    continue
+
+                self._weather_chain(chain, sc, substeps)
+                chain = []
+
+                # change 'mass_components' in weatherer
+                with self._trace(w, 'weather_elements'):
+                    self._weather_substances(w, sc, substeps)
+
+            self._weather_cleanups(cleanups, sc, substeps)
+            self._weather_chain(chain, sc, substeps)
+
+        self._for_each_spill_container(weather,
+                                       all(w.concurrent_safe
+                                           for w in self.weatherers))
+
+    def _weather_substances(self, weatherer, sc, substeps):
+        '''
+        the weatherer's sub-steps on sc: with concurrent_substances, on each
+        substance at the same time if the weatherer can, with
+        run_concurrently() on a SubstanceSubset each. Their mass balances are added to the spill
+        container's in the order of the substances, so the run comes out the
+        same whichever thread is done first.
+        '''
+        subsets = []
+        if self.concurrent_substances and weatherer.substance_concurrent:
+            subsets = sc.substance_subsets()
+
+        if len(subsets) < 2:
+            weatherer.weather_elements_substeps(sc, substeps)
+            return
+
+        run_concurrently([(weatherer.weather_elements_substeps,
+                           (subset, substeps)) for subset in subsets])
+
+        for subset in subsets:
+            subset.add_mass_balance()
+
+    def _weather_cleanups(self, cleanups, sc, substeps):
+        '''
+        the cleanup operations next to each other in the weatherers, in one
+        pass over the elements if there are more than one of them
+        '''
+        if len(cleanups) == 1:
+            with self._trace(cleanups[0], 'weather_elements'):
+                cleanups[0].weather_elements_substeps(sc, substeps)
+        elif len(cleanups) > 1:
+            with self._trace(cleanups[0], 'weather_cleanups'):
+                weather_cleanups(cleanups, sc, substeps)
+
+    def _weather_chain(self, chain, sc, substeps):
+        '''
+        the chainable weatherers next to each other in the weatherers, in
+        one call on each substance if there are more than one of them
+        '''
+        if len(chain) == 1:
+            with self._trace(chain[0], 'weather_elements'):
+                self._weather_substances(chain[0], sc, substeps)
+        elif len(chain) > 1:
+            with self._trace(chain[0], 'weather_pipeline'):
+                weather_pipeline(chain, sc, substeps)
 
     def _split_into_substeps(self):
         '''
@@ -810,6 +1135,196 @@ class Model(Serializable):
 
         return res
 
+    def sort_elements(self):
+        '''
+        Sorts the elements of the forecast spill containers by position.
+        The uncertain ones are left alone: lib_gnome keeps their uncertainty
+        state by element index
+        '''
+        for sc in self.spills.items():
+            if not sc.uncertain:
+                sc.sort_by_position()
+
+    def _can_run_transport(self):
+        '''
+        whether run_transport() can run the next steps: with
+        transport_fast_path, for a run with no weathering and no
+        uncertainty, all of whose movers run in C++ (see
+        CyMover.native_transport), on a map with no land or a raster map,
+        and no outputters in the background
+        '''
+        if (not self.transport_fast_path or self.uncertain or
+                any(w.on for w in self.weatherers) or
+                len(self.spills.items()) != 1):
+            return False
+
+        if not all(isinstance(m, CyMover) and m.native_transport
+                   for m in self.movers):
+            return False
+
+        if (isinstance(self.map, gnome.map.ParamMap) or
+                not (type(self.map) is gnome.map.GnomeMap or
+                     isinstance(self.map, gnome.map.RasterMap))):
+            return False
+
+        return not any(self._in_background(o) for o in self.outputters)
+
+    def _transport_span(self):
+        '''
+        The number of steps from this one that run_transport() runs, and
+        which movers are active in them: up to the first step that is
+        output, releases elements at its end, sorts or checkpoints, or is
+        the last one, and before the first step with other movers active.
+
+        The outputters are prepared for the steps, as setup_time_step()
+        does, to find the first one they write.
+        '''
+        sc = self.spills.items()[0]
+        dt = timedelta(seconds=self.time_step)
+        step = self.current_time_step
+        model_time = self.model_time
+        active = [m.active_in_step(self.time_step, model_time)
+                  for m in self.movers]
+        num_steps = 0
+
+        while True:
+            if num_steps > 0 and active != [m.active_in_step(self.time_step,
+                                                             model_time)
+                                            for m in self.movers]:
+                break
+
+            for outputter in self.outputters:
+                outputter.prepare_for_model_step(self.time_step, model_time)
+            num_steps += 1
+            model_time += dt
+
+            if (any(o._write_step for o in self.outputters) or
+                    step + num_steps >= self._num_time_steps - 1 or
+                    self._releases_at(sc, model_time) or
+                    (self.sort_interval > 0 and
+                     (step + num_steps - 1) % self.sort_interval == 0) or
+                    (self.element_manager is not None and
+                     self.element_manager.interval > 0 and
+                     (step + num_steps - 1) %
+                     self.element_manager.interval == 0) or
+                    (self.checkpoint_interval > 0 and
+                     self.checkpoint_file is not None and
+                     (step + num_steps) % self.checkpoint_interval == 0)):
+                break
+
+        return num_steps, active
+
+    def _releases_at(self, sc, model_time):
+        '''
+        whether the spills of sc may release elements in the step from
+        model_time -- all but the ones that released all their elements
+        and the ones that start after it
+        '''
+        for spills in sc.iterspillsbysubstance():
+            for spill in spills:
+                release = spill.release
+                num_elements = getattr(release, 'num_elements', None)
+                if (num_elements is not None and
+                        release.num_released >= num_elements):
+                    continue
+
+                if model_time + timedelta(seconds=self.time_step) < \
+                        release.release_time:
+                    continue
+
+                return True
+
+        return False
+
+    def run_transport(self):
+        '''
+        Runs the steps from this one up to the next that must come back to
+        Python (see _transport_span) in lib_gnome's RunTransportSteps: the
+        refloat, the windages, the movers, the land and map checks of the
+        forecast elements, all of the steps in C++. The last step is left
+        done, for step() to release, cache and output its elements.
+        '''
+        num_steps, active = self._transport_span()
+        sc = self.spills.items()[0]
+
+        # the movers' and the environment's state at the last step
+        self._forcing_prefetch.wait()
+        for m, is_active in zip(self.movers, active):
+            m._active = is_active
+
+        for i in range(num_steps):
+            for environment in self.environment:
+                environment.prepare_for_model_step(
+                    self.model_time + timedelta(seconds=i * self.time_step))
+
+        movers = [m for m, is_active in zip(self.movers, active) if is_active]
+        wind = (sc.num_released > 0 and
+                any(isinstance(m, WindMoversBase) for m in self.movers))
+
+        land = transform = None
+        refloat_probability = -1.
+        if isinstance(self.map, gnome.map.RasterMap):
+            land = self.map.basebitmap
+            transform = self.map.projection.pixel_transform()
+            if self.map._refloat_halflife >= 0.0:
+                refloat_probability = \
+                    self.map._refloat_probability(self.time_step)
+
+        with self._trace(self, 'run_transport'):
+            result = run_transport_steps(
+                [m.mover for m in movers], num_steps,
+                date_to_sec(self.model_time), self.time_step,
+                sc['positions'], sc['status_codes'],
+                sc['last_water_positions'], sc['id'],
+                [isinstance(m, WindMoversBase) for m in movers],
+                sc['windages'] if wind else None,
+                sc['windage_range'] if wind else None,
+                sc['windage_persist'] if wind else None,
+                land, transform, self.map.map_bounds, refloat_probability,
+                self.map._refloat_step(sc))
+
+        if result['error'] != 0:
+            failed = self.model_time + timedelta(seconds=result['steps'] *
+                                                 self.time_step)
+            msg = ('No available data in the time interval that is being '
+                   'modeled\nModel time: {0}'.format(failed))
+            self.logger.error(msg)
+            raise RuntimeError(msg)
+
+        if isinstance(self.map, gnome.map.RasterMap):
+            self.map._update_mass_balance(sc, result['beached'])
+
+        # what move_elements() and step_is_done() do after the movers
+        off_maps = sc['status_codes'] == oil_status.off_maps
+        sc['status_codes'][off_maps] = oil_status.to_be_removed
+        self._update_fate_status(sc)
+
+        for i in range(num_steps):
+            for outputter in self.outputters:
+                outputter.model_step_is_done()
+
+        sc.model_step_is_done()
+        sc['age'][:] = sc['age'][:] + self.time_step * num_steps
+
+        # left at the last step, which step() ends
+        self.current_time_step += num_steps - 1
+
+    def save_checkpoint(self, filename):
+        '''
+        Saves a checkpoint of the run at the current step to filename, for
+        restore_checkpoint() to pick the run up from -- see
+        gnome.persist.checkpoint for what is and is not in it
+        '''
+        checkpoint.save_checkpoint(self, filename)
+
+    def restore_checkpoint(self, filename):
+        '''
+        Picks the run up from the checkpoint in filename, saved by
+        save_checkpoint() of a model set up as this one is. The next step()
+        is the step after the checkpoint.
+        '''
+        checkpoint.restore_checkpoint(self, filename)
+
     def step_is_done(self):
         '''
         Loop through movers and weatherers and call model_step_is_done
@@ -827,7 +1342,10 @@ class Model(Serializable):
                 w.model_step_is_done(sc)
 
         for outputter in self.outputters:
-            outputter.model_step_is_done()
+            if self._in_background(outputter):
+                self._output_writer.submit(outputter.model_step_is_done)
+            else:
+                outputter.model_step_is_done()
 
         for sc in self.spills.items():
             '''
@@ -840,12 +1358,23 @@ class Model(Serializable):
 
     def write_output(self, valid, messages=None):
         output_info = {'step_num': self.current_time_step}
+        islast_step = self.current_time_step == self.num_time_steps - 1
+
+        # all the outputters share one copy of the step, loaded when the
+        # first of them writes it
+        snapshot = StepSnapshot(self._cache, self.current_time_step,
+                                lazy=True)
 
         for outputter in self.outputters:
-            if self.current_time_step == self.num_time_steps - 1:
-                output = outputter.write_output(self.current_time_step, True)
-            else:
-                output = outputter.write_output(self.current_time_step)
+            if self._in_background(outputter):
+                # the writer reads it after the cache has moved on
+                snapshot.load()
+                self._output_writer.write_output(outputter, snapshot,
+                                                 islast_step)
+                continue
+
+            with self._trace(outputter, 'write_output'):
+                output = write_step(outputter, snapshot, islast_step)
 
             if output is not None:
                 output_info[outputter.__class__.__name__] = output
@@ -856,12 +1385,31 @@ class Model(Serializable):
 
         return output_info
 
+    def _in_background(self, outputter):
+        return self._output_writer is not None and outputter.background_safe
+
+    def _close_output_writer(self):
+        '''
+        Waits for the background outputters to be done with the run, and
+        keeps what they returned in background_output
+        '''
+        writer, self._output_writer = self._output_writer, None
+
+        if writer is not None:
+            try:
+                writer.close()
+            finally:
+                self.background_output = writer.results
+
     def step(self):
         '''
         Steps the model forward (or backward) in time. Needs testing for
         hind casting.
         '''
         isvalid = True
+        start = time.time()
+        self._stage_counts = (cy_helpers.read_section_counters()
+                              if cy_helpers.section_counters_open() else None)
         for sc in self.spills.items():
             # Set the current time stamp only after current_time_step is
             # incremented and before the output is written. Set it to None here
@@ -882,19 +1430,44 @@ class Model(Serializable):
             # if not isvalid:
             #    raise StopIteration("Setup model run complete but model "
             #                        "is invalid", msgs)
+            start = self._stage_done('setup', start)
 
         elif self.current_time_step >= self._num_time_steps - 1:
             # _num_time_steps is set when self.time_step is set. If user does
             # not specify time_step, then setup_model_run() automatically
             # initializes it. Thus, do StopIteration check after
             # setup_model_run() is invoked
+            self._close_output_writer()
+            self._forcing_prefetch.wait()
+            if self.tracer is not None:
+                self.tracer.stop()
             raise StopIteration("Run complete for {0}".format(self.name))
 
+        elif self._can_run_transport():
+            # up to the next step that is output or releases elements
+            self.run_transport()
+            start = self._stage_done('transport', start)
+            start = self._manage_elements_if_due(start)
+            start = self._sort_if_due(start)
+
         else:
             self.setup_time_step()
+            start = self._stage_done('setup', start)
+
+            # move_elements splits its time between move and beach
             self.move_elements()
+            start = time.time()
+
+            # the next step's forcing is read while this step weathers
+            self.prepare_next_forcing()
+
             self.weather_elements()
+            start = self._stage_done('weather', start)
+
             self.step_is_done()
+            start = self._stage_done('step_done', start)
+            start = self._manage_elements_if_due(start)
+            start = self._sort_if_due(start)
 
         self.current_time_step += 1
 
@@ -923,16 +1496,133 @@ class Model(Serializable):
             self.logger.debug("{1._pid} released {0} new elements for step:"
                               " {1.current_time_step} for {1.name}".
                               format(num_released, self))
+        start = self._stage_done('release', start)
 
         # cache the results - current_time_step is incremented but the
         # current_time_stamp in spill_containers (self.spills) is not updated
         # till we go through the prepare_for_model_step
         self._cache.save_timestep(self.current_time_step, self.spills)
+        start = self._stage_done('cache', start)
+
         output_info = self.write_output(isvalid)
+        self._stage_done('output', start)
+
+        for sc in self.spills.items():
+            sc.scratch.end_step()
+
+        self._collect_timing_stats()
+        if self.tracer is not None:
+            self.tracer.collect_native()
         self.logger.debug("{0._pid} Completed step: {0.current_time_step} "
                           "for {0.name}".format(self))
+        if self.logger.isEnabledFor(logging.DEBUG):
+            self._log_memory_usage()
+
+        if (self.checkpoint_interval > 0 and
+                self.checkpoint_file is not None and
+                self.current_time_step % self.checkpoint_interval == 0):
+            self.save_checkpoint(self.checkpoint_file)
+
         return output_info
 
+    def _manage_elements_if_due(self, start):
+        '''
+        merges and splits the elements of the forecast spill container
+        every element_manager.interval steps, returns the time the stage
+        after it starts
+        '''
+        manager = self.element_manager
+        if (manager is not None and manager.interval > 0 and
+                self.current_time_step % manager.interval == 0):
+            for sc in self.spills.items():
+                if not sc.uncertain:
+                    manager.manage(sc, self.map)
+            start = self._stage_done('manage', start)
+
+        return start
+
+    def _sort_if_due(self, start):
+        '''
+        sorts the elements every sort_interval steps, returns the time the
+        stage after it starts
+        '''
+        if (self.sort_interval > 0 and
+                self.current_time_step % self.sort_interval == 0):
+            self.sort_elements()
+            start = self._stage_done('sort', start)
+
+        return start
+
+    def _stage_done(self, stage, start):
+        '''
+        Adds the time since start to stage_times[stage], and the counts
+        since the last stage to stage_counters[stage], and returns now
+        '''
+        now = time.time()
+
+        # the stages of the spill containers run at the same time are timed
+        # on the model's thread
+        if not in_worker_thread():
+            self.stage_times[stage] = (self.stage_times.get(stage, 0.) +
+                                       now - start)
+
+            if self._stage_counts is not None:
+                counts = cy_helpers.read_section_counters()
+                stage_counts = self.stage_counters.setdefault(stage, {})
+                for name, count in counts.iteritems():
+                    if count is not None:
+                        stage_counts[name] = (stage_counts.get(name, 0) +
+                                              count - self._stage_counts[name])
+                self._stage_counts = counts
+
+        if self.tracer is not None:
+            self.tracer.add_span(stage, 'step', start, now,
+                                 step=self.current_time_step)
+
+        return now
+
+    def _trace(self, obj, call):
+        '''
+        the tracer's span of obj's call, a no-op span without a tracer
+        '''
+        if self.tracer is None:
+            return NO_SPAN
+
+        return self.tracer.span('{0}.{1}'.format(obj.__class__.__name__,
+                                                 call),
+                                call, name=getattr(obj, 'name', None),
+                                step=self.current_time_step)
+
+    def _collect_timing_stats(self):
+        '''
+        Keeps the lib_gnome section timings of the movers, from the start of
+        the run, in timing_stats (see CyMover.get_timing_stats)
+        '''
+        for m in self.movers:
+            cy_mover = getattr(m, 'mover', None)
+            if hasattr(cy_mover, 'get_timing_stats'):
+                self.timing_stats[m.id] = cy_mover.get_timing_stats()
+
+        # the arrays lent by the scratch pools, of the run
+        self.timing_stats['scratch'] = \
+            dict(('uncertain' if sc.uncertain else 'forecast',
+                  sc.scratch.stats()) for sc in self.spills.items())
+
+    def _log_memory_usage(self):
+        '''
+        Logs the memory held in lib_gnome by subsystem, and its peak
+        '''
+        usage = cy_helpers.get_memory_usage()
+        held = ', '.join('{0}: {1[bytes]} ({1[peak_bytes]} peak)'
+                         .format(name, usage[name])
+                         for name in sorted(usage)
+                         if usage[name]['num_blocks'] > 0 and name != 'total')
+
+        self.logger.debug("{0._pid} lib_gnome memory after step "
+                          "{0.current_time_step}: {1[bytes]} bytes "
+                          "({1[peak_bytes]} peak) in {1[num_blocks]} blocks; "
+                          "{2}".format(self, usage['total'], held))
+
     def __iter__(self):
         '''
         Rewinds the model and returns itself so it can be iterated over.
@@ -972,6 +1662,12 @@ class Model(Serializable):
                 self.logger.info('Run Complete: Stop Iteration')
                 break
 
+        for results in output_data:
+            background = self.background_output.get(results['step_num'])
+            if background:
+                results.update(background)
+                results.setdefault('valid', True)
+
         return output_data
 
     def _add_to_environ_collec(self, obj_added):
@@ -1114,6 +1810,14 @@ class Model(Serializable):
         # if zipsave is on, the create zip and update saveloc
         saveloc = self._create_zip(saveloc, name)
 
+        if self.zipsave:
+            # all the objects append to the one open zipfile
+            with open_savezip(saveloc, self._allowzip64):
+                return self._save(saveloc, references, name)
+
+        return self._save(saveloc, references, name)
+
+    def _save(self, saveloc, references, name):
         # Note: Defining references=References() in the function definition
         # keeps the references object in memory between tests - it changes the
         # scope of References() to be outside the Model() instance. We don't
@@ -1142,7 +1846,7 @@ class Model(Serializable):
             hard code the filename - can make this an attribute if user wants
             to change it - but not sure if that will ever be needed?
             '''
-            self._save_spill_data(saveloc, 'spills_data_arrays.nc')
+            self._save_spill_data(saveloc, 'spills_data_arrays.json')
 
         # if saved as zipfile, then store model's json in Model.json - this is
         # default if name is None
@@ -1151,33 +1855,105 @@ class Model(Serializable):
 
         return references
 
-    def _save_spill_data(self, saveloc, nc_file):
+    def _save_spill_data(self, saveloc, index_file):
+        """
+        save the data arrays for current timestep: each array is written as it
+        is in memory, to an entry of its own in the zipfile or a file of its
+        own in the directory saveloc (see save_load.write_array()), and the
+        arrays, mass_balance and current_time_stamp of each spill container
+        to the json index_file
+        """
+        containers = []
+        for count, sc in enumerate(self.spills.items()):
+            arrays = {}
+            for name, array in sc._data_arrays.iteritems():
+                fname = 'spills_data_{0}_{1}.bin'.format(count, name)
+                arrays[name] = write_array(saveloc, fname, array,
+                                           self._allowzip64)
+
+            time_stamp = sc.current_time_stamp
+            if time_stamp is not None:
+                time_stamp = time_stamp.strftime(self._spill_data_time_format)
+
+            containers.append({'uncertain': sc.uncertain,
+                               'current_time_stamp': time_stamp,
+                               'mass_balance': sc.mass_balance,
+                               'data_arrays': arrays})
+
+        # the mass_balance values can be numpy scalars
+        index = json.dumps({'spill_containers': containers}, indent=True,
+                           default=lambda value: value.tolist())
+
+        if is_savezip(saveloc):
+            self._write_to_zip(saveloc, index_file, index)
+        else:
+            with open(os.path.join(saveloc, index_file), 'w') as outfile:
+                outfile.write(index)
+
+    _spill_data_time_format = '%Y-%m-%dT%H:%M:%S.%f'
+
+    def _spill_data_array_types(self):
+        array_types = set()
+
+        for m in self.movers:
+            array_types.update(m.array_types)
+
+        for w in self.weatherers:
+            array_types.update(w.array_types)
+
+        return array_types
+
+    def _load_spill_data(self, saveloc, index_file):
         """
-        save the data arrays for current timestep to NetCDF
-        If saveloc is zipfile, then move NetCDF to zipfile
+        load the data arrays _save_spill_data() saved and add them back in -
+        designed for savefiles. Save files with the data in NetCDF are loaded
+        by _load_spill_data_nc().
         """
-        zipname = None
         if zipfile.is_zipfile(saveloc):
-            saveloc, zipname = os.path.split(saveloc)
-
-        datafile = os.path.join(saveloc, nc_file)
-        nc_out = NetCDFOutput(datafile, which_data='all', cache=self._cache)
-        nc_out.prepare_for_model_run(model_start_time=self.start_time,
-                                     uncertain=self.uncertain,
-                                     spills=self.spills)
-        nc_out.write_output(self.current_time_step)
-        if zipname is not None:
-            with zipfile.ZipFile(os.path.join(saveloc, zipname), 'a',
-                                 compression=zipfile.ZIP_DEFLATED,
-                                 allowZip64=self._allowzip64) as z:
-                z.write(datafile, nc_file)
-                os.remove(datafile)
-                if self.uncertain:
-                    u_file = nc_out.uncertain_filename
-                    z.write(u_file, os.path.split(u_file)[1])
-                    os.remove(u_file)
+            with zipfile.ZipFile(saveloc, 'r') as z:
+                if index_file not in z.namelist():
+                    return self._load_spill_data_nc(saveloc,
+                                                    'spills_data_arrays.nc')
+
+                index = json.loads(z.read(index_file))
+        else:
+            index_path = os.path.join(saveloc, index_file)
+            if not os.path.exists(index_path):
+                return self._load_spill_data_nc(saveloc,
+                                                'spills_data_arrays.nc')
+
+            with open(index_path, 'r') as infile:
+                index = json.load(infile)
+
+        array_types = self._spill_data_array_types()
+        saved = dict((c['uncertain'], c) for c in index['spill_containers'])
+
+        for sc in self.spills.items():
+            if sc.uncertain not in saved:
+                continue
 
-    def _load_spill_data(self, saveloc, nc_file):
+            sc.prepare_for_model_run(array_types)
+            container = saved[sc.uncertain]
+
+            time_stamp = container['current_time_stamp']
+            if time_stamp is not None:
+                time_stamp = datetime.strptime(time_stamp,
+                                               self._spill_data_time_format)
+
+            sc.current_time_stamp = time_stamp
+            sc._data_arrays = dict((name, read_array(saveloc, array_json))
+                                   for name, array_json
+                                   in container['data_arrays'].iteritems())
+            sc.mass_balance = container['mass_balance']
+
+        if not zipfile.is_zipfile(saveloc):
+            # delete files after data is loaded - since no longer needed
+            os.remove(index_path)
+            for container in index['spill_containers']:
+                for array_json in container['data_arrays'].itervalues():
+                    os.remove(os.path.join(saveloc, array_json['file']))
+
+    def _load_spill_data_nc(self, saveloc, nc_file):
         """
         load NetCDF file and add spill data back in - designed for savefiles
         """
@@ -1203,13 +1979,7 @@ class Model(Serializable):
                                         '{0}_uncertain{1}'
                                         .format(spill_data_fname, ext))
 
-        array_types = set()
-
-        for m in self.movers:
-            array_types.update(m.array_types)
-
-        for w in self.weatherers:
-            array_types.update(w.array_types)
+        array_types = self._spill_data_array_types()
 
         for sc in self.spills.items():
             sc.prepare_for_model_run(array_types)
@@ -1278,6 +2048,26 @@ class Model(Serializable):
 
         return o_json_
 
+    def serialize_delta(self, json_='webapi'):
+        '''
+        Serialize the changes since the last serialize() or serialize_delta()
+        -- with the validation flag and messages, like serialize()
+        '''
+        o_json_ = super(Model, self).serialize_delta(json_)
+
+        (msgs, isvalid) = self.validate()
+        o_json_['valid'] = isvalid
+        o_json_['messages'] = msgs
+
+        return o_json_
+
+    def _delta_collections(self):
+        'the collections of serialize(), the forecast spills with them'
+        return self._oc_list + ['spills']
+
+    def _delta_schema(self, json_='webapi'):
+        return self.__class__._schema(json_)
+
     @classmethod
     def deserialize(cls, json_):
         '''
@@ -1330,6 +2120,7 @@ class Model(Serializable):
         cls._update_datafile_path(json_data, saveloc)
 
         # deserialize after removing references
+        setup_stage = setup_profile.SetupStage('deserialize')
         _to_dict = cls.deserialize(json_data)
 
         if ref_dict:
@@ -1358,7 +2149,8 @@ class Model(Serializable):
 
         model = cls.new_from_dict(_to_dict)
 
-        model._load_spill_data(saveloc, 'spills_data_arrays.nc')
+        model._load_spill_data(saveloc, 'spills_data_arrays.json')
+        setup_stage.done(model)
 
         return model
 
@@ -1415,6 +2207,17 @@ class Model(Serializable):
                 msgs.append('error: ' + self.__class__.__name__ + ': ' + msg)
                 isvalid = False
 
+            release = getattr(spill, 'release', None)
+            if release is not None and self.map is not None:
+                not_allowed = release.positions_not_allowed(self.map)
+                if len(not_allowed) > 0:
+                    msg = ('{0} has {1} of {2} start positions outside of '
+                           'the spillable area of the map'
+                           .format(spill.name, len(not_allowed),
+                                   len(release.release_positions())))
+                    self.logger.warning(msg)
+                    msgs.append(self._warn_pre + msg)
+
         if num_spills > 0 and not someSpillIntersectsModel:
             if num_spills > 1:
                 msg = ('All of the spills are released after the time interval being modeled.')
@@ -1532,6 +2335,22 @@ class Model(Serializable):
             for item in oc:
                 item.make_default_refs = value
 
+    def setup_profile(self):
+        '''
+        The records of the setup stages of the model and its map,
+        environment, movers, weatherers, outputters and spills, in the order
+        they started: each stage's time, the lib_gnome stages in it, and the
+        caches that served it or 'could_be_cached'. See
+        gnome.utilities.setup_profile.
+        '''
+        objects = [self, self.map]
+        for oc in (self.environment, self.movers, self.weatherers,
+                   self.outputters):
+            objects.extend(oc)
+        objects.extend(self.spills)
+
+        return setup_profile.report(objects)
+
     def get_spill_property(self, prop_name, ucert=0):
         '''
         Convenience method to allow user to look up properties of a spill.
@@ -5,73 +5,81 @@
 """
 __init__.py for the gnome package
 
+The movers are imported from their modules the first time they are used,
+so importing one doesn't import all of them, with their cython extensions.
 """
+from gnome.utilities.lazy_import import lazy_package
 
-from movers import Mover, Process, ProcessSchema, CyMover
-from simple_mover import SimpleMover, SimpleMoverSchema
-from wind_movers import (WindMover,
-                         WindMoverSchema,
-                         constant_wind_mover,
-                         wind_mover_from_file,
-                         GridWindMoverSchema,
-                         GridWindMover,
-                         IceWindMoverSchema,
-                         IceWindMover)
-from ship_drift_mover import (ShipDriftMoverSchema,
-                              ShipDriftMover)
-from random_movers import (RandomMoverSchema,
-                           RandomMover,
-                           IceAwareRandomMover,
-                           RandomVerticalMoverSchema,
-                           RandomVerticalMover)
-from current_movers import (CatsMoverSchema,
-                            CatsMover,
-                            ComponentMoverSchema,
-                            ComponentMover,
-                            GridCurrentMoverSchema,
-                            GridCurrentMover,
-                            IceMoverSchema,
-                            IceMover,
-                            CurrentCycleMoverSchema,
-                            CurrentCycleMover)
-from vertical_movers import RiseVelocityMoverSchema, RiseVelocityMover
+_movers = {'movers': ('Mover', 'Process', 'ProcessSchema', 'CyMover',
+                      'LazyForcing', 'get_move_fused', 'get_move_ensemble',
+                      'c_layout', 'world_points', 'zero_world_points'),
+           'simple_mover': ('SimpleMover', 'SimpleMoverSchema'),
+           'wind_movers': ('WindMover',
+                           'WindMoverSchema',
+                           'constant_wind_mover',
+                           'wind_mover_from_file',
+                           'GridWindMoverSchema',
+                           'GridWindMover',
+                           'IceWindMoverSchema',
+                           'IceWindMover'),
+           'ship_drift_mover': ('ShipDriftMoverSchema',
+                                'ShipDriftMover'),
+           'random_movers': ('RandomMoverSchema',
+                             'RandomMover',
+                             'IceAwareRandomMover',
+                             'RandomVerticalMoverSchema',
+                             'RandomVerticalMover'),
+           'current_movers': ('CatsMoverSchema',
+                              'CatsMover',
+                              'ComponentMoverSchema',
+                              'ComponentMover',
+                              'GridCurrentMoverSchema',
+                              'GridCurrentMover',
+                              'IceMoverSchema',
+                              'IceMover',
+                              'CurrentCycleMoverSchema',
+                              'CurrentCycleMover'),
+           'tracpy_mover': ('TracPyMover',),
+           'vertical_movers': ('RiseVelocityMoverSchema', 'RiseVelocityMover'),
+           'ugrid_movers': ('UGridCurrentMover',),
+           'py_wind_movers': ('PyWindMover',),
+           'py_current_movers': ('PyGridCurrentMover',)}
 
-from ugrid_movers import UGridCurrentMover
-from py_wind_movers import PyWindMover
-from py_current_movers import PyGridCurrentMover
+__all__ = ['Mover',
+           'CyMover',
+           'Process',
+           'ProcessSchema',
+           'SimpleMover',
+           'SimpleMoverSchema',
+           'WindMover',
+           'WindMoverSchema',
+           'constant_wind_mover',
+           'wind_mover_from_file',
+           'GridWindMoverSchema',
+           'GridWindMover',
+           'ShipDriftMoverSchema',
+           'ShipDriftMover',
+           'IceWindMoverSchema',
+           'IceWindMover',
+           'RandomMoverSchema',
+           'RandomMover',
+           'IceAwareRandomMover',
+           'RandomVerticalMoverSchema',
+           'RandomVerticalMover',
+           'CatsMoverSchema',
+           'CatsMover',
+           'ComponentMoverSchema',
+           'ComponentMover',
+           'GridCurrentMoverSchema',
+           'GridCurrentMover',
+           'IceMoverSchema',
+           'IceMover',
+           'CurrentCycleMoverSchema',
+           'CurrentCycleMover',
+           'TracPyMover',
+           'RiseVelocityMoverSchema',
+           'RiseVelocityMover',
+           'PyWindMover',
+           'PyGridCurrentMover']
 
-__all__ = [Mover,
-           CyMover,
-           Process,
-           ProcessSchema,
-           SimpleMover,
-           SimpleMoverSchema,
-           WindMover,
-           WindMoverSchema,
-           constant_wind_mover,
-           wind_mover_from_file,
-           GridWindMoverSchema,
-           GridWindMover,
-           ShipDriftMoverSchema,
-           ShipDriftMover,
-           IceWindMoverSchema,
-           IceWindMover,
-           RandomMoverSchema,
-           RandomMover,
-           IceAwareRandomMover,
-           RandomVerticalMoverSchema,
-           RandomVerticalMover,
-           CatsMoverSchema,
-           CatsMover,
-           ComponentMoverSchema,
-           ComponentMover,
-           GridCurrentMoverSchema,
-           GridCurrentMover,
-           IceMoverSchema,
-           IceMover,
-           CurrentCycleMoverSchema,
-           CurrentCycleMover,
-           RiseVelocityMoverSchema,
-           RiseVelocityMover,
-           PyWindMover,
-           PyGridCurrentMover]
+lazy_package(__name__, _movers)
@@ -11,10 +11,12 @@ from colander import (SchemaNode, Bool, String, Float, drop)
 
 from gnome.persist.base_schema import ObjType, WorldPoint
 
-from gnome.movers import CyMover, ProcessSchema
+from gnome.movers import CyMover, LazyForcing, ProcessSchema
 from gnome import environment
 from gnome.utilities import serializable
 from gnome.utilities import time_utils
+from gnome.utilities.setup_profile import setup_stage
+from gnome.utilities.remote_data import data_path_exists
 
 from gnome import basic_types
 from gnome.cy_gnome.cy_cats_mover import CyCatsMover
@@ -161,6 +163,8 @@ class CatsMover(CurrentMoversBase, serializable.Serializable):
                                          save=True, update=True,
                                          save_reference=True)])
     _schema = CatsMoverSchema
+    uses_element_view = True
+    native_transport = True
 
     def __init__(self, filename, tide=None, uncertain_duration=48,
                  **kwargs):
@@ -202,7 +206,8 @@ class CatsMover(CurrentMoversBase, serializable.Serializable):
 
         # check if this is stored with cy_cats_mover?
         self.mover = CyCatsMover()
-        self.mover.text_read(filename)
+        with setup_stage(self, 'read'):
+            self.mover.text_read(filename)
         self.name = os.path.split(filename)[1]
 
         self._tide = None
@@ -323,6 +328,14 @@ class CatsMover(CurrentMoversBase, serializable.Serializable):
 
         self._tide = tide_obj
 
+    def set_model_step_times(self, start_time, time_step, num_steps):
+        '''
+        the tide's values at all the step times are looked up once, in
+        prepare_for_model_run(), for the movers sharing the tide
+        '''
+        self.mover.set_model_step_times(self.datetime_to_seconds(start_time),
+                                        int(time_step), num_steps or 0)
+
     def get_grid_data(self):
         """
             Invokes the GetToplogyHdl method of TriGridVel_c object
@@ -395,7 +408,8 @@ class GridCurrentMoverSchema(CurrentMoversBaseSchema):
     is_data_on_cells = SchemaNode(Bool(), missing=drop)
 
 
-class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
+class GridCurrentMover(LazyForcing, CurrentMoversBase,
+                       serializable.Serializable):
 
     _update = ['uncertain_cross', 'uncertain_along', 'current_scale', 'extrapolate', 'time_offset']
     _save = ['uncertain_cross', 'uncertain_along', 'current_scale', 'extrapolate', 'time_offset']
@@ -411,6 +425,8 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
                       serializable.Field('is_data_on_cells',
                                          save=False, read=True)])
     _schema = GridCurrentMoverSchema
+    uses_element_view = True
+    native_transport = True
 
     def __init__(self, filename,
                  topology_file=None,
@@ -420,6 +436,7 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
                  uncertain_along=0.5,
                  uncertain_across=0.25,
                  num_method=basic_types.numerical_methods.euler,
+                 lazy=False,
                  **kwargs):
         """
         Initialize a GridCurrentMover
@@ -443,6 +460,12 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
         :param num_method: Numerical method for calculating movement delta.
                            Default Euler
                            option: Runga-Kutta 4 (RK4)
+                           option: adaptive - Euler for the elements that
+                           stay within their grid cell in a step, RK4
+                           sub-steps for the others, see max_courant
+        :param lazy=False: read the data file the first time the mover is
+                           used, not here. Only used if topology_file is
+                           given.
 
         uses super, super(GridCurrentMover,self).__init__(\*\*kwargs)
         """
@@ -451,7 +474,7 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
         if type(self) == GridCurrentMover:
             self.mover = CyGridCurrentMover()
 
-        if not os.path.exists(filename):
+        if not data_path_exists(filename):
             raise ValueError('Path for current file does not exist: {0}'
                              .format(filename))
 
@@ -471,19 +494,30 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
         self.current_scale = current_scale
         self.uncertain_along = uncertain_along
         self.uncertain_across = uncertain_across
-        self.mover.text_read(filename, topology_file)
+        self.num_method = num_method
+
+        #super(GridCurrentMover, self).__init__(**kwargs)
+
+        # the topology file is exported from the data, so without one the
+        # data is read now
+        self._read_forcing_or_defer(lazy and topology_file is not None,
+                                    self._read_forcing, filename,
+                                    topology_file, extrapolate, time_offset)
+
+    def _read_forcing(self, filename, topology_file, extrapolate,
+                      time_offset):
+        with setup_stage(self, 'read'):
+            self.mover.text_read(filename, topology_file)
         if type(self) != CurrentCycleMover:
             self.real_data_start = time_utils.sec_to_datetime(self.mover.get_start_time())
             self.real_data_stop = time_utils.sec_to_datetime(self.mover.get_end_time())
         self.mover.extrapolate_in_time(extrapolate)
         self.mover.offset_time(time_offset * 3600.)
-        self.num_method = num_method
-
-        #super(GridCurrentMover, self).__init__(**kwargs)
 
         if self.topology_file is None:
             self.topology_file = filename + '.dat'
-            self.export_topology(self.topology_file)
+            with setup_stage(self, 'export_topology'):
+                self.export_topology(self.topology_file)
 
     def __repr__(self):
         return ('GridCurrentMover('
@@ -537,6 +571,18 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
                                                     'num_method',
                                                     val))
 
+    # for num_method adaptive: the Courant number up to which an element
+    # takes an Euler step, and the most RK4 sub-steps it is split into
+    max_courant = property(lambda self: self.mover.max_courant,
+                           lambda self, val: setattr(self.mover,
+                                                     'max_courant',
+                                                     val))
+
+    max_substeps = property(lambda self: self.mover.max_substeps,
+                            lambda self, val: setattr(self.mover,
+                                                      'max_substeps',
+                                                      val))
+
     @property
     def is_data_on_cells(self):
         return self.mover._is_data_on_cells()
@@ -626,6 +672,27 @@ class GridCurrentMover(CurrentMoversBase, serializable.Serializable):
     def get_num_method(self):
         return self.mover.num_method
 
+    def get_courant_numbers(self, sc, time_step, model_time_datetime):
+        """
+        The Courant number of each element of sc for a step of time_step
+        seconds from model_time_datetime: how far the current moves it in
+        the step, in sizes of the grid cell it is in. 0 for the elements
+        not in water, and where the grid doesn't know its cell sizes.
+
+        A Courant number over 1 is an element that crosses cells in a step,
+        which Euler steps over: a shorter time_step, or num_method adaptive,
+        keeps it in the grid's resolution.
+        """
+        positions = sc['positions']
+
+        return self.mover.get_courant_numbers(
+            self.datetime_to_seconds(model_time_datetime),
+            time_step,
+            np.ascontiguousarray(positions[:, 1]),
+            np.ascontiguousarray(positions[:, 0]),
+            np.ascontiguousarray(positions[:, 2]),
+            np.ascontiguousarray(sc['status_codes']))
+
 
 class IceMoverSchema(CurrentMoversBaseSchema):
     filename = SchemaNode(String(), missing=drop)
@@ -688,7 +755,7 @@ class IceMover(CurrentMoversBase, serializable.Serializable):
         if type(self) == IceMover:
             self.mover = CyIceMover()
 
-        if not os.path.exists(filename):
+        if not data_path_exists(filename):
             raise ValueError('Path for current file does not exist: {0}'
                              .format(filename))
 
@@ -914,6 +981,10 @@ class CurrentCycleMover(GridCurrentMover, serializable.Serializable):
                                          save_reference=True)])
     _schema = CurrentCycleMoverSchema
 
+    # CurrentCycleMover_c's move isn't the one in get_move_batch
+    uses_element_view = False
+    native_transport = False
+
     def __init__(self,
                  filename,
                  topology_file=None,
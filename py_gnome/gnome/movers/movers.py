@@ -16,9 +16,40 @@ from gnome.basic_types import (world_point,
 from gnome.utilities import inf_datetime
 from gnome.utilities import time_utils, serializable
 from gnome.cy_gnome.cy_rise_velocity_mover import CyRiseVelocityMover
+from gnome.cy_gnome import cy_mover
 from gnome import AddLogger
 from gnome.utilities.inf_datetime import InfTime, MinusInfTime
 from gnome.utilities.projections import FlatEarthProjection
+from gnome.utilities.scratch import scratch_zeros
+
+
+def c_layout(values, dtype):
+    '''
+    values as the C contiguous array of dtype the cython movers take: the
+    array itself when it is one already, as the spill container's data
+    arrays are, and a converted copy only when it isn't
+    '''
+    return np.ascontiguousarray(values, dtype=dtype)
+
+
+def world_points(positions):
+    '''
+    the Nx3 positions as the 1-d array of world_point the cython movers
+    take -- a view of them when they have its layout, see c_layout()
+    '''
+    positions = c_layout(positions, world_point_type)
+
+    return positions.view(dtype=world_point).reshape((len(positions),))
+
+
+def zero_world_points(sc, num):
+    '''
+    a zeroed 1-d array of num world_point from sc's scratch pool, for the
+    deltas of a step
+    '''
+    delta = scratch_zeros(sc, (num, len(world_point)), world_point_type)
+
+    return delta.view(dtype=world_point).reshape((num,))
 
 
 class ProcessSchema(MappingSchema):
@@ -132,12 +163,31 @@ class Process(AddLogger):
         self._check_active_startstop(self._active_start, value)
         self._active_stop = value
 
+    # the last time converted, the movers all convert the same model time
+    # a few times each step
+    _last_seconds = (None, None)
+
     def datetime_to_seconds(self, model_time):
         """
         Put the time conversion call here - in case we decide to change it, it
         only updates here
+
+        Seconds since the epoch, as date_to_sec gives them, are passed
+        through as they are.
         """
-        return time_utils.date_to_sec(model_time)
+        if isinstance(model_time, (int, long, np.integer)):
+            return model_time
+
+        if (not isinstance(model_time, datetime) or
+                model_time.tzinfo is not None):
+            return time_utils.date_to_sec(model_time)
+
+        last_time, seconds = Process._last_seconds
+        if model_time != last_time:
+            seconds = time_utils.date_to_sec(model_time)
+            Process._last_seconds = (model_time, seconds)
+
+        return seconds
 
     def prepare_for_model_run(self):
         """
@@ -162,14 +212,18 @@ class Process(AddLogger):
         :param model_time_datetime: current model time as datetime object
 
         """
-        if (self.active_start <=
-            (model_time_datetime + timedelta(seconds=time_step/2)) and
-            self.active_stop >=
-            (model_time_datetime + timedelta(seconds=time_step/2)) and
-            self.on):
-            self._active = True
-        else:
-            self._active = False
+        self._active = self.active_in_step(time_step, model_time_datetime)
+
+    def active_in_step(self, time_step, model_time_datetime):
+        """
+        whether the object is active in the time step from
+        model_time_datetime, as prepare_for_model_step() sets it
+        """
+        half_step = model_time_datetime + timedelta(seconds=time_step/2)
+
+        return (self.active_start <= half_step and
+                self.active_stop >= half_step and
+                self.on)
 
     def model_step_is_done(self, sc=None):
         """
@@ -204,6 +258,42 @@ class Mover(Process):
 
         return delta
 
+    def get_move_view(self, sc, view, time_step, model_time_datetime):
+        """
+        Adds the move to the positions of a
+        gnome.spill_container.ElementView, loaded with sc's elements, in
+        place of returning it from get_move
+
+        :returns: True if the move was added to view, False if the mover
+                  doesn't work on views and get_move() must be called
+
+        Base class returns False
+        """
+        return False
+
+    def prepare_forcing(self, time_step, model_time_datetime):
+        """
+        Reads what the step at model_time_datetime needs from the mover's
+        forcing and doesn't depend on the elements, before the step's
+        prepare_for_model_step(). With Model.pipeline_steps it is called on
+        a background thread while the step before weathers, so it must not
+        touch the spill containers - see gnome.utilities.step_pipeline
+
+        Base class does nothing
+        """
+        pass
+
+    def set_model_step_times(self, start_time, time_step, num_steps):
+        """
+        The times of the steps of the run prepare_for_model_run() prepares
+        next, for a mover that looks something up for all of them at once.
+        The model calls it just before; num_steps is None when the run has
+        no duration
+
+        Base class does nothing
+        """
+        pass
+
 class PyMover(Mover):
 
     def __init__(self,
@@ -213,8 +303,70 @@ class PyMover(Mover):
                             'Euler': self.get_delta_Euler,
                             'Trapezoid':self.get_delta_Trapezoid}
         self.default_num_method=default_num_method
+
+        # node values of the velocity fields by (id(field), time), for the
+        # stage times of the step being moved and the next one: the end of
+        # a step is the start of the next
+        self._node_values = {}
         Mover.__init__(self, **kwargs)
 
+    def prepare_for_model_run(self):
+        self._node_values = {}
+        super(PyMover, self).prepare_for_model_run()
+
+    def stage_times(self, time_step, model_time, num_method):
+        """
+        the times the stages of num_method read the velocities at, None for
+        the stages it doesn't have: (start, middle, end) of the step
+        """
+        dt = timedelta(seconds=time_step)
+
+        return {'Euler': (model_time, None, None),
+                'Trapezoid': (model_time, None, model_time + dt),
+                'RK4': (model_time, model_time + dt / 2,
+                        model_time + dt)}[num_method]
+
+    def node_values(self, vel_field, time):
+        """
+        vel_field.node_values() at time, read once for the steps that need
+        them
+        """
+        key = (id(vel_field), time)
+        if key not in self._node_values:
+            self._node_values[key] = \
+                vel_field.node_values(time,
+                                      extrapolate=getattr(self, 'extrapolate',
+                                                          False))
+
+        return self._node_values[key]
+
+    def _drop_node_values(self, model_time):
+        'forgets the node values of the times before model_time'
+        for key in [k for k in self._node_values if k[1] < model_time]:
+            del self._node_values[key]
+
+    def forcing_fields(self):
+        """
+        the velocity fields on the nodes of a triangle grid that the mover
+        reads - their node values are what prepare_forcing() reads
+
+        Base class has none
+        """
+        return []
+
+    def prepare_forcing(self, time_step, model_time_datetime):
+        """
+        reads the node values of forcing_fields() at the stage times of the
+        step at model_time_datetime
+        """
+        self._drop_node_values(model_time_datetime)
+
+        for vel_field in self.forcing_fields():
+            for t in self.stage_times(time_step, model_time_datetime,
+                                      self.default_num_method):
+                if t is not None:
+                    self.node_values(vel_field, t)
+
     def get_delta_Euler(self, sc, time_step, model_time, pos, vel_field):
         vels = vel_field.at(pos[:, 0:2], model_time, extrapolate=self.extrapolate)
         return vels * time_step
@@ -243,6 +395,14 @@ class PyMover(Mover):
 
 
 class CyMover(Mover):
+    # set by the classes whose cython mover does the same move in
+    # get_move_batch as in get_move, so get_move_view() can use it
+    uses_element_view = False
+
+    # set by the classes whose steps need nothing of Python besides what
+    # CyMover does (and the windages of the wind movers), so lib_gnome's
+    # RunTransportSteps can run them -- see Model.transport_fast_path
+    native_transport = False
 
     def __init__(self, **kwargs):
         """
@@ -295,12 +455,12 @@ class CyMover(Mover):
         super(CyMover, self).prepare_for_model_step(sc, time_step, model_time_datetime)
         if self.active:
             uncertain_spill_count = 0
-            uncertain_spill_size = np.array((0, ), dtype=np.int32)
+            uncertain_spill_size = np.array((0, ), dtype=np.int64)
 
             if sc.uncertain:
                 uncertain_spill_count = 1
                 uncertain_spill_size = np.array((sc.num_released, ),
-                                                dtype=np.int32)
+                                                dtype=np.int64)
 
             err = self.mover.prepare_for_model_step(
                         self.datetime_to_seconds(model_time_datetime),
@@ -338,6 +498,45 @@ class CyMover(Mover):
         return self.delta.view(dtype=world_point_type).reshape((-1,
                 len(world_point)))
 
+    def get_move_view(self, sc, view, time_step, model_time_datetime):
+        """
+        If the class sets uses_element_view, calls the cython mover's
+        get_move_batch on view's arrays and adds the move to view's next
+        positions. The C++ mover must do the same move in get_move_batch as
+        in get_move.
+
+        :param sc: spill_container.SpillContainer object
+        :param view: spill_container.ElementView loaded with sc's elements
+        :param time_step: time step in seconds
+        :param model_time_datetime: current model time as datetime object
+        """
+        if not self.uses_element_view:
+            return False
+
+        # only call get_move_batch if mover is active and there are LEs
+        if self.active and view.num > 0:
+            self.mover.get_move_batch(self.datetime_to_seconds(
+                                          model_time_datetime),
+                                      time_step,
+                                      view.lat, view.lon, view.z,
+                                      view.status,
+                                      view.delta_lat, view.delta_lon,
+                                      view.delta_z,
+                                      (spill_type.uncertainty if sc.uncertain
+                                       else spill_type.forecast),
+                                      self._view_windages(sc),
+                                      view.active)
+            view.add_delta()
+
+        return True
+
+    def _view_windages(self, sc):
+        '''
+        windages array passed to get_move_batch - None, the wind movers
+        override it
+        '''
+        return None
+
     def prepare_data_for_get_move(self, sc, model_time_datetime):
         """
         organizes the spill object into inputs for calling with Cython
@@ -348,10 +547,11 @@ class CyMover(Mover):
         """
         self.model_time = self.datetime_to_seconds(model_time_datetime)
 
-        # Get the data:
+        # Get the data, as views of the spill container's arrays:
         try:
-            self.positions = sc['positions']
-            self.status_codes = sc['status_codes']
+            self.positions = world_points(sc['positions'])
+            self.status_codes = c_layout(sc['status_codes'],
+                                         status_code_type)
         except KeyError, err:
             raise ValueError('The spill container does not have the required'
                              'data arrays\n' + err.message)
@@ -361,13 +561,7 @@ class CyMover(Mover):
         else:
             self.spill_type = spill_type.forecast
 
-        # Array is not the same size, change view and reshape
-
-        self.positions = \
-            self.positions.view(dtype=world_point).reshape(
-                                                    (len(self.positions),))
-        self.delta = np.zeros(len(self.positions),
-                              dtype=world_point)
+        self.delta = zero_world_points(sc, len(self.positions))
 
     def model_step_is_done(self, sc=None):
         """
@@ -379,7 +573,8 @@ class CyMover(Mover):
             if sc.uncertain:
                 if self.active:
                     try:
-                        self.status_codes = sc['status_codes']
+                        self.status_codes = c_layout(sc['status_codes'],
+                                                     status_code_type)
                     except KeyError, err:
                         raise ValueError('The spill container does not have'
                                          ' the required data array\n'
@@ -391,3 +586,130 @@ class CyMover(Mover):
         else:
             if self.active:
                 self.mover.model_step_is_done()
+
+
+class LazyForcing(object):
+    '''
+    Mixin for the CyMovers that read their forcing files as they are made.
+    The ones made with lazy=True -- as they are in a lazy load of a save
+    file -- read them the first time their cython mover is used instead,
+    so loading a model doesn't wait on reading all of its forcing.
+
+    The mixin must come before CyMover in the bases: it makes 'mover' a
+    property.
+    '''
+    _lazy_load = True
+
+    # the read of the forcing files put off, if there is one
+    _forcing_read = None
+
+    @property
+    def mover(self):
+        if self._forcing_read is not None:
+            read, self._forcing_read = self._forcing_read, None
+            read()
+
+        return self._mover
+
+    @mover.setter
+    def mover(self, mover):
+        self._mover = mover
+
+    def _read_forcing_or_defer(self, lazy, read, *args):
+        '''
+        read(\*args) now, or the first time the mover is used if lazy
+        '''
+        if lazy:
+            self._forcing_read = lambda: read(*args)
+        else:
+            read(*args)
+
+    @property
+    def forcing_loaded(self):
+        '''
+        False while the read of the forcing files is put off
+        '''
+        return self._forcing_read is None
+
+    @classmethod
+    def _restore_attr_from_save(cls, new_obj, dict_):
+        '''
+        the attributes of a save not set in __init__ are fields of the cython
+        mover, not of its forcing, so restoring them doesn't read it
+        '''
+        read, new_obj._forcing_read = new_obj._forcing_read, None
+        try:
+            super(LazyForcing, cls)._restore_attr_from_save(new_obj, dict_)
+        finally:
+            new_obj._forcing_read = read
+
+
+def get_move_fused(movers, sc, view, time_step, model_time_datetime):
+    """
+    Adds the moves of CyMovers that use the element view
+    (CyMover.uses_element_view) to view's next positions, like their
+    get_move_view() in turn, but in one pass of the cython get_move_fused:
+    each chunk of elements goes through all the movers before the next one.
+
+    :param movers: list of CyMover objects, the inactive ones are skipped
+    :param sc: spill_container.SpillContainer object
+    :param view: spill_container.ElementView loaded with sc's elements
+    :param time_step: time step in seconds
+    :param model_time_datetime: current model time as datetime object
+    """
+    movers = [m for m in movers if m.active]
+
+    if len(movers) == 0 or view.num == 0:
+        return
+
+    cy_mover.get_move_fused([m.mover for m in movers],
+                            movers[0].datetime_to_seconds(model_time_datetime),
+                            time_step,
+                            view.lat, view.lon, view.z, view.status,
+                            view.next_lat, view.next_lon, view.next_z,
+                            (spill_type.uncertainty if sc.uncertain
+                             else spill_type.forecast),
+                            [m._view_windages(sc) for m in movers],
+                            view.active)
+
+
+def get_move_ensemble(movers, sc, view, time_step, model_time_datetime,
+                      member_start, scales):
+    """
+    get_move_fused() for an ensemble: the elements in sc are the elements
+    of its members, one member after the other, and the move of each
+    element by each mover is scaled by the member's scale for the mover.
+    All the members are moved in the one pass, so each mover reads its
+    forcing once, not once per member.
+
+    :param movers: list of CyMover objects, the inactive ones are skipped
+    :param member_start: index of the first element of each member, and
+                         then the number of elements
+    :param scales: (number of members, number of movers) array of the scale
+                   of each member's move by each mover, e.g. its wind speed
+                   factor for the wind movers, its current scale for the
+                   current movers and 1 for the others
+    """
+    scales = np.asarray(scales, dtype=np.float64)
+    if scales.shape != (len(member_start) - 1, len(movers)):
+        raise ValueError('scales needs a row for each member and a column '
+                         'for each mover')
+
+    keep = [i for i, m in enumerate(movers) if m.active]
+    movers = [movers[i] for i in keep]
+
+    if len(movers) == 0 or view.num == 0:
+        return
+
+    model_time = movers[0].datetime_to_seconds(model_time_datetime)
+
+    cy_mover.get_move_ensemble([m.mover for m in movers], model_time,
+                               time_step,
+                               view.lat, view.lon, view.z, view.status,
+                               view.next_lat, view.next_lon, view.next_z,
+                               (spill_type.uncertainty if sc.uncertain
+                                else spill_type.forecast),
+                               [m._view_windages(sc) for m in movers],
+                               np.asarray(member_start, dtype=np.int64),
+                               scales[:, keep],
+                               view.active)
@@ -4,8 +4,10 @@ import datetime
 import copy
 from gnome import basic_types
 from gnome.environment import GridCurrent
+from gnome.environment.grid_locator import grid_integrator
 from gnome.utilities import serializable
 from gnome.utilities.projections import FlatEarthProjection
+from gnome.utilities.scratch import scratch_zeros
 from gnome.basic_types import oil_status
 from gnome.basic_types import (world_point,
                                world_point_type,
@@ -89,6 +91,51 @@ class PyGridCurrentMover(movers.PyMover, serializable.Serializable):
 
         return vels
 
+    def forcing_fields(self):
+        """
+        the current, if get_delta_on_grid() moves on its node values
+        """
+        if (self.current is None or
+                getattr(self.current, 'angle', None) is not None or
+                not hasattr(self.current, 'node_values') or
+                grid_integrator(self.current.grid, self) is None):
+            return []
+
+        return [self.current]
+
+    def get_delta_on_grid(self, time_step, model_time, pos, vel_field,
+                          num_method):
+        """
+        The move of get_delta_<num_method>, integrated in lib_gnome when the
+        velocities are on the nodes of a triangle grid: the stages are done
+        per element, in C. The velocity is 0 off the grid, as with
+        GridCurrentMover.
+
+        Returns None for the other grids, which are integrated in numpy.
+        """
+        if (getattr(vel_field, 'angle', None) is not None or
+                not hasattr(vel_field, 'node_values')):
+            return None
+
+        integrator = grid_integrator(vel_field.grid, self)
+        if integrator is None:
+            return None
+
+        self._drop_node_values(model_time)
+
+        velocities = []
+        for t in self.stage_times(time_step, model_time, num_method):
+            if t is None:
+                velocities.extend((None, None))
+                continue
+
+            values = self.node_values(vel_field, t)
+            if values is None:
+                return None
+            velocities.extend(values)
+
+        return integrator.get_moves(pos, time_step, num_method, *velocities)
+
     def get_move(self, sc, time_step, model_time_datetime, num_method=None):
         """
         Compute the move in (long,lat,z) space. It returns the delta move
@@ -106,19 +153,22 @@ class PyGridCurrentMover(movers.PyMover, serializable.Serializable):
 
         All movers must implement get_move() since that's what the model calls
         """
-        method = None
         if num_method is None:
-            method = self.num_methods[self.default_num_method]
-        else:
-            method = self.num_method[num_method]
+            num_method = self.default_num_method
+        method = self.num_methods[num_method]
 
         status = sc['status_codes'] != oil_status.in_water
         positions = sc['positions']
-        deltas = np.zeros_like(positions)
+        deltas = scratch_zeros(sc, positions.shape, positions.dtype)
         pos = positions[:, 0:2]
 
-        deltas[:, 0:2] = method(sc, time_step, model_time_datetime, pos, self.current)
+        delta = self.get_delta_on_grid(time_step, model_time_datetime, pos,
+                                       self.current, num_method)
+        if delta is None:
+            delta = method(sc, time_step, model_time_datetime, pos,
+                           self.current)
+        deltas[:, 0:2] = delta
 
-        deltas = FlatEarthProjection.meters_to_lonlat(deltas, positions)
+        FlatEarthProjection.meters_to_lonlat(deltas, positions, out=deltas)
         deltas[status] = (0, 0, 0)
         return deltas
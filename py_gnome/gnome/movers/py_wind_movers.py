@@ -5,6 +5,7 @@ import copy
 from gnome import basic_types
 from gnome.utilities import serializable, rand
 from gnome.utilities.projections import FlatEarthProjection
+from gnome.utilities.scratch import scratch_zeros
 from gnome.environment import GridWind
 from gnome.basic_types import oil_status
 from gnome.basic_types import (world_point,
@@ -145,13 +146,13 @@ class PyWindMover(movers.PyMover, serializable.Serializable):
 
         status = sc['status_codes'] != oil_status.in_water
         positions = sc['positions']
-        deltas = np.zeros_like(positions)
+        deltas = scratch_zeros(sc, positions.shape, positions.dtype)
         pos = positions[:, 0:2]
 
         deltas[:, 0:2] = method(sc, time_step, model_time_datetime, pos, self.wind)
         deltas[:,0] *= sc['windages']
         deltas[:,1] *= sc['windages']
 
-        deltas = FlatEarthProjection.meters_to_lonlat(deltas, positions)
+        FlatEarthProjection.meters_to_lonlat(deltas, positions, out=deltas)
         deltas[status] = (0, 0, 0)
         return deltas
@@ -36,6 +36,8 @@ class RandomMover(CyMover, Serializable):
     _state.add(update=['diffusion_coef', 'uncertain_factor'],
               save=['diffusion_coef', 'uncertain_factor'])
     _schema = RandomMoverSchema
+    uses_element_view = True
+    native_transport = True
 
     def __init__(self, **kwargs):
         """
@@ -80,6 +82,10 @@ class RandomMover(CyMover, Serializable):
 
 
 class IceAwareRandomMover(RandomMover):
+    # get_move scales the move by the ice concentration
+    uses_element_view = False
+    native_transport = False
+
     def __init__(self, *args, **kwargs):
         if 'ice_conc_var' in kwargs.keys():
             self.ice_conc_var = kwargs.pop('ice_conc_var')
@@ -22,7 +22,9 @@ from gnome.utilities import serializable, rand
 
 from gnome import environment
 from gnome.environment import Grid
-from gnome.movers import Mover, ProcessSchema
+from gnome.movers import (Mover, ProcessSchema, c_layout, world_points,
+                          zero_world_points)
+from gnome.utilities.scratch import scratch_zeros
 
 from gnome.persist.base_schema import ObjType
 
@@ -182,19 +184,16 @@ class ShipDriftMover(Mover, serializable.Serializable):
         """
         self.model_time = self.datetime_to_seconds(model_time_datetime)
 
-        # Get the data:
+        # Get the data, as views of the spill container's arrays:
         try:
-            self.positions = sc['positions']
-            self.status_codes = sc['status_codes']
+            self.positions = world_points(sc['positions'])
+            self.status_codes = c_layout(sc['status_codes'],
+                                         status_code_type)
         except KeyError, err:
             raise ValueError('The spill container does not have the required'
                              'data arrays\n' + err.message)
 
-        self.positions = \
-            self.positions.view(dtype=world_point).reshape(
-                                                    (len(self.positions),))
-        self.delta = np.zeros(len(self.positions),
-                              dtype=world_point)
+        self.delta = zero_world_points(sc, len(self.positions))
 
     def get_move(self, sc, time_step, model_time_datetime):
         """
@@ -209,7 +208,7 @@ class ShipDriftMover(Mover, serializable.Serializable):
         self.prepare_data_for_get_move(sc, model_time_datetime)
         #will need to override get_move using grid's get_values
 
-        vels = np.zeros(len(self.positions), dtype=velocity_rec)
+        vels = scratch_zeros(sc, len(self.positions), velocity_rec)
         in_water_mask = self.status_codes == oil_status.in_water
 
         if self.active and len(self.positions) > 0:
@@ -217,13 +216,20 @@ class ShipDriftMover(Mover, serializable.Serializable):
             #self.grid.grid.get_values(self.model_time, self.positions, vels)
             vel = self.grid.get_value(self.model_time, (-123.57152, 37.369436))
 
-            self.delta['lat'][in_water_mask] = vels['v'] * time_step
-            self.delta['long'][in_water_mask] = vels['u'] * time_step
+            # the elements in the water move, in meters, then in place to
+            # degrees
+            windages = sc['windages'][in_water_mask]
+            delta = self.delta.view(dtype=world_point_type).reshape((-1, 3))
 
-            self.delta['lat'][in_water_mask] *= sc['windages']
-            self.delta['long'][in_water_mask] *= sc['windages']
+            delta[in_water_mask, 0] = (vels['u'][in_water_mask] * time_step *
+                                       windages)
+            delta[in_water_mask, 1] = (vels['v'][in_water_mask] * time_step *
+                                       windages)
 
-            self.delta = projections.FlatEarthProjection.meters_to_lonlat(self.delta.view(dtype=np.float64).reshape(-1,3), self.positions.view(dtype=np.float64).reshape(-1,3))
+            projections.FlatEarthProjection.meters_to_lonlat(
+                delta,
+                self.positions.view(dtype=world_point_type).reshape((-1, 3)),
+                out=delta)
 
         return (self.delta.view(dtype=world_point_type)
                 .reshape((-1, len(world_point))))
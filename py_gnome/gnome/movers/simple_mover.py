@@ -20,6 +20,7 @@ from colander import (SchemaNode, Float)
 from gnome.basic_types import oil_status, mover_type
 from gnome.utilities.projections import FlatEarthProjection as proj
 from gnome.utilities import serializable
+from gnome.utilities.scratch import scratch_zeros
 
 from gnome.movers import Mover, ProcessSchema
 
@@ -121,7 +122,7 @@ class SimpleMover(Mover, serializable.Serializable):
 
         # compute the move
 
-        delta = np.zeros_like(positions)
+        delta = scratch_zeros(spill, positions.shape, positions.dtype)
 
         if self.active and self.on:
             delta[in_water_mask] = self.velocity * time_step
@@ -142,6 +143,6 @@ class SimpleMover(Mover, serializable.Serializable):
             # scale for projection
 
             # just the lat-lon...
-            delta = proj.meters_to_lonlat(delta, positions)
+            delta = proj.meters_to_lonlat(delta, positions, out=delta)
 
         return delta
@@ -1,133 +1,50 @@
 #!/usr/bin/env python
 
 """
-simple_mover.py
-
-This is an example mover class -- not really useful, but about as simple as
-can be, for testing and demonstration purposes
-
-It's a steady, uniform current -- one velocity and direction for everywhere
-at all time.
-
-
+tracpy_mover.py
+
+ROMS currents stepped the way TracPy steps them, without TracPy: the fields
+are read by lib_gnome's curvilinear grid reader, the elements find their
+cells from the ones they were in the step before, and the move is the
+batched 4th order Runge-Kutta of the GridCurrentMover. There is no grid
+set up in Python and no array copied each step, so a run costs what the
+same file costs a GridCurrentMover.
 """
 
-import copy
-
-import numpy as np
-from numpy import random
-
 from gnome import basic_types
-from gnome.movers import Mover
-from gnome.utilities.projections import FlatEarthProjection as proj
-from gnome.utilities import serializable
-
-
-class SimpleMover(Mover, serializable.Serializable):
-
-    """
-    simple_mover
-    
-    a really simple mover -- moves all LEs a constant speed and direction
-    
-    (not all that different than a constant wind mover, now that I think about it)    
-    """
-
-    _state = copy.deepcopy(Mover._state)
-    _state.add(update=['uncertainty_scale', 'velocity'],
-              save=['uncertainty_scale', 'velocity'])
-
-    def __init__(
-        self,
-        velocity,
-        uncertainty_scale=0.5,
-        **kwargs
-        ):
+from gnome.movers.current_movers import GridCurrentMover
+from gnome.cy_gnome.cy_gridcurrent_mover import CyGridCurrentMover
+
+
+class TracPyMover(GridCurrentMover):
+    '''
+    A GridCurrentMover for the ROMS output TracPy takes, integrated RK4 as
+    TracPy does by default
+    '''
+    def __init__(self, filename,
+                 topology_file=None,
+                 num_method=basic_types.numerical_methods.rk4,
+                 **kwargs):
         """
-        simple_mover (velocity)
+        :param filename: the ROMS output: a NetCDF file or a file list of
+                         them, with the grid and the velocities on it
+        :param topology_file=None: the grid's topology, made from the data
+                                   file if not given
 
-        create a simple_mover instance
+        :param num_method=rk4: the numerical method, as a GridCurrentMover's.
+                               Adaptive takes an Euler step for the elements
+                               that stay in their cell.
 
-        :param velocity: a (u, v, w) triple -- in meters per second
-        
-        Remaining kwargs are passed onto Mover's __init__ using super. 
-        See Mover documentation for remaining valid kwargs.
+        Remaining kwargs are passed onto GridCurrentMover's __init__. See its
+        documentation for the remaining valid kwargs.
         """
+        self.mover = CyGridCurrentMover()
 
-        self.velocity = np.asarray(velocity,
-                                   dtype=basic_types.mover_type).reshape((3,
-                ))  # use this, to be compatible with whatever we are using for location
-        self.uncertainty_scale = uncertainty_scale
-        super(SimpleMover, self).__init__(**kwargs)
+        super(TracPyMover, self).__init__(filename,
+                                          topology_file=topology_file,
+                                          num_method=num_method,
+                                          **kwargs)
 
     def __repr__(self):
-        return 'SimpleMover(<%s>)' % self.id
-
-    def velocity_to_dict(self):
-        """
-        convert velocity back into a tuple
-        """
-
-        return tuple(self.velocity.tolist())
-
-    def get_move(
-        self,
-        spill,
-        time_step,
-        model_time,
-        ):
-        """
-        moves the particles defined in the spill object
-        
-        :param spill: spill is an instance of the gnome.spill.Spill class
-        :param time_step: time_step in seconds
-        :param model_time: current model time as a datetime object
-        In this case, it uses the:
-            positions
-            status_code
-        data arrays.
-        
-        :returns delta: Nx3 numpy array of movement -- in (long, lat, meters) units
-        
-        """
-
-        # Get the data:
-
-        try:
-            positions = spill['positions']
-            status_codes = spill['status_codes']
-        except KeyError, err:
-            raise ValueError('The spill does not have the required data arrays\n'
-                              + err.message)
-
-        # which ones should we move?
-
-        in_water_mask = status_codes == basic_types.oil_status.in_water
-
-        # compute the move
-
-        delta = np.zeros_like(positions)
-
-        if self.active and self.on:
-            delta[in_water_mask] = self.velocity * time_step
-
-            # add some random stuff if uncertainty is on
-
-            if spill.uncertain:
-                num = sum(in_water_mask)
-                scale = self.uncertainty_scale * self.velocity \
-                    * time_step
-                delta[in_water_mask, 0] += random.uniform(-scale[0],
-                        scale[0], num)
-                delta[in_water_mask, 1] += random.uniform(-scale[1],
-                        scale[1], num)
-                delta[in_water_mask, 2] += random.uniform(-scale[2],
-                        scale[2], num)
-
-            # scale for projection
-
-            delta = proj.meters_to_lonlat(delta, positions)  # just the lat-lon...
-
-        return delta
-
-
+        return ('TracPyMover(filename={0}, num_method={1})'
+                .format(self.filename, self.num_method))
@@ -5,6 +5,7 @@ import copy
 from gnome import basic_types
 from gnome.utilities import serializable
 from gnome.utilities.projections import FlatEarthProjection
+from gnome.environment.grid_locator import grid_integrator
 from gnome.basic_types import oil_status
 from gnome.basic_types import (world_point,
                                world_point_type,
@@ -82,11 +83,23 @@ class UGridCurrentMover(movers.Mover, serializable.Serializable):
         status = sc['status_codes'] != oil_status.in_water
         positions = sc['positions']
 
-        vels = self.grid.interpolated_velocities(model_time_datetime, positions[:, 0:2])
         deltas = np.zeros_like(positions)
-        deltas[:] = 0.
-        deltas[:, 0:2] = vels * time_step
-        deltas = FlatEarthProjection.meters_to_lonlat(deltas, positions)
+
+        # the velocities on the nodes of a triangle grid are moved in lib_gnome
+        integrator = grid_integrator(self.grid.grid, self)
+        if integrator is not None:
+            u, v = self.grid.node_velocities(model_time_datetime)
+            if len(u) != integrator.locator.num_nodes:
+                integrator = None
+
+        if integrator is not None:
+            deltas[:, 0:2] = integrator.get_moves(positions, time_step,
+                                                  'Euler', u, v)
+        else:
+            vels = self.grid.interpolated_velocities(model_time_datetime,
+                                                     positions[:, 0:2])
+            deltas[:, 0:2] = vels * time_step
+        FlatEarthProjection.meters_to_lonlat(deltas, positions, out=deltas)
         deltas[status] = (0, 0, 0)
         pass
         return deltas
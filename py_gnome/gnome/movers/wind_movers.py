@@ -15,14 +15,17 @@ from gnome.basic_types import (ts_format,
                                world_point,
                                world_point_type,
                                velocity_rec,
+                               windage_type,
                                datetime_value_2d)
 
-from gnome.utilities import serializable, rand
+from gnome.utilities import serializable
 from gnome.utilities import time_utils
+from gnome.utilities.setup_profile import setup_stage
+from gnome.utilities.remote_data import data_path_exists
 
 from gnome import environment
-from gnome.movers import CyMover, ProcessSchema
-from gnome.cy_gnome.cy_wind_mover import CyWindMover
+from gnome.movers import CyMover, LazyForcing, ProcessSchema, c_layout
+from gnome.cy_gnome.cy_wind_mover import CyWindMover, update_windages
 from gnome.cy_gnome.cy_gridwind_mover import CyGridWindMover
 from gnome.cy_gnome.cy_ice_wind_mover import CyIceWindMover
 
@@ -153,11 +156,16 @@ class WindMoversBase(CyMover):
         if sc.num_released is None  or sc.num_released == 0:
             return
 
-        rand.random_with_persistance(sc['windage_range'][:, 0],
-                                     sc['windage_range'][:, 1],
-                                     sc['windages'],
-                                     sc['windage_persist'],
-                                     time_step)
+        # in place, keyed on the model time: each wind mover of the step
+        # draws the same windages
+        update_windages(sc['id'],
+                        sc['windage_range'],
+                        sc['windage_persist'],
+                        sc['windages'],
+                        time_step,
+                        self.datetime_to_seconds(model_time_datetime),
+                        stream=int(sc.uncertain),
+                        num_threads=self.mover.num_threads)
 
     def get_move(self, sc, time_step, model_time_datetime):
         """
@@ -176,13 +184,16 @@ class WindMoversBase(CyMover):
                                 time_step,
                                 self.positions,
                                 self.delta,
-                                sc['windages'],
+                                c_layout(sc['windages'], windage_type),
                                 self.status_codes,
                                 self.spill_type)
 
         return (self.delta.view(dtype=world_point_type)
                 .reshape((-1, len(world_point))))
 
+    def _view_windages(self, sc):
+        return c_layout(sc['windages'], windage_type)
+
     def _state_as_str(self):
         '''
             Returns a string containing properties of object.
@@ -212,6 +223,8 @@ class WindMover(WindMoversBase, serializable.Serializable):
     _state.add_field(serializable.Field('wind', save=True, update=True,
                                         save_reference=True))
     _schema = WindMoverSchema
+    uses_element_view = True
+    native_transport = True
 
     def __init__(self, wind=None, extrapolate=False, **kwargs):
     #def __init__(self, wind=None, **kwargs):
@@ -370,7 +383,7 @@ class GridWindMoverSchema(WindMoversBaseSchema):
     extrapolate = SchemaNode(Bool(), missing=drop)
 
 
-class GridWindMover(WindMoversBase, serializable.Serializable):
+class GridWindMover(LazyForcing, WindMoversBase, serializable.Serializable):
     _state = copy.deepcopy(WindMoversBase._state)
     _state.add(update=['wind_scale', 'extrapolate'], save=['wind_scale', 'extrapolate'])
     _state.add_field([serializable.Field('wind_file', save=True,
@@ -381,7 +394,7 @@ class GridWindMover(WindMoversBase, serializable.Serializable):
     _schema = GridWindMoverSchema
 
     def __init__(self, wind_file, topology_file=None,
-                 extrapolate=False, time_offset=0,
+                 extrapolate=False, time_offset=0, lazy=False,
                  **kwargs):
         """
         :param wind_file: file containing wind data on a grid
@@ -391,12 +404,14 @@ class GridWindMover(WindMoversBase, serializable.Serializable):
         :param extrapolate: Allow current data to be extrapolated before and
                             after file data
         :param time_offset: Time zone shift if data is in GMT
+        :param lazy: Default is False. Read wind_file the first time the
+                     mover is used, not here.
 
         Pass optional arguments to base class
         uses super: super(GridWindMover,self).__init__(\*\*kwargs)
         """
 
-        if not os.path.exists(wind_file):
+        if not data_path_exists(wind_file):
             raise ValueError('Path for wind file does not exist: {0}'
                              .format(wind_file))
 
@@ -412,7 +427,13 @@ class GridWindMover(WindMoversBase, serializable.Serializable):
         self.name = os.path.split(wind_file)[1]
         super(GridWindMover, self).__init__(**kwargs)
 
-        self.mover.text_read(wind_file, topology_file)
+        self._read_forcing_or_defer(lazy, self._read_forcing, wind_file,
+                                    topology_file, extrapolate, time_offset)
+
+    def _read_forcing(self, wind_file, topology_file, extrapolate,
+                      time_offset):
+        with setup_stage(self, 'read'):
+            self.mover.text_read(wind_file, topology_file)
         self.real_data_start = time_utils.sec_to_datetime(self.mover.get_start_time())
         self.real_data_stop = time_utils.sec_to_datetime(self.mover.get_end_time())
         self.mover.extrapolate_in_time(extrapolate)
@@ -535,7 +556,7 @@ class IceWindMover(WindMoversBase, serializable.Serializable):
         if type(self) == IceWindMover:
             self.mover = CyIceWindMover()
 
-        if not os.path.exists(filename):
+        if not data_path_exists(filename):
             raise ValueError('Path for current file does not exist: {0}'
                              .format(filename))
 
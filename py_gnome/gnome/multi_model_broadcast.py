@@ -1,13 +1,18 @@
 
 import sys
 import os
+import shutil
 import psutil
 import time
 import traceback
 import logging
+import argparse
+import tempfile
+import subprocess
 
 from cPickle import loads, dumps
 import uuid
+from collections import deque
 
 import multiprocessing as mp
 
@@ -18,6 +23,87 @@ from zmq.eventloop import ioloop, zmqstream
 from gnome import GnomeId
 from gnome.environment import Wind
 from gnome.outputters import WeatheringOutput
+from gnome.persist import load
+from gnome.movers import LazyForcing
+from gnome.cy_gnome import cy_helpers
+from gnome.utilities.shared_arrays import (shared_filename,
+                                           SharedArrayWriter,
+                                           SharedArrayReader,
+                                           FrameWriter,
+                                           FrameReader)
+
+
+def data_filename(task_port, ipc_folder='.'):
+    '''
+        the shared file the results of the consumer on task_port are
+        passed in
+    '''
+    return shared_filename('Data-{0}'.format(task_port), ipc_folder)
+
+
+def connect_worker(context, task_port, ipc_folder='.', endpoint=None):
+    '''
+        the request socket of a ModelConsumer and the reader of its
+        results: over its ipc socket with the results in its shared file,
+        or, with the endpoint of a worker on another host, like
+        'tcp://node3:5600', over the network with the arrays of the
+        results in frames of their own
+    '''
+    task = context.socket(zmq.REQ)
+
+    if endpoint is None:
+        task.connect('ipc://{0}/Task-{1}'.format(ipc_folder, task_port))
+        reader = SharedArrayReader(data_filename(task_port, ipc_folder))
+    else:
+        task.connect(endpoint)
+        reader = FrameReader()
+
+    return task, reader
+
+
+def close_readers(readers):
+    for r in readers:
+        r.close()
+        if r.filename is not None:
+            try:
+                os.remove(r.filename)
+            except OSError:
+                pass
+
+
+def zipped_model(model):
+    '''
+        the bytes of a zip file save of model, for the workers on other
+        hosts, which don't see our files
+    '''
+    saveloc = tempfile.mkdtemp(prefix='gnome_model_')
+
+    zipsave = model.zipsave
+    model.zipsave = True
+    try:
+        model.save(saveloc, name='Model.zip')
+
+        with open(os.path.join(saveloc, 'Model.zip'), 'rb') as f:
+            return f.read()
+    finally:
+        model.zipsave = zipsave
+        shutil.rmtree(saveloc, ignore_errors=True)
+
+
+def available_cpus():
+    '''
+        the CPUs this process may run on
+    '''
+    proc = psutil.Process(os.getpid())
+    try:
+        return proc.cpu_affinity()
+    except AttributeError:
+        try:
+            # deprecated psutil API
+            return proc.get_cpu_affinity()
+        except AttributeError:
+            # not supported on this platform
+            return None
 
 
 class ModelConsumer(mp.Process):
@@ -36,16 +122,32 @@ class ModelConsumer(mp.Process):
              )
         - Attempt to perform the registered command.  Registered commands
           are defined as private methods of this class.
-        - Returns the results in a results queue
-
+        - Returns the results in a results queue.  The numpy arrays of
+          the results are put in a shared file (see shared_arrays), and
+          only the rest of them is pickled and sent back.
+
+        With a cpu, the process is pinned to that CPU, so it keeps its
+        caches for the life of the process.
+
+        With an endpoint, like 'tcp://*:5600', the consumer is a worker
+        for the clients on other hosts: it binds the endpoint instead of
+        its ipc socket, and sends the arrays of its results in frames of
+        their own (see shared_arrays.FrameWriter).  Its models are sent to
+        it zipped (receive_model).  worker_main() runs one.
     '''
     def __init__(self, task_port, model,
-                 ipc_folder='.'):
+                 ipc_folder='.', cpu=None, endpoint=None):
         mp.Process.__init__(self)
 
         self.task_port = task_port
         self.model = model
         self.ipc_folder = ipc_folder
+        self.cpu = cpu
+        self.endpoint = endpoint
+
+        # where the models sent to a worker are kept
+        self.model_dir = None
+        self.received_model = None
 
     def run(self):
         print '{0}: starting...'.format(self.name)
@@ -60,13 +162,21 @@ class ModelConsumer(mp.Process):
         [root_logger.removeHandler(h) for h in handler_list]
 
         self.cleanup_inherited_files()
+        self.set_cpu_affinity()
 
         context = zmq.Context()
 
         self.loop = ioloop.IOLoop.instance()
 
         sock = context.socket(zmq.REP)
-        sock.bind('ipc://{0}/Task-{1}'.format(self.ipc_folder, self.task_port))
+        if self.endpoint is None:
+            self.transport = SharedArrayWriter(data_filename(self.task_port,
+                                                             self.ipc_folder))
+            sock.bind('ipc://{0}/Task-{1}'.format(self.ipc_folder,
+                                                  self.task_port))
+        else:
+            self.transport = FrameWriter()
+            sock.bind(self.endpoint)
 
         # We need to create a stream from our socket and
         # register a callback for recv events.
@@ -77,6 +187,9 @@ class ModelConsumer(mp.Process):
 
         sock.close()
         context.destroy(linger=0)
+        self.transport.close()
+        if self.model_dir is not None:
+            shutil.rmtree(self.model_dir, ignore_errors=True)
         print '{0}: exiting...'.format(self.name)
 
     def cleanup_inherited_files(self):
@@ -87,6 +200,21 @@ class ModelConsumer(mp.Process):
             # deprecated psutil API
             [os.close(c.fd) for c in proc.get_connections()]
 
+    def set_cpu_affinity(self):
+        if self.cpu is None:
+            return
+
+        proc = psutil.Process(os.getpid())
+        try:
+            proc.cpu_affinity([self.cpu])
+        except AttributeError:
+            try:
+                # deprecated psutil API
+                proc.set_cpu_affinity([self.cpu])
+            except AttributeError:
+                # not supported on this platform, so we just don't pin
+                pass
+
     def handle_cmd(self, msg):
         '''
             the IOLoop only uses recv_multipart(), so we will always get
@@ -101,13 +229,80 @@ class ModelConsumer(mp.Process):
                 cmd, args = cmd[:2]
                 res = getattr(self, '_' + cmd)(**args)
 
-                self.stream.send_unicode(dumps(res))
+                self.stream.send_multipart(self.transport.dumps_frames(res),
+                                           copy=False)
             except:
                 exc_type, exc_value, exc_traceback = sys.exc_info()
                 fmt = traceback.format_exception(exc_type, exc_value,
                                                  exc_traceback)
 
-                self.stream.send_unicode(dumps(fmt))
+                self.stream.send_multipart(self.transport.dumps_frames(fmt),
+                                           copy=False)
+
+    def _load_model(self, saveloc):
+        '''
+            replaces the model with the one saved in saveloc, so the
+            process can run another model without being forked again
+        '''
+        self.model = load(saveloc)
+        return self.model is not None
+
+    def _receive_model(self, data):
+        '''
+            keeps the zipped save of a model sent from another host, for
+            load_model and start_member, in place of the one sent before,
+            and returns where it is
+        '''
+        if self.model_dir is None:
+            self.model_dir = tempfile.mkdtemp(prefix='gnome_worker_')
+
+        if self.received_model is not None:
+            os.remove(self.received_model)
+
+        self.received_model = os.path.join(self.model_dir,
+                                           'Model-{0}.zip'
+                                           .format(uuid.uuid4()))
+        with open(self.received_model, 'wb') as f:
+            f.write(data)
+
+        return self.received_model
+
+    def _start_member(self, saveloc,
+                      wind_speed_uncertainty,
+                      spill_amount_uncertainty):
+        '''
+            loads a fresh copy of the model saved in saveloc for a member
+            of an ensemble, and sets it up the way the ModelBroadcaster sets
+            up its models.  The uncertainties change the model for good, so
+            each member needs its own copy.
+        '''
+        if not self._load_model(saveloc):
+            raise ValueError('no model saved in {0}'.format(saveloc))
+
+        self._set_spill_container_uncertainty(False)
+        self._set_wind_speed_uncertainty(wind_speed_uncertainty)
+        self._set_spill_amount_uncertainty(spill_amount_uncertainty)
+        self._set_cache_enabled(False)
+        self._set_weathering_output_only()
+        self.model.rewind()
+
+        return self.model.num_time_steps
+
+    def _step_batch(self, num_steps):
+        '''
+            runs up to num_steps steps, stopping at the end of the run
+        '''
+        results = []
+        for _i in range(num_steps):
+            try:
+                results.append(self._step())
+            except StopIteration:
+                break
+
+        done = (len(results) < num_steps or
+                self.model.current_time_step >= self.model.num_time_steps - 1)
+
+        return {'results': results, 'done': done}
 
     def _rewind(self):
         return self.model.rewind()
@@ -196,35 +391,87 @@ class ModelBroadcaster(GnomeId):
 
         More specifically, the model variations we are interested in are
         uncertainty variations.
+
+        With share_map, a raster map's land bitmap is packed and put in
+        shared memory before the consumers are forked, so they all read
+        one copy of it (see RasterMap.share_bitmap)
+
+        With share_grids, the lib_gnome grids the model's movers have set up
+        -- their points, topology and DAG trees -- are moved to a shared
+        memory segment before the consumers are forked, mapped read only,
+        so they all read one copy of them however their pages are touched
+        (see cy_helpers.share_handle_blocks). The models of set_model()
+        are loaded in the consumers, and don't share theirs.
+
+        With pin_cpus, each consumer is pinned to one of the CPUs we may
+        run on, in turn.
+
+        The consumers live until stop() is called, and set_model() gives
+        them a new model to run, so a service running many models does
+        not need to fork a set of processes for each.
+
+        With endpoints, one for each variation, the variations run on the
+        workers there (see RemoteWorkers) instead of on consumers forked
+        here, and the model is sent to them zipped.  The map and grids are
+        not shared with them.
     '''
     def __init__(self, model,
                  wind_speed_uncertainties,
                  spill_amount_uncertainties,
-                 ipc_folder='.'):
+                 ipc_folder='.',
+                 share_map=False,
+                 share_grids=False,
+                 pin_cpus=False,
+                 endpoints=None):
         self.model = model
         self.ipc_folder = ipc_folder
+        self.pin_cpus = pin_cpus
+        self.endpoints = endpoints
+        self.wind_speed_uncertainties = wind_speed_uncertainties
+        self.spill_amount_uncertainties = spill_amount_uncertainties
         self.context = None
         self.consumers = []
         self.tasks = []
+        self.readers = []
         self.lookup = {}
 
         self._get_available_ports(wind_speed_uncertainties,
                                   spill_amount_uncertainties)
-        self._spawn_consumers()
-        self._spawn_tasks()
 
-        for wsu in wind_speed_uncertainties:
-            for sau in spill_amount_uncertainties:
-                self._set_uncertainty(wsu, sau)
+        if endpoints is None:
+            if share_map and hasattr(model.map, 'share_bitmap'):
+                model.map.share_bitmap()
 
-        for i in range(len(self.tasks)):
-            self._set_new_cache_dir(i)
-            self._disable_cache(i)
-            self._set_weathering_output_only(i)
+            if share_grids:
+                self._share_grids()
+
+            self._spawn_consumers()
+        elif len(endpoints) != len(self.task_ports):
+            raise ValueError('{0} endpoints for {1} variations'
+                             .format(len(endpoints), len(self.task_ports)))
+
+        self._spawn_tasks()
+        if endpoints is not None:
+            self._send_model(model)
+        self._setup_models()
 
     def __del__(self):
         self.stop()
 
+    def _share_grids(self):
+        for mover in self.model.movers:
+            if isinstance(mover, LazyForcing):
+                # reads the forcing put off by a lazy load, so the consumers
+                # don't each read it
+                mover.mover
+
+        name = '/gnome_grids_{0}_{1}'.format(os.getpid(), uuid.uuid4().hex)
+        try:
+            cy_helpers.share_handle_blocks(name)
+        except OSError:
+            logging.warning('the grids could not be shared, each model '
+                            'consumer has its own copy')
+
     def _get_available_ports(self,
                              wind_speed_uncertainties,
                              spill_amount_uncertainties):
@@ -238,41 +485,109 @@ class ModelBroadcaster(GnomeId):
                 idx += 1
 
     def _spawn_consumers(self):
-        for p in self.task_ports:
-            model_consumer = ModelConsumer(p, self.model, self.ipc_folder)
+        cpus = available_cpus() if self.pin_cpus else None
+
+        for i, p in enumerate(self.task_ports):
+            cpu = cpus[i % len(cpus)] if cpus else None
+
+            model_consumer = ModelConsumer(p, self.model, self.ipc_folder,
+                                           cpu=cpu)
             model_consumer.start()
             self.consumers.append(model_consumer)
 
     def _spawn_tasks(self):
         self.context = zmq.Context()
 
-        for p in self.task_ports:
-            task = self.context.socket(zmq.REQ)
-            task.connect('ipc://{0}/Task-{1}'.format(self.ipc_folder, p))
+        for i, p in enumerate(self.task_ports):
+            endpoint = (self.endpoints[i] if self.endpoints is not None
+                        else None)
+            task, reader = connect_worker(self.context, p, self.ipc_folder,
+                                          endpoint)
 
             self.tasks.append(task)
+            self.readers.append(reader)
+
+    def _send_model(self, model):
+        '''
+            sends the workers the model zipped, and has each load it
+        '''
+        savelocs = self.cmd('receive_model', dict(data=zipped_model(model)))
+
+        for t, saveloc in zip(self.tasks, savelocs):
+            t.send(dumps(('load_model', dict(saveloc=saveloc))))
+
+        return [self._recv(i) for i in range(len(self.tasks))]
+
+    def _setup_models(self):
+        for wsu in self.wind_speed_uncertainties:
+            for sau in self.spill_amount_uncertainties:
+                self._set_uncertainty(wsu, sau)
+
+        for i in range(len(self.tasks)):
+            self._set_new_cache_dir(i)
+            self._disable_cache(i)
+            self._set_weathering_output_only(i)
+
+    def _recv(self, idx):
+        return self.readers[idx].loads_frames(
+            self.tasks[idx].recv_multipart(copy=False))
 
     def cmd(self, command, args, key=None, idx=None, in_parallel=True):
         request = dumps((command, args))
 
         if idx is not None:
             self.tasks[idx].send(request)
-            return loads(self.tasks[idx].recv())
+            return self._recv(idx)
         elif key is not None:
             idx = self.lookup[key]
             self.tasks[idx].send(request)
-            return loads(self.tasks[idx].recv())
+            return self._recv(idx)
         else:
             if in_parallel:
                 [t.send(request) for t in self.tasks]
-                return [loads(t.recv()) for t in self.tasks]
+                return [self._recv(i) for i in range(len(self.tasks))]
             else:
                 out = []
-                for t in self.tasks:
+                for i, t in enumerate(self.tasks):
                     t.send(request)
-                    out.append(loads(t.recv()))
+                    out.append(self._recv(i))
                 return out
 
+    def set_model(self, model):
+        '''
+            Gives the consumers a new model to run, with the same
+            uncertainty variations.
+
+            The model is saved to the ipc folder, and each consumer loads
+            its own copy of it, which is much cheaper than forking new
+            processes.  The map is loaded from its file, so a shared map
+            bitmap is not shared by the new models.  Workers on other hosts
+            are sent the model zipped.
+        '''
+        if self.endpoints is not None:
+            res = self._send_model(model)
+        else:
+            saveloc = os.path.join(self.ipc_folder,
+                                   'Model-{0}'.format(uuid.uuid4()))
+            os.mkdir(saveloc)
+
+            zipsave = model.zipsave
+            model.zipsave = False
+            try:
+                model.save(saveloc)
+
+                res = self.cmd('load_model', dict(saveloc=saveloc))
+            finally:
+                model.zipsave = zipsave
+                shutil.rmtree(saveloc, ignore_errors=True)
+
+        if not all([r is True for r in res]):
+            raise ValueError('consumers failed to load the model: '
+                             '{0}'.format(res))
+
+        self.model = model
+        self._setup_models()
+
     def stop(self):
         [t.send(dumps(None)) for t in self.tasks]
         [t.close() for t in self.tasks]
@@ -283,8 +598,11 @@ class ModelBroadcaster(GnomeId):
 
         self.context.destroy()
 
+        close_readers(self.readers)
+
         self.consumers = []
         self.tasks = []
+        self.readers = []
         self.lookup = {}
 
     def _set_uncertainty(self,
@@ -311,3 +629,342 @@ class ModelBroadcaster(GnomeId):
 
     def _set_weathering_output_only(self, idx):
         self.cmd('set_weathering_output_only', {}, idx=idx)
+
+
+
+class EnsembleScheduler(object):
+    '''
+        Runs an ensemble of uncertainty variations of a model on a fixed
+        pool of consumer processes.
+
+        The ModelBroadcaster runs each variation in a process of its own,
+        all in lock step.  Here the members are queued on the workers
+        instead, and run a batch of steps at a time: when a worker has
+        run all of its own members it steals a member that has not been
+        started from the back of the longest queue, so members that finish
+        early do not leave their CPUs idle.  A member that has started
+        stays on its worker, which has its state.
+
+        run() yields the results of each batch as it comes in, and
+        progress has how far each member has got.
+
+        The members can be spread over the workers of other hosts too (see
+        RemoteWorkers), so an ensemble doesn't need to fit on one: their
+        endpoints are workers after the local ones.
+    '''
+    def __init__(self, model, members,
+                 num_workers=None,
+                 batch_steps=8,
+                 ipc_folder='.',
+                 pin_cpus=False,
+                 endpoints=()):
+        '''
+        :param model: the model the members are variations of
+        :param members: (wind_speed_uncertainty, spill_amount_uncertainty)
+                        of each member, like the keys of a ModelBroadcaster
+        :param num_workers=None: the number of local processes, by default
+                                 the number of CPUs, or none with
+                                 endpoints
+        :param batch_steps=8: the number of steps a member runs for each
+                              of its results
+        :param endpoints=(): the endpoints of workers on other hosts
+
+        There are not more workers than members: the remote ones are
+        dropped first.
+        '''
+        self.members = [tuple(m) for m in members]
+        self.batch_steps = batch_steps
+        self.ipc_folder = ipc_folder
+        self.context = None
+        self.consumers = []
+        self.tasks = []
+        self.readers = []
+        self.busy = []
+
+        if num_workers is None:
+            num_workers = 0 if endpoints else mp.cpu_count()
+        num_workers = min(num_workers, len(self.members))
+        endpoints = list(endpoints)[:len(self.members) - num_workers]
+        if num_workers + len(endpoints) == 0:
+            num_workers = 1
+
+        # members are dealt to the workers' queues in turn
+        num_queues = num_workers + len(endpoints)
+        self.queues = [deque(range(i, len(self.members), num_queues))
+                       for i in range(num_queues)]
+
+        # (steps run, steps in the run) of each member -- the steps in the
+        # run are None until it has started
+        self.progress = [(0, None) for _m in self.members]
+
+        # the model the workers load a copy of for each member
+        self.saveloc = os.path.join(ipc_folder,
+                                    'Model-{0}'.format(uuid.uuid4()))
+        os.mkdir(self.saveloc)
+
+        zipsave = model.zipsave
+        model.zipsave = False
+        try:
+            model.save(self.saveloc)
+        finally:
+            model.zipsave = zipsave
+
+        # where each worker loads the members' model from
+        self.savelocs = []
+
+        self._spawn_workers(model, num_workers, pin_cpus)
+        self._connect_workers(model, endpoints)
+
+    def __del__(self):
+        self.stop()
+
+    def _spawn_workers(self, model, num_workers, pin_cpus):
+        cpus = available_cpus() if pin_cpus else None
+        self.context = zmq.Context()
+
+        for i in range(num_workers):
+            port = uuid.uuid4()
+            cpu = cpus[i % len(cpus)] if cpus else None
+
+            consumer = ModelConsumer(port, model, self.ipc_folder, cpu=cpu)
+            consumer.start()
+            self.consumers.append(consumer)
+
+            task, reader = connect_worker(self.context, port,
+                                          self.ipc_folder)
+            self.tasks.append(task)
+            self.readers.append(reader)
+            self.busy.append(False)
+            self.savelocs.append(self.saveloc)
+
+    def _connect_workers(self, model, endpoints):
+        '''
+            connects to the workers on other hosts, and sends them the
+            model
+        '''
+        if not endpoints:
+            return
+
+        data = zipped_model(model)
+        first = len(self.tasks)
+
+        for endpoint in endpoints:
+            task, reader = connect_worker(self.context, None,
+                                          endpoint=endpoint)
+            self.tasks.append(task)
+            self.readers.append(reader)
+            self.busy.append(False)
+
+        for idx in range(first, len(self.tasks)):
+            self._send(idx, 'receive_model', dict(data=data))
+        for idx in range(first, len(self.tasks)):
+            self.savelocs.append(self._recv(idx))
+
+    def _next_member(self, idx):
+        '''
+            the next member for worker idx: the front of its own queue, or
+            else the back of the longest one
+        '''
+        if self.queues[idx]:
+            return self.queues[idx].popleft()
+
+        victim = max(self.queues, key=len)
+        if victim:
+            return victim.pop()
+
+        return None
+
+    def _send(self, idx, command, args):
+        self.tasks[idx].send(dumps((command, args)))
+        self.busy[idx] = True
+
+    def _recv(self, idx):
+        res = self.readers[idx].loads_frames(
+            self.tasks[idx].recv_multipart(copy=False))
+        self.busy[idx] = False
+
+        if isinstance(res, list):
+            # the consumer sends back the traceback of a failed command
+            raise RuntimeError(''.join(res))
+
+        return res
+
+    def _start(self, idx, member):
+        wsu, sau = self.members[member]
+        self._send(idx, 'start_member',
+                   dict(saveloc=self.savelocs[idx],
+                        wind_speed_uncertainty=wsu,
+                        spill_amount_uncertainty=sau))
+
+    def run(self):
+        '''
+            Runs all the members, yielding (member, results) as each batch
+            of steps comes in, where member is the index of the member and
+            results are the outputs of its steps in the batch.  The batches
+            of a member come in order, but those of different members are
+            mixed.
+        '''
+        poller = zmq.Poller()
+        for t in self.tasks:
+            poller.register(t, zmq.POLLIN)
+
+        # the member each worker is running, or None
+        running = [None] * len(self.tasks)
+
+        for idx in range(len(self.tasks)):
+            running[idx] = self._next_member(idx)
+            if running[idx] is not None:
+                self._start(idx, running[idx])
+
+        while any([m is not None for m in running]):
+            ready = dict(poller.poll())
+
+            for idx, t in enumerate(self.tasks):
+                if t not in ready:
+                    continue
+
+                member = running[idx]
+                res = self._recv(idx)
+                steps_run, num_steps = self.progress[member]
+
+                if isinstance(res, dict):
+                    # the results of a batch
+                    steps_run += len(res['results'])
+                    self.progress[member] = (steps_run, num_steps)
+
+                    done = res['done']
+                    results = res['results']
+                else:
+                    # the member has started, and res is its number of steps
+                    self.progress[member] = (0, res)
+
+                    done = False
+                    results = None
+
+                if done:
+                    running[idx] = self._next_member(idx)
+                    if running[idx] is not None:
+                        self._start(idx, running[idx])
+                else:
+                    self._send(idx, 'step_batch',
+                               dict(num_steps=self.batch_steps))
+
+                if results:
+                    yield member, results
+
+    def full_run(self):
+        '''
+            Runs all the members, and returns the outputs of all the steps
+            of each of them
+        '''
+        out = [[] for _m in self.members]
+
+        for member, results in self.run():
+            out[member].extend(results)
+
+        return out
+
+    def stop(self):
+        for idx, t in enumerate(self.tasks):
+            if self.busy[idx]:
+                # a run that was not finished -- a reply is owed before
+                # the socket can send again
+                t.recv_multipart()
+            t.send(dumps(None))
+        [t.close() for t in self.tasks]
+
+        for c in self.consumers:
+            c.join()
+
+        if self.context is not None:
+            self.context.destroy()
+            self.context = None
+
+        close_readers(self.readers)
+
+        shutil.rmtree(self.saveloc, ignore_errors=True)
+
+        self.consumers = []
+        self.tasks = []
+        self.readers = []
+        self.busy = []
+        self.savelocs = []
+
+
+class RemoteWorkers(object):
+    '''
+        ModelConsumers started on other hosts over ssh, each running
+        worker_main() bound to a TCP port, for the endpoints of a
+        ModelBroadcaster or an EnsembleScheduler:
+
+            workers = RemoteWorkers(['node1', 'node2'], workers_per_host=16,
+                                    block_cache_dir='/shared/gnome_blocks')
+            scheduler = EnsembleScheduler(model, members,
+                                          endpoints=workers.endpoints)
+
+        The hosts need py_gnome, ssh without a password and the ports open
+        to this one.  Forcing on OPeNDAP servers (see remote_data) is
+        fetched once for all of them, into block_cache_dir, when it is on
+        a file system they share.  The workers exit when the broadcaster
+        or scheduler stops them; stop() ends the ones that are left.
+    '''
+    def __init__(self, hosts,
+                 workers_per_host=1,
+                 port=5600,
+                 python='python',
+                 ssh=('ssh',),
+                 block_cache_dir=None):
+        self.endpoints = []
+        self.processes = []
+
+        for host in hosts:
+            for i in range(workers_per_host):
+                args = list(ssh) + [host, python, '-m',
+                                    'gnome.multi_model_broadcast',
+                                    'tcp://*:{0}'.format(port + i)]
+                if block_cache_dir:
+                    args.extend(['--block-cache-dir', block_cache_dir])
+
+                self.processes.append(subprocess.Popen(args))
+                # ssh's user@host
+                self.endpoints.append('tcp://{0}:{1}'
+                                      .format(host.split('@')[-1], port + i))
+
+    def __del__(self):
+        self.stop()
+
+    def stop(self):
+        for p in self.processes:
+            if p.poll() is None:
+                p.terminate()
+            p.wait()
+
+        self.processes = []
+
+
+def worker_main(argv):
+    '''
+        runs a ModelConsumer in this process, bound to the endpoint on the
+        command line, until it is stopped
+
+            python -m gnome.multi_model_broadcast tcp://*:5600
+    '''
+    parser = argparse.ArgumentParser(description='run a model consumer for '
+                                     'the ensembles of other hosts')
+    parser.add_argument('endpoint', help="zmq endpoint to bind, like "
+                        "'tcp://*:5600'")
+    parser.add_argument('--block-cache-dir',
+                        help='where the blocks of remote forcing are kept '
+                        '(cy_helpers.set_forcing_block_cache_dir)')
+    parser.add_argument('--cpu', type=int,
+                        help='the CPU to pin the worker to')
+    args = parser.parse_args(argv)
+
+    if args.block_cache_dir:
+        cy_helpers.set_forcing_block_cache_dir(args.block_cache_dir)
+
+    ModelConsumer(None, None, cpu=args.cpu, endpoint=args.endpoint).run()
+
+
+if __name__ == '__main__':
+    worker_main(sys.argv[1:])
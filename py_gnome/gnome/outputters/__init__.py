@@ -1,15 +1,27 @@
+"""
+The outputters are imported from their modules the first time they are
+used, so importing one doesn't import all of them, with netCDF4, py_gd and
+the shapefile and kmz writers.
+"""
+from itertools import chain
 
-from outputter import Outputter, BaseSchema
-from netcdf import NetCDFOutput, NetCDFOutputSchema
-from renderer import Renderer, RendererSchema
-from weathering import WeatheringOutput
-from geo_json import (TrajectoryGeoJsonOutput,
-                      IceGeoJsonOutput)
-from json import (IceJsonOutput,
-                  CurrentJsonOutput)
+from gnome.utilities.lazy_import import lazy_package
 
-from kmz import KMZOutput
-from image import IceImageOutput
-from shape import ShapeOutput
+_outputters = {'outputter': ('Outputter', 'BaseSchema'),
+               'netcdf': ('NetCDFOutput', 'NetCDFOutputSchema'),
+               'renderer': ('Renderer', 'RendererSchema'),
+               'weathering': ('WeatheringOutput',),
+               'geo_json': ('TrajectoryGeoJsonOutput',
+                            'IceGeoJsonOutput'),
+               'json': ('IceJsonOutput',
+                        'CurrentJsonOutput'),
+               'kmz': ('KMZOutput',),
+               'image': ('IceImageOutput',),
+               'shape': ('ShapeOutput',),
+               'concentration': ('ConcentrationGridOutput',),
+               'thinning': ('OutputThinning',)}
 
-# NOTE: no need for __all__ if you want export everything!
+# all of them, as the imports did
+__all__ = sorted(chain(*_outputters.values()))
+
+lazy_package(__name__, _outputters)
@@ -7,7 +7,8 @@ from colander import SchemaNode, String, drop
 from gnome.persist import base_schema, class_from_objtype
 
 from . import Renderer
-import py_gd
+from gnome.utilities.lazy_import import lazy_module
+py_gd = lazy_module('py_gd')
 from gnome.utilities.map_canvas import MapCanvas
 from gnome.utilities.serializable import Field
 from gnome.utilities.file_tools import haz_files
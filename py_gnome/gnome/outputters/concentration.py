@@ -0,0 +1,288 @@
+'''
+Concentration outputter - the mass of the elements in the water binned on a
+grid each output step, written to a compressed NetCDF file, instead of the
+particles to be binned afterwards
+'''
+import copy
+import os
+
+from gnome.utilities.lazy_import import lazy_module
+nc = lazy_module('netCDF4')
+
+import numpy as np
+
+from colander import (SchemaNode, SequenceSchema, TupleSchema,
+                      String, Float, Int, Bool, drop)
+
+from gnome import __version__
+from gnome.persist import base_schema
+from gnome.utilities.serializable import Serializable, Field
+from gnome.cy_gnome.cy_grid_locator import CyGridLocator
+from gnome.cy_gnome.cy_concentration_grid import CyConcentrationGrid
+
+from . import Outputter, BaseSchema
+
+
+class GridShape(TupleSchema):
+    rows = SchemaNode(Int())
+    cols = SchemaNode(Int())
+
+
+class DepthEdges(SequenceSchema):
+    depth = SchemaNode(Float())
+
+
+class ConcentrationGridSchema(BaseSchema):
+    'colander schema for serialize/deserialize object'
+    filename = SchemaNode(String(), missing=drop)
+    bounds = base_schema.LongLatBounds(missing=drop)
+    shape = GridShape(missing=drop)
+    depth_edges = DepthEdges(missing=drop)
+    compress = SchemaNode(Bool(), missing=drop)
+
+
+def grid_locator(grid):
+    '''
+    the CyGridLocator of the triangles of a mover's grid -- a grid current
+    mover, or any with get_points() and the triangles of its cy mover
+    '''
+    if isinstance(grid, CyGridLocator):
+        return grid
+
+    points = grid.get_points()
+    triangle_data = grid.mover._get_triangle_data()
+
+    dtype = triangle_data[0].dtype.descr
+    faces = (triangle_data.view(dtype=dtype[0][1])
+             .reshape(-1, len(dtype))[:, :3])
+
+    return CyGridLocator(np.column_stack((points['long'], points['lat'])),
+                         faces)
+
+
+class ConcentrationGridOutput(Outputter, Serializable):
+    '''
+    Bins the mass of the forecast elements in the water by cell and depth
+    layer every output step, in lib_gnome, and writes the mass and the
+    concentration of each cell to a NetCDF4 file with its variables
+    compressed.
+
+    The cells are those of a regular longitude and latitude grid -- bounds
+    and shape -- or the triangles of a model grid. On a model grid each
+    element's lookup starts from the triangle it was in at the last output.
+
+    The layers are between the depths of depth_edges: by default the
+    surface meter, so the concentrations are those of the surface oil.
+    '''
+    cf_attributes = {'comment': 'Concentration output from the NOAA '
+                                'PyGnome model',
+                     'source': 'PyGnome version {0}'.format(__version__),
+                     'institution': 'NOAA Emergency Response Division',
+                     'conventions': 'CF-1.6',
+                     }
+
+    _state = copy.deepcopy(Outputter._state)
+
+    # data file should not be moved to save file location!
+    _state.add_field([Field('filename', save=True, update=True,
+                            test_for_eq=False),
+                      Field('bounds', save=True, update=True),
+                      Field('shape', save=True, update=True),
+                      Field('depth_edges', save=True, update=True),
+                      Field('compress', save=True, update=True),
+                      ])
+    _schema = ConcentrationGridSchema
+
+    def __init__(self, filename, bounds=None, shape=(100, 100), grid=None,
+                 depth_edges=(0., 1.), compress=True, **kwargs):
+        '''
+        :param filename: the NetCDF file to write
+        :param bounds: ((west, south), (east, north)) of a regular grid
+        :param shape: (rows, columns) of the regular grid
+        :param grid: a mover whose grid's triangles are the cells, or the
+            CyGridLocator of a triangle grid, instead of bounds and shape.
+            Not saved with the outputter
+        :param depth_edges: the depths in meters, increasing, of the tops of
+            the layers and the bottom of the last
+        :param compress: whether the NetCDF variables are compressed
+
+        use super to pass optional \\*\\*kwargs to base class __init__ method
+        '''
+        if grid is None and bounds is None:
+            raise ValueError('the concentration grid needs bounds or a '
+                             'model grid')
+
+        self.filename = filename
+        self.bounds = bounds
+        self.shape = tuple(shape)
+        self.grid = grid
+        self.depth_edges = tuple(depth_edges)
+        self.compress = compress
+
+        super(ConcentrationGridOutput, self).__init__(**kwargs)
+
+    def _make_grid(self):
+        if self.grid is not None:
+            return CyConcentrationGrid(locator=grid_locator(self.grid),
+                                       depth_edges=self.depth_edges)
+
+        return CyConcentrationGrid(bounds=self.bounds, shape=self.shape,
+                                   depth_edges=self.depth_edges)
+
+    def _create_var(self, rootgrp, name, dims, attributes, dtype=np.float32):
+        var = rootgrp.createVariable(name, dtype, dims, zlib=self.compress)
+        var.setncatts(attributes)
+
+        return var
+
+    def prepare_for_model_run(self, model_start_time, spills=None, **kwargs):
+        '''
+        Makes the grid, and the NetCDF file with its cells and layers. An
+        existing file is replaced.
+        '''
+        super(ConcentrationGridOutput, self).prepare_for_model_run(
+            model_start_time, spills, **kwargs)
+        if not self.on:
+            return
+
+        self.clean_output_files()
+        self._conc_grid = self._make_grid()
+
+        edges = np.array(self.depth_edges, dtype=np.float64)
+        lon, lat = self._conc_grid.cell_centers
+
+        if self.grid is None:
+            cell_dims = ('lat', 'lon')
+        else:
+            cell_dims = ('cell',)
+        data_dims = ('time', 'depth') + cell_dims
+
+        with nc.Dataset(self.filename, 'w', format='NETCDF4') as rootgrp:
+            rootgrp.setncatts(self.cf_attributes)
+            rootgrp.createDimension('time', None)
+            rootgrp.createDimension('depth', len(edges) - 1)
+            rootgrp.createDimension('nv', 2)
+
+            time = self._create_var(rootgrp, 'time', ('time',),
+                                    {'standard_name': 'time',
+                                     'units': 'seconds since {0}'.format(
+                                         model_start_time.isoformat()),
+                                     'calendar': 'gregorian',
+                                     },
+                                    np.float64)
+            depth = self._create_var(rootgrp, 'depth', ('depth',),
+                                     {'standard_name': 'depth',
+                                      'units': 'meters',
+                                      'positive': 'down',
+                                      'bounds': 'depth_bounds',
+                                      },
+                                     np.float64)
+            depth_bounds = self._create_var(rootgrp, 'depth_bounds',
+                                            ('depth', 'nv'), {}, np.float64)
+            depth[:] = (edges[:-1] + edges[1:]) / 2
+            depth_bounds[:] = np.column_stack((edges[:-1], edges[1:]))
+
+            if self.grid is None:
+                rootgrp.createDimension('lat', self.shape[0])
+                rootgrp.createDimension('lon', self.shape[1])
+                lon_var = self._create_var(rootgrp, 'lon', ('lon',), {},
+                                           np.float64)
+                lat_var = self._create_var(rootgrp, 'lat', ('lat',), {},
+                                           np.float64)
+                lon_var[:] = lon[0, :]
+                lat_var[:] = lat[:, 0]
+            else:
+                rootgrp.createDimension('cell', self._conc_grid.num_cells)
+                lon_var = self._create_var(rootgrp, 'lon', ('cell',),
+                                           {'comment': 'triangle centers'},
+                                           np.float64)
+                lat_var = self._create_var(rootgrp, 'lat', ('cell',),
+                                           {'comment': 'triangle centers'},
+                                           np.float64)
+                lon_var[:] = lon
+                lat_var[:] = lat
+            lon_var.setncatts({'standard_name': 'longitude',
+                               'units': 'degrees_east'})
+            lat_var.setncatts({'standard_name': 'latitude',
+                               'units': 'degrees_north'})
+
+            area = self._create_var(rootgrp, 'cell_area', cell_dims,
+                                    {'long_name': 'area of the cell',
+                                     'units': 'm2'},
+                                    np.float64)
+            area[:] = self._conc_grid.cell_areas
+
+            self._create_var(rootgrp, 'mass', data_dims,
+                             {'long_name': 'mass of the elements in the '
+                                           'cell and layer',
+                              'units': 'kilograms'})
+            self._create_var(rootgrp, 'concentration', data_dims,
+                             {'long_name': 'mass of the elements per volume '
+                                           'of the cell and layer',
+                              'units': 'kg m-3'})
+            time.setncatts({'long_name': 'time since the beginning of the '
+                                         'simulation'})
+
+        # a volume per cell and layer, the concentration is mass over it
+        areas = self._conc_grid.cell_areas
+        thickness = np.diff(edges).reshape((-1,) + (1,) * areas.ndim)
+        self._volumes = areas[None, ...] * thickness
+
+        # the cells of the elements at the last output, by element id
+        self._cells = np.zeros((0,), dtype=np.int_)
+        self._time_idx = 0
+
+    def _element_cells(self, ids):
+        if len(ids) and ids.max() >= len(self._cells):
+            cells = np.full((ids.max() + 1,), -1, dtype=np.int_)
+            cells[:len(self._cells)] = self._cells
+            self._cells = cells
+
+        return self._cells[ids]
+
+    def write_output(self, step_num, islast_step=False):
+        'bins the elements of the step, and writes the grid to the file'
+        super(ConcentrationGridOutput, self).write_output(step_num,
+                                                          islast_step)
+
+        if not self.on or not self._write_step:
+            return None
+
+        # the forecast spill container
+        sc = self.cache.load_timestep(step_num).items()[0]
+        in_water = self.derived(sc, 'in_water')
+        ids = sc['id'][in_water]
+
+        self._conc_grid.clear()
+        _binned, cells = self._conc_grid.add_mass(sc['positions'][in_water],
+                                                  sc['mass'][in_water],
+                                                  self._element_cells(ids))
+        self._cells[ids] = cells
+
+        mass = self._conc_grid.mass
+        seconds = (sc.current_time_stamp -
+                   self._model_start_time).total_seconds()
+
+        with nc.Dataset(self.filename, 'a') as rootgrp:
+            rootgrp.variables['time'][self._time_idx] = seconds
+            rootgrp.variables['mass'][self._time_idx] = mass
+            rootgrp.variables['concentration'][self._time_idx] = \
+                mass / self._volumes
+        self._time_idx += 1
+
+        return {'filename': self.filename,
+                'time_stamp': sc.current_time_stamp.isoformat()}
+
+    def clean_output_files(self):
+        'deletes the output file, called by prepare_for_model_run'
+        try:
+            os.remove(self.filename)
+        except OSError:
+            pass  # it must not be there
+
+    def rewind(self):
+        super(ConcentrationGridOutput, self).rewind()
+
+        self._conc_grid = None
+        self._cells = np.zeros((0,), dtype=np.int_)
+        self._time_idx = 0
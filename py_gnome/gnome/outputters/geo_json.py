@@ -5,6 +5,7 @@ Does not contain a schema for persistence yet
 import copy
 import os
 from glob import glob
+from cStringIO import StringIO
 from collections import Iterable, defaultdict
 
 import numpy as np
@@ -20,6 +21,8 @@ from gnome.utilities.serializable import Serializable, Field
 from gnome.persist import class_from_objtype
 
 from .outputter import Outputter, BaseSchema
+from .streaming import write_point_features, typed_array
+from .ice_products import IceProducts
 
 
 class TrajectoryGeoJsonSchema(BaseSchema):
@@ -29,6 +32,7 @@ class TrajectoryGeoJsonSchema(BaseSchema):
     round_data = SchemaNode(Bool(), missing=drop)
     round_to = SchemaNode(Int(), missing=drop)
     output_dir = SchemaNode(String(), missing=drop)
+    output_format = SchemaNode(String(), missing=drop)
 
 
 class TrajectoryGeoJsonOutput(Outputter, Serializable):
@@ -64,6 +68,9 @@ class TrajectoryGeoJsonOutput(Outputter, Serializable):
             ...
         }
 
+    The web client can have the step as text or as binary arrays instead,
+    so the API does not have to encode a Python object for each element --
+    see output_format.
     '''
     _state = copy.deepcopy(Outputter._state)
 
@@ -71,13 +78,17 @@ class TrajectoryGeoJsonOutput(Outputter, Serializable):
     # is saved correctly - maybe point it to saveloc
     _state += [Field('round_data', update=True, save=True),
                Field('round_to', update=True, save=True),
-               Field('output_dir', update=True, save=True)]
+               Field('output_dir', update=True, save=True),
+               Field('output_format', update=True, save=True)]
     _schema = TrajectoryGeoJsonSchema
 
+    output_formats = ('geojson', 'text', 'binary')
+
     def __init__(self,
                  round_data=True,
                  round_to=4,
                  output_dir=None,
+                 output_format='geojson',
                  **kwargs):
         '''
         :param bool round_data=True: if True, then round the numpy arrays
@@ -88,12 +99,28 @@ class TrajectoryGeoJsonOutput(Outputter, Serializable):
         :param str output_dir=None: output directory for geojson files. Default
             is None since data is returned in dict for webapi. For using
             write_output_post_run(), this must be set
+        :param str output_format='geojson': what write_output() returns for
+            the certain and uncertain elements:
+
+            'geojson' - a geojson.FeatureCollection object
+
+            'text' - the text of that FeatureCollection, written straight
+                     from the arrays
+
+            'binary' - a dict of the element arrays, each encoded by
+                       streaming.typed_array(): 'coordinates' (Nx2 float32
+                       lon, lat), 'status_code' (uint8), 'mass' (float32)
+                       and 'spill_num' (uint16), and the 'sc_type'
+
+            The files in output_dir are always written straight from the
+            arrays.
 
         use super to pass optional \*\*kwargs to base class __init__ method
         '''
         self.round_data = round_data
         self.round_to = round_to
         self.output_dir = output_dir
+        self.output_format = output_format
 
         super(TrajectoryGeoJsonOutput, self).__init__(output_dir=output_dir,
                                                       **kwargs)
@@ -124,53 +151,117 @@ class TrajectoryGeoJsonOutput(Outputter, Serializable):
         if not self._write_step:
             return None
 
-        # one feature per element client; replaced with multipoint
-        # because client performance is much more stable with one
-        # feature per step rather than (n) features per step.features = []
-        c_features = []
-        uc_features = []
+        output_info = {}
         for sc in self.cache.load_timestep(step_num).items():
-            position = self._dataarray_p_types(sc['positions'])
-            status = self._dataarray_p_types(sc['status_codes'])
-            mass = self._dataarray_p_types(sc['mass'])
-            sc_type = 'uncertain' if sc.uncertain else 'forecast'
-            spill_num = self._dataarray_p_types(sc['spill_num'])
-
-            # break elements into multipoint features based on their
-            # status code
-            #   evaporated : 10
-            #   in_water : 2
-            #   not_released : 0
-            #   off_maps : 7
-            #   on_land : 3
-            #   to_be_removed : 12
-            for ix, pos in enumerate(position):
-                feature = Feature(geometry=Point(pos[:2]), id=ix,
-                                  properties={'status_code': status[ix],
-                                              'sc_type': sc_type,
-                                              'mass': mass[ix],
-                                              'spill_num': spill_num[ix]}
-                                  )
-                if sc.uncertain:
-                    uc_features.append(feature)
-                else:
-                    c_features.append(feature)
-
-        c_geojson = FeatureCollection(c_features)
-        uc_geojson = FeatureCollection(uc_features)
+            sc = self.thinned(sc)
+            key = 'uncertain' if sc.uncertain else 'certain'
+
+            if self.output_format == 'geojson':
+                output_info[key] = self._feature_collection(sc)
+            elif self.output_format == 'text':
+                text = StringIO()
+                self._write_features(text, sc)
+                output_info[key] = text.getvalue()
+            else:
+                output_info[key] = self._typed_arrays(sc)
+
+            if self.output_dir:
+                filename = self.stream_to_file(sc, step_num)
+                if not sc.uncertain:
+                    output_info['output_filename'] = filename
+
         # default geojson should not output data to file
         # read data from file and send it to web client
-        output_info = {'time_stamp': sc.current_time_stamp.isoformat(),
-                       'certain': c_geojson,
-                       'uncertain': uc_geojson
-                       }
-
-        if self.output_dir:
-            output_info['output_filename'] = self.output_to_file(c_geojson, step_num)
-            self.output_to_file(uc_geojson, step_num)
+        output_info['time_stamp'] = sc.current_time_stamp.isoformat()
 
         return output_info
 
+    @property
+    def output_format(self):
+        return self._output_format
+
+    @output_format.setter
+    def output_format(self, output_format):
+        if output_format not in self.output_formats:
+            raise ValueError('output_format must be one of {0}'
+                             .format(self.output_formats))
+
+        self._output_format = output_format
+
+    def _sc_type(self, sc):
+        return 'uncertain' if sc.uncertain else 'forecast'
+
+    def _feature_collection(self, sc):
+        '''
+        the elements of the spill container as a FeatureCollection of Point
+        Features
+        '''
+        position = self._dataarray_p_types(sc['positions'])
+        status = self._dataarray_p_types(sc['status_codes'])
+        mass = self._dataarray_p_types(sc['mass'])
+        sc_type = self._sc_type(sc)
+        spill_num = self._dataarray_p_types(sc['spill_num'])
+
+        # break elements into multipoint features based on their
+        # status code
+        #   evaporated : 10
+        #   in_water : 2
+        #   not_released : 0
+        #   off_maps : 7
+        #   on_land : 3
+        #   to_be_removed : 12
+        features = []
+        for ix, pos in enumerate(position):
+            feature = Feature(geometry=Point(pos[:2]), id=ix,
+                              properties={'status_code': status[ix],
+                                          'sc_type': sc_type,
+                                          'mass': mass[ix],
+                                          'spill_num': spill_num[ix]}
+                              )
+            features.append(feature)
+
+        return FeatureCollection(features)
+
+    def _write_features(self, stream, sc):
+        '''
+        writes the FeatureCollection of _feature_collection() straight from
+        the spill container's arrays
+        '''
+        decimals = self.round_to if self.round_data else None
+
+        write_point_features(stream, sc['positions'],
+                             [('status_code', sc['status_codes']),
+                              ('sc_type', self._sc_type(sc)),
+                              ('mass', sc['mass']),
+                              ('spill_num', sc['spill_num'])],
+                             decimals=decimals)
+
+    def _typed_arrays(self, sc):
+        '''
+        the element data of the spill container as typed arrays: float32
+        positions are good to about a meter
+        '''
+        return {'sc_type': self._sc_type(sc),
+                'num_elements': len(sc['positions']),
+                'coordinates': typed_array(self.derived(sc, 'coordinates_f4'),
+                                           '<f4'),
+                'status_code': typed_array(sc['status_codes'], '<u1'),
+                'mass': typed_array(sc['mass'], '<f4'),
+                'spill_num': typed_array(sc['spill_num'], '<u2')}
+
+    def stream_to_file(self, sc, step_num):
+        '''
+        writes the elements of the spill container to the step's file
+        '''
+        file_format = 'geojson_{0:06d}.geojson'
+        filename = os.path.join(self.output_dir,
+                                file_format.format(step_num))
+
+        with open(filename, 'w+') as outfile:
+            self._write_features(outfile, sc)
+
+        return filename
+
     def output_to_file(self, json_content, step_num):
         file_format = 'geojson_{0:06d}.geojson'
         filename = os.path.join(self.output_dir,
@@ -259,6 +350,9 @@ class IceGeoJsonOutput(Outputter):
 
     _schema = IceGeoJsonSchema
 
+    # it reads the ice movers at the model's time
+    background_safe = False
+
     def __init__(self, ice_movers, **kwargs):
         '''
             :param ice_movers: ice_movers associated with this outputter.
@@ -275,6 +369,8 @@ class IceGeoJsonOutput(Outputter):
         else:
             self.ice_movers = tuple()
 
+        self._ice_products = IceProducts()
+
         super(IceGeoJsonOutput, self).__init__(**kwargs)
 
     def write_output(self, step_num, islast_step=False):
@@ -291,14 +387,16 @@ class IceGeoJsonOutput(Outputter):
 
         geojson = {}
         for mover in self.ice_movers:
-            grid_data = mover.get_grid_data()
-            ice_coverage, ice_thickness = mover.get_ice_fields(model_time)
+            grid_data = self._ice_products.grid_data(mover)
+
+            def feature_collections(ice_coverage, ice_thickness):
+                return [self.get_coverage_fc(ice_coverage, grid_data),
+                        self.get_thickness_fc(ice_thickness, grid_data)]
 
-            geojson[mover.id] = []
-            geojson[mover.id].append(self.get_coverage_fc(ice_coverage,
-                                                          grid_data))
-            geojson[mover.id].append(self.get_thickness_fc(ice_thickness,
-                                                           grid_data))
+            # made again only when the fields have changed
+            geojson[mover.id] = self._ice_products.product(
+                mover.id, mover.get_ice_fields(model_time),
+                feature_collections)
 
         # default geojson should not output data to file
         output_info = {'time_stamp': sc.current_time_stamp.isoformat(),
@@ -368,6 +466,7 @@ class IceGeoJsonOutput(Outputter):
     def rewind(self):
         'remove previously written files'
         super(IceGeoJsonOutput, self).rewind()
+        self._ice_products.clear()
 
     def ice_movers_to_dict(self):
         '''
@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+"""
+ice_products.py
+
+What the ice outputters make of their movers' grids and ice fields, kept
+from one output step to the next. The grid of a mover doesn't change in a
+run, so it is read once; the FeatureCollections and images made of the
+fields are made again only when the fields have changed -- they are
+blended from the forcing slices in lib_gnome, which gathers each slice's
+fields on the cells once, so steps in the same slice with no blending to
+do, or past the last slice, cost a comparison of the fields.
+"""
+import numpy as np
+
+
+class IceProducts(object):
+    '''
+    The grids and the products of the fields of an outputter's ice movers
+    '''
+    def __init__(self):
+        self.clear()
+
+    def clear(self):
+        'forgets it all, for a run with other data'
+        self._grids = {}
+        self._products = {}
+
+    def grid_data(self, mover):
+        'the mover\'s get_grid_data(), read once'
+        if mover.id not in self._grids:
+            self._grids[mover.id] = mover.get_grid_data()
+
+        return self._grids[mover.id]
+
+    def product(self, key, fields, make):
+        '''
+        make(*fields), or what it made of the same fields for key last time
+
+        :param fields: a sequence of arrays
+        '''
+        last = self._products.get(key)
+        if (last is not None and len(last[0]) == len(fields) and
+                all(np.array_equal(a, b) for a, b in zip(last[0], fields))):
+            return last[1]
+
+        made = make(*fields)
+        self._products[key] = (tuple(np.array(f) for f in fields), made)
+
+        return made
@@ -19,6 +19,7 @@ from gnome.utilities.map_canvas import MapCanvas
 from gnome.persist import class_from_objtype
 
 from . import Outputter, BaseSchema
+from .ice_products import IceProducts
 
 
 class IceImageSchema(BaseSchema):
@@ -43,6 +44,9 @@ class IceImageOutput(Outputter):
 
     _schema = IceImageSchema
 
+    # it reads the ice movers at the model's time
+    background_safe = False
+
     def __init__(self, ice_movers=None,
                  image_size=(800, 600),
                  projection=None,
@@ -57,6 +61,7 @@ class IceImageOutput(Outputter):
         '''
         # this is a place where we store our gradient color infomration
         self.gradient_lu = {}
+        self._ice_products = IceProducts()
 
         self.map_canvas = MapCanvas(image_size,
                                     projection=projection,
@@ -116,6 +121,9 @@ class IceImageOutput(Outputter):
 
         self.gradient_lu[gradient_name] = (scale, np.array(color_names))
 
+        # the images drawn with the old colors
+        self._ice_products.clear()
+
     def add_gradient_to_canvas(self, color_range, color_prefix, num_colors):
         '''
             Add a color gradient to our palette
@@ -226,7 +234,20 @@ class IceImageOutput(Outputter):
             This uses the MapCanvas code to do the actual rendering
 
             returns: thickness_image, concentration_image
+
+            The images are drawn again only when the movers' fields have
+            changed since the last ones were.
         """
+        fields = []
+        for mover in self.ice_movers:
+            fields.extend(mover.get_ice_fields(model_time))
+
+        return self._ice_products.product('images', fields, self._draw_images)
+
+    def _draw_images(self, *fields):
+        '''
+            draws the images of the movers' (concentration, thickness) fields
+        '''
         canvas = self.map_canvas
 
         # We kinda need to figure our our bounding box before doing the
@@ -235,7 +256,7 @@ class IceImageOutput(Outputter):
         mover_grid_bb = None
         mover_grids = []
         for mover in self.ice_movers:
-            mover_grids.append(mover.get_grid_data())
+            mover_grids.append(self._ice_products.grid_data(mover))
             mover_grid_bb = mover.get_grid_bounding_box(mover_grids[-1],
                                                         mover_grid_bb)
 
@@ -243,11 +264,12 @@ class IceImageOutput(Outputter):
         canvas.clear_background()
 
         # Here is where we draw our grid data....
-        for mover, mover_grid in zip(self.ice_movers, mover_grids):
+        for i, (mover, mover_grid) in enumerate(zip(self.ice_movers,
+                                                    mover_grids)):
             mover_grid_bb = mover.get_grid_bounding_box(mover_grid,
                                                         mover_grid_bb)
 
-            concentration, thickness = mover.get_ice_fields(model_time)
+            concentration, thickness = fields[2 * i:2 * i + 2]
 
             thickness_colors = self.lookup_gradient_color('thickness',
                                                           thickness)
@@ -261,10 +283,9 @@ class IceImageOutput(Outputter):
                           .view(dtype=unstructured_type)
                           .reshape(*new_shape))
 
-            for poly, tc, cc in zip(mover_grid,
-                                    thickness_colors, concentration_colors):
-                canvas.draw_polygon(poly, fill_color=tc)
-                canvas.draw_polygon(poly, fill_color=cc, background=True)
+            canvas.draw_polygons(mover_grid, thickness_colors)
+            canvas.draw_polygons(mover_grid, concentration_colors,
+                                 background=True)
 
         # diagnostic so we can see what we have rendered.
         # print '\ndrawing reference objects...'
@@ -294,6 +315,7 @@ class IceImageOutput(Outputter):
     def rewind(self):
         'remove previously written files'
         super(IceImageOutput, self).rewind()
+        self._ice_products.clear()
 
     def ice_movers_to_dict(self):
         '''
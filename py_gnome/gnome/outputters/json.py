@@ -15,6 +15,7 @@ from geojson import (Feature, FeatureCollection, dump,
 from colander import SchemaNode, String, drop, Int, Bool
 
 from gnome.utilities.time_utils import date_to_sec
+from gnome.utilities.tile_pyramid import TilePyramid
 from gnome.utilities.serializable import Serializable, Field
 
 from gnome.persist import class_from_objtype
@@ -22,13 +23,101 @@ from gnome.persist import class_from_objtype
 from .outputter import Outputter, BaseSchema
 
 
+def _tile_key(mover):
+    '''
+    what the tiles of a mover depend on besides its grid and the time: its
+    files (and when they changed) and its scaling
+    '''
+    parts = [mover.__class__.__name__]
+    for attr in ('filename', 'topology_file', 'current_scale', 'scale',
+                 'scale_value', 'scale_refpoint', 'extrapolate',
+                 'time_offset'):
+        value = getattr(mover, attr, None)
+        parts.append(repr(value))
+        if attr in ('filename', 'topology_file') and value is not None:
+            try:
+                parts.append(repr(os.path.getmtime(value)))
+            except (OSError, TypeError):
+                pass
+
+    tide = getattr(mover, 'tide', None)
+    if tide is not None:
+        parts.append(repr(getattr(tide, 'filename', None)))
+
+    return ' '.join(parts)
+
+
+class TiledJsonOutput(object):
+    '''
+    Mixin for the JSON outputters of gridded fields that can serve them as
+    tiles (see gnome.utilities.tile_pyramid) instead of writing every cell
+    each step. With tiles on, write_output() gives the pyramid of each mover
+    and get_tile() the tiles the client shows.
+    '''
+    # the value of one step of the quantized values
+    tile_quantum = 0.01
+
+    def _init_tiles(self, tiles, tile_cache_dir):
+        self.tiles = tiles
+        self.tile_cache_dir = tile_cache_dir
+
+        # kept across rewinds, a mover's pyramid holds for its grid
+        self._pyramids = {}
+
+    def _tile_movers(self):
+        raise NotImplementedError
+
+    def _tile_values(self, mover, model_time):
+        '''
+        the values to tile at the mover's center points, one row per point
+        '''
+        raise NotImplementedError
+
+    def _get_pyramid(self, mover, model_time):
+        'the pyramid of the mover, with the slice at model_time'
+        if mover.id not in self._pyramids:
+            self._pyramids[mover.id] = TilePyramid(mover.get_center_points(),
+                                                   self.tile_quantum,
+                                                   cache_dir=self.tile_cache_dir,
+                                                   key=_tile_key(mover))
+
+        pyramid = self._pyramids[mover.id]
+        if not pyramid.has_slice(model_time):
+            pyramid.add_slice(model_time, self._tile_values(mover, model_time))
+
+        return pyramid
+
+    def _tiles_output(self, model_time):
+        return dict((mover.id,
+                     self._get_pyramid(mover, model_time).describe())
+                    for mover in self._tile_movers())
+
+    def get_tile(self, mover_id, time, zoom, x, y):
+        '''
+        tile (x, y) of a zoom of a mover's field at time, see
+        TilePyramid.get_tile()
+
+        :param time: a datetime or model seconds
+        :raises KeyError: if the outputter has no mover mover_id
+        '''
+        model_time = time if isinstance(time, (int, long, float)) else date_to_sec(time)
+
+        for mover in self._tile_movers():
+            if mover.id == mover_id:
+                return (self._get_pyramid(mover, model_time)
+                        .get_tile(model_time, zoom, x, y))
+
+        raise KeyError('no mover {0}'.format(mover_id))
+
+
 class CurrentJsonSchema(BaseSchema):
     '''
     Nothing is required for initialization
     '''
+    tiles = SchemaNode(Bool(), missing=drop)
 
 
-class CurrentJsonOutput(Outputter, Serializable):
+class CurrentJsonOutput(TiledJsonOutput, Outputter, Serializable):
     '''
     Class that outputs GNOME current velocity results for each current mover
     in a geojson format.  The output is a collection of Features.
@@ -56,6 +145,10 @@ class CurrentJsonOutput(Outputter, Serializable):
                              }
         }
 
+    With tiles on, each mover's entry is instead what TilePyramid.describe()
+    gives, and get_tile() serves the (u, v) of the tiles, quantized to
+    steps of 0.01.
+
     '''
     _state = copy.deepcopy(Outputter._state)
 
@@ -63,17 +156,27 @@ class CurrentJsonOutput(Outputter, Serializable):
     # is saved correctly - maybe point it to saveloc
     _state.add_field(Field('current_movers', save=True, update=True,
                            iscollection=True))
+    _state.add_field(Field('tiles', save=True, update=True))
 
     _schema = CurrentJsonSchema
 
-    def __init__(self, current_movers, **kwargs):
+    # it reads the current movers at the model's time
+    background_safe = False
+
+    def __init__(self, current_movers, tiles=False, tile_cache_dir=None,
+                 **kwargs):
         '''
         :param list current_movers: A list or collection of current grid mover
                                     objects.
 
+        :param tiles=False: serve the velocities as tiles, see get_tile()
+        :param tile_cache_dir=None: directory keeping the tiles for later
+                                    sessions, None keeps them in memory only
+
         use super to pass optional \*\*kwargs to base class __init__ method
         '''
         self.current_movers = current_movers
+        self._init_tiles(tiles, tile_cache_dir)
 
         super(CurrentJsonOutput, self).__init__(**kwargs)
 
@@ -88,6 +191,9 @@ class CurrentJsonOutput(Outputter, Serializable):
             model_time = date_to_sec(sc.current_time_stamp)
             iso_time = sc.current_time_stamp.isoformat()
 
+        if self.tiles:
+            return self._tiles_output(model_time)
+
         json_ = {}
         for cm in self.current_movers:
 
@@ -105,6 +211,14 @@ class CurrentJsonOutput(Outputter, Serializable):
                          }
         return json_
 
+    def _tile_movers(self):
+        return self.current_movers
+
+    def _tile_values(self, mover, model_time):
+        velocities = mover.get_scaled_velocities(model_time)
+
+        return np.column_stack((velocities['u'], velocities['v']))
+
     def get_rounded_velocities(self, velocities):
         return np.vstack((velocities['u'].round(decimals=2),
                           velocities['v'].round(decimals=2))).T
@@ -142,9 +256,10 @@ class IceJsonSchema(BaseSchema):
     '''
     Nothing is required for initialization
     '''
+    tiles = SchemaNode(Bool(), missing=drop)
 
 
-class IceJsonOutput(Outputter):
+class IceJsonOutput(TiledJsonOutput, Outputter):
     '''
     Class that outputs GNOME ice property results for each ice mover
     in a raw JSON format.  The output contains a dict keyed by mover id.
@@ -167,6 +282,10 @@ class IceJsonOutput(Outputter):
                                  ...
                                  }
         }
+
+    With tiles on, 'data' holds what TilePyramid.describe() gives for each
+    mover, and get_tile() serves the (concentration, thickness) of the
+    tiles, quantized to steps of 0.01.
     '''
     _state = copy.deepcopy(Outputter._state)
 
@@ -174,15 +293,24 @@ class IceJsonOutput(Outputter):
     # is saved correctly - maybe point it to saveloc
     _state.add_field(Field('ice_movers',
                            save=True, update=True, iscollection=True))
+    _state.add_field(Field('tiles', save=True, update=True))
 
     _schema = IceJsonSchema
 
-    def __init__(self, ice_movers, **kwargs):
+    # it reads the ice movers at the model's time
+    background_safe = False
+
+    def __init__(self, ice_movers, tiles=False, tile_cache_dir=None,
+                 **kwargs):
         '''
             :param ice_movers: ice_movers associated with this outputter.
             :type ice_movers: An ice_mover object or sequence of ice_mover
                               objects.
 
+            :param tiles=False: serve the ice fields as tiles, see get_tile()
+            :param tile_cache_dir=None: directory keeping the tiles for later
+                                        sessions, None keeps them in memory
+
             Use super to pass optional \*\*kwargs to base class __init__ method
         '''
         if (isinstance(ice_movers, Iterable) and
@@ -192,6 +320,7 @@ class IceJsonOutput(Outputter):
             self.ice_movers = (ice_movers,)
         else:
             self.ice_movers = tuple()
+        self._init_tiles(tiles, tile_cache_dir)
 
         super(IceJsonOutput, self).__init__(**kwargs)
 
@@ -207,6 +336,10 @@ class IceJsonOutput(Outputter):
 
         model_time = date_to_sec(sc.current_time_stamp)
 
+        if self.tiles:
+            return {'time_stamp': sc.current_time_stamp.isoformat(),
+                    'data': self._tiles_output(model_time)}
+
         raw_json = {}
         for mover in self.ice_movers:
             ice_coverage, ice_thickness = mover.get_ice_fields(model_time)
@@ -225,6 +358,12 @@ class IceJsonOutput(Outputter):
 
         return output_info
 
+    def _tile_movers(self):
+        return self.ice_movers
+
+    def _tile_values(self, mover, model_time):
+        return np.column_stack(mover.get_ice_fields(model_time))
+
     def rewind(self):
         'remove previously written files'
         super(IceJsonOutput, self).rewind()
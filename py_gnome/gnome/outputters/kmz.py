@@ -17,10 +17,10 @@ from gnome.utilities.time_utils import date_to_sec
 from gnome.utilities.serializable import Serializable, Field
 
 from gnome.persist import class_from_objtype
-from gnome.basic_types import oil_status
 
 from .outputter import Outputter, BaseSchema
 from . import kmz_templates
+from .streaming import DeflatedStream
 
 
 class KMZSchema(BaseSchema):
@@ -107,12 +107,16 @@ class KMZOutput(Outputter, Serializable):
         # shouldn't be required if the above worked!
         self._file_exists_error(self.filename)
 
-        # create a list to hold what will be the contents of the kml
-        self.kml = [kmz_templates.header_template.format(caveat=kmz_templates.caveat,
-                                                         kml_name = self.kml_name,
-                                                         valid_timestring = model_start_time.strftime(self.time_formatter),
-                                                         issued_timestring = datetime.now().strftime(self.time_formatter),
-                                                         )]
+        # the kml is compressed as the steps come in, and the kmz is put
+        # together from it after the last one
+        self._close_kml()
+        self._kml_file = DeflatedStream(os.path.dirname(self.filename) or
+                                        None)
+        self._kml_file.write(kmz_templates.header_template.format(caveat=kmz_templates.caveat,
+                                                                  kml_name = self.kml_name,
+                                                                  valid_timestring = model_start_time.strftime(self.time_formatter),
+                                                                  issued_timestring = datetime.now().strftime(self.time_formatter),
+                                                                  ).encode('utf8'))
 
         # # netcdf outputter has this --  not sure why
         # self._middle_of_run = True
@@ -138,25 +142,28 @@ class KMZOutput(Outputter, Serializable):
             end_time = end_time.isoformat()
 
             positions = sc['positions']
-            water_positions = positions[sc['status_codes']   == oil_status.in_water]
-            beached_positions = positions[sc['status_codes'] == oil_status.on_land]
+            water_positions = positions[self.derived(sc, 'in_water')]
+            beached_positions = positions[self.derived(sc, 'on_land')]
 
             data_dict = {'certain' : "Uncertainty"if sc.uncertain else "Best Guess",
                         }
-            self.kml.append(kmz_templates.build_one_timestep(water_positions,
-                                                             beached_positions,
-                                                             start_time,
-                                                             end_time,
-                                                             sc.uncertain
-                                                             ))
+            self._kml_file.write(kmz_templates.build_one_timestep(water_positions,
+                                                                  beached_positions,
+                                                                  start_time,
+                                                                  end_time,
+                                                                  sc.uncertain
+                                                                  ).encode('utf8'))
 
         if islast_step: # now we really write the file:
-           self.kml.append(kmz_templates.footer)
-           with zipfile.ZipFile(self.filename, 'w', compression=zipfile.ZIP_DEFLATED) as kmzfile:
+            self._kml_file.write(kmz_templates.footer.encode('utf8'))
+            with zipfile.ZipFile(self.filename, 'w',
+                                 compression=zipfile.ZIP_DEFLATED,
+                                 allowZip64=True) as kmzfile:
                 kmzfile.writestr('dot.png', base64.b64decode(DOT))
                 kmzfile.writestr('x.png', base64.b64decode(X))
-                # write the kml file
-                kmzfile.writestr(self.kml_name, "".join(self.kml).encode('utf8'))
+                # the kml, compressed already
+                self._kml_file.add_to_zip(kmzfile, self.kml_name)
+            self._kml_file = None
 
 
 
@@ -176,6 +183,12 @@ class KMZOutput(Outputter, Serializable):
 
         self._middle_of_run = False
         self._start_idx = 0
+        self._close_kml()
+
+    def _close_kml(self):
+        kml_file, self._kml_file = getattr(self, '_kml_file', None), None
+        if kml_file is not None:
+            kml_file.close()
 
     def delete_output_files(self):
         '''
@@ -185,6 +198,7 @@ class KMZOutput(Outputter, Serializable):
 
         here in case it needs to be called from elsewhere
         '''
+        self._close_kml()
         try:
             os.remove(self.filename)
         except OSError:
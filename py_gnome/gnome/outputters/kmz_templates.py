@@ -1,6 +1,9 @@
 """
 templates for the kmz  outputter
 """
+import numpy as np
+
+from .streaming import format_rows
 
 caveat = "This trajectory was produced by GNOME (General NOAA Operational Modeling Environment), and should be used for educational and planning purposes only--not for a real response. In the event of an oil or chemical spill in U.S. waters, contact the U.S. Coast Guard National Response Center at 1-800-424-8802."
 
@@ -108,6 +111,9 @@ point_template="""             <Point>
              </Point>
 """
 
+# point_template as a % format, for formatting all the points at once
+point_rows_template = point_template.replace('{:.6f}', '%.6f')
+
 
 timestep_header_template = """<Folder>
   <name>{date_string}:{certain}</name>
@@ -151,8 +157,10 @@ def build_one_timestep(floating_positions,
         data['status'] = status
         kml.append(one_run_header.format(**data))
 
-        for point in positions:
-            kml.append(point_template.format(*point[:2]))
+        positions = np.asarray(positions, dtype=np.float64)
+        if len(positions) > 0:
+            kml.extend(format_rows(point_rows_template,
+                                   (positions[:, 0], positions[:, 1])))
         kml.append(one_run_footer)
     kml.append(timestep_footer)
 
@@ -6,7 +6,8 @@ import copy
 import os
 from datetime import datetime
 
-import netCDF4 as nc
+from gnome.utilities.lazy_import import lazy_module
+nc = lazy_module('netCDF4')
 
 import numpy as np
 
@@ -16,6 +17,7 @@ from gnome import __version__
 from gnome.basic_types import oil_status, world_point_type
 
 from gnome.utilities.serializable import Serializable, Field
+from gnome.utilities.nc_particles import INDEX_VARIABLES, index_step
 
 from . import Outputter, BaseSchema
 
@@ -72,6 +74,16 @@ var_attributes = {
     'next_positions': {},
     'last_water_positions': {},
 
+    # the index to seek in the file - see gnome.utilities.nc_particles
+    'step_offset': {'long_name': 'record of the first particle of a timestep',
+                    'units': '1'},
+    'prev_record': {'long_name': 'record of the particle at the timestep '
+                                 'before, -1 where it is new',
+                    'units': '1'},
+    'last_record': {'long_name': 'last record of the particle ID, -1 where '
+                                 'it has none',
+                    'units': '1'},
+
     # weathering data
     'floating': {
         'long_name': 'total mass floating in water after each time step',
@@ -99,6 +111,7 @@ class NetCDFOutputSchema(BaseSchema):
     netcdf_filename = SchemaNode(String(), missing=drop)
     all_data = SchemaNode(Bool(), missing=drop)
     compress = SchemaNode(Bool(), missing=drop)
+    buffer_steps = SchemaNode(Int(), missing=drop)
     _start_idx = SchemaNode(Int(), missing=drop)
     _middle_of_run = SchemaNode(Bool(), missing=drop)
 
@@ -179,6 +192,7 @@ class NetCDFOutput(Outputter, Serializable):
                       Field('which_data', save=True, update=True),
                       # Field('netcdf_format', save=True, update=True),
                       Field('compress', save=True, update=True),
+                      Field('buffer_steps', save=True, update=True),
                       Field('_start_idx', save=True),
                       Field('_middle_of_run', save=True),
                       ])
@@ -188,6 +202,7 @@ class NetCDFOutput(Outputter, Serializable):
                  netcdf_filename,
                  which_data='standard',
                  compress=True,
+                 buffer_steps=1,
                  **kwargs):
         """
         Constructor for Net_CDFOutput object. It reads data from cache and
@@ -207,6 +222,14 @@ class NetCDFOutput(Outputter, Serializable):
             attributes
         :type which_data: string -- one of {'standard', 'most', 'all'}
 
+        :param buffer_steps=1: the number of output steps to keep before
+            writing them to the file. The steps are written together, with
+            one write per variable, instead of opening the file and writing
+            every variable each step, and the variables get chunks big enough
+            for those writes. The buffered steps are written on the last
+            step, when flush() is called and when the outputter is saved.
+        :type buffer_steps: int
+
         Optional arguments passed on to base class (kwargs):
 
         :param cache: sets the cache object from which to read data. The model
@@ -226,6 +249,11 @@ class NetCDFOutput(Outputter, Serializable):
             final step is written regardless of output_timestep
         :type output_last_step: boolean
 
+        :param thinning: default is None, in which case all the elements
+            are written. If set, only the elements it picks of each step
+            are; the file's index still links each element's records.
+        :type thinning: gnome.outputters.thinning.OutputThinning
+
         use super to pass optional kwargs to base class __init__ method
         """
         self._check_filename(netcdf_filename)
@@ -270,6 +298,15 @@ class NetCDFOutput(Outputter, Serializable):
         # number of particles are released
         self._start_idx = 0
 
+        self._buffer_steps = self._check_buffer_steps(buffer_steps)
+
+        # {filename: [step]} of the steps not written yet
+        self._buffered = {}
+
+        # {filename: the last record of each particle id} of the index, read
+        # back from the file if the run was loaded mid-run
+        self._last_records = {}
+
         # define NetCDF variable attributes that are instance attributes here
         # It is set in prepare_for_model_run():
         # 'spill_names' is set based on the names of spill's as defined by user
@@ -336,6 +373,37 @@ class NetCDFOutput(Outputter, Serializable):
         else:
             self._chunksize = value
 
+    @property
+    def buffer_steps(self):
+        return self._buffer_steps
+
+    @buffer_steps.setter
+    def buffer_steps(self, value):
+        if self.middle_of_run:
+            raise AttributeError('buffer_steps can not be set '
+                                 'in the middle of a run')
+        else:
+            self._buffer_steps = self._check_buffer_steps(value)
+
+    @staticmethod
+    def _check_buffer_steps(value):
+        if int(value) != value or value < 1:
+            raise ValueError('buffer_steps must be a whole number of steps, '
+                             'at least 1')
+
+        return int(value)
+
+    def _data_chunksize(self, row_bytes):
+        '''
+        The chunk length along 'data': chunksize, or when steps are buffered,
+        enough rows for about 256KB, since the buffered writes are that big
+        and HDF5 compresses a chunk at a time.
+        '''
+        if self._buffer_steps > 1:
+            return max(self._chunksize, (256 * 1024) // max(row_bytes, 1))
+
+        return self._chunksize
+
     @property
     def compress(self):
         return self._compress
@@ -382,6 +450,7 @@ class NetCDFOutput(Outputter, Serializable):
         # need to be names...
         dims = [('time', None),     # unlimited
                 ('data', None),     # unlimited
+                ('particle', None),     # unlimited, the ids of the index
                 ('two', 2),
                 ('three', 3)]
 
@@ -489,6 +558,15 @@ class NetCDFOutput(Outputter, Serializable):
                 self._create_nc_var(rootgrp, 'particle_count', np.int32,
                                     ('time', ), (self._chunksize,))
 
+                # the index - see _write_index()
+                self._create_nc_var(rootgrp, 'step_offset', np.int64,
+                                    ('time', ), (self._chunksize,))
+                self._create_nc_var(rootgrp, 'prev_record', np.int64,
+                                    ('data', ), (self._data_chunksize(8),))
+                self._create_nc_var(rootgrp, 'last_record', np.int64,
+                                    ('particle', ),
+                                    (self._data_chunksize(8),))
+
                 self._update_arrays_to_output(sc)
 
                 for var_name in self.arrays_to_output:
@@ -497,7 +575,8 @@ class NetCDFOutput(Outputter, Serializable):
                         # these don't  map directly to an array_type
                         dt = world_point_type
                         shape = ('data', )
-                        chunksz = (self._chunksize,)
+                        chunksz = (self._data_chunksize(
+                                   np.dtype(dt).itemsize),)
                     else:
                         # in prepare_for_model_run, nothing is released but
                         # numpy arrays are initialized with 0 elements so use
@@ -508,11 +587,13 @@ class NetCDFOutput(Outputter, Serializable):
 
                         if len(sc[var_name].shape) == 1:
                             shape = ('data',)
-                            chunksz = (self._chunksize,)
+                            chunksz = (self._data_chunksize(dt.itemsize),)
                         else:
                             y_sz = d_dims[sc[var_name].shape[1]]
                             shape = ('data', y_sz)
-                            chunksz = (self._chunksize, sc[var_name].shape[1])
+                            chunksz = (self._data_chunksize(
+                                       dt.itemsize * sc[var_name].shape[1]),
+                                       sc[var_name].shape[1])
 
                     self._create_nc_var(rootgrp, var_name, dt, shape, chunksz)
 
@@ -533,6 +614,8 @@ class NetCDFOutput(Outputter, Serializable):
         # need to keep track of starting index for writing data since variable
         # number of particles are released
         self._start_idx = 0
+        self._buffered = {}
+        self._last_records = {}
         self._middle_of_run = True
 
     def _create_nc_var(self, grp, var_name, dtype, shape, chunksz):
@@ -595,9 +678,26 @@ class NetCDFOutput(Outputter, Serializable):
         super(NetCDFOutput, self).write_output(step_num, islast_step)
 
         if self.on is False or not self._write_step:
+            if islast_step:
+                self.flush()
             return None
 
+        if self._buffer_steps > 1:
+            for sc in self.cache.load_timestep(step_num).items():
+                time_stamp = sc.current_time_stamp
+                self._buffer_step(self.thinned(sc))
+
+            if (islast_step or
+                    len(self._buffered[self.netcdf_filename]) >=
+                    self._buffer_steps):
+                self.flush()
+
+            return {'netcdf_filename': (self.netcdf_filename,
+                                        self._u_netcdf_filename),
+                    'time_stamp': time_stamp}
+
         for sc in self.cache.load_timestep(step_num).items():
+            sc = self.thinned(sc)
             if sc.uncertain and self._u_netcdf_filename is not None:
                 file_ = self._u_netcdf_filename
             else:
@@ -629,6 +729,9 @@ class NetCDFOutput(Outputter, Serializable):
                     else:
                         rg_vars[var_name][self._start_idx:_end_idx] = sc[var_name]
 
+                self._write_index(rootgrp, file_, idx, self._start_idx,
+                                  [sc['id']])
+
                 # write mass_balance data
                 if sc.mass_balance:
                     grp = rootgrp.groups['mass_balance']
@@ -646,6 +749,128 @@ class NetCDFOutput(Outputter, Serializable):
                                     self._u_netcdf_filename),
                 'time_stamp': time_stamp}
 
+    def _output_file(self, sc):
+        if sc.uncertain and self._u_netcdf_filename is not None:
+            return self._u_netcdf_filename
+        else:
+            return self.netcdf_filename
+
+    def _buffer_step(self, sc):
+        'keep the data of the step to write with the next flush()'
+        arrays = {}
+        for var_name in self.arrays_to_output:
+            if var_name == 'longitude':
+                arr = sc['positions'][:, 0]
+            elif var_name == 'latitude':
+                arr = sc['positions'][:, 1]
+            elif var_name == 'depth':
+                arr = sc['positions'][:, 2]
+            else:
+                arr = sc[var_name]
+
+            arrays[var_name] = np.array(arr)
+
+        step = {'time_stamp': sc.current_time_stamp,
+                'particle_count': len(sc),
+                'ids': np.array(sc['id']),
+                'arrays': arrays,
+                'mass_balance': dict(sc.mass_balance)}
+
+        self._buffered.setdefault(self._output_file(sc), []).append(step)
+
+    def flush(self):
+        '''
+        Writes the buffered steps to the files: each variable's data of all
+        the steps in one write
+        '''
+        for file_, steps in self._buffered.iteritems():
+            if not steps:
+                continue
+
+            with nc.Dataset(file_, 'a') as rootgrp:
+                rg_vars = rootgrp.variables
+                idx = len(rg_vars['time'])
+                end_idx = idx + len(steps)
+
+                # the data of the steps goes after what is in the file
+                start = len(rootgrp.dimensions['data'])
+                counts = [step['particle_count'] for step in steps]
+                end = start + sum(counts)
+
+                rg_vars['time'][idx:end_idx] = \
+                    nc.date2num([step['time_stamp'] for step in steps],
+                                rg_vars['time'].units,
+                                rg_vars['time'].calendar)
+                rg_vars['particle_count'][idx:end_idx] = counts
+
+                if end > start:
+                    for var_name in self.arrays_to_output:
+                        rg_vars[var_name][start:end] = \
+                            np.concatenate([step['arrays'][var_name]
+                                            for step in steps])
+
+                self._write_index(rootgrp, file_, idx, start,
+                                  [step['ids'] for step in steps])
+
+                # write mass_balance data
+                if 'mass_balance' in rootgrp.groups:
+                    self._write_mass_balance(rootgrp.groups['mass_balance'],
+                                             steps, idx)
+
+            if file_ == self.netcdf_filename:
+                self._start_idx = end
+
+        self._buffered = {}
+
+    def _write_index(self, rootgrp, file_, idx, start, step_ids):
+        '''
+        the index of the steps from step idx, their data from record start,
+        of the particle ids of each step in step_ids
+        '''
+        rg_vars = rootgrp.variables
+        if 'step_offset' not in rg_vars:
+            # a file written before there was an index
+            return
+
+        last_records = self._last_records.get(file_)
+        if last_records is None:
+            last_records = np.array(rg_vars['last_record'][:],
+                                    dtype=np.int64)
+
+        offsets = []
+        prev = []
+        for ids in step_ids:
+            (step_prev, last_records) = index_step(ids, start, last_records)
+            offsets.append(start)
+            prev.append(step_prev)
+            start += len(ids)
+
+        rg_vars['step_offset'][idx:idx + len(offsets)] = offsets
+        if start > offsets[0]:
+            rg_vars['prev_record'][offsets[0]:start] = np.concatenate(prev)
+        if len(last_records) > 0:
+            rg_vars['last_record'][:len(last_records)] = last_records
+
+        self._last_records[file_] = last_records
+
+    def _write_mass_balance(self, grp, steps, idx):
+        keys = set()
+        for step in steps:
+            keys.update(step['mass_balance'])
+
+        for key in keys:
+            if key not in grp.variables:
+                self._create_nc_var(grp, key, 'float', ('time', ),
+                                    (self._chunksize,))
+
+            values = [step['mass_balance'].get(key) for step in steps]
+            if None in values:
+                for i, val in enumerate(values):
+                    if val is not None:
+                        grp.variables[key][idx + i] = val
+            else:
+                grp.variables[key][idx:idx + len(steps)] = values
+
     def clean_output_files(self):
         '''
         deletes output files that may be around
@@ -672,6 +897,8 @@ class NetCDFOutput(Outputter, Serializable):
 
         self._middle_of_run = False
         self._start_idx = 0
+        self._buffered = {}
+        self._last_records = {}
 
     @classmethod
     def read_data(klass,
@@ -755,8 +982,10 @@ class NetCDFOutput(Outputter, Serializable):
                     if index < 0:
                         index = len(time_) + index
 
-            for idx in range(index):
-                _start_ix += data.variables['particle_count'][idx]
+            if 'step_offset' in data.variables:
+                _start_ix = data.variables['step_offset'][index]
+            elif index > 0:
+                _start_ix = data.variables['particle_count'][:index].sum()
 
             _stop_ix = _start_ix + data.variables['particle_count'][index]
             elem = data.variables['particle_count'][index]
@@ -781,7 +1010,7 @@ class NetCDFOutput(Outputter, Serializable):
                                                   'particle_count',
                                                   'latitude',
                                                   'longitude',
-                                                  'depth')]
+                                                  'depth') + INDEX_VARIABLES]
                 data_arrays.add('positions')
             else:  # should be list of data arrays
                 data_arrays = set(which_data)
@@ -819,7 +1048,11 @@ class NetCDFOutput(Outputter, Serializable):
 
         update netcdf_filename to point to saveloc, then call base class save
         using super
+
+        Buffered steps are written first, so the file has what _start_idx
+        says it has.
         '''
+        self.flush()
         json_ = self.serialize('save')
         fname = os.path.split(json_['netcdf_filename'])[1]
         json_['netcdf_filename'] = os.path.join('./', fname)
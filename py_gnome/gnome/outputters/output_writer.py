@@ -0,0 +1,178 @@
+#!/usr/bin/env python
+"""
+output_writer.py
+
+Runs the outputters' step calls on a background thread, so writing and
+compressing the output of one step overlaps the model computing the next.
+
+The Model hands the writer the calls it would make on each outputter --
+prepare_for_model_step(), model_step_is_done() and write_output() -- and the
+writer makes them in the same order, on its thread. An outputter is only
+touched by that thread during a run, so none of its state needs a lock.
+write_output() reads a snapshot of the step taken when it was queued, not
+the model's cache, which has moved on to later steps by then. The outputters
+the Model runs itself read the same snapshot, so a step is loaded from the
+cache once, and only if an outputter writes it.
+
+The queue holds a bounded number of calls: when the writer falls that far
+behind, the model waits for it instead of piling up snapshots.
+"""
+import sys
+import threading
+import Queue
+
+import numpy as np
+
+from gnome.basic_types import oil_status
+
+# the arrays several outputters work out from the same spill container
+# arrays, by the name Outputter.derived() asks for them by
+DERIVED_ARRAYS = {
+    'in_water': lambda sc: sc['status_codes'] == oil_status.in_water,
+    'on_land': lambda sc: sc['status_codes'] == oil_status.on_land,
+    'coordinates_f4': lambda sc: np.ascontiguousarray(sc['positions'][:, :2],
+                                                      dtype='<f4'),
+}
+
+
+class StepSnapshot(object):
+    """
+    Stands in for the model's cache while an outputter writes a step: it
+    holds that step's SpillContainerPairData, which the outputters share and
+    must only read. Other steps are loaded from the cache it was taken from.
+
+    A lazy snapshot loads the step when an outputter first asks for it, so a
+    step no outputter writes costs nothing. The arrays of DERIVED_ARRAYS are
+    worked out once for all the outputters of the step.
+    """
+    def __init__(self, cache, step_num, lazy=False):
+        self.cache = cache
+        self.step_num = step_num
+        self.scp = None
+        self._derived = {}
+
+        if not lazy:
+            self.load()
+
+    def load(self):
+        'loads the step now, for a snapshot read after the cache moves on'
+        if self.scp is None:
+            self.scp = self.cache.load_timestep(self.step_num)
+
+        return self.scp
+
+    def load_timestep(self, step_num):
+        if step_num == self.step_num:
+            return self.load()
+
+        return self.cache.load_timestep(step_num)
+
+    def derived(self, sc, name):
+        """
+        the derived array name of a spill container of the step, worked out
+        on the first call. Those of other steps are not kept
+        """
+        if self.scp is None or all(sc is not c for c in self.scp.items()):
+            return DERIVED_ARRAYS[name](sc)
+
+        key = (sc.uncertain, name)
+        if key not in self._derived:
+            self._derived[key] = DERIVED_ARRAYS[name](sc)
+
+        return self._derived[key]
+
+
+def write_step(outputter, snapshot, islast_step=False):
+    """
+    outputter.write_output() of the snapshot's step, reading the snapshot
+    instead of its cache
+    """
+    cache = outputter.cache
+    outputter.cache = snapshot
+    try:
+        return outputter.write_output(snapshot.step_num, islast_step)
+    finally:
+        outputter.cache = cache
+
+
+class OutputWriter(object):
+    """
+    A background thread that runs outputter calls in the order they are
+    queued, with at most queue_depth of them waiting.
+
+    An exception in a call stops the writer from running any more of them,
+    and is raised again by the next submit() or flush().
+    """
+    def __init__(self, queue_depth=4):
+        if queue_depth < 1:
+            raise ValueError('queue_depth must be at least 1')
+
+        self.queue_depth = queue_depth
+        self._queue = Queue.Queue(maxsize=queue_depth)
+        self._error = None
+
+        # {step_num: {outputter class name: output}} of the steps written
+        self.results = {}
+
+        self._thread = threading.Thread(target=self._run,
+                                        name='gnome output writer')
+        self._thread.daemon = True
+        self._thread.start()
+
+    def _run(self):
+        while True:
+            job = self._queue.get()
+            try:
+                if job is None:
+                    return
+
+                if self._error is None:
+                    func, args = job
+                    func(*args)
+            except Exception:
+                self._error = sys.exc_info()
+            finally:
+                self._queue.task_done()
+
+    def _raise_error(self):
+        if self._error is not None:
+            error, self._error = self._error, None
+            raise error[0], error[1], error[2]
+
+    def submit(self, func, *args):
+        """
+        queues func(*args), waiting for room in the queue if it is full
+        """
+        self._raise_error()
+        self._queue.put((func, args))
+
+    def write_output(self, outputter, snapshot, islast_step=False):
+        """
+        queues outputter.write_output() of the snapshot's step
+        """
+        self.submit(self._write_output, outputter, snapshot, islast_step)
+
+    def _write_output(self, outputter, snapshot, islast_step):
+        output = write_step(outputter, snapshot, islast_step)
+
+        if output is not None:
+            step_results = self.results.setdefault(snapshot.step_num, {})
+            step_results[outputter.__class__.__name__] = output
+
+    def flush(self):
+        """
+        waits for the queued calls to be done, and raises the error of one
+        that failed
+        """
+        self._queue.join()
+        self._raise_error()
+
+    def close(self):
+        """
+        flushes, and stops the thread
+        """
+        try:
+            self.flush()
+        finally:
+            self._queue.put(None)
+            self._thread.join()
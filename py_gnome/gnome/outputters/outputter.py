@@ -18,6 +18,8 @@ from colander import SchemaNode, MappingSchema, Bool, drop
 from gnome.persist import base_schema, extend_colander, validators
 from gnome.utilities.serializable import Serializable, Field
 
+from .output_writer import DERIVED_ARRAYS
+
 
 class BaseSchema(base_schema.ObjType, MappingSchema):
     'Base schema for all outputters - they all contain the following'
@@ -44,6 +46,12 @@ class Outputter(Serializable):
                Field('output_start_time', save=True, update=True))
     _schema = BaseSchema
 
+    # Whether the Model can run this outputter on its background
+    # OutputWriter (see Model.output_queue_depth). Those that write from
+    # the cache can; those that read movers while writing need the model to
+    # be at the step they write, so they are run in step.
+    background_safe = True
+
     def __init__(self,
                  cache=None,
                  on=True,
@@ -52,7 +60,8 @@ class Outputter(Serializable):
                  output_last_step=True,
                  output_start_time=None,
                  name='',
-                 output_dir=None):
+                 output_dir=None,
+                 thinning=None):
         """
         sets attributes for all outputters, like output_timestep, cache
 
@@ -82,6 +91,10 @@ class Outputter(Serializable):
         :param output_dir=None: directory to dump ouput in, if it needs to
                                 do this.
         :type output_dir: string (path)
+
+        :param thinning=None: which elements of each step to write, for the
+            outputters that call thinned(). All of them if None.
+        :type thinning: gnome.outputters.thinning.OutputThinning
         """
         self.cache = cache
         self.on = on
@@ -97,6 +110,7 @@ class Outputter(Serializable):
             self.output_start_time = None
 
         self.sc_pair = None     # set in prepare_for_model_run
+        self.thinning = thinning
 
         self.name = name
 
@@ -190,6 +204,7 @@ class Outputter(Serializable):
             self._write_step = True
 
         self._dt_since_lastoutput = 0
+        self._thinning_state = {}
 
     def prepare_for_model_step(self, time_step, model_time):
         """
@@ -270,6 +285,28 @@ class Outputter(Serializable):
             raise ValueError('cache object is not defined. It is required'
                              ' prior to calling write_output')
 
+    def derived(self, sc, name):
+        """
+        an array worked out from the spill container's (see
+        output_writer.DERIVED_ARRAYS), shared with the other outputters
+        writing the step when the model runs them
+        """
+        derived = getattr(self.cache, 'derived', None)
+        if derived is not None:
+            return derived(sc, name)
+
+        return DERIVED_ARRAYS[name](sc)
+
+    def thinned(self, sc):
+        '''
+        the elements of the spill container this outputter writes, by its
+        thinning -- sc itself when it writes them all
+        '''
+        if self.thinning is None:
+            return sc
+
+        return self.thinning.thin(sc, self._thinning_state)
+
     def clean_output_files(self):
         '''
         cleans out the output dir
@@ -293,6 +330,7 @@ class Outputter(Serializable):
         self._dt_since_lastoutput = None
         self._write_step = True
         self._is_first_output = True
+        self._thinning_state = {}
 
     def write_output_post_run(self,
                               model_start_time,
@@ -13,7 +13,8 @@ import glob
 import copy
 import zipfile
 import numpy as np
-import py_gd
+from gnome.utilities.lazy_import import lazy_module
+py_gd = lazy_module('py_gd')
 
 from colander import SchemaNode, String, drop
 
@@ -25,7 +26,6 @@ from gnome.utilities.serializable import Field
 from gnome.utilities.file_tools import haz_files
 from gnome.utilities import projections
 
-from gnome.basic_types import oil_status
 
 from gnome.utilities.projections import FlatEarthProjection
 
@@ -516,7 +516,7 @@ class Renderer(Outputter, MapCanvas):
             positions = sc['positions']
 
             # which ones are on land?
-            on_land = sc['status_codes'] == oil_status.on_land
+            on_land = self.derived(sc, 'on_land')
             self.draw_points(positions[on_land],
                              diameter=2,
                              color='black',
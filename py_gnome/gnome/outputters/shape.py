@@ -4,14 +4,154 @@ kmz  outputter
 
 import copy
 import os
+import struct
 import zipfile
 
+import numpy as np
+
 from colander import SchemaNode, String, drop
-import shapefile as shp
 
 from gnome.utilities.serializable import Serializable, Field
 
 from .outputter import Outputter, BaseSchema
+from .streaming import DeflatedStream, format_rows
+
+# info for prj file
+EPSG = ('GEOGCS["WGS 84",'
+        'DATUM["WGS_1984",'
+        'SPHEROID["WGS 84",6378137,298.257223563]]'
+        ',PRIMEM["Greenwich",0],'
+        'UNIT["degree",0.0174532925199433]]')
+
+# a point record of the .shp: its big endian number and content length in
+# 16 bit words, then the little endian shape type and x, y
+SHP_POINT_RECORD = np.dtype([('number', '>i4'), ('length', '>i4'),
+                             ('shape_type', '<i4'),
+                             ('x', '<f8'), ('y', '<f8')])
+# a record of the .shx: the offset and content length of the .shp record,
+# in 16 bit words
+SHX_RECORD = np.dtype([('offset', '>i4'), ('length', '>i4')])
+SHP_HEADER_SIZE = 100
+SHP_POINT = 1
+
+# the fields of the .dbf: name, dBASE type, width, decimals, and the %
+# format of the values, which must not be wider
+DBF_FIELDS = (('Year', 'C', 4, 0, '%-4d'),
+              ('Month', 'C', 2, 0, '%-2d'),
+              ('Day', 'C', 2, 0, '%-2d'),
+              ('Hour', 'C', 2, 0, '%-2d'),
+              ('LE_id', 'N', 10, 0, '%10d'),
+              ('Depth', 'N', 19, 6, '%19.6f'),
+              ('Mass', 'N', 19, 6, '%19.6f'),
+              ('Age', 'N', 10, 0, '%10d'),
+              ('Status_Code', 'N', 3, 0, '%3d'))
+
+
+class PointShapefile(object):
+    '''
+    The .shp, .shx and .dbf of a point shapefile, written a step of
+    elements at a time from their arrays and compressed as they are, for
+    add_to_zip() to put in a zip with their headers once the counts and
+    extent they have are known.
+    '''
+    def __init__(self, dirname=None):
+        self._shp = DeflatedStream(dirname)
+        self._shx = DeflatedStream(dirname)
+        self._dbf = DeflatedStream(dirname)
+
+        self.num_records = 0
+        self.bbox = None
+
+    def add_points(self, time, positions, ids, mass, age, status_codes):
+        '''
+        writes a record for each of the elements at time
+
+        :param positions: the (lon, lat, depth) of the elements
+        :type positions: Nx3 array
+        '''
+        positions = np.asarray(positions, dtype=np.float64)
+        num = len(positions)
+        if num == 0:
+            return
+
+        numbers = np.arange(self.num_records, self.num_records + num)
+
+        shp = np.empty(num, dtype=SHP_POINT_RECORD)
+        shp['number'] = numbers + 1
+        shp['length'] = (SHP_POINT_RECORD.itemsize - 8) // 2
+        shp['shape_type'] = SHP_POINT
+        shp['x'] = positions[:, 0]
+        shp['y'] = positions[:, 1]
+        self._shp.write(shp.tostring())
+
+        shx = np.empty(num, dtype=SHX_RECORD)
+        shx['offset'] = ((SHP_HEADER_SIZE +
+                          numbers * SHP_POINT_RECORD.itemsize) // 2)
+        shx['length'] = shp['length']
+        self._shx.write(shx.tostring())
+
+        # the date fields are the same for all of them, and the records
+        # start with the deletion flag
+        date_fmt = ''.join(f[4] for f in DBF_FIELDS[:4])
+        fmt = (' ' + date_fmt % (time.year, time.month, time.day, time.hour)
+               + ''.join(f[4] for f in DBF_FIELDS[4:]))
+        for text in format_rows(fmt, (ids, positions[:, 2], mass, age,
+                                      status_codes)):
+            self._dbf.write(text)
+
+        bbox = (positions[:, 0].min(), positions[:, 1].min(),
+                positions[:, 0].max(), positions[:, 1].max())
+        if self.bbox is not None:
+            bbox = (min(bbox[0], self.bbox[0]), min(bbox[1], self.bbox[1]),
+                    max(bbox[2], self.bbox[2]), max(bbox[3], self.bbox[3]))
+        self.bbox = bbox
+
+        self.num_records += num
+
+    def _shp_header(self, file_size):
+        bbox = self.bbox if self.bbox is not None else (0., 0., 0., 0.)
+
+        return (struct.pack('>6i', 9994, 0, 0, 0, 0, 0) +
+                struct.pack('>i', file_size // 2) +
+                struct.pack('<2i', 1000, SHP_POINT) +
+                struct.pack('<8d', *(bbox + (0., 0., 0., 0.))))
+
+    def _dbf_header(self, date):
+        record_size = 1 + sum(f[2] for f in DBF_FIELDS)
+        header_size = 32 + 32 * len(DBF_FIELDS) + 1
+
+        header = [struct.pack('<4BIHH20x', 3, date.year - 1900, date.month,
+                              date.day, self.num_records, header_size,
+                              record_size)]
+        for name, type_, width, decimals, _fmt in DBF_FIELDS:
+            header.append(struct.pack('<11sc4xBB14x', name, type_, width,
+                                      decimals))
+        header.append('\r')
+
+        return ''.join(header)
+
+    def add_to_zip(self, zip_file, basename, date):
+        '''
+        writes the files as the members basename.shp, .shx and .dbf of
+        zip_file, with date the last update in the .dbf's header, and
+        closes them
+        '''
+        self._dbf.write('\x1a')
+
+        shp_size = SHP_HEADER_SIZE + self._shp.size
+        shx_size = SHP_HEADER_SIZE + self._shx.size
+        self._shp.add_to_zip(zip_file, basename + '.shp',
+                             self._shp_header(shp_size))
+        self._shx.add_to_zip(zip_file, basename + '.shx',
+                             self._shp_header(shx_size))
+        self._dbf.add_to_zip(zip_file, basename + '.dbf',
+                             self._dbf_header(date))
+
+    def close(self):
+        'throws away what was written'
+        for stream in (self._shp, self._shx, self._dbf):
+            stream.close()
+
 
 class ShapeSchema(BaseSchema):
     '''
@@ -93,105 +233,51 @@ class ShapeOutput(Outputter, Serializable):
         # shouldn't be required if the above worked!
         self._file_exists_error(self.shpfilename + '.zip')
 
-        # info for prj file
-        epsg = 'GEOGCS["WGS 84",'
-        epsg += 'DATUM["WGS_1984",'
-        epsg += 'SPHEROID["WGS 84",6378137,298.257223563]]'
-        epsg += ',PRIMEM["Greenwich",0],'
-        epsg += 'UNIT["degree",0.0174532925199433]]'
-        self.epsg = epsg
-        
+        # the records are compressed as the steps come in, and the zips are
+        # put together from them after the last one
+        self._close_shapefiles()
         for sc in self.sc_pair.items():
-            w = shp.Writer(shp.POINT)
-            w.autobalance = 1
-
-            w.field('Year', 'C')
-            w.field('Month', 'C')
-            w.field('Day', 'C')
-            w.field('Hour', 'C')
-            w.field('LE id', 'N')
-            w.field('Depth', 'N')
-            w.field('Mass', 'N')
-            w.field('Age', 'N')
-            w.field('Status_Code', 'N')
-            
-            if sc.uncertain:
-                self.w_u = w
-            else:
-                self.w = w
-        
+            self._shapefiles[sc.uncertain] = \
+                PointShapefile(self.shpfiledir or None)
+
     def write_output(self, step_num, islast_step=False):
-        """dump a timestep's data into the kmz file"""
+        """dump a timestep's data into the shape files"""
 
         super(ShapeOutput, self).write_output(step_num, islast_step)
 
         if not self._write_step:
             return None
 
-        uncertain = False
-        
         for sc in self.cache.load_timestep(step_num).items():
-            
+            sc = self.thinned(sc)
             curr_time = sc.current_time_stamp
-            
-            if sc.uncertain: 
-                uncertain = True
-                for k, p in enumerate(sc['positions']):
-                    self.w_u.point(p[0],p[1])
-                    self.w_u.record(curr_time.year,
-                        curr_time.month,
-                        curr_time.day,
-                        curr_time.hour,
-                        sc['id'][k],
-                        p[2],
-                        sc['mass'][k],
-                        sc['age'][k],
-                        sc['status_codes'][k])
-            else:
-                for k, p in enumerate(sc['positions']):
-                    self.w.point(p[0],p[1])
-                    self.w.record(curr_time.year,
-                        curr_time.month,
-                        curr_time.day,
-                        curr_time.hour,
-                        sc['id'][k],
-                        p[2],
-                        sc['mass'][k],
-                        sc['age'][k],
-                        sc['status_codes'][k])
-       
+
+            self._shapefiles[sc.uncertain].add_points(curr_time,
+                                                      sc['positions'],
+                                                      sc['id'],
+                                                      sc['mass'],
+                                                      sc['age'],
+                                                      sc['status_codes'])
+
         if islast_step: # now we really write the files:
-            
-            if uncertain:
-                shapefilenames = [self.shpfilename,self.shpfilename + '_uncert']
-            else:
-                shapefilenames = [self.shpfilename]
-            
-            for fn in shapefilenames:
-
-                if uncertain:
-                    self.w_u.save(fn)
-                else:
-                    self.w.save(fn)
-                zfilename = fn + '.zip'
-
-                prj_file = open("%s.prj" % fn, "w")
-                prj_file.write(self.epsg)
-                prj_file.close()
-                
-                zipf = zipfile.ZipFile(zfilename, 'w')
-                for suf in ['shp','prj','dbf','shx']:
-                    f = os.path.split(fn)[-1] + '.' + suf
-                    zipf.write(os.path.join(self.shpfiledir, f), arcname=f)
-                    os.remove(fn + '.' + suf)
-                zipf.close()
-                
+            for uncertain, shapefile in sorted(self._shapefiles.items()):
+                fn = self.shpfilename + ('_uncert' if uncertain else '')
+                basename = os.path.split(fn)[-1]
+
+                with zipfile.ZipFile(fn + '.zip', 'w',
+                                     compression=zipfile.ZIP_DEFLATED,
+                                     allowZip64=True) as zipf:
+                    # the records, compressed already
+                    shapefile.add_to_zip(zipf, basename, curr_time)
+                    zipf.writestr(basename + '.prj', EPSG)
+
+            self._shapefiles = {}
+
         output_info = {'time_stamp': sc.current_time_stamp.isoformat(),
                        'output_filename': self.shpfilename + '.zip'}
 
         return output_info
 
-
     def rewind(self):
         '''
         reset a few parameter and call base class rewind to reset
@@ -201,6 +287,12 @@ class ShapeOutput(Outputter, Serializable):
 
         self._middle_of_run = False
         self._start_idx = 0
+        self._close_shapefiles()
+
+    def _close_shapefiles(self):
+        for shapefile in getattr(self, '_shapefiles', {}).values():
+            shapefile.close()
+        self._shapefiles = {}
 
     def delete_output_files(self):
         '''
@@ -210,11 +302,13 @@ class ShapeOutput(Outputter, Serializable):
 
         here in case it needs to be called from elsewhere
         '''
-        try:
-            os.remove(self.shpfilename + '.zip')
-            os.remove(self.shpfilename + '_uncert.zip')
-        except OSError:
-            pass # it must not be there
+        self._close_shapefiles()
+        for filename in (self.shpfilename + '.zip',
+                         self.shpfilename + '_uncert.zip'):
+            try:
+                os.remove(filename)
+            except OSError:
+                pass # it must not be there
 
 
 
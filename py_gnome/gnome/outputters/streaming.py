@@ -0,0 +1,267 @@
+"""
+streaming.py
+
+Writes the text of outputs straight from the element arrays, without
+making a Python object for each element.
+
+The rows of the arrays are formatted a chunk at a time: a chunk is one %
+of the row format repeated for each of its rows, so the formatting runs in
+C, and the output is written to the stream as it goes rather than built up
+in memory.
+
+Also here: a compact encoding of arrays for the web client, which can make
+typed arrays of the data without parsing any numbers; and DeflatedStream,
+which compresses an output as the steps come, for the kmz and shapefile
+zips to be put together at the end of a run without compressing anything.
+"""
+import json
+import time
+import base64
+import shutil
+import zlib
+import zipfile
+import tempfile
+
+import numpy as np
+
+# rows formatted at once -- bounds the memory the tuple of values takes
+CHUNK_ROWS = 10000
+
+
+def format_rows(fmt, columns, sep='', chunk_rows=CHUNK_ROWS):
+    """
+    The text of fmt % row for the rows of the columns, joined by sep,
+    yielded in pieces of chunk_rows rows
+
+    :param fmt: format of one row, with a % field for each column
+    :param columns: the columns of the rows, all the same length
+    :type columns: sequence of 1-d array-likes
+    """
+    columns = [np.asarray(c) for c in columns]
+    num_rows = len(columns[0]) if columns else 0
+
+    for start in xrange(0, num_rows, chunk_rows):
+        stop = min(num_rows, start + chunk_rows)
+
+        # the values of the rows in order, as python numbers
+        values = np.empty((stop - start, len(columns)), dtype=object)
+        for i, c in enumerate(columns):
+            values[:, i] = c[start:stop]
+
+        text = sep.join([fmt] * (stop - start)) % tuple(values.ravel())
+
+        yield sep + text if start > 0 else text
+
+
+def number_format(values, decimals=None):
+    """
+    The % format of a JSON number of the values' type, and the values
+    rounded to decimals if they are floats and it is not None -- they
+    are written as repr() writes them, like json.dump()
+    """
+    values = np.asarray(values)
+
+    if np.issubdtype(values.dtype, np.integer):
+        return '%d', values
+    elif np.issubdtype(values.dtype, np.bool_):
+        return '%d', values.astype(np.int8)
+
+    if decimals is not None:
+        values = values.round(decimals)
+
+    return '%r', values
+
+
+def write_point_features(stream, positions, properties, decimals=None,
+                         chunk_rows=CHUNK_ROWS):
+    """
+    Writes a GeoJSON FeatureCollection with a Point Feature for each
+    position, with its index as its id
+
+    :param stream: file-like object to write to
+    :param positions: the (lon, lat) of each point
+    :type positions: Nx2 (or NX3, depth is not written) array
+    :param properties: the properties of the features
+    :type properties: sequence of (name, value) pairs. A value is an
+                      array with a number for each point, or a string or
+                      number that all of them have
+    :param decimals=None: round float values to these number of digits
+    """
+    positions = np.asarray(positions)
+    num_points = len(positions)
+
+    fields = []
+    columns = [np.arange(num_points)]
+    for name, value in properties:
+        key = json.dumps(name).replace('%', '%%')
+
+        if isinstance(value, np.ndarray) and value.ndim > 0:
+            fmt, value = number_format(value, decimals)
+            columns.append(value)
+        else:
+            fmt = json.dumps(value).replace('%', '%%')
+
+        fields.append('{0}: {1}'.format(key, fmt))
+
+    lon_fmt, lon = number_format(positions[:, 0], decimals)
+    lat_fmt, lat = number_format(positions[:, 1], decimals)
+    columns += [lon, lat]
+
+    feature = ('{"type": "Feature", "id": %d, '
+               '"properties": {' + ', '.join(fields) + '}, '
+               '"geometry": {"type": "Point", "coordinates": '
+               '[' + lon_fmt + ', ' + lat_fmt + ']}}')
+
+    stream.write('{"type": "FeatureCollection", "features": [')
+    for text in format_rows(feature, columns, sep=', ',
+                            chunk_rows=chunk_rows):
+        stream.write(text)
+    stream.write(']}')
+
+
+def typed_array(values, dtype):
+    """
+    A JSON safe encoding of an array, for the web client to make a typed
+    array of: the base64 of its little endian bytes, with their dtype and
+    the shape of the array
+
+    :param dtype: the type to send the values as, e.g. '<f4' for a
+                  Float32Array
+    """
+    dtype = np.dtype(dtype).newbyteorder('<')
+    values = np.ascontiguousarray(values, dtype=dtype)
+
+    return {'dtype': values.dtype.str,
+            'shape': list(values.shape),
+            'data': base64.b64encode(values.tostring())}
+
+
+def decode_typed_array(encoded):
+    """
+    The array encoded by typed_array()
+    """
+    values = np.fromstring(base64.b64decode(encoded['data']),
+                           dtype=np.dtype(str(encoded['dtype'])))
+
+    return values.reshape(encoded['shape'])
+
+
+def _gf2_times(matrix, vector):
+    total = 0
+    i = 0
+    while vector:
+        if vector & 1:
+            total ^= matrix[i]
+        vector >>= 1
+        i += 1
+
+    return total
+
+
+def _gf2_square(matrix):
+    return [_gf2_times(matrix, row) for row in matrix]
+
+
+def crc32_combine(crc1, crc2, len2):
+    """
+    The crc32 of data1 + data2 from crc1 of data1, and crc2 and the length
+    of data2 -- zlib's crc32_combine(), which python's zlib doesn't have
+    """
+    crc1 &= 0xffffffff
+
+    # the operators of 1, 2 and 4 zero bits, then of 2**n zero bytes
+    odd = [0xedb88320] + [1 << n for n in range(31)]
+    even = _gf2_square(odd)
+    odd = _gf2_square(even)
+
+    while len2:
+        even = _gf2_square(odd)
+        if len2 & 1:
+            crc1 = _gf2_times(even, crc1)
+        len2 >>= 1
+        if not len2:
+            break
+
+        odd = _gf2_square(even)
+        if len2 & 1:
+            crc1 = _gf2_times(odd, crc1)
+        len2 >>= 1
+
+    return crc1 ^ (crc2 & 0xffffffff)
+
+
+class DeflatedStream(object):
+    """
+    A file-like object that deflates what is written to it as it comes,
+    into a temporary file, for add_to_zip() to copy into a zip as it is.
+
+    add_to_zip() can put a header in front of the data, deflated on its
+    own: the header of a format that has counts in it, like a shapefile's,
+    is only known once all the data has been written.
+    """
+    def __init__(self, dirname=None):
+        '''
+        :param dirname=None: the directory of the temporary file, the
+                             system's if None. It is deleted when the
+                             stream is closed.
+        '''
+        self._file = tempfile.TemporaryFile(dir=dirname)
+        self._compressor = zlib.compressobj(zlib.Z_DEFAULT_COMPRESSION,
+                                            zlib.DEFLATED, -15)
+        self.crc = 0
+        self.size = 0
+
+    def write(self, data):
+        self.crc = zlib.crc32(data, self.crc)
+        self.size += len(data)
+        self._file.write(self._compressor.compress(data))
+
+    def add_to_zip(self, zip_file, arcname, header=''):
+        '''
+        writes header and the data as the member arcname of zip_file, an
+        open zipfile.ZipFile, and closes the stream
+        '''
+        self._file.write(self._compressor.flush())
+
+        # the header's blocks end flushed, not final, so the data's
+        # deflate stream goes on from them
+        compressor = zlib.compressobj(zlib.Z_DEFAULT_COMPRESSION,
+                                      zlib.DEFLATED, -15)
+        deflated_header = (compressor.compress(header) +
+                           compressor.flush(zlib.Z_FULL_FLUSH))
+
+        zinfo = zipfile.ZipInfo(filename=arcname,
+                                date_time=time.localtime(time.time())[:6])
+        zinfo.compress_type = zipfile.ZIP_DEFLATED
+        zinfo.external_attr = 0o600 << 16
+        zinfo.file_size = len(header) + self.size
+        zinfo.compress_size = len(deflated_header) + self._file.tell()
+        zinfo.CRC = crc32_combine(zlib.crc32(header), self.crc, self.size)
+
+        # as ZipFile.writestr() writes a member
+        zinfo.header_offset = zip_file.fp.tell()
+        zip_file._writecheck(zinfo)
+        zip_file._didModify = True
+
+        zip64 = (zinfo.file_size > zipfile.ZIP64_LIMIT or
+                 zinfo.compress_size > zipfile.ZIP64_LIMIT)
+        if zip64 and not zip_file._allowZip64:
+            raise zipfile.LargeZipFile('Filesize would require ZIP64 '
+                                       'extensions')
+
+        zip_file.fp.write(zinfo.FileHeader(zip64))
+        zip_file.fp.write(deflated_header)
+        self._file.seek(0)
+        shutil.copyfileobj(self._file, zip_file.fp)
+        zip_file.fp.flush()
+
+        zip_file.filelist.append(zinfo)
+        zip_file.NameToInfo[zinfo.filename] = zinfo
+
+        self.close()
+
+    def close(self):
+        'throws away what was written'
+        if self._file is not None:
+            self._file.close()
+            self._file = None
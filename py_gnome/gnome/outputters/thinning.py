@@ -0,0 +1,164 @@
+#!/usr/bin/env python
+"""
+thinning.py
+
+Which of the elements of a step an outputter writes. A long run often
+only needs all of its elements near the start and where they matter --
+near the shorelines, say; an OutputThinning set as an outputter's
+thinning writes the others:
+
+  - every Kth of them, by id, so the same elements are followed all along
+  - only when they have moved more than some distance, or changed status,
+    since they were last written
+  - not at all, outside some regions of interest
+
+The elements are picked by cy_thinning.thin_elements() over the snapshot's
+arrays, and the outputter writes a ThinnedElements of them in place of the
+spill container.
+"""
+import numpy as np
+
+from gnome.basic_types import world_point_type, status_code_type
+from gnome.utilities.cy_thinning import thin_elements
+from gnome.utilities.geometry.cy_point_in_polygon import PolygonIndex
+
+
+class ThinnedElements(object):
+    '''
+    The elements of a spill container at index, as an outputter writes
+    them: its arrays are the elements' and everything else -- the time
+    stamp, the mass balance -- is the spill container's
+    '''
+    def __init__(self, sc, index):
+        self._sc = sc
+        self._index = index
+        self._arrays = {}
+
+    def __getattr__(self, name):
+        return getattr(self._sc, name)
+
+    def __getitem__(self, name):
+        if name not in self._arrays:
+            self._arrays[name] = self._sc[name][self._index]
+
+        return self._arrays[name]
+
+    def __contains__(self, name):
+        return name in self._sc
+
+    def __len__(self):
+        return len(self._index)
+
+
+class OutputThinning(object):
+    '''
+    Which elements of each step the outputters it is set on write. One can
+    be shared by several of them: what each has written is kept by the
+    outputter, in the state it passes to thin().
+    '''
+    def __init__(self,
+                 every=1,
+                 min_move=None,
+                 regions=None,
+                 full_resolution_time=None):
+        '''
+        :param every=1: write every Kth element, those whose id is a
+            multiple of it. With regions, 0 writes none outside them.
+        :type every: int
+
+        :param min_move=None: write an element only when it has moved more
+            than this many meters, or its status has changed, since it was
+            last written
+        :type min_move: float
+
+        :param regions=None: the regions of interest -- polygons of
+            (longitude, latitude), as sequences of vertices or a
+            PolygonSet. All the elements in them are written.
+
+        :param full_resolution_time=None: all the elements are written for
+            this long from the first step written
+        :type full_resolution_time: timedelta
+        '''
+        if every < 0 or (every == 0 and regions is None):
+            raise ValueError('every must be at least 1, or 0 with regions')
+
+        if min_move is not None and min_move < 0:
+            raise ValueError('min_move must not be negative')
+
+        self.every = int(every)
+        self.min_move = min_move
+        self.full_resolution_time = full_resolution_time
+
+        self._regions = (None if regions is None
+                         else PolygonIndex(regions))
+
+    def thin(self, sc, state):
+        '''
+        The elements of the spill container to write: sc itself when they
+        all are, a ThinnedElements of them when not
+
+        :param state: the outputter's dict of what it has written, empty at
+            the start of a run
+        '''
+        time_stamp = sc.current_time_stamp
+        start = state.setdefault('start_time', time_stamp)
+
+        keep_all = (self.full_resolution_time is not None and
+                    time_stamp - start < self.full_resolution_time)
+
+        if len(sc) == 0 or (keep_all and self.min_move is None):
+            return sc
+
+        if self.every == 1 and self._regions is None and \
+                self.min_move is None:
+            return sc
+
+        ids = np.ascontiguousarray(sc['id'], dtype=np.uint32)
+        last = self._last_written(state, sc.uncertain,
+                                  int(ids.max()) + 1 if len(ids) else 0)
+
+        in_region = None
+        if self._regions is not None and not keep_all:
+            in_region = self._regions.contains(sc['positions'][:, :2])
+            in_region = np.ascontiguousarray(in_region, dtype=np.uint8)
+
+        index = thin_elements(ids,
+                              np.ascontiguousarray(sc['positions'],
+                                                   dtype=world_point_type),
+                              np.ascontiguousarray(sc['status_codes'],
+                                                   dtype=status_code_type),
+                              self.every,
+                              in_region,
+                              -1. if self.min_move is None
+                              else float(self.min_move),
+                              last['positions'], last['status_codes'],
+                              last['written'],
+                              keep_all)
+
+        if len(index) == len(sc):
+            return sc
+
+        return ThinnedElements(sc, index)
+
+    def _last_written(self, state, uncertain, num_ids):
+        '''
+        the arrays of what was last written of each element of the certain
+        or the uncertain spill container, by id, grown to num_ids
+        '''
+        last = state.setdefault(uncertain, {})
+        size = len(last['written']) if last else 0
+
+        if size < num_ids:
+            # grown by at least half, elements are released a few at a time
+            size = max(num_ids, size + size // 2)
+            grown = {'positions': np.zeros((size, 3), dtype=world_point_type),
+                     'status_codes': np.zeros((size, ),
+                                              dtype=status_code_type),
+                     'written': np.zeros((size, ), dtype=np.uint8)}
+
+            for name, array in last.iteritems():
+                grown[name][:len(array)] = array
+
+            last.update(grown)
+
+        return last
@@ -0,0 +1,198 @@
+'''
+checkpoint.py
+
+Checkpoints of a model run: the state a run has built up as it stepped --
+the elements, the step the model is at, the movers' uncertainty lists and
+counters, the random number generators -- saved to a single binary file so
+a long run (a hindcast of weeks, say) can be picked up from its last
+checkpoint rather than started over.
+
+A checkpoint is not a save file: it does not hold the model's
+configuration, only where a run of it had got to. It is restored into a
+model set up as the checkpointed one was -- loaded from the same save
+file, or made by the same script -- with the same build of lib_gnome.
+
+What is not in a checkpoint:
+
+- the state of the C library rand(), which can't be read. The movers that
+  draw from their own random streams (see cy_helpers.set_random_stream)
+  or by step (the random movers) go on with the very numbers they would
+  have drawn; anything that calls rand() goes on with numbers of the
+  same distribution, from seed + step.
+- the outputters: they are set up again for the run, and write from the
+  step the run is picked up at.
+- the time intervals of gridded data the movers had loaded, which are
+  loaded again on the first step after the restore.
+'''
+import os
+import random
+import cPickle
+from datetime import datetime, date, timedelta
+
+import numpy as np
+
+from gnome.cy_gnome import cy_helpers
+
+CHECKPOINT_VERSION = 1
+
+# attributes that are who an object is, not what state it is in
+_skip = ('id', '_id', '_log')
+
+_plain_types = (type(None), bool, int, long, float, str, unicode,
+                datetime, date, timedelta, np.generic)
+
+
+def is_plain(value):
+    '''
+    whether the value is data -- numbers, strings, times, arrays of them
+    and containers of them -- rather than an object of the model
+    '''
+    if isinstance(value, _plain_types):
+        return True
+
+    if isinstance(value, np.ndarray):
+        return not value.dtype.hasobject
+
+    if isinstance(value, (list, tuple)):
+        return all(is_plain(v) for v in value)
+
+    if isinstance(value, dict):
+        return all(is_plain(k) and is_plain(v) for k, v in value.iteritems())
+
+    return False
+
+
+def plain_state(obj):
+    '''
+    the plain attributes of obj -- its state, without the objects it
+    refers to, which are checkpointed (or set up again) on their own
+    '''
+    return dict((key, value) for key, value in vars(obj).iteritems()
+                if key not in _skip and is_plain(value))
+
+
+def _check_match(kind, saved, objs):
+    names = [obj.__class__.__name__ for obj in objs]
+
+    if [s[0] for s in saved] != names:
+        raise ValueError('the checkpoint has {0} {1}, the model has '
+                         '{2}'.format(kind, [s[0] for s in saved], names))
+
+
+def _collection_state(objs):
+    return [(obj.__class__.__name__, plain_state(obj)) for obj in objs]
+
+
+def _cy_mover(mover):
+    cy_mover = getattr(mover, 'mover', None)
+
+    return cy_mover if hasattr(cy_mover, 'get_run_state') else None
+
+
+def save_checkpoint(model, filename):
+    '''
+    Saves a checkpoint of the run of model at its current step to filename.
+    The file is written next to it first, and put in place when it is
+    complete, so a run that stops while checkpointing leaves the last one.
+    '''
+    if model.current_time_step < 0:
+        raise ValueError('the model has not been stepped -- there is '
+                         'nothing to checkpoint')
+
+    spills = []
+    for sc in model.spills.items():
+        spills.append({'spill_container': plain_state(sc),
+                       'spills': [(plain_state(spill),
+                                   plain_state(spill.release))
+                                  for spill in sc.spills]})
+
+    movers = []
+    for mover in model.movers:
+        cy_mover = _cy_mover(mover)
+        movers.append((mover.__class__.__name__,
+                       plain_state(mover),
+                       cy_mover.get_run_state() if cy_mover else None))
+
+    checkpoint = {'version': CHECKPOINT_VERSION,
+                  'current_time_step': model.current_time_step,
+                  'model_time': model.model_time,
+                  'spills': spills,
+                  'movers': movers,
+                  'weatherers': _collection_state(model.weatherers),
+                  'environment': _collection_state(model.environment),
+                  'cache': model._cache.checkpoint_state(),
+                  'random': (random.getstate(),
+                             np.random.get_state(),
+                             cy_helpers.get_random_state())}
+
+    tmp = filename + '.tmp'
+    with open(tmp, 'wb') as fd:
+        cPickle.dump(checkpoint, fd, cPickle.HIGHEST_PROTOCOL)
+
+    if os.path.exists(filename):
+        # os.rename won't replace a file on Windows
+        os.remove(filename)
+    os.rename(tmp, filename)
+
+
+def restore_checkpoint(model, filename):
+    '''
+    Picks up the run of model from the checkpoint in filename: the model is
+    rewound and set up for the run, then put at the step it was at. The
+    next call to step() runs the step after the checkpoint.
+
+    Raises ValueError if the checkpoint is not of a model like this one.
+    '''
+    with open(filename, 'rb') as fd:
+        checkpoint = cPickle.load(fd)
+
+    if checkpoint.get('version') != CHECKPOINT_VERSION:
+        raise ValueError('{0} is not a version {1} checkpoint'
+                         .format(filename, CHECKPOINT_VERSION))
+
+    containers = model.spills.items()
+    if (len(checkpoint['spills']) != len(containers) or
+            [len(s['spills']) for s in checkpoint['spills']] !=
+            [len(sc.spills) for sc in containers]):
+        raise ValueError('the checkpoint is of a model with other spills')
+
+    _check_match('movers', checkpoint['movers'], model.movers)
+    _check_match('weatherers', checkpoint['weatherers'], model.weatherers)
+    _check_match('environment', checkpoint['environment'],
+                 model.environment)
+
+    model.rewind()
+    model.setup_model_run()
+
+    for saved, sc in zip(checkpoint['spills'], containers):
+        sc.__dict__.update(saved['spill_container'])
+
+        for (spill_state, release_state), spill in zip(saved['spills'],
+                                                       sc.spills):
+            spill.__dict__.update(spill_state)
+            spill.release.__dict__.update(release_state)
+
+    for (_name, state, run_state), mover in zip(checkpoint['movers'],
+                                               model.movers):
+        mover.__dict__.update(state)
+
+        if run_state is not None:
+            _cy_mover(mover).set_run_state(run_state)
+
+    for saved, objs in ((checkpoint['weatherers'], model.weatherers),
+                        (checkpoint['environment'], model.environment)):
+        for (_name, state), obj in zip(saved, objs):
+            obj.__dict__.update(state)
+
+    model._cache.restore_checkpoint_state(checkpoint['cache'])
+
+    py_state, np_state, lib_state = checkpoint['random']
+    random.setstate(py_state)
+    np.random.set_state(np_state)
+
+    # rand() can only be seeded; set_random_state() puts the streams back
+    cy_helpers.srand(lib_state[0] + checkpoint['current_time_step'])
+    cy_helpers.set_random_state(lib_state)
+
+    model.current_time_step = checkpoint['current_time_step']
+    model.model_time = checkpoint['model_time']
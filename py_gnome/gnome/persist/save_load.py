@@ -6,8 +6,13 @@ import shutil
 import json
 import zipfile
 import logging
+from contextlib import contextmanager
+
+import numpy as np
 
 import gnome
+from gnome.utilities.remote_data import is_remote_path
+from gnome.utilities.setup_profile import SetupStage
 
 # as long as loggers are configured before module is loaded, module scope
 # logger will work. If loggers are configured after this module is loaded and
@@ -23,9 +28,14 @@ class References(object):
     it is merely referenced by the WindMover. When persisting a Model, the
     referenced objects are saved in their own file and a reference is stored
     for it. This class manages these references.
+
+    The References of a load also say how it loads: lazy is passed on to the
+    objects that can put off reading their data files (see
+    Savable.loads()).
     '''
-    def __init__(self):
+    def __init__(self, lazy=False):
         self._refs = {}
+        self.lazy = lazy
 
     def __contains__(self, obj):
         if self.get_reference(obj):
@@ -112,7 +122,7 @@ def class_from_objtype(obj_type):
         raise
 
 
-def load(saveloc, fname='Model.json', references=None):
+def load(saveloc, fname='Model.json', references=None, lazy=False):
     '''
     read json from file and load the appropriate object
     This is a general purpose load method that looks at the json['obj_type']
@@ -125,6 +135,10 @@ def load(saveloc, fname='Model.json', references=None):
         must contain 'fname'
     :param references=None: References object that keeps track of objects
         in a dict as they are constructed, using the filename as the key
+    :param lazy=False: if True, the objects that read forcing data files
+        when they are made -- the gridded current and wind movers -- read
+        them the first time they are used instead. Only used if references
+        is None; a References object says if its load is lazy.
 
     :returns: object constructed from the json
 
@@ -179,6 +193,95 @@ def load(saveloc, fname='Model.json', references=None):
     return obj
 
 
+# the zipfiles being saved to, open for the whole save, by filename
+_open_zips = {}
+
+
+@contextmanager
+def open_savezip(saveloc, allowZip64=False):
+    '''
+    context manager of the ZipFile for appending to the zipfile saveloc.
+    Saves within the with statement of an open_savezip() all append to the
+    one ZipFile, rather than each opening the zipfile, reading its central
+    directory, and writing it again on closing.
+
+    .. note:: until the outermost with statement ends, saveloc is not a
+        zipfile to zipfile.is_zipfile() -- use is_savezip()
+    '''
+    if saveloc in _open_zips:
+        yield _open_zips[saveloc]
+        return
+
+    z = zipfile.ZipFile(saveloc, 'a',
+                        compression=zipfile.ZIP_DEFLATED,
+                        allowZip64=allowZip64)
+    _open_zips[saveloc] = z
+    try:
+        yield z
+    finally:
+        del _open_zips[saveloc]
+        z.close()
+
+
+def is_savezip(saveloc):
+    '''
+    True if saveloc is a zipfile, or one open_savezip() is saving to
+    '''
+    return saveloc in _open_zips or zipfile.is_zipfile(saveloc)
+
+
+def _dtype_from_descr(descr):
+    '''
+    the dtype of descr, a numpy.lib.format.dtype_to_descr() read back from
+    json: the fields of record dtypes are lists, not tuples
+    '''
+    if isinstance(descr, basestring):
+        return np.dtype(descr)
+
+    return np.dtype([(f[0], _dtype_from_descr(f[1])) +
+                     tuple(tuple(shape) for shape in f[2:])
+                     for f in descr])
+
+
+def write_array(saveloc, name, array, allowZip64=False):
+    '''
+    writes the bytes of array as they are in memory to the file name in
+    saveloc -- an entry of the zipfile, stored, not deflated, or a file in
+    the directory -- and returns the dict read_array() reads it back with.
+    A contiguous array is written without being copied.
+    '''
+    array = np.ascontiguousarray(array)
+
+    if is_savezip(saveloc):
+        with open_savezip(saveloc, allowZip64) as z:
+            z.writestr(name, buffer(array), zipfile.ZIP_STORED)
+    else:
+        array.tofile(os.path.join(saveloc, name))
+
+    return {'file': name,
+            'dtype': np.lib.format.dtype_to_descr(array.dtype),
+            'shape': list(array.shape)}
+
+
+def read_array(saveloc, array_json):
+    '''
+    reads back the array write_array() wrote, from the zipfile or directory
+    saveloc
+    '''
+    dtype = _dtype_from_descr(array_json['dtype'])
+
+    if zipfile.is_zipfile(saveloc):
+        with zipfile.ZipFile(saveloc, 'r') as z:
+            data = z.read(array_json['file'])
+
+        array = np.frombuffer(data, dtype=dtype).copy()
+    else:
+        array = np.fromfile(os.path.join(saveloc, array_json['file']),
+                            dtype=dtype)
+
+    return array.reshape(array_json['shape'])
+
+
 '''
 Define general purpose functions for checking and rejecting bad zipfiles
 '''
@@ -192,12 +295,16 @@ class Savable(object):
     '''
     _allowzip64 = False
 
+    # set by the classes with a 'lazy' kwarg for putting off reading their
+    # data files, which a lazy load passes them
+    _lazy_load = False
+
     def _ref_in_saveloc(self, saveloc, ref):
         '''
         returns true if reference is found in saveloc, false otherwise
         '''
-        if zipfile.is_zipfile(saveloc):
-            with zipfile.ZipFile(saveloc, 'r') as z:
+        if is_savezip(saveloc):
+            with open_savezip(saveloc, self._allowzip64) as z:
                 if ref in z.namelist():
                     return True
                 else:
@@ -267,7 +374,7 @@ class Savable(object):
 
         # move datafiles to saveloc
         json_ = self._move_data_file(saveloc, json_)
-        if zipfile.is_zipfile(saveloc):
+        if is_savezip(saveloc):
             self._write_to_zip(saveloc, f_name, json.dumps(json_, indent=True))
         else:
             # make last leaf of save location if it doesn't exist
@@ -287,9 +394,7 @@ class Savable(object):
         f_name is the archive name and s_data is the corresponding string,
         added to zipfile
         '''
-        with zipfile.ZipFile(saveloc, 'a',
-                             compression=zipfile.ZIP_DEFLATED,
-                             allowZip64=self._allowzip64) as z:
+        with open_savezip(saveloc, self._allowzip64) as z:
             z.writestr(f_name, s_data)
 
     def save(self, saveloc, references=None, name=None):
@@ -334,14 +439,16 @@ class Savable(object):
             if field.name not in json_:
                 continue
 
+            if is_remote_path(json_[field.name]):
+                # read from its server wherever the save file is loaded
+                continue
+
             # data filename
             d_fname = os.path.split(json_[field.name])[1]
 
-            if zipfile.is_zipfile(saveloc):
+            if is_savezip(saveloc):
                 # add datafile to zip archive
-                with zipfile.ZipFile(saveloc, 'a',
-                                     compression=zipfile.ZIP_DEFLATED,
-                                     allowZip64=self._allowzip64) as z:
+                with open_savezip(saveloc, self._allowzip64) as z:
                     if d_fname not in z.namelist():
                         z.write(json_[field.name], d_fname)
             else:
@@ -390,7 +497,8 @@ class Savable(object):
 
         # fix datafiles path from relative to absolute so we can load datafiles
         for field in datafiles:
-            if field.name in json_data:
+            if (field.name in json_data and
+                    not is_remote_path(json_data[field.name])):
                 # ZipCheck: path must only be defined relative to saveloc
                 # currently, all datafiles stored at same level in saveloc,
                 # no subdirectories.
@@ -432,11 +540,15 @@ class Savable(object):
         cls._update_datafile_path(json_data, saveloc)
 
         # deserialize after removing references
+        setup_stage = SetupStage('deserialize')
         _to_dict = cls.deserialize(json_data)
 
         if ref_dict:
             _to_dict.update(ref_dict)
 
+        if references.lazy and cls._lazy_load:
+            _to_dict['lazy'] = True
+
         c_fields = cls._state.get_field_by_attribute('iscollection')
         for field in c_fields:
             _to_dict[field.name] = cls._load_collection(saveloc,
@@ -444,6 +556,7 @@ class Savable(object):
                                                         references)
 
         obj = cls.new_from_dict(_to_dict)
+        setup_stage.done(obj)
 
         return obj
 
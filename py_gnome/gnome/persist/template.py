@@ -0,0 +1,177 @@
+'''
+template.py
+
+Model templates: the model of a location file built once, for the web
+service to make the models of its requests from.
+
+Building a model from a location file reads its forcing files, sets up
+their grids and DAG trees in lib_gnome and computes its tide caches, mostly
+on the model's first step. A ModelTemplate does all of that once, with
+warm(). Then:
+
+- run_forked() runs a function of the model in a child process forked from
+  this one. The child starts with the template's model as it is, grids,
+  trees and tides in the pages it shares with this process, copy on write:
+  nothing is read or set up again, and nothing the child does to the model
+  comes back. What the function returns is pickled back to the parent.
+- new_model() is a model of its own loaded from the location file, lazily
+  (see save_load.load()), for where there is no fork. Its forcing is read
+  the first time it is used.
+
+    template = get_template('location_files/ny_harbor.zip')
+    output = template.run_forked(lambda model: list(model))
+'''
+import os
+import shutil
+import zipfile
+import tempfile
+import threading
+import cPickle
+
+from gnome.model import Model
+from gnome.movers import LazyForcing
+from gnome.outputters import Outputter
+from gnome.utilities.orderedcollection import OrderedCollection
+from gnome.persist.save_load import zipfile_folders, extract_zipfile
+
+
+class ModelTemplate(object):
+    '''
+    The model of a location file, warmed up, to make models from
+    '''
+    def __init__(self, saveloc, warm=True):
+        '''
+        :param saveloc: the location file: a zipfile, or a directory with the
+            contents of one. A zipfile is extracted once, to a directory of
+            the template's own.
+        :param warm=True: if True, warm() the model: read its forcing and set
+            up its first step
+        '''
+        self.saveloc = saveloc
+        self._tmpdir = None
+
+        if zipfile.is_zipfile(saveloc):
+            self._tmpdir = tempfile.mkdtemp(prefix='gnome_template_')
+            with zipfile.ZipFile(saveloc, 'r') as z:
+                folders = zipfile_folders(z)
+                prefix = folders[0] if len(folders) == 1 else ''
+                extract_zipfile(z, self._tmpdir, prefix)
+
+            self._dir = self._tmpdir
+        else:
+            self._dir = saveloc
+
+        self.model = Model.load_savefile(self._dir, lazy=True)
+
+        if warm:
+            self.warm()
+
+    def warm(self):
+        '''
+        reads the forcing of the model and sets its movers, weatherers and
+        environment up for the first step -- all the model does on its first
+        step but move the elements and write output -- then rewinds it
+        '''
+        model = self.model
+
+        for mover in model.movers:
+            if isinstance(mover, LazyForcing):
+                # the property reads the forcing put off by the lazy load
+                mover.mover
+
+        # the outputters would write files for the step
+        outputters = model.outputters
+        model.outputters = OrderedCollection(dtype=Outputter)
+        try:
+            model.setup_model_run()
+            model.setup_time_step()
+        finally:
+            model.outputters = outputters
+            model.rewind()
+
+    def new_model(self):
+        '''
+        a model of its own, lazily loaded from the location file
+        '''
+        return Model.load_savefile(self._dir, lazy=True)
+
+    def run_forked(self, func, *args, **kwargs):
+        '''
+        func(model, \\*args, \\*\\*kwargs) in a child process forked from this
+        one, where model is the template's model as it is here.
+
+        :returns: what func returned, pickled back from the child
+        :raises: the exception func raised in the child, or RuntimeError if
+            the child died without sending anything back
+        '''
+        read_fd, write_fd = os.pipe()
+        pid = os.fork()
+
+        if pid == 0:
+            os.close(read_fd)
+            try:
+                try:
+                    result = (True, func(self.model, *args, **kwargs))
+                except Exception, err:
+                    result = (False, err)
+
+                with os.fdopen(write_fd, 'wb') as out:
+                    try:
+                        data = cPickle.dumps(result, cPickle.HIGHEST_PROTOCOL)
+                    except Exception, err:
+                        data = cPickle.dumps((False, RuntimeError(repr(err))),
+                                             cPickle.HIGHEST_PROTOCOL)
+                    out.write(data)
+            finally:
+                # not sys.exit(): the child doesn't run the parent's cleanup
+                os._exit(0)
+
+        os.close(write_fd)
+        with os.fdopen(read_fd, 'rb') as inp:
+            data = inp.read()
+
+        os.waitpid(pid, 0)
+
+        if not data:
+            raise RuntimeError('the forked model run died without a result')
+
+        succeeded, result = cPickle.loads(data)
+        if not succeeded:
+            raise result
+
+        return result
+
+    def close(self):
+        '''
+        removes the directory the location file was extracted to
+        '''
+        if self._tmpdir is not None:
+            shutil.rmtree(self._tmpdir, ignore_errors=True)
+            self._tmpdir = None
+
+
+# the templates of get_template(), by location file
+_templates = {}
+_templates_lock = threading.Lock()
+
+
+def get_template(saveloc):
+    '''
+    the ModelTemplate of the location file saveloc, made the first time it is
+    asked for
+    '''
+    key = os.path.abspath(saveloc)
+
+    with _templates_lock:
+        if key not in _templates:
+            _templates[key] = ModelTemplate(saveloc)
+
+        return _templates[key]
+
+
+def clear_templates():
+    with _templates_lock:
+        for template in _templates.values():
+            template.close()
+
+        _templates.clear()
@@ -10,6 +10,7 @@ from release import (Release,
                      GridRelease,
                      VerticalPlumeRelease,
                      InitElemsFromFile)
+from element_manager import ElementManager
 import elements
 
 __all__ = [Spill,
@@ -25,5 +26,6 @@ __all__ = [Spill,
            GridRelease,
            VerticalPlumeRelease,
            InitElemsFromFile,
+           ElementManager,
            elements,
            ]
@@ -0,0 +1,188 @@
+'''
+Super-particle management: merging the light elements of the far field of
+a long run into heavier ones, and splitting them again where the run needs
+its resolution, for Model.element_manager
+'''
+import numpy as np
+
+from gnome.basic_types import oil_status
+from gnome.utilities.projections import FlatEarthProjection
+from gnome.cy_gnome.cy_land_check import distance_field
+
+
+class ElementManager(object):
+    '''
+    Merges the elements in the water that are in the same cell of a
+    longitude, latitude and depth grid, and are of the same spill and
+    substance with similar densities and viscosities, into super-particles
+    of at most about max_mass -- so the number of elements, and the cost of
+    every mover and weatherer with it, follows the resolution the run needs
+    instead of all it released. The mass is conserved: see
+    SpillContainer.merge_elements().
+
+    Near the shore and the response targets, the elements are left alone
+    and the ones heavier than split_mass are split into parts no heavier
+    (see SpillContainer.split_elements()), so the resolution is back where
+    it matters.
+
+    The model runs it after step_is_done, every interval steps, on the
+    forecast spill container: the uncertain one keeps lib_gnome's
+    uncertainty state by element index. The numbers merged and split are in
+    the spill container's element_counts.
+    '''
+    def __init__(self, cell_size=0.01, depth_size=1., max_mass=None,
+                 split_mass=None, min_age=0, tolerance=0.1,
+                 shore_distance=None, targets=(), interval=1):
+        '''
+        :param cell_size: the size in degrees of the cells of the elements
+            merged together
+        :param depth_size: the size in meters of their depth layers
+        :param max_mass: the mass in kg of a super-particle, about, None for
+            no limit
+        :param split_mass: the mass in kg of the parts of the elements near
+            the shore and the targets, None not to split them
+        :param min_age: the age in seconds of the elements merged
+        :param tolerance: the relative difference of the densities and
+            viscosities of the elements merged together, about
+        :param shore_distance: the distance in pixels of a raster map of the
+            elements near the shore, None for no shore
+        :param targets: (lon, lat, radius in meters) of each response target
+        :param interval: the number of steps between runs
+        '''
+        if (max_mass is not None and split_mass is not None and
+                split_mass > max_mass):
+            raise ValueError('split_mass must be no more than max_mass')
+
+        self.cell_size = cell_size
+        self.depth_size = depth_size
+        self.max_mass = max_mass
+        self.split_mass = split_mass
+        self.min_age = min_age
+        self.tolerance = tolerance
+        self.shore_distance = shore_distance
+        self.targets = list(targets)
+        self.interval = interval
+
+        # the distance field of the map without one, made the first time
+        self._distance = (None, None)
+
+    def __repr__(self):
+        return ('{0.__class__.__name__}(cell_size={0.cell_size}, '
+                'max_mass={0.max_mass}, split_mass={0.split_mass}, '
+                'interval={0.interval})'.format(self))
+
+    def _near_shore(self, sc, map_):
+        positions = sc['positions']
+        near = np.zeros((len(positions),), dtype=bool)
+
+        if self.shore_distance is None or not hasattr(map_, 'basebitmap'):
+            return near
+
+        distance = map_.distance
+        if distance is None:
+            bitmap, distance = self._distance
+            if bitmap is not map_.basebitmap:
+                distance = distance_field(map_.basebitmap)
+                self._distance = (map_.basebitmap, distance)
+
+        pixels = map_.projection.to_pixel(positions, asint=True)
+        on_raster = ((pixels[:, 0] >= 0) & (pixels[:, 0] < distance.shape[0]) &
+                     (pixels[:, 1] >= 0) & (pixels[:, 1] < distance.shape[1]))
+        near[on_raster] = (distance[pixels[on_raster, 0],
+                                    pixels[on_raster, 1]] <=
+                           self.shore_distance)
+
+        return near
+
+    def _near_targets(self, sc):
+        positions = sc['positions']
+        near = np.zeros((len(positions),), dtype=bool)
+
+        for lon, lat, radius in self.targets:
+            delta = positions - (lon, lat, 0.)
+            delta[:, 2] = 0.
+            meters = FlatEarthProjection.lonlat_to_meters(delta, positions)
+            near |= (meters[:, 0] ** 2 + meters[:, 1] ** 2) <= radius ** 2
+
+        return near
+
+    def _property_bins(self, values):
+        'the bins of relative width tolerance of positive values, -1 if not'
+        bins = np.full(values.shape, -1, dtype=np.int64)
+        positive = values > 0.
+        bins[positive] = np.floor(np.log(values[positive]) /
+                                  np.log1p(self.tolerance))
+
+        return bins
+
+    def _groups(self, sc, merge):
+        '''
+        the super-particle of each element, -1 for the ones not merged
+        '''
+        idx = np.where(merge)[0]
+        positions = sc['positions'][idx]
+
+        keys = [np.floor(positions[:, 0] / self.cell_size),
+                np.floor(positions[:, 1] / self.cell_size),
+                np.floor(positions[:, 2] / self.depth_size),
+                sc['spill_num'][idx]]
+        if 'substance' in sc:
+            keys.append(sc['substance'][idx])
+        for name in ('density', 'viscosity'):
+            if name in sc:
+                keys.append(self._property_bins(sc[name][idx]))
+
+        keys = np.column_stack(keys).astype(np.int64)
+        order = np.lexsort(keys.T[::-1])
+        idx = idx[order]
+        keys = keys[order]
+
+        new_cell = np.r_[True, np.any(keys[1:] != keys[:-1], axis=1)]
+        if self.max_mass is not None:
+            # a new super-particle every max_mass of the cell's mass
+            mass = sc['mass'][idx]
+            cum = np.cumsum(mass) - mass
+            cell_start = np.maximum.accumulate(np.where(new_cell, cum, 0.))
+            chunk = np.floor((cum - cell_start) / self.max_mass)
+            new_cell |= np.r_[True, chunk[1:] != chunk[:-1]]
+
+        groups = np.full((len(sc),), -1, dtype=np.int64)
+        groups[idx] = np.cumsum(new_cell) - 1
+
+        return groups
+
+    def manage(self, sc, map_):
+        '''
+        Splits the heavy elements near the shore and the targets, and merges
+        the others.
+
+        :param sc: the forecast spill container
+        :param map_: the model's map, for the shore
+        :returns: the number of elements merged away, and added by splits
+        '''
+        if len(sc) == 0:
+            sc.element_counts = {'merged': 0, 'split': 0, 'elements': 0}
+            return 0, 0
+
+        near = self._near_shore(sc, map_) | self._near_targets(sc)
+        in_water = sc['status_codes'] == oil_status.in_water
+
+        num_split = 0
+        if self.split_mass is not None:
+            split = np.where(near & in_water &
+                             (sc['mass'] > self.split_mass))[0]
+            nums = np.ceil(sc['mass'][split] / self.split_mass).astype(np.int_)
+            num_split = sc.split_elements(split, nums)
+
+            near = np.r_[near, np.ones((num_split,), dtype=bool)]
+            in_water = sc['status_codes'] == oil_status.in_water
+
+        merge = (~near & in_water & (sc['mass'] > 0.) &
+                 (sc['age'] >= self.min_age))
+        num_merged = sc.merge_elements(self._groups(sc, merge))
+
+        sc.element_counts = {'merged': num_merged,
+                             'split': num_split,
+                             'elements': len(sc)}
+
+        return num_merged, num_split
@@ -151,17 +151,19 @@ class ElementType(Serializable):
 
         return at
 
-    def set_newparticle_values(self, num_new_particles, spill, data_arrays):
+    def set_newparticle_values(self, num_new_particles, spill, data_arrays,
+                               rng=None):
         '''
         call all initializers. This will set the initial values for all
-        data_arrays.
+        data_arrays. The initializers draw their random values from rng, an
+        ElementRandom of the new particles, if it is given.
         '''
         if num_new_particles > 0:
             for i in self.initializers:
                 # looks like issubset() looks at data_arrays.keys()
                 if i.array_types.issubset(data_arrays):
                     i.initialize(num_new_particles, spill, data_arrays,
-                                 self.substance)
+                                 self.substance, rng=rng)
 
     def to_dict(self):
         """
@@ -47,10 +47,14 @@ class InitBaseClass(object):
         # set_newparticle_values()
         self.array_types = set()
 
-    def initialize(self, num_new_particles, spill, data_arrays, substance):
+    def initialize(self, num_new_particles, spill, data_arrays, substance,
+                   rng=None):
         """
         all classes that derive from Base class must implement initialize
         method
+
+        rng is the ElementRandom of the new particles their random values
+        are drawn from - numpy.random if it is None
         """
         pass
 
@@ -137,7 +141,7 @@ class InitWindages(InitBaseClass, Serializable):
         self._windage_range = val
 
     def initialize(self, num_new_particles, spill, data_arrays,
-                   substance=None):
+                   substance=None, rng=None):
         """
         Since windages exists in data_arrays, so must windage_range and
         windage_persist if this initializer is used/called
@@ -154,7 +158,8 @@ class InitWindages(InitBaseClass, Serializable):
         random_with_persistance(
                     data_arrays['windage_range'][-num_new_particles:][:, 0],
                     data_arrays['windage_range'][-num_new_particles:][:, 1],
-                    data_arrays['windages'][-num_new_particles:])
+                    data_arrays['windages'][-num_new_particles:],
+                    rng=rng)
 
 
 # do following two classes work for a time release spill?
@@ -175,7 +180,8 @@ class InitMassFromPlume(InitBaseClass, Serializable):
         self.array_types.add('mass')
         self.name = 'mass'
 
-    def initialize(self, num_new_particles, spill, data_arrays, substance):
+    def initialize(self, num_new_particles, spill, data_arrays, substance,
+                   rng=None):
         if spill.plume_gen is None:
             raise ValueError('plume_gen attribute of spill is None - cannot'
                              ' compute mass without plume mass flux')
@@ -253,7 +259,7 @@ class InitRiseVelFromDist(DistributionBase):
              * WeibullDistribution
             New distribution classes could be made.  The only
             requirement is they need to have a set_values()
-            method which accepts a NumPy array.
+            method which accepts a NumPy array and an optional rng.
             (presumably, this function will also modify
              the array in some way)
         """
@@ -269,10 +275,11 @@ class InitRiseVelFromDist(DistributionBase):
         self.name = 'rise_vel'
 
     def initialize(self, num_new_particles, spill, data_arrays,
-                   substance=None):
+                   substance=None, rng=None):
         'Update values of "rise_vel" data array for new particles'
         self.distribution.set_values(
-                            data_arrays['rise_vel'][-num_new_particles:])
+                            data_arrays['rise_vel'][-num_new_particles:],
+                            rng=rng)
 
 
 class InitRiseVelFromDropletSizeFromDist(DistributionBase):
@@ -298,7 +305,7 @@ class InitRiseVelFromDropletSizeFromDist(DistributionBase):
          * WeibullDistribution
         New distribution classes could be made.  The only
         requirement is they need to have a set_values()
-        method which accepts a NumPy array.
+        method which accepts a NumPy array and an optional rng.
         (presumably, this function will also modify
          the array in some way)
         :param water_density: 1020.0 [kg/m3]
@@ -319,7 +326,8 @@ class InitRiseVelFromDropletSizeFromDist(DistributionBase):
         self.array_types.update(('rise_vel', 'droplet_diameter'))
         self.name = 'rise_vel'
 
-    def initialize(self, num_new_particles, spill, data_arrays, substance):
+    def initialize(self, num_new_particles, spill, data_arrays, substance,
+                   rng=None):
         """
         Update values of 'rise_vel' and 'droplet_diameter' data arrays for
         new particles. First create a droplet_size array sampled from specified
@@ -331,7 +339,7 @@ class InitRiseVelFromDropletSizeFromDist(DistributionBase):
         drop_size = np.zeros((num_new_particles, ), dtype=np.float64)
         le_density = np.zeros((num_new_particles, ), dtype=np.float64)
 
-        self.distribution.set_values(drop_size)
+        self.distribution.set_values(drop_size, rng=rng)
 
         data_arrays['droplet_diameter'][-num_new_particles:] = drop_size
         le_density[:] = substance.get_density()
@@ -170,6 +170,32 @@ class Release(object):
         """
         pass
 
+    def release_positions(self):
+        """
+        the positions the release starts its elements from, an Nx3 array:
+        the start_position, and the end_position of a line, or each
+        position of a SpatialRelease. Empty if it has none.
+        """
+        positions = [getattr(self, 'start_position', None),
+                     getattr(self, 'end_position', None)]
+        positions = [pos for pos in positions if pos is not None]
+        if not positions:
+            return np.zeros((0, 3), dtype=world_point_type)
+
+        return np.vstack([np.asarray(pos, dtype=world_point_type)
+                          .reshape((-1, 3)) for pos in positions])
+
+    def positions_not_allowed(self, spill_map):
+        """
+        the indexes into release_positions() of the positions that aren't
+        allowable spill positions of spill_map, checked in one batch
+        """
+        positions = self.release_positions()
+        if len(positions) == 0:
+            return np.zeros((0,), dtype=np.int64)
+
+        return np.nonzero(~spill_map.allowable_spill_batch(positions))[0]
+
     def rewind(self):
         """
         rewinds the Release to original status (before anything has been
@@ -907,7 +933,7 @@ class SpatialRelease(Release, Serializable):
         data_arrays['positions'][-self.num_released:] = self.start_position
 
 
-def GridRelease(release_time, bounds, resolution):
+def GridRelease(release_time, bounds, resolution, spill_map=None):
     """
     Utility function that creates a SpatialRelease with a grid of elements.
 
@@ -917,12 +943,18 @@ def GridRelease(release_time, bounds, resolution):
                    ((min_lon, min_lat),
                     (max_lon, max_lat))
     :type bounds: 2x2 numpy array or equivalent
+
+    :param spill_map: if given, only the grid points that are allowable
+                      spill positions of this map get an element
     """
     lon = np.linspace(bounds[0][0], bounds[1][0], resolution)
     lat = np.linspace(bounds[0][1], bounds[1][1], resolution)
     lon, lat = np.meshgrid(lon, lat)
     positions = np.c_[lon.flat, lat.flat, np.zeros((resolution * resolution),)]
 
+    if spill_map is not None:
+        positions = positions[spill_map.allowable_spill_batch(positions)]
+
     return SpatialRelease(release_time, positions)
 
 
@@ -539,7 +539,7 @@ class Spill(serializable.Serializable):
         return self.release.num_elements_to_release(current_time, time_step)
 
     def set_newparticle_values(self, num_new_particles, current_time,
-                               time_step, data_arrays):
+                               time_step, data_arrays, rng=None):
         """
         SpillContainer will release elements and initialize all data_arrays
         to default initial value. The SpillContainer gets passed as input and
@@ -560,13 +560,15 @@ class Spill(serializable.Serializable):
             Look for 'positions' array in the dict and update positions for
             latest num_new_particles that are released
         :type data_arrays: dict containing numpy arrays for values
+        :param rng: ElementRandom of the new particles the initializers draw
+            their random values from. Default is None for numpy.random
 
         Also, the set_newparticle_values() method for all element_type gets
         called so each element_type sets the values for its own data correctly
         """
         if self.element_type is not None:
             self.element_type.set_newparticle_values(num_new_particles, self,
-                                                     data_arrays)
+                                                     data_arrays, rng=rng)
 
         self.release.set_newparticle_positions(num_new_particles, current_time,
                                                time_step, data_arrays)
@@ -7,6 +7,7 @@ set of arrays. The spills themselves provide some of the arrays themselves
 (adding more each time LEs are released).
 """
 import os
+import tempfile
 from collections import namedtuple
 
 import numpy as np
@@ -27,6 +28,8 @@ from gnome.array_types import (positions,
                                ArrayType)
 
 from gnome.utilities.orderedcollection import OrderedCollection
+from gnome.utilities.rand import ElementRandom
+from gnome.utilities.scratch import ScratchPool
 import gnome.spill
 from gnome import AddLogger
 from gnome.exceptions import GnomeRuntimeError
@@ -46,8 +49,27 @@ substances_spills = namedtuple('substances_spills',
                                 's_id',
                                 'spills'])
 
+# the data arrays that are only read now and then, which can be kept out of
+# core without slowing the movers -- see SpillContainer.cold_arrays
+COLD_ARRAYS = ('mass_components', 'init_mass', 'id', 'age')
+
+# elements copied at once when a cold array is remade
+COLD_CHUNK = 1 << 20
+
 
 class FateDataView(AddLogger):
+    """
+    The data of one substance's LEs, by fate, for the weatherers.
+
+    The LEs of each fate are found once and kept as an index into the SC's
+    arrays: None if they're all of the LEs, a slice if they're a run of
+    them, else an array of their indexes. Till LEs join or leave a fate --
+    its 'fate_status' bits change or its 'mass' goes to 0 in update_sc() --
+    the index is reused. For all the LEs or a run of them the data arrays
+    are the SC's arrays or views of them, which the weatherers update in
+    place, so nothing is copied out or back; only the LEs scattered through
+    the arrays are gathered into copies and written back.
+    """
     _dicts_ = ('surface_weather', 'subsurf_weather', 'skim', 'burn',
                'disperse', 'non_weather', 'all')
 
@@ -67,13 +89,18 @@ class FateDataView(AddLogger):
         # properties of old LEs and properties of newly released LEs
         self.all = {}
 
+        # the index of each fate's LEs and their 'fate_status' when the data
+        # was made, to see if it changed
+        self._index = {}
+        self._status = {}
+
     def _get_fate_mask(self, sc, fate):
         '''
         get fate_status mask over SC - only include LEs with 'mass' > 0.0
         '''
         if fate == 'all':
             # look at all fate data
-            w_mask = np.asarray([True] * len(sc))
+            w_mask = np.ones((len(sc),), dtype=bool)
         else:
             w_mask = (sc['fate_status'] & getattr(bt_fate, fate) ==
                       getattr(bt_fate, fate))
@@ -81,27 +108,58 @@ class FateDataView(AddLogger):
         w_mask = np.logical_and(w_mask, sc['mass'] > 0.0)
         return w_mask
 
-    def _set_data(self, sc, array_types, fate_mask, fate):
+    def _get_index(self, sc, fate):
         '''
-        fate_mask is the data already masked for the desired 'fate' option
+        the index of the LEs of the substance in fate, from the mask the first
+        time it is needed after a reset
         '''
-        # return all data associated with substance
-        if 'substance' in sc:
-            fate_mask = np.logical_and(sc['substance'] == self.substance_id,
-                                       fate_mask)
+        if fate not in self._index:
+            fate_mask = self._get_fate_mask(sc, fate)
+
+            # return all data associated with substance
+            if 'substance' in sc:
+                fate_mask = np.logical_and(sc['substance'] ==
+                                           self.substance_id,
+                                           fate_mask)
 
-        if np.all(fate_mask):
+            if np.all(fate_mask):
+                index = None
+            else:
+                index = np.flatnonzero(fate_mask)
+                if len(index) == 0:
+                    index = slice(0, 0)
+                elif index[-1] - index[0] + 1 == len(index):
+                    # a run of LEs - views of the arrays
+                    index = slice(index[0], index[-1] + 1)
+
+            self._index[fate] = index
+
+        return self._index[fate]
+
+    def _set_data(self, sc, array_types, index, fate):
+        '''
+        index is the LEs of the desired 'fate' option from _get_index()
+        '''
+        if index is None:
             # no need to make a copy of array
             setattr(self, fate, sc._data_arrays)
         else:
             dict_to_update = getattr(self, fate)
+            if dict_to_update is sc._data_arrays:
+                dict_to_update = {}
+
             for at in array_types:
                 array = sc._array_name(at)
                 if array not in dict_to_update:
-                    dict_to_update[array] = sc[array][fate_mask]
+                    # a view for a slice, else a copy
+                    dict_to_update[array] = sc[array][index]
 
             setattr(self, fate, dict_to_update)
 
+        data = getattr(self, fate)
+        if fate not in self._status and 'fate_status' in data:
+            self._status[fate] = data['fate_status'].copy()
+
     def get_data(self, sc, array_types, fate='surface_weather'):
         '''
         Get data that matches 'susbstance_id'. Also, since this is weathering
@@ -113,71 +171,213 @@ class FateDataView(AddLogger):
         # always add 'id' to array_types
         array_types.update({'id'})
         self._set_data(sc, array_types,
-                       self._get_fate_mask(sc, fate),
+                       self._get_index(sc, fate),
                        fate)
         return getattr(self, fate)
 
     def update_sc(self, sc, fate='surface_weather'):
         '''
-        update SC arrays with data viewer arrays for specified fate
-        - update all arrays just to make sure everything is in sync
-
-        After update, remove LEs with mass = 0. Since weatherers call this at
+        update SC arrays with data viewer arrays for specified fate - the
+        arrays that are views of the SC's arrays were updated in place, the
+        others are written back.
+
+        After update, if LEs changed fate or got to mass = 0 the view is
+        reset, since LEs have joined or left this fate and maybe others: the
+        indexes are found again when the next weatherer asks for data. For
+        instance, if the 'burn' started with 'surface_weather' data_arrays,
+        then marked some of these LEs to be burned, they should no longer be
+        contained in the 'surface_weather' dict. Since weatherers call this at
         the end of a weathering step, this ensures zero mass LEs are removed
         from the arrays.
-
-        .. note:: the 'id' of each LE corresponds with the index into SC array
-            however, if LEs are removed, then this will not be the case. Do not
-            rely on this indexing. Instead, get the mask again - the assumption
-            is that the fate_mask should be the same between getting the data
-            and resync'ing the original arrays in the SC
         '''
         d_to_sync = getattr(self, fate)
 
-        if d_to_sync is sc._data_arrays:
+        if fate not in self._index or len(d_to_sync) == 0:
             return
 
-        w_mask = self._get_fate_mask(sc, fate)
+        index = self._index[fate]
 
-        if 'substance' in sc:
-            w_mask = np.logical_and(sc['substance'] == self.substance_id,
-                                    w_mask)
+        if d_to_sync is not sc._data_arrays:
+            for key, val in d_to_sync.iteritems():
+                array = sc[key]
+
+                if isinstance(index, slice) and np.may_share_memory(val,
+                                                                    array):
+                    # a view - already updated in place
+                    continue
+
+                array[index] = val
 
-        # if fate_status of LEs was updated, then reset data attribute. This is
-        # because the data in the attribute is no longer valid. For instance,
-        # if the 'burn' started with 'surface_weather' data_arrays, then
-        # marked some of these LEs to be burned, they should no longer be
-        # contained in the 'surface_weather' dict - easisest to reset the dict
-        # and let it be recreated when the next weatherer asks for data.
         reset_view = False
-        if ('fate_status' in d_to_sync and
-                np.any(sc['fate_status'][w_mask] != d_to_sync['fate_status'])):
+        if ('fate_status' in d_to_sync and fate in self._status and
+                np.any(self._status[fate] != d_to_sync['fate_status'])):
             reset_view = True
         elif ('mass' in d_to_sync and
-              np.any(np.isclose(d_to_sync['mass'], 0))):
-            # probably need a threshold close to 0.0 as opposed to equality
+              np.any(d_to_sync['mass'] <= 0.0)):
             reset_view = True
             self.logger.debug(self._pid + "found LEs with 'mass' equal to 0. "
                               "reset_view")
 
-        for key, val in d_to_sync.iteritems():
-            sc[key][w_mask] = val
-
         if reset_view:
-            setattr(self, fate, {})
+            self.reset()
 
-    def _reset_fatedata(self, sc, ix):
+    def refresh(self, sc, names):
         '''
-        reset all arrays that contain LE with 'id' = ix
+        the SC's arrays of names were changed in place, outside of the data:
+        the copies of them, and the views, are taken from the SC again the
+        next time the data is asked for
         '''
         for fate in self._dicts_:
             data = getattr(self, fate)
-            if len(data) > 0:
-                idx = np.where(data['id'] == ix)[0]
-                if len(idx) > 0:
-                    self._set_data(sc, data.keys(),
-                                   self._get_fate_mask(sc, fate),
-                                   fate)
+            if data is sc._data_arrays:
+                continue
+
+            for name in names:
+                data.pop(name, None)
+
+    def _reset_fatedata(self, sc, ix):
+        '''
+        reset all arrays that contain LE with 'id' = ix
+        '''
+        # the SC's arrays were remade with the LE split, so the indexes and
+        # views of all the fates are stale, not just those with the LE
+        self.reset()
+
+
+def _is_prefix(array, buf):
+    '''
+    True if array is the first elements of buf, as SpillContainer's data
+    arrays are of their buffers
+    '''
+    return (array.base is buf and
+            array.strides == buf.strides and
+            (array.__array_interface__['data'][0] ==
+             buf.__array_interface__['data'][0]))
+
+
+def _spread_bits(v):
+    '''
+    spreads the low 16 bits of the uint32 array v to the even bits
+    '''
+    v = (v | (v << 8)) & 0x00FF00FF
+    v = (v | (v << 4)) & 0x0F0F0F0F
+    v = (v | (v << 2)) & 0x33333333
+    v = (v | (v << 1)) & 0x55555555
+
+    return v
+
+
+def morton_codes(positions):
+    '''
+    32 bit Morton codes of the (long, lat) of an (N, 3) positions array:
+    each coordinate is scaled to 16 bits over the bounding box of the
+    positions and the bits are interleaved
+    '''
+    codes = np.zeros((len(positions), ), dtype=np.uint32)
+    for shift, coord in ((0, positions[:, 0]), (1, positions[:, 1])):
+        low, high = coord.min(), coord.max()
+        scale = 65535. / (high - low) if high > low else 0.
+
+        cell = ((coord - low) * scale).astype(np.uint32)
+        codes |= _spread_bits(cell) << shift
+
+    return codes
+
+
+class ElementView(object):
+    """
+    The element positions laid out for lib_gnome's Mover_c::get_move_batch:
+    one contiguous, 64 byte aligned float64 array per coordinate, loaded
+    once per step and shared by all the movers of the step, so the C++
+    movers read and write it in place instead of each mover casting the
+    positions to WorldPoint3D and scaling every LE into an LERec.
+
+    Units, the same as get_move_batch:
+
+     - lon, lat: the positions at the start of the step, degrees
+     - z: meters, positive down
+     - delta_lon, delta_lat, delta_z: the move of the current mover, in the
+       same units
+     - next_lon, next_lat, next_z: the positions plus the moves so far
+     - status: the spill container's status_codes array (int16), not a copy
+     - active: the indexes of the elements in water, in order (int64), so
+       the movers can skip the others. The statuses don't change while the
+       movers move the elements, so it is made once per step in load()
+
+    The arrays are slices of buffers that only grow, so a step with the
+    same or fewer elements doesn't allocate.
+    """
+    _alignment = 64
+    _coords = ('lon', 'lat', 'z')
+
+    def __init__(self):
+        self.num = 0
+        self.status = np.zeros((0, ), dtype=status_codes.dtype)
+        self.active = np.zeros((0, ), dtype=np.int64)
+        self._buffers = {}
+
+        for name in self._names():
+            setattr(self, name, np.zeros((0, ), dtype=np.float64))
+
+    def _names(self):
+        return [prefix + c for prefix in ('', 'delta_', 'next_')
+                for c in self._coords]
+
+    def _aligned(self, num):
+        '''
+        a float64 array of num elements starting on an _alignment boundary
+        '''
+        raw = np.empty((num * 8 + self._alignment, ), dtype=np.uint8)
+        offset = -raw.ctypes.data % self._alignment
+
+        return raw[offset:offset + num * 8].view(np.float64)
+
+    def _resize(self, num):
+        for name in self._names():
+            buf = self._buffers.get(name)
+            if buf is None or len(buf) < num:
+                buf = self._aligned(max(num, len(buf) * 3 // 2
+                                        if buf is not None else 0))
+                self._buffers[name] = buf
+
+            setattr(self, name, buf[:num])
+
+        self.num = num
+
+    def load(self, sc):
+        '''
+        copies the spill container's positions in, one pass for the step,
+        and starts next_* at the positions
+        '''
+        positions = sc['positions']
+        self._resize(len(positions))
+
+        for i, c in enumerate(self._coords):
+            getattr(self, c)[:] = positions[:, i]
+            getattr(self, 'next_' + c)[:] = positions[:, i]
+
+        self.status = np.ascontiguousarray(sc['status_codes'])
+        self.active = np.flatnonzero(self.status ==
+                                     oil_status.in_water).astype(np.int64)
+
+    def add_delta(self, delta=None):
+        '''
+        adds the current mover's move to next_*, from delta_* or from an
+        (N, 3) delta array returned by a mover's get_move
+        '''
+        for i, c in enumerate(self._coords):
+            d = (getattr(self, 'delta_' + c) if delta is None
+                 else delta[:, i])
+            np.add(getattr(self, 'next_' + c), d,
+                   out=getattr(self, 'next_' + c))
+
+    def store(self, sc):
+        '''
+        writes next_* to the spill container's next_positions
+        '''
+        next_positions = sc['next_positions']
+        for i, c in enumerate(self._coords):
+            next_positions[:, i] = getattr(self, 'next_' + c)
 
 
 class SpillContainerData(object):
@@ -217,6 +417,14 @@ class SpillContainerData(object):
         self.current_time_stamp = None
         self.mass_balance = {}
 
+        # the LEs the map beached, refloated and has on land and off the maps
+        # in the last step (see GnomeMap._update_mass_balance)
+        self.beaching_counts = {}
+
+        # the LEs merged into super-particles and split again in the last
+        # step, and the super-particles there are (see ElementManager)
+        self.element_counts = {}
+
         # following internal variable is used when comparing two SpillContainer
         # objects. When testing the data arrays are equal, use this tolerance
         # with numpy.allclose() method. Default is to make it 0 so arrays must
@@ -292,14 +500,15 @@ class SpillContainerData(object):
         val_is_dict = []
         for key, val in self.__dict__.iteritems():
             'compare dict not including _data_arrays'
-            if isinstance(val, dict):
-                val_is_dict.append(key)
-            elif key == '_substances_spills' or key == '_fate_data_list':
+            if key in ('_substances_spills', '_fate_data_list',
+                       'element_view', '_buffers'):
                 '''
                 this is just another view of the data - no need to write extra
                 code to check equality for this
                 '''
                 pass
+            elif isinstance(val, dict):
+                val_is_dict.append(key)
             elif val != other.__dict__[key]:
                 return False
 
@@ -381,6 +590,31 @@ class SpillContainer(AddLogger, SpillContainerData):
         self.spills = OrderedCollection(dtype=gnome.spill.Spill)
         self.spills.register_callback(self._spills_changed,
                                       ('add', 'replace', 'remove'))
+
+        # positions for the movers that use get_move_batch, see
+        # Model.use_element_view
+        self.element_view = ElementView()
+
+        # the temporary arrays of the weatherers and the Python movers, lent
+        # for the step and given back by the model at its end
+        self.scratch = ScratchPool()
+
+        # the names of the data arrays kept out of core: their buffers are
+        # mapped to temporary files in cold_array_dir (the system's
+        # temporary directory if None), so the operating system pages them
+        # in as they are used and out again under memory pressure, and a
+        # run can have more elements than fit in memory. Removing, merging
+        # and sorting the elements remake them a chunk at a time. Set it
+        # before the elements are released, the arrays already made stay
+        # where they are till they are remade
+        self.cold_arrays = set()
+        self.cold_array_dir = None
+
+        # the indexes of the spills release_elements() releases, None for
+        # all of them: a rank of a domain decomposed run has all the spills,
+        # so the spill numbers and substances are the same in every rank,
+        # but only releases the ones that start in its subdomain
+        self.release_spills = None
         self.rewind()
 
     def __setitem__(self, data_name, array):
@@ -413,6 +647,11 @@ class SpillContainer(AddLogger, SpillContainerData):
                              'age': age}
         self._data_arrays = {}
 
+        # the memory the data arrays are the first len(self) elements of. It
+        # grows geometrically so releasing elements step after step doesn't
+        # copy the arrays every step
+        self._buffers = {}
+
     def _reset__substances_spills(self):
         '''
         reset internal attributes to None and empty list []:
@@ -613,6 +852,10 @@ class SpillContainer(AddLogger, SpillContainerData):
         initialize data arrays once spill has spawned particles
         Data arrays are set to their initial_values
 
+        The arrays are views of the first elements of larger buffers, the new
+        elements are set in the buffer so the old ones are only copied when
+        the buffer needs to grow.
+
         :param int num_released: number of particles released
 
         """
@@ -628,17 +871,86 @@ class SpillContainer(AddLogger, SpillContainerData):
                                             initial_value=tuple([0] * self._oil_comp_array_len))
             else:
                 a_append = atype.initialize(num_released)
-            self._data_arrays[name] = np.r_[self._data_arrays[name], a_append]
+            self._data_arrays[name] = self._grow_array(name, a_append)
+
+    def _grow_array(self, name, a_append):
+        """
+        the data array 'name' with a_append appended, in its buffer. If the
+        array isn't the start of its buffer -- it was replaced, say elements
+        were removed -- or the buffer is full, a new buffer is made of twice
+        the size needed and the array copied into it.
+        """
+        array = self._data_arrays[name]
+        buf = self._buffers.get(name)
+        num = len(array)
+        new_len = num + len(a_append)
+        dtype = np.result_type(array, a_append)
+
+        if (buf is None or not _is_prefix(array, buf) or
+                buf.dtype != dtype or len(buf) < new_len):
+            buf = self._new_buffer(name,
+                                   (max(2 * new_len, 16),) +
+                                   a_append.shape[1:],
+                                   dtype)
+            buf[:num] = array
+            self._buffers[name] = buf
+
+        buf[num:new_len] = a_append
+
+        return buf[:new_len]
+
+    def _new_buffer(self, name, shape, dtype):
+        '''
+        an empty buffer for the data array name, mapped to a temporary file
+        if it is one of the cold_arrays
+        '''
+        if name not in self.cold_arrays:
+            return np.empty(shape, dtype=dtype)
+
+        # the file is unlinked as soon as it is made, and its space freed
+        # with the last view of the map
+        with tempfile.TemporaryFile(prefix='gnome_cold_',
+                                    dir=self.cold_array_dir) as f:
+            return np.memmap(f, dtype=dtype, mode='w+', shape=shape)
+
+    def _take_elements(self, name, index):
+        '''
+        the elements at index of the data array name. For the cold arrays
+        they are copied to a new buffer a chunk at a time, so the array is
+        never all in memory.
+        '''
+        array = self[name]
+        if name not in self.cold_arrays:
+            return array[index]
+
+        num = len(index)
+        buf = self._new_buffer(name, (max(2 * num, 16),) + array.shape[1:],
+                               array.dtype)
+        for start in xrange(0, num, COLD_CHUNK):
+            buf[start:start + COLD_CHUNK] = \
+                array[index[start:start + COLD_CHUNK]]
+        self._buffers[name] = buf
+
+        return buf[:num]
 
-    def _set_substance_array(self, subs_idx, num_rel_by_substance):
+    def _delete_elements(self, name, removed):
         '''
-        -. update 'substance' array if more than one substance present. The
-        value of array is the index of 'substance' in _substances_spills
-        data structure
+        the data array name without the elements at the indexes removed
+        '''
+        if name not in self.cold_arrays:
+            return np.delete(self[name], removed, axis=0)
+
+        return self._take_elements(name, np.delete(np.arange(len(self[name])),
+                                                   removed))
+
+    def _set_substance_array(self, subs_idx, start, stop):
+        '''
+        -. update 'substance' array of the elements [start:stop] if more than
+        one substance present. The value of array is the index of 'substance'
+        in _substances_spills data structure
         '''
         if 'substance' in self:
-            if num_rel_by_substance > 0:
-                self['substance'][-num_rel_by_substance:] = subs_idx
+            self['substance'][start:stop] = subs_idx
 
     def substancefatedata(self,
                           substance,
@@ -652,6 +964,28 @@ class SpillContainer(AddLogger, SpillContainerData):
         view = self._get_fatedataview(substance)
         return view.get_data(self, array_types, fate)
 
+    def substancefateindex(self, substance, fate='surface_weather'):
+        '''
+        the index into the SC's arrays of the LEs of substance in fate, as
+        the data of substancefatedata() has them: None for all the LEs, a
+        slice or an array of their indexes
+        '''
+        view = self._get_fatedataview(substance)
+        return view._get_index(self, fate)
+
+    def refresh_fatedataviews(self, names, reset=False):
+        '''
+        the arrays of names were changed in place, not through the fate data
+        of the weatherers: the data of all substances and fates takes them
+        from the SC again. reset=True if LEs may have left their fate, or
+        their mass gone to 0, so the indexes are found again too.
+        '''
+        for view in self._fate_data_list:
+            if reset:
+                view.reset()
+            else:
+                view.refresh(self, names)
+
     def iterspillsbysubstance(self):
         '''
         iterate through the substances spills datastructure and return the
@@ -663,6 +997,18 @@ class SpillContainer(AddLogger, SpillContainerData):
             self._set_substancespills()
         return self._substances_spills.spills
 
+    def substance_subsets(self):
+        '''
+        a SubstanceSubset of each substance that is not None, in the order
+        of itersubstancedata()
+        '''
+        if self._substances_spills is None:
+            self._set_substancespills()
+
+        return [SubstanceSubset(self, ix, substance) for ix, substance in
+                enumerate(self.get_substances(complete=False))
+                if ix < len(self._fate_data_list)]
+
     def itersubstancedata(self, array_types, fate='surface_weather'):
         '''
         iterates through and returns the following for each iteration:
@@ -777,6 +1123,13 @@ class SpillContainer(AddLogger, SpillContainerData):
         self._reset__fate_data_list()
         self.initialize_data_arrays()
         self.mass_balance = {}  # reset to empty array
+        self.beaching_counts = {}
+        self.element_counts = {}
+        self.scratch.clear()
+
+        # the ids released from now on are at least this, so the ids of
+        # the elements extract_elements() took out aren't given again
+        self._next_id = 0
 
     def get_spill_mask(self, spill):
         return self['spill_num'] == self.spills.index(spill)
@@ -792,6 +1145,11 @@ class SpillContainer(AddLogger, SpillContainerData):
         for sp in self.spills:
             u_sc.spills += sp.uncertain_copy()
 
+        u_sc.cold_arrays = set(self.cold_arrays)
+        u_sc.cold_array_dir = self.cold_array_dir
+        if self.release_spills is not None:
+            u_sc.release_spills = set(self.release_spills)
+
         return u_sc
 
     def prepare_for_model_run(self, array_types=set()):
@@ -883,52 +1241,65 @@ class SpillContainer(AddLogger, SpillContainerData):
         # used internally only by SpillContainer - could be a strided array.
         # Simpler to define it only in SpillContainer as opposed to ArrayTypes
         # 'substance': ((), np.uint8, 0)
+        releases = []
         for ix, spills in enumerate(self.iterspillsbysubstance()):
-            num_rel_by_substance = 0
             for spill in spills:
                 # only spills that are included here - no need to check
                 # spill.on flag
+                if (self.release_spills is not None and
+                        self.spills.index(spill) not in self.release_spills):
+                    continue
                 num_rel = spill.num_elements_to_release(model_time, time_step)
                 if num_rel > 0:
-                    # update 'spill_num' ArrayType's initial_value so it
-                    # corresponds with spill number for this set of released
-                    # particles - just another way to set value of spill_num
-                    # correctly
-                    self._array_types['spill_num'].initial_value = \
-                        self.spills.index(spill)
-
-                    if len(self['spill_num']) > 0:
-                        # unique identifier for each new element released
-                        # this adjusts the _array_types initial_value since the
-                        # initialize function just calls:
-                        #  range(initial_value, num_released + initial_value)
-                        self._array_types['id'].initial_value = \
-                            self['id'][-1] + 1
-                    else:
-                        # always reset value of first particle released to 0!
-                        # The array_types are shared globally. To initialize
-                        # uncertain spills correctly, reset this to 0.
-                        # To be safe, always reset to 0 when no
-                        # particles are released
-                        self._array_types['id'].initial_value = 0
-
-                    # append to data arrays - number of oil components is
-                    # currently the same for all spills
-                    self._append_data_arrays(num_rel)
-                    spill.set_newparticle_values(num_rel,
-                                                 model_time,
-                                                 time_step,
-                                                 self._data_arrays)
-                    num_rel_by_substance += num_rel
-
-            # always reset data arrays else the changing arrays are stale
-            self._set_substance_array(ix, num_rel_by_substance)
-
-            # reset fate_dataview at each step - do it after release elements
-            self.reset_fate_dataview()
-
-            # update total elements released for substance
-            total_released += num_rel_by_substance
+                    releases.append((ix, spill, num_rel))
+                    total_released += num_rel
+
+        if total_released > 0:
+            if len(self['spill_num']) > 0:
+                # unique identifier for each new element released
+                # this adjusts the _array_types initial_value since the
+                # initialize function just calls:
+                #  range(initial_value, num_released + initial_value)
+                # max, not the last one: sort_by_position() may
+                # have reordered the elements
+                self._array_types['id'].initial_value = \
+                    max(self['id'].max() + 1, self._next_id)
+            else:
+                # always reset value of first particle released to 0!
+                # The array_types are shared globally. To initialize
+                # uncertain spills correctly, reset this to 0.
+                # To be safe, always reset to 0 when no
+                # particles are released
+                self._array_types['id'].initial_value = self._next_id
+
+            # append to data arrays once for all the spills - number of oil
+            # components is currently the same for all spills
+            start = len(self)
+            self._append_data_arrays(total_released)
+
+            for ix, spill, num_rel in releases:
+                stop = start + num_rel
+                spill_num = self.spills.index(spill)
+
+                self['spill_num'][start:stop] = spill_num
+                self._set_substance_array(ix, start, stop)
+
+                # the spill sets the values of its own elements: views of
+                # the data arrays that end with them
+                data_arrays = dict((name, array[start:stop])
+                                   for name, array
+                                   in self._data_arrays.iteritems())
+                rng = ElementRandom(data_arrays['id'], spill_num,
+                                    stream=int(self.uncertain))
+                spill.set_newparticle_values(num_rel,
+                                             model_time,
+                                             time_step,
+                                             data_arrays,
+                                             rng=rng)
+                start = stop
+
+        # reset fate_dataview at each step - do it after release elements
+        self.reset_fate_dataview()
 
         return total_released
 
@@ -963,6 +1334,10 @@ class SpillContainer(AddLogger, SpillContainerData):
             data = np.insert(data, idx, split_elems[:-1], 0)
             data[idx + len(split_elems) - 1] = split_elems[-1]
             self._data_arrays[name] = data
+            if name in self.cold_arrays:
+                # back in a buffer of its own
+                self._data_arrays[name] = self._take_elements(
+                    name, np.arange(len(data)))
 
         # update fate_dataview which contains this LE
         # for now we only have one type of substance
@@ -987,8 +1362,146 @@ class SpillContainer(AddLogger, SpillContainerData):
 
         if len(to_be_removed) > 0:
             for key in self._array_types.keys():
-                self._data_arrays[key] = np.delete(self[key], to_be_removed,
-                                                   axis=0)
+                self._data_arrays[key] = self._delete_elements(key,
+                                                               to_be_removed)
+
+    def extract_elements(self, index):
+        '''
+        Takes the elements at index out of the spill container, to go on in
+        another one of the same spills and array types, see add_elements()
+
+        :returns: {name: array} of the elements' data arrays
+        '''
+        index = np.asarray(index, dtype=np.intp)
+        arrays = dict((key, self._data_arrays[key][index].copy())
+                      for key in self._array_types)
+
+        if len(index) > 0:
+            self._next_id = max(self._next_id, self['id'].max() + 1)
+            for key in self._array_types.keys():
+                self._data_arrays[key] = self._delete_elements(key, index)
+            self.reset_fate_dataview()
+
+        return arrays
+
+    def add_elements(self, arrays):
+        '''
+        Appends the elements another spill container's extract_elements()
+        took out, with their ids.
+
+        :param arrays: {name: array} with the same names as the data arrays
+        '''
+        if set(arrays) != set(self._array_types):
+            raise ValueError('the elements added have arrays {0}, not {1}'
+                             .format(sorted(arrays),
+                                     sorted(self._array_types)))
+
+        if len(arrays['id']) == 0:
+            return
+
+        for key in self._array_types:
+            self._data_arrays[key] = self._grow_array(key, arrays[key])
+        self.reset_fate_dataview()
+
+    def merge_elements(self, groups):
+        '''
+        Merges the elements of each group into one super-particle, in place
+        of its first element: the mass and the other values divided on split
+        are summed, the floating point values are mass weighted means and
+        the others are the first element's -- see
+        ArrayType.merge_elements(). The mass is conserved.
+
+        :param groups: the group of each element, -1 for the elements left
+            alone. A group of one element is left alone too. The elements
+            merged must have mass
+        :returns: the number of elements there are fewer of
+        '''
+        groups = np.asarray(groups)
+        idx = np.where(groups >= 0)[0]
+        idx = idx[np.argsort(groups[idx], kind='mergesort')]
+
+        # the groups of more than one element
+        new_group = np.r_[True, groups[idx][1:] != groups[idx][:-1]]
+        sizes = np.diff(np.r_[np.flatnonzero(new_group), len(idx)])
+        idx = idx[np.repeat(sizes > 1, sizes)]
+        if len(idx) == 0:
+            return 0
+
+        starts = np.flatnonzero(np.r_[True, groups[idx][1:] !=
+                                      groups[idx][:-1]])
+        weights = self['mass'][idx].copy()
+        removed = np.delete(idx, starts)
+
+        for key, at in self._array_types.iteritems():
+            data = self[key]
+            data[idx[starts]] = at.merge_elements(data[idx], weights, starts)
+            self._data_arrays[key] = self._delete_elements(key, removed)
+
+        self.reset_fate_dataview()
+
+        return len(removed)
+
+    def split_elements(self, indices, nums):
+        '''
+        Splits the elements at indices into nums of equal parts, the values
+        divided on split divided between them (see
+        ArrayType.split_elements()). The new elements are appended, with
+        new ids.
+
+        :param indices: the indices of the elements to split
+        :param nums: the number of elements each is split into, at least 2
+        :returns: the number of elements added
+        '''
+        indices = np.asarray(indices, dtype=np.int_)
+        nums = np.asarray(nums, dtype=np.int_)
+        if len(indices) == 0:
+            return 0
+
+        if np.any(nums < 2):
+            msg = "'nums' to split into must be at least 2"
+            self.logger.error(msg)
+            raise ValueError(msg)
+
+        next_id = self['id'].max() + 1
+        num_new = (nums - 1).sum()
+
+        for key, at in self._array_types.iteritems():
+            kept, new = at.split_elements(self[key][indices], nums)
+            if key == 'id':
+                new = np.arange(next_id, next_id + num_new,
+                                dtype=self[key].dtype)
+
+            self[key][indices] = kept
+            self._data_arrays[key] = self._grow_array(key, new)
+
+        self.reset_fate_dataview()
+
+        return num_new
+
+    def sort_by_position(self):
+        '''
+        Reorders the elements along a Morton (Z order) curve of their
+        positions, so elements near each other are near each other in the
+        data arrays and the movers look up the same map, grid and velocity
+        data for runs of elements instead of jumping around. All the data
+        arrays are permuted the same way; the 'id' array stays with its
+        element, so output can be mapped back by id.
+
+        Elements with the same code keep their order (the sort is stable).
+
+        :returns: the permutation, new index -> old index, or None if there
+            was nothing to sort
+        '''
+        if len(self._data_arrays) == 0 or len(self['positions']) < 2:
+            return None
+
+        order = np.argsort(morton_codes(self['positions']), kind='mergesort')
+        for key in self._array_types.keys():
+            self._data_arrays[key] = self._take_elements(key, order)
+
+        self.reset_fate_dataview()
+
+        return order
 
     def __str__(self):
         return ('gnome.spill_container.SpillContainer\n'
@@ -998,6 +1511,48 @@ class SpillContainer(AddLogger, SpillContainerData):
     __repr__ = __str__
 
 
+class SubstanceSubset(object):
+    '''
+    A spill container as a weatherer sees it with only one of its
+    substances, so the substances can be weathered at the same time -- see
+    Model.concurrent_substances: itersubstancedata() and
+    update_from_fatedataview() are the substance's, and mass_balance is the
+    substance's own, from 0, added to the spill container's by
+    add_mass_balance(). Everything else is the spill container's.
+    '''
+    def __init__(self, sc, index, substance):
+        self._sc = sc
+        self._view = sc._fate_data_list[index]
+        self._substance = substance
+        self.mass_balance = dict.fromkeys(sc.mass_balance, 0.)
+
+    def __getattr__(self, name):
+        return getattr(self._sc, name)
+
+    def __getitem__(self, name):
+        return self._sc[name]
+
+    def __contains__(self, name):
+        return name in self._sc
+
+    def __len__(self):
+        return len(self._sc)
+
+    def itersubstancedata(self, array_types, fate='surface_weather'):
+        return [(self._substance,
+                 self._view.get_data(self._sc, array_types, fate))]
+
+    def update_from_fatedataview(self, substance=None,
+                                 fate='surface_weather'):
+        self._view.update_sc(self._sc, fate)
+
+    def add_mass_balance(self):
+        'adds the mass balance of the substance to the spill container\'s'
+        for key, value in self.mass_balance.iteritems():
+            self._sc.mass_balance[key] = (self._sc.mass_balance.get(key, 0.) +
+                                          value)
+
+
 class SpillContainerPairData(object):
     """
     A really simple SpillContainerPair
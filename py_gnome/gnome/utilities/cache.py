@@ -6,10 +6,12 @@ accessing again for output, etc.
 
 """
 import os
+import mmap
 import warnings
 import tempfile
 import shutil
 import copy
+from collections import OrderedDict
 from multiprocessing import Lock
 
 import numpy
@@ -62,18 +64,172 @@ import atexit
 atexit.register(clean_up_cache)
 
 
+class ColumnarStore(object):
+    """
+    The steps of an ElementCache in one append-only file per array: each
+    step's array is appended to the array's file, and an index of where it
+    went is kept in memory. Reading a step back maps the files instead of
+    opening an npz file, and a rewind truncates the files instead of
+    deleting a file per step.
+
+    The certain and uncertain arrays go in separate files. Arrays of python
+    objects (the time stamp) are kept in the index.
+    """
+    def __init__(self, cache_dir):
+        self.cache_dir = cache_dir
+
+        # (name, uncertain) -> [open file, bytes written, mmap or None]
+        self.columns = {}
+
+        # (step_num, uncertain) -> {name: (offset, dtype, shape) or array}
+        self.index = {}
+
+    def _column(self, name, uncertain, mode='w+b'):
+        key = (name, uncertain)
+        column = self.columns.get(key)
+
+        if column is None:
+            if not os.path.isdir(self.cache_dir):
+                os.makedirs(self.cache_dir)
+
+            filename = os.path.join(self.cache_dir,
+                                    '{0}{1}.col'.format(name,
+                                                        '_uncert' if uncertain
+                                                        else ''))
+            column = self.columns[key] = [open(filename, mode), 0, None]
+
+        return column
+
+    def save(self, step_num, uncertain, data):
+        entry = {}
+
+        for name, arr in data.iteritems():
+            if arr.dtype.hasobject:
+                entry[name] = arr
+                continue
+
+            arr = np.ascontiguousarray(arr)
+            column = self._column(name, uncertain)
+            entry[name] = (column[1], arr.dtype, arr.shape)
+
+            if arr.nbytes:
+                column[0].seek(column[1])
+                arr.tofile(column[0])
+                column[1] += arr.nbytes
+
+        self.index[(step_num, uncertain)] = entry
+
+    def load(self, step_num, uncertain):
+        """
+        the data arrays saved for the step, which are copies, or None if
+        the step isn't in the store
+        """
+        try:
+            entry = self.index[(step_num, uncertain)]
+        except KeyError:
+            return None
+
+        data = {}
+        for name, item in entry.iteritems():
+            if isinstance(item, np.ndarray):
+                data[name] = item.copy()
+                continue
+
+            offset, dtype, shape = item
+            count = int(np.prod(shape))
+            if count == 0:
+                data[name] = np.empty(shape, dtype=dtype)
+                continue
+
+            column = self.columns[(name, uncertain)]
+            nbytes = count * dtype.itemsize
+            if column[2] is None or len(column[2]) < offset + nbytes:
+                # the file grew since it was mapped
+                if column[2] is not None:
+                    column[2].close()
+                column[0].flush()
+                column[2] = mmap.mmap(column[0].fileno(), column[1],
+                                      access=mmap.ACCESS_READ)
+
+            data[name] = np.frombuffer(column[2], dtype=dtype, count=count,
+                                       offset=offset).reshape(shape).copy()
+
+        return data
+
+    def _unmap(self):
+        for column in self.columns.values():
+            if column[2] is not None:
+                column[2].close()
+                column[2] = None
+
+    def rewind(self):
+        self._unmap()
+        for column in self.columns.values():
+            column[0].seek(0)
+            column[0].truncate()
+            column[1] = 0
+
+        self.index = {}
+
+    def close(self):
+        self._unmap()
+        for column in self.columns.values():
+            column[0].close()
+
+        self.columns = {}
+        self.index = {}
+
+    def sizes(self):
+        """
+        the bytes written to each column, with all of them flushed to disk
+        """
+        for column in self.columns.values():
+            column[0].flush()
+
+        return dict((key, column[1])
+                    for key, column in self.columns.iteritems())
+
+    def reopen(self, sizes, index):
+        """
+        Takes up the columns a store of the same cache dir had, as sizes()
+        and the index had them -- what was written to the files after that
+        is cut off
+        """
+        self.close()
+
+        for (name, uncertain), size in sizes.iteritems():
+            column = self._column(name, uncertain, 'r+b')
+            column[0].truncate(size)
+            column[1] = size
+
+        self.index = index
+
+
 class ElementCache(object):
     """
     Cache for element data -- i.e. the data associated with the particles.
     This caches UncertainSpillContainerPair
     The cache can be accessed to re-draw the LE movies, etc.
 
+    The steps can be stored as:
+
+    'npz': an npz file per step
+
+    'columnar': a ColumnarStore -- one file per array, for long runs where a
+                file per step makes too many files and slow rewinds
+
+    'memory': only the last ring_size steps, in memory. Nothing goes to
+              disk; older steps are dropped.
+
     TODO: This is a really fragile module in terms of handling multiple
           instances.  The __del__() method of previous instances can clear
           the _cache_dir at the whim of the GC.
           We may want to manage this differently.
     """
-    def __init__(self, cache_dir=None, enabled=True):
+    stores = ('npz', 'columnar', 'memory')
+
+    def __init__(self, cache_dir=None, enabled=True, store='npz',
+                 ring_size=100):
         """
         initialize a new cache object
 
@@ -81,21 +237,40 @@ class ElementCache(object):
                                should be stored.
                                If not provided, a temp dir will be created by
                                the python tempfile module
+
+        :param store='npz': how the steps are stored: 'npz', 'columnar' or
+                            'memory'
+
+        :param ring_size=100: the number of steps the 'memory' store keeps
         """
+        # set first, for the __del__ of one that isn't made
+        self.lock = Lock()
+        self._cache_dir = ''
+        self._columns = None
+
+        if store not in self.stores:
+            raise ValueError('store must be one of {0}, not {1!r}'
+                             .format(self.stores, store))
+        if store == 'memory' and ring_size < 1:
+            raise ValueError('ring_size must be at least 1')
+
+        self.store = store
+        self.ring_size = ring_size
+
         self.create_new_dir(cache_dir)
 
         # dict to hold recent data so we don't need to pull from the
-        # file system
-        self.recent = {}
+        # file system -- for the 'memory' store, this is the store
+        self.recent = OrderedDict()
 
         # flag for whether to enable disk cache
         self.enabled = enabled
 
-        self.lock = Lock()
-
     def __del__(self):
         'Clear out the cache when this object is deleted'
         with self.lock:
+            if self._columns is not None:
+                self._columns.close()
             if os.path.isdir(self._cache_dir):
                 shutil.rmtree(self._cache_dir)
 
@@ -119,6 +294,13 @@ class ElementCache(object):
             self._cache_dir = tempfile.mkdtemp(dir=_cache_dir)
         else:
             self._cache_dir = cache_dir
+
+        if self.store == 'columnar':
+            # the steps already stored stay in the old dir
+            if self._columns is not None:
+                self._columns.close()
+            self._columns = ColumnarStore(self._cache_dir)
+
         return True
 
     def save_timestep(self, step_num, spill_container_pair):
@@ -140,16 +322,24 @@ class ElementCache(object):
 
             if sc.uncertain:
                 self.recent[step_num][1] = data
+            elif self.store == 'memory':
+                self.recent.pop(step_num, None)
+                self.recent[step_num] = [data, None]
+                while len(self.recent) > self.ring_size:
+                    self.recent.popitem(last=False)
             else:
                 # this creates a new dict, so only one step is saved
-                self.recent = {step_num: [data, None]}
+                self.recent = OrderedDict([(step_num, [data, None])])
 
             # write the data if enabled
             # could be threaded -- data is a copy, so doesn't need to be
             #                      re-used by anything
             if self.enabled:
-                filename = self._make_filename(step_num, sc.uncertain)
-                np.savez(filename, **data)
+                if self.store == 'npz':
+                    filename = self._make_filename(step_num, sc.uncertain)
+                    np.savez(filename, **data)
+                elif self.store == 'columnar':
+                    self._columns.save(step_num, sc.uncertain, data)
 
     def load_timestep(self, step_num):
         """
@@ -176,19 +366,30 @@ class ElementCache(object):
                         np.array(u_data_arrays['current_time_stamp'])
         except KeyError:
             # not in the recent dict: try to load from disk
-            try:
-                data_arrays = \
-                    dict(np.load(self._make_filename(step_num)))
-            except IOError:
+            if self.store == 'columnar':
+                data_arrays = self._columns.load(step_num, False)
+                if data_arrays is None:
+                    raise CacheError('step: {0} is not in the cache'
+                                     .format(step_num))
+
+                u_data_arrays = self._columns.load(step_num, True)
+            elif self.store == 'npz':
+                try:
+                    data_arrays = \
+                        dict(np.load(self._make_filename(step_num)))
+                except IOError:
+                    raise CacheError('step: {0} is not in the cache'
+                                     .format(step_num))
+
+                try:
+                    u_data_arrays = \
+                        dict(np.load(self._make_filename(step_num, True)))
+                except IOError:
+                    u_data_arrays = None
+            else:
                 raise CacheError('step: {0} is not in the cache'
                                  .format(step_num))
 
-            try:
-                u_data_arrays = \
-                    dict(np.load(self._make_filename(step_num, True)))
-            except IOError:
-                u_data_arrays = None
-
         # HOWEVER, loading numpy arrays
         #     data_arrays = dict(np.load(self._make_filename(step_num)))
         # converts current_time_stamp to numpy.ndarray objects
@@ -249,12 +450,64 @@ class ElementCache(object):
 
         return mb_data
 
+    def checkpoint_state(self):
+        """
+        where the cache is, for a model checkpoint. The steps already on
+        disk stay in the cache dir, so only where to find them is kept --
+        with the steps in memory, which are nowhere else.
+        """
+        state = {'cache_dir': self._cache_dir,
+                 'store': self.store,
+                 'enabled': self.enabled,
+                 'recent': self.recent}
+
+        if self._columns is not None:
+            state['sizes'] = self._columns.sizes()
+            state['index'] = dict(self._columns.index)
+
+        return state
+
+    def restore_checkpoint_state(self, state):
+        """
+        Picks the cache up where checkpoint_state() was -- in the cache dir
+        of the run that was checkpointed, if it is still there. If it isn't
+        -- or it is this cache's own dir, which rewinding cleared -- the
+        steps before the checkpoint that were only on disk are gone.
+        """
+        if state['store'] != self.store:
+            raise ValueError('the checkpoint is of a {0!r} cache, not a '
+                             '{1!r} one'.format(state['store'], self.store))
+
+        self.enabled = state['enabled']
+        self.recent = state['recent']
+
+        cache_dir = state['cache_dir']
+        if cache_dir == self._cache_dir or not os.path.isdir(cache_dir):
+            return
+
+        with self.lock:
+            if self._columns is not None:
+                self._columns.close()
+            if os.path.isdir(self._cache_dir):
+                shutil.rmtree(self._cache_dir)
+
+            self.create_new_dir(cache_dir)
+
+            if self._columns is not None:
+                self._columns.reopen(state['sizes'], state['index'])
+
     def rewind(self):
         'Rewinds the cache -- clearing out everything'
         # clean out the in-memory cache
-        self.recent = {}
+        self.recent = OrderedDict()
 
         # clean out the disk cache
-        if os.path.isdir(self._cache_dir):
-            shutil.rmtree(self._cache_dir)
-        os.mkdir(self._cache_dir)
+        if self._columns is not None:
+            # keep the files, the next run writes over them
+            self._columns.rewind()
+            if not os.path.isdir(self._cache_dir):
+                os.mkdir(self._cache_dir)
+        elif self.store == 'npz':
+            if os.path.isdir(self._cache_dir):
+                shutil.rmtree(self._cache_dir)
+            os.mkdir(self._cache_dir)
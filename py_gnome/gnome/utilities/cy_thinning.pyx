@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+
+"""
+Cython code for the output thinning of gnome.outputters.thinning
+
+Picks the elements of a step an outputter writes out of the snapshot's
+arrays in one pass, without a Python object per element, and keeps what
+was last written of each element -- by its id -- to tell which have moved
+since.
+"""
+
+import cython
+import numpy as np
+cimport numpy as cnp
+from libc.math cimport cos, sqrt, M_PI
+
+# as lib_gnome's Units.h
+cdef double METERS_PER_DEGREE_LAT = 111120.00024
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+@cython.cdivision(True)
+def thin_elements(cnp.ndarray[cnp.uint32_t, ndim=1] ids not None,
+                  cnp.ndarray[double, ndim=2] positions not None,
+                  cnp.ndarray[cnp.int16_t, ndim=1] status_codes not None,
+                  int every,
+                  cnp.ndarray[cnp.uint8_t, ndim=1] in_region,
+                  double min_move,
+                  cnp.ndarray[double, ndim=2] last_positions not None,
+                  cnp.ndarray[cnp.int16_t, ndim=1] last_status not None,
+                  cnp.ndarray[cnp.uint8_t, ndim=1] written not None,
+                  bint keep_all=False):
+    """
+    The indexes of the elements to write, in order
+
+    An element is written when keep_all is set, when it is in_region, or
+    when its id is a multiple of every (every > 0) and, if min_move is not
+    negative, it has not been written before, its status changed or it
+    moved more than min_move meters since it was last written.
+
+    :param in_region: 1 for the elements in the regions, or None
+    :param last_positions, last_status, written: what was last written of
+        each element, by id -- the elements written are updated. They must
+        be longer than the largest id
+    """
+    cdef Py_ssize_t n = ids.shape[0]
+    cdef Py_ssize_t i, num_kept = 0
+    cdef cnp.uint32_t id_
+    cdef bint keep, has_region = in_region is not None
+    cdef double dx, dy, dz
+    cdef cnp.ndarray[cnp.int64_t, ndim=1] kept = np.empty(n, dtype=np.int64)
+
+    if positions.shape[0] != n or status_codes.shape[0] != n:
+        raise ValueError('the arrays must be the same length')
+    if has_region and in_region.shape[0] != n:
+        raise ValueError('in_region must be the length of the arrays')
+    if n > 0 and positions.shape[1] < 3:
+        raise ValueError('positions must be Nx3')
+
+    for i in range(n):
+        if ids[i] >= <cnp.uint32_t>written.shape[0]:
+            raise ValueError('the last written arrays are too short '
+                             'for id {0}'.format(ids[i]))
+
+    with nogil:
+        for i in range(n):
+            id_ = ids[i]
+            keep = keep_all or (has_region and in_region[i] != 0)
+
+            if not keep and every > 0 and id_ % every == 0:
+                if (min_move < 0 or not written[id_] or
+                        status_codes[i] != last_status[id_]):
+                    keep = True
+                else:
+                    dx = ((positions[i, 0] - last_positions[id_, 0]) *
+                          METERS_PER_DEGREE_LAT *
+                          cos(positions[i, 1] * M_PI / 180.))
+                    dy = ((positions[i, 1] - last_positions[id_, 1]) *
+                          METERS_PER_DEGREE_LAT)
+                    dz = positions[i, 2] - last_positions[id_, 2]
+                    keep = sqrt(dx * dx + dy * dy + dz * dz) > min_move
+
+            if keep:
+                kept[num_kept] = i
+                num_kept += 1
+
+                last_positions[id_, 0] = positions[i, 0]
+                last_positions[id_, 1] = positions[i, 1]
+                last_positions[id_, 2] = positions[i, 2]
+                last_status[id_] = status_codes[i]
+                written[id_] = 1
+
+    return kept[:num_kept]
@@ -0,0 +1,287 @@
+#!/usr/bin/env python
+"""
+determinism.py
+
+Checks that the parallel and vectorized ways of running a model come out
+the same as the serial one: a model is made for each of a list of
+configurations, run step by step, and the positions, status codes and mass
+of its elements after each step are compared with those of the first
+configuration's run, bit for bit, or within a number of units in the last
+place a configuration declares for math that may round differently.
+
+A configuration is a dict of:
+
+ - name: what the report calls it
+ - threads: the num_threads of the movers and of the weatherers' lib_gnome
+   loops (default 1)
+ - simd: whether the batched interpolation may use vector instructions
+   (default True)
+ - device: whether the batched interpolation is on the CUDA device, if there
+   is one (default False)
+ - ulps: the units in the last place floating point arrays may be off by
+   (default 0, bit for bit)
+
+and Model attributes to set: use_element_view, fuse_movers,
+concurrent_spill_containers, concurrent_substances, pipeline_steps and
+sort_interval. The random movers draw the counter based random numbers in
+every configuration, so their draws don't depend on the order of the
+elements.
+
+    divergences = check_determinism(make_model, CONFIGURATIONS)
+    print format_report(divergences)
+"""
+import numpy as np
+
+from gnome.cy_gnome import cy_helpers
+from gnome.cy_gnome import cy_weatherers
+
+# the element arrays compared
+ARRAY_NAMES = ('positions', 'status_codes', 'mass')
+
+MODEL_OPTIONS = ('use_element_view', 'fuse_movers',
+                 'concurrent_spill_containers', 'concurrent_substances',
+                 'pipeline_steps', 'sort_interval')
+
+# the serial run first, it is the reference
+CONFIGURATIONS = ({'name': 'serial'},
+                  {'name': 'scalar', 'simd': False},
+                  {'name': 'element view', 'use_element_view': True},
+                  {'name': 'fused', 'use_element_view': True,
+                   'fuse_movers': True},
+                  {'name': '4 threads', 'threads': 4,
+                   'use_element_view': True, 'fuse_movers': True},
+                  {'name': 'concurrent', 'threads': 4,
+                   'use_element_view': True,
+                   'concurrent_spill_containers': True,
+                   'concurrent_substances': True,
+                   'pipeline_steps': True},
+                  {'name': 'device', 'device': True,
+                   'use_element_view': True, 'fuse_movers': True})
+
+
+class Divergence(object):
+    """
+    where a run came out different from the reference: the step, the spill
+    container, the array, how many elements are off and the largest
+    difference in units in the last place (None for integer arrays and for
+    different numbers of elements)
+    """
+    def __init__(self, config, step, sc_index, name, num_off, max_ulps):
+        self.config = config
+        self.step = step
+        self.sc_index = sc_index
+        self.name = name
+        self.num_off = num_off
+        self.max_ulps = max_ulps
+
+    def __repr__(self):
+        return ('Divergence({0.config!r}, step={0.step}, '
+                'sc={0.sc_index}, {0.name!r}, num_off={0.num_off}, '
+                'max_ulps={0.max_ulps})'.format(self))
+
+
+def ulp_distance(a, b):
+    """
+    the number of float64 values between a and b, elementwise: 0 if they
+    are the same, 1 for neighbours. NaNs are the same as NaNs and as far as
+    can be from anything else.
+    """
+    a = np.ascontiguousarray(a, dtype=np.float64)
+    b = np.ascontiguousarray(b, dtype=np.float64)
+
+    # the bits of a float64 as an integer that is in the order of the
+    # floats, -0.0 and 0.0 the same
+    def ordered(x):
+        i = x.view(np.int64)
+        return np.where(i < 0, np.int64(-0x8000000000000000) - i, i)
+
+    dist = np.abs(ordered(a).astype(np.float64) -
+                  ordered(b).astype(np.float64))
+
+    nan_a, nan_b = np.isnan(a), np.isnan(b)
+    dist[nan_a != nan_b] = np.inf
+    dist[nan_a & nan_b] = 0.
+
+    return dist
+
+
+def snapshot(model):
+    """
+    copies of the compared arrays of each of the model's spill containers,
+    the elements in the order of their ids, so sorting them by position
+    doesn't count
+    """
+    snapshots = []
+    for sc in model.spills.items():
+        order = np.argsort(sc['id'], kind='mergesort')
+        snapshots.append(dict((name, sc[name][order]) for name in ARRAY_NAMES
+                              if name in sc))
+
+    return snapshots
+
+
+def compare_snapshots(config, step, reference, other, ulps=0):
+    """
+    the Divergences of the other snapshot of a step from the reference one
+    """
+    divergences = []
+
+    for sc_index, (ref, arrays) in enumerate(zip(reference, other)):
+        for name in ARRAY_NAMES:
+            if name not in ref and name not in arrays:
+                continue
+
+            a, b = ref.get(name), arrays.get(name)
+            if a is None or b is None or a.shape != b.shape:
+                divergences.append(Divergence(config, step, sc_index, name,
+                                              None, None))
+                continue
+
+            if a.dtype.kind == 'f':
+                dist = ulp_distance(a, b)
+                off = dist > ulps
+                if off.any():
+                    divergences.append(Divergence(config, step, sc_index,
+                                                  name,
+                                                  int(off.reshape(len(a), -1)
+                                                      .any(axis=1).sum()),
+                                                  float(dist.max())))
+            else:
+                off = a != b
+                if off.any():
+                    divergences.append(Divergence(config, step, sc_index,
+                                                  name,
+                                                  int(off.reshape(len(a), -1)
+                                                      .any(axis=1).sum()),
+                                                  None))
+
+    return divergences
+
+
+class _Settings(object):
+    """
+    the lib_gnome settings of a configuration, while a run is in it: the
+    ones before are set again on exit
+    """
+    def __init__(self, config):
+        self.config = config
+
+    def __enter__(self):
+        self._weathering_threads = cy_weatherers.get_num_threads()
+
+        cy_weatherers.set_num_threads(self.config.get('threads', 1))
+        cy_helpers.set_interpolation_simd(self.config.get('simd', True))
+        if self.config.get('device', False):
+            cy_helpers.set_interpolation_device(True)
+
+        return self
+
+    def __exit__(self, *args):
+        cy_weatherers.set_num_threads(self._weathering_threads)
+        cy_helpers.set_interpolation_simd(True)
+        if self.config.get('device', False):
+            cy_helpers.set_interpolation_device(False)
+
+        return False
+
+
+def configure(model, config):
+    """
+    sets the model and its movers up for the configuration
+    """
+    for option in MODEL_OPTIONS:
+        if option in config:
+            setattr(model, option, config[option])
+
+    threads = config.get('threads', 1)
+    for m in model.movers:
+        cy_mover = getattr(m, 'mover', None)
+        if cy_mover is None:
+            continue
+
+        if hasattr(cy_mover, 'use_counter_rng'):
+            cy_mover.use_counter_rng = True
+        if hasattr(cy_mover, 'num_threads'):
+            cy_mover.num_threads = threads
+
+
+def run_steps(model, config):
+    """
+    runs the model from the start in the configuration
+
+    :returns: the snapshot() after each step
+    """
+    configure(model, config)
+
+    steps = []
+    with _Settings(config):
+        for _step in model:
+            steps.append(snapshot(model))
+
+    return steps
+
+
+def compare_runs(config, reference, steps, ulps=0):
+    """
+    the Divergences of the snapshots of a run from the reference run's,
+    step by step. A run with a different number of steps diverges at the
+    first step one of them doesn't have.
+    """
+    divergences = []
+
+    for step, (ref, other) in enumerate(zip(reference, steps)):
+        divergences.extend(compare_snapshots(config, step, ref, other, ulps))
+
+    if len(reference) != len(steps):
+        divergences.append(Divergence(config, min(len(reference), len(steps)),
+                                      None, 'steps', None, None))
+
+    return divergences
+
+
+def check_determinism(make_model, configurations=CONFIGURATIONS):
+    """
+    runs a new make_model() in each configuration, and compares the runs
+    with the first configuration's
+
+    :returns: the Divergences, by configuration and step, none if all the
+        runs come out the same
+    """
+    configurations = list(configurations)
+    reference = run_steps(make_model(), configurations[0])
+
+    divergences = []
+    for config in configurations[1:]:
+        steps = run_steps(make_model(), config)
+        divergences.extend(compare_runs(config.get('name', repr(config)),
+                                        reference, steps,
+                                        config.get('ulps', 0)))
+
+    return divergences
+
+
+def format_report(divergences):
+    """
+    the divergences as lines of text, by configuration and step
+    """
+    if not divergences:
+        return 'all the runs are the same'
+
+    lines = []
+    for d in divergences:
+        if d.name == 'steps':
+            lines.append('{0}: the run ends after step {1}'
+                         .format(d.config, d.step))
+        elif d.num_off is None:
+            lines.append('{0}: step {1}, spill container {2}: {3} is not '
+                         'for the same elements'
+                         .format(d.config, d.step, d.sc_index, d.name))
+        else:
+            lines.append('{0}: step {1}, spill container {2}: {3} of {4} '
+                         'elements off{5}'
+                         .format(d.config, d.step, d.sc_index, d.name,
+                                 d.num_off,
+                                 '' if d.max_ulps is None else
+                                 ' by up to {0:g} ulps'.format(d.max_ulps)))
+
+    return '\n'.join(lines)
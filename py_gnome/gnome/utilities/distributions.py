@@ -1,6 +1,9 @@
 #!/usr/bin/env python
 '''
 Classes that generate various types of probability distributions
+
+set_values() draws from numpy.random, or from the ElementRandom of the
+elements being initialized if it is given one.
 '''
 
 import copy
@@ -76,11 +79,14 @@ class UniformDistribution(Serializable):
             raise TypeError('Uniform probability distribution requires '
                             'low and high')
 
-    def _uniform(self, np_array):
-        np_array[:] = np.random.uniform(self.low, self.high, len(np_array))
+    def _uniform(self, np_array, rng=None):
+        if rng is None:
+            np_array[:] = np.random.uniform(self.low, self.high, len(np_array))
+        else:
+            np_array[:] = rng.uniform(self.low, self.high)
 
-    def set_values(self, np_array):
-        self._uniform(np_array)
+    def set_values(self, np_array, rng=None):
+        self._uniform(np_array, rng)
 
 
 class NormalDistribution(Serializable):
@@ -104,11 +110,14 @@ class NormalDistribution(Serializable):
             raise TypeError('Normal probability distribution requires '
                             'mean and sigma')
 
-    def _normal(self, np_array):
-        np_array[:] = np.random.normal(self.mean, self.sigma, len(np_array))
+    def _normal(self, np_array, rng=None):
+        if rng is None:
+            np_array[:] = np.random.normal(self.mean, self.sigma, len(np_array))
+        else:
+            np_array[:] = rng.normal(self.mean, self.sigma)
 
-    def set_values(self, np_array):
-        self._normal(np_array)
+    def set_values(self, np_array, rng=None):
+        self._normal(np_array, rng)
 
 
 class LogNormalDistribution(Serializable):
@@ -132,11 +141,14 @@ class LogNormalDistribution(Serializable):
             raise TypeError('Log Normal probability distribution requires '
                             'mean and sigma')
 
-    def _lognormal(self, np_array):
-        np_array[:] = np.random.lognormal(self.mean, self.sigma, len(np_array))
+    def _lognormal(self, np_array, rng=None):
+        if rng is None:
+            np_array[:] = np.random.lognormal(self.mean, self.sigma, len(np_array))
+        else:
+            np_array[:] = rng.lognormal(self.mean, self.sigma)
 
-    def set_values(self, np_array):
-        self._lognormal(np_array)
+    def set_values(self, np_array, rng=None):
+        self._lognormal(np_array, rng)
 
 
 class WeibullDistribution(Serializable):
@@ -189,7 +201,13 @@ class WeibullDistribution(Serializable):
                 raise ValueError('Weibull distribution requires '
                                  'maximum > .000025 (25 microns)')
 
-    def _weibull(self, np_array):
+    def _weibull(self, np_array, rng=None):
+        if rng is not None:
+            # no draws are rejected - see ElementRandom.weibull()
+            np_array[:] = rng.weibull(self.alpha, self.lambda_,
+                                      self.min_, self.max_)
+            return
+
         np_array[:] = self.lambda_ * np.random.weibull(self.alpha,
                                                        len(np_array))
 
@@ -206,8 +224,8 @@ class WeibullDistribution(Serializable):
                 while np_array[x] > self.max_:
                     np_array[x] = self.lambda_ * np.random.weibull(self.alpha)
 
-    def set_values(self, np_array):
-        self._weibull(np_array)
+    def set_values(self, np_array, rng=None):
+        self._weibull(np_array, rng)
 
 
 class RayleighDistribution():
@@ -7,36 +7,198 @@ based on the classic C fscanf
 import sys
 
 cimport cython
+from cython.parallel cimport prange
 import numpy as np
 cimport numpy as cnp
 cimport libc
 from libc cimport stdio
 from libc.stdint cimport uint32_t, UINT32_MAX
+from libc.stdlib cimport strtod, malloc, free
+from libc.string cimport memcpy
 from cpython cimport *
 
 
 
 
-## NOTE: this to get the file pointer form the python file object
-##       does not work in Py3!
-
-# cdef extern from "Python.h":
-#     ## dont know why I need this -- shouldn't it be in the cpython pxd?
-#     stdio.FILE* PyFile_AsFile(PyObject*)
-#     int PyFile_CheckExact(PyObject*)
-
-#    void  fprintf(FILE* f, char* s, char* s)
-# Next, enter the builtin file class into the namespace:
-#cdef extern from "fileobject.h":
-#    ctypedef class __builtin__.file [object PyFileObject]:
-#        pass
+## NOTE: getting the FILE* from a python file object only works on Py2.
+##       The compat header stubs it out on Py3, where scan() reads the
+##       file object's text and scans that with the buffer scanner below.
+cdef extern from "filescanner_compat.h":
+    cdef stdio.FILE *PyFile_AsFile(object) except NULL
+    cdef int PyFile_CheckExact(object)
+    cdef Py_ssize_t PY_SSIZE_T_MAX
 
 cdef extern from "ctype.h":
     cdef int isspace( int )
 
-cdef extern from "fileobject.h":
-    cdef stdio.FILE *PyFile_AsFile(object) except NULL
-    cdef int PyFile_CheckExact(object)
+if sys.version_info[0] < 3:
+    import __builtin__ as builtins
+else:
+    import builtins
+
+# the Py2 file type, which scan() reads through its FILE*
+_file_type = getattr(builtins, 'file', None)
+
+
+# The buffer scanner reads what scan() reads with fscanf("%lg") from a
+# file: white space is skipped, then the input item fscanf takes is taken -
+# which for a failed conversion can include the character that didn't
+# match - and on a failure scan() skips one more character. Hex floats
+# ("0x1p3") are not read as hex: they scan as 0 followed by what follows
+# the x.
+
+cdef inline bint _is_space(char c) nogil:
+    return c == b' ' or (c >= b'\t' and c <= b'\r')
+
+
+cdef inline bint _is_digit(char c) nogil:
+    return c >= b'0' and c <= b'9'
+
+
+cdef inline char _lower(char c) nogil:
+    if c >= b'A' and c <= b'Z':
+        return c + 32
+    return c
+
+
+cdef Py_ssize_t _match_word(const char *p, Py_ssize_t n, const char *word,
+                            bint *whole) nogil:
+    """
+    the characters of word (lower case) that match at p, and the one that
+    doesn't, which fscanf takes too
+    """
+    cdef Py_ssize_t i = 0
+
+    while word[i] != 0 and i < n and _lower(p[i]) == word[i]:
+        i += 1
+
+    whole[0] = word[i] == 0
+    if not whole[0] and i < n:
+        i += 1
+
+    return i
+
+
+cdef Py_ssize_t _number_item(const char *p, Py_ssize_t n, bint *valid) nogil:
+    """
+    the length of the input item %lg takes at p, and whether it is a number
+    """
+    cdef Py_ssize_t i = 0
+    cdef bint digits = False, whole
+    cdef const char *word
+
+    valid[0] = False
+
+    if i < n and (p[i] == b'+' or p[i] == b'-'):
+        i += 1
+
+    if i < n and (_lower(p[i]) == b'i' or _lower(p[i]) == b'n'):
+        word = "inf" if _lower(p[i]) == b'i' else "nan"
+        i += _match_word(p + i, n - i, word, &whole)
+        if not whole:
+            return i
+        if word[0] == b'i' and i < n and _lower(p[i]) == b'i':
+            i += _match_word(p + i, n - i, "inity", &whole)
+            if not whole:
+                return i
+        valid[0] = True
+        return i
+
+    while i < n and _is_digit(p[i]):
+        i += 1
+        digits = True
+    if i < n and p[i] == b'.':
+        i += 1
+        while i < n and _is_digit(p[i]):
+            i += 1
+            digits = True
+    if not digits:
+        return i
+
+    # an exponent without digits is taken, and the number is still good
+    if i < n and (p[i] == b'e' or p[i] == b'E'):
+        i += 1
+        if i < n and (p[i] == b'+' or p[i] == b'-'):
+            i += 1
+        while i < n and _is_digit(p[i]):
+            i += 1
+
+    valid[0] = True
+    return i
+
+
+cdef double _to_double(const char *p, Py_ssize_t length) nogil:
+    """
+    the number in p[:length], which strtod needs null terminated
+    """
+    cdef char small[64]
+    cdef char *token = small
+    cdef double value
+
+    if length >= 64:
+        token = <char*> malloc(length + 1)
+        if token == NULL:
+            return 0
+    memcpy(token, p, length)
+    token[length] = 0
+
+    value = strtod(token, NULL)
+
+    if token != small:
+        free(token)
+
+    return value
+
+
+cdef Py_ssize_t _scan_values(const char *p, Py_ssize_t n,
+                             Py_ssize_t max_count, double *out,
+                             Py_ssize_t *end) nogil:
+    """
+    scans up to max_count numbers from p[:n] into out (or just counts them
+    when out is NULL). end is set to where the scan stopped: just past the
+    last number, so another scan can go on from there.
+    """
+    cdef Py_ssize_t i = 0, count = 0, length
+    cdef bint valid
+
+    while count < max_count:
+        while i < n and _is_space(p[i]):
+            i += 1
+        if i >= n:
+            break
+
+        length = _number_item(p + i, n - i, &valid)
+        if valid:
+            if out != NULL:
+                out[count] = _to_double(p + i, length)
+            count += 1
+            i += length
+        else:
+            i += length + 1
+
+    end[0] = i if i < n else n
+
+    return count
+
+
+cdef Py_ssize_t _chunk_start(const char *p, Py_ssize_t start, Py_ssize_t n,
+                             Py_ssize_t i) nogil:
+    """
+    The first place at or after i a chunk can start: after white space that
+    follows white space or a digit. No input item or skipped character
+    runs across that, so scanning the chunks on their own reads what
+    scanning the whole reads.
+    """
+    if i < start + 2:
+        i = start + 2
+
+    while i < n:
+        if _is_space(p[i - 1]) and (_is_space(p[i - 2]) or
+                                    _is_digit(p[i - 2])):
+            return i
+        i += 1
+
+    return n
 
 
 def scan(infile, num_to_read=None):
@@ -44,7 +206,8 @@ def scan(infile, num_to_read=None):
     scan the file and return a numpy array of float64.
 
     :param infile: the file to scan
-    :type infile: and open python file object.
+    :type infile: an open python file object, or any open, readable and
+                  seekable file-like object (io.open(), Py3 files)
 
     :param num_to_read=None: the number of values to read. If None,
                              then reads all the numbers in the file.
@@ -63,10 +226,13 @@ def scan(infile, num_to_read=None):
 
     N = UINT32_MAX if num_to_read is None else num_to_read
 
+    if _file_type is None or type(infile) is not _file_type:
+        # no FILE* to read through (Py3, or an io module file)
+        return _scan_file_object(infile, num_to_read)
+
     ## does all this checking cost too much?
     ## and CheckExact is there later anyway...
-    if  ( (type(infile) is not file) or
-          infile.closed or
+    if  ( infile.closed or
           not ('r' in infile.mode or 'a' in infile.mode)
         ):
         raise TypeError("infile must be an open file object")
@@ -111,7 +277,8 @@ def scan(infile, num_to_read=None):
             break
         if num_read > out_arr.shape[0]: # need to make the array bigger
             # NOTE: ndarray.resize does not work in Cython
-            out_arr.resize( ( <int> out_arr.shape[0]*1.2, ), refcheck=False)
+            # doubling keeps the copies linear in the size of the file
+            out_arr.resize( ( <int> out_arr.shape[0]*2, ), refcheck=False)
             arr_view = out_arr
             #temp = np.zeros( (num_read+<int> out_arr.shape[0]*1.5) )
             #temp[:num_read-1] = out_arr
@@ -139,6 +306,291 @@ def scan(infile, num_to_read=None):
     return out_arr
 
 
+def scan_buffer(buf, num_to_read=None, Py_ssize_t offset=0, out=None,
+                int num_threads=1):
+    """
+    scan the numbers out of a buffer of text, as scan() scans a file
+
+    :param buf: the text: a bytes, bytearray, mmap or anything else with
+                the buffer interface. mmap a large file to scan it without
+                reading it all into memory first.
+
+    :param num_to_read=None: the number of values to read. If None, reads
+                             all the numbers in the buffer, or as many as
+                             out holds if out is given.
+    :type num_to_read: integer
+
+    :param offset=0: where in buf to start
+
+    :param out=None: a float64 array to put the values in, instead of a new
+                     one. It must be C contiguous and hold num_to_read.
+
+    :param num_threads=1: scans large buffers in this many chunks at once,
+                          in parallel when filescanner is built with
+                          GNOME_OPENMP=1. The values are what one thread
+                          reads.
+
+    :returns: (values, end): the values, in out when it is given, and the
+              offset in buf past them and the white space after them, where
+              the text that follows starts.
+
+    Raises a ValueError if there are fewer than num_to_read numbers.
+    """
+    # plain arrays: a typed buffer would have to be writeable, and the
+    # values are written through the pointer
+    cdef cnp.ndarray text, out_arr
+    cdef const char *p
+    cdef double *values
+    cdef Py_ssize_t n, N, num_read, end, i, c, num_chunks
+    cdef Py_ssize_t[:] starts, counts, ends, firsts
+
+    if isinstance(buf, unicode):
+        raise TypeError("buf must be bytes or a buffer, not unicode text")
+
+    try:
+        text = np.frombuffer(buf, dtype=np.uint8)
+    except ValueError:
+        # older numpy can't make an array of an empty buffer
+        if len(buf) != 0:
+            raise
+        text = np.zeros((1,), dtype=np.uint8)[:0]
+
+    n = text.shape[0]
+    p = <const char*> cnp.PyArray_DATA(text)
+
+    if offset < 0 or offset > n:
+        raise ValueError("offset {0} is outside the buffer".format(offset))
+
+    if out is not None:
+        out_arr = out
+        if (out_arr.dtype != np.float64 or out_arr.ndim != 1 or
+                not out_arr.flags.c_contiguous or
+                not out_arr.flags.writeable):
+            raise ValueError("out must be a writeable, contiguous 1-d "
+                             "float64 array")
+        if num_to_read is None:
+            num_to_read = out_arr.shape[0]
+        elif num_to_read > out_arr.shape[0]:
+            raise ValueError("out holds {0} values, not {1}"
+                             .format(out_arr.shape[0], num_to_read))
+
+    N = PY_SSIZE_T_MAX if num_to_read is None else num_to_read
+    if N < 0:
+        raise ValueError("num_to_read can't be negative")
+
+    num_chunks = max(1, num_threads)
+    if N == 0 or (n - offset) < 4096 * num_chunks:
+        num_chunks = 1
+
+    if num_chunks == 1 and N != PY_SSIZE_T_MAX:
+        if out is None:
+            out_arr = np.zeros((N,), dtype=np.float64)
+        values = <double*> cnp.PyArray_DATA(out_arr)
+
+        with nogil:
+            num_read = _scan_values(p + offset, n - offset, N, values, &end)
+        end += offset
+
+    elif num_chunks == 1:
+        # reading them all: grow the array as scan() does
+        out_arr = np.zeros((128,), dtype=np.float64)
+        num_read = 0
+        end = offset
+
+        while True:
+            values = <double*> cnp.PyArray_DATA(out_arr)
+            i = out_arr.shape[0] - num_read
+            with nogil:
+                c = _scan_values(p + end, n - end, i, values + num_read, &i)
+            num_read += c
+            end += i
+            if num_read < out_arr.shape[0] or end >= n:
+                break
+            out_arr.resize((out_arr.shape[0] * 2,), refcheck=False)
+
+    else:
+        # count the numbers in each chunk, then read them into their places
+        starts = np.empty((num_chunks + 1,), dtype=np.intp)
+        counts = np.zeros((num_chunks,), dtype=np.intp)
+        ends = np.empty((num_chunks,), dtype=np.intp)
+        firsts = np.zeros((num_chunks,), dtype=np.intp)
+
+        starts[0] = offset
+        starts[num_chunks] = n
+        for c in range(1, num_chunks):
+            starts[c] = _chunk_start(p, offset, n,
+                                     max(starts[c - 1],
+                                         offset + (n - offset) * c //
+                                         num_chunks))
+
+        with nogil:
+            for c in prange(num_chunks, num_threads=num_chunks,
+                            schedule='static'):
+                counts[c] = _scan_values(p + starts[c],
+                                         starts[c + 1] - starts[c],
+                                         PY_SSIZE_T_MAX, NULL, &ends[c])
+
+        num_read = 0
+        for c in range(num_chunks):
+            firsts[c] = num_read
+            num_read = num_read + counts[c]
+            if num_read >= N:
+                # the ones past N are left
+                counts[c] -= num_read - N
+                num_read = N
+                num_chunks = c + 1
+                break
+
+        if out is None:
+            out_arr = np.zeros((num_read,), dtype=np.float64)
+        values = <double*> cnp.PyArray_DATA(out_arr)
+
+        with nogil:
+            for c in prange(num_chunks, num_threads=num_chunks,
+                            schedule='static'):
+                counts[c] = _scan_values(p + starts[c],
+                                         starts[c + 1] - starts[c],
+                                         counts[c], values + firsts[c],
+                                         &ends[c])
+
+        if N == PY_SSIZE_T_MAX:
+            end = n
+        else:
+            end = starts[num_chunks - 1] + ends[num_chunks - 1]
+
+    if N != PY_SSIZE_T_MAX and num_read < N:
+        raise ValueError("not enough values in the buffer -- only read %i"
+                         % num_read)
+
+    # advance past any whitespace left
+    while end < n and _is_space(p[end]):
+        end += 1
+
+    if out is not None:
+        return out[:num_read], end
+
+    if out_arr.shape[0] > num_read:
+        out_arr.resize((num_read, ), refcheck=False)
+    return out_arr, end
+
+
+def _scan_file_object(infile, num_to_read):
+    """
+    scan() for the file objects that have no FILE*: reads the rest of the
+    file, scans it, and leaves the file after what was scanned.
+    """
+    try:
+        readable = (not infile.closed and infile.readable() and
+                    infile.seekable())
+    except (AttributeError, ValueError):
+        readable = False
+    if not readable:
+        raise TypeError("infile must be an open, readable file object")
+
+    start = infile.tell()
+    text = infile.read()
+    if isinstance(text, unicode):
+        # one byte to a character, so the end is a count of characters
+        data = text.encode('latin-1', 'replace')
+    else:
+        data = text
+
+    values, end = scan_buffer(data, num_to_read)
+
+    infile.seek(start)
+    infile.read(end)
+
+    return values
+
+def scan_bna(buf, header):
+    """
+    scan the polygons of the text of a BNA file in one pass, as
+    haz_files.GetNextBNAPolygon reads them one at a time with scan()
+
+    :param buf: the text: bytes or anything else with the buffer interface
+                that slices to bytes, like an mmap
+
+    :param header: the function that reads a header line:
+                   header(line) -> (num_points, poly_type, name, sname)
+
+    :returns: (points, starts, metadata): the (N, 2) float64 points of all
+              the polygons, the index in points of the first point of each
+              and of the end (so polygon k is points[starts[k]:starts[k+1]]),
+              and the (poly_type, name, sname) of each. The last point of a
+              'polygon' that is the same as its first is left out.
+
+    The lines end with \\n, \\r\\n or \\r. Raises a ValueError if a polygon
+    has fewer numbers than its header says.
+    """
+    cdef cnp.ndarray text, out_arr
+    cdef const char *p
+    cdef double *values
+    cdef Py_ssize_t n, i = 0, line_end, header_end, end, count
+    cdef Py_ssize_t num_points, total = 0
+
+    if isinstance(buf, unicode):
+        raise TypeError("buf must be bytes or a buffer, not unicode text")
+
+    try:
+        text = np.frombuffer(buf, dtype=np.uint8)
+    except ValueError:
+        # older numpy can't make an array of an empty buffer
+        if len(buf) != 0:
+            raise
+        text = np.zeros((1,), dtype=np.uint8)[:0]
+
+    n = text.shape[0]
+    p = <const char*> cnp.PyArray_DATA(text)
+
+    # x, y of each point, grown as scan() grows its array
+    out_arr = np.zeros((256,), dtype=np.float64)
+    starts = [0]
+    metadata = []
+
+    while True:
+        # blank lines are skipped
+        while i < n and _is_space(p[i]):
+            i += 1
+        if i >= n:
+            break
+
+        line_end = i
+        while line_end < n and p[line_end] != b'\n' and p[line_end] != b'\r':
+            line_end += 1
+
+        line = buf[i:line_end]
+        if not isinstance(line, str):
+            line = line.decode('latin-1')
+        num_points, poly_type, name, sname = header(line)
+
+        while 2 * (total + num_points) > out_arr.shape[0]:
+            out_arr.resize((out_arr.shape[0] * 2,), refcheck=False)
+        values = <double*> cnp.PyArray_DATA(out_arr) + 2 * total
+
+        with nogil:
+            count = _scan_values(p + line_end, n - line_end, 2 * num_points,
+                                 values, &end)
+        if count < 2 * num_points:
+            raise ValueError("not enough values for {0} -- only read {1}"
+                             .format(name, count))
+        i = line_end + end
+
+        # first and last points are the same in BNA, but we don't want the
+        # duplicate point
+        if (poly_type == 'polygon' and values[0] == values[2 * num_points - 2]
+                and values[1] == values[2 * num_points - 1]):
+            num_points -= 1
+
+        total += num_points
+        starts.append(total)
+        metadata.append((poly_type, name, sname))
+
+    out_arr.resize((2 * total,), refcheck=False)
+    out_arr.shape = (-1, 2)
+
+    return out_arr, np.array(starts, dtype=np.int_), metadata
+
+
 @cython.boundscheck(False)
 def resize_test():
     """
@@ -0,0 +1,30 @@
+/*
+ * filescanner_compat.h
+ *
+ * The Python 2 file object calls filescanner.scan() reads through. Python 3
+ * files have no FILE*, so there they are stubs that are never reached:
+ * scan() scans the text of those files instead.
+ */
+
+#ifndef FILESCANNER_COMPAT_H
+#define FILESCANNER_COMPAT_H
+
+#include "Python.h"
+
+#if PY_MAJOR_VERSION >= 3
+
+#define PyFile_CheckExact(op) 0
+
+static FILE *PyFile_AsFile(PyObject *f)
+{
+    PyErr_SetString(PyExc_TypeError, "Python 3 files have no FILE*");
+    return NULL;
+}
+
+#else
+
+#include "fileobject.h"
+
+#endif
+
+#endif
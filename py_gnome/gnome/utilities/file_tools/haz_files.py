@@ -10,7 +10,7 @@ import os
 import numpy as np
 
 try:
-    from .filescanner import scan
+    from .filescanner import scan, scan_bna
     FILESCANNER = True
 except:
     FILESCANNER = False
@@ -198,6 +198,37 @@ def WriteVerdatFile(filename, PointData, Boundaries):
     fd.close()
 
 
+def ReadBNAHeader(header):
+    """
+    Reads the header line of a BNA polygon
+
+    returns: (num_points, poly_type, name, sname), as GetNextBNAPolygon
+    """
+    try:
+        fields = header.split('"')
+        name = fields[1]
+        sname = fields[3]
+        num_points = int(fields[4].strip()[1:])
+        #header = header.replace('", "', '","') # some bnas have an extra space
+        #name, rest = header.strip().split('","')
+    except ValueError, IndexError:
+        raise ValueError('something wrong with header line: {0}'
+                         .format(header))
+
+    if num_points < 0 or num_points == 2:
+        poly_type = 'polyline'
+        num_points = abs(num_points)
+    elif num_points == 1:
+        poly_type = 'point'
+    elif num_points > 2:
+        poly_type = 'polygon'
+    else:
+        raise BnaError("polygon {0} does not have a valid number of points"
+                       .format(name))
+
+    return (num_points, poly_type, name, sname)
+
+
 def GetNextBNAPolygon(f, dtype=np.float64):
     """
     Utility function that returns the next polygon from a BNA file
@@ -229,27 +260,8 @@ def GetNextBNAPolygon(f, dtype=np.float64):
             break
         else:
             continue
-    try:
-        fields = header.split('"')
-        name = fields[1]
-        sname = fields[3]
-        num_points = int(fields[4].strip()[1:])
-        #header = header.replace('", "', '","') # some bnas have an extra space
-        #name, rest = header.strip().split('","')
-    except ValueError, IndexError:
-        raise ValueError('something wrong with header line: {0}'
-                         .format(header))
 
-    if num_points < 0 or num_points == 2:
-        poly_type = 'polyline'
-        num_points = abs(num_points)
-    elif num_points == 1:
-        poly_type = 'point'
-    elif num_points > 2:
-        poly_type = 'polygon'
-    else:
-        raise BnaError("polygon {0} does not have a valid number of points"
-                       .format(name))
+    num_points, poly_type, name, sname = ReadBNAHeader(header)
 
     if FILESCANNER:
             points = scan(f, num_points * 2)
@@ -303,7 +315,22 @@ def ReadBNA(filename, polytype="list", dtype=np.float):
 
     The dtype parameter specifies what numpy data type you want the points
     data in -- it defaults to np.float (C double)
+
+    With the filescanner extension, the "list" and "PolygonSet" polygons
+    are read in one pass over the file by filescanner.scan_bna.
     """
+    if FILESCANNER and polytype in ('list', 'PolygonSet'):
+        with open(filename, 'rb') as fd:
+            points, starts, metadata = scan_bna(fd.read(), ReadBNAHeader)
+
+        if polytype == 'list':
+            return [(points[starts[k]:starts[k + 1]].astype(dtype),) +
+                    metadata[k] for k in range(len(metadata))]
+
+        from ..geometry import polygons
+        return polygons.PolygonSet.from_arrays(points, starts, metadata,
+                                               dtype=dtype)
+
     fd = open(filename, 'rU')
 
     if polytype == 'list':
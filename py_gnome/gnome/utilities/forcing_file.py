@@ -0,0 +1,42 @@
+#!/usr/bin/env python
+"""
+forcing_file.py
+
+Converts a NetCDF current file to a GNOME forcing file: its time slices
+decoded the way the grid current movers read them, kept in tiles with the
+times and the curvilinear grid's topology, in one file mapped in place by
+gnome.cy_gnome.cy_helpers.open_forcing_file(). A run with the forcing file
+open reads no NetCDF for its slices, and one on an active window only pages
+in the tiles it uses.
+
+The grid reads the source file to write it, so write it once ahead of the
+runs, on the platform they run on (the file keeps the platform's sizes).
+
+usage: forcing_file.py current_file [topology_file] forcing_file
+"""
+import sys
+
+from gnome.cy_gnome.cy_gridcurrent_mover import CyGridCurrentMover
+
+
+def write_forcing_file(current_file, forcing_file, topology_file=None):
+    """
+    Writes forcing_file from the NetCDF current_file, read like
+    GridCurrentMover reads it (with the topology file if it has one).
+
+    :raises: OSError if the current file can't be read or the forcing file
+             can't be written
+    """
+    mover = CyGridCurrentMover()
+    mover.text_read(current_file, topology_file)
+    mover.write_forcing_file(forcing_file)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) not in (3, 4):
+        print __doc__
+        sys.exit(1)
+
+    args = sys.argv[1:]
+    write_forcing_file(args[0], args[-1],
+                       args[1] if len(args) == 3 else None)
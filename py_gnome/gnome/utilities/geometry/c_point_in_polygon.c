@@ -92,3 +92,86 @@ char c_point_in_poly1(int nvert, double *vertices, double *point)
 //     return c;
 // }
 
+
+
+/*
+Point in polygon with an index of the polygon edges
+
+The edges of a set of polygons are binned in a uniform grid of cells over
+their bounding box, so a point only tests the edges that lie in its row of
+cells, at or to the right of its cell -- the edges that the ray of the
+crossing test above can reach. Each edge is tested in the first of its
+cells that the point visits, with exactly the test of c_point_in_poly1, so
+the result is the same as testing every polygon.
+
+In each row, an edge is binned in the cells from the least to the greatest
+x it has in that row. The right side is pushed out by a margin of far more
+than the rounding error of the crossing x, so a point to the left of the
+crossing is never in a cell to the right of the edge.
+*/
+
+// the cell of coordinate v, for cells of 1 / scale from origin
+int c_cell_index(double v, double origin, double scale, int n)
+{
+    double c = (v - origin) * scale;
+
+    if (!(c >= 0.0))  // also NaN
+        return 0;
+    if (c >= n)
+        return n - 1;
+    return (int)c;
+}
+
+// The last polygon that point is in, or -1 if it is in none of them
+int c_locate_point(const double *edges, const int *edge_poly,
+                   const int *cell_start, const int *cell_edges,
+                   const int *cell_first, int nx, int ny,
+                   const double *grid, const double *point,
+                   char *parity, int *touched)
+/*  edges       the (xi, yi, xj, yj) of each edge, aranged as an Nx4 array
+    edge_poly   the polygon of each edge
+    cell_start  where the edges of each cell, row by row, start in cell_edges
+                (nx * ny + 1 of them)
+    cell_edges  the edges of the cells
+    cell_first  the first column of each of cell_edges in its row of cells
+    grid        the (x, y) origin and the (x, y) scale of the cells
+    parity      0 for each polygon -- left that way
+    touched     room for an index for each polygon
+*/
+{
+    int col, row, k, e, end, poly, ntouched = 0, result = -1;
+    const double *edge;
+
+    col = c_cell_index(point[0], grid[0], grid[2], nx);
+    row = c_cell_index(point[1], grid[1], grid[3], ny);
+
+    for (k = col; k < nx; k++) {
+        end = cell_start[row * nx + k + 1];
+        for (e = cell_start[row * nx + k]; e < end; e++) {
+            int i = cell_edges[e];
+
+            // tested in an earlier cell
+            if ((cell_first[e] > col ? cell_first[e] : col) != k)
+                continue;
+
+            edge = edges + 4 * i;
+            if ( ((edge[1]>point[1]) != (edge[3]>point[1])) &&
+                (point[0] < (edge[2]-edge[0]) * (point[1]-edge[1]) / (edge[3]-edge[1]) + edge[0]) ) {
+                // 1 inside, 2 outside again, 0 not crossed
+                poly = edge_poly[i];
+                if (parity[poly] == 0)
+                    touched[ntouched++] = poly;
+                parity[poly] = (parity[poly] == 1) ? 2 : 1;
+            }
+        }
+    }
+
+    for (k = 0; k < ntouched; k++) {
+        poly = touched[k];
+        if (parity[poly] == 1 && poly > result)
+            result = poly;
+        parity[poly] = 0;
+    }
+
+    return result;
+}
@@ -0,0 +1,260 @@
+/*
+C code for drawing points and filled polygons into an 8 bit image
+
+The image is an array of bytes indexed [x, y] -- the layout of
+MapCanvas.back_asarray() and the RasterMap bitmap -- given by a pointer to
+pixel (0, 0) and the byte strides of x and y. Each call draws only into the
+columns x0 <= x < x1 of the image, so the image can be cut in column tiles
+that are drawn at the same time, with nothing shared but the input.
+
+Pixel x covers the coordinates x <= c < x + 1, so pixel coordinates are
+floored to get the pixel, as projections.to_pixel(asint=True) does.
+
+Without anti-aliasing a pixel is drawn if its center is in the shape, and
+the pixel gets the value. With anti-aliasing of n > 1, n x n samples are
+tested in each pixel, and the pixel gets the value scaled by the part of
+the samples in the shape -- if that is more than it has. That makes the
+image a layer of coverage (alpha, density) rather than a paletted image,
+where scaled values would be meaningless color indexes.
+*/
+
+#include <math.h>
+
+#define SHAPE_ROUND 0
+#define SHAPE_X 1
+
+#define HALF_DIAGONAL 0.70710678118654752440
+
+// (lon, lat) to pixel coordinates, with a transform of
+// (center_x, center_y, scale_x, scale_y, offset_x, offset_y)
+void c_project_point(const double *transform, const double *coords,
+                     double *pixel)
+{
+    pixel[0] = (coords[0] - transform[0]) * transform[2] + transform[4];
+    pixel[1] = (coords[1] - transform[1]) * transform[3] + transform[5];
+}
+
+// the tile a pixel coordinate is in, -1 left of the image and ntiles right
+// of it, NaN is off the image too
+int c_tile_index(double x, int width, int tile_size)
+{
+    int ntiles = (width + tile_size - 1) / tile_size;
+
+    if (x >= 0.0 && x < width)
+        return (int)x / tile_size;
+    if (x < 0.0)
+        return -1;
+    return ntiles;
+}
+
+static int in_shape(int shape, double dx, double dy, int diameter)
+{
+    double r = diameter / 2.0;
+
+    if (shape == SHAPE_X) {
+        double arm = (diameter / 2) + 0.5;
+
+        if (fabs(dx) > arm || fabs(dy) > arm)
+            return 0;
+        return fabs(dx - dy) <= HALF_DIAGONAL || fabs(dx + dy) <= HALF_DIAGONAL;
+    }
+
+    return dx * dx + dy * dy <= r * r;
+}
+
+static void put_value(unsigned char *pixels, long xstride, long ystride,
+                      long x, long y, int coverage, int samples,
+                      unsigned char value)
+{
+    unsigned char *p = pixels + x * xstride + y * ystride;
+
+    if (samples == 1) {
+        *p = value;
+    }
+    else {
+        unsigned char v = (unsigned char)((coverage * value + samples / 2) / samples);
+
+        if (v > *p)
+            *p = v;
+    }
+}
+
+// Draws a point at pixel coordinates (px, py), clipped to columns x0 to x1
+// of an image of height rows.
+//
+// A round point is a disk of the diameter, an x point is two diagonal
+// strokes a pixel wide, diameter / 2 pixels out from the center. Without
+// anti-aliasing the shape is centered in the pixel the point is in (on its
+// lower right corner for even diameters), so a diameter of 1 is that pixel
+// and 2 the 2x2 block it starts; with it the shape is centered on the point.
+void c_draw_point(unsigned char *pixels, long xstride, long ystride,
+                  long x0, long x1, long height,
+                  double px, double py, int diameter, int shape,
+                  int antialias, unsigned char value)
+{
+    double cx, cy, reach, sx, sy, step;
+    long x, y, xa, xb, ya, yb;
+    int i, j, n, count;
+
+    if (!(px == px) || !(py == py) || diameter < 1)
+        return;
+
+    if (antialias > 1) {
+        n = antialias;
+        cx = px;
+        cy = py;
+    }
+    else {
+        n = 1;
+        cx = floor(px) + 0.5;
+        cy = floor(py) + 0.5;
+        if (shape == SHAPE_ROUND && diameter % 2 == 0) {
+            cx += 0.5;
+            cy += 0.5;
+        }
+    }
+
+    reach = diameter / 2.0 + 1.0;
+    if (cx + reach < x0 || cx - reach >= x1 || cy + reach < 0 || cy - reach >= height)
+        return;
+
+    xa = (long)floor(cx - reach);
+    xb = (long)floor(cx + reach);
+    ya = (long)floor(cy - reach);
+    yb = (long)floor(cy + reach);
+    if (xa < x0) xa = x0;
+    if (xb > x1 - 1) xb = x1 - 1;
+    if (ya < 0) ya = 0;
+    if (yb > height - 1) yb = height - 1;
+
+    step = 1.0 / n;
+    for (x = xa; x <= xb; x++) {
+        for (y = ya; y <= yb; y++) {
+            count = 0;
+            for (i = 0; i < n; i++) {
+                sx = x + (i + 0.5) * step - cx;
+                for (j = 0; j < n; j++) {
+                    sy = y + (j + 0.5) * step - cy;
+                    count += in_shape(shape, sx, sy, diameter);
+                }
+            }
+            if (count)
+                put_value(pixels, xstride, ystride, x, y, count, n * n, value);
+        }
+    }
+}
+
+// where the edges of the polygon cross the line y = sy, sorted. The test
+// is the one of c_point_in_poly1, so a vertex on the line is counted once.
+static int crossings(const double *vertices, int nvert, double sy,
+                     double *xs)
+{
+    int i, j, k, n = 0;
+    double x;
+
+    for (i = 0, j = nvert - 1; i < nvert; j = i++) {
+        const double *a = vertices + 2 * i, *b = vertices + 2 * j;
+
+        if ((a[1] > sy) != (b[1] > sy)) {
+            x = (b[0] - a[0]) * (sy - a[1]) / (b[1] - a[1]) + a[0];
+
+            // insertion sort -- there are only a few
+            for (k = n; k > 0 && xs[k - 1] > x; k--)
+                xs[k] = xs[k - 1];
+            xs[k] = x;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+// Fills the polygon of nvert (x, y) pixel coordinates, clipped to columns
+// x0 to x1 of an image of height rows, with the even-odd rule.
+//
+// xs needs room for nvert values, and with anti-aliasing coverage for
+// x1 - x0. Anti-aliased rows are cut in antialias lines, and the part of
+// each pixel that the spans on the lines cover is added up exactly, so the
+// edges are smooth in x as well as y.
+void c_fill_polygon(unsigned char *pixels, long xstride, long ystride,
+                    long x0, long x1, long height,
+                    const double *vertices, int nvert,
+                    int antialias, unsigned char value,
+                    double *xs, double *coverage)
+{
+    double ymin, ymax, xmin, xmax, sy, a, b;
+    long x, y, ya, yb, xa, xb;
+    int i, k, s, n, ncross;
+
+    if (nvert < 3)
+        return;
+
+    xmin = xmax = vertices[0];
+    ymin = ymax = vertices[1];
+    for (i = 1; i < nvert; i++) {
+        if (vertices[2 * i] < xmin) xmin = vertices[2 * i];
+        if (vertices[2 * i] > xmax) xmax = vertices[2 * i];
+        if (vertices[2 * i + 1] < ymin) ymin = vertices[2 * i + 1];
+        if (vertices[2 * i + 1] > ymax) ymax = vertices[2 * i + 1];
+    }
+
+    // also false for NaN
+    if (!(xmax >= x0 && xmin < x1 && ymax >= 0 && ymin < height))
+        return;
+
+    ya = ymin > 0 ? (long)floor(ymin) : 0;
+    yb = ymax < height - 1 ? (long)floor(ymax) : height - 1;
+    n = antialias > 1 ? antialias : 1;
+
+    for (y = ya; y <= yb; y++) {
+        if (n > 1) {
+            for (x = 0; x < x1 - x0; x++)
+                coverage[x] = 0.0;
+        }
+
+        for (s = 0; s < n; s++) {
+            sy = y + (s + 0.5) / n;
+            ncross = crossings(vertices, nvert, sy, xs);
+
+            for (k = 0; k + 1 < ncross; k += 2) {
+                a = xs[k] > x0 ? xs[k] : x0;
+                b = xs[k + 1] < x1 ? xs[k + 1] : x1;
+                if (!(a < b))
+                    continue;
+
+                if (n == 1) {
+                    // the pixels with their centers in [a, b)
+                    xa = (long)ceil(a - 0.5);
+                    xb = (long)ceil(b - 0.5);
+                    for (x = xa; x < xb; x++)
+                        put_value(pixels, xstride, ystride, x, y, 1, 1, value);
+                }
+                else {
+                    xa = (long)floor(a);
+                    xb = (long)floor(b);
+                    if (xa == xb) {
+                        coverage[xa - x0] += b - a;
+                    }
+                    else {
+                        coverage[xa - x0] += xa + 1 - a;
+                        for (x = xa + 1; x < xb; x++)
+                            coverage[x - x0] += 1.0;
+                        if (xb < x1)
+                            coverage[xb - x0] += b - xb;
+                    }
+                }
+            }
+        }
+
+        if (n > 1) {
+            for (x = x0; x < x1; x++) {
+                // in 1 / 1024ths of the pixel
+                int c = (int)(coverage[x - x0] / n * 1024.0 + 0.5);
+
+                if (c > 0)
+                    put_value(pixels, xstride, ystride, x, y,
+                              c > 1024 ? 1024 : c, 1024, value);
+            }
+        }
+    }
+}
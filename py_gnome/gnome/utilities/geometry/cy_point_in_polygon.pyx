@@ -8,12 +8,22 @@ Should I just port the C to Cython???
 
 
 import cython
+from cython.parallel cimport prange, parallel
+from libc.stdlib cimport malloc, calloc, free
+from libc.math cimport fabs
 # import both numpy and the Cython declarations for numpy
 import numpy as np
 cimport numpy as cnp
 
 # declare the interface to the C code
 cdef extern char c_point_in_poly1(size_t nvert, double *vertices, double *point)
+cdef extern int c_cell_index(double v, double origin, double scale,
+                             int n) nogil
+cdef extern int c_locate_point(const double *edges, const int *edge_poly,
+                               const int *cell_start, const int *cell_edges,
+                               const int *cell_first, int nx, int ny,
+                               const double *grid, const double *point,
+                               char *parity, int *touched) nogil
 
 
 @cython.boundscheck(False)
@@ -115,6 +125,252 @@ def points_in_polys(cnp.ndarray[double,ndim=3, mode="c"] pgons, cnp.ndarray[doub
     for i in range(N):
         result[i] = c_point_in_poly1(M, &pgons[i,0,0], &points[i,0])
     return result.view(dtype=np.bool)
-    
-    
-    
+
+
+cdef class PolygonIndex:
+    """
+    PolygonIndex(polygons, cells=None)
+
+    An index of the edges of a set of polygons -- the land polygons of a
+    map, say -- for finding which of them a lot of points are in.
+
+    The edges are binned in a grid of cells over the polygons, so a point
+    is only tested against the edges in its row of cells, to the right of
+    it, instead of every edge of every polygon. The test of each edge is
+    the one points_in_poly does, so a point is in a polygon by the index
+    exactly when points_in_poly says it is.
+
+    :param polygons: A gnome.utilities.geometry.polygons.PolygonSet, or a
+                     sequence of Nx2 arrays of vertices
+    :param cells: the number of cells on each side of the grid
+                  (default: the square root of the number of edges)
+
+    The index is built once; points are located with locate() or
+    contains(), which test the points in parallel when the extension is
+    built with GNOME_OPENMP=1.
+    """
+    cdef readonly int num_polygons
+    cdef readonly int num_cells
+    cdef double grid[4]
+    cdef cnp.ndarray edges, edge_poly, cell_start, cell_edges, cell_first
+    cdef object polygons
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    @cython.cdivision(True)
+    def __init__(self, polygons, cells=None):
+        if hasattr(polygons, '_PointsArray'):
+            vertices = polygons._PointsArray
+            starts = polygons._IndexArray
+        else:
+            polygons = [np.asarray(p, dtype=np.float64).reshape(-1, 2)
+                        for p in polygons]
+            vertices = (np.concatenate(polygons) if polygons
+                        else np.zeros((0, 2)))
+            starts = np.r_[0, np.cumsum([len(p) for p in polygons])]
+
+        # kept for pickling
+        self.polygons = [np.array(vertices[starts[k]:starts[k + 1]])
+                         for k in range(len(starts) - 1)]
+
+        cdef double [:, :] v = np.ascontiguousarray(vertices,
+                                                    dtype=np.float64)
+        cdef long [:] start = np.asarray(starts, dtype=np.int_)
+        cdef int nvert = v.shape[0], npoly = start.shape[0] - 1
+        cdef int n
+
+        self.num_polygons = max(npoly, 0)
+
+        if cells is None:
+            cells = int(np.sqrt(nvert))
+        n = self.num_cells = max(1, min(int(cells), 1024))
+
+        # the cells cover the vertices
+        if nvert > 0:
+            x_min, y_min = np.min(vertices, axis=0)
+            x_max, y_max = np.max(vertices, axis=0)
+        else:
+            x_min = y_min = x_max = y_max = 0.0
+
+        self.grid[0] = x_min
+        self.grid[1] = y_min
+        self.grid[2] = n / (x_max - x_min) if x_max > x_min else 0.0
+        self.grid[3] = n / (y_max - y_min) if y_max > y_min else 0.0
+
+        # the edges, in the order the vertices are tested -- vertex i then
+        # the one before it. Horizontal edges are never crossed.
+        cdef cnp.ndarray[double, ndim=2, mode='c'] edges = \
+            np.zeros((nvert, 4), dtype=np.float64)
+        cdef cnp.ndarray[int, ndim=1, mode='c'] edge_poly = \
+            np.zeros((nvert,), dtype=np.intc)
+        cdef int k, i, j, ne = 0
+
+        for k in range(npoly):
+            for i in range(start[k], start[k + 1]):
+                j = i - 1 if i > start[k] else start[k + 1] - 1
+                if v[i, 1] == v[j, 1]:
+                    continue
+
+                edges[ne, 0] = v[i, 0]
+                edges[ne, 1] = v[i, 1]
+                edges[ne, 2] = v[j, 0]
+                edges[ne, 3] = v[j, 1]
+                edge_poly[ne] = k
+                ne += 1
+
+        self.edges = edges[:ne].copy()
+        self.edge_poly = edge_poly[:ne].copy()
+
+        # the cells of each edge, counted then filled in
+        cdef cnp.ndarray[int, ndim=1, mode='c'] cell_start = \
+            np.zeros((n * n + 1,), dtype=np.intc)
+        cdef cnp.ndarray[int, ndim=1, mode='c'] cell_edges, cell_first
+        cdef cnp.ndarray[int, ndim=1, mode='c'] fill
+
+        self._bin_edges(self.edges, cell_start, None, None, None)
+        cell_start = np.r_[0, np.cumsum(cell_start[1:])].astype(np.intc)
+
+        cell_edges = np.zeros((cell_start[n * n],), dtype=np.intc)
+        cell_first = np.zeros((cell_start[n * n],), dtype=np.intc)
+        fill = cell_start[:-1].copy()
+        self._bin_edges(self.edges, cell_start, cell_edges, cell_first, fill)
+
+        self.cell_start = cell_start
+        self.cell_edges = cell_edges
+        self.cell_first = cell_first
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    @cython.cdivision(True)
+    cdef _bin_edges(self,
+                    cnp.ndarray[double, ndim=2, mode='c'] edges,
+                    cnp.ndarray[int, ndim=1, mode='c'] cell_start,
+                    cnp.ndarray[int, ndim=1, mode='c'] cell_edges,
+                    cnp.ndarray[int, ndim=1, mode='c'] cell_first,
+                    cnp.ndarray[int, ndim=1, mode='c'] fill):
+        """
+        With fill None, counts the edges of each cell in cell_start[1:],
+        otherwise puts them in cell_edges, from fill.
+
+        In each row of cells an edge is in the cells from its least to its
+        greatest x in the row, with the row a little taller and the cells
+        to the right a little wider than they are, so no point that could
+        cross it is in a cell to the right of it.
+        """
+        cdef int n = self.num_cells
+        cdef int i, row, col, first, last, c
+        cdef double xi, yi, xj, yj, y_lo, y_hi, ya, yb, xa, xb, slop
+        cdef double margin = 1e-9 * (fabs(self.grid[0]) + fabs(self.grid[1]) +
+                                     (n / self.grid[2] if self.grid[2] > 0
+                                      else 0.0) +
+                                     (n / self.grid[3] if self.grid[3] > 0
+                                      else 0.0) + 1.0)
+
+        for i in range(edges.shape[0]):
+            xi = edges[i, 0]
+            yi = edges[i, 1]
+            xj = edges[i, 2]
+            yj = edges[i, 3]
+            slop = 1e-9 * (fabs(xi) + fabs(xj) + 1.0)
+
+            y_lo = min(yi, yj)
+            y_hi = max(yi, yj)
+
+            for row in range(c_cell_index(y_lo, self.grid[1], self.grid[3], n),
+                             c_cell_index(y_hi, self.grid[1], self.grid[3], n)
+                             + 1):
+                ya = y_lo
+                yb = y_hi
+                if self.grid[3] > 0:
+                    ya = max(ya, self.grid[1] + row / self.grid[3] - margin)
+                    yb = min(yb, self.grid[1] + (row + 1) / self.grid[3] +
+                             margin)
+
+                xa = xi + (xj - xi) * (ya - yi) / (yj - yi)
+                xb = xi + (xj - xi) * (yb - yi) / (yj - yi)
+
+                first = c_cell_index(min(xa, xb) - slop,
+                                     self.grid[0], self.grid[2], n)
+                last = c_cell_index(max(xa, xb) + slop,
+                                    self.grid[0], self.grid[2], n)
+
+                for col in range(first, last + 1):
+                    c = row * n + col
+                    if fill is None:
+                        cell_start[c + 1] += 1
+                    else:
+                        cell_edges[fill[c]] = i
+                        cell_first[fill[c]] = first
+                        fill[c] += 1
+
+    @property
+    def num_edges(self):
+        return self.edges.shape[0]
+
+    def __reduce__(self):
+        return (PolygonIndex, (self.polygons, self.num_cells))
+
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
+    def locate(self, points):
+        """
+        The last of the polygons that each point is in
+
+        :param points: the points to test
+        :type points: NX2 or NX3 numpy array of floats, or one point
+
+        :returns: an int array of the polygon of each point, -1 for a point
+                  in none of them -- or an int for a single point
+
+        The last polygon is the one drawn on top, so with lakes listed after
+        the land around them it says whether a point is in the lake.
+        """
+        np_points = np.ascontiguousarray(points, dtype=np.float64)
+        scalar = (np_points.ndim == 1)
+        np_points = np_points.reshape(-1, np_points.shape[-1])
+
+        cdef double [:, ::1] a_points = np_points
+        cdef cnp.ndarray[int, ndim=1, mode='c'] result = \
+            np.empty((a_points.shape[0],), dtype=np.intc)
+
+        cdef int i, npoints = a_points.shape[0], n = self.num_cells
+        cdef int npoly = max(self.num_polygons, 1)
+        cdef char *parity
+        cdef int *touched
+        cdef double *edges = <double*> cnp.PyArray_DATA(self.edges)
+        cdef int *edge_poly = <int*> cnp.PyArray_DATA(self.edge_poly)
+        cdef int *cell_start = <int*> cnp.PyArray_DATA(self.cell_start)
+        cdef int *cells = <int*> cnp.PyArray_DATA(self.cell_edges)
+        cdef int *cell_first = <int*> cnp.PyArray_DATA(self.cell_first)
+
+        if npoints > 0 and a_points.shape[1] < 2:
+            raise ValueError('points need x and y')
+
+        with nogil, parallel():
+            # each thread has its own crossing counts
+            parity = <char*> calloc(npoly, sizeof(char))
+            touched = <int*> malloc(npoly * sizeof(int))
+
+            for i in prange(npoints, schedule='static'):
+                result[i] = c_locate_point(edges, edge_poly, cell_start,
+                                           cells, cell_first, n, n,
+                                           self.grid, &a_points[i, 0],
+                                           parity, touched)
+
+            free(parity)
+            free(touched)
+
+        if scalar:
+            return int(result[0])
+        else:
+            return result
+
+    def contains(self, points):
+        """
+        Whether each point is in any of the polygons
+
+        :returns: a boolean array the same length as points, or a python
+                  bool for a single point -- like points_in_poly
+        """
+        return self.locate(points) >= 0
+
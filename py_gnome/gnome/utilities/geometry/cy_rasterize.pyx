@@ -0,0 +1,484 @@
+#!/usr/bin/env python
+
+"""
+Cython code to call the C point and polygon rasterizer
+
+Draws whole arrays of points and polygons into an 8 bit image, for the
+map canvas to draw elements and grids without a call per element. The
+image is cut in tiles of columns that are drawn on threads at the same
+time when the extension is built with OpenMP -- each tile is only written
+by one of them, so the result is the same on any number of threads.
+
+The image is an array of bytes indexed [x, y], as MapCanvas.back_asarray()
+returns it. The coordinates are pixel coordinates, or are projected to
+them in C by a transform: the (center_x, center_y, scale_x, scale_y,
+offset_x, offset_y) of projections.GeoProjection.pixel_transform().
+"""
+
+import cython
+from cython.parallel cimport prange
+from libc.stdlib cimport malloc, free
+import numpy as np
+cimport numpy as cnp
+
+# declare the interface to the C code
+cdef extern void c_project_point(const double *transform,
+                                 const double *coords,
+                                 double *pixel) nogil
+cdef extern int c_tile_index(double x, int width, int tile_size) nogil
+cdef extern void c_draw_point(unsigned char *pixels, long xstride,
+                              long ystride, long x0, long x1, long height,
+                              double px, double py, int diameter, int shape,
+                              int antialias, unsigned char value) nogil
+cdef extern void c_fill_polygon(unsigned char *pixels, long xstride,
+                                long ystride, long x0, long x1, long height,
+                                const double *vertices, int nvert,
+                                int antialias, unsigned char value,
+                                double *xs, double *coverage) nogil
+
+shapes = ('round', 'x')
+
+
+cdef struct Raster:
+    unsigned char *pixels
+    long xstride, ystride
+    int width, height, tile_size
+
+
+cdef int _setup_raster(Raster *raster, cnp.uint8_t [:, :] image,
+                       int tile_size) except -1:
+    if tile_size < 1:
+        raise ValueError('tile_size must be at least 1')
+
+    raster.pixels = NULL
+    raster.width = image.shape[0]
+    raster.height = image.shape[1]
+    raster.xstride = image.strides[0]
+    raster.ystride = image.strides[1]
+    raster.tile_size = tile_size
+    if raster.width > 0 and raster.height > 0:
+        raster.pixels = &image[0, 0]
+
+    return 0
+
+
+cdef int _num_tiles(Raster *raster) nogil:
+    if raster.pixels == NULL:
+        return 0
+
+    return (raster.width + raster.tile_size - 1) // raster.tile_size
+
+
+cdef int _tile_end(Raster *raster, int tile) nogil:
+    cdef int x1 = (tile + 1) * raster.tile_size
+
+    return x1 if x1 < raster.width else raster.width
+
+
+cdef bint _get_transform(transform, double *t) except -1:
+    """
+    fills t with the transform, False if there is none
+    """
+    cdef int i
+
+    if transform is None:
+        return False
+
+    transform = tuple(transform)
+    if len(transform) != 6:
+        raise ValueError('transform is (center_x, center_y, scale_x, '
+                         'scale_y, offset_x, offset_y)')
+
+    for i in range(6):
+        t[i] = transform[i]
+
+    return True
+
+
+def _as_coords(coords):
+    points = np.ascontiguousarray(coords, dtype=np.float64)
+    if points.ndim == 1 and points.shape[0] in (2, 3):
+        points = points.reshape(1, -1)
+    if points.ndim != 2 or (points.shape[0] > 0 and points.shape[1] < 2):
+        raise ValueError('coords must be an Nx2 or Nx3 array')
+
+    return points
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def project(coords, transform, num_threads=None):
+    """
+    Projects (lon, lat) coordinates to pixel coordinates
+
+    :param coords: the coordinates
+    :type coords: Nx2 or Nx3 array of floats (depth is ignored)
+
+    :param transform: the pixel transform of the projection
+
+    :returns: a Nx2 float array of pixel coordinates -- the values of
+              projection.to_pixel(coords) for a GeoProjection
+    """
+    cdef double [:, ::1] a_coords = _as_coords(coords)
+    cdef cnp.ndarray[double, ndim=2, mode='c'] result = \
+        np.empty((a_coords.shape[0], 2), dtype=np.float64)
+    cdef double [:, ::1] pixels = result
+    cdef double t[6]
+    cdef int i, n = a_coords.shape[0]
+    cdef bint default_threads = num_threads is None
+    cdef int threads = 1 if default_threads else max(1, num_threads)
+
+    if not _get_transform(transform, t):
+        raise ValueError('project needs a transform')
+
+    with nogil:
+        if default_threads:
+            for i in prange(n, schedule='static'):
+                c_project_point(t, &a_coords[i, 0], &pixels[i, 0])
+        else:
+            for i in prange(n, schedule='static', num_threads=threads):
+                c_project_point(t, &a_coords[i, 0], &pixels[i, 0])
+
+    return result
+
+
+cdef struct PointJob:
+    Raster raster
+    double *pixels
+    int *order
+    int *bin_start
+    int num_bins, reach_tiles
+    int diameter, shape, antialias
+    unsigned char value
+
+
+cdef void _draw_point_tile(PointJob *job, int tile) nogil:
+    """
+    draws the points that can reach the tile, which are binned by the tile
+    they are in -- bin 0 is left of the image, and the last bin right of it
+    """
+    cdef Raster *r = &job.raster
+    cdef int x0 = tile * r.tile_size, x1 = _tile_end(r, tile)
+    cdef int b, m, i
+    cdef int first = tile + 1 - job.reach_tiles
+    cdef int last = tile + 1 + job.reach_tiles
+
+    if first < 0:
+        first = 0
+    if last > job.num_bins - 1:
+        last = job.num_bins - 1
+
+    for b in range(first, last + 1):
+        for m in range(job.bin_start[b], job.bin_start[b + 1]):
+            i = job.order[m]
+            c_draw_point(r.pixels, r.xstride, r.ystride, x0, x1, r.height,
+                         job.pixels[2 * i], job.pixels[2 * i + 1],
+                         job.diameter, job.shape, job.antialias, job.value)
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def rasterize_points(cnp.uint8_t [:, :] image not None,
+                     points,
+                     int value=1,
+                     int diameter=1,
+                     shape='round',
+                     int antialias=0,
+                     transform=None,
+                     int tile_size=64,
+                     num_threads=None):
+    """
+    Draws points of all the same value
+
+    :param image: the image to draw into
+    :type image: 2-d uint8 array, indexed [x, y]
+
+    :param points: the points
+    :type points: Nx2 or Nx3 array of floats (depth is ignored)
+
+    :param value=1: the value (color index) to set the pixels to
+
+    :param diameter=1: diameter of the points in pixels. 1 is
+                       a pixel, 2 a 2x2 block
+
+    :param shape='round': "round" or "x"
+
+    :param antialias=0: 0 draws whole pixels. n > 1 samples the shape n x n
+                        times in each pixel, and sets the pixels it covers
+                        part of to that part of the value, unless they are
+                        already higher: this is for coverage (alpha) layers,
+                        not for paletted images.
+
+    :param transform=None: the pixel transform to project the points with,
+                           if they are not pixel coordinates already
+
+    :param tile_size=64: width of the column tiles that are drawn at once
+
+    :param num_threads=None: how many threads to draw on, the OpenMP
+                             default if None.
+    """
+    if shape not in shapes:
+        raise ValueError('only "round" and "x" are supported shapes')
+    if not 0 <= value <= 255:
+        raise ValueError('value must fit in a byte')
+
+    cdef double [:, ::1] a_points = _as_coords(points)
+    cdef cnp.ndarray[double, ndim=2, mode='c'] pixels = \
+        np.empty((a_points.shape[0], 2), dtype=np.float64)
+    cdef cnp.ndarray[int, ndim=1, mode='c'] tiles = \
+        np.empty((a_points.shape[0],), dtype=np.intc)
+    cdef cnp.ndarray[int, ndim=1, mode='c'] order = \
+        np.empty((a_points.shape[0],), dtype=np.intc)
+    cdef cnp.ndarray[int, ndim=1, mode='c'] bin_start
+    cdef PointJob job
+    cdef double t[6]
+    cdef bint projecting = _get_transform(transform, t)
+    cdef int i, b, k, n = a_points.shape[0], ntiles, margin
+    cdef bint default_threads = num_threads is None
+    cdef int threads = 1 if default_threads else max(1, num_threads)
+
+    _setup_raster(&job.raster, image, tile_size)
+    ntiles = _num_tiles(&job.raster)
+    if ntiles == 0 or n == 0:
+        return
+
+    with nogil:
+        if default_threads:
+            for i in prange(n, schedule='static'):
+                if projecting:
+                    c_project_point(t, &a_points[i, 0], &pixels[i, 0])
+                else:
+                    pixels[i, 0] = a_points[i, 0]
+                    pixels[i, 1] = a_points[i, 1]
+                tiles[i] = c_tile_index(pixels[i, 0], job.raster.width,
+                                        tile_size)
+        else:
+            for i in prange(n, schedule='static', num_threads=threads):
+                if projecting:
+                    c_project_point(t, &a_points[i, 0], &pixels[i, 0])
+                else:
+                    pixels[i, 0] = a_points[i, 0]
+                    pixels[i, 1] = a_points[i, 1]
+                tiles[i] = c_tile_index(pixels[i, 0], job.raster.width,
+                                        tile_size)
+
+    # a counting sort of the points by their tile, keeping their order
+    bin_start = np.zeros((ntiles + 3,), dtype=np.intc)
+    with nogil:
+        for i in range(n):
+            bin_start[tiles[i] + 2] += 1
+        for b in range(1, ntiles + 3):
+            bin_start[b] += bin_start[b - 1]
+        for i in range(n):
+            b = tiles[i] + 1
+            order[bin_start[b]] = i
+            bin_start[b] += 1
+        for b in range(ntiles + 1, 0, -1):
+            bin_start[b] = bin_start[b - 1]
+        bin_start[0] = 0
+
+    # how far a point can be drawn from its pixel
+    margin = diameter // 2 + 2
+    job.pixels = <double*> cnp.PyArray_DATA(pixels)
+    job.order = <int*> cnp.PyArray_DATA(order)
+    job.bin_start = <int*> cnp.PyArray_DATA(bin_start)
+    job.num_bins = ntiles + 2
+    job.reach_tiles = (margin + tile_size - 1) // tile_size
+    job.diameter = diameter
+    job.shape = shapes.index(shape)
+    job.antialias = antialias
+    job.value = value
+
+    with nogil:
+        if default_threads:
+            for k in prange(ntiles, schedule='dynamic'):
+                _draw_point_tile(&job, k)
+        else:
+            for k in prange(ntiles, schedule='dynamic', num_threads=threads):
+                _draw_point_tile(&job, k)
+
+
+cdef struct PolygonJob:
+    Raster raster
+    double *vertices
+    int *starts
+    int *first_tile
+    int *last_tile
+    unsigned char *values
+    int num_polygons, max_vertices, antialias
+
+
+cdef void _fill_polygon_tile(PolygonJob *job, int tile) nogil:
+    """
+    fills the polygons that reach the tile, in order
+    """
+    cdef Raster *r = &job.raster
+    cdef int x0 = tile * r.tile_size, x1 = _tile_end(r, tile)
+    cdef int i
+    cdef double *xs = <double*> malloc(job.max_vertices * sizeof(double))
+    cdef double *coverage = <double*> malloc(r.tile_size * sizeof(double))
+
+    for i in range(job.num_polygons):
+        if job.first_tile[i] > tile or job.last_tile[i] < tile:
+            continue
+
+        c_fill_polygon(r.pixels, r.xstride, r.ystride, x0, x1, r.height,
+                       job.vertices + 2 * job.starts[i],
+                       job.starts[i + 1] - job.starts[i],
+                       job.antialias, job.values[i], xs, coverage)
+
+    free(xs)
+    free(coverage)
+
+
+def _flatten_polygons(polygons):
+    """
+    the vertices of all the polygons in one array, and where each starts
+    """
+    if isinstance(polygons, np.ndarray) and polygons.ndim == 3:
+        n, k = polygons.shape[:2]
+        vertices = polygons.reshape(n * k, -1)
+        starts = np.arange(0, n * k + 1, max(k, 1), dtype=np.intc)
+        if k == 0:
+            starts = np.zeros((n + 1,), dtype=np.intc)
+
+        return _as_coords(vertices), starts
+
+    polygons = [_as_coords(p) for p in polygons]
+    starts = np.zeros((len(polygons) + 1,), dtype=np.intc)
+    starts[1:] = np.cumsum([len(p) for p in polygons])
+    if len(polygons) == 0 or starts[-1] == 0:
+        return np.zeros((0, 2), dtype=np.float64), starts
+
+    return (np.ascontiguousarray(np.concatenate([p[:, :2] for p in polygons
+                                                 if len(p)])),
+            starts)
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def rasterize_polygons(cnp.uint8_t [:, :] image not None,
+                       polygons,
+                       values=1,
+                       int antialias=0,
+                       transform=None,
+                       int tile_size=64,
+                       num_threads=None):
+    """
+    Fills polygons, each with its own value, drawn in order so that later
+    ones are on top
+
+    :param image: the image to draw into
+    :type image: 2-d uint8 array, indexed [x, y]
+
+    :param polygons: the polygons
+    :type polygons: NxMx2 (or NxMx3) array of N polygons of M vertices, or
+                    a sequence of Mx2 array-likes
+
+    :param values=1: the value (color index) of each polygon, or one for
+                     all of them
+
+    :param antialias=0: 0 fills the pixels with their centers inside.
+                        n > 1 cuts each row in n lines and sets the pixels
+                        to the part of the value that they are covered,
+                        unless they are already higher -- as for points.
+
+    :param transform=None: the pixel transform to project the vertices with,
+                           if they are not pixel coordinates already
+
+    :param tile_size=64: width of the column tiles that are drawn at once
+
+    :param num_threads=None: how many threads to draw on, the OpenMP
+                             default if None.
+
+    The even-odd rule is used, so a polygon that crosses itself has holes.
+    """
+    vertices, np_starts = _flatten_polygons(polygons)
+
+    cdef double [:, ::1] a_vertices = vertices
+    cdef int [::1] starts = np_starts
+    cdef int npoly = starts.shape[0] - 1, nvert = a_vertices.shape[0]
+    cdef cnp.ndarray[double, ndim=2, mode='c'] pixels = \
+        np.empty((nvert, 2), dtype=np.float64)
+    cdef cnp.ndarray[int, ndim=1, mode='c'] first_tile = \
+        np.empty((npoly,), dtype=np.intc)
+    cdef cnp.ndarray[int, ndim=1, mode='c'] last_tile = \
+        np.empty((npoly,), dtype=np.intc)
+    cdef cnp.ndarray[cnp.uint8_t, ndim=1, mode='c'] poly_values
+    cdef PolygonJob job
+    cdef double t[6]
+    cdef bint projecting = _get_transform(transform, t)
+    cdef int i, j, k, ntiles, lo, hi, maxv = 1
+    cdef bint default_threads = num_threads is None
+    cdef int threads = 1 if default_threads else max(1, num_threads)
+    cdef double xmin, xmax
+
+    np_values = np.asarray(values)
+    if np_values.ndim == 0:
+        np_values = np.repeat(np_values, npoly)
+    if np_values.shape != (npoly,):
+        raise ValueError('there must be one value, or one for each polygon')
+    if npoly and (np_values.min() < 0 or np_values.max() > 255):
+        raise ValueError('values must fit in a byte')
+    poly_values = np.ascontiguousarray(np_values, dtype=np.uint8)
+
+    _setup_raster(&job.raster, image, tile_size)
+    ntiles = _num_tiles(&job.raster)
+    if ntiles == 0 or npoly == 0:
+        return
+
+    for i in range(npoly):
+        maxv = max(maxv, starts[i + 1] - starts[i])
+
+    with nogil:
+        if default_threads:
+            for i in prange(nvert, schedule='static'):
+                if projecting:
+                    c_project_point(t, &a_vertices[i, 0], &pixels[i, 0])
+                else:
+                    pixels[i, 0] = a_vertices[i, 0]
+                    pixels[i, 1] = a_vertices[i, 1]
+        else:
+            for i in prange(nvert, schedule='static', num_threads=threads):
+                if projecting:
+                    c_project_point(t, &a_vertices[i, 0], &pixels[i, 0])
+                else:
+                    pixels[i, 0] = a_vertices[i, 0]
+                    pixels[i, 1] = a_vertices[i, 1]
+
+        # the tiles each polygon spans, clipped to the image
+        for i in range(npoly):
+            lo = ntiles
+            hi = -1
+            if starts[i + 1] > starts[i]:
+                xmin = xmax = pixels[starts[i], 0]
+                for j in range(starts[i] + 1, starts[i + 1]):
+                    if pixels[j, 0] < xmin:
+                        xmin = pixels[j, 0]
+                    if pixels[j, 0] > xmax:
+                        xmax = pixels[j, 0]
+                lo = c_tile_index(xmin, job.raster.width, tile_size)
+                hi = c_tile_index(xmax, job.raster.width, tile_size)
+                if lo < 0:
+                    lo = 0
+                if hi > ntiles - 1:
+                    hi = ntiles - 1
+            first_tile[i] = lo
+            last_tile[i] = hi
+
+    job.vertices = <double*> cnp.PyArray_DATA(pixels)
+    job.starts = &starts[0]
+    job.first_tile = <int*> cnp.PyArray_DATA(first_tile)
+    job.last_tile = <int*> cnp.PyArray_DATA(last_tile)
+    job.values = <unsigned char*> cnp.PyArray_DATA(poly_values)
+    job.num_polygons = npoly
+    job.max_vertices = maxv
+    job.antialias = antialias
+
+    with nogil:
+        if default_threads:
+            for k in prange(ntiles, schedule='dynamic'):
+                _fill_polygon_tile(&job, k)
+        else:
+            for k in prange(ntiles, schedule='dynamic', num_threads=threads):
+                _fill_polygon_tile(&job, k)
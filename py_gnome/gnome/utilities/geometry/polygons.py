@@ -199,6 +199,22 @@ class PolygonSet:
             self._IndexArray = np.array(data[1])
             self._MetaDataList = np.array(data[2])
 
+    @classmethod
+    def from_arrays(cls, points, starts, metadata, dtype=np.float64):
+        """
+        create a PolygonSet of all the points at once, as the polygons in
+        them read by filescanner.scan_bna:
+
+        points[starts[k]:starts[k+1]] are the points of polygon k, with
+        metadata[k]
+        """
+        self = cls(dtype=dtype)
+        self._PointsArray = np.array(points, dtype=dtype).reshape((-1, 2))
+        self._IndexArray = np.array(starts, dtype=np.int)
+        self._MetaDataList = list(metadata)
+
+        return self
+
     def append(self, polygon, metadata=None):
 
         """
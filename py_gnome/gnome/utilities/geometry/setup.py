@@ -19,6 +19,10 @@ ext_modules = [Extension("cy_point_in_polygon",
                          sources=["cy_point_in_polygon.pyx",
                                   "c_point_in_polygon.c"],
                          include_dirs=[numpy.get_include()]),
+               Extension("cy_rasterize",
+                         sources=["cy_rasterize.pyx",
+                                  "c_rasterize.c"],
+                         include_dirs=[numpy.get_include()]),
                ]
 
 setup(
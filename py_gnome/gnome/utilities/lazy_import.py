@@ -0,0 +1,111 @@
+'''
+Lazy imports, so importing gnome doesn't import all of its modules -- and
+the cython extensions, netCDF4, py_gd and so forth with them -- but only the
+ones a script or worker uses, the first time it uses them.
+
+ - lazy_package(): the attributes of a package, the classes its __init__.py
+   used to import from its modules and the modules themselves, are imported
+   the first time they are looked up.
+ - lazy_module(): a module imported the first time one of its attributes is
+   looked up, for the heavy ones imported at the top of a module.
+'''
+import sys
+import pkgutil
+import importlib
+from types import ModuleType
+
+
+class LazyPackage(ModuleType):
+    '''
+    A package whose attributes in _lazy_names, and its submodules, are
+    imported the first time they are looked up, then kept as attributes.
+    '''
+    def __getattr__(self, name):
+        # only called for the attributes not there yet
+        lazy = self.__dict__.get('_lazy_names', {})
+
+        if name in lazy:
+            module_name, attr = lazy[name]
+        elif not name.startswith('_') and name in self._submodules():
+            module_name, attr = '.' + name, None
+        else:
+            raise AttributeError("'module' object has no attribute '{0}'"
+                                 .format(name))
+
+        module = importlib.import_module(module_name, self.__name__)
+        value = module if attr is None else getattr(module, attr)
+        setattr(self, name, value)
+
+        return value
+
+    def __dir__(self):
+        return sorted(set(self.__dict__) |
+                      set(self.__dict__.get('_lazy_names', {})) |
+                      self._submodules())
+
+    def _submodules(self):
+        'the names of the modules and packages in the package directory'
+        if '_submodule_names' not in self.__dict__:
+            self._submodule_names = set(name for (_loader, name, _ispkg) in
+                                        pkgutil.iter_modules(self.__path__))
+
+        return self._submodule_names
+
+
+def lazy_package(name, names=None):
+    '''
+    Make the package name import its attributes when they are looked up.
+    The package in sys.modules is replaced by a LazyPackage with its
+    attributes so far: call it last in the package's __init__.py, the
+    names set after it are not seen.
+
+    :param name: the __name__ of the package
+    :param names: {module: attribute names} of the attributes of the package
+        from its modules, the modules relative to the package. The
+        submodules are attributes without being listed.
+    '''
+    package = sys.modules[name]
+
+    lazy = LazyPackage(name, package.__doc__)
+    lazy.__dict__.update(package.__dict__)
+
+    lazy_names = {}
+    for module, attrs in (names or {}).iteritems():
+        for attr in attrs:
+            lazy_names[attr] = ('.' + module, attr)
+    lazy._lazy_names = lazy_names
+
+    # the functions defined in __init__.py use the package module's globals,
+    # which python 2 clears when the module is freed: keep it
+    lazy._package = package
+
+    sys.modules[name] = lazy
+
+    return lazy
+
+
+class LazyModule(ModuleType):
+    '''
+    A module imported the first time one of its attributes is looked up:
+    its attributes are then copied to this one.
+    '''
+    def __getattr__(self, attr):
+        module = importlib.import_module(self.__name__)
+        self.__dict__.update(module.__dict__)
+
+        return getattr(module, attr)
+
+
+def lazy_module(name):
+    '''
+    The module name, or a LazyModule of it if it isn't imported yet:
+
+        nc = lazy_module('netCDF4')
+
+    instead of import netCDF4 as nc at the top of a module that doesn't need
+    it on import.
+    '''
+    if name in sys.modules:
+        return sys.modules[name]
+
+    return LazyModule(name)
@@ -18,11 +18,14 @@ import bisect
 
 import numpy as np
 
-import py_gd
+from gnome.utilities.lazy_import import lazy_module
+py_gd = lazy_module('py_gd')
 
 import unit_conversion as uc
 
 from gnome.utilities.projections import FlatEarthProjection
+from gnome.utilities.geometry.cy_rasterize import (rasterize_points,
+                                                   rasterize_polygons)
 
 
 class MapCanvas(object):
@@ -40,7 +43,12 @@ class MapCanvas(object):
 
     This version uses a paletted (8 bit) image -- may be updated for RGB images
     at some point.
+
+    Points and sets of filled polygons are drawn by the native rasterizer,
+    in cy_rasterize, which works on whole arrays at once.
     """
+    # threads the rasterizer draws with, the OpenMP default if None
+    num_threads = None
 
     def __init__(self,
                  image_size,
@@ -273,13 +281,20 @@ class MapCanvas(object):
         if shape not in ('round', 'x'):
             raise ValueError('only "round" and "x" are supported shapes')
 
-        points = self.projection.to_pixel(points, asint=True)
         img = self.back_image if background else self.fore_image
 
-        if shape == 'round':
-            img.draw_dots(points, diameter=diameter, color=color)
-        elif shape == 'x':
-            img.draw_xes(points, diameter=diameter, color=color)
+        transform = self.projection.pixel_transform()
+        if transform is None:
+            points = self.projection.to_pixel(points)
+
+        pixels = np.asarray(img)
+        rasterize_points(pixels, points,
+                         value=self._color_index(img, color),
+                         diameter=diameter,
+                         shape=shape,
+                         transform=transform,
+                         num_threads=self.num_threads)
+        img.set_data(np.asfortranarray(pixels))
 
     def draw_polygon(self,
                      points,
@@ -314,6 +329,51 @@ class MapCanvas(object):
                          fill_color=fill_color,
                          line_width=line_width)
 
+    def draw_polygons(self,
+                      polygons,
+                      fill_colors,
+                      background=False):
+        """
+        Fill a set of polygons, each with its own color -- in one call, so
+        it is fast for many of them, like the cells of a grid. The ones later
+        in the list are drawn on top.
+
+        :param polygons: the polygons
+        :type polygons: NxMx2 array of N polygons of M points, or a sequence
+                        of Mx2 arrays (or things that can be turned into them)
+
+        :param fill_colors: the color of each polygon, or one for all of them
+        :type fill_colors: color names (strings) or indexes (ints)
+
+        :param background=False: whether to draw to the background image.
+        :type background: bool
+        """
+        img = self.back_image if background else self.fore_image
+
+        if isinstance(fill_colors, (basestring, int)):
+            values = self._color_index(img, fill_colors)
+        else:
+            index = dict((c, self._color_index(img, c))
+                         for c in set(fill_colors))
+            values = np.array([index[c] for c in fill_colors], dtype=np.uint8)
+
+        transform = self.projection.pixel_transform()
+        if transform is None:
+            polygons = [self.projection.to_pixel(p) for p in polygons]
+
+        pixels = np.asarray(img)
+        rasterize_polygons(pixels, polygons,
+                           values=values,
+                           transform=transform,
+                           num_threads=self.num_threads)
+        img.set_data(np.asfortranarray(pixels))
+
+    @staticmethod
+    def _color_index(img, color):
+        if isinstance(color, int):
+            return color
+        return img.get_color_index(color)
+
     def draw_polyline(self,
                       points,
                       line_color,
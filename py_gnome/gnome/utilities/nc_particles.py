@@ -3,6 +3,14 @@ module for manipulating netcdf particle files
 
 This is a test case for working with what hopefully will be a CF standard
 
+The files written here and by NetCDFOutput have an index to seek in them as
+well: 'step_offset(time)' is the record of the first particle of each
+step, 'prev_record(data)' the record of the same particle at the step
+before, -1 where it is new, and 'last_record(particle)' the last record of
+each particle id, -1 for the ids not written. A step is then one slice of
+the data, and a particle's trajectory its records linked back from its
+last one, without reading the counts or the ids of the other particles.
+
 """  # Change the / operator to ensure true division throughout (Zelenke).
 
 from __future__ import division
@@ -10,7 +18,51 @@ from datetime import datetime
 
 import numpy as np
 
-import netCDF4
+from gnome.utilities.lazy_import import lazy_module
+netCDF4 = lazy_module('netCDF4')
+
+# the variables of the index
+INDEX_VARIABLES = ('step_offset', 'prev_record', 'last_record')
+
+
+def index_step(ids, start, last_records):
+    '''
+    the index of a step of the particles of ids, written from record start
+
+    :param last_records: the last record of each particle id so far, -1 for
+        the ids not yet written -- updated with the step's, grown to the
+        ids if they are past its end
+    :returns: (prev_record of the step's records, last_records)
+    '''
+    ids = np.asarray(ids, dtype=np.int64)
+
+    if len(ids) > 0 and ids.max() >= len(last_records):
+        grown = np.full((max(ids.max() + 1, 2 * len(last_records)), ), -1,
+                        dtype=np.int64)
+        grown[:len(last_records)] = last_records
+        last_records = grown
+
+    prev = last_records[ids]
+    last_records[ids] = start + np.arange(len(ids), dtype=np.int64)
+
+    return prev, last_records
+
+
+def trajectory_records(last_record, prev_record, particle_id):
+    '''
+    the records of the particle in the order of the steps, from the
+    index's variables: the particle's last record and the links back
+    '''
+    records = []
+    if 0 <= particle_id < len(last_record):
+        record = int(last_record[particle_id])
+        while record >= 0:
+            records.append(record)
+            record = int(prev_record[record])
+
+    records.reverse()
+
+    return np.array(records, dtype=np.int64)
 
 
 class particle_trajectory:
@@ -112,6 +164,30 @@ class particle_trajectory:
         (Variables['time'])[:] = netCDF4.date2num(self.timesteps,
                 self.time_units)
 
+        # the index, NETCDF3_CLASSIC has no 64 bit ints
+
+        if 'id' in self.Trajectory[0].dtype.names:
+            offsets = []
+            prev = []
+            last_records = np.zeros((0, ), dtype=np.int64)
+            start = 0
+            for t in range(len(self.Trajectory)):
+                (step_prev, last_records) = \
+                    index_step(self.Trajectory[t]['id'], start, last_records)
+                offsets.append(start)
+                prev.append(step_prev)
+                start += len(self.Trajectory[t])
+
+        # a dimension of length 0 would be a second unlimited one
+
+        if 'id' in self.Trajectory[0].dtype.names and len(last_records) > 0:
+            nc.createDimension('particle', len(last_records))
+            nc.createVariable('step_offset', 'i4', ('time', ))[:] = offsets
+            nc.createVariable('prev_record', 'i4', ('data', ))[:] = \
+                np.concatenate(prev)
+            nc.createVariable('last_record', 'i4', ('particle', ))[:] = \
+                last_records
+
         # # add attributes:
 
         Variable_attributes = {}
@@ -179,11 +255,17 @@ class nc_particle_file:
 
         self.particle_count = nc.variables['particle_count']
 
-        # build the index:
+        # build the index: from the file's where it has one
+
+        self.indexed = all(var in nc.variables for var in INDEX_VARIABLES)
 
         self.data_index = np.zeros((len(self.times) + 1, ),
-                                   dtype=np.int32)
-        self.data_index[1:] = np.cumsum(self.particle_count)
+                                   dtype=np.int64)
+        if self.indexed:
+            self.data_index[:-1] = nc.variables['step_offset'][:]
+            self.data_index[-1] = len(nc.dimensions['data'])
+        else:
+            self.data_index[1:] = np.cumsum(self.particle_count)
 
         # print self.times
         # print self.particle_count
@@ -217,14 +299,28 @@ class nc_particle_file:
     def get_individual_trajectory(self, particle_id, vars=['latitude',
                                   'longitude']):
         """
-        returns the requested variables from trajectory of an individual particle
-        
-        note: this is very inefficient -- it has to read the entire file to get it.
-        """
-
-        indexes = np.where(self.nc.variables['id'] == particle_id)
+        returns the requested variables from trajectory of an individual
+        particle as a dictionary keyed by the variable names, with the
+        'timestep' of each of its records
 
+        note: without the index in the file this is very inefficient -- it
+        has to read all the ids to get it.
+        """
 
-        # print self.nc.variables['id'][:]
-        # print indexes
+        if self.indexed:
+            records = trajectory_records(self.nc.variables['last_record'],
+                                         self.nc.variables['prev_record'],
+                                         particle_id)
+        else:
+            records = np.nonzero(self.nc.variables['id'][:] ==
+                                 particle_id)[0]
+
+        data = {'timestep': np.searchsorted(self.data_index, records,
+                                            side='right') - 1}
+        for var in vars:
+            if len(records) > 0:
+                data[var] = (self.nc.variables[var])[records]
+            else:
+                data[var] = (self.nc.variables[var])[0:0]
+        return data
 
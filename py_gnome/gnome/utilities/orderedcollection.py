@@ -1,4 +1,5 @@
 #!/usr/bin/env python
+from bisect import bisect_left
 
 
 class OrderedCollection(object):
@@ -11,7 +12,14 @@ class OrderedCollection(object):
     - Objects are accessed by id, as if in a dictionary.
     - Objects can be replaced in order.  The objects will be referenced
     by a new id, and still be in the correct order.
+    - The ids of the objects of each class, and of each value of the
+    indexed_attrs, are kept up to date as objects are added, replaced and
+    removed, so find_by_class() and find_by_attr() don't look at every
+    object.
     '''
+    # the attributes find_by_attr() finds in an index: ones that don't change
+    # while an object is in the collection, like the class level _ref_as
+    indexed_attrs = ('_ref_as',)
 
     def __init__(self, elems=None, dtype=None):
         if elems and not isinstance(elems, list):
@@ -42,8 +50,97 @@ class OrderedCollection(object):
         self._d_index = \
             {self._s_id(elem): idx for idx, elem in enumerate(self._elems)}
 
+        self._reset_indexes()
+        for elem in self._elems:
+            self._index_elem(elem)
+
         self.callbacks = {}
 
+    def _reset_indexes(self):
+        # the positions in _elems of the objects in order, made when needed
+        self._order = None
+
+        # the ids of the objects by class, and by value of indexed_attrs
+        self._by_class = {}
+        self._by_attr = dict((attr, {}) for attr in self.indexed_attrs)
+
+    def _index_elem(self, elem):
+        'add elem to the class and attribute indexes'
+        l__id = self._s_id(elem)
+        self._by_class.setdefault(type(elem), set()).add(l__id)
+
+        for attr, index in self._by_attr.iteritems():
+            if hasattr(elem, attr):
+                index.setdefault(getattr(elem, attr), set()).add(l__id)
+
+        self._order = None
+
+    def _unindex_elem(self, elem):
+        'remove elem from the class and attribute indexes'
+        l__id = self._s_id(elem)
+        self._by_class.get(type(elem), set()).discard(l__id)
+
+        for attr, index in self._by_attr.iteritems():
+            if hasattr(elem, attr):
+                index.get(getattr(elem, attr), set()).discard(l__id)
+
+        self._order = None
+
+    def _positions(self):
+        '''
+        the positions in _elems of the objects, in order. The list is not
+        changed once made, a new one is made after the collection changes
+        '''
+        if self._order is None:
+            self._order = sorted(self._d_index.values())
+
+        return self._order
+
+    def _in_order(self, ids, allitems):
+        '''
+        the objects of ids in order, or the first of them if not allitems.
+        None if there are none
+        '''
+        if len(ids) == 0:
+            return None
+
+        positions = [self._d_index[l__id] for l__id in ids]
+        if not allitems:
+            return self._elems[min(positions)]
+
+        return [self._elems[idx] for idx in sorted(positions)]
+
+    def find_by_class(self, cls, allitems=False):
+        '''
+        the first object that isinstance() of cls, or all of them in order if
+        allitems is True. None if there are none
+        '''
+        ids = set()
+        for klass, class_ids in self._by_class.iteritems():
+            if issubclass(klass, cls):
+                ids.update(class_ids)
+
+        return self._in_order(ids, allitems)
+
+    def find_by_attr(self, attr, value, allitems=False):
+        '''
+        the first object whose attr is value, or all of them in order if
+        allitems is True. None if there are none. The objects without attr
+        are not matched.
+        '''
+        if attr in self._by_attr:
+            return self._in_order(self._by_attr[attr].get(value, ()),
+                                  allitems)
+
+        ids = [self._s_id(elem) for elem in self
+               if hasattr(elem, attr) and getattr(elem, attr) == value]
+
+        return self._in_order(ids, allitems)
+
+    def contains_id(self, ident):
+        'True if the object of id ident is in the collection'
+        return ident in self._d_index
+
     def _s_id(self, elem):
         'return the id of the object as a string'
         if hasattr(elem, 'id'):
@@ -61,6 +158,8 @@ class OrderedCollection(object):
             for ix, elem in enumerate(self._elems):
                 self._d_index[self._s_id(elem)] = ix
 
+            self._order = None
+
     def get(self, ident):
         '''
         can get the object either by 'id' or by index in the order in which
@@ -68,7 +167,7 @@ class OrderedCollection(object):
         '''
         try:
             # ident is an index into list
-            idx = sorted(self._d_index.values())[ident]
+            idx = self._positions()[ident]
             return self._elems[idx]
         except TypeError:
             # ident is the 'id' string
@@ -79,9 +178,10 @@ class OrderedCollection(object):
         if isinstance(elem, self.dtype):
             l__id = self._s_id(elem)
 
-            if l__id not in self._d_index.keys():
+            if l__id not in self._d_index:
                 self._d_index[l__id] = len(self._elems)
                 self._elems.append(elem)
+                self._index_elem(elem)
 
                 # fire add event only if elem is not already in the list
                 self.fire_event('add', elem)
@@ -115,6 +215,7 @@ class OrderedCollection(object):
             obj_id = self._s_id(self[ident])
 
         item = self[obj_id]
+        self._unindex_elem(item)
         self._elems[self._d_index[obj_id]] = None
         del self._d_index[obj_id]
 
@@ -149,9 +250,11 @@ class OrderedCollection(object):
             idx = self._d_index[l__key]
 
         # found existing object
+        self._unindex_elem(self._elems[idx])
         del self._d_index[l__key]
         self._elems[idx] = new_elem
         self._d_index[self._s_id(new_elem)] = idx
+        self._index_elem(new_elem)
         self.fire_event('replace', new_elem)  # returns the newly added object
 
     def index(self, elem):
@@ -173,13 +276,13 @@ class OrderedCollection(object):
                 raise ValueError('{0} is not in OrderedCollection'
                                  .format(elem))
 
-        return sorted(self._d_index.values()).index(idx)
+        return bisect_left(self._positions(), idx)
 
     def __len__(self):
-        return len(self._d_index.keys())
+        return len(self._d_index)
 
     def __iter__(self):
-        for i in sorted(self._d_index.values()):
+        for i in self._positions():
             yield self._elems[i]
 
     def __contains__(self, elem):
@@ -316,6 +419,7 @@ class OrderedCollection(object):
         '''
         del self._elems[:]
         self._d_index.clear()
+        self._reset_indexes()
 
     def values(self):
         'return list of items contained in collection'
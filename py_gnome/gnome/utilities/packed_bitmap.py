@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+"""
+packed_bitmap.py
+
+A land-water raster with one bit per pixel, for the RasterMap land check
+
+The bits are the rows of the raster packed with numpy.packbits (the first
+pixel of each 8 is the high bit), so a 10000 x 10000 map takes 12.5 MB
+instead of 100 MB. The bits can be put in shared memory so the model
+workers of a multiprocessing run map the same pages instead of each having
+its own copy -- see PackedBitmap.share()
+"""
+import os
+import mmap
+
+import numpy as np
+
+
+class PackedBitmap(object):
+    """
+    The land (1) and water (0) pixels of an (m, n) raster, as an (m,
+    ceil(n / 8)) uint8 array of bits.
+
+    Indexing it with a pixel, or with arrays of rows and columns, gives the
+    pixel values like the uint8 raster it was made from; np.asarray()
+    unpacks the whole raster.
+    """
+    def __init__(self, bits, shape):
+        """
+        :param bits: the packed rows, as made by pack()
+        :param shape: (m, n) of the raster
+        """
+        self.shape = tuple(shape)
+        self.bits = np.ascontiguousarray(bits, dtype=np.uint8)
+        self.filename = None
+
+        if self.bits.shape != (self.shape[0], (self.shape[1] + 7) // 8):
+            raise ValueError('bits of shape {0} are not the bits of a {1} '
+                             'raster'.format(self.bits.shape, self.shape))
+
+    @classmethod
+    def pack(cls, bitmap, land_flag=1):
+        """
+        packs the pixels of a raster that are land_flag
+        """
+        bitmap = np.asarray(bitmap)
+
+        return cls(np.packbits(bitmap == land_flag, axis=1), bitmap.shape)
+
+    @property
+    def size(self):
+        return self.shape[0] * self.shape[1]
+
+    @property
+    def nbytes(self):
+        return self.bits.nbytes
+
+    def __getitem__(self, index):
+        rows, cols = index
+        cols = np.asarray(cols)
+
+        return ((self.bits[rows, cols >> 3] >> (7 - (cols & 7))) &
+                1).astype(np.uint8)
+
+    def unpack(self):
+        """
+        the raster as a (m, n) uint8 array
+        """
+        return np.unpackbits(self.bits, axis=1)[:, :self.shape[1]]
+
+    def __array__(self, dtype=None):
+        bitmap = self.unpack()
+
+        return bitmap if dtype is None else bitmap.astype(dtype)
+
+    def share(self, filename=None):
+        """
+        Moves the bits to shared memory
+
+        With no filename the bits go to an anonymous shared map, which the
+        processes forked after this see without a copy. With a filename
+        they are written to that file and mapped from it, and pickling the
+        bitmap keeps only the file name, so workers that get the model by
+        pickle map the same file (and the same pages of the OS cache)
+        instead of copying the bits.
+        """
+        if filename is None:
+            buf = mmap.mmap(-1, max(self.bits.nbytes, 1))
+            shared = np.frombuffer(buf, dtype=np.uint8,
+                                   count=self.bits.size)
+            shared[:] = self.bits.ravel()
+        else:
+            with open(filename, 'wb') as f:
+                f.write(self.bits.tostring())
+            shared = self._map_file(filename)
+
+        self.bits = shared.reshape(self.bits.shape)
+        self.filename = filename
+
+    def _map_file(self, filename):
+        count = self.shape[0] * ((self.shape[1] + 7) // 8)
+        with open(filename, 'rb') as f:
+            buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+        return np.frombuffer(buf, dtype=np.uint8, count=count)
+
+    def __getstate__(self):
+        if self.filename is not None:
+            return {'shape': self.shape, 'filename': self.filename}
+
+        return {'shape': self.shape, 'bits': np.array(self.bits)}
+
+    def __setstate__(self, state):
+        self.shape = state['shape']
+        self.filename = state.get('filename')
+
+        if self.filename is not None:
+            bits = self._map_file(self.filename)
+        else:
+            bits = state['bits']
+
+        self.bits = bits.reshape((self.shape[0], (self.shape[1] + 7) // 8))
+
+    def __eq__(self, other):
+        return (isinstance(other, PackedBitmap) and
+                self.shape == other.shape and
+                np.array_equal(self.bits, other.bits))
+
+    def __ne__(self, other):
+        return not self == other
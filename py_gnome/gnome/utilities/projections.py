@@ -19,6 +19,8 @@ from __future__ import division
 
 import numpy as np
 
+from gnome.cy_gnome import cy_projections
+
 
 def to_2d_coords(coords):
     """
@@ -113,6 +115,13 @@ class NoProjection(object):
         """
         return np.asarray(coords, dtype=np.float64, order='C')
 
+    def pixel_transform(self):
+        """
+        the (center_x, center_y, scale_x, scale_y, offset_x, offset_y) of
+        to_pixel(), for projecting in C: do nothing
+        """
+        return (0.0, 0.0, 1.0, 1.0, 0.0, 0.0)
+
 
 class GeoProjection(object):
     """
@@ -216,7 +225,7 @@ class GeoProjection(object):
                           self.to_lonlat((image_size[0], 0)))
         self.image_size = image_size
 
-    def to_pixel(self, coords, asint=False):
+    def to_pixel(self, coords, asint=False, dtype=np.float64):
         """
         Converts input coordinates to pixel coords
 
@@ -240,27 +249,13 @@ class GeoProjection(object):
               a point  exactly at the max of the bounding box will be
               considered outside the map
 
-        """
-        coords = to_2d_coords(coords)  # strip off depth, if it's there
-
-        # shift to center:
-        coords = coords - self.center
-
-        # scale to pixels:
-        coords *= self.scale
-
-        # shift to pixel coords
-        coords += self.offset
+        :param dtype: of the pixel coords if not asint: np.float64, or
+                      np.float32 for renderers that draw in single precision
 
-        if asint:
-            # NOTE: using "floor" as it rounds negative numbers towards -inf
-            #      simple casting rounds toward zero
-            #      we may need the negative coords to work right for locations
-            #      off the grid.
-            #      (used for the raster map code)
-            return np.floor(coords, coords).astype(np.int32)
-        else:
-            return coords
+        """
+        # shifted and scaled in C, straight from (lon, lat[, depth])
+        return cy_projections.to_pixels(coords, self.pixel_transform(),
+                                        asint, dtype)
 
     def to_pixel_2D(self, coords, asint=False):
         """
@@ -268,6 +263,16 @@ class GeoProjection(object):
         """
         raise NotImplementedError("no longer required, use to_pixel()")
 
+    def pixel_transform(self):
+        """
+        The (center_x, center_y, scale_x, scale_y, offset_x, offset_y) that
+        to_pixel() shifts and scales by, so the native rasterizer can do the
+        same thing in C: ((lon, lat) - center) * scale + offset
+        """
+        return (self.center[0], self.center[1],
+                self.scale[0], self.scale[1],
+                self.offset[0], self.offset[1])
+
     def to_pixel_multipoint(self, coords, asint=False):
         """
         does the to_pixel operation, but on a generic shaped array
@@ -340,7 +345,7 @@ class FlatEarthProjection(GeoProjection):
     """
 
     @staticmethod
-    def meters_to_lonlat(meters, ref_positions):
+    def meters_to_lonlat(meters, ref_positions, out=None):
         """
         Converts from delta meters to delta latitude-longitude,
         using the Flat-Earth projection.
@@ -357,34 +362,20 @@ class FlatEarthProjection(GeoProjection):
         :param ref_positions: Reference positions in degrees
         :type ref_positions: NX3, numpy array (Only lat is used here)
 
+        :param out: Array for the result: float64, C contiguous, of the shape
+                    of meters -- or meters itself, to convert in place.
+                    Default is a new array
+
         :returns delta_lon_lat: Differential (delta) positional values
                                 Nx3 numpy array of (delta-lon, delta-lat, delta-z)
         """
 
-        # make a copy -- don't change meters
-        delta_lon_lat = np.array(meters, dtype=np.float64)
-        if len(delta_lon_lat.shape) == 1:
-            if delta_lon_lat.shape[0] == 2:
-                delta_lon_lat = delta_lon_lat.reshape(1,2)
-            else:
-                delta_lon_lat = delta_lon_lat.reshape(1,3)
-        # reference is possible for reference positions
-        ref_positions = np.asarray(ref_positions,
-                                   dtype=np.float64)
-
-        if len(ref_positions.shape) == 1:
-            if ref_positions.shape[0] == 2:
-                ref_positions = ref_positions.reshape(1,2)
-            else:
-                ref_positions = ref_positions.reshape(1,3)
-
-        delta_lon_lat[:, :2] *= 8.9992801e-06
-        delta_lon_lat[:, 0] /= np.cos(np.deg2rad(ref_positions[:, 1]))
-
-        return delta_lon_lat
+        # a copy unless out is given -- in lib_gnome, with the math of the
+        # C movers' LongToLatRatio3()
+        return cy_projections.meters_to_lonlat(meters, ref_positions, out)
 
     @staticmethod
-    def lonlat_to_meters(lon_lat, ref_positions):
+    def lonlat_to_meters(lon_lat, ref_positions, out=None):
         """
         Converts from delta longitude-latitude to delta meters, using the
         Flat-Earth projection. This should be a reversal of meters_to_latlon.
@@ -409,21 +400,14 @@ class FlatEarthProjection(GeoProjection):
         :type ref_positions: NX3, numpy array of (lon,lat,z)
                              (Only lat is used here)
 
+        :param out: Array for the result, as for meters_to_lonlat()
+
         :returns delta_meters: Differential (delta) positional values in meters
                                Nx3 numpy array of (delta-x, delta-y, delta-z)
                                triples
         """
-        # make a copy -- don't change input
-        delta_meters = np.array(lon_lat, dtype=np.float64).reshape(-1, 3)
-
-        # reference is possible for reference positions
-        ref_positions = np.asarray(ref_positions,
-                                   dtype=np.float64).reshape(-1, 3)
-
-        delta_meters[:, :2] /= 8.9992801e-06
-        delta_meters[:, 0] *= np.cos(np.deg2rad(ref_positions[:, 1]))
-
-        return delta_meters
+        # a copy unless out is given
+        return cy_projections.lonlat_to_meters(lon_lat, ref_positions, out)
 
     @staticmethod
     def geodesic_sphere(lon, lat,
@@ -698,6 +682,13 @@ class RectangularGridProjection(NoProjection):
 
         return np.c_[lon, lat]
 
+    def pixel_transform(self):
+        """
+        None: the grid is interpolated, not shifted and scaled, so the
+        coordinates have to go through to_pixel()
+        """
+        return None
+
 
 class RegularGridProjection(GeoProjection):
     """
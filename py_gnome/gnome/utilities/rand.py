@@ -17,6 +17,7 @@ def random_with_persistance(
     array=None,  # update this array, if provided
     persistence=None,
     time_step=1.,
+    rng=None,
     ):
     """
     Used by gnome to generate a randomness between low and high, which is
@@ -34,6 +35,9 @@ def random_with_persistance(
         equal to 'time_step'. If persistence < 0 for any elements, their values
         are not updated in the 'array'
 
+    :param rng: ElementRandom of the elements in 'array' to draw the
+        numbers from. Default is None in which case numpy.random is used
+
     :returns: returns 'array' with newly computed values
 
     Note: persistence and time_step should be in the same time units
@@ -81,7 +85,7 @@ def random_with_persistance(
         if persistence == time_step, then no need to scale the [low, high]
         interval
         """
-        array[:] = np.random.uniform(low, high)
+        array[:] = _uniform(low, high, rng)
     else:
         """
         if persistence == time_step, then no need to scale the [low, high]
@@ -107,11 +111,93 @@ def random_with_persistance(
                 low[u_mask] = mean - l__range / 2.
                 high[u_mask] = mean + l__range / 2.
 
-            array[u_mask] = np.random.uniform(low[u_mask], high[u_mask])
+            if rng is None:
+                array[u_mask] = np.random.uniform(low[u_mask], high[u_mask])
+            else:
+                # rng draws for all its elements
+                array[u_mask] = rng.uniform(low, high)[u_mask]
 
     return array
 
 
+def _uniform(low, high, rng=None):
+    if rng is None:
+        return np.random.uniform(low, high)
+
+    return rng.uniform(low, high)
+
+
+class ElementRandom(object):
+    """
+    The random numbers of the elements of a release, drawn from lib_gnome's
+    counter based generator: an element's numbers depend on the seed, its
+    spill and its 'id' only, so they are the same whatever else is released
+    with it. Each draw advances a counter so the initializers of a release
+    each get numbers of their own.
+    """
+
+    def __init__(self, ids, spill_num=0, stream=0, seed=None):
+        """
+        :param ids: 'id' of each element
+        :param spill_num: index of the elements' spill
+        :param stream: keeps apart the numbers of elements with the same
+            spill and ids - the forecast and the uncertain spill containers
+        :param seed: seed of the generator. Default is None in which case
+            the seed of the C++ random state is used
+        """
+        self.ids = np.asarray(ids, dtype=np.uint32)
+        self.spill_num = spill_num
+        self.stream = stream
+        self.seed = seed
+        self.draw = 0
+
+    def __len__(self):
+        return len(self.ids)
+
+    def random(self):
+        """
+        uniform numbers in [0, 1), one per element
+        """
+        values = cy_helpers.counter_uniforms(self.ids, self.draw,
+                                             spill_id=self.spill_num,
+                                             stream=self.stream,
+                                             seed=self.seed)
+        self.draw += 1
+
+        return values
+
+    def uniform(self, low=0., high=1.):
+        return low + self.random() * (np.asarray(high) - low)
+
+    def normal(self, mean=0., sigma=1.):
+        # Box-Muller: 1 - u is in (0, 1] so its log is finite
+        radius = np.sqrt(-2. * np.log1p(-self.random()))
+
+        return mean + sigma * radius * np.cos(2. * np.pi * self.random())
+
+    def lognormal(self, mean=0., sigma=1.):
+        return np.exp(self.normal(mean, sigma))
+
+    def weibull(self, alpha, lambda_=1., min_=None, max_=None):
+        """
+        weibull numbers with shape alpha and scale lambda_, within
+        [min_, max_] if they are given - from the inverse of the cumulative
+        distribution over the part of it between min_ and max_, so no
+        numbers are drawn and thrown away
+        """
+        cdf_low = 0. if min_ is None else -np.expm1(-(min_ / lambda_) ** alpha)
+        cdf_high = 1. if max_ is None else -np.expm1(-(max_ / lambda_) ** alpha)
+
+        cdf = cdf_low + self.random() * (cdf_high - cdf_low)
+        values = lambda_ * (-np.log1p(-cdf)) ** (1. / alpha)
+
+        if min_ is not None or max_ is not None:
+            # round off at the ends of the interval
+            np.clip(values, min_, max_, out=values)
+
+        return values
+
+
 def seed(seed=1):
     """
     Set the C++, the python and the numpy random seed to desired value
@@ -13,6 +13,23 @@ data_server = 'http://gnome.orr.noaa.gov/py_gnome_testdata/'
 CHUNKSIZE = 1024 * 1024
 
 
+def is_remote_path(path):
+    '''
+    True for a http(s) URL: forcing on an OPeNDAP server, which lib_gnome
+    reads the slices it needs of rather than downloading (see
+    cy_helpers.set_forcing_block_cache_dir)
+    '''
+    return path.startswith(('http://', 'https://'))
+
+
+def data_path_exists(path):
+    '''
+    True for a file that exists, or a remote path -- that one is only found
+    or not when it is opened
+    '''
+    return is_remote_path(path) or os.path.exists(path)
+
+
 def get_datafile(file_):
     """
     Function looks to see if file_ exists in local directory. If it exists,
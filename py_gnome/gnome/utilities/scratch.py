@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+"""
+scratch.py
+
+The temporary arrays the weatherers and the Python movers work in over a
+step, kept from one step to the next so a run that has stopped releasing
+elements does no large allocations once its first steps are done.
+
+A ScratchPool lends arrays by dtype and shape. They are the borrower's till
+the end of the step, when the model gives them all back with end_step():
+an array is never lent twice in a step, and one must not be kept past it.
+The arrays of the shapes not asked for in a step are let go at its end, so
+the pool holds the arrays of about one step.
+"""
+import threading
+
+import numpy as np
+
+
+def scratch_empty(sc, shape, dtype=np.float64):
+    '''
+    an uninitialized array from sc's scratch pool, or a new one for the
+    spill containers that don't have a pool
+    '''
+    pool = getattr(sc, 'scratch', None)
+    if pool is None:
+        return np.empty(shape, dtype=dtype)
+
+    return pool.empty(shape, dtype)
+
+
+def scratch_zeros(sc, shape, dtype=np.float64):
+    'scratch_empty(), zeroed'
+    array = scratch_empty(sc, shape, dtype)
+    array.fill(0)
+
+    return array
+
+
+class ScratchPool(object):
+    '''
+    The step's temporary arrays of a spill container: empty() lends one,
+    end_step() takes them all back. The weatherers of the substances
+    weathered at the same time borrow from the one pool.
+
+    stats() are the counts since the last clear(): the arrays asked for,
+    the ones allocated for them and their bytes, and those lent again.
+    '''
+    def __init__(self):
+        self._lock = threading.Lock()
+        self.clear()
+
+    def clear(self):
+        'lets all the arrays go and zeroes the counts'
+        with self._lock:
+            self._free = {}
+            self._lent = []
+            self._used = set()
+
+            self._requests = 0
+            self._allocations = 0
+            self._allocated_bytes = 0
+
+    def _key(self, shape, dtype):
+        if np.isscalar(shape):
+            shape = (shape, )
+
+        # the dtype itself, so structured ones of a size are told apart
+        return (np.dtype(dtype), tuple(int(n) for n in shape))
+
+    def empty(self, shape, dtype=np.float64):
+        '''
+        an array of shape and dtype, uninitialized, for the rest of the step
+        '''
+        key = self._key(shape, dtype)
+
+        with self._lock:
+            self._requests += 1
+            self._used.add(key)
+
+            free = self._free.get(key)
+            if free:
+                array = free.pop()
+            else:
+                array = np.empty(key[1], dtype=key[0])
+                self._allocations += 1
+                self._allocated_bytes += array.nbytes
+
+            self._lent.append((key, array))
+
+        return array
+
+    def zeros(self, shape, dtype=np.float64):
+        'empty(), zeroed'
+        array = self.empty(shape, dtype)
+        array.fill(0)
+
+        return array
+
+    def end_step(self):
+        '''
+        takes back the arrays lent this step, and lets go of those of the
+        shapes not asked for in it
+        '''
+        with self._lock:
+            for key, array in self._lent:
+                self._free.setdefault(key, []).append(array)
+
+            for key in self._free.keys():
+                if key not in self._used:
+                    del self._free[key]
+
+            self._lent = []
+            self._used = set()
+
+    def stats(self):
+        '''
+        dict of the counts: 'requests', 'allocations', 'allocated_bytes',
+        'reuses', and 'held_bytes' of the arrays the pool has now
+        '''
+        with self._lock:
+            held = (sum(array.nbytes for arrays in self._free.itervalues()
+                        for array in arrays) +
+                    sum(array.nbytes for _key, array in self._lent))
+
+            return {'requests': self._requests,
+                    'allocations': self._allocations,
+                    'allocated_bytes': self._allocated_bytes,
+                    'reuses': self._requests - self._allocations,
+                    'held_bytes': held}
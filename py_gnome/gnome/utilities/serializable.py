@@ -480,6 +480,93 @@ class Serializable(GnomeId, Savable):
     _state = State(save=('obj_type', 'name'), read=('obj_type', 'id'),
                    update=('name',))
 
+    # the fields whose serialized values change with another's: a Wind's
+    # timeseries is given in its units
+    _dependent_fields = {}
+
+    # the serialized arrays kept to serialize again without colander are the
+    # ones of at least this many items
+    _serial_cache_size = 64
+
+    def __setattr__(self, name, value):
+        '''
+        note the attribute as changed for serialize_delta(). A private
+        attribute is noted as the public one of its name: _wind as wind
+        '''
+        super(Serializable, self).__setattr__(name, value)
+        self._mark_changed(name.lstrip('_'))
+
+    def _mark_changed(self, *names):
+        '''
+        note fields as changed for serialize_delta(), for the changes that
+        are not made by setting them, like the ones of a cython object
+        '''
+        changed = self.__dict__.setdefault('_changed', set())
+        for name in names:
+            changed.add(name)
+            changed.update(self._dependent_fields.get(name, ()))
+
+    def mark_clean(self):
+        '''
+        forget the changes so far: the next serialize_delta() has the ones
+        made from now on. serialize() for the webapi calls it.
+        '''
+        self.__dict__['_changed'] = set()
+        self.__dict__['_delta_members'] = \
+            dict((name, [item.id for item in getattr(self, name)])
+                 for name in self._delta_collections())
+
+    def has_changes(self):
+        '''
+        True if a field, a nested object or an item of a collection changed
+        since the last serialize() or serialize_delta() for the webapi, or if
+        there was none
+        '''
+        if '_delta_members' not in self.__dict__:
+            return True
+
+        attrlist = self._attrlist()
+        if self.__dict__['_changed'].intersection(attrlist):
+            return True
+
+        for obj in self._nested_objects(attrlist).values():
+            if obj.has_changes():
+                return True
+
+        for name in self._delta_collections():
+            coll = getattr(self, name)
+            if ([item.id for item in coll] !=
+                    self.__dict__['_delta_members'].get(name)):
+                return True
+
+            if any(item.has_changes() for item in coll):
+                return True
+
+        return False
+
+    def _delta_collections(self):
+        'the names of the collections of Serializable objects'
+        return [field.name for field in
+                self._state.get_field_by_attribute('iscollection')]
+
+    def _nested_objects(self, attrlist):
+        '''
+        the nested Serializable objects of the fields of attrlist, the ones
+        kept as attributes of the field name or the private one, by name.
+        The properties aren't called.
+        '''
+        nested = {}
+        for name in attrlist:
+            obj = self.__dict__.get(name, self.__dict__.get('_' + name))
+            if isinstance(obj, Serializable):
+                nested[name] = obj
+
+        return nested
+
+    def _delta_schema(self, json_='webapi'):
+        'the schema of the fields of serialize_delta() and update_from_delta()'
+        return self.__class__._schema()
+
     @classmethod
     def _restore_attr_from_save(cls, new_obj, dict_):
         '''
@@ -663,6 +750,55 @@ class Serializable(GnomeId, Savable):
 
         return updated
 
+    def update_from_delta(self, json_):
+        '''
+        Apply a delta of serialize_delta() made by the client: the fields in
+        it are deserialized through their nodes of the schema and given to
+        update_from_dict(), the nested objects and the items of the
+        collections are updated with their own deltas.
+
+        New objects are made with new_from_dict(): a delta of a collection
+        with an object not in it raises a ValueError.
+
+        :returns: True if something changed, False otherwise
+        '''
+        attrlist = self._attrlist()
+        schema = self._delta_schema(json_.get('json_', 'webapi'))
+        nested = self._nested_objects(attrlist)
+        collections = self._delta_collections()
+        updated = False
+        data = {}
+
+        for name, value in json_.iteritems():
+            if name in ('obj_type', 'id', 'json_') or name not in attrlist:
+                continue
+
+            if name in collections:
+                items = dict((item.id, item) for item in getattr(self, name))
+                for item_delta in value:
+                    if item_delta.get('id') not in items:
+                        raise ValueError('{0} is not in {1}: new objects are '
+                                         'made with new_from_dict'
+                                         .format(item_delta.get('id'), name))
+
+                    if items[item_delta['id']].update_from_delta(item_delta):
+                        updated = True
+            elif (name in nested and isinstance(value, dict) and
+                    value.get('id') == nested[name].id):
+                if nested[name].update_from_delta(value):
+                    updated = True
+            else:
+                node = schema.get(name)
+                if node is None or value is None:
+                    data[name] = value
+                else:
+                    data[name] = node.deserialize(value)
+
+        if data and self.update_from_dict(data):
+            updated = True
+
+        return updated
+
     def _attr_changed(self, current_value, received_value):
         '''
         Checks if an attribute passed back in a dict_ from client has changed.
@@ -851,6 +987,10 @@ class Serializable(GnomeId, Savable):
                     toserial[key] = dict_[key]
 
         toserial['json_'] = json_
+
+        if json_ == 'webapi':
+            self.mark_clean()
+
         return toserial
 
     def serialize(self, json_='webapi'):
@@ -871,7 +1011,7 @@ class Serializable(GnomeId, Savable):
         c_fields = self._state.get_field_by_attribute('iscollection')
 
         if json_ == 'webapi':
-            serial = schema.serialize(toserial)
+            serial = self._serialize_cached(schema, toserial, json_)
             # check for collections
             for field in c_fields:
                 serial[field.name] = \
@@ -881,10 +1021,101 @@ class Serializable(GnomeId, Savable):
                 # add a node for each collection, then serialize
                 schema.add(CollectionItemsList(name=field.name))
 
-            serial = schema.serialize(toserial)
+            serial = self._serialize_cached(schema, toserial, json_)
 
         return serial
 
+    def _serialize_cached(self, schema, toserial, json_):
+        '''
+        schema.serialize(toserial), with the large arrays of toserial
+        serialized by _serialize_array()
+        '''
+        arrays = {}
+        for name, value in toserial.items():
+            node = schema.get(name)
+            if (node is not None and isinstance(value, np.ndarray) and
+                    value.size >= self._serial_cache_size):
+                arrays[name] = self._serialize_array(node, name, value, json_)
+                del toserial[name]
+
+        serial = schema.serialize(toserial)
+        serial.update(arrays)
+
+        return serial
+
+    def _serialize_array(self, node, name, value, json_):
+        '''
+        node.serialize(value) for a large array: the one of the last time,
+        if value has not changed since, so a long timeseries or polygon is
+        not walked item by item by colander every time the object is
+        serialized
+        '''
+        cache = self.__dict__.setdefault('_serial_cache', {})
+        key = (json_, name)
+        raw = (value.dtype, value.shape, value.tobytes())
+
+        if key not in cache or cache[key][0] != raw:
+            cache[key] = (raw, node.serialize(value))
+
+        # the items are shared with the cache, they are not to be changed
+        return copy.copy(cache[key][1])
+
+    def serialize_delta(self, json_='webapi'):
+        '''
+        Serialize what has changed since the last serialize() or
+        serialize_delta() for the webapi, for the client that has that
+        already: the changed fields through their nodes of the schema, the
+        deltas of the nested objects that changed, and of the items of the
+        collections that changed -- or the whole collection if items were
+        added, removed or moved. obj_type, id and json_ are always in it. An
+        object never serialized for the webapi is serialized whole.
+
+        The changes are the fields set, and the ones given to _mark_changed():
+        arrays changed in place are not seen.
+        '''
+        if '_delta_members' not in self.__dict__:
+            return self.serialize(json_)
+
+        attrlist = self._attrlist()
+        changed = self.__dict__['_changed']
+        members = self.__dict__['_delta_members']
+        schema = self._delta_schema(json_)
+        nested = self._nested_objects(attrlist)
+        collections = self._delta_collections()
+
+        delta = {'obj_type': self.obj_type_to_dict(),
+                 'id': self.id,
+                 'json_': json_}
+
+        for name in attrlist:
+            if name in collections:
+                coll = getattr(self, name)
+                if [item.id for item in coll] != members.get(name):
+                    delta[name] = self.serialize_oc(coll, json_)
+                else:
+                    items = [item.serialize_delta(json_) for item in coll
+                             if item.has_changes()]
+                    if items:
+                        delta[name] = items
+            elif name in changed:
+                value = self.attr_to_dict(name)
+                node = schema.get(name)
+
+                if isinstance(value, Serializable):
+                    value = value.serialize(json_)
+                elif isinstance(value, np.ndarray) and node is not None:
+                    value = self._serialize_array(node, name, value, json_)
+                elif value is not None and node is not None:
+                    value = node.serialize(value)
+
+                delta[name] = value
+            elif name in nested and nested[name].has_changes():
+                delta[name] = nested[name].serialize_delta(json_)
+
+        self.mark_clean()
+
+        return delta
+
     @classmethod
     def is_sparse(cls, json_):
         '''
@@ -0,0 +1,147 @@
+#!/usr/bin/env python
+"""
+setup_profile.py
+
+Where the time of setting up a model goes, object by object: reading the
+map and the forcing files, deserializing a save file, preparing each mover
+for a run. Each object keeps a record of each of its setup stages -- how
+long it took, the lib_gnome stages that ran in it (cy_helpers
+.get_setup_stats(): topology builds, island numbering, DAG trees, tide
+year data, scans of forcing files for their times) and the caches that
+applied to it, served or not. The caches that applied and didn't serve are
+the record's 'could_be_cached': a warm run wouldn't pay for the stage.
+
+Model.setup_profile() gives the records of a model's objects. The records
+are kept for the life of the object only, they aren't saved with it.
+
+The lib_gnome stages nest -- a topology build includes its islands and DAG
+tree -- so their times don't add up to the record's.
+"""
+import time
+import weakref
+from contextlib import contextmanager
+
+from gnome.cy_gnome import cy_helpers
+
+# the cache each lib_gnome stage could be served by
+STAGE_CACHES = {'topology': 'topology',
+                'time_scan': 'time_index',
+                }
+
+# id of an object to a weak reference to it and its records, by stage --
+# by id, the objects that compare equal have records of their own
+_records = {}
+
+
+def _forget(obj_id):
+    return lambda ref: _records.pop(obj_id, None)
+
+
+class SetupStage(object):
+    """
+    a setup stage of an object, from when it is made until done()
+    """
+    def __init__(self, stage):
+        self.stage = stage
+        self.start = time.time()
+        self._lib_start = cy_helpers.get_setup_stats()
+
+    def done(self, obj, caches=None):
+        """
+        records the stage as obj's, in place of an earlier record of it
+
+        :param caches: a dict of the name of each cache the stage could
+            have been served by, other than lib_gnome's, to whether it was
+        """
+        seconds = time.time() - self.start
+        lib_end = cy_helpers.get_setup_stats()
+
+        lib_stages = {}
+        for name, end in lib_end['stages'].iteritems():
+            start = self._lib_start['stages'][name]
+            count = end['count'] - start['count']
+            if count > 0:
+                lib_stages[name] = {'count': count,
+                                    'seconds': end['seconds'] -
+                                    start['seconds']}
+
+        cache_hits = {}
+        for name, hits in lib_end['cache_hits'].iteritems():
+            hits -= self._lib_start['cache_hits'][name]
+            if hits > 0:
+                cache_hits[name] = hits
+
+        served = dict(caches or {})
+        for name in lib_stages:
+            if name in STAGE_CACHES:
+                served.setdefault(STAGE_CACHES[name], False)
+        for name in cache_hits:
+            served[name] = True
+
+        record = {'stage': self.stage,
+                  'start': self.start,
+                  'seconds': seconds,
+                  'lib_gnome': lib_stages,
+                  'cache_hits': cache_hits,
+                  'caches': served,
+                  'could_be_cached': sorted(n for n, s in served.iteritems()
+                                            if not s)}
+
+        obj_id = id(obj)
+        if obj_id not in _records:
+            try:
+                _records[obj_id] = (weakref.ref(obj, _forget(obj_id)), {})
+            except TypeError:
+                # not an object a weak reference can be kept to
+                return record
+        _records[obj_id][1][self.stage] = record
+
+        return record
+
+
+@contextmanager
+def setup_stage(obj, stage, caches=None):
+    """
+    records the stage of obj the with block runs. caches is as done()'s,
+    and may be changed in the block
+    """
+    s = SetupStage(stage)
+    if caches is None:
+        caches = {}
+
+    yield caches
+
+    s.done(obj, caches)
+
+
+def records(obj):
+    """
+    the records of obj's setup stages, in the order they started
+    """
+    ref, by_stage = _records.get(id(obj), (None, {}))
+    if ref is None or ref() is not obj:
+        return []
+
+    return sorted(by_stage.values(), key=lambda r: r['start'])
+
+
+def report(objects):
+    """
+    the records of the setup stages of objects, each with the 'class',
+    'name' and 'id' of its object, in the order they started
+    """
+    seen = set()
+    report = []
+    for obj in objects:
+        if obj is None or id(obj) in seen:
+            continue
+        seen.add(id(obj))
+
+        for r in records(obj):
+            r = dict(r)
+            r['class'] = obj.__class__.__name__
+            r['name'] = getattr(obj, 'name', None)
+            r['id'] = getattr(obj, 'id', None)
+            report.append(r)
+
+    return sorted(report, key=lambda r: r['start'])
@@ -0,0 +1,277 @@
+#!/usr/bin/env python
+"""
+shared_arrays.py
+
+Passes the numpy arrays of a result from one process to another through
+shared memory, so they are not pickled and sent over the socket.
+
+The writer pickles the result with each large array replaced by a small
+reference to where it put the array's data in a shared file -- on
+/dev/shm, which is memory, where there is one. The pickle is then only a
+control message, and the reader copies the arrays out of the file where
+the references say they are.
+
+The file is reused for every result, so a result must be read before the
+writer writes the next one -- as it is with the request / reply sockets of
+the ModelBroadcaster.
+
+Between hosts, where there is no file to share, FrameWriter puts each large
+array in a frame of its own after the pickle, and the frames are sent as one
+multipart zmq message without copying the arrays into it. FrameReader's
+arrays are read only views of the frames that came in. Both ends have
+dumps_frames() and loads_frames(), so the ModelConsumers and their clients
+use either the same way.
+"""
+import os
+import mmap
+import cPickle
+from cStringIO import StringIO
+
+import numpy as np
+
+# arrays smaller than this are pickled with the rest of the result
+MIN_BYTES = 4096
+
+# where arrays start in the file
+ALIGNMENT = 64
+
+SHARED_ARRAY = 'shared_array'
+FRAMED_ARRAY = 'framed_array'
+
+
+def shared_filename(name, folder='.'):
+    """
+    The path of a shared file: on /dev/shm if there is one, else in folder
+    """
+    if os.path.isdir('/dev/shm'):
+        folder = '/dev/shm'
+
+    return os.path.join(folder, name)
+
+
+def _frame_bytes(frame):
+    'the bytes of a zmq frame, or a string'
+    return getattr(frame, 'bytes', frame)
+
+
+class SharedArrayWriter(object):
+    """
+    The sending end: dumps() pickles a result, putting its arrays in the
+    shared file
+    """
+    def __init__(self, filename, min_bytes=MIN_BYTES):
+        self.filename = filename
+        self.min_bytes = min_bytes
+
+        self._file = open(filename, 'w+b')
+        self._buf = None
+        self._size = 0
+
+        self._arrays = []
+        self._end = 0
+
+    def dumps(self, obj):
+        """
+        obj pickled, with the data of its arrays in the shared file
+        """
+        self._arrays = []
+        self._end = 0
+
+        out = StringIO()
+        pickler = cPickle.Pickler(out, cPickle.HIGHEST_PROTOCOL)
+        pickler.persistent_id = self._persistent_id
+        pickler.dump(obj)
+
+        # the file is only grown once the size of all the arrays is known,
+        # so no views of the old map are left when it is remapped
+        self._reserve(self._end)
+
+        for offset, a in self._arrays:
+            dest = np.ndarray(a.shape, dtype=a.dtype, buffer=self._buf,
+                              offset=offset)
+            dest[...] = a
+
+        self._arrays = []
+
+        return out.getvalue()
+
+    def dumps_frames(self, obj):
+        return [self.dumps(obj)]
+
+    def _persistent_id(self, obj):
+        if (type(obj) is not np.ndarray or
+                obj.dtype.hasobject or
+                obj.nbytes < self.min_bytes):
+            return None
+
+        offset = -(-self._end // ALIGNMENT) * ALIGNMENT
+        self._end = offset + obj.nbytes
+        self._arrays.append((offset, obj))
+
+        return (SHARED_ARRAY, offset, obj.dtype, obj.shape)
+
+    def _reserve(self, nbytes):
+        if nbytes <= self._size:
+            return
+
+        # grow by doubling, in whole pages, so it is not remapped every step
+        size = max(nbytes, 2 * self._size)
+        size = -(-size // mmap.PAGESIZE) * mmap.PAGESIZE
+
+        if self._buf is not None:
+            self._buf.close()
+
+        self._file.truncate(size)
+        self._buf = mmap.mmap(self._file.fileno(), size)
+        self._size = size
+
+    def close(self):
+        if self._buf is not None:
+            self._buf.close()
+            self._buf = None
+
+        self._file.close()
+        self._size = 0
+
+
+class SharedArrayReader(object):
+    """
+    The receiving end: loads() unpickles a result made by
+    SharedArrayWriter.dumps(), with copies of its arrays from the shared
+    file
+    """
+    def __init__(self, filename):
+        self.filename = filename
+
+        self._file = None
+        self._buf = None
+        self._size = 0
+
+    def loads(self, data):
+        unpickler = cPickle.Unpickler(StringIO(data))
+        unpickler.persistent_load = self._persistent_load
+
+        return unpickler.load()
+
+    def loads_frames(self, frames):
+        return self.loads(_frame_bytes(frames[0]))
+
+    def _persistent_load(self, pid):
+        tag, offset, dtype, shape = pid
+
+        if tag != SHARED_ARRAY:
+            raise cPickle.UnpicklingError('unknown persistent id: '
+                                          '{0}'.format(tag))
+
+        end = offset + dtype.itemsize * int(np.prod(shape))
+        if end > self._size:
+            self._map()
+
+        # copied, as the writer reuses the file for its next result
+        return np.ndarray(shape, dtype=dtype, buffer=self._buf,
+                          offset=offset).copy()
+
+    def _map(self):
+        """
+        maps all of the file, which the writer may have grown
+        """
+        if self._file is None:
+            self._file = open(self.filename, 'rb')
+
+        if self._buf is not None:
+            self._buf.close()
+
+        self._size = os.fstat(self._file.fileno()).st_size
+        self._buf = mmap.mmap(self._file.fileno(), self._size,
+                              access=mmap.ACCESS_READ)
+
+    def close(self):
+        if self._buf is not None:
+            self._buf.close()
+            self._buf = None
+
+        if self._file is not None:
+            self._file.close()
+            self._file = None
+
+        self._size = 0
+
+
+class FrameWriter(object):
+    """
+    The sending end over a network: dumps_frames() pickles a result, with
+    each large array replaced by the index of the frame its data is in
+    """
+    filename = None
+
+    def __init__(self, min_bytes=MIN_BYTES):
+        self.min_bytes = min_bytes
+
+        self._frames = []
+
+    def dumps_frames(self, obj):
+        """
+        the frames of a multipart message of obj: the pickle, then the
+        buffers of its arrays, for send_multipart(copy=False)
+        """
+        self._frames = [None]
+
+        out = StringIO()
+        pickler = cPickle.Pickler(out, cPickle.HIGHEST_PROTOCOL)
+        pickler.persistent_id = self._persistent_id
+        pickler.dump(obj)
+
+        frames, self._frames = self._frames, []
+        frames[0] = out.getvalue()
+
+        return frames
+
+    def _persistent_id(self, obj):
+        if (type(obj) is not np.ndarray or
+                obj.dtype.hasobject or
+                obj.nbytes < self.min_bytes):
+            return None
+
+        self._frames.append(np.ascontiguousarray(obj))
+
+        return (FRAMED_ARRAY, len(self._frames) - 1, obj.dtype, obj.shape)
+
+    def close(self):
+        self._frames = []
+
+
+class FrameReader(object):
+    """
+    The receiving end over a network: loads_frames() unpickles the frames
+    made by FrameWriter.dumps_frames(), the arrays read only views of their
+    frames
+    """
+    filename = None
+
+    def __init__(self):
+        self._frames = []
+
+    def loads_frames(self, frames):
+        self._frames = frames
+        try:
+            unpickler = cPickle.Unpickler(StringIO(_frame_bytes(frames[0])))
+            unpickler.persistent_load = self._persistent_load
+
+            return unpickler.load()
+        finally:
+            self._frames = []
+
+    def _persistent_load(self, pid):
+        tag, index, dtype, shape = pid
+
+        if tag != FRAMED_ARRAY:
+            raise cPickle.UnpicklingError('unknown persistent id: '
+                                          '{0}'.format(tag))
+
+        frame = self._frames[index]
+        data = getattr(frame, 'buffer', frame)
+
+        return np.frombuffer(data, dtype=dtype).reshape(shape)
+
+    def close(self):
+        self._frames = []
@@ -0,0 +1,141 @@
+#!/usr/bin/env python
+"""
+step_pipeline.py
+
+Overlaps the parts of a model step that don't depend on one another, for
+Model.pipeline_steps.
+
+The stages of a step, and what each of them needs::
+
+    setup_time_step    the forcing of the step, the elements released at
+                       the end of the step before
+    move_elements      setup_time_step
+    weather_elements   move_elements (beached elements don't weather)
+    step_is_done       weather_elements
+    release, cache     step_is_done
+    write_output       the cache
+
+The forcing of the next step -- what the movers read from their files at
+its times -- depends on none of this step's elements. Once move_elements()
+is done with the forcing of this step, the next step's can be read while
+the elements weather: the model runs Mover.prepare_forcing() and
+Environment.prepare_forcing() for the next step on a ForcingPrefetch
+thread, and setup_time_step() of the next step waits for them. The
+outputters on the model's OutputWriter thread write each step while the
+model moves and weathers the next one.
+
+prepare_forcing() must not touch the spill containers, the weatherers or
+anything else the weathering reads: it runs at the same time.
+
+With Model.concurrent_spill_containers, the forecast and the uncertain
+spill containers, which don't depend on one another within a step, are
+moved and weathered at the same time, with run_concurrently(): the
+uncertain one on a worker thread while the lib_gnome calls of the forecast
+one release the GIL. The two are done before the stage after.
+
+With Model.concurrent_substances, the substances of a spill container are
+weathered at the same time in the same way, by the weatherers that only
+touch their elements through SpillContainer.itersubstancedata(): each
+substance on a SubstanceSubset of its own, with a mass balance of its own
+that is added to the spill container's in the order of the substances.
+"""
+import sys
+import threading
+
+# the run_concurrently() worker threads have in_worker set
+_worker = threading.local()
+
+
+def in_worker_thread():
+    """
+    whether this is a run_concurrently() worker thread
+    """
+    return getattr(_worker, 'in_worker', False)
+
+
+def _run_job(func, args, errors, i):
+    _worker.in_worker = True
+    try:
+        func(*args)
+    except Exception:
+        errors[i] = sys.exc_info()
+
+
+def run_concurrently(jobs):
+    """
+    Runs the (func, args) jobs at the same time, the first on this thread
+    and the others on worker threads, and returns once they are all done.
+    The error of the first job that failed is raised again.
+    """
+    errors = [None] * len(jobs)
+    threads = []
+
+    for i, (func, args) in enumerate(jobs[1:], 1):
+        thread = threading.Thread(target=_run_job,
+                                  args=(func, args, errors, i),
+                                  name='gnome spill container {0}'.format(i))
+        thread.daemon = True
+        thread.start()
+        threads.append(thread)
+
+    try:
+        if jobs:
+            func, args = jobs[0]
+            func(*args)
+    except Exception:
+        errors[0] = sys.exc_info()
+
+    for thread in threads:
+        thread.join()
+
+    for error in errors:
+        if error is not None:
+            raise error[0], error[1], error[2]
+
+
+class ForcingPrefetch(object):
+    """
+    Runs the prepare_forcing() calls of a step on a background thread, one
+    step at a time.
+
+    An exception in a call stops the rest of them, and is raised again by
+    wait().
+    """
+    def __init__(self):
+        self._thread = None
+        self._error = None
+
+    @property
+    def busy(self):
+        return self._thread is not None
+
+    def start(self, jobs):
+        """
+        runs the (func, args) jobs, in order, once the ones before are done
+        """
+        self.wait()
+
+        self._thread = threading.Thread(target=self._run, args=(jobs,),
+                                        name='gnome forcing prefetch')
+        self._thread.daemon = True
+        self._thread.start()
+
+    def _run(self, jobs):
+        try:
+            for func, args in jobs:
+                func(*args)
+        except Exception:
+            self._error = sys.exc_info()
+
+    def wait(self, raise_error=True):
+        """
+        waits for the jobs to be done, and raises the error of one that
+        failed unless raise_error is False
+        """
+        thread, self._thread = self._thread, None
+        if thread is not None:
+            thread.join()
+
+        error, self._error = self._error, None
+        if error is not None and raise_error:
+            raise error[0], error[1], error[2]
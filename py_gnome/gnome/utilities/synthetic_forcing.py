@@ -0,0 +1,506 @@
+#!/usr/bin/env python
+"""
+synthetic_forcing.py
+
+Writes current files of any size for the benchmarks: NetCDF grids of an
+analytic velocity field, in the layouts the grid current movers read, so
+the grid building (the DAG tree, the point reordering and island numbering
+of the curvilinear grids) and the time slice reads can be timed as the
+grids grow, and the movers' velocities checked against the field.
+
+ - rectilinear: CF lon and lat coordinates, u and v of (time, lat, lon)
+ - curvilinear: ROMS-like, a rotated and warped grid of 2D lon and lat
+   (yc, xc) with a land mask of round islands, the bathymetry, ROMS
+   s-coordinates (sc_r, Cs_r, hc) and u and v of (time, sigma, yc, xc)
+   on the nodes
+ - triangular: a mesh of the grid's cells split in two, with the UGRID
+   mesh topology attributes and the node, nele, nv, nbe and bnd layout of
+   the triangular grids GNOME reads, u and v of (time, node)
+
+The fields don't vary with depth, and are in m/s, eastward and northward:
+
+ - uniform: the same everywhere
+ - shear: eastward, going from 0 at the south edge to the speed at the
+   north edge, so a linear interpolation has it exactly
+ - gyre: a gyre over the domain, its streamfunction sin(pi x) sin(pi y) of
+   the domain scaled to 0..1, its strength going up and down by 10 percent
+   over a day
+
+The files are NetCDF 3 (64 bit offsets), the format the movers recognize
+by its first bytes, written a time slice at a time.
+
+    info = write_forcing('curvilinear', 'big.nc', shape=(1000, 1000),
+                         num_times=48)
+    positions = water_positions(info, 1000)
+    delta = expected_delta(info, positions, model_time, time_step)
+
+usage: synthetic_forcing.py rectilinear|curvilinear|triangular filename
+           [num_rows num_cols [num_times]]
+"""
+import sys
+from datetime import datetime
+
+import numpy as np
+
+from gnome.utilities.lazy_import import lazy_module
+from gnome.utilities.time_utils import date_to_sec
+from gnome.utilities.projections import FlatEarthProjection
+
+nc = lazy_module('netCDF4')
+
+KINDS = ('rectilinear', 'curvilinear', 'triangular')
+
+# ((lon, lat), (lon, lat)) of the grids
+DEFAULT_BOUNDS = ((-72., 40.), (-70., 42.))
+DEFAULT_START_TIME = datetime(2012, 1, 1)
+
+FILL_VALUE = -1e+34
+
+
+def uniform_field(lon, lat, seconds, bounds, speed):
+    u = np.full(np.shape(lon), speed * np.cos(np.pi / 6))
+    v = np.full(np.shape(lon), speed * np.sin(np.pi / 6))
+
+    return u, v
+
+
+def shear_field(lon, lat, seconds, bounds, speed):
+    ((_lo_long, lo_lat), (_hi_long, hi_lat)) = bounds
+    y = (np.asarray(lat) - lo_lat) / (hi_lat - lo_lat)
+
+    return speed * y, np.zeros_like(y)
+
+
+def gyre_field(lon, lat, seconds, bounds, speed):
+    ((lo_long, lo_lat), (hi_long, hi_lat)) = bounds
+    x = (np.asarray(lon) - lo_long) / (hi_long - lo_long)
+    y = (np.asarray(lat) - lo_lat) / (hi_lat - lo_lat)
+    strength = speed * (1. + .1 * np.sin(2 * np.pi * seconds / 86400.))
+
+    # u = -dpsi/dy, v = dpsi/dx, in units of the domain
+    u = -strength * np.sin(np.pi * x) * np.cos(np.pi * y)
+    v = strength * np.cos(np.pi * x) * np.sin(np.pi * y)
+
+    return u, v
+
+
+FIELDS = {'uniform': uniform_field,
+          'shear': shear_field,
+          'gyre': gyre_field}
+
+
+def velocity(info, lon, lat, seconds):
+    '''
+    the (u, v) m/s of the field of a file write_forcing() wrote, at seconds
+    since its start time
+    '''
+    return FIELDS[info['field']](lon, lat, seconds, info['bounds'],
+                                 info['speed'])
+
+
+def _lattice(shape, bounds):
+    ((lo_long, lo_lat), (hi_long, hi_lat)) = bounds
+    num_rows, num_cols = shape
+
+    return (np.linspace(lo_long, hi_long, num_cols),
+            np.linspace(lo_lat, hi_lat, num_rows))
+
+
+def _islands(shape, bounds, num_islands):
+    '''
+    (lon, lat, radius) of num_islands round islands on a row across the
+    middle of the domain, a few cells wide each
+    '''
+    ((lo_long, lo_lat), (hi_long, hi_lat)) = bounds
+    width = hi_long - lo_long
+    radius = max(3. * width / shape[1], width / (6. * num_islands + 6.))
+
+    return [(lo_long + width * (i + 1.) / (num_islands + 1.),
+             (lo_lat + hi_lat) / 2., radius)
+            for i in range(num_islands)]
+
+
+def _on_land(info, lon, lat):
+    land = np.zeros(np.shape(lon), dtype=bool)
+    for (x, y, r) in info['islands']:
+        land |= (np.asarray(lon) - x) ** 2 + (np.asarray(lat) - y) ** 2 < r * r
+
+    return land
+
+
+def _time_values(info):
+    return np.arange(info['num_times']) * (info['time_step'] / 3600.)
+
+
+def _add_time(ds, info):
+    ds.createDimension('time', None)
+    time = ds.createVariable('time', 'f8', ('time', ))
+    time.units = ('hours since {0}'
+                  .format(info['start_time'].strftime('%Y-%m-%d %H:%M:%S')))
+    time.standard_name = 'time'
+    time.long_name = 'time'
+    time[:] = _time_values(info)
+
+
+def _add_velocity(ds, dims, lon_name, lat_name):
+    uv = []
+    for name, standard_name in (('u', 'eastward_sea_water_velocity'),
+                                ('v', 'northward_sea_water_velocity')):
+        var = ds.createVariable(name, 'f4', dims, fill_value=FILL_VALUE)
+        var.units = 'm/s'
+        var.standard_name = standard_name
+        var.coordinates = '{0} {1}'.format(lon_name, lat_name)
+        uv.append(var)
+
+    return uv
+
+
+def _write_slices(info, u_var, v_var, lon, lat, land=None, num_levels=None):
+    '''
+    the field at each time, a slice at a time, on land the fill value
+    '''
+    for i, hours in enumerate(_time_values(info)):
+        u, v = velocity(info, lon, lat, hours * 3600.)
+        if land is not None:
+            u = np.where(land, FILL_VALUE, u)
+            v = np.where(land, FILL_VALUE, v)
+        if num_levels is not None:
+            u = np.repeat(u[np.newaxis], num_levels, axis=0)
+            v = np.repeat(v[np.newaxis], num_levels, axis=0)
+
+        u_var[i] = u
+        v_var[i] = v
+
+
+def _write_rectilinear(ds, info):
+    lon, lat = _lattice(info['shape'], info['bounds'])
+
+    ds.grid_type = 'REGULAR'
+    ds.createDimension('lat', len(lat))
+    ds.createDimension('lon', len(lon))
+
+    lat_var = ds.createVariable('lat', 'f8', ('lat', ))
+    lat_var.units = 'degrees_north'
+    lat_var.standard_name = 'latitude'
+    lat_var[:] = lat
+
+    lon_var = ds.createVariable('lon', 'f8', ('lon', ))
+    lon_var.units = 'degrees_east'
+    lon_var.standard_name = 'longitude'
+    lon_var[:] = lon
+
+    _add_time(ds, info)
+    u_var, v_var = _add_velocity(ds, ('time', 'lat', 'lon'), 'lon', 'lat')
+
+    lon2, lat2 = np.meshgrid(lon, lat)
+    _write_slices(info, u_var, v_var, lon2, lat2)
+
+
+def curvilinear_points(info):
+    '''
+    the (num_rows, num_cols) lon and lat of a curvilinear grid: the lattice
+    of the bounds turned a little about its center, and its rows warped
+    '''
+    ((lo_long, lo_lat), (hi_long, hi_lat)) = info['bounds']
+    num_rows, num_cols = info['shape']
+    x, y = np.meshgrid(np.linspace(0., 1., num_cols),
+                       np.linspace(0., 1., num_rows))
+
+    angle = np.radians(5.)
+    xr = .5 + (x - .5) * np.cos(angle) - (y - .5) * np.sin(angle)
+    yr = .5 + (x - .5) * np.sin(angle) + (y - .5) * np.cos(angle)
+    yr += .02 * np.sin(np.pi * xr)
+
+    # inside the bounds
+    xr = .05 + .9 * xr
+    yr = .05 + .9 * yr
+
+    return (lo_long + (hi_long - lo_long) * xr,
+            lo_lat + (hi_lat - lo_lat) * yr)
+
+
+def _write_curvilinear(ds, info):
+    num_rows, num_cols = info['shape']
+    num_levels = info['num_levels']
+    lon, lat = curvilinear_points(info)
+    land = _on_land(info, lon, lat)
+
+    # GNOME reads the nodes of (yc, xc) with the velocities on them
+    ds.grid_type = 'curvilinear'
+    ds.createDimension('yc', num_rows)
+    ds.createDimension('xc', num_cols)
+    ds.createDimension('sigma', num_levels)
+
+    for name, values, units, standard_name in (('lat', lat, 'degrees_north',
+                                                'latitude'),
+                                               ('lon', lon, 'degrees_east',
+                                                'longitude')):
+        var = ds.createVariable(name, 'f8', ('yc', 'xc'))
+        var.units = units
+        var.standard_name = standard_name
+        var[:] = values
+
+    mask = ds.createVariable('mask', 'f8', ('yc', 'xc'))
+    mask.long_name = 'land mask'
+    mask.flag_values = np.array([0., 1.])
+    mask.flag_meanings = 'land water'
+    mask[:] = np.where(land, 0., 1.)
+
+    # deeper to the east
+    depth = ds.createVariable('depth', 'f4', ('yc', 'xc'))
+    depth.units = 'm'
+    depth.positive = 'down'
+    depth.standard_name = 'sea_floor_depth_below_geoid'
+    depth[:] = 10. + 90. * (lon - lon.min()) / (lon.max() - lon.min())
+
+    # ROMS s-coordinates, unstretched: z = hc*sc_r + (h - hc)*Cs_r
+    sc_r = -1. + (np.arange(num_levels) + .5) / num_levels
+    sc_r_var = ds.createVariable('sc_r', 'f4', ('sigma', ))
+    sc_r_var.long_name = 's-coordinate at rho points'
+    sc_r_var.standard_name = 'ocean_s_coordinate'
+    sc_r_var.formula_terms = 's: sc_r C: Cs_r depth: depth depth_c: hc'
+    sc_r_var[:] = sc_r
+    cs_r_var = ds.createVariable('Cs_r', 'f4', ('sigma', ))
+    cs_r_var.long_name = 's-coordinate stretching curve at rho points'
+    cs_r_var[:] = sc_r
+    hc = ds.createVariable('hc', 'f4', ())
+    hc.units = 'm'
+    hc.long_name = 's-coordinate critical depth'
+    hc.assignValue(5.)
+
+    _add_time(ds, info)
+    u_var, v_var = _add_velocity(ds, ('time', 'sigma', 'yc', 'xc'),
+                                 'lon', 'lat')
+    _write_slices(info, u_var, v_var, lon, lat, land, num_levels)
+
+
+def triangles(shape):
+    '''
+    the counterclockwise (num_triangles, 3) nodes of the cells of a
+    (num_rows, num_cols) lattice of nodes split in two, node j*num_cols+i
+    at row j and column i
+    '''
+    num_rows, num_cols = shape
+    j, i = np.meshgrid(np.arange(num_rows - 1), np.arange(num_cols - 1),
+                       indexing='ij')
+    a = (j * num_cols + i).ravel()
+    b, c, d = a + 1, a + num_cols + 1, a + num_cols
+
+    return np.concatenate((np.column_stack((a, b, c)),
+                           np.column_stack((a, c, d))))
+
+
+def neighbors(tris):
+    '''
+    the (num_triangles, 3) triangles across the edges opposite each vertex
+    of the triangles, -1 on the boundary
+    '''
+    num_tris = len(tris)
+    # the edge opposite vertex m is the other two
+    edges = np.concatenate([tris[:, [(m + 1) % 3, (m + 2) % 3]]
+                            for m in range(3)])
+    edges.sort(axis=1)
+    keys = edges[:, 0].astype(np.int64) * (tris.max() + 1) + edges[:, 1]
+
+    order = np.argsort(keys, kind='mergesort')
+    pair = np.flatnonzero(keys[order][1:] == keys[order][:-1])
+    first, second = order[pair], order[pair + 1]
+
+    result = np.full((3 * num_tris, ), -1, dtype=np.int64)
+    result[first] = second % num_tris
+    result[second] = first % num_tris
+
+    # edge k of vertex m is result[m * num_tris + k]
+    return result.reshape(3, num_tris).T
+
+
+def boundary(shape):
+    '''
+    the nodes around the lattice, counterclockwise from its southwest corner
+    '''
+    num_rows, num_cols = shape
+    south = np.arange(num_cols)
+    east = np.arange(1, num_rows) * num_cols + num_cols - 1
+    north = (num_rows - 1) * num_cols + np.arange(num_cols - 2, -1, -1)
+    west = np.arange(num_rows - 2, 0, -1) * num_cols
+
+    return np.concatenate((south, east, north, west))
+
+
+def _write_triangular(ds, info):
+    lon, lat = _lattice(info['shape'], info['bounds'])
+    lon, lat = [a.ravel() for a in np.meshgrid(lon, lat)]
+    tris = triangles(info['shape'])
+    ring = boundary(info['shape'])
+
+    ds.grid_type = 'Triangular'
+    ds.createDimension('node', len(lon))
+    ds.createDimension('nele', len(tris))
+    ds.createDimension('three', 3)
+    ds.createDimension('nbnd', len(ring))
+    ds.createDimension('nbi', 4)
+
+    mesh = ds.createVariable('mesh', 'i4', ())
+    mesh.cf_role = 'mesh_topology'
+    mesh.topology_dimension = 2
+    mesh.node_coordinates = 'lon lat'
+    mesh.face_node_connectivity = 'nv'
+    mesh.face_face_connectivity = 'nbe'
+    mesh.face_dimension = 'nele'
+    mesh.boundary_node_connectivity = 'bnd'
+
+    for name, values, units, standard_name in (('lat', lat, 'degrees_north',
+                                                'latitude'),
+                                               ('lon', lon, 'degrees_east',
+                                                'longitude')):
+        var = ds.createVariable(name, 'f4', ('node', ))
+        var.units = units
+        var.standard_name = standard_name
+        var[:] = values
+
+    depth = ds.createVariable('depth', 'f4', ('node', ))
+    depth.units = 'm'
+    depth.positive = 'down'
+    depth[:] = 10. + 90. * (lon - lon.min()) / (lon.max() - lon.min())
+
+    # numbered from 1, 0 for no neighbor
+    nv = ds.createVariable('nv', 'i4', ('three', 'nele'))
+    nv.cf_role = 'face_node_connectivity'
+    nv.start_index = 1
+    nv[:] = tris.T + 1
+    nbe = ds.createVariable('nbe', 'i4', ('three', 'nele'))
+    nbe.cf_role = 'face_face_connectivity'
+    nbe.start_index = 1
+    nbe.order = 'ccw'
+    nbe[:] = neighbors(tris).T + 1
+
+    # the boundary segments: their nodes, the boundary's number and 0 for
+    # land
+    bnd = ds.createVariable('bnd', 'i4', ('nbnd', 'nbi'))
+    bnd.long_name = 'boundary segment node list'
+    bnd[:] = np.column_stack((ring + 1, np.roll(ring, -1) + 1,
+                              np.ones_like(ring), np.zeros_like(ring)))
+
+    _add_time(ds, info)
+    u_var, v_var = _add_velocity(ds, ('time', 'node'), 'lon', 'lat')
+    _write_slices(info, u_var, v_var, lon, lat)
+
+
+_writers = {'rectilinear': _write_rectilinear,
+            'curvilinear': _write_curvilinear,
+            'triangular': _write_triangular}
+
+
+def write_forcing(kind, filename, shape=(100, 100), num_times=24,
+                  bounds=DEFAULT_BOUNDS, start_time=DEFAULT_START_TIME,
+                  time_step=3600, field='gyre', speed=.5, num_levels=4,
+                  num_islands=3):
+    '''
+    Writes a current file of the analytic field
+
+    :param kind: 'rectilinear', 'curvilinear' or 'triangular'
+    :param shape: (num_rows, num_cols) of the grid, of the triangular
+        mesh's nodes
+    :param num_times: the time slices, time_step seconds apart from
+        start_time
+    :param field: one of FIELDS, of the speed in m/s
+    :param num_levels: the s-levels of a curvilinear grid
+    :param num_islands: the islands of a curvilinear grid
+
+    :returns: the dict of what the file is, for velocity(),
+        water_positions() and expected_delta()
+    '''
+    if kind not in _writers:
+        raise ValueError('{0} is not one of {1}'.format(kind, KINDS))
+    if field not in FIELDS:
+        raise ValueError('{0} is not one of {1}'.format(field, sorted(FIELDS)))
+    if min(shape) < 2 or num_times < 1:
+        raise ValueError('a grid needs 2 rows and columns and a time')
+
+    info = {'kind': kind,
+            'filename': filename,
+            'shape': tuple(shape),
+            'num_times': num_times,
+            'bounds': bounds,
+            'start_time': start_time,
+            'time_step': time_step,
+            'field': field,
+            'speed': speed,
+            'num_levels': num_levels if kind == 'curvilinear' else 1,
+            'islands': (_islands(shape, bounds, num_islands)
+                        if kind == 'curvilinear' else [])}
+
+    with nc.Dataset(filename, 'w', format='NETCDF3_64BIT') as ds:
+        ds.Conventions = ('CF-1.6, UGRID-1.0' if kind == 'triangular'
+                          else 'CF-1.6')
+        ds.title = 'synthetic {0} {1} currents'.format(kind, field)
+        ds.source = 'gnome.utilities.synthetic_forcing'
+        _writers[kind](ds, info)
+
+    return info
+
+
+def water_positions(info, num, margin=2, seed=0):
+    '''
+    (num, 3) random positions in the water of a grid, margin cells from its
+    edges and its islands
+    '''
+    ((lo_long, lo_lat), (hi_long, hi_lat)) = info['bounds']
+    num_rows, num_cols = info['shape']
+    d_long = (hi_long - lo_long) / (num_cols - 1.) * margin
+    d_lat = (hi_lat - lo_lat) / (num_rows - 1.) * margin
+
+    if info['kind'] == 'curvilinear':
+        # the turned grid is inside a smaller box, see curvilinear_points()
+        lo_long, hi_long = (lo_long + .15 * (hi_long - lo_long),
+                            hi_long - .15 * (hi_long - lo_long))
+        lo_lat, hi_lat = (lo_lat + .15 * (hi_lat - lo_lat),
+                          hi_lat - .15 * (hi_lat - lo_lat))
+
+    rs = np.random.RandomState(seed)
+    positions = np.zeros((0, 3))
+    while len(positions) < num:
+        p = np.zeros((num, 3))
+        p[:, 0] = rs.uniform(lo_long + d_long, hi_long - d_long, num)
+        p[:, 1] = rs.uniform(lo_lat + d_lat, hi_lat - d_lat, num)
+
+        near = dict(info)
+        near['islands'] = [(x, y, r + max(d_long, d_lat))
+                           for (x, y, r) in info['islands']]
+        positions = np.concatenate((positions,
+                                    p[~_on_land(near, p[:, 0], p[:, 1])]))
+
+    return positions[:num]
+
+
+def expected_delta(info, positions, model_time, time_step):
+    '''
+    the (N, 3) lon, lat and z move of the positions over a step of the
+    field, as a current mover's get_move has it
+
+    :param model_time: the time of the step, datetime
+    :param time_step: seconds
+    '''
+    seconds = date_to_sec(model_time) - date_to_sec(info['start_time'])
+    u, v = velocity(info, positions[:, 0], positions[:, 1], seconds)
+
+    meters = np.zeros((len(positions), 3))
+    meters[:, 0] = u * time_step
+    meters[:, 1] = v * time_step
+
+    return FlatEarthProjection.meters_to_lonlat(meters, positions)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) not in (3, 5, 6) or sys.argv[1] not in KINDS:
+        print __doc__
+        sys.exit(1)
+
+    args = sys.argv[1:]
+    kwargs = {}
+    if len(args) >= 4:
+        kwargs['shape'] = (int(args[2]), int(args[3]))
+    if len(args) == 5:
+        kwargs['num_times'] = int(args[4])
+
+    write_forcing(args[0], args[1], **kwargs)
@@ -0,0 +1,294 @@
+#!/usr/bin/env python
+"""
+tile_pyramid.py
+
+Multi-resolution tiles of the values on a grid's points, so a web client
+showing currents or ice downloads only the tiles in its view
+
+The tiles follow the web map (spherical mercator) scheme: zoom z has
+2**z x 2**z tiles, x counted east from the dateline and y south from the
+top. A tile is split into BINS x BINS bins, each holding the mean of the
+values of the grid points in it, quantized to int16 steps of the pyramid's
+quantum. The coarsest zoom is the last with the whole grid in one tile, the
+finest the first giving each point a bin of its own (at most MAX_ZOOM).
+
+Which bin each point falls in is worked out once for the grid, so a time
+slice costs one bincount per zoom and value. The last max_slices slices are
+kept in memory and, with a cache_dir, in .npz files that later sessions read
+instead of asking the grid again.
+"""
+import os
+import hashlib
+from collections import OrderedDict
+
+import numpy as np
+
+BINS = 16
+MAX_ZOOM = 16
+
+# web mercator stops short of the poles
+MAX_LAT = 85.0511287798
+
+
+def lon_lat(points):
+    """
+    the points as an (n, 2) float array of longitude and latitude, from the
+    (n, 2) arrays and the ('long', 'lat') records the movers give
+    """
+    points = np.asarray(points)
+    if points.dtype.names:
+        return np.column_stack((points['long'], points['lat'])).astype(np.float64)
+
+    return points.reshape(-1, 2).astype(np.float64)
+
+
+def mercator_fractions(points):
+    """
+    the positions of the points across the world map, as fractions in
+    [0, 1) from the west and from the top
+    """
+    lon = points[:, 0]
+    lat = np.radians(np.clip(points[:, 1], -MAX_LAT, MAX_LAT))
+
+    col = (lon + 180.) / 360. % 1.
+    row = (1. - np.log(np.tan(lat) + 1. / np.cos(lat)) / np.pi) / 2.
+
+    return col, np.clip(row, 0., np.nextafter(1., 0.))
+
+
+class _Level(object):
+    'the bins of one zoom that have points, in the order of their tiles'
+    def __init__(self, zoom, col, row):
+        self.zoom = zoom
+        side = 2 ** zoom * BINS
+        bin_col = np.minimum((col * side).astype(np.int64), side - 1)
+        bin_row = np.minimum((row * side).astype(np.int64), side - 1)
+
+        tile = (bin_row // BINS) * 2 ** zoom + bin_col // BINS
+        in_tile = (bin_row % BINS) * BINS + bin_col % BINS
+
+        keys, self.point_bins = np.unique(tile * BINS * BINS + in_tile,
+                                          return_inverse=True)
+        self.counts = np.bincount(self.point_bins, minlength=len(keys))
+        self.bins = (keys % (BINS * BINS)).astype(np.uint8)
+
+        tiles = keys // (BINS * BINS)
+        self.tiles, self.starts = np.unique(tiles, return_index=True)
+        self.starts = np.append(self.starts, len(keys))
+
+    @property
+    def num_bins(self):
+        return len(self.bins)
+
+    def tile_range(self, x, y):
+        'the bins of tile (x, y), an empty slice if it has no points'
+        tile = y * 2 ** self.zoom + x
+        i = np.searchsorted(self.tiles, tile)
+        if i == len(self.tiles) or self.tiles[i] != tile:
+            return slice(0, 0)
+
+        return slice(self.starts[i], self.starts[i + 1])
+
+    def quantize(self, values, quantum):
+        'the means of the values of each bin, in steps of quantum'
+        means = np.empty((self.num_bins, values.shape[1]), dtype=np.float64)
+        for c in range(values.shape[1]):
+            means[:, c] = np.bincount(self.point_bins, weights=values[:, c],
+                                      minlength=self.num_bins)
+        means /= self.counts[:, None]
+
+        return np.clip(np.round(means / quantum),
+                       -32767, 32767).astype(np.int16)
+
+
+class TilePyramid(object):
+    """
+    The tiles of the time slices of values on a fixed set of grid points.
+
+    add_slice() quantizes a slice of values, get_tile() serves a tile of a
+    slice added before, in this session or (with a cache_dir) an earlier one.
+    """
+    def __init__(self, points, quantum=0.01, max_slices=8,
+                 cache_dir=None, key=''):
+        """
+        :param points: the grid points the values are on, an (n, 2) array
+                       of longitude and latitude or ('long', 'lat') records
+        :param quantum: the value of one step of the quantized values
+        :param max_slices: how many slices to keep in memory
+        :param cache_dir: the directory to keep the slices in across
+                          sessions, None keeps them in memory only
+        :param key: what else the values depend on besides the points and
+                    the time (the source files, the scaling...), a string
+        """
+        points = lon_lat(points)
+        self.num_points = len(points)
+        self.quantum = quantum
+        self.max_slices = max_slices
+        self.cache_dir = cache_dir
+
+        self._slices = OrderedDict()
+
+        digest = hashlib.sha1(np.ascontiguousarray(points).tostring())
+        digest.update('{0} {1} {2} {3}'.format(BINS, MAX_ZOOM, quantum, key))
+        self.key = digest.hexdigest()
+
+        if self.num_points == 0:
+            self.bounds = ((0., 0.), (0., 0.))
+            self.min_zoom = self.max_zoom = 0
+            self._levels = []
+            return
+
+        self.bounds = (tuple(points.min(axis=0)), tuple(points.max(axis=0)))
+
+        col, row = mercator_fractions(points)
+        self.min_zoom = self._one_tile_zoom(col, row)
+
+        self._levels = []
+        for zoom in range(self.min_zoom, MAX_ZOOM + 1):
+            self._levels.append(_Level(zoom, col, row))
+            if self._levels[-1].num_bins == self.num_points:
+                break
+        self.max_zoom = self._levels[-1].zoom
+
+    @staticmethod
+    def _one_tile_zoom(col, row):
+        'the finest zoom with all the points in one tile'
+        zoom = 0
+        while zoom < MAX_ZOOM:
+            side = 2 ** (zoom + 1)
+            if (int(col.min() * side) != int(col.max() * side) or
+                    int(row.min() * side) != int(row.max() * side)):
+                break
+            zoom += 1
+
+        return zoom
+
+    def _cache_path(self, time):
+        return os.path.join(self.cache_dir,
+                            '{0}_{1}.npz'.format(self.key, int(time)))
+
+    def _keep(self, time, levels):
+        self._slices[time] = levels
+        while len(self._slices) > self.max_slices:
+            self._slices.popitem(last=False)
+
+    def _load(self, time):
+        'the slice from the cache directory, None if it is not there'
+        if self.cache_dir is None:
+            return None
+
+        try:
+            with np.load(self._cache_path(time)) as data:
+                levels = [data['z{0}'.format(level.zoom)]
+                          for level in self._levels]
+        except (IOError, KeyError, ValueError):
+            return None
+
+        if any(len(q) != level.num_bins
+               for q, level in zip(levels, self._levels)):
+            return None
+
+        return levels
+
+    def _save(self, time, levels):
+        'written to a temporary file first, so readers never see half of it'
+        path = self._cache_path(time)
+        tmp_path = '{0}.{1}.tmp'.format(path, os.getpid())
+
+        try:
+            if not os.path.isdir(self.cache_dir):
+                os.makedirs(self.cache_dir)
+            with open(tmp_path, 'wb') as f:
+                np.savez(f, **dict(('z{0}'.format(level.zoom), q)
+                                  for q, level in zip(levels, self._levels)))
+            if os.path.exists(path):
+                os.remove(path)
+            os.rename(tmp_path, path)
+        except (IOError, OSError):
+            # the cache only saves time, a slice that can't be kept is
+            # still served from memory
+            if os.path.exists(tmp_path):
+                os.remove(tmp_path)
+
+    def _slice(self, time):
+        time = int(time)
+        if time in self._slices:
+            self._slices[time] = self._slices.pop(time)  # the newest now
+            return self._slices[time]
+
+        levels = self._load(time)
+        if levels is not None:
+            self._keep(time, levels)
+
+        return levels
+
+    def has_slice(self, time):
+        'whether the slice is in memory or in the cache directory'
+        return self._slice(time) is not None
+
+    def add_slice(self, time, values):
+        """
+        quantizes the values of the points at time (model seconds)
+
+        :param values: an (n, k) array of the k values of each point, (u, v)
+                       for vectors
+        """
+        values = np.asarray(values, dtype=np.float64)
+        if values.ndim == 1:
+            values = values[:, None]
+        if len(values) != self.num_points:
+            raise ValueError('{0} values for {1} grid points'
+                             .format(len(values), self.num_points))
+
+        levels = [level.quantize(values, self.quantum)
+                  for level in self._levels]
+        self._keep(int(time), levels)
+        if self.cache_dir is not None:
+            self._save(int(time), levels)
+
+    def describe(self):
+        'what a client needs to ask for the tiles'
+        return {'min_zoom': self.min_zoom,
+                'max_zoom': self.max_zoom,
+                'bins': BINS,
+                'quantum': self.quantum,
+                'bounds': self.bounds,
+                'key': self.key}
+
+    def tiles_at(self, zoom):
+        'the (x, y) of the tiles of a zoom with points'
+        if zoom < self.min_zoom or zoom > self.max_zoom or not self._levels:
+            return []
+
+        tiles = self._levels[zoom - self.min_zoom].tiles
+        side = 2 ** zoom
+
+        return zip((tiles % side).tolist(), (tiles // side).tolist())
+
+    def get_tile(self, time, zoom, x, y):
+        """
+        the tile (x, y) of a zoom of the slice at time, as a dict of its
+        bins with points, numbered along the rows from the top left, and
+        their quantized values (one list per bin)
+
+        :raises KeyError: if the slice was not added
+        :raises ValueError: if the zoom is not in the pyramid (a client
+                            zoomed past max_zoom enlarges its tiles)
+        """
+        if zoom < self.min_zoom or zoom > self.max_zoom:
+            raise ValueError('zoom {0} is not in [{1}, {2}]'
+                             .format(zoom, self.min_zoom, self.max_zoom))
+
+        levels = self._slice(time)
+        if levels is None:
+            raise KeyError('no slice at {0}'.format(time))
+
+        if not self._levels:
+            return {'zoom': zoom, 'x': x, 'y': y, 'bins': [], 'values': []}
+
+        i = zoom - self.min_zoom
+        bins = self._levels[i].tile_range(x, y)
+
+        return {'zoom': zoom, 'x': x, 'y': y,
+                'bins': self._levels[i].bins[bins].tolist(),
+                'values': levels[i][bins].tolist()}
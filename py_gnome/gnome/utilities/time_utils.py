@@ -9,6 +9,10 @@ import time
 
 import numpy as np
 
+from gnome.utilities.lazy_import import lazy_module
+
+cy_helpers = lazy_module('gnome.cy_gnome.cy_helpers')
+
 
 # tzinfo classes for use with datetime.datetime
 #
@@ -96,6 +100,12 @@ def date_to_sec(date_times):
     if not isinstance(date_times[0], datetime):
         raise TypeError("date_to_sec only works on datetime and datetime64 objects")
 
+    if len(date_times) > 1 and all(dt.tzinfo is None for dt in date_times):
+        # lib_gnome converts them all in one call, with a mktime per day
+        return (cy_helpers.dates_to_seconds(np.array(date_times,
+                                                     dtype='datetime64[s]'))
+                .astype(np.uint32))
+
     t_list = []
     for dt in date_times:
         timetuple = list(dt.timetuple())
@@ -109,6 +119,33 @@ def date_to_sec(date_times):
     return np.array(t_list, dtype=np.uint32) if not scalar else t_list[0]
 
 
+def times_to_sec(times):
+    """
+    :param times: a time or a sequence of times: datetime objects,
+                  numpy.datetime64 or seconds since the epoch (integers, as
+                  date_to_sec returns them)
+    :returns: an int64 array of the time in seconds of each, as date_to_sec
+
+    The seconds are passed through as they are. The datetimes are converted
+    as date_to_sec does, without its loop over each of them: local standard
+    time has the same offset for all the times of a day, so time.mktime is
+    only called for each of their days.
+    """
+    times = np.asarray(times).reshape(-1)
+
+    if times.dtype.kind in 'iuf':
+        return times.astype(np.int64)
+
+    # the seconds of the times as if they were UTC, and the offset of their
+    # day's local standard time
+    naive = times.astype('datetime64[s]').astype(np.int64)
+    days, day_idx = np.unique(naive // 86400, return_inverse=True)
+    offsets = (date_to_sec((days * 86400).astype('datetime64[s]'))
+               .astype(np.int64) - days * 86400)
+
+    return naive + offsets[day_idx]
+
+
 # def sec_to_date(seconds):
 # old code that uses sec_to_timestruct -- broken for spring DST transition
 #     """
@@ -157,9 +194,13 @@ def sec_to_date(seconds):
     FIXME: this may be broken there!!!!!
     """
     t_array = np.asarray(seconds, dtype=np.uint32).reshape(-1)
-    d_list = [sec_to_datetime(sec) for sec in t_array]
 
-    return d_list[0] if len(d_list) == 1 else np.array(d_list, dtype='datetime64[s]')
+    if len(t_array) != 1:
+        # lib_gnome converts them all in one call, SecondsToDate does the
+        # same DST correction
+        return cy_helpers.seconds_to_datetime64(t_array)
+
+    return sec_to_datetime(t_array[0])
 
 
 def sec_to_datetime(seconds):
@@ -0,0 +1,170 @@
+#!/usr/bin/env python
+"""
+tracing.py
+
+Spans of where the time of a model run goes, saved as a Chrome trace file
+(chrome://tracing, or https://ui.perfetto.dev) -- unlike the cProfile
+decorators of profiledeco, for looking at one run step by step.
+
+Set Model.tracer to a ChromeTracer and the model adds a span for each
+stage of each step (the stages of Model.stage_times), and for each mover,
+weatherer and outputter call in them. lib_gnome built with GNOME_TIMING
+adds its timed sections: prepare_for_model_step, get_move, read_data
+(SetInterval and the time slice reads), locate and interpolate. With no
+tracer, all the model does is check that Model.tracer is None.
+
+    model.tracer = ChromeTracer('run.json')
+    model.full_run()
+"""
+import os
+import json
+import threading
+import time
+
+from gnome.cy_gnome import cy_helpers
+
+
+class _NoSpan(object):
+    """
+    the span of a model with no tracer: does nothing
+    """
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        return False
+
+
+NO_SPAN = _NoSpan()
+
+
+class _Span(object):
+    def __init__(self, tracer, name, cat, args):
+        self.tracer = tracer
+        self.name = name
+        self.cat = cat
+        self.args = args
+
+    def __enter__(self):
+        self.start = time.time()
+        return self
+
+    def __exit__(self, *args):
+        self.tracer.add_span(self.name, self.cat, self.start, time.time(),
+                             **self.args)
+        return False
+
+
+class ChromeTracer(object):
+    """
+    Collects spans as Chrome trace 'complete' events. Times are in
+    microseconds from when the tracer was made.
+
+    The spans of the model's background threads -- the output writer and
+    the forcing prefetch -- are on their own rows, as are those of each
+    lib_gnome thread.
+    """
+    def __init__(self, filename=None):
+        """
+        :param filename: the model saves the trace here at the end of each
+            run, if it is given
+        """
+        self.filename = filename
+        self.events = []
+
+        self._pid = os.getpid()
+        self._start = time.time()
+        self._native = False
+        # microseconds to add to the lib_gnome clock for ours
+        self._native_offset = 0.
+        self._dropped = 0
+        # the trace's thread numbers, by thread name
+        self._threads = {}
+
+    def _ts(self, seconds):
+        return (seconds - self._start) * 1e6
+
+    def _tid(self, thread_name):
+        if thread_name not in self._threads:
+            self._threads[thread_name] = len(self._threads)
+
+        return self._threads[thread_name]
+
+    def span(self, name, cat, **args):
+        """
+        a context manager adding a span of its body
+        """
+        return _Span(self, name, cat, args)
+
+    def add_span(self, name, cat, start, end, **args):
+        """
+        adds a span from start to end, time.time() seconds
+        """
+        tid = self._tid(threading.current_thread().name)
+        self.events.append({'name': name, 'cat': cat, 'ph': 'X',
+                            'ts': self._ts(start),
+                            'dur': (end - start) * 1e6,
+                            'pid': self._pid, 'tid': tid,
+                            'args': args})
+
+    def start(self):
+        """
+        turns on the lib_gnome section trace -- it stays off if lib_gnome
+        wasn't built with GNOME_TIMING
+        """
+        self._native = cy_helpers.set_section_tracing(True)
+        if self._native:
+            self._native_offset = (self._ts(time.time()) -
+                                   cy_helpers.section_trace_clock() / 1e3)
+
+    def collect_native(self):
+        """
+        adds the lib_gnome sections traced since the last time
+        """
+        if not self._native:
+            return
+
+        for name, start, duration, thread, num_les in \
+                cy_helpers.take_section_trace():
+            self.events.append({'name': name, 'cat': 'lib_gnome', 'ph': 'X',
+                                'ts': start / 1e3 + self._native_offset,
+                                'dur': duration / 1e3,
+                                'pid': self._pid,
+                                'tid': self._tid('lib_gnome {0}'
+                                                 .format(thread)),
+                                'args': {'num_LEs': num_les}})
+
+        self._dropped = cy_helpers.get_section_trace_dropped()
+
+    def stop(self):
+        """
+        turns off the lib_gnome section trace, and saves the trace to
+        filename if there is one
+        """
+        self.collect_native()
+        if self._native:
+            cy_helpers.set_section_tracing(False)
+            self._native = False
+
+        if self.filename is not None:
+            self.save(self.filename)
+
+    def clear(self):
+        self.events = []
+
+    def to_dict(self):
+        """
+        the Chrome trace of the events, sorted by time
+        """
+        names = [{'name': 'thread_name', 'ph': 'M', 'pid': self._pid,
+                  'tid': tid, 'args': {'name': name}}
+                 for name, tid in self._threads.items()]
+
+        return {'traceEvents': (names +
+                                sorted(self.events, key=lambda e: e['ts'])),
+                'displayTimeUnit': 'ms',
+                'otherData': {'lib_gnome_dropped_events': self._dropped}}
+
+    def save(self, filename):
+        with open(filename, 'w') as trace_file:
+            json.dump(self.to_dict(), trace_file)
@@ -1,3 +1,5 @@
+import numpy as np
+
 from monahan import Monahan
 
 
@@ -21,19 +23,23 @@ class LehrSimecek(object):
                        By Stanislaw R. Massel
         """
         Tm = Monahan.whitecap_decay_constant(salinity)
+        U = np.asarray(U, dtype=np.float64)
+
+        # below 4 m/s:
+        # linear fit from 0 to the 4m/s value from Ding and Farmer
+        # maybe should be a exponential / quadratic fit?
+        # or zero less than 3, then a sharp increase to 4m/s?
+        #
+        # above:
+        # # Ding and Farmer (JPO 1994)
+        # fw = (0.01*U + 0.01) / Tm
+        # old ADIOS had a .5 factor - not sure why but we'll keep it
+        # for now
+        fw = np.where(U < 4.0,  # m/s
+                      (0.0125 * U) / Tm,
+                      # Ding and Farmer (JPO 1994)
+                      0.5 * (0.01 * U + 0.01) / Tm)
+
+        fw = np.minimum(fw, 1.0)  # only with U > 200m/s!
 
-        if U < 4.0:  # m/s
-            # linear fit from 0 to the 4m/s value from Ding and Farmer
-            # maybe should be a exponential / quadratic fit?
-            # or zero less than 3, then a sharp increase to 4m/s?
-            fw = (0.0125 * U) / Tm
-        else:
-            # # Ding and Farmer (JPO 1994)
-            # fw = (0.01*U + 0.01) / Tm
-            # old ADIOS had a .5 factor - not sure why but we'll keep it
-            # for now
-
-            # Ding and Farmer (JPO 1994)
-            fw = 0.5 * (0.01 * U + 0.01) / Tm
-
-        return fw if fw <= 1.0 else 1.0  # only with U > 200m/s!
+        return fw if fw.ndim else fw.item()
@@ -13,6 +13,7 @@ from gnome.weatherers import Weatherer
 from gnome.utilities.serializable import Serializable, Field
 from gnome.environment.wind import WindSchema
 from gnome.environment import Waves
+from gnome.cy_gnome.cy_weatherers import remove_oil
 
 from .core import WeathererSchema
 from .. import _valid_units
@@ -96,6 +97,11 @@ class CleanUpBase(RemoveMass, Weatherer):
     Just need to add a few internal methods for Skimmer + Burn common code
     Currently defined as a base class.
     '''
+    # the fate of the LEs marked for the operation, and the mass_balance key
+    # of the mass it removes -- set by the derived classes
+    _fate = None
+    _mass_balance_key = None
+
     def __init__(self, **kwargs):
         '''
         add 'frac_water' to array_types and pass **kwargs to base class
@@ -203,6 +209,14 @@ class CleanUpBase(RemoveMass, Weatherer):
 
         sc.update_from_fatedataview(substance, 'surface_weather')
 
+    def _removal(self, substance, data, model_time):
+        '''
+        the mass in kg the operation is to remove from the LEs marked for it
+        in the sub-step at model_time, data their 'mass' and 'frac_water'.
+        Derived classes define it.
+        '''
+        raise NotImplementedError
+
     def _avg_frac_oil(self, data):
         '''
         find weighted average of frac_water array, return (1 - avg_frac_water)
@@ -229,6 +243,9 @@ class SkimmerSchema(WeathererSchema):
 
 
 class Skimmer(CleanUpBase, Serializable):
+    _fate = 'skim'
+    _mass_balance_key = 'skimmed'
+
     _state = copy.deepcopy(Weatherer._state)
     _state += [Field('amount', save=True, update=True),
                Field('units', save=True, update=True),
@@ -334,6 +351,14 @@ class Skimmer(CleanUpBase, Serializable):
 
         return rm_mass
 
+    def _removal(self, substance, data, model_time):
+        rm_amount = \
+            self._rate * self._avg_frac_oil(data) * self._timestep
+
+        return self._get_mass(substance,
+                              rm_amount,
+                              self.units) * self.efficiency
+
     def weather_elements(self, sc, time_step, model_time):
         '''
         Assumes there is only ever 1 substance being modeled!
@@ -350,11 +375,7 @@ class Skimmer(CleanUpBase, Serializable):
             if len(data['mass']) is 0:
                 continue
 
-            rm_amount = \
-                self._rate * self._avg_frac_oil(data) * self._timestep
-            rm_mass = self._get_mass(substance,
-                                     rm_amount,
-                                     self.units) * self.efficiency
+            rm_mass = self._removal(substance, data, model_time)
 
             total_mass = data['mass'].sum()
             rm_mass_frac = min(rm_mass / total_mass, 1.0)
@@ -389,6 +410,9 @@ class BurnSchema(WeathererSchema):
 
 
 class Burn(CleanUpBase, Serializable):
+    _fate = 'burn'
+    _mass_balance_key = 'burned'
+
     _schema = BurnSchema
 
     _state = copy.deepcopy(Weatherer._state)
@@ -676,6 +700,16 @@ class Burn(CleanUpBase, Serializable):
             else:
                 self.efficiency = 1 - 0.07 * ws
 
+    def _removal(self, substance, data, model_time):
+        self._set_efficiency(model_time)
+
+        # scale rate by efficiency
+        # this is volume of oil burned - need to get mass from this
+        vol_oil_burned = \
+            self._oil_vol_burnrate * self.efficiency * self._timestep
+
+        return self._get_mass(substance, vol_oil_burned, 'm^3')
+
     def weather_elements(self, sc, time_step, model_time):
         '''
         1. figure out the mass to remove for current timestep based on rate and
@@ -692,13 +726,7 @@ class Burn(CleanUpBase, Serializable):
             if len(data['mass']) is 0:
                 continue
 
-            self._set_efficiency(model_time)
-
-            # scale rate by efficiency
-            # this is volume of oil burned - need to get mass from this
-            vol_oil_burned = \
-                self._oil_vol_burnrate * self.efficiency * self._timestep
-            rm_mass = self._get_mass(substance, vol_oil_burned, 'm^3')
+            rm_mass = self._removal(substance, data, model_time)
             if rm_mass > data['mass'].sum():
                 rm_mass = data['mass'].sum()
             rm_mass_frac = rm_mass / data['mass'].sum()
@@ -755,6 +783,9 @@ class ChemicalDispersionSchema(WeathererSchema):
 
 
 class ChemicalDispersion(CleanUpBase, Serializable):
+    _fate = 'disperse'
+    _mass_balance_key = 'chem_dispersed'
+
     _state = copy.deepcopy(Weatherer._state)
     _schema = ChemicalDispersionSchema
     _state += [Field('fraction_sprayed', save=True, update=True),
@@ -866,6 +897,11 @@ class ChemicalDispersion(CleanUpBase, Serializable):
             else:
                 self.efficiency = efficiency
 
+    def _removal(self, substance, data, model_time):
+        self._set_efficiency(model_time)
+        #rm_mass = self._rate * self._timestep * self.efficiency
+        return self._rate * self._timestep # rate includes efficiency
+
     def weather_elements(self, sc, time_step, model_time):
         'for now just take away 0.1% at every step'
         if self.active and len(sc) > 0:
@@ -874,9 +910,7 @@ class ChemicalDispersion(CleanUpBase, Serializable):
                 if len(data['mass']) is 0:
                     continue
 
-                self._set_efficiency(model_time)
-                #rm_mass = self._rate * self._timestep * self.efficiency
-                rm_mass = self._rate * self._timestep # rate includes efficiency
+                rm_mass = self._removal(substance, data, model_time)
 
                 total_mass = data['mass'].sum()
                 rm_mass_frac = min(rm_mass / total_mass, 1.0)
@@ -922,3 +956,72 @@ class ChemicalDispersion(CleanUpBase, Serializable):
             _to_dict['waves'] = Waves.deserialize(json_['waves'])
 
         return _to_dict
+
+
+def weather_cleanups(cleanups, sc, substeps):
+    '''
+    weather_elements_substeps() of each of the cleanup operations in turn,
+    for Model.batch_cleanup: the mass each removes from the LEs of its fate
+    in each sub-step is found from their total, which the removals scale
+    without changing the weighted frac_water, and the mass is removed in
+    one pass over the LEs by lib_gnome's remove_mass -- instead of each
+    operation gathering, scaling and writing back its LEs each sub-step.
+
+    :param cleanups: CleanUpBase objects, in the order of the weatherers
+    :param substeps: (model_time, time_step) of each sub-step
+    '''
+    active = [c for c in cleanups if c.active]
+    if len(sc) == 0 or len(active) == 0:
+        return
+
+    fates = []
+    for c in active:
+        if c._fate not in fates:
+            fates.append(c._fate)
+
+    group = np.full((len(sc),), -1, dtype=np.int32)
+    factors = []
+
+    for substance in sc.get_substances(complete=False):
+        for fate in fates:
+            index = sc.substancefateindex(substance, fate)
+            if index is None:
+                index = slice(None)
+
+            data = {'mass': sc['mass'][index]}
+            if 'frac_water' in sc:
+                data['frac_water'] = sc['frac_water'][index]
+
+            if len(data['mass']) == 0:
+                continue
+
+            total_mass = data['mass'].sum()
+            factor = 1.0
+
+            for c in active:
+                if c._fate != fate:
+                    continue
+
+                for model_time, time_step in substeps:
+                    curr_mass = factor * total_mass
+                    if curr_mass <= 0.0:
+                        break
+
+                    rm_mass = c._removal(substance, data, model_time)
+                    rm_mass_frac = min(rm_mass / curr_mass, 1.0)
+                    factor *= (1 - rm_mass_frac)
+
+                    sc.mass_balance[c._mass_balance_key] += \
+                        rm_mass_frac * curr_mass
+                    c.logger.debug('{0} amount removed for {1}: {2}'
+                                   .format(c._pid, substance.name,
+                                           rm_mass_frac * curr_mass))
+
+            if factor < 1.0:
+                group[index] = len(factors)
+                factors.append(factor)
+
+    if len(factors) > 0:
+        remove_oil(group, factors, sc['mass_components'], sc['mass'])
+        sc.refresh_fatedataviews(('mass', 'mass_components'),
+                                 reset=min(factors) <= 0.0)
@@ -12,6 +12,7 @@ from gnome.array_types import mass_components
 from gnome.utilities.serializable import Serializable, Field
 from gnome.exceptions import ReferencedObjectNotSet
 from gnome.movers.movers import Process, ProcessSchema
+from gnome.cy_gnome.cy_weatherers import WeatheringPipeline
 
 
 class WeathererSchema(ObjType, ProcessSchema):
@@ -33,6 +34,22 @@ class Weatherer(Process):
     _state = copy.deepcopy(Process._state)
     _schema = WeathererSchema  # nothing new added so use this schema
 
+    # whether the weatherer can weather the forecast and the uncertain spill
+    # containers at the same time - see Model.concurrent_spill_containers.
+    # The ones that keep state of their own while they weather one can't
+    concurrent_safe = True
+
+    # whether the weatherer can weather the substances of a spill container
+    # at the same time, on a SubstanceSubset each - see
+    # Model.concurrent_substances. The ones that touch the elements only
+    # through itersubstancedata() and add to the mass balance can
+    substance_concurrent = False
+
+    # whether the weatherer is a stage of lib_gnome's WeatheringPipeline, so
+    # it can run with the chainable weatherers next to it in one call on
+    # each substance - see Model.chain_weatherers and weather_pipeline()
+    chainable = False
+
     def __init__(self, **kwargs):
         '''
         Base weatherer class; defines the API for all weatherers
@@ -89,6 +106,33 @@ class Weatherer(Process):
         '''
         pass
 
+    def weather_elements_substeps(self, sc, substeps):
+        '''
+        weather_elements() over each of the (model_time, time_step) sub-steps
+        of a model step in turn. Weatherers that can do the sub-steps in
+        one pass override it.
+        '''
+        for model_time, time_step in substeps:
+            self.weather_elements(sc, time_step, model_time)
+
+    def add_pipeline_stage(self, pipeline, substance, substeps):
+        '''
+        for the chainable weatherers: adds the weatherer's stage for the
+        substance to the WeatheringPipeline, with its values at each of the
+        (model_time, time_step) substeps
+
+        :returns: False if the substance doesn't weather here
+        '''
+        return False
+
+    def pipeline_stage_done(self, sc, substance, data, totals):
+        '''
+        for the chainable weatherers: after the pipeline has run on the
+        substance's data, with the totals of the weatherer's stage, adds
+        them to sc.mass_balance
+        '''
+        pass
+
     def _halflife(self, M_0, factors, time):
         'Assumes our factors are half-life values'
         half = np.float64(0.5)
@@ -117,6 +161,8 @@ class HalfLifeWeatherer(Weatherer, Serializable):
     _state = copy.deepcopy(Weatherer._state)
     _state += Field('half_lives', save=True, update=True)
 
+    substance_concurrent = True
+
     def __init__(self, half_lives=(15.*60, ), **kwargs):
         '''
         The half_lives are a property of HalfLifeWeatherer. If the
@@ -158,6 +204,43 @@ class HalfLifeWeatherer(Weatherer, Serializable):
             hl = self._halflife(data['mass_components'],
                                 self.half_lives, time_step)
             data['mass_components'][:] = hl
-            data['mass'][:] = data['mass_components'].sum(1)
+            data['mass_components'].sum(1, out=data['mass'])
 
         sc.update_from_fatedataview()
+
+
+def weather_pipeline(weatherers, sc, substeps):
+    '''
+    weather_elements_substeps() of each of the chainable weatherers in
+    turn, for Model.chain_weatherers: their stages run on each substance's
+    data in one call to lib_gnome's WeatheringPipeline, each over all the
+    sub-steps before the next as the model runs them -- instead of each
+    weatherer getting, working on and writing back the substance's data.
+
+    :param weatherers: chainable weatherers, in the order of the model's
+    :param substeps: (model_time, time_step) of each sub-step
+    '''
+    active = [w for w in weatherers if w.active]
+    if sc.num_released == 0 or len(active) == 0:
+        return
+
+    array_types = set()
+    for w in active:
+        array_types.update(w.array_types)
+
+    step_lens = [time_step for _model_time, time_step in substeps]
+    pipeline = WeatheringPipeline()
+
+    for substance, data in sc.itersubstancedata(array_types):
+        if len(data['mass']) == 0:
+            continue
+
+        pipeline.clear()
+        staged = [w for w in active
+                  if w.add_pipeline_stage(pipeline, substance, substeps)]
+        totals = pipeline.run(step_lens, data)
+
+        for w, stage_totals in zip(staged, totals):
+            w.pipeline_stage_done(sc, substance, data, stage_totals)
+
+    sc.update_from_fatedataview()
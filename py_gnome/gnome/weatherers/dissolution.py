@@ -9,6 +9,7 @@ import numpy as np
 import gnome  # required by deserialize
 
 from gnome.utilities.serializable import Serializable, Field
+from gnome.cy_gnome.cy_weatherers import WeatheringWorkspace
 from gnome.utilities.weathering import (LeeHuibers, Stokes,
                                         DingFarmer, DelvigneSweeney,
                                         PiersonMoskowitz)
@@ -31,6 +32,9 @@ class Dissolution(Weatherer, Serializable):
     _state = copy.deepcopy(Weatherer._state)
     _state += [Field('waves', save=True, update=True, save_reference=True)]
 
+    # the spill containers share the one workspace
+    concurrent_safe = False
+
     _schema = WeathererSchema
 
     def __init__(self, waves=None, **kwargs):
@@ -50,6 +54,9 @@ class Dissolution(Weatherer, Serializable):
                                  'droplet_avg_size': droplet_avg_size
                                  })
 
+        # lib_gnome's arrays for the step, made on the first step
+        self._workspace = None
+
     def prepare_for_model_run(self, sc):
         '''
             Add dissolution key to mass_balance if it doesn't exist.
@@ -194,6 +201,49 @@ class Dissolution(Weatherer, Serializable):
 
         return total_mass_dissolved
 
+    def dissolve_oil_kernel(self, data, substance, model_time, time_step):
+        '''
+            dissolve_oil() in lib_gnome: the mass transfer of each LE is
+            done in the weathering workspace, in place in 'mass_components'
+            and 'mass'. The waves and wind are worked out here, once for the
+            step, as are the partition coefficients of the components.
+
+            Returns the mass dissolved
+        '''
+        if self._workspace is None:
+            self._workspace = WeatheringWorkspace()
+
+        arom_mask = substance._sara['type'] == 'Aromatics'
+        mol_wt = substance.molecular_weight
+        rho = substance.component_density
+
+        K_ow_comp = arom_mask * LeeHuibers.partition_coeff(mol_wt, rho)
+
+        wind_speed = max(.1, self.waves.wind.get_value(model_time)[0])
+        wave_height = self.waves.get_value(model_time)[0]
+        wave_period = PiersonMoskowitz.peak_wave_period(wind_speed)
+        f_bw = DelvigneSweeney.breaking_waves_frac(wind_speed, wave_period)
+
+        names = ('mass_components', 'mass', 'partition_coeff')
+        arrays = [np.ascontiguousarray(data[name], dtype=np.float64)
+                  for name in names]
+
+        dissolved = self._workspace.dissolve(time_step,
+                                             arrays[0], arrays[1],
+                                             data['area'],
+                                             data['droplet_avg_size'],
+                                             arrays[2],
+                                             K_ow_comp, mol_wt, rho,
+                                             self.waves.water.get('density'),
+                                             wave_height, wave_period, f_bw,
+                                             wind_speed)
+
+        for name, array in zip(names, arrays):
+            if array is not data[name]:
+                data[name][:] = array
+
+        return dissolved
+
     def oil_avg_density(self, masses, densities):
         # oil component count needs to match
         assert masses.shape[-1] == densities.shape[-1]
@@ -347,17 +397,11 @@ class Dissolution(Weatherer, Serializable):
                 # data does not contain any surface_weathering LEs
                 continue
 
-            diss = self.dissolve_oil(model_time=model_time,
-                                     time_step=time_step,
-                                     data=data,
-                                     substance=substance)
-
             # TODO: We should probably only modify the floating LEs
-            data['mass_components'] -= diss
-
-            sc.mass_balance['dissolution'] += diss.sum()
+            diss = self.dissolve_oil_kernel(data, substance,
+                                            model_time, time_step)
 
-            data['mass'] = data['mass_components'].sum(1)
+            sc.mass_balance['dissolution'] += diss
 
             self.logger.debug('{0} Amount dissolved for {1}: {2}'
                               .format(self._pid,
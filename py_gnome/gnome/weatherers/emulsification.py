@@ -19,6 +19,7 @@ from gnome import constants
 from .core import WeathererSchema
 from gnome.weatherers import Weatherer
 from gnome.cy_gnome.cy_weatherers import emulsify_oil
+from gnome.utilities.scratch import scratch_empty
 from gnome.persist import class_from_objtype
 
 
@@ -27,6 +28,8 @@ class Emulsification(Weatherer, Serializable):
     _state += [Field('waves', save=True, update=True, save_reference=True)]
     _schema = WeathererSchema
 
+    chainable = True
+
     def __init__(self,
                  waves=None,
                  **kwargs):
@@ -123,9 +126,7 @@ class Emulsification(Weatherer, Serializable):
             # just average the water fraction each time - it is not per time
             # step value but at a certain time value
             # todo: probably should be weighted avg
-            if data['mass'].sum() > 0:
-                sc.mass_balance['water_content'] = \
-                    np.sum(data['mass']/data['mass'].sum() * data['frac_water'])
+            self._set_water_content(sc, data)
 
             self.logger.debug(self._pid + 'water_content for {0}: {1}'.
                               format(substance.name,
@@ -133,6 +134,42 @@ class Emulsification(Weatherer, Serializable):
 
         sc.update_from_fatedataview()
 
+    def add_pipeline_stage(self, pipeline, substance, substeps):
+        '''
+        the emulsify() of weather_elements() at each sub-step
+        '''
+        # max water content fraction - get from database
+        Y_max = substance.get('emulsion_water_fraction_max')
+
+        # doesn't emulsify, avoid the nans
+        if Y_max <= 0:
+            return False
+        S_max = (6. / constants.drop_min) * (Y_max / (1.0 - Y_max))
+
+        k_emul = [self._water_uptake_coeff(model_time, substance)
+                  for model_time, _time_step in substeps]
+
+        pipeline.add_emulsification(k_emul, substance.bulltime,
+                                    substance.bullwinkle, S_max, Y_max,
+                                    constants.drop_max)
+        return True
+
+    def pipeline_stage_done(self, sc, substance, data, totals):
+        self._set_water_content(sc, data)
+
+        self.logger.debug(self._pid + 'water_content for {0}: {1}'.
+                          format(substance.name,
+                                 sc.mass_balance['water_content']))
+
+    def _set_water_content(self, sc, data):
+        'the mass weighted frac_water, in a scratch array of sc'
+        total = data['mass'].sum()
+        if total > 0:
+            weighted = scratch_empty(sc, len(data['mass']))
+            np.divide(data['mass'], total, out=weighted)
+            weighted *= data['frac_water']
+            sc.mass_balance['water_content'] = weighted.sum()
+
     def serialize(self, json_='webapi'):
         """
         Since 'wind'/'waves' property is saved as references in save file
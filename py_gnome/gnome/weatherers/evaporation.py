@@ -9,6 +9,7 @@ from gnome import constants
 from gnome.basic_types import oil_status
 from gnome.utilities.serializable import Serializable, Field
 from gnome.exceptions import ReferencedObjectNotSet
+from gnome.cy_gnome.cy_weatherers import evaporate_oil
 
 from .core import WeathererSchema
 from gnome.weatherers import Weatherer
@@ -22,6 +23,14 @@ class Evaporation(Weatherer, Serializable):
                Field('wind', save=True, update=True, save_reference=True)]
     _schema = WeathererSchema
 
+    # the decay constants of _set_evap_decay_constant() are computed and
+    # applied in lib_gnome's evaporate(); subclasses with decay constants
+    # of their own turn this off
+    _use_kernel = True
+
+    substance_concurrent = True
+    chainable = True
+
     def __init__(self,
                  water=None,
                  wind=None,
@@ -160,6 +169,10 @@ class Evaporation(Weatherer, Serializable):
         L becomes::
             L = (1 - fw) * area * K * vp/(gas_constant * water_temp * sum_m_mw)
         '''
+        if self._use_kernel:
+            self.weather_elements_substeps(sc, [(model_time, time_step)])
+            return
+
         if not self.active:
             return
         if sc.num_released == 0:
@@ -189,9 +202,92 @@ class Evaporation(Weatherer, Serializable):
             data['mass'][:] = data['mass_components'].sum(1)
 
             # add frac_lost
-            data['frac_lost'][:] = 1 - data['mass']/data['init_mass']
+            np.divide(data['mass'], data['init_mass'], out=data['frac_lost'])
+            np.subtract(1, data['frac_lost'], out=data['frac_lost'])
         sc.update_from_fatedataview()
 
+    def weather_elements_substeps(self, sc, substeps):
+        '''
+        weather_elements() over the (model_time, time_step) sub-steps of a
+        model step, in one call to lib_gnome's evaporate() for each
+        substance: the components of each element decay sub-step by
+        sub-step, with the decay constants of each sub-step worked out from
+        its masses and the wind at its time, in place in 'mass_components'.
+        '''
+        if not self._use_kernel:
+            return super(Evaporation, self).weather_elements_substeps(sc,
+                                                                      substeps)
+
+        if not self.active:
+            return
+        if sc.num_released == 0:
+            return
+
+        step_lens = [time_step for _model_time, time_step in substeps]
+        mass_transport = [self._mass_transport_coeff(model_time)
+                          for model_time, _time_step in substeps]
+        water_temp = self.water.get('temperature', 'K')
+
+        for substance, data in sc.itersubstancedata(self.array_types):
+            if len(data['mass']) is 0:
+                continue
+
+            vp = substance.vapor_pressure(water_temp)
+            # evaporation expects mw in kg/mol, database is in g/mol
+            mw = substance.molecular_weight / 1000.
+
+            # frac_water content in emulsion is per element but is
+            # currently not being set by anything
+            frac_water = data['frac_water'] if 'frac_water' in data else None
+
+            # evaporate() works on the arrays in place
+            names = ('mass_components', 'mass', 'evap_decay_constant')
+            arrays = [np.ascontiguousarray(data[name], dtype=np.float64)
+                      for name in names]
+
+            evaporated = evaporate_oil(step_lens, mass_transport,
+                                       arrays[0], arrays[1], arrays[2],
+                                       np.ascontiguousarray(data['area'],
+                                                            dtype=np.float64),
+                                       frac_water, vp, mw, water_temp,
+                                       constants.gas_constant)
+
+            for name, array in zip(names, arrays):
+                if array is not data[name]:
+                    data[name][:] = array
+
+            sc.mass_balance['evaporated'] += evaporated
+
+            # log amount evaporated at each step
+            self.logger.debug(self._pid + 'amount evaporated for {0}: {1}'.
+                              format(substance.name, evaporated))
+
+            # add frac_lost
+            np.divide(data['mass'], data['init_mass'], out=data['frac_lost'])
+            np.subtract(1, data['frac_lost'], out=data['frac_lost'])
+        sc.update_from_fatedataview()
+
+    def add_pipeline_stage(self, pipeline, substance, substeps):
+        '''
+        the evaporate() of weather_elements_substeps(), then frac_lost
+        '''
+        water_temp = self.water.get('temperature', 'K')
+        mass_transport = [self._mass_transport_coeff(model_time)
+                          for model_time, _time_step in substeps]
+
+        # evaporation expects mw in kg/mol, database is in g/mol
+        pipeline.add_evaporation(mass_transport,
+                                 substance.vapor_pressure(water_temp),
+                                 substance.molecular_weight / 1000.,
+                                 water_temp, constants.gas_constant)
+        return True
+
+    def pipeline_stage_done(self, sc, substance, data, totals):
+        sc.mass_balance['evaporated'] += totals[0]
+
+        self.logger.debug(self._pid + 'amount evaporated for {0}: {1}'.
+                          format(substance.name, totals[0]))
+
     def serialize(self, json_='webapi'):
         """
         Since 'wind'/'water' property is saved as references in save file
@@ -233,6 +329,9 @@ class BlobEvaporation(Evaporation):
     See documentation in source code:
         gnome/documentation/evaporation/blob_evap.ipynb
     '''
+    _use_kernel = False
+    chainable = False
+
     def _set_evap_decay_constant(self, model_time, data, substance, time_step):
         '''
         testing - for now assume only one spill and instantaneous spill
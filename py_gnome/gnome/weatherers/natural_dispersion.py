@@ -10,7 +10,7 @@ import numpy as np
 import gnome    # required by deserialize
 
 from gnome import constants
-from gnome.cy_gnome.cy_weatherers import disperse_oil
+from gnome.cy_gnome.cy_weatherers import WeatheringWorkspace
 from gnome.array_types import (viscosity,
                                mass,
                                density,
@@ -30,6 +30,10 @@ class NaturalDispersion(Weatherer, Serializable):
     _state = copy.deepcopy(Weatherer._state)
     _state += [Field('water', save=True, update=True, save_reference=True),
                Field('waves', save=True, update=True, save_reference=True)]
+
+    # the spill containers share the one workspace
+    concurrent_safe = False
+    chainable = True
     _schema = WeathererSchema
 
     def __init__(self,
@@ -53,6 +57,9 @@ class NaturalDispersion(Weatherer, Serializable):
                                  'droplet_avg_size': droplet_avg_size,
                                  })
 
+        # lib_gnome's arrays for the step, made on the first step
+        self._workspace = None
+
     def prepare_for_model_run(self, sc):
         '''
         add dispersion and sedimentation keys to mass_balance
@@ -108,53 +115,54 @@ class NaturalDispersion(Weatherer, Serializable):
             V_entrain = constants.volume_entrained
             ka = constants.ka  # oil sticking term
 
-            disp = np.zeros((len(data['mass'])), dtype=np.float64)
-            sed = np.zeros((len(data['mass'])), dtype=np.float64)
-            droplet_avg_size = data['droplet_avg_size']
-
-            disperse_oil(time_step,
-                         data['frac_water'],
-                         data['mass'],
-                         data['viscosity'],
-                         data['density'],
-                         data['fay_area'],
-                         disp,
-                         sed,
-                         droplet_avg_size,
-                         frac_breaking_waves,
-                         disp_wave_energy,
-                         wave_height,
-                         visc_w,
-                         rho_w,
-                         sediment,
-                         V_entrain,
-                         ka)
-
-            sc.mass_balance['natural_dispersion'] += np.sum(disp[:])
+            if self._workspace is None:
+                self._workspace = WeatheringWorkspace()
+
+            # the dispersed and sedimented mass of each LE are kept in the
+            # workspace: only the totals are needed here
+            droplet_avg_size = np.ascontiguousarray(data['droplet_avg_size'],
+                                                    dtype=np.float64)
+            disp, sed = self._workspace.disperse(time_step,
+                                                 data['frac_water'],
+                                                 data['mass'],
+                                                 data['viscosity'],
+                                                 data['density'],
+                                                 data['fay_area'],
+                                                 droplet_avg_size,
+                                                 frac_breaking_waves,
+                                                 disp_wave_energy,
+                                                 wave_height,
+                                                 visc_w,
+                                                 rho_w,
+                                                 sediment,
+                                                 V_entrain,
+                                                 ka)
+            if droplet_avg_size is not data['droplet_avg_size']:
+                data['droplet_avg_size'][:] = droplet_avg_size
+
+            sc.mass_balance['natural_dispersion'] += disp
 
             if data['mass'].sum() > 0:
-                disp_mass_frac = np.sum(disp[:]) / data['mass'].sum()
+                disp_mass_frac = disp / data['mass'].sum()
                 if disp_mass_frac > 1:
                     disp_mass_frac = 1
             else:
                 disp_mass_frac = 0
 
-            data['mass_components'] = ((1 - disp_mass_frac) *
-                                       data['mass_components'])
-            data['mass'] = data['mass_components'].sum(1)
+            data['mass_components'] *= (1 - disp_mass_frac)
+            data['mass_components'].sum(1, out=data['mass'])
 
-            sc.mass_balance['sedimentation'] += np.sum(sed[:])
+            sc.mass_balance['sedimentation'] += sed
 
             if data['mass'].sum() > 0:
-                sed_mass_frac = np.sum(sed[:]) / data['mass'].sum()
+                sed_mass_frac = sed / data['mass'].sum()
                 if sed_mass_frac > 1:
                     sed_mass_frac = 1
             else:
                 sed_mass_frac = 0
 
-            data['mass_components'] = ((1 - sed_mass_frac) *
-                                       data['mass_components'])
-            data['mass'] = data['mass_components'].sum(1)
+            data['mass_components'] *= (1 - sed_mass_frac)
+            data['mass_components'].sum(1, out=data['mass'])
 
             self.logger.debug('{0} Amount Dispersed for {1}: {2}'
                               .format(self._pid,
@@ -163,6 +171,34 @@ class NaturalDispersion(Weatherer, Serializable):
 
         sc.update_from_fatedataview()
 
+    def add_pipeline_stage(self, pipeline, substance, substeps):
+        '''
+        the disperse() of weather_elements() at each sub-step, the dispersed
+        then the sedimented mass taken out of the components
+        '''
+        waves = [self.waves.get_value(model_time)
+                 for model_time, _time_step in substeps]
+
+        pipeline.add_dispersion([w[2] for w in waves],
+                                [w[3] for w in waves],
+                                [w[0] for w in waves],
+                                self.waves.water.kinematic_viscosity,
+                                self.waves.water.density,
+                                self.waves.water.get('sediment',
+                                                     unit='kg/m^3'),
+                                constants.volume_entrained,
+                                constants.ka)
+        return True
+
+    def pipeline_stage_done(self, sc, substance, data, totals):
+        sc.mass_balance['natural_dispersion'] += totals[0]
+        sc.mass_balance['sedimentation'] += totals[1]
+
+        self.logger.debug('{0} Amount Dispersed for {1}: {2}'
+                          .format(self._pid,
+                                  substance.name,
+                                  sc.mass_balance['natural_dispersion']))
+
     def disperse_oil(self, time_step,
                      frac_water,
                      mass,
@@ -14,6 +14,7 @@ from gnome.constants import gravity
 from gnome import constants
 from .core import Weatherer
 from gnome.exceptions import GnomeRuntimeError
+from gnome.cy_gnome.cy_weatherers import spread_oil, langmuir_oil
 
 from .core import WeathererSchema
 
@@ -49,13 +50,17 @@ class FayGravityViscous(Weatherer, Serializable):
         # can be set
         self.water = water
         self.array_types.update({'fay_area', 'area', 'spill_num',
-                                 'bulk_init_volume', 'age', 'density'})
+                                 'bulk_init_volume', 'age', 'density',
+                                 'blob_num'})
         # relative_buoyancy - use density at release time. For now
         # temperature is fixed so just compute once and store. When temperature
         # varies over time, may want to do something different
         self._init_relative_buoyancy = None
         self.thickness_limit = None
 
+        # the number of the next blob of LEs released
+        self._next_blob = 0
+
     @lru_cache(4)
     def _gravity_spreading_t0(self,
                               water_viscosity,
@@ -259,6 +264,7 @@ class FayGravityViscous(Weatherer, Serializable):
         # reset _init_relative_buoyancy for every run
         # make it None so no stale data
         self._init_relative_buoyancy = None
+        self._next_blob = 0
 
     def _set_init_relative_buoyancy(self, substance):
         '''
@@ -323,6 +329,8 @@ class FayGravityViscous(Weatherer, Serializable):
 
                 data['fay_area'][s_mask] = init_blob_area / num
                 data['area'][s_mask] = init_blob_area / num
+                data['blob_num'][s_mask] = self._next_blob
+                self._next_blob += 1
 
         sc.update_from_fatedataview()
 
@@ -341,19 +349,47 @@ class FayGravityViscous(Weatherer, Serializable):
             if len(data['fay_area']) == 0:
                 continue
 
-            for s_num in np.unique(data['spill_num']):
-                s_mask = data['spill_num'] == s_num
-                data['fay_area'][s_mask] = \
-                    self.update_area(water_kvis,
-                                     self._init_relative_buoyancy,
-                                     data['bulk_init_volume'][s_mask],
-                                     data['fay_area'][s_mask],
-                                     data['age'][s_mask] + time_step)
-
-                data['area'][s_mask] = data['fay_area'][s_mask]
+            # all the blobs in one pass, in place in 'fay_area'
+            fay_area = np.ascontiguousarray(data['fay_area'],
+                                            dtype=np.float64)
+            area = np.ascontiguousarray(data['area'], dtype=np.float64)
+
+            spread_oil(self._blob_numbers(data), data['age'],
+                       int(time_step),
+                       data['bulk_init_volume'],
+                       fay_area, area,
+                       water_kvis,
+                       self._init_relative_buoyancy,
+                       self.thickness_limit,
+                       self.spreading_const,
+                       constants.gravity)
+
+            if fay_area is not data['fay_area']:
+                data['fay_area'][:] = fay_area
+            if area is not data['area']:
+                data['area'][:] = area
 
         sc.update_from_fatedataview()
 
+    def _blob_numbers(self, data):
+        '''
+        the 'blob_num' array, with the LEs not yet in a blob -- those not
+        released through initialize_data() -- put in one by spill and age,
+        as update_area() does
+        '''
+        blob = data['blob_num']
+        new = blob < 0
+
+        if np.any(new):
+            age = data['age'][new].astype(np.int64)
+            keys = (data['spill_num'][new].astype(np.int64) *
+                    (age.max() + 1) + age)
+            _, inverse = np.unique(keys, return_inverse=True)
+            blob[new] = self._next_blob + inverse
+            self._next_blob += inverse.max() + 1
+
+        return blob
+
     def serialize(self, json_="webapi"):
         toserial = self.to_serialize(json_)
         schema = self.__class__._schema()
@@ -497,27 +533,29 @@ class Langmuir(Weatherer, Serializable):
             return
 
         rho_h2o = self.water.get('density', 'kg/m^3')
+        v_max = self.wind.get_value(model_time)[0] * 0.005
+
         for _, data in sc.itersubstancedata(self.array_types):
-            for s_num in np.unique(data['spill_num']):
-                s_mask = data['spill_num'] == s_num
-                # thickness for blob of oil released together - need per spill
-                # Use the 'bulk_init_volume' and the 'fay_area' of the
-                # blob of oil. Each LE used to model the blob will have the
-                # same thickness. In order to get the 'fay_area' for the blob
-                # of oil released at same time, from same spill, sum
-                # the 'fay_area' array for elements that belong to same oil
-                # blob.
-                thickness = (data['bulk_init_volume'][s_mask][0] /
-                             data['fay_area'][s_mask].sum())
-
-                # assume only one type of oil is modeled so thickness_limit is
-                # already set and constant for all
-                rel_buoy = (rho_h2o - data['density'][s_mask]) / rho_h2o
-                data['frac_coverage'][s_mask] = \
-                    self._get_frac_coverage(model_time, rel_buoy, thickness)
-
-            # update 'area'
-            data['area'][:] = data['fay_area'] * data['frac_coverage']
+            # thickness for blob of oil released together - need per spill
+            # Use the 'bulk_init_volume' and the 'fay_area' of the
+            # blob of oil. Each LE used to model the blob will have the
+            # same thickness. In order to get the 'fay_area' for the blob
+            # of oil released at same time, from same spill, sum
+            # the 'fay_area' array for elements that belong to same oil
+            # blob. All the spills are done in one pass, as is 'area'
+            frac_coverage = np.ascontiguousarray(data['frac_coverage'],
+                                                 dtype=np.float64)
+            area = np.ascontiguousarray(data['area'], dtype=np.float64)
+
+            langmuir_oil(data['spill_num'], data['bulk_init_volume'],
+                         data['fay_area'], data['density'],
+                         frac_coverage, area,
+                         v_max, rho_h2o, gravity)
+
+            if frac_coverage is not data['frac_coverage']:
+                data['frac_coverage'][:] = frac_coverage
+            if area is not data['area']:
+                data['area'][:] = area
 
         sc.update_from_fatedataview()
 
@@ -18,6 +18,7 @@ import gnome    # required by deserialize
 
 from gnome.basic_types import oil_status, fate
 from gnome.utilities.serializable import Serializable, Field
+from gnome.utilities.scratch import scratch_empty
 
 from .core import Weatherer, WeathererSchema
 
@@ -133,17 +134,30 @@ class WeatheringData(Weatherer, Serializable):
             # mass_components are zero padded for substance which has fewer
             # psuedocomponents. Subselecting mass_components array by
             # [mask, :substance.num_components] ensures numpy operations work
-            mass_frac = \
-                (data['mass_components'][:, :substance.num_components] /
-                 data['mass'].reshape(len(data['mass']), -1))
+            #
+            # the temporaries are the spill container's scratch arrays, and
+            # the results are worked out in place in the data - which may
+            # be views of the SC's arrays - in the order of the expressions
+            #   oil_rho = k_rho * (component_density * mass_frac).sum(1)
+            #   density = frac_water * water_rho + (1 - frac_water) * oil_rho
+            num = len(data['mass'])
+            mass_frac = scratch_empty(sc, (num, substance.num_components))
+            np.divide(data['mass_components'][:, :substance.num_components],
+                      data['mass'].reshape(num, -1), out=mass_frac)
 
             # check if density becomes > water, set it equal to water in this
             # case - 'density' is for the oil-water emulsion
-            oil_rho = k_rho*(substance.component_density * mass_frac).sum(1)
+            oil_rho = scratch_empty(sc, num)
+            np.multiply(mass_frac, substance.component_density, out=mass_frac)
+            mass_frac.sum(1, out=oil_rho)
+            oil_rho *= k_rho
 
             # oil/water emulsion density
-            new_rho = (data['frac_water'] * water_rho +
-                       (1 - data['frac_water']) * oil_rho)
+            new_rho = data['density']
+            np.subtract(1, data['frac_water'], out=new_rho)
+            new_rho *= oil_rho
+            np.multiply(data['frac_water'], water_rho, out=oil_rho)
+            np.add(oil_rho, new_rho, out=new_rho)
 
             if np.any(new_rho > self.water.density):
                 new_rho[new_rho > self.water.density] = self.water.density
@@ -151,20 +165,26 @@ class WeatheringData(Weatherer, Serializable):
                                  'than water density - set to water density'
                                  .format(self._pid))
 
-            data['density'] = new_rho
-
-            # following implementation results in an extra array called
-            # fw_d_fref but is easy to read
+            #   viscosity = (v0 * exp(kv1 * frac_lost) *
+            #                (1 + fw_d_fref / (1.187 - fw_d_fref)) ** 2.49)
             v0 = substance.get_viscosity(self.water.get('temperature', 'K'))
 
             if v0 is not None:
                 kv1 = self._get_kv1_weathering_visc_update(v0)
-                fw_d_fref = data['frac_water']/self.visc_f_ref
+                fw_d_fref = scratch_empty(sc, num)
+                np.divide(data['frac_water'], self.visc_f_ref, out=fw_d_fref)
+
+                emul = scratch_empty(sc, num)
+                np.subtract(1.187, fw_d_fref, out=emul)
+                np.divide(fw_d_fref, emul, out=emul)
+                emul += 1
+                np.power(emul, 2.49, out=emul)
 
-                data['viscosity'] = (v0 *
-                                     np.exp(kv1 * data['frac_lost']) *
-                                     (1 + (fw_d_fref / (1.187 - fw_d_fref))) ** 2.49
-                                     )
+                visc = data['viscosity']
+                np.multiply(kv1, data['frac_lost'], out=visc)
+                np.exp(visc, out=visc)
+                np.multiply(v0, visc, out=visc)
+                visc *= emul
 
         sc.update_from_fatedataview(fate='all')
 
@@ -206,10 +226,15 @@ class WeatheringData(Weatherer, Serializable):
                                         {'mass', 'density', 'viscosity'})
 
             if data['mass'].sum() > 0.0:
+                weights = scratch_empty(sc, len(data['mass']))
+                weighted = scratch_empty(sc, len(data['mass']))
+
+                np.divide(data['mass'], data['mass'].sum(), out=weights)
                 sc.mass_balance['avg_density'] = \
-                    np.sum(data['mass']/data['mass'].sum() * data['density'])
+                    np.multiply(weights, data['density'], out=weighted).sum()
                 sc.mass_balance['avg_viscosity'] = \
-                    np.sum(data['mass']/data['mass'].sum() * data['viscosity'])
+                    np.multiply(weights, data['viscosity'],
+                                out=weighted).sum()
             else:
                 self.logger.info("{0} sum of 'mass' array went to 0.0"
                                  .format(self._pid))
@@ -18,9 +18,10 @@ import sys
 import sysconfig
 import glob
 import shutil
+import subprocess
 
 # to support "develop" mode:
-from setuptools import setup, find_packages
+from setuptools import setup, find_packages, Command
 from distutils.command.clean import clean
 
 from distutils.extension import Extension
@@ -81,6 +82,7 @@ class cleanall(clean):
     def clean_cython_files(self):
         # clean remaining cython/cpp files
         paths = [os.path.join(SETUP_PATH, 'gnome', 'cy_gnome'),
+                 os.path.join(SETUP_PATH, 'gnome', 'utilities'),
                  os.path.join(SETUP_PATH, 'gnome', 'utilities', 'geometry')]
         exts = ['*.so', 'cy_*.pyd', 'cy_*.cpp', 'cy_*.c']
 
@@ -112,6 +114,57 @@ class cleanall(clean):
                   .format(filepath, err))
             # raise
 
+
+class build_bench(Command):
+    description = ("builds the lib_gnome micro benchmarks into "
+                   "build/bench/gnome_bench")
+
+    user_options = []
+
+    def initialize_options(self):
+        pass
+
+    def finalize_options(self):
+        pass
+
+    def run(self):
+        from distutils.ccompiler import new_compiler
+        from distutils.sysconfig import customize_compiler
+
+        compiler = new_compiler()
+        customize_compiler(compiler)
+
+        bench_dir = os.path.join('build', 'bench')
+        sources = cpp_files + [os.path.join(cpp_code_dir, 'bench',
+                                            'GnomeBench.cpp')]
+
+        args = list(compile_args) + openmp_args
+        link = list(openmp_args)
+        libraries = []
+        objects = []
+        if sys.platform == 'win32':
+            libraries = ['netcdf']
+        elif sys.platform == 'darwin':
+            args.append('-std=c++11')  # std::chrono
+            objects = netcdf_lib_files
+            link += ['-lz', '-lcurl']
+        else:
+            args.append('-std=c++11')
+            libraries = ['netcdf']
+
+        objs = compiler.compile(sources,
+                                output_dir=os.path.join(bench_dir, 'obj'),
+                                macros=macros,
+                                include_dirs=include_dirs,
+                                extra_postargs=args)
+        compiler.link_executable(objs + objects + cuda_objects, 'gnome_bench',
+                                 output_dir=bench_dir,
+                                 libraries=libraries + cuda_libs,
+                                 library_dirs=[netcdf_libs] + cuda_libdirs,
+                                 extra_postargs=link,
+                                 target_lang='c++')
+
+
 # setup our environment and architecture
 # These should be properties that are used by all Extensions
 libfile = ''
@@ -195,6 +248,18 @@ if sys.platform is "darwin" or "win32":
                         for l in netcdf_names]
 
 
+# OpenMP is opt-in: set GNOME_OPENMP=1 to build the parallel get_move loops
+# in lib_gnome, the parallel land check in cy_land_check and the
+# PolygonIndex point location in cy_point_in_polygon, the chunked
+# filescanner.scan_buffer and the tiled drawing in cy_rasterize. Without it
+# the loops compile to the serial versions.
+openmp_args = []
+if os.environ.get('GNOME_OPENMP', '0') not in ('', '0'):
+    if sys.platform == 'win32':
+        openmp_args = ['/openmp']
+    else:
+        openmp_args = ['-fopenmp']
+
 # the cython extensions to build -- each should correspond to a *.pyx file
 extension_names = ['cy_mover',
                    'cy_helpers',
@@ -217,15 +282,21 @@ extension_names = ['cy_mover',
                    'cy_grid',
                    'cy_grid_rect',
                    'cy_grid_curv',
-                   'cy_weatherers'
+                   'cy_grid_locator',
+                   'cy_grid_integrator',
+                   'cy_concentration_grid',
+                   'cy_weatherers',
+                   'cy_projections'
                    ]
 
 cpp_files = ['RectGridVeL_c.cpp',
              'MemUtils.cpp',
              'Mover_c.cpp',
+             'TransportDriver.cpp',
              'Replacements.cpp',
              'ClassID_c.cpp',
              'Random_c.cpp',
+             'CounterRandom.cpp',
              'TimeValuesIO.cpp',
              'GEOMETRY.cpp',
              'OSSMTimeValue_c.cpp',
@@ -236,6 +307,7 @@ cpp_files = ['RectGridVeL_c.cpp',
              # 'CMYLIST.cpp',
              # 'GEOMETR2.cpp',
              'StringFunctions.cpp',
+             'TextLines.cpp',
              'OUTILS.cpp',
              # 'NetCDFMover_c.cpp',
              'CATSMover_c.cpp',
@@ -246,22 +318,46 @@ cpp_files = ['RectGridVeL_c.cpp',
              'TriGridVel_c.cpp',
              'DagTree.cpp',
              'DagTreeIO.cpp',
+             'TriBucketIndex.cpp',
              'ShioCurrent1.cpp',
              'ShioCurrent2.cpp',
+             'ShioHarmonics.cpp',
              'GridCurrentMover_c.cpp',
              'GridWindMover_c.cpp',
              'IceMover_c.cpp',
              'IceWindMover_c.cpp',
              'CurrentCycleMover_c.cpp',
              'TimeGridVel_c.cpp',
+             'TimeSliceCache.cpp',
+             'TopologyCache.cpp',
+             'ForcingBlockCache.cpp',
+             'ForcingIOStats.cpp',
+             'ForcingFile.cpp',
+             'TideTableCache.cpp',
+             'TimeIndexCache.cpp',
+             'TimeValuesCache.cpp',
+             'InterpolationKernels.cpp',
+             'NearestNodeIndex.cpp',
+             'TriDepthTables.cpp',
+             'IceFieldProducts.cpp',
+             'SetupStats.cpp',
+             'CurvCellLocator.cpp',
+             'TimingStats.cpp',
+             'GnomeThreads.cpp',
+             'GnomeError.cpp',
              'TimeGridWind_c.cpp',
              'MakeTriangles.cpp',
+             'MakeDelaunayTriangles.cpp',
              'MakeDagTree.cpp',
+             'GridLocator_c.cpp',
+             'ConcentrationGrid_c.cpp',
              'GridMap_c.cpp',
              'GridMapUtils.cpp',
              'RandomVertical_c.cpp',
              'RiseVelocity_c.cpp',
              'Weatherers_c.cpp',
+             'WeatheringWorkspace_c.cpp',
+             'WeatheringPipeline_c.cpp',
              ]
 
 
@@ -273,6 +369,50 @@ cpp_files = [os.path.join(cpp_code_dir, f) for f in cpp_files]
 # in the cpp files is done right.
 macros = [('pyGNOME', 1), ]
 
+# the movers lock shared state with pthreads (GnomeThreads.cpp) so get_move
+# can run without the GIL
+if sys.platform != 'win32':
+    openmp_args = openmp_args + ['-pthread']
+
+# GNOME_PREFETCH=1 reads the next time of gridded data on a background thread
+# while the step computes. Needs a C++11 compiler (std::thread).
+if os.environ.get('GNOME_PREFETCH', '0') not in ('', '0'):
+    macros.append(('GNOME_PREFETCH', 1))
+
+# GNOME_TIMING=1 compiles in the per mover section timers read by
+# CyMover.get_timing_stats(). Needs a C++11 compiler (std::chrono).
+if os.environ.get('GNOME_TIMING', '0') not in ('', '0'):
+    macros.append(('GNOME_TIMING', 1))
+
+# GNOME_CUDA=1 builds the CUDA kernel of the batched velocity interpolation,
+# InterpolationDevice.cu, with nvcc (from CUDA_HOME, /usr/local/cuda by
+# default) and links lib_gnome against the CUDA runtime. It is only used
+# after cy_helpers.set_interpolation_device(True), and only with a device.
+cuda_objects = []
+cuda_libs = []
+cuda_libdirs = []
+if os.environ.get('GNOME_CUDA', '0') not in ('', '0'):
+    cuda_home = os.environ.get('CUDA_HOME', '/usr/local/cuda')
+    cuda_source = os.path.join(cpp_code_dir, 'InterpolationDevice.cu')
+    cuda_object = os.path.join(target_path(), 'InterpolationDevice' +
+                               ('.obj' if sys.platform == 'win32' else '.o'))
+
+    if 'clean' not in sys.argv[1:]:
+        if not os.path.exists(target_path()):
+            os.makedirs(target_path())
+
+        nvcc = [os.path.join(cuda_home, 'bin', 'nvcc'), '-c', '-O3',
+                '-DpyGNOME=1', '-I' + cpp_code_dir]
+        if sys.platform != 'win32':
+            nvcc += ['-Xcompiler', '-fPIC']
+        subprocess.check_call(nvcc + [cuda_source, '-o', cuda_object])
+
+    macros.append(('GNOME_CUDA', 1))
+    cuda_objects = [cuda_object]
+    cuda_libs = ['cudart']
+    cuda_libdirs = [os.path.join(cuda_home, 'lib64' if sys.platform != 'win32'
+                                 else os.path.join('lib', 'x64'))]
+
 # Build the extension objects
 compile_args = []
 extensions = []
@@ -287,7 +427,7 @@ include_dirs = [cpp_code_dir,
                 np.get_include(),
                 netcdf_inc,
                 '.']
-static_lib_files = netcdf_lib_files
+static_lib_files = netcdf_lib_files + cuda_objects
 
 # build cy_basic_types along with lib_gnome so we can use distutils
 # for building everything
@@ -308,9 +448,11 @@ if sys.platform == "darwin":
                                 ['gnome/cy_gnome/cy_basic_types.pyx'] + cpp_files,
                                 language='c++',
                                 define_macros=macros,
-                                extra_compile_args=compile_args,
-                                extra_link_args=['-lz', '-lcurl'],
+                                extra_compile_args=compile_args + openmp_args,
+                                extra_link_args=['-lz', '-lcurl'] + openmp_args,
                                 extra_objects=static_lib_files,
+                                libraries=cuda_libs,
+                                library_dirs=cuda_libdirs,
                                 include_dirs=include_dirs,
                                 )
 
@@ -330,13 +472,15 @@ elif sys.platform == "win32":
 
     # build our linking arguments
     libdirs.append(netcdf_libs)
+    libdirs.extend(cuda_libdirs)
 
     basic_types_ext = Extension(r'gnome.cy_gnome.cy_basic_types',
                                 [r'gnome\cy_gnome\cy_basic_types.pyx'] + cpp_files,
                                 language='c++',
                                 define_macros=macros,
-                                extra_compile_args=compile_args,
+                                extra_compile_args=compile_args + openmp_args,
                                 library_dirs=libdirs,
+                                libraries=cuda_libs,
                                 extra_link_args=link_args,
                                 extra_objects=static_lib_files,
                                 include_dirs=include_dirs,
@@ -363,12 +507,18 @@ elif sys.platform == "linux2":
     # the static netcdf. We didn't build a NETCDF static library.
     setup(name='pyGnome',  # not required since ext defines this
           cmdclass={'build_ext': build_ext,
+                    'build_bench': build_bench,
                     'cleanall': cleanall},
           ext_modules=[Extension('gnome.cy_gnome.libgnome',
                                  cpp_files,
                                  language='c++',
                                  define_macros=macros,
-                                 libraries=['netcdf'],
+                                 # rt: shm_open
+                                 libraries=['netcdf', 'rt'] + cuda_libs,
+                                 library_dirs=cuda_libdirs,
+                                 extra_compile_args=openmp_args,
+                                 extra_link_args=openmp_args,
+                                 extra_objects=cuda_objects,
                                  include_dirs=[cpp_code_dir],
                                  )])
 
@@ -416,14 +566,18 @@ elif sys.platform == "linux2":
 # All other lib_gnome-based cython extensions.
 # These depend on the successful build of cy_basic_types
 #
+# the ones with prange loops, which run in parallel with GNOME_OPENMP=1
+openmp_extensions = ('cy_land_check',)
+
 for mod_name in extension_names:
     cy_file = os.path.join("gnome/cy_gnome", mod_name + ".pyx")
+    omp = openmp_args if mod_name in openmp_extensions else []
     extensions.append(Extension('gnome.cy_gnome.' + mod_name,
                                 [cy_file],
                                 language="c++",
                                 define_macros=macros,
-                                extra_compile_args=compile_args,
-                                extra_link_args=link_args,
+                                extra_compile_args=compile_args + omp,
+                                extra_link_args=link_args + omp,
                                 libraries=lib,
                                 library_dirs=libdirs,
                                 extra_objects=static_lib_files,
@@ -444,6 +598,25 @@ if sys.platform == "win32":
 extensions.append(Extension("gnome.utilities.geometry.cy_point_in_polygon",
                             sources=sources,
                             include_dirs=include_dirs,
+                            extra_compile_args=openmp_args,
+                            extra_link_args=link_args + openmp_args,
+                            ))
+
+extensions.append(Extension("gnome.utilities.geometry.cy_rasterize",
+                            sources=[os.path.join(poly_cypath,
+                                                  'cy_rasterize.pyx'),
+                                     os.path.join(poly_cypath,
+                                                  'c_rasterize.c')],
+                            include_dirs=include_dirs,
+                            extra_compile_args=openmp_args,
+                            extra_link_args=link_args + openmp_args,
+                            ))
+
+extensions.append(Extension("gnome.utilities.cy_thinning",
+                            sources=[os.path.join('gnome',
+                                                  'utilities',
+                                                  'cy_thinning.pyx')],
+                            include_dirs=include_dirs,
                             extra_link_args=link_args,
                             ))
 
@@ -454,6 +627,8 @@ extensions.append(Extension("gnome.utilities.file_tools.filescanner",
                                                   'filescanner.pyx')],
                             include_dirs=include_dirs,
                             language="c",
+                            extra_compile_args=openmp_args,
+                            extra_link_args=link_args + openmp_args,
                             ))
 
 
@@ -477,6 +652,7 @@ setup(name='pyGnome',
                               'outputters/sample.b64']},
       requires=['numpy'],   # want other packages here?
       cmdclass={'build_ext': build_ext,
+                'build_bench': build_bench,
                 'cleanall': cleanall},
 
       # scripts,
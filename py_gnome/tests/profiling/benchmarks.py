@@ -0,0 +1,809 @@
+#!/usr/bin/env python
+
+"""
+Repeatable whole model benchmarks
+
+Runs canonical scenarios from start to end and writes the wall times to a
+JSON file:
+
+ - build: making the model (reading maps, grids and tides)
+ - total: the model run
+ - stages: the split of the run by Model.stage_times - setup, move, beach,
+   weather, step_done, sort (with --sort-interval), release, cache and
+   output
+ - movers: the lib_gnome sections of each mover (Model.timing_stats), only
+   filled in when lib_gnome is built with GNOME_TIMING=1
+ - peak_bytes: the lib_gnome memory high water mark over the run
+ - tlb_misses: the TLB misses of the run by the hardware counters
+   (cy_helpers.read_tlb_counters()), None where the machine doesn't allow
+   them. With --huge-pages the big grid and time slice blocks are on huge
+   pages, the counts tell what that saves
+ - counters: with --counters, the cycles, instructions, last level cache
+   misses and branch misses of each stage (Model.stage_counters), and of
+   each of the movers' sections with GNOME_TIMING. The land check is in the
+   beach stage and the weathering kernels in the weather one
+ - scratch: the temporary arrays the weatherers and the Python movers asked
+   the spill containers' scratch pools for, and how many of them were
+   allocated rather than reused (Model.timing_stats['scratch'])
+ - setup_profile: the stages of the build and of the run's setup, object
+   by object (Model.setup_profile()): the time of each, the lib_gnome
+   topology, island, DAG tree, tide year data and time scan stages in it,
+   and the caches that could have served it and didn't ('could_be_cached').
+   Those of the first run are also written to stderr: the later repeats
+   may find them cached
+
+and the startup times of a new python process, a batch worker's: importing
+gnome, making a model and a wind, with the number of modules each loads.
+
+Each scenario is run --repeat times; 'best' keeps the smallest of each time,
+which is the least noisy estimate of its cost. Compare two runs with
+compare_benchmarks.py.
+
+    python benchmarks.py -o before.json
+    python benchmarks.py -s long_island -n 10000 -r 5 -o after.json
+
+With --determinism, the scenarios are instead run in each of the
+configurations of gnome.utilities.determinism -- serial, scalar, fused,
+threaded, concurrent -- and the elements after each step compared with the
+serial run's: the steps where they diverge are reported, with the wall time
+of each configuration.
+
+    python benchmarks.py --determinism -s weathering
+
+With --scaling, the grids are instead synthetic ones of
+gnome.utilities.synthetic_forcing, of each --grid-kind and of each of the
+--sizes nodes on a side: the seconds to write, build (read the grid, make
+its topology, DAG tree and islands) and read each time slice, and how far
+the mover's moves are off the analytic field's, as fractions of its speed.
+Plot them with plot_scaling.py.
+
+    python benchmarks.py --scaling --sizes 100 200 400 800 -o scaling.json
+
+With --forcing-io, the gridded current movers of the scenarios only read
+their files, at each time of the run (CyGridCurrentMover.load_interval),
+with no elements moved, and what that cost is counted per file
+(cy_helpers.get_forcing_io_stats()): the bytes read, netCDF calls, opens
+and closes, time slice and forcing block cache hits and misses, and the
+times prefetched, used, thrown away and waited for. Run it on a --grid on
+local disk, on NFS and at an OPeNDAP URL to compare them, and with
+--no-prefetch and --window to see what the prefetch and the hyperslab
+reads of an active window save.
+
+    python benchmarks.py --forcing-io -s curvilinear --grid URL \
+        --position -74.04 40.54 -o opendap.json
+
+The data files are fetched with get_datafile like the scripts and tests do.
+"""
+
+import os
+import sys
+import json
+import time
+import shutil
+import argparse
+import platform
+import tempfile
+import subprocess
+import multiprocessing
+from datetime import datetime, timedelta
+
+import numpy as np
+
+import gnome
+from gnome.basic_types import (datetime_value_2d, world_point,
+                               status_code_type, spill_type, oil_status)
+from gnome.utilities.remote_data import get_datafile
+from gnome.utilities.time_utils import date_to_sec
+from gnome.utilities.projections import FlatEarthProjection
+from gnome.cy_gnome import cy_helpers
+from gnome.cy_gnome.cy_gridcurrent_mover import CyGridCurrentMover
+from gnome.utilities import determinism, synthetic_forcing
+
+from gnome.model import Model
+from gnome.map import MapFromBNA
+from gnome.environment import Wind, Tide, constant_wind, Water, Waves
+from gnome.spill import point_line_release_spill
+from gnome.movers import (RandomMover, WindMover, CatsMover,
+                          GridCurrentMover, constant_wind_mover)
+from gnome.weatherers import (Evaporation,
+                              Emulsification,
+                              NaturalDispersion,
+                              Skimmer,
+                              Burn)
+from gnome.outputters import NetCDFOutput, WeatheringOutput
+
+base_dir = os.path.dirname(__file__)
+scripts_dir = os.path.join(base_dir, '..', '..', 'scripts')
+sample_data = os.path.join(base_dir, '..', 'unit_tests', 'sample_data')
+
+RESULTS_FORMAT = 1
+
+# what a new process does on startup, timed on its own after the ones before
+startup_steps = (('import', 'import gnome'),
+                 ('model', 'from gnome.model import Model; Model()'),
+                 ('wind', 'from gnome.environment import constant_wind; '
+                          'constant_wind(1., 0.)'))
+
+startup_script = '''
+import sys
+import time
+for code in sys.argv[1:]:
+    start = time.time()
+    exec code
+    print time.time() - start, len(sys.modules)
+'''
+
+
+def long_island(num_elements, output_dir, options):
+    '''
+    Long Island Sound: CATS tidal currents with a Shio tide, a variable wind
+    and diffusion over 48 hours, uncertain, with the map, the cache and
+    netCDF output
+    '''
+    data_dir = os.path.join(scripts_dir, 'script_long_island')
+    start_time = datetime(2012, 9, 15, 12, 0)
+    mapfile = get_datafile(os.path.join(data_dir, 'LongIslandSoundMap.BNA'))
+
+    model = Model(start_time=start_time,
+                  duration=timedelta(hours=48), time_step=3600,
+                  map=MapFromBNA(mapfile, refloat_halflife=6),
+                  uncertain=True, cache_enabled=True)
+
+    model.outputters += NetCDFOutput(os.path.join(output_dir,
+                                                  'long_island.nc'),
+                                     which_data='all')
+
+    model.spills += point_line_release_spill(num_elements=num_elements,
+                                             start_position=(-72.419992,
+                                                             41.202120, 0.0),
+                                             release_time=start_time)
+
+    model.movers += RandomMover(diffusion_coef=500000, uncertain_factor=2)
+
+    series = np.zeros((5, ), dtype=datetime_value_2d)
+    for i, (hours, direction) in enumerate(((0, 45), (18, 90), (30, 135),
+                                            (42, 180), (54, 225))):
+        series[i] = (start_time + timedelta(hours=hours), (10, direction))
+    model.movers += WindMover(Wind(timeseries=series, units='m/s'))
+
+    curr_file = get_datafile(os.path.join(data_dir, 'LI_tidesWAC.CUR'))
+    tide_file = get_datafile(os.path.join(data_dir, 'CLISShio.txt'))
+    c_mover = CatsMover(curr_file, tide=Tide(tide_file))
+    model.movers += c_mover
+    model.environment += c_mover.tide
+
+    return model
+
+
+def curvilinear(num_elements, output_dir, options):
+    '''
+    New York harbor on a curvilinear ROMS grid (or the --grid file), with
+    diffusion and a constant wind, 15 minute steps over a day, uncertain
+    '''
+    start_time = datetime(2008, 1, 29, 17)
+
+    model = Model(start_time=start_time,
+                  duration=timedelta(hours=24), time_step=900,
+                  uncertain=True)
+
+    if options.grid is None:
+        curr_dir = os.path.join(sample_data, 'currents')
+        grid = get_datafile(os.path.join(curr_dir, 'ny_cg.nc'))
+        topology = get_datafile(os.path.join(curr_dir, 'NYTopology.dat'))
+        mapfile = get_datafile(os.path.join(scripts_dir, 'script_ny_roms',
+                                            'nyharbor.bna'))
+        model.map = MapFromBNA(mapfile, refloat_halflife=0.0)
+        position = (-74.03988, 40.536092, 0.0)
+    else:
+        grid, topology = options.grid, options.topology
+        position = options.position
+
+    model.spills += point_line_release_spill(num_elements=num_elements,
+                                             start_position=position,
+                                             release_time=start_time)
+
+    model.movers += RandomMover(diffusion_coef=50000)
+    model.movers += constant_wind_mover(4, 270, units='m/s')
+
+    # extrapolate so the run does not depend on how much time the file has
+    model.movers += GridCurrentMover(grid, topology, extrapolate=True)
+
+    return model
+
+
+def weathering(num_elements, output_dir, options):
+    '''
+    Alaska North Slope crude released over a day in a strong wind, with
+    evaporation, emulsification, dispersion, skimming and a burn over 42
+    hours, uncertain, with weathering and netCDF output
+    '''
+    start_time = datetime(2015, 5, 14, 0, 0)
+
+    model = Model(start_time=start_time,
+                  duration=timedelta(hours=42), time_step=3600,
+                  uncertain=True)
+
+    model.outputters += WeatheringOutput()
+    model.outputters += NetCDFOutput(os.path.join(output_dir,
+                                                  'weathering.nc'),
+                                     which_data='all')
+
+    spill = point_line_release_spill(num_elements=num_elements,
+                                     start_position=(-164.791878561,
+                                                     69.6252597267, 0.0),
+                                     release_time=start_time,
+                                     end_release_time=(start_time +
+                                                       timedelta(hours=24)),
+                                     amount=1000,
+                                     substance=('ALASKA NORTH SLOPE '
+                                                '(MIDDLE PIPELINE)'),
+                                     units='bbl')
+    model.spills += spill
+
+    water = Water(280.928)
+    wind = constant_wind(20., 117, 'knots')
+    waves = Waves(wind, water)
+    model.environment += [water, wind, waves]
+
+    model.movers += WindMover(wind)
+
+    model.weatherers += Evaporation(water, wind)
+    model.weatherers += Emulsification(waves)
+    model.weatherers += NaturalDispersion(waves, water)
+    model.weatherers += Skimmer(80, units=spill.units, efficiency=0.36,
+                                active_start=start_time + timedelta(hours=15),
+                                active_stop=start_time + timedelta(hours=23))
+    model.weatherers += Burn(1000., .1,
+                             active_start=start_time + timedelta(hours=36),
+                             efficiency=.2)
+
+    return model
+
+
+# name: (make model, default number of elements)
+scenarios = {'long_island': (long_island, 1000),
+             'curvilinear': (curvilinear, 4000),
+             'weathering': (weathering, 1000)}
+
+
+def mover_stats(model):
+    '''
+    the lib_gnome section times of the movers, by mover name, in seconds
+    '''
+    stats = {}
+    for m in model.movers:
+        sections = model.timing_stats.get(m.id)
+        if not sections:
+            continue
+
+        name = m.name if m.name not in stats else '{0} {1}'.format(m.name,
+                                                                    m.id)
+        stats[name] = dict((section, {'count': s['count'],
+                                      'num_les': s['num_les'],
+                                      'seconds': s['ns'] / 1e9,
+                                      'bytes_read': s['bytes_read'],
+                                      'counters': s.get('counters', {})})
+                           for section, s in sections.iteritems())
+
+    return stats
+
+
+def run_scenario(name, num_elements, options):
+    '''
+    builds and runs one scenario once
+
+    :returns: dict of the times of the run
+    '''
+    make_model = scenarios[name][0]
+    output_dir = tempfile.mkdtemp(prefix='gnome_bench_')
+
+    try:
+        start = time.time()
+        model = make_model(num_elements, output_dir, options)
+        model.use_element_view = options.element_view or options.fuse
+        model.fuse_movers = options.fuse
+        model.sort_interval = options.sort_interval
+        build = time.time() - start
+
+        cy_helpers.reset_memory_peaks()
+        tlb = cy_helpers.read_tlb_counters()
+        start = time.time()
+        model.full_run()
+        total = time.time() - start
+        tlb_after = cy_helpers.read_tlb_counters()
+
+        return {'build': build,
+                'total': total,
+                'num_steps': model.num_time_steps,
+                'stages': dict(model.stage_times),
+                'movers': mover_stats(model),
+                'peak_bytes': (cy_helpers.get_memory_usage()['total']
+                               ['peak_bytes']),
+                'tlb_misses': dict((name, None if count is None else
+                                    tlb_after[name] - count)
+                                   for name, count in tlb.iteritems()),
+                'counters': model.stage_counters,
+                'scratch': model.timing_stats.get('scratch', {}),
+                'setup_profile': model.setup_profile()}
+    finally:
+        shutil.rmtree(output_dir, ignore_errors=True)
+
+
+def check_scenario(name, num_elements, options):
+    '''
+    runs one scenario in each of the determinism configurations
+
+    :returns: dict of the wall time of each configuration, and of the
+        divergences from the serial run
+    '''
+    make_model = scenarios[name][0]
+    output_dir = tempfile.mkdtemp(prefix='gnome_bench_')
+
+    try:
+        reference = None
+        times = {}
+        divergences = []
+        for config in determinism.CONFIGURATIONS:
+            model = make_model(num_elements, output_dir, options)
+
+            start = time.time()
+            steps = determinism.run_steps(model, config)
+            times[config['name']] = time.time() - start
+
+            if reference is None:
+                reference = steps
+            else:
+                divergences.extend(determinism.compare_runs(config['name'],
+                                                            reference, steps,
+                                                            config.get('ulps',
+                                                                       0)))
+
+        sys.stderr.write('{0}:\n{1}\n'
+                         .format(name, determinism.format_report(divergences)))
+
+        return {'seconds': times,
+                'divergences': [dict(vars(d)) for d in divergences]}
+    finally:
+        shutil.rmtree(output_dir, ignore_errors=True)
+
+
+def scaling_run(kind, size, options):
+    '''
+    writes a synthetic grid of size by size nodes, and reads and moves
+    through it once
+
+    :returns: dict of the times of the run and the errors of the moves
+    '''
+    output_dir = tempfile.mkdtemp(prefix='gnome_bench_')
+    filename = os.path.join(output_dir, '{0}_{1}.nc'.format(kind, size))
+
+    try:
+        start = time.time()
+        info = synthetic_forcing.write_forcing(kind, filename,
+                                               shape=(size, size),
+                                               num_times=options.times,
+                                               field=options.field)
+        write = time.time() - start
+
+        cy_helpers.reset_memory_peaks()
+        start = time.time()
+        mover = CyGridCurrentMover()
+        mover.text_read(filename, topology_file=None)
+        build = time.time() - start
+
+        positions = synthetic_forcing.water_positions(info,
+                                                      options.num_elements
+                                                      or 1000)
+        ref = np.zeros((len(positions), ), dtype=world_point)
+        ref['long'] = positions[:, 0]
+        ref['lat'] = positions[:, 1]
+        status = np.empty((len(positions), ), dtype=status_code_type)
+        status[:] = oil_status.in_water
+        delta = np.zeros((len(positions), ), dtype=world_point)
+
+        # a step per time slice, each one reads the next
+        time_step = info['time_step']
+        read = 0.
+        errors = []
+        mover.prepare_for_model_run()
+        for step in range(info['num_times'] - 1):
+            model_time = info['start_time'] + timedelta(seconds=step *
+                                                        time_step)
+            seconds = date_to_sec(model_time)
+
+            start = time.time()
+            mover.prepare_for_model_step(seconds, time_step)
+            read += time.time() - start
+
+            mover.get_move(seconds, time_step, ref, delta, status,
+                           spill_type.forecast)
+            mover.model_step_is_done()
+
+            expected = synthetic_forcing.expected_delta(info, positions,
+                                                        model_time,
+                                                        time_step)
+            off = np.column_stack((delta['long'] - expected[:, 0],
+                                   delta['lat'] - expected[:, 1],
+                                   np.zeros(len(positions))))
+            meters = FlatEarthProjection.lonlat_to_meters(off, positions)
+            errors.append(np.hypot(meters[:, 0], meters[:, 1]) /
+                          (info['speed'] * time_step))
+
+        errors = np.concatenate(errors) if errors else np.zeros((1, ))
+        num_nodes = size * size
+
+        return {'num_nodes': num_nodes,
+                'num_times': info['num_times'],
+                'file_bytes': os.path.getsize(filename),
+                'write': write,
+                'build': build,
+                'read_slice': read / max(info['num_times'] - 1, 1),
+                'peak_bytes': (cy_helpers.get_memory_usage()['total']
+                               ['peak_bytes']),
+                'rms_error': float(np.sqrt(np.mean(errors ** 2))),
+                'max_error': float(errors.max())}
+    finally:
+        shutil.rmtree(output_dir, ignore_errors=True)
+
+
+def scaling_curves(options):
+    '''
+    the best of --repeat scaling_run()s of each grid kind and size
+
+    :returns: dict of grid kind to the list of runs by size
+    '''
+    curves = {}
+    for kind in options.grid_kind or synthetic_forcing.KINDS:
+        curves[kind] = []
+        for size in options.sizes:
+            repeats = [scaling_run(kind, size, options)
+                       for _i in range(max(options.repeat, 1))]
+
+            best = dict(repeats[0])
+            for name in ('write', 'build', 'read_slice'):
+                best[name] = min(r[name] for r in repeats)
+            best['size'] = size
+            curves[kind].append(best)
+
+            sys.stderr.write('{0} {1}x{1}: build {2:.3f} s, slice {3:.4f} s, '
+                             'rms error {4:.2g}\n'
+                             .format(kind, size, best['build'],
+                                     best['read_slice'], best['rms_error']))
+
+    return curves
+
+
+def forcing_io_run(name, options):
+    '''
+    builds one scenario and reads the forcing of its gridded current movers
+    over the times of its run, without running it
+
+    :returns: dict of the times and, per file, the forcing reads
+    '''
+    make_model = scenarios[name][0]
+    output_dir = tempfile.mkdtemp(prefix='gnome_bench_')
+
+    try:
+        start = time.time()
+        model = make_model(options.num_elements or scenarios[name][1],
+                           output_dir, options)
+        build = time.time() - start
+
+        grid_movers = [m.mover for m in model.movers
+                       if hasattr(getattr(m, 'mover', None),
+                                  'load_interval')]
+        for mover in grid_movers:
+            mover.prefetch = not options.no_prefetch
+            if options.window is not None:
+                mover.set_active_window(True)
+                mover.set_active_window_bounds(options.window)
+
+        num_times = int(model.duration.total_seconds() //
+                        model.time_step) + 1
+        cy_helpers.reset_forcing_io_stats()
+        blocks = cy_helpers.get_forcing_block_cache_stats()
+        start = time.time()
+        for step in range(num_times):
+            seconds = date_to_sec(model.start_time +
+                                  timedelta(seconds=step * model.time_step))
+            for mover in grid_movers:
+                mover.load_interval(seconds)
+        read = time.time() - start
+        blocks_after = cy_helpers.get_forcing_block_cache_stats()
+
+        files = cy_helpers.get_forcing_io_stats()
+        for stats in files.itervalues():
+            used = stats['prefetches_used']
+            stats['prefetch_used_fraction'] = (float(used) /
+                                               stats['prefetches']
+                                               if stats['prefetches']
+                                               else None)
+
+        return {'build': build,
+                'read': read,
+                'num_times': num_times,
+                'num_grid_movers': len(grid_movers),
+                'block_cache': {'hits': blocks_after[0] - blocks[0],
+                                'misses': blocks_after[1] - blocks[1]},
+                'files': files}
+    finally:
+        shutil.rmtree(output_dir, ignore_errors=True)
+
+
+def startup_times(repeats):
+    '''
+    the best wall times of the startup_steps in new processes, with the
+    python modules loaded after each
+    '''
+    runs = []
+    for i in range(max(repeats, 1)):
+        out = subprocess.check_output([sys.executable, '-c', startup_script] +
+                                      [code for _name, code in startup_steps])
+        runs.append([line.split() for line in out.splitlines()])
+
+    return dict((name, {'seconds': min(float(run[j][0]) for run in runs),
+                        'modules': int(runs[0][j][1])})
+                for j, (name, _code) in enumerate(startup_steps))
+
+
+def min_counts(counts):
+    '''
+    the smallest of each count of the dicts of counter name to count
+    '''
+    counts = list(counts)
+
+    return dict((name, min(c.get(name, count) for c in counts))
+                for name, count in counts[0].iteritems())
+
+
+def best_of(repeats):
+    '''
+    the smallest of each time over the repeats
+    '''
+    best = dict(repeats[0])
+    best['build'] = min(r['build'] for r in repeats)
+    best['total'] = min(r['total'] for r in repeats)
+    best['peak_bytes'] = max(r['peak_bytes'] for r in repeats)
+    best['tlb_misses'] = dict((name, None if count is None else
+                               min(r['tlb_misses'][name] for r in repeats))
+                              for name, count in
+                              repeats[0]['tlb_misses'].iteritems())
+    best['stages'] = dict((stage, min(r['stages'].get(stage, 0.)
+                                      for r in repeats))
+                          for stage in repeats[0]['stages'])
+    best['counters'] = dict((stage, min_counts(r['counters'].get(stage, {})
+                                               for r in repeats))
+                            for stage in repeats[0]['counters'])
+
+    best['movers'] = {}
+    for mover, sections in repeats[0]['movers'].iteritems():
+        best['movers'][mover] = {}
+        for section, stats in sections.iteritems():
+            s = dict(stats)
+            s['seconds'] = min(r['movers'].get(mover, {})
+                               .get(section, stats)['seconds']
+                               for r in repeats)
+            s['counters'] = min_counts(r['movers'].get(mover, {})
+                                       .get(section, stats)['counters']
+                                       for r in repeats)
+            best['movers'][mover][section] = s
+
+    return best
+
+
+def machine_info():
+    return {'platform': platform.platform(),
+            'processor': platform.processor(),
+            'cpu_count': multiprocessing.cpu_count(),
+            'python': platform.python_version(),
+            'node': platform.node()}
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description='run the model benchmarks')
+    parser.add_argument('-s', '--scenario', action='append',
+                        choices=sorted(scenarios),
+                        help='scenario to run, may be repeated '
+                        '(default: all of them)')
+    parser.add_argument('-n', '--num-elements', type=int,
+                        help='elements per spill (default: per scenario)')
+    parser.add_argument('-r', '--repeat', type=int, default=3,
+                        help='runs of each scenario (default: 3)')
+    parser.add_argument('-o', '--output',
+                        help='JSON file for the results (default: stdout)')
+    parser.add_argument('--label', default='',
+                        help='note kept with the results, like a commit')
+    parser.add_argument('--element-view', action='store_true',
+                        help='move the elements in the element view '
+                        '(Model.use_element_view)')
+    parser.add_argument('--fuse', action='store_true',
+                        help='fuse the movers that can be '
+                        '(Model.fuse_movers, implies --element-view)')
+    parser.add_argument('--sort-interval', type=int, default=0,
+                        help='sort the elements by position every this '
+                        'many steps (Model.sort_interval, default: 0, off)')
+    parser.add_argument('--huge-pages', default='off',
+                        choices=('off', 'transparent', 'explicit'),
+                        help='back the big time slice, topology and DAG '
+                        'blocks with huge pages '
+                        '(cy_helpers.set_huge_pages(), default: off)')
+    parser.add_argument('--counters', action='store_true',
+                        help='count the cycles, instructions, cache and '
+                        'branch misses of the stages and mover sections '
+                        '(cy_helpers.open_section_counters())')
+    parser.add_argument('--determinism', action='store_true',
+                        help='run the scenarios serial, threaded and '
+                        'vectorized and compare the elements step by step, '
+                        'instead of timing them')
+    parser.add_argument('--scaling', action='store_true',
+                        help='time synthetic grids of growing sizes instead '
+                        'of the scenarios')
+    parser.add_argument('--grid-kind', action='append',
+                        choices=synthetic_forcing.KINDS,
+                        help='synthetic grid of --scaling, may be repeated '
+                        '(default: all of them)')
+    parser.add_argument('--sizes', type=int, nargs='+',
+                        default=[50, 100, 200, 400],
+                        help='nodes on a side of the --scaling grids '
+                        '(default: 50 100 200 400)')
+    parser.add_argument('--times', type=int, default=6,
+                        help='time slices of the --scaling grids '
+                        '(default: 6)')
+    parser.add_argument('--field', default='gyre',
+                        choices=sorted(synthetic_forcing.FIELDS),
+                        help='analytic currents of the --scaling grids '
+                        '(default: gyre)')
+    parser.add_argument('--forcing-io', action='store_true',
+                        help='count the forcing reads of the scenarios\' '
+                        'gridded currents per file, reading them alone over '
+                        'the times of the run, instead of timing the runs')
+    parser.add_argument('--no-prefetch', action='store_true',
+                        help='don\'t prefetch the next time of the '
+                        '--forcing-io reads')
+    parser.add_argument('--window', type=float, nargs=4,
+                        metavar=('LONG', 'LAT', 'LONG', 'LAT'),
+                        help='read only the grid cells in these corners, '
+                        'plus a halo, in the --forcing-io reads (the active '
+                        'window)')
+    parser.add_argument('--grid',
+                        help='netCDF currents for the curvilinear scenario')
+    parser.add_argument('--topology',
+                        help='topology file for the --grid currents')
+    parser.add_argument('--position', type=float, nargs=2,
+                        metavar=('LONG', 'LAT'),
+                        help='spill position in the --grid currents')
+
+    args = parser.parse_args(argv)
+    if args.grid is not None and args.position is None:
+        parser.error('--grid needs a spill --position')
+    if args.position is not None:
+        args.position = tuple(args.position) + (0.0, )
+    if args.window is not None:
+        args.window = (tuple(args.window[:2]), tuple(args.window[2:]))
+
+    return args
+
+
+def main(argv):
+    args = parse_args(argv)
+    names = args.scenario or sorted(scenarios)
+
+    # before the first parallel loop starts its threads
+    cy_helpers.open_tlb_counters()
+    if args.counters and not cy_helpers.open_section_counters():
+        sys.stderr.write('no hardware counters on this machine\n')
+    if args.huge_pages != 'off' and not cy_helpers.set_huge_pages(
+            args.huge_pages):
+        sys.stderr.write('no huge pages on this machine\n')
+
+    if args.scaling:
+        write_results({'format': RESULTS_FORMAT,
+                       'label': args.label,
+                       'created': datetime.now().isoformat(),
+                       'gnome_version': gnome.__version__,
+                       'machine': machine_info(),
+                       'scaling_options': {'times': args.times,
+                                           'field': args.field,
+                                           'num_elements': (args.num_elements
+                                                            or 1000)},
+                       'scaling': scaling_curves(args)},
+                      args.output)
+        return
+
+    if args.forcing_io:
+        reads = {}
+        for name in names:
+            repeats = [forcing_io_run(name, args)
+                       for _i in range(max(args.repeat, 1))]
+            # the counts are the same each time, the seconds aren't
+            reads[name] = dict(repeats[0])
+            reads[name]['read'] = min(r['read'] for r in repeats)
+            reads[name]['build'] = min(r['build'] for r in repeats)
+
+            for path, stats in sorted(reads[name]['files'].iteritems()):
+                sys.stderr.write('{0} {1}: {2} bytes, {3} nc calls, '
+                                 '{4} opens, {5} prefetched, {6} used\n'
+                                 .format(name, path, stats['bytes_read'],
+                                         stats['nc_calls'], stats['opens'],
+                                         stats['prefetches'],
+                                         stats['prefetches_used']))
+
+        write_results({'format': RESULTS_FORMAT,
+                       'label': args.label,
+                       'created': datetime.now().isoformat(),
+                       'gnome_version': gnome.__version__,
+                       'machine': machine_info(),
+                       'forcing_io_options': {'prefetch':
+                                              not args.no_prefetch,
+                                              'window': args.window},
+                       'forcing_io': reads},
+                      args.output)
+        return
+
+    if args.determinism:
+        checks = {}
+        for name in names:
+            num_elements = args.num_elements or scenarios[name][1]
+            checks[name] = check_scenario(name, num_elements, args)
+
+        write_results({'format': RESULTS_FORMAT,
+                       'label': args.label,
+                       'created': datetime.now().isoformat(),
+                       'gnome_version': gnome.__version__,
+                       'machine': machine_info(),
+                       'determinism': checks},
+                      args.output)
+        return
+
+    results = {'format': RESULTS_FORMAT,
+               'label': args.label,
+               'created': datetime.now().isoformat(),
+               'gnome_version': gnome.__version__,
+               'machine': machine_info(),
+               'model_options': {'element_view': args.element_view or args.fuse,
+                                 'fuse': args.fuse,
+                                 'sort_interval': args.sort_interval,
+                                 'huge_pages': args.huge_pages,
+                                 'counters': args.counters},
+               'startup': startup_times(args.repeat),
+               'scenarios': {}}
+
+    for name in names:
+        num_elements = args.num_elements or scenarios[name][1]
+        repeats = []
+        for i in range(max(args.repeat, 1)):
+            repeats.append(run_scenario(name, num_elements, args))
+            sys.stderr.write('{0} run {1}: {2:.3f} s\n'
+                             .format(name, i + 1, repeats[-1]['total']))
+            if i == 0:
+                write_could_be_cached(repeats[0]['setup_profile'])
+
+        results['scenarios'][name] = {'num_elements': num_elements,
+                                      'num_steps': repeats[0]['num_steps'],
+                                      'best': best_of(repeats),
+                                      'repeats': repeats}
+
+    write_results(results, args.output)
+
+
+def write_could_be_cached(profile):
+    'the setup stages a warm cache would have saved, to stderr'
+    for r in profile:
+        if r['could_be_cached']:
+            sys.stderr.write('  {0} {1} {2}: {3:.3f} s, could be cached: '
+                             '{4}\n'.format(r['class'], r['name'],
+                                            r['stage'], r['seconds'],
+                                            ', '.join(r['could_be_cached'])))
+
+
+def write_results(results, output):
+    text = json.dumps(results, indent=2, sort_keys=True)
+    if output:
+        with open(output, 'w') as f:
+            f.write(text)
+    else:
+        print text
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
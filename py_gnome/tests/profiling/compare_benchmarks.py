@@ -0,0 +1,185 @@
+#!/usr/bin/env python
+
+"""
+Compares two benchmarks.py result files
+
+    python compare_benchmarks.py before.json after.json [-t 10]
+
+Prints the best times of each scenario side by side: build, total, the
+model stages and the lib_gnome mover sections, after the startup times,
+then the peak bytes, the TLB misses and, of the runs with --counters, the
+hardware counts of the stages and sections. Times that got slower by
+more than the threshold percent are marked, and the exit status is 1 if
+there are any, so it can gate a build. Times under --min-time seconds in
+both runs are too small to compare and are never marked.
+"""
+
+import sys
+import json
+import argparse
+
+
+def load(filename):
+    with open(filename) as f:
+        return json.load(f)
+
+
+def times(best):
+    '''
+    (name, seconds) of a scenario's best times, in print order
+    '''
+    rows = [('build', best['build']), ('total', best['total'])]
+    rows.extend(('stage ' + stage, seconds)
+                for stage, seconds in sorted(best['stages'].iteritems()))
+
+    for mover, sections in sorted(best['movers'].iteritems()):
+        rows.extend(('{0} {1}'.format(mover, section), s['seconds'])
+                    for section, s in sorted(sections.iteritems())
+                    if s['count'] > 0)
+
+    return rows
+
+
+def counts(best):
+    '''
+    (name, count) of a scenario's best hardware counts, in print order
+    '''
+    rows = []
+    for stage, stage_counts in sorted(best.get('counters', {}).iteritems()):
+        rows.extend(('stage {0} {1}'.format(stage, counter), count)
+                    for counter, count in sorted(stage_counts.iteritems()))
+
+    for mover, sections in sorted(best['movers'].iteritems()):
+        for section, s in sorted(sections.iteritems()):
+            if s['count'] > 0:
+                rows.extend(('{0} {1} {2}'.format(mover, section, counter),
+                             count)
+                            for counter, count in
+                            sorted(s.get('counters', {}).iteritems()))
+
+    return rows
+
+
+def compare_startup(base, new, threshold, min_time):
+    '''
+    prints the startup rows, of the runs that have them
+
+    :returns: number of regressions
+    '''
+    if 'startup' not in base or 'startup' not in new:
+        return 0
+
+    print '\nstartup'
+    print '  {0:<40} {1:>10} {2:>10} {3:>8} {4:>8}'.format('', 'base (s)',
+                                                           'new (s)',
+                                                           'change',
+                                                           'modules')
+    regressions = 0
+    for step in sorted(new['startup']):
+        if step not in base['startup']:
+            continue
+
+        before = base['startup'][step]['seconds']
+        seconds = new['startup'][step]['seconds']
+        change = (seconds - before) / before * 100 if before > 0 else 0.
+        slower = (change > threshold and max(before, seconds) >= min_time)
+        regressions += slower
+
+        print '  {0:<40} {1:>10.4f} {2:>10.4f} {3:>+7.1f}% {4:>8}{5}'.format(
+            step, before, seconds, change, new['startup'][step]['modules'],
+            '  <-- slower' if slower else '')
+
+    return regressions
+
+
+def compare_scenario(name, base, new, threshold, min_time):
+    '''
+    prints the scenario's rows
+
+    :returns: number of regressions
+    '''
+    print '\n{0}'.format(name)
+    for key in ('num_elements', 'num_steps'):
+        if base[key] != new[key]:
+            print '  warning: {0} differs: {1} vs {2}'.format(key, base[key],
+                                                               new[key])
+
+    base_times = dict(times(base['best']))
+    regressions = 0
+
+    print '  {0:<40} {1:>10} {2:>10} {3:>8}'.format('', 'base (s)',
+                                                    'new (s)', 'change')
+    for row, seconds in times(new['best']):
+        if row not in base_times:
+            print '  {0:<40} {1:>10} {2:>10.4f}'.format(row, '-', seconds)
+            continue
+
+        before = base_times[row]
+        change = (seconds - before) / before * 100 if before > 0 else 0.
+        slower = (change > threshold and max(before, seconds) >= min_time)
+        regressions += slower
+
+        print '  {0:<40} {1:>10.4f} {2:>10.4f} {3:>+7.1f}%{4}'.format(
+            row, before, seconds, change, '  <-- slower' if slower else '')
+
+    peak = (base['best']['peak_bytes'], new['best']['peak_bytes'])
+    print '  {0:<40} {1:>10} {2:>10}'.format('lib_gnome peak bytes', *peak)
+
+    # the hardware counters, in the runs that have them
+    base_tlb = base['best'].get('tlb_misses', {})
+    for counter, count in sorted(new['best'].get('tlb_misses', {})
+                                 .iteritems()):
+        if count is not None and base_tlb.get(counter) is not None:
+            print '  {0:<40} {1:>10} {2:>10}'.format(counter,
+                                                     base_tlb[counter], count)
+
+    base_counts = dict(counts(base['best']))
+    for row, count in counts(new['best']):
+        if row in base_counts:
+            before = base_counts[row]
+            change = (count - before) * 100. / before if before > 0 else 0.
+            print '  {0:<40} {1:>10} {2:>10} {3:>+7.1f}%'.format(row, before,
+                                                                 count, change)
+
+    return regressions
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='compare two benchmark '
+                                     'runs')
+    parser.add_argument('base', help='results to compare against')
+    parser.add_argument('new', help='results to check')
+    parser.add_argument('-t', '--threshold', type=float, default=10.,
+                        help='percent slower that counts as a regression '
+                        '(default: 10)')
+    parser.add_argument('--min-time', type=float, default=.01,
+                        help='seconds below which times are not compared '
+                        '(default: .01)')
+    args = parser.parse_args(argv)
+
+    base, new = load(args.base), load(args.new)
+    for results, filename in ((base, args.base), (new, args.new)):
+        print '{0}: {1} {2} on {3[node]} ({3[platform]})'.format(
+            filename, results['created'], results['label'],
+            results['machine'])
+
+    if base['machine']['node'] != new['machine']['node']:
+        print 'warning: the runs are from different machines'
+
+    regressions = compare_startup(base, new, args.threshold, args.min_time)
+    for name in sorted(new['scenarios']):
+        if name not in base['scenarios']:
+            print '\n{0}: not in {1}'.format(name, args.base)
+            continue
+
+        regressions += compare_scenario(name, base['scenarios'][name],
+                                        new['scenarios'][name],
+                                        args.threshold, args.min_time)
+
+    print '\n{0} regression(s) over {1}%'.format(regressions, args.threshold)
+
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,71 @@
+#!/usr/bin/env python
+
+"""
+Plots the scaling curves of benchmarks.py --scaling results
+
+    python plot_scaling.py scaling.json [more.json ...] -o scaling.png
+
+Draws, against the nodes of the grids, log-log: the seconds to build each
+grid kind and to read a time slice of it, and the rms error of the moves
+as a fraction of the field's speed. The curves of more than one file are
+labelled by their --label, to compare builds.
+"""
+
+import sys
+import json
+import argparse
+
+import matplotlib
+matplotlib.use('Agg')
+import matplotlib.pyplot as plt
+
+panels = (('build', 'build seconds'),
+          ('read_slice', 'seconds per time slice'),
+          ('rms_error', 'rms error / speed'))
+
+
+def load(filename):
+    with open(filename) as f:
+        return json.load(f)
+
+
+def plot(results, output):
+    fig, axes = plt.subplots(1, len(panels), figsize=(5 * len(panels), 4))
+
+    for res in results:
+        for kind, runs in sorted(res['scaling'].iteritems()):
+            label = ('{0} {1}'.format(res['label'], kind) if res['label']
+                     else kind)
+            nodes = [r['num_nodes'] for r in runs]
+            for ax, (name, _title) in zip(axes, panels):
+                ax.loglog(nodes, [max(r[name], 1e-12) for r in runs],
+                          marker='o', label=label)
+
+    for ax, (_name, title) in zip(axes, panels):
+        ax.set_xlabel('grid nodes')
+        ax.set_title(title)
+        ax.grid(True, which='both', alpha=.3)
+    axes[0].legend(loc='upper left', fontsize='small')
+
+    fig.tight_layout()
+    fig.savefig(output)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='plot benchmarks.py '
+                                     '--scaling results')
+    parser.add_argument('results', nargs='+')
+    parser.add_argument('-o', '--output', default='scaling.png',
+                        help='image file (default: scaling.png)')
+    args = parser.parse_args(argv)
+
+    results = [load(f) for f in args.results]
+    missing = [f for f, r in zip(args.results, results) if 'scaling' not in r]
+    if missing:
+        sys.exit('no --scaling results in {0}'.format(', '.join(missing)))
+
+    plot(results, args.output)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -17,7 +17,7 @@ class CyTestMove(object):
     Base class that initializes stuff that is common for multiple cy_wind_mover objects
     """
 
-    spill_size = np.zeros((1, ), dtype=np.int32)  # number of LEs in 1 uncertainty spill - simple test
+    spill_size = np.zeros((1, ), dtype=np.int64)  # number of LEs in 1 uncertainty spill - simple test
 
     def __init__(self, num_le=4):
         self.num_le = 4  # test on 4 LEs
@@ -107,6 +107,62 @@ def test_certain_move():
     assert np.all((tgt.delta['long'])[:] == tgt.delta['long'][0])
 
 
+def test_move_with_tri_hints():
+    """
+    LEs remember their triangle between calls, moving them after the first
+    lookup gives the same deltas as a mover that has no hints yet
+    """
+    tgt = CatsMove()
+    tgt.certain_move()
+
+    tgt.ref['long'] += np.linspace(0., 0.01, len(tgt.ref))
+    tgt.ref['lat'] += np.linspace(0., 0.005, len(tgt.ref))
+    tgt.certain_move()
+
+    fresh = CatsMove()
+    fresh.ref[:] = tgt.ref
+    fresh.certain_move()
+
+    assert np.all(tgt.delta == fresh.delta)
+
+
+def test_move_bucket_index():
+    """
+    looking the triangles up through the bucket index gives the same deltas
+    as the DAG tree
+    """
+    tgt = CatsMove()
+    tgt.ref['long'] += np.linspace(0., 0.02, len(tgt.ref))
+    tgt.certain_move()
+
+    buckets = CatsMove()
+    assert not buckets.cats.bucket_index
+    buckets.cats.bucket_index = True
+    assert buckets.cats.bucket_index
+    buckets.ref[:] = tgt.ref
+    buckets.certain_move()
+
+    assert np.all(tgt.delta['lat'] != 0)
+    assert np.all(tgt.delta == buckets.delta)
+
+
+def test_move_packed_dag_tree():
+    """
+    the packed DAG tree finds the same triangles as the original one
+    """
+    tgt = CatsMove()
+    tgt.ref['long'] += np.linspace(0., 0.02, len(tgt.ref))
+    tgt.certain_move()
+
+    packed = CatsMove()
+    packed.cats.packed_dag_tree = True
+    assert packed.cats.packed_dag_tree
+    packed.ref[:] = tgt.ref
+    packed.certain_move()
+
+    assert np.all(tgt.delta == packed.delta)
+
+
 def test_uncertain_move():
     """
     test get_move for uncertainty LEs
@@ -0,0 +1,93 @@
+'''
+tests the concentration grid: the mass of the elements binned by cell and
+depth layer in lib_gnome
+'''
+import numpy as np
+import pytest
+
+from gnome.cy_gnome.cy_grid_locator import CyGridLocator
+from gnome.cy_gnome.cy_concentration_grid import CyConcentrationGrid
+
+# the 2 x 1 rectangle of four triangles of test_cy_grid_locator
+nodes = np.array([(0., 0.), (1., 0.), (1., 1.), (0., 1.), (2., 0.), (2., 1.)])
+faces = np.array([(0, 1, 2), (0, 3, 2), (1, 4, 5), (1, 5, 2)])
+
+positions = np.array([(0.7, 0.2, 0.5),
+                      (0.2, 0.8, 0.5),
+                      (1.5, 0.5, 3.0),
+                      (3.0, 0.5, 0.5)])
+mass = np.array([1., 2., 4., 8.])
+
+
+def test_bad_grid():
+    with pytest.raises(ValueError):
+        CyConcentrationGrid()
+
+    with pytest.raises(ValueError):
+        CyConcentrationGrid(bounds=((1., 0.), (0., 1.)), shape=(2, 2))
+
+    with pytest.raises(ValueError):
+        CyConcentrationGrid(bounds=((0., 0.), (2., 1.)), shape=(2, 2),
+                            depth_edges=(1., 0.))
+
+
+def test_regular():
+    grid = CyConcentrationGrid(bounds=((0., 0.), (2., 1.)), shape=(2, 4))
+    binned, cells = grid.add_mass(positions, mass)
+
+    # the third is below the surface meter, the fourth off the grid
+    assert binned == 2
+    assert list(cells) == [1, 4, 7, -1]
+    assert grid.mass.shape == (1, 2, 4)
+    assert grid.mass.sum() == 3.
+    assert grid.mass[0, 0, 1] == 1.
+    assert grid.mass[0, 1, 0] == 2.
+
+    grid.clear()
+    assert grid.mass.sum() == 0.
+
+
+def test_areas():
+    'the cells of a row have one area, smaller toward the pole'
+    grid = CyConcentrationGrid(bounds=((-10., 40.), (10., 60.)),
+                               shape=(2, 4))
+    areas = grid.cell_areas
+
+    assert areas.shape == (2, 4)
+    assert np.allclose(areas[0], areas[0, 0])
+    assert areas[1, 0] < areas[0, 0]
+
+    lon, lat = grid.cell_centers
+    assert np.allclose(lon[0], (-7.5, -2.5, 2.5, 7.5))
+    assert np.allclose(lat[:, 0], (45., 55.))
+
+
+def test_layers():
+    grid = CyConcentrationGrid(bounds=((0., 0.), (2., 1.)), shape=(1, 2),
+                               depth_edges=(0., 1., 5.))
+    binned, cells = grid.add_mass(positions, mass)
+
+    assert grid.num_layers == 2
+    assert binned == 3
+    assert grid.mass[0].sum() == 3.
+    assert grid.mass[1, 0, 1] == 4.
+
+
+def test_triangles():
+    locator = CyGridLocator(nodes, faces)
+    grid = CyConcentrationGrid(locator=locator, depth_edges=(0., 5.))
+    binned, cells = grid.add_mass(positions, mass)
+
+    assert grid.num_cells == 4
+    assert binned == 3
+    assert list(cells) == [0, 1, 2, -1]
+    assert list(grid.mass[0]) == [1., 2., 4., 0.]
+
+    # half a square degree each, near the equator
+    assert np.allclose(grid.cell_areas, 0.5 * 111120. ** 2, rtol=1e-3)
+
+    # started from the triangles they were in
+    grid.clear()
+    hinted = grid.add_mass(positions, mass, cells)
+    assert np.array_equal(hinted[1], cells)
+    assert list(grid.mass[0]) == [1., 2., 4., 0.]
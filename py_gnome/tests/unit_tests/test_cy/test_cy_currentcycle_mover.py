@@ -93,7 +93,7 @@ class TestCurrentCycleMover:
 
     def move_uncertain(self):
         self.ccm.prepare_for_model_run()
-        spill_size = np.zeros((1, ), dtype=np.int32)  # number of LEs in 1 uncertainty spill - simple test   
+        spill_size = np.zeros((1, ), dtype=np.int64)  # number of LEs in 1 uncertainty spill - simple test   
         spill_size[0] = self.cm.num_le  # for uncertainty spills
         start_pos=(-76.149368,37.74496,0)
 
@@ -0,0 +1,77 @@
+'''
+tests the py movers' moves on a triangle grid integrated in lib_gnome
+'''
+import numpy as np
+import pytest
+
+from gnome.cy_gnome.cy_grid_locator import CyGridLocator
+from gnome.cy_gnome.cy_grid_integrator import CyGridIntegrator
+from gnome.utilities.projections import FlatEarthProjection
+
+nodes = np.array([(0., 0.), (1., 0.), (1., 1.), (0., 1.), (2., 0.), (2., 1.)])
+faces = np.array([(0, 1, 2), (0, 3, 2), (1, 4, 5), (1, 5, 2)])
+
+positions = np.array([(0.5, 0.5, 0.),
+                      (1.5, 0.5, 0.),
+                      (3.0, 0.5, 0.)])
+
+time_step = 3600.
+
+# an eastward current, with a northward part that grows to the east
+u = np.ones((len(nodes),))
+v = nodes[:, 0].copy()
+
+
+@pytest.fixture
+def integrator():
+    return CyGridIntegrator(CyGridLocator(nodes, faces))
+
+
+def test_euler(integrator):
+    deltas = integrator.get_moves(positions, time_step, 'Euler', u, v)
+
+    assert np.allclose(deltas[:, 0], (time_step, time_step, 0.))
+    assert np.allclose(deltas[:, 1], (0.5 * time_step, 1.5 * time_step, 0.))
+
+
+@pytest.mark.parametrize('method', ['Trapezoid', 'RK4'])
+def test_linear_field(integrator, method):
+    '''
+    the northward current at the end of the move is that of where the
+    eastward current took the elements
+    '''
+    deltas = integrator.get_moves(positions, time_step, method,
+                                  u, v, u, v, u, v)
+
+    d_lon = FlatEarthProjection.meters_to_lonlat(np.array([(time_step, 0., 0.)]),
+                                                 positions[:1])[0, 0]
+
+    assert np.allclose(deltas[:2, 0], time_step)
+    assert np.allclose(deltas[:2, 1],
+                       (positions[:2, 0] + d_lon / 2) * time_step)
+    assert np.all(deltas[2] == 0)
+
+
+def test_steps(integrator):
+    '''
+    a later step, velocities changed in time: the same moves as without
+    the triangles of the step before
+    '''
+    integrator.get_moves(positions, time_step, 'RK4', u, v)
+    later = integrator.get_moves(positions, time_step, 'RK4',
+                                 u, v, 2 * u, 2 * v, 3 * u, 3 * v)
+
+    fresh = CyGridIntegrator(integrator.locator)
+    expected = fresh.get_moves(positions, time_step, 'RK4',
+                               u, v, 2 * u, 2 * v, 3 * u, 3 * v)
+
+    assert np.allclose(later, expected)
+    assert np.allclose(later[:2, 0], time_step * 2)
+
+
+def test_bad_arguments(integrator):
+    with pytest.raises(ValueError):
+        integrator.get_moves(positions, time_step, 'Midpoint', u, v)
+
+    with pytest.raises(ValueError):
+        integrator.get_moves(positions, time_step, 'Euler', u[:-1], v)
@@ -0,0 +1,94 @@
+'''
+tests the grid locator: the points of a triangle grid located with the DAG
+tree interpolate as the grid library does
+'''
+import numpy as np
+import pytest
+
+import pyugrid
+
+from gnome.cy_gnome.cy_grid_locator import CyGridLocator
+from gnome.environment import grid_locator
+
+# a 2 x 1 rectangle of four triangles, in both orders
+nodes = np.array([(0., 0.), (1., 0.), (1., 1.), (0., 1.), (2., 0.), (2., 1.)])
+faces = np.array([(0, 1, 2), (0, 3, 2), (1, 4, 5), (1, 5, 2)])
+
+points = np.array([(0.7, 0.2, 0.),
+                   (0.2, 0.8, 0.),
+                   (1.5, 0.5, 0.),
+                   (3.0, 0.5, 0.)])
+
+
+def test_build():
+    locator = CyGridLocator(nodes, faces)
+
+    assert locator.num_nodes == 6
+    assert locator.num_triangles == 4
+
+
+def test_bad_faces():
+    with pytest.raises(ValueError):
+        CyGridLocator(nodes, np.array([(0, 1, 7)]))
+
+    with pytest.raises(ValueError):
+        CyGridLocator(nodes, np.array([(0, 1, 2, 3)]))
+
+
+def test_locate():
+    locator = CyGridLocator(nodes, faces)
+    tri, node, alpha = locator.locate(points)
+
+    assert list(tri) == [0, 1, 2, -1]
+    assert np.allclose(alpha[:3].sum(axis=1), 1.)
+    assert np.all(node[3] == -1)
+
+    # each point is the weighted sum of its triangle's nodes
+    for i in range(3):
+        assert np.allclose((nodes[node[i]] * alpha[i][:, None]).sum(axis=0),
+                           points[i, :2])
+
+    # started from the triangles they were in
+    hinted = locator.locate(points, tri)
+    assert np.array_equal(hinted[0], tri)
+    assert np.allclose(hinted[2], alpha)
+
+
+def test_interpolate():
+    locator = CyGridLocator(nodes, faces)
+    tri, node, alpha = locator.locate(points)
+
+    # a linear field is interpolated exactly
+    values = 2 * nodes[:, 0] - nodes[:, 1]
+    result = locator.interpolate(tri, node, alpha, values, fill=-999.)
+
+    assert np.allclose(result[:3], 2 * points[:3, 0] - points[:3, 1])
+    assert result[3] == -999.
+
+    with pytest.raises(ValueError):
+        locator.interpolate(tri, node, alpha, values[:-1])
+
+
+def test_interpolate_var_to_points():
+    '''
+    the variables on the nodes of a UGrid go through the grid's locator,
+    which locates the points once for all of them
+    '''
+    grid = pyugrid.UGrid(nodes=nodes, faces=faces)
+    inside = points[:3]
+
+    # a time series of two node variables
+    u = np.array([nodes[:, 0], 2 * nodes[:, 0]])
+    v = np.array([nodes[:, 1], 3 * nodes[:, 1]])
+
+    for var in (u, v):
+        expected = grid.interpolate_var_to_points(inside, var, slices=[1])
+        result = grid_locator.interpolate_var_to_points(grid, inside, var,
+                                                        slices=[1])
+        assert np.allclose(result, expected)
+
+    cache = grid_locator._locators[grid]
+    assert len(cache._weights) == 1
+
+    cache.clear()
+    assert len(cache._weights) == 0
@@ -13,9 +13,10 @@ import pytest
 from gnome.basic_types import world_point, status_code_type, \
     spill_type, oil_status
 
+from gnome.cy_gnome import cy_helpers
 from gnome.cy_gnome.cy_gridcurrent_mover import CyGridCurrentMover
 
-from gnome.utilities import time_utils
+from gnome.utilities import time_utils, synthetic_forcing
 from ..conftest import testdata
 
 
@@ -64,6 +65,913 @@ def test_init():
         assert getattr(gcm, key) == val
 
 
+def test_num_threads():
+    gcm = CyGridCurrentMover()
+    assert gcm.num_threads == 1
+
+    gcm.num_threads = 4
+    assert gcm.num_threads == 4
+
+    gcm.num_threads = 0  # anything less than 1 means serial
+    assert gcm.num_threads == 1
+
+
+@pytest.mark.slow
+def test_move_num_threads():
+    """
+    the parallel get_move loop gives the same deltas as the serial one
+    """
+    num_le = 100
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+
+    deltas = []
+    for num_threads in (1, 4):
+        gcm.num_threads = num_threads
+        delta = np.zeros((num_le, ), dtype=world_point)
+
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+        gcm.model_step_is_done()
+
+        deltas.append(delta)
+
+    np.testing.assert_equal(deltas[0], deltas[1])
+
+
+@pytest.mark.slow
+def test_shared_time_slice_cache():
+    """
+    two movers on the same file share the loaded slices when the cache is
+    on, and still give the same deltas as without it
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for cache_size in (0, 1 << 30):
+        cy_helpers.set_time_slice_cache_size(cache_size)
+        movers = [CyGridCurrentMover(), CyGridCurrentMover()]
+        for gcm in movers:
+            gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+
+        if cache_size:
+            assert cy_helpers.get_time_slice_cache_size()[1] > 0
+
+        for gcm in movers:
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm.get_move(model_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            deltas.append(delta)
+
+        del movers, gcm
+
+    cy_helpers.set_time_slice_cache_size(0)
+
+
+@pytest.mark.slow
+def test_quantized_time_slices():
+    """
+    quantized slices give the same deltas to the mover that read them and
+    to the one that shares them, within the reported error of the
+    unquantized deltas
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    cy_helpers.set_time_slice_cache_size(1 << 30)
+    for quantize in (False, True):
+        cy_helpers.set_time_slice_quantization(quantize)
+        assert cy_helpers.get_time_slice_quantization() == quantize
+        movers = [CyGridCurrentMover(), CyGridCurrentMover()]
+        for gcm in movers:
+            gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+
+        for gcm in movers:
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm.get_move(model_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            deltas.append(delta)
+
+        del movers, gcm
+
+    error = cy_helpers.get_time_slice_quantization_error()
+    cy_helpers.set_time_slice_quantization(False)
+    cy_helpers.set_time_slice_cache_size(0)
+
+    assert 0 < error < 1e-3
+    np.testing.assert_equal(deltas[2], deltas[3])
+    # a meter a second off is time_step meters of movement, in degrees
+    # of latitude
+    np.testing.assert_allclose(deltas[2]['lat'], deltas[0]['lat'],
+                               rtol=0, atol=error * time_step / 1e5)
+
+
+def test_topology_cache(tmpdir):
+    """
+    a curvilinear grid read with the topology cache on writes a cache file,
+    reading it again uses that file and moves the LEs the same as without
+    """
+    num_le = 4
+    model_time = time_utils.date_to_sec(datetime.datetime(2008, 1, 29, 17))
+    time_step = 900
+    time_grid_file = testdata['GridCurrentMover']['curr_curv']
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = -74.03988
+    ref[:]['lat'] = 40.536092
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for cache_dir in (None, str(tmpdir), str(tmpdir)):
+        cy_helpers.set_topology_cache_dir(cache_dir)
+        gcm = CyGridCurrentMover()
+        gcm.text_read(time_grid_file, topology_file=None)
+
+        if cache_dir:
+            assert len(tmpdir.listdir(lambda p: p.ext == '.gnometopo')) == 1
+
+        delta = np.zeros((num_le, ), dtype=world_point)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+        gcm.model_step_is_done()
+        deltas.append(delta)
+
+    cy_helpers.set_topology_cache_dir(None)
+    assert cy_helpers.get_topology_cache_dir() == ''
+
+    np.testing.assert_equal(deltas[0], deltas[1])
+    np.testing.assert_equal(deltas[0], deltas[2])
+    assert cy_helpers.get_time_slice_cache_size() == (0, 0)
+
+    for delta in deltas[1:]:
+        np.testing.assert_equal(deltas[0], delta)
+
+
+def test_forcing_block_cache_local_files(tmpdir):
+    """
+    the forcing block cache only keeps what is read from a server: a local
+    file is read as it is with the cache off
+    """
+    model_time = time_utils.date_to_sec(datetime.datetime(2008, 1, 29, 17))
+    time_grid_file = testdata['GridCurrentMover']['curr_curv']
+    before = cy_helpers.get_forcing_block_cache_stats()
+
+    cy_helpers.set_forcing_block_cache_dir(str(tmpdir))
+    assert cy_helpers.get_forcing_block_cache_dir() == str(tmpdir)
+    try:
+        gcm = CyGridCurrentMover()
+        gcm.text_read(time_grid_file, topology_file=None)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, 900)
+        gcm.model_step_is_done()
+    finally:
+        cy_helpers.set_forcing_block_cache_dir(None)
+
+    assert cy_helpers.get_forcing_block_cache_dir() == ''
+    assert cy_helpers.get_forcing_block_cache_stats() == before
+    assert len(tmpdir.listdir(lambda p: p.ext == '.gnomeblock')) == 0
+
+
+@pytest.mark.parametrize(('curr', 'when', 'lon', 'lat'),
+                         [('curr_reg', (1999, 11, 29, 21), 3.1, 52.016468),
+                          ('curr_curv', (2008, 1, 29, 17), -74.03988, 40.536092)])
+def test_forcing_file(tmpdir, curr, when, lon, lat):
+    """
+    a grid reading its slices, and the curvilinear grid its topology, from
+    a forcing file moves the LEs the same as reading the NetCDF file
+    """
+    num_le = 4
+    model_time = time_utils.date_to_sec(datetime.datetime(*when))
+    time_step = 900
+    time_grid_file = testdata['GridCurrentMover'][curr]
+    forcing_file = str(tmpdir.join('forcing.gnf'))
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = lon
+    ref[:]['lat'] = lat
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(time_grid_file, topology_file=None)
+    gcm.write_forcing_file(forcing_file)
+    del gcm
+
+    deltas = []
+    for use_forcing in (False, True):
+        if use_forcing:
+            cy_helpers.open_forcing_file(forcing_file)
+            assert cy_helpers.get_num_forcing_files() == 1
+        try:
+            gcm = CyGridCurrentMover()
+            gcm.text_read(time_grid_file, topology_file=None)
+
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+            gcm.get_move(model_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            del gcm
+            deltas.append(delta)
+        finally:
+            cy_helpers.close_forcing_files()
+
+    assert cy_helpers.get_num_forcing_files() == 0
+    assert np.any(deltas[0]['lat'] != 0)
+    np.testing.assert_equal(deltas[0], deltas[1])
+
+    with pytest.raises(OSError):
+        cy_helpers.open_forcing_file(time_grid_file)
+
+
+def test_time_index_cache(tmpdir):
+    """
+    a list of NetCDF files read with the time index on indexes the files'
+    times, and moves the LEs the same as the file read alone
+    """
+    num_le = 4
+    model_time = time_utils.date_to_sec(datetime.datetime(2008, 1, 29, 17))
+    time_step = 900
+    time_grid_file = testdata['GridCurrentMover']['curr_curv']
+
+    file_list = tmpdir.join('file_list.txt')
+    file_list.write('NetCDF Files\n[FILE] {0}\n'
+                    .format(os.path.abspath(time_grid_file)))
+    index_dir = tmpdir.mkdir('index')
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = -74.03988
+    ref[:]['lat'] = 40.536092
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    cy_helpers.set_time_index_cache_dir(str(index_dir))
+    try:
+        for path in (time_grid_file, str(file_list), str(file_list)):
+            gcm = CyGridCurrentMover()
+            gcm.text_read(path, topology_file=None)
+
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+            gcm.get_move(model_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            deltas.append(delta)
+
+        assert len(index_dir.listdir(lambda p: p.ext == '.gnometimes')) == 1
+    finally:
+        cy_helpers.set_time_index_cache_dir(None)
+
+    assert cy_helpers.get_time_index_cache_dir() == ''
+
+    for delta in deltas[1:]:
+        np.testing.assert_equal(deltas[0], delta)
+
+
+@pytest.mark.parametrize(('key', 'when', 'long', 'lat'),
+                         [('ptCur', (2000, 2, 14, 10),
+                           -124.686928, 48.401124),
+                          ('grid_ts', (2002, 1, 30, 1),
+                           -119.933264, 34.138736)])
+def test_time_block_index(tmpdir, key, when, long, lat):
+    """
+    an ASCII file read with the time index on indexes its [TIME] blocks once,
+    and moves the LEs the same from the index as from the scan
+    """
+    num_le = 4
+    model_time = time_utils.date_to_sec(datetime.datetime(*when))
+    time_step = 900
+    time_grid_file = testdata['GridCurrentMover'][key]
+    index_dir = tmpdir.mkdir('index')
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = long
+    ref[:]['lat'] = lat
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    try:
+        for index in (None, str(index_dir), str(index_dir)):
+            cy_helpers.set_time_index_cache_dir(index)
+
+            gcm = CyGridCurrentMover()
+            gcm.text_read(time_grid_file)
+
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+            gcm.get_move(model_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            deltas.append(delta)
+
+        assert len(index_dir.listdir(lambda p: p.ext == '.gnometimes')) == 1
+    finally:
+        cy_helpers.set_time_index_cache_dir(None)
+
+    assert np.any(deltas[0]['long'] != 0)
+    for delta in deltas[1:]:
+        np.testing.assert_equal(deltas[0], delta)
+
+
+@pytest.mark.slow
+def test_active_window():
+    """
+    reading only the cells around the LEs gives the same deltas as
+    reading the whole grid, also after the LEs move out of the window
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+    windowed = CyGridCurrentMover()
+    windowed.text_read(testdata['GridCurrentMover']['curr_reg'])
+    windowed.set_active_window(True, halo=2)
+    assert windowed.active_window
+
+    for gcm_ in (gcm, windowed):
+        gcm_.prepare_for_model_run()
+
+    for lon in ((3.0, 3.01), (3.0, 3.2)):
+        ref = np.zeros((num_le, ), dtype=world_point)
+        ref[:]['long'] = np.linspace(lon[0], lon[1], num_le)
+        ref[:]['lat'] = 52.016468
+
+        deltas = []
+        for gcm_ in (gcm, windowed):
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm_.prepare_for_model_step(model_time, time_step)
+            gcm_.get_move(model_time, time_step, ref, delta, status,
+                          spill_type.forecast)
+            gcm_.model_step_is_done()
+            deltas.append(delta)
+
+        np.testing.assert_equal(deltas[0], deltas[1])
+        model_time += time_step
+
+
+@pytest.mark.slow
+def test_active_window_bounds():
+    """
+    a window started at bounds gives the same deltas as the whole grid for
+    the LEs in it, and after they move out of it
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+    windowed = CyGridCurrentMover()
+    windowed.text_read(testdata['GridCurrentMover']['curr_reg'])
+
+    # only with the window on, and on the grid
+    assert not windowed.set_active_window_bounds(((3.0, 52.0), (3.05, 52.03)))
+    windowed.set_active_window(True, halo=2)
+    assert not windowed.set_active_window_bounds(((100., 0.), (101., 1.)))
+    assert windowed.set_active_window_bounds(((3.0, 52.0), (3.05, 52.03)))
+
+    for gcm_ in (gcm, windowed):
+        gcm_.prepare_for_model_run()
+
+    for lon in ((3.0, 3.05), (3.0, 3.2)):
+        ref = np.zeros((num_le, ), dtype=world_point)
+        ref[:]['long'] = np.linspace(lon[0], lon[1], num_le)
+        ref[:]['lat'] = 52.016468
+
+        deltas = []
+        for gcm_ in (gcm, windowed):
+            delta = np.zeros((num_le, ), dtype=world_point)
+            gcm_.prepare_for_model_step(model_time, time_step)
+            gcm_.get_move(model_time, time_step, ref, delta, status,
+                          spill_type.forecast)
+            gcm_.model_step_is_done()
+            deltas.append(delta)
+
+        np.testing.assert_equal(deltas[0], deltas[1])
+        model_time += time_step
+
+
+def test_forcing_io_stats(tmpdir):
+    """
+    reading the times of a file alone is counted for the file: one open
+    kept for all of them, and the bytes of the u and v of each time read
+    """
+    filename = str(tmpdir.join('rect.nc'))
+    info = synthetic_forcing.write_forcing('rectilinear', filename,
+                                           shape=(20, 30), num_times=5)
+    slice_bytes = 2 * 20 * 30 * 4    # u and v, float32
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(filename)
+
+    cy_helpers.reset_forcing_io_stats()
+    for hour in range(info['num_times'] - 1):
+        model_time = info['start_time'] + datetime.timedelta(hours=hour)
+        gcm.load_interval(time_utils.date_to_sec(model_time))
+
+    stats = cy_helpers.get_forcing_io_stats()[filename]
+
+    assert stats['opens'] <= 1
+    assert stats['closes'] == 0
+    assert stats['nc_calls'] > 0
+    assert stats['slice_misses'] + stats['prefetches_used'] == \
+        info['num_times']
+    assert stats['bytes_read'] == \
+        (stats['slice_misses'] + stats['prefetches']) * slice_bytes
+
+    cy_helpers.reset_forcing_io_stats()
+    assert cy_helpers.get_forcing_io_stats() == {}
+
+
+@pytest.mark.slow
+def test_single_precision():
+    """
+    float32 reads give the same deltas as the double reads for float data
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for single in (False, True):
+        gcm = CyGridCurrentMover()
+        gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+        gcm.single_precision = single
+        assert gcm.single_precision == single
+
+        delta = np.zeros((num_le, ), dtype=world_point)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+        gcm.model_step_is_done()
+        deltas.append(delta)
+
+    np.testing.assert_equal(deltas[0], deltas[1])
+
+
+def test_interpolated_field():
+    """
+    blending the time slices once per step gives the same deltas as
+    blending them per LE
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for use_field in (False, True):
+        gcm = CyGridCurrentMover()
+        gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+        gcm.interpolated_field = use_field
+        assert gcm.interpolated_field == use_field
+
+        gcm.prepare_for_model_run()
+        for step in range(3):
+            delta = np.zeros((num_le, ), dtype=world_point)
+            step_time = model_time + step * time_step
+            gcm.prepare_for_model_step(step_time, time_step)
+            gcm.get_move(step_time, time_step, ref, delta, status,
+                         spill_type.forecast)
+            gcm.model_step_is_done()
+            deltas.append(delta)
+
+    for step in range(3):
+        assert np.all(deltas[step]['lat'] != 0)
+        np.testing.assert_equal(deltas[step], deltas[step + 3])
+
+
+def test_cell_binning():
+    """
+    binning the LEs by cell gives the same deltas as a velocity per LE
+    """
+    num_le = 40
+    model_time = time_utils.date_to_sec(datetime.datetime(2008, 1, 29, 17))
+    time_step = 900
+
+    # a few LEs to a cell, in no order
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.tile(np.linspace(-74.042, -74.038, 4), 10)
+    ref[:]['lat'] = np.repeat(np.linspace(40.535, 40.537, 10), 4)
+    ref[::3]['z'] = 2.
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for binning in (False, True):
+        gcm = CyGridCurrentMover()
+        gcm.text_read(testdata['GridCurrentMover']['curr_curv'],
+                      topology_file=None)
+        gcm.cell_binning = binning
+        assert gcm.cell_binning == binning
+
+        delta = np.zeros((num_le, ), dtype=world_point)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+        gcm.model_step_is_done()
+        deltas.append(delta)
+
+    assert np.any(deltas[0]['lat'] != 0)
+    np.testing.assert_equal(deltas[0], deltas[1])
+
+
+def test_cell_caches():
+    """
+    the cell centers and cell data are kept by the grid and seen by numpy
+    without copies, read only
+    """
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover']['curr_curv'],
+                  topology_file=None)
+
+    for get in (gcm._get_center_points, gcm._get_cell_data):
+        first = get()
+        second = get()
+
+        assert len(first) > 0
+        assert not first.flags.writeable
+        assert np.may_share_memory(first, second)
+        np.testing.assert_equal(first, second)
+
+
+@pytest.mark.slow
+def test_water_node_layout():
+    """
+    keeping only the water nodes gives the same deltas as the whole grid,
+    per LE and in a batch
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(2015, 5, 14, 0))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = -164.01696 + np.linspace(-.05, .05, num_le)
+    ref[:]['lat'] = 72.921024 + np.linspace(-.05, .05, num_le)
+    ref[0]['long'] = 0  # off the grid
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for water_nodes in (False, True):
+        gcm = CyGridCurrentMover()
+        gcm.text_read(testdata['GridCurrentMover']['ice_curr_curv'],
+                      testdata['GridCurrentMover']['ice_top_curv'])
+        gcm.water_node_layout = water_nodes
+        assert gcm.water_node_layout == water_nodes
+
+        delta = np.zeros((num_le, ), dtype=world_point)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+
+        delta_lat = np.zeros((num_le, ))
+        delta_lon = np.zeros((num_le, ))
+        delta_z = np.zeros((num_le, ))
+        gcm.get_move_batch(model_time, time_step,
+                           np.ascontiguousarray(ref['lat']),
+                           np.ascontiguousarray(ref['long']),
+                           np.ascontiguousarray(ref['z']),
+                           status, delta_lat, delta_lon, delta_z,
+                           spill_type.forecast)
+        gcm.model_step_is_done()
+        np.testing.assert_equal(delta_lat, delta['lat'])
+        np.testing.assert_equal(delta_lon, delta['long'])
+        deltas.append(delta)
+
+    assert np.any(deltas[0]['lat'] != 0)
+    np.testing.assert_equal(deltas[0], deltas[1])
+
+
+@pytest.mark.slow
+def test_nearest_node():
+    """
+    with the nearest node an LE off the grid moves, per LE and in a batch
+    alike, and the LEs on the grid move as before
+    """
+    num_le = 10
+    model_time = time_utils.date_to_sec(datetime.datetime(2015, 5, 14, 0))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = -164.01696 + np.linspace(-.05, .05, num_le)
+    ref[:]['lat'] = 72.921024 + np.linspace(-.05, .05, num_le)
+    ref[0]['long'] = 0  # off the grid
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    deltas = []
+    for nearest_node in (False, True):
+        gcm = CyGridCurrentMover()
+        gcm.text_read(testdata['GridCurrentMover']['ice_curr_curv'],
+                      testdata['GridCurrentMover']['ice_top_curv'])
+        gcm.nearest_node = nearest_node
+        assert gcm.nearest_node == nearest_node
+
+        delta = np.zeros((num_le, ), dtype=world_point)
+        gcm.prepare_for_model_run()
+        gcm.prepare_for_model_step(model_time, time_step)
+        gcm.get_move(model_time, time_step, ref, delta, status,
+                     spill_type.forecast)
+
+        delta_lat = np.zeros((num_le, ))
+        delta_lon = np.zeros((num_le, ))
+        delta_z = np.zeros((num_le, ))
+        gcm.get_move_batch(model_time, time_step,
+                           np.ascontiguousarray(ref['lat']),
+                           np.ascontiguousarray(ref['long']),
+                           np.ascontiguousarray(ref['z']),
+                           status, delta_lat, delta_lon, delta_z,
+                           spill_type.forecast)
+        gcm.model_step_is_done()
+        np.testing.assert_equal(delta_lat, delta['lat'])
+        np.testing.assert_equal(delta_lon, delta['long'])
+        deltas.append(delta)
+
+    assert deltas[0][0]['lat'] == 0 and deltas[0][0]['long'] == 0
+    assert deltas[1][0]['lat'] != 0 or deltas[1][0]['long'] != 0
+    np.testing.assert_equal(deltas[0][1:], deltas[1][1:])
+
+
+@pytest.mark.slow
+def test_move_rk4_staged():
+    """
+    RK4 on a prepared step runs stage by stage, it gives the same deltas
+    as the per LE RK4 used when the step is not prepared
+    """
+    num_le = 100
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    gcm = CyGridCurrentMover(num_method=1)
+    gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+    gcm.prepare_for_model_run()
+
+    per_le = np.zeros((num_le, ), dtype=world_point)
+    gcm.get_move(model_time, time_step, ref, per_le, status,
+                 spill_type.forecast)
+
+    staged = np.zeros((num_le, ), dtype=world_point)
+    gcm.prepare_for_model_step(model_time, time_step)
+    gcm.get_move(model_time, time_step, ref, staged, status,
+                 spill_type.forecast)
+    gcm.model_step_is_done()
+
+    assert np.all(staged['long'] != 0)
+    np.testing.assert_equal(per_le, staged)
+
+
+def test_move_adaptive():
+    """
+    adaptive is Euler for the LEs under max_courant, RK4 for the others
+    """
+    num_le = 100
+    model_time = time_utils.date_to_sec(datetime.datetime(1999, 11, 29, 21))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = np.linspace(3.0, 3.2, num_le)
+    ref[:]['lat'] = 52.016468
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+    status[-1] = 0  # not in water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover']['curr_reg'])
+    gcm.prepare_for_model_run()
+
+    deltas = {}
+    for method in (0, 1):
+        gcm.num_method = method
+        deltas[method] = np.zeros((num_le, ), dtype=world_point)
+        gcm.get_move(model_time, time_step, ref, deltas[method], status,
+                     spill_type.forecast)
+
+    courant = gcm.get_courant_numbers(model_time, time_step,
+                                      np.ascontiguousarray(ref['lat']),
+                                      np.ascontiguousarray(ref['long']),
+                                      np.ascontiguousarray(ref['z']),
+                                      status)
+    assert np.all(courant[:-1] > 0)
+    assert courant[-1] == 0
+
+    gcm.num_method = 2
+    gcm.max_substeps = 1
+    for max_courant, method in ((1e10, 0), (1e-10, 1)):
+        gcm.max_courant = max_courant
+        adaptive = np.zeros((num_le, ), dtype=world_point)
+        gcm.get_move(model_time, time_step, ref, adaptive, status,
+                     spill_type.forecast)
+
+        np.testing.assert_allclose(adaptive['lat'], deltas[method]['lat'],
+                                   rtol=1e-12, atol=0)
+        np.testing.assert_allclose(adaptive['long'], deltas[method]['long'],
+                                   rtol=1e-12, atol=0)
+
+    # sub-steps move the LEs about as far as one step does
+    gcm.max_substeps = 8
+    adaptive = np.zeros((num_le, ), dtype=world_point)
+    gcm.get_move(model_time, time_step, ref, adaptive, status,
+                 spill_type.forecast)
+    np.testing.assert_allclose(adaptive['long'], deltas[1]['long'],
+                               rtol=1e-2)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize(('curr', 'top', 'when', 'lon', 'lat'),
+                         [('curr_reg', None, (1999, 11, 29, 21),
+                           3.104588, 52.016468),
+                          ('curr_tri', 'top_tri', (2004, 12, 31, 13),
+                           -76.149368, 37.74496),
+                          ('curr_curv', 'top_curv', (2008, 1, 29, 17),
+                           -74.03988, 40.536092),
+                          ('series_curv', 'series_top', (2009, 8, 9, 0),
+                           -157.795728, 21.069288)])
+def test_get_move_batch(curr, top, when, lon, lat):
+    """
+    get_move_batch interpolates the LEs as one batch, with the vector kernel
+    or the scalar loop it gives the same deltas as get_move. The regular and
+    curvilinear grids read their fields through TimeGridFieldView, the
+    curvilinear ones with velocities at the cell centers, HiROMS with depth
+    levels
+    """
+    num_le = 11  # not a multiple of the vector width
+    model_time = time_utils.date_to_sec(datetime.datetime(*when))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = lon + np.linspace(-.01, .01, num_le)
+    ref[:]['lat'] = lat + np.linspace(-.01, .01, num_le)
+    ref[0]['long'] = 0  # off the grid
+    ref[1]['z'] = 2  # below the surface
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+    status[2] = 0  # not in water
+
+    gcm = CyGridCurrentMover()
+    gcm.text_read(testdata['GridCurrentMover'][curr],
+                  testdata['GridCurrentMover'][top] if top else None)
+    gcm.prepare_for_model_run()
+
+    per_le = np.zeros((num_le, ), dtype=world_point)
+    gcm.get_move(model_time, time_step, ref, per_le, status,
+                 spill_type.forecast)
+    assert np.any(per_le['lat'] != 0)
+
+    for use_simd in (True, False):
+        cy_helpers.set_interpolation_simd(use_simd)
+        if not use_simd:
+            assert cy_helpers.get_interpolation_kernel() == 'scalar'
+
+        delta_lat = np.zeros((num_le, ))
+        delta_lon = np.zeros((num_le, ))
+        delta_z = np.zeros((num_le, ))
+        gcm.get_move_batch(model_time, time_step,
+                           np.ascontiguousarray(ref['lat']),
+                           np.ascontiguousarray(ref['long']),
+                           np.ascontiguousarray(ref['z']),
+                           status, delta_lat, delta_lon, delta_z,
+                           spill_type.forecast)
+
+        np.testing.assert_equal(delta_lat, per_le['lat'])
+        np.testing.assert_equal(delta_lon, per_le['long'])
+
+    cy_helpers.set_interpolation_simd(True)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize(('grid', 'when', 'lon', 'lat'),
+                         [('tri', (2004, 12, 31, 13), -76.149368, 37.74496),
+                          ('curv', (2008, 1, 29, 17), -74.03988, 40.536092)])
+def test_interpolation_device(grid, when, lon, lat):
+    """
+    with the CUDA kernel, the Euler get_move_batch and the RK4 stages give
+    the deltas of the cpu kernels
+    """
+    if not cy_helpers.set_interpolation_device(True):
+        assert cy_helpers.get_interpolation_kernel() != 'cuda'
+        pytest.skip('lib_gnome was built without GNOME_CUDA, or no device')
+
+    num_le = 11
+    model_time = time_utils.date_to_sec(datetime.datetime(*when))
+    time_step = 900
+
+    ref = np.zeros((num_le, ), dtype=world_point)
+    ref[:]['long'] = lon + np.linspace(-.01, .01, num_le)
+    ref[:]['lat'] = lat + np.linspace(-.01, .01, num_le)
+    ref[0]['long'] = 0  # off the grid
+    status = np.empty((num_le, ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+    status[2] = 0  # not in water
+
+    try:
+        for num_method in (0, 1):  # Euler, RK4
+            gcm = CyGridCurrentMover(num_method=num_method)
+            gcm.text_read(testdata['GridCurrentMover']['curr_' + grid],
+                          testdata['GridCurrentMover']['top_' + grid])
+            gcm.prepare_for_model_run()
+            gcm.prepare_for_model_step(model_time, time_step)
+
+            deltas = []
+            for use_device in (False, True):
+                assert (cy_helpers.set_interpolation_device(use_device) ==
+                        use_device)
+
+                delta = np.zeros((num_le, ), dtype=world_point)
+                if num_method == 0:
+                    delta_lat = np.zeros((num_le, ))
+                    delta_lon = np.zeros((num_le, ))
+                    gcm.get_move_batch(model_time, time_step,
+                                       np.ascontiguousarray(ref['lat']),
+                                       np.ascontiguousarray(ref['long']),
+                                       np.ascontiguousarray(ref['z']),
+                                       status, delta_lat, delta_lon,
+                                       np.zeros((num_le, )),
+                                       spill_type.forecast)
+                    delta['lat'] = delta_lat
+                    delta['long'] = delta_lon
+                else:
+                    gcm.get_move(model_time, time_step, ref, delta, status,
+                                 spill_type.forecast)
+                deltas.append(delta)
+
+            gcm.model_step_is_done()
+
+            assert np.any(deltas[0]['lat'] != 0)
+            np.testing.assert_equal(deltas[1], deltas[0])
+    finally:
+        cy_helpers.set_interpolation_device(False)
+
+
 @pytest.mark.slow
 class TestGridCurrentMover:
 
@@ -89,7 +997,7 @@ class TestGridCurrentMover:
 
     def move_uncertain(self):
         self.gcm.prepare_for_model_run()
-        spill_size = np.zeros((1, ), dtype=np.int32)  # number of LEs in 1 uncertainty spill - simple test   
+        spill_size = np.zeros((1, ), dtype=np.int64)  # number of LEs in 1 uncertainty spill - simple test   
         spill_size[0] = self.cm.num_le  # for uncertainty spills
         start_pos=(-76.149368,37.74496,0)
 
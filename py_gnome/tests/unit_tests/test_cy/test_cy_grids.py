@@ -4,8 +4,10 @@ test cython wrappers around grid objects
 import os
 from datetime import datetime
 
+import numpy as np
 import netCDF4 as nc
 
+from gnome.basic_types import world_point, velocity_rec
 from gnome.cy_gnome.cy_grid_rect import CyTimeGridWindRect
 from gnome.cy_gnome.cy_grid_curv import CyTimeGridWindCurv
 from gnome.utilities.time_utils import date_to_sec
@@ -42,3 +44,24 @@ def test_grid_wind_curv():
     vel = curv.get_value(time, (-122.934656, 38.27594))
     print "Curv grid - vel: {0}\n".format(vel)
     assert vel.item() != 0
+
+
+def test_grid_wind_curv_get_values():
+    '''
+    the batched get_values gives what get_value gives at each point
+    '''
+    curv = CyTimeGridWindCurv(testdata['GridWindMover']['wind_curv'],
+                              testdata['GridWindMover']['top_curv'])
+    time = date_to_sec(datetime(2006, 3, 31, 21))
+
+    points = np.zeros((3,), dtype=world_point)
+    points['long'] = (-122.934656, -122.9, -122.95)
+    points['lat'] = (38.27594, 38.3, 38.25)
+    vels = np.zeros((3,), dtype=velocity_rec)
+    hints = np.zeros((3,), dtype=np.int_) - 1
+
+    curv.get_values(time, points, vels, hints)
+
+    for p, v in zip(points, vels):
+        assert v == curv.get_value(time, (p['long'], p['lat']))
+    assert np.any(vels['u'] != 0)
@@ -81,7 +81,7 @@ class TestGridWindMover:
 
     def move_uncertain(self):
         self.gcm.prepare_for_model_run()
-        spill_size = np.zeros((1, ), dtype=np.int32)  # number of LEs in 1 uncertainty spill - simple test   
+        spill_size = np.zeros((1, ), dtype=np.int64)  # number of LEs in 1 uncertainty spill - simple test   
         spill_size[0] = self.cm.num_le  # for uncertainty spills
         start_pos=(-122.934656,38.27594,0)
 
@@ -5,13 +5,18 @@ test time conversions from date time to seconds and vice versa
 just a python script right now
 """
 
+import os
+import sys
 from datetime import datetime
 
 import numpy as np
+import pytest
 
 from gnome.cy_gnome import cy_helpers
 from gnome.utilities import time_utils
 from gnome import basic_types
+from gnome.cy_gnome.cy_shio_time import CyShioTime
+from ..conftest import testdata
 
 
 class TestCyDateTime:
@@ -91,6 +96,211 @@ class TestCyDateTime:
         assert tgt == act
 
 
+def test_dates_to_seconds_array():
+    '''
+    the array conversions give the seconds and dates of the one at a time
+    conversions, for dates across a DST change
+    '''
+    target = cy_helpers.CyDateTime()
+    times = (np.datetime64('2016-03-12T22:10:05') +
+             np.arange(0, 3 * 86400, 1250).astype('timedelta64[s]'))
+
+    seconds = cy_helpers.dates_to_seconds(times)
+    assert np.all(seconds == [time_utils.date_to_sec(t.astype(datetime))
+                              for t in times])
+
+    recs = cy_helpers.seconds_to_dates(seconds)
+    assert np.all(cy_helpers.dates_to_seconds(recs) == seconds)
+    for sec, rec in zip(seconds, recs):
+        assert target.SecondsToDate(sec) == rec
+
+    assert np.all(cy_helpers.seconds_to_datetime64(seconds) == times)
+    assert np.all(time_utils.sec_to_date(seconds) == times)
+
+
+def test_handle_pooling():
+    assert not cy_helpers.get_handle_pooling()
+    cy_helpers.set_handle_pooling(True)
+    assert cy_helpers.get_handle_pooling()
+    cy_helpers.set_handle_pooling(False)
+    assert not cy_helpers.get_handle_pooling()
+
+
+def test_time_slice_recycling():
+    assert not cy_helpers.get_time_slice_recycling()
+    cy_helpers.set_time_slice_recycling(True)
+    assert cy_helpers.get_time_slice_recycling()
+    cy_helpers.set_time_slice_recycling(False)
+    assert not cy_helpers.get_time_slice_recycling()
+
+
+def test_time_slice_interleaving():
+    '''
+    the slices are interleaved only on a machine of more than one node
+    '''
+    numa = cy_helpers.get_numa_node_count() > 1
+
+    assert not cy_helpers.get_time_slice_interleaving()
+    assert cy_helpers.set_time_slice_interleaving(True) == numa
+    assert cy_helpers.get_time_slice_interleaving() == numa
+    assert not cy_helpers.set_time_slice_interleaving(False)
+    assert not cy_helpers.get_time_slice_interleaving()
+
+
+@pytest.mark.skipif("sys.platform != 'linux2'")
+def test_huge_pages():
+    assert cy_helpers.get_huge_pages() == ('off', [])
+    assert cy_helpers.set_huge_pages('transparent', ('topology', 'dag_tree'))
+    assert cy_helpers.get_huge_pages() == ('transparent',
+                                           ['topology', 'dag_tree'])
+
+    assert not cy_helpers.set_huge_pages('off')
+
+    # the blocks on huge pages work like any others
+    shio_file = testdata['timeseries']['tide_shio']
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    time = [t + 3600. * dt for dt in range(60)]
+    expected = CyShioTime(shio_file).get_time_value(time)
+
+    cy_helpers.set_huge_pages('transparent', ('tide_tables',))
+    try:
+        shio = CyShioTime(shio_file)
+        np.testing.assert_equal(shio.get_time_value(time), expected)
+        del shio
+    finally:
+        assert not cy_helpers.set_huge_pages('off')
+
+    assert cy_helpers.get_huge_pages() == ('off', [])
+
+    with pytest.raises(ValueError):
+        cy_helpers.set_huge_pages('giant')
+
+
+def test_tlb_counters():
+    cy_helpers.open_tlb_counters()
+    counts = cy_helpers.read_tlb_counters()
+    cy_helpers.close_tlb_counters()
+
+    assert sorted(counts) == ['dtlb_load_misses', 'dtlb_store_misses',
+                              'itlb_load_misses']
+    assert all(c is None or c >= 0 for c in counts.itervalues())
+
+
+def test_section_counters():
+    opened = cy_helpers.open_section_counters()
+    try:
+        assert cy_helpers.section_counters_open() == opened
+        counts = cy_helpers.read_section_counters()
+    finally:
+        cy_helpers.close_section_counters()
+
+    assert not cy_helpers.section_counters_open()
+    assert sorted(counts) == ['branch_misses', 'cycles', 'instructions',
+                              'llc_misses']
+    assert all(c is None or c >= 0 for c in counts.itervalues())
+    if not opened:
+        assert all(c is None for c in counts.itervalues())
+
+
+@pytest.mark.parametrize("arena", (False, True))
+def test_handle_allocators_same_values(arena):
+    """
+    objects whose handles come from the pools or an arena work the same,
+    including after the arena has ended
+    """
+    shio_file = testdata['timeseries']['tide_shio']
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    time = [t + 3600. * dt for dt in range(60)]
+    expected = CyShioTime(shio_file).get_time_value(time)
+
+    if arena:
+        cy_helpers.begin_handle_arena()
+    else:
+        cy_helpers.set_handle_pooling(True)
+    try:
+        shio = CyShioTime(shio_file)
+        first = shio.get_time_value(time[:10])
+    finally:
+        if arena:
+            cy_helpers.end_handle_arena()
+        else:
+            cy_helpers.set_handle_pooling(False)
+
+    np.testing.assert_equal(first, expected[:10])
+    # recomputes its tide tables with the default allocator
+    np.testing.assert_equal(shio.get_time_value(time), expected)
+    del shio
+
+
+def test_memory_usage():
+    """
+    blocks are counted under the subsystem that made them, and the peaks
+    keep the high water mark
+    """
+    shio_file = testdata['timeseries']['tide_shio']
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    before = cy_helpers.get_memory_usage()
+
+    assert 'total' in before
+    for name in ('time_slices', 'topology', 'dag_tree', 'uncertainty',
+                 'tide_tables', 'other'):
+        assert name in before
+
+    cy_helpers.set_tide_table_cache_size(1)
+    try:
+        shio = CyShioTime(shio_file)
+        shio.get_time_value([t])
+        held = cy_helpers.get_memory_usage()
+
+        assert held['total']['bytes'] > before['total']['bytes']
+        assert held['total']['num_blocks'] > before['total']['num_blocks']
+        assert held['tide_tables']['bytes'] > before['tide_tables']['bytes']
+        assert held['total']['peak_bytes'] >= held['total']['bytes']
+        del shio
+    finally:
+        cy_helpers.set_tide_table_cache_size(0)
+
+    after = cy_helpers.get_memory_usage()
+    assert after['tide_tables']['bytes'] == before['tide_tables']['bytes']
+    assert after['total']['peak_bytes'] >= held['total']['bytes']
+
+    cy_helpers.reset_memory_peaks()
+    reset = cy_helpers.get_memory_usage()
+    assert reset['total']['peak_bytes'] == reset['total']['bytes']
+
+
+
+@pytest.mark.skipif(sys.platform == 'win32',
+                    reason='no POSIX shared memory')
+def test_share_handle_blocks():
+    """
+    shared blocks keep their values, and are only moved once
+    """
+    shio_file = testdata['timeseries']['tide_shio']
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    time = [t + 3600. * dt for dt in range(60)]
+    name = '/gnome_test_{0}'.format(os.getpid())
+
+    with pytest.raises(ValueError):
+        cy_helpers.share_handle_blocks(name, tags=('no_such_subsystem',))
+
+    cy_helpers.set_tide_table_cache_size(1)
+    try:
+        shio = CyShioTime(shio_file)
+        expected = shio.get_time_value(time)
+
+        # the cached tables are only copied from
+        moved = cy_helpers.share_handle_blocks(name, tags=('tide_tables',))
+        assert moved > 0
+        assert cy_helpers.share_handle_blocks(name + '_again',
+                                              tags=('tide_tables',)) == 0
+
+        np.testing.assert_equal(shio.get_time_value(time), expected)
+        del shio
+    finally:
+        cy_helpers.set_tide_table_cache_size(0)
+
+
 if __name__ == '__main__':
     a = TestCyDateTime()
     a.test_date_to_sec()
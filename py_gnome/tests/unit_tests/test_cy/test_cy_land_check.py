@@ -14,7 +14,20 @@ Designed to be run with py.test
 import pytest
 
 import numpy as np
-from gnome.cy_gnome.cy_land_check import overlap_grid, find_first_pixel
+
+from gnome.basic_types import oil_status
+from gnome.utilities.packed_bitmap import PackedBitmap
+from gnome.cy_gnome.cy_land_check import (overlap_grid,
+                                          find_first_pixel,
+                                          check_land_layers,
+                                          check_land_layers_batch,
+                                          land_count_table,
+                                          tile_occupancy,
+                                          distance_field,
+                                          status_totals,
+                                          refloat_batch,
+                                          pixels_on_land)
+from gnome.cy_gnome.cy_helpers import counter_uniforms
 
 
 class Test_overlap_grid:
@@ -346,3 +359,224 @@ if __name__ == '__main__':
     # result = find_first_pixel(raster, pt1, pt2)
 
     # print result
+
+
+def test_land_count_table():
+    raster = (np.random.uniform(size=(13, 7)) < .3).astype(np.uint8)
+    counts = land_count_table(raster)
+
+    assert counts.shape == (14, 8)
+    assert counts.dtype == np.int32
+    for (i, j) in ((0, 0), (13, 7), (5, 3), (13, 1)):
+        assert counts[i, j] == raster[:i, :j].sum()
+
+
+def test_tile_occupancy():
+    raster = np.zeros((10, 7), dtype=np.uint8)
+    raster[:4, :4] = 1
+    raster[5, 5] = 1
+    raster[8:, 4:] = 1
+
+    tiles = tile_occupancy(raster, 4)
+
+    assert tiles.dtype == np.uint8
+    # the edge tiles only have the pixels in the raster
+    assert np.all(tiles == [[2, 0], [0, 1], [0, 2]])
+
+
+@pytest.mark.parametrize('ratio', (3, 4, 8, 16))
+def test_tile_occupancy_packed(ratio):
+    raster = np.zeros((50, 75), dtype=np.uint8)
+    raster[:20, :30] = 1
+    raster[np.random.randint(0, 50, 40), np.random.randint(0, 75, 40)] = 1
+
+    assert np.all(tile_occupancy(PackedBitmap.pack(raster), ratio) ==
+                  tile_occupancy(raster, ratio))
+
+
+@pytest.mark.parametrize('packed', (False, True))
+def test_distance_field(packed):
+    raster = np.zeros((30, 20), dtype=np.uint8)
+    raster[5:9, 12:15] = 1
+    raster[25, 3] = 1
+
+    field = distance_field(PackedBitmap.pack(raster) if packed else raster)
+    assert field.dtype == np.int8
+
+    land = np.argwhere(raster == 1)
+    water = np.argwhere(raster == 0)
+    for (x, y) in ((0, 0), (10, 10), (29, 19), (25, 4), (6, 13), (5, 12)):
+        other = water if raster[x, y] else land
+        d = np.abs(other - (x, y)).max(axis=1).min()
+        assert field[x, y] == (-d if raster[x, y] else d)
+
+    # far from land it saturates
+    assert distance_field(np.zeros((300, 2), dtype=np.uint8)).max() == 127
+
+
+@pytest.mark.parametrize(('use_counts', 'use_tiles', 'packed', 'distance'),
+                         ((False, False, False, False),
+                          (True, False, False, False),
+                          (False, True, False, False),
+                          (True, True, False, False),
+                          (True, True, True, False),
+                          (False, False, False, True),
+                          (True, True, True, True)))
+def test_check_land_layers_batch(use_counts, use_tiles, packed, distance):
+    """
+    the batch land check beaches and moves the LEs the same as
+    check_land_layers
+    """
+    (w, h), ratio = (320, 160), 16
+    raster = np.zeros((w, h), dtype=np.uint8)
+    raster[100:140, 20:60] = 1
+    raster[200:, 120:] = 1
+    raster[250, :] = 1
+    raster[np.random.randint(0, w, 200), np.random.randint(0, h, 200)] = 1
+
+    coarse = np.zeros((w // ratio, h // ratio), dtype=np.uint8)
+    for i in range(coarse.shape[0]):
+        for j in range(coarse.shape[1]):
+            coarse[i, j] = np.any(raster[i * ratio:(i + 1) * ratio,
+                                         j * ratio:(j + 1) * ratio])
+
+    layers = np.array([coarse, raster])
+    ratios = np.array((ratio, 1), dtype=np.int32)
+
+    num = 2000
+    start = np.zeros((num, 2), dtype=np.int32)
+    start[:, 0] = np.random.randint(1, 99, num)
+    start[:, 1] = np.random.randint(1, h - 1, num)
+    start[::2, 0] += 141
+    end = np.clip(start + np.random.randint(-60, 60, (num, 2)), 1,
+                  (w - 2, h - 2)).astype(np.int32)
+    status = np.zeros((num, ), dtype=np.int16) + oil_status.in_water
+    status[::7] = oil_status.on_land
+
+    arrays = [(start.copy(), end.copy(), status.copy(),
+               np.zeros_like(start)) for i in range(2)]
+    check_land_layers(layers, ratios, *arrays[0])
+
+    counts = land_count_table(coarse) if use_counts else None
+    tiles = [tile_occupancy(raster, ratio)] if use_tiles else None
+    field = distance_field(raster) if distance else None
+    if packed:
+        layers = [coarse, PackedBitmap.pack(raster)]
+
+    num_beached = check_land_layers_batch(layers, ratios, *arrays[1],
+                                          land_counts=counts, tiles=tiles,
+                                          distance=field, chunk=64)
+
+    assert np.any(arrays[0][2] != status)
+    for serial, batch in zip(*arrays):
+        assert np.all(serial == batch)
+    assert num_beached == np.count_nonzero(arrays[1][2] != status)
+
+
+def test_status_totals():
+    """
+    the LEs and mass on land and off the maps, the same as with masks
+    """
+    num = 10000
+    status = np.zeros((num, ), dtype=np.int16) + oil_status.in_water
+    status[::3] = oil_status.on_land
+    status[1::7] = oil_status.off_maps
+    mass = np.random.uniform(0, 1, num)
+
+    totals = status_totals(status, mass)
+    on_land = status == oil_status.on_land
+    off_maps = status == oil_status.off_maps
+
+    assert totals[0] == np.count_nonzero(on_land)
+    assert totals[2] == np.count_nonzero(off_maps)
+    assert np.isclose(totals[1], mass[on_land].sum())
+    assert np.isclose(totals[3], mass[off_maps].sum())
+
+    assert status_totals(status)[1::2] == (0., 0.)
+    assert status_totals(status[:0]) == (0, 0., 0, 0.)
+
+
+def test_refloat_batch():
+    """
+    the LEs on land whose draws are under the probability go back to their
+    last water positions, the same ones as with masks
+    """
+    num = 10000
+    status = np.zeros((num, ), dtype=np.int16) + oil_status.in_water
+    status[::3] = oil_status.on_land
+    positions = np.random.uniform(0, 1, (num, 3))
+    last_water = np.random.uniform(0, 1, (num, 3))
+    on_land = np.where(status == oil_status.on_land)[0]
+    rnd = np.random.uniform(0, 1, len(on_land))
+
+    expected = positions.copy()
+    refloat = on_land[rnd <= 0.5]
+    expected[refloat] = last_water[refloat]
+
+    num_refloated = refloat_batch(status, positions, last_water, rnd, 0.5)
+
+    assert num_refloated == len(refloat)
+    assert np.all(positions == expected)
+    assert np.all(status[refloat] == oil_status.in_water)
+    assert np.count_nonzero(status == oil_status.on_land) == \
+        len(on_land) - len(refloat)
+
+    # no draws: all of them
+    assert refloat_batch(status, positions, last_water) == \
+        len(on_land) - len(refloat)
+    assert np.all(status == oil_status.in_water)
+
+    with pytest.raises(ValueError):
+        status[:2] = oil_status.on_land
+        refloat_batch(status, positions, last_water, rnd, 0.5)
+
+
+def test_refloat_batch_counter_draws():
+    """
+    with le_ids, the LEs on land refloat with draw 1 of the counter based
+    generator, so an LE refloats or not whatever the other LEs are
+    """
+    num = 10000
+    status = np.zeros((num, ), dtype=np.int16) + oil_status.in_water
+    status[::3] = oil_status.on_land
+    positions = np.random.uniform(0, 1, (num, 3))
+    last_water = np.random.uniform(0, 1, (num, 3))
+    ids = np.arange(num, dtype=np.uint32)[::-1].copy()
+
+    rnd = counter_uniforms(ids, 1, step=3600, stream=1, seed=7)
+    refloat = np.where((status == oil_status.on_land) & (rnd <= 0.3))[0]
+    expected = positions.copy()
+    expected[refloat] = last_water[refloat]
+
+    num_refloated = refloat_batch(status, positions, last_water, None, 0.3,
+                                  ids, 3600, 1, seed=7)
+
+    assert num_refloated == len(refloat)
+    assert np.all(positions == expected)
+    assert np.all(status[refloat] == oil_status.in_water)
+
+    # the LEs left on land make the same draws by themselves
+    on_land = np.where(status == oil_status.on_land)[0]
+    sub_status = status[on_land].copy()
+    sub_positions = positions[on_land].copy()
+    assert refloat_batch(sub_status, sub_positions, last_water[on_land].copy(),
+                         None, 0.3, ids[on_land].copy(), 3600, 1,
+                         seed=7) == 0
+
+    with pytest.raises(ValueError):
+        refloat_batch(status, positions, last_water, np.zeros((1, )), 0.3,
+                      ids, 3600, 1, seed=7)
+
+
+@pytest.mark.parametrize("packed", (False, True))
+def test_pixels_on_land(packed):
+    raster = np.zeros((20, 12), dtype=np.uint8)
+    raster[6:13, 4:8] = 1
+    grid = PackedBitmap.pack(raster) if packed else raster
+    pixels = np.array(((10, 6), (0, 0), (6, 4), (12, 7), (13, 7),
+                       (-1, 5), (20, 5), (10, 12)), dtype=np.int32)
+
+    assert np.array_equal(pixels_on_land(grid, pixels),
+                          (True, False, True, True, False,
+                           False, False, False))
+    assert len(pixels_on_land(grid, np.zeros((0, 2), dtype=np.int32))) == 0
@@ -9,6 +9,9 @@ it works.
 The functions being tested do not produce any results.
 '''
 
+import numpy as np
+import pytest
+
 from gnome.cy_gnome import cy_mover
 from gnome.cy_gnome import cy_current_mover
 
@@ -40,3 +43,53 @@ def test_prepare_for_model_step():
 def test_model_step_is_done():
     cm.model_step_is_done()
     assert True
+
+
+def test_get_move_batch():
+    """ no C++ mover - it should not do anything """
+    a = np.zeros((2, ))
+    status = np.zeros((2, ), dtype=np.int16)
+    cm.get_move_batch(0, 0, a, a, a, status, a, a, a, 1)
+    cm.get_move_batch(0, 0, a, a, a, status, a, a, a, 1,
+                      active=np.zeros((0, ), dtype=np.int64))
+    assert True
+
+
+def test_get_move_fused():
+    """ no C++ mover - the next positions don't change """
+    a = np.zeros((2, ))
+    status = np.zeros((2, ), dtype=np.int16)
+    next_pos = np.ones((2, ))
+    cy_mover.get_move_fused([cm], 0, 0, a, a, a, status,
+                            next_pos, next_pos, next_pos, 1, [None])
+    assert np.all(next_pos == 1)
+
+    with pytest.raises(ValueError):
+        cy_mover.get_move_fused([cm], 0, 0, a, a, a, status,
+                                next_pos, next_pos, next_pos, 1, [])
+
+
+def test_get_move_ensemble():
+    """ no C++ mover - the next positions don't change """
+    a = np.zeros((4, ))
+    status = np.zeros((4, ), dtype=np.int16)
+    next_pos = np.ones((4, ))
+    members = np.array([0, 1, 4], dtype=np.int64)
+
+    cy_mover.get_move_ensemble([cm], 0, 0, a, a, a, status,
+                               next_pos, next_pos, next_pos, 1, [None],
+                               members, [[1.0], [2.0]])
+    assert np.all(next_pos == 1)
+
+    # a scale for each member and mover
+    with pytest.raises(ValueError):
+        cy_mover.get_move_ensemble([cm], 0, 0, a, a, a, status,
+                                   next_pos, next_pos, next_pos, 1, [None],
+                                   members, [1.0, 2.0])
+
+    # the members cover all the LEs
+    with pytest.raises(ValueError):
+        cy_mover.get_move_ensemble([cm], 0, 0, a, a, a, status,
+                                   next_pos, next_pos, next_pos, 1, [None],
+                                   np.array([0, 1, 3], dtype=np.int64),
+                                   [[1.0], [2.0]])
@@ -18,6 +18,7 @@ from gnome.basic_types import ts_format, seconds, velocity_rec
 
 from gnome.cy_gnome.cy_ossm_time import CyOSSMTime, CyTimeseries
 from gnome.cy_gnome.cy_shio_time import CyShioTime
+from gnome.cy_gnome import cy_helpers
 from ..conftest import testdata
 
 
@@ -69,6 +70,27 @@ def test_init_units(obj):
     assert ossmT2.user_units == 'knots'
 
 
+def test_time_values_cache(tmpdir):
+    """
+    a file read again with the cache on gives the values it was read with
+    """
+    expected = CyTimeseries(filename=testdata['timeseries']['wind_ts'],
+                            file_format=ts_format.magnitude_direction)
+
+    cy_helpers.set_time_values_cache_dir(str(tmpdir))
+    try:
+        for i in range(2):
+            ossm = CyTimeseries(filename=testdata['timeseries']['wind_ts'],
+                                file_format=ts_format.magnitude_direction)
+            np.testing.assert_equal(ossm.timeseries, expected.timeseries)
+            assert ossm.user_units == expected.user_units
+        assert len(tmpdir.listdir(lambda p: p.ext == '.gnometv')) == 1
+    finally:
+        cy_helpers.set_time_values_cache_dir(None)
+
+    assert cy_helpers.get_time_values_cache_dir() == ''
+
+
 class TestObjectSerialization:
     '''
         Test all the serialization and deserialization methods that are
@@ -194,6 +216,30 @@ class TestCyTimeseries:
             np.testing.assert_allclose(vel['v'], actual['v'], tol, tol,
                                        msg, 0)
 
+    def test_get_time_value_order(self):
+        """
+        the lookup remembers the last bracket, so check it gives the same
+        values for ascending times, random times and one time at a time
+        """
+        tval = np.zeros((1000, ), dtype=basic_types.time_value_pair)
+        tval['time'] = np.arange(1000) * 3600
+        tval['value']['u'] = np.sin(np.arange(1000) * .1)
+        tval['value']['v'] = np.cos(np.arange(1000) * .1)
+        ossm = CyTimeseries(timeseries=tval)
+
+        time = np.linspace(0, 999 * 3600, 5001).astype(seconds)
+        ascending = ossm.get_time_value(time)
+
+        order = np.random.RandomState(0).permutation(len(time))
+        shuffled = ossm.get_time_value(time[order])
+        np.testing.assert_equal(shuffled, ascending[order])
+
+        for i in order[:100]:
+            np.testing.assert_equal(ossm.get_time_value(time[i]),
+                                    ascending[i:i + 1])
+
+        assert len(ossm.get_time_value(np.array([], dtype=seconds))) == 0
+
 
 if __name__ == '__main__':
     # tt = TestTimeSeriesInit()
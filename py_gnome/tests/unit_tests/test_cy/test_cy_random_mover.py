@@ -4,11 +4,13 @@ unit tests cython wrapper
 designed to be run with py.test
 """
 
+import threading
+
 import numpy as np
 
 from gnome.basic_types import spill_type, world_point, world_point_type
 
-from gnome.cy_gnome.cy_helpers import srand
+from gnome.cy_gnome.cy_helpers import srand, set_random_stream
 from gnome.cy_gnome.cy_random_mover import CyRandomMover
 import cy_fixtures
 
@@ -132,6 +134,97 @@ class TestRandom:
         assert np.all(delta['lat'] == new_delta['lat'])
         assert np.all(delta['long'] == new_delta['long'])
 
+    def test_counter_rng(self):
+        """
+        counter based random numbers depend only on the seed, not on the
+        state of rand() or the number of threads
+        """
+
+        self.rm.use_counter_rng = True
+        self.rm.rng_seed = 7
+        assert self.rm.use_counter_rng
+
+        delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(delta)
+
+        srand(3)
+        self.rm.num_threads = 4
+        new_delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(new_delta)
+        self.rm.num_threads = 1
+
+        assert np.all(delta['lat'] != 0)
+        assert np.all(delta['lat'] == new_delta['lat'])
+        assert np.all(delta['long'] == new_delta['long'])
+
+        self.rm.rng_seed = 8
+        new_delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(new_delta)
+        self.rm.use_counter_rng = False
+        self.rm.rng_seed = 1
+
+        assert np.all(delta['lat'] != new_delta['lat'])
+
+    def test_threads(self):
+        """
+        get_move releases the GIL - two threads moving with the mover at
+        once, each with a random stream of its own, get the same moves as
+        the streams one after the other
+        """
+        def move_in_stream(stream, delta):
+            set_random_stream(stream)
+            try:
+                for i in range(10):
+                    self.rm.get_move(self.cm.model_time, self.cm.time_step,
+                                     self.cm.ref, delta, self.cm.status,
+                                     spill_type.forecast)
+            finally:
+                set_random_stream(0)
+
+        self.rm.prepare_for_model_run()
+        self.rm.prepare_for_model_step(self.cm.model_time, self.cm.time_step)
+
+        srand(1)
+        serial = [np.zeros((self.cm.num_le, ), dtype=world_point)
+                  for i in range(2)]
+        for stream, delta in enumerate(serial):
+            move_in_stream(stream + 1, delta)
+
+        srand(1)
+        threaded = [np.zeros((self.cm.num_le, ), dtype=world_point)
+                    for i in range(2)]
+        threads = [threading.Thread(target=move_in_stream,
+                                    args=(stream + 1, delta))
+                   for stream, delta in enumerate(threaded)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        assert np.all(serial[0]['lat'] != serial[1]['lat'])
+        for delta, new_delta in zip(serial, threaded):
+            assert np.all(delta == new_delta)
+
+    def test_timing_stats(self):
+        """
+        the section timers count the steps and LEs when lib_gnome is built
+        with GNOME_TIMING, and are all zero otherwise
+        """
+        self.rm.reset_timing_stats()
+        for stats in self.rm.get_timing_stats().values():
+            assert stats['count'] == 0 and stats['ns'] == 0
+
+        delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(delta)
+        stats = self.rm.get_timing_stats()
+
+        assert sorted(stats) == sorted(['prepare_for_model_step', 'get_move',
+                                        'read_data', 'locate', 'interpolate'])
+        get_move = stats['get_move']
+        assert get_move['count'] in (0, 1)
+        assert get_move['num_les'] == get_move['count'] * self.cm.num_le
+        assert stats['prepare_for_model_step']['count'] == get_move['count']
+
     def _diff(self, delta, new_delta):
         """
         gives the norm of the (delta-new_delta)
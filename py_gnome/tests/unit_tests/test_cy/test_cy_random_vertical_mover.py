@@ -195,6 +195,36 @@ class TestRandomVertical:
         assert np.all(delta['lat'] == new_delta['lat'])
         assert np.all(delta['long'] == new_delta['long'])
 
+    def test_counter_rng(self):
+        """
+        counter based random numbers depend only on the seed, not on the
+        state of rand() or the number of threads
+        """
+
+        self.rm.use_counter_rng = True
+        self.rm.rng_seed = 7
+        assert self.rm.use_counter_rng
+
+        delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(delta)
+
+        srand(3)
+        self.rm.num_threads = 4
+        new_delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(new_delta)
+        self.rm.num_threads = 1
+
+        assert np.all(delta['z'] != 0)
+        assert np.all(delta['z'] == new_delta['z'])
+
+        self.rm.rng_seed = 8
+        new_delta = np.zeros((self.cm.num_le, ), dtype=world_point)
+        self.move(new_delta)
+        self.rm.use_counter_rng = False
+        self.rm.rng_seed = 1
+
+        assert np.all(delta['z'] != new_delta['z'])
+
     def _diff(self, delta, new_delta):
         """
         gives the norm of the (delta-new_delta)
@@ -9,11 +9,13 @@ todo: still need to add tests for functions that get the data from C++ code
 import os
 from datetime import datetime
 
+import numpy as np
 import pytest
 
 import gnome
 from gnome.utilities import time_utils
 from gnome.cy_gnome.cy_shio_time import CyShioTime
+from gnome.cy_gnome import cy_helpers
 from ..conftest import testdata
 
 shio_file = testdata['timeseries']['tide_shio']
@@ -103,6 +105,56 @@ def test_get_time_value():
     assert all(vel_rec['v'] == 0)
 
 
+def test_tide_table_cache(tmpdir):
+    """
+    values from cached tide tables, in memory or on disk, are the same as
+    computed ones
+    """
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    time = [t + 3600.*dt for dt in range(10)]
+    expected = CyShioTime(shio_file).get_time_value(time)
+
+    cy_helpers.set_tide_table_cache_size(4)
+    cy_helpers.set_tide_table_cache_dir(str(tmpdir))
+    try:
+        for i in range(2):
+            vel_rec = CyShioTime(shio_file).get_time_value(time)
+            np.testing.assert_equal(vel_rec, expected)
+        assert cy_helpers.get_tide_table_cache_size() == (4, 1)
+        assert len(tmpdir.listdir(lambda p: p.ext == '.gnometide')) == 1
+
+        # only on disk
+        cy_helpers.set_tide_table_cache_size(0)
+        vel_rec = CyShioTime(shio_file).get_time_value(time)
+        np.testing.assert_equal(vel_rec, expected)
+    finally:
+        cy_helpers.set_tide_table_cache_size(0)
+        cy_helpers.set_tide_table_cache_dir(None)
+
+    assert cy_helpers.get_tide_table_cache_size() == (0, 0)
+    assert cy_helpers.get_tide_table_cache_dir() == ''
+
+
+def test_harmonic_recurrence():
+    """
+    the tide curve summed with the recurrence is close to the direct sums
+    """
+    t = time_utils.date_to_sec(datetime(2012, 8, 20, 13))
+    time = [t + 3600.*dt for dt in range(10)]
+    expected = CyShioTime(shio_file).get_time_value(time)
+
+    assert not cy_helpers.get_harmonic_recurrence()
+    cy_helpers.set_harmonic_recurrence(True)
+    try:
+        assert cy_helpers.get_harmonic_recurrence()
+        vel_rec = CyShioTime(shio_file).get_time_value(time)
+    finally:
+        cy_helpers.set_harmonic_recurrence(False)
+
+    np.testing.assert_allclose(vel_rec['u'], expected['u'], rtol=0, atol=1e-9)
+    np.testing.assert_allclose(vel_rec['v'], expected['v'], rtol=0, atol=1e-9)
+
+
 def test_eq():
     shio = CyShioTime(shio_file)
 
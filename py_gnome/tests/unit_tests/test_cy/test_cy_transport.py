@@ -0,0 +1,146 @@
+"""
+unit tests of run_transport_steps, the transport-only steps in lib_gnome
+
+designed to be run with py.test
+"""
+
+import numpy as np
+
+from gnome.basic_types import oil_status, world_point_type, status_code_type
+from gnome.utilities.packed_bitmap import PackedBitmap
+from gnome.cy_gnome.cy_random_mover import CyRandomMover
+from gnome.cy_gnome.cy_mover import run_transport_steps
+
+import pytest
+
+time_step = 900
+model_time = 0
+
+# pixel (x, y) is at lon x, lat y: a raster of 10 x 10 one degree pixels
+transform = (0., 0., 1., 1., 0., 0.)
+
+
+def elements(positions, status=oil_status.in_water):
+    positions = np.array(positions, dtype=world_point_type).reshape(-1, 3)
+    status_codes = np.full((len(positions),), status,
+                           dtype=status_code_type)
+    ids = np.arange(len(positions), dtype=np.uint32)
+
+    return positions, status_codes, positions.copy(), ids
+
+
+def land(x0=5):
+    'the pixels from column x0 on are land'
+    raster = np.zeros((10, 10), dtype=np.uint8)
+    raster[x0:, :] = 1
+
+    return raster
+
+
+def test_lengths():
+    positions, status_codes, lw, ids = elements([(1., 1., 0.)])
+
+    with pytest.raises(ValueError):
+        run_transport_steps([], 1, model_time, time_step, positions[:0],
+                            status_codes, lw, ids)
+
+    with pytest.raises(ValueError):
+        run_transport_steps([CyRandomMover()], 1, model_time, time_step,
+                            positions, status_codes, lw, ids,
+                            uses_windages=[])
+
+
+def test_no_movers():
+    'with no movers or map the elements stay, each step is done'
+    positions, status_codes, lw, ids = elements([(1., 1., -2.),
+                                                 (2., 2., 1.)])
+
+    result = run_transport_steps([], 4, model_time, time_step, positions,
+                                 status_codes, lw, ids, track=True)
+
+    assert result['steps'] == 4
+    assert result['error'] == 0
+    assert result['lon'].shape == (4, 2)
+    assert np.all(positions[:, :2] == [(1., 1.), (2., 2.)])
+
+    # the elements in the air come down to the surface
+    assert np.all(positions[:, 2] == [0., 1.])
+    assert np.all(status_codes == oil_status.in_water)
+
+
+def test_random_mover():
+    'the moves are the same for the same seed'
+    results = []
+    for i in range(2):
+        positions, status_codes, lw, ids = elements([(1., 1., 0.)] * 10)
+        mover = CyRandomMover(diffusion_coef=100000)
+        mover.prepare_for_model_run()
+
+        run_transport_steps([mover], 3, model_time, time_step, positions,
+                            status_codes, lw, ids, seed=7)
+        results.append(positions)
+
+    assert np.any(results[0] != (1., 1., 0.))
+    assert np.all(results[0] == results[1])
+
+
+@pytest.mark.parametrize("packed", [False, True])
+def test_on_land(packed):
+    '''
+    the elements in the water that don't move stay there, the ones on land
+    that don't refloat are left where they are
+    '''
+    positions, status_codes, lw, ids = elements([(1.5, 1.5, 0.),
+                                                 (8.5, 8.5, 0.)])
+    status_codes[1] = oil_status.on_land
+    raster = land()
+    if packed:
+        raster = PackedBitmap.pack(raster)
+
+    result = run_transport_steps([], 1, model_time, time_step, positions,
+                                 status_codes, lw, ids, land=raster,
+                                 transform=transform)
+
+    assert result['beached'] == 0
+    assert np.all(status_codes == [oil_status.in_water, oil_status.on_land])
+    assert np.all(positions[1] == (8.5, 8.5, 0.))
+
+
+def test_refloat():
+    'with a refloat probability of 1 the elements on land all refloat'
+    positions, status_codes, lw, ids = elements([(8.5, 8.5, 0.)] * 3,
+                                                oil_status.on_land)
+    lw[:] = (2.5, 2.5, 0.)
+
+    run_transport_steps([], 1, model_time, time_step, positions,
+                        status_codes, lw, ids, land=land(),
+                        transform=transform, refloat_probability=1.)
+
+    assert np.all(status_codes == oil_status.in_water)
+    assert np.all(positions == (2.5, 2.5, 0.))
+
+
+def test_no_refloat():
+    'with a negative refloat probability the elements stay on land'
+    positions, status_codes, lw, ids = elements([(8.5, 8.5, 0.)] * 3,
+                                                oil_status.on_land)
+    lw[:] = (2.5, 2.5, 0.)
+
+    run_transport_steps([], 5, model_time, time_step, positions,
+                        status_codes, lw, ids, land=land(),
+                        transform=transform, refloat_probability=-1.)
+
+    assert np.all(status_codes == oil_status.on_land)
+    assert np.all(positions == (8.5, 8.5, 0.))
+
+
+def test_off_maps():
+    'the elements off the map bounds are off the maps'
+    positions, status_codes, lw, ids = elements([(1., 1., 0.),
+                                                 (20., 1., 0.)])
+    bounds = np.array([(0., 0.), (10., 0.), (10., 10.), (0., 10.)])
+
+    run_transport_steps([], 2, model_time, time_step, positions,
+                        status_codes, lw, ids, map_bounds=bounds)
+
+    assert np.all(status_codes == [oil_status.in_water, oil_status.off_maps])
@@ -0,0 +1,91 @@
+"""
+unit tests for the cython weathering functions
+
+designed to be run with py.test
+"""
+
+import numpy as np
+
+import pytest
+
+from gnome.cy_gnome import cy_weatherers
+
+
+def arrays(num_le):
+    rand = np.random.RandomState(1)
+    return {'frac_water': rand.uniform(0, .9, num_le),
+            'area': rand.uniform(0, 1000, num_le),
+            'frac_evap': rand.uniform(0, 1, num_le),
+            'age': rand.randint(0, 7200, num_le).astype(np.int32),
+            'bulltime': np.where(rand.uniform(size=num_le) < .5, -1.,
+                                 rand.uniform(0, 3600, num_le)),
+            'mass': rand.uniform(0, 10, num_le),
+            'viscosity': rand.uniform(0, .1, num_le),
+            'density': rand.uniform(800, 1000, num_le),
+            'fay_area': rand.uniform(0, 100, num_le)}
+
+
+def weather(num_threads, num_le=1001):
+    """
+    emulsify, then disperse, with the given number of threads
+    """
+    a = arrays(num_le)
+    d_disp = np.zeros((num_le, ))
+    d_sed = np.zeros((num_le, ))
+    droplet = np.zeros((num_le, ))
+
+    cy_weatherers.set_num_threads(num_threads)
+    try:
+        cy_weatherers.emulsify_oil(900, a['frac_water'], a['area'],
+                                   a['frac_evap'], a['age'], a['bulltime'],
+                                   2.3e-6, -1., 0.3, 1000., 0.9, 1e-5)
+        cy_weatherers.disperse_oil(900, a['frac_water'], a['mass'],
+                                   a['viscosity'], a['density'],
+                                   a['fay_area'], d_disp, d_sed, droplet,
+                                   0.1, 10., 1.5, 1e-6, 1025., 0.01, 1., 0.4)
+    finally:
+        cy_weatherers.set_num_threads(1)
+
+    return a['frac_water'], a['area'], a['bulltime'], d_disp, d_sed, droplet
+
+
+def test_num_threads():
+    assert cy_weatherers.get_num_threads() == 1
+
+    cy_weatherers.set_num_threads(4)
+    assert cy_weatherers.get_num_threads() == 4
+
+    cy_weatherers.set_num_threads(0)  # anything less than 1 means serial
+    assert cy_weatherers.get_num_threads() == 1
+
+
+def test_threads_same_results():
+    """
+    the threaded loops give the same results as the serial ones
+    """
+    serial = weather(1)
+    threaded = weather(4)
+
+    assert np.any(serial[3] > 0)
+    for s, t in zip(serial, threaded):
+        np.testing.assert_equal(s, t)
+
+
+def test_remove_oil():
+    'the LEs of each group are scaled by its factor, the others left alone'
+    mass_components = np.arange(12, dtype=np.float64).reshape(4, 3)
+    le_mass = mass_components.sum(1)
+    expected = mass_components.copy()
+    expected[0] *= 0.5
+    expected[2] *= 0.5
+    expected[3] *= 0.
+
+    cy_weatherers.remove_oil([0, -1, 0, 1], [0.5, 0.],
+                             mass_components, le_mass)
+
+    assert np.all(mass_components == expected)
+    assert np.all(le_mass == expected.sum(1))
+
+    with pytest.raises(ValueError):
+        cy_weatherers.remove_oil([2, -1, 0, 1], [0.5, 0.],
+                                 mass_components, le_mass)
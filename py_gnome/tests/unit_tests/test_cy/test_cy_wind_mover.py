@@ -9,8 +9,9 @@ import os
 
 import numpy
 np = numpy
+import pytest
 
-from gnome.basic_types import (spill_type, ts_format,
+from gnome.basic_types import (spill_type, ts_format, oil_status,
                                velocity_rec,
                                time_value_pair,
                                world_point,
@@ -18,6 +19,7 @@ from gnome.basic_types import (spill_type, ts_format,
 from gnome.utilities import projections
 
 from gnome.cy_gnome.cy_ossm_time import CyTimeseries
+from gnome.cy_gnome import cy_mover
 from gnome.cy_gnome.cy_wind_mover import CyWindMover
 
 import cy_fixtures
@@ -319,6 +321,124 @@ def test_z_greater_than_0():
     assert np.all((cw.delta['z'])[2:] == 0)
 
 
+def test_get_move_batch():
+    """
+    The structure-of-arrays get_move_batch should give the same deltas
+    as get_move
+    """
+    cw = ConstantWind()
+    (cw.ref['lat'])[:] = np.linspace(30, 60, cw.num_le)
+    (cw.ref['z'])[:1] = 2  # particle 0 is not on the surface
+    cw.status[-1] = 0  # last particle is not in water
+    cw.test_move()
+
+    delta_lat = np.zeros((cw.num_le, ))
+    delta_lon = np.zeros((cw.num_le, ))
+    delta_z = np.zeros((cw.num_le, ))
+
+    cw.wm.get_move_batch(cw.model_time, cw.time_step,
+                         np.ascontiguousarray(cw.ref['lat']),
+                         np.ascontiguousarray(cw.ref['long']),
+                         np.ascontiguousarray(cw.ref['z']),
+                         cw.status,
+                         delta_lat, delta_lon, delta_z,
+                         spill_type.forecast,
+                         cw.windage)
+
+    np.testing.assert_allclose(delta_lat, cw.delta['lat'], 1e-12, 1e-16)
+    np.testing.assert_allclose(delta_lon, cw.delta['long'], 1e-12, 1e-16)
+    assert np.all(delta_z == 0)
+    assert delta_lat[0] == 0 and delta_lat[-1] == 0
+
+
+def test_get_move_ensemble():
+    """
+    An ensemble of members of the same LEs moves each of them by the
+    get_move_batch deltas, scaled by the member's wind scale
+    """
+    cw = ConstantWind()
+    (cw.ref['lat'])[:] = np.linspace(30, 60, cw.num_le)
+    cw.status[-1] = 0  # last particle is not in water
+    cw.wm.prepare_for_model_step(cw.model_time, cw.time_step)
+
+    lat = np.ascontiguousarray(cw.ref['lat'])
+    lon = np.ascontiguousarray(cw.ref['long'])
+    z = np.ascontiguousarray(cw.ref['z'])
+    delta_lat = np.zeros((cw.num_le, ))
+    delta_lon = np.zeros((cw.num_le, ))
+    delta_z = np.zeros((cw.num_le, ))
+
+    cw.wm.get_move_batch(cw.model_time, cw.time_step, lat, lon, z,
+                         cw.status, delta_lat, delta_lon, delta_z,
+                         spill_type.forecast, cw.windage)
+
+    scales = np.array([[0.5], [1.0], [2.0]])
+    num = cw.num_le * len(scales)
+    next_lat = np.tile(lat, len(scales))
+    next_lon = np.tile(lon, len(scales))
+    next_z = np.tile(z, len(scales))
+
+    cy_mover.get_move_ensemble([cw.wm], cw.model_time, cw.time_step,
+                               next_lat.copy(), next_lon.copy(),
+                               next_z.copy(), np.tile(cw.status, 3),
+                               next_lat, next_lon, next_z,
+                               spill_type.forecast, [np.tile(cw.windage, 3)],
+                               np.arange(0, num + 1, cw.num_le,
+                                         dtype=np.int64),
+                               scales)
+
+    for k, scale in enumerate(scales[:, 0]):
+        member = slice(k * cw.num_le, (k + 1) * cw.num_le)
+
+        np.testing.assert_allclose(next_lat[member] - lat,
+                                   scale * delta_lat, 1e-9, 1e-12)
+        np.testing.assert_allclose(next_lon[member] - lon,
+                                   scale * delta_lon, 1e-9, 1e-12)
+
+
+def _physical_memory():
+    try:
+        return os.sysconf('SC_PAGE_SIZE') * os.sysconf('SC_PHYS_PAGES')
+    except (AttributeError, ValueError, OSError):
+        return 0
+
+
+@pytest.mark.slow
+@pytest.mark.skipif(_physical_memory() < 32 * 2 ** 30,
+                    reason='needs 32GB for the arrays of 2^31 LEs')
+def test_get_move_fused_past_2_31():
+    """
+    The LEs past index 2^31 move like the first ones: the counts and
+    indexes of the LEs are 64 bits. The arrays are zeros, so only the pages
+    of the few LEs moved are ever touched.
+    """
+    cw = ConstantWind()
+    cw.wm.prepare_for_model_step(cw.model_time, cw.time_step)
+
+    num = 2 ** 31 + 16
+    active = np.array([0, 1, 2 ** 31 - 1, 2 ** 31, num - 1], dtype=np.int64)
+
+    lat = np.zeros((num, ))
+    status = np.zeros((num, ), dtype=np.int16)
+    windages = np.zeros((num, ))
+    next_lat = np.zeros((num, ))
+    next_lon = np.zeros((num, ))
+    next_z = np.zeros((num, ))
+
+    status[active] = oil_status.in_water
+    windages[active] = 0.03
+
+    cy_mover.get_move_fused([cw.wm], cw.model_time, cw.time_step,
+                            lat, lat, lat, status,
+                            next_lat, next_lon, next_z,
+                            spill_type.forecast, [windages], active)
+
+    assert next_lat[0] != 0 and next_lon[0] != 0
+    assert np.all(next_lat[active] == next_lat[0])
+    assert np.all(next_lon[active] == next_lon[0])
+    assert next_lat[2] == 0 and next_lat[num - 2] == 0
+
+
 class TestObjectSerialization:
     '''
         Test all the serialization and deserialization methods that are
@@ -346,6 +466,103 @@ class TestObjectSerialization:
         assert new_wm == self.wm
         assert repr(new_wm) == repr(self.wm)
 
+
+def uncertain_move(num_members, seed=7, num_threads=1,
+                   shared_factor_count=0):
+    """
+    uncertain deltas of num_members copies of the fixture's LEs, moved by
+    a new wind mover with the counter based random numbers
+    """
+    cm = cy_fixtures.CyTestMove()
+    wm = CyWindMover()
+    wm.set_constant_wind(const_wind['u'], const_wind['v'])
+    wm.use_counter_rng = True
+    wm.rng_seed = seed
+    wm.num_threads = num_threads
+    wm.shared_factor_count = shared_factor_count
+
+    ref = np.tile(cm.ref, num_members)
+    windage = np.tile(cm.windage, num_members)
+    status = np.tile(cm.status, num_members)
+    delta = np.zeros((len(ref), ), dtype=world_point)
+    spill_size = np.array([len(ref)], dtype=np.int64)
+
+    wm.prepare_for_model_step(cm.model_time, cm.time_step,
+                              len(spill_size), spill_size)
+    wm.get_move(cm.model_time, cm.time_step, ref, delta, windage, status,
+                spill_type.uncertainty)
+
+    return delta
+
+
+def test_counter_rng_uncertainty():
+    """
+    the counter based uncertainty factors depend only on the seed, not on
+    rand() or the number of threads
+    """
+    from gnome.cy_gnome.cy_helpers import srand
+
+    delta = uncertain_move(1)
+
+    srand(3)
+    assert np.all(delta == uncertain_move(1, num_threads=4))
+    assert np.all(delta['lat'] != uncertain_move(1, seed=8)['lat'])
+
+
+def test_shared_factor_count():
+    """
+    with shared factors, the LEs of the second member move like the same
+    LEs of the first
+    """
+    num_le = cy_fixtures.CyTestMove().num_le
+
+    delta = uncertain_move(2)
+    assert np.all(delta[:num_le]['lat'] != delta[num_le:]['lat'])
+
+    shared = uncertain_move(2, shared_factor_count=num_le)
+    assert np.all(shared[:num_le] == delta[:num_le])
+    assert np.all(shared[num_le:] == shared[:num_le])
+
+    with pytest.raises(ValueError):
+        CyWindMover().shared_factor_count = -1
+
+
+def test_update_windages():
+    """
+    the windages of the LEs with a positive persistence are drawn again in
+    their range, scaled to the time step; the others keep theirs. Any number
+    of threads draws the same ones
+    """
+    from gnome.cy_gnome.cy_wind_mover import update_windages
+
+    num_le = 1000
+    ids = np.arange(num_le, dtype=np.uint32)
+    windage_range = np.zeros((num_le, 2), dtype=np.float64)
+    windage_range[:] = (0.01, 0.04)
+    persist = np.empty((num_le,), dtype=np.int)
+    persist[:] = 900
+    persist[::2] = -1
+    windages = np.zeros((num_le,), dtype=np.float64)
+
+    update_windages(ids, windage_range, persist, windages, 900, 0, seed=1)
+    assert np.all(windages[::2] == 0)
+    assert np.all(windages[1::2] >= 0.01)
+    assert np.all(windages[1::2] < 0.04)
+
+    threaded = np.zeros_like(windages)
+    update_windages(ids, windage_range, persist, threaded, 900, 0, seed=1,
+                    num_threads=4)
+    assert np.all(threaded == windages)
+
+    update_windages(ids, windage_range, persist, threaded, 900, 900, seed=1)
+    assert np.all(threaded[1::2] != windages[1::2])
+
+    # a 4 times longer persistence doubles the range about its middle
+    persist[1::2] = 3600
+    update_windages(ids, windage_range, persist, windages, 900, 0, seed=1)
+    assert np.all(windages[1::2] >= -0.005)
+    assert np.all(windages[1::2] < 0.055)
+
 if __name__ == '__main__':
     cw = TestConstantWind()
     cw.test_constant_wind()
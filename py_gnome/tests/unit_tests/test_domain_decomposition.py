@@ -0,0 +1,93 @@
+'''
+tests of the domain decomposed runs
+'''
+from datetime import datetime, timedelta
+
+import numpy as np
+from pytest import raises
+
+from gnome.model import Model
+from gnome.spill import point_line_release_spill
+from gnome.movers import RandomMover, constant_wind_mover
+from gnome.domain_decomposition import (Decomposition, Rank, spill_rank,
+                                        run_local)
+
+
+def test_strips():
+    d = Decomposition.strips(((-74., 40.), (-70., 42.)), 4)
+
+    assert np.all(d.edges == [-74., -73., -72., -71., -70.])
+    assert d.region(1) == ((-73., 40.), (-72., 42.))
+    # the first and last strips go on past the domain
+    assert list(d.ranks_of(np.array([(-80., 41.), (-72.5, 41.),
+                                     (-72., 41.), (-60., 41.)]))) == \
+        [0, 1, 2, 3]
+
+    # of the same number of positions
+    positions = np.zeros((100, 3))
+    positions[:, 0] = np.r_[np.linspace(-74., -73.5, 75),
+                            np.linspace(-72., -70., 25)]
+    d = Decomposition.strips(((-74., 40.), (-70., 42.)), 2, positions)
+    assert np.bincount(d.ranks_of(positions)).tolist() == [50, 50]
+
+    with raises(ValueError):
+        Decomposition([-72., -72.], (40., 42.))
+
+
+def make_model(rank=0):
+    '''
+    a spill in each of two strips, the wind taking the elements east from
+    one into the other
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=6),
+                  time_step=900, uncertain=False)
+
+    for lon in (-72.05, -71.5):
+        model.spills += point_line_release_spill(num_elements=50,
+                                                 start_position=(lon, 41., 0.),
+                                                 release_time=start_time)
+
+    model.movers += RandomMover(diffusion_coef=100000)
+    model.movers += constant_wind_mover(20., 270., units='m/s')
+
+    return model
+
+
+def test_spill_rank():
+    d = Decomposition([-73., -72., -71.], (40., 42.))
+    model = make_model()
+
+    assert [spill_rank(s, d) for s in model.spills] == [0, 1]
+
+    model.uncertain = True
+    with raises(ValueError):
+        Rank(model, d, 0)
+
+
+def test_run_local():
+    '''
+    the elements stay in the strips of their ranks as they migrate, and
+    none are lost or doubled
+    '''
+    d = Decomposition([-73., -72., -71.], (40., 42.))
+    run = run_local(make_model, d)
+
+    num_steps = 0
+    for _steps in run:
+        num_steps += 1
+        for r in run.ranks:
+            sc = r.spill_container
+            assert np.all(d.ranks_of(sc['positions']) == r.rank)
+
+    ranks = run.ranks
+    assert num_steps == ranks[0].model.num_time_steps
+    # some went east
+    assert len(ranks[1]) > 50
+
+    ids = np.concatenate([r.spill_container['id'] for r in ranks])
+    spill_nums = np.concatenate([r.spill_container['spill_num']
+                                 for r in ranks])
+    assert len(ids) == 100
+    assert len(set(zip(ids, spill_nums))) == 100
+    assert np.bincount(spill_nums).tolist() == [50, 50]
@@ -3,7 +3,7 @@ test object in environment module
 '''
 import pytest
 from unit_conversion import InvalidUnitError
-from gnome.environment import Water
+from gnome.environment import Water, StepCache
 
 
 def test_Water_init():
@@ -105,3 +105,33 @@ def test_properties_in_si(attr, unit, val, exp_si):
     assert w.units[attr] == unit
 
     assert w.get(attr) == exp_si
+
+
+def test_StepCache():
+    'the values are computed once each for the step, only once it is reset'
+    calls = []
+
+    def compute(*args):
+        calls.append(args)
+        return len(calls)
+
+    cache = StepCache()
+    assert cache.get('a', 0, compute) == 1
+    assert cache.get('a', 0, compute) == 2
+
+    cache.reset(0)
+    assert cache.get('a', 0, compute) == 3
+    assert cache.get('a', 0, compute) == 3
+    assert cache.get('a', 10, compute) == 4
+    assert cache.get('b', 0, compute) == 5
+
+    def compute_many(keys):
+        calls.append(keys)
+        return [k * 10 for k in keys]
+
+    assert cache.get_many([1, 2], 0, compute_many) == [10, 20]
+    assert cache.get_many([2, 3], 0, compute_many) == [20, 30]
+    assert calls[-1] == [3]
+
+    cache.reset(10)
+    assert cache.get('a', 0, compute) == 8
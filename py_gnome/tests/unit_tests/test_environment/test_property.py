@@ -77,6 +77,43 @@ class TestTime:
         assert ts.index_of(ts.time[-1], True) == 4
         assert ts.index_of(ts.time[0], True) == 0
 
+    def test_many_times(self, ts):
+        times = [dt.datetime(1999, 12, 31, 23),
+                 dt.datetime(2000, 1, 1, 0),
+                 dt.datetime(2000, 1, 1, 1, 30),
+                 dt.datetime(2000, 1, 1, 8),
+                 dt.datetime(2000, 1, 1, 9)]
+
+        assert list(ts.index_of(times, True)) == [ts.index_of(t, True)
+                                                  for t in times]
+        assert np.allclose(ts.interp_alpha(times[1:4]),
+                           [ts.interp_alpha(t) for t in times[1:4]])
+
+        with pytest.raises(ValueError):
+            ts.index_of(times, False)
+        with pytest.raises(ValueError):
+            ts.interp_alpha(times)
+
+    def test_stepping(self, ts):
+        '''
+        the times of a model run, in and out of order: the same indices
+        and alphas as searching for each
+        '''
+        steps = [dt.datetime(2000, 1, 1, 0) + dt.timedelta(minutes=15) * i
+                 for i in range(33)]
+
+        for t in steps + steps[::-1] + steps[::7]:
+            i0 = np.searchsorted(ts.time, t)
+            assert ts.index_of(t, False) == i0
+
+            if i0 == 0:
+                assert ts.interp_alpha(t) == 0
+            else:
+                t0 = ts.time[i0 - 1]
+                t1 = ts.time[i0]
+                expected = (t - t0).total_seconds() / (t1 - t0).total_seconds()
+                assert np.isclose(ts.interp_alpha(t), expected)
+
 
 
 
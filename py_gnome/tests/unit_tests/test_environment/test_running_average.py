@@ -159,6 +159,33 @@ def test_full_run_extended():
     assert np.all(running_av.ossm.timeseries['value']['u'][:] == 15)
 
 
+def test_av_kept_series():
+    '''
+    the wind keeps its last running average, asking again gives the same
+    series, and changing the wind gives a new one
+    '''
+    wm = Wind(timeseries=[(datetime(2012, 9, 7, 8, 0), (10, 270)),
+                          (datetime(2012, 9, 7, 14, 0), (28, 270)),
+                          (datetime(2012, 9, 7, 20, 0), (28, 270)),
+                          (datetime(2012, 9, 8, 02, 0), (10, 270))],
+              units='m/s')
+    av = RunningAverage(wm)
+    av2 = RunningAverage(wm)
+
+    assert np.all(av.ossm.timeseries == av2.ossm.timeseries)
+    assert np.all(wm.ossm.create_running_average(3) == av.ossm.timeseries)
+
+    wm.set_wind_data(np.array([(datetime(2012, 9, 7, 8, 0), (20, 270)),
+                               (datetime(2012, 9, 7, 14, 0), (28, 270)),
+                               (datetime(2012, 9, 7, 20, 0), (28, 270)),
+                               (datetime(2012, 9, 8, 02, 0), (10, 270))],
+                              dtype=datetime_value_2d), units='m/s')
+
+    series = wm.ossm.create_running_average(3)
+    assert series['value']['u'][0] == 20.
+    assert np.any(series['value']['u'] != av.ossm.timeseries['value']['u'])
+
+
 def test_past_hours_to_average():
     """
     just make sure there are no errors
@@ -4,10 +4,15 @@ Test all operations for cats mover work
 
 import os
 
+from datetime import datetime, timedelta
+
+import numpy as np
+
 import pytest
 from pytest import raises
 
 from gnome.environment import Tide
+from gnome.utilities.time_utils import date_to_sec
 from gnome.utilities.remote_data import get_datafile
 
 from ..conftest import testdata
@@ -41,6 +46,26 @@ def test_file(filename):
     assert td.filename == os.path.split(filename)[1]
 
 
+@pytest.mark.parametrize('filename', [shio_file, ossm_file])
+def test_get_values(filename):
+    'get_values for all the times is get_time_value for each'
+    td = Tide(filename)
+    if filename == shio_file:
+        start = datetime(2013, 3, 1, 0)
+        times = [start + timedelta(minutes=30 * i) for i in range(200)]
+    else:
+        # the seconds within the file's time series
+        seconds = td.cy_obj.timeseries['time']
+        times = np.linspace(seconds[0], seconds[-1], 200).astype(np.int64)
+
+    values = td.get_values(times)
+    assert values.shape == (len(times), 2)
+
+    for time, value in zip(times, values):
+        vel_rec = td.cy_obj.get_time_value(date_to_sec(time))
+        assert np.allclose(value, (vel_rec['u'][0], vel_rec['v'][0]))
+
+
 @pytest.mark.parametrize(('filename', 'json_'),
                          [(shio_file, 'save'), (ossm_file, 'webapi')])
 def test_serialize_deserialize(filename, json_):
@@ -319,3 +319,109 @@ def test_get_emulsification_wind_with_wave_height2():
     print w.get_emulsification_wind(start_time)
     # input wave height should not have overwhelmed wind speed
     assert w.get_emulsification_wind(start_time) == 10.0
+
+
+@pytest.mark.parametrize("wave_height", [None, 1.0])
+def test_get_values(wave_height):
+    'get_values for all the times is get_value for each of them'
+    timeseries = np.array([(start_time + datetime.timedelta(hours=i),
+                            (2. * i, 45)) for i in range(10)],
+                          dtype=datetime_value_2d)
+    water = copy(default_water)
+    water.fetch = 1e4  # 10km
+    water.wave_height = wave_height
+    w = Waves(Wind(timeseries=timeseries, units='meter per second'), water)
+    times = timeseries['time']
+
+    values = w.get_values(times)
+
+    for i, time in enumerate(times):
+        expected = w.get_value(time.astype(datetime.datetime))
+        assert np.allclose([v[i] for v in values], expected)
+
+
+def counting_wind():
+    'a 5 m/s wind, with the number of its get_value calls'
+    wind = Wind(timeseries=np.array((start_time, (5, 45)),
+                                    dtype=datetime_value_2d).reshape((1, )),
+                units='meter per second')
+    wind.calls = 0
+    get_value = wind.get_value
+
+    def counted(time):
+        wind.calls += 1
+        return get_value(time)
+
+    wind.get_value = counted
+
+    return wind
+
+
+def test_step_cache():
+    'the weatherers asking for the values of a step share them'
+    wind = counting_wind()
+    w = Waves(wind, default_water)
+    w.prepare_for_model_run(start_time)
+
+    # not in a step: each is computed
+    values = w.get_value(start_time)
+    assert w.get_value(start_time) == values
+    assert wind.calls == 2
+
+    w.prepare_for_model_step(start_time)
+    for i in range(3):
+        assert w.get_value(start_time) == values
+        w.get_emulsification_wind(start_time)
+    assert wind.calls == 4
+
+    next_time = start_time + datetime.timedelta(hours=1)
+    w.prepare_for_model_step(next_time)
+    w.get_value(next_time)
+    w.get_value(next_time)
+    assert wind.calls == 5
+
+
+class FakeGridWind(object):
+    'a gridded wind of one degree cells, its speed the longitude in m/s'
+    class grid(object):
+        @staticmethod
+        def locate_faces(points):
+            return np.floor(points[:, 0]).astype(np.int64)
+
+    def __init__(self):
+        self.calls = 0
+
+    def at(self, points, time, units=None):
+        self.calls += 1
+        return np.column_stack((points[:, 0], np.zeros((len(points),))))
+
+
+def test_get_values_at():
+    'the wave field of a gridded wind varies with its cells'
+    wind = FakeGridWind()
+    w = Waves(wind, default_water)
+    w.prepare_for_model_step(start_time)
+
+    points = np.array([(4.25, 0., 0.), (4.75, 0., 0.), (10.5, 0., 0.)])
+    H, T, Wf, De = w.get_values_at(points, start_time)
+
+    assert H[0] == H[1]
+    assert np.isclose(H[0], w.compute_H(4.5))
+    assert np.isclose(H[2], w.compute_H(10.5))
+    assert np.isclose(Wf[2], w.whitecap_fraction(10.5))
+    assert wind.calls == 1
+
+    # the cells already computed for the step are not computed again
+    H2 = w.get_values_at(points[::-1], start_time)[0]
+    assert np.all(H2 == H[::-1])
+    assert wind.calls == 1
+
+
+def test_get_values_at_wind():
+    'with a Wind the values are the same everywhere'
+    w = Waves(test_wind_5, default_water)
+    points = np.array([(4.25, 0.), (40., 10.)])
+
+    for values, value in zip(w.get_values_at(points, start_time),
+                             w.get_value(start_time)):
+        assert np.allclose(values, value)
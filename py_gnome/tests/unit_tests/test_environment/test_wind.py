@@ -13,7 +13,8 @@ import unit_conversion
 
 from gnome.basic_types import datetime_value_2d
 from gnome.utilities.time_utils import (zero_time,
-                                        sec_to_date)
+                                        sec_to_date,
+                                        date_to_sec)
 from gnome.utilities.timeseries import TimeseriesError
 from gnome.environment import Wind, constant_wind, wind_from_values
 
@@ -138,6 +139,23 @@ def test_get_value(wind_circ):
         assert all(np.isclose(rec['value'], val))
 
 
+@pytest.mark.parametrize("format", ['r-theta', 'uv'])
+def test_get_values(wind_circ, format):
+    'get_values(..) for all the times is get_wind_data(..) for each'
+    wind = wind_circ['wind']
+    times = wind_circ['rq']['time']
+    expected = wind.get_wind_data(times, 'knots', format)['value']
+
+    vals = wind.get_values(times, 'knots', format)
+    assert vals.shape == (len(times), 2)
+    assert np.allclose(vals, expected)
+
+    # the same for the seconds of the times
+    assert np.allclose(wind.get_values(date_to_sec(times).astype(np.int64),
+                                       'knots', format),
+                       expected)
+
+
 @pytest.fixture(scope='module')
 def wind_rand(rq_rand):
     """
@@ -607,3 +625,60 @@ def test_wind_from_values_knots():
         vals = wind.get_value(dt)
         assert np.allclose(vals[0], unit_conversion.convert('velocity', 'knot', 'm/s', r))
         assert np.allclose(vals[1], theta)
+
+
+def test_serialize_delta():
+    'the delta has the fields set since the last serialization'
+    wind = constant_wind(1.0, 45.0, 'meter per second')
+
+    # never serialized: all of it
+    assert 'timeseries' in wind.serialize_delta()
+
+    delta = wind.serialize_delta()
+    assert delta['id'] == wind.id
+    assert 'timeseries' not in delta
+    assert 'description' not in delta
+
+    wind.description = 'changed'
+    delta = wind.serialize_delta()
+    assert delta['description'] == 'changed'
+    assert 'timeseries' not in delta
+
+    # the timeseries is serialized in the units
+    wind.units = 'knots'
+    delta = wind.serialize_delta()
+    assert delta['units'] == 'knots'
+    assert delta['timeseries'] == wind.serialize()['timeseries']
+
+
+def test_update_from_delta():
+    wind = constant_wind(1.0, 45.0, 'meter per second')
+    other = constant_wind(1.0, 45.0, 'meter per second')
+    wind.serialize()
+
+    wind.units = 'knots'
+    wind.description = 'changed'
+    assert other.update_from_delta(wind.serialize_delta())
+
+    assert other.units == 'knots'
+    assert other.description == 'changed'
+    assert np.allclose(other.timeseries['value'], wind.timeseries['value'],
+                       atol=0.01)
+
+
+def test_serialize_cached_timeseries():
+    'the serialized timeseries kept between serializations is up to date'
+    ts = np.zeros((100,), dtype=datetime_value_2d)
+    ts['time'] = [datetime(2012, 11, 6) + timedelta(hours=i)
+                  for i in range(100)]
+    ts['value'] = [(i + 1., 45.) for i in range(100)]
+    wind = Wind(timeseries=ts, units='m/s')
+
+    first = wind.serialize()['timeseries']
+    assert wind.serialize()['timeseries'] == first
+
+    ts['value'][:, 0] += 1.
+    wind.timeseries = ts
+    second = wind.serialize()['timeseries']
+    assert second != first
+    assert second[0][1][0] == 2.
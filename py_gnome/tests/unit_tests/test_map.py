@@ -378,6 +378,35 @@ class Test_RasterMap:
         # outside polygon, off land:
         assert not gmap.allowable_spill_position((3.0, 3.0, 0.))
 
+    @pytest.mark.parametrize("packed", (False, True))
+    def test_batch(self, packed):
+        """
+        the batch versions give what the point by point versions do
+        """
+        poly = ((5, 2), (15, 2), (15, 10), (10, 10), (10, 5))
+        gmap = RasterMap(refloat_halflife=6, bitmap_array=self.raster,
+                         map_bounds=((-50, -30), (-50, 30),
+                                     (50, 30), (50, -30)),
+                         projection=NoProjection(),
+                         spillable_area=[poly],
+                         packed_bitmap=packed)
+        points = np.array(((11.0, 3.0, 0.), (14.0, 9.0, 0.),
+                           (11.0, 6.0, 0.), (8.0, 6.0, 0.),
+                           (3.0, 3.0, 0.), (19.0, 11.0, 0.),
+                           (30.0, 20.0, 0.), (60.0, 0.0, 0.)))
+
+        assert np.array_equal(gmap.on_land_batch(points),
+                              [bool(gmap.on_land(p)) for p in points])
+        assert np.array_equal(gmap.in_water_batch(points),
+                              [gmap.on_map(p) and not gmap.on_land(p)
+                               for p in points])
+        assert np.array_equal(gmap.allowable_spill_batch(points),
+                              [gmap.allowable_spill_position(p)
+                               for p in points])
+        # Nx2 too
+        assert np.array_equal(gmap.allowable_spill_batch(points[:, :2]),
+                              gmap.allowable_spill_batch(points))
+
 
 class TestRefloat:
 
@@ -439,6 +468,7 @@ class TestRefloat:
 
         assert np.all((self.spill['positions'])[:5] == self.orig_pos[:5])
         assert np.all((self.spill['positions'])[5:] == self.last_water)
+        assert self.spill.beaching_counts['refloated'] == self.num_les - 5
 
     def test_refloat_halflife_negative(self):
         """
@@ -457,6 +487,19 @@ class TestRefloat:
         assert np.all((self.spill['positions']) == self.orig_pos)
         assert np.all(self.spill['status_codes'] == orig_status_codes)
 
+    def test_refloat_probability(self):
+        """
+        the probability is worked out again when the half-life changes
+        """
+        self.reset()
+
+        assert self.map._refloat_probability(self.time_step) == 0.5
+        self.map.refloat_halflife = 0
+        assert self.map._refloat_probability(self.time_step) == 1.0
+        self.map.refloat_halflife = 2 * self.time_step / 3600.
+        assert np.isclose(self.map._refloat_probability(self.time_step),
+                          1. - .5 ** .5)
+
     def test_refloat_some_onland(self):
         """
         refloat elements on land based on probability
@@ -514,6 +557,37 @@ class TestRefloat:
                       self.orig_pos[mask, :])
 
 
+def test_bna_cache(tmpdir):
+    """
+    the second map of a BNA file is loaded from the cache, the same as the
+    first
+    """
+    cache_dir = str(tmpdir)
+    first = MapFromBNA(testmap, raster_size=1000, cache_dir=cache_dir)
+    assert len(os.listdir(cache_dir)) == 1
+
+    second = MapFromBNA(testmap, raster_size=1000, cache_dir=cache_dir)
+    assert len(os.listdir(cache_dir)) == 1
+
+    assert np.array_equal(first.basebitmap, second.basebitmap)
+    assert np.array_equal(first.map_bounds, second.map_bounds)
+    for l1, l2 in zip(first.layers, second.layers):
+        assert np.array_equal(l1, l2)
+    assert len(first.land_polys) == len(second.land_polys)
+
+    # a different raster is another cache file
+    MapFromBNA(testmap, raster_size=2000, cache_dir=cache_dir)
+    assert len(os.listdir(cache_dir)) == 2
+
+    # a corrupt file is ignored
+    for name in os.listdir(cache_dir):
+        with open(os.path.join(cache_dir, name), 'wb') as fd:
+            fd.write(b'not a pickle')
+
+    third = MapFromBNA(testmap, raster_size=1000, cache_dir=cache_dir)
+    assert np.array_equal(first.basebitmap, third.basebitmap)
+
+
 class Test_MapfromBNA:
 
     print "instaniating map:", testmap
@@ -591,6 +665,38 @@ class Test_MapfromBNA:
 
         assert not self.bna_map.allowable_spill_position(off_map)
 
+    def test_in_land_polys(self):
+        points = np.array(((-127, 47.8, 0.),  # on land
+                           (-126.8, 47.84, 0.),  # in a lake
+                           (-126.78709, 48.1647, 0.),  # in water
+                           (127.643856, 47.999608, 0.)))  # off map
+
+        assert np.array_equal(self.bna_map.in_land_polys(points),
+                              (True, False, False, False))
+        assert self.bna_map.in_land_polys(points[0]) is True
+
+        # the same as the raster
+        assert np.array_equal(self.bna_map.in_land_polys(points[:3]),
+                              [self.bna_map.on_land(p) for p in points[:3]])
+
+    def test_polygon_index(self):
+        index = self.bna_map.polygon_index('land_polys')
+
+        assert index is self.bna_map.polygon_index('land_polys')
+        assert index.num_polygons == len(self.bna_map.land_polys)
+
+    def test_allowable_spill_batch(self):
+        points = np.array(((-126.984472, 48.08106, 0.),  # in water
+                           (-126.793592, 47.841064, 0.),  # in a lake
+                           (-127, 47.8, 0.),  # on land
+                           (127.244752, 47.585072, 0.),  # not spillable
+                           (127.643856, 47.999608, 0.)))  # off map
+
+        assert np.array_equal(self.bna_map.allowable_spill_batch(points),
+                              (True, True, False, False, False))
+        assert np.array_equal(self.bna_map.in_water_batch(points[:3]),
+                              [self.bna_map.in_water(p) for p in points[:3]])
+
     def test_map_on_map(self):
         point_on_map = (-126.12336, 47.454164, 0.)
 
@@ -674,11 +780,13 @@ class Test_full_move:
         assert not gmap.on_map((100.0, 1., 0.))
         assert gmap.on_map((0., 1., 0.))
 
-    def test_on_land(self):
+    @pytest.mark.parametrize('packed', (False, True))
+    def test_on_land(self, packed):
         gmap = RasterMap(refloat_halflife=6, bitmap_array=self.raster,
                          map_bounds=((-50, -30), (-50, 30),
                                      (50, 30), (50, -30)),
-                         projection=NoProjection())
+                         projection=NoProjection(),
+                         packed_bitmap=packed)
 
         assert gmap.on_land((10, 3, 0)) == 1
         assert gmap.on_land((9, 3, 0)) == 0
@@ -737,14 +845,16 @@ class Test_full_move:
         assert np.array_equal(spill['last_water_positions'][0], (9.0, 5.0, 0.))
         assert spill['status_codes'][0] == oil_status.on_land
 
-    def test_land_cross_array(self):
+    @pytest.mark.parametrize('packed', (False, True))
+    def test_land_cross_array(self, packed):
         """
         test a few LEs
         """
         gmap = RasterMap(refloat_halflife=6, bitmap_array=self.raster,
                          map_bounds=((-50, -30), (-50, 30),
                                      (50, 30), (50, -30)),
-                         projection=NoProjection())
+                         projection=NoProjection(),
+                         packed_bitmap=packed)
 
         # one left to right
         # one right to left
@@ -33,6 +33,7 @@ from gnome.weatherers import (HalfLifeWeatherer,
                               ChemicalDispersion,
                               Burn,
                               Skimmer,
+                              NaturalDispersion,
                               Emulsification)
 from gnome.outputters import Renderer, TrajectoryGeoJsonOutput
 
@@ -241,6 +242,347 @@ def test_simple_run_rewind():
     assert np.all(model.spills.LE('positions') == pos)
 
 
+def test_stage_times():
+    '''
+    the time of each step is split into the model stages, and rewind
+    starts them over
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    model = Model(start_time=start_time)
+    model.movers += SimpleMover(velocity=(1., 2., 0.))
+    model.spills += point_line_release_spill(num_elements=10,
+                                             start_position=(0., 0., 0.),
+                                             release_time=start_time)
+
+    assert model.stage_times == {}
+
+    model.full_run()
+    assert sorted(model.stage_times) == sorted(['setup', 'move', 'beach',
+                                                'weather', 'step_done',
+                                                'release', 'cache',
+                                                'output'])
+    assert all(t >= 0 for t in model.stage_times.values())
+
+    model.rewind()
+    assert model.stage_times == {}
+
+
+def test_element_view_run():
+    '''
+    the movers moving the elements in the spill container's element_view
+    move them like the get_move loop, certain and uncertain, and fusing the
+    movers moves them the same as moving them one mover at a time
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    series = np.array((start_time, (10, 45)),
+                      dtype=datetime_value_2d).reshape((1, ))
+
+    positions = []
+    for use_element_view, fuse_movers in ((False, False),
+                                          (True, False),
+                                          (True, True)):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900, uncertain=True)
+        model.use_element_view = use_element_view
+        model.fuse_movers = fuse_movers
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time)
+        model.movers += SimpleMover(velocity=(1., -1., 0.))
+        model.movers += RandomMover(diffusion_coef=100000)
+        model.movers += WindMover(Wind(timeseries=series,
+                                       units='meter per second'))
+        model.movers += CatsMover(testdata['CatsMover']['curr'])
+
+        model.full_run()
+        positions.append([np.copy(sc['positions'])
+                          for sc in model.spills.items()])
+
+    for off, on, fused in zip(*positions):
+        assert np.allclose(off, on, rtol=0, atol=1e-12)
+        assert np.all(fused == on)
+
+
+def test_sort_elements_run():
+    '''
+    sorting the elements every few steps moves them the same, found by id,
+    and times the sort separately
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    positions = []
+    for sort_interval in (0, 2):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900)
+        model.sort_interval = sort_interval
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time,
+                                                 end_position=(2., 3., 0.))
+        model.movers += SimpleMover(velocity=(1., -1., 0.))
+        model.movers += CatsMover(testdata['CatsMover']['curr'])
+
+        model.full_run()
+        assert ('sort' in model.stage_times) == (sort_interval > 0)
+
+        sc = model.spills.items()[0]
+        positions.append(sc['positions'][np.argsort(sc['id'])])
+
+    assert np.allclose(positions[0], positions[1], rtol=0, atol=1e-12)
+
+
+@pytest.mark.parametrize("wind", [False, True])
+def test_transport_fast_path_run(wind):
+    '''
+    with transport_fast_path, the steps of a transport-only run that are not
+    output run many at a time in lib_gnome, and the elements end up where
+    the steps in Python leave them
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    positions = []
+    for fast_path in (False, True):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900)
+        model.transport_fast_path = fast_path
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time,
+                                                 end_position=(2., 3., 0.))
+        model.movers += CatsMover(testdata['CatsMover']['curr'])
+        model.movers += RandomMover()
+        if wind:
+            model.movers += WindMover(constant_wind(5., 45., 'm/s'))
+
+        model.full_run()
+        assert ('transport' in model.stage_times) == fast_path
+
+        sc = model.spills.items()[0]
+        positions.append(sc['positions'][np.argsort(sc['id'])])
+
+    assert np.allclose(positions[0], positions[1], rtol=0, atol=1e-10)
+
+
+def test_transport_fast_path_not_used():
+    '''
+    the runs that weather or are uncertain step in Python
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=2),
+                  time_step=900, uncertain=True)
+    model.transport_fast_path = True
+    model.spills += point_line_release_spill(num_elements=10,
+                                             start_position=(1., 2., 0.),
+                                             release_time=start_time)
+    model.movers += RandomMover()
+
+    model.full_run()
+    assert 'transport' not in model.stage_times
+
+
+def test_concurrent_spill_containers_run():
+    '''
+    moving and weathering the forecast and uncertain spill containers at
+    the same time comes out the same as one after the other
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    results = []
+    for concurrent in (False, True):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900, uncertain=True)
+        model.use_element_view = True
+        model.concurrent_spill_containers = concurrent
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time,
+                                                 substance=test_oil,
+                                                 amount=1000, units='kg')
+        model.movers += CatsMover(testdata['CatsMover']['curr'])
+        random_mover = RandomMover()
+        random_mover.mover.use_counter_rng = True
+        model.movers += random_mover
+        model.environment += Water()
+        model.weatherers += HalfLifeWeatherer()
+
+        model.full_run()
+        results.append([np.copy(sc[name]) for sc in model.spills.items()
+                        for name in ('positions', 'mass', 'status_codes')])
+
+    for off, on in zip(*results):
+        assert np.all(off == on)
+
+
+def test_concurrent_substances_run():
+    '''
+    weathering the substances of a spill container at the same time comes
+    out the same as one after the other
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    results = []
+    for concurrent in (False, True):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900)
+        model.concurrent_substances = concurrent
+
+        for substance in (test_oil, 'ARABIAN MEDIUM, EXXON'):
+            model.spills += point_line_release_spill(num_elements=100,
+                                                     start_position=(1., 2.,
+                                                                     0.),
+                                                     release_time=start_time,
+                                                     substance=substance,
+                                                     amount=1000, units='kg')
+        model.environment += [Water(), constant_wind(5., 0)]
+        model.weatherers += [Evaporation(), HalfLifeWeatherer()]
+        model.set_make_default_refs(True)
+
+        model.full_run()
+        sc = model.spills.items()[0]
+        results.append((np.copy(sc['mass']), sc.mass_balance['evaporated']))
+
+    assert np.all(results[0][0] == results[1][0])
+    assert np.isclose(results[0][1], results[1][1])
+    assert results[1][1] > 0
+
+
+def test_chain_weatherers_run():
+    '''
+    evaporation, dispersion and emulsification run as stages of lib_gnome's
+    weathering pipeline weather the elements as the weatherers do one after
+    the other, to the summation order
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    keys = ('evaporated', 'natural_dispersion', 'sedimentation',
+            'water_content')
+
+    results = []
+    for chain in (False, True):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900)
+        model.chain_weatherers = chain
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time,
+                                                 substance=test_oil,
+                                                 amount=1000, units='kg')
+        water = Water()
+        wind = constant_wind(10., 0)
+        model.environment += [water, wind, Waves(wind, water)]
+        model.weatherers += [Evaporation(), NaturalDispersion(),
+                             Emulsification()]
+        model.set_make_default_refs(True)
+
+        model.full_run()
+        sc = model.spills.items()[0]
+        results.append([np.copy(sc[name])
+                        for name in ('mass_components', 'mass', 'frac_lost',
+                                     'frac_water', 'droplet_avg_size')] +
+                       [sc.mass_balance[key] for key in keys])
+
+    for off, on in zip(*results):
+        assert np.allclose(off, on)
+
+    balance = dict(zip(keys, results[1][-len(keys):]))
+    assert balance['evaporated'] > 0
+    assert balance['natural_dispersion'] > 0
+
+
+def test_scratch_arrays_reused():
+    '''
+    once the elements are released, the steps take the temporary arrays of
+    the weatherers and the movers from the scratch pool without allocating
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=6),
+                  time_step=900)
+
+    model.spills += point_line_release_spill(num_elements=100,
+                                             start_position=(1., 2., 0.),
+                                             release_time=start_time,
+                                             substance=test_oil,
+                                             amount=1000, units='kg')
+    water = Water()
+    wind = constant_wind(10., 0)
+    model.environment += [water, wind, Waves(wind, water)]
+    model.movers += SimpleMover(velocity=(1., -1., 0.))
+    model.weatherers += [Evaporation(), NaturalDispersion(),
+                         Emulsification()]
+    model.set_make_default_refs(True)
+
+    for _i in range(3):
+        model.step()
+    after_release = model.timing_stats['scratch']['forecast']
+
+    model.full_run()
+    stats = model.timing_stats['scratch']['forecast']
+
+    assert stats['requests'] > after_release['requests']
+    assert stats['allocations'] == after_release['allocations']
+
+
+def test_pipeline_steps_run():
+    '''
+    reading the next step's forcing while the elements weather, the movers
+    get each step's prepare_forcing() before its prepare_for_model_step(),
+    and the run comes out the same
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+
+    class ForcingMover(SimpleMover):
+        def prepare_forcing(self, time_step, model_time_datetime):
+            self.calls.append(('forcing', model_time_datetime))
+
+        def prepare_for_model_step(self, sc, time_step, model_time_datetime):
+            if not sc.uncertain:
+                self.calls.append(('step', model_time_datetime))
+            super(ForcingMover, self).prepare_for_model_step(
+                sc, time_step, model_time_datetime)
+
+    results = []
+    for pipeline_steps in (False, True):
+        model = Model(start_time=start_time, duration=timedelta(hours=6),
+                      time_step=900, uncertain=True)
+        model.pipeline_steps = pipeline_steps
+
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(1., 2., 0.),
+                                                 release_time=start_time,
+                                                 substance=test_oil,
+                                                 amount=1000, units='kg')
+        mover = ForcingMover(velocity=(1., -1., 0.))
+        mover.calls = []
+        model.movers += mover
+        model.movers += CatsMover(testdata['CatsMover']['curr'])
+        model.environment += Water()
+        model.weatherers += HalfLifeWeatherer()
+
+        model.full_run()
+        results.append([np.copy(sc['positions'])
+                        for sc in model.spills.items()] +
+                       [np.copy(sc['mass']) for sc in model.spills.items()])
+
+        steps = [t for call, t in mover.calls if call == 'step']
+        forcing = [t for call, t in mover.calls if call == 'forcing']
+        if pipeline_steps:
+            # every step but the first has its forcing read ahead
+            assert forcing == steps[1:]
+            for t in forcing:
+                assert (mover.calls.index(('forcing', t)) <
+                        mover.calls.index(('step', t)))
+        else:
+            assert forcing == []
+
+    for off, on in zip(*results):
+        assert np.all(off == on)
+
+
 def test_simple_run_with_map():
     '''
     pretty much all this tests is that the model will run
@@ -1276,6 +1618,33 @@ class TestMergeModels:
 
 
 # test sorting function weatherer_sort
+def test_serialize_delta():
+    '''
+    the delta of a model has the changed objects of its collections, or the
+    whole collection if objects were added
+    '''
+    model = Model()
+    wind = constant_wind(1., 0.)
+    model.environment += wind
+    model.serialize()
+
+    delta = model.serialize_delta()
+    assert 'environment' not in delta
+    assert 'valid' in delta
+
+    wind.description = 'changed'
+    delta = model.serialize_delta()
+    assert [item['id'] for item in delta['environment']] == [wind.id]
+    assert delta['environment'][0]['description'] == 'changed'
+    assert 'timeseries' not in delta['environment'][0]
+
+    model.movers += SimpleMover(velocity=(1., 0., 0.))
+    delta = model.serialize_delta()
+    assert 'environment' not in delta
+    assert len(delta['movers']) == 1
+    assert 'velocity' in delta['movers'][0]
+
+
 def test_weatherer_sort():
     '''
     Sample model with weatherers - only tests sorting of weathereres. The
@@ -1,4 +1,6 @@
 import os
+import socket
+from collections import deque
 
 from datetime import datetime, timedelta
 
@@ -21,7 +23,10 @@ from gnome.weatherers import Evaporation, ChemicalDispersion, Burn, Skimmer
 
 from gnome.outputters import WeatheringOutput, TrajectoryGeoJsonOutput
 
-from gnome.multi_model_broadcast import ModelBroadcaster
+from gnome.multi_model_broadcast import (ModelBroadcaster,
+                                        ModelConsumer,
+                                        EnsembleScheduler,
+                                        available_cpus)
 from conftest import testdata, test_oil
 
 from pprint import PrettyPrinter
@@ -278,6 +283,154 @@ def test_weathering_output_only():
     model_broadcaster.stop()
 
 
+def test_pin_cpus():
+    model = make_model()
+
+    model_broadcaster = ModelBroadcaster(model,
+                                         ('down', 'up'),
+                                         ('down', 'up'),
+                                         pin_cpus=True)
+
+    res = model_broadcaster.cmd('step', {})
+    assert len(res) == 4
+
+    cpus = available_cpus()
+    if cpus:
+        assert [c.cpu for c in model_broadcaster.consumers] == \
+            [cpus[i % len(cpus)] for i in range(4)]
+
+    model_broadcaster.stop()
+
+
+def test_set_model():
+    """
+    the consumers run a new model without being forked again
+    """
+    model = make_model()
+
+    model_broadcaster = ModelBroadcaster(model,
+                                         ('down', 'normal', 'up'),
+                                         ('down', 'normal', 'up'))
+    pids = [c.pid for c in model_broadcaster.consumers]
+
+    model_broadcaster.cmd('step', {})
+
+    new_model = make_model(geojson_output=True)
+    new_model.spills[0].amount = 2000
+    model_broadcaster.set_model(new_model)
+
+    assert [c.pid for c in model_broadcaster.consumers] == pids
+    assert not [f for f in os.listdir(model_broadcaster.ipc_folder)
+                if f.startswith('Model-')]
+
+    res = model_broadcaster.cmd('get_spill_amounts', {}, ('up', 'up'))
+    assert np.isclose(res[0], 3333.33333)
+
+    res = model_broadcaster.cmd('get_outputters', {})
+    assert not [o for r in res for o in r
+                if not isinstance(o, WeatheringOutput)]
+
+    res = model_broadcaster.cmd('step', {})
+    assert len(res) == 9
+    assert all([r['step_num'] == 0 for r in res])
+
+    model_broadcaster.stop()
+
+
+def test_ensemble_scheduler():
+    model = make_model()
+    members = [(wsu, sau)
+               for wsu in ('down', 'normal', 'up')
+               for sau in ('down', 'normal', 'up')]
+
+    scheduler = EnsembleScheduler(model, members, num_workers=4,
+                                  batch_steps=10)
+    assert len(scheduler.consumers) == 4
+    assert sorted([m for q in scheduler.queues for m in q]) == range(9)
+
+    num_steps = model.num_time_steps
+    step_nums = [[] for _m in members]
+
+    for member, results in scheduler.run():
+        assert 0 < len(results) <= 10
+        step_nums[member].extend([r['step_num'] for r in results])
+
+        steps_run, steps_in_run = scheduler.progress[member]
+        assert steps_run == len(step_nums[member])
+        assert steps_in_run == num_steps
+
+    # each member ran all its steps, in order
+    assert step_nums == [range(num_steps)] * 9
+    assert scheduler.progress == [(num_steps, num_steps)] * 9
+    assert not [q for q in scheduler.queues if q]
+
+    scheduler.stop()
+    assert not os.path.exists(scheduler.saveloc)
+
+
+def test_ensemble_scheduler_stealing():
+    """
+    a worker with no members of its own runs the members of another
+    """
+    model = make_model()
+    scheduler = EnsembleScheduler(model, [('down', 'down'), ('up', 'up')],
+                                  num_workers=2, batch_steps=100)
+    scheduler.queues = [deque([0, 1]), deque()]
+
+    assert scheduler._next_member(1) == 1
+    assert scheduler._next_member(1) is None
+    assert scheduler._next_member(0) == 0
+
+    scheduler.queues = [deque([0, 1]), deque()]
+    res = scheduler.full_run()
+
+    assert [len(r) for r in res] == [model.num_time_steps] * 2
+
+    scheduler.stop()
+
+
+def test_ensemble_scheduler_stop_early():
+    model = make_model()
+    scheduler = EnsembleScheduler(model, [('down', 'down'), ('up', 'up')],
+                                  num_workers=2, batch_steps=1)
+
+    for member, results in scheduler.run():
+        break
+
+    scheduler.stop()
+    assert not scheduler.consumers
+
+
+def test_ensemble_scheduler_tcp_worker():
+    '''
+    a worker bound to a TCP port, as on another host, runs members with
+    the local ones
+    '''
+    sock = socket.socket()
+    sock.bind(('127.0.0.1', 0))
+    endpoint = 'tcp://127.0.0.1:{0}'.format(sock.getsockname()[1])
+    sock.close()
+
+    worker = ModelConsumer(None, None, endpoint=endpoint)
+    worker.start()
+
+    model = make_model()
+    scheduler = EnsembleScheduler(model,
+                                  [('down', 'down'), ('up', 'up'),
+                                   ('normal', 'normal')],
+                                  num_workers=1, batch_steps=100,
+                                  endpoints=[endpoint])
+    assert len(scheduler.consumers) == 1
+    assert len(scheduler.tasks) == 2
+    assert scheduler.savelocs[1] != scheduler.saveloc
+
+    res = scheduler.full_run()
+    assert [len(r) for r in res] == [model.num_time_steps] * 3
+
+    scheduler.stop()
+    worker.join()
+
+
 if __name__ == '__main__':
     scripting.make_images_dir()
 
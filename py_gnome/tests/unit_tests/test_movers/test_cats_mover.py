@@ -104,6 +104,29 @@ def test_certain_uncertain():
     assert np.all(delta[:, 2] == u_delta[:, 2])
 
 
+def test_model_step_times():
+    '''
+    the tide looked up once for the run's step times moves the elements as
+    it does looked up at the step
+    '''
+    pSpill = sample_sc_release(num_le, start_pos, rel_time)
+    tide = Tide(filename=testdata['CatsMover']['tide'])
+    cats = CatsMover(curr_file, tide=tide)
+    delta = _certain_loop(pSpill, cats)
+
+    # model_time is the run's third step, a second mover shares the tide
+    start = model_time - datetime.timedelta(seconds=2 * time_step)
+    other = CatsMover(curr_file, tide=tide)
+    for mover in (cats, other):
+        mover.set_model_step_times(start, time_step, 5)
+        assert np.all(_certain_loop(pSpill, mover) == delta)
+
+    # not a step time, the tide is looked up as before
+    cats.set_model_step_times(start + datetime.timedelta(seconds=60),
+                              time_step, 5)
+    assert np.all(_certain_loop(pSpill, cats) == delta)
+
+
 c_cats = CatsMover(curr_file)
 
 
@@ -100,6 +100,24 @@ def test_ice_fields():
     # return frac, thick
 
 
+def test_movement_field():
+    """
+    the movement field blended once per step gives the same moves as the
+    blend per LE
+    """
+    deltas = []
+    for use_field in (False, True):
+        pSpill = sample_sc_release(num_le, start_pos, rel_time)
+        ice_mover = IceMover(ice_file, topology_file)
+        ice_mover.mover.movement_field = use_field
+        assert ice_mover.mover.movement_field == use_field
+
+        deltas.append(_certain_loop(pSpill, ice_mover))
+
+    _assert_move(deltas[1])
+    assert np.array_equal(deltas[0], deltas[1])
+
+
 # def test_uncertain_loop(uncertain_time_delay=0):
 #     """
 #     test one time step with uncertainty on the spill
@@ -98,3 +98,33 @@ def test_get_move():
     mv = movers.Mover()
     delta = mv.get_move(sc, time_step, model_time)
     assert np.all(np.isnan(delta))
+
+
+def test_world_points_view_the_positions():
+    '''
+    the spill container's positions are passed to the cython movers as they
+    are, and converted only when their layout isn't the one they take
+    '''
+    sc = sample_sc_release(10, (0, 0, 0))
+
+    points = movers.world_points(sc['positions'])
+    assert points.shape == (10, )
+    assert np.may_share_memory(points, sc['positions'])
+    assert movers.c_layout(sc['status_codes'],
+                           sc['status_codes'].dtype) is sc['status_codes']
+
+    strided = np.zeros((10, 6))[:, ::2]
+    assert not np.may_share_memory(movers.world_points(strided), strided)
+
+    as_float32 = sc['positions'].astype(np.float32)
+    points = movers.world_points(as_float32)
+    assert np.all(points.view(np.float64).reshape(-1, 3) == as_float32)
+
+
+def test_zero_world_points():
+    sc = sample_sc_release(10, (0, 0, 0))
+
+    delta = movers.zero_world_points(sc, 10)
+    assert delta.shape == (10, )
+    assert np.all(delta['lat'] == 0)
+    assert movers.zero_world_points(sc, 10) is not delta
@@ -0,0 +1,53 @@
+'''
+Test the TracPy mover moves the elements as the GridCurrentMover it is
+'''
+import datetime
+
+import numpy as np
+
+from gnome import basic_types
+from gnome.movers import GridCurrentMover, TracPyMover
+from gnome.utilities import time_utils
+
+from ..conftest import sample_sc_release, testdata
+
+curr_file = testdata['GridCurrentMover']['curr_curv']
+topology_file = testdata['GridCurrentMover']['top_curv']
+
+num_le = 4
+start_pos = (-74.03988, 40.536092, 0)
+rel_time = datetime.datetime(2008, 1, 29, 17)
+time_step = 15 * 60  # seconds
+model_time = time_utils.sec_to_date(time_utils.date_to_sec(rel_time))
+
+
+def _certain_loop(pSpill, curr):
+    curr.prepare_for_model_run()
+    curr.prepare_for_model_step(pSpill, time_step, model_time)
+    delta = curr.get_move(pSpill, time_step, model_time)
+    curr.model_step_is_done()
+
+    return delta
+
+
+def test_default_props():
+    tracpy = TracPyMover(curr_file, topology_file)
+
+    assert tracpy.num_method == basic_types.numerical_methods.rk4
+    assert isinstance(tracpy, GridCurrentMover)
+    assert repr(tracpy).startswith('TracPyMover(')
+
+
+def test_loop():
+    '''
+    the move is the GridCurrentMover's RK4 move
+    '''
+    pSpill = sample_sc_release(num_le, start_pos, rel_time)
+    delta = _certain_loop(pSpill, TracPyMover(curr_file, topology_file))
+
+    assert np.all(delta[:, :2] != 0)
+    assert np.all(delta[:, 2] == 0)
+
+    grid = GridCurrentMover(curr_file, topology_file,
+                            num_method=basic_types.numerical_methods.rk4)
+    assert np.all(_certain_loop(pSpill, grid) == delta)
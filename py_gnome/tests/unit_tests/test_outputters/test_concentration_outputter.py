@@ -0,0 +1,86 @@
+'''
+tests the concentration outputter: the mass of the elements in the water on
+a grid, written to NetCDF
+'''
+import os
+from datetime import timedelta
+
+import numpy as np
+import pytest
+
+import netCDF4 as nc
+
+from gnome.basic_types import oil_status
+from gnome.spill import point_line_release_spill
+from gnome.outputters import ConcentrationGridOutput
+
+
+@pytest.fixture(scope='function')
+def model(sample_model_fcn, output_dir):
+    model = sample_model_fcn['model']
+    model.cache_enabled = True
+    model.spills += point_line_release_spill(20,
+                                             start_position=sample_model_fcn
+                                             ['release_start_pos'],
+                                             release_time=model.start_time,
+                                             end_release_time=model.start_time
+                                             + timedelta(minutes=30),
+                                             amount=20, units='kg')
+
+    filename = os.path.join(output_dir, 'concentration.nc')
+    model.outputters += ConcentrationGridOutput(filename,
+                                                bounds=((-128., 47.),
+                                                        (-126., 49.)),
+                                                shape=(20, 20))
+    model.rewind()
+
+    return model
+
+
+def test_needs_a_grid():
+    with pytest.raises(ValueError):
+        ConcentrationGridOutput('concentration.nc')
+
+
+def test_model_run(model):
+    output = model.outputters[0]
+    in_water = []
+
+    for step in model:
+        sc = model.spills.items()[0]
+        in_water.append(sc['mass'][sc['status_codes'] == oil_status.in_water].sum())
+
+    with nc.Dataset(output.filename) as data:
+        mass = data.variables['mass'][:]
+        conc = data.variables['concentration'][:]
+        area = data.variables['cell_area'][:]
+
+        assert mass.shape == (model.num_time_steps, 1, 20, 20)
+        assert len(data.variables['time']) == model.num_time_steps
+        assert np.all(data.variables['lon'][:] > -128.)
+        assert np.all(np.diff(data.variables['lat'][:]) > 0)
+
+    assert np.all(mass.sum(axis=(1, 2, 3)) <= np.array(in_water) + 1e-3)
+    assert mass[-1].sum() > 0
+
+    # a meter deep layer
+    assert np.allclose(conc, mass / area[None, None, ...], rtol=1e-5)
+
+
+def test_rewind(model):
+    'a second run replaces the file'
+    model.full_run()
+    model.rewind()
+    model.full_run()
+
+    with nc.Dataset(model.outputters[0].filename) as data:
+        assert len(data.variables['time']) == model.num_time_steps
+
+
+def test_serialize(model):
+    'the model grid is not saved, the regular one is'
+    output = model.outputters[0]
+    dict_ = ConcentrationGridOutput.deserialize(output.serialize())
+
+    assert tuple(dict_['shape']) == (20, 20)
+    assert list(dict_['depth_edges']) == [0., 1.]
@@ -95,3 +95,33 @@ def test_current_grid_json_output(model):
             assert len(fc['direction']) > 0
             assert len(fc['magnitude']) > 0
             assert len(fc['magnitude']) == len(fc['direction'])
+
+
+def test_current_grid_tiles(model, dump):
+    '''
+        with tiles on, the steps give the pyramid of each mover and its
+        tiles hold the quantized velocities of the grid
+    '''
+    model.outputters.clear()
+    output = CurrentJsonOutput([c_cats], tiles=True, tile_cache_dir=dump)
+    model.outputters += output
+    model.rewind()
+
+    num_cells = len(c_cats.get_center_points())
+
+    for step in model:
+        pyramid = step['CurrentJsonOutput'][c_cats.id]
+        assert pyramid['min_zoom'] <= pyramid['max_zoom']
+
+        time = model.model_time
+        zoom = pyramid['max_zoom']
+        tiles = [output.get_tile(c_cats.id, time, zoom, x, y)
+                 for x, y in output._pyramids[c_cats.id].tiles_at(zoom)]
+
+        assert 0 < sum(len(tile['bins']) for tile in tiles) <= num_cells
+        assert any(any(q) for tile in tiles for q in tile['values'])
+
+        with pytest.raises(KeyError):
+            output.get_tile('not a mover', time, zoom, 0, 0)
+
+        break
@@ -2,13 +2,18 @@
 tests for geojson outputter
 '''
 import os
+import json
 from glob import glob
 from datetime import timedelta
+from StringIO import StringIO
 
 import numpy as np
 import pytest
+import geojson
 
 from gnome.outputters import TrajectoryGeoJsonOutput
+from gnome.outputters.streaming import (write_point_features,
+                                        decode_typed_array)
 from gnome.spill import SpatialRelease, Spill, point_line_release_spill
 from gnome.basic_types import oil_status
 from gnome.environment import constant_wind, Water
@@ -139,3 +144,82 @@ def test_geojson_multipoint_output(model):
                         atol=10 ** -round_to)
 
     model.outputters[-1].output_dir = odir
+
+
+def test_output_formats(model):
+    '''
+    the text and binary output have the data of the geojson objects
+    '''
+    o_put = model.outputters[-1]
+    odir = o_put.output_dir
+    o_put.output_dir = None
+
+    outputs = {}
+    for output_format in o_put.output_formats:
+        o_put.output_format = output_format
+        model.rewind()
+        outputs[output_format] = [step['TrajectoryGeoJsonOutput']
+                                  for step in model]
+
+    for geo, text, binary in zip(outputs['geojson'], outputs['text'],
+                                 outputs['binary']):
+        for key in ('certain', 'uncertain'):
+            expected = json.loads(geojson.dumps(geo[key]))
+            assert json.loads(text[key]) == expected
+
+            features = expected['features']
+            assert binary[key]['num_elements'] == len(features)
+            coords = decode_typed_array(binary[key]['coordinates'])
+            assert coords.dtype == np.float32
+            assert np.allclose(coords.reshape(-1, 2),
+                               [f['geometry']['coordinates']
+                                for f in features], atol=1e-3)
+            assert (decode_typed_array(binary[key]['status_code']).tolist() ==
+                    [f['properties']['status_code'] for f in features])
+            assert (decode_typed_array(binary[key]['spill_num']).tolist() ==
+                    [f['properties']['spill_num'] for f in features])
+
+    o_put.output_format = 'geojson'
+    o_put.output_dir = odir
+
+
+def test_output_files(model, output_dir):
+    '''
+    the files are written from the arrays, and are the geojson of a step
+    '''
+    model.rewind()
+
+    for step in model:
+        output = step['TrajectoryGeoJsonOutput']
+
+        # the uncertain elements go in the same file
+        with open(output['output_filename']) as f:
+            assert json.load(f) == json.loads(geojson.dumps(output['uncertain']))
+
+
+def test_bad_output_format():
+    with pytest.raises(ValueError):
+        TrajectoryGeoJsonOutput(output_format='xml')
+
+
+def test_write_point_features():
+    positions = np.array([(-123.123456, 45.5, 1.0), (10.0, -1.25, 0.0)])
+    mass = np.array([1.0 / 3, 2.0])
+    text = StringIO()
+
+    write_point_features(text, positions,
+                         [('mass', mass), ('flag', np.array([True, False])),
+                          ('label', '100%')],
+                         decimals=2, chunk_rows=1)
+
+    fc = json.loads(text.getvalue())
+    assert [f['id'] for f in fc['features']] == [0, 1]
+    assert fc['features'][0]['geometry']['coordinates'] == [-123.12, 45.5]
+    assert fc['features'][0]['properties'] == {'mass': 0.33, 'flag': 1,
+                                               'label': '100%'}
+    assert fc['features'][1]['properties']['mass'] == 2.0
+
+    text = StringIO()
+    write_point_features(text, np.zeros((0, 3)), [('mass', np.zeros(0))])
+    assert json.loads(text.getvalue()) == {'type': 'FeatureCollection',
+                                           'features': []}
@@ -13,6 +13,7 @@ from gnome.utilities import time_utils
 from gnome.spill import SpatialRelease, Spill, point_line_release_spill
 from gnome.movers import IceMover
 from gnome.outputters import IceGeoJsonOutput, IceJsonOutput
+from gnome.outputters.ice_products import IceProducts
 
 from ..conftest import testdata
 
@@ -63,6 +64,43 @@ def test_init():
     assert g.ice_movers[0] == c_ice_mover
 
 
+def test_ice_fields_again():
+    '''
+        the fields blended from the slices gathered once are the same
+        asked for again, after another time
+    '''
+    model_time = time_utils.date_to_sec(datetime(2015, 5, 14, 6))
+
+    fields = c_ice_mover.get_ice_fields(model_time)
+    c_ice_mover.get_ice_fields(model_time + 3600)
+    again = c_ice_mover.get_ice_fields(model_time)
+
+    for a, b in zip(fields, again):
+        assert np.array_equal(a, b)
+
+
+def test_ice_products():
+    'a product is made again only for other fields'
+    products = IceProducts()
+    made = []
+
+    def make(coverage, thickness):
+        made.append((coverage.sum(), thickness.sum()))
+        return len(made)
+
+    fields = (np.zeros(4), np.ones(4))
+    assert products.product('fc', fields, make) == 1
+    assert products.product('fc', (np.zeros(4), np.ones(4)), make) == 1
+
+    # the fields kept are copies
+    fields[0][0] = 1.
+    assert products.product('fc', fields, make) == 2
+    assert products.product('image', fields, make) == 3
+
+    products.clear()
+    assert products.product('fc', fields, make) == 4
+
+
 def test_ice_geojson_output(model):
     '''
         test geojson outputter with a model since simplest to do that
@@ -3,6 +3,7 @@ tests for kmz outputter
 '''
 
 import os
+import zipfile
 from glob import glob
 from datetime import datetime, timedelta
 
@@ -200,3 +201,37 @@ def test_on_timestep_kml():
 #     assert len(files) == int((model.num_time_steps-2)/output_ts_factor) + 2
 #     o_geojson.output_timestep = None
 #     model.outputters += o_geojson
+
+
+def test_timestep_points():
+    '''
+    the points are all formatted at once, as the template formats them
+    '''
+    floating_positions = np.array([(23.45, 45.2, 0), (-13.45, 12.2, 0)])
+
+    kml = kmz_templates.build_one_timestep(floating_positions,
+                                           np.zeros((0, 3)),
+                                           '2015-10-23T14:00:00',
+                                           '2015-10-23T15:00:00',
+                                           uncertain=False,
+                                           )
+
+    points = "".join(kmz_templates.point_template.format(*p[:2])
+                     for p in floating_positions)
+    assert points in kml
+    assert kml.count('<Point>') == 2
+
+
+def test_kml_in_kmz(model, output_filename):
+    kmz = KMZOutput(output_filename)
+    model.outputters += kmz
+    model.full_run()
+
+    with zipfile.ZipFile(kmz.filename) as kmzfile:
+        kml = kmzfile.read(kmz.kml_name)
+
+    assert kml.startswith('<?xml')
+    assert kml.rstrip().endswith('</kml>')
+    assert kml.count('<Folder>') == model.num_time_steps * 2
+    # nothing else is left beside the kmz
+    assert glob(kmz.filename + '*') == [kmz.filename]
@@ -20,6 +20,7 @@ from gnome.weatherers import Evaporation
 from gnome.environment import Water
 from gnome.movers import RandomMover, constant_wind_mover
 from gnome.outputters import NetCDFOutput
+from gnome.utilities.nc_particles import nc_particle_file
 from gnome.model import Model
 from ..conftest import test_oil
 
@@ -320,6 +321,100 @@ def test_write_output_all_data(model):
         uncertain = True
 
 
+def _read_variables(file_):
+    'the values of the variables and mass_balance variables in file_'
+    with nc.Dataset(file_) as data:
+        values = {name: var[:] for name, var in data.variables.iteritems()}
+        if 'mass_balance' in data.groups:
+            for name, var in data.groups['mass_balance'].variables.iteritems():
+                values['mass_balance/' + name] = var[:]
+
+    return values
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize("buffer_steps", [2, 3, 100])
+def test_write_output_buffered(model, buffer_steps):
+    """
+    buffered steps are written to the files as they are written step by step
+    """
+    o_put = [model.outputters[outputter.id]
+             for outputter in model.outputters
+             if isinstance(outputter, NetCDFOutput)][0]
+    o_put.which_data = 'most'
+
+    model.rewind()
+    _run_model(model)
+    files = (o_put.netcdf_filename, o_put._u_netcdf_filename)
+    expected = [_read_variables(file_) for file_ in files]
+
+    model.rewind()
+    o_put.buffer_steps = buffer_steps
+    _run_model(model)
+
+    assert o_put._buffered == {}
+    for file_, values in zip(files, expected):
+        written = _read_variables(file_)
+        assert sorted(written) == sorted(values)
+        for name in values:
+            assert np.array_equal(written[name], values[name])
+
+        with nc.Dataset(file_) as data:
+            chunks = data.variables['mass'].chunking()
+            assert chunks[0] > o_put.chunksize
+
+    model.rewind()
+    with raises(ValueError):
+        o_put.buffer_steps = 0
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize("buffer_steps", [1, 3])
+def test_write_index(model, buffer_steps):
+    '''
+    the index has the offset of each step, and each particle's records
+    linked back from its last, as scanning the counts and the ids finds them
+    '''
+    o_put = [model.outputters[outputter.id]
+             for outputter in model.outputters
+             if isinstance(outputter, NetCDFOutput)][0]
+    o_put.buffer_steps = buffer_steps
+
+    model.rewind()
+    _run_model(model)
+
+    for file_ in (o_put.netcdf_filename, o_put._u_netcdf_filename):
+        with nc.Dataset(file_) as data:
+            dv = data.variables
+            counts = dv['particle_count'][:]
+            assert np.all(dv['step_offset'][:] ==
+                          np.cumsum(counts) - counts)
+
+            reader = nc_particle_file(data)
+            assert reader.indexed
+            ids = dv['id'][:]
+            for particle_id in np.unique(ids):
+                records = np.nonzero(ids == particle_id)[0]
+                traj = reader.get_individual_trajectory(particle_id,
+                                                        ['id', 'mass'])
+
+                assert np.all(traj['id'] == particle_id)
+                assert np.all(traj['mass'] == dv['mass'][records])
+                assert np.all(reader.data_index[traj['timestep']] <=
+                              records)
+                assert np.all(records <
+                              reader.data_index[traj['timestep'] + 1])
+
+            missing = reader.get_individual_trajectory(ids.max() + 1)
+            assert len(missing['latitude']) == 0
+
+    # a step is read from its offset
+    step = model.num_time_steps - 1
+    data, _ = NetCDFOutput.read_data(o_put.netcdf_filename, index=step)
+    scp = model._cache.load_timestep(step)
+    assert np.all(data['id'] == scp.LE('id'))
+
+
 def test_run_without_spills(model):
     for spill in model.spills:
         del model.spills[spill.id]
@@ -0,0 +1,197 @@
+#!/usr/bin/env python
+"""
+tests for running outputters on the background OutputWriter
+"""
+import threading
+
+import numpy as np
+import pytest
+
+from gnome.basic_types import oil_status
+from gnome.spill import point_line_release_spill
+from gnome.outputters import Outputter
+from gnome.outputters.output_writer import OutputWriter, StepSnapshot
+
+
+class RecordingOutputter(Outputter):
+    """
+    notes the steps it writes, the positions it writes and the thread it
+    writes them on
+    """
+    def __init__(self, **kwargs):
+        super(RecordingOutputter, self).__init__(**kwargs)
+        self.written = []
+        self.threads = set()
+
+    def write_output(self, step_num, islast_step=False):
+        super(RecordingOutputter, self).write_output(step_num, islast_step)
+        self.threads.add(threading.current_thread().name)
+
+        if not self._write_step:
+            return None
+
+        sc = self.cache.load_timestep(step_num).items()[0]
+        self.written.append((step_num, islast_step, sc.current_time_stamp,
+                             sc['positions'].sum()))
+
+        return {'step_num': step_num}
+
+
+class LiveOutputter(RecordingOutputter):
+    background_safe = False
+
+
+class FailingOutputter(Outputter):
+    def write_output(self, step_num, islast_step=False):
+        super(FailingOutputter, self).write_output(step_num, islast_step)
+        if step_num == 2:
+            raise IOError('disk full')
+
+
+@pytest.fixture(scope='module')
+def model(sample_model):
+    model = sample_model['model']
+    model.spills += point_line_release_spill(num_elements=10,
+                        start_position=sample_model['release_start_pos'],
+                        release_time=model.start_time,
+                        end_release_time=model.start_time + model.duration)
+
+    return model
+
+
+class FakeSpillContainer(dict):
+    uncertain = False
+
+
+class FakeCache(object):
+    'a cache of one step, counting its loads'
+    def __init__(self):
+        self.loads = 0
+        self.sc = FakeSpillContainer(
+            status_codes=np.array([oil_status.in_water, oil_status.on_land]),
+            positions=np.zeros((2, 3)))
+
+    def load_timestep(self, step_num):
+        self.loads += 1
+        return self
+
+    def items(self):
+        return [self.sc]
+
+
+def test_lazy_snapshot():
+    cache = FakeCache()
+    snapshot = StepSnapshot(cache, 3, lazy=True)
+    assert cache.loads == 0
+
+    sc = snapshot.load_timestep(3).items()[0]
+    snapshot.load_timestep(3)
+    assert cache.loads == 1
+
+    on_land = snapshot.derived(sc, 'on_land')
+    assert list(on_land) == [False, True]
+    assert snapshot.derived(sc, 'on_land') is on_land
+
+    coordinates = snapshot.derived(sc, 'coordinates_f4')
+    assert coordinates.dtype == np.float32 and coordinates.shape == (2, 2)
+
+
+def test_snapshot_unwritten_step(model):
+    """
+    outputters that write no step don't load the steps from the cache
+    """
+    class NotWriting(Outputter):
+        def write_output(self, step_num, islast_step=False):
+            super(NotWriting, self).write_output(step_num, islast_step)
+            if self._write_step:
+                self.cache.load_timestep(step_num)
+
+    loads = []
+    model.outputters += NotWriting(output_zero_step=False,
+                                   output_last_step=False,
+                                   output_timestep=model.duration * 2)
+    model.output_queue_depth = 0
+    model.rewind()
+
+    load_timestep = model._cache.load_timestep
+
+    def counting_load(step_num):
+        loads.append(step_num)
+        return load_timestep(step_num)
+
+    model._cache.load_timestep = counting_load
+    try:
+        model.full_run(rewind=False)
+    finally:
+        del model._cache.load_timestep
+
+    assert loads == []
+    model.outputters.clear()
+
+
+def test_writer_order():
+    writer = OutputWriter(queue_depth=1)
+    done = []
+    for i in range(20):
+        writer.submit(done.append, i)
+    writer.close()
+
+    assert done == range(20)
+
+
+def test_writer_error():
+    def fail():
+        raise ValueError('no')
+
+    writer = OutputWriter()
+    writer.submit(fail)
+    with pytest.raises(ValueError):
+        writer.flush()
+
+    # the error is only raised once
+    writer.close()
+
+
+def test_background_output(model):
+    """
+    the outputters write the same steps and data on the writer as in step
+    """
+    o_put = RecordingOutputter()
+    live = LiveOutputter()
+    model.outputters += [o_put, live]
+
+    model.output_queue_depth = 0
+    in_step = model.full_run()
+    written = list(o_put.written)
+    assert o_put.threads == set([threading.current_thread().name])
+
+    for o in (o_put, live):
+        del o.written[:]
+        o.threads.clear()
+
+    model.output_queue_depth = 2
+    in_background = model.full_run()
+
+    assert o_put.written == written
+    assert o_put.threads == set(['gnome output writer'])
+    assert live.written == written
+    assert live.threads == set([threading.current_thread().name])
+
+    assert model._output_writer is None
+    assert in_background == in_step
+    assert sorted(model.background_output) == range(model.num_time_steps)
+
+    model.outputters.clear()
+
+
+def test_background_error(model):
+    model.outputters += FailingOutputter()
+    model.output_queue_depth = 1
+
+    with pytest.raises(IOError):
+        model.full_run()
+
+    model.rewind()
+    assert model._output_writer is None
+
+    model.outputters.clear()
@@ -3,6 +3,9 @@ tests for kmz outputter
 '''
 
 import os
+import struct
+import zipfile
+from glob import glob
 from datetime import datetime, timedelta
 
 import pytest
@@ -127,6 +130,43 @@ def test_timesteps(model):
     model.full_run()
 
 
+def test_shapefile_in_zip(model, output_filename):
+    '''
+    the records of all the steps are written with the headers that count
+    them, and nothing else is left beside the zips
+    '''
+    shp = ShapeOutput(output_filename)
+    model.outputters += shp
+    model.full_run()
 
-
-
+    basename = os.path.split(output_filename)[-1]
+    num_elements = model.spills.items()[0].num_released
+
+    with zipfile.ZipFile(output_filename + '.zip') as zipf:
+        assert zipf.testzip() is None
+        assert (sorted(zipf.namelist()) ==
+                sorted(basename + suf for suf in ('.shp', '.shx', '.dbf',
+                                                  '.prj')))
+        shp_data = zipf.read(basename + '.shp')
+        shx_data = zipf.read(basename + '.shx')
+        dbf_data = zipf.read(basename + '.dbf')
+
+    num_records = (len(shp_data) - 100) / 28
+    assert num_records == num_elements * model.num_time_steps
+
+    # the file lengths in the headers are in 16 bit words
+    assert struct.unpack('>i', shp_data[24:28])[0] * 2 == len(shp_data)
+    assert struct.unpack('>i', shx_data[24:28])[0] * 2 == len(shx_data)
+    assert len(shx_data) == 100 + 8 * num_records
+
+    # the last record is where the index has it
+    offset = struct.unpack('>i', shx_data[-8:-4])[0] * 2
+    assert offset == len(shp_data) - 28
+    assert struct.unpack('>i', shp_data[offset:offset + 4])[0] == num_records
+
+    count, header_size, record_size = struct.unpack('<IHH', dbf_data[4:12])
+    assert count == num_records
+    assert len(dbf_data) == header_size + count * record_size + 1
+
+    assert (sorted(glob(output_filename + '*')) ==
+            [output_filename + '.zip', output_filename + '_uncert.zip'])
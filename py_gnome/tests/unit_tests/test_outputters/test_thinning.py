@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+"""
+tests for the output thinning
+"""
+from datetime import datetime, timedelta
+
+import numpy as np
+import pytest
+
+from gnome.basic_types import oil_status
+from gnome.outputters import TrajectoryGeoJsonOutput
+from gnome.outputters.thinning import OutputThinning, ThinnedElements
+from gnome.outputters.streaming import decode_typed_array
+
+start_time = datetime(2016, 1, 1)
+
+
+class FakeSpillContainer(dict):
+    uncertain = False
+    mass_balance = {'evaporated': 1.}
+
+    def __init__(self, time_stamp, positions, status_codes=None):
+        num = len(positions)
+        if status_codes is None:
+            status_codes = [oil_status.in_water] * num
+
+        super(FakeSpillContainer, self).__init__(
+            id=np.arange(num, dtype=np.uint32),
+            positions=np.asarray(positions, dtype=np.float64),
+            status_codes=np.asarray(status_codes, dtype=np.int16),
+            mass=np.ones(num),
+            spill_num=np.zeros(num, dtype=np.uint16))
+        self.current_time_stamp = time_stamp
+
+
+class FakeCache(object):
+    'the steps of a list of spill containers'
+    def __init__(self, steps):
+        self.steps = steps
+
+    def load_timestep(self, step_num):
+        return self
+
+    def items(self):
+        return [self.steps.pop(0)]
+
+
+def line(num, lon=-120.):
+    positions = np.zeros((num, 3))
+    positions[:, 0] = lon
+    positions[:, 1] = np.linspace(45., 46., num)
+
+    return positions
+
+
+def test_init_exceptions():
+    with pytest.raises(ValueError):
+        OutputThinning(every=0)
+
+    with pytest.raises(ValueError):
+        OutputThinning(min_move=-1.)
+
+
+def test_all_written():
+    sc = FakeSpillContainer(start_time, line(10))
+    assert OutputThinning().thin(sc, {}) is sc
+
+
+def test_every():
+    sc = FakeSpillContainer(start_time, line(10))
+    thinned = OutputThinning(every=3).thin(sc, {})
+
+    assert isinstance(thinned, ThinnedElements)
+    assert len(thinned) == 4
+    assert thinned['id'].tolist() == [0, 3, 6, 9]
+    assert np.all(thinned['positions'] == sc['positions'][::3])
+
+    # the rest is the spill container's
+    assert thinned.current_time_stamp == start_time
+    assert thinned.mass_balance is sc.mass_balance
+
+
+def test_min_move():
+    thinning = OutputThinning(min_move=100.)
+    state = {}
+
+    positions = line(4)
+    assert thinning.thin(FakeSpillContainer(start_time, positions),
+                         state)['id'].tolist() == [0, 1, 2, 3]
+
+    # 0 moves ~110 m north, 1 ~10 m, 3 is beached where it was
+    positions[0, 1] += 0.001
+    positions[1, 1] += 0.0001
+    status = [oil_status.in_water] * 3 + [oil_status.on_land]
+    sc = FakeSpillContainer(start_time + timedelta(hours=1), positions,
+                            status)
+    assert thinning.thin(sc, state)['id'].tolist() == [0, 3]
+
+    # 1 has moved enough from where it was last written
+    positions[1, 1] += 0.001
+    sc = FakeSpillContainer(start_time + timedelta(hours=2), positions,
+                            status)
+    assert thinning.thin(sc, state)['id'].tolist() == [1]
+
+    # another outputter's run writes them all again
+    sc = FakeSpillContainer(start_time, positions, status)
+    assert thinning.thin(sc, {}) is sc
+
+
+def test_regions():
+    region = [(-121., 45.45), (-119., 45.45), (-119., 45.55), (-121., 45.55)]
+    sc = FakeSpillContainer(start_time, line(11))
+
+    thinned = OutputThinning(every=0, regions=[region]).thin(sc, {})
+    assert thinned['id'].tolist() == [5]
+
+    thinned = OutputThinning(every=5, regions=[region]).thin(sc, {})
+    assert thinned['id'].tolist() == [0, 5, 10]
+
+
+def test_full_resolution_time():
+    thinning = OutputThinning(every=2,
+                              full_resolution_time=timedelta(hours=2))
+    state = {}
+
+    for hours, num in ((0, 6), (1, 6), (2, 3), (3, 3)):
+        sc = FakeSpillContainer(start_time + timedelta(hours=hours), line(6))
+        assert len(thinning.thin(sc, state)) == num
+
+
+def test_geojson_binary():
+    '''
+    the outputter writes the elements its thinning picks
+    '''
+    steps = [FakeSpillContainer(start_time + timedelta(hours=h), line(10))
+             for h in range(2)]
+    o_put = TrajectoryGeoJsonOutput(output_format='binary',
+                                    thinning=OutputThinning(every=4),
+                                    cache=FakeCache(steps))
+
+    o_put.prepare_for_model_run(model_start_time=start_time)
+    for step_num in range(2):
+        output = o_put.write_output(step_num)
+
+        assert output['certain']['num_elements'] == 3
+        coords = decode_typed_array(output['certain']['coordinates'])
+        assert np.allclose(coords.reshape(-1, 2),
+                           line(10)[::4, :2], atol=1e-3)
@@ -0,0 +1,160 @@
+'''
+tests checkpoints of a model run: a run picked up from a checkpoint goes
+on as the checkpointed run did
+'''
+import os
+from datetime import datetime, timedelta
+
+import pytest
+from pytest import raises
+
+import numpy as np
+
+from gnome.model import Model
+from gnome.utilities.cache import ElementCache
+from gnome.environment import constant_wind
+from gnome.spill import point_line_release_spill
+from gnome.movers import SimpleMover, RandomMover, WindMover
+from gnome.persist.checkpoint import plain_state, is_plain
+
+start_time = datetime(2012, 9, 15, 12, 0)
+
+
+def make_model(uncertain=False, cache_store='npz'):
+    model = Model(start_time=start_time, duration=timedelta(hours=6),
+                  time_step=900, uncertain=uncertain)
+    model._cache = ElementCache(store=cache_store)
+
+    model.spills += point_line_release_spill(num_elements=100,
+                                             start_position=(1., 2., 0.),
+                                             release_time=start_time,
+                                             end_position=(2., 3., 0.),
+                                             end_release_time=start_time +
+                                             timedelta(hours=2))
+    model.movers += SimpleMover(velocity=(1., -1., 0.))
+    model.movers += RandomMover(diffusion_coef=100000)
+    model.movers += WindMover(constant_wind(5., 270., 'knots'))
+
+    return model
+
+
+def positions(model):
+    return [(sc['positions'].copy(), sc['status_codes'].copy())
+            for sc in model.spills.items()]
+
+
+@pytest.mark.parametrize('cache_store', ['npz', 'columnar'])
+def test_restart(tmpdir, cache_store):
+    filename = str(tmpdir.join('run.checkpoint'))
+
+    model = make_model(cache_store=cache_store)
+    for _i in range(10):
+        model.step()
+    checkpointed = positions(model)
+    model.save_checkpoint(filename)
+
+    model.full_run()
+    expected = positions(model)
+
+    restarted = make_model(cache_store=cache_store)
+    restarted.restore_checkpoint(filename)
+
+    assert restarted.current_time_step == 9
+    assert restarted.model_time == start_time + timedelta(seconds=9 * 900)
+    for (pos, status), (c_pos, c_status) in zip(positions(restarted),
+                                                checkpointed):
+        assert np.array_equal(pos, c_pos)
+        assert np.array_equal(status, c_status)
+
+    # the steps before the checkpoint are in the cache
+    sc = restarted._cache.load_timestep(5).items()[0]
+    assert len(sc['positions']) > 0
+
+    restarted.full_run()
+    assert restarted.current_time_step == model.current_time_step
+
+    for (pos, status), (e_pos, e_status) in zip(positions(restarted),
+                                                expected):
+        assert np.array_equal(pos, e_pos)
+        assert np.array_equal(status, e_status)
+
+
+def test_restart_uncertain(tmpdir):
+    '''
+    the uncertain spills are picked up too -- their uncertainty is drawn
+    with rand(), so they are only checked at the checkpoint
+    '''
+    filename = str(tmpdir.join('run.checkpoint'))
+
+    model = make_model(uncertain=True)
+    for _i in range(6):
+        model.step()
+    model.save_checkpoint(filename)
+
+    restarted = make_model(uncertain=True)
+    restarted.restore_checkpoint(filename)
+
+    assert len(restarted.spills.items()) == 2
+    for (pos, status), (e_pos, e_status) in zip(positions(restarted),
+                                                positions(model)):
+        assert np.array_equal(pos, e_pos)
+        assert np.array_equal(status, e_status)
+
+    restarted.full_run()
+
+
+def test_checkpoint_interval(tmpdir):
+    filename = str(tmpdir.join('run.checkpoint'))
+
+    model = make_model()
+    model.checkpoint_file = filename
+    model.checkpoint_interval = 4
+
+    for _i in range(4):
+        model.step()
+    assert not os.path.exists(filename)
+
+    model.step()
+    assert os.path.exists(filename)
+    assert not os.path.exists(filename + '.tmp')
+
+    restarted = make_model()
+    restarted.restore_checkpoint(filename)
+    assert restarted.current_time_step == 4
+
+
+def test_not_stepped(tmpdir):
+    with raises(ValueError):
+        make_model().save_checkpoint(str(tmpdir.join('run.checkpoint')))
+
+
+def test_other_model(tmpdir):
+    filename = str(tmpdir.join('run.checkpoint'))
+
+    model = make_model()
+    model.step()
+    model.save_checkpoint(filename)
+
+    other = make_model()
+    del other.movers[other.movers[-1].id]
+
+    with raises(ValueError):
+        other.restore_checkpoint(filename)
+
+
+def test_plain_state():
+    class Obj(object):
+        pass
+
+    obj = Obj()
+    obj.id = 'its id'
+    obj.count = 3
+    obj.times = [start_time, timedelta(hours=1)]
+    obj.values = {'a': np.arange(3), 'b': (1.5, None)}
+    obj.other = Obj()
+    obj.objects = [Obj()]
+    obj.object_array = np.array([Obj()], dtype=object)
+
+    assert sorted(plain_state(obj)) == ['count', 'times', 'values']
+    assert is_plain(np.float32(2))
+    assert not is_plain({'a': Obj()})
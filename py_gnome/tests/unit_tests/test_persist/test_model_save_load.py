@@ -8,6 +8,7 @@ import os
 import shutil
 from datetime import datetime, timedelta
 import json
+from zipfile import ZipFile, ZIP_STORED
 
 import pytest
 from pytest import raises
@@ -18,7 +19,7 @@ from gnome.basic_types import datetime_value_2d
 from gnome.map import MapFromBNA
 from gnome.environment import Wind, Tide, Water
 from gnome.model import Model
-from gnome.persist import load
+from gnome.persist import load, is_savezip_valid
 from gnome.spill import point_line_release_spill
 from gnome.movers import RandomMover, WindMover, CatsMover, IceMover
 from gnome.weatherers import Evaporation, Skimmer, Burn
@@ -250,6 +251,35 @@ def test_save_load_midrun_no_movers(uncertain, zipsave, saveloc_):
     assert model == model2
 
 
+@pytest.mark.parametrize('uncertain', [False, True])
+def test_save_midrun_arrays_stored(uncertain, saveloc_):
+    '''
+    the data arrays of a mid-run save are entries of their own in the zip,
+    stored as they are, with their index in spills_data_arrays.json
+    '''
+    model = make_model(uncertain)
+    model.step()
+    model.save(saveloc_)
+
+    zip_file = zipname(saveloc_, model)
+    with ZipFile(zip_file, 'r') as z:
+        index = json.loads(z.read('spills_data_arrays.json'))
+        infos = dict((i.filename, i) for i in z.infolist())
+
+    assert len(index['spill_containers']) == len(model.spills.items())
+    for container, sc in zip(index['spill_containers'], model.spills.items()):
+        assert container['uncertain'] == sc.uncertain
+        assert (sorted(container['data_arrays'].keys()) ==
+                sorted(sc._data_arrays.keys()))
+
+        for name, array_json in container['data_arrays'].iteritems():
+            info = infos[array_json['file']]
+            assert info.compress_type == ZIP_STORED
+            assert info.file_size == sc[name].nbytes
+
+    assert is_savezip_valid(zip_file)
+
+
 @pytest.mark.slow
 @pytest.mark.parametrize('uncertain', [False, True])
 def test_load_midrun_ne_rewound_model(uncertain, saveloc_):
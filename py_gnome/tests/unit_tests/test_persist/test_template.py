@@ -0,0 +1,89 @@
+'''
+tests model templates: the models made from a template run as the model of
+the location file does
+'''
+import os
+from datetime import datetime, timedelta
+
+import pytest
+from pytest import raises
+
+from gnome.model import Model
+from gnome.environment import constant_wind
+from gnome.spill import point_line_release_spill
+from gnome.movers import RandomMover, WindMover
+from gnome.persist.template import (ModelTemplate, get_template,
+                                    clear_templates)
+
+start_time = datetime(2012, 9, 15, 12, 0)
+
+needs_fork = pytest.mark.skipif(not hasattr(os, 'fork'),
+                                reason='needs os.fork()')
+
+
+@pytest.fixture
+def location_file(saveloc_):
+    model = Model(start_time=start_time, duration=timedelta(hours=3),
+                  time_step=900)
+    model.spills += point_line_release_spill(num_elements=10,
+                                             start_position=(1., 2., 0.),
+                                             release_time=start_time)
+    model.movers += RandomMover(diffusion_coef=100000)
+    model.movers += WindMover(constant_wind(5., 270., 'knots'))
+    model.save(saveloc_)
+
+    return os.path.join(saveloc_, model.name + '.zip'), model
+
+
+def test_new_model(location_file):
+    filename, model = location_file
+    template = ModelTemplate(filename)
+
+    model2 = template.new_model()
+    assert model2 is not template.model
+    assert model2 == model
+
+    # warming it up left the template's model rewound
+    assert template.model.current_time_step == -1
+    assert template.model == model
+
+    template.close()
+
+
+@needs_fork
+def test_run_forked(location_file):
+    filename, model = location_file
+    template = ModelTemplate(filename)
+
+    num_steps = template.run_forked(lambda m: len([step for step in m]))
+    assert num_steps == model.num_time_steps
+
+    # the run was in the child
+    assert template.model.current_time_step == -1
+
+    template.close()
+
+
+@needs_fork
+def test_run_forked_raises(location_file):
+    template = ModelTemplate(location_file[0])
+
+    def fails(model, msg):
+        raise ValueError(msg)
+
+    with raises(ValueError):
+        template.run_forked(fails, 'from the child')
+
+    template.close()
+
+
+def test_get_template(location_file):
+    filename = location_file[0]
+
+    template = get_template(filename)
+    assert get_template(filename) is template
+
+    clear_templates()
+    assert get_template(filename) is not template
+
+    clear_templates()
@@ -5,6 +5,8 @@ import os
 from datetime import datetime
 from zipfile import ZipFile, ZIP_DEFLATED
 
+import numpy as np
+
 from gnome.utilities.time_utils import sec_to_date
 from gnome.persist import (References, load,
                            class_from_objtype, is_savezip_valid)
@@ -207,6 +209,61 @@ def test_save_load_grids(saveloc_, obj):
     # ==========================================================================
 
 
+@pytest.mark.parametrize("obj", l_movers2)
+def test_lazy_load_grids(saveloc_, obj):
+    '''
+    a lazy load doesn't read the mover's forcing until the mover is used,
+    and gives the same mover
+    '''
+    refs = obj.save(saveloc_)
+    obj2 = load(os.path.join(saveloc_, refs.reference(obj)), lazy=True)
+
+    assert not obj2.forcing_loaded
+    assert obj == obj2
+    assert obj2.forcing_loaded
+
+
+@pytest.mark.parametrize("zipsave", [False, True])
+def test_write_read_array(saveloc_, zipsave):
+    '''
+    arrays written by write_array() are read back by read_array(), from a
+    directory or a zipfile written to in open_savezip()
+    '''
+    arrays = {'positions': np.arange(12.).reshape(4, 3),
+              'status_codes': np.array([2, 3, 2], dtype=np.int16),
+              'records': np.zeros((3,), dtype=[('a', '<f8'),
+                                               ('b', '<i4', (2,))]),
+              'empty': np.zeros((0, 3)),
+              # not contiguous
+              'positions_lat': np.arange(12.).reshape(4, 3)[:, 1]}
+
+    saveloc = saveloc_
+    if zipsave:
+        saveloc = os.path.join(saveloc_, 'arrays.zip')
+        ZipFile(saveloc, 'w').close()
+
+        with save_load.open_savezip(saveloc) as z:
+            written = dict((name, save_load.write_array(saveloc, name, a))
+                           for name, a in arrays.iteritems())
+            assert save_load.is_savezip(saveloc)
+
+            # written to the one open ZipFile
+            with save_load.open_savezip(saveloc) as z2:
+                assert z2 is z
+
+        assert not save_load._open_zips
+    else:
+        written = dict((name, save_load.write_array(saveloc, name, a))
+                       for name, a in arrays.iteritems())
+
+    for name, array in arrays.iteritems():
+        array2 = save_load.read_array(saveloc, written[name])
+
+        assert array2.dtype == array.dtype
+        assert array2.shape == array.shape
+        assert np.all(array2 == array)
+
+
 class TestSaveZipIsValid:
     here = os.path.dirname(__file__)
 
@@ -0,0 +1,121 @@
+'''
+Tests of the ElementManager, the super-particles of Model.element_manager
+'''
+from datetime import datetime, timedelta
+
+import numpy as np
+
+import pytest
+
+from gnome.basic_types import oil_status
+from gnome.map import GnomeMap
+from gnome.model import Model
+from gnome.movers import SimpleMover
+from gnome.spill import ElementManager, point_line_release_spill
+
+from ..conftest import sample_sc_release
+
+release_time = datetime(2012, 1, 1, 12)
+
+
+def far_field_sc(num=100):
+    'elements in two cells of 0.01 degrees, the mass of each 1 kg'
+    sc = sample_sc_release(num, (0., 0., 0.), release_time)
+    sc['positions'][:, 0] = np.where(np.arange(num) % 2 == 0, 0.0025, 0.0125)
+    sc['positions'][:, 1] = 0.005
+    sc['mass'][:] = 1.
+
+    return sc
+
+
+def test_init():
+    with pytest.raises(ValueError):
+        ElementManager(max_mass=1., split_mass=2.)
+
+
+def test_merge():
+    'the elements of a cell are merged, the mass is conserved'
+    sc = far_field_sc()
+    total = sc['mass'].sum()
+
+    merged, split = ElementManager().manage(sc, GnomeMap())
+
+    assert (merged, split) == (98, 0)
+    assert len(sc) == 2
+    assert np.isclose(sc['mass'].sum(), total)
+    assert np.allclose(sorted(sc['positions'][:, 0]), (0.0025, 0.0125))
+    assert sc.element_counts == {'merged': 98, 'split': 0, 'elements': 2}
+
+
+def test_merge_max_mass():
+    'the super-particles are no heavier than about max_mass'
+    sc = far_field_sc()
+    total = sc['mass'].sum()
+
+    ElementManager(max_mass=10.).manage(sc, GnomeMap())
+
+    assert len(sc) == 10
+    assert np.all(sc['mass'] == 10.)
+    assert np.isclose(sc['mass'].sum(), total)
+
+
+def test_merge_alike():
+    '''
+    the elements of other spills, not in the water or too young are left
+    alone
+    '''
+    sc = far_field_sc()
+    sc['status_codes'][:10] = oil_status.on_land
+    sc['age'][10:20] = 0
+    sc['age'][20:] = 3600
+
+    ElementManager(min_age=1800).manage(sc, GnomeMap())
+
+    assert len(sc) == 22
+    assert np.all(sc['status_codes'][:10] == oil_status.on_land)
+
+
+def test_targets():
+    '''
+    near a target the elements are not merged, and the heavy ones are
+    split
+    '''
+    sc = far_field_sc()
+    sc['mass'][:2] = 5.
+    total = sc['mass'].sum()
+
+    # the second cell's elements are within 500 m of the target
+    manager = ElementManager(split_mass=1., targets=[(0.0125, 0.005, 500.)])
+    merged, split = manager.manage(sc, GnomeMap())
+
+    assert split == 4
+    assert merged == 49
+    assert len(sc) == 100 - 49 + 4
+    assert len(np.unique(sc['id'])) == len(sc)
+    assert np.isclose(sc['mass'].sum(), total)
+
+    near = sc['positions'][:, 0] > 0.01
+    assert np.all(sc['mass'][near] == 1.)
+
+
+def test_model_run():
+    '''
+    a model with an element manager has fewer elements, with the mass of
+    the ones released
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=3),
+                  time_step=900)
+    model.element_manager = ElementManager(cell_size=1., interval=2)
+    model.spills += point_line_release_spill(num_elements=100,
+                                             start_position=(1.5, 2.5, 0.),
+                                             release_time=start_time,
+                                             amount=100, units='kg')
+    model.movers += SimpleMover(velocity=(1., -1., 0.))
+
+    model.full_run()
+
+    sc = model.spills.items()[0]
+    assert len(sc) < 100
+    assert np.isclose(sc['mass'].sum(), 100.)
+    assert 'manage' in model.stage_times
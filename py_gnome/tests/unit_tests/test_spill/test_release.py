@@ -22,6 +22,7 @@ from gnome.spill import (Release,
                          InitElemsFromFile,
                          Spill)
 from gnome.spill_container import SpillContainer
+from gnome.map import GnomeMap
 from gnome.spill.release import release_from_splot_data
 
 try:
@@ -84,6 +85,29 @@ def test_grid_release():
                                                    [2.,  12.,  0.]])
 
 
+def test_grid_release_spill_map():
+    """
+    with a map, only the grid points that are allowable spill positions
+    """
+    bounds = ((0, 10), (2, 12))
+    spill_map = GnomeMap(spillable_area=[((-1, 9), (1.5, 9),
+                                          (1.5, 13), (-1, 13))])
+    release = GridRelease(datetime.now(), bounds, 3, spill_map)
+
+    assert np.array_equal(release.start_position[:, 0], [0., 1.] * 3)
+    assert len(release.positions_not_allowed(spill_map)) == 0
+    assert len(GridRelease(datetime.now(), bounds, 3)
+               .positions_not_allowed(spill_map)) == 3
+
+
+def test_release_positions():
+    rel = PointLineRelease(rel_time, (0, 0, 0), num_elements=10,
+                           end_position=(1, 1, 0))
+
+    assert np.array_equal(rel.release_positions(), [[0, 0, 0], [1, 1, 0]])
+    assert len(Release(rel_time, 10).release_positions()) == 0
+
+
 '''  todo: add other release to this test - need schemas for all '''
 
 rel_time = datetime(2012, 8, 20, 13)
@@ -26,7 +26,9 @@ from gnome.spill.elements import (ElementType,
 
 from gnome.utilities.distributions import UniformDistribution
 
-from gnome.spill_container import SpillContainer, SpillContainerPair
+from gnome.spill_container import (SpillContainer, SpillContainerPair,
+                                   FateDataView, morton_codes)
+from gnome.basic_types import fate
 from gnome.spill import point_line_release_spill, Spill, Release
 from gnome.exceptions import GnomeRuntimeError
 
@@ -1300,5 +1302,320 @@ def test_split_element():
         assert np.allclose(d_split, split)
 
 
+def test_merge_elements():
+    '''
+    the elements of each group are merged into their first one: the mass is
+    summed, the positions are the mass weighted mean and the ids the first
+    element's
+    '''
+    sc = sample_sc_release(10, start_position, release_time)
+    sc['mass'][:] = np.arange(1., 11.)
+    sc['positions'][:, 0] = np.arange(10.)
+    total = sc['mass'].sum()
+    ids = sc['id'].copy()
+
+    groups = np.full((10,), -1)
+    groups[[1, 3, 5]] = 7
+    groups[[8, 9]] = 2
+    groups[6] = 4   # a group of one is left alone
+
+    assert sc.merge_elements(groups) == 3
+    assert len(sc) == 7
+    assert all([len(sc[key]) == 7 for key in sc.array_types])
+    assert np.isclose(sc['mass'].sum(), total)
+
+    i = np.where(sc['id'] == ids[1])[0][0]
+    assert sc['mass'][i] == 2. + 4. + 6.
+    assert np.isclose(sc['positions'][i, 0],
+                      (1. * 2. + 3. * 4. + 5. * 6.) / 12.)
+    assert ids[3] not in sc['id']
+
+    i = np.where(sc['id'] == ids[8])[0][0]
+    assert sc['mass'][i] == 9. + 10.
+
+    assert sc.merge_elements(np.full((7,), -1)) == 0
+
+
+def test_split_elements():
+    '''
+    the elements split have their mass divided between the new ones, which
+    get new ids
+    '''
+    sc = sample_sc_release(10, start_position, release_time)
+    sc['mass'][:] = 2.
+    total = sc['mass'].sum()
+
+    assert sc.split_elements([0, 4], [2, 3]) == 3
+    assert all([len(sc[key]) == 13 for key in sc.array_types])
+    assert len(np.unique(sc['id'])) == 13
+    assert np.isclose(sc['mass'].sum(), total)
+    assert sc['mass'][0] == 1.
+    assert np.allclose(sc['mass'][4], 2. / 3)
+    assert np.all(sc['positions'][10:] == sc['positions'][[0, 4, 4]])
+
+    with raises(ValueError):
+        sc.split_elements([1], [1])
+
+
+def test_element_view():
+    '''
+    the element view holds aligned copies of the positions and writes the
+    moves back to next_positions
+    '''
+    sc = sample_sc_release(num_elements, start_position, release_time)
+    view = sc.element_view
+
+    view.load(sc)
+    assert view.num == sc.num_released
+    for i, name in enumerate(('lon', 'lat', 'z')):
+        arr = getattr(view, name)
+        assert arr.flags['C_CONTIGUOUS']
+        assert arr.ctypes.data % 64 == 0
+        assert np.all(arr == sc['positions'][:, i])
+        assert np.all(getattr(view, 'next_' + name) == arr)
+
+    assert np.all(view.status == sc['status_codes'])
+    assert np.all(view.active == np.arange(sc.num_released))
+    assert view.active.dtype == np.int64
+
+    view.delta_lon[:] = 1.
+    view.delta_z[:] = 2.
+    view.add_delta()
+
+    delta = np.ones_like(sc['positions'])
+    view.add_delta(delta)
+    view.store(sc)
+
+    assert np.all(sc['next_positions'] == sc['positions'] + (2., 1., 3.))
+
+    # only the elements in water are active
+    sc['status_codes'][::3] = oil_status.on_land
+    view.load(sc)
+    assert np.all(view.active == np.where(sc['status_codes'] ==
+                                          oil_status.in_water)[0])
+
+    # fewer elements reuse the arrays, more grow them
+    buf = view.lon.ctypes.data
+    view.load(sample_sc_release(10, start_position, release_time))
+    assert view.num == 10
+    assert view.lon.ctypes.data == buf
+
+    view.load(sample_sc_release(2 * num_elements, start_position,
+                                release_time))
+    assert view.num == 2 * num_elements
+    assert view.lon.ctypes.data % 64 == 0
+
+
+def test_sort_by_position():
+    '''
+    sorting permutes all the data arrays the same way, keeps the ids with
+    their elements, and the elements released after it still get new ids
+    '''
+    spill = point_line_release_spill(num_elements, start_position,
+                                     release_time,
+                                     end_release_time=(release_time +
+                                                       timedelta(hours=2)))
+    sc = sample_sc_release(spill=spill, time_step=3600)
+    num = sc.num_released
+    sc['positions'][:, 0] = np.random.uniform(-72, -71, num)
+    sc['positions'][:, 1] = np.random.uniform(41, 42, num)
+    before = dict((key, sc[key].copy()) for key in sc.array_types)
+
+    order = sc.sort_by_position()
+    assert sorted(order) == range(num)
+    for key, arr in before.iteritems():
+        assert np.all(sc[key] == arr[order])
+
+    codes = morton_codes(sc['positions'])
+    assert np.all(codes[:-1] <= codes[1:])
+
+    sc.release_elements(3600, release_time + timedelta(hours=1))
+    assert sc.num_released > num
+    assert len(np.unique(sc['id'])) == sc.num_released
+
+
+
+
+def test_release_grows_buffers():
+    '''
+    elements released step after step are appended in the arrays' buffers:
+    the arrays are views of the start of them, copied only when they grow
+    '''
+    spill = point_line_release_spill(100, start_position, release_time,
+                                     end_release_time=(release_time +
+                                                       timedelta(hours=4)))
+    sc = sample_sc_release(spill=spill, time_step=360)
+    copies = 0
+
+    for step in range(1, 50):
+        ids = sc['id'].copy()
+        positions = sc['positions'].copy()
+        buf = sc._buffers['positions']
+
+        sc.release_elements(360, release_time + timedelta(seconds=360 * step))
+
+        assert np.all(sc['id'][:len(ids)] == ids)
+        assert np.all(sc['positions'][:len(ids)] == positions)
+        assert sc['positions'].base is sc._buffers['positions']
+        if sc._buffers['positions'] is not buf:
+            copies += 1
+
+    assert sc.num_released == 100
+    assert len(np.unique(sc['id'])) == 100
+    assert copies < 5
+
+    # removing elements makes new arrays, then new buffers
+    sc['status_codes'][:10] = oil_status.to_be_removed
+    sc.model_step_is_done()
+    assert all([len(sc[key]) == 90 for key in sc.array_types])
+
+
+def test_cold_arrays():
+    '''
+    the cold arrays are in memory mapped buffers once they grow, and stay
+    in them when elements are removed, sorted and merged, with the same
+    values as the arrays in memory
+    '''
+    spill = point_line_release_spill(100, start_position, release_time,
+                                     end_release_time=(release_time +
+                                                       timedelta(hours=4)))
+    sc = sample_sc_release(spill=spill, time_step=360)
+    sc.cold_arrays = {'id', 'age'}
+
+    for step in range(1, 50):
+        sc.release_elements(360, release_time + timedelta(seconds=360 * step))
+
+    assert sc.num_released == 100
+    assert isinstance(sc._buffers['id'], np.memmap)
+    assert isinstance(sc._buffers['age'], np.memmap)
+    assert not isinstance(sc._buffers['positions'], np.memmap)
+    assert np.all(sc['id'] == np.arange(100))
+
+    sc['positions'][:, 0] = np.random.uniform(-72, -71, 100)
+    sc['positions'][:, 1] = np.random.uniform(41, 42, 100)
+    sc['status_codes'][:10] = oil_status.to_be_removed
+    sc.model_step_is_done()
+
+    assert np.all(sc['id'] == np.arange(10, 100))
+    assert sc['id'].base is sc._buffers['id']
+    assert isinstance(sc._buffers['id'], np.memmap)
+
+    ids = sc['id'].copy()
+    order = sc.sort_by_position()
+    assert np.all(sc['id'] == ids[order])
+    assert isinstance(sc._buffers['id'], np.memmap)
+
+    groups = np.full((90,), -1)
+    groups[:3] = 0
+    assert sc.merge_elements(groups) == 2
+    assert len(sc['id']) == len(sc['age']) == len(sc['positions']) == 88
+    assert isinstance(sc._buffers['age'], np.memmap)
+
+
+def test_release_spills_together():
+    """
+    spills released in the same step are appended to the arrays together;
+    each sets the data of its own elements, with windages that depend on
+    their spill and id only
+    """
+    def released_sc():
+        sc = SpillContainer()
+        sc.spills.add([point_line_release_spill(num_elements, start_position,
+                                                release_time),
+                       point_line_release_spill(num_elements / 2,
+                                                start_position,
+                                                release_time)])
+        sc.prepare_for_model_run(windage_at)
+        sc.release_elements(3600, release_time)
+
+        return sc
+
+    sc = released_sc()
+
+    assert sc.num_released == num_elements + num_elements / 2
+    assert np.all(sc['id'] == range(sc.num_released))
+    assert np.all(sc['spill_num'][:num_elements] == 0)
+    assert np.all(sc['spill_num'][num_elements:] == 1)
+    assert np.all((sc['windages'] >= sc['windage_range'][:, 0]) &
+                  (sc['windages'] <= sc['windage_range'][:, 1]))
+
+    # a second container makes the same windages
+    assert np.all(released_sc()['windages'] == sc['windages'])
+
+
+def test_fate_data_view():
+    '''
+    the data of a run of LEs are views of the SC's arrays, updated in place;
+    scattered LEs are copied and written back, and the view is reset when
+    LEs change fate
+    '''
+    sc = sample_sc_release(num_elements=10)
+    sc['mass'] = np.ones((10,), dtype=np.float64)
+    sc['fate_status'] = np.ones((10,), dtype=np.uint8) * fate.non_weather
+    sc['fate_status'][2:6] = fate.surface_weather
+
+    view = FateDataView(0)
+    data = view.get_data(sc, {'mass'})
+    assert np.all(data['id'] == sc['id'][2:6])
+    assert np.may_share_memory(data['mass'], sc['mass'])
+
+    data['mass'] *= 0.5
+    view.update_sc(sc)
+    assert np.all(sc['mass'][2:6] == 0.5)
+    assert view.get_data(sc, {'mass'}) is data
+
+    # scattered LEs
+    sc['fate_status'][8] = fate.surface_weather
+    view.reset()
+    data = view.get_data(sc, {'mass', 'fate_status'})
+    assert np.all(data['id'] == sc['id'][[2, 3, 4, 5, 8]])
+    assert not np.may_share_memory(data['mass'], sc['mass'])
+
+    data['mass'][:] = 0.25
+    data['fate_status'][0] = fate.skim
+    view.update_sc(sc)
+    assert np.all(sc['mass'][[2, 3, 4, 5, 8]] == 0.25)
+    assert sc['fate_status'][2] == fate.skim
+
+    # LE 2 left the surface
+    data = view.get_data(sc, {'mass'})
+    assert np.all(data['id'] == sc['id'][[3, 4, 5, 8]])
+
+
+def test_extract_add_elements():
+    '''
+    release_spills keeps the other spills from releasing, the elements
+    extract_elements() takes out go back in with add_elements(), and their
+    ids aren't given again
+    '''
+    sc = SpillContainer()
+    sc.spills += [point_line_release_spill(10, start_position, release_time),
+                  point_line_release_spill(10, end_position, release_time)]
+    sc.prepare_for_model_run(windage_at)
+
+    sc.release_spills = {0}
+    sc.release_elements(360, release_time)
+    assert len(sc) == 10
+    assert np.all(sc['spill_num'] == 0)
+
+    arrays = sc.extract_elements(np.arange(5, 10))
+    assert np.all(sc['id'] == np.arange(5))
+    assert np.all(arrays['id'] == np.arange(5, 10))
+    assert set(arrays) == set(sc.array_types)
+
+    sc.release_spills = {1}
+    sc.release_elements(360, release_time)
+    assert np.all(sc['id'][5:] == np.arange(10, 20))
+    assert np.all(sc['spill_num'][5:] == 1)
+
+    sc.add_elements(arrays)
+    assert len(sc) == 20
+    assert np.all(sc['id'][15:] == np.arange(5, 10))
+    assert np.all(sc['positions'][15:] == arrays['positions'])
+
+    with raises(ValueError):
+        sc.add_elements({'id': arrays['id']})
+
+
 if __name__ == '__main__':
     test_rewind()
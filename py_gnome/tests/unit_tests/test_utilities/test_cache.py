@@ -359,6 +359,120 @@ def test_rewind():
     c.save_timestep(0, scp)
 
 
+@pytest.mark.parametrize('store', ['columnar', 'memory'])
+def test_write_and_read_back_store(store):
+    """
+    the other stores read back what the npz files do
+    """
+    c = cache.ElementCache(store=store)
+
+    sc = sample_sc_release(num_elements=10, start_pos=(3.14, 2.72, 1.2))
+    u_sc = sample_sc_release(num_elements=10, start_pos=(4.14, 3.72, 2.2),
+                             uncertain=True)
+    scp = SpillContainerPairData(sc, u_sc)
+
+    saved = []
+    for step in range(3):
+        sc.current_time_stamp = dt + tdelta * step
+        sc.mass_balance = {'floating': 10.0 - step, 'evaporated': 1.0 * step}
+        c.save_timestep(step, scp)
+        saved.append((sc['positions'].copy(), u_sc['positions'].copy()))
+
+        sc['positions'] += 1.1
+        u_sc['positions'] *= 1.1
+
+    for step in (2, 0, 1):
+        scp_n = c.load_timestep(step)
+        assert np.array_equal(scp_n._spill_container['positions'],
+                              saved[step][0])
+        assert np.array_equal(scp_n._u_spill_container['positions'],
+                              saved[step][1])
+        assert scp_n._spill_container.current_time_stamp == dt + tdelta * step
+        assert scp_n._spill_container.mass_balance == \
+            {'floating': 10.0 - step, 'evaporated': 1.0 * step}
+
+
+def test_columnar_files():
+    """
+    the columnar store has a file per array, not per step
+    """
+    c = cache.ElementCache(store='columnar')
+
+    sc = sample_sc_release(num_elements=10, start_pos=(3.14, 2.72, 1.2))
+    scp = SpillContainerPairData(sc)
+
+    c.save_timestep(0, scp)
+    files = sorted(os.listdir(c._cache_dir))
+    assert files
+
+    for step in range(1, 20):
+        sc['positions'] += 1.1
+        c.save_timestep(step, scp)
+    assert sorted(os.listdir(c._cache_dir)) == files
+
+    # the steps are read back from the files, not the recent one
+    assert np.array_equal(c.load_timestep(19)._spill_container['positions'],
+                          sc['positions'])
+    c.recent.clear()
+    assert np.array_equal(c.load_timestep(19)._spill_container['positions'],
+                          sc['positions'])
+    assert np.allclose(c.load_timestep(3)._spill_container['positions'],
+                       c.load_timestep(4)._spill_container['positions'] - 1.1)
+
+    d = c._cache_dir
+    del c
+    assert not os.path.isdir(d)
+
+
+def test_columnar_rewind():
+    c = cache.ElementCache(store='columnar')
+
+    sc = sample_sc_release(num_elements=10, start_pos=(3.14, 2.72, 1.2))
+    scp = SpillContainerPairData(sc)
+
+    c.save_timestep(0, scp)
+    c.save_timestep(1, scp)
+    c.rewind()
+
+    with pytest.raises(cache.CacheError):
+        c.load_timestep(0)
+    with pytest.raises(cache.CacheError):
+        c.load_timestep(1)
+
+    # and it works again
+    sc['positions'] += 1.1
+    c.save_timestep(0, scp)
+    c.save_timestep(1, scp)
+    c.recent.clear()
+    assert np.array_equal(c.load_timestep(0)._spill_container['positions'],
+                          sc['positions'])
+
+
+def test_memory_ring():
+    """
+    the memory store keeps only the last ring_size steps
+    """
+    c = cache.ElementCache(store='memory', ring_size=2)
+
+    sc = sample_sc_release(num_elements=10, start_pos=(3.14, 2.72, 1.2))
+    scp = SpillContainerPairData(sc)
+
+    for step in range(3):
+        c.save_timestep(step, scp)
+
+    with pytest.raises(cache.CacheError):
+        c.load_timestep(0)
+    c.load_timestep(1)
+    c.load_timestep(2)
+
+    assert os.listdir(c._cache_dir) == []
+
+
+def test_bad_store():
+    with pytest.raises(ValueError):
+        cache.ElementCache(store='zip')
+
+
 #    assert False
 
 if __name__ == '__main__':
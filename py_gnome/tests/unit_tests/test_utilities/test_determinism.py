@@ -0,0 +1,96 @@
+'''
+tests of the determinism checks of the parallel and vectorized runs
+'''
+from datetime import datetime, timedelta
+
+import numpy as np
+
+from gnome.model import Model
+from gnome.environment import Water, constant_wind
+from gnome.spill import point_line_release_spill
+from gnome.movers import RandomMover, CatsMover, constant_wind_mover
+from gnome.weatherers import Evaporation, HalfLifeWeatherer
+from gnome.utilities import determinism
+
+from ..conftest import testdata, test_oil
+
+
+def test_ulp_distance():
+    a = np.array([1., 0., -0., 1., np.nan, np.nan, -1e-300])
+    b = np.array([1., -0., 0., np.nextafter(1., 2.), np.nan, 1., 1e-300])
+
+    dist = determinism.ulp_distance(a, b)
+
+    assert list(dist[:5]) == [0., 0., 0., 1., 0.]
+    assert dist[5] == np.inf
+    # across 0
+    assert dist[6] > 1e18
+
+
+def test_compare_snapshots():
+    ref = [{'positions': np.zeros((4, 3)),
+            'status_codes': np.ones((4,), dtype=np.int16)}]
+    other = [{'positions': np.zeros((4, 3)),
+              'status_codes': np.ones((4,), dtype=np.int16)}]
+
+    assert determinism.compare_snapshots('same', 0, ref, other) == []
+
+    other[0]['positions'][1:3, 0] = np.nextafter(0., 1.)
+    other[0]['status_codes'][3] = 2
+
+    divergences = determinism.compare_snapshots('off', 5, ref, other)
+    assert [(d.step, d.name, d.num_off) for d in divergences] == \
+        [(5, 'positions', 2), (5, 'status_codes', 1)]
+    assert divergences[0].max_ulps == 1.
+
+    # within the ulps the configuration declares
+    assert [d.name for d in
+            determinism.compare_snapshots('off', 5, ref, other, ulps=1)] == \
+        ['status_codes']
+
+
+def test_compare_runs_steps():
+    step = [{'mass': np.ones((2,))}]
+
+    divergences = determinism.compare_runs('short', [step, step], [step])
+
+    assert [(d.step, d.name) for d in divergences] == [(1, 'steps')]
+    assert 'ends after step 1' in determinism.format_report(divergences)
+
+
+def make_model():
+    '''
+    currents, diffusion, a wind and two oils weathering, uncertain
+    '''
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=4),
+                  time_step=900, uncertain=True)
+
+    for substance in (test_oil, 'ARABIAN MEDIUM, EXXON'):
+        model.spills += point_line_release_spill(num_elements=100,
+                                                 start_position=(-72.419992,
+                                                                 41.202120,
+                                                                 0.),
+                                                 release_time=start_time,
+                                                 substance=substance,
+                                                 amount=1000, units='kg')
+
+    model.movers += CatsMover(testdata['CatsMover']['curr'])
+    model.movers += RandomMover(diffusion_coef=100000)
+    model.movers += constant_wind_mover(5., 45., units='m/s')
+
+    model.environment += [Water(), constant_wind(5., 45.)]
+    model.weatherers += [Evaporation(), HalfLifeWeatherer()]
+    model.set_make_default_refs(True)
+
+    return model
+
+
+def test_check_determinism():
+    '''
+    the serial, scalar, fused, threaded and concurrent runs are the same
+    bit for bit
+    '''
+    divergences = determinism.check_determinism(make_model)
+
+    assert divergences == [], determinism.format_report(divergences)
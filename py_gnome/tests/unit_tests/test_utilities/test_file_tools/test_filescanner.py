@@ -5,10 +5,15 @@ Tests for the filescanner module
 
 Designed to be run with py.test
 """
+import io
+import mmap
+
 import pytest
 import numpy as np
 
-from gnome.utilities.file_tools.filescanner import scan
+from gnome.utilities.file_tools.filescanner import (scan, scan_buffer,
+                                                   scan_bna)
+from gnome.utilities.file_tools.haz_files import ReadBNAHeader
 
 # write a test file with various separators.
 tiny_file = "junk_tiny.txt"
@@ -113,6 +118,124 @@ def test_big():
     assert np.array_equal( result, np.zeros((N,), dtype=np.float64)+3.1459 )
 
 
+def test_scan_io_file():
+    """
+    io module files have no FILE*, so they are scanned through the buffer
+    """
+    f = io.open(tiny_file, 'r')
+    result = scan(f, 8)
+    assert np.array_equal(result, tiny_arr[:8])
+    assert f.readline().strip() == "some random text"
+
+
+def test_scan_io_file_wrong_mode():
+    f = io.open('junk.txt', 'w')
+    with pytest.raises(TypeError):
+        scan(f, 10)
+
+
+def test_scan_buffer():
+    result, end = scan_buffer(open(tiny_file, 'rb').read())
+    assert np.array_equal(result, tiny_arr)
+
+
+def test_scan_buffer_end():
+    text = open(tiny_file, 'rb').read()
+    result, end = scan_buffer(text, 8)
+    assert np.array_equal(result, tiny_arr[:8])
+    assert text[end:].startswith(b"some random text")
+
+    # and going on from there
+    result, end = scan_buffer(text, offset=end)
+    assert np.array_equal(result, tiny_arr[8:])
+    assert end == len(text)
+
+
+def test_scan_buffer_not_enough():
+    with pytest.raises(ValueError):
+        scan_buffer(open(tiny_file, 'rb').read(), 15)
+
+
+def test_scan_buffer_out():
+    out = np.zeros((10,), dtype=np.float64)
+    result, end = scan_buffer(open(tiny_file, 'rb').read(), out=out)
+    assert np.array_equal(out, tiny_arr[:10])
+    assert np.array_equal(result, out)
+
+
+def test_scan_buffer_out_wrong_type():
+    with pytest.raises(ValueError):
+        scan_buffer(b"1 2 3", out=np.zeros((3,), dtype=np.float32))
+
+
+def test_scan_buffer_mmap():
+    with open(tiny_file, 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    result, end = scan_buffer(buf)
+    assert np.array_equal(result, tiny_arr)
+
+
+def test_scan_buffer_like_fscanf():
+    """
+    scan_buffer reads what fscanf reads, including the odd bits
+    """
+    text = b"1e5 -x 3.e+, inf infx nan in 5 1e .5 +-2 7"
+    with open('junk_odd.txt', 'wb') as f:
+        f.write(text)
+
+    expected = scan(open('junk_odd.txt'))
+    result, end = scan_buffer(text)
+    np.testing.assert_array_equal(result, expected)
+
+
+@pytest.mark.parametrize("num_threads", [2, 3, 8])
+def test_scan_buffer_threads(num_threads):
+    """
+    the chunks scanned at once give what one thread reads
+    """
+    N = 20000
+    text = b"".join(b"%d.%d, %de-2\n" % (i, i % 7, i) for i in range(N))
+    expected, expected_end = scan_buffer(text)
+
+    result, end = scan_buffer(text, num_threads=num_threads)
+    assert np.array_equal(result, expected)
+    assert end == expected_end
+    assert len(result) == 2 * N
+
+    result, end = scan_buffer(text, 1001, num_threads=num_threads)
+    assert np.array_equal(result, expected[:1001])
+    assert end == scan_buffer(text, 1001)[1]
+
+
+def test_scan_bna():
+    """
+    the polygons of a BNA text with blank lines and \\r\\n line ends
+    """
+    text = (b'"one","1", 4\r\n1.0,2.0\r\n3.0,4.0\r\n5.0,6.0\r\n1.0,2.0\r\n'
+            b'\r\n'
+            b'"two","2", -2\n7.5,8.5\n9.5,10.5\n')
+    points, starts, metadata = scan_bna(text, ReadBNAHeader)
+
+    # the last point of the polygon is the same as its first: left out
+    assert np.array_equal(points, [(1., 2.), (3., 4.), (5., 6.),
+                                   (7.5, 8.5), (9.5, 10.5)])
+    assert list(starts) == [0, 3, 5]
+    assert metadata == [('polygon', 'one', '1'), ('polyline', 'two', '2')]
+
+
+def test_scan_bna_empty():
+    points, starts, metadata = scan_bna(b'', ReadBNAHeader)
+
+    assert points.shape == (0, 2)
+    assert list(starts) == [0]
+    assert metadata == []
+
+
+def test_scan_bna_not_enough():
+    with pytest.raises(ValueError):
+        scan_bna(b'"one","1", 3\n1.0,2.0\n3.0,4.0\n', ReadBNAHeader)
+
+
 if __name__ == "__main__":
     test_call()
     # test_assert_not_int()
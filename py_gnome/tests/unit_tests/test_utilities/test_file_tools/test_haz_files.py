@@ -185,3 +185,31 @@ def test_without_filescanner():
     assert  polys[1].metadata[2] == '6'
 
 
+def test_filescanner_same_polygons():
+    """
+    the polygons read in one pass by scan_bna are the ones read one at a
+    time
+    """
+    if not haz_files.FILESCANNER:
+        return
+
+    fast = haz_files.ReadBNA(test_bna, 'PolygonSet')
+    fast_list = haz_files.ReadBNA(test_bna, 'list')
+
+    state = haz_files.FILESCANNER
+    haz_files.FILESCANNER = False
+    slow = haz_files.ReadBNA(test_bna, 'PolygonSet')
+    slow_list = haz_files.ReadBNA(test_bna, 'list')
+    haz_files.FILESCANNER = state
+
+    assert len(fast) == len(slow) == 6
+    for f, s in zip(fast, slow):
+        assert np.array_equal(f, s)
+        assert tuple(f.metadata) == tuple(s.metadata)
+
+    assert len(fast_list) == len(slow_list)
+    for f, s in zip(fast_list, slow_list):
+        assert np.array_equal(f[0], s[0])
+        assert f[1:] == s[1:]
+
+
@@ -7,6 +7,9 @@ Designed to be run with py.test
 
 """
 
+import os
+import pickle
+
 import pytest
 
 import numpy as np
@@ -14,7 +17,8 @@ import numpy as np
 ## the Cython version:
 
 from gnome.utilities.geometry.cy_point_in_polygon import point_in_poly, \
-    points_in_poly
+    points_in_poly, PolygonIndex
+from gnome.utilities.file_tools.haz_files import ReadBNA
 
 poly1_ccw = np.array((
     (-5, -2),
@@ -291,3 +295,74 @@ def test_points_in_poly_array():
     assert np.array_equal(points_in_poly(poly1, points), result)
 
 
+## test the polygon edge index against testing each polygon:
+
+def locate_each(polys, points):
+    """
+    the last polygon each point is in, with points_in_poly
+    """
+    located = np.zeros((len(points),), dtype=np.intc) - 1
+    for k, poly in enumerate(polys):
+        located[points_in_poly(np.ascontiguousarray(poly), points)] = k
+
+    return located
+
+
+def test_index_shared_boundary():
+    index = PolygonIndex([poly1_ccw, poly2_cw])
+    points = np.array([p[0] + (0., ) for p in points_in_poly1 +
+                       points_in_poly2] +
+                      [tuple(v) + (0., ) for v in poly1_ccw] +
+                      [(-3.0, 2.0, 0.), (5.0, 2.0, 0.), (-1.0, -1.0, 0.),
+                       (100., 100., 0.)])
+
+    assert np.array_equal(index.locate(points),
+                          locate_each([poly1_ccw, poly2_cw], points))
+    assert index.num_polygons == 2
+
+
+def test_index_scalar():
+    index = PolygonIndex([poly1])
+
+    assert index.contains((0.5, 0.5, 0.0)) is True
+    assert index.contains((1.5, 0.5)) is False
+    assert index.locate((0.5, 0.5)) == 0
+
+
+def test_index_empty():
+    index = PolygonIndex([])
+
+    assert not index.contains(np.zeros((3, 3))).any()
+
+
+@pytest.mark.parametrize('cells', (None, 1, 7, 200))
+def test_index_bna(cells):
+    filename = os.path.join(os.path.split(__file__)[0],
+                            '00439polys_013685pts.bna')
+    polys = ReadBNA(filename, polytype='PolygonSet')
+    index = PolygonIndex(polys, cells)
+
+    # random points over the polygons, and the vertices themselves
+    bb = polys.bounding_box
+    np.random.seed(11)
+    points = np.c_[np.random.uniform(bb.Left, bb.Right, 5000),
+                   np.random.uniform(bb.Bottom, bb.Top, 5000),
+                   np.zeros(5000)]
+    points = np.r_[points, np.c_[polys._PointsArray[::7],
+                                 np.zeros(len(polys._PointsArray[::7]))]]
+    each = locate_each([p.points for p in polys], points)
+
+    assert np.array_equal(index.locate(points), each)
+    assert np.array_equal(index.contains(points), each >= 0)
+    assert (each >= 0).any()
+
+
+def test_index_pickle():
+    index = PolygonIndex([poly1_ccw, poly2_ccw], cells=3)
+    index2 = pickle.loads(pickle.dumps(index))
+    points = np.array([p[0] + (0., ) for p in points_in_poly1 +
+                       points_in_poly2])
+
+    assert index2.num_cells == 3
+    assert np.array_equal(index.locate(points), index2.locate(points))
+
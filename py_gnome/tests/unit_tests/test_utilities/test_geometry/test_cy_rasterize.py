@@ -0,0 +1,162 @@
+#!/usr/bin/env python
+
+"""
+Tests of the point and polygon rasterizer in the cython code.
+
+Designed to be run with py.test
+"""
+
+import pytest
+
+import numpy as np
+
+from gnome.utilities.projections import FlatEarthProjection
+from gnome.utilities.geometry.cy_point_in_polygon import points_in_poly
+from gnome.utilities.geometry.cy_rasterize import (project,
+                                                   rasterize_points,
+                                                   rasterize_polygons)
+
+
+def drawn(image):
+    """
+    the (x, y) of the pixels set, as a set
+    """
+    return set(zip(*np.nonzero(image)))
+
+
+def test_project():
+    proj = FlatEarthProjection(((-10.0, 23.0), (-5, 33.0)), (500, 400))
+    coords = np.random.RandomState(1).uniform((-12, 20, 0), (-3, 35, 0),
+                                              (1000, 3))
+
+    result = project(coords, proj.pixel_transform())
+
+    assert np.allclose(result, proj.to_pixel(coords), rtol=0, atol=1e-9)
+    assert np.array_equal(np.floor(result).astype(np.int32),
+                          proj.to_pixel(coords, asint=True))
+
+
+@pytest.mark.parametrize(('diameter', 'shape', 'pixels'),
+                         [(1, 'round', [(3, 4)]),
+                          (2, 'round', [(3, 4), (4, 4), (3, 5), (4, 5)]),
+                          (1, 'x', [(3, 4)]),
+                          (2, 'x', [(2, 3), (4, 3), (3, 4), (2, 5), (4, 5)]),
+                          ])
+def test_point_shapes(diameter, shape, pixels):
+    image = np.zeros((10, 10), dtype=np.uint8)
+
+    rasterize_points(image, [(3.2, 4.9)], value=7, diameter=diameter,
+                     shape=shape)
+
+    assert drawn(image) == set(pixels)
+    assert set(image[np.nonzero(image)]) == set([7])
+
+
+def test_points_off_image():
+    image = np.zeros((10, 8), dtype=np.uint8)
+
+    rasterize_points(image, [(-0.5, 4), (4, -0.5), (10.5, 4), (4, 8.5),
+                             (np.nan, 4), (1e300, 1e300)], diameter=2)
+    assert drawn(image) == set([(0, 4), (0, 5), (4, 0), (5, 0)])
+
+
+@pytest.mark.parametrize('num_threads', [None, 1, 3])
+@pytest.mark.parametrize('tile_size', [1, 7, 64])
+def test_tiles(tile_size, num_threads):
+    """
+    the image comes out the same however it is cut and drawn
+    """
+    points = np.random.RandomState(2).uniform(-5, 105, (2000, 2))
+    reference = np.zeros((100, 60), dtype=np.uint8)
+    for p in points[:20]:
+        rasterize_points(reference, [p], diameter=5, tile_size=1000)
+
+    image = np.zeros((100, 60), dtype=np.uint8)
+    rasterize_points(image, points[:20], diameter=5, tile_size=tile_size,
+                     num_threads=num_threads)
+    assert np.array_equal(image, reference)
+
+    reference[:] = 0
+    rasterize_polygons(reference, points.reshape(-1, 4, 2)[:30],
+                       values=np.arange(30) + 1, tile_size=1000)
+
+    image[:] = 0
+    rasterize_polygons(image, points.reshape(-1, 4, 2)[:30],
+                       values=np.arange(30) + 1, tile_size=tile_size,
+                       num_threads=num_threads)
+    assert np.array_equal(image, reference)
+
+
+def test_strided_image():
+    """
+    images are indexed [x, y] whatever their memory layout
+    """
+    image = np.zeros((12, 9), dtype=np.uint8, order='F')
+    other = np.zeros((12, 9), dtype=np.uint8)
+
+    for img in (image, other):
+        rasterize_points(img, [(2, 3), (10, 1)], diameter=3)
+        rasterize_polygons(img, [((5, 5), (9, 5), (9, 8))], values=2)
+
+    assert np.array_equal(image, other)
+    assert image[10, 1] == 1 and image[8, 6] == 2
+
+
+def test_polygon_pixel_centers():
+    """
+    a pixel is filled if its center is in the polygon
+    """
+    poly = np.array(((1.2, 0.7), (17.6, 3.1), (6.3, 11.8)))
+    image = np.zeros((20, 14), dtype=np.uint8)
+
+    rasterize_polygons(image, [poly])
+
+    centers = np.array([(x + 0.5, y + 0.5)
+                        for x in range(20) for y in range(14)])
+    inside = points_in_poly(poly, np.c_[centers, np.zeros(len(centers))])
+
+    assert drawn(image) == set((int(x), int(y))
+                               for x, y in centers[inside.astype(bool)])
+
+
+def test_polygon_order():
+    image = np.zeros((10, 10), dtype=np.uint8)
+    square = np.array(((1, 1), (8, 1), (8, 8), (1, 8)), dtype=np.float64)
+
+    rasterize_polygons(image, [square, square + 2], values=[3, 4])
+
+    assert image[2, 2] == 3
+    assert image[5, 5] == 4
+    assert image[9, 9] == 4
+
+
+def test_antialias():
+    image = np.zeros((30, 30), dtype=np.uint8)
+    tri = ((2.0, 3.0), (27.5, 6.25), (9.0, 25.0))
+    area = 0.5 * abs((27.5 - 2) * (25 - 3) - (9 - 2) * (6.25 - 3))
+
+    rasterize_polygons(image, [tri], values=255, antialias=4)
+
+    assert abs(image.sum() / 255.0 - area) < 0.5
+    # the edges are partly covered
+    assert np.any((image > 0) & (image < 255))
+
+    image[:] = 0
+    rasterize_points(image, [(15.3, 15.6)], value=200, diameter=4,
+                     antialias=8)
+
+    assert abs(image.sum() / 200.0 - np.pi * 4) < 0.5
+    assert image.max() == 200
+
+
+def test_bad_input():
+    image = np.zeros((10, 10), dtype=np.uint8)
+
+    with pytest.raises(ValueError):
+        rasterize_points(image, [(1, 2)], shape='square')
+    with pytest.raises(ValueError):
+        rasterize_points(image, [(1, 2)], value=300)
+    with pytest.raises(ValueError):
+        rasterize_points(image, [(1, 2)], transform=(1, 2))
+    with pytest.raises(ValueError):
+        rasterize_polygons(image, [((1, 2), (3, 4), (5, 1))], values=[1, 2])
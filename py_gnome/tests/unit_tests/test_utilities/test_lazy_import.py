@@ -0,0 +1,41 @@
+'''
+tests of the lazy imports of the gnome packages and the heavy modules
+'''
+import sys
+
+import pytest
+
+import gnome
+from gnome.utilities.lazy_import import LazyPackage, LazyModule, lazy_module
+
+
+@pytest.mark.parametrize('name', ['gnome', 'gnome.movers',
+                                  'gnome.outputters', 'gnome.environment'])
+def test_lazy_packages(name):
+    assert isinstance(sys.modules[name], LazyPackage)
+
+
+def test_package_attributes():
+    'the names of the packages are the ones of their modules'
+    from gnome.movers.wind_movers import WindMover
+    from gnome.environment.wind import constant_wind
+
+    assert gnome.movers.WindMover is WindMover
+    assert gnome.environment.constant_wind is constant_wind
+    assert 'WindMover' in dir(gnome.movers)
+
+    # the submodules without being listed too
+    assert gnome.outputters.output_writer.OutputWriter is not None
+
+    with pytest.raises(AttributeError):
+        gnome.movers.NotAMover
+
+
+def test_lazy_module():
+    'a module is imported the first time it is used'
+    colorsys = LazyModule('colorsys')
+    assert colorsys.rgb_to_hsv(1., 0., 0.) == (0., 1., 1.)
+    assert 'hsv_to_rgb' in colorsys.__dict__
+
+    # the module itself once it is imported
+    assert lazy_module('sys') is sys
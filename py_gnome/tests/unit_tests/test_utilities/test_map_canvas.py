@@ -4,6 +4,7 @@ Tests of the gd map canvas code.
 
 import os
 
+import numpy as np
 
 from gnome.utilities.map_canvas import MapCanvas
 
@@ -125,6 +126,53 @@ def test_copy_back_to_fore(output_dir):
     mc.save_foreground(os.path.join(output_dir, "copy_back_to_fore.png"))
 
 
+def test_draw_points():
+    mc = MapCanvas((400, 300), preset_colors='web')
+    mc.viewport = ((-40, -30), (40, 30))
+
+    points = ((0.0, 0.0, 0.0), (-20.0, 10.0, 0.0), (500.0, 0.0, 0.0))
+    mc.draw_points(points, diameter=2, color='red')
+    mc.draw_points(points[:1], diameter=1, color='blue', shape='x',
+                   background=True)
+
+    pixels = mc.projection.to_pixel(points, asint=True)
+    fore = mc.fore_asarray()
+    red = mc.fore_image.get_color_index('red')
+    for x, y in pixels[:2]:
+        assert (fore[x:x + 2, y:y + 2] == red).all()
+    assert (fore == red).sum() == 8
+
+    x, y = pixels[0]
+    assert mc.back_asarray()[x, y] == mc.back_image.get_color_index('blue')
+
+
+def test_draw_polygons(output_dir):
+    """
+    a grid of cells drawn in one call
+    """
+    mc = MapCanvas((400, 300), preset_colors='web')
+    mc.viewport = ((-40, -30), (40, 30))
+
+    lon, lat = np.meshgrid(np.arange(-30, 30, 10.0), np.arange(-20, 20, 10.0))
+    lon, lat = lon.ravel(), lat.ravel()
+    cells = np.dstack((np.c_[lon, lon + 10, lon + 10, lon],
+                       np.c_[lat, lat, lat + 10, lat + 10]))
+    colors = ['red', 'blue', 'green'] * (len(cells) // 3)
+
+    mc.draw_polygons(cells, colors)
+    mc.draw_polygons(cells[:1], 'black', background=True)
+
+    fore = mc.fore_asarray()
+    for cell, color in zip(cells, colors):
+        x, y = mc.projection.to_pixel(cell.mean(axis=0), asint=True)[0]
+        assert fore[x, y] == mc.fore_image.get_color_index(color)
+
+    x, y = mc.projection.to_pixel(cells[0].mean(axis=0), asint=True)[0]
+    assert mc.back_asarray()[x, y] == mc.back_image.get_color_index('black')
+
+    mc.save_foreground(os.path.join(output_dir, "grid_polygons.png"))
+
+
 def test_projection(output_dir):
     """
     draw the "same sized" rectangle at three latitudes to see how the look
@@ -59,6 +59,65 @@ def test_values():
         assert x[ix] == v
 
 
+def test_find_by_class():
+    'the class index follows the adds, replaces and removes'
+    items = [SimpleMover(), RandomMover(), SimpleMover()]
+    oc = OrderedCollection(items, dtype=Mover)
+
+    assert oc.find_by_class(SimpleMover) is items[0]
+    assert oc.find_by_class(SimpleMover, True) == [items[0], items[2]]
+    assert oc.find_by_class(Mover, True) == items
+
+    del oc[s_id(items[0])]
+    assert oc.find_by_class(SimpleMover, True) == [items[2]]
+
+    rand = RandomMover()
+    oc[s_id(items[2])] = rand
+    assert oc.find_by_class(SimpleMover) is None
+    assert oc.find_by_class(RandomMover, True) == [items[1], rand]
+
+    oc.clear()
+    assert oc.find_by_class(Mover) is None
+
+
+def test_find_by_attr():
+    'the indexed attributes and the others are found in order'
+    items = [SimpleMover(), RandomMover(), SimpleMover()]
+    items[0]._ref_as = 'first'
+    items[2]._ref_as = 'first'
+    oc = OrderedCollection(items, dtype=Mover)
+
+    assert oc.find_by_attr('_ref_as', 'first') is items[0]
+    assert oc.find_by_attr('_ref_as', 'first', True) == [items[0], items[2]]
+    assert oc.find_by_attr('_ref_as', 'other') is None
+    assert oc.find_by_attr('id', items[1].id) is items[1]
+
+    del oc[0]
+    assert oc.find_by_attr('_ref_as', 'first', True) == [items[2]]
+
+
+def test_contains_id():
+    items = [SimpleMover(), RandomMover()]
+    oc = OrderedCollection(items, dtype=Mover)
+
+    assert oc.contains_id(s_id(items[1]))
+
+    del oc[1]
+    assert not oc.contains_id(s_id(items[1]))
+
+
+def test_order_after_changes():
+    'the order kept between changes is remade after each change'
+    oc = OrderedCollection(range(5))
+    assert list(oc) == range(5)
+
+    del oc[1]
+    oc += 7
+    assert list(oc) == [0, 2, 3, 4, 7]
+    assert oc[-1] == 7
+    assert oc.index(7) == 4
+
+
 class TestOrderedCollection(object):
 
     def test_init(self):
@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+
+"""
+Test gnome.utilities.packed_bitmap.py
+"""
+
+import cPickle as pickle
+
+import numpy as np
+
+from gnome.utilities.packed_bitmap import PackedBitmap
+
+import pytest
+
+
+@pytest.fixture
+def raster():
+    raster = (np.random.uniform(size=(17, 21)) < .4).astype(np.uint8)
+    raster[3, :] = 2  # not land
+
+    return raster
+
+
+def test_pack(raster):
+    packed = PackedBitmap.pack(raster)
+
+    assert packed.shape == raster.shape
+    assert packed.bits.shape == (17, 3)
+    assert packed.nbytes == 17 * 3
+    assert np.all(np.asarray(packed) == (raster == 1))
+
+
+def test_index(raster):
+    packed = PackedBitmap.pack(raster)
+
+    assert packed[0, 20] == (raster[0, 20] == 1)
+    assert packed[16, 7] == (raster[16, 7] == 1)
+
+    rows = np.random.randint(0, 17, 50)
+    cols = np.random.randint(0, 21, 50)
+    assert np.all(packed[rows, cols] == (raster[rows, cols] == 1))
+
+
+def test_wrong_bits():
+    with pytest.raises(ValueError):
+        PackedBitmap(np.zeros((4, 2), dtype=np.uint8), (4, 17))
+
+
+@pytest.mark.parametrize('to_file', (False, True))
+def test_share(raster, to_file, tmpdir):
+    packed = PackedBitmap.pack(raster)
+    filename = str(tmpdir.join('bits')) if to_file else None
+
+    packed.share(filename)
+    assert np.all(np.asarray(packed) == (raster == 1))
+
+    # only the file name is pickled when the bits are in a file
+    assert ('bits' in packed.__getstate__()) != to_file
+
+    unpickled = pickle.loads(pickle.dumps(packed, 2))
+    assert unpickled == packed
+    assert unpickled.filename == filename
@@ -125,6 +125,14 @@ class Test_GeoProjection:
         assert proj1 != proj2
         assert not proj1 == proj2
 
+    def test_pixel_transform(self):
+        cx, cy, sx, sy, ox, oy = self.proj.pixel_transform()
+        coords = np.array(((-9.5, 24.0, 0.0), (-5.5, 32.0, 0.0)))
+
+        assert np.allclose(self.proj.to_pixel(coords),
+                           np.c_[(coords[:, 0] - cx) * sx + ox,
+                                 (coords[:, 1] - cy) * sy + oy])
+
 
 class Test_FlatEarthProjection:
     # bb with 60 degrees in the center: ( cos(60 deg) == 0.5 )
@@ -301,6 +309,39 @@ def test_round_trip_reverse(d_meters, ref):
     assert np.allclose(d_meters, l2m(m2l(d_meters, ref), ref))
 
 
+def test_meters_to_lonlat_in_place():
+    """ out=meters converts the meters in place, one ref for all of them """
+    meters = np.array([(METERS_PER_DEGREE_GNOME, METERS_PER_DEGREE_GNOME, 4.5),
+                       (0.0, -METERS_PER_DEGREE_GNOME, 1.0)])
+    ref = (0.0, 60.0, 0.0)
+    expected = m2l(meters, ref)
+
+    assert m2l(meters, ref, out=meters) is meters
+    assert np.allclose(meters, expected)
+    assert np.allclose(meters, ((2.0, 1.0, 4.5), (0.0, -1.0, 1.0)))
+
+    l2m(meters, [ref, ref], out=meters)
+    assert np.allclose(meters[0], (METERS_PER_DEGREE_GNOME,
+                                   METERS_PER_DEGREE_GNOME, 4.5))
+
+    with pytest.raises(ValueError):
+        m2l(meters, ref, out=np.zeros((2, 2)))
+
+    with pytest.raises(ValueError):
+        m2l(meters, [ref, ref, ref])
+
+
+def test_to_pixel_float32():
+    proj = projections.GeoProjection(((-10.0, 23.0), (-5, 33.0)), (500, 500))
+    coords = ((-10.0, 23.0, 0.0), (-7.5, 28.0, 0.0))
+
+    pixels = proj.to_pixel(coords, dtype=np.float32)
+
+    assert pixels.dtype == np.float32
+    assert np.allclose(pixels, proj.to_pixel(coords))
+    assert np.allclose(pixels, ((125, 500), (250, 250)))
+
+
 ##################################################
 # test the geodesic on the sphere code:
 ##################################################
@@ -7,7 +7,8 @@ Test gnome.utilities.rand.py
 import numpy as np
 import random
 
-from gnome.utilities.rand import random_with_persistance, seed
+from gnome.utilities.rand import random_with_persistance, seed, ElementRandom
+from gnome.utilities.distributions import WeibullDistribution
 from gnome.cy_gnome.cy_helpers import rand
 
 import pytest
@@ -91,3 +92,35 @@ def test_set_seed():
     assert xi == xf
     assert np.all(ai == af)
     assert ci == cf
+
+
+def test_element_random():
+    '''
+    an element's numbers depend on its id, not on the other elements
+    '''
+    ids = np.arange(100)
+    rng = ElementRandom(ids, spill_num=1, seed=3)
+    u = rng.uniform(0.01, 0.04)
+    n = rng.normal(1., 0.5)
+
+    assert np.all((u >= 0.01) & (u < 0.04))
+    assert np.all(np.isfinite(n))
+
+    # same numbers for half the elements, in a different order
+    rng = ElementRandom(ids[::-2], spill_num=1, seed=3)
+    assert np.all(rng.uniform(0.01, 0.04) == u[::-2])
+    assert np.all(rng.normal(1., 0.5) == n[::-2])
+
+    # other spill, other numbers
+    rng = ElementRandom(ids, spill_num=2, seed=3)
+    assert not np.any(rng.uniform(0.01, 0.04) == u)
+
+
+def test_element_random_weibull():
+    'truncated weibull draws are all within [min_, max_]'
+    dist = WeibullDistribution(alpha=1.8, lambda_=0.000248,
+                               min_=0.0002, max_=0.0004)
+    values = np.zeros((1000,))
+    dist.set_values(values, rng=ElementRandom(np.arange(1000), seed=1))
+
+    assert np.all((values >= 0.0002) & (values <= 0.0004))
@@ -6,7 +6,8 @@ import os
 import shutil
 from urllib2 import HTTPError, URLError
 
-from gnome.utilities.remote_data import get_datafile
+from gnome.utilities.remote_data import (get_datafile, is_remote_path,
+                                         data_path_exists)
 
 import pytest
 from ..conftest import testdata
@@ -62,3 +63,16 @@ def test_get_datafile():
     # do not delete file_
     if renamed is not None:
         shutil.move(renamed, file_)
+
+
+@pytest.mark.parametrize(("path", "remote"),
+                         [('http://opendap.co-ops.nos.noaa.gov/thredds/'
+                           'dodsC/NYOFS/fmrc/Aggregated_7_day_NYOFS_'
+                           'Fields_Forecast_best.ncd', True),
+                          ('https://server/dodsC/data.nc', True),
+                          ('data.nc', False),
+                          ('/tmp/http:/data.nc', False)])
+def test_is_remote_path(path, remote):
+    assert is_remote_path(path) is remote
+    # a remote path is only checked when it is opened
+    assert data_path_exists(path) is remote
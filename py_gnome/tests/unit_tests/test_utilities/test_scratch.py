@@ -0,0 +1,82 @@
+#!/usr/bin/env python
+
+"""
+Test gnome.utilities.scratch.py
+"""
+
+import numpy as np
+
+from gnome.utilities.scratch import ScratchPool, scratch_empty, scratch_zeros
+
+
+def test_lent_once_per_step():
+    pool = ScratchPool()
+
+    a = pool.empty(10)
+    b = pool.empty(10)
+    assert a is not b
+    assert a.shape == (10, ) and a.dtype == np.float64
+
+    pool.end_step()
+    again = [pool.empty(10), pool.empty(10)]
+    assert any(a is c for c in again) and any(b is c for c in again)
+
+    stats = pool.stats()
+    assert stats['requests'] == 4
+    assert stats['allocations'] == 2
+    assert stats['reuses'] == 2
+    assert stats['allocated_bytes'] == 2 * a.nbytes
+    assert stats['held_bytes'] == 2 * a.nbytes
+
+
+def test_keyed_by_dtype_and_shape():
+    pool = ScratchPool()
+
+    a = pool.empty((10, 3))
+    pool.end_step()
+
+    assert pool.empty((10, 3), np.float32) is not a
+    assert pool.empty((3, 10)) is not a
+    assert pool.empty((10, 3)) is a
+
+
+def test_unused_shapes_let_go():
+    pool = ScratchPool()
+
+    pool.empty(10)
+    pool.end_step()
+    pool.empty(20)
+    pool.end_step()
+
+    # the step after asked for 20 only
+    assert pool.stats()['held_bytes'] == 20 * 8
+    pool.empty(10)
+    assert pool.stats()['allocations'] == 3
+
+
+def test_zeros():
+    pool = ScratchPool()
+
+    a = pool.empty(5)
+    a[:] = 1.
+    pool.end_step()
+
+    assert np.all(pool.zeros(5) == 0)
+
+
+def test_clear():
+    pool = ScratchPool()
+
+    pool.empty(5)
+    pool.clear()
+
+    assert pool.stats() == {'requests': 0, 'allocations': 0,
+                            'allocated_bytes': 0, 'reuses': 0,
+                            'held_bytes': 0}
+
+
+def test_without_pool():
+    'the spill containers without a pool get new arrays'
+    a = scratch_empty(object(), (4, 3), np.float32)
+    assert a.shape == (4, 3) and a.dtype == np.float32
+    assert np.all(scratch_zeros({}, 4) == 0)
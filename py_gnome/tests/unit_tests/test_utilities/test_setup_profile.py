@@ -0,0 +1,81 @@
+'''
+tests for the setup profile of models
+'''
+from datetime import datetime, timedelta
+
+from gnome.model import Model
+from gnome.map import MapFromBNA
+from gnome.movers import CatsMover
+from gnome.environment import Tide
+from gnome.utilities import setup_profile
+from gnome.utilities.setup_profile import SetupStage, setup_stage
+
+from ..conftest import testdata
+
+
+class Thing(object):
+    name = 'thing'
+
+
+def test_records():
+    thing = Thing()
+
+    with setup_stage(thing, 'read', {'a_cache': False}) as caches:
+        caches['another_cache'] = True
+    SetupStage('prepare').done(thing)
+
+    records = setup_profile.records(thing)
+    assert [r['stage'] for r in records] == ['read', 'prepare']
+    assert records[0]['caches'] == {'a_cache': False, 'another_cache': True}
+    assert records[0]['could_be_cached'] == ['a_cache']
+    assert records[1]['could_be_cached'] == []
+    assert all(r['seconds'] >= 0. for r in records)
+
+    # a stage again replaces its record
+    SetupStage('read').done(thing, {'a_cache': True})
+    records = setup_profile.records(thing)
+    assert [r['stage'] for r in records] == ['prepare', 'read']
+    assert records[1]['could_be_cached'] == []
+
+    report = setup_profile.report([thing, thing, None])
+    assert len(report) == 2
+    assert all(r['class'] == 'Thing' and r['name'] == 'thing'
+               for r in report)
+
+    # the records don't outlive the object
+    thing_id = id(thing)
+    del thing, records, report
+    assert thing_id not in setup_profile._records
+
+
+def test_bna_cache(tmpdir):
+    cache_dir = str(tmpdir)
+    testmap = testdata['MapFromBNA']['testmap']
+
+    cold = MapFromBNA(testmap, raster_size=1000, cache_dir=cache_dir)
+    warm = MapFromBNA(testmap, raster_size=1000, cache_dir=cache_dir)
+
+    (cold_read,) = setup_profile.records(cold)
+    (warm_read,) = setup_profile.records(warm)
+    assert cold_read['stage'] == warm_read['stage'] == 'read_bna'
+    assert cold_read['could_be_cached'] == ['bna_map']
+    assert warm_read['could_be_cached'] == []
+
+
+def test_model_setup_profile():
+    start_time = datetime(2012, 8, 20, 13)
+    model = Model(start_time=start_time, duration=timedelta(hours=1))
+    model.movers += CatsMover(testdata['CatsMover']['curr'],
+                              tide=Tide(testdata['CatsMover']['tide']))
+
+    model.full_run()
+
+    profile = model.setup_profile()
+    stages = [(r['class'], r['stage']) for r in profile]
+    assert ('CatsMover', 'read') in stages
+    assert ('Tide', 'read') in stages
+    assert ('CatsMover', 'prepare_for_model_run') in stages
+
+    # in the order they started
+    starts = [r['start'] for r in profile]
+    assert starts == sorted(starts)
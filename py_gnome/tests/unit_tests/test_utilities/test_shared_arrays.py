@@ -0,0 +1,125 @@
+#!/usr/bin/env python
+
+"""
+Test gnome.utilities.shared_arrays.py
+"""
+
+import os
+import cPickle as pickle
+
+import numpy as np
+
+from gnome.utilities.shared_arrays import (SharedArrayWriter,
+                                           SharedArrayReader,
+                                           FrameWriter,
+                                           FrameReader)
+
+import pytest
+
+
+@pytest.fixture
+def transport(request, tmpdir):
+    filename = str(tmpdir.join('Data-test'))
+
+    writer = SharedArrayWriter(filename, min_bytes=64)
+    reader = SharedArrayReader(filename)
+
+    def close():
+        reader.close()
+        writer.close()
+
+    request.addfinalizer(close)
+
+    return writer, reader
+
+
+def test_round_trip(transport):
+    writer, reader = transport
+
+    positions = np.random.uniform(size=(1000, 3))
+    status = np.arange(1000, dtype=np.int16)[::2]  # not contiguous
+    mass = np.ones((1000,), dtype=[('mass', '<f8'), ('id', '<u4')])
+    result = {'step_num': 3,
+              'small': np.arange(4),
+              'names': np.array(['a', None], dtype=object),
+              'TrajectoryOutput': (positions, status, mass)}
+
+    data = writer.dumps(result)
+    loaded = reader.loads(data)
+
+    # the big arrays are not in the pickle
+    assert len(data) < positions.nbytes
+    assert loaded['step_num'] == 3
+    assert np.array_equal(loaded['small'], result['small'])
+    assert list(loaded['names']) == ['a', None]
+
+    for a, b in zip(loaded['TrajectoryOutput'], result['TrajectoryOutput']):
+        assert a.dtype == b.dtype
+        assert np.array_equal(a, b)
+
+
+def test_arrays_are_copied(transport):
+    writer, reader = transport
+
+    first = reader.loads(writer.dumps(np.zeros((100,))))
+    second = reader.loads(writer.dumps(np.ones((100,))))
+
+    assert np.all(first == 0)
+    assert np.all(second == 1)
+
+
+def test_file_grows(transport):
+    writer, reader = transport
+
+    for n in (10, 10000, 100, 300000):
+        a = np.arange(n, dtype=np.float64)
+
+        assert np.array_equal(reader.loads(writer.dumps([a, a[::-1]])),
+                              [a, a[::-1]])
+
+    assert os.path.getsize(writer.filename) >= 2 * 300000 * 8
+
+
+def test_plain_pickles(transport):
+    """
+    results without arrays are just pickles
+    """
+    writer, reader = transport
+    result = ['Traceback:', {'x': 1.5}]
+
+    assert reader.loads(writer.dumps(result)) == result
+    assert pickle.loads(writer.dumps(result)) == result
+
+
+def test_frames_round_trip():
+    """
+    between hosts the big arrays are frames of their own, and come out as
+    read only views of them
+    """
+    writer, reader = FrameWriter(min_bytes=64), FrameReader()
+
+    positions = np.random.uniform(size=(1000, 3))
+    status = np.arange(1000, dtype=np.int16)[::2]  # not contiguous
+    result = {'step_num': 3,
+              'small': np.arange(4),
+              'TrajectoryOutput': (positions, status)}
+
+    frames = writer.dumps_frames(result)
+    assert len(frames) == 3
+    assert len(frames[0]) < positions.nbytes
+
+    # as they come out of a socket
+    loaded = reader.loads_frames([f if isinstance(f, str) else f.tostring()
+                                  for f in frames])
+
+    assert loaded['step_num'] == 3
+    assert np.array_equal(loaded['small'], result['small'])
+    for a, b in zip(loaded['TrajectoryOutput'], result['TrajectoryOutput']):
+        assert a.dtype == b.dtype
+        assert np.array_equal(a, b)
+        assert not a.flags.writeable
+
+    # results without arrays are one frame
+    frames = writer.dumps_frames(['Traceback:'])
+    assert len(frames) == 1
+    assert reader.loads_frames(frames) == ['Traceback:']
@@ -0,0 +1,84 @@
+'''
+tests of the synthetic current files of the benchmarks
+'''
+from datetime import timedelta
+
+import numpy as np
+import pytest
+
+from gnome.basic_types import world_point, status_code_type, \
+    spill_type, oil_status
+from gnome.cy_gnome.cy_gridcurrent_mover import CyGridCurrentMover
+from gnome.utilities import synthetic_forcing
+from gnome.utilities.time_utils import date_to_sec
+
+
+def test_triangles():
+    tris = synthetic_forcing.triangles((3, 4))
+    nbe = synthetic_forcing.neighbors(tris)
+
+    # 6 cells of 2
+    assert tris.shape == nbe.shape == (12, 3)
+
+    # the neighbors are each other's, across the same edge
+    for t in range(len(tris)):
+        for m in range(3):
+            n = nbe[t, m]
+            if n < 0:
+                continue
+            assert t in nbe[n]
+            assert (set(tris[t]) - {tris[t, m]} ==
+                    set(tris[n]) - {tris[n, list(nbe[n]).index(t)]})
+
+    # the edges on the boundary of the 2 x 3 cells
+    assert (nbe < 0).sum() == 10
+    assert list(synthetic_forcing.boundary((3, 4))) == \
+        [0, 1, 2, 3, 7, 11, 10, 9, 8, 4]
+
+
+def test_water_positions():
+    info = {'kind': 'curvilinear', 'shape': (50, 50),
+            'bounds': synthetic_forcing.DEFAULT_BOUNDS,
+            'islands': [(-71., 41., .2)]}
+    positions = synthetic_forcing.water_positions(info, 100)
+
+    assert positions.shape == (100, 3)
+    assert np.all(np.hypot(positions[:, 0] + 71.,
+                           positions[:, 1] - 41.) > .2)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('kind', synthetic_forcing.KINDS)
+def test_read_synthetic(kind, tmpdir):
+    '''
+    the grid current mover reads the files, and moves the elements as the
+    field has it
+    '''
+    filename = str(tmpdir.join('{0}.nc'.format(kind)))
+    info = synthetic_forcing.write_forcing(kind, filename, shape=(30, 30),
+                                           num_times=3, field='uniform')
+
+    positions = synthetic_forcing.water_positions(info, 20)
+    ref = np.zeros((len(positions), ), dtype=world_point)
+    ref['long'] = positions[:, 0]
+    ref['lat'] = positions[:, 1]
+    status = np.empty((len(positions), ), dtype=status_code_type)
+    status[:] = oil_status.in_water
+
+    mover = CyGridCurrentMover()
+    mover.text_read(filename, topology_file=None)
+
+    model_time = info['start_time'] + timedelta(hours=1)
+    time_step = 900
+    delta = np.zeros((len(positions), ), dtype=world_point)
+    mover.prepare_for_model_run()
+    mover.prepare_for_model_step(date_to_sec(model_time), time_step)
+    mover.get_move(date_to_sec(model_time), time_step, ref, delta, status,
+                   spill_type.forecast)
+    mover.model_step_is_done()
+
+    expected = synthetic_forcing.expected_delta(info, positions, model_time,
+                                                time_step)
+    # the file is float32
+    assert np.allclose(delta['long'], expected[:, 0], rtol=1e-4)
+    assert np.allclose(delta['lat'], expected[:, 1], rtol=1e-4)
@@ -0,0 +1,101 @@
+#!/usr/bin/env python
+
+"""
+Test gnome.utilities.tile_pyramid.py
+"""
+
+import numpy as np
+
+from gnome.utilities.tile_pyramid import TilePyramid, BINS
+
+import pytest
+
+
+@pytest.fixture
+def points():
+    'a 25 x 20 lattice'
+    lon, lat = np.meshgrid(np.linspace(-70.5, -70., 25),
+                           np.linspace(42., 42.5, 20))
+    points = np.zeros((500,), dtype=[('long', '<f8'), ('lat', '<f8')])
+    points['long'] = lon.ravel()
+    points['lat'] = lat.ravel()
+
+    return points
+
+
+def all_tiles(pyramid, time, zoom):
+    'the tiles of a zoom that have points'
+    return [pyramid.get_tile(time, zoom, x, y)
+            for x, y in pyramid.tiles_at(zoom)]
+
+
+def test_zooms(points):
+    pyramid = TilePyramid(points)
+
+    assert pyramid.min_zoom < pyramid.max_zoom
+    assert len(pyramid.tiles_at(pyramid.min_zoom)) == 1
+    assert pyramid.tiles_at(pyramid.max_zoom + 1) == []
+
+    with pytest.raises(KeyError):
+        pyramid.get_tile(0, pyramid.min_zoom, 0, 0)  # no slice yet
+
+    pyramid.add_slice(0, np.ones((500, 2)))
+    with pytest.raises(ValueError):
+        pyramid.get_tile(0, pyramid.max_zoom + 1, 0, 0)
+
+
+def test_means(points):
+    'a coarse bin holds the mean of its points, quantized'
+    pyramid = TilePyramid(points, quantum=0.01)
+    values = np.column_stack((np.full(500, .5), np.linspace(-1, 1, 500)))
+    pyramid.add_slice(0, values)
+
+    tile = all_tiles(pyramid, 0, pyramid.min_zoom)[0]
+    bins = np.array(tile['bins'])
+    quantized = np.array(tile['values'])
+
+    assert np.all((bins >= 0) & (bins < BINS * BINS))
+    assert np.all(quantized[:, 0] == 50)
+
+    # each point has a bin of its own at the finest zoom
+    finest = all_tiles(pyramid, 0, pyramid.max_zoom)
+    assert sum(len(tile['bins']) for tile in finest) == 500
+    assert sorted(q for tile in finest for q, _ in tile['values']) == [50] * 500
+
+
+def test_missing_slice(points):
+    pyramid = TilePyramid(points)
+
+    assert not pyramid.has_slice(0)
+    pyramid.add_slice(0, np.zeros((500, 2)))
+    assert pyramid.has_slice(0)
+
+    with pytest.raises(ValueError):
+        pyramid.add_slice(900, np.zeros((499, 2)))
+
+
+def test_cache_dir(points, dump):
+    'a new pyramid on the same points reads the slice the first one kept'
+    values = np.random.uniform(-1, 1, (500, 2))
+
+    first = TilePyramid(points, cache_dir=dump, key='test')
+    first.add_slice(900, values)
+    zoom = first.max_zoom
+    tiles = all_tiles(first, 900, zoom)
+
+    second = TilePyramid(points, cache_dir=dump, key='test')
+    assert second.has_slice(900)
+    assert all_tiles(second, 900, zoom) == tiles
+
+    # other values are another pyramid
+    assert not TilePyramid(points, cache_dir=dump,
+                           key='other').has_slice(900)
+
+
+def test_slices_kept(points):
+    pyramid = TilePyramid(points, max_slices=2)
+    for time in (0, 900, 1800):
+        pyramid.add_slice(time, np.zeros((500, 2)))
+
+    assert not pyramid.has_slice(0)
+    assert pyramid.has_slice(900) and pyramid.has_slice(1800)
@@ -9,6 +9,7 @@ import pytest
 
 
 from gnome.utilities.time_utils import (date_to_sec,
+                                        times_to_sec,
                                         sec_to_date,
                                         round_time,
                                         zero_time,
@@ -200,3 +201,21 @@ def test_datetime64_dst():
     dt_list = dt_arr.astype(datetime).tolist()
 
     assert dt_list == dts
+
+
+@pytest.mark.parametrize("times", [[datetime(2016, 3, 13, 1, 30),
+                                    datetime(2016, 3, 13, 2, 30),
+                                    datetime(2016, 11, 6, 1, 30),
+                                    datetime(2016, 11, 6, 12)],
+                                   [datetime(2012, 1, 1) +
+                                    timedelta(minutes=17 * i)
+                                    for i in range(200)]])
+def test_times_to_sec(times):
+    'the seconds of times_to_sec are the ones of date_to_sec'
+    expected = date_to_sec(times).astype(np.int64)
+
+    assert np.all(times_to_sec(times) == expected)
+    assert np.all(times_to_sec(np.array(times, dtype='datetime64[s]')) ==
+                  expected)
+    assert np.all(times_to_sec(expected) == expected)
+    assert times_to_sec(times[0]) == expected[:1]
@@ -0,0 +1,55 @@
+'''
+tests for the Chrome trace of model runs
+'''
+import json
+from datetime import datetime, timedelta
+
+from gnome.model import Model
+from gnome.movers import SimpleMover
+from gnome.spill import point_line_release_spill
+from gnome.utilities.tracing import ChromeTracer
+
+
+def test_spans():
+    tracer = ChromeTracer()
+
+    with tracer.span('outer', 'test', step=1):
+        with tracer.span('inner', 'test'):
+            pass
+
+    trace = tracer.to_dict()
+    spans = [e for e in trace['traceEvents'] if e['ph'] == 'X']
+    names = [e for e in trace['traceEvents'] if e['ph'] == 'M']
+
+    assert [s['name'] for s in spans] == ['outer', 'inner']
+    assert spans[0]['args'] == {'step': 1}
+    # inner is within outer
+    assert spans[0]['ts'] <= spans[1]['ts']
+    assert (spans[1]['ts'] + spans[1]['dur'] <=
+            spans[0]['ts'] + spans[0]['dur'])
+    assert len(names) == 1
+    assert names[0]['tid'] == spans[0]['tid']
+
+
+def test_model_trace(dump):
+    start_time = datetime(2012, 9, 15, 12, 0)
+    model = Model(start_time=start_time, duration=timedelta(hours=2),
+                  time_step=900)
+    model.spills += point_line_release_spill(num_elements=10,
+                                             start_position=(1., 2., 0.),
+                                             release_time=start_time)
+    model.movers += SimpleMover(velocity=(1., -1., 0.))
+
+    filename = dump + '/model_trace.json'
+    model.tracer = ChromeTracer(filename)
+    model.full_run()
+
+    with open(filename) as trace_file:
+        events = json.load(trace_file)['traceEvents']
+
+    names = [e['name'] for e in events]
+    for stage in ('setup', 'move', 'release', 'cache', 'output'):
+        assert stage in names
+
+    # a get_move span for each step that moves
+    assert names.count('SimpleMover.get_move') == model.num_time_steps - 1
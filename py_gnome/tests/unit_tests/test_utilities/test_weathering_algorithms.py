@@ -8,6 +8,8 @@ from gnome.utilities.weathering import (LeeHuibers,
                                         PiersonMoskowitz,
                                         DelvigneSweeney,
                                         DingFarmer,
+                                        Adios2,
+                                        LehrSimecek,
                                         )
 
 
@@ -75,3 +77,23 @@ def test_ding_farmer():
                                                             wave_height,
                                                             k_w),
                       1.0)
+
+
+def test_wave_arrays():
+    'the wave formulas of an array of wind speeds are the ones of each'
+    U = np.array([0., 1., 4., 4.5, 10., 30., 250.])
+
+    for fetch in (None, 1e4):
+        assert np.allclose(Adios2.wave_height(U, fetch),
+                           [Adios2.wave_height(u, fetch) for u in U])
+        assert np.allclose(Adios2.mean_wave_period(U, None, fetch),
+                           [Adios2.mean_wave_period(u, None, fetch)
+                            for u in U])
+
+    H = np.array([0., 0.1, 1., 10.])
+    assert np.allclose(Adios2.wind_speed_from_height(H),
+                       [Adios2.wind_speed_from_height(h) for h in H])
+
+    assert np.allclose(LehrSimecek.whitecap_fraction(U, 35.),
+                       [LehrSimecek.whitecap_fraction(u, 35.) for u in U])
+    assert LehrSimecek.whitecap_fraction(250., 35.) == 1.0
@@ -10,7 +10,7 @@ import unit_conversion as uc
 
 from gnome.basic_types import oil_status, fate
 
-from gnome.weatherers.cleanup import CleanUpBase
+from gnome.weatherers.cleanup import CleanUpBase, weather_cleanups
 from gnome.weatherers import (WeatheringData,
                               FayGravityViscous,
                               Skimmer,
@@ -680,3 +680,69 @@ class TestChemicalDispersion(ObjForTests):
         assert np.allclose(self.sc.mass_balance['chem_dispersed'] /
                            self.spill.get_mass(),
                            self.c_disp.fraction_sprayed * efficiency)
+
+
+class TestWeatherCleanups(ObjForTests):
+    '''
+    weather_cleanups() removes the mass the cleanup operations do one after
+    the other, in one pass
+    '''
+    def run(self, batch):
+        (self.sc, self.weatherers) = ObjForTests.mk_test_objs()
+        cleanups = [Skimmer(amount / 4, 'kg', efficiency=0.3,
+                            active_start=active_start,
+                            active_stop=active_stop),
+                    Skimmer(amount / 8, 'kg', efficiency=0.8,
+                            active_start=active_start,
+                            active_stop=active_stop + timedelta(hours=1)),
+                    ChemicalDispersion(0.2, efficiency=0.5,
+                                       active_start=active_start,
+                                       active_stop=active_stop)]
+        self.prepare_test_objs(set.union(*[c.array_types
+                                           for c in cleanups]))
+        for c in cleanups:
+            c.prepare_for_model_run(self.sc)
+
+        model_time = rel_time
+        while model_time < active_stop + timedelta(hours=2):
+            if self.release_elements(time_step, model_time) > 0:
+                self.sc['frac_water'][:] = 0.2
+
+            for w in cleanups + self.weatherers:
+                w.prepare_for_model_step(self.sc, time_step, model_time)
+
+            # two sub-steps of the step
+            substeps = [(model_time, time_step / 2),
+                        (model_time + timedelta(seconds=time_step / 2),
+                         time_step / 2)]
+            self.sc.reset_fate_dataview()
+            if batch:
+                weather_cleanups(cleanups, self.sc, substeps)
+            else:
+                for c in cleanups:
+                    c.weather_elements_substeps(self.sc, substeps)
+
+            for w in self.weatherers:
+                w.weather_elements_substeps(self.sc, substeps)
+
+            self.sc.model_step_is_done()
+            for w in cleanups + self.weatherers:
+                w.model_step_is_done(self.sc)
+
+            model_time += timedelta(seconds=time_step)
+
+        return self.sc
+
+    def test_weather_cleanups(self):
+        sc = self.run(batch=False)
+        batch_sc = self.run(batch=True)
+
+        for key in ('skimmed', 'chem_dispersed'):
+            assert sc.mass_balance[key] > 0.
+            assert np.isclose(batch_sc.mass_balance[key], sc.mass_balance[key])
+
+        assert np.allclose(batch_sc['mass'], sc['mass'])
+        assert np.allclose(batch_sc['mass_components'], sc['mass_components'])
+        assert np.isclose(amount, batch_sc['mass'].sum() +
+                          batch_sc.mass_balance['skimmed'] +
+                          batch_sc.mass_balance['chem_dispersed'])
@@ -172,6 +172,53 @@ def test_dissolution_droplet_size(oil, temp, num_elems, drop_size, on):
         assert np.allclose(sc._data_arrays['droplet_avg_size'], drop_size[i])
 
 
+@pytest.mark.parametrize('oil', ('ABU SAFAH', 'BAHIA'))
+def test_dissolution_kernel(oil):
+    '''
+        lib_gnome's weathering workspace dissolves the same mass as
+        dissolve_oil(), step after step
+    '''
+    et = floating(substance=oil)
+
+    disp = NaturalDispersion(waves, water)
+    diss = Dissolution(waves)
+
+    (sc, time_step) = weathering_data_arrays(diss.array_types,
+                                             water,
+                                             element_type=et,
+                                             num_elements=3)[:2]
+
+    model_time = (sc.spills[0]
+                  .get('release_time') + timedelta(seconds=time_step))
+
+    disp.prepare_for_model_run(sc)
+    diss.prepare_for_model_run(sc)
+
+    disp.initialize_data(sc, sc.num_released)
+    diss.initialize_data(sc, sc.num_released)
+
+    for i in range(3):
+        disp.weather_elements(sc, time_step, model_time)
+
+        for substance, data in sc.itersubstancedata(diss.array_types):
+            start = data['mass_components'].copy()
+            exp = diss.dissolve_oil(data, substance,
+                                    model_time=model_time,
+                                    time_step=time_step)
+            exp_k_ow = data['partition_coeff'].copy()
+            data['mass_components'][:] = start
+
+            dissolved = diss.dissolve_oil_kernel(data, substance,
+                                                 model_time, time_step)
+
+            assert np.isclose(dissolved, exp.sum())
+            assert np.allclose(data['mass_components'], start - exp)
+            assert np.allclose(data['mass'], data['mass_components'].sum(1))
+            assert np.allclose(data['partition_coeff'], exp_k_ow)
+
+        sc.update_from_fatedataview()
+
+
 @pytest.mark.parametrize(('oil', 'temp', 'num_elems', 'expected_mb', 'on'),
                          [('ABU SAFAH', 311.15, 3, 0.0, True),
                           ('BAHIA', 311.15, 3, 0.0, True),
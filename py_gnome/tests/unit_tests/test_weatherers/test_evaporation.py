@@ -82,6 +82,60 @@ def test_evaporation(oil, temp, num_elems, on):
         assert np.all(sc['mass_components'] == init_mass)
 
 
+def make_evaporated(use_kernel, wind_speed=5.):
+    evap = Evaporation(Water(), wind=constant_wind(wind_speed, 0))
+    evap._use_kernel = use_kernel
+    (sc, time_step) = weathering_data_arrays(evap.array_types, evap.water,
+                                             num_elements=4)[:2]
+
+    model_time = (sc.spills[0].get('release_time') +
+                  timedelta(seconds=time_step))
+
+    evap.prepare_for_model_run(sc)
+    evap.prepare_for_model_step(sc, time_step, model_time)
+
+    return evap, sc, time_step, model_time
+
+
+def test_kernel_matches_numpy():
+    '''
+    lib_gnome's evaporate() does the step the numpy code does
+    '''
+    results = []
+    for use_kernel in (False, True):
+        evap, sc, time_step, model_time = make_evaporated(use_kernel)
+        evap.weather_elements(sc, time_step, model_time)
+        results.append(sc)
+
+    numpy_sc, kernel_sc = results
+    for name in ('mass_components', 'mass', 'evap_decay_constant',
+                 'frac_lost'):
+        assert np.allclose(kernel_sc[name], numpy_sc[name])
+
+    assert np.isclose(kernel_sc.mass_balance['evaporated'],
+                      numpy_sc.mass_balance['evaporated'])
+
+
+def test_substeps():
+    '''
+    the sub-steps of a model step in one call are those one at a time
+    '''
+    results = []
+    for use_kernel in (False, True):
+        evap, sc, time_step, model_time = make_evaporated(use_kernel)
+        substeps = [(model_time + timedelta(seconds=300 * i), 300)
+                    for i in range(3)]
+        evap.weather_elements_substeps(sc, substeps)
+        results.append(sc)
+
+    numpy_sc, kernel_sc = results
+    assert np.allclose(kernel_sc['mass_components'],
+                       numpy_sc['mass_components'])
+    assert np.isclose(kernel_sc.mass_balance['evaporated'],
+                      numpy_sc.mass_balance['evaporated'])
+    assert kernel_sc.mass_balance['evaporated'] > 0
+
+
 class TestDecayConst:
     '''
     WIP - Currently has one working test, but may have more so grouped it in
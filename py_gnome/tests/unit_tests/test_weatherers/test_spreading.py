@@ -9,6 +9,7 @@ import pytest
 from gnome import constants
 from gnome.environment import constant_wind, Water
 from gnome.weatherers import FayGravityViscous, Langmuir
+from gnome.cy_gnome.cy_weatherers import spread_oil, langmuir_oil
 from .test_cleanup import ObjForTests
 
 # scalar inputs - for testing
@@ -176,6 +177,57 @@ class TestFayGravityViscous:
         assert np.all(area[:4] == i_area)
         assert np.all(area[4:] < i_area)
 
+    def test_kernel_matches_update_area(self):
+        '''
+        lib_gnome's fay_spread() spreads all the blobs as update_area() does
+        '''
+        (bulk_init_volume, age, area) = \
+            data_arrays(10)
+        bulk_init_volume[0::2] = 60
+        age[0::2] = 900
+        age[1::2] = 1800
+        area[0::2] = self.expected(60, 900)[0] / 5
+        area[1::2] = self.expected(bulk_init_volume[1], 1800)[0] / 5
+
+        blob_num = np.asarray([0, 1] * 5, dtype=np.int32)
+        fay_area = area.copy()
+        le_area = np.zeros_like(area)
+
+        spread_oil(blob_num, age - 900, 900, bulk_init_volume, fay_area,
+                   le_area, water_viscosity, rel_buoy,
+                   self.spread.thickness_limit, self.spread.spreading_const,
+                   constants.gravity)
+
+        self.spread.update_area(water_viscosity, rel_buoy, bulk_init_volume,
+                                area, age)
+
+        assert np.allclose(fay_area, area)
+        assert np.all(le_area == fay_area)
+
+        with pytest.raises(ValueError):
+            spread_oil(blob_num, age - 900, 0, bulk_init_volume, fay_area,
+                       le_area, water_viscosity, rel_buoy,
+                       self.spread.thickness_limit,
+                       self.spread.spreading_const, constants.gravity)
+
+    def test_blob_numbers(self):
+        '''
+        LEs not numbered at release are put in blobs by spill and age
+        '''
+        spread = FayGravityViscous()
+        data = {'blob_num': np.asarray([0, 0, -1, -1, -1, -1],
+                                       dtype=np.int32),
+                'spill_num': np.asarray([0, 0, 0, 0, 1, 1]),
+                'age': np.asarray([900, 900, 0, 900, 0, 0], dtype=np.int32)}
+        spread._next_blob = 1
+
+        blob = spread._blob_numbers(data)
+
+        assert blob[2] != blob[3]
+        assert blob[4] == blob[5]
+        assert len(np.unique(blob)) == 4
+        assert spread._next_blob == 4
+
 
 class TestLangmuir(ObjForTests):
     thick = 1e-4
@@ -244,3 +296,32 @@ class TestLangmuir(ObjForTests):
         assert l.active
         assert np.all(self.sc['area'] < self.sc['fay_area'])
         assert np.all(self.sc['frac_coverage'] < 1.0)
+
+    def test_kernel_matches_frac_coverage(self):
+        '''
+        lib_gnome's langmuir_coverage() gives each spill's LEs the fractional
+        coverage of _get_frac_coverage()
+        '''
+        spill_num = np.asarray([0, 0, 1, 1, 1])
+        bulk_init_volume = np.asarray([1., 1., 10., 10., 10.])
+        fay_area = np.asarray([1e4, 1e4, 2e4, 2e4, 2e4])
+        density = np.asarray([900., 900., 950., 950., 950.])
+        frac_coverage = np.ones_like(fay_area)
+        area = np.zeros_like(fay_area)
+        rho_h2o = 1000.
+
+        v_max = self.l.wind.get_value(self.model_time)[0] * 0.005
+        langmuir_oil(spill_num, bulk_init_volume, fay_area, density,
+                     frac_coverage, area, v_max, rho_h2o, constants.gravity)
+
+        for s_num in (0, 1):
+            s_mask = spill_num == s_num
+            thickness = (bulk_init_volume[s_mask][0] /
+                         fay_area[s_mask].sum())
+            rel_buoy = (rho_h2o - density[s_mask]) / rho_h2o
+            exp = self.l._get_frac_coverage(self.model_time, rel_buoy,
+                                            thickness)
+
+            assert np.allclose(frac_coverage[s_mask], exp)
+
+        assert np.allclose(area, fay_area * frac_coverage)